@@ -30,34 +30,37 @@
 #include <math.h>
 #include <stdint.h>
 #include <pios_math.h>
+#include <mathmisc.h>
 #include "CoordinateConversions.h"
 
 #define MIN_ALLOWABLE_MAGNITUDE 1e-30f
 
-// ****** convert Lat,Lon,Alt to ECEF  ************
-void LLA2ECEF(int32_t LLAi[3], double ECEF[3])
+// ****** ECEF from the trig of Lat,Lon and the Alt ************
+static void ECEFFromSinCos(double sinLat, double cosLat, double sinLon, double cosLon, double alt, double ECEF[3])
 {
     const double a  = 6378137.0d; // Equatorial Radius
     const double e  = 8.1819190842622e-2d; // Eccentricity
     const double e2 = e * e; // Eccentricity squared
-    double sinLat, sinLon, cosLat, cosLon;
     double N;
-    double LLA[3]   = {
+
+    N = a / sqrt(1.0d - e2 * sinLat * sinLat); // prime vertical radius of curvature
+
+    ECEF[0] = (N + alt) * cosLat * cosLon;
+    ECEF[1] = (N + alt) * cosLat * sinLon;
+    ECEF[2] = ((1.0d - e2) * N + alt) * sinLat;
+}
+
+// ****** convert Lat,Lon,Alt to ECEF  ************
+void LLA2ECEF(int32_t LLAi[3], double ECEF[3])
+{
+    double LLA[3] = {
         (double)LLAi[0] * 1e-7d,
         (double)LLAi[1] * 1e-7d,
         (double)LLAi[2] * 1e-4d
     };
 
-    sinLat = sin(DEG2RAD_D(LLA[0]));
-    sinLon = sin(DEG2RAD_D(LLA[1]));
-    cosLat = cos(DEG2RAD_D(LLA[0]));
-    cosLon = cos(DEG2RAD_D(LLA[1]));
-
-    N = a / sqrt(1.0d - e2 * sinLat * sinLat); // prime vertical radius of curvature
-
-    ECEF[0] = (N + LLA[2]) * cosLat * cosLon;
-    ECEF[1] = (N + LLA[2]) * cosLat * sinLon;
-    ECEF[2] = ((1.0d - e2) * N + LLA[2]) * sinLat;
+    ECEFFromSinCos(sin(DEG2RAD_D(LLA[0])), cos(DEG2RAD_D(LLA[0])),
+                   sin(DEG2RAD_D(LLA[1])), cos(DEG2RAD_D(LLA[1])), LLA[2], ECEF);
 }
 
 // ****** convert ECEF to Lat,Lon,Alt (ITERATIVE!) *********
@@ -148,6 +151,26 @@ void Quaternion2RPY(const float q[4], float rpy[3])
     // TODO: consider the cases where |R13| ~= 1, |pitch| ~= pi/2
 }
 
+// ****** find roll, pitch, yaw from quaternion, polynomial approximations (error < 1e-3 deg) ********
+void Quaternion2RPYFast(const float q[4], float rpy[3])
+{
+    float R13, R11, R12, R23, R33;
+    float q0s = q[0] * q[0];
+    float q1s = q[1] * q[1];
+    float q2s = q[2] * q[2];
+    float q3s = q[3] * q[3];
+
+    R13    = 2.0f * (q[1] * q[3] - q[0] * q[2]);
+    R11    = q0s + q1s - q2s - q3s;
+    R12    = 2.0f * (q[1] * q[2] + q[0] * q[3]);
+    R23    = 2.0f * (q[2] * q[3] + q[0] * q[1]);
+    R33    = q0s - q1s - q2s + q3s;
+
+    rpy[1] = RAD2DEG(fast_asinf(-R13)); // pitch always between -pi/2 to pi/2
+    rpy[2] = RAD2DEG(fast_atan2f(R12, R11));
+    rpy[0] = RAD2DEG(fast_atan2f(R23, R33));
+}
+
 // ****** find quaternion from roll, pitch, yaw ********
 void RPY2Quaternion(const float rpy[3], float q[4])
 {
@@ -177,6 +200,35 @@ void RPY2Quaternion(const float rpy[3], float q[4])
     }
 }
 
+// ****** find quaternion from roll, pitch, yaw, polynomial approximations (error < 2e-6) ********
+void RPY2QuaternionFast(const float rpy[3], float q[4])
+{
+    float phi, theta, psi;
+    float cphi, sphi, ctheta, stheta, cpsi, spsi;
+
+    phi    = DEG2RAD(rpy[0] / 2);
+    theta  = DEG2RAD(rpy[1] / 2);
+    psi    = DEG2RAD(rpy[2] / 2);
+    cphi   = fast_cosf(phi);
+    sphi   = fast_sinf(phi);
+    ctheta = fast_cosf(theta);
+    stheta = fast_sinf(theta);
+    cpsi   = fast_cosf(psi);
+    spsi   = fast_sinf(psi);
+
+    q[0]   = cphi * ctheta * cpsi + sphi * stheta * spsi;
+    q[1]   = sphi * ctheta * cpsi - cphi * stheta * spsi;
+    q[2]   = cphi * stheta * cpsi + sphi * ctheta * spsi;
+    q[3]   = cphi * ctheta * spsi - sphi * stheta * cpsi;
+
+    if (q[0] < 0) { // q0 always positive for uniqueness
+        q[0] = -q[0];
+        q[1] = -q[1];
+        q[2] = -q[2];
+        q[3] = -q[3];
+    }
+}
+
 // ** Find Rbe, that rotates a vector from earth fixed to body frame, from quaternion **
 void Quaternion2R(float q[4], float Rbe[3][3])
 {
@@ -279,6 +331,61 @@ void ECEF2Base(double ECEF[3], double BaseECEF[3], float Rne[3][3], float NED[3]
     NED[2]  = Rne[2][0] * diff[0] + Rne[2][1] * diff[1] + Rne[2][2] * diff[2];
 }
 
+// ****** Prepare a local NED Base Frame for LLA2BaseFrame() ********
+void BaseFrameFromLLA(int32_t LLAi[3], BaseFrame *base)
+{
+    const double lat = DEG2RAD_D((double)LLAi[0] * 1e-7d);
+    const double lon = DEG2RAD_D((double)LLAi[1] * 1e-7d);
+
+    base->LLAi[0] = LLAi[0];
+    base->LLAi[1] = LLAi[1];
+    base->LLAi[2] = LLAi[2];
+    base->sinLat  = sin(lat);
+    base->cosLat  = cos(lat);
+    base->sinLon  = sin(lon);
+    base->cosLon  = cos(lon);
+    ECEFFromSinCos(base->sinLat, base->cosLat, base->sinLon, base->cosLon, (double)LLAi[2] * 1e-4d, base->ECEF);
+    RneFromLLA(LLAi, base->Rne);
+}
+
+// sin and cos of x + d from those of x, for a small d
+static inline void SinCosOffset(double sinX, double cosX, double d, double *sinXd, double *cosXd)
+{
+    const double d2   = d * d;
+    const double sinD = d * (1.0d - d2 * (1.0d / 6.0d) * (1.0d - d2 * (1.0d / 20.0d)));
+    const double cosD = 1.0d - d2 * 0.5d * (1.0d - d2 * (1.0d / 12.0d));
+
+    *sinXd = sinX * cosD + cosX * sinD;
+    *cosXd = cosX * cosD - sinX * sinD;
+}
+
+// ****** Express LLA in a local NED Base Frame, without trig near the base ********
+void LLA2BaseFrame(int32_t LLAi[3], const BaseFrame *base, float NED[3])
+{
+    const double dLat = DEG2RAD_D(((double)LLAi[0] - (double)base->LLAi[0]) * 1e-7d);
+    const double dLon = DEG2RAD_D(((double)LLAi[1] - (double)base->LLAi[1]) * 1e-7d);
+    const double alt  = (double)LLAi[2] * 1e-4d;
+    double ECEF[3];
+    float diff[3];
+
+    if (fabs(dLat) < BASEFRAME_MAX_OFFSET && fabs(dLon) < BASEFRAME_MAX_OFFSET) {
+        double sinLat, cosLat, sinLon, cosLon;
+        SinCosOffset(base->sinLat, base->cosLat, dLat, &sinLat, &cosLat);
+        SinCosOffset(base->sinLon, base->cosLon, dLon, &sinLon, &cosLon);
+        ECEFFromSinCos(sinLat, cosLat, sinLon, cosLon, alt, ECEF);
+    } else {
+        LLA2ECEF(LLAi, ECEF);
+    }
+
+    diff[0] = (float)(ECEF[0] - base->ECEF[0]);
+    diff[1] = (float)(ECEF[1] - base->ECEF[1]);
+    diff[2] = (float)(ECEF[2] - base->ECEF[2]);
+
+    NED[0]  = base->Rne[0][0] * diff[0] + base->Rne[0][1] * diff[1] + base->Rne[0][2] * diff[2];
+    NED[1]  = base->Rne[1][0] * diff[0] + base->Rne[1][1] * diff[1] + base->Rne[1][2] * diff[2];
+    NED[2]  = base->Rne[2][0] * diff[0] + base->Rne[2][1] * diff[1] + base->Rne[2][2] * diff[2];
+}
+
 // ****** convert Rotation Matrix to Quaternion ********
 // ****** if R converts from e to b, q is rotation from e to b ****
 void R2Quaternion(float R[3][3], float q[4])
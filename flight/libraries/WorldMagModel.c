@@ -51,11 +51,6 @@
 #include "WorldMagModel.h"
 #include "WMMInternal.h"
 
-#define MALLOC(x) pios_malloc(x)
-#define FREE(x)   vPortFree(x)
-// #define MALLOC(x) malloc(x)
-// #define FREE(x) free(x)
-
 // http://reviews.openpilot.org/cru/OPReview-436#c6476 :
 // first column not used but it will be optimized out by compiler
 static const float CoeffFile[91][6] = {
@@ -152,8 +147,39 @@ static const float CoeffFile[91][6] = {
     { 12.0f, 12.0f, 0.0f,      0.9f,     0.1f,   0.0f   }
 };
 
-static WMMtype_Ellipsoid *Ellip = NULL;
-static WMMtype_MagneticModel *MagneticModel = NULL;
+// Evaluation buffers are static rather than allocated per call: the model is
+// evaluated from the GPS task and the heap churn (and the stack it would take
+// instead) stalled it. None of the functions below are reentrant.
+static struct {
+    WMMtype_Ellipsoid Ellip;
+    WMMtype_MagneticModel MagneticModel;
+    WMMtype_CoordSpherical CoordSpherical;
+    WMMtype_CoordGeodetic CoordGeodetic;
+    WMMtype_GeoMagneticElements GeoMagneticElements;
+    WMMtype_LegendreFunction LegendreFunction;
+    WMMtype_SphericalHarmonicVariables SphVariables;
+    float    schmidtQuasiNorm[NUMPCUP];
+    uint16_t schmidtQuasiNormMax; // nMax schmidtQuasiNorm was built for, 0 if not yet built
+    float    f1[NUMPCUP];
+    float    f2[NUMPCUP];
+    float    PreSqr[NUMPCUP];
+    float    PcupS[NUMPCUPS];
+} wmm;
+
+// Field at the corners of the last grid cell used by WMM_GetMagVectorInterpolated
+static struct {
+    bool     valid;
+    int16_t  lat0;
+    int16_t  lon0;
+    float    alt;
+    uint16_t month;
+    uint16_t day;
+    uint16_t year;
+    float    B[4][3]; // (lat0,lon0) (lat0,lon0+1) (lat0+1,lon0) (lat0+1,lon0+1)
+} wmm_cell;
+
+static WMMtype_Ellipsoid *const Ellip = &wmm.Ellip;
+static WMMtype_MagneticModel *const MagneticModel = &wmm.MagneticModel;
 static float decimal_date;
 
 /**************************************************************************************
@@ -165,18 +191,16 @@ static float decimal_date;
 *	e.g. Iceland in may of 2012 = WMM_GetMagVector(65.0, -20.0, 0.0, 5, 5, 2012, B);
 *	Alt is above the WGS-84 Ellipsoid
 *	B is the NED (XYZ) magnetic vector in nTesla
+*
+*	WMM_GetMagVectorInterpolated() takes the same arguments, but evaluates the
+*	model only at the corners of the WMM_GRID_CELL_DEG grid cell containing the
+*	position and interpolates between them, for callers that track position.
 **************************************************************************************/
 
 int WMM_Initialize()
 // Sets default values for WMM subroutines.
 // UPDATES : Ellip and MagneticModel
 {
-    if (!Ellip) {
-        return -1; // invalid pointer
-    }
-    if (!MagneticModel) {
-        return -2; // invalid pointer
-    }
     // Sets WGS-84 parameters
     Ellip->a     = 6378.137f;   // semi-major axis of the ellipsoid in km
     Ellip->b     = 6356.7523142f;       // semi-minor axis of the ellipsoid in km
@@ -220,32 +244,13 @@ int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, u
     if (Lon > 180.0f) {
         return -4; // error
     }
-    // ***********
-    // allocated required memory
 
-// Ellip = NULL;
-// MagneticModel = NULL;
+    WMMtype_CoordSpherical *CoordSpherical = &wmm.CoordSpherical;
+    WMMtype_CoordGeodetic *CoordGeodetic   = &wmm.CoordGeodetic;
+    WMMtype_GeoMagneticElements *GeoMagneticElements = &wmm.GeoMagneticElements;
 
-// MagneticModel = NULL;
-// CoordGeodetic = NULL;
-// GeoMagneticElements = NULL;
-
-    Ellip = (WMMtype_Ellipsoid *)MALLOC(sizeof(WMMtype_Ellipsoid));
-    MagneticModel = (WMMtype_MagneticModel *)MALLOC(sizeof(WMMtype_MagneticModel));
-
-    WMMtype_CoordSpherical *CoordSpherical = (WMMtype_CoordSpherical *)MALLOC(sizeof(WMMtype_CoordSpherical));
-    WMMtype_CoordGeodetic *CoordGeodetic   = (WMMtype_CoordGeodetic *)MALLOC(sizeof(WMMtype_CoordGeodetic));
-    WMMtype_GeoMagneticElements *GeoMagneticElements = (WMMtype_GeoMagneticElements *)MALLOC(sizeof(WMMtype_GeoMagneticElements));
-
-    if (!Ellip || !MagneticModel || !CoordSpherical || !CoordGeodetic || !GeoMagneticElements) {
-        returned = -5; // error
-    }
-    // ***********
-
-    if (returned >= 0) {
-        if (WMM_Initialize() < 0) {
-            returned = -6; // error
-        }
+    if (WMM_Initialize() < 0) {
+        returned = -6; // error
     }
 
     if (returned >= 0) {
@@ -271,42 +276,81 @@ int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, u
         if (WMM_Geomag(CoordSpherical, CoordGeodetic, GeoMagneticElements) < 0) {
             returned = -9; // error
         } else { // set the returned values
-            B[0] = GeoMagneticElements->X;
-            B[1] = GeoMagneticElements->Y;
-            B[2] = GeoMagneticElements->Z;
+            B[0] = GeoMagneticElements->X * 1e-2f;
+            B[1] = GeoMagneticElements->Y * 1e-2f;
+            B[2] = GeoMagneticElements->Z * 1e-2f;
         }
     }
 
-    // ***********
-    // free allocated memory
+    return returned;
+}
 
-    if (GeoMagneticElements) {
-        FREE(GeoMagneticElements);
-    }
+int WMM_GetMagVectorInterpolated(float Lat, float Lon, float AltEllipsoid, uint16_t Month, uint16_t Day, uint16_t Year, float B[3])
+{
+    // return '0' if all appears to be OK
+    // return < 0 if error, same codes as WMM_GetMagVector
 
-    if (CoordGeodetic) {
-        FREE(CoordGeodetic);
+    if (Lat < -90.0f) {
+        return -1; // error
+    }
+    if (Lat > 90.0f) {
+        return -2; // error
+    }
+    if (Lon < -180.0f) {
+        return -3; // error
+    }
+    if (Lon > 180.0f) {
+        return -4; // error
     }
 
-    if (CoordSpherical) {
-        FREE(CoordSpherical);
+    // the local NED frame turns quickly with longitude close to the poles,
+    // interpolating the horizontal components there is not good enough
+    if (fabsf(Lat) > WMM_GRID_CELL_MAX_LAT) {
+        return WMM_GetMagVector(Lat, Lon, AltEllipsoid, Month, Day, Year, B);
     }
 
-    if (MagneticModel) {
-        FREE(MagneticModel);
-        MagneticModel = NULL;
+    int16_t lat0 = (int16_t)floorf(Lat / WMM_GRID_CELL_DEG) * WMM_GRID_CELL_DEG;
+    int16_t lon0 = (int16_t)floorf(Lon / WMM_GRID_CELL_DEG) * WMM_GRID_CELL_DEG;
+
+    // keep the far corners in range on the +90 / +180 edges
+    if (lat0 > 90 - WMM_GRID_CELL_DEG) {
+        lat0 = 90 - WMM_GRID_CELL_DEG;
+    }
+    if (lon0 > 180 - WMM_GRID_CELL_DEG) {
+        lon0 = 180 - WMM_GRID_CELL_DEG;
     }
 
-    if (Ellip) {
-        FREE(Ellip);
-        Ellip = NULL;
+    if (!wmm_cell.valid || wmm_cell.lat0 != lat0 || wmm_cell.lon0 != lon0 ||
+        fabsf(wmm_cell.alt - AltEllipsoid) > WMM_GRID_CELL_ALT ||
+        wmm_cell.month != Month || wmm_cell.day != Day || wmm_cell.year != Year) {
+        wmm_cell.valid = false;
+        for (uint8_t i = 0; i < 4; i++) {
+            float lat = (float)(lat0 + ((i & 2) ? WMM_GRID_CELL_DEG : 0));
+            float lon = (float)(lon0 + ((i & 1) ? WMM_GRID_CELL_DEG : 0));
+            int returned = WMM_GetMagVector(lat, lon, AltEllipsoid, Month, Day, Year, wmm_cell.B[i]);
+            if (returned < 0) {
+                return returned;
+            }
+        }
+        wmm_cell.lat0  = lat0;
+        wmm_cell.lon0  = lon0;
+        wmm_cell.alt   = AltEllipsoid;
+        wmm_cell.month = Month;
+        wmm_cell.day   = Day;
+        wmm_cell.year  = Year;
+        wmm_cell.valid = true;
     }
 
-    B[0] = GeoMagneticElements->X * 1e-2f;
-    B[1] = GeoMagneticElements->Y * 1e-2f;
-    B[2] = GeoMagneticElements->Z * 1e-2f;
+    // bilinear interpolation inside the cell
+    float u = (Lon - (float)lon0) / (float)WMM_GRID_CELL_DEG;
+    float v = (Lat - (float)lat0) / (float)WMM_GRID_CELL_DEG;
+    for (uint8_t i = 0; i < 3; i++) {
+        float south = wmm_cell.B[0][i] + u * (wmm_cell.B[1][i] - wmm_cell.B[0][i]);
+        float north = wmm_cell.B[2][i] + u * (wmm_cell.B[3][i] - wmm_cell.B[2][i]);
+        B[i] = south + v * (north - south);
+    }
 
-    return returned;
+    return 0; // OK
 }
 
 int WMM_Geomag(WMMtype_CoordSpherical *CoordSpherical, WMMtype_CoordGeodetic *CoordGeodetic, WMMtype_GeoMagneticElements *GeoMagneticElements)
@@ -341,18 +385,10 @@ int WMM_Geomag(WMMtype_CoordSpherical *CoordSpherical, WMMtype_CoordGeodetic *Co
     WMMtype_MagneticResults MagneticResultsSphVar;
     WMMtype_MagneticResults MagneticResultsGeoVar;
 
-    // ********
-    // allocate required memory
-
-    WMMtype_LegendreFunction *LegendreFunction = (WMMtype_LegendreFunction *)MALLOC(sizeof(WMMtype_LegendreFunction));
-    WMMtype_SphericalHarmonicVariables *SphVariables = (WMMtype_SphericalHarmonicVariables *)MALLOC(sizeof(WMMtype_SphericalHarmonicVariables));
+    WMMtype_LegendreFunction *LegendreFunction = &wmm.LegendreFunction;
+    WMMtype_SphericalHarmonicVariables *SphVariables = &wmm.SphVariables;
 
-    if (!LegendreFunction || !SphVariables) {
-        returned = -1; // memory allocation error
-    }
-    // ********
-
-    if (returned >= 0) { // Compute Spherical Harmonic variables
+    { // Compute Spherical Harmonic variables
         if (WMM_ComputeSphericalHarmonicVariables(CoordSpherical, MagneticModel->nMax, SphVariables) < 0) {
             returned = -2; // error
         }
@@ -400,19 +436,6 @@ int WMM_Geomag(WMMtype_CoordSpherical *CoordSpherical, WMMtype_CoordGeodetic *Co
         }
     }
 
-    // ********
-    // free allocated memory
-
-    if (SphVariables) {
-        FREE(SphVariables);
-    }
-
-    if (LegendreFunction) {
-        FREE(LegendreFunction);
-    }
-
-    // ********
-
     return returned;
 }
 
@@ -813,32 +836,15 @@ int WMM_PcupHigh(float *Pcup, float *dPcup, float x, uint16_t nMax)
     uint16_t k, kstart, m, n;
     float pm2, pm1, pmm, plm, rescalem, z, scalef;
 
-    float *f1     = (float *)MALLOC(sizeof(float) * NUMPCUP);
-    float *f2     = (float *)MALLOC(sizeof(float) * NUMPCUP);
-    float *PreSqr = (float *)MALLOC(sizeof(float) * NUMPCUP);
-
-    if (!PreSqr || !f2 || !f1) { // memory allocation error
-        if (PreSqr) {
-            FREE(PreSqr);
-        }
-        if (f2) {
-            FREE(f2);
-        }
-        if (f1) {
-            FREE(f1);
-        }
-
-        return -1;
-    }
+    float *f1     = wmm.f1;
+    float *f2     = wmm.f2;
+    float *PreSqr = wmm.PreSqr;
 
     /*
      * Note: OP code change to avoid floating point equality test.
      * Was: if (fabs(x) == 1.0)
      */
     if (fabsf(x) - 1.0f < 1e-9f) {
-        FREE(PreSqr);
-        FREE(f2);
-        FREE(f1);
 
         // printf("Error in PcupHigh: derivative cannot be calculated at poles\n");
         return -2;
@@ -872,9 +878,6 @@ int WMM_PcupHigh(float *Pcup, float *dPcup, float x, uint16_t nMax)
     Pcup[0]  = 1.0f;
     dPcup[0] = 0.0f;
     if (nMax == 0) {
-        FREE(PreSqr);
-        FREE(f2);
-        FREE(f1);
         return -3;
     }
     pm1      = x;
@@ -927,15 +930,6 @@ int WMM_PcupHigh(float *Pcup, float *dPcup, float x, uint16_t nMax)
     Pcup[kstart]  = pmm * rescalem;
     dPcup[kstart] = -(float)(nMax) * x * Pcup[kstart] / z;
 
-    // *********
-    // free allocated memory
-
-    FREE(PreSqr);
-    FREE(f2);
-    FREE(f1);
-
-    // *********
-
     return 0; // OK
 }
 
@@ -967,11 +961,7 @@ int WMM_PcupLow(float *Pcup, float *dPcup, float x, uint16_t nMax)
     uint16_t n, m, index, index1, index2;
     float k, z;
 
-    float *schmidtQuasiNorm = (float *)MALLOC(sizeof(float) * NUMPCUP);
-
-    if (!schmidtQuasiNorm) { // memory allocation error
-        return -1;
-    }
+    float *schmidtQuasiNorm = wmm.schmidtQuasiNorm;
 
     Pcup[0]  = 1.0f;
     dPcup[0] = 0.0f;
@@ -1008,20 +998,24 @@ int WMM_PcupLow(float *Pcup, float *dPcup, float x, uint16_t nMax)
     }
 /*Compute the ration between the Gauss-normalized associated Legendre
    functions and the Schmidt quasi-normalized version. This is equivalent to
-   sqrt((m==0?1:2)*(n-m)!/(n+m!))*(2n-1)!!/(n-m)!  */
-
-    schmidtQuasiNorm[0] = 1.0f;
-    for (n = 1; n <= nMax; n++) {
-        index  = (n * (n + 1) / 2);
-        index1 = (n - 1) * n / 2;
-        /* for m = 0 */
-        schmidtQuasiNorm[index] = schmidtQuasiNorm[index1] * (float)(2 * n - 1) / (float)n;
-
-        for (m = 1; m <= n; m++) {
-            index  = (n * (n + 1) / 2 + m);
-            index1 = (n * (n + 1) / 2 + m - 1);
-            schmidtQuasiNorm[index] = schmidtQuasiNorm[index1] * sqrtf((float)((n - m + 1) * (m == 1 ? 2 : 1)) / (float)(n + m));
+   sqrt((m==0?1:2)*(n-m)!/(n+m!))*(2n-1)!!/(n-m)!
+   OP change: it only depends on nMax, so it is built once and kept. */
+
+    if (wmm.schmidtQuasiNormMax != nMax) {
+        schmidtQuasiNorm[0] = 1.0f;
+        for (n = 1; n <= nMax; n++) {
+            index  = (n * (n + 1) / 2);
+            index1 = (n - 1) * n / 2;
+            /* for m = 0 */
+            schmidtQuasiNorm[index] = schmidtQuasiNorm[index1] * (float)(2 * n - 1) / (float)n;
+
+            for (m = 1; m <= n; m++) {
+                index  = (n * (n + 1) / 2 + m);
+                index1 = (n * (n + 1) / 2 + m - 1);
+                schmidtQuasiNorm[index] = schmidtQuasiNorm[index1] * sqrtf((float)((n - m + 1) * (m == 1 ? 2 : 1)) / (float)(n + m));
+            }
         }
+        wmm.schmidtQuasiNormMax = nMax;
     }
 
 /* Converts the  Gauss-normalized associated Legendre
@@ -1038,8 +1032,6 @@ int WMM_PcupLow(float *Pcup, float *dPcup, float x, uint16_t nMax)
         }
     }
 
-    FREE(schmidtQuasiNorm);
-
     return 0; // OK
 }
 
@@ -1062,11 +1054,7 @@ int WMM_SummationSpecial(WMMtype_SphericalHarmonicVariables *
     float schmidtQuasiNorm2;
     float schmidtQuasiNorm3;
 
-    float *PcupS = (float *)MALLOC(sizeof(float) * NUMPCUPS);
-
-    if (!PcupS) {
-        return -1; // memory allocation error
-    }
+    float *PcupS = wmm.PcupS;
     PcupS[0] = 1;
     schmidtQuasiNorm1   = 1.0f;
 
@@ -1101,8 +1089,6 @@ int WMM_SummationSpecial(WMMtype_SphericalHarmonicVariables *
             * PcupS[n] * schmidtQuasiNorm3;
     }
 
-    FREE(PcupS);
-
     return 0; // OK
 }
 
@@ -1124,11 +1110,7 @@ int WMM_SecVarSummationSpecial(WMMtype_SphericalHarmonicVariables *
     float schmidtQuasiNorm2;
     float schmidtQuasiNorm3;
 
-    float *PcupS = (float *)MALLOC(sizeof(float) * NUMPCUPS);
-
-    if (!PcupS) {
-        return -1; // memory allocation error
-    }
+    float *PcupS = wmm.PcupS;
     PcupS[0] = 1;
     schmidtQuasiNorm1   = 1.0f;
 
@@ -1159,8 +1141,6 @@ int WMM_SecVarSummationSpecial(WMMtype_SphericalHarmonicVariables *
             * PcupS[n] * schmidtQuasiNorm3;
     }
 
-    FREE(PcupS);
-
     return 0; // OK
 }
 
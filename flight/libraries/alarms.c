@@ -45,6 +45,17 @@ static volatile uint16_t lastAlarmChange[SYSTEMALARMS_ALARM_NUMELEM] = { 0 }; //
 
 // Private functions
 static int32_t hasSeverity(SystemAlarmsAlarmOptions severity);
+static bool mayChange(SystemAlarmsAlarmElem alarm, uint8_t current, SystemAlarmsAlarmOptions severity, uint16_t flightTime);
+
+/**
+ * Whether an alarm may go to the new severity now, it only goes down once the
+ * grace time since its last change is over
+ */
+static bool mayChange(SystemAlarmsAlarmElem alarm, uint8_t current, SystemAlarmsAlarmOptions severity, uint16_t flightTime)
+{
+    return ((uint16_t)(flightTime - lastAlarmChange[alarm]) > PIOS_ALARM_GRACETIME && current != severity)
+           || current < severity;
+}
 
 /**
  * Initialize the alarms library
@@ -81,9 +92,7 @@ int32_t AlarmsSet(SystemAlarmsAlarmElem alarm, SystemAlarmsAlarmOptions severity
     // Read alarm and update its severity only if it was changed
     SystemAlarmsAlarmGet(&alarms);
     uint16_t flightTime = (uint16_t)xTaskGetTickCount() * (uint16_t)portTICK_RATE_MS; // this deliberately overflows every 2^16 milliseconds to save memory
-    if (((uint16_t)(flightTime - lastAlarmChange[alarm]) > PIOS_ALARM_GRACETIME &&
-         SystemAlarmsAlarmToArray(alarms)[alarm] != severity)
-        || SystemAlarmsAlarmToArray(alarms)[alarm] < severity) {
+    if (mayChange(alarm, SystemAlarmsAlarmToArray(alarms)[alarm], severity, flightTime)) {
         SystemAlarmsAlarmToArray(alarms)[alarm] = severity;
         lastAlarmChange[alarm] = flightTime;
         SystemAlarmsAlarmSet(&alarms);
@@ -120,9 +129,7 @@ int32_t ExtendedAlarmsSet(SystemAlarmsAlarmElem alarm,
     // Read alarm and update its severity only if it was changed
     SystemAlarmsGet(&alarms);
     uint16_t flightTime = (uint16_t)xTaskGetTickCount() * (uint16_t)portTICK_RATE_MS; // this deliberately overflows every 2^16 milliseconds to save memory
-    if (((uint16_t)(flightTime - lastAlarmChange[alarm]) > PIOS_ALARM_GRACETIME &&
-         SystemAlarmsAlarmToArray(alarms.Alarm)[alarm] != severity)
-        || SystemAlarmsAlarmToArray(alarms.Alarm)[alarm] < severity) {
+    if (mayChange(alarm, SystemAlarmsAlarmToArray(alarms.Alarm)[alarm], severity, flightTime)) {
         SystemAlarmsExtendedAlarmStatusToArray(alarms.ExtendedAlarmStatus)[alarm] = status;
         SystemAlarmsExtendedAlarmSubStatusToArray(alarms.ExtendedAlarmSubStatus)[alarm] = subStatus;
         SystemAlarmsAlarmToArray(alarms.Alarm)[alarm] = severity;
@@ -135,6 +142,80 @@ int32_t ExtendedAlarmsSet(SystemAlarmsAlarmElem alarm,
     return 0;
 }
 
+/**
+ * Set an alarm in a batch, written by AlarmsSetMany()
+ * @param batch The batch
+ * @param alarm The system alarm to be modified
+ * @param severity The alarm severity
+ */
+void AlarmsBatchSet(AlarmsBatch *batch, SystemAlarmsAlarmElem alarm, SystemAlarmsAlarmOptions severity)
+{
+    if (alarm < SYSTEMALARMS_ALARM_NUMELEM) {
+        batch->set   |= 1u << alarm;
+        batch->clear &= ~(1u << alarm);
+        batch->severity[alarm] = severity;
+    }
+}
+
+/**
+ * Clear an alarm in a batch, written by AlarmsSetMany()
+ * @param batch The batch
+ * @param alarm The system alarm to be modified
+ */
+void AlarmsBatchClear(AlarmsBatch *batch, SystemAlarmsAlarmElem alarm)
+{
+    if (alarm < SYSTEMALARMS_ALARM_NUMELEM) {
+        AlarmsBatchSet(batch, alarm, SYSTEMALARMS_ALARM_OK);
+        batch->clear |= 1u << alarm;
+    }
+}
+
+/**
+ * Write the alarms of a batch, as AlarmsSet() and AlarmsClear() would one by
+ * one but with one update of SystemAlarms, only if one of them changed.
+ * Empties the batch.
+ * @param batch The batch
+ * @return 0 if success, -1 if an error
+ */
+int32_t AlarmsSetMany(AlarmsBatch *batch)
+{
+    SystemAlarmsData alarms;
+    bool changed = false;
+
+    if (batch->set == 0) {
+        return 0;
+    }
+
+    // Lock
+    xSemaphoreTakeRecursive(lock, portMAX_DELAY);
+
+    SystemAlarmsGet(&alarms);
+    uint16_t flightTime = (uint16_t)xTaskGetTickCount() * (uint16_t)portTICK_RATE_MS; // this deliberately overflows every 2^16 milliseconds to save memory
+    for (uint32_t n = 0; n < SYSTEMALARMS_ALARM_NUMELEM; ++n) {
+        if (!(batch->set & (1u << n)) ||
+            !mayChange(n, SystemAlarmsAlarmToArray(alarms.Alarm)[n], batch->severity[n], flightTime)) {
+            continue;
+        }
+        if (n < SYSTEMALARMS_EXTENDEDALARMSTATUS_NUMELEM && (batch->clear & (1u << n))) {
+            SystemAlarmsExtendedAlarmStatusToArray(alarms.ExtendedAlarmStatus)[n] = SYSTEMALARMS_EXTENDEDALARMSTATUS_NONE;
+            SystemAlarmsExtendedAlarmSubStatusToArray(alarms.ExtendedAlarmSubStatus)[n] = 0;
+        }
+        SystemAlarmsAlarmToArray(alarms.Alarm)[n] = batch->severity[n];
+        lastAlarmChange[n] = flightTime;
+        changed = true;
+    }
+    if (changed) {
+        SystemAlarmsSet(&alarms);
+    }
+
+    // Release lock
+    xSemaphoreGiveRecursive(lock);
+
+    batch->set   = 0;
+    batch->clear = 0;
+    return 0;
+}
+
 /**
  * Get an alarm
  * @param alarm The system alarm to be read
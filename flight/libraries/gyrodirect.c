@@ -1,12 +1,11 @@
 /**
  ******************************************************************************
  *
- * @file       trailitem.cpp
- * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2012.
- * @brief      A graphicsItem representing a trail point
+ * @file       gyrodirect.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Direct gyro path from the sensor task to the stabilization inner loop.
+ *             --
  * @see        The GNU Public License (GPL) Version 3
- * @defgroup   OPMapWidget
- * @{
  *
  *****************************************************************************/
 /*
@@ -24,25 +23,35 @@
  * with this program; if not, write to the Free Software Foundation, Inc.,
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
-#include "traillineitem.h"
 
-namespace mapcontrol {
-TrailLineItem::TrailLineItem(internals::PointLatLng const & coord1, internals::PointLatLng const & coord2, QBrush color, MapGraphicItem *map) : QGraphicsLineItem(map), coord1(coord1), coord2(coord2), m_brush(color), m_map(map)
-{
-    QPen pen;
+#include <stdint.h>
+#include "inc/gyrodirect.h"
 
-    pen.setBrush(m_brush);
-    pen.setWidth(1);
-    this->setPen(pen);
-}
+static gyrodirect_handler consumer;
+static float correction[3] = { 0, 0, 0 };
 
-int TrailLineItem::type() const
+void gyrodirect_connect(gyrodirect_handler handler)
 {
-    return Type;
+    consumer = handler;
 }
 
-void TrailLineItem::setLineSlot()
+void gyrodirect_set_correction(const float delta[3])
 {
-    setLine(m_map->FromLatLngToLocal(this->coord1).X(), m_map->FromLatLngToLocal(this->coord1).Y(), m_map->FromLatLngToLocal(this->coord2).X(), m_map->FromLatLngToLocal(this->coord2).Y());
+    correction[0] = delta[0];
+    correction[1] = delta[1];
+    correction[2] = delta[2];
 }
+
+void gyrodirect_publish(const float gyro[3])
+{
+    if (!consumer) {
+        return;
+    }
+
+    const float corrected[3] = {
+        gyro[0] + correction[0],
+        gyro[1] + correction[1],
+        gyro[2] + correction[2]
+    };
+    consumer(corrected);
 }
@@ -0,0 +1,123 @@
+/**
+ ******************************************************************************
+ *
+ * @file       hmac_sha1.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      HMAC-SHA1 with the keyed pad states computed once per key
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * HMAC(K, m) = H((K ^ opad) | H((K ^ ipad) | m)). Both pad blocks only
+ * depend on the key, so their SHA1 states are kept and a MAC costs the
+ * compressions of the message and of the outer digest alone, one of each
+ * for a short radio packet, instead of four.
+ */
+
+#include <string.h>
+
+#include "hmac_sha1.h"
+
+/**
+ * Compute the pad states of a key
+ * \param[out] ctx the key states
+ * \param[in] key the key, hashed first if longer than a block
+ * \param[in] keylen the key length in bytes
+ */
+void HMACSHA1Init(HMAC_SHA1_CTX *ctx, const uint8_t *key, unsigned int keylen)
+{
+    uint8_t pad[HMAC_SHA1_BLOCK_LENGTH] = { 0 };
+    SHA1_CTX sha;
+
+    if (keylen > HMAC_SHA1_BLOCK_LENGTH) {
+        SHA1Init(&sha);
+        SHA1Update(&sha, key, keylen);
+        SHA1Final(pad, &sha);
+    } else {
+        memcpy(pad, key, keylen);
+    }
+
+    for (int i = 0; i < HMAC_SHA1_BLOCK_LENGTH; i++) {
+        pad[i] ^= 0x36;
+    }
+    SHA1Init(&sha);
+    SHA1Transform(sha.state, pad);
+    memcpy(ctx->inner, sha.state, sizeof(ctx->inner));
+
+    for (int i = 0; i < HMAC_SHA1_BLOCK_LENGTH; i++) {
+        pad[i] ^= 0x36 ^ 0x5c;
+    }
+    SHA1Init(&sha);
+    SHA1Transform(sha.state, pad);
+    memcpy(ctx->outer, sha.state, sizeof(ctx->outer));
+
+    memset(pad, 0, sizeof(pad));
+}
+
+/**
+ * Start the MAC of a message given in parts
+ * \param[in] ctx the key states
+ * \param[out] sha the inner hash, to be fed the message with SHA1Update()
+ */
+void HMACSHA1Start(const HMAC_SHA1_CTX *ctx, SHA1_CTX *sha)
+{
+    /* carry on from the pad block, which was 512 bits */
+    memcpy(sha->state, ctx->inner, sizeof(sha->state));
+    sha->count[0] = HMAC_SHA1_BLOCK_LENGTH * 8;
+    sha->count[1] = 0;
+}
+
+/**
+ * Finish the MAC of a message given in parts
+ * \param[in] ctx the key states
+ * \param[in] sha the inner hash of the message
+ * \param[out] mac the first maclen bytes of the MAC
+ * \param[in] maclen the bytes wanted, at most SHA1_DIGEST_LENGTH
+ */
+void HMACSHA1Finish(const HMAC_SHA1_CTX *ctx, SHA1_CTX *sha, uint8_t *mac, unsigned int maclen)
+{
+    uint8_t digest[SHA1_DIGEST_LENGTH];
+
+    SHA1Final(digest, sha);
+
+    memcpy(sha->state, ctx->outer, sizeof(sha->state));
+    sha->count[0] = HMAC_SHA1_BLOCK_LENGTH * 8;
+    sha->count[1] = 0;
+    SHA1Update(sha, digest, SHA1_DIGEST_LENGTH);
+    SHA1Final(digest, sha);
+
+    memcpy(mac, digest, (maclen < SHA1_DIGEST_LENGTH) ? maclen : SHA1_DIGEST_LENGTH);
+}
+
+/**
+ * Compute the MAC of a message
+ * \param[in] ctx the key states
+ * \param[in] data the message
+ * \param[in] len the message length in bytes
+ * \param[out] mac the first maclen bytes of the MAC
+ * \param[in] maclen the bytes wanted, at most SHA1_DIGEST_LENGTH
+ */
+void HMACSHA1(const HMAC_SHA1_CTX *ctx, const uint8_t *data, unsigned int len, uint8_t *mac, unsigned int maclen)
+{
+    SHA1_CTX sha;
+
+    HMACSHA1Start(ctx, &sha);
+    SHA1Update(&sha, data, len);
+    HMACSHA1Finish(ctx, &sha, mac, maclen);
+}
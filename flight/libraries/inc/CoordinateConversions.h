@@ -43,9 +43,11 @@ void Rv2Rot(float Rv[3], float R[3][3]);
 
 // ****** find roll, pitch, yaw from quaternion ********
 void Quaternion2RPY(const float q[4], float rpy[3]);
+void Quaternion2RPYFast(const float q[4], float rpy[3]);
 
 // ****** find quaternion from roll, pitch, yaw ********
 void RPY2Quaternion(const float rpy[3], float q[4]);
+void RPY2QuaternionFast(const float rpy[3], float q[4]);
 
 // ** Find Rbe, that rotates a vector from earth fixed to body frame, from quaternion **
 void Quaternion2R(float q[4], float Rbe[3][3]);
@@ -71,6 +73,21 @@ void LLA2Base(int32_t LLAi[3], double BaseECEF[3], float Rne[3][3], float NED[3]
 // ****** Express ECEF in a local NED Base Frame ********
 void ECEF2Base(double ECEF[3], double BaseECEF[3], float Rne[3][3], float NED[3]);
 
+// ****** Local NED Base Frame, prepared once for repeated conversions ********
+// LLA2BaseFrame() gives the result of LLA2Base() but takes the trig of the
+// position from that of the base for positions within BASEFRAME_MAX_OFFSET
+// rad (about 60 km) of it, which leaves a few double multiplies and a sqrt.
+#define BASEFRAME_MAX_OFFSET 0.01d
+typedef struct {
+    int32_t LLAi[3];
+    double  sinLat, cosLat, sinLon, cosLon;
+    double  ECEF[3];
+    float   Rne[3][3];
+} BaseFrame;
+
+void BaseFrameFromLLA(int32_t LLAi[3], BaseFrame *base);
+void LLA2BaseFrame(int32_t LLAi[3], const BaseFrame *base, float NED[3]);
+
 // ****** convert Rotation Matrix to Quaternion ********
 // ****** if R converts from e to b, q is rotation from e to b ****
 void R2Quaternion(float R[3][3], float q[4]);
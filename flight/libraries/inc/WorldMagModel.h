@@ -27,8 +27,16 @@
 #ifndef WORLDMAGMODEL_H_
 #define WORLDMAGMODEL_H_
 
+// Size of the lat/lon grid cell WMM_GetMagVectorInterpolated evaluates the model on [deg]
+#define WMM_GRID_CELL_DEG 1
+// Altitude change [m] after which the cached grid cell is evaluated again
+#define WMM_GRID_CELL_ALT 1000.0f
+// Latitude [deg] beyond which WMM_GetMagVectorInterpolated evaluates the model exactly
+#define WMM_GRID_CELL_MAX_LAT 80.0f
+
 // Exposed Function Prototypes
 int WMM_Initialize();
 int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, uint16_t Day, uint16_t Year, float B[3]);
+int WMM_GetMagVectorInterpolated(float Lat, float Lon, float AltEllipsoid, uint16_t Month, uint16_t Day, uint16_t Year, float B[3]);
 
 #endif /* WORLDMAGMODEL_H_ */
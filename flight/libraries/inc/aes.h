@@ -1,10 +1,14 @@
 #ifndef _AES_H_
 #define _AES_H_
 
+#include <stdint.h>
+
 #define N_ROW   4
 #define N_COL   4
 #define N_BLOCK (N_ROW * N_COL)
 
+#define AES_128_ROUND_KEYS 44
+
 void aes_encrypt_cbc_128(void *data, void *key, void *chain_block);
 void aes_decrypt_cbc_128(void *data, void *key, void *chain_block);
 void aes_decrypt_key_128_create(void *enc_key, void *dec_key);
@@ -13,4 +17,8 @@ void aes_encrypt_cbc_256(void *data, void *key, void *chain_block);
 void aes_decrypt_cbc_256(void *data, void *key, void *chain_block);
 void aes_decrypt_key_256_create(void *enc_key, void *dec_key);
 
+void aes_key_128_expand(const void *key, uint32_t round_key[AES_128_ROUND_KEYS]);
+void aes_encrypt_128(const uint32_t round_key[AES_128_ROUND_KEYS], const void *in, void *out);
+void aes_ctr_128(const uint32_t round_key[AES_128_ROUND_KEYS], uint8_t counter[N_BLOCK], void *data, unsigned int len);
+
 #endif
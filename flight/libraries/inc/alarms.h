@@ -31,6 +31,20 @@
 #include <systemalarms.h>
 #define SYSTEMALARMS_ALARM_DEFAULT SYSTEMALARMS_ALARM_UNINITIALISED
 
+#if SYSTEMALARMS_ALARM_NUMELEM > 32
+#error AlarmsBatch keeps the alarms in 32 bit masks
+#endif
+
+/**
+ * Alarms collected by a module over one loop, written together by AlarmsSetMany()
+ * with a single update of SystemAlarms. Start it zeroed, AlarmsSetMany() empties it.
+ */
+typedef struct {
+    uint32_t set; // the alarms in the batch
+    uint32_t clear; // the ones of them cleared, as AlarmsClear()
+    uint8_t  severity[SYSTEMALARMS_ALARM_NUMELEM];
+} AlarmsBatch;
+
 int32_t AlarmsInitialize(void);
 int32_t AlarmsSet(SystemAlarmsAlarmElem alarm, SystemAlarmsAlarmOptions severity);
 int32_t ExtendedAlarmsSet(SystemAlarmsAlarmElem alarm,
@@ -43,6 +57,10 @@ void AlarmsDefaultAll();
 int32_t AlarmsClear(SystemAlarmsAlarmElem alarm);
 void AlarmsClearAll();
 
+void AlarmsBatchSet(AlarmsBatch *batch, SystemAlarmsAlarmElem alarm, SystemAlarmsAlarmOptions severity);
+void AlarmsBatchClear(AlarmsBatch *batch, SystemAlarmsAlarmElem alarm);
+int32_t AlarmsSetMany(AlarmsBatch *batch);
+
 int32_t AlarmsHasWarnings();
 int32_t AlarmsHasErrors();
 int32_t AlarmsHasCritical();
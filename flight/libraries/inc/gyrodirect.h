@@ -0,0 +1,51 @@
+/**
+ ******************************************************************************
+ *
+ * @file       gyrodirect.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Direct gyro path from the sensor task to the stabilization inner loop.
+ *             --
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef GYRODIRECT_H_
+#define GYRODIRECT_H_
+#include <openpilot.h>
+
+typedef void (*gyrodirect_handler)(const float gyro[3]);
+
+/**
+ * @brief Register the consumer of direct gyro samples, only one is supported
+ * @param[in] handler called from the context publishing the sample
+ */
+void gyrodirect_connect(gyrodirect_handler handler);
+
+/**
+ * @brief Set the correction the state estimation applies to raw gyro samples
+ * @param[in] delta GyroState - GyroSensor in deg/s
+ */
+void gyrodirect_set_correction(const float delta[3]);
+
+/**
+ * @brief Hand a new gyro sample to the consumer, in the caller's context
+ * @param[in] gyro calibrated gyro sample in deg/s
+ */
+void gyrodirect_publish(const float gyro[3]);
+
+#endif /* GYRODIRECT_H_ */
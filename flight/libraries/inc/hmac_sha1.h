@@ -0,0 +1,45 @@
+/**
+ ******************************************************************************
+ *
+ * @file       hmac_sha1.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      HMAC-SHA1 with the keyed pad states computed once per key
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef HMAC_SHA1_H
+#define HMAC_SHA1_H
+
+#include <stdint.h>
+#include <sha1.h>
+
+#define HMAC_SHA1_BLOCK_LENGTH 64
+
+/* The SHA1 states after the inner and the outer key pad block */
+typedef struct {
+    uint32_t inner[5];
+    uint32_t outer[5];
+} HMAC_SHA1_CTX;
+
+void HMACSHA1Init(HMAC_SHA1_CTX *ctx, const uint8_t *key, unsigned int keylen);
+void HMACSHA1Start(const HMAC_SHA1_CTX *ctx, SHA1_CTX *sha);
+void HMACSHA1Finish(const HMAC_SHA1_CTX *ctx, SHA1_CTX *sha, uint8_t *mac, unsigned int maclen);
+void HMACSHA1(const HMAC_SHA1_CTX *ctx, const uint8_t *data, unsigned int len, uint8_t *mac, unsigned int maclen);
+
+#endif /* HMAC_SHA1_H */
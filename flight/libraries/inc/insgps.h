@@ -33,6 +33,7 @@
 #define INSGPS_H_
 
 #include "stdint.h"
+#include "stdbool.h"
 
 /**
  * @addtogroup Constants
@@ -48,24 +49,32 @@
 
 #define FULL_SENSORS      0x3FF
 
+// state vector sizes for INSGPSInit()
+#define INSGPS_13STATE    13 // position, velocity, attitude and gyro bias
+#define INSGPS_16STATE    16 // the same and the accel bias
+
 /**
  * @}
  */
 
 // Exposed Function Prototypes
-void INSGPSInit();
+void INSGPSInit(uint16_t num_states);
+void INSSetUDFactorization(bool enable);
 void INSStatePrediction(float gyro_data[3], float accel_data[3], float dT);
 void INSCovariancePrediction(float dT);
+void INSAccumulateTransition(float dT);
+void INSAccumulatedCovariancePrediction();
 void INSCorrection(float mag_data[3], float Pos[3], float Vel[3], float BaroAlt, uint16_t SensorsUsed);
 
-void INSResetP(float PDiag[13]);
-void INSGetP(float PDiag[13]);
+void INSResetP(float PDiag[]);
+void INSGetP(float PDiag[]);
 void INSSetState(float pos[3], float vel[3], float q[4], float gyro_bias[3], float accel_bias[3]);
 void INSSetPosVelVar(float PosVar[3], float VelVar[3]);
 void INSSetGyroBias(float gyro_bias[3]);
 void INSSetAccelVar(float accel_var[3]);
 void INSSetGyroVar(float gyro_var[3]);
 void INSSetGyroBiasVar(float gyro_bias_var[3]);
+void INSSetAccelBiasVar(float accel_bias_var[3]);
 void INSSetMagNorth(float B[3]);
 void INSSetMagVar(float scaled_mag_var[3]);
 void INSSetBaroVar(float baro_var);
@@ -76,7 +85,7 @@ void MagVelBaroCorrection(float mag_data[3], float Vel[3], float BaroAlt);
 void FullCorrection(float mag_data[3], float Pos[3], float Vel[3],
                     float BaroAlt);
 void GpsBaroCorrection(float Pos[3], float Vel[3], float BaroAlt);
-void GpsMagCorrection(float mag_data[3], float Pos[3], float Vel[2]);
+void GpsMagCorrection(float mag_data[3], float Pos[3], float Vel[3]);
 void VelBaroCorrection(float Vel[3], float BaroAlt);
 
 uint16_t ins_get_num_states();
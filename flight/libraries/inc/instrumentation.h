@@ -32,7 +32,7 @@
 void InstrumentationInit();
 
 /**
- * publish all counters to UAVObjects
+ * publish all counters and profiles to UAVObjects
  */
 void InstrumentationPublishAllCounters();
 
@@ -34,6 +34,31 @@ struct path_status {
     float correction_vector[3];
 };
 
+typedef enum {
+    PATH_SEGMENT_ENDPOINT,
+    PATH_SEGMENT_VECTOR,
+    PATH_SEGMENT_CIRCLE,
+} path_segment_type_t;
+
+// geometry of a PathDesired, computed once by path_compile()
+struct path_segment {
+    path_segment_type_t type;
+    bool  mode3D; // endpoint and vector, include altitude
+    bool  clockwise; // circle
+    float start[3];
+    float end[3]; // the center of a circle
+    float vector[3]; // end - start, horizontal unless mode3D
+    float unit[3]; // vector / length, zero for a null vector
+    float length;
+    float inv_length_squared;
+    float radius; // circle
+    float start_angle; // circle, of start seen from its center, 0..2pi
+    float starting_velocity;
+    float ending_velocity;
+};
+
 void path_progress(PathDesiredData *path, float *cur_point, struct path_status *status);
+void path_compile(PathDesiredData *path, struct path_segment *segment);
+void path_segment_progress(const struct path_segment *segment, float *cur_point, struct path_status *status);
 
 #endif
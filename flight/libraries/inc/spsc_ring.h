@@ -0,0 +1,67 @@
+/**
+ ******************************************************************************
+ *
+ * @file       spsc_ring.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Lock free single producer single consumer ring buffer.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef _SPSC_RING_H_
+#define _SPSC_RING_H_
+
+#include "stdint.h"
+
+// *********************
+
+/*
+ * One side (e.g. an ISR) only ever calls the put/reserve/commit functions,
+ * the other side only the get/peek/release functions, so neither needs a
+ * critical section. The size is a power of two and all of it is usable,
+ * head and tail are free running and only masked on access.
+ */
+typedef struct {
+    uint8_t  *buf_ptr;
+    volatile uint16_t head; // written by the producer only
+    volatile uint16_t tail; // written by the consumer only
+    uint16_t mask;
+} t_spsc_ring;
+
+// *********************
+
+int8_t spscRing_init(t_spsc_ring *ring, void *buffer, uint16_t buffer_size);
+
+uint16_t spscRing_getSize(const t_spsc_ring *ring);
+uint16_t spscRing_getUsed(const t_spsc_ring *ring);
+uint16_t spscRing_getFree(const t_spsc_ring *ring);
+
+// producer side
+uint16_t spscRing_putData(t_spsc_ring *ring, const void *data, uint16_t len);
+uint16_t spscRing_reserve(t_spsc_ring *ring, uint8_t * *span);
+void spscRing_commit(t_spsc_ring *ring, uint16_t len);
+
+// consumer side
+uint16_t spscRing_getData(t_spsc_ring *ring, void *data, uint16_t len);
+uint16_t spscRing_peek(t_spsc_ring *ring, const uint8_t * *span);
+void spscRing_release(t_spsc_ring *ring, uint16_t len);
+void spscRing_clearData(t_spsc_ring *ring);
+
+// *********************
+
+#endif // ifndef _SPSC_RING_H_
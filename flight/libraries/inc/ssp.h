@@ -37,6 +37,13 @@
 #define SSP_RX_ACK        6
 #define SSP_RX_SYNCH      7
 
+// window limits. A port keeps up to txWindow packets in flight and holds up to
+// rxWindow - 1 packets that arrive ahead of a lost one, once both ends have
+// agreed on it in the synch exchange. Buffers must hold window slots of
+// SSP_PACKET_BUF_SIZE(size) bytes each.
+#define SSP_MAX_WINDOW    8
+#define SSP_PACKET_BUF_SIZE(size) ((size) + 4)
+
 typedef enum decodeState_ {
     decode_len1_e = 0,
     decode_seqNo_e,
@@ -64,6 +71,8 @@ typedef struct {
     uint16_t txBufSize; // CRC for data in Packet buff
     uint16_t max_retry; // Maximum number of retrys for a single transmit.
     int32_t  timeoutLen; // how long to wait for each retry to succeed
+    uint8_t  txWindow; // number of transmit slots in txBuf, 0 or 1 = stop and wait
+    uint8_t  rxWindow; // number of receive slots in rxBuf, 0 or 1 = in order only
     void (*pfCallBack)(uint8_t *, uint16_t); // call back function that is called when a full packet has been received
     int16_t (*pfSerialRead)(void); // function to call to read a byte from serial hardware
     void (*pfSerialWrite)(uint8_t); // function used to write a byte to serial hardware for transmission
@@ -75,10 +84,19 @@ typedef struct Port_tag {
     int16_t (*pfSerialRead)(void); // function to read a character from the serial input stream
     void (*pfSerialWrite)(uint8_t); // function to write a byte to be sent out the serial port
     uint32_t (*pfGetTime)(void); // function returns time in number of seconds that has elapsed from a given reference point
-    uint8_t  retryCount; // how many times have we tried to transmit the 'send' packet
     uint8_t  maxRetryCount; // max. times to try to transmit the 'send' packet
     int32_t  timeoutLen; // how long to wait for each retry to succeed
-    uint32_t timeout; // current timeout. when 'time' reaches this point we have timed out
+    uint8_t  txWindow; // number of transmit slots available in txBuf
+    uint8_t  rxWindow; // number of receive slots available in rxBuf
+    uint8_t  txLimit; // packets allowed in flight, agreed with the other end during synch
+    uint8_t  rxLimit; // receive window agreed during synch, 0 = peer does not use windows
+    uint16_t txBusy; // bit mask of the transmit slots waiting for an ack
+    uint8_t  txSlotSeq[SSP_MAX_WINDOW]; // sequence number held by each transmit slot
+    uint8_t  txSlotRetry[SSP_MAX_WINDOW]; // how many times each transmit slot has been sent
+    uint32_t txSlotTimeout[SSP_MAX_WINDOW]; // when 'time' reaches this point the slot is sent again
+    uint8_t  rxSlotSeq[SSP_MAX_WINDOW]; // sequence number held by each out of order receive slot, 0 = free
+    uint16_t rxSlotLen[SSP_MAX_WINDOW]; // number of 'data' bytes held by each receive slot
+    uint8_t  ackBuf[SSP_PACKET_BUF_SIZE(1)]; // ACK packets are built here so they do not clobber a pending transmit slot
     uint8_t  txSeqNo; // current 'send' packet sequence number
     uint16_t rxBufPos; // current buffer position in the receive packet
     uint16_t rxBufLen; // number of 'data' bytes in the buffer
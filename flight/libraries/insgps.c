@@ -0,0 +1,1666 @@
+/**
+ ******************************************************************************
+ * @addtogroup AHRS
+ * @{
+ * @addtogroup INSGPS
+ * @{
+ * @brief INSGPS is a joint attitude and position estimation EKF
+ *
+ * @file       insgps.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      An INS/GPS algorithm implemented with an EKF, with 13 states
+ *             or 16 with the accel bias.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "insgps.h"
+#include <math.h>
+#include <float.h>
+#include <stdint.h>
+#include <pios_math.h>
+#include <pios_mem.h>
+
+// constants/macros/typdefs
+#define NUMX 16 // number of states, X is the state vector
+#define NUMW 12 // number of plant noise inputs, w is disturbance noise vector
+#define NUMV 10 // number of measurements, v is the measurement noise vector
+#define NUMU 6 // number of deterministic inputs, U is the input vector
+
+// The matrices are sized for the 16 state filter. The 13 state filter drops
+// the accel bias, the last three states and noise inputs, and the kernels only
+// run over the first numx states. The unused rows and columns stay zero.
+#define XABIAS 13 // first accel bias state
+
+// The kernels are instantiated for both sizes, kernel13() and kernel16(), so
+// that their loops run on constant bounds. The instances are not inlined into
+// the function choosing between them, that keeps the temporaries of only one
+// on the stack.
+#define ARGS(...) __VA_ARGS__
+#define SPECIALIZE(kernel, params, args) \
+    static __attribute__((noinline, optimize("O3"))) void kernel##13 params \
+    { \
+        kernel##N(XABIAS, ARGS args); \
+    } \
+    static __attribute__((noinline, optimize("O3"))) void kernel##16 params \
+    { \
+        kernel##N(NUMX, ARGS args); \
+    }
+
+// Private functions
+void CovariancePrediction(int8_t numx, float F[NUMX][NUMX], float G[NUMX][NUMW],
+                          float Q[NUMW], float dT, float P[NUMX][NUMX]);
+void CovariancePredictionSparse(int8_t numx, float F[NUMX][NUMX], float G[NUMX][NUMW],
+                                float Q[NUMW], float dT, float P[NUMX][NUMX]);
+void TransitionAccumulate(int8_t numx, float F[NUMX][NUMX], float dT, float Phi[NUMX][NUMX]);
+void CovariancePredictionTransition(int8_t numx, float Phi[NUMX][NUMX], float G[NUMX][NUMW],
+                                    float Q[NUMW], float dTsq, float P[NUMX][NUMX]);
+void SerialUpdate(int8_t numx, float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+                  float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+                  uint16_t SensorsUsed);
+void SerialUpdateBatched(int8_t numx, float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+                         float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+                         uint16_t SensorsUsed);
+void UDDecompose(int8_t numx, float P[NUMX][NUMX]);
+void UDCompose(int8_t numx, float P[NUMX][NUMX]);
+void UDCovariancePrediction(int8_t numx, float F[NUMX][NUMX], float G[NUMX][NUMW],
+                            float Q[NUMW], float dT, float UD[NUMX][NUMX]);
+void UDCovariancePredictionTransition(int8_t numx, float Phi[NUMX][NUMX], float G[NUMX][NUMW],
+                                      float Q[NUMW], float dTsq, float UD[NUMX][NUMX]);
+void UDSerialUpdate(int8_t numx, float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+                    float Y[NUMV], float UD[NUMX][NUMX], float X[NUMX],
+                    uint16_t SensorsUsed);
+void RungeKutta(int8_t numx, float X[NUMX], float U[NUMU], float dT);
+void StateEq(float X[NUMX], float U[NUMU], float Xdot[NUMX]);
+void LinearizeFG(float X[NUMX], float U[NUMU], float F[NUMX][NUMX],
+                 float G[NUMX][NUMW]);
+void MeasurementEq(float X[NUMX], float Be[3], float Y[NUMV]);
+void LinearizeH(float X[NUMX], float Be[3], float H[NUMV][NUMX]);
+
+// Private variables
+
+// speed optimizations, describe matrix sparsity
+// derived from state equations in
+// LinearizeFG() and LinearizeH():
+//
+// (columns d-f and rows d-f only with the accel bias)
+//
+// usage F:            usage G:      usage H:
+// 0123456789abcdef  0123456789ab  0123456789abcdef
+// 0...X............  ............  X...............
+// 1....X...........  ............  .X..............
+// 2.....X..........  ............  ..X.............
+// 3......XXXX...XXX  ...XXX......  ...X............
+// 4......XXXX...XXX  ...XXX......  ....X...........
+// 5......XXXX...XXX  ...XXX......  .....X..........
+// 6.......XXXXXX...  XXX.........  ......XXXX......
+// 7......X.XXXXX...  XXX.........  ......XXXX......
+// 8......XX.XXXX...  XXX.........  ......XXXX......
+// 9......XXX.XXX...  XXX.........  ..X.............
+// a................  ......X.....
+// b................  .......X....
+// c................  ........X...
+// d................  .........X..
+// e................  ..........X.
+// f................  ...........X
+
+static const int8_t FrowMin[NUMX] = { 3, 4, 5, 6, 6, 6, 7, 6, 6, 6, 16, 16, 16, 16, 16, 16 };
+static const int8_t FrowMax[NUMX] = { 3, 4, 5, 15, 15, 15, 12, 12, 12, 12, -1, -1, -1, -1, -1, -1 };
+
+static const int8_t GrowMin[NUMX] = { 12, 12, 12, 3, 3, 3, 0, 0, 0, 0, 6, 7, 8, 9, 10, 11 };
+static const int8_t GrowMax[NUMX] = { -1, -1, -1, 5, 5, 5, 2, 2, 2, 2, 6, 7, 8, 9, 10, 11 };
+
+static const int8_t HrowMin[NUMV] = { 0, 1, 2, 3, 4, 5, 6, 6, 6, 2 };
+static const int8_t HrowMax[NUMV] = { 0, 1, 2, 3, 4, 5, 9, 9, 9, 2 };
+
+// measurements arriving together: position, velocity, magnetometer, baro
+#define NUMVGROUPS 4
+static const int8_t VgroupStart[NUMVGROUPS + 1] = { 0, 3, 6, 9, NUMV };
+
+static struct EKFData {
+    // number of states in use, 13 or 16
+    int8_t numx;
+    // linearized system matrices
+    float F[NUMX][NUMX];
+    float G[NUMX][NUMW];
+    float H[NUMV][NUMX];
+    // local magnetic unit vector in NED frame
+    float Be[3];
+    // covariance matrix, or its UD factors, and state vector
+    float P[NUMX][NUMX];
+    bool  ud;
+    float X[NUMX];
+    // state transition and summed dT^2 since the last covariance prediction
+    float Phi[NUMX][NUMX];
+    float PhidTsq;
+    // input noise and measurement noise variances
+    float Q[NUMW];
+    float R[NUMV];
+} ekf __ccm_data;
+
+// Global variables
+struct NavStruct Nav;
+
+// *************  Exposed Functions ****************
+// *************************************************
+
+uint16_t ins_get_num_states()
+{
+    return ekf.numx;
+}
+
+static void NavUpdate()
+{
+    Nav.Pos[0] = ekf.X[0];
+    Nav.Pos[1] = ekf.X[1];
+    Nav.Pos[2] = ekf.X[2];
+    Nav.Vel[0] = ekf.X[3];
+    Nav.Vel[1] = ekf.X[4];
+    Nav.Vel[2] = ekf.X[5];
+    Nav.q[0]   = ekf.X[6];
+    Nav.q[1]   = ekf.X[7];
+    Nav.q[2]   = ekf.X[8];
+    Nav.q[3]   = ekf.X[9];
+    Nav.gyro_bias[0]  = ekf.X[10];
+    Nav.gyro_bias[1]  = ekf.X[11];
+    Nav.gyro_bias[2]  = ekf.X[12];
+    Nav.accel_bias[0] = ekf.X[13];
+    Nav.accel_bias[1] = ekf.X[14];
+    Nav.accel_bias[2] = ekf.X[15];
+}
+
+void INSGPSInit(uint16_t num_states)
+{
+    ekf.numx  = (num_states == INSGPS_16STATE) ? INSGPS_16STATE : INSGPS_13STATE;
+    ekf.ud    = false;
+
+    ekf.Be[0] = 1.0f;
+    ekf.Be[1] = 0.0f;
+    ekf.Be[2] = 0.0f; // local magnetic unit vector
+
+    for (int i = 0; i < NUMX; i++) {
+        for (int j = 0; j < NUMX; j++) {
+            ekf.P[i][j]   = 0.0f; // zero all terms
+            ekf.F[i][j]   = 0.0f;
+            ekf.Phi[i][j] = (i == j) ? 1.0f : 0.0f;
+        }
+
+        for (int j = 0; j < NUMW; j++) {
+            ekf.G[i][j] = 0.0f;
+        }
+
+        for (int j = 0; j < NUMV; j++) {
+            ekf.H[j][i] = 0.0f;
+        }
+
+        ekf.X[i] = 0.0f;
+    }
+    for (int i = 0; i < NUMW; i++) {
+        ekf.Q[i] = 0.0f;
+    }
+    for (int i = 0; i < NUMV; i++) {
+        ekf.R[i] = 0.0f;
+    }
+    ekf.PhidTsq = 0.0f;
+
+
+    ekf.P[0][0]   = ekf.P[1][1] = ekf.P[2][2] = 25.0f;            // initial position variance (m^2)
+    ekf.P[3][3]   = ekf.P[4][4] = ekf.P[5][5] = 5.0f;             // initial velocity variance (m/s)^2
+    ekf.P[6][6]   = ekf.P[7][7] = ekf.P[8][8] = ekf.P[9][9] = 1e-5f;  // initial quaternion variance
+    ekf.P[10][10] = ekf.P[11][11] = ekf.P[12][12] = 1e-9f; // initial gyro bias variance (rad/s)^2
+    if (ekf.numx > XABIAS) {
+        ekf.P[13][13] = ekf.P[14][14] = ekf.P[15][15] = 1e-4f; // initial accel bias variance (m/s^2)^2
+    }
+
+    ekf.X[0]  = ekf.X[1] = ekf.X[2] = ekf.X[3] = ekf.X[4] = ekf.X[5] = 0.0f; // initial pos and vel (m)
+    ekf.X[6]  = 1.0f;
+    ekf.X[7]  = ekf.X[8] = ekf.X[9] = 0.0f;      // initial quaternion (level and North) (m/s)
+    ekf.X[10] = ekf.X[11] = ekf.X[12] = 0.0f; // initial gyro bias (rad/s)
+    ekf.X[13] = ekf.X[14] = ekf.X[15] = 0.0f; // initial accel bias (m/s^2)
+
+    ekf.Q[0]  = ekf.Q[1] = ekf.Q[2] = 50e-4f;        // gyro noise variance (rad/s)^2
+    ekf.Q[3]  = ekf.Q[4] = ekf.Q[5] = 0.00001f;      // accelerometer noise variance (m/s^2)^2
+    ekf.Q[6]  = ekf.Q[7] = ekf.Q[8] = 2e-8f;     // gyro bias random walk variance (rad/s^2)^2
+    if (ekf.numx > XABIAS) {
+        ekf.Q[9] = ekf.Q[10] = ekf.Q[11] = 1e-6f; // accel bias random walk variance (m/s^3)^2
+    }
+
+    ekf.R[0]  = ekf.R[1] = 0.004f;   // High freq GPS horizontal position noise variance (m^2)
+    ekf.R[2]  = 0.036f;          // High freq GPS vertical position noise variance (m^2)
+    ekf.R[3]  = ekf.R[4] = 0.004f;   // High freq GPS horizontal velocity noise variance (m/s)^2
+    ekf.R[5]  = 100.0f;          // High freq GPS vertical velocity noise variance (m/s)^2
+    ekf.R[6]  = ekf.R[7] = ekf.R[8] = 0.005f;    // magnetometer unit vector noise variance
+    ekf.R[9]  = .25f;                    // High freq altimeter noise variance (m^2)
+
+    NavUpdate();
+}
+
+void INSSetUDFactorization(bool enable)
+{
+    if (enable && !ekf.ud) {
+        UDDecompose(ekf.numx, ekf.P);
+    } else if (!enable && ekf.ud) {
+        UDCompose(ekf.numx, ekf.P);
+    }
+    ekf.ud = enable;
+}
+
+void INSResetP(float PDiag[])
+{
+    int8_t i, j;
+
+    // if PDiag[i] nonzero then clear row and column and set diagonal element
+    // a diagonal P is also its UD factorization
+    for (i = 0; i < ekf.numx; i++) {
+        if (PDiag != 0) {
+            for (j = 0; j < ekf.numx; j++) {
+                ekf.P[i][j] = ekf.P[j][i] = 0.0f;
+            }
+            ekf.P[i][i] = PDiag[i];
+        }
+    }
+}
+
+void INSGetP(float PDiag[])
+{
+    int8_t i, k;
+
+    // retrieve diagonal elements (aka state variance)
+    for (i = 0; i < ekf.numx; i++) {
+        if (PDiag != 0) {
+            PDiag[i] = ekf.P[i][i];
+            if (ekf.ud) { // P[i][i] = sum of U[i][k]^2 * D[k]
+                for (k = i + 1; k < ekf.numx; k++) {
+                    PDiag[i] += ekf.P[i][k] * ekf.P[i][k] * ekf.P[k][k];
+                }
+            }
+        }
+    }
+}
+
+void INSSetState(float pos[3], float vel[3], float q[4], float gyro_bias[3], float accel_bias[3])
+{
+    ekf.X[0]  = pos[0];
+    ekf.X[1]  = pos[1];
+    ekf.X[2]  = pos[2];
+    ekf.X[3]  = vel[0];
+    ekf.X[4]  = vel[1];
+    ekf.X[5]  = vel[2];
+    ekf.X[6]  = q[0];
+    ekf.X[7]  = q[1];
+    ekf.X[8]  = q[2];
+    ekf.X[9]  = q[3];
+    ekf.X[10] = gyro_bias[0];
+    ekf.X[11] = gyro_bias[1];
+    ekf.X[12] = gyro_bias[2];
+    /* Note: accel_bias not used in 13 state INS */
+    if (ekf.numx > XABIAS) {
+        ekf.X[13] = accel_bias[0];
+        ekf.X[14] = accel_bias[1];
+        ekf.X[15] = accel_bias[2];
+    }
+}
+
+void INSPosVelReset(float pos[3], float vel[3])
+{
+    if (ekf.ud) {
+        UDCompose(ekf.numx, ekf.P);
+    }
+    for (int i = 0; i < 6; i++) {
+        for (int j = i; j < ekf.numx; j++) {
+            ekf.P[i][j] = 0; // zero the first 6 rows and columns
+            ekf.P[j][i] = 0;
+        }
+    }
+
+    ekf.P[0][0] = ekf.P[1][1] = ekf.P[2][2] = 25; // initial position variance (m^2)
+    ekf.P[3][3] = ekf.P[4][4] = ekf.P[5][5] = 5; // initial velocity variance (m/s)^2
+    if (ekf.ud) {
+        UDDecompose(ekf.numx, ekf.P);
+    }
+
+    ekf.X[0]    = pos[0];
+    ekf.X[1]    = pos[1];
+    ekf.X[2]    = pos[2];
+    ekf.X[3]    = vel[0];
+    ekf.X[4]    = vel[1];
+    ekf.X[5]    = vel[2];
+}
+
+void INSSetPosVelVar(float PosVar[3], float VelVar[3])
+{
+    ekf.R[0] = PosVar[0];
+    ekf.R[1] = PosVar[1];
+    ekf.R[2] = PosVar[2];
+    ekf.R[3] = VelVar[0];
+    ekf.R[4] = VelVar[1];
+    ekf.R[5] = VelVar[2];
+}
+
+void INSSetGyroBias(float gyro_bias[3])
+{
+    ekf.X[10] = gyro_bias[0];
+    ekf.X[11] = gyro_bias[1];
+    ekf.X[12] = gyro_bias[2];
+}
+
+void INSSetAccelVar(float accel_var[3])
+{
+    ekf.Q[3] = accel_var[0];
+    ekf.Q[4] = accel_var[1];
+    ekf.Q[5] = accel_var[2];
+}
+
+void INSSetGyroVar(float gyro_var[3])
+{
+    ekf.Q[0] = gyro_var[0];
+    ekf.Q[1] = gyro_var[1];
+    ekf.Q[2] = gyro_var[2];
+}
+
+void INSSetGyroBiasVar(float gyro_bias_var[3])
+{
+    ekf.Q[6] = gyro_bias_var[0];
+    ekf.Q[7] = gyro_bias_var[1];
+    ekf.Q[8] = gyro_bias_var[2];
+}
+
+void INSSetAccelBiasVar(float accel_bias_var[3])
+{
+    /* Note: no accel bias random walk in 13 state INS */
+    if (ekf.numx > XABIAS) {
+        ekf.Q[9]  = accel_bias_var[0];
+        ekf.Q[10] = accel_bias_var[1];
+        ekf.Q[11] = accel_bias_var[2];
+    }
+}
+
+void INSSetMagVar(float scaled_mag_var[3])
+{
+    ekf.R[6] = scaled_mag_var[0];
+    ekf.R[7] = scaled_mag_var[1];
+    ekf.R[8] = scaled_mag_var[2];
+}
+
+void INSSetBaroVar(float baro_var)
+{
+    ekf.R[9] = baro_var;
+}
+
+void INSSetMagNorth(float B[3])
+{
+    float mag = sqrtf(B[0] * B[0] + B[1] * B[1] + B[2] * B[2]);
+
+    ekf.Be[0] = B[0] / mag;
+    ekf.Be[1] = B[1] / mag;
+    ekf.Be[2] = B[2] / mag;
+}
+
+void INSStatePrediction(float gyro_data[3], float accel_data[3], float dT)
+{
+    float U[6];
+    float qmag;
+
+    // rate gyro inputs in units of rad/s
+    U[0] = gyro_data[0];
+    U[1] = gyro_data[1];
+    U[2] = gyro_data[2];
+
+    // accelerometer inputs in units of m/s
+    U[3] = accel_data[0];
+    U[4] = accel_data[1];
+    U[5] = accel_data[2];
+
+    // EKF prediction step
+    LinearizeFG(ekf.X, U, ekf.F, ekf.G);
+    RungeKutta(ekf.numx, ekf.X, U, dT);
+    qmag      = sqrtf(ekf.X[6] * ekf.X[6] + ekf.X[7] * ekf.X[7] + ekf.X[8] * ekf.X[8] + ekf.X[9] * ekf.X[9]);
+    ekf.X[6] /= qmag;
+    ekf.X[7] /= qmag;
+    ekf.X[8] /= qmag;
+    ekf.X[9] /= qmag;
+    // CovariancePrediction(ekf.numx, ekf.F, ekf.G, ekf.Q, dT, ekf.P);
+
+    // Update Nav solution structure
+    NavUpdate();
+}
+
+void INSCovariancePrediction(float dT)
+{
+    if (ekf.ud) {
+        UDCovariancePrediction(ekf.numx, ekf.F, ekf.G, ekf.Q, dT, ekf.P);
+    } else {
+        CovariancePredictionSparse(ekf.numx, ekf.F, ekf.G, ekf.Q, dT, ekf.P);
+    }
+}
+
+void INSAccumulateTransition(float dT)
+{
+    TransitionAccumulate(ekf.numx, ekf.F, dT, ekf.Phi);
+    ekf.PhidTsq += dT * dT;
+}
+
+void INSAccumulatedCovariancePrediction()
+{
+    if (ekf.PhidTsq <= 0.0f) {
+        return;
+    }
+    if (ekf.ud) {
+        UDCovariancePredictionTransition(ekf.numx, ekf.Phi, ekf.G, ekf.Q, ekf.PhidTsq, ekf.P);
+    } else {
+        CovariancePredictionTransition(ekf.numx, ekf.Phi, ekf.G, ekf.Q, ekf.PhidTsq, ekf.P);
+    }
+    for (int i = 0; i < NUMX; i++) {
+        for (int j = 0; j < NUMX; j++) {
+            ekf.Phi[i][j] = (i == j) ? 1.0f : 0.0f;
+        }
+    }
+    ekf.PhidTsq = 0.0f;
+}
+
+float zeros[3] = { 0, 0, 0 };
+
+void MagCorrection(float mag_data[3])
+{
+    INSCorrection(mag_data, zeros, zeros, zeros[0], MAG_SENSORS);
+}
+
+void MagVelBaroCorrection(float mag_data[3], float Vel[3], float BaroAlt)
+{
+    INSCorrection(mag_data, zeros, Vel, BaroAlt,
+                  MAG_SENSORS | HORIZ_SENSORS | VERT_SENSORS |
+                  BARO_SENSOR);
+}
+
+void GpsBaroCorrection(float Pos[3], float Vel[3], float BaroAlt)
+{
+    INSCorrection(zeros, Pos, Vel, BaroAlt,
+                  HORIZ_SENSORS | VERT_SENSORS | BARO_SENSOR);
+}
+
+void FullCorrection(float mag_data[3], float Pos[3], float Vel[3],
+                    float BaroAlt)
+{
+    INSCorrection(mag_data, Pos, Vel, BaroAlt, FULL_SENSORS);
+}
+
+void GpsMagCorrection(float mag_data[3], float Pos[3], float Vel[3])
+{
+    INSCorrection(mag_data, Pos, Vel, zeros[0],
+                  POS_SENSORS | HORIZ_SENSORS | MAG_SENSORS);
+}
+
+void VelBaroCorrection(float Vel[3], float BaroAlt)
+{
+    INSCorrection(zeros, zeros, Vel, BaroAlt,
+                  HORIZ_SENSORS | VERT_SENSORS | BARO_SENSOR);
+}
+
+void INSCorrection(float mag_data[3], float Pos[3], float Vel[3],
+                   float BaroAlt, uint16_t SensorsUsed)
+{
+    float Z[10], Y[10];
+    float Bmag, qmag;
+
+    // GPS Position in meters and in local NED frame
+    Z[0] = Pos[0];
+    Z[1] = Pos[1];
+    Z[2] = Pos[2];
+
+    // GPS Velocity in meters and in local NED frame
+    Z[3] = Vel[0];
+    Z[4] = Vel[1];
+    Z[5] = Vel[2];
+
+    // magnetometer data in any units (use unit vector) and in body frame
+    Bmag =
+        sqrtf(mag_data[0] * mag_data[0] + mag_data[1] * mag_data[1] +
+              mag_data[2] * mag_data[2]);
+    Z[6] = mag_data[0] / Bmag;
+    Z[7] = mag_data[1] / Bmag;
+    Z[8] = mag_data[2] / Bmag;
+
+    // barometric altimeter in meters and in local NED frame
+    Z[9] = BaroAlt;
+
+    // EKF correction step
+    LinearizeH(ekf.X, ekf.Be, ekf.H);
+    MeasurementEq(ekf.X, ekf.Be, Y);
+    if (ekf.ud) {
+        UDSerialUpdate(ekf.numx, ekf.H, ekf.R, Z, Y, ekf.P, ekf.X, SensorsUsed);
+    } else {
+        SerialUpdateBatched(ekf.numx, ekf.H, ekf.R, Z, Y, ekf.P, ekf.X, SensorsUsed);
+    }
+    qmag       = sqrtf(ekf.X[6] * ekf.X[6] + ekf.X[7] * ekf.X[7] + ekf.X[8] * ekf.X[8] + ekf.X[9] * ekf.X[9]);
+    ekf.X[6]  /= qmag;
+    ekf.X[7]  /= qmag;
+    ekf.X[8]  /= qmag;
+    ekf.X[9]  /= qmag;
+
+    // Update Nav solution structure
+    NavUpdate();
+}
+
+// *************  CovariancePrediction *************
+// Does the prediction step of the Kalman filter for the covariance matrix
+// Output, Pnew, overwrites P, the input covariance
+// Pnew = (I+F*T)*P*(I+F*T)' + T^2*G*Q*G'
+// Q is the discrete time covariance of process noise
+// Q is vector of the diagonal for a square matrix with
+// dimensions equal to the number of disturbance noise variables
+// The General Method is very inefficient,not taking advantage of the sparse F and G
+// The first Method is very specific to this implementation
+// CovariancePrediction() is kept as the reference for CovariancePredictionSparse()
+// ************************************************
+
+__attribute__((always_inline))
+static inline void CovariancePredictionN(const int8_t numx, float F[NUMX][NUMX], float G[NUMX][NUMW],
+                                         float Q[NUMW], float dT, float P[NUMX][NUMX])
+{
+    float Dummy[NUMX][NUMX];
+    // Pnew = (I+F*T)*P*(I+F*T)' + (T^2)*G*Q*G' = (T^2)[(P/T + F*P)*(I/T + F') + G*Q*G')]
+
+    float dT1  = 1.0f / dT; // multiplication is faster than division on fpu.
+    float dTsq = dT * dT;
+
+    int8_t i;
+
+    for (i = 0; i < numx; i++) { // Calculate Dummy = (P/T +F*P)
+        float *Firow   = F[i];
+        float *Pirow   = P[i];
+        float *Dirow   = Dummy[i];
+        int8_t Fistart = FrowMin[i];
+        int8_t Fiend   = MIN(FrowMax[i], numx - 1);
+        int8_t j;
+        for (j = 0; j < numx; j++) {
+            Dirow[j] = Pirow[j] * dT1; // Dummy = P / T ...
+            int8_t k;
+            for (k = Fistart; k <= Fiend; k++) {
+                Dirow[j] += Firow[k] * P[k][j]; // [] + F * P
+            }
+        }
+    }
+    for (i = 0; i < numx; i++) { // Calculate Pnew = (T^2) [Dummy/T + Dummy*F' + G*Qw*G']
+        float *Dirow   = Dummy[i];
+        float *Girow   = G[i];
+        float *Pirow   = P[i];
+        int8_t Gistart = GrowMin[i];
+        int8_t Giend   = GrowMax[i];
+        int8_t j;
+        for (j = i; j < numx; j++) { // Use symmetry, ie only find upper triangular
+            float Ptmp = Dirow[j] * dT1; // Pnew = Dummy / T ...
+
+            {
+                float *Fjrow   = F[j];
+                int8_t Fjstart = FrowMin[j];
+                int8_t Fjend   = MIN(FrowMax[j], numx - 1);
+                int8_t k;
+                for (k = Fjstart; k <= Fjend; k++) {
+                    Ptmp += Dirow[k] * Fjrow[k]; // [] + Dummy*F' ...
+                }
+            }
+
+            {
+                float *Gjrow   = G[j];
+                int8_t Gjstart = MAX(Gistart, GrowMin[j]);
+                int8_t Gjend   = MIN(Giend, GrowMax[j]);
+                int8_t k;
+                for (k = Gjstart; k <= Gjend; k++) {
+                    Ptmp += Q[k] * Girow[k] * Gjrow[k]; // [] + G*Q*G' ...
+                }
+            }
+
+            P[j][i] = Pirow[j] = Ptmp * dTsq; // [] * (T^2)
+        }
+    }
+}
+
+SPECIALIZE(CovariancePrediction,
+           (float F[NUMX][NUMX], float G[NUMX][NUMW], float Q[NUMW], float dT, float P[NUMX][NUMX]),
+           (F, G, Q, dT, P))
+
+void CovariancePrediction(int8_t numx, float F[NUMX][NUMX], float G[NUMX][NUMW],
+                          float Q[NUMW], float dT, float P[NUMX][NUMX])
+{
+    if (numx > XABIAS) {
+        CovariancePrediction16(F, G, Q, dT, P);
+    } else {
+        CovariancePrediction13(F, G, Q, dT, P);
+    }
+}
+
+// *************  CovariancePredictionSparse *******
+// Same result as CovariancePrediction(), written out for the block structure
+// LinearizeFG() produces (see the usage tables above), with A = I+F*T:
+// rows 0-2   A[i][i] = 1, A[i][i+3] = T           (F[i][i+3] is exactly 1)
+// rows 3-5   A[i][i] = 1, A[i][6..9] = T*F          (Vdot from q)
+//                         A[i][13..15] = T*F        (and the accel bias)
+// rows 6-9   A[i][i] = 1, A[i][6..12] = T*F         (qdot from q and gyro bias, F[i][i] = 0)
+// rows 10-15 A[i][i] = 1                            (random walk biases)
+// G*Q*G' only fills the diagonal blocks 3-5, 6-9 and the bias diagonal.
+// Only the upper triangle of Pnew is computed and mirrored.
+// ************************************************
+
+__attribute__((always_inline))
+static inline void CovariancePredictionSparseN(const int8_t numx, float F[NUMX][NUMX], float G[NUMX][NUMW],
+                                               float Q[NUMW], float dT, float P[NUMX][NUMX])
+{
+    float D[NUMX][NUMX]; // D = A*P
+    int8_t i, j, k;
+
+    for (j = 0; j < numx; j++) {
+        const float P6 = P[6][j], P7 = P[7][j], P8 = P[8][j], P9 = P[9][j];
+        const float P10 = P[10][j], P11 = P[11][j], P12 = P[12][j];
+
+        for (i = 0; i < 3; i++) {
+            D[i][j] = P[i][j] + dT * P[i + 3][j];
+        }
+        for (i = 3; i < 6; i++) {
+            float d = F[i][6] * P6 + F[i][7] * P7 + F[i][8] * P8 + F[i][9] * P9;
+            if (numx > XABIAS) {
+                d += F[i][13] * P[13][j] + F[i][14] * P[14][j] + F[i][15] * P[15][j];
+            }
+            D[i][j] = P[i][j] + dT * d;
+        }
+        for (i = 6; i < 10; i++) {
+            D[i][j] = P[i][j] + dT * (F[i][6] * P6 + F[i][7] * P7 + F[i][8] * P8 + F[i][9] * P9 +
+                                      F[i][10] * P10 + F[i][11] * P11 + F[i][12] * P12);
+        }
+        for (i = 10; i < numx; i++) {
+            D[i][j] = P[i][j];
+        }
+    }
+
+    // Pnew = D*A' + T^2*G*Q*G', row i of D against row j of A
+    const float dTsq = dT * dT;
+    for (i = 0; i < numx; i++) {
+        const float *Di = D[i];
+        const float D6  = Di[6], D7 = Di[7], D8 = Di[8], D9 = Di[9];
+        const float D10 = Di[10], D11 = Di[11], D12 = Di[12];
+
+        for (j = i; j < 3; j++) {
+            P[i][j] = Di[j] + dT * Di[j + 3];
+        }
+        for (j = (i > 3 ? i : 3); j < 6; j++) {
+            float d = D6 * F[j][6] + D7 * F[j][7] + D8 * F[j][8] + D9 * F[j][9];
+            if (numx > XABIAS) {
+                d += Di[13] * F[j][13] + Di[14] * F[j][14] + Di[15] * F[j][15];
+            }
+            P[i][j] = Di[j] + dT * d;
+        }
+        for (j = (i > 6 ? i : 6); j < 10; j++) {
+            P[i][j] = Di[j] + dT * (D6 * F[j][6] + D7 * F[j][7] + D8 * F[j][8] + D9 * F[j][9] +
+                                    D10 * F[j][10] + D11 * F[j][11] + D12 * F[j][12]);
+        }
+        for (j = (i > 10 ? i : 10); j < numx; j++) {
+            P[i][j] = Di[j];
+        }
+    }
+
+    // G*Q*G' diagonal blocks: accel noise on V, gyro noise on q, bias random walk
+    for (i = 3; i < 6; i++) {
+        for (j = i; j < 6; j++) {
+            float GQG = 0.0f;
+            for (k = 3; k < 6; k++) {
+                GQG += Q[k] * G[i][k] * G[j][k];
+            }
+            P[i][j] += dTsq * GQG;
+        }
+    }
+    for (i = 6; i < 10; i++) {
+        for (j = i; j < 10; j++) {
+            float GQG = 0.0f;
+            for (k = 0; k < 3; k++) {
+                GQG += Q[k] * G[i][k] * G[j][k];
+            }
+            P[i][j] += dTsq * GQG;
+        }
+    }
+    for (i = 10; i < numx; i++) {
+        P[i][i] += dTsq * Q[i - 4] * G[i][i - 4] * G[i][i - 4];
+    }
+
+    for (i = 1; i < numx; i++) {
+        for (j = 0; j < i; j++) {
+            P[i][j] = P[j][i];
+        }
+    }
+}
+
+SPECIALIZE(CovariancePredictionSparse,
+           (float F[NUMX][NUMX], float G[NUMX][NUMW], float Q[NUMW], float dT, float P[NUMX][NUMX]),
+           (F, G, Q, dT, P))
+
+void CovariancePredictionSparse(int8_t numx, float F[NUMX][NUMX], float G[NUMX][NUMW],
+                                float Q[NUMW], float dT, float P[NUMX][NUMX])
+{
+    if (numx > XABIAS) {
+        CovariancePredictionSparse16(F, G, Q, dT, P);
+    } else {
+        CovariancePredictionSparse13(F, G, Q, dT, P);
+    }
+}
+
+// *************  TransitionAccumulate ************
+// Phi = (I+F*T)*Phi, collects the state transition of several prediction steps
+// for CovariancePredictionTransition(). Starting from Phi = I the product keeps
+// the block structure
+// rows 0-2   identity, cols 3-15
+// rows 3-5   identity, cols 6-15
+// rows 6-9   cols 6-12
+// rows 10-15 identity
+// so columns 0-2 never change and only the non zero part is multiplied.
+// ************************************************
+
+__attribute__((always_inline))
+static inline void TransitionAccumulateN(const int8_t numx, float F[NUMX][NUMX], float dT, float Phi[NUMX][NUMX])
+{
+    int8_t i, j;
+
+    for (j = 3; j < numx; j++) {
+        const float P6 = Phi[6][j], P7 = Phi[7][j], P8 = Phi[8][j], P9 = Phi[9][j];
+        const float P10 = Phi[10][j], P11 = Phi[11][j], P12 = Phi[12][j];
+        float D[10];
+
+        for (i = 0; i < 3; i++) {
+            D[i] = Phi[i][j] + dT * Phi[i + 3][j];
+        }
+        for (i = 3; i < 6; i++) {
+            float d = F[i][6] * P6 + F[i][7] * P7 + F[i][8] * P8 + F[i][9] * P9;
+            if (numx > XABIAS) {
+                d += F[i][13] * Phi[13][j] + F[i][14] * Phi[14][j] + F[i][15] * Phi[15][j];
+            }
+            D[i] = Phi[i][j] + dT * d;
+        }
+        for (i = 6; i < 10; i++) {
+            D[i] = Phi[i][j] + dT * (F[i][6] * P6 + F[i][7] * P7 + F[i][8] * P8 + F[i][9] * P9 +
+                                     F[i][10] * P10 + F[i][11] * P11 + F[i][12] * P12);
+        }
+        for (i = 0; i < 10; i++) {
+            Phi[i][j] = D[i];
+        }
+    }
+}
+
+SPECIALIZE(TransitionAccumulate,
+           (float F[NUMX][NUMX], float dT, float Phi[NUMX][NUMX]),
+           (F, dT, Phi))
+
+void TransitionAccumulate(int8_t numx, float F[NUMX][NUMX], float dT, float Phi[NUMX][NUMX])
+{
+    if (numx > XABIAS) {
+        TransitionAccumulate16(F, dT, Phi);
+    } else {
+        TransitionAccumulate13(F, dT, Phi);
+    }
+}
+
+// *************  CovariancePredictionTransition **
+// Pnew = Phi*P*Phi' + dTsq*G*Q*G', the covariance prediction over all the steps
+// collected in Phi by TransitionAccumulate(). dTsq is the sum of the squared
+// step lengths, the process noise of the skipped steps is taken with the
+// latest G. Uses the structure of Phi described above.
+// ************************************************
+
+__attribute__((always_inline))
+static inline void CovariancePredictionTransitionN(const int8_t numx, float Phi[NUMX][NUMX], float G[NUMX][NUMW],
+                                                   float Q[NUMW], float dTsq, float P[NUMX][NUMX])
+{
+    float D[NUMX][NUMX]; // D = Phi*P
+    int8_t i, j, k;
+
+    for (j = 0; j < numx; j++) {
+        for (i = 0; i < 3; i++) {
+            float d = P[i][j];
+            for (k = 3; k < numx; k++) {
+                d += Phi[i][k] * P[k][j];
+            }
+            D[i][j] = d;
+        }
+        for (i = 3; i < 6; i++) {
+            float d = P[i][j];
+            for (k = 6; k < numx; k++) {
+                d += Phi[i][k] * P[k][j];
+            }
+            D[i][j] = d;
+        }
+        for (i = 6; i < 10; i++) {
+            float d = 0.0f;
+            for (k = 6; k < numx; k++) {
+                d += Phi[i][k] * P[k][j];
+            }
+            D[i][j] = d;
+        }
+        for (i = 10; i < numx; i++) {
+            D[i][j] = P[i][j];
+        }
+    }
+
+    // Pnew = D*Phi', upper triangle only
+    for (i = 0; i < numx; i++) {
+        const float *Di = D[i];
+
+        for (j = i; j < 3; j++) {
+            float p = Di[j];
+            for (k = 3; k < numx; k++) {
+                p += Di[k] * Phi[j][k];
+            }
+            P[i][j] = p;
+        }
+        for (j = (i > 3 ? i : 3); j < 6; j++) {
+            float p = Di[j];
+            for (k = 6; k < numx; k++) {
+                p += Di[k] * Phi[j][k];
+            }
+            P[i][j] = p;
+        }
+        for (j = (i > 6 ? i : 6); j < 10; j++) {
+            float p = 0.0f;
+            for (k = 6; k < numx; k++) {
+                p += Di[k] * Phi[j][k];
+            }
+            P[i][j] = p;
+        }
+        for (j = (i > 10 ? i : 10); j < numx; j++) {
+            P[i][j] = Di[j];
+        }
+    }
+
+    // G*Q*G' diagonal blocks as in CovariancePredictionSparse()
+    for (i = 3; i < 6; i++) {
+        for (j = i; j < 6; j++) {
+            float GQG = 0.0f;
+            for (k = 3; k < 6; k++) {
+                GQG += Q[k] * G[i][k] * G[j][k];
+            }
+            P[i][j] += dTsq * GQG;
+        }
+    }
+    for (i = 6; i < 10; i++) {
+        for (j = i; j < 10; j++) {
+            float GQG = 0.0f;
+            for (k = 0; k < 3; k++) {
+                GQG += Q[k] * G[i][k] * G[j][k];
+            }
+            P[i][j] += dTsq * GQG;
+        }
+    }
+    for (i = 10; i < numx; i++) {
+        P[i][i] += dTsq * Q[i - 4] * G[i][i - 4] * G[i][i - 4];
+    }
+
+    for (i = 1; i < numx; i++) {
+        for (j = 0; j < i; j++) {
+            P[i][j] = P[j][i];
+        }
+    }
+}
+
+SPECIALIZE(CovariancePredictionTransition,
+           (float Phi[NUMX][NUMX], float G[NUMX][NUMW], float Q[NUMW], float dTsq, float P[NUMX][NUMX]),
+           (Phi, G, Q, dTsq, P))
+
+void CovariancePredictionTransition(int8_t numx, float Phi[NUMX][NUMX], float G[NUMX][NUMW],
+                                    float Q[NUMW], float dTsq, float P[NUMX][NUMX])
+{
+    if (numx > XABIAS) {
+        CovariancePredictionTransition16(Phi, G, Q, dTsq, P);
+    } else {
+        CovariancePredictionTransition13(Phi, G, Q, dTsq, P);
+    }
+}
+
+// *************  SerialUpdate *******************
+// Does the update step of the Kalman filter for the covariance and estimate
+// Outputs are Xnew & Pnew, and are written over P and X
+// Z is actual measurement, Y is predicted measurement
+// Xnew = X + K*(Z-Y), Pnew=(I-K*H)*P,
+// where K=P*H'*inv[H*P*H'+R]
+// NOTE the algorithm assumes R (measurement covariance matrix) is diagonal
+// i.e. the measurment noises are uncorrelated.
+// It therefore uses a serial update that requires no matrix inversion by
+// processing the measurements one at a time.
+// Algorithm - see Grewal and Andrews, "Kalman Filtering,2nd Ed" p.121 & p.253
+// - or see Simon, "Optimal State Estimation," 1st Ed, p.150
+// The SensorsUsed variable is a bitwise mask indicating which sensors
+// should be used in the update.
+// ************************************************
+
+__attribute__((always_inline))
+static inline void SerialUpdateN(const int8_t numx, float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+                                 float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+                                 uint16_t SensorsUsed)
+{
+    float HP[NUMX], HPHR, Error;
+    int8_t i, j, k, m;
+    float Km[NUMX];
+
+    for (m = 0; m < NUMV; m++) {
+        if (SensorsUsed & (0x01 << m)) { // use this sensor for update
+            for (j = 0; j < numx; j++) { // Find Hp = H*P
+                HP[j] = 0;
+                for (k = HrowMin[m]; k <= HrowMax[m]; k++) {
+                    HP[j] += H[m][k] * P[k][j];
+                }
+            }
+            HPHR = R[m]; // Find  HPHR = H*P*H' + R
+            for (k = HrowMin[m]; k <= HrowMax[m]; k++) {
+                HPHR += HP[k] * H[m][k];
+            }
+
+            for (k = 0; k < numx; k++) {
+                Km[k] = HP[k] / HPHR; // find K = HP/HPHR
+            }
+            for (i = 0; i < numx; i++) { // Find P(m)= P(m-1) + K*HP
+                for (j = i; j < numx; j++) {
+                    P[i][j] = P[j][i] =
+                                  P[i][j] - Km[i] * HP[j];
+                }
+            }
+
+            Error = Z[m] - Y[m];
+            for (i = 0; i < numx; i++) { // Find X(m)= X(m-1) + K*Error
+                X[i] = X[i] + Km[i] * Error;
+            }
+        }
+    }
+}
+
+SPECIALIZE(SerialUpdate,
+           (float H[NUMV][NUMX], float R[NUMV], float Z[NUMV], float Y[NUMV], float P[NUMX][NUMX], float X[NUMX], uint16_t SensorsUsed),
+           (H, R, Z, Y, P, X, SensorsUsed))
+
+void SerialUpdate(int8_t numx, float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+                  float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+                  uint16_t SensorsUsed)
+{
+    if (numx > XABIAS) {
+        SerialUpdate16(H, R, Z, Y, P, X, SensorsUsed);
+    } else {
+        SerialUpdate13(H, R, Z, Y, P, X, SensorsUsed);
+    }
+}
+
+// *************  SerialUpdateBatched ************
+// Same result as SerialUpdate(), with the measurements of one sensor group
+// (VgroupStart) processed together:
+// - H*P is computed once per group from the P at the start of the group,
+//   after each scalar update the remaining rows follow from
+//   H_l*Pnew = H_l*P - (H_l*K)*HP
+// - only the upper triangle of P is updated and it is mirrored once per group
+// - rows of P with a zero gain are left alone
+// SerialUpdate() is kept as the reference.
+// ************************************************
+
+__attribute__((always_inline))
+static inline void SerialUpdateBatchedN(const int8_t numx, float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+                                        float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+                                        uint16_t SensorsUsed)
+{
+    float HP[NUMV][NUMX];
+    float Km[NUMX];
+    int8_t g, i, j, k, l, m;
+
+    for (g = 0; g < NUMVGROUPS; g++) {
+        const uint16_t groupMask = ((1 << VgroupStart[g + 1]) - 1) & ~((1 << VgroupStart[g]) - 1);
+        if (!(SensorsUsed & groupMask)) {
+            continue;
+        }
+
+        for (m = VgroupStart[g]; m < VgroupStart[g + 1]; m++) { // Find Hp = H*P for the group
+            if (SensorsUsed & (0x01 << m)) {
+                for (j = 0; j < numx; j++) {
+                    HP[m][j] = 0;
+                    for (k = HrowMin[m]; k <= HrowMax[m]; k++) {
+                        HP[m][j] += H[m][k] * P[k][j];
+                    }
+                }
+            }
+        }
+
+        for (m = VgroupStart[g]; m < VgroupStart[g + 1]; m++) {
+            if (!(SensorsUsed & (0x01 << m))) {
+                continue;
+            }
+            const float *HPm = HP[m];
+            float HPHR = R[m]; // Find  HPHR = H*P*H' + R
+            for (k = HrowMin[m]; k <= HrowMax[m]; k++) {
+                HPHR += HPm[k] * H[m][k];
+            }
+            const float invHPHR = 1.0f / HPHR;
+
+            const float Error = Z[m] - Y[m];
+            for (k = 0; k < numx; k++) {
+                Km[k] = HPm[k] * invHPHR; // find K = HP/HPHR
+                X[k] += Km[k] * Error; // Find X(m)= X(m-1) + K*Error
+            }
+
+            for (i = 0; i < numx; i++) { // Find P(m)= P(m-1) - K*HP, upper triangle
+                const float Ki = Km[i];
+                if (fabsf(Ki) < FLT_MIN) { // structurally zero gain, the row is left as is
+                    continue;
+                }
+                for (j = i; j < numx; j++) {
+                    P[i][j] -= Ki * HPm[j];
+                }
+            }
+
+            for (l = m + 1; l < VgroupStart[g + 1]; l++) { // H*P of the next scalars against the new P
+                if (!(SensorsUsed & (0x01 << l))) {
+                    continue;
+                }
+                float HK = 0.0f;
+                for (k = HrowMin[l]; k <= HrowMax[l]; k++) {
+                    HK += H[l][k] * Km[k];
+                }
+                for (j = 0; j < numx; j++) {
+                    HP[l][j] -= HK * HPm[j];
+                }
+            }
+        }
+
+        for (i = 1; i < numx; i++) {
+            for (j = 0; j < i; j++) {
+                P[i][j] = P[j][i];
+            }
+        }
+    }
+}
+
+SPECIALIZE(SerialUpdateBatched,
+           (float H[NUMV][NUMX], float R[NUMV], float Z[NUMV], float Y[NUMV], float P[NUMX][NUMX], float X[NUMX], uint16_t SensorsUsed),
+           (H, R, Z, Y, P, X, SensorsUsed))
+
+void SerialUpdateBatched(int8_t numx, float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+                         float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+                         uint16_t SensorsUsed)
+{
+    if (numx > XABIAS) {
+        SerialUpdateBatched16(H, R, Z, Y, P, X, SensorsUsed);
+    } else {
+        SerialUpdateBatched13(H, R, Z, Y, P, X, SensorsUsed);
+    }
+}
+
+// *************  UD factorization ****************
+// With the UD factorization P = U*D*U', U unit upper triangular and D diagonal,
+// P is never formed, so it stays symmetric and positive semi definite however
+// the rounding goes. That is what lets the filter run at high prediction rates
+// in single precision. The factors are kept in the storage of P: D on the
+// diagonal, U above it, its unit diagonal implied, the lower triangle unused.
+// A diagonal P is its own UD factorization.
+// UDDecompose() and UDCompose() go from one form to the other in place.
+// Algorithm - see Bierman, "Factorization Methods for Discrete Sequential
+// Estimation", 1977, and Grewal and Andrews, "Kalman Filtering, 2nd Ed" p.230
+// ************************************************
+
+void UDDecompose(int8_t numx, float P[NUMX][NUMX])
+{
+    int8_t i, j, k;
+
+    for (j = numx - 1; j >= 0; j--) {
+        float d = P[j][j];
+        for (k = j + 1; k < numx; k++) {
+            d -= P[k][k] * P[j][k] * P[j][k];
+        }
+        P[j][j] = d;
+
+        // a zero variance leaves the column of U free, keep it zero
+        const float invd = (d > 0.0f) ? 1.0f / d : 0.0f;
+        for (i = 0; i < j; i++) {
+            float u = P[i][j];
+            for (k = j + 1; k < numx; k++) {
+                u -= P[k][k] * P[i][k] * P[j][k];
+            }
+            P[i][j] = u * invd;
+        }
+    }
+}
+
+void UDCompose(int8_t numx, float P[NUMX][NUMX])
+{
+    int8_t i, j, k;
+
+    // P[i][j] only needs the factors in columns j and above, rows i and below
+    for (i = 0; i < numx; i++) {
+        for (j = i; j < numx; j++) {
+            float p = P[j][j] * ((i == j) ? 1.0f : P[i][j]);
+            for (k = j + 1; k < numx; k++) {
+                p += P[i][k] * P[k][k] * P[j][k];
+            }
+            P[i][j] = p;
+        }
+    }
+    for (i = 1; i < numx; i++) {
+        for (j = 0; j < i; j++) {
+            P[i][j] = P[j][i];
+        }
+    }
+}
+
+// *************  UDCovariancePrediction **********
+// Pnew = A*P*A' + T^2*G*Q*G' on the factors, A = I+F*T. Pnew = W*Dw*W' with
+// W = [A*U | G] and Dw = diag(D, T^2*Q), the modified weighted Gram-Schmidt
+// orthogonalization of the rows of W gives the new U and D (Thornton). A*U
+// uses the block structure of A, see CovariancePredictionSparse().
+// UDCovariancePredictionTransition() does the same with Phi for A, as
+// CovariancePredictionTransition().
+// ************************************************
+
+__attribute__((always_inline))
+static inline void UDGramSchmidtN(const int8_t numx, float W[NUMX][NUMX + NUMW], float Dw[NUMX + NUMW],
+                                  float UD[NUMX][NUMX])
+{
+    const int8_t numw = numx - 4; // 9 noise inputs with 13 states, 12 with 16
+    const int8_t numc = numx + numw;
+    float DwWj[NUMX + NUMW];
+    int8_t i, j, k;
+
+    for (j = numx - 1; j >= 0; j--) {
+        const float *Wj = W[j];
+        float d = 0.0f;
+        for (k = 0; k < numc; k++) {
+            DwWj[k] = Dw[k] * Wj[k];
+            d += Wj[k] * DwWj[k];
+        }
+        UD[j][j] = d;
+
+        const float invd = (d > 0.0f) ? 1.0f / d : 0.0f;
+        for (i = 0; i < j; i++) {
+            float *Wi = W[i];
+            float u   = 0.0f;
+            for (k = 0; k < numc; k++) {
+                u += Wi[k] * DwWj[k];
+            }
+            u *= invd;
+            UD[i][j] = u;
+            for (k = 0; k < numc; k++) {
+                Wi[k] -= u * Wj[k];
+            }
+        }
+    }
+}
+
+// W = [U | G] and Dw = diag(D, dTsq*Q), the transition still to be applied to U
+__attribute__((always_inline))
+static inline void UDNoiseColumnsN(const int8_t numx, float G[NUMX][NUMW], float Q[NUMW], float dTsq,
+                                   float UD[NUMX][NUMX], float W[NUMX][NUMX + NUMW], float Dw[NUMX + NUMW])
+{
+    const int8_t numw = numx - 4;
+    int8_t i, j;
+
+    for (i = 0; i < numx; i++) {
+        for (j = 0; j < numx; j++) {
+            W[i][j] = (j > i) ? UD[i][j] : ((j == i) ? 1.0f : 0.0f);
+        }
+        for (j = 0; j < numw; j++) {
+            W[i][numx + j] = G[i][j];
+        }
+        Dw[i] = UD[i][i];
+    }
+    for (j = 0; j < numw; j++) {
+        Dw[numx + j] = dTsq * Q[j];
+    }
+}
+
+__attribute__((always_inline))
+static inline void UDCovariancePredictionN(const int8_t numx, float F[NUMX][NUMX], float G[NUMX][NUMW],
+                                           float Q[NUMW], float dT, float UD[NUMX][NUMX])
+{
+    float W[NUMX][NUMX + NUMW];
+    float Dw[NUMX + NUMW];
+    float Wq[4][NUMX]; // A*U of the quaternion rows, they depend on each other
+    int8_t i, j;
+
+    UDNoiseColumnsN(numx, G, Q, dT * dT, UD, W, Dw);
+
+    // A*U in place, each block only reads rows below it or saves them first
+    for (j = 0; j < numx; j++) {
+        for (i = 0; i < 3; i++) {
+            W[i][j] += dT * W[i + 3][j];
+        }
+        for (i = 3; i < 6; i++) {
+            float d = F[i][6] * W[6][j] + F[i][7] * W[7][j] + F[i][8] * W[8][j] + F[i][9] * W[9][j];
+            if (numx > XABIAS) {
+                d += F[i][13] * W[13][j] + F[i][14] * W[14][j] + F[i][15] * W[15][j];
+            }
+            W[i][j] += dT * d;
+        }
+        for (i = 6; i < 10; i++) {
+            Wq[i - 6][j] = W[i][j] + dT * (F[i][6] * W[6][j] + F[i][7] * W[7][j] + F[i][8] * W[8][j] + F[i][9] * W[9][j] +
+                                           F[i][10] * W[10][j] + F[i][11] * W[11][j] + F[i][12] * W[12][j]);
+        }
+        for (i = 6; i < 10; i++) {
+            W[i][j] = Wq[i - 6][j];
+        }
+    }
+
+    UDGramSchmidtN(numx, W, Dw, UD);
+}
+
+SPECIALIZE(UDCovariancePrediction,
+           (float F[NUMX][NUMX], float G[NUMX][NUMW], float Q[NUMW], float dT, float UD[NUMX][NUMX]),
+           (F, G, Q, dT, UD))
+
+void UDCovariancePrediction(int8_t numx, float F[NUMX][NUMX], float G[NUMX][NUMW],
+                            float Q[NUMW], float dT, float UD[NUMX][NUMX])
+{
+    if (numx > XABIAS) {
+        UDCovariancePrediction16(F, G, Q, dT, UD);
+    } else {
+        UDCovariancePrediction13(F, G, Q, dT, UD);
+    }
+}
+
+__attribute__((always_inline))
+static inline void UDCovariancePredictionTransitionN(const int8_t numx, float Phi[NUMX][NUMX], float G[NUMX][NUMW],
+                                                     float Q[NUMW], float dTsq, float UD[NUMX][NUMX])
+{
+    float W[NUMX][NUMX + NUMW];
+    float Dw[NUMX + NUMW];
+    float Uj[NUMX];
+    int8_t i, j, k;
+
+    UDNoiseColumnsN(numx, G, Q, dTsq, UD, W, Dw);
+
+    // Phi*U a column at a time, column j of U is zero below row j
+    for (j = 0; j < numx; j++) {
+        for (k = 0; k <= j; k++) {
+            Uj[k] = W[k][j];
+        }
+        for (i = 0; i < numx; i++) {
+            float w = 0.0f;
+            for (k = 0; k <= j; k++) {
+                w += Phi[i][k] * Uj[k];
+            }
+            W[i][j] = w;
+        }
+    }
+
+    UDGramSchmidtN(numx, W, Dw, UD);
+}
+
+SPECIALIZE(UDCovariancePredictionTransition,
+           (float Phi[NUMX][NUMX], float G[NUMX][NUMW], float Q[NUMW], float dTsq, float UD[NUMX][NUMX]),
+           (Phi, G, Q, dTsq, UD))
+
+void UDCovariancePredictionTransition(int8_t numx, float Phi[NUMX][NUMX], float G[NUMX][NUMW],
+                                      float Q[NUMW], float dTsq, float UD[NUMX][NUMX])
+{
+    if (numx > XABIAS) {
+        UDCovariancePredictionTransition16(Phi, G, Q, dTsq, UD);
+    } else {
+        UDCovariancePredictionTransition13(Phi, G, Q, dTsq, UD);
+    }
+}
+
+// *************  UDSerialUpdate *****************
+// SerialUpdate() on the factors, one scalar measurement at a time with
+// Bierman's update. For measurement m, f = U'*H_m and v = D*f, then column by
+// column D and U are corrected while the gain K = P*H_m' is accumulated.
+// f is zero in the columns before the first non zero H_m, those are skipped.
+// ************************************************
+
+__attribute__((always_inline))
+static inline void UDSerialUpdateN(const int8_t numx, float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+                                   float Y[NUMV], float UD[NUMX][NUMX], float X[NUMX],
+                                   uint16_t SensorsUsed)
+{
+    float f[NUMX];
+    float K[NUMX];
+    int8_t i, j, k, m;
+
+    for (m = 0; m < NUMV; m++) {
+        if (!(SensorsUsed & (0x01 << m))) {
+            continue;
+        }
+        const int8_t Hstart = HrowMin[m];
+        const int8_t Hend   = HrowMax[m];
+
+        for (j = Hstart; j < numx; j++) { // Find f = U'*H, U has a unit diagonal
+            float fj = (j <= Hend) ? H[m][j] : 0.0f;
+            for (k = Hstart; k <= MIN(Hend, j - 1); k++) {
+                fj += H[m][k] * UD[k][j];
+            }
+            f[j] = fj;
+        }
+        for (j = 0; j < Hstart; j++) {
+            K[j] = 0.0f;
+        }
+
+        float alpha = R[m]; // becomes H*P*H' + R
+        for (j = Hstart; j < numx; j++) {
+            const float fj     = f[j];
+            const float vj     = UD[j][j] * fj;
+            const float beta   = alpha;
+            alpha += fj * vj;
+            const float lambda = -fj / beta;
+            UD[j][j] *= beta / alpha;
+            for (i = 0; i < j; i++) {
+                const float u = UD[i][j];
+                UD[i][j] = u + lambda * K[i];
+                K[i]    += vj * u;
+            }
+            K[j] = vj;
+        }
+
+        const float Error = (Z[m] - Y[m]) / alpha;
+        for (i = 0; i < numx; i++) { // Find X(m)= X(m-1) + K*Error
+            X[i] += K[i] * Error;
+        }
+    }
+}
+
+SPECIALIZE(UDSerialUpdate,
+           (float H[NUMV][NUMX], float R[NUMV], float Z[NUMV], float Y[NUMV], float UD[NUMX][NUMX], float X[NUMX], uint16_t SensorsUsed),
+           (H, R, Z, Y, UD, X, SensorsUsed))
+
+void UDSerialUpdate(int8_t numx, float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+                    float Y[NUMV], float UD[NUMX][NUMX], float X[NUMX],
+                    uint16_t SensorsUsed)
+{
+    if (numx > XABIAS) {
+        UDSerialUpdate16(H, R, Z, Y, UD, X, SensorsUsed);
+    } else {
+        UDSerialUpdate13(H, R, Z, Y, UD, X, SensorsUsed);
+    }
+}
+
+// *************  RungeKutta **********************
+// Does a 4th order Runge Kutta numerical integration step
+// Output, Xnew, is written over X
+// NOTE the algorithm assumes time invariant state equations and
+// constant inputs over integration step
+// ************************************************
+
+void RungeKutta(int8_t numx, float X[NUMX], float U[NUMU], float dT)
+{
+    float dT2 =
+        dT / 2.0f, K1[NUMX], K2[NUMX], K3[NUMX], K4[NUMX], Xlast[NUMX];
+    int8_t i;
+
+    for (i = 0; i < numx; i++) {
+        Xlast[i] = X[i]; // make a working copy
+    }
+    StateEq(X, U, K1); // k1 = f(x,u)
+    for (i = 0; i < numx; i++) {
+        X[i] = Xlast[i] + dT2 * K1[i];
+    }
+    StateEq(X, U, K2); // k2 = f(x+0.5*dT*k1,u)
+    for (i = 0; i < numx; i++) {
+        X[i] = Xlast[i] + dT2 * K2[i];
+    }
+    StateEq(X, U, K3); // k3 = f(x+0.5*dT*k2,u)
+    for (i = 0; i < numx; i++) {
+        X[i] = Xlast[i] + dT * K3[i];
+    }
+    StateEq(X, U, K4); // k4 = f(x+dT*k3,u)
+
+    // Xnew  = X + dT*(k1+2*k2+2*k3+k4)/6
+    for (i = 0; i < numx; i++) {
+        X[i] =
+            Xlast[i] + dT * (K1[i] + 2.0f * K2[i] + 2.0f * K3[i] +
+                             K4[i]) / 6.0f;
+    }
+}
+
+// *************  Model Specific Stuff  ***************************
+// ***  StateEq, MeasurementEq, LinerizeFG, and LinearizeH ********
+//
+// State Variables = [Pos Vel Quaternion GyroBias AccelBias]
+// Deterministic Inputs = [AngularVel Accel]
+// Disturbance Noise = [GyroNoise AccelNoise GyroRandomWalkNoise AccelRandomWalkNoise]
+//
+// Measurement Variables = [Pos Vel BodyFrameMagField Altimeter]
+// Inputs to Measurement = [EarthFrameMagField]
+//
+// Notes: Pos and Vel in earth frame
+// AngularVel and Accel in body frame
+// MagFields are unit vectors
+// Xdot is output of StateEq()
+// F and G are outputs of LinearizeFG(), all elements not set should be zero
+// The accel bias states are always modelled, the 13 state filter keeps them
+// at zero and no kernel reads their rows or columns
+// y is output of OutputEq()
+// H is output of LinearizeH(), all elements not set should be zero
+// ************************************************
+
+void StateEq(float X[NUMX], float U[NUMU], float Xdot[NUMX])
+{
+    float ax, ay, az, wx, wy, wz, q0, q1, q2, q3;
+
+    ax = U[3] - X[13];
+    ay = U[4] - X[14];
+    az = U[5] - X[15]; // subtract the biases on accels
+    wx = U[0] - X[10];
+    wy = U[1] - X[11];
+    wz = U[2] - X[12]; // subtract the biases on gyros
+    q0 = X[6];
+    q1 = X[7];
+    q2 = X[8];
+    q3 = X[9];
+
+    // Pdot = V
+    Xdot[0] = X[3];
+    Xdot[1] = X[4];
+    Xdot[2] = X[5];
+
+    // Vdot = Reb*a
+    Xdot[3] =
+        (q0 * q0 + q1 * q1 - q2 * q2 - q3 * q3) * ax + 2.0f * (q1 * q2 -
+                                                               q0 * q3) *
+        ay + 2.0f * (q1 * q3 + q0 * q2) * az;
+    Xdot[4] =
+        2.0f * (q1 * q2 + q0 * q3) * ax + (q0 * q0 - q1 * q1 + q2 * q2 -
+                                           q3 * q3) * ay + 2 * (q2 * q3 -
+                                                                q0 * q1) *
+        az;
+    Xdot[5] =
+        2.0f * (q1 * q3 - q0 * q2) * ax + 2 * (q2 * q3 + q0 * q1) * ay +
+        (q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3) * az + 9.81f;
+
+    // qdot = Q*w
+    Xdot[6]  = (-q1 * wx - q2 * wy - q3 * wz) / 2.0f;
+    Xdot[7]  = (q0 * wx - q3 * wy + q2 * wz) / 2.0f;
+    Xdot[8]  = (q3 * wx + q0 * wy - q1 * wz) / 2.0f;
+    Xdot[9]  = (-q2 * wx + q1 * wy + q0 * wz) / 2.0f;
+
+    // best guess is that bias stays constant
+    Xdot[10] = Xdot[11] = Xdot[12] = 0;
+    Xdot[13] = Xdot[14] = Xdot[15] = 0;
+}
+
+void LinearizeFG(float X[NUMX], float U[NUMU], float F[NUMX][NUMX],
+                 float G[NUMX][NUMW])
+{
+    float ax, ay, az, wx, wy, wz, q0, q1, q2, q3;
+
+    ax = U[3] - X[13];
+    ay = U[4] - X[14];
+    az = U[5] - X[15]; // subtract the biases on accels
+    wx = U[0] - X[10];
+    wy = U[1] - X[11];
+    wz = U[2] - X[12]; // subtract the biases on gyros
+    q0 = X[6];
+    q1 = X[7];
+    q2 = X[8];
+    q3 = X[9];
+
+    // Pdot = V
+    F[0][3] = F[1][4] = F[2][5] = 1.0f;
+
+    // dVdot/dq
+    F[3][6] = 2.0f * (q0 * ax - q3 * ay + q2 * az);
+    F[3][7] = 2.0f * (q1 * ax + q2 * ay + q3 * az);
+    F[3][8] = 2.0f * (-q2 * ax + q1 * ay + q0 * az);
+    F[3][9] = 2.0f * (-q3 * ax - q0 * ay + q1 * az);
+    F[4][6] = 2.0f * (q3 * ax + q0 * ay - q1 * az);
+    F[4][7] = 2.0f * (q2 * ax - q1 * ay - q0 * az);
+    F[4][8] = 2.0f * (q1 * ax + q2 * ay + q3 * az);
+    F[4][9] = 2.0f * (q0 * ax - q3 * ay + q2 * az);
+    F[5][6] = 2.0f * (-q2 * ax + q1 * ay + q0 * az);
+    F[5][7] = 2.0f * (q3 * ax + q0 * ay - q1 * az);
+    F[5][8] = 2.0f * (-q0 * ax + q3 * ay - q2 * az);
+    F[5][9] = 2.0f * (q1 * ax + q2 * ay + q3 * az);
+
+    // dqdot/dq
+    F[6][6]  = 0;
+    F[6][7]  = -wx / 2.0f;
+    F[6][8]  = -wy / 2.0f;
+    F[6][9]  = -wz / 2.0f;
+    F[7][6]  = wx / 2.0f;
+    F[7][7]  = 0;
+    F[7][8]  = wz / 2.0f;
+    F[7][9]  = -wy / 2.0f;
+    F[8][6]  = wy / 2.0f;
+    F[8][7]  = -wz / 2.0f;
+    F[8][8]  = 0;
+    F[8][9]  = wx / 2.0f;
+    F[9][6]  = wz / 2.0f;
+    F[9][7]  = wy / 2.0f;
+    F[9][8]  = -wx / 2.0f;
+    F[9][9]  = 0;
+
+    // dqdot/dwbias
+    F[6][10] = q1 / 2.0f;
+    F[6][11] = q2 / 2.0f;
+    F[6][12] = q3 / 2.0f;
+    F[7][10] = -q0 / 2.0f;
+    F[7][11] = q3 / 2.0f;
+    F[7][12] = -q2 / 2.0f;
+    F[8][10] = -q3 / 2.0f;
+    F[8][11] = -q0 / 2.0f;
+    F[8][12] = q1 / 2.0f;
+    F[9][10] = q2 / 2.0f;
+    F[9][11] = -q1 / 2.0f;
+    F[9][12] = -q0 / 2.0f;
+
+    // dVdot/dna
+    G[3][3]  = -q0 * q0 - q1 * q1 + q2 * q2 + q3 * q3;
+    G[3][4]  = 2.0f * (-q1 * q2 + q0 * q3);
+    G[3][5]  = -2.0f * (q1 * q3 + q0 * q2);
+    G[4][3]  = -2.0f * (q1 * q2 + q0 * q3);
+    G[4][4]  = -q0 * q0 + q1 * q1 - q2 * q2 + q3 * q3;
+    G[4][5]  = 2.0f * (-q2 * q3 + q0 * q1);
+    G[5][3]  = 2.0f * (-q1 * q3 + q0 * q2);
+    G[5][4]  = -2.0f * (q2 * q3 + q0 * q1);
+    G[5][5]  = -q0 * q0 + q1 * q1 + q2 * q2 - q3 * q3;
+
+    // dVdot/dabias, same as dVdot/dna
+    F[3][13] = G[3][3];
+    F[3][14] = G[3][4];
+    F[3][15] = G[3][5];
+    F[4][13] = G[4][3];
+    F[4][14] = G[4][4];
+    F[4][15] = G[4][5];
+    F[5][13] = G[5][3];
+    F[5][14] = G[5][4];
+    F[5][15] = G[5][5];
+
+    // dqdot/dnw
+    G[6][0]  = q1 / 2.0f;
+    G[6][1]  = q2 / 2.0f;
+    G[6][2]  = q3 / 2.0f;
+    G[7][0]  = -q0 / 2.0f;
+    G[7][1]  = q3 / 2.0f;
+    G[7][2]  = -q2 / 2.0f;
+    G[8][0]  = -q3 / 2.0f;
+    G[8][1]  = -q0 / 2.0f;
+    G[8][2]  = q1 / 2.0f;
+    G[9][0]  = q2 / 2.0f;
+    G[9][1]  = -q1 / 2.0f;
+    G[9][2]  = -q0 / 2.0f;
+
+    // dwbias = random walk noise
+    G[10][6] = G[11][7] = G[12][8] = 1.0f;
+    // dabias = random walk noise
+    G[13][9] = G[14][10] = G[15][11] = 1.0f;
+}
+
+void MeasurementEq(float X[NUMX], float Be[3], float Y[NUMV])
+{
+    float q0, q1, q2, q3;
+
+    q0   = X[6];
+    q1   = X[7];
+    q2   = X[8];
+    q3   = X[9];
+
+    // first six outputs are P and V
+    Y[0] = X[0];
+    Y[1] = X[1];
+    Y[2] = X[2];
+    Y[3] = X[3];
+    Y[4] = X[4];
+    Y[5] = X[5];
+
+    // Bb=Rbe*Be
+    Y[6] =
+        (q0 * q0 + q1 * q1 - q2 * q2 - q3 * q3) * Be[0] +
+        2.0f * (q1 * q2 + q0 * q3) * Be[1] + 2.0f * (q1 * q3 -
+                                                     q0 * q2) * Be[2];
+    Y[7] =
+        2.0f * (q1 * q2 - q0 * q3) * Be[0] + (q0 * q0 - q1 * q1 +
+                                              q2 * q2 - q3 * q3) * Be[1] +
+        2.0f * (q2 * q3 + q0 * q1) * Be[2];
+    Y[8] =
+        2.0f * (q1 * q3 + q0 * q2) * Be[0] + 2.0f * (q2 * q3 -
+                                                     q0 * q1) * Be[1] +
+        (q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3) * Be[2];
+
+    // Alt = -Pz
+    Y[9] = -1.0f * X[2];
+}
+
+void LinearizeH(float X[NUMX], float Be[3], float H[NUMV][NUMX])
+{
+    float q0, q1, q2, q3;
+
+    q0 = X[6];
+    q1 = X[7];
+    q2 = X[8];
+    q3 = X[9];
+
+    // dP/dP=I;
+    H[0][0] = H[1][1] = H[2][2] = 1.0f;
+    // dV/dV=I;
+    H[3][3] = H[4][4] = H[5][5] = 1.0f;
+
+    // dBb/dq
+    H[6][6] = 2.0f * (q0 * Be[0] + q3 * Be[1] - q2 * Be[2]);
+    H[6][7] = 2.0f * (q1 * Be[0] + q2 * Be[1] + q3 * Be[2]);
+    H[6][8] = 2.0f * (-q2 * Be[0] + q1 * Be[1] - q0 * Be[2]);
+    H[6][9] = 2.0f * (-q3 * Be[0] + q0 * Be[1] + q1 * Be[2]);
+    H[7][6] = 2.0f * (-q3 * Be[0] + q0 * Be[1] + q1 * Be[2]);
+    H[7][7] = 2.0f * (q2 * Be[0] - q1 * Be[1] + q0 * Be[2]);
+    H[7][8] = 2.0f * (q1 * Be[0] + q2 * Be[1] + q3 * Be[2]);
+    H[7][9] = 2.0f * (-q0 * Be[0] - q3 * Be[1] + q2 * Be[2]);
+    H[8][6] = 2.0f * (q2 * Be[0] - q1 * Be[1] + q0 * Be[2]);
+    H[8][7] = 2.0f * (q3 * Be[0] - q0 * Be[1] - q1 * Be[2]);
+    H[8][8] = 2.0f * (q0 * Be[0] + q3 * Be[1] - q2 * Be[2]);
+    H[8][9] = 2.0f * (q1 * Be[0] + q2 * Be[1] + q3 * Be[2]);
+
+    // dAlt/dPz = -1
+    H[9][2] = -1.0f;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -267,7 +267,7 @@ void ins_init_algorithm()
     float ge[3] = { 0, 0, -9.81 }, zeros[3] = { 0, 0, 0 }, Pdiag[16] = { 25, 25, 25, 5, 5, 5, 1e-5, 1e-5, 1e-5, 1e-5, 1e-5, 1e-5, 1e-5, 1e-4, 1e-4, 1e-4 };
     bool using_mags, using_gps;
 
-    INSGPSInit();
+    INSGPSInit(INSGPS_13STATE);
 
     HomeLocationData home;
     HomeLocationGet(&home);
@@ -27,15 +27,41 @@
 #include <openpilot.h>
 #include <instrumentation.h>
 #include <pios_instrumentation.h>
+#include <perfprofile.h>
+#include <perftrace.h>
+#include <perftracecontrol.h>
+
+// events sent per PerfTrace update
+#define TRACE_CHUNK_EVENTS PERFTRACE_ID_NUMELEM
+
+// unit of the trace timestamps, the cycle counter on target
+#if defined(ARCH_POSIX) || defined(ARCH_WIN32)
+#define TRACE_CLOCK_RATE   1000000
+#else
+#define TRACE_CLOCK_RATE   PIOS_SYSCLK
+#endif
 
 static uint8_t publishedCountersInstances = 0;
+static uint8_t publishedProfilesInstances = 0;
 static void counterCallback(const pios_perf_counter_t *counter, const int8_t index, void *context);
+static void publishProfiles();
+static void traceControlUpdatedCb(UAVObjEvent *ev);
+static void sendTraceChunk(uint16_t chunk);
 static xSemaphoreHandle sem;
+static PerfTraceData *trace; // would be better on stack but event dispatcher stack might be insufficient
 void InstrumentationInit()
 {
     PerfCounterInitialize();
+    PerfProfileInitialize();
+    PerfTraceInitialize();
+    PerfTraceControlInitialize();
     publishedCountersInstances = 1;
+    publishedProfilesInstances = 1;
     vSemaphoreCreateBinary(sem);
+    trace = pios_malloc(sizeof(PerfTraceData));
+    if (trace) {
+        PerfTraceControlConnectCallback(traceControlUpdatedCb);
+    }
 }
 
 void InstrumentationPublishAllCounters()
@@ -44,9 +70,80 @@ void InstrumentationPublishAllCounters()
         return;
     }
     PIOS_Instrumentation_ForEachCounter(&counterCallback, NULL);
+    publishProfiles();
     xSemaphoreGive(sem);
 }
 
+/**
+ * Publish the statistics of the profiles over the last period, and start a new one
+ */
+static void publishProfiles()
+{
+    struct pios_perf_profile_stats stats;
+    PerfProfileData data;
+
+    for (int8_t index = 0; index < PIOS_Instrumentation_GetNumProfiles(); index++) {
+        if (publishedProfilesInstances < index + 1) {
+            if (PerfProfileCreateInstance() == 0) {
+                return; // out of memory
+            }
+            publishedProfilesInstances++;
+        }
+        PIOS_Instrumentation_GetProfileStats(index, &stats, true);
+        data.Id    = stats.id;
+        data.Count = stats.count;
+        data.Cycles.Min     = stats.min;
+        data.Cycles.Max     = stats.max;
+        data.Cycles.Average = stats.average;
+        data.Cycles.P50     = stats.p50;
+        data.Cycles.P90     = stats.p90;
+        data.Cycles.P99     = stats.p99;
+        PerfProfileInstSet(index, &data);
+    }
+}
+
+static void traceControlUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    PerfTraceControlData control;
+
+    PerfTraceControlGet(&control);
+    switch (control.Operation) {
+    case PERFTRACECONTROL_OPERATION_CAPTURE:
+        PIOS_Instrumentation_TraceFreeze(true);
+        sendTraceChunk(0);
+        break;
+    case PERFTRACECONTROL_OPERATION_RETRIEVE:
+        sendTraceChunk(control.Chunk);
+        break;
+    case PERFTRACECONTROL_OPERATION_RESUME:
+        PIOS_Instrumentation_TraceFreeze(false);
+        break;
+    default:
+        break;
+    }
+}
+
+static void sendTraceChunk(uint16_t chunk)
+{
+    struct pios_trace_event event;
+
+    memset(trace, 0, sizeof(PerfTraceData));
+    trace->Chunk     = chunk;
+    trace->Events    = PIOS_Instrumentation_TraceCount();
+    trace->ClockRate = TRACE_CLOCK_RATE;
+    // one event at a time, to keep the event dispatcher stack small
+    for (uint16_t i = 0; i < TRACE_CHUNK_EVENTS; i++) {
+        if (PIOS_Instrumentation_TraceRead(chunk * TRACE_CHUNK_EVENTS + i, &event, 1) == 0) {
+            break;
+        }
+        trace->Timestamp[i] = event.timestamp;
+        trace->Id[i]   = event.id;
+        trace->Type[i] = event.type;
+        trace->Task[i] = event.task;
+    }
+    PerfTraceSet(trace);
+}
+
 void counterCallback(const pios_perf_counter_t *counter, const int8_t index, __attribute__((unused)) void *context)
 {
     if (publishedCountersInstances < index + 1) {
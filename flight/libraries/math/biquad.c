@@ -0,0 +1,188 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilot Math Utilities
+ * @{
+ * @addtogroup Biquad filter bank
+ * @{
+ *
+ * @file       biquad.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Biquad sections in direct form 2 transposed, low pass cascades and notches
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "openpilot.h"
+#include "math.h"
+#include "biquad.h"
+#include <pios_math.h>
+
+/**
+ * Initialize a second order low pass section (bilinear transform, prewarped).
+ * The state is cleared.
+ * @param[out] f Filter to set up
+ * @param[in] ff Cut-off frequency ratio, cut-off frequency / sample rate, below 0.5
+ * @param[in] q Quality factor, 1/sqrt(2) gives a Butterworth section
+ * @returns Nothing
+ */
+void biquad_init_lowpass(struct biquad *f, const float ff, const float q)
+{
+    const float omega = 2.0f * M_PI_F * ff;
+    const float cs    = cosf(omega);
+    const float alpha = sinf(omega) / (2.0f * q);
+    const float a0inv = 1.0f / (1.0f + alpha);
+
+    f->b0 = (1.0f - cs) * 0.5f * a0inv;
+    f->b1 = (1.0f - cs) * a0inv;
+    f->b2 = f->b0;
+    f->a1 = -2.0f * cs * a0inv;
+    f->a2 = (1.0f - alpha) * a0inv;
+    f->z1 = 0.0f;
+    f->z2 = 0.0f;
+}
+
+/**
+ * Initialize a notch section. The state is cleared.
+ * @param[out] f Filter to set up
+ * @param[in] ff Center frequency ratio, center frequency / sample rate, below 0.5
+ * @param[in] q Quality factor, center frequency / -3dB bandwidth
+ * @returns Nothing
+ */
+void biquad_init_notch(struct biquad *f, const float ff, const float q)
+{
+    biquad_update_notch(f, ff, q);
+    f->z1 = 0.0f;
+    f->z2 = 0.0f;
+}
+
+/**
+ * Move the center of a running notch section. Only the coefficients are
+ * touched, the state carries over so the output stays continuous while the
+ * center frequency is tracked.
+ * @param[in,out] f Filter set up by biquad_init_notch
+ * @param[in] ff Center frequency ratio, center frequency / sample rate, below 0.5
+ * @param[in] q Quality factor, center frequency / -3dB bandwidth
+ * @returns Nothing
+ */
+void biquad_update_notch(struct biquad *f, const float ff, const float q)
+{
+    const float omega = 2.0f * M_PI_F * ff;
+    const float alpha = sinf(omega) / (2.0f * q);
+    const float a0inv = 1.0f / (1.0f + alpha);
+
+    // numerator and denominator share b1 = a1 and the unit gain b0 = b2
+    f->b0 = a0inv;
+    f->b1 = -2.0f * cosf(omega) * a0inv;
+    f->b2 = a0inv;
+    f->a1 = f->b1;
+    f->a2 = (1.0f - alpha) * a0inv;
+}
+
+/**
+ * Set the state to the steady state for a constant input, avoids the step
+ * response when a filter is started on a signal with an offset.
+ * @param[in,out] f Filter to reset
+ * @param[in] x0 Prescribed value
+ * @returns Nothing
+ */
+void biquad_reset(struct biquad *f, const float x0)
+{
+    const float y0 = x0 * (f->b0 + f->b1 + f->b2) / (1.0f + f->a1 + f->a2);
+
+    f->z1 = y0 - f->b0 * x0;
+    f->z2 = f->b2 * x0 - f->a2 * y0;
+}
+
+/**
+ * Filter a block of consecutive samples. The coefficients and state stay in
+ * registers for the whole block. in and out may point to the same buffer.
+ * @param[in,out] f Filter coefficients and state
+ * @param[in] in Raw samples
+ * @param[out] out Filtered samples
+ * @param[in] count Number of samples
+ * @returns Nothing
+ */
+void biquad_apply_block(struct biquad *f, const float *in, float *out, uint16_t count)
+{
+    const float b0 = f->b0;
+    const float b1 = f->b1;
+    const float b2 = f->b2;
+    const float a1 = f->a1;
+    const float a2 = f->a2;
+    float z1 = f->z1;
+    float z2 = f->z2;
+
+    for (uint16_t n = 0; n < count; n++) {
+        const float x = in[n];
+        const float y = b0 * x + z1;
+        z1     = b1 * x - a1 * y + z2;
+        z2     = b2 * x - a2 * y;
+        out[n] = y;
+    }
+    f->z1 = z1;
+    f->z2 = z2;
+}
+
+/**
+ * Initialize a Butterworth low pass of the given order as a cascade of second
+ * order sections. Odd orders are rounded up. The state is cleared.
+ * @param[out] c Cascade to set up
+ * @param[in] ff Cut-off frequency ratio, cut-off frequency / sample rate, below 0.5
+ * @param[in] order Filter order, 2 to 2 * BIQUAD_MAX_STAGES
+ * @returns Number of sections used
+ */
+uint8_t biquad_cascade_init_lowpass(struct biquad_cascade *c, const float ff, const uint8_t order)
+{
+    uint8_t stages = (order + 1) / 2;
+
+    if (stages < 1) {
+        stages = 1;
+    } else if (stages > BIQUAD_MAX_STAGES) {
+        stages = BIQUAD_MAX_STAGES;
+    }
+    c->stages = stages;
+
+    // pole pairs of an even order Butterworth, Q = 1 / (2 cos(theta_k))
+    for (uint8_t n = 0; n < stages; n++) {
+        const float theta = M_PI_F * (float)(2 * n + 1) / (float)(4 * stages);
+        biquad_init_lowpass(&c->stage[n], ff, 0.5f / cosf(theta));
+    }
+    return stages;
+}
+
+/**
+ * Set all sections of a cascade to the steady state for a constant input
+ * @param[in,out] c Cascade to reset
+ * @param[in] x0 Prescribed value
+ * @returns Nothing
+ */
+void biquad_cascade_reset(struct biquad_cascade *c, const float x0)
+{
+    float x = x0;
+
+    for (uint8_t n = 0; n < c->stages; n++) {
+        biquad_reset(&c->stage[n], x);
+        x = x * (c->stage[n].b0 + c->stage[n].b1 + c->stage[n].b2) / (1.0f + c->stage[n].a1 + c->stage[n].a2);
+    }
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,100 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilot Math Utilities
+ * @{
+ * @addtogroup Biquad filter bank
+ * @{
+ *
+ * @file       biquad.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Biquad sections in direct form 2 transposed, low pass cascades and notches
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef BIQUAD_H
+#define BIQUAD_H
+
+#include <stdint.h>
+
+// Maximum number of second order sections in a cascade, i.e. up to 8th order
+#define BIQUAD_MAX_STAGES 4
+
+// Coefficients (a0 normalized to 1) and state of one second order section
+struct biquad {
+    float b0;
+    float b1;
+    float b2;
+    float a1;
+    float a2;
+    float z1;
+    float z2;
+};
+
+// Chain of second order sections applied one after the other
+struct biquad_cascade {
+    uint8_t stages;
+    struct biquad stage[BIQUAD_MAX_STAGES];
+};
+
+// Function declarations
+void biquad_init_lowpass(struct biquad *f, const float ff, const float q);
+void biquad_init_notch(struct biquad *f, const float ff, const float q);
+void biquad_update_notch(struct biquad *f, const float ff, const float q);
+void biquad_reset(struct biquad *f, const float x0);
+void biquad_apply_block(struct biquad *f, const float *in, float *out, uint16_t count);
+
+uint8_t biquad_cascade_init_lowpass(struct biquad_cascade *c, const float ff, const uint8_t order);
+void biquad_cascade_reset(struct biquad_cascade *c, const float x0);
+
+/**
+ * Filter one sample, direct form 2 transposed
+ * @param[in,out] f Filter coefficients and state
+ * @param[in] x New raw value
+ * @returns Filtered value
+ */
+static inline float biquad_apply(struct biquad *f, const float x)
+{
+    const float y = f->b0 * x + f->z1;
+
+    f->z1 = f->b1 * x - f->a1 * y + f->z2;
+    f->z2 = f->b2 * x - f->a2 * y;
+    return y;
+}
+
+/**
+ * Filter one sample through all sections of a cascade
+ * @param[in,out] c Cascade coefficients and state
+ * @param[in] x New raw value
+ * @returns Filtered value
+ */
+static inline float biquad_cascade_apply(struct biquad_cascade *c, float x)
+{
+    for (uint8_t n = 0; n < c->stages; n++) {
+        x = biquad_apply(&c->stage[n], x);
+    }
+    return x;
+}
+
+#endif /* BIQUAD_H */
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,168 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilot Math Utilities
+ * @{
+ * @addtogroup Fixed point quaternion math
+ * @{
+ *
+ * @file       fixed_quat.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Q2.30 quaternion math for the attitude filter on targets without FPU
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "fixed_quat.h"
+
+// vectors shorter than this can not be normalized (about 1e-3)
+#define FIX16_MIN_NORM (FIX16_ONE >> 10)
+#define FIX30_MIN_NORM (FIX30_ONE >> 10)
+
+/**
+ * Integer square root, rounded down
+ * @param[in] x value
+ * @returns floor(sqrt(x))
+ */
+uint32_t fix_isqrt64(uint64_t x)
+{
+    uint64_t result = 0;
+    uint64_t bit    = (uint64_t)1 << 62;
+
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (x >= result + bit) {
+            x     -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)result;
+}
+
+/**
+ * First order quaternion integration, q = q + 0.5 * q x (0, w * dT).
+ * Keeps q[0] positive.
+ * @param[in,out] q attitude quaternion
+ * @param[in] half_dtheta body rotation in the step, w * dT / 2 in radians
+ */
+void fixquat_integrate(fix30_t q[4], const fix30_t half_dtheta[3])
+{
+    const int64_t h0 = half_dtheta[0], h1 = half_dtheta[1], h2 = half_dtheta[2];
+    fix30_t qdot[4];
+
+    qdot[0] = (fix30_t)((-q[1] * h0 - q[2] * h1 - q[3] * h2) >> 30);
+    qdot[1] = (fix30_t)((q[0] * h0 - q[3] * h1 + q[2] * h2) >> 30);
+    qdot[2] = (fix30_t)((q[3] * h0 + q[0] * h1 - q[1] * h2) >> 30);
+    qdot[3] = (fix30_t)((-q[2] * h0 + q[1] * h1 + q[0] * h2) >> 30);
+
+    q[0] += qdot[0];
+    q[1] += qdot[1];
+    q[2] += qdot[2];
+    q[3] += qdot[3];
+
+    if (q[0] < 0) {
+        q[0] = -q[0];
+        q[1] = -q[1];
+        q[2] = -q[2];
+        q[3] = -q[3];
+    }
+}
+
+/**
+ * Renormalize a quaternion that drifted slightly from unit length, using
+ * Newton steps on 1/sqrt(|q|^2) so no division is needed.
+ * @param[in,out] q quaternion
+ * @returns 0 if successful, -1 if q is too far from unit length to recover
+ */
+int32_t fixquat_normalize(fix30_t q[4])
+{
+    for (uint8_t n = 0; n < 4; n++) {
+        const int64_t norm = ((int64_t)q[0] * q[0] + (int64_t)q[1] * q[1] + (int64_t)q[2] * q[2] + (int64_t)q[3] * q[3]) >> 30;
+
+        if (norm < FIX30_ONE / 4 || norm > 2 * (int64_t)FIX30_ONE) {
+            return -1;
+        }
+        // k = (3 - |q|^2) / 2
+        const fix30_t k = (fix30_t)((3 * (int64_t)FIX30_ONE - norm) >> 1);
+        q[0] = fix30_mul(q[0], k);
+        q[1] = fix30_mul(q[1], k);
+        q[2] = fix30_mul(q[2], k);
+        q[3] = fix30_mul(q[3], k);
+
+        // one step is exact to the last bit for the drift of a single update
+        if (norm - FIX30_ONE < (FIX30_ONE >> 12) && FIX30_ONE - norm < (FIX30_ONE >> 12)) {
+            break;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Gravity direction in the body frame, the third row of the rotation matrix negated
+ * @param[in] q attitude quaternion
+ * @param[out] g unit gravity vector
+ */
+void fixquat_gravity(const fix30_t q[4], fix30_t g[3])
+{
+    const int64_t q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+
+    g[0] = (fix30_t)(-(q1 * q3 - q0 * q2) >> 29);
+    g[1] = (fix30_t)(-(q2 * q3 + q0 * q1) >> 29);
+    g[2] = (fix30_t)(-(q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3) >> 30);
+}
+
+/**
+ * Attitude error as the cross product of the normalized measured and estimated gravity
+ * @param[in] accel measured acceleration
+ * @param[in] g estimated gravity direction, need not be unit length
+ * @param[out] err accel x g, both normalized
+ * @returns 0 if successful, -1 if either vector is too short
+ */
+int32_t fixquat_accel_error(const fix16_t accel[3], const fix30_t g[3], fix30_t err[3])
+{
+    const uint32_t accel_norm = fix_isqrt64((uint64_t)((int64_t)accel[0] * accel[0] + (int64_t)accel[1] * accel[1] + (int64_t)accel[2] * accel[2]));
+    const uint32_t g_norm     = fix_isqrt64((uint64_t)((int64_t)g[0] * g[0] + (int64_t)g[1] * g[1] + (int64_t)g[2] * g[2]));
+
+    if (accel_norm < FIX16_MIN_NORM || g_norm < FIX30_MIN_NORM) {
+        return -1;
+    }
+
+    // one division per vector, the components are at most the norm so the products fit
+    const int64_t inv_accel = ((int64_t)1 << 46) / accel_norm;
+    const int64_t inv_g     = ((int64_t)1 << 60) / g_norm;
+    fix30_t a[3], b[3];
+    for (uint8_t i = 0; i < 3; i++) {
+        a[i] = (fix30_t)((accel[i] * inv_accel) >> 16);
+        b[i] = (fix30_t)((g[i] * inv_g) >> 30);
+    }
+
+    err[0] = (fix30_t)(((int64_t)a[1] * b[2] - (int64_t)a[2] * b[1]) >> 30);
+    err[1] = (fix30_t)(((int64_t)a[2] * b[0] - (int64_t)a[0] * b[2]) >> 30);
+    err[2] = (fix30_t)(((int64_t)a[0] * b[1] - (int64_t)a[1] * b[0]) >> 30);
+    return 0;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,76 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilot Math Utilities
+ * @{
+ * @addtogroup Fixed point quaternion math
+ * @{
+ *
+ * @file       fixed_quat.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Q2.30 quaternion math for the attitude filter on targets without FPU
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef FIXED_QUAT_H
+#define FIXED_QUAT_H
+
+#include <stdint.h>
+
+// Q16.16, accelerations
+typedef int32_t fix16_t;
+// Q2.30, quaternion components, unit vectors and small angles
+typedef int32_t fix30_t;
+
+#define FIX16_ONE ((fix16_t)1 << 16)
+#define FIX30_ONE ((fix30_t)1 << 30)
+
+static inline fix30_t fix30_mul(fix30_t a, fix30_t b)
+{
+    return (fix30_t)(((int64_t)a * b) >> 30);
+}
+
+static inline fix16_t fix16_from_float(float f)
+{
+    return (fix16_t)(f * 65536.0f);
+}
+
+static inline fix30_t fix30_from_float(float f)
+{
+    return (fix30_t)(f * 1073741824.0f);
+}
+
+static inline float fix30_to_float(fix30_t a)
+{
+    return (float)a * (1.0f / 1073741824.0f);
+}
+
+// Function declarations
+uint32_t fix_isqrt64(uint64_t x);
+void fixquat_integrate(fix30_t q[4], const fix30_t half_dtheta[3]);
+int32_t fixquat_normalize(fix30_t q[4]);
+void fixquat_gravity(const fix30_t q[4], fix30_t g[3]);
+int32_t fixquat_accel_error(const fix16_t accel[3], const fix30_t g[3], fix30_t err[3]);
+
+#endif /* FIXED_QUAT_H */
+
+/**
+ * @}
+ * @}
+ */
@@ -32,6 +32,7 @@
 #define MATHMISC_H
 
 #include <math.h>
+#include <float.h>
 #include <stdint.h>
 
 // returns min(boundary1,boundary2) if val<min(boundary1,boundary2)
@@ -121,6 +122,7 @@ static inline float y_on_curve(float x, const pointf points[], int num_points)
 }
 // Fast inverse square root implementation from "quake3-1.32b/code/game/q_math.c"
 // http://en.wikipedia.org/wiki/Fast_inverse_square_root
+// relative error below 1.8e-3
 
 static inline float fast_invsqrtf(float number)
 {
@@ -144,6 +146,96 @@ static inline float fast_invsqrtf(float number)
     return y;
 }
 
+/**
+ * Polynomial approximations of the libm functions for the attitude math, each
+ * call site picks between these and libm. The error bounds are absolute,
+ * include single precision rounding and are checked in flight/tests/math.
+ */
+
+/**
+ * Sine, Taylor polynomial to x^11 after reduction to [-pi/2, pi/2].
+ * |error| < 5e-7 for |x| <= 2pi, the range reduction costs accuracy beyond
+ * that (1e-5 at |x| = 100).
+ */
+static inline float fast_sinf(float x)
+{
+    // reduce to [-pi, pi], then fold into [-pi/2, pi/2]
+    x -= 6.28318531f * floorf(x * 0.159154943f + 0.5f);
+    if (x > 1.57079633f) {
+        x = 3.14159265f - x;
+    } else if (x < -1.57079633f) {
+        x = -3.14159265f - x;
+    }
+    const float x2 = x * x;
+    return x * (1.0f + x2 * (-1.6666667e-1f + x2 * (8.3333333e-3f + x2 * (-1.9841270e-4f + x2 * (2.7557319e-6f + x2 * -2.5052108e-8f)))));
+}
+
+/**
+ * Cosine, see fast_sinf
+ */
+static inline float fast_cosf(float x)
+{
+    return fast_sinf(x + 1.57079633f);
+}
+
+/**
+ * Four quadrant arctangent, Abramowitz and Stegun 4.4.47 on the octant.
+ * |error| < 1.2e-5 rad, fast_atan2f(0, 0) returns 0, as do denormal arguments.
+ */
+static inline float fast_atan2f(float y, float x)
+{
+    const float ax = fabsf(x);
+    const float ay = fabsf(y);
+    const float mx = (ax > ay) ? ax : ay;
+
+    if (mx < FLT_MIN) {
+        return 0.0f;
+    }
+    const float z  = ((ax > ay) ? ay : ax) / mx;
+    const float z2 = z * z;
+    float a = z * (0.9998660f + z2 * (-0.3302995f + z2 * (0.1801410f + z2 * (-0.0851330f + z2 * 0.0208351f))));
+
+    if (ay > ax) {
+        a = 1.57079633f - a;
+    }
+    if (x < 0.0f) {
+        a = 3.14159265f - a;
+    }
+    return (y < 0.0f) ? -a : a;
+}
+
+/**
+ * Arccosine, Abramowitz and Stegun 4.4.46.
+ * |error| < 5e-7 rad for x in [-1, 1], arguments outside are clamped.
+ */
+static inline float fast_acosf(float x)
+{
+    float ax = fabsf(x);
+    float p  = -0.0012624911f;
+
+    if (ax > 1.0f) {
+        ax = 1.0f;
+    }
+    p = p * ax + 0.0066700901f;
+    p = p * ax - 0.0170881256f;
+    p = p * ax + 0.0308918810f;
+    p = p * ax - 0.0501743046f;
+    p = p * ax + 0.0889789874f;
+    p = p * ax - 0.2145988016f;
+    p = p * ax + 1.5707963050f;
+    const float a = sqrtf(1.0f - ax) * p;
+
+    return (x < 0.0f) ? 3.14159265f - a : a;
+}
+
+/**
+ * Arcsine, see fast_acosf
+ */
+static inline float fast_asinf(float x)
+{
+    return 1.57079633f - fast_acosf(x);
+}
+
 /**
  * Ultrafast pow() aproximation needed for expo
  * Based on Algorithm by Martin Ankerl
@@ -99,6 +99,53 @@ float pid_apply_setpoint(struct pid *pid, const pid_scaler *scaler, const float
     return (err * scaler->p * pid->p) + pid->iAccumulator / 1000.0f + dterm;
 }
 
+/**
+ * Update several PID loops sharing one time step, evaluating the terms that
+ * depend only on dT and the derivative filter once for all of them.
+ * Same computation as pid_apply_setpoint for every loop selected in mask.
+ * @param[in,out] pids Array of count PID structures
+ * @param[in] scalers Per loop scale factors
+ * @param[in] setpoint Per loop setpoints
+ * @param[in] measured Per loop measured values
+ * @param[out] output Per loop controller values, untouched for loops not in mask
+ * @param[in] count Number of loops, at most 8
+ * @param[in] mask Bit n set to update loop n
+ * @param[in] dT  The time step
+ */
+void pid_apply_setpoint_batch(struct pid *pids, const pid_scaler *scalers, const float *setpoint, const float *measured,
+                              float *output, uint8_t count, uint8_t mask, float dT)
+{
+    const bool dValid = dT > 0.0f;
+    const float iScale = dT * 1000.0f;
+    // low pass filter derivative term, alpha = dT/(deriv_tau+dT)
+    const float alpha  = dValid ? dT / (dT + deriv_tau) : 0.0f;
+    const float invdT  = dValid ? 1.0f / dT : 0.0f;
+
+    for (uint8_t n = 0; n < count; n++) {
+        if (!(mask & (1 << n))) {
+            continue;
+        }
+        struct pid *pid = &pids[n];
+        const pid_scaler *scaler = &scalers[n];
+        const float err = setpoint[n] - measured[n];
+
+        // Scale up accumulator by 1000 while computing to avoid losing precision
+        pid->iAccumulator += err * (scaler->i * pid->i * iScale);
+        pid->iAccumulator  = boundf(pid->iAccumulator, pid->iLim * -1000.0f, pid->iLim * 1000.0f);
+
+        const float derr = deriv_gamma * setpoint[n] - measured[n];
+        const float diff = derr - pid->lastErr;
+        pid->lastErr = derr;
+        float dterm = 0;
+        if (pid->d > 0.0f && dValid) {
+            dterm = pid->lastDer + alpha * ((scaler->d * diff * pid->d * invdT) - pid->lastDer);
+            pid->lastDer = dterm;
+        }
+
+        output[n] = (err * scaler->p * pid->p) + pid->iAccumulator * 0.001f + dterm;
+    }
+}
+
 /**
  * Reset a bit
  * @param[in] pid The pid to reset
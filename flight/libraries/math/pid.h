@@ -53,6 +53,8 @@ typedef struct pid_scaler {
 // ! Methods to use the pid structures
 float pid_apply(struct pid *pid, const float err, float dT);
 float pid_apply_setpoint(struct pid *pid, const pid_scaler *scaler, const float setpoint, const float measured, float dT);
+void pid_apply_setpoint_batch(struct pid *pids, const pid_scaler *scalers, const float *setpoint, const float *measured,
+                              float *output, uint8_t count, uint8_t mask, float dT);
 void pid_zero(struct pid *pid);
 void pid_configure(struct pid *pid, float p, float i, float d, float iLim);
 void pid_configure_derivative(float cutoff, float gamma);
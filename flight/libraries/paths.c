@@ -34,9 +34,9 @@
 // no direct UAVObject usage allowed in this file
 
 // private functions
-static void path_endpoint(PathDesiredData *path, float *cur_point, struct path_status *status, bool mode);
-static void path_vector(PathDesiredData *path, float *cur_point, struct path_status *status, bool mode);
-static void path_circle(PathDesiredData *path, float *cur_point, struct path_status *status, bool clockwise);
+static void path_endpoint(const struct path_segment *segment, float *cur_point, struct path_status *status);
+static void path_vector(const struct path_segment *segment, float *cur_point, struct path_status *status);
+static void path_circle(const struct path_segment *segment, float *cur_point, struct path_status *status);
 
 /**
  * @brief Compute progress along path and deviation from it
@@ -45,35 +45,111 @@ static void path_circle(PathDesiredData *path, float *cur_point, struct path_sta
  * @param[out] status Structure containing progress along path and deviation
  */
 void path_progress(PathDesiredData *path, float *cur_point, struct path_status *status)
+{
+    struct path_segment segment;
+
+    path_compile(path, &segment);
+    path_segment_progress(&segment, cur_point, status);
+}
+
+/**
+ * @brief Compute the geometry of a path once, for the progress evaluations
+ * that follow until the path changes
+ * @param[in] path PathDesired structure
+ * @param[out] segment Compiled path
+ */
+void path_compile(PathDesiredData *path, struct path_segment *segment)
 {
     switch (path->Mode) {
     case PATHDESIRED_MODE_BRAKE: // should never get here...
     case PATHDESIRED_MODE_FLYVECTOR:
-        return path_vector(path, cur_point, status, true);
-
+        segment->type   = PATH_SEGMENT_VECTOR;
+        segment->mode3D = true;
         break;
     case PATHDESIRED_MODE_DRIVEVECTOR:
-        return path_vector(path, cur_point, status, false);
-
+        segment->type   = PATH_SEGMENT_VECTOR;
+        segment->mode3D = false;
         break;
     case PATHDESIRED_MODE_FLYCIRCLERIGHT:
     case PATHDESIRED_MODE_DRIVECIRCLERIGHT:
-        return path_circle(path, cur_point, status, 1);
-
+        segment->type      = PATH_SEGMENT_CIRCLE;
+        segment->clockwise = true;
         break;
     case PATHDESIRED_MODE_FLYCIRCLELEFT:
     case PATHDESIRED_MODE_DRIVECIRCLELEFT:
-        return path_circle(path, cur_point, status, 0);
-
+        segment->type      = PATH_SEGMENT_CIRCLE;
+        segment->clockwise = false;
         break;
     case PATHDESIRED_MODE_FLYENDPOINT:
-        return path_endpoint(path, cur_point, status, true);
-
+        segment->type   = PATH_SEGMENT_ENDPOINT;
+        segment->mode3D = true;
         break;
     case PATHDESIRED_MODE_DRIVEENDPOINT:
     default:
         // use the endpoint as default failsafe if called in unknown modes
-        return path_endpoint(path, cur_point, status, false);
+        segment->type   = PATH_SEGMENT_ENDPOINT;
+        segment->mode3D = false;
+        break;
+    }
+
+    segment->start[0]          = path->Start.North;
+    segment->start[1]          = path->Start.East;
+    segment->start[2]          = path->Start.Down;
+    segment->end[0]            = path->End.North;
+    segment->end[1]            = path->End.East;
+    segment->end[2]            = path->End.Down;
+    segment->starting_velocity = path->StartingVelocity;
+    segment->ending_velocity   = path->EndingVelocity;
+
+    if (segment->type == PATH_SEGMENT_CIRCLE) {
+        // the circle is around End, through Start
+        float radius_north = path->End.North - path->Start.North;
+        float radius_east  = path->End.East - path->Start.East;
+
+        segment->radius      = sqrtf(squaref(radius_north) + squaref(radius_east));
+        segment->start_angle = atan2f(radius_north, radius_east);
+        if (segment->start_angle < 0) {
+            segment->start_angle += 2.0f * M_PI_F;
+        }
+        return;
+    }
+
+    segment->vector[0] = path->End.North - path->Start.North;
+    segment->vector[1] = path->End.East - path->Start.East;
+    segment->vector[2] = segment->mode3D ? path->End.Down - path->Start.Down : 0.0f;
+    segment->length    = vector_lengthf(segment->vector, 3);
+
+    if (segment->length > 1e-6f) {
+        segment->unit[0] = segment->vector[0] / segment->length;
+        segment->unit[1] = segment->vector[1] / segment->length;
+        segment->unit[2] = segment->vector[2] / segment->length;
+        segment->inv_length_squared = 1.0f / (segment->length * segment->length);
+    } else {
+        segment->unit[0] = segment->unit[1] = segment->unit[2] = 0.0f;
+        segment->inv_length_squared = 0.0f;
+    }
+}
+
+/**
+ * @brief Compute progress along a compiled path and deviation from it
+ * @param[in] segment Path compiled by path_compile()
+ * @param[in] cur_point Current location
+ * @param[out] status Structure containing progress along path and deviation
+ */
+void path_segment_progress(const struct path_segment *segment, float *cur_point, struct path_status *status)
+{
+    switch (segment->type) {
+    case PATH_SEGMENT_VECTOR:
+        return path_vector(segment, cur_point, status);
+
+        break;
+    case PATH_SEGMENT_CIRCLE:
+        return path_circle(segment, cur_point, status);
+
+        break;
+    case PATH_SEGMENT_ENDPOINT:
+    default:
+        return path_endpoint(segment, cur_point, status);
 
         break;
     }
@@ -81,28 +157,22 @@ void path_progress(PathDesiredData *path, float *cur_point, struct path_status *
 
 /**
  * @brief Compute progress towards endpoint. Deviation equals distance
- * @param[in] path PathDesired
+ * @param[in] segment Compiled path
  * @param[in] cur_point Current location
  * @param[out] status Structure containing progress along path and deviation
- * @param[in] mode3D set true to include altitude in distance and progress calculation
  */
-static void path_endpoint(PathDesiredData *path, float *cur_point, struct path_status *status, bool mode3D)
+static void path_endpoint(const struct path_segment *segment, float *cur_point, struct path_status *status)
 {
     float diff[3];
-    float dist_path, dist_diff;
-
-    // Distance to go
-    status->path_vector[0] = path->End.North - path->Start.North;
-    status->path_vector[1] = path->End.East - path->Start.East;
-    status->path_vector[2] = mode3D ? path->End.Down - path->Start.Down : 0.0f;
+    float dist_diff;
+    float dist_path = fmaxf(segment->length, 1.0f);
 
     // Current progress location relative to end
-    diff[0]   = path->End.North - cur_point[0];
-    diff[1]   = path->End.East - cur_point[1];
-    diff[2]   = mode3D ? path->End.Down - cur_point[2] : 0.0f;
+    diff[0]   = segment->end[0] - cur_point[0];
+    diff[1]   = segment->end[1] - cur_point[1];
+    diff[2]   = segment->mode3D ? segment->end[2] - cur_point[2] : 0.0f;
 
     dist_diff = vector_lengthf(diff, 3);
-    dist_path = vector_lengthf(status->path_vector, 3);
 
     if (dist_diff < 1e-6f) {
         status->fractional_progress  = 1;
@@ -114,8 +184,8 @@ static void path_endpoint(PathDesiredData *path, float *cur_point, struct path_s
         return;
     }
 
-    if (fmaxf(dist_path, 1.0f) > dist_diff) {
-        status->fractional_progress = 1 - dist_diff / fmaxf(dist_path, 1.0f);
+    if (dist_path > dist_diff) {
+        status->fractional_progress = 1 - dist_diff / dist_path;
     } else {
         status->fractional_progress = 0; // we don't want fractional_progress to become negative
     }
@@ -127,129 +197,108 @@ static void path_endpoint(PathDesiredData *path, float *cur_point, struct path_s
     status->correction_vector[2] = diff[2];
 
     // base movement direction in this mode is a constant velocity offset on top of correction in the same direction
-    status->path_vector[0] = path->EndingVelocity * status->correction_vector[0] / dist_diff;
-    status->path_vector[1] = path->EndingVelocity * status->correction_vector[1] / dist_diff;
-    status->path_vector[2] = path->EndingVelocity * status->correction_vector[2] / dist_diff;
+    float scale = segment->ending_velocity / dist_diff;
+    status->path_vector[0] = scale * status->correction_vector[0];
+    status->path_vector[1] = scale * status->correction_vector[1];
+    status->path_vector[2] = scale * status->correction_vector[2];
 }
 
 /**
  * @brief Compute progress along path and deviation from it
- * @param[in] path PathDesired
+ * @param[in] segment Compiled path
  * @param[in] cur_point Current location
  * @param[out] status Structure containing progress along path and deviation
- * @param[in] mode3D set true to include altitude in distance and progress calculation
  */
-static void path_vector(PathDesiredData *path, float *cur_point, struct path_status *status, bool mode3D)
+static void path_vector(const struct path_segment *segment, float *cur_point, struct path_status *status)
 {
     float diff[3];
-    float dist_path;
-    float dot;
     float velocity;
-    float track_point[3];
 
-    // Distance to go
-    status->path_vector[0] = path->End.North - path->Start.North;
-    status->path_vector[1] = path->End.East - path->Start.East;
-    status->path_vector[2] = mode3D ? path->End.Down - path->Start.Down : 0.0f;
-
-    // Current progress location relative to start
-    diff[0]   = cur_point[0] - path->Start.North;
-    diff[1]   = cur_point[1] - path->Start.East;
-    diff[2]   = mode3D ? cur_point[2] - path->Start.Down : 0.0f;
-
-    dot       = status->path_vector[0] * diff[0] + status->path_vector[1] * diff[1] + status->path_vector[2] * diff[2];
-    dist_path = vector_lengthf(status->path_vector, 3);
-
-    if (dist_path > 1e-6f) {
-        // Compute direction to travel & progress
-        status->fractional_progress = dot / (dist_path * dist_path);
-    } else {
+    if (segment->length <= 1e-6f) {
         // Fly towards the endpoint to prevent flying away,
         // but assume progress=1 either way.
-        path_endpoint(path, cur_point, status, mode3D);
+        path_endpoint(segment, cur_point, status);
         status->fractional_progress = 1;
         return;
     }
-    // Compute point on track that is closest to our current position.
-    track_point[0] = status->fractional_progress * status->path_vector[0] + path->Start.North;
-    track_point[1] = status->fractional_progress * status->path_vector[1] + path->Start.East;
-    track_point[2] = status->fractional_progress * status->path_vector[2] + path->Start.Down;
 
-    status->correction_vector[0] = track_point[0] - cur_point[0];
-    status->correction_vector[1] = track_point[1] - cur_point[1];
-    status->correction_vector[2] = track_point[2] - cur_point[2];
+    // Current progress location relative to start
+    diff[0] = cur_point[0] - segment->start[0];
+    diff[1] = cur_point[1] - segment->start[1];
+    diff[2] = segment->mode3D ? cur_point[2] - segment->start[2] : 0.0f;
+
+    // Compute direction to travel & progress
+    status->fractional_progress = (segment->vector[0] * diff[0] + segment->vector[1] * diff[1] + segment->vector[2] * diff[2]) * segment->inv_length_squared;
+
+    // Compute the correction towards the point on track that is closest to our current position.
+    status->correction_vector[0] = status->fractional_progress * segment->vector[0] + segment->start[0] - cur_point[0];
+    status->correction_vector[1] = status->fractional_progress * segment->vector[1] + segment->start[1] - cur_point[1];
+    status->correction_vector[2] = status->fractional_progress * segment->vector[2] + segment->start[2] - cur_point[2];
 
     status->error = vector_lengthf(status->correction_vector, 3);
 
     // correct movement vector to current velocity
-    velocity = path->StartingVelocity + boundf(status->fractional_progress, 0.0f, 1.0f) * (path->EndingVelocity - path->StartingVelocity);
-    status->path_vector[0] = velocity * status->path_vector[0] / dist_path;
-    status->path_vector[1] = velocity * status->path_vector[1] / dist_path;
-    status->path_vector[2] = velocity * status->path_vector[2] / dist_path;
+    velocity = segment->starting_velocity + boundf(status->fractional_progress, 0.0f, 1.0f) * (segment->ending_velocity - segment->starting_velocity);
+    status->path_vector[0] = velocity * segment->unit[0];
+    status->path_vector[1] = velocity * segment->unit[1];
+    status->path_vector[2] = velocity * segment->unit[2];
 }
 
 /**
  * @brief Compute progress along circular path and deviation from it
- * @param[in] path PathDesired
+ * @param[in] segment Compiled path
  * @param[in] cur_point Current location
  * @param[out] status Structure containing progress along path and deviation
  */
-static void path_circle(PathDesiredData *path, float *cur_point, struct path_status *status, bool clockwise)
+static void path_circle(const struct path_segment *segment, float *cur_point, struct path_status *status)
 {
-    float radius_north, radius_east, diff_north, diff_east, diff_down;
-    float radius, cradius;
+    float diff_north, diff_east, diff_down;
+    float cradius;
     float normal[2];
     float progress;
-    float a_diff, a_radius;
-
-    // Radius
-    radius_north = path->End.North - path->Start.North;
-    radius_east  = path->End.East - path->Start.East;
+    float a_diff;
 
     // Current location relative to center
-    diff_north   = cur_point[0] - path->End.North;
-    diff_east    = cur_point[1] - path->End.East;
-    diff_down    = cur_point[2] - path->End.Down;
+    diff_north = cur_point[0] - segment->end[0];
+    diff_east  = cur_point[1] - segment->end[1];
+    diff_down  = cur_point[2] - segment->end[2];
 
-    radius  = sqrtf(squaref(radius_north) + squaref(radius_east));
-    cradius = sqrtf(squaref(diff_north) + squaref(diff_east));
+    cradius    = sqrtf(squaref(diff_north) + squaref(diff_east));
 
     // circles are always horizontal (for now - TODO: allow 3d circles - problem: clockwise/counterclockwise does no longer apply)
     status->path_vector[2] = 0.0f;
 
     // error is current radius minus wanted radius - positive if too close
-    status->error = radius - cradius;
+    status->error = segment->radius - cradius;
 
     if (cradius < 1e-6f) {
         // cradius is zero, just fly somewhere
         status->fractional_progress  = 1;
         status->correction_vector[0] = 0;
         status->correction_vector[1] = 0;
-        status->path_vector[0] = path->EndingVelocity;
+        status->path_vector[0] = segment->ending_velocity;
         status->path_vector[1] = 0;
     } else {
-        if (clockwise) {
+        float inv_cradius = 1.0f / cradius;
+
+        if (segment->clockwise) {
             // Compute the normal to the radius clockwise
-            normal[0] = -diff_east / cradius;
-            normal[1] = diff_north / cradius;
+            normal[0] = -diff_east * inv_cradius;
+            normal[1] = diff_north * inv_cradius;
         } else {
             // Compute the normal to the radius counter clockwise
-            normal[0] = diff_east / cradius;
-            normal[1] = -diff_north / cradius;
+            normal[0] = diff_east * inv_cradius;
+            normal[1] = -diff_north * inv_cradius;
         }
 
         // normalize progress to 0..1
-        a_diff   = atan2f(diff_north, diff_east);
-        a_radius = atan2f(radius_north, radius_east);
+        a_diff = atan2f(diff_north, diff_east);
 
         if (a_diff < 0) {
             a_diff += 2.0f * M_PI_F;
         }
-        if (a_radius < 0) {
-            a_radius += 2.0f * M_PI_F;
-        }
 
-        progress = (a_diff - a_radius + M_PI_F) / (2.0f * M_PI_F);
+        progress = (a_diff - segment->start_angle + M_PI_F) / (2.0f * M_PI_F);
 
         if (progress < 0.0f) {
             progress += 1.0f;
@@ -257,22 +306,22 @@ static void path_circle(PathDesiredData *path, float *cur_point, struct path_sta
             progress -= 1.0f;
         }
 
-        if (clockwise) {
+        if (segment->clockwise) {
             progress = 1.0f - progress;
         }
 
         status->fractional_progress = progress;
 
         // Compute direction to travel
-        status->path_vector[0] = normal[0] * path->EndingVelocity;
-        status->path_vector[1] = normal[1] * path->EndingVelocity;
+        status->path_vector[0] = normal[0] * segment->ending_velocity;
+        status->path_vector[1] = normal[1] * segment->ending_velocity;
 
         // Compute direction to correct error
-        status->correction_vector[0] = status->error * diff_north / cradius;
-        status->correction_vector[1] = status->error * diff_east / cradius;
+        status->correction_vector[0] = status->error * diff_north * inv_cradius;
+        status->correction_vector[1] = status->error * diff_east * inv_cradius;
     }
 
     status->correction_vector[2] = -diff_down;
 
-    status->error = fabs(status->error);
+    status->error = fabsf(status->error);
 }
@@ -63,8 +63,9 @@ void
 Modified_Berlekamp_Massey (void)
 {	
   int n, L, L2, k, d, i;
-  int psi[MAXDEG], psi2[MAXDEG], D[MAXDEG];
-  int gamma[MAXDEG];
+  /* static, these are too large for the stack of the radio task */
+  static int psi[MAXDEG], psi2[MAXDEG], D[MAXDEG];
+  static int gamma[MAXDEG];
 	
   /* initialize Gamma, the erasure locator polynomial */
   init_gamma(gamma);
@@ -76,7 +77,7 @@ Modified_Berlekamp_Massey (void)
   copy_poly(psi, gamma);	
   k = -1; L = NErasures;
 	
-  for (n = NErasures; n < RS_ECC_NPARITY; n++) {
+  for (n = NErasures; n < NPar; n++) {
 	
     d = compute_discrepancy(psi, synBytes, L, n);
 		
@@ -115,11 +116,11 @@ void
 compute_modified_omega ()
 {
   int i;
-  int product[MAXDEG*2];
+  static int product[MAXDEG*2];
 	
   mult_polys(product, Lambda, synBytes);	
   zero_poly(Omega);
-  for(i = 0; i < RS_ECC_NPARITY; i++) Omega[i] = product[i];
+  for(i = 0; i < NPar; i++) Omega[i] = product[i];
 
 }
 
@@ -128,7 +129,7 @@ void
 mult_polys (int dst[], int p1[], int p2[])
 {
   int i, j;
-  int tmp1[MAXDEG*2];
+  static int tmp1[MAXDEG*2];
 	
   for (i=0; i < (MAXDEG*2); i++) dst[i] = 0;
 	
@@ -242,7 +243,7 @@ Find_Roots (void)
   for (r = 1; r < 256; r++) {
     sum = 0;
     /* evaluate lambda at r */
-    for (k = 0; k < RS_ECC_NPARITY+1; k++) {
+    for (k = 0; k < NPar+1; k++) {
       sum ^= gmult(gexp[(k*r)%255], Lambda[k]);
     }
     if (sum == 0) 
@@ -284,7 +285,7 @@ correct_errors_erasures (unsigned char codeword[],
   Find_Roots();
   
 
-  if ((NErrors <= RS_ECC_NPARITY) && NErrors > 0) { 
+  if ((NErrors <= NPar) && NErrors > 0) { 
 
     /* first check for illegal error locs */
     for (r = 0; r < NErrors; r++) {
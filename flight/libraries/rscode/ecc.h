@@ -55,9 +55,12 @@ typedef unsigned short BIT16;
 
 /* **************************************************************** */
 
-/* Maximum degree of various polynomials. */
+/* Maximum degree of various polynomials, RS_ECC_NPARITY is the most parity
+   bytes a codeword may have, NPar the number set by set_ecc_nparity(). */
 #define MAXDEG (RS_ECC_NPARITY*2)
 
+extern int NPar;
+
 /*************************************/
 /* Encoder parity bytes */
 extern int pBytes[MAXDEG];
@@ -70,6 +73,7 @@ extern int synBytes[MAXDEG];
 
 /* Reed Solomon encode/decode routines */
 void initialize_ecc (void);
+void set_ecc_nparity (int npar);
 int check_syndrome (void);
 void decode_data (unsigned char data[], int nbytes);
 void encode_data (unsigned char msg[], int nbytes, unsigned char dst[]);
@@ -38,6 +38,9 @@ int synBytes[MAXDEG];
 /* generator polynomial */
 int genPoly[MAXDEG*2];
 
+/* parity bytes per codeword */
+int NPar = RS_ECC_NPARITY;
+
 //int DEBUG = FALSE;
 
 static void
@@ -51,7 +54,16 @@ initialize_ecc ()
     init_galois_tables();
 
     /* Compute the encoder generator polynomial */
-    compute_genpoly(RS_ECC_NPARITY, genPoly);
+    compute_genpoly(NPar, genPoly);
+}
+
+/* Change the number of parity bytes, at most RS_ECC_NPARITY */
+void
+set_ecc_nparity (int npar)
+{
+  if (npar < 1 || npar > RS_ECC_NPARITY) return;
+  NPar = npar;
+  compute_genpoly(NPar, genPoly);
 }
 
 void
@@ -68,7 +80,7 @@ print_parity (void)
 #ifdef NEVER
   int i;
   printf("Parity Bytes: ");
-  for (i = 0; i < RS_ECC_NPARITY; i++) 
+  for (i = 0; i < NPar; i++) 
     printf("[%d]:%x, ",i,pBytes[i]);
   printf("\n");
 #endif
@@ -81,7 +93,7 @@ print_syndrome (void)
 #ifdef NEVER
   int i;
   printf("Syndrome Bytes: ");
-  for (i = 0; i < RS_ECC_NPARITY; i++) 
+  for (i = 0; i < NPar; i++) 
     printf("[%d]:%x, ",i,synBytes[i]);
   printf("\n");
 #endif
@@ -95,8 +107,8 @@ build_codeword (unsigned char msg[], int nbytes, unsigned char dst[])
 	
   for (i = 0; i < nbytes; i++) dst[i] = msg[i];
 	
-  for (i = 0; i < RS_ECC_NPARITY; i++) {
-    dst[i+nbytes] = pBytes[RS_ECC_NPARITY-1-i];
+  for (i = 0; i < NPar; i++) {
+    dst[i+nbytes] = pBytes[NPar-1-i];
   }
 }
 	
@@ -111,7 +123,7 @@ void
 decode_data(unsigned char data[], int nbytes)
 {
   int i, j, sum;
-  for (j = 0; j < RS_ECC_NPARITY;  j++) {
+  for (j = 0; j < NPar;  j++) {
     sum	= 0;
     for (i = 0; i < nbytes; i++) {
       sum = data[i] ^ gmult(gexp[j+1], sum);
@@ -126,7 +138,7 @@ int
 check_syndrome (void)
 {
  int i, nz = 0;
- for (i =0 ; i < RS_ECC_NPARITY; i++) {
+ for (i =0 ; i < NPar; i++) {
   if (synBytes[i] != 0) {
       nz = 1;
       break;
@@ -189,17 +201,17 @@ encode_data (unsigned char msg[], int nbytes, unsigned char dst[])
 {
   int i, LFSR[RS_ECC_NPARITY+1],dbyte, j;
 	
-  for(i=0; i < RS_ECC_NPARITY+1; i++) LFSR[i]=0;
+  for(i=0; i < NPar+1; i++) LFSR[i]=0;
 
   for (i = 0; i < nbytes; i++) {
-    dbyte = msg[i] ^ LFSR[RS_ECC_NPARITY-1];
-    for (j = RS_ECC_NPARITY-1; j > 0; j--) {
+    dbyte = msg[i] ^ LFSR[NPar-1];
+    for (j = NPar-1; j > 0; j--) {
       LFSR[j] = LFSR[j-1] ^ gmult(genPoly[j], dbyte);
     }
     LFSR[0] = gmult(genPoly[0], dbyte);
   }
 
-  for (i = 0; i < RS_ECC_NPARITY; i++) 
+  for (i = 0; i < NPar; i++) 
     pBytes[i] = LFSR[i];
 	
   build_codeword(msg, nbytes, dst);
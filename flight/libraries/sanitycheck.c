@@ -80,6 +80,7 @@ int32_t configuration_check()
     switch (revoFusion) {
     case REVOSETTINGS_FUSIONALGORITHM_COMPLEMENTARYMAGGPSOUTDOOR:
     case REVOSETTINGS_FUSIONALGORITHM_GPSNAVIGATIONINS13:
+    case REVOSETTINGS_FUSIONALGORITHM_GPSNAVIGATIONINS16:
         navCapableFusion = true;
         break;
     default:
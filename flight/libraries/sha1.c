@@ -262,10 +262,10 @@ void SHA1Final(uint8_t digest[20], SHA1_CTX *context)
         finalcount[i] = (uint8_t)((context->count[(i >= 4 ? 0 : 1)]
                                    >> ((3 - (i & 3)) * 8)) & 255); /* Endian independent */
     }
-    SHA1Update(context, (const uint8_t *)"\200", 1);
-    while ((context->count[0] & 504) != 448) {
-        SHA1Update(context, (const uint8_t *)"\0", 1);
-    }
+    /* Pad to 56 mod 64 bytes in one update rather than byte by byte */
+    static const uint8_t padding[64] = { 0x80 };
+    unsigned int used = (context->count[0] >> 3) & 63;
+    SHA1Update(context, padding, (used < 56) ? (56 - used) : (120 - used));
     SHA1Update(context, finalcount, 8); /* Should cause a SHA1Transform() */
 
     if (digest) {
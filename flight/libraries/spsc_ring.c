@@ -0,0 +1,163 @@
+/**
+ ******************************************************************************
+ *
+ * @file       spsc_ring.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Lock free single producer single consumer ring buffer.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <string.h>
+
+#include "spsc_ring.h"
+
+// data accesses must be complete before the index that publishes them is written,
+// and the index must be read before the data it covers. A dmb on Cortex-M.
+#define SPSC_BARRIER() __sync_synchronize()
+
+// *****************************************************************************
+// ring buffer functions
+
+int8_t spscRing_init(t_spsc_ring *ring, void *buffer, uint16_t buffer_size)
+{ // buffer_size must be a power of two, below 2^16 so head - tail never overflows
+    if (buffer_size == 0 || (buffer_size & (buffer_size - 1)) || buffer_size > 0x8000) {
+        return -1;
+    }
+
+    ring->buf_ptr = (uint8_t *)buffer;
+    ring->head    = 0;
+    ring->tail    = 0;
+    ring->mask    = buffer_size - 1;
+
+    return 0;
+}
+
+uint16_t spscRing_getSize(const t_spsc_ring *ring)
+{ // return the usable size of the buffer
+    return ring->mask + 1;
+}
+
+uint16_t spscRing_getUsed(const t_spsc_ring *ring)
+{ // return the number of bytes in the buffer
+    return (uint16_t)(ring->head - ring->tail);
+}
+
+uint16_t spscRing_getFree(const t_spsc_ring *ring)
+{ // return the free space size in the buffer
+    return spscRing_getSize(ring) - spscRing_getUsed(ring);
+}
+
+uint16_t spscRing_reserve(t_spsc_ring *ring, uint8_t * *span)
+{ // return the contiguous free space at the head, to be filled in place and committed
+    uint16_t head = ring->head;
+    uint16_t tail = ring->tail;
+
+    SPSC_BARRIER(); // the consumer is done with the space before we write it
+
+    uint16_t free = (ring->mask + 1) - (uint16_t)(head - tail);
+    uint16_t offset = head & ring->mask;
+    uint16_t contiguous = (ring->mask + 1) - offset;
+
+    *span = ring->buf_ptr + offset;
+
+    return (free < contiguous) ? free : contiguous;
+}
+
+void spscRing_commit(t_spsc_ring *ring, uint16_t len)
+{ // publish len bytes written to a reserved span
+    SPSC_BARRIER(); // the data is in place before the consumer can see it
+
+    ring->head = ring->head + len;
+}
+
+uint16_t spscRing_putData(t_spsc_ring *ring, const void *data, uint16_t len)
+{ // add data to the buffer
+    const uint8_t *p = (const uint8_t *)data;
+    uint16_t i = 0;
+
+    while (i < len) {
+        uint8_t *span;
+        uint16_t block_len = spscRing_reserve(ring, &span);
+        if (block_len == 0) {
+            break;
+        }
+        if (block_len > len - i) {
+            block_len = len - i;
+        }
+        memcpy(span, p + i, block_len);
+        spscRing_commit(ring, block_len);
+        i += block_len;
+    }
+
+    return i; // return number of bytes copied
+}
+
+uint16_t spscRing_peek(t_spsc_ring *ring, const uint8_t * *span)
+{ // return the contiguous data at the tail, to be read in place and released
+    uint16_t tail = ring->tail;
+    uint16_t head = ring->head;
+
+    SPSC_BARRIER(); // the data covered by head is read after head
+
+    uint16_t used = (uint16_t)(head - tail);
+    uint16_t offset = tail & ring->mask;
+    uint16_t contiguous = (ring->mask + 1) - offset;
+
+    *span = ring->buf_ptr + offset;
+
+    return (used < contiguous) ? used : contiguous;
+}
+
+void spscRing_release(t_spsc_ring *ring, uint16_t len)
+{ // hand len bytes of a peeked span back to the producer
+    SPSC_BARRIER(); // the data has been read before the producer may overwrite it
+
+    ring->tail = ring->tail + len;
+}
+
+uint16_t spscRing_getData(t_spsc_ring *ring, void *data, uint16_t len)
+{ // get data from the buffer
+    uint8_t *p = (uint8_t *)data;
+    uint16_t i = 0;
+
+    while (i < len) {
+        const uint8_t *span;
+        uint16_t block_len = spscRing_peek(ring, &span);
+        if (block_len == 0) {
+            break;
+        }
+        if (block_len > len - i) {
+            block_len = len - i;
+        }
+        memcpy(p + i, span, block_len);
+        spscRing_release(ring, block_len);
+        i += block_len;
+    }
+
+    return i; // return number of bytes copied
+}
+
+void spscRing_clearData(t_spsc_ring *ring)
+{ // remove all data from the buffer, consumer side only
+    SPSC_BARRIER();
+
+    ring->tail = ring->head;
+}
+
+// *****************************************************************************
@@ -37,6 +37,20 @@
 * This protocol is best used in cases where one device is the master and the other is the slave, or a don't
 * speak unless spoken to type of approach.
 *
+* Windowed operation: a port configured with txWindow/rxWindow greater than one carries its receive window as
+* a single data byte in the synch packet, and a port that understands windows answers with its own receive
+* window as a data byte in the ACK of the synch. After that each end may keep min(own txWindow, peer rxWindow)
+* packets in flight. Every packet has its own timeout and retry count so only packets that were not acked are
+* sent again, and the receiver holds packets that arrive ahead of a lost one until the gap is filled, acking
+* each packet as it arrives. A peer that predates windows ignores the synch data byte and answers with a bare
+* ACK, which leaves both ends in the original stop and wait mode. A window of one on either side also stays in
+* stop and wait mode.
+*
+* When a packet is given up on after max_retry attempts, the packets behind it are dropped too and the sequence
+* numbers of the two ends no longer agree. The next ssp_SendData() then synchronises the port again before it
+* sends anything else, receiving that synch resets the other end as well. Packets outside the receive window can
+* only be stale copies from before such a synch, they are acked so their sender stops resending them.
+*
 * The following are items are required to initialize a port for communications:
 * 1. The number attempts for each packet
 * 2. time to wait for an ack.
@@ -105,25 +119,42 @@
 #define ISBITSET(a, b)              (((a) & (b)) == (b) ? TRUE : FALSE)
 #define ISBITCLEAR(a, b)            ((~(a) & (b)) == (b) ? TRUE : FALSE)
 
+// sequence numbers run 1..127, these step and compare them across the rollover
+#define SEQ_COUNT                   0x7F
+#define NEXTSEQNO(s)                ((((s) & 0x7F) >= SEQ_COUNT) ? 1 : (((s) & 0x7F) + 1))
+#define SEQDISTANCE(from, to)       ((uint8_t)(((to) + SEQ_COUNT - (from)) % SEQ_COUNT))
+
+// window slot locations in the tx and rx buffers
+#define TXSLOT(p, n)                (&(p)->txBuf[(n) * SSP_PACKET_BUF_SIZE((p)->txBufSize)])
+#define RXSLOT(p, n)                (&(p)->rxBuf[(n) * SSP_PACKET_BUF_SIZE((p)->rxBufSize)])
+#define CLAMPWINDOW(w)              ((w) < 1 ? 1 : ((w) > SSP_MAX_WINDOW ? SSP_MAX_WINDOW : (w)))
+
 /** PRIVATE FUNCTIONS **/
 // static void          sf_SendSynchPacket( Port_t *thisport );
 static uint16_t sf_checksum(uint16_t crc, uint8_t data);
 static void sf_write_byte(Port_t *thisport, uint8_t c);
-static void sf_SetSendTimeout(Port_t *thisport);
-static uint16_t sf_CheckTimeout(Port_t *thisport);
+static void sf_SetSendTimeout(Port_t *thisport, uint8_t slot);
+static uint16_t sf_CheckTimeout(Port_t *thisport, uint8_t slot);
 static int16_t sf_DecodeState(Port_t *thisport, uint8_t c);
 static int16_t sf_ReceiveState(Port_t *thisport, uint8_t c);
 
-static void sf_SendPacket(Port_t *thisport);
-static void sf_SendAckPacket(Port_t *thisport, uint8_t seqNumber);
+static void sf_SendPacket(Port_t *thisport, const uint8_t *buf);
+static void sf_SendSlot(Port_t *thisport, uint8_t slot);
+static void sf_SendAckPacket(Port_t *thisport, uint8_t seqNumber, const uint8_t *pdata, uint16_t length);
 static void sf_MakePacket(uint8_t *buf, const uint8_t *pdata, uint16_t length,
                           uint8_t seqNo);
 static int16_t sf_ReceivePacket(Port_t *thisport);
+static int16_t sf_ReceiveWindowed(Port_t *thisport);
+static int16_t sf_GetTxSlot(Port_t *thisport);
+static void sf_ResetWindow(Port_t *thisport);
+static void sf_StartSynch(Port_t *thisport);
+static void sf_SetLimits(Port_t *thisport, const uint8_t *peerWindow);
 
 /* Flag bit masks...*/
 #define SENT_SYNCH       (0x01)
 #define ACK_RECEIVED     (0x02)
 #define ACK_EXPECTED     (0x04)
+#define RESYNCH          (0x08) // a packet was given up on, synch before sending again
 
 #define SSP_AWAITING_ACK 0
 #define SSP_ACKED        1
@@ -191,11 +222,14 @@ void ssp_Init(Port_t *thisport, const PortConfig_t *const info)
     thisport->rxBufSize     = info->rxBufSize;
     thisport->txBuf = info->txBuf;
     thisport->rxBuf = info->rxBuf;
-    thisport->retryCount    = 0;
+    thisport->txWindow      = CLAMPWINDOW(info->txWindow);
+    thisport->rxWindow      = CLAMPWINDOW(info->rxWindow);
+    thisport->txLimit       = 1; // stop and wait until a synch agrees on a window
+    thisport->rxLimit       = 0;
     thisport->sendSynch     = FALSE; // TRUE;
     thisport->rxSeqNo = 255;
     thisport->txSeqNo = 255;
-    thisport->SendState     = SSP_IDLE;
+    sf_ResetWindow(thisport);
 }
 
 /*!
@@ -211,31 +245,34 @@ void ssp_Init(Port_t *thisport, const PortConfig_t *const info)
  */
 int16_t ssp_SendProcess(Port_t *thisport)
 {
-    int16_t value = SSP_TX_WAITING;
+    int16_t value = SSP_TX_IDLE;
 
-    if (thisport->SendState == SSP_AWAITING_ACK) {
-        if (sf_CheckTimeout(thisport) == TRUE) {
-            if (thisport->retryCount < thisport->maxRetryCount) {
-                // Try again
-                sf_SendPacket(thisport);
-                sf_SetSendTimeout(thisport);
-                value = SSP_TX_WAITING;
-            } else {
-                // Give up, # of trys has exceded the limit
-                value = SSP_TX_TIMEOUT;
-                CLEARBIT(thisport->flags, ACK_RECEIVED);
-                thisport->SendState = SSP_IDLE;
-            }
+    for (uint8_t slot = 0; slot < thisport->txWindow && value != SSP_TX_TIMEOUT; slot++) {
+        if (ISBITCLEAR(thisport->txBusy, 1 << slot) || sf_CheckTimeout(thisport, slot) == FALSE) {
+            continue;
+        }
+        if (thisport->txSlotRetry[slot] < thisport->maxRetryCount) {
+            // Try again, only this packet is resent
+            sf_SendSlot(thisport, slot);
         } else {
-            value = SSP_TX_WAITING;
+            // Give up, # of trys has exceded the limit. The packets behind it can not be
+            // delivered in order either, so the whole window is dropped and the sequence
+            // numbers are synchronised again before the next packet.
+            value = SSP_TX_TIMEOUT;
+            CLEARBIT(thisport->flags, ACK_RECEIVED);
+            SETBIT(thisport->flags, RESYNCH);
+            thisport->txBusy    = 0;
+            thisport->SendState = SSP_IDLE;
         }
+    }
+    if (value == SSP_TX_TIMEOUT) {
+        // reported above
     } else if (thisport->SendState == SSP_ACKED) {
         SETBIT(thisport->flags, ACK_RECEIVED);
         value = SSP_TX_ACKED;
         thisport->SendState = SSP_IDLE;
-    } else {
-        thisport->SendState = SSP_IDLE;
-        value = SSP_TX_IDLE;
+    } else if (thisport->txBusy != 0) {
+        value = SSP_TX_WAITING;
     }
     return value;
 }
@@ -314,20 +351,29 @@ uint16_t ssp_SendDataBlock(Port_t *thisport, uint8_t *data, uint16_t length)
  * \param	length = number of bytes to send
  * \return	SSP_TX_BUFOVERRUN = tried to send too much data
  * \return	SSP_TX_WAITING = data sent and waiting for an ack to arrive
- * \return	SSP_TX_BUSY = a packet has already been sent, but not yet acked
+ * \return	SSP_TX_BUSY = the window is full, wait for an ack before sending more
  *
  * \note
- *
+ * In stop and wait mode the window is a single packet, so SSP_TX_BUSY is returned
+ * until the previous packet has been acked or has timed out. After a packet timed
+ * out the first call starts a synch instead, and SSP_TX_BUSY is returned until the
+ * synch has been acked.
  */
 int16_t ssp_SendData(Port_t *thisport, const uint8_t *data,
                      const uint16_t length)
 {
     int16_t value = SSP_TX_WAITING;
+    int16_t slot  = -1;
 
     if ((length + 2) > thisport->txBufSize) {
         // TRYING to send too much data.
         value = SSP_TX_BUFOVERRUN;
-    } else if (thisport->SendState == SSP_IDLE) {
+    } else if (ISBITSET(thisport->flags, RESYNCH)) {
+        if (thisport->txBusy == 0) {
+            sf_StartSynch(thisport);
+        }
+        value = SSP_TX_BUSY;
+    } else if ((slot = sf_GetTxSlot(thisport)) >= 0) {
 #ifdef ACTIVE_SYNCH
         if (thisport->sendSynch == TRUE) {
             sf_SendSynchPacket(thisport);
@@ -343,32 +389,24 @@ int16_t ssp_SendData(Port_t *thisport, const uint8_t *data,
             thisport->txSeqNo = 0; // make this zero to cause the other end to re-synch with us
             SETBIT(thisport->flags, SENT_SYNCH);
         } else {
-            // we are sending a data packet
-            CLEARBIT(thisport->txSeqNo, ACK_BIT); // make sure we are not sending a ACK packet
-            thisport->txSeqNo++; // update the sequence number.
-            if (thisport->txSeqNo > 0x7F) { // check for sequence number rollover
-                thisport->txSeqNo = 1; // if we do have rollover then reset to 1 not zero,
-                // zero is reserviced for synchronization requests
-            }
+            // we are sending a data packet, rolls over to 1 not zero,
+            // zero is reserviced for synchronization requests
+            thisport->txSeqNo = NEXTSEQNO(thisport->txSeqNo);
         }
 
 #else
-        CLEARBIT(thisport->txSeqNo, ACK_BIT); // make sure we are not sending a ACK packet
-        thisport->txSeqNo++; // update the sequence number.
-        if (thisport->txSeqNo > 0x7F) { // check for sequence number rollover
-            thisport->txSeqNo = 1; // if we do have rollover then reset to 1 not zero,
-            // zero is reserved for synchronization requests
-        }
+        // rolls over from 127 to 1 not zero, zero is reserved for synchronization requests
+        thisport->txSeqNo = NEXTSEQNO(thisport->txSeqNo);
 #endif /* ifdef SYNCH_SEND */
         CLEARBIT(thisport->flags, ACK_RECEIVED);
-        thisport->SendState  = SSP_AWAITING_ACK;
         value = SSP_TX_WAITING;
-        thisport->retryCount = 0; // zero out the retry counter for this transmission
-        sf_MakePacket(thisport->txBuf, data, length, thisport->txSeqNo);
-        sf_SendPacket(thisport); // punch out the packet to the serial port
-        sf_SetSendTimeout(thisport); // do the timeout values
+        thisport->txSlotSeq[slot]   = thisport->txSeqNo;
+        thisport->txSlotRetry[slot] = 0; // zero out the retry counter for this transmission
+        SETBIT(thisport->txBusy, 1 << slot);
+        sf_MakePacket(TXSLOT(thisport, slot), data, length, thisport->txSeqNo);
+        sf_SendSlot(thisport, slot); // punch out the packet and start its timeout
     } else {
-        // error we are already sending a packet. Need to wait for the current packet to be acked or timeout.
+        // error the window is full. Need to wait for a packet to be acked or timeout.
         value = SSP_TX_BUSY;
     }
     return value;
@@ -387,19 +425,15 @@ int16_t ssp_SendData(Port_t *thisport, const uint8_t *data,
  *              increment try counter
  *              if number of tries exceed maximum try limit then exit
  * C. goto A
+ *
+ * The synch packet carries our receive window, see the notes at the top of the file.
  */
 uint16_t ssp_Synchronise(Port_t *thisport)
 {
     int16_t packet_status;
 
 #ifndef USE_SENDPACKET_DATA
-    thisport->txSeqNo = 0; // make this zero to cause the other end to re-synch with us
-    SETBIT(thisport->flags, SENT_SYNCH);
-    // TODO - should this be using ssp_SendPacketData()??
-    sf_MakePacket(thisport->txBuf, NULL, 0, thisport->txSeqNo); // construct the packet
-    sf_SendPacket(thisport);
-    sf_SetSendTimeout(thisport);
-    thisport->SendState = SSP_AWAITING_ACK;
+    sf_StartSynch(thisport);
     packet_status = SSP_TX_WAITING;
 #else
     packet_status = ssp_SendData(thisport, NULL, 0);
@@ -412,25 +446,122 @@ uint16_t ssp_Synchronise(Port_t *thisport)
     return packet_status == SSP_TX_ACKED;
 }
 
+/*!
+ * \brief   drops the window and sends a synch packet carrying our receive window
+ * \param   thisport = which port to use
+ * \return  none.
+ *
+ * \note
+ * The synch is retried and timed out like a data packet by ssp_SendProcess.
+ */
+static void sf_StartSynch(Port_t *thisport)
+{
+    sf_ResetWindow(thisport);
+    thisport->txLimit = 1;
+    thisport->txSeqNo = 0; // make this zero to cause the other end to re-synch with us
+    SETBIT(thisport->flags, SENT_SYNCH);
+    // TODO - should this be using ssp_SendPacketData()??
+    sf_MakePacket(TXSLOT(thisport, 0), &thisport->rxWindow, 1, thisport->txSeqNo); // construct the packet
+    thisport->txSlotSeq[0]   = thisport->txSeqNo;
+    thisport->txSlotRetry[0] = 0;
+    SETBIT(thisport->txBusy, 1);
+    sf_SendSlot(thisport, 0);
+}
+
+/*!
+ * \brief   sets the window limits agreed in a synch exchange
+ * \param   thisport = which port to use
+ * \param	peerWindow = receive window sent by the other end, NULL if it does not use windows
+ * \return  none.
+ *
+ * \note
+ * The windowed receive path is only used when both ends keep more than one packet in
+ * flight, a window of one stays in stop and wait mode.
+ */
+static void sf_SetLimits(Port_t *thisport, const uint8_t *peerWindow)
+{
+    if (peerWindow != NULL) {
+        thisport->txLimit = MIN(CLAMPWINDOW(*peerWindow), thisport->txWindow);
+        thisport->rxLimit = (thisport->rxWindow > 1) ? thisport->rxWindow : 0;
+    } else {
+        thisport->txLimit = 1;
+        thisport->rxLimit = 0;
+    }
+}
+
 /*!
  * \brief   sends out a preformatted packet for a give port
  * \param   thisport = which port to use.
+ * \param	buf = packet to send
  * \return  none.
  *
  * \note
  * Packet should be formed through the use of sf_MakePacket before calling this function.
  */
-static void sf_SendPacket(Port_t *thisport)
+static void sf_SendPacket(Port_t *thisport, const uint8_t *buf)
 {
     // add 3 to packet data length for: 1 length + 2 CRC (packet overhead)
-    uint8_t packetLen = thisport->txBuf[LENGTH] + 3;
+    uint16_t packetLen = buf[LENGTH] + 3;
 
     // use the raw serial write function so the SYNC byte does not get 'escaped'
     thisport->pfSerialWrite(SYNC);
-    for (uint8_t x = 0; x < packetLen; x++) {
-        sf_write_byte(thisport, thisport->txBuf[x]);
+    for (uint16_t x = 0; x < packetLen; x++) {
+        sf_write_byte(thisport, buf[x]);
     }
-    thisport->retryCount++;
+}
+
+/*!
+ * \brief   sends (or resends) the packet held in a transmit slot and restarts its timeout
+ * \param   thisport = which port to use.
+ * \param	slot = transmit slot to send
+ * \return  none.
+ */
+static void sf_SendSlot(Port_t *thisport, uint8_t slot)
+{
+    sf_SendPacket(thisport, TXSLOT(thisport, slot));
+    thisport->txSlotRetry[slot]++;
+    sf_SetSendTimeout(thisport, slot);
+}
+
+/*!
+ * \brief   finds a free transmit slot for the next packet
+ * \param   thisport = which port to use.
+ * \return  slot number, or -1 if the window is full
+ *
+ * \note
+ * The window is full when txLimit packets are in flight, or when the oldest packet
+ * that has not been acked is txLimit sequence numbers behind the next one, since the
+ * receiver would drop the next packet as being outside its window.
+ */
+static int16_t sf_GetTxSlot(Port_t *thisport)
+{
+    uint8_t nextSeqNo = NEXTSEQNO(thisport->txSeqNo);
+    uint8_t inFlight  = 0;
+    int16_t freeSlot  = -1;
+
+    for (uint8_t slot = 0; slot < thisport->txWindow; slot++) {
+        if (ISBITSET(thisport->txBusy, 1 << slot)) {
+            inFlight++;
+            if (SEQDISTANCE(thisport->txSlotSeq[slot], nextSeqNo) >= thisport->txLimit) {
+                return -1;
+            }
+        } else if (freeSlot < 0) {
+            freeSlot = slot;
+        }
+    }
+    return (inFlight < thisport->txLimit) ? freeSlot : -1;
+}
+
+/*!
+ * \brief   drops all packets in flight and any that are held waiting for a gap to be filled
+ * \param   thisport = which port to use.
+ * \return  none.
+ */
+static void sf_ResetWindow(Port_t *thisport)
+{
+    thisport->txBusy    = 0;
+    thisport->SendState = SSP_IDLE;
+    memset(thisport->rxSlotSeq, 0, sizeof(thisport->rxSlotSeq));
 }
 
 /*!
@@ -475,19 +606,21 @@ void sf_MakePacket(uint8_t *txBuf, const uint8_t *pdata, uint16_t length,
  * \brief   sends out an ack packet to given sequence number
  * \param   thisport = which port to use
  * \param	seqNumber = sequence number of the packet we would like to ack
+ * \param	pdata = optional ack data, only used to answer a synch request
+ * \param	length = number of ack data bytes, at most 1
  * \return  none.
  *
  * \note
  *
  */
 
-static void sf_SendAckPacket(Port_t *thisport, uint8_t seqNumber)
+static void sf_SendAckPacket(Port_t *thisport, uint8_t seqNumber, const uint8_t *pdata, uint16_t length)
 {
     uint8_t AckSeqNumber = SETBIT(seqNumber, ACK_BIT);
 
     // create the packet, note we pass AckSequenceNumber directly
-    sf_MakePacket(thisport->txBuf, NULL, 0, AckSeqNumber);
-    sf_SendPacket(thisport);
+    sf_MakePacket(thisport->ackBuf, pdata, length, AckSeqNumber);
+    sf_SendPacket(thisport, thisport->ackBuf);
     // we don't set the timeout for an ACK because we don't ACK our ACKs in this protocol
 }
 
@@ -552,36 +685,38 @@ static uint16_t sf_checksum(uint16_t crc, uint8_t data)
 /*!
  * \brief   sets the timeout for the given packet
  * \param   thisport = which port to use
+ * \param	slot = transmit slot holding the packet
  * \return  none.
  *
  * \note
  *
  */
 
-static void sf_SetSendTimeout(Port_t *thisport)
+static void sf_SetSendTimeout(Port_t *thisport, uint8_t slot)
 {
     uint32_t timeout;
 
     timeout = thisport->pfGetTime() + thisport->timeoutLen;
-    thisport->timeout = timeout;
+    thisport->txSlotTimeout[slot] = timeout;
 }
 
 /*!
  * \brief   checks to see if a timeout occured
  * \param   thisport = which port to use
+ * \param	slot = transmit slot holding the packet
  * \return  true = a timeout has occurred
  * \return	false = has not timed out
  *
  * \note
  *
  */
-static uint16_t sf_CheckTimeout(Port_t *thisport)
+static uint16_t sf_CheckTimeout(Port_t *thisport, uint8_t slot)
 {
     uint16_t retval = FALSE;
     uint32_t current_time;
 
     current_time = thisport->pfGetTime();
-    if (current_time > thisport->timeout) {
+    if (current_time > thisport->txSlotTimeout[slot]) {
         retval = TRUE;
     }
     return retval;
@@ -753,13 +888,24 @@ static int16_t sf_ReceivePacket(Port_t *thisport)
     int16_t value = FALSE;
 
     if (ISBITSET(thisport->rxBuf[SEQNUM], ACK_BIT)) {
-        // Received an ACK packet, need to check if it matches the previous sent packet
-        if ((thisport->rxBuf[SEQNUM] & 0x7F) == (thisport->txSeqNo & 0x7f)) {
-            // It matches the last packet sent by us
-            SETBIT(thisport->txSeqNo, ACK_BIT);
-            thisport->SendState = SSP_ACKED;
-
-            value = FALSE;
+        // Received an ACK packet, need to check if it matches a packet in flight
+        uint8_t seqNo = thisport->rxBuf[SEQNUM] & 0x7F;
+        for (uint8_t slot = 0; slot < thisport->txWindow; slot++) {
+            if (ISBITSET(thisport->txBusy, 1 << slot) && thisport->txSlotSeq[slot] == seqNo) {
+                CLEARBIT(thisport->txBusy, 1 << slot);
+                thisport->SendState = SSP_ACKED;
+                if (seqNo == 0) {
+                    // ack of our synch, carries the receive window of a peer that supports windows
+                    if (thisport->rxBufLen > 0) {
+                        sf_SetLimits(thisport, &thisport->rxBuf[DATA]);
+                        thisport->rxSeqNo = 0;
+                    } else {
+                        sf_SetLimits(thisport, NULL);
+                    }
+                    CLEARBIT(thisport->flags, RESYNCH);
+                }
+                break;
+            }
         }
         // else ignore the ACK packet
     } else {
@@ -769,12 +915,25 @@ static int16_t sf_ReceivePacket(Port_t *thisport)
 #ifdef ACTIVE_SYNCH
             thisport->sendSynch = TRUE;
 #endif
-            sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM]);
+            sf_ResetWindow(thisport);
+            if (thisport->rxBufLen > 0) {
+                // the host supports windows, answer with our receive window and restart our sequence
+                sf_SetLimits(thisport, &thisport->rxBuf[DATA]);
+                thisport->txSeqNo = 0;
+                sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM], &thisport->rxWindow, 1);
+            } else {
+                sf_SetLimits(thisport, NULL);
+                sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM], NULL, 0);
+            }
+            // both directions start over, a synch we were about to send is not needed
+            CLEARBIT(thisport->flags, RESYNCH);
             thisport->rxSeqNo   = 0;
             value = FALSE;
+        } else if (thisport->rxLimit > 0) {
+            value = sf_ReceiveWindowed(thisport);
         } else if (thisport->rxBuf[SEQNUM] == thisport->rxSeqNo) {
             // Already seen this packet, just ack it, don't act on the packet.
-            sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM]);
+            sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM], NULL, 0);
             value = FALSE;
         } else {
             // New Packet
@@ -787,9 +946,78 @@ static int16_t sf_ReceivePacket(Port_t *thisport)
             // after we send the ACK, it is possible for the host to send a new packet.
             // Thus the application needs to copy the data and reset the receive buffer
             // inside of thisport->pfCallBack()
-            sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM]);
+            sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM], NULL, 0);
             value = TRUE;
         }
     }
     return value;
 }
+
+/*!
+ * \brief   receive one data packet once a window has been agreed on
+ * \param   thisport = which port to use
+ * \return  true = new data was passed to the application
+ * \return	false = otherwise
+ *
+ * \note
+ * The next packet in sequence is passed to the callback together with any held packets
+ * that follow it. A packet ahead of the next one is copied into a free receive slot and
+ * acked, so the sender does not resend it. Any other packet is a resend of one whose ack
+ * was lost, or a stale copy from before a synch, and is only acked again.
+ */
+static int16_t sf_ReceiveWindowed(Port_t *thisport)
+{
+    uint8_t seqNo    = thisport->rxBuf[SEQNUM];
+    uint8_t distance = SEQDISTANCE(NEXTSEQNO(thisport->rxSeqNo), seqNo);
+    int16_t value    = FALSE;
+
+    if (distance == 0) {
+        thisport->rxSeqNo = seqNo;
+        if (thisport->pfCallBack != NULL) {
+            thisport->pfCallBack(&(thisport->rxBuf[DATA]), thisport->rxBufLen);
+        }
+        for (uint8_t slot = 1; slot < thisport->rxWindow;) {
+            if (thisport->rxSlotSeq[slot] == NEXTSEQNO(thisport->rxSeqNo)) {
+                thisport->rxSeqNo = thisport->rxSlotSeq[slot];
+                thisport->rxSlotSeq[slot] = 0;
+                if (thisport->pfCallBack != NULL) {
+                    thisport->pfCallBack(RXSLOT(thisport, slot), thisport->rxSlotLen[slot]);
+                }
+                slot = 1; // the next one may sit in any slot
+            } else {
+                slot++;
+            }
+        }
+        // a held packet that is not ahead of the window any more would be taken for a
+        // new one once the sequence numbers wrap, drop it
+        for (uint8_t slot = 1; slot < thisport->rxWindow; slot++) {
+            if (thisport->rxSlotSeq[slot] != 0 &&
+                SEQDISTANCE(NEXTSEQNO(thisport->rxSeqNo), thisport->rxSlotSeq[slot]) >= thisport->rxLimit) {
+                thisport->rxSlotSeq[slot] = 0;
+            }
+        }
+        sf_SendAckPacket(thisport, seqNo, NULL, 0);
+        value = TRUE;
+    } else if (distance < thisport->rxLimit) {
+        // slot 0 is the receive buffer itself, 1..rxWindow-1 hold packets ahead of a gap
+        uint8_t freeSlot = 0;
+        for (uint8_t slot = 1; slot < thisport->rxWindow; slot++) {
+            if (thisport->rxSlotSeq[slot] == seqNo) {
+                freeSlot = slot; // already held, just ack it again
+                break;
+            } else if (thisport->rxSlotSeq[slot] == 0 && freeSlot == 0) {
+                freeSlot = slot;
+            }
+        }
+        if (freeSlot != 0) {
+            memcpy(RXSLOT(thisport, freeSlot), &(thisport->rxBuf[DATA]), thisport->rxBufLen);
+            thisport->rxSlotLen[freeSlot] = thisport->rxBufLen;
+            thisport->rxSlotSeq[freeSlot] = seqNo;
+            sf_SendAckPacket(thisport, seqNo, NULL, 0);
+        }
+    } else {
+        // Already seen this packet, or it is outside the window, just ack it, don't act on the packet.
+        sf_SendAckPacket(thisport, seqNo, NULL, 0);
+    }
+    return value;
+}
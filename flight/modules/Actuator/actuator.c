@@ -45,6 +45,7 @@
 #include "cameradesired.h"
 #include "manualcontrolcommand.h"
 #include "taskinfo.h"
+#include <mathmisc.h>
 #undef PIOS_INCLUDE_INSTRUMENTATION
 #ifdef PIOS_INCLUDE_INSTRUMENTATION
 #include <pios_instrumentation.h>
@@ -69,12 +70,37 @@ static int8_t counter;
 
 #define ACTUATOR_ONESHOT125_CLOCK       2000000
 #define ACTUATOR_ONESHOT125_PULSE_SCALE 4
+// Multishot maps 1000-2000 to 5-25us, timer ticks are 1/12us
+#define ACTUATOR_MULTISHOT_CLOCK        12000000
+#define ACTUATOR_MULTISHOT_PULSE(value) (60 + (((int32_t)(value) - 1000) * 6) / 25)
 #define ACTUATOR_PWM_CLOCK              1000000
+#define MIXER_CURVE_SEGMENTS            (MIXERSETTINGS_THROTTLECURVE1_NUMELEM - 1)
+
+#if MIXERSETTINGS_THROTTLECURVE1_NUMELEM != MIXERSETTINGS_THROTTLECURVE2_NUMELEM
+#error "Both throttle curves must have the same number of points"
+#endif
+
 // Private types
 
+// a throttle curve as one line per segment, input clamped to [lower, upper]
+typedef struct {
+    float slope[MIXER_CURVE_SEGMENTS];
+    float intercept[MIXER_CURVE_SEGMENTS];
+    float lower;
+    float upper;
+} MixerCurve_t;
+
+// scaling of one channel from -1/+1 to a pulse
+typedef struct {
+    float   positive;
+    float   negative;
+    int16_t neutral;
+    int16_t lower;
+    int16_t upper;
+} ChannelScale_t;
 
 // Private variables
-static xQueueHandle queue;
+static UAVObjEventSubscriber subscriber;
 static xTaskHandle taskHandle;
 
 static float lastResult[MAX_MIX_ACTUATORS] = { 0 };
@@ -85,18 +111,31 @@ static volatile bool actuator_settings_updated;
 // used to inform the actuator thread that mixer settings are changed
 static volatile bool mixer_settings_updated;
 
+// mixer rows scaled to floats, rebuilt only when MixerSettings change
+static float mixerMatrix[MAX_MIX_ACTUATORS][MIXERSETTINGS_MIXER1VECTOR_NUMELEM];
+static float mixerInvAccelTime;
+static float mixerInvDecelTime;
+static int mixerCount;
+static MixerCurve_t mixerCurve1;
+static MixerCurve_t mixerCurve2;
+
+// channel scaling, rebuilt only when ActuatorSettings change
+static ChannelScale_t channelScale[MAX_MIX_ACTUATORS];
+
 // Private functions
 static void actuatorTask(void *parameters);
-static int16_t scaleChannel(float value, int16_t max, int16_t min, int16_t neutral);
+static int16_t scaleChannel(float value, int index);
 static void setFailsafe(const ActuatorSettingsData *actuatorSettings, const MixerSettingsData *mixerSettings);
-static float MixerCurve(const float throttle, const float *curve, uint8_t elements);
+static inline float MixerCurve(const float input, const MixerCurve_t *curve);
+static void updateMixerCurve(MixerCurve_t *curve, const float *points);
 static bool set_channel(uint8_t mixer_channel, uint16_t value, const ActuatorSettingsData *actuatorSettings);
 static void actuator_update_rate_if_changed(const ActuatorSettingsData *actuatorSettings, bool force_update);
 static void MixerSettingsUpdatedCb(UAVObjEvent *ev);
 static void ActuatorSettingsUpdatedCb(UAVObjEvent *ev);
-float ProcessMixer(const int index, const float curve1, const float curve2,
-                   const MixerSettingsData *mixerSettings, ActuatorDesiredData *desired,
-                   const float period);
+static void updateMixerMatrix(const MixerSettingsData *mixerSettings);
+static void updateChannelScale(const ActuatorSettingsData *actuatorSettings);
+float ProcessMixer(const int index, const float input[MIXERSETTINGS_MIXER1VECTOR_NUMELEM],
+                   const MixerSettingsData *mixerSettings, const float period);
 
 // this structure is equivalent to the UAVObjects for one mixer.
 typedef struct {
@@ -135,8 +174,10 @@ int32_t ActuatorInitialize()
 
     // Listen for ActuatorDesired updates (Primary input to this module)
     ActuatorDesiredInitialize();
-    queue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
-    ActuatorDesiredConnectQueue(queue);
+    if (UAVObjSubscriberInit(&subscriber, MAX_QUEUE_SIZE, true) != 0) {
+        return -1;
+    }
+    ActuatorDesiredConnectSubscriber(&subscriber);
 
     // Register AccessoryDesired (Secondary input to this module)
     AccessoryDesiredInitialize();
@@ -168,7 +209,7 @@ MODULE_INITCALL(ActuatorInitialize, ActuatorStart);
  */
 static void actuatorTask(__attribute__((unused)) void *parameters)
 {
-    UAVObjEvent ev;
+    UAVObjEventNode *ev;
     portTickType lastSysTime;
     portTickType thisSysTime;
     float dTSeconds;
@@ -190,11 +231,13 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
 
     actuator_settings_updated = false;
     ActuatorSettingsGet(&actuatorSettings);
+    updateChannelScale(&actuatorSettings);
 
     /* Read initial values of MixerSettings */
     MixerSettingsData mixerSettings;
     mixer_settings_updated = false;
     MixerSettingsGet(&mixerSettings);
+    updateMixerMatrix(&mixerSettings);
 
     /* Force an initial configuration of the actuator update rates */
     actuator_update_rate_if_changed(&actuatorSettings, true);
@@ -210,7 +253,12 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
 #endif
 
         // Wait until the ActuatorDesired object is updated
-        uint8_t rc = xQueueReceive(queue, &ev, FAILSAFE_TIMEOUT_MS / portTICK_RATE_MS);
+        ev = UAVObjSubscriberReceive(&subscriber, FAILSAFE_TIMEOUT_MS / portTICK_RATE_MS);
+        uint8_t rc = ev ? pdTRUE : pdFALSE;
+        if (ev) {
+            // only the update matters, the data are read below
+            UAVObjSubscriberRelease(ev);
+        }
 #ifdef PIOS_INCLUDE_INSTRUMENTATION
         PIOS_Instrumentation_TimeStart(counter);
 #endif
@@ -218,11 +266,13 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
         if (actuator_settings_updated) {
             actuator_settings_updated = false;
             ActuatorSettingsGet(&actuatorSettings);
+            updateChannelScale(&actuatorSettings);
             actuator_update_rate_if_changed(&actuatorSettings, false);
         }
         if (mixer_settings_updated) {
             mixer_settings_updated = false;
             MixerSettingsGet(&mixerSettings);
+            updateMixerMatrix(&mixerSettings);
         }
 
         if (rc != pdTRUE) {
@@ -279,14 +329,8 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
 #ifdef DIAG_MIXERSTATUS
         MixerStatusGet(&mixerStatus);
 #endif
-        int nMixers     = 0;
         Mixer_t *mixers = (Mixer_t *)&mixerSettings.Mixer1Type;
-        for (int ct = 0; ct < MAX_MIX_ACTUATORS; ct++) {
-            if (mixers[ct].type != MIXERSETTINGS_MIXER1TYPE_DISABLED) {
-                nMixers++;
-            }
-        }
-        if ((nMixers < 2) && !ActuatorCommandReadOnly()) { // Nothing can fly with less than two mixers.
+        if ((mixerCount < 2) && !ActuatorCommandReadOnly()) { // Nothing can fly with less than two mixers.
             setFailsafe(&actuatorSettings, &mixerSettings); // So that channels like PWM buzzer keep working
             continue;
         }
@@ -297,28 +341,26 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
         bool positiveThrottle = (throttleDesired > 0.00f);
         bool spinWhileArmed   = actuatorSettings.MotorsSpinWhileArmed == ACTUATORSETTINGS_MOTORSSPINWHILEARMED_TRUE;
 
-        float curve1 = MixerCurve(throttleDesired, mixerSettings.ThrottleCurve1, MIXERSETTINGS_THROTTLECURVE1_NUMELEM);
+        float curve1 = MixerCurve(throttleDesired, &mixerCurve1);
 
         // The source for the secondary curve is selectable
         float curve2 = 0;
         AccessoryDesiredData accessory;
         switch (mixerSettings.Curve2Source) {
         case MIXERSETTINGS_CURVE2SOURCE_THROTTLE:
-            curve2 = MixerCurve(throttleDesired, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            curve2 = MixerCurve(throttleDesired, &mixerCurve2);
             break;
         case MIXERSETTINGS_CURVE2SOURCE_ROLL:
-            curve2 = MixerCurve(desired.Roll, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            curve2 = MixerCurve(desired.Roll, &mixerCurve2);
             break;
         case MIXERSETTINGS_CURVE2SOURCE_PITCH:
-            curve2 = MixerCurve(desired.Pitch, mixerSettings.ThrottleCurve2,
-                                MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            curve2 = MixerCurve(desired.Pitch, &mixerCurve2);
             break;
         case MIXERSETTINGS_CURVE2SOURCE_YAW:
-            curve2 = MixerCurve(desired.Yaw, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            curve2 = MixerCurve(desired.Yaw, &mixerCurve2);
             break;
         case MIXERSETTINGS_CURVE2SOURCE_COLLECTIVE:
-            curve2 = MixerCurve(collectiveDesired, mixerSettings.ThrottleCurve2,
-                                MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            curve2 = MixerCurve(collectiveDesired, &mixerCurve2);
             break;
         case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY0:
         case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY1:
@@ -327,13 +369,22 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
         case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY4:
         case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY5:
             if (AccessoryDesiredInstGet(mixerSettings.Curve2Source - MIXERSETTINGS_CURVE2SOURCE_ACCESSORY0, &accessory) == 0) {
-                curve2 = MixerCurve(accessory.AccessoryVal, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+                curve2 = MixerCurve(accessory.AccessoryVal, &mixerCurve2);
             } else {
                 curve2 = 0;
             }
             break;
         }
 
+        // mixer input vector, in MixerSettings MixerVector order
+        const float input[MIXERSETTINGS_MIXER1VECTOR_NUMELEM] = {
+            [MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1] = curve1,
+            [MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE2] = curve2,
+            [MIXERSETTINGS_MIXER1VECTOR_ROLL]  = desired.Roll,
+            [MIXERSETTINGS_MIXER1VECTOR_PITCH] = desired.Pitch,
+            [MIXERSETTINGS_MIXER1VECTOR_YAW]   = desired.Yaw,
+        };
+
         float *status = (float *)&mixerStatus; // access status objects as an array of floats
 
         for (int ct = 0; ct < MAX_MIX_ACTUATORS; ct++) {
@@ -350,7 +401,7 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
             }
 
             if ((mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_MOTOR) || (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_REVERSABLEMOTOR) || (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_SERVO)) {
-                status[ct] = ProcessMixer(ct, curve1, curve2, &mixerSettings, &desired, dTSeconds);
+                status[ct] = ProcessMixer(ct, input, &mixerSettings, dTSeconds);
             } else {
                 status[ct] = -1;
             }
@@ -428,10 +479,7 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
         // will be set except explicitly disabled (which will have PWM pulse = 0).
         for (int i = 0; i < MAX_MIX_ACTUATORS; i++) {
             if (command.Channel[i]) {
-                command.Channel[i] = scaleChannel(status[i],
-                                                  actuatorSettings.ChannelMax[i],
-                                                  actuatorSettings.ChannelMin[i],
-                                                  actuatorSettings.ChannelNeutral[i]);
+                command.Channel[i] = scaleChannel(status[i], i);
             }
         }
 
@@ -471,21 +519,85 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
 }
 
 
+/**
+ * Convert the int8 mixer vectors to float rows with the 1/128 scale folded in,
+ * count the active mixers and invert the feed forward time constants.
+ */
+static void updateMixerMatrix(const MixerSettingsData *mixerSettings)
+{
+    const Mixer_t *mixers = (Mixer_t *)&mixerSettings->Mixer1Type; // pointer to array of mixers in UAVObjects
+
+    mixerCount = 0;
+    for (int ct = 0; ct < MAX_MIX_ACTUATORS; ct++) {
+        if (mixers[ct].type != MIXERSETTINGS_MIXER1TYPE_DISABLED) {
+            mixerCount++;
+        }
+        for (int i = 0; i < MIXERSETTINGS_MIXER1VECTOR_NUMELEM; i++) {
+            mixerMatrix[ct][i] = (float)mixers[ct].matrix[i] * (1.0f / 128.0f);
+        }
+    }
+    mixerInvAccelTime = 1.0f / mixerSettings->AccelTime;
+    mixerInvDecelTime = 1.0f / mixerSettings->DecelTime;
+    updateMixerCurve(&mixerCurve1, mixerSettings->ThrottleCurve1);
+    updateMixerCurve(&mixerCurve2, mixerSettings->ThrottleCurve2);
+}
+
+/**
+ * Convert the points of a throttle curve to the slope and intercept of each
+ * segment. A first point below -1 disables the curve, the input then passes
+ * through unchanged.
+ */
+static void updateMixerCurve(MixerCurve_t *curve, const float *points)
+{
+    if (points[0] < -1.0f) {
+        for (int i = 0; i < MIXER_CURVE_SEGMENTS; i++) {
+            curve->slope[i]     = 1.0f;
+            curve->intercept[i] = 0.0f;
+        }
+        curve->lower = -INFINITY;
+        curve->upper = INFINITY;
+        return;
+    }
+
+    for (int i = 0; i < MIXER_CURVE_SEGMENTS; i++) {
+        curve->slope[i]     = (points[i + 1] - points[i]) * (float)MIXER_CURVE_SEGMENTS;
+        curve->intercept[i] = points[i] - curve->slope[i] * ((float)i / (float)MIXER_CURVE_SEGMENTS);
+    }
+    curve->lower = 0.0f;
+    curve->upper = 1.0f;
+}
+
+/**
+ * Precompute the per channel scaling of scaleChannel()
+ */
+static void updateChannelScale(const ActuatorSettingsData *actuatorSettings)
+{
+    for (int i = 0; i < MAX_MIX_ACTUATORS; i++) {
+        int16_t max     = actuatorSettings->ChannelMax[i];
+        int16_t min     = actuatorSettings->ChannelMin[i];
+        int16_t neutral = actuatorSettings->ChannelNeutral[i];
+
+        channelScale[i].positive = (float)(max - neutral);
+        channelScale[i].negative = (float)(neutral - min);
+        channelScale[i].neutral  = neutral;
+        // reversed channels have max below min
+        channelScale[i].lower    = (max > min) ? min : max;
+        channelScale[i].upper    = (max > min) ? max : min;
+    }
+}
+
 /**
  * Process mixing for one actuator
  */
-float ProcessMixer(const int index, const float curve1, const float curve2,
-                   const MixerSettingsData *mixerSettings, ActuatorDesiredData *desired, const float period)
+float ProcessMixer(const int index, const float input[MIXERSETTINGS_MIXER1VECTOR_NUMELEM],
+                   const MixerSettingsData *mixerSettings, const float period)
 {
     static float lastFilteredResult[MAX_MIX_ACTUATORS];
     const Mixer_t *mixers = (Mixer_t *)&mixerSettings->Mixer1Type; // pointer to array of mixers in UAVObjects
     const Mixer_t *mixer  = &mixers[index];
+    const float *row = mixerMatrix[index];
 
-    float result = ((((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1]) * curve1) +
-                    (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE2]) * curve2) +
-                    (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_ROLL]) * desired->Roll) +
-                    (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_PITCH]) * desired->Pitch) +
-                    (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_YAW]) * desired->Yaw)) / 128.0f;
+    float result = row[0] * input[0] + row[1] * input[1] + row[2] * input[2] + row[3] * input[3] + row[4] * input[4];
 
     // note: no feedforward for reversable motors yet for safety reasons
     if (mixer->type == MIXERSETTINGS_MIXER1TYPE_MOTOR) {
@@ -500,13 +612,13 @@ float ProcessMixer(const int index, const float curve1, const float curve2,
         result += accumulator;
         if (period > 0.0f) {
             if (accumulator > 0.0f) {
-                float invFilter = period / mixerSettings->AccelTime;
+                float invFilter = period * mixerInvAccelTime;
                 if (invFilter > 1) {
                     invFilter = 1;
                 }
                 accumulator -= accumulator * invFilter;
             } else {
-                float invFilter = period / mixerSettings->DecelTime;
+                float invFilter = period * mixerInvDecelTime;
                 if (invFilter > 1) {
                     invFilter = 1;
                 }
@@ -530,61 +642,32 @@ float ProcessMixer(const int index, const float curve1, const float curve2,
 
 
 /**
- * Interpolate a throttle curve. Throttle input should be in the range 0 to 1.
- * Output is in the range 0 to 1.
+ * Interpolate a throttle curve. Input should be in the range 0 to 1 and is
+ * clamped to it, output is in the range 0 to 1.
  */
-static float MixerCurve(const float throttle, const float *curve, uint8_t elements)
+static inline float MixerCurve(const float input, const MixerCurve_t *curve)
 {
-    float scale = throttle * (float)(elements - 1);
-    int idx1    = scale;
+    const float x = boundf(input, curve->lower, curve->upper);
+    int segment   = (int)(boundf(x, 0.0f, 1.0f) * (float)MIXER_CURVE_SEGMENTS);
 
-    scale -= (float)idx1; // remainder
-    if (curve[0] < -1) {
-        return throttle;
-    }
-    if (idx1 < 0) {
-        idx1  = 0; // clamp to lowest entry in table
-        scale = 0;
-    }
-    int idx2 = idx1 + 1;
-    if (idx2 >= elements) {
-        idx2 = elements - 1; // clamp to highest entry in table
-        if (idx1 >= elements) {
-            idx1 = elements - 1;
-        }
-    }
-    return curve[idx1] * (1.0f - scale) + curve[idx2] * scale;
+    segment -= (segment >= MIXER_CURVE_SEGMENTS); // the last point ends the last segment
+    return curve->slope[segment] * x + curve->intercept[segment];
 }
 
 
 /**
  * Convert channel from -1/+1 to servo pulse duration in microseconds
  */
-static int16_t scaleChannel(float value, int16_t max, int16_t min, int16_t neutral)
+static int16_t scaleChannel(float value, int index)
 {
-    int16_t valueScaled;
+    const ChannelScale_t *scale = &channelScale[index];
+    int16_t valueScaled = (int16_t)(value * ((value >= 0.0f) ? scale->positive : scale->negative)) + scale->neutral;
 
-    // Scale
-    if (value >= 0.0f) {
-        valueScaled = (int16_t)(value * ((float)(max - neutral))) + neutral;
-    } else {
-        valueScaled = (int16_t)(value * ((float)(neutral - min))) + neutral;
+    if (valueScaled > scale->upper) {
+        valueScaled = scale->upper;
     }
-
-    if (max > min) {
-        if (valueScaled > max) {
-            valueScaled = max;
-        }
-        if (valueScaled < min) {
-            valueScaled = min;
-        }
-    } else {
-        if (valueScaled < max) {
-            valueScaled = max;
-        }
-        if (valueScaled > min) {
-            valueScaled = min;
-        }
+    if (valueScaled < scale->lower) {
+        valueScaled = scale->lower;
     }
 
     return valueScaled;
@@ -744,6 +827,10 @@ static bool set_channel(uint8_t mixer_channel, uint16_t value, const ActuatorSet
             // Remap 1000-2000 range to 125-250
             PIOS_Servo_Set(actuatorSettings->ChannelAddr[mixer_channel], value / ACTUATOR_ONESHOT125_PULSE_SCALE);
             break;
+        case ACTUATORSETTINGS_BANKMODE_MULTISHOT:
+            // Remap 1000-2000 range to 5-25us
+            PIOS_Servo_Set(actuatorSettings->ChannelAddr[mixer_channel], ACTUATOR_MULTISHOT_PULSE(value));
+            break;
         default:
             PIOS_Servo_Set(actuatorSettings->ChannelAddr[mixer_channel], value);
             break;
@@ -797,6 +884,10 @@ static void actuator_update_rate_if_changed(const ActuatorSettingsData *actuator
                 freq[i]  = 100; // Value must be small enough so CCr isn't update until the PIOS_Servo_Update is triggered
                 clock[i] = ACTUATOR_ONESHOT125_CLOCK; // Setup an 2MHz timer clock
                 break;
+            case ACTUATORSETTINGS_BANKMODE_MULTISHOT:
+                freq[i]  = 200; // lowest rate that keeps the 12MHz period within a 16 bit timer
+                clock[i] = ACTUATOR_MULTISHOT_CLOCK;
+                break;
             case ACTUATORSETTINGS_BANKMODE_PWMSYNC:
                 freq[i]  = 100;
                 clock[i] = ACTUATOR_PWM_CLOCK;
@@ -69,8 +69,14 @@
 #include "CoordinateConversions.h"
 #include <pios_notify.h>
 #include <mathmisc.h>
+#ifdef PIOS_ATTITUDE_FIXED_POINT
+#include <fixed_quat.h>
+#endif
 #include <pios_constants.h>
 #include <pios_instrumentation_helper.h>
+#ifdef PIOS_STABILIZATION_GYRO_DIRECT
+#include <gyrodirect.h>
+#endif
 
 PERF_DEFINE_COUNTER(counterUpd);
 PERF_DEFINE_COUNTER(counterAccelSamples);
@@ -83,7 +89,12 @@ PERF_DEFINE_COUNTER(counterAtt);
 // - 0xA7710004 number of accel samples read for each loop (cc only).
 
 // Private constants
+#ifdef PIOS_STABILIZATION_GYRO_DIRECT
+// the stabilization inner loop runs on this stack
+#define STACK_SIZE_BYTES    1340
+#else
 #define STACK_SIZE_BYTES    540
+#endif
 #define TASK_PRIORITY       (tskIDLE_PRIORITY + 3)
 
 // Attitude module loop interval (defined by sensor rate in pios_config.h)
@@ -130,6 +141,11 @@ static float yawBiasRate = 0;
 static float rollPitchBiasRate = 0.0f;
 static AccelGyroSettingsaccel_biasData accel_bias;
 static float q[4] = { 1, 0, 0, 0 };
+#ifdef PIOS_ATTITUDE_FIXED_POINT
+// the filter state, q is only the published copy
+static fix30_t qfix[4] = { FIX30_ONE, 0, 0, 0 };
+static fix30_t grot_fix_filtered[3];
+#endif
 static float R[3][3];
 static int8_t rotate = 0;
 static bool zero_during_arming = false;
@@ -214,6 +230,12 @@ int32_t AttitudeInitialize(void)
     q[1] = 0;
     q[2] = 0;
     q[3] = 0;
+#ifdef PIOS_ATTITUDE_FIXED_POINT
+    qfix[0] = FIX30_ONE;
+    qfix[1] = 0;
+    qfix[2] = 0;
+    qfix[3] = 0;
+#endif
     for (uint8_t i = 0; i < 3; i++) {
         for (uint8_t j = 0; j < 3; j++) {
             R[i][j] = 0;
@@ -456,6 +478,9 @@ static int32_t updateSensors(AccelStateData *accelState, GyroStateData *gyros)
     PERF_TIMED_SECTION_END(counterUpd);
 
     GyroStateSet(gyros);
+#ifdef PIOS_STABILIZATION_GYRO_DIRECT
+    gyrodirect_publish(&gyros->x);
+#endif
     AccelStateSet(accelState);
 
     return 0;
@@ -586,6 +611,9 @@ static int32_t updateSensorsCC3D(AccelStateData *accelStateData, GyroStateData *
     gyro_correct_int[2] += -gyrosData->z * yawBiasRate;
     PERF_TIMED_SECTION_END(counterUpd);
     GyroStateSet(gyrosData);
+#ifdef PIOS_STABILIZATION_GYRO_DIRECT
+    gyrodirect_publish(&gyrosData->x);
+#endif
     AccelStateSet(accelStateData);
 
     return 0;
@@ -604,6 +632,87 @@ static inline void apply_accel_filter(const float *raw, float *filtered)
     }
 }
 
+#ifdef PIOS_ATTITUDE_FIXED_POINT
+/**
+ * Same complementary filter as below, with the quaternion kept in Q2.30 so the
+ * integration and normalization run in integer math on targets without FPU.
+ * Only the accel low pass and the gains stay in float.
+ */
+__attribute__((optimize("O3"))) static void updateAttitude(AccelStateData *accelStateData, GyroStateData *gyrosData)
+{
+    float dT      = PIOS_DELTATIME_GetAverageSeconds(&dtconfig);
+
+    float *gyros  = &gyrosData->x;
+    float *accels = &accelStateData->x;
+
+    fix16_t accel_fix[3];
+    fix30_t grot[3];
+    fix30_t accel_err[3];
+
+    // Apply smoothing to accel values, to reduce vibration noise before main calculations.
+    apply_accel_filter(accels, accels_filtered);
+    accel_fix[0] = fix16_from_float(accels_filtered[0]);
+    accel_fix[1] = fix16_from_float(accels_filtered[1]);
+    accel_fix[2] = fix16_from_float(accels_filtered[2]);
+
+    // Rotate gravity unit vector to body frame, filter and cross with accels
+    fixquat_gravity(qfix, grot);
+    if (accel_filter_enabled) {
+        const fix30_t alpha = fix30_from_float(accel_alpha);
+        for (uint8_t i = 0; i < 3; i++) {
+            grot_fix_filtered[i] = fix30_mul(grot_fix_filtered[i], alpha) + fix30_mul(grot[i], FIX30_ONE - alpha);
+        }
+    } else {
+        grot_fix_filtered[0] = grot[0];
+        grot_fix_filtered[1] = grot[1];
+        grot_fix_filtered[2] = grot[2];
+    }
+
+    // Normalizes both vectors, fails if the accel or filtered gravity magnitude is too small
+    if (fixquat_accel_error(accel_fix, grot_fix_filtered, accel_err) != 0) {
+        return;
+    }
+
+    // Accumulate integral of error.  Scale here so that units are (deg/s) but Ki has units of s
+    gyro_correct_int[0] += fix30_to_float(accel_err[0]) * accelKi;
+    gyro_correct_int[1] += fix30_to_float(accel_err[1]) * accelKi;
+
+    // Correct rates based on error, integral component dealt with in updateSensors.
+    // The Kp / dT correction times dT leaves Kp, so it is applied directly to the step angle.
+    const fix30_t kp = fix30_from_float(accelKp * (M_PI_F / 180.0f / 2.0f));
+    const float gyro_scale = dT * (M_PI_F / 180.0f / 2.0f);
+    fix30_t half_dtheta[3];
+    half_dtheta[0] = fix30_from_float(gyros[0] * gyro_scale) + fix30_mul(accel_err[0], kp);
+    half_dtheta[1] = fix30_from_float(gyros[1] * gyro_scale) + fix30_mul(accel_err[1], kp);
+    half_dtheta[2] = fix30_from_float(gyros[2] * gyro_scale) + fix30_mul(accel_err[2], kp);
+
+    fixquat_integrate(qfix, half_dtheta);
+
+    // If quaternion has become inappropriately short reinit.
+    // THIS SHOULD NEVER ACTUALLY HAPPEN
+    if (fixquat_normalize(qfix) != 0) {
+        qfix[0] = FIX30_ONE;
+        qfix[1] = 0;
+        qfix[2] = 0;
+        qfix[3] = 0;
+    }
+
+    q[0] = fix30_to_float(qfix[0]);
+    q[1] = fix30_to_float(qfix[1]);
+    q[2] = fix30_to_float(qfix[2]);
+    q[3] = fix30_to_float(qfix[3]);
+
+    AttitudeStateData attitudeState;
+    AttitudeStateGet(&attitudeState);
+
+    quat_copy(q, &attitudeState.q1);
+
+    // Convert into eueler degrees (makes assumptions about RPY order)
+    Quaternion2RPYFast(&attitudeState.q1, &attitudeState.Roll);
+
+    AttitudeStateSet(&attitudeState);
+}
+#else /* PIOS_ATTITUDE_FIXED_POINT */
 __attribute__((optimize("O3"))) static void updateAttitude(AccelStateData *accelStateData, GyroStateData *gyrosData)
 {
     float dT      = PIOS_DELTATIME_GetAverageSeconds(&dtconfig);
@@ -708,10 +817,11 @@ __attribute__((optimize("O3"))) static void updateAttitude(AccelStateData *accel
     quat_copy(q, &attitudeState.q1);
 
     // Convert into eueler degrees (makes assumptions about RPY order)
-    Quaternion2RPY(&attitudeState.q1, &attitudeState.Roll);
+    Quaternion2RPYFast(&attitudeState.q1, &attitudeState.Roll);
 
     AttitudeStateSet(&attitudeState);
 }
+#endif /* PIOS_ATTITUDE_FIXED_POINT */
 
 static void settingsUpdatedCb(__attribute__((unused)) UAVObjEvent *objEv)
 {
@@ -3,13 +3,13 @@
  * @addtogroup OpenPilotModules OpenPilot Modules
  * @{
  * @addtogroup Autotuning module
- * @brief Reads from @ref ManualControlCommand and fakes a rate mode while
- *        toggling the channels to relay mode
+ * @brief Identifies the rate plant of each axis in flight and computes the
+ *        PIDs from it
  * @{
  *
  * @file       autotune.c
  * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2012.
- * @brief      Module to handle all comms to the AHRS on a periodic basis.
+ * @brief      Recursive least squares identification of the rate plant.
  *
  * @see        The GNU Public License (GPL) Version 3
  *
@@ -31,49 +31,118 @@
  */
 
 /**
- * Input objects: None, takes sensor data via pios
- * Output objects: @ref AttitudeRaw @ref AttitudeActual
+ * Input objects: @ref ActuatorDesired, @ref GyroState, @ref SystemIdentSettings
+ * Output objects: @ref SystemIdent
  *
- * This module computes an attitude estimate from the sensor data
+ * Every ActuatorDesired update of the stabilization loop is paired with the
+ * gyro and collected into double buffered batches, while armed and above
+ * SystemIdentSettings MinThrust. A low priority callback runs the batches
+ * through a recursive least squares fit per axis of
  *
- * The module executes in its own thread.
+ *   y[k] = a * y[k-1] + b * u[k-1-d] + c
  *
- * UAVObjects are automatically generated by the UAVObjectGenerator from
- * the object definition XML file.
+ * where y is the change of the rate over a sample and u the actuator. This
+ * is an angular acceleration proportional to the actuator behind a first
+ * order lag (the motors) and a delay of d samples, c takes up the trims and
+ * the gyro bias. A fit runs for each delay candidate and the one predicting
+ * the samples best gives the delay. Normal flying with some stick input is
+ * all the excitation it needs, nothing is ever commanded by this module.
  *
- * Modules have no API, all communication to other modules is done through UAVObjects.
- * However modules may use the API exposed by shared libraries.
- * See the OpenPilot wiki for more details.
- * http://www.openpilot.org/OpenPilot_Application_Architecture
+ * Differencing the gyro leaves mostly noise in y, and with the measured
+ * y[k-1] as a regressor that noise drags a towards zero. The regressor is
+ * the model's own prediction instead (pseudo linear regression of the output
+ * error), and the rate and the actuator both go through the same low pass
+ * first, which leaves the model between them as it is.
  *
+ * The rate PID is placed for a crossover at SystemIdentSettings
+ * CrossoverRatio over the lag plus the delay, the attitude loop a fraction
+ * AttitudeRatio of it. The gains are published in @ref SystemIdent and never
+ * applied here, the GCS applies them to a bank once the pilot is happy.
+ *
+ * With SystemIdentSettings Stream enabled every batch also goes out as one
+ * @ref SampleStream update, for the analysis of the whole flight in the GCS.
+ * One object update per sample would spend most of the link on framing, and
+ * the telemetry could not keep up with the loop rate anyway.
  */
 
 #include <openpilot.h>
 
+#include "actuatordesired.h"
+#include "callbackinfo.h"
 #include "flightstatus.h"
+#include "gyrostate.h"
 #include "hwsettings.h"
-#include "manualcontrolcommand.h"
-#include "manualcontrolsettings.h"
-#include "relaytuning.h"
-#include "relaytuningsettings.h"
-#include "stabilizationdesired.h"
-#include "stabilizationsettings.h"
-#include "taskinfo.h"
+#include "samplestream.h"
+#include "systemident.h"
+#include "systemidentsettings.h"
 
 // Private constants
-#define STACK_SIZE_BYTES 1024
-#define TASK_PRIORITY    (tskIDLE_PRIORITY + 2)
+#define CALLBACK_PRIORITY CALLBACK_PRIORITY_LOW
+#define CBTASK_PRIORITY   CALLBACK_TASK_AUXILIARY
+#define STACK_SIZE_BYTES  768
+
+// samples per batch, a batch is streamed as one update
+#define BATCH_SIZE        SAMPLESTREAM_GYROROLL_NUMELEM
+// delay candidates, in samples
+#define DELAYS            6
+// initial covariance, and the bound keeping it from winding up without excitation
+#define P_INIT            100.0f
+#define P_MAX             10000.0f
+// the D term zero sits at twice the plant lag pole
+#define KD_TAU_RATIO      0.5f
+// the integral zero a decade below the crossover
+#define KI_RATIO          0.1f
+// low pass on the rate and the actuator ahead of the fits
+#define PREFILTER_HZ      30.0f
 
 // Private types
-enum AUTOTUNE_STATE { AT_INIT, AT_START, AT_ROLL, AT_PITCH, AT_FINISHED, AT_SET };
+struct sample {
+    float gyro[3];
+    float actuator[3];
+};
+
+struct rls {
+    float theta[3]; // a, b, c
+    float P[3][3];
+    float error; // low passed square of the a priori error
+    float prediction; // of y by this fit, the regressor of the next sample
+};
+
+struct axis {
+    struct rls fit[DELAYS];
+    float actuator[DELAYS]; // most recent first, filtered
+    float filtered;
+    float rate;
+};
 
 // Private variables
-static xTaskHandle taskHandle;
 static bool autotuneEnabled;
+static DelayedCallbackInfo *callbackHandle;
+static SystemIdentSettingsData settings;
+
+// double buffered, the event callback fills one batch while the callback reads the other
+static struct sample samples[2][BATCH_SIZE];
+static float periodSum[2];
+static uint32_t batchStart[2];
+static uint8_t fillBuffer;
+static uint8_t fillCount;
+static volatile bool busy;
+// samples were dropped before the batch being read
+static bool gap[2] = { true, true };
+
+static struct axis axes[3];
+static uint8_t history;
+static float period;
+static uint32_t sampleCount;
 
 // Private functions
-static void AutotuneTask(void *parameters);
-static void update_stabilization_settings();
+static void actuatorUpdatedCb(UAVObjEvent *ev);
+static void settingsUpdatedCb(UAVObjEvent *ev);
+static void autotuneCb(void);
+static void rls_init(struct rls *fit);
+static void rls_update(struct rls *fit, float actuator, float y, float lambda);
+static void publish(void);
+static void stream(uint8_t buffer);
 
 /**
  * Initialise the module, called on startup
@@ -81,254 +150,321 @@ static void update_stabilization_settings();
  */
 int32_t AutotuneInitialize(void)
 {
-    // Create a queue, connect to manual control command and flightstatus
 #ifdef MODULE_AUTOTUNE_BUILTIN
     autotuneEnabled = true;
 #else
+    HwSettingsOptionalModulesData optionalModules;
+
     HwSettingsInitialize();
-    uint8_t optionalModules[HWSETTINGS_OPTIONALMODULES_NUMELEM];
+    HwSettingsOptionalModulesGet(&optionalModules);
 
-    HwSettingsOptionalModulesGet(optionalModules);
+    autotuneEnabled = (optionalModules.AutoTune == HWSETTINGS_OPTIONALMODULES_ENABLED);
+#endif
 
-    if (optionalModules[HWSETTINGS_OPTIONALMODULES_AUTOTUNE] == HWSETTINGS_OPTIONALMODULES_ENABLED) {
-        autotuneEnabled = true;
-    } else {
-        autotuneEnabled = false;
+    if (autotuneEnabled) {
+        SystemIdentInitialize();
+        SystemIdentSettingsInitialize();
+        SampleStreamInitialize();
     }
-#endif
 
     return 0;
 }
 
 /**
- * Initialise the module, called on startup
+ * Start the module, called on startup
  * \returns 0 on success or -1 if initialisation failed
  */
 int32_t AutotuneStart(void)
 {
-    // Start main task if it is enabled
-    if (autotuneEnabled) {
-        xTaskCreate(AutotuneTask, (signed char *)"Autotune", STACK_SIZE_BYTES / 4, NULL, TASK_PRIORITY, &taskHandle);
+    if (!autotuneEnabled) {
+        return 0;
+    }
 
-        PIOS_TASK_MONITOR_RegisterTask(TASKINFO_RUNNING_AUTOTUNE, taskHandle);
-        PIOS_WDG_RegisterFlag(PIOS_WDG_AUTOTUNE);
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        for (uint8_t d = 0; d < DELAYS; d++) {
+            rls_init(&axes[axis].fit[d]);
+        }
     }
+
+    callbackHandle = PIOS_CALLBACKSCHEDULER_Create(&autotuneCb, CALLBACK_PRIORITY, CBTASK_PRIORITY, CALLBACKINFO_RUNNING_AUTOTUNE, STACK_SIZE_BYTES);
+
+    SystemIdentSettingsConnectCallback(&settingsUpdatedCb);
+    settingsUpdatedCb(NULL);
+    ActuatorDesiredConnectCallback(&actuatorUpdatedCb);
+
     return 0;
 }
 
 MODULE_INITCALL(AutotuneInitialize, AutotuneStart);
 
+static void settingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    SystemIdentSettingsGet(&settings);
+}
+
 /**
- * Module thread, should not return.
+ * Pair the actuators of the stabilization loop with the gyro, runs from the
+ * event dispatcher on every ActuatorDesired update, so keep it short
  */
-static void AutotuneTask(__attribute__((unused)) void *parameters)
+static void actuatorUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
-    // AlarmsClear(SYSTEMALARMS_ALARM_ATTITUDE);
-
-    enum AUTOTUNE_STATE state   = AT_INIT;
-
-    portTickType lastUpdateTime = xTaskGetTickCount();
+    ActuatorDesiredData actuator;
+    uint8_t armed;
+
+    ActuatorDesiredGet(&actuator);
+    FlightStatusArmedGet(&armed);
+
+    // only the stabilization loop fills in its period, and on the ground there is nothing to learn
+    if (armed != FLIGHTSTATUS_ARMED_ARMED || actuator.Thrust < settings.MinThrust || actuator.UpdateTime <= 0.0f) {
+        gap[fillBuffer] = true;
+        fillCount = 0;
+        periodSum[fillBuffer] = 0.0f;
+        return;
+    }
 
-    while (1) {
-        PIOS_WDG_UpdateFlag(PIOS_WDG_AUTOTUNE);
-        // TODO:
-        // 1. get from queue
-        // 2. based on whether it is flightstatus or manualcontrol
+    GyroStateData gyro;
+    GyroStateGet(&gyro);
 
-        portTickType diffTime;
+    if (fillCount == 0) {
+        batchStart[fillBuffer] = PIOS_DELAY_GetuS();
+    }
+    struct sample *sample = &samples[fillBuffer][fillCount];
+    sample->gyro[0]     = gyro.x;
+    sample->gyro[1]     = gyro.y;
+    sample->gyro[2]     = gyro.z;
+    sample->actuator[0] = actuator.Roll;
+    sample->actuator[1] = actuator.Pitch;
+    sample->actuator[2] = actuator.Yaw;
+    periodSum[fillBuffer] += actuator.UpdateTime;
+
+    if (++fillCount < BATCH_SIZE) {
+        return;
+    }
+    fillCount = 0;
+    // drop the batch if the previous one is still being worked on
+    if (busy) {
+        gap[fillBuffer] = true;
+        periodSum[fillBuffer] = 0.0f;
+        return;
+    }
+    busy = true;
+    fillBuffer ^= 1;
+    gap[fillBuffer] = false;
+    periodSum[fillBuffer] = 0.0f;
+    PIOS_CALLBACKSCHEDULER_Dispatch(callbackHandle);
+}
 
-        const uint32_t PREPARE_TIME = 2000;
-        const uint32_t MEAURE_TIME  = 30000;
+static void autotuneCb(void)
+{
+    const uint8_t readBuffer = fillBuffer ^ 1;
+    const float lambda = settings.ForgettingFactor;
 
-        FlightStatusData flightStatus;
-        FlightStatusGet(&flightStatus);
+    // the history is no good across dropped samples, the fits are
+    if (gap[readBuffer]) {
+        history = 0;
+    }
+    // ms, low passed over the batches
+    const float batchPeriod = periodSum[readBuffer] / BATCH_SIZE;
+    period = (period > 0.0f) ? period + 0.1f * (batchPeriod - period) : batchPeriod;
+    const float alpha = 1.0f - expf(-2.0f * M_PI_F * PREFILTER_HZ * period * 0.001f);
+
+    for (uint8_t n = 0; n < BATCH_SIZE; n++) {
+        const struct sample *sample = &samples[readBuffer][n];
+
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            struct axis *state = &axes[axis];
+
+            if (history == 0) {
+                state->rate     = sample->gyro[axis];
+                state->filtered = sample->actuator[axis];
+                for (uint8_t d = 0; d < DELAYS; d++) {
+                    state->fit[d].prediction = 0.0f;
+                }
+            }
+            const float rate = state->rate + alpha * (sample->gyro[axis] - state->rate);
+            const float y    = rate - state->rate;
+
+            // needs the actuators of every delay candidate
+            if (history > DELAYS) {
+                for (uint8_t d = 0; d < DELAYS; d++) {
+                    rls_update(&state->fit[d], state->actuator[d], y, lambda);
+                }
+            }
 
-        // Only allow this module to run when autotuning
-        if (flightStatus.FlightMode != FLIGHTSTATUS_FLIGHTMODE_AUTOTUNE) {
-            state = AT_INIT;
-            vTaskDelay(50);
-            continue;
+            for (uint8_t d = DELAYS - 1; d > 0; d--) {
+                state->actuator[d] = state->actuator[d - 1];
+            }
+            state->filtered   += alpha * (sample->actuator[axis] - state->filtered);
+            state->actuator[0] = state->filtered;
+            state->rate = rate;
         }
-
-        StabilizationDesiredData stabDesired;
-        StabilizationDesiredGet(&stabDesired);
-
-        StabilizationSettingsData stabSettings;
-        StabilizationSettingsGet(&stabSettings);
-
-        ManualControlSettingsData manualSettings;
-        ManualControlSettingsGet(&manualSettings);
-
-        ManualControlCommandData manualControl;
-        ManualControlCommandGet(&manualControl);
-
-        RelayTuningSettingsData relaySettings;
-        RelayTuningSettingsGet(&relaySettings);
-
-        bool rate = relaySettings.Mode == RELAYTUNINGSETTINGS_MODE_RATE;
-
-        if (rate) { // rate mode
-            stabDesired.StabilizationMode[STABILIZATIONDESIRED_STABILIZATIONMODE_ROLL]  = STABILIZATIONDESIRED_STABILIZATIONMODE_RATE;
-            stabDesired.StabilizationMode[STABILIZATIONDESIRED_STABILIZATIONMODE_PITCH] = STABILIZATIONDESIRED_STABILIZATIONMODE_RATE;
-
-            stabDesired.Roll  = manualControl.Roll * stabSettings.ManualRate[STABILIZATIONSETTINGS_MANUALRATE_ROLL];
-            stabDesired.Pitch = manualControl.Pitch * stabSettings.ManualRate[STABILIZATIONSETTINGS_MANUALRATE_PITCH];
+        if (history <= DELAYS) {
+            history++;
         } else {
-            stabDesired.StabilizationMode[STABILIZATIONDESIRED_STABILIZATIONMODE_ROLL]  = STABILIZATIONDESIRED_STABILIZATIONMODE_ATTITUDE;
-            stabDesired.StabilizationMode[STABILIZATIONDESIRED_STABILIZATIONMODE_PITCH] = STABILIZATIONDESIRED_STABILIZATIONMODE_ATTITUDE;
-
-            stabDesired.Roll  = manualControl.Roll * stabSettings.RollMax;
-            stabDesired.Pitch = manualControl.Pitch * stabSettings.PitchMax;
+            sampleCount++;
         }
+    }
 
-        stabDesired.StabilizationMode[STABILIZATIONDESIRED_STABILIZATIONMODE_YAW]    = STABILIZATIONDESIRED_STABILIZATIONMODE_RATE;
-        stabDesired.Yaw = manualControl.Yaw * stabSettings.ManualRate[STABILIZATIONSETTINGS_MANUALRATE_YAW];
-        stabDesired.StabilizationMode[STABILIZATIONDESIRED_STABILIZATIONMODE_THRUST] = STABILIZATIONDESIRED_STABILIZATIONMODE_MANUAL;
-        stabDesired.Thrust = manualControl.Thrust;
-
-        switch (state) {
-        case AT_INIT:
+    if (settings.Stream == SYSTEMIDENTSETTINGS_STREAM_ENABLED) {
+        stream(readBuffer);
+    }
+    busy = false;
+    publish();
+}
 
-            lastUpdateTime = xTaskGetTickCount();
+/**
+ * Send a batch as it was sampled, in the fixed point of @ref SampleStream
+ */
+static void stream(uint8_t buffer)
+{
+    static SampleStreamData data;
 
-            // Only start when armed and flying
-            if (flightStatus.Armed == FLIGHTSTATUS_ARMED_ARMED && stabDesired.Thrust > 0) {
-                state = AT_START;
-            }
-            break;
+    data.Sequence++;
+    data.Timestamp = batchStart[buffer];
+    data.Interval  = (uint16_t)(periodSum[buffer] * (1000.0f / BATCH_SIZE));
 
-        case AT_START:
+    for (uint8_t n = 0; n < BATCH_SIZE; n++) {
+        const struct sample *sample = &samples[buffer][n];
 
-            diffTime = xTaskGetTickCount() - lastUpdateTime;
+        data.GyroRoll[n]      = (int16_t)boundf(sample->gyro[0] * 10.0f, -32767.0f, 32767.0f);
+        data.GyroPitch[n]     = (int16_t)boundf(sample->gyro[1] * 10.0f, -32767.0f, 32767.0f);
+        data.GyroYaw[n]       = (int16_t)boundf(sample->gyro[2] * 10.0f, -32767.0f, 32767.0f);
+        data.ActuatorRoll[n]  = (int16_t)boundf(sample->actuator[0] * 10000.0f, -32767.0f, 32767.0f);
+        data.ActuatorPitch[n] = (int16_t)boundf(sample->actuator[1] * 10000.0f, -32767.0f, 32767.0f);
+        data.ActuatorYaw[n]   = (int16_t)boundf(sample->actuator[2] * 10000.0f, -32767.0f, 32767.0f);
+    }
 
-            // Spend the first block of time in normal rate mode to get airborne
-            if (diffTime > PREPARE_TIME) {
-                state = AT_ROLL;
-                lastUpdateTime = xTaskGetTickCount();
-            }
-            break;
+    SampleStreamSet(&data);
+}
 
-        case AT_ROLL:
+static void rls_init(struct rls *fit)
+{
+    memset(fit, 0, sizeof(*fit));
+    // start out from a slow lag
+    fit->theta[0] = 0.9f;
+    for (uint8_t i = 0; i < 3; i++) {
+        fit->P[i][i] = P_INIT;
+    }
+}
 
-            diffTime = xTaskGetTickCount() - lastUpdateTime;
+/**
+ * One recursive least squares step with exponential forgetting
+ * @param[in,out] fit Parameters, covariance and prediction
+ * @param[in] actuator At the delay of the fit
+ * @param[in] y Measured change of the rate
+ * @param[in] lambda Forgetting factor
+ */
+static void rls_update(struct rls *fit, float actuator, float y, float lambda)
+{
+    const float phi[3] = { fit->prediction, actuator, 1.0f };
+    float Pphi[3];
 
-            // Run relay mode on the roll axis for the measurement time
-            stabDesired.StabilizationMode[STABILIZATIONDESIRED_STABILIZATIONMODE_ROLL] = rate ? STABILIZATIONDESIRED_STABILIZATIONMODE_RELAYRATE :
-                                                                                         STABILIZATIONDESIRED_STABILIZATIONMODE_RELAYATTITUDE;
-            if (diffTime > MEAURE_TIME) { // Move on to next state
-                state = AT_PITCH;
-                lastUpdateTime = xTaskGetTickCount();
-            }
-            break;
+    for (uint8_t i = 0; i < 3; i++) {
+        Pphi[i] = fit->P[i][0] * phi[0] + fit->P[i][1] * phi[1] + fit->P[i][2] * phi[2];
+    }
+    const float e     = y - (fit->theta[0] * phi[0] + fit->theta[1] * phi[1] + fit->theta[2] * phi[2]);
+    const float denom = lambda + phi[0] * Pphi[0] + phi[1] * Pphi[1] + phi[2] * Pphi[2];
+    const float scale = 1.0f / denom;
 
-        case AT_PITCH:
+    for (uint8_t i = 0; i < 3; i++) {
+        fit->theta[i] += Pphi[i] * scale * e;
+    }
 
-            diffTime = xTaskGetTickCount() - lastUpdateTime;
+    // P = (P - P phi phi' P / denom) / lambda, P stays symmetric. Without
+    // excitation P grows by 1 / lambda per sample, stop forgetting then.
+    const float trace = fit->P[0][0] + fit->P[1][1] + fit->P[2][2];
+    const float inv_lambda = (trace < P_MAX) ? 1.0f / lambda : 1.0f;
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = i; j < 3; j++) {
+            const float p = (fit->P[i][j] - Pphi[i] * Pphi[j] * scale) * inv_lambda;
+            fit->P[i][j] = p;
+            fit->P[j][i] = p;
+        }
+    }
 
-            // Run relay mode on the pitch axis for the measurement time
-            stabDesired.StabilizationMode[STABILIZATIONDESIRED_STABILIZATIONMODE_PITCH] = rate ? STABILIZATIONDESIRED_STABILIZATIONMODE_RELAYRATE :
-                                                                                          STABILIZATIONDESIRED_STABILIZATIONMODE_RELAYATTITUDE;
-            if (diffTime > MEAURE_TIME) { // Move on to next state
-                state = AT_FINISHED;
-                lastUpdateTime = xTaskGetTickCount();
-            }
-            break;
+    fit->error += (1.0f - lambda) * (e * e - fit->error);
+    fit->prediction = fit->theta[0] * phi[0] + fit->theta[1] * phi[1] + fit->theta[2];
+}
 
-        case AT_FINISHED:
+/**
+ * Turn the best fit of each axis into the plant parameters and the PIDs
+ */
+static void publish(void)
+{
+    SystemIdentData ident;
 
-            // Wait until disarmed and landed before updating the settings
-            if (flightStatus.Armed == FLIGHTSTATUS_ARMED_DISARMED && stabDesired.Thrust <= 0) {
-                state = AT_SET;
-            }
+    SystemIdentGet(&ident);
 
-            break;
+    const float Ts = period * 0.001f;
+    ident.Period  = period;
+    ident.Samples = sampleCount;
 
-        case AT_SET:
-            update_stabilization_settings();
-            state = AT_INIT;
-            break;
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        const struct rls *best = &axes[axis].fit[0];
+        uint8_t delay = 0;
 
-        default:
-            // Set an alarm or some shit like that
-            break;
+        for (uint8_t d = 1; d < DELAYS; d++) {
+            if (axes[axis].fit[d].error < best->error) {
+                best  = &axes[axis].fit[d];
+                delay = d;
+            }
         }
 
-        StabilizationDesiredSet(&stabDesired);
-
-        vTaskDelay(10);
-    }
-}
+        const float a = best->theta[0];
+        const float b = best->theta[1];
+        float *gain   = &SystemIdentGainToArray(ident.Gain)[axis];
+        float *tau    = &SystemIdentTauToArray(ident.Tau)[axis];
+        float *uncertainty = &SystemIdentUncertaintyToArray(ident.Uncertainty)[axis];
+        uint8_t *converged = &SystemIdentConvergedToArray(ident.Converged)[axis];
+
+        *converged = SYSTEMIDENT_CONVERGED_FALSE;
+        SystemIdentDelayToArray(ident.Delay)[axis] = delay * period;
+        SystemIdentRateKpToArray(ident.RateKp)[axis] = 0.0f;
+        SystemIdentRateKiToArray(ident.RateKi)[axis] = 0.0f;
+        SystemIdentRateKdToArray(ident.RateKd)[axis] = 0.0f;
+        SystemIdentAttitudeKpToArray(ident.AttitudeKp)[axis] = 0.0f;
+
+        // a lag is 0 < a < 1 and a positive actuator speeds the axis up, anything else is no model yet
+        if (Ts <= 0.0f || a <= 0.0f || a >= 1.0f || b <= 0.0f) {
+            *gain = 0.0f;
+            *tau  = 0.0f;
+            *uncertainty = 100.0f;
+            continue;
+        }
 
-/**
- * Called after measuring roll and pitch to update the
- * stabilization settings
- *
- * takes in @ref RelayTuning and outputs @ref StabilizationSettings
- */
-static void update_stabilization_settings()
-{
-    RelayTuningData relayTuning;
-
-    RelayTuningGet(&relayTuning);
-
-    RelayTuningSettingsData relaySettings;
-    RelayTuningSettingsGet(&relaySettings);
-
-    StabilizationSettingsData stabSettings;
-    StabilizationSettingsGet(&stabSettings);
-
-    // Eventually get these settings from RelayTuningSettings
-    const float gain_ratio_r = 1.0f / 3.0f;
-    const float zero_ratio_r = 1.0f / 3.0f;
-    const float gain_ratio_p = 1.0f / 5.0f;
-    const float zero_ratio_p = 1.0f / 5.0f;
-
-    // For now just run over roll and pitch
-    for (uint i = 0; i < 2; i++) {
-        float wu  = 1000.0f * 2 * M_PI / relayTuning.Period[i]; // ultimate freq = output osc freq (rad/s)
-
-        float wc  = wu * gain_ratio_r;      // target openloop crossover frequency (rad/s)
-        float zc  = wc * zero_ratio_r;      // controller zero location (rad/s)
-        float kpu = 4.0f / M_PI / relayTuning.Gain[i]; // ultimate gain, i.e. the proportional gain for instablity
-        float kp  = kpu * gain_ratio_r;     // proportional gain
-        float ki  = zc * kp;                // integral gain
-
-        // Now calculate gains for the next loop out knowing it is the integral of
-        // the inner loop -- the plant is position/velocity = scale*1/s
-        float wc2 = wc * gain_ratio_p; // crossover of the attitude loop
-        float kp2 = wc2; // kp of attitude
-        float ki2 = wc2 * zero_ratio_p * kp2; // ki of attitude
-
-        switch (i) {
-        case 0: // roll
-            stabSettings.RollRatePID[STABILIZATIONSETTINGS_ROLLRATEPID_KP] = kp;
-            stabSettings.RollRatePID[STABILIZATIONSETTINGS_ROLLRATEPID_KI] = ki;
-            stabSettings.RollPI[STABILIZATIONSETTINGS_ROLLPI_KP] = kp2;
-            stabSettings.RollPI[STABILIZATIONSETTINGS_ROLLPI_KI] = ki2;
-            break;
-        case 1: // Pitch
-            stabSettings.PitchRatePID[STABILIZATIONSETTINGS_ROLLRATEPID_KP] = kp;
-            stabSettings.PitchRatePID[STABILIZATIONSETTINGS_ROLLRATEPID_KI] = ki;
-            stabSettings.PitchPI[STABILIZATIONSETTINGS_ROLLPI_KP] = kp2;
-            stabSettings.PitchPI[STABILIZATIONSETTINGS_ROLLPI_KI] = ki2;
-            break;
-        default:
-            // Oh shit oh shit oh shit
-            break;
+        // the steady state change per sample g = b / (1 - a), its variance from the
+        // covariance of a and b scaled by the noise of the fit
+        const float g     = b / (1.0f - a);
+        const float dg_db = 1.0f / (1.0f - a);
+        const float dg_da = g / (1.0f - a);
+        const float var   = best->error * (dg_db * dg_db * best->P[1][1] + dg_da * dg_da * best->P[0][0] +
+                                           2.0f * dg_da * dg_db * best->P[0][1]);
+
+        const float K     = g / Ts; // deg/s^2 per unit of actuator
+        const float lag   = -Ts / logf(a); // s
+        *gain = K;
+        *tau  = lag * 1000.0f;
+        *uncertainty = 100.0f * sqrtf(fmaxf(var, 0.0f)) / g;
+
+        if (*uncertainty > settings.ConvergenceLimit) {
+            continue;
         }
+        *converged = SYSTEMIDENT_CONVERGED_TRUE;
+
+        // K / (s (lag s + 1)) e^(-delay s) under a PID with its D zero near the lag pole,
+        // the proportional gain puts the open loop through 0dB at the crossover
+        const float wc   = settings.CrossoverRatio / (lag + delay * Ts);
+        const float lead = KD_TAU_RATIO * lag;
+        const float kp   = wc * sqrtf(1.0f + wc * wc * lag * lag) / (K * sqrtf(1.0f + wc * wc * lead * lead));
+
+        SystemIdentRateKpToArray(ident.RateKp)[axis] = kp;
+        SystemIdentRateKiToArray(ident.RateKi)[axis] = kp * wc * KI_RATIO;
+        SystemIdentRateKdToArray(ident.RateKd)[axis] = kp * lead;
+        // around the closed rate loop the attitude is an integrator, its Kp is its crossover
+        SystemIdentAttitudeKpToArray(ident.AttitudeKp)[axis] = wc * settings.AttitudeRatio;
     }
-    switch (relaySettings.Behavior) {
-    case RELAYTUNINGSETTINGS_BEHAVIOR_MEASURE:
-        // Just measure, don't update the stab settings
-        break;
-    case RELAYTUNINGSETTINGS_BEHAVIOR_COMPUTE:
-        StabilizationSettingsSet(&stabSettings);
-        break;
-    case RELAYTUNINGSETTINGS_BEHAVIOR_SAVE:
-        StabilizationSettingsSet(&stabSettings);
-        UAVObjSave(StabilizationSettingsHandle(), 0);
-        break;
-    }
+
+    SystemIdentSet(&ident);
 }
 
 /**
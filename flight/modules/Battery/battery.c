@@ -67,6 +67,8 @@ static bool batteryEnabled = false;
 // CAN SIMPLY BE MODIFIED TO SUPPORT 15 ADC PINS, BY USING ALL AVAILABLE BITS.
 static int8_t voltageADCPin = -1; // ADC pin for voltage
 static int8_t currentADCPin = -1; // ADC pin for current
+static struct pios_adc_pin_stats lastCurrentStats; // integral of the current pin at the previous pass
+static bool lastCurrentStatsValid = false;
 
 // Private functions
 static void onTimer(UAVObjEvent *ev);
@@ -126,7 +128,7 @@ int32_t BatteryInitialize(void)
     return 0;
 }
 
-MODULE_INITCALL(BatteryInitialize, 0);
+MODULE_INITCALL_PARALLEL(BatteryInitialize, 0);
 static void onTimer(__attribute__((unused)) UAVObjEvent *ev)
 {
     static FlightBatterySettingsData batterySettings;
@@ -137,6 +139,7 @@ static void onTimer(__attribute__((unused)) UAVObjEvent *ev)
 
     const float dT = SAMPLE_PERIOD_MS / 1000.0f;
     float energyRemaining;
+    AlarmsBatch alarms = { 0 };
 
     // calculate the battery parameters
     if (voltageADCPin >= 0) {
@@ -160,7 +163,25 @@ static void onTimer(__attribute__((unused)) UAVObjEvent *ev)
 
     // For safety reasons consider only positive currents in energy comsumption, i.e. no charging up.
     // necesary when sensor are not perfectly calibrated
-    if (flightBatteryData.Current > 0) {
+    // The ADC driver integrates the current pin above its zero point at the ADC rate, so the consumption
+    // is not limited to the current of the samples left at SAMPLE_PERIOD_MS.
+    struct pios_adc_pin_stats currentStats;
+    if (currentADCPin >= 0 && PIOS_ADC_PinGetStats(currentADCPin, &currentStats)) {
+        if (lastCurrentStatsValid && flightBatteryData.Voltage > 0.f) {
+            uint32_t samples = currentStats.samples - lastCurrentStats.samples;
+            if (samples > 0) {
+                // time between the last block integrated by each pass
+                float integralDT = (float)(PIOS_DELAY_DiffuS(lastCurrentStats.timestamp) - PIOS_DELAY_DiffuS(currentStats.timestamp)) * 1e-6f;
+                float positiveCurrent = (float)(currentStats.positive - lastCurrentStats.positive) / samples * PIOS_ADC_VOLTAGE_SCALE * batterySettings.SensorCalibrations.CurrentFactor; // in Amps
+                flightBatteryData.ConsumedEnergy += (positiveCurrent * integralDT * 1000.0f / 3600.0f); // in mAh
+            }
+        }
+        lastCurrentStats      = currentStats;
+        lastCurrentStatsValid = true;
+        // integrate above the zero point from now on, it may have been changed by the settings
+        float zero = batterySettings.SensorCalibrations.CurrentZero / (PIOS_ADC_VOLTAGE_SCALE);
+        PIOS_ADC_PinSetOffset(currentADCPin, (zero > 0.0f) ? (uint16_t)(zero + 0.5f) : 0);
+    } else if (flightBatteryData.Current > 0) {
         flightBatteryData.ConsumedEnergy += (flightBatteryData.Current * dT * 1000.0f / 3600.0f); // in mAh
     }
 
@@ -183,28 +204,29 @@ static void onTimer(__attribute__((unused)) UAVObjEvent *ev)
     if ((flightBatteryData.Voltage <= 0) && (flightBatteryData.Current <= 0)) {
         // FIXME: There's no guarantee that a floating ADC will give 0. So this
         // check might fail, even when there's nothing attached.
-        AlarmsSet(SYSTEMALARMS_ALARM_BATTERY, SYSTEMALARMS_ALARM_ERROR);
-        AlarmsSet(SYSTEMALARMS_ALARM_FLIGHTTIME, SYSTEMALARMS_ALARM_ERROR);
+        AlarmsBatchSet(&alarms, SYSTEMALARMS_ALARM_BATTERY, SYSTEMALARMS_ALARM_ERROR);
+        AlarmsBatchSet(&alarms, SYSTEMALARMS_ALARM_FLIGHTTIME, SYSTEMALARMS_ALARM_ERROR);
     } else {
         // FIXME: should make the timer alarms user configurable
         if (batterySettings.Capacity > 0 && flightBatteryData.EstimatedFlightTime < 30) {
-            AlarmsSet(SYSTEMALARMS_ALARM_FLIGHTTIME, SYSTEMALARMS_ALARM_CRITICAL);
+            AlarmsBatchSet(&alarms, SYSTEMALARMS_ALARM_FLIGHTTIME, SYSTEMALARMS_ALARM_CRITICAL);
         } else if (batterySettings.Capacity > 0 && flightBatteryData.EstimatedFlightTime < 120) {
-            AlarmsSet(SYSTEMALARMS_ALARM_FLIGHTTIME, SYSTEMALARMS_ALARM_WARNING);
+            AlarmsBatchSet(&alarms, SYSTEMALARMS_ALARM_FLIGHTTIME, SYSTEMALARMS_ALARM_WARNING);
         } else {
-            AlarmsClear(SYSTEMALARMS_ALARM_FLIGHTTIME);
+            AlarmsBatchClear(&alarms, SYSTEMALARMS_ALARM_FLIGHTTIME);
         }
 
         // FIXME: should make the battery voltage detection dependent on battery type.
         /*Not so sure. Some users will want to run their batteries harder than others, so it should be the user's choice. [KDS]*/
         if (flightBatteryData.Voltage < batterySettings.CellVoltageThresholds.Alarm * flightBatteryData.NbCells) {
-            AlarmsSet(SYSTEMALARMS_ALARM_BATTERY, SYSTEMALARMS_ALARM_CRITICAL);
+            AlarmsBatchSet(&alarms, SYSTEMALARMS_ALARM_BATTERY, SYSTEMALARMS_ALARM_CRITICAL);
         } else if (flightBatteryData.Voltage < batterySettings.CellVoltageThresholds.Warning * flightBatteryData.NbCells) {
-            AlarmsSet(SYSTEMALARMS_ALARM_BATTERY, SYSTEMALARMS_ALARM_WARNING);
+            AlarmsBatchSet(&alarms, SYSTEMALARMS_ALARM_BATTERY, SYSTEMALARMS_ALARM_WARNING);
         } else {
-            AlarmsClear(SYSTEMALARMS_ALARM_BATTERY);
+            AlarmsBatchClear(&alarms, SYSTEMALARMS_ALARM_BATTERY);
         }
     }
+    AlarmsSetMany(&alarms);
 
     FlightBatteryStateSet(&flightBatteryData);
 }
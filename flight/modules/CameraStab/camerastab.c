@@ -33,7 +33,7 @@
 /**
  * Output object: Accessory
  *
- * This module will periodically calculate the output values for stabilizing the camera
+ * This module will calculate the output values for stabilizing the camera on every gyro update
  *
  * UAVObjects are automatically generated by the UAVObjectGenerator from
  * the object definition XML file.
@@ -49,20 +49,38 @@
 
 #include "accessorydesired.h"
 #include "attitudestate.h"
+#include "gyrostate.h"
 #include "camerastabsettings.h"
 #include "cameradesired.h"
 #include "hwsettings.h"
+#include "callbackinfo.h"
+
+#include <pios_deltatime.h>
+#include <sin_lookup.h>
 
 //
 // Configuration
 //
-#define SAMPLE_PERIOD_MS 10
+#define CALLBACK_PRIORITY CALLBACK_PRIORITY_REGULAR
+#define CBTASK_PRIORITY   CALLBACK_TASK_FLIGHTCONTROL
+#define STACK_SIZE_BYTES  512
+
+#define UPDATE_EXPECTED   (1.0f / PIOS_SENSOR_RATE)
+#define UPDATE_MIN        1.0e-6f
+#define UPDATE_MAX        1.0f
+#define UPDATE_ALPHA      1.0e-2f
+
+// the euler rates are not propagated closer to +-90 deg pitch than this
+#define MIN_COS_PITCH     0.1f
 
 // Private types
 
 // Private variables
 static struct CameraStab_data {
-    portTickType lastSysTime;
+    PiOSDeltatimeConfig timeval;
+    CameraStabSettingsData settings;
+    float attitude[3]; // roll pitch yaw, the last AttitudeState carried forward by the gyros
+    float gyro[3];
     float inputs[CAMERASTABSETTINGS_INPUT_NUMELEM];
 
 #ifdef USE_GIMBAL_LPF
@@ -76,8 +94,16 @@ static struct CameraStab_data {
 #endif
 } *csd;
 
+static DelayedCallbackInfo *callbackHandle;
+static volatile bool attitudeUpdated;
+static volatile bool settingsUpdated;
+
 // Private functions
-static void attitudeUpdated(UAVObjEvent *ev);
+static void cameraStabTask(void);
+static void propagateAttitude(float dT);
+static void gyroStateUpdatedCb(UAVObjEvent *ev);
+static void attitudeStateUpdatedCb(UAVObjEvent *ev);
+static void settingsUpdatedCb(UAVObjEvent *ev);
 
 #ifdef USE_GIMBAL_FF
 static void applyFeedForward(uint8_t index, float dT, float *attitude, CameraStabSettingsData *cameraStab);
@@ -116,19 +142,21 @@ int32_t CameraStabInitialize(void)
 
         // initialize camera state variables
         memset(csd, 0, sizeof(struct CameraStab_data));
-        csd->lastSysTime = xTaskGetTickCount();
+        PIOS_DELTATIME_Init(&csd->timeval, UPDATE_EXPECTED, UPDATE_MIN, UPDATE_MAX, UPDATE_ALPHA);
 
         AttitudeStateInitialize();
+        GyroStateInitialize();
         CameraStabSettingsInitialize();
         CameraDesiredInitialize();
 
-        UAVObjEvent ev = {
-            .obj    = AttitudeStateHandle(),
-            .instId = 0,
-            .event  = 0,
-            .lowPriority = false,
-        };
-        EventPeriodicCallbackCreate(&ev, attitudeUpdated, SAMPLE_PERIOD_MS / portTICK_RATE_MS);
+        attitudeUpdated = true;
+        settingsUpdated = true;
+
+        // the gimbal follows every gyro sample, from a callback below the stabilization
+        callbackHandle  = PIOS_CALLBACKSCHEDULER_Create(&cameraStabTask, CALLBACK_PRIORITY, CBTASK_PRIORITY, CALLBACKINFO_RUNNING_CAMERASTAB, STACK_SIZE_BYTES);
+        GyroStateConnectCallback(&gyroStateUpdatedCb);
+        AttitudeStateConnectCallback(&attitudeStateUpdatedCb);
+        CameraStabSettingsConnectCallback(&settingsUpdatedCb);
 
         return 0;
     }
@@ -144,23 +172,85 @@ int32_t CameraStabStart(void)
 
 MODULE_INITCALL(CameraStabInitialize, CameraStabStart);
 
-static void attitudeUpdated(UAVObjEvent *ev)
+static void gyroStateUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    GyroStateData gyroState;
+
+    GyroStateGet(&gyroState);
+    csd->gyro[0] = gyroState.x;
+    csd->gyro[1] = gyroState.y;
+    csd->gyro[2] = gyroState.z;
+
+    PIOS_CALLBACKSCHEDULER_Dispatch(callbackHandle);
+}
+
+/*
+ * AttitudeState and the settings are only flagged here, the callback reads
+ * them itself so it never sees half of an update.
+ */
+static void attitudeStateUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    attitudeUpdated = true;
+}
+
+static void settingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    settingsUpdated = true;
+}
+
+/**
+ * Carry the attitude forward with the body rates between two AttitudeState
+ * updates, so the gimbal moves on every gyro sample whatever rate the
+ * attitude estimate runs at.
+ */
+static void propagateAttitude(float dT)
 {
-    if (ev->obj != AttitudeStateHandle()) {
+    if (attitudeUpdated) {
+        attitudeUpdated = false;
+        AttitudeStateData attitudeState;
+        AttitudeStateGet(&attitudeState);
+        csd->attitude[0] = attitudeState.Roll;
+        csd->attitude[1] = attitudeState.Pitch;
+        csd->attitude[2] = attitudeState.Yaw;
         return;
     }
 
+    float sinRoll  = sin_lookup_deg(csd->attitude[0]);
+    float cosRoll  = cos_lookup_deg(csd->attitude[0]);
+    float cosPitch = cos_lookup_deg(csd->attitude[1]);
+    if (cosPitch < MIN_COS_PITCH) {
+        return;
+    }
+    float tanPitch = sin_lookup_deg(csd->attitude[1]) / cosPitch;
+
+    // body rates to euler angle rates
+    float qr = csd->gyro[1] * sinRoll + csd->gyro[2] * cosRoll;
+    csd->attitude[0] += (csd->gyro[0] + qr * tanPitch) * dT;
+    csd->attitude[1] += (csd->gyro[1] * cosRoll - csd->gyro[2] * sinRoll) * dT;
+    csd->attitude[2] += (qr / cosPitch) * dT;
+
+    if (csd->attitude[2] > 180.0f) {
+        csd->attitude[2] -= 360.0f;
+    } else if (csd->attitude[2] < -180.0f) {
+        csd->attitude[2] += 360.0f;
+    }
+}
+
+static void cameraStabTask(void)
+{
     AccessoryDesiredData accessory;
 
-    CameraStabSettingsData cameraStab;
-    CameraStabSettingsGet(&cameraStab);
+    if (settingsUpdated) {
+        settingsUpdated = false;
+        CameraStabSettingsGet(&csd->settings);
+    }
+    CameraStabSettingsData *cameraStab = &csd->settings;
+
+    // time delta between calls, gyro samples are too close for the tick counter
+    float dT = PIOS_DELTATIME_GetAverageSeconds(&csd->timeval);
+    float dT_millis = dT * 1000.0f;
 
-    // check how long since last update, time delta between calls in ms
-    portTickType thisSysTime = xTaskGetTickCount();
-    float dT_millis = (thisSysTime > csd->lastSysTime) ?
-                      (float)((thisSysTime - csd->lastSysTime) * portTICK_RATE_MS) :
-                      (float)SAMPLE_PERIOD_MS;
-    csd->lastSysTime = thisSysTime;
+    propagateAttitude(dT);
 
     // storage for elevon roll component before the pitch component has been generated
     // we are guaranteed that the iteration order of i is roll pitch yaw
@@ -171,22 +261,22 @@ static void attitudeUpdated(UAVObjEvent *ev)
     // process axes
     for (uint8_t i = 0; i < CAMERASTABSETTINGS_INPUT_NUMELEM; i++) {
         // read and process control input
-        if (CameraStabSettingsInputToArray(cameraStab.Input)[i] != CAMERASTABSETTINGS_INPUT_NONE) {
-            if (AccessoryDesiredInstGet(CameraStabSettingsInputToArray(cameraStab.Input)[i] -
+        if (CameraStabSettingsInputToArray(cameraStab->Input)[i] != CAMERASTABSETTINGS_INPUT_NONE) {
+            if (AccessoryDesiredInstGet(CameraStabSettingsInputToArray(cameraStab->Input)[i] -
                                         CAMERASTABSETTINGS_INPUT_ACCESSORY0, &accessory) == 0) {
                 float input_rate;
-                switch (CameraStabSettingsStabilizationModeToArray(cameraStab.StabilizationMode)[i]) {
+                switch (CameraStabSettingsStabilizationModeToArray(cameraStab->StabilizationMode)[i]) {
                 case CAMERASTABSETTINGS_STABILIZATIONMODE_ATTITUDE:
                     csd->inputs[i] = accessory.AccessoryVal *
-                                     CameraStabSettingsInputRangeToArray(cameraStab.InputRange)[i];
+                                     CameraStabSettingsInputRangeToArray(cameraStab->InputRange)[i];
                     break;
                 case CAMERASTABSETTINGS_STABILIZATIONMODE_AXISLOCK:
                     input_rate = accessory.AccessoryVal *
-                                 CameraStabSettingsInputRateToArray(cameraStab.InputRate)[i];
-                    if (fabsf(input_rate) > cameraStab.MaxAxisLockRate) {
+                                 CameraStabSettingsInputRateToArray(cameraStab->InputRate)[i];
+                    if (fabsf(input_rate) > cameraStab->MaxAxisLockRate) {
                         csd->inputs[i] = boundf(csd->inputs[i] + input_rate * 0.001f * dT_millis,
-                                                -CameraStabSettingsInputRangeToArray(cameraStab.InputRange)[i],
-                                                CameraStabSettingsInputRangeToArray(cameraStab.InputRange)[i]);
+                                                -CameraStabSettingsInputRangeToArray(cameraStab->InputRange)[i],
+                                                CameraStabSettingsInputRangeToArray(cameraStab->InputRange)[i]);
                     }
                     break;
                 default:
@@ -196,46 +286,32 @@ static void attitudeUpdated(UAVObjEvent *ev)
         }
 
         // calculate servo output
-        float attitude;
-
-        switch (i) {
-        case CAMERASTABSETTINGS_INPUT_ROLL:
-            AttitudeStateRollGet(&attitude);
-            break;
-        case CAMERASTABSETTINGS_INPUT_PITCH:
-            AttitudeStatePitchGet(&attitude);
-            break;
-        case CAMERASTABSETTINGS_INPUT_YAW:
-            AttitudeStateYawGet(&attitude);
-            break;
-        default:
-            PIOS_Assert(0);
-        }
+        float attitude = csd->attitude[i];
 
 #ifdef USE_GIMBAL_LPF
-        if (CameraStabSettingsResponseTimeToArray(cameraStab.ResponseTime)[i]) {
-            float rt = (float)CameraStabSettingsResponseTimeToArray(cameraStab.ResponseTime)[i];
+        if (CameraStabSettingsResponseTimeToArray(cameraStab->ResponseTime)[i]) {
+            float rt = (float)CameraStabSettingsResponseTimeToArray(cameraStab->ResponseTime)[i];
             attitude = csd->attitudeFiltered[i] = ((rt * csd->attitudeFiltered[i]) + (dT_millis * attitude)) / (rt + dT_millis);
         }
 #endif
 
 #ifdef USE_GIMBAL_FF
-        if (CameraStabSettingsFeedForwardToArray(cameraStab.FeedForward)[i]) {
-            applyFeedForward(i, dT_millis, &attitude, &cameraStab);
+        if (CameraStabSettingsFeedForwardToArray(cameraStab->FeedForward)[i]) {
+            applyFeedForward(i, dT_millis, &attitude, cameraStab);
         }
 #endif
 
         // bounding for elevon mixing occurs on the unmixed output
         // to limit the range of the mixed output you must limit the range
         // of both the unmixed pitch and unmixed roll
-        float output = boundf((attitude + csd->inputs[i]) / CameraStabSettingsOutputRangeToArray(cameraStab.OutputRange)[i], -1.0f, 1.0f);
+        float output = boundf((attitude + csd->inputs[i]) / CameraStabSettingsOutputRangeToArray(cameraStab->OutputRange)[i], -1.0f, 1.0f);
 
         // set output channels
         switch (i) {
         case CAMERASTABSETTINGS_INPUT_ROLL:
             // we are guaranteed that the iteration order of i is roll pitch yaw
             // for elevon mixing we simply grab the value for later use
-            if (cameraStab.GimbalType == CAMERASTABSETTINGS_GIMBALTYPE_ROLLPITCHMIXED) {
+            if (cameraStab->GimbalType == CAMERASTABSETTINGS_GIMBALTYPE_ROLLPITCHMIXED) {
                 elevon_roll = output;
             } else {
                 CameraDesiredRollOrServo1Set(&output);
@@ -244,14 +320,14 @@ static void attitudeUpdated(UAVObjEvent *ev)
         case CAMERASTABSETTINGS_INPUT_PITCH:
             // we are guaranteed that the iteration order of i is roll pitch yaw
             // for elevon mixing we use the value we previously grabbed and set both s1 and s2
-            if (cameraStab.GimbalType == CAMERASTABSETTINGS_GIMBALTYPE_ROLLPITCHMIXED) {
+            if (cameraStab->GimbalType == CAMERASTABSETTINGS_GIMBALTYPE_ROLLPITCHMIXED) {
                 float elevon_pitch = output;
                 // elevon reversing works like this:
                 // first use the normal reversing facilities to get servo 1 roll working in the correct direction
                 // then use the normal reversing facilities to get servo 2 roll working in the correct direction
                 // then use these new reversing switches to reverse servo 1 and/or 2 pitch as needed
                 // if servo 1 pitch is reversed
-                if (cameraStab.Servo1PitchReverse == CAMERASTABSETTINGS_SERVO1PITCHREVERSE_TRUE) {
+                if (cameraStab->Servo1PitchReverse == CAMERASTABSETTINGS_SERVO1PITCHREVERSE_TRUE) {
                     // use (reversed pitch) + roll
                     output = ((1.0f - elevon_pitch) + elevon_roll) / 2.0f;
                 } else {
@@ -260,7 +336,7 @@ static void attitudeUpdated(UAVObjEvent *ev)
                 }
                 CameraDesiredRollOrServo1Set(&output);
                 // if servo 2 pitch is reversed
-                if (cameraStab.Servo2PitchReverse == CAMERASTABSETTINGS_SERVO2PITCHREVERSE_TRUE) {
+                if (cameraStab->Servo2PitchReverse == CAMERASTABSETTINGS_SERVO2PITCHREVERSE_TRUE) {
                     // use (reversed pitch) - roll
                     output = ((1.0f - elevon_pitch) - elevon_roll) / 2.0f;
                 } else {
@@ -294,16 +370,14 @@ void applyFeedForward(uint8_t index, float dT_millis, float *attitude, CameraSta
         break;
     case CAMERASTABSETTINGS_GIMBALTYPE_YAWROLLPITCH:
         if (index == CAMERASTABSETTINGS_INPUT_ROLL) {
-            float pitch;
-            AttitudeStatePitchGet(&pitch);
+            float pitch = csd->attitude[CAMERASTABSETTINGS_INPUT_PITCH];
             gimbalTypeCorrection = (cameraStab->OutputRange.Pitch - fabsf(pitch))
                                    / cameraStab->OutputRange.Pitch;
         }
         break;
     case CAMERASTABSETTINGS_GIMBALTYPE_YAWPITCHROLL:
         if (index == CAMERASTABSETTINGS_INPUT_PITCH) {
-            float roll;
-            AttitudeStateRollGet(&roll);
+            float roll = csd->attitude[CAMERASTABSETTINGS_INPUT_ROLL];
             gimbalTypeCorrection = (cameraStab->OutputRange.Roll - fabsf(roll))
                                    / cameraStab->OutputRange.Roll;
         }
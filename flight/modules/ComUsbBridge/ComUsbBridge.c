@@ -52,17 +52,12 @@ static void updateSettings(UAVObjEvent *ev);
 
 #define TASK_PRIORITY        (tskIDLE_PRIORITY + 1)
 
-#define BRIDGE_BUF_LEN       10
-
 // ****************
 // Private variables
 
 static xTaskHandle com2UsbBridgeTaskHandle;
 static xTaskHandle usb2ComBridgeTaskHandle;
 
-static uint8_t *com2usb_buf;
-static uint8_t *usb2com_buf;
-
 static uint32_t usart_port;
 static uint32_t vcp_port;
 
@@ -114,10 +109,6 @@ static int32_t comUsbBridgeInitialize(void)
 #endif
 
     if (bridge_enabled) {
-        com2usb_buf = pios_malloc(BRIDGE_BUF_LEN);
-        PIOS_Assert(com2usb_buf);
-        usb2com_buf = pios_malloc(BRIDGE_BUF_LEN);
-        PIOS_Assert(usb2com_buf);
         HwSettingsConnectCallback(&updateSettings);
         updateSettings(0);
     }
@@ -136,15 +127,10 @@ static void com2UsbBridgeTask(__attribute__((unused)) void *parameters)
     volatile uint32_t tx_errors = 0;
 
     while (1) {
-        uint32_t rx_bytes;
-
-        rx_bytes = PIOS_COM_ReceiveBuffer(usart_port, com2usb_buf, BRIDGE_BUF_LEN, 500);
-        if (rx_bytes > 0) {
-            /* Bytes available to transfer */
-            if (PIOS_COM_SendBuffer(vcp_port, com2usb_buf, rx_bytes) != (int32_t)rx_bytes) {
-                /* Error on transmit */
-                tx_errors++;
-            }
+        /* Whatever arrived goes from one fifo into the other */
+        if (PIOS_COM_ForwardBuffer(usart_port, vcp_port, 500) < 0) {
+            /* Error on transmit */
+            tx_errors++;
         }
     }
 }
@@ -155,15 +141,10 @@ static void usb2ComBridgeTask(__attribute__((unused)) void *parameters)
     volatile uint32_t tx_errors = 0;
 
     while (1) {
-        uint32_t rx_bytes;
-
-        rx_bytes = PIOS_COM_ReceiveBuffer(vcp_port, usb2com_buf, BRIDGE_BUF_LEN, 500);
-        if (rx_bytes > 0) {
-            /* Bytes available to transfer */
-            if (PIOS_COM_SendBuffer(usart_port, usb2com_buf, rx_bytes) != (int32_t)rx_bytes) {
-                /* Error on transmit */
-                tx_errors++;
-            }
+        /* Whatever arrived goes from one fifo into the other */
+        if (PIOS_COM_ForwardBuffer(vcp_port, usart_port, 500) < 0) {
+            /* Error on transmit */
+            tx_errors++;
         }
     }
 }
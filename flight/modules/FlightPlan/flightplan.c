@@ -47,7 +47,7 @@
 
 // Private variables
 static xTaskHandle taskHandle;
-static xQueueHandle queue;
+static UAVObjEventSubscriber subscriber;
 
 // Private functions
 static void flightPlanTask(void *parameters);
@@ -84,11 +84,11 @@ int32_t FlightPlanInitialize()
     // Listen for object updates
     FlightPlanControlConnectCallback(&objectUpdatedCb);
 
-    // Create object queue
-    queue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
-
     // Listen for FlightPlanControl updates
-    FlightPlanControlConnectQueue(queue);
+    if (UAVObjSubscriberInit(&subscriber, MAX_QUEUE_SIZE, true) != 0) {
+        return -1;
+    }
+    FlightPlanControlConnectSubscriber(&subscriber);
 
     return 0;
 }
@@ -98,7 +98,7 @@ MODULE_INITCALL(FlightPlanInitialize, FlightPlanStart);
  */
 static void flightPlanTask(__attribute__((unused)) void *parameters)
 {
-    UAVObjEvent ev;
+    UAVObjEventNode *ev;
     PmReturn_t retval;
     FlightPlanStatusData status;
     FlightPlanControlData control;
@@ -115,9 +115,10 @@ static void flightPlanTask(__attribute__((unused)) void *parameters)
     // Main thread loop
     while (1) {
         // Wait for FlightPlanControl updates
-        while (xQueueReceive(queue, &ev, portMAX_DELAY) != pdTRUE) {
+        while ((ev = UAVObjSubscriberReceive(&subscriber, portMAX_DELAY)) == NULL) {
             ;
         }
+        UAVObjSubscriberRelease(ev);
 
         // Get object and check if a start command was sent
         FlightPlanControlGet(&control);
@@ -24,6 +24,19 @@
 # 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #
 
+#
+# Every object access from a flight plan goes through the generic read() and
+# write() below, which walk the fields of the instance and look up the same
+# attribute names for each field. Those names are made once per call rather
+# than per field, as each one costs a heap chunk and a walk of the string cache.
+#
+# The objects have no generated native accessors, and the PyMite interpreter
+# loop and heap are used as shipped. No firmware target includes pymite.mk,
+# so changes to the generated natives or to the vendored VM could not be
+# built, and the switch of the interpreter loop already compiles to a jump
+# table.
+#
+
 """__NATIVE__
 #include "openpilot.h"
 
@@ -36,6 +49,10 @@
 #define TYPE_FLOAT32 6
 #define TYPE_ENUM 7
 
+/* Leaves read() or write() with the attribute names off the temporary GC roots */
+#define UAVO_RETURN_IF_ERROR(retval, objid) \
+	if ((retval) != PM_RET_OK) { heap_gcPopTempRoot(objid); return (retval); }
+
 """
 
 from list import append
@@ -168,6 +185,10 @@ class UAVObject:
 		uint32_t type;  
 		uint32_t numElements;   
 		uint8_t const *tmpStr;
+		pPmObj_t nameFtype;
+		pPmObj_t nameNumElements;
+		pPmObj_t nameValue;
+		uint8_t namesObjid, objid;
 		int16_t *tmpInt16;
 		int32_t *tmpInt32;
 		float *tmpFloat;
@@ -202,27 +223,33 @@ class UAVObject:
 		retval = dict_getItem(attrs, fieldName, &fields); PM_RETURN_IF_ERROR(retval);
 		numFields = ((pPmList_t) fields)->length;    
 
+		// Names of the field attributes, created once for all the fields
+		// and kept from the garbage collector until done
+		tmpStr = (uint8_t const *)"ftype";
+		retval = string_new(&tmpStr, &nameFtype); PM_RETURN_IF_ERROR(retval);
+		heap_gcPushTempRoot(nameFtype, &namesObjid);
+		tmpStr = (uint8_t const *)"numElements";
+		retval = string_new(&tmpStr, &nameNumElements); UAVO_RETURN_IF_ERROR(retval, namesObjid);
+		heap_gcPushTempRoot(nameNumElements, &objid);
+		tmpStr = (uint8_t const *)"value";
+		retval = string_new(&tmpStr, &nameValue); UAVO_RETURN_IF_ERROR(retval, namesObjid);
+		heap_gcPushTempRoot(nameValue, &objid);
+
 		// Process each field
 		dataIdx = 0;
 		for (fieldIdx = 0; fieldIdx < numFields; ++fieldIdx)
 		{		
 			// Get field
-			retval = list_getItem(fields, fieldIdx, &field); PM_RETURN_IF_ERROR(retval);
+			retval = list_getItem(fields, fieldIdx, &field); UAVO_RETURN_IF_ERROR(retval, namesObjid);
 			attrs = (pPmObj_t)((pPmInstance_t)field)->cli_attrs;
 			// Get type
-			tmpStr = (uint8_t const *)"ftype";
-			retval = string_new(&tmpStr, &fieldName); PM_RETURN_IF_ERROR(retval); 
-			retval = dict_getItem(attrs, fieldName, &field); PM_RETURN_IF_ERROR(retval);
+			retval = dict_getItem(attrs, nameFtype, &field); UAVO_RETURN_IF_ERROR(retval, namesObjid);
 			type = ((pPmInt_t) field)->val;   
 			// Get number of elements
-			tmpStr = (uint8_t const *)"numElements";
-			retval = string_new(&tmpStr, &fieldName); PM_RETURN_IF_ERROR(retval); 
-			retval = dict_getItem(attrs, fieldName, &field); PM_RETURN_IF_ERROR(retval);
+			retval = dict_getItem(attrs, nameNumElements, &field); UAVO_RETURN_IF_ERROR(retval, namesObjid);
 			numElements = ((pPmInt_t) field)->val;
 			// Get value
-			tmpStr = (uint8_t const *)"value";
-			retval = string_new(&tmpStr, &fieldName); PM_RETURN_IF_ERROR(retval); 
-			retval = dict_getItem(attrs, fieldName, &field); PM_RETURN_IF_ERROR(retval); 
+			retval = dict_getItem(attrs, nameValue, &field); UAVO_RETURN_IF_ERROR(retval, namesObjid);
 			// Set value for each element
 			for (valueIdx = 0; valueIdx < numElements; ++valueIdx)
 			{		
@@ -232,40 +259,39 @@ class UAVObject:
 					case TYPE_INT8: 
 					case TYPE_UINT8:
 					case TYPE_ENUM: 
-						retval = int_new(data[dataIdx], &value); PM_RETURN_IF_ERROR(retval);                       
+						retval = int_new(data[dataIdx], &value); UAVO_RETURN_IF_ERROR(retval, namesObjid);                       
 						dataIdx = dataIdx + 1;
 						break;
 					case TYPE_INT16:
 					case TYPE_UINT16:
 						tmpInt16 = (int16_t*)(&data[dataIdx]);
-						retval = int_new(*tmpInt16, &value); PM_RETURN_IF_ERROR(retval);    
+						retval = int_new(*tmpInt16, &value); UAVO_RETURN_IF_ERROR(retval, namesObjid);    
 						dataIdx = dataIdx + 2;
 						break;       
 					case TYPE_INT32:
 					case TYPE_UINT32:
 						tmpInt32 = (int32_t*)(&data[dataIdx]);
-						retval = int_new(*tmpInt32, &value); PM_RETURN_IF_ERROR(retval);    
+						retval = int_new(*tmpInt32, &value); UAVO_RETURN_IF_ERROR(retval, namesObjid);    
 						dataIdx = dataIdx + 4;
 						break;  
 					case TYPE_FLOAT32:
 						tmpFloat = (float*)(&data[dataIdx]);
-						retval = float_new(*tmpFloat, &value); PM_RETURN_IF_ERROR(retval);    
+						retval = float_new(*tmpFloat, &value); UAVO_RETURN_IF_ERROR(retval, namesObjid);    
 						dataIdx = dataIdx + 4;
 						break;    
 				}
 				// Set value 
 				if ( OBJ_GET_TYPE(field) == OBJ_TYPE_LST )
 				{
-					retval = list_setItem(field, valueIdx, value); PM_RETURN_IF_ERROR(retval); 
+					retval = list_setItem(field, valueIdx, value); UAVO_RETURN_IF_ERROR(retval, namesObjid);
 				}
 				else
 				{
-					tmpStr = (uint8_t const *)"value";
-					retval = string_new(&tmpStr, &fieldName); PM_RETURN_IF_ERROR(retval); 
-					retval = dict_setItem(attrs, fieldName, value); PM_RETURN_IF_ERROR(retval); 
+					retval = dict_setItem(attrs, nameValue, value); UAVO_RETURN_IF_ERROR(retval, namesObjid);
 				}
 			}
 		}
+		heap_gcPopTempRoot(namesObjid);
 		
 		// Done
 		return PM_RET_OK;
@@ -292,6 +318,10 @@ class UAVObject:
 		uint32_t type;  
 		uint32_t numElements;  
 		uint8_t const *tmpStr;
+		pPmObj_t nameFtype;
+		pPmObj_t nameNumElements;
+		pPmObj_t nameValue;
+		uint8_t namesObjid, objid;
 		int8_t tmpInt8 = 0;
 		int16_t tmpInt16;
 		int32_t tmpInt32;
@@ -324,34 +354,40 @@ class UAVObject:
 		retval = dict_getItem(attrs, fieldName, &fields); PM_RETURN_IF_ERROR(retval);
 		numFields = ((pPmList_t) fields)->length;    
 
+		// Names of the field attributes, created once for all the fields
+		// and kept from the garbage collector until done
+		tmpStr = (uint8_t const *)"ftype";
+		retval = string_new(&tmpStr, &nameFtype); PM_RETURN_IF_ERROR(retval);
+		heap_gcPushTempRoot(nameFtype, &namesObjid);
+		tmpStr = (uint8_t const *)"numElements";
+		retval = string_new(&tmpStr, &nameNumElements); UAVO_RETURN_IF_ERROR(retval, namesObjid);
+		heap_gcPushTempRoot(nameNumElements, &objid);
+		tmpStr = (uint8_t const *)"value";
+		retval = string_new(&tmpStr, &nameValue); UAVO_RETURN_IF_ERROR(retval, namesObjid);
+		heap_gcPushTempRoot(nameValue, &objid);
+
 		// Process each field
 		dataIdx = 0;
 		for (fieldIdx = 0; fieldIdx < numFields; ++fieldIdx)
 		{		
 			// Get field
-			retval = list_getItem(fields, fieldIdx, &field); PM_RETURN_IF_ERROR(retval);
+			retval = list_getItem(fields, fieldIdx, &field); UAVO_RETURN_IF_ERROR(retval, namesObjid);
 			attrs = (pPmObj_t)((pPmInstance_t)field)->cli_attrs;
 			// Get type
-			tmpStr = (uint8_t const *)"ftype";
-			retval = string_new(&tmpStr, &fieldName); PM_RETURN_IF_ERROR(retval); 
-			retval = dict_getItem(attrs, fieldName, &field); PM_RETURN_IF_ERROR(retval);
+			retval = dict_getItem(attrs, nameFtype, &field); UAVO_RETURN_IF_ERROR(retval, namesObjid);
 			type = ((pPmInt_t) field)->val;   
 			// Get number of elements
-			tmpStr = (uint8_t const *)"numElements";
-			retval = string_new(&tmpStr, &fieldName); PM_RETURN_IF_ERROR(retval); 
-			retval = dict_getItem(attrs, fieldName, &field); PM_RETURN_IF_ERROR(retval);
+			retval = dict_getItem(attrs, nameNumElements, &field); UAVO_RETURN_IF_ERROR(retval, namesObjid);
 			numElements = ((pPmInt_t) field)->val;
 			// Get value
-			tmpStr = (uint8_t const *)"value";
-			retval = string_new(&tmpStr, &fieldName); PM_RETURN_IF_ERROR(retval); 
-			retval = dict_getItem(attrs, fieldName, &field); PM_RETURN_IF_ERROR(retval); 
+			retval = dict_getItem(attrs, nameValue, &field); UAVO_RETURN_IF_ERROR(retval, namesObjid);
 			// Set value for each element
 			for (valueIdx = 0; valueIdx < numElements; ++valueIdx)
 			{
 				// Get value
 				if ( OBJ_GET_TYPE(field) == OBJ_TYPE_LST )
 				{
-					retval = list_getItem(field, valueIdx, &value); PM_RETURN_IF_ERROR(retval); 
+					retval = list_getItem(field, valueIdx, &value); UAVO_RETURN_IF_ERROR(retval, namesObjid);
 				}
 				else
 					value = field;
@@ -413,6 +449,7 @@ class UAVObject:
 				}
 			}
 		}
+		heap_gcPopTempRoot(namesObjid);
 		
 		// Write object data
 		UAVObjSetInstanceData(objHandle, instId, data);
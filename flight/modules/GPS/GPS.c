@@ -112,6 +112,7 @@ void updateGpsSettings(UAVObjEvent *ev);
 // Private variables
 
 static uint32_t gpsPort;
+static uint32_t gpsBaud;
 static bool gpsEnabled = false;
 
 static xTaskHandle gpsTaskHandle;
@@ -285,6 +286,8 @@ static void gpsTask(__attribute__((unused)) void *parameters)
             PERF_TIMED_SECTION_START(counterParse);
             PERF_TRACK_VALUE(counterBytesIn, cnt);
             PERF_MEASURE_PERIOD(counterRate);
+            // the solutions completed in this buffer were received by now
+            gpspositionsensor.RxTime = PIOS_COM_GetRxTime(gpsPort);
             int res;
             switch (gpsSettings.DataProtocol) {
 #if defined(PIOS_INCLUDE_GPS_NMEA_PARSER)
@@ -439,30 +442,33 @@ static void updateHwSettings()
         // Set port speed
         switch (speed) {
         case HWSETTINGS_GPSSPEED_2400:
-            PIOS_COM_ChangeBaud(gpsPort, 2400);
+            gpsBaud = 2400;
             break;
         case HWSETTINGS_GPSSPEED_4800:
-            PIOS_COM_ChangeBaud(gpsPort, 4800);
+            gpsBaud = 4800;
             break;
         case HWSETTINGS_GPSSPEED_9600:
-            PIOS_COM_ChangeBaud(gpsPort, 9600);
+            gpsBaud = 9600;
             break;
         case HWSETTINGS_GPSSPEED_19200:
-            PIOS_COM_ChangeBaud(gpsPort, 19200);
+            gpsBaud = 19200;
             break;
         case HWSETTINGS_GPSSPEED_38400:
-            PIOS_COM_ChangeBaud(gpsPort, 38400);
+            gpsBaud = 38400;
             break;
         case HWSETTINGS_GPSSPEED_57600:
-            PIOS_COM_ChangeBaud(gpsPort, 57600);
+            gpsBaud = 57600;
             break;
         case HWSETTINGS_GPSSPEED_115200:
-            PIOS_COM_ChangeBaud(gpsPort, 115200);
+            gpsBaud = 115200;
             break;
         case HWSETTINGS_GPSSPEED_230400:
-            PIOS_COM_ChangeBaud(gpsPort, 230400);
+            gpsBaud = 230400;
             break;
+        default:
+            return;
         }
+        PIOS_COM_ChangeBaud(gpsPort, gpsBaud);
     }
 }
 
@@ -481,6 +487,11 @@ void updateGpsSettings(__attribute__((unused)) UAVObjEvent *ev)
     uint8_t ubxSbasSats;
 
     GPSSettingsUbxRateGet(&newconfig.navRate);
+    newconfig.baud = gpsBaud;
+
+    uint8_t ubxPvtOnly;
+    GPSSettingsUbxPVTOnlyGet(&ubxPvtOnly);
+    newconfig.pvtOnly = ubxPvtOnly == GPSSETTINGS_UBXPVTONLY_TRUE;
 
     GPSSettingsUbxAutoConfigGet(&ubxAutoConfig);
     newconfig.autoconfigEnabled = ubxAutoConfig == GPSSETTINGS_UBXAUTOCONFIG_DISABLED ? false : true;
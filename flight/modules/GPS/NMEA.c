@@ -44,7 +44,6 @@
 
 // Debugging
 #ifdef ENABLE_DEBUG_MSG
-// #define DEBUG_MSG_IN			///< define to display the incoming NMEA messages
 // #define DEBUG_PARAMS			///< define to display the incoming NMEA messages split into its parameters
 // #define DEBUG_MSGID_IN		///< define to display the names of the incoming NMEA messages
 // #define NMEA_DEBUG_PKT		///< define to enable debug of all NMEA messages
@@ -76,41 +75,73 @@ static bool nmeaProcessGxZDA(GPSPositionSensorData *GpsData, bool *gpsDataUpdate
 static bool nmeaProcessGxGSV(GPSPositionSensorData *GpsData, bool *gpsDataUpdated, char *param[], uint8_t nbParam);
 #endif // PIOS_GPS_MINIMAL
 
-static const struct nmea_parser nmea_parsers[] = {
-    {
+/*
+ * The parsers are found by a hash of the three letters of the sentence id,
+ * perfect over the ids we handle. A new id must land on a free slot, the
+ * compiler warns about a slot initialized twice (-Woverride-init).
+ */
+#define NMEA_PARSER_SLOTS 8
+#define NMEA_HASH(a, b, c) (((((uint8_t)(a)) << 1) ^ ((uint8_t)(b)) ^ ((uint8_t)(c))) & (NMEA_PARSER_SLOTS - 1))
+
+static const struct nmea_parser nmea_parsers[NMEA_PARSER_SLOTS] = {
+    [NMEA_HASH('G', 'G', 'A')] = {
         .prefix  = "GGA",
         .handler = nmeaProcessGxGGA,
     },
-    {
+    [NMEA_HASH('V', 'T', 'G')] = {
         .prefix  = "VTG",
         .handler = nmeaProcessGxVTG,
     },
-    {
+    [NMEA_HASH('G', 'S', 'A')] = {
         .prefix  = "GSA",
         .handler = nmeaProcessGxGSA,
     },
-    {
+    [NMEA_HASH('R', 'M', 'C')] = {
         .prefix  = "RMC",
         .handler = nmeaProcessGxRMC,
     },
 #if !defined(PIOS_GPS_MINIMAL)
-    {
+    [NMEA_HASH('Z', 'D', 'A')] = {
         .prefix  = "ZDA",
         .handler = nmeaProcessGxZDA,
     },
-    {
+    [NMEA_HASH('G', 'S', 'V')] = {
         .prefix  = "GSV",
         .handler = nmeaProcessGxGSV,
     },
 #endif // PIOS_GPS_MINIMAL
 };
 
+static bool NMEA_process_sentence(char *params[], uint8_t nbParams, GPSPositionSensorData *GpsData);
+
+static inline int8_t NMEA_hex_digit(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+/**
+ * Receives the NMEA stream, the sentences are checksummed and split into their
+ * parameters as their characters come in, so that each character is handled once
+ */
 int parse_nmea_stream(uint8_t *rx, uint8_t len, char *gps_rx_buffer, GPSPositionSensorData *GpsData, struct GPS_RX_STATS *gpsRxStats)
 {
     int ret = PARSER_INCOMPLETE;
     static uint8_t rx_count = 0;
     static bool start_flag  = false;
     static bool found_cr    = false;
+    // offsets of the parameters in the buffer, their separators zeroed
+    static uint8_t param_start[MAX_NB_PARAMS];
+    static uint8_t nbParams;
+    static uint8_t checksum_computed;
+    static uint8_t checksum_received;
+    static int8_t checksum_digits; // -1 until the '*'
     uint8_t c;
 
     for (int i = 0; i < len; i++) {
@@ -120,6 +151,15 @@ int parse_nmea_stream(uint8_t *rx, uint8_t len, char *gps_rx_buffer, GPSPosition
             start_flag = true;
             found_cr   = false;
             rx_count   = 0;
+            // The first parameter is the message name
+            // Skip the two characters of the talker, allow GL, GN, GP...
+            param_start[0]    = 3;
+            nbParams          = 1;
+            checksum_computed = 0;
+            checksum_received = 0;
+            checksum_digits   = -1;
+            gps_rx_buffer[rx_count++] = c;
+            continue;
         } else if (!start_flag) {
             return PARSER_ERROR;
         }
@@ -132,10 +172,36 @@ int parse_nmea_stream(uint8_t *rx, uint8_t len, char *gps_rx_buffer, GPSPosition
             found_cr   = false;
             rx_count   = 0;
             ret = PARSER_OVERRUN;
+            continue;
+        }
+
+        // Sample NMEA message: "$GPRMC,000131.736,V,,,,,0.00,0.00,060180,,,N*43"
+        if (checksum_digits < 0) {
+            if (c == '*') {
+                // After the * comes the "CRC", zero-terminate the last parameter
+                gps_rx_buffer[rx_count] = 0;
+                checksum_digits = 0;
+            } else {
+                checksum_computed ^= c;
+                if (c == ',') {
+                    // This is the end of this parameter, start a new one
+                    gps_rx_buffer[rx_count] = 0;
+                    if (nbParams < MAX_NB_PARAMS) {
+                        param_start[nbParams++] = rx_count + 1;
+                    }
+                } else {
+                    gps_rx_buffer[rx_count] = c;
+                }
+            }
         } else {
+            int8_t digit = NMEA_hex_digit(c);
+            if (digit >= 0 && checksum_digits < 2) {
+                checksum_received = (checksum_received << 4) | digit;
+                checksum_digits++;
+            }
             gps_rx_buffer[rx_count] = c;
-            rx_count++;
         }
+        rx_count++;
 
         // look for ending '\r\n' sequence
         if (!found_cr && (c == '\r')) {
@@ -143,33 +209,24 @@ int parse_nmea_stream(uint8_t *rx, uint8_t len, char *gps_rx_buffer, GPSPosition
         } else if (found_cr && (c != '\n')) {
             found_cr = false; // false end flag
         } else if (found_cr && (c == '\n')) {
-            // The NMEA functions require a zero-terminated string
-            // As we detected \r\n, the string as for sure 2 bytes long, we will also strip the \r\n
-            gps_rx_buffer[rx_count - 2] = 0;
-
             // prepare to parse next sentence
             start_flag = false;
             found_cr   = false;
             rx_count   = 0;
-            // Our rxBuffer must look like this now:
-            // [0]           = '$'
-            // ...           = zero or more bytes of sentence payload
-            // [end_pos - 1] = '\r'
-            // [end_pos]     = '\n'
-            //
-            // Prepare to consume the sentence from the buffer
 
             // Validate the checksum over the sentence
-            if (!NMEA_checksum(&gps_rx_buffer[1])) { // Invalid checksum.  May indicate dropped characters on Rx.
-                                                     // PIOS_DEBUG_PinHigh(2);
+            if (checksum_digits <= 0 || checksum_computed != checksum_received) {
+                // Invalid checksum.  May indicate dropped characters on Rx.
                 gpsRxStats->gpsRxChkSumError++;
-                // PIOS_DEBUG_PinLow(2);
                 ret = PARSER_ERROR;
             } else { // Valid checksum, use this packet to update the GPS position
-                if (!NMEA_update_position(&gps_rx_buffer[1], GpsData)) {
-                    // PIOS_DEBUG_PinHigh(2);
+                char *params[MAX_NB_PARAMS];
+                for (uint8_t j = 0; j < nbParams; j++) {
+                    params[j] = &gps_rx_buffer[param_start[j]];
+                }
+
+                if (!NMEA_process_sentence(params, nbParams, GpsData)) {
                     gpsRxStats->gpsRxParserError++;
-                    // PIOS_DEBUG_PinLow(2);
                 } else {
                     gpsRxStats->gpsRxReceived++;
                 };
@@ -183,120 +240,93 @@ int parse_nmea_stream(uint8_t *rx, uint8_t len, char *gps_rx_buffer, GPSPosition
 
 static const struct nmea_parser *NMEA_find_parser_by_prefix(const char *prefix)
 {
-    if (!prefix) {
+    if (!prefix || !prefix[0] || !prefix[1] || !prefix[2] || prefix[3]) {
         return NULL;
     }
 
-    for (uint8_t i = 0; i < NELEMENTS(nmea_parsers); i++) {
-        const struct nmea_parser *parser = &nmea_parsers[i];
+    const struct nmea_parser *parser = &nmea_parsers[NMEA_HASH(prefix[0], prefix[1], prefix[2])];
 
-        /* Use strcmp to check for exact equality over the entire prefix */
-        if (!strcmp(prefix, parser->prefix)) {
-            /* Found an appropriate parser */
-            return parser;
-        }
+    /* The hash only tells where the parser would be, check for exact equality */
+    if (parser->prefix && !memcmp(prefix, parser->prefix, 3)) {
+        /* Found an appropriate parser */
+        return parser;
     }
 
     /* No matching parser for this prefix */
     return NULL;
 }
 
-/**
- * Computes NMEA sentence checksum
- * \param[in] Buffer for parsed nmea sentence
- * \return false checksum not valid
- * \return true checksum valid
+/* 10^-n, the scale of the numbers with n decimals */
+static const float nmea_decimal_scale[] = {
+    1e0f, 1e-1f, 1e-2f, 1e-3f, 1e-4f, 1e-5f, 1e-6f, 1e-7f, 1e-8f, 1e-9f
+};
+
+/* Parse a number encoded in a string of the format:
+ *   [-]NN[.nnnnn]
+ * into an integer of its digits, the decimal point dropped.
+ * The decimals field is the number of digits after the point, the
+ * ones after the ninth are ignored.
  */
-bool NMEA_checksum(char *nmea_sentence)
+static int32_t NMEA_parse_fixed(const char *field, uint8_t *decimals)
 {
-    uint8_t checksum_computed = 0;
-    uint8_t checksum_received;
-
-    while (*nmea_sentence != '\0' && *nmea_sentence != '*') {
-        checksum_computed ^= *nmea_sentence;
-        nmea_sentence++;
-    }
-
-    /* Make sure we're now pointing at the checksum */
-    if (*nmea_sentence == '\0') {
-        /* Buffer ran out before we found a checksum marker */
-        return false;
+    bool negative = false;
+    bool point    = false;
+    int32_t value = 0;
+
+    *decimals = 0;
+    if (*field == '-') {
+        negative = true;
+        field++;
+    }
+
+    for (;; field++) {
+        if (*field >= '0' && *field <= '9') {
+            if (!point) {
+                value = value * 10 + (*field - '0');
+            } else if (*decimals < NELEMENTS(nmea_decimal_scale) - 1) {
+                value = value * 10 + (*field - '0');
+                (*decimals)++;
+            }
+        } else if (*field == '.' && !point) {
+            point = true;
+        } else {
+            break;
+        }
     }
 
-    /* Load the checksum from the buffer */
-    checksum_received = strtol(nmea_sentence + 1, NULL, 16);
-
-    // PIOS_COM_SendFormattedStringNonBlocking(COM_DEBUG_USART,"$%d=%d\r\n",checksum_received,checksum_computed);
-
-    return checksum_computed == checksum_received;
+    return negative ? -value : value;
 }
 
-/*
- * This function only exists to deal with a linking
- * failure in the stdlib function strtof().  This
- * implementation does not rely on the _sbrk() syscall
- * like strtof() does.
- */
-
-/* Parse a number encoded in a string of the format:
- *   [-]NN.nnnnn
- * into a signed whole part and an unsigned fractional part.
- * The fract_units field indicates the units of the fractional part as
- *   1 whole = 10^fract_units fract
- */
-static bool NMEA_parse_real(int32_t *whole, uint32_t *fract, uint8_t *fract_units, char *field)
+/* The whole part of an unsigned number, such as hhmmss.sss times */
+static uint32_t NMEA_parse_whole(const char *field)
 {
-    char *s = field;
-    char *field_w;
-    char *field_f;
-
-    PIOS_DEBUG_Assert(whole);
-    PIOS_DEBUG_Assert(fract);
-    PIOS_DEBUG_Assert(fract_units);
-    PIOS_DEBUG_Assert(field);
-
-    field_w = strsep(&s, ".");
-    field_f = s;
-
-    *whole  = strtol(field_w, NULL, 10);
+    uint32_t value = 0;
 
-    if (field_w) {
-        /* decimal was found so we may have a fractional part */
-        *fract = strtoul(field_f, NULL, 10);
-        *fract_units = strlen(field_f);
-    } else {
-        /* no decimal was found, fractional part is zero */
-        *fract = 0;
-        *fract_units = 0;
+    while (*field >= '0' && *field <= '9') {
+        value = value * 10 + (*field++ - '0');
     }
-
-    return true;
+    return value;
 }
 
-static float NMEA_real_to_float(char *nmea_real)
+static float NMEA_real_to_float(const char *nmea_real)
 {
-    int32_t whole;
-    uint32_t fract;
-    uint8_t fract_units;
-
-    if (!NMEA_parse_real(&whole, &fract, &fract_units, nmea_real)) {
-        return false;
-    }
+    uint8_t decimals;
+    int32_t value = NMEA_parse_fixed(nmea_real, &decimals);
 
     /* Convert to float */
-    return ((float)whole) + fract * powf(10.0f, -fract_units);
+    return value * nmea_decimal_scale[decimals];
 }
 
 /*
  * Parse a field in the format:
- *    DD[D]MM.mmmm[mm]
+ *    DD[D]MM.mmmm[mmm]
  * into a fixed-point representation in units of (degrees * 1e-7)
  */
-static bool NMEA_latlon_to_fixed_point(int32_t *latlon, char *nmea_latlon, bool negative)
+static bool NMEA_latlon_to_fixed_point(int32_t *latlon, const char *nmea_latlon, bool negative)
 {
-    int32_t num_DDDMM;
-    uint32_t num_m;
-    uint8_t units;
+    uint32_t num_DDDMM = 0;
+    uint32_t num_m     = 0;
+    uint8_t units      = 0;
 
     /* Sanity checks */
     PIOS_DEBUG_Assert(nmea_latlon);
@@ -306,38 +336,22 @@ static bool NMEA_latlon_to_fixed_point(int32_t *latlon, char *nmea_latlon, bool
         return false;
     }
 
-    if (!NMEA_parse_real(&num_DDDMM, &num_m, &units, nmea_latlon)) {
-        return false;
+    num_DDDMM = NMEA_parse_whole(nmea_latlon);
+    while (*nmea_latlon >= '0' && *nmea_latlon <= '9') {
+        nmea_latlon++;
     }
 
-    /* scale up the mmmm[mm] field apropriately depending on # of digits */
-    /* not using 1eN notation because that forces fixed point and lost precision */
-    switch (units) {
-    case 0:
-        /* no digits, value is zero so no scaling */
-        break;
-    case 1: /* m       */
-        num_m *= 1000000; /* m000000 */
-        break;
-    case 2: /* mm      */
-        num_m *= 100000; /* mm00000 */
-        break;
-    case 3: /* mmm     */
-        num_m *= 10000; /* mmm0000 */
-        break;
-    case 4: /* mmmm    */
-        num_m *= 1000; /* mmmm000 */
-        break;
-    case 5: /* mmmmm   */
-        num_m *= 100; /* mmmmm00 */
-        break;
-    case 6: /* mmmmmm  */
-        num_m *= 10; /* mmmmmm0 */
-        break;
-    default:
-        /* unhandled format */
-        num_m = 0.0f;
-        break;
+    /* the mmmm[mmm] field, in 1e-7 minutes: the digits after the seventh are dropped */
+    if (*nmea_latlon == '.') {
+        for (nmea_latlon++; *nmea_latlon >= '0' && *nmea_latlon <= '9'; nmea_latlon++) {
+            if (units < 7) {
+                num_m = num_m * 10 + (*nmea_latlon - '0');
+                units++;
+            }
+        }
+    }
+    for (; units < 7; units++) {
+        num_m *= 10;
     }
 
     *latlon  = (num_DDDMM / 100) * 10000000;        /* scale the whole degrees */
@@ -353,48 +367,13 @@ static bool NMEA_latlon_to_fixed_point(int32_t *latlon, char *nmea_latlon, bool
 
 
 /**
- * Parses a complete NMEA sentence and updates the GPSPositionSensor UAVObject
- * \param[in] An NMEA sentence with a valid checksum
+ * Processes a complete NMEA sentence and updates the GPSPositionSensor UAVObject
+ * \param[in] The parameters of an NMEA sentence with a valid checksum, the first one its name
  * \return true if the sentence was successfully parsed
  * \return false if any errors were encountered with the parsing
  */
-bool NMEA_update_position(char *nmea_sentence, GPSPositionSensorData *GpsData)
+static bool NMEA_process_sentence(char *params[], uint8_t nbParams, GPSPositionSensorData *GpsData)
 {
-    char *p = nmea_sentence;
-    char *params[MAX_NB_PARAMS];
-    uint8_t nbParams;
-
-#ifdef DEBUG_MSG_IN
-    DEBUG_MSG("\"%s\"\n", nmea_sentence);
-#endif
-
-    // Split the nmea sentence it its parameters, separated by ","
-    // Sample NMEA message: "GPRMC,000131.736,V,,,,,0.00,0.00,060180,,,N*43"
-
-    // The first parameter starts at the beginning of the message
-    // Skip first two character, allow GL, GN, GP...
-    p += 2;
-    params[0] = p;
-    nbParams  = 1;
-    while (*p != 0) {
-        if (*p == '*') {
-            // After the * comes the "CRC", we are done,
-            *p = 0; // Zero-terminate this parameter
-            break;
-        } else if (*p == ',') {
-            // This is the end of this parameter
-            *p = 0; // Zero-terminate this parameter
-            // Start new parameter
-            if (nbParams == MAX_NB_PARAMS) {
-                break;
-            }
-            params[nbParams] = p + 1; // For sure there is something at p+1 because at p there is ","
-            nbParams++;
-        }
-        p++;
-    }
-
-
 #ifdef DEBUG_PARAMS
     int i;
     for (i = 0; i < nbParams; i++) {
@@ -492,7 +471,7 @@ static bool nmeaProcessGxGGA(GPSPositionSensorData *GpsData, bool *gpsDataUpdate
     }
 
     // get number of satellites used in GPS solution
-    GpsData->Satellites = atoi(param[7]);
+    GpsData->Satellites = NMEA_parse_whole(param[7]);
 
     // get altitude (in meters mm.m)
     GpsData->Altitude   = NMEA_real_to_float(param[9]);
@@ -530,10 +509,10 @@ static bool nmeaProcessGxRMC(GPSPositionSensorData *GpsData, bool *gpsDataUpdate
     GPSTimeGet(&gpst);
 
     // get UTC time [hhmmss.sss]
-    float hms = NMEA_real_to_float(param[1]);
-    gpst.Second = (int)hms % 100;
-    gpst.Minute = (((int)hms - gpst.Second) / 100) % 100;
-    gpst.Hour   = (int)hms / 10000;
+    uint32_t hms = NMEA_parse_whole(param[1]);
+    gpst.Second = hms % 100;
+    gpst.Minute = (hms / 100) % 100;
+    gpst.Hour   = hms / 10000;
 #endif // PIOS_GPS_MINIMAL
 
     // don't process void sentences
@@ -558,12 +537,11 @@ static bool nmeaProcessGxRMC(GPSPositionSensorData *GpsData, bool *gpsDataUpdate
     GpsData->Heading     = NMEA_real_to_float(param[8]);
 
 #if !defined(PIOS_GPS_MINIMAL)
-    // get Date of fix
-    // TODO: Should really not use a float here to be safe
-    float date = NMEA_real_to_float(param[9]);
-    gpst.Year  = (int)date % 100;
-    gpst.Month = (((int)date - gpst.Year) / 100) % 100;
-    gpst.Day   = (int)(date / 10000);
+    // get Date of fix [ddmmyy]
+    uint32_t date = NMEA_parse_whole(param[9]);
+    gpst.Year  = date % 100;
+    gpst.Month = (date / 100) % 100;
+    gpst.Day   = date / 10000;
     gpst.Year += 2000;
     GPSTimeSet(&gpst);
 #endif // PIOS_GPS_MINIMAL
@@ -619,15 +597,15 @@ static bool nmeaProcessGxZDA(__attribute__((unused)) GPSPositionSensorData *GpsD
     GPSTimeGet(&gpst);
 
     // get UTC time [hhmmss.sss]
-    float hms = NMEA_real_to_float(param[1]);
-    gpst.Second = (int)hms % 100;
-    gpst.Minute = (((int)hms - gpst.Second) / 100) % 100;
-    gpst.Hour   = (int)hms / 10000;
+    uint32_t hms = NMEA_parse_whole(param[1]);
+    gpst.Second = hms % 100;
+    gpst.Minute = (hms / 100) % 100;
+    gpst.Hour   = hms / 10000;
 
     // Get Date
-    gpst.Day    = atoi(param[2]);
-    gpst.Month  = atoi(param[3]);
-    gpst.Year   = atoi(param[4]);
+    gpst.Day    = NMEA_parse_whole(param[2]);
+    gpst.Month  = NMEA_parse_whole(param[3]);
+    gpst.Year   = NMEA_parse_whole(param[4]);
 
     GPSTimeSet(&gpst);
     return true;
@@ -652,8 +630,8 @@ static bool nmeaProcessGxGSV(__attribute__((unused)) GPSPositionSensorData *GpsD
     DEBUG_MSG(" Sats=%s\n", param[3]);
 #endif
 
-    uint8_t nbSentences  = atoi(param[1]);
-    uint8_t currSentence = atoi(param[2]);
+    uint8_t nbSentences  = NMEA_parse_whole(param[1]);
+    uint8_t currSentence = NMEA_parse_whole(param[2]);
 
     *gpsDataUpdated = false;
 
@@ -661,7 +639,7 @@ static bool nmeaProcessGxGSV(__attribute__((unused)) GPSPositionSensorData *GpsD
         return false;
     }
 
-    gsv_partial.SatsInView = atoi(param[3]);
+    gsv_partial.SatsInView = NMEA_parse_whole(param[3]);
 
     // Find out if this is the first sentence in the GSV set
     if (currSentence == 1) {
@@ -696,10 +674,10 @@ static bool nmeaProcessGxGSV(__attribute__((unused)) GPSPositionSensorData *GpsD
             uint8_t sat_index = ((currSentence - 1) * 4) + i;
 
             // Get sat info
-            gsv_partial.PRN[sat_index]       = atoi(param[parIdx++]);
-            gsv_partial.Elevation[sat_index] = atoi(param[parIdx++]);
-            gsv_partial.Azimuth[sat_index]   = atoi(param[parIdx++]);
-            gsv_partial.SNR[sat_index]       = atoi(param[parIdx++]);
+            gsv_partial.PRN[sat_index]       = NMEA_parse_whole(param[parIdx++]);
+            gsv_partial.Elevation[sat_index] = NMEA_parse_whole(param[parIdx++]);
+            gsv_partial.Azimuth[sat_index]   = NMEA_parse_whole(param[parIdx++]);
+            gsv_partial.SNR[sat_index]       = NMEA_parse_whole(param[parIdx++]);
 #ifdef NMEA_DEBUG_GSV
             DEBUG_MSG(" %d", gsv_partial.PRN[sat_index]);
 #endif
@@ -743,7 +721,7 @@ static bool nmeaProcessGxGSA(GPSPositionSensorData *GpsData, bool *gpsDataUpdate
 
     *gpsDataUpdated = false;
 
-    switch (atoi(param[2])) {
+    switch (NMEA_parse_whole(param[2])) {
     case 1:
         GpsData->Status = GPSPOSITIONSENSOR_STATUS_NOFIX;
         break;
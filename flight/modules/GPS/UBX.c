@@ -77,12 +77,15 @@ static void parse_ubx_mon_ver(struct UBXPacket *ubx, GPSPositionSensorData *GpsP
 #endif
 
 const ubx_message_handler ubx_handler_table[] = {
+#ifndef PIOS_GPS_MINIMAL
+    // the only navigation message of high rate receivers, see GPSSettings.UbxPVTOnly
+    { .msgClass = UBX_CLASS_NAV,     .msgID = UBX_ID_NAV_PVT,     .handler = &parse_ubx_nav_pvt     },
+#endif
     { .msgClass = UBX_CLASS_NAV,     .msgID = UBX_ID_NAV_POSLLH,  .handler = &parse_ubx_nav_posllh  },
     { .msgClass = UBX_CLASS_NAV,     .msgID = UBX_ID_NAV_VELNED,  .handler = &parse_ubx_nav_velned  },
     { .msgClass = UBX_CLASS_NAV,     .msgID = UBX_ID_NAV_SOL,     .handler = &parse_ubx_nav_sol     },
     { .msgClass = UBX_CLASS_NAV,     .msgID = UBX_ID_NAV_DOP,     .handler = &parse_ubx_nav_dop     },
 #ifndef PIOS_GPS_MINIMAL
-    { .msgClass = UBX_CLASS_NAV,     .msgID = UBX_ID_NAV_PVT,     .handler = &parse_ubx_nav_pvt     },
     { .msgClass = UBX_CLASS_OP_CUST, .msgID = UBX_ID_OP_MAG,      .handler = &parse_ubx_op_mag      },
     { .msgClass = UBX_CLASS_NAV,     .msgID = UBX_ID_NAV_SVINFO,  .handler = &parse_ubx_nav_svinfo  },
     { .msgClass = UBX_CLASS_NAV,     .msgID = UBX_ID_NAV_TIMEUTC, .handler = &parse_ubx_nav_timeutc },
@@ -124,7 +127,7 @@ int parse_ubx_stream(uint8_t *rx, uint8_t len, char *gps_rx_buffer, GPSPositionS
     };
     uint8_t c;
     static enum proto_states proto_state = START;
-    static uint8_t rx_count = 0;
+    static uint16_t rx_count = 0;
     struct UBXPacket *ubx   = (struct UBXPacket *)gps_rx_buffer;
 
     for (int i = 0; i < len; i++) {
@@ -161,20 +164,21 @@ int parse_ubx_stream(uint8_t *rx, uint8_t len, char *gps_rx_buffer, GPSPositionS
                 proto_state = START;
             } else {
                 rx_count    = 0;
-                proto_state = UBX_PAYLOAD;
+                proto_state = (ubx->header.len > 0) ? UBX_PAYLOAD : UBX_CHK1;
             }
             break;
         case UBX_PAYLOAD:
-            if (rx_count < ubx->header.len) {
-                ubx->payload.payload[rx_count] = c;
-                if (++rx_count == ubx->header.len) {
-                    proto_state = UBX_CHK1;
-                }
-            } else {
-                gpsRxStats->gpsRxOverflow++;
-                proto_state = START;
+        {
+            // take as much of the payload as this buffer holds in one go
+            uint16_t count = MIN(ubx->header.len - rx_count, len - i);
+            memcpy(&ubx->payload.payload[rx_count], &rx[i], count);
+            rx_count += count;
+            i += count - 1;
+            if (rx_count == ubx->header.len) {
+                proto_state = UBX_CHK1;
             }
-            break;
+        }
+        break;
         case UBX_CHK1:
             ubx->header.ck_a = c;
             proto_state = UBX_CHK2;
@@ -330,6 +334,7 @@ static void parse_ubx_nav_velned(struct UBXPacket *ubx, GPSPositionSensorData *G
             GpsVelocity.North        = (float)velned->velN / 100.0f;
             GpsVelocity.East         = (float)velned->velE / 100.0f;
             GpsVelocity.Down         = (float)velned->velD / 100.0f;
+            GpsVelocity.RxTime       = GpsPosition->RxTime;
             GPSVelocitySensorSet(&GpsVelocity);
             GpsPosition->Groundspeed = (float)velned->gSpeed * 0.01f;
             GpsPosition->Heading     = (float)velned->heading * 1.0e-5f;
@@ -348,6 +353,7 @@ static void parse_ubx_nav_pvt(struct UBXPacket *ubx, GPSPositionSensorData *GpsP
     GpsVelocity.North = (float)pvt->velN * 0.001f;
     GpsVelocity.East  = (float)pvt->velE * 0.001f;
     GpsVelocity.Down  = (float)pvt->velD * 0.001f;
+    GpsVelocity.RxTime = GpsPosition->RxTime;
     GPSVelocitySensorSet(&GpsVelocity);
 
     GpsPosition->Groundspeed     = (float)pvt->gSpeed * 0.001f;
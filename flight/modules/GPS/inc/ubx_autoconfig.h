@@ -37,6 +37,13 @@
 #define UBX_MAX_RATE_VER7       10
 #define UBX_MAX_RATE            5
 
+// bytes sent per navigation solution, the rate is kept within what the port carries
+#define UBX_SOLUTION_BYTES_VER6 270 // POSLLH, VELNED, SOL, STATUS, DOP, TIMEUTC
+#define UBX_SOLUTION_BYTES_VER7 134 // PVT, DOP
+#define UBX_SOLUTION_BYTES_PVT  100 // PVT alone
+// share of the port the solutions may use, the rest is left to SVINFO and the acks
+#define UBX_SOLUTION_LOAD       75
+
 // time to wait before reinitializing the fsm due to disconnection
 #define UBX_CONNECTION_TIMEOUT  (2000 * 1000)
 // times between retries in case an error does occurs
@@ -88,6 +95,9 @@ typedef struct {
 
     int8_t  navRate;
     ubx_config_dynamicmodel_t dynamicModel;
+
+    bool     pvtOnly; // NAV-PVT as the only navigation message, for high rates
+    uint32_t baud; // speed of the GPS port, 0 if unknown
 } ubx_autoconfig_settings_t;
 
 // Mask for "all supported devices": battery backed RAM, Flash, EEPROM, SPI Flash
@@ -113,6 +113,38 @@ ubx_cfg_msg_t msg_config_ubx7[] = {
     { .msgClass = UBX_CLASS_NAV, .msgID = UBX_ID_NAV_SVINFO,    .rate = 10 },
 };
 
+// NAV-PVT alone, the fast path of the parser, SVINFO once a second at 25Hz
+ubx_cfg_msg_t msg_config_ubx7_pvt[] = {
+    // messages to disable
+    { .msgClass = UBX_CLASS_NAV, .msgID = UBX_ID_NAV_AOPSTATUS, .rate = 0  },
+    { .msgClass = UBX_CLASS_NAV, .msgID = UBX_ID_NAV_CLOCK,     .rate = 0  },
+    { .msgClass = UBX_CLASS_NAV, .msgID = UBX_ID_NAV_DGPS,      .rate = 0  },
+    { .msgClass = UBX_CLASS_NAV, .msgID = UBX_ID_NAV_POSECEF,   .rate = 0  },
+    { .msgClass = UBX_CLASS_NAV, .msgID = UBX_ID_NAV_SBAS,      .rate = 0  },
+    { .msgClass = UBX_CLASS_NAV, .msgID = UBX_ID_NAV_TIMEGPS,   .rate = 0  },
+    { .msgClass = UBX_CLASS_NAV, .msgID = UBX_ID_NAV_VELECEF,   .rate = 0  },
+    { .msgClass = UBX_CLASS_NAV, .msgID = UBX_ID_NAV_SOL,       .rate = 0  },
+    { .msgClass = UBX_CLASS_NAV, .msgID = UBX_ID_NAV_STATUS,    .rate = 0  },
+    { .msgClass = UBX_CLASS_NAV, .msgID = UBX_ID_NAV_VELNED,    .rate = 0  },
+    { .msgClass = UBX_CLASS_NAV, .msgID = UBX_ID_NAV_TIMEUTC,   .rate = 0  },
+    { .msgClass = UBX_CLASS_NAV, .msgID = UBX_ID_NAV_POSLLH,    .rate = 0  },
+    { .msgClass = UBX_CLASS_NAV, .msgID = UBX_ID_NAV_DOP,       .rate = 0  },
+
+    { .msgClass = UBX_CLASS_MON, .msgID = UBX_ID_MON_HW,        .rate = 0  },
+    { .msgClass = UBX_CLASS_MON, .msgID = UBX_ID_MON_HW2,       .rate = 0  },
+    { .msgClass = UBX_CLASS_MON, .msgID = UBX_ID_MON_IO,        .rate = 0  },
+    { .msgClass = UBX_CLASS_MON, .msgID = UBX_ID_MON_MSGPP,     .rate = 0  },
+    { .msgClass = UBX_CLASS_MON, .msgID = UBX_ID_MON_RXBUFF,    .rate = 0  },
+    { .msgClass = UBX_CLASS_MON, .msgID = UBX_ID_MON_RXR,       .rate = 0  },
+    { .msgClass = UBX_CLASS_MON, .msgID = UBX_ID_MON_TXBUF,     .rate = 0  },
+
+    { .msgClass = UBX_CLASS_RXM, .msgID = UBX_ID_RXM_SVSI,      .rate = 0  },
+
+    // message to enable
+    { .msgClass = UBX_CLASS_NAV, .msgID = UBX_ID_NAV_PVT,       .rate = 1  },
+    { .msgClass = UBX_CLASS_NAV, .msgID = UBX_ID_NAV_SVINFO,    .rate = 25 },
+};
+
 // private defines
 #define LAST_CONFIG_SENT_START     (-1)
 #define LAST_CONFIG_SENT_COMPLETED (-2)
@@ -171,6 +203,13 @@ void config_rate(uint16_t *bytes_to_send)
     } else if (ubxHwVersion >= UBX_HW_VERSION_8 && rate > UBX_MAX_RATE_VER8) {
         rate = UBX_MAX_RATE_VER8;
     }
+    // and no faster than the port can carry the solutions
+    if (status->currentSettings.baud) {
+        uint16_t bytes = (ubxHwVersion < UBX_HW_VERSION_7) ? UBX_SOLUTION_BYTES_VER6 :
+                         status->currentSettings.pvtOnly ? UBX_SOLUTION_BYTES_PVT : UBX_SOLUTION_BYTES_VER7;
+        uint16_t max_rate = status->currentSettings.baud / 10 * UBX_SOLUTION_LOAD / 100 / bytes;
+        rate = MAX(1, MIN(rate, max_rate));
+    }
     uint16_t period = 1000 / rate;
 
     status->working_packet.message.payload.cfg_rate.measRate = period;
@@ -264,10 +303,19 @@ static void configure(uint16_t *bytes_to_send)
 static void enable_sentences(__attribute__((unused)) uint16_t *bytes_to_send)
 {
     int8_t msg = status->lastConfigSent + 1;
-    uint8_t msg_count = (ubxHwVersion >= UBX_HW_VERSION_7) ?
-                        NELEMENTS(msg_config_ubx7) : NELEMENTS(msg_config_ubx6);
-    ubx_cfg_msg_t *msg_config = (ubxHwVersion >= UBX_HW_VERSION_7) ?
-                                &msg_config_ubx7[0] : &msg_config_ubx6[0];
+    uint8_t msg_count;
+    ubx_cfg_msg_t *msg_config;
+
+    if (ubxHwVersion < UBX_HW_VERSION_7) {
+        msg_count  = NELEMENTS(msg_config_ubx6);
+        msg_config = &msg_config_ubx6[0];
+    } else if (status->currentSettings.pvtOnly) {
+        msg_count  = NELEMENTS(msg_config_ubx7_pvt);
+        msg_config = &msg_config_ubx7_pvt[0];
+    } else {
+        msg_count  = NELEMENTS(msg_config_ubx7);
+        msg_config = &msg_config_ubx7[0];
+    }
 
     if (msg >= 0 && msg < msg_count) {
         status->working_packet.message.payload.cfg_msg = msg_config[msg];
@@ -37,18 +37,40 @@
 #include "debuglogentry.h"
 #include "flightstatus.h"
 
+// private constants
+#define LOGGING_BURST_MAX 16 // entries sent per RetrieveBurst, each needs one DebugLogEntry instance
+#define LOGGING_SAMPLER_MAX_OBJECTS 48 // objects with periodic logging the sampler takes care of
+
+// private types
+struct sampledObject {
+    UAVObjHandle obj;
+    uint16_t     decimation; // sampler ticks per record
+    uint16_t     countdown; // ticks until the next record
+};
+
 // private variables
 static DebugLogSettingsData settings;
 static DebugLogControlData control;
 static DebugLogStatusData status;
 static FlightStatusData flightstatus;
 static DebugLogEntryData *entry; // would be better on stack but event dispatcher stack might be insufficient
+static uint32_t lastBytesWritten;
+static portTickType lastStatusTime;
+static struct sampledObject sampled[LOGGING_SAMPLER_MAX_OBJECTS];
+static uint8_t sampledCount;
+static uint16_t samplerPeriod;
+static bool samplerOverflow;
+static bool samplerEventCreated;
 
 // private functions
 static void SettingsUpdatedCb(UAVObjEvent *ev);
 static void ControlUpdatedCb(UAVObjEvent *ev);
 static void StatusUpdatedCb(UAVObjEvent *ev);
 static void FlightStatusUpdatedCb(UAVObjEvent *ev);
+static void RetrieveEntry(uint16_t instId, uint16_t flight, uint16_t inst);
+static void SamplerUpdate(void);
+static void SamplerAddObject(UAVObjHandle obj);
+static void SamplerCb(UAVObjEvent *ev);
 
 int32_t LoggingInitialize(void)
 {
@@ -89,8 +111,24 @@ MODULE_INITCALL(LoggingInitialize, LoggingStart);
 
 static void StatusUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
+    uint32_t bytesWritten;
+    portTickType now = xTaskGetTickCount();
+    uint32_t elapsed = (now - lastStatusTime) * portTICK_RATE_MS;
+
     PIOS_DEBUGLOG_Info(&status.Flight, &status.Entry, &status.FreeSlots, &status.UsedSlots);
+    PIOS_DEBUGLOG_Counters(&bytesWritten, &status.DroppedEntries);
+    // only update the rate once enough time has passed, this is also called on every control request
+    if (elapsed >= 500) {
+        status.Throughput = ((bytesWritten - lastBytesWritten) * 1000) / elapsed;
+        lastBytesWritten  = bytesWritten;
+        lastStatusTime    = now;
+    }
     DebugLogStatusSet(&status);
+
+    // objects register and metadata change at any time, pick them up
+    if (samplerPeriod) {
+        SamplerUpdate();
+    }
 }
 
 static void FlightStatusUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
@@ -110,6 +148,33 @@ static void FlightStatusUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 static void SettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
     DebugLogSettingsGet(&settings);
+    switch (settings.LogFormat) {
+    case DEBUGLOGSETTINGS_LOGFORMAT_COMPACT:
+        PIOS_DEBUGLOG_SetEncoding(PIOS_DEBUGLOG_ENCODING_COMPACT);
+        break;
+    case DEBUGLOGSETTINGS_LOGFORMAT_COMPACTDELTA:
+        PIOS_DEBUGLOG_SetEncoding(PIOS_DEBUGLOG_ENCODING_COMPACTDELTA);
+        break;
+    default:
+        PIOS_DEBUGLOG_SetEncoding(PIOS_DEBUGLOG_ENCODING_FULL);
+    }
+    if (settings.SamplerPeriod != samplerPeriod) {
+        samplerPeriod = settings.SamplerPeriod;
+        SamplerUpdate();
+
+        UAVObjEvent samplerEv = {
+            .obj    = DebugLogStatusHandle(),
+            .instId = 0,
+            .event  = EV_LOGGING_PERIODIC,
+            .lowPriority = true,
+        };
+        if (!samplerEventCreated) {
+            samplerEventCreated = EventPeriodicCallbackCreate(&samplerEv, SamplerCb, samplerPeriod) == 0;
+        } else {
+            EventPeriodicCallbackUpdate(&samplerEv, SamplerCb, samplerPeriod);
+        }
+        UAVObjSetLoggingSampled(samplerPeriod != 0);
+    }
     if (settings.LoggingEnabled == DEBUGLOGSETTINGS_LOGGINGENABLED_ALWAYS) {
         PIOS_DEBUGLOG_Enable(1);
         PIOS_DEBUGLOG_Printf("On board logging enabled.");
@@ -125,14 +190,28 @@ static void ControlUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
     DebugLogControlGet(&control);
     if (control.Operation == DEBUGLOGCONTROL_OPERATION_RETRIEVE) {
-        memset(entry, 0, sizeof(DebugLogEntryData));
-        if (PIOS_DEBUGLOG_Read(entry, control.Flight, control.Entry) != 0) {
-            // reading from log failed, mark as non existent in output
-            entry->Flight = control.Flight;
-            entry->Entry  = control.Entry;
-            entry->Type   = DEBUGLOGENTRY_TYPE_EMPTY;
+        RetrieveEntry(0, control.Flight, control.Entry);
+    } else if (control.Operation == DEBUGLOGCONTROL_OPERATION_RETRIEVEBURST) {
+        uint8_t burst = MIN(MAX(control.BurstSize, 1), LOGGING_BURST_MAX);
+        // instances are only created once a burst is requested, to not waste memory otherwise
+        uint16_t instances = UAVObjGetNumInstances(DebugLogEntryHandle());
+        while (instances < burst) {
+            DebugLogEntryCreateInstance();
+            if (UAVObjGetNumInstances(DebugLogEntryHandle()) == instances) {
+                break; // out of memory
+            }
+            instances++;
+        }
+        burst = MIN(burst, instances);
+        // every instance gets queued to telemetry with its own data, the gcs acks the whole burst with its next request.
+        // DebugLogEntry is manually updated, so each filled instance is sent by notifying its update
+        for (uint8_t i = 0; i < burst; i++) {
+            RetrieveEntry(i, control.Flight, control.Entry + i);
+            UAVObjInstanceUpdated(DebugLogEntryHandle(), i);
+            if (entry->Type == DEBUGLOGENTRY_TYPE_EMPTY) {
+                break;
+            }
         }
-        DebugLogEntrySet(entry);
     } else if (control.Operation == DEBUGLOGCONTROL_OPERATION_FORMATFLASH) {
         uint8_t armed;
         FlightStatusArmedGet(&armed);
@@ -143,6 +222,89 @@ static void ControlUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
     StatusUpdatedCb(ev);
 }
 
+static void RetrieveEntry(uint16_t instId, uint16_t flight, uint16_t inst)
+{
+    memset(entry, 0, sizeof(DebugLogEntryData));
+    if (PIOS_DEBUGLOG_Read(entry, flight, inst) != 0) {
+        // reading from log failed, mark as non existent in output
+        entry->Flight = flight;
+        entry->Entry  = inst;
+        entry->Type   = DEBUGLOGENTRY_TYPE_EMPTY;
+    }
+    DebugLogEntryInstSet(instId, entry);
+}
+
+/**
+ * Rebuild the list of the objects with a periodic logging update mode. Each
+ * one is recorded every so many sampler ticks, the multiple of the sampler
+ * period nearest to its own logging period. The countdowns of the objects
+ * already in the list are kept so they stay in phase.
+ */
+static void SamplerUpdate(void)
+{
+    static struct sampledObject previous[LOGGING_SAMPLER_MAX_OBJECTS]; // off the event dispatcher stack
+    uint8_t previousCount = sampledCount;
+
+    memcpy(previous, sampled, sizeof(previous));
+    sampledCount = 0;
+    if (samplerPeriod) {
+        UAVObjIterate(&SamplerAddObject);
+    }
+
+    for (uint8_t i = 0; i < sampledCount; i++) {
+        for (uint8_t j = 0; j < previousCount; j++) {
+            if (previous[j].obj == sampled[i].obj) {
+                sampled[i].countdown = MIN(previous[j].countdown, sampled[i].decimation);
+                break;
+            }
+        }
+    }
+
+    if (samplerOverflow) {
+        samplerOverflow = false;
+        PIOS_DEBUGLOG_Printf("Logging sampler full, objects past %d are not logged.", LOGGING_SAMPLER_MAX_OBJECTS);
+    }
+}
+
+static void SamplerAddObject(UAVObjHandle obj)
+{
+    UAVObjMetadata metadata;
+
+    if (UAVObjIsMetaobject(obj) || UAVObjGetMetadata(obj, &metadata) != 0) {
+        return;
+    }
+    if (UAVObjGetLoggingUpdateMode(&metadata) != UPDATEMODE_PERIODIC || metadata.loggingUpdatePeriod == 0) {
+        return;
+    }
+    if (sampledCount >= LOGGING_SAMPLER_MAX_OBJECTS) {
+        samplerOverflow = true;
+        return;
+    }
+
+    struct sampledObject *s = &sampled[sampledCount++];
+    s->obj = obj;
+    s->decimation = MAX(1, (metadata.loggingUpdatePeriod + samplerPeriod / 2) / samplerPeriod);
+    s->countdown  = 1;
+}
+
+/**
+ * On every sampler tick record the objects that are due, all of them together
+ */
+static void SamplerCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    UAVObjHandle due[LOGGING_SAMPLER_MAX_OBJECTS];
+    uint8_t dueCount = 0;
+
+    for (uint8_t i = 0; i < sampledCount; i++) {
+        if (--sampled[i].countdown == 0) {
+            sampled[i].countdown = sampled[i].decimation;
+            due[dueCount++] = sampled[i].obj;
+        }
+    }
+    if (dueCount) {
+        UAVObjWriteSampleToLog(due, dueCount);
+    }
+}
 
 /**
  * @}
@@ -163,6 +163,10 @@ static void systemTask(__attribute__((unused)) void *parameters)
             oplinkStatus.Timeouts    = radio_stats.timeouts;
             oplinkStatus.RSSI        = radio_stats.rssi;
             oplinkStatus.LinkQuality = radio_stats.link_quality;
+            oplinkStatus.AirDataRate = radio_stats.datarate;
+            oplinkStatus.PPMInterval    = radio_stats.ppm_interval;
+            oplinkStatus.PPMIntervalMax = radio_stats.ppm_interval_max;
+            oplinkStatus.PPMLatency     = radio_stats.ppm_latency;
             if (first_time) {
                 first_time = false;
             } else {
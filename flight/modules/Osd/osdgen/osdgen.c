@@ -75,9 +75,34 @@ extern uint8_t *disp_buffer_mask;
 
 TTime timex;
 
+/*
+ * Rows drawn in each of the two buffers, so that clearing a buffer for the
+ * next frame only touches the rows its previous frame actually used.
+ * Buffer 0 is always below buffer 1 in memory, whichever is being drawn.
+ */
+static uint32_t dirty_rows[2][(GRAPHICS_HEIGHT_REAL + 31) / 32];
+#define DRAW_DIRTY_ROWS() dirty_rows[draw_buffer_level < disp_buffer_level ? 0 : 1]
+#define ROW_DIRTY(dirty, y) ((dirty)[(y) >> 5] & (1UL << ((y) & 31)))
+
 // ****************
 // Private functions
 
+/**
+ * mark_dirty: Note the rows written in the draw buffer.
+ *
+ * @param       y0              first row
+ * @param       y1              last row (inclusive)
+ */
+static inline void mark_dirty(unsigned int y0, unsigned int y1)
+{
+    uint32_t *dirty = DRAW_DIRTY_ROWS();
+
+    y1 = MIN(y1, GRAPHICS_HEIGHT_REAL - 1);
+    for (unsigned int y = y0; y <= y1; y++) {
+        dirty[y >> 5] |= 1UL << (y & 31);
+    }
+}
+
 static void osdgenTask(void *parameters);
 
 // ****************
@@ -126,10 +151,44 @@ uint16_t mirror(uint16_t source)
     return result;
 }
 
+/**
+ * clearGraphics: Clear the rows the draw buffer was last drawn in, the
+ * others are still clear. Consecutive rows are cleared at once.
+ */
 void clearGraphics()
 {
-    memset((uint8_t *)draw_buffer_mask, 0, GRAPHICS_WIDTH * GRAPHICS_HEIGHT);
-    memset((uint8_t *)draw_buffer_level, 0, GRAPHICS_WIDTH * GRAPHICS_HEIGHT);
+    uint32_t *dirty = DRAW_DIRTY_ROWS();
+    unsigned int y  = 0;
+
+    while (y < GRAPHICS_HEIGHT_REAL) {
+        if (!ROW_DIRTY(dirty, y)) {
+            y++;
+            continue;
+        }
+        unsigned int first = y;
+        while (y < GRAPHICS_HEIGHT_REAL && ROW_DIRTY(dirty, y)) {
+            y++;
+        }
+        memset((uint8_t *)&draw_buffer_mask[first * GRAPHICS_WIDTH], 0, (y - first) * GRAPHICS_WIDTH);
+        memset((uint8_t *)&draw_buffer_level[first * GRAPHICS_WIDTH], 0, (y - first) * GRAPHICS_WIDTH);
+    }
+    memset(dirty, 0, sizeof(dirty_rows[0]));
+}
+
+/**
+ * clearRightEdge: Clear the last word of the drawn rows, the SPI keeps
+ * clocking it out otherwise. The rows not drawn are clear already.
+ */
+static void clearRightEdge()
+{
+    uint32_t *dirty = DRAW_DIRTY_ROWS();
+
+    for (unsigned int y = 0; y < GRAPHICS_HEIGHT_REAL; y++) {
+        if (ROW_DIRTY(dirty, y)) {
+            draw_buffer_mask[(y + 1) * GRAPHICS_WIDTH - 1]  = 0;
+            draw_buffer_level[(y + 1) * GRAPHICS_WIDTH - 1] = 0;
+        }
+    }
 }
 
 void copyimage(uint16_t offsetx, uint16_t offsety, int image)
@@ -141,6 +200,7 @@ void copyimage(uint16_t offsetx, uint16_t offsety, int image)
     struct splashEntry splash_info;
     splash_info = splash[image];
     offsetx     = offsetx / 8;
+    mark_dirty(offsety, offsety + splash_info.height - 1);
     for (uint16_t y = offsety; y < ((splash_info.height) + offsety); y++) {
         uint16_t x1 = offsetx;
         for (uint16_t x = offsetx; x < (((splash_info.width) / 16) + offsetx); x++) {
@@ -348,6 +408,7 @@ void drawBox(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
 void write_pixel(uint8_t *buff, unsigned int x, unsigned int y, int mode)
 {
     CHECK_COORDS(x, y);
+    mark_dirty(y, y);
     // Determine the bit in the word to be set and the word
     // index to set it in.
     int bitnum    = CALC_BIT_IN_WORD(x);
@@ -369,6 +430,7 @@ void write_pixel(uint8_t *buff, unsigned int x, unsigned int y, int mode)
 void write_pixel_lm(unsigned int x, unsigned int y, int mmode, int lmode)
 {
     CHECK_COORDS(x, y);
+    mark_dirty(y, y);
     // Determine the bit in the word to be set and the word
     // index to set it in.
     int bitnum    = CALC_BIT_IN_WORD(x);
@@ -398,6 +460,7 @@ void write_hline(uint8_t *buff, unsigned int x0, unsigned int x1, unsigned int y
     if (x0 == x1) {
         return;
     }
+    mark_dirty(y, y);
     /* This is an optimised algorithm for writing horizontal lines.
     * We begin by finding the addresses of the x0 and x1 points. */
     int addr0     = CALC_BUFF_ADDR(x0, y);
@@ -491,6 +554,7 @@ void write_vline(uint8_t *buff, unsigned int x, unsigned int y0, unsigned int y1
     if (y0 == y1) {
         return;
     }
+    mark_dirty(y0, y1);
     /* This is an optimised algorithm for writing vertical lines.
      * We begin by finding the addresses of the x,y0 and x,y1 points. */
     unsigned int addr0  = CALC_BUFF_ADDR(x, y0);
@@ -575,6 +639,7 @@ void write_filled_rectangle(uint8_t *buff, unsigned int x, unsigned int y, unsig
     if (width <= 0 || height <= 0) {
         return;
     }
+    mark_dirty(y, y + height - 1);
     // Calculate as if the rectangle was only a horizontal line. We then
     // step these addresses through each row until we iterate `height` times.
     unsigned int addr0     = CALC_BUFF_ADDR(x, y);
@@ -957,6 +1022,8 @@ void write_word_misaligned(uint8_t *buff, uint16_t word, unsigned int addr, unsi
     int16_t firstmask = word >> xoff;
     int16_t lastmask  = word << (16 - xoff);
 
+    mark_dirty(addr / GRAPHICS_WIDTH, addr / GRAPHICS_WIDTH);
+
     WRITE_WORD_MODE(buff, addr + 1, firstmask && 0x00ff, mode);
     WRITE_WORD_MODE(buff, addr, (firstmask & 0xff00) >> 8, mode);
     if (xoff > 0) {
@@ -984,6 +1051,8 @@ void write_word_misaligned_NAND(uint8_t *buff, uint16_t word, unsigned int addr,
     uint16_t firstmask = word >> xoff;
     uint16_t lastmask  = word << (16 - xoff);
 
+    mark_dirty(addr / GRAPHICS_WIDTH, addr / GRAPHICS_WIDTH);
+
     WRITE_WORD_NAND(buff, addr + 1, firstmask & 0x00ff);
     WRITE_WORD_NAND(buff, addr, (firstmask & 0xff00) >> 8);
     if (xoff > 0) {
@@ -1011,6 +1080,8 @@ void write_word_misaligned_OR(uint8_t *buff, uint16_t word, unsigned int addr, u
     uint16_t firstmask = word >> xoff;
     uint16_t lastmask  = word << (16 - xoff);
 
+    mark_dirty(addr / GRAPHICS_WIDTH, addr / GRAPHICS_WIDTH);
+
     WRITE_WORD_OR(buff, addr + 1, firstmask & 0x00ff);
     WRITE_WORD_OR(buff, addr, (firstmask & 0xff00) >> 8);
     if (xoff > 0) {
@@ -1036,6 +1107,31 @@ void write_word_misaligned_lm(uint16_t wordl, uint16_t wordm, unsigned int addr,
     write_word_misaligned(draw_buffer_mask, wordm, addr, xoff, mmode);
 }
 
+/**
+ * write_glyph_row: Write a row of a character, up to 16 pixels wide, in both
+ * level and mask buffers. The row is shifted once into a word and the up
+ * to three bytes it spans are written in a single pass.
+ *
+ * @param       mask    mask bits of the row, left aligned
+ * @param       white   level bits to set, left aligned, the others within
+ *                      the mask are cleared
+ * @param       addr    address of first byte
+ * @param       xoff    x offset (0-7)
+ */
+static inline void write_glyph_row(uint16_t mask, uint16_t white, unsigned int addr, unsigned int xoff)
+{
+    uint32_t m = (uint32_t)mask << (16 - xoff);
+    uint32_t w = (uint32_t)(white & mask) << (16 - xoff);
+
+    for (unsigned int i = 0; i < 3; i++, m <<= 8, w <<= 8) {
+        uint8_t mb = m >> 24;
+        if (mb) {
+            draw_buffer_mask[addr + i] |= mb;
+            draw_buffer_level[addr + i] = (draw_buffer_level[addr + i] & ~mb) | (w >> 24);
+        }
+    }
+}
+
 /**
  * fetch_font_info: Fetch font info structs.
  *
@@ -1073,8 +1169,8 @@ int fetch_font_info(uint8_t ch, int font, struct FontEntry *font_info, char *loo
  */
 void write_char16(char ch, unsigned int x, unsigned int y, int font)
 {
-    unsigned int yy, addr_temp, row, row_temp, xshift;
-    uint16_t and_mask, or_mask, levels;
+    unsigned int yy, row, xshift;
+    uint16_t mask, white;
     struct FontEntry font_info;
 
     // char lookup = 0;
@@ -1093,44 +1189,20 @@ void write_char16(char ch, unsigned int x, unsigned int y, int font)
             return;
         }
         // Load data pointer.
-        row       = ch * font_info.height;
-        row_temp  = row;
-        addr_temp = addr;
-        xshift    = 16 - font_info.width;
-        // We can write mask words easily.
+        row    = ch * font_info.height;
+        xshift = 16 - font_info.width;
+        mark_dirty(y, y + font_info.height - 1);
+        // Level bits are set or cleared only where the mask bit is set,
+        // otherwise we leave them alone.
         for (yy = y; yy < y + font_info.height; yy++) {
             if (font == 3) {
-                write_word_misaligned_OR(draw_buffer_mask, font_mask12x18[row] << xshift, addr, wbit);
+                mask  = font_mask12x18[row] << xshift;
+                white = font_frame12x18[row] << xshift;
             } else {
-                write_word_misaligned_OR(draw_buffer_mask, font_mask8x10[row] << xshift, addr, wbit);
+                mask  = font_mask8x10[row] << xshift;
+                white = font_frame8x10[row] << xshift;
             }
-            addr += GRAPHICS_WIDTH_REAL / 8;
-            row++;
-        }
-        // Level bits are more complicated. We need to set or clear
-        // level bits, but only where the mask bit is set; otherwise,
-        // we need to leave them alone. To do this, for each word, we
-        // construct an AND mask and an OR mask, and apply each individually.
-        row  = row_temp;
-        addr = addr_temp;
-        for (yy = y; yy < y + font_info.height; yy++) {
-            if (font == 3) {
-                levels   = font_frame12x18[row];
-                // if(!(flags & FONT_INVERT)) // data is normally inverted
-                levels   = ~levels;
-                or_mask  = font_mask12x18[row] << xshift;
-                and_mask = (font_mask12x18[row] & levels) << xshift;
-            } else {
-                levels   = font_frame8x10[row];
-                // if(!(flags & FONT_INVERT)) // data is normally inverted
-                levels   = ~levels;
-                or_mask  = font_mask8x10[row] << xshift;
-                and_mask = (font_mask8x10[row] & levels) << xshift;
-            }
-            write_word_misaligned_OR(draw_buffer_level, or_mask, addr, wbit);
-            // If we're not bold write the AND mask.
-            // if(!(flags & FONT_BOLD))
-            write_word_misaligned_NAND(draw_buffer_level, and_mask, addr, wbit);
+            write_glyph_row(mask, white, addr, wbit);
             addr += GRAPHICS_WIDTH_REAL / 8;
             row++;
         }
@@ -1150,8 +1222,8 @@ void write_char16(char ch, unsigned int x, unsigned int y, int font)
  */
 void write_char(char ch, unsigned int x, unsigned int y, int flags, int font)
 {
-    unsigned int yy, addr_temp, row, row_temp, xshift;
-    uint16_t and_mask, or_mask, levels;
+    unsigned int yy, row, xshift;
+    uint16_t white;
     struct FontEntry font_info;
     char lookup = 0;
 
@@ -1174,34 +1246,17 @@ void write_char(char ch, unsigned int x, unsigned int y, int flags, int font)
             return;
         }
         // Load data pointer.
-        row       = lookup * font_info.height * 2;
-        row_temp  = row;
-        addr_temp = addr;
-        xshift    = 16 - font_info.width;
-        // We can write mask words easily.
+        row    = lookup * font_info.height * 2;
+        xshift = 16 - font_info.width;
+        mark_dirty(y, y + font_info.height - 1);
+        // Level bits are set or cleared only where the mask bit is set,
+        // otherwise we leave them alone.
         for (yy = y; yy < y + font_info.height; yy++) {
-            write_word_misaligned_OR(draw_buffer_mask, font_info.data[row] << xshift, addr, wbit);
-            addr += GRAPHICS_WIDTH_REAL / 8;
-            row++;
-        }
-        // Level bits are more complicated. We need to set or clear
-        // level bits, but only where the mask bit is set; otherwise,
-        // we need to leave them alone. To do this, for each word, we
-        // construct an AND mask and an OR mask, and apply each individually.
-        row  = row_temp;
-        addr = addr_temp;
-        for (yy = y; yy < y + font_info.height; yy++) {
-            levels = font_info.data[row + font_info.height];
-            if (!(flags & FONT_INVERT)) {
-                // data is normally inverted
-                levels = ~levels;
+            white = font_info.data[row + font_info.height];
+            if (flags & FONT_INVERT) {
+                white = ~white;
             }
-            or_mask  = font_info.data[row] << xshift;
-            and_mask = (font_info.data[row] & levels) << xshift;
-            write_word_misaligned_OR(draw_buffer_level, or_mask, addr, wbit);
-            // If we're not bold write the AND mask.
-            // if(!(flags & FONT_BOLD))
-            write_word_misaligned_NAND(draw_buffer_level, and_mask, addr, wbit);
+            write_glyph_row(font_info.data[row] << xshift, white << xshift, addr, wbit);
             addr += GRAPHICS_WIDTH_REAL / 8;
             row++;
         }
@@ -2025,10 +2080,7 @@ void introGraphics()
     drawBox(APPLY_HDEADBAND(0), APPLY_VDEADBAND(0), APPLY_HDEADBAND(GRAPHICS_RIGHT - 8), APPLY_VDEADBAND(GRAPHICS_BOTTOM));
 
     // Must mask out last half-word because SPI keeps clocking it out otherwise
-    for (uint32_t i = 0; i < 8; i++) {
-        write_vline(draw_buffer_level, GRAPHICS_WIDTH_REAL - i - 1, 0, GRAPHICS_HEIGHT_REAL - 1, 0);
-        write_vline(draw_buffer_mask, GRAPHICS_WIDTH_REAL - i - 1, 0, GRAPHICS_HEIGHT_REAL - 1, 0);
-    }
+    clearRightEdge();
 }
 
 void calcHomeArrow(int16_t m_yaw)
@@ -2381,10 +2433,7 @@ void updateGraphics()
     }
 
     // Must mask out last half-word because SPI keeps clocking it out otherwise
-    for (uint32_t i = 0; i < 8; i++) {
-        write_vline(draw_buffer_level, GRAPHICS_WIDTH_REAL - i - 1, 0, GRAPHICS_HEIGHT_REAL - 1, 0);
-        write_vline(draw_buffer_mask, GRAPHICS_WIDTH_REAL - i - 1, 0, GRAPHICS_HEIGHT_REAL - 1, 0);
-    }
+    clearRightEdge();
 }
 
 void updateOnceEveryFrame()
@@ -2463,6 +2512,7 @@ static void osdgenTask(__attribute__((unused)) void *parameters)
 #endif
             clearGraphics();
             introGraphics();
+            PIOS_Video_FrameDone();
         }
     }
     for (int i = 0; i < 63; i++) {
@@ -2473,6 +2523,7 @@ static void osdgenTask(__attribute__((unused)) void *parameters)
             clearGraphics();
             introGraphics();
             introText();
+            PIOS_Video_FrameDone();
         }
     }
 
@@ -2482,6 +2533,7 @@ static void osdgenTask(__attribute__((unused)) void *parameters)
             PIOS_WDG_UpdateFlag(PIOS_WDG_OSDGEN);
 #endif
             updateOnceEveryFrame();
+            PIOS_Video_FrameDone();
         }
         // xSemaphoreTake(osdSemaphore, portMAX_DELAY);
         // vTaskDelayUntil(&lastSysTime, 10 / portTICK_RATE_MS);
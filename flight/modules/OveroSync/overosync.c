@@ -34,7 +34,9 @@
 
 #include "overosync.h"
 
+#include "flightstatus.h"
 #include "hwsettings.h"
+#include "overosyncsettings.h"
 #include "overosyncstats.h"
 #include "systemstats.h"
 #include "taskinfo.h"
@@ -43,6 +45,10 @@
 #define MAX_QUEUE_SIZE   200
 #define STACK_SIZE_BYTES 512
 #define TASK_PRIORITY    (tskIDLE_PRIORITY + 0)
+// the companion's objects are looked for this often while nothing is sent
+#define RX_POLL_MS       10
+#define RX_BUFFER_LENGTH 128
+#define STATS_PERIOD_MS  1000
 
 // Private types
 
@@ -51,11 +57,17 @@ static xQueueHandle queue;
 static UAVTalkConnection uavTalkCon;
 static xTaskHandle overoSyncTaskHandle;
 static bool overoEnabled;
+static OveroSyncSettingsData settings;
 
 // Private functions
 static void overoSyncTask(void *parameters);
 static int32_t packData(uint8_t *data, int32_t length);
 static void registerObject(UAVObjHandle obj);
+static void settingsUpdatedCb(UAVObjEvent *ev);
+static bool streaming(void);
+static bool included(const UAVObjEvent *ev);
+static void receiveData(void);
+static void updateStats(portTickType elapsed);
 
 // External variables
 extern uint32_t pios_com_overo_id;
@@ -66,6 +78,7 @@ struct overosync {
     uint32_t sent_objects;
     uint32_t failed_objects;
     uint32_t received_objects;
+    uint32_t frames;
 };
 
 struct overosync *overosync;
@@ -98,6 +111,10 @@ int32_t OveroSyncInitialize(void)
 
 
     OveroSyncStatsInitialize();
+    OveroSyncSettingsInitialize();
+    FlightStatusInitialize();
+    OveroSyncSettingsConnectCallback(&settingsUpdatedCb);
+    settingsUpdatedCb(NULL);
 
 
     // Initialise UAVTalk
@@ -123,7 +140,7 @@ int32_t OveroSyncStart(void)
         return -1;
     }
 
-    overosync->sent_bytes = 0;
+    memset(overosync, 0, sizeof(*overosync));
 
     // Process all registered objects and connect queue for updates
     UAVObjIterate(&registerObject);
@@ -151,56 +168,152 @@ static void registerObject(UAVObjHandle obj)
     if (UAVObjIsMetaobject(obj)) {
         eventMask |= EV_UNPACKED; // we also need to act on remote updates (unpack events)
     }
-    UAVObjConnectQueue(obj, queue, eventMask);
+    // an object updated faster than the frames go out is sent once per frame, with its latest data
+    UAVObjConnectQueueCoalesced(obj, queue, eventMask);
+}
+
+static void settingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    OveroSyncSettingsGet(&settings);
+}
+
+/**
+ * Whether the companion gets the updates now, by LogOn
+ */
+static bool streaming(void)
+{
+    uint8_t armed;
+
+    switch (settings.LogOn) {
+    case OVEROSYNCSETTINGS_LOGON_ALWAYS:
+        return true;
+
+    case OVEROSYNCSETTINGS_LOGON_ARMED:
+        FlightStatusArmedGet(&armed);
+        return armed == FLIGHTSTATUS_ARMED_ARMED;
+
+    default:
+        return false;
+    }
+}
+
+/**
+ * Whether an update passes the object filter. The metaobjects and the explicit
+ * updates and requests always do.
+ */
+static bool included(const UAVObjEvent *ev)
+{
+    UAVObjMetadata metadata;
+
+    if (settings.Objects == OVEROSYNCSETTINGS_OBJECTS_ALL || UAVObjIsMetaobject(ev->obj) || ev->event != EV_UPDATED) {
+        return true;
+    }
+
+    UAVObjGetMetadata(ev->obj, &metadata);
+    if (settings.Objects == OVEROSYNCSETTINGS_OBJECTS_TELEMETRY) {
+        return UAVObjGetTelemetryUpdateMode(&metadata) != UPDATEMODE_MANUAL;
+    }
+    return UAVObjGetLoggingUpdateMode(&metadata) != UPDATEMODE_MANUAL;
 }
 
 /**
  * Telemetry transmit task, regular priority
  *
- * Logic: We need to double buffer the DMA transfers.  Pack the buffer until either
- * 1) it is full (and then we should record the number of missed events then)
- * 2) the current transaction is done (we should immediately schedule since we are slave)
- * when done packing the buffer we should call PIOS_SPI_TransferBlock, change the active buffer
- * and then take the semaphrore
+ * The SPI transfers are double buffered by the driver, this task packs the
+ * updates waiting in the queue into batched frames: everything queued goes out
+ * in as few frames as fit, then the task waits for the rest of the period while
+ * the updates coalesce in the queue. The companion's objects are received here
+ * too, it may set OveroSyncSettings to negotiate the period and the filter.
  */
 static void overoSyncTask(__attribute__((unused)) void *parameters)
 {
     UAVObjEvent ev;
 
-    // Kick off SPI transfers (once one is completed another will automatically transmit)
-    overosync->sent_objects     = 0;
-    overosync->failed_objects   = 0;
-    overosync->received_objects = 0;
-
     portTickType lastUpdateTime = xTaskGetTickCount();
+    portTickType frameTime;
     portTickType updateTime;
 
     // Loop forever
     while (1) {
-        // Wait for queue message
-        if (xQueueReceive(queue, &ev, portMAX_DELAY) == pdTRUE) {
-            // Process event.  This calls transmitData
-            UAVTalkSendObjectTimestamped(uavTalkCon, ev.obj, ev.instId, false, 0);
-
-            updateTime = xTaskGetTickCount();
-            if (((portTickType)(updateTime - lastUpdateTime)) > 1000) {
-                // Update stats.  This will trigger a local send event too
-                OveroSyncStatsData syncStats;
-                syncStats.Send            = overosync->sent_bytes;
-                syncStats.Connected       = syncStats.Send > 500 ? OVEROSYNCSTATS_CONNECTED_TRUE : OVEROSYNCSTATS_CONNECTED_FALSE;
-                syncStats.DroppedUpdates  = overosync->failed_objects;
-                syncStats.Packets         = PIOS_OVERO_GetPacketCount(pios_overo_id);
-                OveroSyncStatsSet(&syncStats);
-                overosync->failed_objects = 0;
-                overosync->sent_bytes     = 0;
-                lastUpdateTime            = updateTime;
+        // Wait for the first update of a frame
+        bool pending = xQueueReceive(queue, &ev, RX_POLL_MS / portTICK_RATE_MS) == pdTRUE;
+
+        frameTime = xTaskGetTickCount();
+        if (pending) {
+            bool stream = streaming();
+            while (pending) {
+                // The object updates from now on are queued again
+                UAVObjEventReceived(queue, &ev);
+                if (stream && included(&ev)) {
+                    // This calls packData once a frame is full
+                    if (UAVTalkSendObjectBatched(uavTalkCon, ev.obj, ev.instId) == 0) {
+                        overosync->sent_objects++;
+                    }
+                }
+                pending = xQueueReceive(queue, &ev, 0) == pdTRUE;
             }
+            UAVTalkFlushBatch(uavTalkCon);
+        }
+
+        receiveData();
 
-            // TODO: Check the receive buffer
+        updateTime = xTaskGetTickCount();
+        if (((portTickType)(updateTime - lastUpdateTime)) > STATS_PERIOD_MS / portTICK_RATE_MS) {
+            updateStats(updateTime - lastUpdateTime);
+            lastUpdateTime = updateTime;
+        }
+
+        // The rate the companion asked for
+        portTickType period = settings.Period / portTICK_RATE_MS;
+        portTickType spent  = xTaskGetTickCount() - frameTime;
+        if (period > spent) {
+            vTaskDelay(period - spent);
         }
     }
 }
 
+/**
+ * Process the objects the companion sent
+ */
+static void receiveData(void)
+{
+    static uint8_t serial_data[RX_BUFFER_LENGTH];
+    uint16_t bytes_to_process;
+
+    while ((bytes_to_process = PIOS_COM_ReceiveBuffer(pios_com_overo_id, serial_data, sizeof(serial_data), 0)) > 0) {
+        UAVTalkProcessInputStreamBuffer(uavTalkCon, serial_data, bytes_to_process);
+    }
+}
+
+/**
+ * Throughput and drops over the last period, in per second rates.
+ * This will trigger a local send event too.
+ */
+static void updateStats(portTickType elapsed)
+{
+    OveroSyncStatsData syncStats;
+    UAVTalkStats talkStats;
+    uint32_t ms = elapsed * portTICK_RATE_MS;
+
+    UAVTalkGetStats(uavTalkCon, &talkStats, true);
+
+    syncStats.Send            = overosync->sent_bytes * 1000 / ms;
+    syncStats.Received        = talkStats.rxBytes * 1000 / ms;
+    syncStats.Connected       = syncStats.Send > 500 ? OVEROSYNCSTATS_CONNECTED_TRUE : OVEROSYNCSTATS_CONNECTED_FALSE;
+    syncStats.FramesyncErrors = talkStats.rxSyncErrors + talkStats.rxCrcErrors;
+    syncStats.UnderrunErrors  = 0;
+    syncStats.DroppedUpdates  = overosync->failed_objects;
+    syncStats.Packets         = PIOS_OVERO_GetPacketCount(pios_overo_id);
+    syncStats.SentObjects     = overosync->sent_objects * 1000 / ms;
+    syncStats.Frames          = overosync->frames * 1000 / ms;
+    OveroSyncStatsSet(&syncStats);
+
+    overosync->failed_objects = 0;
+    overosync->sent_bytes     = 0;
+    overosync->sent_objects   = 0;
+    overosync->frames         = 0;
+}
+
 /**
  * Transmit data buffer to the modem or USB port.
  * \param[in] data Data buffer to send
@@ -215,6 +328,7 @@ static int32_t packData(uint8_t *data, int32_t length)
     }
 
     overosync->sent_bytes += length;
+    overosync->frames++;
 
     return length;
 
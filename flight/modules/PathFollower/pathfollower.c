@@ -139,6 +139,7 @@ static uint32_t updatePeriod = PF_IDLE_UPDATE_RATE_MS;
 static struct Globals global;
 static PathStatusData pathStatus;
 static PathDesiredData pathDesired;
+static struct path_segment pathSegment; // pathDesired compiled, see path_compile()
 static FixedWingPathFollowerSettingsData fixedWingPathFollowerSettings;
 static VtolPathFollowerSettingsData vtolPathFollowerSettings;
 static FlightStatusData flightStatus;
@@ -310,6 +311,7 @@ static void SettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
     pid_configure(&global.BrakePIDvel[1], vtolPathFollowerSettings.BrakeHorizontalVelPID.Kp, vtolPathFollowerSettings.BrakeHorizontalVelPID.Ki, vtolPathFollowerSettings.BrakeHorizontalVelPID.Kd, vtolPathFollowerSettings.BrakeHorizontalVelPID.ILimit);
 
     PathDesiredGet(&pathDesired);
+    path_compile(&pathDesired, &pathSegment);
 }
 
 
@@ -595,7 +597,7 @@ static float updatePathBearing()
                      positionState.Down };
     struct path_status progress;
 
-    path_progress(&pathDesired, cur, &progress);
+    path_segment_progress(&pathSegment, cur, &progress);
 
     // atan2f always returns in between + and - 180 degrees
     return RAD2DEG(atan2f(progress.path_vector[1], progress.path_vector[0]));
@@ -708,6 +710,7 @@ static void processPOI()
             pathDesired.StartingVelocity = 1.0f;
             pathDesired.EndingVelocity   = 0.0f;
             pathDesired.Mode = PATHDESIRED_MODE_FLYENDPOINT;
+            path_compile(&pathDesired, &pathSegment);
             PathDesiredSet(&pathDesired);
         }
     }
@@ -798,7 +801,7 @@ static void updatePathVelocity(float kFF, bool limited)
                          positionState.East + (velocityState.East * kFF),
                          positionState.Down + (velocityState.Down * kFF) };
         struct path_status progress;
-        path_progress(&pathDesired, cur, &progress);
+        path_segment_progress(&pathSegment, cur, &progress);
 
         // calculate velocity - can be zero if waypoints are too close
         velocityDesired.North = progress.path_vector[0];
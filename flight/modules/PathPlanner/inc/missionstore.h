@@ -1,12 +1,15 @@
 /**
  ******************************************************************************
+ * @addtogroup OpenPilotModules OpenPilot Modules
+ * @{
+ * @addtogroup PathPlanner Path Planner Module
+ * @{
+ *
+ * @file       missionstore.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Keeps the path plan in the user flash filesystem across reboots
  *
- * @file       traillineitem.h
- * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2012.
- * @brief      A graphicsItem representing a WayPoint
  * @see        The GNU Public License (GPL) Version 3
- * @defgroup   OPMapWidget
- * @{
  *
  *****************************************************************************/
 /*
@@ -24,32 +27,18 @@
  * with this program; if not, write to the Free Software Foundation, Inc.,
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
-#ifndef TAILLINEITEM_H
-#define TAILLINEITEM_H
+#ifndef MISSIONSTORE_H
+#define MISSIONSTORE_H
 
-#include <QGraphicsItem>
-#include <QPainter>
-#include <QLabel>
-#include "../internals/pointlatlng.h"
-#include <QObject>
-#include "mapgraphicitem.h"
+#include "pathplan.h"
 
-namespace mapcontrol {
-class TrailLineItem : public QObject, public QGraphicsLineItem {
-    Q_OBJECT Q_INTERFACES(QGraphicsItem)
-public:
-    enum { Type = UserType + 7 };
-    TrailLineItem(internals::PointLatLng const & coord1, internals::PointLatLng const & coord2, QBrush color, MapGraphicItem *map);
-    int type() const;
-    internals::PointLatLng coord1;
-    internals::PointLatLng coord2;
-private:
-    QBrush m_brush;
-    MapGraphicItem *m_map;
-public slots:
-    void setLineSlot();
-signals:
-};
-}
+int32_t mission_store_restore(void);
+int32_t mission_store_save(const PathPlanData *pathPlan);
+bool mission_store_holds(const PathPlanData *pathPlan);
 
-#endif // TAILLINEITEM_H
+#endif // MISSIONSTORE_H
+
+/**
+ * @}
+ * @}
+ */
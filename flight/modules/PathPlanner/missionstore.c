@@ -0,0 +1,202 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotModules OpenPilot Modules
+ * @{
+ * @addtogroup PathPlanner Path Planner Module
+ * @{
+ *
+ * @file       missionstore.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Keeps the path plan in the user flash filesystem across reboots
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "openpilot.h"
+
+#include <pios_flashfs.h>
+#include "pathplan.h"
+#include "pathaction.h"
+#include "waypoint.h"
+#include "missionstore.h"
+
+/*
+ * A validated path plan is saved packed, the Waypoint and PathAction
+ * instances back to back in chunks of a slot each: twelve waypoints or six
+ * path actions per slot, where UAVObjSave() would take a slot per instance.
+ * The PathPlan goes last, the chunks are only used if its CRC matches them.
+ *
+ * The ids are those of the objects with a tag, nothing saved by UAVObjSave()
+ * in the same filesystem (simposix has a single one) can collide with them.
+ */
+#define MISSION_OBJID(obj_id)       ((obj_id) ^ 0x4d495300)  // 'MIS'
+#define MISSION_CHUNK_SIZE          240 // a 256 bytes slot, less its header
+#define MISSION_WAYPOINTS_PER_CHUNK (MISSION_CHUNK_SIZE / WAYPOINT_NUMBYTES)
+#define MISSION_ACTIONS_PER_CHUNK   (MISSION_CHUNK_SIZE / PATHACTION_NUMBYTES)
+
+// flash filesystem for the user data, see pios_board.c
+extern uintptr_t pios_user_fs_id;
+
+// the PathPlan in flash, zero counts if none, and whether its chunks match it
+static PathPlanData storedPlan;
+static bool storedPlanValid;
+static uint8_t chunk[MISSION_CHUNK_SIZE];
+
+static int32_t saveInstances(UAVObjHandle obj_handle, uint16_t count, uint16_t storedCount, uint16_t size, uint16_t perChunk);
+static int32_t restoreInstances(UAVObjHandle obj_handle, uint16_t count, uint16_t size, uint16_t perChunk, uint8_t *crc);
+
+/**
+ * Load the stored plan into the Waypoint and PathAction instances and the
+ * PathPlan, which must be empty. Called before anyone listens to these.
+ * \return 0 if a plan was restored, -1 if there was none or it was corrupted
+ */
+int32_t mission_store_restore(void)
+{
+    PathPlanData pathPlan;
+    uint8_t crc = 0;
+
+    PathPlanGet(&pathPlan);
+    if (!pios_user_fs_id || pathPlan.WaypointCount > 0 ||
+        PIOS_FLASHFS_ObjLoad(pios_user_fs_id, MISSION_OBJID(PATHPLAN_OBJID), 0, (uint8_t *)&storedPlan, PATHPLAN_NUMBYTES) != 0) {
+        return -1;
+    }
+
+    if (restoreInstances(WaypointHandle(), storedPlan.WaypointCount, WAYPOINT_NUMBYTES, MISSION_WAYPOINTS_PER_CHUNK, &crc) != 0 ||
+        restoreInstances(PathActionHandle(), storedPlan.PathActionCount, PATHACTION_NUMBYTES, MISSION_ACTIONS_PER_CHUNK, &crc) != 0 ||
+        crc != storedPlan.Crc) {
+        // the instances keep the partial plan, but without a PathPlan to validate it
+        return -1;
+    }
+    storedPlanValid = true;
+
+    // the plan is validated by the PathPlanner as if it had just been uploaded
+    PathPlanSet(&storedPlan);
+    return 0;
+}
+
+/**
+ * Save the plan currently held by the Waypoint and PathAction instances.
+ * This writes up to a few dozen slots, call it only when nothing waits on
+ * the caller, i.e. on the ground.
+ * \param[in] pathPlan the PathPlan of the instances, already validated
+ * \return 0 on success, -1 on failure
+ */
+int32_t mission_store_save(const PathPlanData *pathPlan)
+{
+    if (!pios_user_fs_id) {
+        return -1;
+    }
+
+    // obsolete the stored plan first, an interrupted save must not leave it valid
+    if (PIOS_FLASHFS_ObjDelete(pios_user_fs_id, MISSION_OBJID(PATHPLAN_OBJID), 0) != 0) {
+        return -1;
+    }
+    storedPlanValid = false;
+
+    if (saveInstances(WaypointHandle(), pathPlan->WaypointCount, storedPlan.WaypointCount, WAYPOINT_NUMBYTES, MISSION_WAYPOINTS_PER_CHUNK) != 0 ||
+        saveInstances(PathActionHandle(), pathPlan->PathActionCount, storedPlan.PathActionCount, PATHACTION_NUMBYTES, MISSION_ACTIONS_PER_CHUNK) != 0) {
+        // chunks of either plan may be left, the cleanup of the next save takes the larger counts
+        storedPlan.WaypointCount   = MAX(storedPlan.WaypointCount, pathPlan->WaypointCount);
+        storedPlan.PathActionCount = MAX(storedPlan.PathActionCount, pathPlan->PathActionCount);
+        return -1;
+    }
+
+    storedPlan = *pathPlan;
+    if (PIOS_FLASHFS_ObjSave(pios_user_fs_id, MISSION_OBJID(PATHPLAN_OBJID), 0, (uint8_t *)pathPlan, PATHPLAN_NUMBYTES) != 0) {
+        return -1;
+    }
+    storedPlanValid = true;
+
+    return 0;
+}
+
+/**
+ * Whether this plan is the one in flash already
+ */
+bool mission_store_holds(const PathPlanData *pathPlan)
+{
+    return storedPlanValid &&
+           storedPlan.WaypointCount == pathPlan->WaypointCount &&
+           storedPlan.PathActionCount == pathPlan->PathActionCount &&
+           storedPlan.Crc == pathPlan->Crc;
+}
+
+/**
+ * Pack instances 0..count-1 of an object into chunks and save them, then
+ * drop the chunks a longer plan of storedCount instances left after them.
+ */
+static int32_t saveInstances(UAVObjHandle obj_handle, uint16_t count, uint16_t storedCount, uint16_t size, uint16_t perChunk)
+{
+    uint32_t obj_id = MISSION_OBJID(UAVObjGetID(obj_handle));
+    uint16_t chunkId;
+
+    for (chunkId = 0; chunkId * perChunk < count; chunkId++) {
+        uint16_t first = chunkId * perChunk;
+        uint16_t n     = MIN(perChunk, count - first);
+
+        for (uint16_t i = 0; i < n; i++) {
+            UAVObjGetInstanceData(obj_handle, first + i, &chunk[i * size]);
+        }
+        if (PIOS_FLASHFS_ObjSave(pios_user_fs_id, obj_id, chunkId, chunk, n * size) != 0) {
+            return -1;
+        }
+    }
+
+    for (; chunkId * perChunk < storedCount; chunkId++) {
+        if (PIOS_FLASHFS_ObjDelete(pios_user_fs_id, obj_id, chunkId) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Load the chunks of an object into instances 0..count-1, creating those
+ * missing, and update the plan CRC with them as checkPathPlan() does.
+ */
+static int32_t restoreInstances(UAVObjHandle obj_handle, uint16_t count, uint16_t size, uint16_t perChunk, uint8_t *crc)
+{
+    uint32_t obj_id = MISSION_OBJID(UAVObjGetID(obj_handle));
+
+    for (uint16_t chunkId = 0; chunkId * perChunk < count; chunkId++) {
+        uint16_t first = chunkId * perChunk;
+        uint16_t n     = MIN(perChunk, count - first);
+
+        if (PIOS_FLASHFS_ObjLoad(pios_user_fs_id, obj_id, chunkId, chunk, n * size) != 0) {
+            return -1;
+        }
+        for (uint16_t i = 0; i < n; i++) {
+            if (first + i >= UAVObjGetNumInstances(obj_handle) &&
+                UAVObjCreateInstance(obj_handle, NULL) != first + i) {
+                // out of memory
+                return -1;
+            }
+            UAVObjSetInstanceData(obj_handle, first + i, &chunk[i * size]);
+            *crc = PIOS_CRC_updateCRC(*crc, &chunk[i * size], size);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @}
+ * @}
+ */
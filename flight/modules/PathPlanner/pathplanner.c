@@ -45,6 +45,7 @@
 #include "flightmodesettings.h"
 #include "paths.h"
 #include "plans.h"
+#include "missionstore.h"
 
 // Private constants
 #define STACK_SIZE_BYTES            1024
@@ -57,9 +58,11 @@
 // Private functions
 static void pathPlannerTask();
 static void commandUpdated(UAVObjEvent *ev);
+static void planUpdated(UAVObjEvent *ev);
 static void statusUpdated(UAVObjEvent *ev);
 static void updatePathDesired();
 static void setWaypoint(uint16_t num);
+static void loadWaypoints();
 
 static uint8_t checkPathPlan();
 static uint8_t pathConditionCheck();
@@ -83,6 +86,16 @@ static WaypointData waypoint;
 static PathActionData pathAction;
 static bool pathplanner_active = false;
 
+// the plan is validated again, and the waypoints around the active one
+// read again, only once the plan or one of its instances changed
+static volatile bool planChanged    = true;
+static volatile bool waypointsStale = true;
+static uint8_t validPathPlan;
+static bool unsavedPathPlan;
+static uint16_t waypointsIndex;
+static WaypointData waypointPrev;
+static WaypointData waypointNext;
+
 
 /**
  * Module initialization
@@ -90,10 +103,13 @@ static bool pathplanner_active = false;
 int32_t PathPlannerStart()
 {
     plan_initialize();
+    // a plan saved by an earlier flight, unless one was uploaded already
+    mission_store_restore();
     // when the active waypoint changes, update pathDesired
-    WaypointConnectCallback(commandUpdated);
+    WaypointConnectCallback(planUpdated);
     WaypointActiveConnectCallback(commandUpdated);
-    PathActionConnectCallback(commandUpdated);
+    PathActionConnectCallback(planUpdated);
+    PathPlanConnectCallback(planUpdated);
     PathStatusConnectCallback(statusUpdated);
 
     // Start main task callback
@@ -136,12 +152,26 @@ static void pathPlannerTask()
 
     // check path plan validity early to raise alarm
     // even if not in guided mode
-    uint8_t validPathPlan = checkPathPlan();
+    if (planChanged) {
+        planChanged     = false;
+        validPathPlan   = checkPathPlan();
+        unsavedPathPlan = validPathPlan;
+    }
 
     FlightStatusData flightStatus;
     FlightStatusGet(&flightStatus);
     if (flightStatus.ControlChain.PathPlanner != FLIGHTSTATUS_CONTROLCHAIN_TRUE) {
         pathplanner_active = false;
+
+        // keep a new plan for the next flights, the flash writes would hold up the navigation callbacks in the air
+        if (unsavedPathPlan && flightStatus.Armed == FLIGHTSTATUS_ARMED_DISARMED) {
+            PathPlanData pathPlan;
+            PathPlanGet(&pathPlan);
+            if (!mission_store_holds(&pathPlan)) {
+                mission_store_save(&pathPlan);
+            }
+            unsavedPathPlan = false;
+        }
         if (!validPathPlan) {
             // unverified path plans are only a warning while we are not in pathplanner mode
             // so it does not prevent arming. However manualcontrols safety check
@@ -191,8 +221,7 @@ static void pathPlannerTask()
         return;
     }
 
-    WaypointInstGet(waypointActive.Index, &waypoint);
-    PathActionInstGet(waypoint.Action, &pathAction);
+    loadWaypoints();
     PathStatusData pathStatus;
     PathStatusGet(&pathStatus);
 
@@ -253,9 +282,8 @@ static uint8_t checkPathPlan()
     uint16_t actionCount;
     uint8_t pathCrc;
     PathPlanData pathPlan;
-
-    // WaypointData waypoint; // using global instead (?)
-    // PathActionData action; // using global instead (?)
+    WaypointData checkWaypoint;
+    PathActionData action;
 
     PathPlanGet(&pathPlan);
 
@@ -292,8 +320,8 @@ static uint8_t checkPathPlan()
 
     // waypoint consistency
     for (i = 0; i < waypointCount; i++) {
-        WaypointInstGet(i, &waypoint);
-        if (waypoint.Action >= actionCount) {
+        WaypointInstGet(i, &checkWaypoint);
+        if (checkWaypoint.Action >= actionCount) {
             // path action id is out of range
             return false;
         }
@@ -301,12 +329,12 @@ static uint8_t checkPathPlan()
 
     // path action consistency
     for (i = 0; i < actionCount; i++) {
-        PathActionInstGet(i, &pathAction);
-        if (pathAction.ErrorDestination >= waypointCount) {
+        PathActionInstGet(i, &action);
+        if (action.ErrorDestination >= waypointCount) {
             // waypoint id is out of range
             return false;
         }
-        if (pathAction.JumpDestination >= waypointCount) {
+        if (action.JumpDestination >= waypointCount) {
             // waypoint id is out of range
             return false;
         }
@@ -323,6 +351,14 @@ void commandUpdated(__attribute__((unused)) UAVObjEvent *ev)
     PIOS_CALLBACKSCHEDULER_Dispatch(pathDesiredUpdaterHandle);
 }
 
+// callback function when the plan or an instance of it changed, validate it again and update pathDesired
+void planUpdated(__attribute__((unused)) UAVObjEvent *ev)
+{
+    planChanged    = true;
+    waypointsStale = true;
+    PIOS_CALLBACKSCHEDULER_Dispatch(pathDesiredUpdaterHandle);
+}
+
 // callback function when waypoints changed in any way, update pathDesired
 void statusUpdated(__attribute__((unused)) UAVObjEvent *ev)
 {
@@ -343,8 +379,7 @@ void updatePathDesired()
     // find out current waypoint
     WaypointActiveGet(&waypointActive);
 
-    WaypointInstGet(waypointActive.Index, &waypoint);
-    PathActionInstGet(waypoint.Action, &pathAction);
+    loadWaypoints();
 
     pathDesired.End.North = waypoint.Position.North;
     pathDesired.End.East  = waypoint.Position.East;
@@ -371,9 +406,6 @@ void updatePathDesired()
         pathDesired.StartingVelocity = pathDesired.EndingVelocity;
     } else {
         // Get previous waypoint as start point
-        WaypointData waypointPrev;
-        WaypointInstGet(waypointActive.Index - 1, &waypointPrev);
-
         pathDesired.Start.North = waypointPrev.Position.North;
         pathDesired.Start.East  = waypointPrev.Position.East;
         pathDesired.Start.Down  = waypointPrev.Position.Down;
@@ -382,6 +414,28 @@ void updatePathDesired()
     PathDesiredSet(&pathDesired);
 }
 
+// helper function to read the active waypoint, its action and its neighbours, unless they are read already
+static void loadWaypoints()
+{
+    if (!waypointsStale && waypointsIndex == waypointActive.Index) {
+        return;
+    }
+    // cleared first, a change from now on is seen next time
+    waypointsStale = false;
+    waypointsIndex = waypointActive.Index;
+
+    WaypointInstGet(waypointsIndex, &waypoint);
+    PathActionInstGet(waypoint.Action, &pathAction);
+    if (waypointsIndex > 0) {
+        WaypointInstGet(waypointsIndex - 1, &waypointPrev);
+    }
+    uint16_t nextWaypointId = waypointsIndex + 1;
+    if (nextWaypointId >= UAVObjGetNumInstances(WaypointHandle())) {
+        nextWaypointId = 0;
+    }
+    WaypointInstGet(nextWaypointId, &waypointNext);
+}
+
 // helper function to go to a specific waypoint
 static void setWaypoint(uint16_t num)
 {
@@ -610,15 +664,7 @@ static uint8_t conditionAboveSpeed()
  */
 static uint8_t conditionPointingTowardsNext()
 {
-    uint16_t nextWaypointId = waypointActive.Index + 1;
-
-    if (nextWaypointId >= UAVObjGetNumInstances(WaypointHandle())) {
-        nextWaypointId = 0;
-    }
-    WaypointData nextWaypoint;
-    WaypointInstGet(nextWaypointId, &nextWaypoint);
-
-    float angle1 = atan2f((nextWaypoint.Position.North - waypoint.Position.North), (nextWaypoint.Position.East - waypoint.Position.East));
+    float angle1 = atan2f((waypointNext.Position.North - waypoint.Position.North), (waypointNext.Position.East - waypoint.Position.East));
 
     VelocityStateData velocity;
     VelocityStateGet(&velocity);
@@ -57,6 +57,7 @@
 #define EVENT_QUEUE_SIZE  10
 #define MAX_PORT_DELAY    200
 #define SERIAL_RX_BUF_LEN 100
+#define RELAY_RX_BUF_LEN  32
 #define PPM_INPUT_TIMEOUT 100
 
 
@@ -83,6 +84,10 @@ typedef struct {
     // The raw serial Rx buffer
     uint8_t  serialRxBuf[SERIAL_RX_BUF_LEN];
 
+    // The Rx buffers of the UAVTalk streams, the relayed frames are sent from them
+    uint8_t  telemetryRxBuf[RELAY_RX_BUF_LEN];
+    uint8_t  radioRxBuf[RELAY_RX_BUF_LEN];
+
     // Error statistics.
     uint32_t telemetryTxRetries;
     uint32_t radioTxRetries;
@@ -108,8 +113,9 @@ static void radioRxTask(void *parameters);
 static void PPMInputTask(void *parameters);
 static int32_t UAVTalkSendHandler(uint8_t *buf, int32_t length);
 static int32_t RadioSendHandler(uint8_t *buf, int32_t length);
-static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t rxbyte);
-static void ProcessRadioStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t rxbyte);
+static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t *buf, uint16_t length);
+static void ProcessRadioStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t *buf, uint16_t length);
+static void RelayPacket(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t *buf, int32_t frameStart, uint16_t frameEnd);
 static void objectPersistenceUpdatedCb(UAVObjEvent *objEv);
 static void registerObject(UAVObjHandle obj);
 
@@ -403,14 +409,12 @@ static void radioRxTask(__attribute__((unused)) void *parameters)
         PIOS_WDG_UpdateFlag(PIOS_WDG_RADIORX);
 #endif
         if (PIOS_COM_RADIO) {
-            uint8_t serial_data[1];
-            uint16_t bytes_to_process = PIOS_COM_ReceiveBuffer(PIOS_COM_RADIO, serial_data, sizeof(serial_data), MAX_PORT_DELAY);
+            uint8_t *serial_data = data->radioRxBuf;
+            uint16_t bytes_to_process = PIOS_COM_ReceiveBuffer(PIOS_COM_RADIO, serial_data, RELAY_RX_BUF_LEN, MAX_PORT_DELAY);
             if (bytes_to_process > 0) {
                 if (data->parseUAVTalk) {
                     // Pass the data through the UAVTalk parser.
-                    for (uint8_t i = 0; i < bytes_to_process; i++) {
-                        ProcessRadioStream(data->radioUAVTalkCon, data->telemUAVTalkCon, serial_data[i]);
-                    }
+                    ProcessRadioStream(data->radioUAVTalkCon, data->telemUAVTalkCon, serial_data, bytes_to_process);
                 } else if (PIOS_COM_TELEMETRY) {
                     // Send the data straight to the telemetry port.
                     // Following call can fail with -2 error code (buffer full) or -3 error code (could not acquire send mutex)
@@ -448,12 +452,9 @@ static void telemetryRxTask(__attribute__((unused)) void *parameters)
         }
 #endif /* PIOS_INCLUDE_USB */
         if (inputPort) {
-            uint8_t serial_data[1];
-            uint16_t bytes_to_process = PIOS_COM_ReceiveBuffer(inputPort, serial_data, sizeof(serial_data), MAX_PORT_DELAY);
+            uint16_t bytes_to_process = PIOS_COM_ReceiveBuffer(inputPort, data->telemetryRxBuf, RELAY_RX_BUF_LEN, MAX_PORT_DELAY);
             if (bytes_to_process > 0) {
-                for (uint8_t i = 0; i < bytes_to_process; i++) {
-                    ProcessTelemetryStream(data->telemUAVTalkCon, data->radioUAVTalkCon, serial_data[i]);
-                }
+                ProcessTelemetryStream(data->telemUAVTalkCon, data->radioUAVTalkCon, data->telemetryRxBuf, bytes_to_process);
             }
         } else {
             vTaskDelay(5);
@@ -591,18 +592,50 @@ static int32_t RadioSendHandler(uint8_t *buf, int32_t length)
 }
 
 /**
- * @brief Process a byte of data received on the telemetry stream
+ * @brief Relay a completed packet to the other side of the bridge.
+ *
+ * Packets that were received whole in the current buffer are forwarded from it
+ * as they are, only those spanning two reads are re-framed by UAVTalk.
+ *
+ * @param[in] inConnectionHandle  The UAVTalk connection handle the packet was received on.
+ * @param[in] outConnectionHandle  The UAVTalk connection handle the packet is sent on.
+ * @param[in] buf  The buffer being parsed.
+ * @param[in] frameStart  The position of the sync byte of the packet in buf, -1 if it was in a previous buffer.
+ * @param[in] frameEnd  The position of the checksum of the packet in buf.
+ */
+static void RelayPacket(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t *buf, int32_t frameStart, uint16_t frameEnd)
+{
+    if (frameStart >= 0) {
+        UAVTalkRelayFrame(inConnectionHandle, outConnectionHandle, &buf[frameStart], frameEnd - frameStart + 1);
+    } else {
+        UAVTalkRelayPacket(inConnectionHandle, outConnectionHandle);
+    }
+}
+
+/**
+ * @brief Process a buffer of data received on the telemetry stream
  *
  * @param[in] inConnectionHandle  The UAVTalk connection handle on the telemetry port
  * @param[in] outConnectionHandle  The UAVTalk connection handle on the radio port.
- * @param[in] rxbyte  The received byte.
+ * @param[in] buf  The received bytes.
+ * @param[in] length  The number of received bytes.
  */
-static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t rxbyte)
+static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t *buf, uint16_t length)
 {
-    // Keep reading until we receive a completed packet.
-    UAVTalkRxState state = UAVTalkProcessInputStreamQuiet(inConnectionHandle, rxbyte);
+    int32_t frameStart = -1;
+
+    for (uint16_t i = 0; i < length; i++) {
+        // Keep reading until we receive a completed packet.
+        UAVTalkRxState state = UAVTalkProcessInputStreamQuiet(inConnectionHandle, buf[i]);
+
+        if (state == UAVTALK_STATE_TYPE) {
+            // the sync byte of a new packet was just accepted
+            frameStart = i;
+        }
+        if (state != UAVTALK_STATE_COMPLETE) {
+            continue;
+        }
 
-    if (state == UAVTALK_STATE_COMPLETE) {
         // We only want to unpack certain telemetry objects
         uint32_t objId = UAVTalkGetPacketObjId(inConnectionHandle);
         switch (objId) {
@@ -627,29 +660,41 @@ static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle, UAVTalk
             // The OBJECTPERSISTENCE logic can be broken too if for example OPLM nacks and then REVO acks...
             UAVTalkReceiveObject(inConnectionHandle);
             // relay packet to remote modem
-            UAVTalkRelayPacket(inConnectionHandle, outConnectionHandle);
+            RelayPacket(inConnectionHandle, outConnectionHandle, buf, frameStart, i);
             break;
         default:
             // all other packets are relayed to the remote modem
-            UAVTalkRelayPacket(inConnectionHandle, outConnectionHandle);
+            RelayPacket(inConnectionHandle, outConnectionHandle, buf, frameStart, i);
             break;
         }
+        frameStart = -1;
     }
 }
 
 /**
- * @brief Process a byte of data received on the radio data stream.
+ * @brief Process a buffer of data received on the radio data stream.
  *
  * @param[in] inConnectionHandle  The UAVTalk connection handle on the radio port.
  * @param[in] outConnectionHandle  The UAVTalk connection handle on the telemetry port.
- * @param[in] rxbyte  The received byte.
+ * @param[in] buf  The received bytes.
+ * @param[in] length  The number of received bytes.
  */
-static void ProcessRadioStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t rxbyte)
+static void ProcessRadioStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t *buf, uint16_t length)
 {
-    // Keep reading until we receive a completed packet.
-    UAVTalkRxState state = UAVTalkProcessInputStreamQuiet(inConnectionHandle, rxbyte);
+    int32_t frameStart = -1;
+
+    for (uint16_t i = 0; i < length; i++) {
+        // Keep reading until we receive a completed packet.
+        UAVTalkRxState state = UAVTalkProcessInputStreamQuiet(inConnectionHandle, buf[i]);
+
+        if (state == UAVTALK_STATE_TYPE) {
+            // the sync byte of a new packet was just accepted
+            frameStart = i;
+        }
+        if (state != UAVTALK_STATE_COMPLETE) {
+            continue;
+        }
 
-    if (state == UAVTALK_STATE_COMPLETE) {
         // We only want to unpack certain objects from the remote modem
         // Similarly we only want to relay certain objects to the telemetry port
         uint32_t objId = UAVTalkGetPacketObjId(inConnectionHandle);
@@ -673,9 +718,10 @@ static void ProcessRadioStream(UAVTalkConnection inConnectionHandle, UAVTalkConn
             break;
         default:
             // all other packets are relayed to the telemetry port
-            UAVTalkRelayPacket(inConnectionHandle, outConnectionHandle);
+            RelayPacket(inConnectionHandle, outConnectionHandle, buf, frameStart, i);
             break;
         }
+        frameStart = -1;
     }
 }
 
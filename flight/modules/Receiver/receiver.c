@@ -41,6 +41,9 @@
 #include <flighttelemetrystats.h>
 #ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
 #include <stabilizationsettings.h>
+#include <stabilizationdesired.h>
+#include <actuatorcommand.h>
+#include <receiverstatus.h>
 #endif
 #include <flightmodesettings.h>
 #include <systemsettings.h>
@@ -67,11 +70,50 @@
 
 #define ASSISTEDCONTROL_DEADBAND_MINIMUM 0.02f // minimum value for a well bahaved Tx.
 
+// channels read at once from the receiver of the throttle, as many as S.Bus has
+#define FRAME_CHANNELS                   18
+#define STATUS_PERIOD_MS                 1000
+
 // Private types
 
+// affine scaling of a channel to -1..+1, with different slopes each side of neutral
+struct channel_scale {
+    int16_t neutral;
+    float   above;
+    float   below;
+};
+
+#ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
+struct latency_stats {
+    uint32_t sum;
+    uint16_t count;
+    uint16_t min;
+    uint16_t max;
+};
+
+// a frame travels from the command to the stabilization to the actuators
+enum frame_stage {
+    FRAME_IDLE,
+    FRAME_COMMANDED,
+    FRAME_STABILIZED,
+};
+#endif
+
 // Private variables
 static xTaskHandle taskHandle;
 static portTickType lastSysTime;
+static int32_t frameChannels[FRAME_CHANNELS];
+static struct channel_scale channelScale[MANUALCONTROLSETTINGS_CHANNELGROUPS_NUMELEM];
+static volatile bool settingsUpdated = true;
+
+#ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
+static struct latency_stats commandLatency;
+static struct latency_stats actuatorLatency;
+static volatile enum frame_stage frameStage;
+static volatile uint32_t frameTime;
+static volatile uint32_t frameActuatorLatency;
+static volatile bool frameActuated;
+#endif
 
 #ifdef USE_INPUT_LPF
 static portTickType lastSysTimeLPF;
@@ -80,10 +122,17 @@ static float inputFiltered[MANUALCONTROLSETTINGS_RESPONSETIME_NUMELEM];
 
 // Private functions
 static void receiverTask(void *parameters);
-static float scaleChannel(int16_t value, int16_t max, int16_t min, int16_t neutral);
+static void settingsUpdatedCb(UAVObjEvent *ev);
+static void updateChannelScales(ManualControlSettingsData *settings);
 static uint32_t timeDifferenceMs(portTickType start_time, portTickType end_time);
 static bool validInputRange(int16_t min, int16_t max, uint16_t value);
 static void applyDeadband(float *value, float deadband);
+#ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
+static void stabilizationDesiredUpdatedCb(UAVObjEvent *ev);
+static void actuatorCommandUpdatedCb(UAVObjEvent *ev);
+static void addLatency(struct latency_stats *stats, uint32_t latency);
+static void publishLatency(struct latency_stats *stats, uint16_t *minAvgMax);
+#endif
 
 #ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
 static uint8_t isAssistedFlightMode(uint8_t position);
@@ -139,8 +188,14 @@ int32_t ReceiverInitialize()
     ManualControlCommandInitialize();
     ReceiverActivityInitialize();
     ManualControlSettingsInitialize();
+    ManualControlSettingsConnectCallback(settingsUpdatedCb);
 #ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
     StabilizationSettingsInitialize();
+    ReceiverStatusInitialize();
+    StabilizationDesiredInitialize();
+    ActuatorCommandInitialize();
+    StabilizationDesiredConnectCallback(stabilizationDesiredUpdatedCb);
+    ActuatorCommandConnectCallback(actuatorCommandUpdatedCb);
 #endif
 
 
@@ -179,18 +234,47 @@ static void receiverTask(__attribute__((unused)) void *parameters)
 
     float scaledChannel[MANUALCONTROLSETTINGS_CHANNELGROUPS_NUMELEM] = { 0 };
     SystemSettingsThrustControlOptions thrustType;
+    xSemaphoreHandle frameSemaphore = NULL;
+    uint32_t lastFrameTime = 0;
+
+#ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
+    portTickType lastStatusTime = lastSysTime;
+    uint16_t frameCount = 0;
+#endif
 
     while (1) {
-        // Wait until next update
-        vTaskDelayUntil(&lastSysTime, UPDATE_PERIOD_MS / portTICK_RATE_MS);
+        // Wait for the next frame of the receiver, or until the next update if it does not signal
+        // its frames. A receiver that stopped sending still gets an update per period, for failsafe.
+        if (frameSemaphore) {
+            xSemaphoreTake(frameSemaphore, UPDATE_PERIOD_MS / portTICK_RATE_MS);
+            lastSysTime = xTaskGetTickCount();
+        } else {
+            vTaskDelayUntil(&lastSysTime, UPDATE_PERIOD_MS / portTICK_RATE_MS);
+        }
 #ifdef PIOS_INCLUDE_WDG
         PIOS_WDG_UpdateFlag(PIOS_WDG_MANUAL);
 #endif
 
-        // Read settings
-        ManualControlSettingsGet(&settings);
+        // Read settings, the channel scales only change with them
+        if (settingsUpdated) {
+            settingsUpdated = false;
+            ManualControlSettingsGet(&settings);
+            updateChannelScales(&settings);
+        }
         SystemSettingsThrustControlGet(&thrustType);
 
+        // The receiver of the throttle paces the updates
+        extern uint32_t pios_rcvr_group_map[];
+        uint32_t frameRcvr = 0;
+        if (settings.ChannelGroups.Throttle < MANUALCONTROLSETTINGS_CHANNELGROUPS_NONE) {
+            frameRcvr = pios_rcvr_group_map[settings.ChannelGroups.Throttle];
+        }
+        frameSemaphore = PIOS_RCVR_GetSemaphore(frameRcvr, 1);
+
+        uint32_t thisFrameTime = 0;
+        bool newFrame = PIOS_RCVR_GetFrameTime(frameRcvr, &thisFrameTime) && thisFrameTime != lastFrameTime;
+        lastFrameTime = thisFrameTime;
+
         /* Update channel activity monitor */
         if (flightStatus.Armed == FLIGHTSTATUS_ARMED_DISARMED) {
             if (updateRcvrActivity(&activity_fsm)) {
@@ -219,28 +303,34 @@ static void receiverTask(__attribute__((unused)) void *parameters)
 
         bool valid_input_detected = true;
 
+        // Read the receiver of the throttle at once, so that the sticks come from the same frame
+        PIOS_RCVR_ReadAll(frameRcvr, frameChannels, FRAME_CHANNELS);
+
         // Read channel values in us
         for (uint8_t n = 0; n < MANUALCONTROLSETTINGS_CHANNELGROUPS_NUMELEM && n < MANUALCONTROLCOMMAND_CHANNEL_NUMELEM; ++n) {
-            extern uint32_t pios_rcvr_group_map[];
+            uint8_t group  = ManualControlSettingsChannelGroupsToArray(settings.ChannelGroups)[n];
+            uint8_t number = ManualControlSettingsChannelNumberToArray(settings.ChannelNumber)[n];
 
-            if (ManualControlSettingsChannelGroupsToArray(settings.ChannelGroups)[n] >= MANUALCONTROLSETTINGS_CHANNELGROUPS_NONE) {
+            if (group >= MANUALCONTROLSETTINGS_CHANNELGROUPS_NONE) {
                 cmd.Channel[n] = PIOS_RCVR_INVALID;
+            } else if (group == settings.ChannelGroups.Throttle && number >= 1 && number <= FRAME_CHANNELS) {
+                cmd.Channel[n] = frameChannels[number - 1];
             } else {
-                cmd.Channel[n] = PIOS_RCVR_Read(pios_rcvr_group_map[
-                                                    ManualControlSettingsChannelGroupsToArray(settings.ChannelGroups)[n]],
-                                                ManualControlSettingsChannelNumberToArray(settings.ChannelNumber)[n]);
+                cmd.Channel[n] = PIOS_RCVR_Read(pios_rcvr_group_map[group], number);
             }
 
+        }
+
+        // Scale channels from servo pulse duration (microseconds) to the -1/+1 range
+        for (uint8_t n = 0; n < MANUALCONTROLSETTINGS_CHANNELGROUPS_NUMELEM && n < MANUALCONTROLCOMMAND_CHANNEL_NUMELEM; ++n) {
             // If a channel has timed out this is not valid data and we shouldn't update anything
             // until we decide to go to failsafe
             if (cmd.Channel[n] == (uint16_t)PIOS_RCVR_TIMEOUT) {
                 valid_input_detected = false;
-            } else {
-                scaledChannel[n] = scaleChannel(cmd.Channel[n],
-                                                ManualControlSettingsChannelMaxToArray(settings.ChannelMax)[n],
-                                                ManualControlSettingsChannelMinToArray(settings.ChannelMin)[n],
-                                                ManualControlSettingsChannelNeutralToArray(settings.ChannelNeutral)[n]);
+                continue;
             }
+            int32_t deviation = (int16_t)cmd.Channel[n] - channelScale[n].neutral;
+            scaledChannel[n] = boundf(deviation * (deviation >= 0 ? channelScale[n].above : channelScale[n].below), -1.0f, 1.0f);
         }
 
         // Check settings, if error raise alarm
@@ -474,6 +564,29 @@ static void receiverTask(__attribute__((unused)) void *parameters)
         // Update cmd object
         ManualControlCommandSet(&cmd);
 
+#ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
+        if (newFrame) {
+            frameCount++;
+            addLatency(&commandLatency, PIOS_DELAY_DiffuS(thisFrameTime));
+            // the previous frame is dropped if it has not reached the actuators yet
+            frameTime  = thisFrameTime;
+            frameStage = FRAME_COMMANDED;
+        }
+        if (frameActuated) {
+            addLatency(&actuatorLatency, frameActuatorLatency);
+            frameActuated = false;
+        }
+        uint32_t statusPeriod = timeDifferenceMs(lastStatusTime, lastSysTime);
+        if (statusPeriod >= STATUS_PERIOD_MS) {
+            ReceiverStatusData status;
+            status.FrameRate = frameCount * 1000.0f / statusPeriod;
+            publishLatency(&commandLatency, ReceiverStatusCommandLatencyToArray(status.CommandLatency));
+            publishLatency(&actuatorLatency, ReceiverStatusActuatorLatencyToArray(status.ActuatorLatency));
+            ReceiverStatusSet(&status);
+            frameCount     = 0;
+            lastStatusTime = lastSysTime;
+        }
+#endif /* PIOS_EXCLUDE_ADVANCED_FEATURES */
 
 #if defined(PIOS_INCLUDE_USB_RCTX)
         if (pios_usb_rctx_id) {
@@ -624,36 +737,94 @@ group_completed:
 }
 
 /**
- * Convert channel from servo pulse duration (microseconds) to scaled -1/+1 range.
+ * Settings changed, the task picks them up at its next update
  */
-static float scaleChannel(int16_t value, int16_t max, int16_t min, int16_t neutral)
+static void settingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
-    float valueScaled;
+    settingsUpdated = true;
+}
 
-    // Scale
-    if ((max > min && value >= neutral) || (min > max && value <= neutral)) {
-        if (max != neutral) {
-            valueScaled = (float)(value - neutral) / (float)(max - neutral);
-        } else {
-            valueScaled = 0;
-        }
-    } else {
-        if (min != neutral) {
-            valueScaled = (float)(value - neutral) / (float)(neutral - min);
+/**
+ * Compute the slopes converting each channel from servo pulse duration (microseconds)
+ * to the -1/+1 range, from neutral to max and from min to neutral. A reversed channel,
+ * with min above max, reaches max below neutral.
+ */
+static void updateChannelScales(ManualControlSettingsData *settings)
+{
+    for (uint8_t n = 0; n < MANUALCONTROLSETTINGS_CHANNELGROUPS_NUMELEM; ++n) {
+        int16_t max     = ManualControlSettingsChannelMaxToArray(settings->ChannelMax)[n];
+        int16_t min     = ManualControlSettingsChannelMinToArray(settings->ChannelMin)[n];
+        int16_t neutral = ManualControlSettingsChannelNeutralToArray(settings->ChannelNeutral)[n];
+        float toMax     = (max != neutral) ? 1.0f / (float)(max - neutral) : 0.0f;
+        float fromMin   = (min != neutral) ? 1.0f / (float)(neutral - min) : 0.0f;
+
+        channelScale[n].neutral = neutral;
+        if (max > min) {
+            channelScale[n].above = toMax;
+            channelScale[n].below = fromMin;
+        } else if (min > max) {
+            channelScale[n].above = fromMin;
+            channelScale[n].below = toMax;
         } else {
-            valueScaled = 0;
+            channelScale[n].above = fromMin;
+            channelScale[n].below = fromMin;
         }
     }
+}
 
-    // Bound
-    if (valueScaled > 1.0f) {
-        valueScaled = 1.0f;
-    } else if (valueScaled < -1.0f) {
-        valueScaled = -1.0f;
+#ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
+/**
+ * The stabilization has picked up the last frame commanded
+ */
+static void stabilizationDesiredUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    if (frameStage == FRAME_COMMANDED) {
+        frameStage = FRAME_STABILIZED;
     }
+}
 
-    return valueScaled;
+/**
+ * The actuators are driven from the last frame, measure since it was received
+ */
+static void actuatorCommandUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    if (frameStage == FRAME_STABILIZED && !frameActuated) {
+        frameActuatorLatency = PIOS_DELAY_DiffuS(frameTime);
+        frameActuated = true;
+        frameStage    = FRAME_IDLE;
+    }
+}
+
+static void addLatency(struct latency_stats *stats, uint32_t latency)
+{
+    if (latency > UINT16_MAX) {
+        latency = UINT16_MAX;
+    }
+    if (stats->count == 0 || latency < stats->min) {
+        stats->min = latency;
+    }
+    if (stats->count == 0 || latency > stats->max) {
+        stats->max = latency;
+    }
+    stats->sum += latency;
+    stats->count++;
+}
+
+/**
+ * Publish the minimum, average and maximum latency of the last period and start over
+ */
+static void publishLatency(struct latency_stats *stats, uint16_t *minAvgMax)
+{
+    if (stats->count) {
+        minAvgMax[0] = stats->min;
+        minAvgMax[1] = stats->sum / stats->count;
+        minAvgMax[2] = stats->max;
+    } else {
+        minAvgMax[0] = minAvgMax[1] = minAvgMax[2] = 0;
+    }
+    memset(stats, 0, sizeof(*stats));
 }
+#endif /* PIOS_EXCLUDE_ADVANCED_FEATURES */
 
 static uint32_t timeDifferenceMs(portTickType start_time, portTickType end_time)
 {
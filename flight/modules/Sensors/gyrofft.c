@@ -0,0 +1,244 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotModules OpenPilot Modules
+ * @{
+ * @addtogroup Sensors
+ * @brief Acquires sensor data
+ * @{
+ *
+ * @file       gyrofft.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Gyro spectrum analysis and vibration peak tracking for the dynamic notch
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ ******************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/**
+ * The sensor task pushes every gyro sample into a collecting buffer. Once it
+ * is full the buffers are swapped and a low priority callback runs a real FFT
+ * per axis, looks for the strongest peak within the configured range and
+ * publishes the spectra as @ref GyroSpectrum. The sensor task picks up the
+ * new peaks and moves its notch filters, so filter coefficients are only ever
+ * written by the task that runs the filters.
+ */
+
+#include <openpilot.h>
+
+#ifdef PIOS_SENSORS_GYRO_FFT
+
+#include <arm_math.h>
+#include <arm_common_tables.h>
+#include <gyrospectrum.h>
+#include <callbackinfo.h>
+#include <gyrofft.h>
+
+// Private constants
+#define CALLBACK_PRIORITY CALLBACK_PRIORITY_LOW
+#define CBTASK_PRIORITY   CALLBACK_TASK_AUXILIARY
+#define STACK_SIZE_BYTES  768
+
+#define GYROFFT_BINS      (GYROFFT_SIZE / 2)
+// a peak must stand out this much from the mean of the search range
+#define PEAK_MIN_RATIO    3.0f
+// low pass on the tracked peak, per transform
+#define PEAK_ALPHA        0.3f
+
+// Private variables
+static DelayedCallbackInfo *fftCallback;
+static arm_rfft_fast_instance_f32 rfft;
+static float sampleRate;
+static uint8_t minBin = 1;
+static uint8_t maxBin = GYROFFT_BINS - 2;
+
+// double buffered input, sensor task writes one half while the callback reads the other
+static float samples[2][3][GYROFFT_SIZE] __ccm_data;
+static float window[GYROFFT_SIZE] __ccm_data;
+static float work[GYROFFT_SIZE] __ccm_data;
+static float spectrum[GYROFFT_SIZE] __ccm_data;
+static uint8_t fillBuffer;
+static uint16_t fillCount;
+static volatile bool busy;
+
+static float peaks[3];
+static volatile bool peaksUpdated;
+
+// Private functions
+static void gyrofftCb(void);
+static float trackPeak(const float *mag, float previous);
+
+/**
+ * Set up the transform and the analysis callback
+ * @param[in] sample_rate Rate gyrofft_push is called at in Hz
+ * @returns 0 on success, -1 on failure
+ */
+int32_t gyrofft_init(float sample_rate)
+{
+    GyroSpectrumInitialize();
+
+    // set up the 128 point transform by hand, arm_rfft_fast_init_f32 would link the tables of every length
+    rfft.Sint.fftLen       = GYROFFT_BINS;
+    rfft.Sint.pTwiddle     = (float32_t *)twiddleCoef_64;
+    rfft.Sint.pBitRevTable = (uint16_t *)armBitRevIndexTable64;
+    rfft.Sint.bitRevLength = ARMBITREVINDEXTABLE__64_TABLE_LENGTH;
+    rfft.fftLenRFFT        = GYROFFT_SIZE;
+    rfft.pTwiddleRFFT      = (float32_t *)twiddleCoef_rfft_128;
+
+    // Hann window
+    for (uint16_t n = 0; n < GYROFFT_SIZE; n++) {
+        window[n] = 0.5f - 0.5f * cosf(2.0f * M_PI_F * n / (GYROFFT_SIZE - 1));
+    }
+
+    sampleRate  = sample_rate;
+    fftCallback = PIOS_CALLBACKSCHEDULER_Create(&gyrofftCb, CALLBACK_PRIORITY, CBTASK_PRIORITY, CALLBACKINFO_RUNNING_GYROFFT, STACK_SIZE_BYTES);
+    return fftCallback ? 0 : -1;
+}
+
+/**
+ * Limit the peak search to a frequency range
+ * @param[in] min_freq Lowest frequency in Hz
+ * @param[in] max_freq Highest frequency in Hz
+ */
+void gyrofft_configure(float min_freq, float max_freq)
+{
+    const float binWidth = sampleRate / GYROFFT_SIZE;
+    float lo = min_freq / binWidth;
+    float hi = max_freq / binWidth;
+
+    // keep a neighbour on each side for the interpolation
+    lo     = boundf(lo, 1.0f, GYROFFT_BINS - 3);
+    hi     = boundf(hi, lo + 1.0f, GYROFFT_BINS - 2);
+    minBin = (uint8_t)lo;
+    maxBin = (uint8_t)hi;
+}
+
+/**
+ * Add a gyro sample, called from the sensor task at the sample rate
+ * @param[in] gyro Sample in deg/s
+ */
+void gyrofft_push(const float gyro[3])
+{
+    samples[fillBuffer][0][fillCount] = gyro[0];
+    samples[fillBuffer][1][fillCount] = gyro[1];
+    samples[fillBuffer][2][fillCount] = gyro[2];
+
+    if (++fillCount < GYROFFT_SIZE) {
+        return;
+    }
+    fillCount = 0;
+    // drop the block if the previous one is still being analysed
+    if (!busy) {
+        busy = true;
+        fillBuffer ^= 1;
+        PIOS_CALLBACKSCHEDULER_Dispatch(fftCallback);
+    }
+}
+
+/**
+ * Fetch the tracked peaks, called from the sensor task
+ * @param[out] out Peak frequency per axis in Hz
+ * @returns true if they changed since the last call
+ */
+bool gyrofft_get_peaks(float out[3])
+{
+    if (!peaksUpdated) {
+        return false;
+    }
+    out[0] = peaks[0];
+    out[1] = peaks[1];
+    out[2] = peaks[2];
+    peaksUpdated = false;
+    return true;
+}
+
+static void gyrofftCb(void)
+{
+    GyroSpectrumData data;
+    float (*block)[GYROFFT_SIZE] = samples[fillBuffer ^ 1];
+    uint8_t *axisSpectrum[3] = { data.Roll, data.Pitch, data.Yaw };
+    float *axisPeak = &data.Peak.Roll;
+
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        float mean;
+        arm_mean_f32(block[axis], GYROFFT_SIZE, &mean);
+        arm_offset_f32(block[axis], -mean, work, GYROFFT_SIZE);
+        arm_mult_f32(work, window, work, GYROFFT_SIZE);
+        // work is used as scratch by the transform
+        arm_rfft_fast_f32(&rfft, work, spectrum, 0);
+        // the first pair packs the real DC and Nyquist terms
+        spectrum[0] = 0.0f;
+        spectrum[1] = 0.0f;
+        arm_cmplx_mag_f32(spectrum, spectrum, GYROFFT_BINS);
+
+        peaks[axis] = trackPeak(spectrum, peaks[axis]);
+        axisPeak[axis] = peaks[axis];
+
+        // amplitude in deg/s, 4 / N undoes the one sided spectrum and the window gain.
+        // Published in 0.5dB steps from -60dB.
+        for (uint8_t n = 0; n < GYROFFT_BINS; n++) {
+            const float amplitude = spectrum[n] * (4.0f / GYROFFT_SIZE);
+            const float level     = 2.0f * (20.0f * log10f(amplitude + 1e-6f) + 60.0f);
+            axisSpectrum[axis][n] = (uint8_t)boundf(level, 0.0f, 255.0f);
+        }
+    }
+    peaksUpdated = true;
+    busy = false;
+
+    data.BinWidth = sampleRate / GYROFFT_SIZE;
+    GyroSpectrumSet(&data);
+}
+
+/**
+ * Locate the strongest bin in the search range and interpolate the peak
+ * frequency from its neighbours. Spectra without a clear peak keep the
+ * previous estimate.
+ */
+static float trackPeak(const float *mag, float previous)
+{
+    uint8_t peak = minBin;
+    float sum    = 0.0f;
+
+    for (uint8_t n = minBin; n <= maxBin; n++) {
+        sum += mag[n];
+        if (mag[n] > mag[peak]) {
+            peak = n;
+        }
+    }
+    const float mean = sum / (maxBin - minBin + 1);
+    if (mag[peak] < PEAK_MIN_RATIO * mean) {
+        return previous;
+    }
+
+    const float left   = mag[peak - 1];
+    const float right  = mag[peak + 1];
+    const float denom  = left - 2.0f * mag[peak] + right;
+    const float offset = (fabsf(denom) > 1e-9f) ? 0.5f * (left - right) / denom : 0.0f;
+    const float freq   = (peak + offset) * sampleRate / GYROFFT_SIZE;
+
+    if (previous <= 0.0f) {
+        return freq;
+    }
+    return previous + PEAK_ALPHA * (freq - previous);
+}
+
+#endif /* PIOS_SENSORS_GYRO_FFT */
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,44 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotModules OpenPilot Modules
+ * @{
+ * @addtogroup Sensors
+ * @brief Acquires sensor data
+ * @{
+ *
+ * @file       gyrofft.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Gyro spectrum analysis and vibration peak tracking for the dynamic notch
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ ******************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef GYROFFT_H
+#define GYROFFT_H
+
+#include "openpilot.h"
+
+// Samples per transform, spectra have half as many bins
+#define GYROFFT_SIZE 128
+
+int32_t gyrofft_init(float sample_rate);
+void gyrofft_configure(float min_freq, float max_freq);
+void gyrofft_push(const float samples[3]);
+bool gyrofft_get_peaks(float peaks[3]);
+
+#endif // GYROFFT_H
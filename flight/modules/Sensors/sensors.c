@@ -59,17 +59,30 @@
 #include <revocalibration.h>
 #include <accelgyrosettings.h>
 #include <revosettings.h>
+#include <tempcompensationtable.h>
 
 #include <mathmisc.h>
+#include <biquad.h>
 #include <taskinfo.h>
 #include <pios_math.h>
 #include <pios_constants.h>
 #include <CoordinateConversions.h>
 #include <pios_board_info.h>
 #include <string.h>
+#ifdef PIOS_STABILIZATION_GYRO_DIRECT
+#include <gyrodirect.h>
+#endif
+#ifdef PIOS_SENSORS_GYRO_FFT
+#include <gyrofft.h>
+#endif
 
 // Private constants
+#ifdef PIOS_STABILIZATION_GYRO_DIRECT
+// the stabilization inner loop runs on this stack
+#define STACK_SIZE_BYTES         1800
+#else
 #define STACK_SIZE_BYTES         1000
+#endif
 #define TASK_PRIORITY            (tskIDLE_PRIORITY + 3)
 
 #define MAX_SENSORS_PER_INSTANCE 2
@@ -107,12 +120,16 @@ typedef struct {
     Vector3i32 accum[2];
     int32_t    temperature;
     uint32_t   count;
+    uint32_t   timestamp; // PIOS_DELAY_GetuS() at the newest batched sample, 0 if not batched
 } sensor_fetch_context;
 
-#define MAX_SENSOR_DATA_SIZE (sizeof(PIOS_SENSORS_3Axis_SensorsWithTemp) + MAX_SENSORS_PER_INSTANCE * sizeof(Vector3i16))
+#define MAX_SAMPLE_DATA_SIZE (sizeof(PIOS_SENSORS_3Axis_SensorsWithTemp) + MAX_SENSORS_PER_INSTANCE * sizeof(Vector3i16))
+#define MAX_BATCH_DATA_SIZE  (sizeof(PIOS_SENSORS_3Axis_SensorsBatch) + PIOS_SENSORS_MAX_BATCH_SAMPLES * MAX_SENSORS_PER_INSTANCE * sizeof(Vector3i16))
+#define MAX_SENSOR_DATA_SIZE (MAX_BATCH_DATA_SIZE > MAX_SAMPLE_DATA_SIZE ? MAX_BATCH_DATA_SIZE : MAX_SAMPLE_DATA_SIZE)
 typedef union {
     PIOS_SENSORS_3Axis_SensorsWithTemp sensorSample3Axis;
     PIOS_SENSORS_1Axis_SensorsWithTemp sensorSample1Axis;
+    PIOS_SENSORS_3Axis_SensorsBatch    sensorBatch3Axis;
 } sensor_data;
 
 #define PIOS_INSTRUMENT_MODULE
@@ -124,29 +141,42 @@ PERF_DEFINE_COUNTER(counterMagPeriod);
 PERF_DEFINE_COUNTER(counterBaroPeriod);
 PERF_DEFINE_COUNTER(counterSensorPeriod);
 PERF_DEFINE_COUNTER(counterSensorResets);
+PERF_DEFINE_COUNTER(counterMagLatency);
+PERF_DEFINE_COUNTER(counterBaroLatency);
+PERF_DEFINE_COUNTER(counterGyroLatency);
 
 // Private functions
 static void SensorsTask(void *parameters);
 static void settingsUpdatedCb(UAVObjEvent *objEv);
 
 static void accumulateSamples(sensor_fetch_context *sensor_context, sensor_data *sample);
+static void accumulateBatch(sensor_fetch_context *sensor_context, sensor_data *batch);
+static void accumulateBlock(int32_t *accum, const Vector3i16 *block, uint32_t width, uint32_t samples);
+static void updateTransform(float transform[3][3], float offset[3], const float scale[3], const float bias[3], const float temp_bias[3]);
+static void applyTransform(const float transform[3][3], const float offset[3], const Vector3i32 *accum, float t, float samples[3]);
 static void processSamples3d(sensor_fetch_context *sensor_context, const PIOS_SENSORS_Instance *sensor);
 static void processSamples1d(PIOS_SENSORS_1Axis_SensorsWithTemp *sample, const PIOS_SENSORS_Instance *sensor);
 
 static void clearContext(sensor_fetch_context *sensor_context);
+static void updateGyroFilters();
 
-static void handleAccel(float *samples, float temperature);
-static void handleGyro(float *samples, float temperature);
+static void handleAccel(const Vector3i32 *accum, float t, float temperature);
+static void handleGyro(const Vector3i32 *accum, float t, float temperature);
 static void handleMag(float *samples, float temperature);
 static void handleBaro(float sample, float temperature);
 
 static void updateAccelTempBias(float temperature);
 static void updateGyroTempBias(float temperature);
 static void updateBaroTempBias(float temperature);
+static void updateTempLuts();
 
 // Private variables
 static sensor_data *source_data;
 static xTaskHandle sensorsTaskHandle;
+#ifdef PIOS_TARGET_PROVIDES_FAST_HEAP
+// drivers read into their own buffers, nothing on this stack is a DMA target
+static StackType_t sensorsStack[STACK_SIZE_BYTES / sizeof(StackType_t)] __ccm_data;
+#endif
 RevoCalibrationData cal;
 AccelGyroSettingsData agcal;
 
@@ -157,6 +187,18 @@ static float mag_transform[3][3] = {
     { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 }
 };
 
+// Temperature bias lookup tables, built from the calibration settings and
+// linearly interpolated at runtime. Points are 1/scale degrees apart from min.
+#define TEMP_LUT_POINTS 16
+struct temp_lut {
+    float min;
+    float scale;
+    float value[TEMP_LUT_POINTS][3];
+};
+static struct temp_lut accel_temp_lut;
+static struct temp_lut gyro_temp_lut;
+static struct temp_lut baro_temp_lut;
+
 // Variables used to handle accel/gyro temperature bias
 static volatile bool gyro_temp_calibrated  = false;
 static volatile bool accel_temp_calibrated = false;
@@ -171,9 +213,26 @@ static uint8_t gyro_temp_calibration_count  = 0;
 static float R[3][3] = {
     { 0 }
 };
+// R * diag(scale) and R * (bias + temperature bias), applied as one kernel on the accumulators
+static float accel_transform[3][3] = {
+    { 0 }
+};
+static float accel_offset[3] = { 0 };
+static float gyro_transform[3][3] = {
+    { 0 }
+};
+static float gyro_offset[3] = { 0 };
+// Gyro low pass and notch, per axis
+static struct biquad_cascade gyro_lowpass[3];
+static struct biquad gyro_notch[3];
+static volatile bool gyro_lowpass_enabled;
+static volatile bool gyro_notch_enabled;
+static volatile bool gyro_notch_dynamic;
+static float gyro_notch_q;
+// low pass configuration the filters were built for, the cutoff in mHz
+static uint32_t gyro_lowpass_cutoff;
+static uint8_t gyro_lowpass_order;
 // Variables used to handle baro temperature bias
-static RevoSettingsBaroTempCorrectionPolynomialData baroCorrection;
-static RevoSettingsBaroTempCorrectionExtentData baroCorrectionExtent;
 static volatile bool baro_temp_correction_enabled;
 static float baro_temp_bias   = 0;
 static float baro_temperature = NAN;
@@ -187,7 +246,11 @@ static int8_t rotate = 0;
  */
 int32_t SensorsInitialize(void)
 {
-    source_data = (sensor_data *)pios_malloc(MAX_SENSOR_DATA_SIZE);
+    // only the cpu touches the fetched samples, keep them in core coupled memory
+    source_data = (sensor_data *)pios_fastheapmalloc(MAX_SENSOR_DATA_SIZE);
+#ifdef PIOS_SENSORS_GYRO_FFT
+    gyrofft_init(PIOS_SENSOR_RATE);
+#endif
     GyroSensorInitialize();
     AccelSensorInitialize();
     MagSensorInitialize();
@@ -196,6 +259,7 @@ int32_t SensorsInitialize(void)
     RevoSettingsInitialize();
     AttitudeSettingsInitialize();
     AccelGyroSettingsInitialize();
+    TempCompensationTableInitialize();
 
     rotate = 0;
 
@@ -203,6 +267,7 @@ int32_t SensorsInitialize(void)
     RevoCalibrationConnectCallback(&settingsUpdatedCb);
     AttitudeSettingsConnectCallback(&settingsUpdatedCb);
     AccelGyroSettingsConnectCallback(&settingsUpdatedCb);
+    TempCompensationTableConnectCallback(&settingsUpdatedCb);
 
     return 0;
 }
@@ -214,7 +279,11 @@ int32_t SensorsInitialize(void)
 int32_t SensorsStart(void)
 {
     // Start main task
+#ifdef PIOS_TARGET_PROVIDES_FAST_HEAP
+    xTaskGenericCreate(SensorsTask, "Sensors", STACK_SIZE_BYTES / 4, NULL, TASK_PRIORITY, &sensorsTaskHandle, sensorsStack, NULL);
+#else
     xTaskCreate(SensorsTask, "Sensors", STACK_SIZE_BYTES / 4, NULL, TASK_PRIORITY, &sensorsTaskHandle);
+#endif
     PIOS_TASK_MONITOR_RegisterTask(TASKINFO_RUNNING_SENSORS, sensorsTaskHandle);
     REGISTER_WDG();
     return 0;
@@ -253,6 +322,9 @@ static void SensorsTask(__attribute__((unused)) void *parameters)
     PERF_INIT_COUNTER(counterBaroPeriod, 0x53000004);
     PERF_INIT_COUNTER(counterSensorPeriod, 0x53000005);
     PERF_INIT_COUNTER(counterSensorResets, 0x53000006);
+    PERF_INIT_COUNTER(counterMagLatency, 0x53000007);
+    PERF_INIT_COUNTER(counterBaroLatency, 0x53000008);
+    PERF_INIT_COUNTER(counterGyroLatency, 0x53000009);
 
     // Test sensors
     bool sensors_test = true;
@@ -299,7 +371,11 @@ static void SensorsTask(__attribute__((unused)) void *parameters)
                 while (xQueueReceive(queue,
                                      (void *)source_data,
                                      (is_primary && !sensor_context.count) ? sensor_period_ticks : 0) == pdTRUE) {
-                    accumulateSamples(&sensor_context, source_data);
+                    if (sensor->driver->is_batched) {
+                        accumulateBatch(&sensor_context, source_data);
+                    } else {
+                        accumulateSamples(&sensor_context, source_data);
+                    }
                 }
                 if (sensor_context.count) {
                     processSamples3d(&sensor_context, sensor);
@@ -314,7 +390,11 @@ static void SensorsTask(__attribute__((unused)) void *parameters)
                 if (PIOS_SENSORS_Poll(sensor)) {
                     PIOS_SENSOR_Fetch(sensor, (void *)source_data, MAX_SENSORS_PER_INSTANCE);
                     if (sensor->type & PIOS_SENSORS_TYPE_3D) {
-                        accumulateSamples(&sensor_context, source_data);
+                        if (sensor->driver->is_batched) {
+                            accumulateBatch(&sensor_context, source_data);
+                        } else {
+                            accumulateSamples(&sensor_context, source_data);
+                        }
                         processSamples3d(&sensor_context, sensor);
                     } else {
                         processSamples1d(&source_data->sensorSample1Axis, sensor);
@@ -338,20 +418,91 @@ static void clearContext(sensor_fetch_context *sensor_context)
         sensor_context->accum[i].z = 0;
     }
     sensor_context->temperature = 0;
-    sensor_context->count = 0;
+    sensor_context->count     = 0;
+    sensor_context->timestamp = 0;
 }
 
 static void accumulateSamples(sensor_fetch_context *sensor_context, sensor_data *sample)
 {
-    for (uint32_t i = 0; (i < MAX_SENSORS_PER_INSTANCE) && (i < sample->sensorSample3Axis.count); i++) {
-        sensor_context->accum[i].x += sample->sensorSample3Axis.sample[i].x;
-        sensor_context->accum[i].y += sample->sensorSample3Axis.sample[i].y;
-        sensor_context->accum[i].z += sample->sensorSample3Axis.sample[i].z;
-    }
+    PIOS_Assert(sample->sensorSample3Axis.count <= MAX_SENSORS_PER_INSTANCE);
+    accumulateBlock(&sensor_context->accum[0].x, sample->sensorSample3Axis.sample, sample->sensorSample3Axis.count, 1);
     sensor_context->temperature += sample->sensorSample3Axis.temperature;
     sensor_context->count++;
 }
 
+static void accumulateBatch(sensor_fetch_context *sensor_context, sensor_data *batch)
+{
+    PIOS_Assert(batch->sensorBatch3Axis.count <= MAX_SENSORS_PER_INSTANCE);
+    accumulateBlock(&sensor_context->accum[0].x, batch->sensorBatch3Axis.sample, batch->sensorBatch3Axis.count, batch->sensorBatch3Axis.samples);
+    sensor_context->temperature += (int32_t)batch->sensorBatch3Axis.temperature * batch->sensorBatch3Axis.samples;
+    sensor_context->count += batch->sensorBatch3Axis.samples;
+    if (batch->sensorBatch3Axis.samples) {
+        sensor_context->timestamp = batch->sensorBatch3Axis.timestamp;
+    }
+}
+
+/**
+ * Add a block of samples, each made of width consecutive Vector3i16, to the
+ * accumulators (width * 3 consecutive int32). On cores with the DSP extension
+ * two int16 are loaded per word and each half is sign extended and added by a
+ * single SMLAD against a 0/1 selector.
+ */
+static void accumulateBlock(int32_t *accum, const Vector3i16 *block, uint32_t width, uint32_t samples)
+{
+    const uint32_t values = width * 3;
+    const int16_t *data   = &block[0].x;
+
+#if defined(__ARM_FEATURE_DSP)
+    if (!(values & 1)) {
+        for (uint32_t n = 0; n < samples; n++) {
+            for (uint32_t i = 0; i < values; i += 2) {
+                uint32_t pair;
+                memcpy(&pair, &data[i], sizeof(pair));
+                accum[i]     = __SMLAD(pair, 0x00000001, accum[i]);
+                accum[i + 1] = __SMLAD(pair, 0x00010000, accum[i + 1]);
+            }
+            data += values;
+        }
+        return;
+    }
+#endif
+    for (uint32_t n = 0; n < samples; n++) {
+        for (uint32_t i = 0; i < values; i++) {
+            accum[i] += data[i];
+        }
+        data += values;
+    }
+}
+
+/**
+ * Fold board rotation, scale and bias into one affine transform:
+ * R * (s .* scale - bias - temp_bias) = transform * s - offset
+ */
+static void updateTransform(float transform[3][3], float offset[3], const float scale[3], const float bias[3], const float temp_bias[3])
+{
+    for (uint8_t i = 0; i < 3; i++) {
+        offset[i] = 0.0f;
+        for (uint8_t j = 0; j < 3; j++) {
+            transform[i][j] = R[i][j] * scale[j];
+            offset[i] += R[i][j] * (bias[j] + temp_bias[j]);
+        }
+    }
+}
+
+/**
+ * samples = transform * (accum * t) - offset, t being scale / sample count
+ */
+static void applyTransform(const float transform[3][3], const float offset[3], const Vector3i32 *accum, float t, float samples[3])
+{
+    const float x = (float)accum->x;
+    const float y = (float)accum->y;
+    const float z = (float)accum->z;
+
+    for (uint8_t i = 0; i < 3; i++) {
+        samples[i] = (transform[i][0] * x + transform[i][1] * y + transform[i][2] * z) * t - offset[i];
+    }
+}
+
 static void processSamples3d(sensor_fetch_context *sensor_context, const PIOS_SENSORS_Instance *sensor)
 {
     float samples[3];
@@ -363,18 +514,20 @@ static void processSamples3d(sensor_fetch_context *sensor_context, const PIOS_SE
     if ((sensor->type & PIOS_SENSORS_TYPE_3AXIS_ACCEL) ||
         (sensor->type == PIOS_SENSORS_TYPE_3AXIS_MAG)) {
         float t = inv_count * scales[0];
-        samples[0]  = ((float)sensor_context->accum[0].x * t);
-        samples[1]  = ((float)sensor_context->accum[0].y * t);
-        samples[2]  = ((float)sensor_context->accum[0].z * t);
         temperature = (float)sensor_context->temperature * inv_count * 0.01f;
         if (sensor->type == PIOS_SENSORS_TYPE_3AXIS_MAG) {
+            samples[0] = ((float)sensor_context->accum[0].x * t);
+            samples[1] = ((float)sensor_context->accum[0].y * t);
+            samples[2] = ((float)sensor_context->accum[0].z * t);
             handleMag(samples, temperature);
             PERF_MEASURE_PERIOD(counterMagPeriod);
+            // from the data ready interrupt to MagSensor
+            PERF_TRACK_VALUE(counterMagLatency, sensor_context->timestamp ? PIOS_DELAY_GetuS() - sensor_context->timestamp : 0);
             return;
         } else {
             PERF_TRACK_VALUE(counterAccelSamples, sensor_context->count);
             PERF_MEASURE_PERIOD(counterAccelPeriod);
-            handleAccel(samples, temperature);
+            handleAccel(&sensor_context->accum[0], t, temperature);
         }
     }
 
@@ -384,11 +537,10 @@ static void processSamples3d(sensor_fetch_context *sensor_context, const PIOS_SE
             index = 1;
         }
         float t = inv_count * scales[index];
-        samples[0]  = ((float)sensor_context->accum[index].x * t);
-        samples[1]  = ((float)sensor_context->accum[index].y * t);
-        samples[2]  = ((float)sensor_context->accum[index].z * t);
         temperature = (float)sensor_context->temperature * inv_count * 0.01f;
-        handleGyro(samples, temperature);
+        handleGyro(&sensor_context->accum[index], t, temperature);
+        // from the data ready interrupt of the newest fifo sample to GyroSensor
+        PERF_TRACK_VALUE(counterGyroLatency, sensor_context->timestamp ? PIOS_DELAY_GetuS() - sensor_context->timestamp : 0);
         return;
     }
 }
@@ -399,6 +551,8 @@ static void processSamples1d(PIOS_SENSORS_1Axis_SensorsWithTemp *sample, const P
     case PIOS_SENSORS_TYPE_1AXIS_BARO:
         PERF_MEASURE_PERIOD(counterBaroPeriod);
         handleBaro(sample->sample, sample->temperature);
+        // from the middle of the conversion to BaroSensor
+        PERF_TRACK_VALUE(counterBaroLatency, PIOS_DELAY_GetuS() - sample->timestamp);
         return;
 
     default:
@@ -406,16 +560,13 @@ static void processSamples1d(PIOS_SENSORS_1Axis_SensorsWithTemp *sample, const P
     }
 }
 
-static void handleAccel(float *samples, float temperature)
+static void handleAccel(const Vector3i32 *accum, float t, float temperature)
 {
     AccelSensorData accelSensorData;
+    float samples[3];
 
     updateAccelTempBias(temperature);
-    float accels_out[3] = { samples[0] * agcal.accel_scale.X - agcal.accel_bias.X - accel_temp_bias[0],
-                            samples[1] * agcal.accel_scale.Y - agcal.accel_bias.Y - accel_temp_bias[1],
-                            samples[2] * agcal.accel_scale.Z - agcal.accel_bias.Z - accel_temp_bias[2] };
-
-    rot_mult(R, accels_out, samples);
+    applyTransform(accel_transform, accel_offset, accum, t, samples);
     accelSensorData.x = samples[0];
     accelSensorData.y = samples[1];
     accelSensorData.z = samples[2];
@@ -423,22 +574,44 @@ static void handleAccel(float *samples, float temperature)
     AccelSensorSet(&accelSensorData);
 }
 
-static void handleGyro(float *samples, float temperature)
+static void handleGyro(const Vector3i32 *accum, float t, float temperature)
 {
     GyroSensorData gyroSensorData;
+    float samples[3];
 
     updateGyroTempBias(temperature);
-    float gyros_out[3] = { samples[0] * agcal.gyro_scale.X - agcal.gyro_bias.X - gyro_temp_bias[0],
-                           samples[1] * agcal.gyro_scale.Y - agcal.gyro_bias.Y - gyro_temp_bias[1],
-                           samples[2] * agcal.gyro_scale.Z - agcal.gyro_bias.Z - gyro_temp_bias[2] };
-
-    rot_mult(R, gyros_out, samples);
+    applyTransform(gyro_transform, gyro_offset, accum, t, samples);
+    if (gyro_lowpass_enabled) {
+        for (uint8_t i = 0; i < 3; i++) {
+            samples[i] = biquad_cascade_apply(&gyro_lowpass[i], samples[i]);
+        }
+    }
+#ifdef PIOS_SENSORS_GYRO_FFT
+    // the analysis needs to see the vibration the notch removes
+    gyrofft_push(samples);
+    float peaks[3];
+    if (gyrofft_get_peaks(peaks) && gyro_notch_dynamic) {
+        for (uint8_t i = 0; i < 3; i++) {
+            if (peaks[i] > 0.0f) {
+                biquad_update_notch(&gyro_notch[i], peaks[i] / PIOS_SENSOR_RATE, gyro_notch_q);
+            }
+        }
+    }
+#endif
+    if (gyro_notch_enabled) {
+        for (uint8_t i = 0; i < 3; i++) {
+            samples[i] = biquad_apply(&gyro_notch[i], samples[i]);
+        }
+    }
     gyroSensorData.temperature = temperature;
     gyroSensorData.x = samples[0];
     gyroSensorData.y = samples[1];
     gyroSensorData.z = samples[2];
 
     GyroSensorSet(&gyroSensorData);
+#ifdef PIOS_STABILIZATION_GYRO_DIRECT
+    gyrodirect_publish(samples);
+#endif
 }
 
 static void handleMag(float *samples, float temperature)
@@ -475,6 +648,73 @@ static void handleBaro(float sample, float temperature)
     }
 }
 
+/**
+ * Interpolate the bias for the given temperature. Outside of the calibrated
+ * range the nearest extreme is used.
+ */
+static void tempLutLookup(const struct temp_lut *lut, float temperature, uint8_t axes, float *bias)
+{
+    float x   = boundf((temperature - lut->min) * lut->scale, 0.0f, (float)(TEMP_LUT_POINTS - 1));
+    uint8_t i = (uint8_t)x;
+
+    if (i > TEMP_LUT_POINTS - 2) {
+        i = TEMP_LUT_POINTS - 2;
+    }
+    x -= (float)i;
+    for (uint8_t j = 0; j < axes; j++) {
+        bias[j] = lut->value[i][j] + x * (lut->value[i + 1][j] - lut->value[i][j]);
+    }
+}
+
+/**
+ * Sample the polynomials bias = c0 + c1 * t + c2 * t^2 + c3 * t^3 (per axis) over [min, max]
+ */
+static void tempLutFromPolynomial(struct temp_lut *lut, float min, float max, uint8_t axes, const float poly[][4])
+{
+    lut->min   = min;
+    lut->scale = (float)(TEMP_LUT_POINTS - 1) / (max - min);
+    for (uint8_t i = 0; i < TEMP_LUT_POINTS; i++) {
+        const float t = min + (float)i / lut->scale;
+        for (uint8_t j = 0; j < axes; j++) {
+            lut->value[i][j] = ((poly[j][3] * t + poly[j][2]) * t + poly[j][1]) * t + poly[j][0];
+        }
+    }
+}
+
+/**
+ * Resample a TempCompensationTable table (one array per axis) over [min, max].
+ * Returns false if the table is not set, i.e. all zero.
+ */
+static bool tempLutFromTable(struct temp_lut *lut, float min, float max, uint8_t axes, const float *const table[])
+{
+    const uint8_t points = TEMPCOMPENSATIONTABLE_GYROX_NUMELEM;
+    bool set = false;
+
+    for (uint8_t j = 0; j < axes; j++) {
+        for (uint8_t k = 0; k < points; k++) {
+            set |= fabsf(table[j][k]) > 1e-9f;
+        }
+    }
+    if (!set) {
+        return false;
+    }
+
+    lut->min   = min;
+    lut->scale = (float)(TEMP_LUT_POINTS - 1) / (max - min);
+    for (uint8_t i = 0; i < TEMP_LUT_POINTS; i++) {
+        float x   = (float)(i * (points - 1)) / (float)(TEMP_LUT_POINTS - 1);
+        uint8_t k = (uint8_t)x;
+        if (k > points - 2) {
+            k = points - 2;
+        }
+        x -= (float)k;
+        for (uint8_t j = 0; j < axes; j++) {
+            lut->value[i][j] = table[j][k] + x * (table[j][k + 1] - table[j][k]);
+        }
+    }
+    return true;
+}
+
 static void updateAccelTempBias(float temperature)
 {
     if (isnan(accel_temperature)) {
@@ -485,10 +725,9 @@ static void updateAccelTempBias(float temperature)
     if ((accel_temp_calibrated) && !accel_temp_calibration_count) {
         accel_temp_calibration_count = TEMP_CALIB_INTERVAL;
         if (accel_temp_calibrated) {
-            float ctemp = boundf(accel_temperature, agcal.temp_calibrated_extent.max, agcal.temp_calibrated_extent.min);
-            accel_temp_bias[0] = agcal.accel_temp_coeff.X * ctemp;
-            accel_temp_bias[1] = agcal.accel_temp_coeff.Y * ctemp;
-            accel_temp_bias[2] = agcal.accel_temp_coeff.Z * ctemp;
+            tempLutLookup(&accel_temp_lut, accel_temperature, 3, accel_temp_bias);
+            updateTransform(accel_transform, accel_offset, AccelGyroSettingsaccel_scaleToArray(agcal.accel_scale),
+                            AccelGyroSettingsaccel_biasToArray(agcal.accel_bias), accel_temp_bias);
         }
     }
     accel_temp_calibration_count--;
@@ -506,10 +745,9 @@ static void updateGyroTempBias(float temperature)
         gyro_temp_calibration_count = TEMP_CALIB_INTERVAL;
 
         if (gyro_temp_calibrated) {
-            float ctemp = boundf(gyro_temperature, agcal.temp_calibrated_extent.max, agcal.temp_calibrated_extent.min);
-            gyro_temp_bias[0] = (agcal.gyro_temp_coeff.X + agcal.gyro_temp_coeff.X2 * ctemp) * ctemp;
-            gyro_temp_bias[1] = (agcal.gyro_temp_coeff.Y + agcal.gyro_temp_coeff.Y2 * ctemp) * ctemp;
-            gyro_temp_bias[2] = (agcal.gyro_temp_coeff.Z + agcal.gyro_temp_coeff.Z2 * ctemp) * ctemp;
+            tempLutLookup(&gyro_temp_lut, gyro_temperature, 3, gyro_temp_bias);
+            updateTransform(gyro_transform, gyro_offset, AccelGyroSettingsgyro_scaleToArray(agcal.gyro_scale),
+                            AccelGyroSettingsgyro_biasToArray(agcal.gyro_bias), gyro_temp_bias);
         }
     }
     gyro_temp_calibration_count--;
@@ -525,13 +763,76 @@ static void updateBaroTempBias(float temperature)
 
     if (baro_temp_correction_enabled && !baro_temp_calibration_count) {
         baro_temp_calibration_count = BARO_TEMP_CALIB_INTERVAL;
-        // pressure bias = A + B*t + C*t^2 + D * t^3
-        // in case the temperature is outside of the calibrated range, uses the nearest extremes
-        float ctemp = boundf(baro_temperature, baroCorrectionExtent.max, baroCorrectionExtent.min);
-        baro_temp_bias = baroCorrection.a + ((baroCorrection.d * ctemp + baroCorrection.c) * ctemp + baroCorrection.b) * ctemp;
+        tempLutLookup(&baro_temp_lut, baro_temperature, 1, &baro_temp_bias);
     }
     baro_temp_calibration_count--;
 }
+
+/**
+ * Build the temperature bias tables. A TempCompensationTable entry takes
+ * precedence over the polynomial models for the same sensor.
+ */
+static void updateTempLuts()
+{
+    TempCompensationTableData table;
+    RevoSettingsBaroTempCorrectionPolynomialData baroCorrection;
+    RevoSettingsBaroTempCorrectionExtentData baroCorrectionExtent;
+
+    TempCompensationTableGet(&table);
+    RevoSettingsBaroTempCorrectionPolynomialGet(&baroCorrection);
+    RevoSettingsBaroTempCorrectionExtentGet(&baroCorrectionExtent);
+
+    const bool accelgyro_table_valid = table.AccelGyroTempRange.Max - table.AccelGyroTempRange.Min > .1f;
+    const bool baro_table_valid = table.BaroTempRange.Max - table.BaroTempRange.Min > .1f;
+    const bool agcal_valid = agcal.temp_calibrated_extent.max - agcal.temp_calibrated_extent.min > .1f;
+
+    // the sensor task only looks at a table while its flag is set
+    accel_temp_calibrated = false;
+    gyro_temp_calibrated  = false;
+    baro_temp_correction_enabled = false;
+
+    const float *const accel_table[3] = { table.AccelX, table.AccelY, table.AccelZ };
+    if (accelgyro_table_valid && tempLutFromTable(&accel_temp_lut, table.AccelGyroTempRange.Min, table.AccelGyroTempRange.Max, 3, accel_table)) {
+        accel_temp_calibrated = true;
+    } else if (agcal_valid &&
+               (fabsf(agcal.accel_temp_coeff.X) > 1e-9f || fabsf(agcal.accel_temp_coeff.Y) > 1e-9f || fabsf(agcal.accel_temp_coeff.Z) > 1e-9f)) {
+        const float poly[3][4] = {
+            { 0.0f, agcal.accel_temp_coeff.X, 0.0f, 0.0f },
+            { 0.0f, agcal.accel_temp_coeff.Y, 0.0f, 0.0f },
+            { 0.0f, agcal.accel_temp_coeff.Z, 0.0f, 0.0f },
+        };
+        tempLutFromPolynomial(&accel_temp_lut, agcal.temp_calibrated_extent.min, agcal.temp_calibrated_extent.max, 3, poly);
+        accel_temp_calibrated = true;
+    }
+
+    const float *const gyro_table[3] = { table.GyroX, table.GyroY, table.GyroZ };
+    if (accelgyro_table_valid && tempLutFromTable(&gyro_temp_lut, table.AccelGyroTempRange.Min, table.AccelGyroTempRange.Max, 3, gyro_table)) {
+        gyro_temp_calibrated = true;
+    } else if (agcal_valid &&
+               (fabsf(agcal.gyro_temp_coeff.X) > 1e-9f || fabsf(agcal.gyro_temp_coeff.Y) > 1e-9f ||
+                fabsf(agcal.gyro_temp_coeff.Z) > 1e-9f || fabsf(agcal.gyro_temp_coeff.Z2) > 1e-9f)) {
+        const float poly[3][4] = {
+            { 0.0f, agcal.gyro_temp_coeff.X, agcal.gyro_temp_coeff.X2, 0.0f },
+            { 0.0f, agcal.gyro_temp_coeff.Y, agcal.gyro_temp_coeff.Y2, 0.0f },
+            { 0.0f, agcal.gyro_temp_coeff.Z, agcal.gyro_temp_coeff.Z2, 0.0f },
+        };
+        tempLutFromPolynomial(&gyro_temp_lut, agcal.temp_calibrated_extent.min, agcal.temp_calibrated_extent.max, 3, poly);
+        gyro_temp_calibrated = true;
+    }
+
+    const float *const baro_table[1] = { table.Baro };
+    if (baro_table_valid && tempLutFromTable(&baro_temp_lut, table.BaroTempRange.Min, table.BaroTempRange.Max, 1, baro_table)) {
+        baro_temp_correction_enabled = true;
+    } else if (!(baroCorrectionExtent.max - baroCorrectionExtent.min < 0.1f ||
+                 (baroCorrection.a < 1e-9f && baroCorrection.b < 1e-9f && baroCorrection.c < 1e-9f && baroCorrection.d < 1e-9f))) {
+        // pressure bias = A + B*t + C*t^2 + D * t^3
+        const float poly[1][4] = {
+            { baroCorrection.a, baroCorrection.b, baroCorrection.c, baroCorrection.d },
+        };
+        tempLutFromPolynomial(&baro_temp_lut, baroCorrectionExtent.min, baroCorrectionExtent.max, 1, poly);
+        baro_temp_correction_enabled = true;
+    }
+}
 /**
  * Locally cache some variables from the AtttitudeSettings object
  */
@@ -543,13 +844,7 @@ static void settingsUpdatedCb(__attribute__((unused)) UAVObjEvent *objEv)
     mag_bias[1] = cal.mag_bias.Y;
     mag_bias[2] = cal.mag_bias.Z;
 
-    accel_temp_calibrated = (agcal.temp_calibrated_extent.max - agcal.temp_calibrated_extent.min > .1f) &&
-                            (fabsf(agcal.accel_temp_coeff.X) > 1e-9f || fabsf(agcal.accel_temp_coeff.Y) > 1e-9f || fabsf(agcal.accel_temp_coeff.Z) > 1e-9f);
-
-    gyro_temp_calibrated  = (agcal.temp_calibrated_extent.max - agcal.temp_calibrated_extent.min > .1f) &&
-                            (fabsf(agcal.gyro_temp_coeff.X) > 1e-9f || fabsf(agcal.gyro_temp_coeff.Y) > 1e-9f ||
-                            fabsf(agcal.gyro_temp_coeff.Z) > 1e-9f || fabsf(agcal.gyro_temp_coeff.Z2) > 1e-9f);
-
+    updateTempLuts();
 
     AttitudeSettingsData attitudeSettings;
     AttitudeSettingsGet(&attitudeSettings);
@@ -585,11 +880,79 @@ static void settingsUpdatedCb(__attribute__((unused)) UAVObjEvent *objEv)
         Quaternion2R(rotationQuat, R);
     }
     matrix_mult_3x3f((float(*)[3])RevoCalibrationmag_transformToArray(cal.mag_transform), R, mag_transform);
+    updateTransform(accel_transform, accel_offset, AccelGyroSettingsaccel_scaleToArray(agcal.accel_scale),
+                    AccelGyroSettingsaccel_biasToArray(agcal.accel_bias), accel_temp_bias);
+    updateTransform(gyro_transform, gyro_offset, AccelGyroSettingsgyro_scaleToArray(agcal.gyro_scale),
+                    AccelGyroSettingsgyro_biasToArray(agcal.gyro_bias), gyro_temp_bias);
 
-    RevoSettingsBaroTempCorrectionPolynomialGet(&baroCorrection);
-    RevoSettingsBaroTempCorrectionExtentGet(&baroCorrectionExtent);
-    baro_temp_correction_enabled = !(baroCorrectionExtent.max - baroCorrectionExtent.min < 0.1f ||
-                                     (baroCorrection.a < 1e-9f && baroCorrection.b < 1e-9f && baroCorrection.c < 1e-9f && baroCorrection.d < 1e-9f));
+    updateGyroFilters();
+}
+
+/**
+ * Set up the gyro filters from RevoSettings. The low pass is only rebuilt when
+ * its configuration changed, the notch is moved without touching its state.
+ */
+static void updateGyroFilters()
+{
+    RevoSettingsGyroNotchData notch;
+    float cutoff;
+    uint8_t order;
+    uint8_t mode;
+
+    RevoSettingsGyroLowPassCutoffGet(&cutoff);
+    RevoSettingsGyroLowPassOrderGet(&order);
+    RevoSettingsGyroNotchGet(&notch);
+    RevoSettingsGyroNotchModeGet(&mode);
+
+#ifdef PIOS_SENSORS_GYRO_FFT
+    RevoSettingsGyroFFTRangeData range;
+    RevoSettingsGyroFFTRangeGet(&range);
+    gyrofft_configure(range.Min, range.Max);
+    if (mode == REVOSETTINGS_GYRONOTCHMODE_DYNAMIC && notch.Width > 0.0f) {
+        if (!(notch.Center > 0.0f)) {
+            notch.Center = 0.5f * (range.Min + range.Max);
+        }
+    } else {
+        mode = REVOSETTINGS_GYRONOTCHMODE_STATIC;
+    }
+#else
+    mode = REVOSETTINGS_GYRONOTCHMODE_STATIC;
+#endif
+
+    if (cutoff > 0.0f && cutoff < 0.5f * PIOS_SENSOR_RATE) {
+        const uint32_t cutoff_mhz = (uint32_t)(cutoff * 1000.0f + 0.5f);
+        if (!gyro_lowpass_enabled || gyro_lowpass_cutoff != cutoff_mhz || gyro_lowpass_order != order) {
+            gyro_lowpass_enabled = false;
+            for (uint8_t i = 0; i < 3; i++) {
+                biquad_cascade_init_lowpass(&gyro_lowpass[i], cutoff / PIOS_SENSOR_RATE, order);
+            }
+            gyro_lowpass_cutoff  = cutoff_mhz;
+            gyro_lowpass_order   = order;
+            gyro_lowpass_enabled = true;
+        }
+    } else {
+        gyro_lowpass_enabled = false;
+    }
+
+    if (notch.Center > 0.0f && notch.Center < 0.5f * PIOS_SENSOR_RATE && notch.Width > 0.0f) {
+        const float q = notch.Center / notch.Width;
+        // a tracking notch keeps its current center, only the width follows the settings
+        if (!gyro_notch_enabled || mode == REVOSETTINGS_GYRONOTCHMODE_STATIC || !gyro_notch_dynamic) {
+            for (uint8_t i = 0; i < 3; i++) {
+                if (gyro_notch_enabled) {
+                    biquad_update_notch(&gyro_notch[i], notch.Center / PIOS_SENSOR_RATE, q);
+                } else {
+                    biquad_init_notch(&gyro_notch[i], notch.Center / PIOS_SENSOR_RATE, q);
+                }
+            }
+        }
+        gyro_notch_q       = q;
+        gyro_notch_dynamic = (mode == REVOSETTINGS_GYRONOTCHMODE_DYNAMIC);
+        gyro_notch_enabled = true;
+    } else {
+        gyro_notch_dynamic = false;
+        gyro_notch_enabled = false;
+    }
 }
 /**
  * @}
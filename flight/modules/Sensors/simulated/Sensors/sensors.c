@@ -48,6 +48,9 @@
 
 #include <openpilot.h>
 
+#include <stdio.h>
+#include <stdlib.h>
+
 #include "attitudestate.h"
 #include "accelsensor.h"
 #include "actuatordesired.h"
@@ -62,6 +65,10 @@
 #include "gpspositionsensor.h"
 #include "gpsvelocitysensor.h"
 #include "homelocation.h"
+#include "flightmodesettings.h"
+#include "manualcontrolcommand.h"
+#include "positionstate.h"
+#include "velocitystate.h"
 // #include "sensor.h"
 #include "ratedesired.h"
 #include "revocalibration.h"
@@ -75,9 +82,30 @@
 #define TASK_PRIORITY    (tskIDLE_PRIORITY + 3)
 #define SENSOR_PERIOD    2
 
+// Scripted flight plan, see simPlanLoad()
+#define PLAN_MAX_STEPS   64
+
 #define F_PI             3.14159265358979323846f
 #define PI_MOD(x) (fmod(x + F_PI, F_PI * 2) - F_PI)
 // Private types
+struct plan_step {
+    float   time;
+    float   throttle;
+    float   roll;
+    float   pitch;
+    float   yaw;
+    uint8_t position;
+};
+
+struct sim_stats {
+    uint32_t count;
+    uint32_t loop_max_us;
+    float    loop_sum_us;
+    float    att_sum_sq;
+    float    att_max;
+    float    pos_sum_sq;
+    float    vel_sum_sq;
+};
 
 // Private variables
 static xTaskHandle sensorsTaskHandle;
@@ -92,6 +120,21 @@ static void simulateModelAirplane();
 static float accel_bias[3];
 
 static float rand_gauss();
+static uint32_t rand_next();
+static void simPlanLoad(const char *fileName);
+static void simPlanApply(float time);
+static void simStatsUpdate(float time, uint32_t loop_us);
+
+// Noise generator state, the same seed gives the same sensor noise on every run
+static uint32_t rand_state = 1;
+
+static struct plan_step plan[PLAN_MAX_STEPS];
+static uint8_t plan_steps;
+static uint8_t plan_next;
+
+// Seconds between two SIMSTATS lines on stdout, 0 to disable them
+static float stats_period;
+static struct sim_stats stats;
 
 enum sensor_sim_type { CONSTANT, MODEL_AGNOSTIC, MODEL_QUADCOPTER, MODEL_AIRPLANE } sensor_sim_type;
 
@@ -102,6 +145,20 @@ enum sensor_sim_type { CONSTANT, MODEL_AGNOSTIC, MODEL_QUADCOPTER, MODEL_AIRPLAN
  */
 int32_t SensorsInitialize(void)
 {
+    // The simulation is set up from the environment, see make/scripts/simposix-runner.py
+    const char *env = getenv("OP_SIM_SEED");
+
+    if (env) {
+        rand_state = strtoul(env, NULL, 0);
+        if (rand_state == 0) {
+            rand_state = 1;
+        }
+    }
+    env = getenv("OP_SIM_STATS");
+    if (env) {
+        stats_period = strtof(env, NULL);
+    }
+
     accel_bias[0] = rand_gauss() / 10;
     accel_bias[1] = rand_gauss() / 10;
     accel_bias[2] = rand_gauss() / 10;
@@ -116,6 +173,15 @@ int32_t SensorsInitialize(void)
     GPSVelocitySensorInitialize();
     MagSensorInitialize();
     RevoCalibrationInitialize();
+    FlightModeSettingsInitialize();
+    ManualControlCommandInitialize();
+    PositionStateInitialize();
+    VelocityStateInitialize();
+
+    env = getenv("OP_SIM_PLAN");
+    if (env) {
+        simPlanLoad(env);
+    }
 
     return 0;
 }
@@ -127,7 +193,7 @@ int32_t SensorsInitialize(void)
 int32_t SensorsStart(void)
 {
     // Start main task
-    xTaskCreate(SensorsTask, (signed char *)"Sensors", STACK_SIZE_BYTES / 4, NULL, TASK_PRIORITY, &sensorsTaskHandle);
+    xTaskCreate(SensorsTask, "Sensors", STACK_SIZE_BYTES / 4, NULL, TASK_PRIORITY, &sensorsTaskHandle);
     PIOS_TASK_MONITOR_RegisterTask(TASKINFO_RUNNING_SENSORS, sensorsTaskHandle);
     PIOS_WDG_RegisterFlag(PIOS_WDG_SENSORS);
 
@@ -142,8 +208,6 @@ MODULE_INITCALL(SensorsInitialize, SensorsStart);
 int sensors_count;
 static void SensorsTask(__attribute__((unused)) void *parameters)
 {
-    portTickType lastSysTime;
-
     AlarmsClear(SYSTEMALARMS_ALARM_SENSORS);
 
 // HomeLocationData homeLocation;
@@ -159,8 +223,8 @@ static void SensorsTask(__attribute__((unused)) void *parameters)
 
 
     // Main task loop
-    lastSysTime = xTaskGetTickCount();
     uint32_t last_time = PIOS_DELAY_GetRaw();
+    float sim_time     = 0;
     while (1) {
         PIOS_WDG_UpdateFlag(PIOS_WDG_SENSORS);
 
@@ -184,12 +248,12 @@ static void SensorsTask(__attribute__((unused)) void *parameters)
             sensor_sim_type = MODEL_AGNOSTIC;
         }
 
-        static int i;
-        i++;
-        if (i % 5000 == 0) {
-            // float dT = PIOS_DELAY_DiffuS(last_time) / 10.0e6;
-            // fprintf(stderr, "Sensor relative timing: %f\n", dT);
-            last_time = PIOS_DELAY_GetRaw();
+        uint32_t loop_us = PIOS_DELAY_DiffuS(last_time);
+        last_time = PIOS_DELAY_GetRaw();
+        sim_time += loop_us / 1.0e6f;
+
+        if (plan_steps) {
+            simPlanApply(sim_time);
         }
 
         sensors_count++;
@@ -208,6 +272,10 @@ static void SensorsTask(__attribute__((unused)) void *parameters)
             simulateModelAirplane();
         }
 
+        if (stats_period > 0) {
+            simStatsUpdate(sim_time, loop_us);
+        }
+
         vTaskDelay(2 / portTICK_RATE_MS);
     }
 }
@@ -354,7 +422,7 @@ static void simulateModelQuadcopter()
     ActuatorDesiredData actuatorDesired;
     ActuatorDesiredGet(&actuatorDesired);
 
-    float thrust = (flightStatus.Armed == FLIGHTSTATUS_ARMED_ARMED) ? actuatorDesired.Throttle * MAX_THRUST : 0;
+    float thrust = (flightStatus.Armed == FLIGHTSTATUS_ARMED_ARMED) ? actuatorDesired.Thrust * MAX_THRUST : 0;
     if (thrust < 0) {
         thrust = 0;
     }
@@ -544,12 +612,12 @@ static void simulateModelQuadcopter()
     attitudeSimulated.q3 = q[2];
     attitudeSimulated.q4 = q[3];
     Quaternion2RPY(q, &attitudeSimulated.Roll);
-    attitudeSimulated.Position[0] = pos[0];
-    attitudeSimulated.Position[1] = pos[1];
-    attitudeSimulated.Position[2] = pos[2];
-    attitudeSimulated.Velocity[0] = vel[0];
-    attitudeSimulated.Velocity[1] = vel[1];
-    attitudeSimulated.Velocity[2] = vel[2];
+    attitudeSimulated.Position.North = pos[0];
+    attitudeSimulated.Position.East = pos[1];
+    attitudeSimulated.Position.Down = pos[2];
+    attitudeSimulated.Velocity.North = vel[0];
+    attitudeSimulated.Velocity.East = vel[1];
+    attitudeSimulated.Velocity.Down = vel[2];
     AttitudeSimulatedSet(&attitudeSimulated);
 }
 
@@ -597,7 +665,7 @@ static void simulateModelAirplane()
     ActuatorDesiredData actuatorDesired;
     ActuatorDesiredGet(&actuatorDesired);
 
-    float thrust = (flightStatus.Armed == FLIGHTSTATUS_ARMED_ARMED) ? actuatorDesired.Throttle * MAX_THRUST : 0;
+    float thrust = (flightStatus.Armed == FLIGHTSTATUS_ARMED_ARMED) ? actuatorDesired.Thrust * MAX_THRUST : 0;
     if (thrust < 0) {
         thrust = 0;
     }
@@ -826,22 +894,148 @@ static void simulateModelAirplane()
     attitudeSimulated.q3 = q[2];
     attitudeSimulated.q4 = q[3];
     Quaternion2RPY(q, &attitudeSimulated.Roll);
-    attitudeSimulated.Position[0] = pos[0];
-    attitudeSimulated.Position[1] = pos[1];
-    attitudeSimulated.Position[2] = pos[2];
-    attitudeSimulated.Velocity[0] = vel[0];
-    attitudeSimulated.Velocity[1] = vel[1];
-    attitudeSimulated.Velocity[2] = vel[2];
+    attitudeSimulated.Position.North = pos[0];
+    attitudeSimulated.Position.East = pos[1];
+    attitudeSimulated.Position.Down = pos[2];
+    attitudeSimulated.Velocity.North = vel[0];
+    attitudeSimulated.Velocity.East = vel[1];
+    attitudeSimulated.Velocity.Down = vel[2];
     AttitudeSimulatedSet(&attitudeSimulated);
 }
 
+/**
+ * Load the flight plan the simulation flies instead of a pilot
+ *
+ * Each line holds the time in seconds from startup at which the step begins, followed by
+ * the throttle, roll, pitch and yaw sticks (-1 to 1) and the flight mode switch position.
+ * Lines starting with # are comments. Steps must be given in time order.
+ */
+static void simPlanLoad(const char *fileName)
+{
+    FILE *file = fopen(fileName, "r");
+
+    if (!file) {
+        fprintf(stderr, "Sensors: can't open flight plan %s\n", fileName);
+        return;
+    }
+
+    char line[128];
+    while (plan_steps < PLAN_MAX_STEPS && fgets(line, sizeof(line), file)) {
+        struct plan_step *step = &plan[plan_steps];
+        unsigned position = 0;
+        if (line[0] == '#') {
+            continue;
+        }
+        if (sscanf(line, "%f %f %f %f %f %u", &step->time, &step->throttle, &step->roll, &step->pitch, &step->yaw, &position) >= 5) {
+            step->position = position;
+            plan_steps++;
+        }
+    }
+    fclose(file);
+
+    if (plan_steps) {
+        // the plan arms by lowering the throttle, as nobody is there to give the arming gesture
+        FlightModeSettingsData settings;
+        FlightModeSettingsGet(&settings);
+        settings.Arming = FLIGHTMODESETTINGS_ARMING_ALWAYSARMED;
+        FlightModeSettingsSet(&settings);
+    }
+}
+
+/**
+ * Fly the plan step that starts at or before time, as the GCS does for fly-by-wire
+ */
+static void simPlanApply(float time)
+{
+    if (plan_next >= plan_steps || plan[plan_next].time > time) {
+        return;
+    }
+
+    struct plan_step *step = &plan[plan_next++];
+    ManualControlCommandData cmd;
+    ManualControlCommandGet(&cmd);
+    cmd.Connected  = MANUALCONTROLCOMMAND_CONNECTED_TRUE;
+    cmd.Throttle   = step->throttle;
+    cmd.Thrust     = step->throttle > 0 ? step->throttle : 0;
+    cmd.Collective = 0;
+    cmd.Roll       = step->roll;
+    cmd.Pitch      = step->pitch;
+    cmd.Yaw        = step->yaw;
+    cmd.FlightModeSwitchPosition = step->position;
+    ManualControlCommandSet(&cmd);
+}
+
+/**
+ * Compare the state estimation with the simulated truth and report it with the loop timing
+ *
+ * One line is printed for every stats_period, with the RMS over that period.
+ */
+static void simStatsUpdate(float time, uint32_t loop_us)
+{
+    AttitudeSimulatedData truth;
+    AttitudeStateData attitude;
+    PositionStateData position;
+    VelocityStateData velocity;
+
+    AttitudeSimulatedGet(&truth);
+    AttitudeStateGet(&attitude);
+    PositionStateGet(&position);
+    VelocityStateGet(&velocity);
+
+    // angle of the rotation between the two attitudes
+    float dot = fabsf(truth.q1 * attitude.q1 + truth.q2 * attitude.q2 + truth.q3 * attitude.q3 + truth.q4 * attitude.q4);
+    float att_error = 2.0f * acosf(dot > 1.0f ? 1.0f : dot) * 180.0f / F_PI;
+    float dN = position.North - truth.Position.North;
+    float dE = position.East - truth.Position.East;
+    float dD = position.Down - truth.Position.Down;
+    float vN = velocity.North - truth.Velocity.North;
+    float vE = velocity.East - truth.Velocity.East;
+    float vD = velocity.Down - truth.Velocity.Down;
+
+    stats.count++;
+    stats.loop_sum_us += loop_us;
+    if (loop_us > stats.loop_max_us) {
+        stats.loop_max_us = loop_us;
+    }
+    stats.att_sum_sq += att_error * att_error;
+    if (att_error > stats.att_max) {
+        stats.att_max = att_error;
+    }
+    stats.pos_sum_sq += dN * dN + dE * dE + dD * dD;
+    stats.vel_sum_sq += vN * vN + vE * vE + vD * vD;
+
+    static float last_report;
+    if (time - last_report < stats_period) {
+        return;
+    }
+    last_report = time;
+
+    printf("SIMSTATS t=%.3f loops=%u loop_avg_us=%.1f loop_max_us=%u att_rms_deg=%.4f att_max_deg=%.4f pos_rms_m=%.4f vel_rms_ms=%.4f\n",
+           (double)time, (unsigned)stats.count, (double)(stats.loop_sum_us / stats.count), (unsigned)stats.loop_max_us,
+           (double)sqrtf(stats.att_sum_sq / stats.count), (double)stats.att_max,
+           (double)sqrtf(stats.pos_sum_sq / stats.count), (double)sqrtf(stats.vel_sum_sq / stats.count));
+    fflush(stdout);
+    memset(&stats, 0, sizeof(stats));
+}
+
+/**
+ * xorshift32, private so that no other user of rand() changes the noise sequence
+ */
+static uint32_t rand_next(void)
+{
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return rand_state;
+}
+
 static float rand_gauss(void)
 {
     float v1, v2, s;
 
     do {
-        v1 = 2.0 * ((float)rand() / RAND_MAX) - 1;
-        v2 = 2.0 * ((float)rand() / RAND_MAX) - 1;
+        v1 = 2.0 * ((float)rand_next() / UINT32_MAX) - 1;
+        v2 = 2.0 * ((float)rand_next() / UINT32_MAX) - 1;
 
         s  = v1 * v1 + v2 * v2;
     } while (s >= 1.0);
@@ -37,6 +37,7 @@
 #include <altitudeholdstatus.h>
 #include <velocitystate.h>
 #include <positionstate.h>
+#include <stabilization.h>
 // Private constants
 
 
@@ -47,10 +48,9 @@
 #define UPDATE_MAX        1.0f
 #define UPDATE_ALPHA      1.0e-2f
 
-#define CALLBACK_PRIORITY CALLBACK_PRIORITY_LOW
-#define CBTASK_PRIORITY   CALLBACK_TASK_FLIGHTCONTROL
+#define CALLBACK_PRIORITY     CALLBACK_PRIORITY_LOW
 
-#define STACK_SIZE_BYTES  512
+#define ALTITUDE_STACK_BYTES  512
 // Private types
 
 // Private variables
@@ -66,6 +66,7 @@ static float startThrust    = 0.5f;
 
 // Private functions
 static void altitudeHoldTask(void);
+static void altitudeHoldStep(bool publish);
 static void SettingsUpdatedCb(UAVObjEvent *ev);
 static void VelocityStateUpdatedCb(UAVObjEvent *ev);
 
@@ -122,6 +123,18 @@ float stabilizationAltitudeHold(float setpoint, ThrustModeType mode, bool reinit
     return thrustDemand;
 }
 
+/**
+ * Setup mode and setpoint and run the loops right away, for the outer loop
+ * running in the inner loop callback. AltitudeHoldStatus is only published
+ * if asked to.
+ */
+float stabilizationAltitudeHoldFused(float setpoint, ThrustModeType mode, bool reinit, bool publish)
+{
+    stabilizationAltitudeHold(setpoint, mode, reinit);
+    altitudeHoldStep(publish);
+    return thrustDemand;
+}
+
 /**
  * Initialise the module, called on startup
  */
@@ -135,7 +148,7 @@ void stabilizationAltitudeloopInit()
     PIOS_DELTATIME_Init(&timeval, UPDATE_EXPECTED, UPDATE_MIN, UPDATE_MAX, UPDATE_ALPHA);
     // Create object queue
 
-    altitudeHoldCBInfo = PIOS_CALLBACKSCHEDULER_Create(&altitudeHoldTask, CALLBACK_PRIORITY, CBTASK_PRIORITY, CALLBACKINFO_RUNNING_ALTITUDEHOLD, STACK_SIZE_BYTES);
+    altitudeHoldCBInfo = PIOS_CALLBACKSCHEDULER_Create(&altitudeHoldTask, CALLBACK_PRIORITY, CBTASK_PRIORITY, CALLBACKINFO_RUNNING_ALTITUDEHOLD, ALTITUDE_STACK_BYTES);
     AltitudeHoldSettingsConnectCallback(&SettingsUpdatedCb);
     VelocityStateConnectCallback(&VelocityStateUpdatedCb);
 
@@ -149,9 +162,12 @@ void stabilizationAltitudeloopInit()
  */
 static void altitudeHoldTask(void)
 {
-    AltitudeHoldStatusData altitudeHoldStatus;
+    altitudeHoldStep(true);
+}
 
-    AltitudeHoldStatusGet(&altitudeHoldStatus);
+static void altitudeHoldStep(bool publish)
+{
+    AltitudeHoldStatusData altitudeHoldStatus;
 
     // do the actual control loop(s)
     float positionStateDown;
@@ -178,7 +194,9 @@ static void altitudeHoldTask(void)
         break;
     }
 
-    AltitudeHoldStatusSet(&altitudeHoldStatus);
+    if (publish) {
+        AltitudeHoldStatusSet(&altitudeHoldStatus);
+    }
 
     switch (thrustMode) {
     case DIRECT:
@@ -206,6 +224,10 @@ static void SettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 
 static void VelocityStateUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
+    if (stabSettings.fused_loops) {
+        // run by the outer loop in the inner loop callback
+        return;
+    }
     PIOS_CALLBACKSCHEDULER_Dispatch(altitudeHoldCBInfo);
 }
 
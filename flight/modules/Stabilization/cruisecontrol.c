@@ -137,7 +137,7 @@ void cruisecontrol_compute_factor(AttitudeStateData *attitude, float thrustDeman
 
         // spherical right triangle
         // 0.0 <= angle <= 180.0
-        angle_unmodified = angle = RAD2DEG(acosf(cos_lookup_deg(attitude->Roll)
+        angle_unmodified = angle = RAD2DEG(fast_acosf(cos_lookup_deg(attitude->Roll)
                                                  * cos_lookup_deg(attitude->Pitch)));
 
         // Calculate rate as a combined (roll and pitch) bank angle
@@ -33,6 +33,9 @@
 #ifndef OUTERLOOP_H
 #define OUTERLOOP_H
 
+#include <ratedesired.h>
+
 void stabilizationOuterloopInit();
+void stabilizationOuterloopFused(RateDesiredData *rateDesired, bool publish);
 
 #endif /* OUTERLOOP_H */
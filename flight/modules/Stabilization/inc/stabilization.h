@@ -35,6 +35,7 @@
 
 #include <openpilot.h>
 #include <pid.h>
+#include <biquad.h>
 #include <stabilizationsettings.h>
 #include <stabilizationbank.h>
 
@@ -45,6 +46,8 @@ typedef struct {
     StabilizationSettingsData settings;
     StabilizationBankData     stabBank;
     float gyro_alpha;
+    struct biquad gyro_notch[3];
+    bool  gyro_notch_enabled;
     struct {
         float min_thrust;
         float max_thrust;
@@ -57,6 +60,8 @@ typedef struct {
         int8_t gyroupdates;
         int8_t rateupdates;
     }     monitor;
+    bool    fused_loops;
+    uint8_t fused_telemetry_divider;
     float rattitude_mode_transition_stick_position;
     struct pid innerPids[3], outerPids[3];
     // TPS [Roll,Pitch,Yaw][P,I,D]
@@ -75,6 +80,13 @@ extern StabilizationData stabSettings;
 #define STACK_SIZE_BYTES    PIOS_STABILIZATION_STACK_SIZE
 #endif
 
+// the outer and altitude loops run on the rate loop's stack when fused
+#ifdef REVOLUTION
+#define FUSED_STACK_SIZE_BYTES 256
+#else
+#define FUSED_STACK_SIZE_BYTES 0
+#endif
+
 // must be same as eventdispatcher to avoid needing additional mutexes
 #define CBTASK_PRIORITY     CALLBACK_TASK_FLIGHTCONTROL
 
@@ -49,6 +49,10 @@
 #include <stabilization.h>
 #include <virtualflybar.h>
 #include <cruisecontrol.h>
+#include <outerloop.h>
+#ifdef PIOS_STABILIZATION_GYRO_DIRECT
+#include <gyrodirect.h>
+#endif
 
 // Private constants
 
@@ -61,15 +65,22 @@
 
 // Private variables
 static DelayedCallbackInfo *callbackHandle;
-static float gyro_filtered[3] = { 0, 0, 0 };
-static float axis_lock_accum[3] = { 0, 0, 0 };
+static float gyro_filtered[3]   __ccm_data;
+static float axis_lock_accum[3] __ccm_data;
 static uint8_t previous_mode[AXES] = { 255, 255, 255, 255 };
 static PiOSDeltatimeConfig timeval;
 static float speedScaleFactor = 1.0f;
+static RateDesiredData fusedRateDesired;
+static uint8_t fusedSkipCount    = 0;
+static uint8_t fusedPublishCount = 0;
 
 // Private functions
 static void stabilizationInnerloopTask();
+#ifdef PIOS_STABILIZATION_GYRO_DIRECT
+static void gyroDirectCb(const float gyro[3]);
+#else
 static void GyroStateUpdatedCb(__attribute__((unused)) UAVObjEvent *ev);
+#endif
 #ifdef REVOLUTION
 static void AirSpeedUpdatedCb(__attribute__((unused)) UAVObjEvent *ev);
 #endif
@@ -90,8 +101,13 @@ void stabilizationInnerloopInit()
 #endif
     PIOS_DELTATIME_Init(&timeval, UPDATE_EXPECTED, UPDATE_MIN, UPDATE_MAX, UPDATE_ALPHA);
 
-    callbackHandle = PIOS_CALLBACKSCHEDULER_Create(&stabilizationInnerloopTask, CALLBACK_PRIORITY, CBTASK_PRIORITY, CALLBACKINFO_RUNNING_STABILIZATION1, STACK_SIZE_BYTES);
+    callbackHandle = PIOS_CALLBACKSCHEDULER_Create(&stabilizationInnerloopTask, CALLBACK_PRIORITY, CBTASK_PRIORITY, CALLBACKINFO_RUNNING_STABILIZATION1, STACK_SIZE_BYTES + FUSED_STACK_SIZE_BYTES);
+#ifdef PIOS_STABILIZATION_GYRO_DIRECT
+    // run the loop in the gyro publisher's context, the callback is only the failsafe
+    gyrodirect_connect(gyroDirectCb);
+#else
     GyroStateConnectCallback(GyroStateUpdatedCb);
+#endif
 
     // schedule dead calls every FAILSAFE_TIMEOUT_MS to have the watchdog cleared
     PIOS_CALLBACKSCHEDULER_Schedule(callbackHandle, FAILSAFE_TIMEOUT_MS, CALLBACK_UPDATEMODE_LATER);
@@ -231,7 +247,24 @@ static void stabilizationInnerloopTask()
     StabilizationStatusInnerLoopData enabled;
     FlightStatusControlChainData cchain;
 
-    RateDesiredGet(&rateDesired);
+    if (stabSettings.fused_loops) {
+        // run the outer loop every OUTERLOOP_SKIPCOUNT gyro updates and
+        // hand its rates over directly, RateDesired is only for telemetry
+        if (fusedSkipCount == 0) {
+            if (++fusedPublishCount >= stabSettings.fused_telemetry_divider) {
+                fusedPublishCount = 0;
+            }
+            stabilizationOuterloopFused(&fusedRateDesired, fusedPublishCount == 0);
+        }
+        if (++fusedSkipCount >= OUTERLOOP_SKIPCOUNT) {
+            fusedSkipCount = 0;
+        }
+        rateDesired = fusedRateDesired;
+    } else {
+        RateDesiredGet(&rateDesired);
+        // pick up where the outer loop callback left off if fused later on
+        fusedRateDesired = rateDesired;
+    }
     ActuatorDesiredGet(&actuator);
     StabilizationStatusInnerLoopGet(&enabled);
     FlightStatusControlChainGet(&cchain);
@@ -241,6 +274,13 @@ static void stabilizationInnerloopTask()
     float dT;
     dT = PIOS_DELTATIME_GetAverageSeconds(&timeval);
 
+    // rate and acro axes are collected here and their pids run together after the mode switch
+    pid_scaler scaler[STABILIZATIONSTATUS_INNERLOOP_THRUST];
+    float pidOutput[STABILIZATIONSTATUS_INNERLOOP_THRUST];
+    float acroStick[STABILIZATIONSTATUS_INNERLOOP_THRUST];
+    uint8_t pidAxes  = 0;
+    uint8_t acroAxes = 0;
+
     for (t = 0; t < AXES; t++) {
         bool reinit = (StabilizationStatusInnerLoopToArray(enabled)[t] != previous_mode[t]);
         previous_mode[t] = StabilizationStatusInnerLoopToArray(enabled)[t];
@@ -271,8 +311,8 @@ static void stabilizationInnerloopTask()
                                  -StabilizationBankMaximumRateToArray(stabSettings.stabBank.MaximumRate)[t],
                                  StabilizationBankMaximumRateToArray(stabSettings.stabBank.MaximumRate)[t]
                                  );
-                pid_scaler scaler = create_pid_scaler(t);
-                actuatorDesiredAxis[t] = pid_apply_setpoint(&stabSettings.innerPids[t], &scaler, rate[t], gyro_filtered[t], dT);
+                scaler[t] = create_pid_scaler(t);
+                pidAxes  |= 1 << t;
                 break;
             case STABILIZATIONSTATUS_INNERLOOP_ACRO:
             {
@@ -284,11 +324,11 @@ static void stabilizationInnerloopTask()
                                  -StabilizationBankMaximumRateToArray(stabSettings.stabBank.MaximumRate)[t],
                                  StabilizationBankMaximumRateToArray(stabSettings.stabBank.MaximumRate)[t]
                                  );
-                pid_scaler ascaler = create_pid_scaler(t);
-                ascaler.i *= boundf(1.0f - (1.5f * fabsf(stickinput[t])), 0.0f, 1.0f); // this prevents Integral from getting too high while controlled manually
-                float arate  = pid_apply_setpoint(&stabSettings.innerPids[t], &ascaler, rate[t], gyro_filtered[t], dT);
-                float factor = fabsf(stickinput[t]) * stabSettings.stabBank.AcroInsanityFactor;
-                actuatorDesiredAxis[t] = factor * stickinput[t] + (1.0f - factor) * arate;
+                scaler[t]    = create_pid_scaler(t);
+                scaler[t].i *= boundf(1.0f - (1.5f * fabsf(stickinput[t])), 0.0f, 1.0f); // this prevents Integral from getting too high while controlled manually
+                acroStick[t] = stickinput[t];
+                pidAxes     |= 1 << t;
+                acroAxes    |= 1 << t;
             }
             break;
             case STABILIZATIONSTATUS_INNERLOOP_DIRECT:
@@ -307,7 +347,19 @@ static void stabilizationInnerloopTask()
                 break;
             }
         }
+    }
+
+    pid_apply_setpoint_batch(stabSettings.innerPids, scaler, rate, gyro_filtered, pidOutput, STABILIZATIONSTATUS_INNERLOOP_THRUST, pidAxes, dT);
+    for (t = 0; t < STABILIZATIONSTATUS_INNERLOOP_THRUST; t++) {
+        if (acroAxes & (1 << t)) {
+            float factor = fabsf(acroStick[t]) * stabSettings.stabBank.AcroInsanityFactor;
+            actuatorDesiredAxis[t] = factor * acroStick[t] + (1.0f - factor) * pidOutput[t];
+        } else if (pidAxes & (1 << t)) {
+            actuatorDesiredAxis[t] = pidOutput[t];
+        }
+    }
 
+    for (t = 0; t < AXES; t++) {
         actuatorDesiredAxis[t] = boundf(actuatorDesiredAxis[t], -1.0f, 1.0f);
     }
 
@@ -350,6 +402,32 @@ static void stabilizationInnerloopTask()
 }
 
 
+static inline void applyGyroNotch()
+{
+    if (stabSettings.gyro_notch_enabled) {
+        for (int t = 0; t < 3; t++) {
+            gyro_filtered[t] = biquad_apply(&stabSettings.gyro_notch[t], gyro_filtered[t]);
+        }
+    }
+}
+
+#ifdef PIOS_STABILIZATION_GYRO_DIRECT
+/**
+ * Runs the inner loop in the sensor task for every gyro sample, skipping the
+ * GyroState event and the callback dispatch. The scheduled failsafe callback
+ * only fires if no sample arrived for FAILSAFE_TIMEOUT_MS.
+ */
+static void gyroDirectCb(const float gyro[3])
+{
+    gyro_filtered[0] = gyro_filtered[0] * stabSettings.gyro_alpha + gyro[0] * (1 - stabSettings.gyro_alpha);
+    gyro_filtered[1] = gyro_filtered[1] * stabSettings.gyro_alpha + gyro[1] * (1 - stabSettings.gyro_alpha);
+    gyro_filtered[2] = gyro_filtered[2] * stabSettings.gyro_alpha + gyro[2] * (1 - stabSettings.gyro_alpha);
+    applyGyroNotch();
+
+    stabSettings.monitor.gyroupdates = 1;
+    stabilizationInnerloopTask();
+}
+#else /* PIOS_STABILIZATION_GYRO_DIRECT */
 static void GyroStateUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
     GyroStateData gyroState;
@@ -359,10 +437,12 @@ static void GyroStateUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
     gyro_filtered[0] = gyro_filtered[0] * stabSettings.gyro_alpha + gyroState.x * (1 - stabSettings.gyro_alpha);
     gyro_filtered[1] = gyro_filtered[1] * stabSettings.gyro_alpha + gyroState.y * (1 - stabSettings.gyro_alpha);
     gyro_filtered[2] = gyro_filtered[2] * stabSettings.gyro_alpha + gyroState.z * (1 - stabSettings.gyro_alpha);
+    applyGyroNotch();
 
     PIOS_CALLBACKSCHEDULER_Dispatch(callbackHandle);
     stabSettings.monitor.gyroupdates++;
 }
+#endif /* PIOS_STABILIZATION_GYRO_DIRECT */
 
 #ifdef REVOLUTION
 static void AirSpeedUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
@@ -47,6 +47,7 @@
 #include <cruisecontrol.h>
 #include <altitudeloop.h>
 #include <CoordinateConversions.h>
+#include <outerloop.h>
 
 // Private constants
 
@@ -66,6 +67,7 @@ static PiOSDeltatimeConfig timeval;
 
 // Private functions
 static void stabilizationOuterloopTask();
+static void stabilizationOuterloopStep(RateDesiredData *rateDesired, bool fused, bool publish);
 static void AttitudeStateUpdatedCb(__attribute__((unused)) UAVObjEvent *ev);
 
 void stabilizationOuterloopInit()
@@ -91,17 +93,32 @@ void stabilizationOuterloopInit()
  */
 static void stabilizationOuterloopTask()
 {
-    AttitudeStateData attitudeState;
     RateDesiredData rateDesired;
+
+    RateDesiredGet(&rateDesired);
+    stabilizationOuterloopStep(&rateDesired, false, true);
+}
+
+/**
+ * Runs the outer loop from the inner loop callback, the rates are handed over
+ * in rateDesired and only published to RateDesired for telemetry if asked to.
+ */
+void stabilizationOuterloopFused(RateDesiredData *rateDesired, bool publish)
+{
+    stabilizationOuterloopStep(rateDesired, true, publish);
+}
+
+static void stabilizationOuterloopStep(RateDesiredData *rateDesired, bool fused, bool publish)
+{
+    AttitudeStateData attitudeState;
     StabilizationDesiredData stabilizationDesired;
     StabilizationStatusOuterLoopData enabled;
 
     AttitudeStateGet(&attitudeState);
     StabilizationDesiredGet(&stabilizationDesired);
-    RateDesiredGet(&rateDesired);
     StabilizationStatusOuterLoopGet(&enabled);
     float *stabilizationDesiredAxis = &stabilizationDesired.Roll;
-    float *rateDesiredAxis = &rateDesired.Roll;
+    float *rateDesiredAxis = &rateDesired->Roll;
     int t;
     float dT = PIOS_DELTATIME_GetAverageSeconds(&timeval);
 
@@ -127,11 +144,11 @@ static void stabilizationOuterloopTask()
             }
         }
 
-        RPY2Quaternion(rpy_desired, q_desired);
+        RPY2QuaternionFast(rpy_desired, q_desired);
         quat_inverse(q_desired);
         quat_mult(q_desired, &attitudeState.q1, q_error);
         quat_inverse(q_error);
-        Quaternion2RPY(q_error, local_error);
+        Quaternion2RPYFast(q_error, local_error);
 
 #else /* if defined(PIOS_QUATERNION_STABILIZATION) */
         // Simpler algorithm for CC, less memory
@@ -248,10 +265,14 @@ static void stabilizationOuterloopTask()
             switch (StabilizationStatusOuterLoopToArray(enabled)[t]) {
 #ifdef REVOLUTION
             case STABILIZATIONSTATUS_OUTERLOOP_ALTITUDE:
-                rateDesiredAxis[t] = stabilizationAltitudeHold(stabilizationDesiredAxis[t], ALTITUDEHOLD, reinit);
+                rateDesiredAxis[t] = fused ?
+                                     stabilizationAltitudeHoldFused(stabilizationDesiredAxis[t], ALTITUDEHOLD, reinit, publish) :
+                                     stabilizationAltitudeHold(stabilizationDesiredAxis[t], ALTITUDEHOLD, reinit);
                 break;
             case STABILIZATIONSTATUS_OUTERLOOP_ALTITUDEVARIO:
-                rateDesiredAxis[t] = stabilizationAltitudeHold(stabilizationDesiredAxis[t], ALTITUDEVARIO, reinit);
+                rateDesiredAxis[t] = fused ?
+                                     stabilizationAltitudeHoldFused(stabilizationDesiredAxis[t], ALTITUDEVARIO, reinit, publish) :
+                                     stabilizationAltitudeHold(stabilizationDesiredAxis[t], ALTITUDEVARIO, reinit);
                 break;
 #endif /* REVOLUTION */
             case STABILIZATIONSTATUS_OUTERLOOP_DIRECT:
@@ -262,7 +283,9 @@ static void stabilizationOuterloopTask()
         }
     }
 
-    RateDesiredSet(&rateDesired);
+    if (publish) {
+        RateDesiredSet(rateDesired);
+    }
     {
         uint8_t armed;
         FlightStatusArmedGet(&armed);
@@ -278,7 +301,7 @@ static void stabilizationOuterloopTask()
     }
 
     // update cruisecontrol based on attitude
-    cruisecontrol_compute_factor(&attitudeState, rateDesired.Thrust);
+    cruisecontrol_compute_factor(&attitudeState, rateDesired->Thrust);
     stabSettings.monitor.rateupdates = 0;
 }
 
@@ -288,6 +311,10 @@ static void AttitudeStateUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
     // to reduce CPU utilization, outer loop is not executed on every state update
     static uint8_t cpusaver = 0;
 
+    if (stabSettings.fused_loops) {
+        // the inner loop runs the outer loop itself
+        return;
+    }
     if ((cpusaver++ % OUTERLOOP_SKIPCOUNT) == 0) {
         // this does not need mutex protection as both eventdispatcher and stabi run in same callback task!
         AttitudeStateGet(&attitude);
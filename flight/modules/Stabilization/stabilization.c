@@ -52,7 +52,7 @@
 
 
 // Public variables
-StabilizationData stabSettings;
+StabilizationData stabSettings __ccm_data;
 
 // Private variables
 static int cur_flight_mode = -1;
@@ -360,9 +360,33 @@ static void SettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
         stabSettings.gyro_alpha = expf(-fakeDt / stabSettings.settings.GyroTau);
     }
 
+    // the inner loop runs once per gyro sample, move a running notch without resetting it
+    const float notchCenter = stabSettings.settings.GyroNotch.Center;
+    const float notchWidth  = stabSettings.settings.GyroNotch.Width;
+    if (notchCenter > 0.0f && notchCenter < 0.5f * PIOS_SENSOR_RATE && notchWidth > 0.0f) {
+        for (int axis = 0; axis < 3; axis++) {
+            if (stabSettings.gyro_notch_enabled) {
+                biquad_update_notch(&stabSettings.gyro_notch[axis], notchCenter / PIOS_SENSOR_RATE, notchCenter / notchWidth);
+            } else {
+                biquad_init_notch(&stabSettings.gyro_notch[axis], notchCenter / PIOS_SENSOR_RATE, notchCenter / notchWidth);
+            }
+        }
+        stabSettings.gyro_notch_enabled = true;
+    } else {
+        stabSettings.gyro_notch_enabled = false;
+    }
+
     // force flight mode update
     cur_flight_mode = -1;
 
+#ifdef REVOLUTION
+    stabSettings.fused_loops = (stabSettings.settings.FusedLoops == STABILIZATIONSETTINGS_FUSEDLOOPS_TRUE);
+#else
+    // not enough stack on the smaller targets to run the outer loop in the rate loop
+    stabSettings.fused_loops = false;
+#endif
+    stabSettings.fused_telemetry_divider = stabSettings.settings.FusedLoopsTelemetryDivider > 0 ? stabSettings.settings.FusedLoopsTelemetryDivider : 1;
+
     // Rattitude stick angle where the attitude to rate transition happens
     if (stabSettings.settings.RattitudeModeTransition < (uint8_t)10) {
         stabSettings.rattitude_mode_transition_stick_position = 10.0f / 100.0f;
@@ -47,6 +47,9 @@ struct data {
     float altitude;
 };
 
+// filter state
+static struct data filterData __ccm_data;
+
 // Private functions
 
 static int32_t init(stateFilter *self);
@@ -57,7 +60,7 @@ int32_t filterAirInitialize(stateFilter *handle)
 {
     handle->init      = &init;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
+    handle->localdata = &filterData;
     return STACK_REQUIRED;
 }
 
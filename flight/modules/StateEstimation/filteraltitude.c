@@ -69,6 +69,9 @@ struct data {
     float gravity;
 };
 
+// filter state
+static struct data filterData __ccm_data;
+
 // Private variables
 
 // Private functions
@@ -82,7 +85,7 @@ int32_t filterAltitudeInitialize(stateFilter *handle)
 {
     handle->init      = &init;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
+    handle->localdata = &filterData;
     HomeLocationInitialize();
     AttitudeStateInitialize();
     AltitudeFilterSettingsInitialize();
@@ -49,6 +49,9 @@ struct data {
     bool    useGPS;
 };
 
+// filter state, shared by all variants since only one filter chain runs at a time
+static struct data filterData __ccm_data;
+
 // Private variables
 
 // Private functions
@@ -63,7 +66,7 @@ int32_t filterBaroInitialize(stateFilter *handle)
 {
     handle->init      = &initwithgps;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
+    handle->localdata = &filterData;
     return STACK_REQUIRED;
 }
 
@@ -71,7 +74,7 @@ int32_t filterBaroiInitialize(stateFilter *handle)
 {
     handle->init      = &initwithoutgps;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
+    handle->localdata = &filterData;
     return STACK_REQUIRED;
 }
 
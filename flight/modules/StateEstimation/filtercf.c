@@ -72,6 +72,9 @@ struct data {
     bool    magCalibrated;
 };
 
+// filter state, shared by all variants since only one filter chain runs at a time
+static struct data filterData __ccm_data;
+
 // Private variables
 bool initialized = 0;
 static FlightStatusData flightStatus;
@@ -106,7 +109,7 @@ int32_t filterCFInitialize(stateFilter *handle)
     globalInit();
     handle->init      = &initwithoutmag;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
+    handle->localdata = &filterData;
     return STACK_REQUIRED;
 }
 
@@ -115,7 +118,7 @@ int32_t filterCFMInitialize(stateFilter *handle)
     globalInit();
     handle->init      = &initwithmag;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
+    handle->localdata = &filterData;
     return STACK_REQUIRED;
 }
 
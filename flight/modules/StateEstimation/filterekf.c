@@ -37,18 +37,31 @@
 #include <attitudestate.h>
 #include <systemalarms.h>
 #include <homelocation.h>
+#include <gpspositionsensor.h>
+#include <gpsvelocitysensor.h>
 
 #include <insgps.h>
 #include <CoordinateConversions.h>
 
+#define PIOS_INSTRUMENT_MODULE
+#include <pios_instrumentation_helper.h>
+
+PERF_DEFINE_COUNTER(counterEKFCovariance);
+PERF_DEFINE_COUNTER(counterEKFCorrection);
+PERF_DEFINE_PROFILE(profileEKFFilter);
+
 // Private constants
 
-#define STACK_REQUIRED 2048
+#define STACK_REQUIRED 3600
 #define DT_ALPHA       1e-3f
 #define DT_MIN         1e-6f
 #define DT_MAX         1.0f
 #define DT_INIT        (1.0f / PIOS_SENSOR_RATE) // initialize with board sensor rate
 
+// predicted states kept to compare the delayed GPS solutions with, 320ms worth
+#define HISTORY_LENGTH    64
+#define HISTORY_PERIOD_US 5000
+
 #define IMPORT_SENSOR_IF_UPDATED(shortname, num) \
     if (IS_SET(state->updated, SENSORUPDATES_##shortname)) { \
         uint8_t t; \
@@ -58,14 +71,29 @@
     }
 
 // Private types
+struct history {
+    uint32_t time; // PIOS_DELAY_GetuS() of the prediction
+    float    pos[3];
+    float    vel[3];
+};
+
 struct data {
     EKFConfigurationData ekfConfiguration;
     HomeLocationData     homeLocation;
 
     bool    usePos;
+    uint8_t num_states;
 
     int32_t init_stage;
 
+    // gyro updates since the last covariance prediction
+    uint8_t covariance_count;
+
+    // ring of past predictions, history_head is the next slot written
+    struct history history[HISTORY_LENGTH];
+    uint8_t history_head;
+    uint8_t history_count;
+
     stateEstimation work;
 
     bool inited;
@@ -73,6 +101,9 @@ struct data {
     PiOSDeltatimeConfig dtconfig;
 };
 
+// filter state, shared by all variants since only one filter chain runs at a time
+static struct data filterData __ccm_data;
+
 // Private variables
 static bool initialized = 0;
 
@@ -81,9 +112,13 @@ static bool initialized = 0;
 
 static int32_t init13i(stateFilter *self);
 static int32_t init13(stateFilter *self);
+static int32_t init16i(stateFilter *self);
+static int32_t init16(stateFilter *self);
 static int32_t maininit(stateFilter *self);
 static filterResult filter(stateFilter *self, stateEstimation *state);
 static inline bool invalid_var(float data);
+static void historyAdd(struct data *this, uint32_t now);
+static void delayCompensate(struct data *this, float *measurement, bool velocity, uint32_t rxTime, uint32_t now);
 
 static void globalInit(void);
 
@@ -95,6 +130,9 @@ static void globalInit(void)
         EKFConfigurationInitialize();
         EKFStateVarianceInitialize();
         HomeLocationInitialize();
+        PERF_INIT_COUNTER(counterEKFCovariance, 0xE6F00001);
+        PERF_INIT_COUNTER(counterEKFCorrection, 0xE6F00002);
+        PERF_INIT_PROFILE(profileEKFFilter, 0xE6F00003);
     }
 }
 
@@ -103,7 +141,7 @@ int32_t filterEKF13iInitialize(stateFilter *handle)
     globalInit();
     handle->init      = &init13i;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
+    handle->localdata = &filterData;
     return STACK_REQUIRED;
 }
 int32_t filterEKF13Initialize(stateFilter *handle)
@@ -111,26 +149,23 @@ int32_t filterEKF13Initialize(stateFilter *handle)
     globalInit();
     handle->init      = &init13;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
+    handle->localdata = &filterData;
     return STACK_REQUIRED;
 }
-// XXX
-// TODO: Until the 16 state EKF is implemented, run 13 state, so compilation runs through
-// XXX
 int32_t filterEKF16iInitialize(stateFilter *handle)
 {
     globalInit();
-    handle->init      = &init13i;
+    handle->init      = &init16i;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
+    handle->localdata = &filterData;
     return STACK_REQUIRED;
 }
 int32_t filterEKF16Initialize(stateFilter *handle)
 {
     globalInit();
-    handle->init      = &init13;
+    handle->init      = &init16;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
+    handle->localdata = &filterData;
     return STACK_REQUIRED;
 }
 
@@ -139,7 +174,8 @@ static int32_t init13i(stateFilter *self)
 {
     struct data *this = (struct data *)self->localdata;
 
-    this->usePos = 0;
+    this->usePos     = 0;
+    this->num_states = INSGPS_13STATE;
     return maininit(self);
 }
 
@@ -147,7 +183,26 @@ static int32_t init13(stateFilter *self)
 {
     struct data *this = (struct data *)self->localdata;
 
-    this->usePos = 1;
+    this->usePos     = 1;
+    this->num_states = INSGPS_13STATE;
+    return maininit(self);
+}
+
+static int32_t init16i(stateFilter *self)
+{
+    struct data *this = (struct data *)self->localdata;
+
+    this->usePos     = 0;
+    this->num_states = INSGPS_16STATE;
+    return maininit(self);
+}
+
+static int32_t init16(stateFilter *self)
+{
+    struct data *this = (struct data *)self->localdata;
+
+    this->usePos     = 1;
+    this->num_states = INSGPS_16STATE;
     return maininit(self);
 }
 
@@ -158,6 +213,9 @@ static int32_t maininit(stateFilter *self)
     this->inited       = false;
     this->init_stage   = 0;
     this->work.updated = 0;
+    this->covariance_count = 0;
+    this->history_head     = 0;
+    this->history_count    = 0;
     PIOS_DELTATIME_Init(&this->dtconfig, DT_INIT, DT_MIN, DT_MAX, DT_ALPHA);
 
     EKFConfigurationGet(&this->ekfConfiguration);
@@ -194,6 +252,7 @@ static int32_t maininit(stateFilter *self)
  */
 static filterResult filter(stateFilter *self, stateEstimation *state)
 {
+    PERF_PROFILE_SCOPE(profileEKFFilter);
     struct data *this    = (struct data *)self->localdata;
 
     const float zeros[3] = { 0.0f, 0.0f, 0.0f };
@@ -239,7 +298,8 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
         // Don't initialize until all sensors are read
         if (this->init_stage == 0) {
             // Reset the INS algorithm
-            INSGPSInit();
+            INSGPSInit(this->num_states);
+            INSSetUDFactorization(this->ekfConfiguration.CovarianceFactorization == EKFCONFIGURATION_COVARIANCEFACTORIZATION_UD);
             // variance is measured in mGaus, but internally the EKF works with a normalized  vector. Scale down by Be^2
             float Be2 = this->homeLocation.Be[0] * this->homeLocation.Be[0] + this->homeLocation.Be[1] * this->homeLocation.Be[1] + this->homeLocation.Be[2] * this->homeLocation.Be[2];
             INSSetMagVar((float[3]) { this->ekfConfiguration.R.MagX / Be2,
@@ -258,6 +318,10 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
                                            this->ekfConfiguration.Q.GyroDriftY,
                                            this->ekfConfiguration.Q.GyroDriftZ }
                               );
+            INSSetAccelBiasVar((float[3]) { this->ekfConfiguration.Q.AccelDriftX,
+                                            this->ekfConfiguration.Q.AccelDriftY,
+                                            this->ekfConfiguration.Q.AccelDriftZ }
+                               );
             INSSetBaroVar(this->ekfConfiguration.R.BaroZ);
 
             // Initialize the gyro bias
@@ -336,6 +400,9 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
     // Advance the state estimate
     INSStatePrediction(gyros, this->work.accel, dT);
 
+    uint32_t now = PIOS_DELAY_GetuS();
+    historyAdd(this, now);
+
     // Copy the attitude into the state
     // NOTE: updating gyr correctly is valid, because this code is reached only when SENSORUPDATES_gyro is already true
     state->attitude[0] = Nav.q[0];
@@ -345,6 +412,12 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
     state->gyro[0]    -= RAD2DEG(Nav.gyro_bias[0]);
     state->gyro[1]    -= RAD2DEG(Nav.gyro_bias[1]);
     state->gyro[2]    -= RAD2DEG(Nav.gyro_bias[2]);
+    if (IS_SET(state->updated, SENSORUPDATES_accel)) {
+        // the accel bias stays zero with 13 states
+        state->accel[0] -= Nav.accel_bias[0];
+        state->accel[1] -= Nav.accel_bias[1];
+        state->accel[2] -= Nav.accel_bias[2];
+    }
     state->pos[0]   = Nav.Pos[0];
     state->pos[1]   = Nav.Pos[1];
     state->pos[2]   = Nav.Pos[2];
@@ -353,8 +426,23 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
     state->vel[2]   = Nav.Vel[2];
     state->updated |= SENSORUPDATES_attitude | SENSORUPDATES_pos | SENSORUPDATES_vel;
 
-    // Advance the covariance estimate
-    INSCovariancePrediction(dT);
+    // Advance the covariance estimate, either on every gyro update or decimated
+    // with the state transition accumulated in between
+    if (this->ekfConfiguration.CovarianceDecimation <= 1) {
+        PERF_TIMED_SECTION_START(counterEKFCovariance);
+        INSCovariancePrediction(dT);
+        PERF_TIMED_SECTION_END(counterEKFCovariance);
+    } else {
+        INSAccumulateTransition(dT);
+        if (++this->covariance_count < this->ekfConfiguration.CovarianceDecimation) {
+            // keep collecting sensor updates for the next correction
+            return FILTERRESULT_OK;
+        }
+        this->covariance_count = 0;
+        PERF_TIMED_SECTION_START(counterEKFCovariance);
+        INSAccumulatedCovariancePrediction();
+        PERF_TIMED_SECTION_END(counterEKFCovariance);
+    }
 
     if (IS_SET(this->work.updated, SENSORUPDATES_mag)) {
         sensors |= MAG_SENSORS;
@@ -388,10 +476,20 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
 
     if (IS_SET(this->work.updated, SENSORUPDATES_pos)) {
         sensors |= POS_SENSORS;
+        if (this->usePos) {
+            uint32_t rxTime;
+            GPSPositionSensorRxTimeGet(&rxTime);
+            delayCompensate(this, this->work.pos, false, rxTime, now);
+        }
     }
 
     if (IS_SET(this->work.updated, SENSORUPDATES_vel)) {
         sensors |= HORIZ_SENSORS | VERT_SENSORS;
+        if (this->usePos) {
+            uint32_t rxTime;
+            GPSVelocitySensorRxTimeGet(&rxTime);
+            delayCompensate(this, this->work.vel, true, rxTime, now);
+        }
     }
 
     if (IS_SET(this->work.updated, SENSORUPDATES_airspeed) && ((!IS_SET(this->work.updated, SENSORUPDATES_vel) && !IS_SET(this->work.updated, SENSORUPDATES_pos)) | !this->usePos)) {
@@ -416,7 +514,9 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
      * although probably should occur within INS itself
      */
     if (sensors) {
+        PERF_TIMED_SECTION_START(counterEKFCorrection);
         INSCorrection(this->work.mag, this->work.pos, this->work.vel, this->work.baro[0], sensors);
+        PERF_TIMED_SECTION_END(counterEKFCorrection);
     }
 
     EKFStateVarianceData vardata;
@@ -424,7 +524,7 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
     INSGetP(EKFStateVariancePToArray(vardata.P));
     EKFStateVarianceSet(&vardata);
     int t;
-    for (t = 0; t < EKFSTATEVARIANCE_P_NUMELEM; t++) {
+    for (t = 0; t < ins_get_num_states(); t++) {
         if (!IS_REAL(EKFStateVariancePToArray(vardata.P)[t]) || EKFStateVariancePToArray(vardata.P)[t] <= 0.0f) {
             INSResetP(EKFConfigurationPToArray(this->ekfConfiguration.P));
             this->init_stage = -1;
@@ -442,6 +542,63 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
     }
 }
 
+/**
+ * Keep the predicted position and velocity, one every HISTORY_PERIOD_US
+ */
+static void historyAdd(struct data *this, uint32_t now)
+{
+    if (this->history_count) {
+        const struct history *last = &this->history[(this->history_head + HISTORY_LENGTH - 1) % HISTORY_LENGTH];
+        if (now - last->time < HISTORY_PERIOD_US) {
+            return;
+        }
+    }
+    struct history *entry = &this->history[this->history_head];
+    entry->time = now;
+    for (uint8_t t = 0; t < 3; t++) {
+        entry->pos[t] = Nav.Pos[t];
+        entry->vel[t] = Nav.Vel[t];
+    }
+    this->history_head = (this->history_head + 1) % HISTORY_LENGTH;
+    if (this->history_count < HISTORY_LENGTH) {
+        this->history_count++;
+    }
+}
+
+/**
+ * Shift a GPS measurement to the current time. The solution describes the
+ * vehicle when the receiver computed it, EKFConfiguration.GPSDelay before the
+ * UART finished receiving it at rxTime. The difference between the measurement and the
+ * state predicted back then is what the correction must see, so the motion
+ * predicted since is added to the measurement. This is the delayed innovation
+ * applied to the current state, it costs no re-propagation of the covariance.
+ * Measurements older than the history are left as they are.
+ */
+static void delayCompensate(struct data *this, float *measurement, bool velocity, uint32_t rxTime, uint32_t now)
+{
+    uint32_t age = (uint32_t)this->ekfConfiguration.GPSDelay * 1000;
+
+    if (rxTime) {
+        age += now - rxTime;
+    }
+    if (age == 0) {
+        return;
+    }
+
+    // newest prediction at or before the measurement epoch
+    for (uint8_t i = 1; i <= this->history_count; i++) {
+        const struct history *entry = &this->history[(this->history_head + HISTORY_LENGTH - i) % HISTORY_LENGTH];
+        if (now - entry->time >= age) {
+            const float *then = velocity ? entry->vel : entry->pos;
+            const float *current = velocity ? Nav.Vel : Nav.Pos;
+            for (uint8_t t = 0; t < 3; t++) {
+                measurement[t] += current[t] - then[t];
+            }
+            return;
+        }
+    }
+}
+
 // check for invalid variance values
 static inline bool invalid_var(float data)
 {
@@ -0,0 +1,270 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotModules OpenPilot Modules
+ * @{
+ * @addtogroup State Estimation
+ * @brief Acquires sensor data and computes state estimate
+ * @{
+ *
+ * @file       filterfast.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Attitude only complementary filter, gyros and accels, meant to
+ *             run alone in its chain on every gyro update.
+ *             WARNING: Same caveat as filtercf.c, no mag so the yaw drifts
+ *             and the attitude is off while the acceleration isn't gravity.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ ******************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "inc/stateestimation.h"
+
+#include <attitudesettings.h>
+#include <flightstatus.h>
+
+#include <CoordinateConversions.h>
+#include <pios_notify.h>
+
+// Private constants
+
+#define STACK_REQUIRED          128
+
+#define CALIBRATION_DELAY_MS    4000
+#define CALIBRATION_DURATION_MS 6000
+
+// Private types
+struct data {
+    float   q[4];
+    float   gyroBias[3];
+    float   currentAccel[3];
+    float   accelKp;
+    float   accelKi;
+    float   rollPitchBiasRate;
+    int32_t timeval;
+    int32_t starttime;
+    uint8_t zeroDuringArming;
+    bool    accelUpdated;
+    bool    first_run;
+    bool    init;
+};
+
+// Private variables
+static struct data filterData __ccm_data;
+static bool initialized = 0;
+static uint8_t armed;
+
+// Private functions
+
+static int32_t init(stateFilter *self);
+static filterResult filter(stateFilter *self, stateEstimation *state);
+static filterResult fastFilter(struct data *this, float gyro[3], const float accel[3]);
+static void loadSettings(struct data *this);
+
+static void flightStatusUpdatedCb(UAVObjEvent *ev);
+
+
+int32_t filterFastInitialize(stateFilter *handle)
+{
+    if (!initialized) {
+        initialized = 1;
+        FlightStatusInitialize();
+        FlightStatusConnectCallbackFields(&flightStatusUpdatedCb, FlightStatusFieldMask(Armed));
+        flightStatusUpdatedCb(NULL);
+    }
+    handle->init      = &init;
+    handle->filter    = &filter;
+    handle->localdata = &filterData;
+    return STACK_REQUIRED;
+}
+
+static int32_t init(stateFilter *self)
+{
+    struct data *this = (struct data *)self->localdata;
+
+    this->first_run    = 1;
+    this->accelUpdated = 0;
+    this->init = 0;
+    loadSettings(this);
+
+    this->gyroBias[0]  = 0.0f;
+    this->gyroBias[1]  = 0.0f;
+    this->gyroBias[2]  = 0.0f;
+
+    return 0;
+}
+
+static void loadSettings(struct data *this)
+{
+    AttitudeSettingsData attitudeSettings;
+
+    AttitudeSettingsGet(&attitudeSettings);
+    this->accelKp = attitudeSettings.AccelKp;
+    this->accelKi = attitudeSettings.AccelKi;
+    this->zeroDuringArming  = attitudeSettings.ZeroDuringArming;
+    this->rollPitchBiasRate = 0.0f;
+}
+
+/**
+ * Keep the latest accel, step the attitude on every gyro update
+ */
+static filterResult filter(stateFilter *self, stateEstimation *state)
+{
+    struct data *this   = (struct data *)self->localdata;
+
+    filterResult result = FILTERRESULT_OK;
+
+    if (IS_SET(state->updated, SENSORUPDATES_accel)) {
+        this->accelUpdated    = 1;
+        this->currentAccel[0] = state->accel[0];
+        this->currentAccel[1] = state->accel[1];
+        this->currentAccel[2] = state->accel[2];
+    }
+    if (IS_SET(state->updated, SENSORUPDATES_gyro) && this->accelUpdated) {
+        result = fastFilter(this, state->gyro, this->currentAccel);
+        if (result == FILTERRESULT_OK || result == FILTERRESULT_CRITICAL) {
+            state->attitude[0] = this->q[0];
+            state->attitude[1] = this->q[1];
+            state->attitude[2] = this->q[2];
+            state->attitude[3] = this->q[3];
+            state->updated    |= SENSORUPDATES_attitude;
+        }
+    }
+    return result;
+}
+
+/**
+ * The filter of filtercf.c without mag and with its gains, so the same
+ * AttitudeSettings carry over. The attitude is kept here rather than read
+ * back from AttitudeState, and the correction and the quaternion step are
+ * written out so that there are no branches between the gyro sample and the
+ * new attitude.
+ */
+static filterResult fastFilter(struct data *this, float gyro[3], const float accel[3])
+{
+    float *q = this->q;
+
+    if (this->first_run) {
+        // roll and pitch from the accels, there is nothing to tell the yaw
+        float rpy[3];
+        rpy[0] = RAD2DEG(atan2f(-accel[1], -accel[2]));
+        rpy[1] = RAD2DEG(atan2f(accel[0], sqrtf(accel[1] * accel[1] + accel[2] * accel[2])));
+        rpy[2] = 0.0f;
+        RPY2Quaternion(rpy, q);
+
+        this->first_run = 0;
+        this->timeval   = PIOS_DELAY_GetRaw(); // Cycle counter used for precise timing
+        this->starttime = xTaskGetTickCount(); // Tick counter used for long time intervals
+
+        return FILTERRESULT_OK; // must return OK on initial initialization, so attitude will init with a valid quaternion
+    }
+
+    if (this->init == 0 && xTaskGetTickCount() - this->starttime < CALIBRATION_DELAY_MS / portTICK_RATE_MS) {
+        // wait 4 seconds for the user to get his hands off in case the board was just powered
+        this->timeval = PIOS_DELAY_GetRaw();
+        return FILTERRESULT_ERROR;
+    } else if ((this->init == 0 && xTaskGetTickCount() - this->starttime < (CALIBRATION_DELAY_MS + CALIBRATION_DURATION_MS) / portTICK_RATE_MS) ||
+               (this->zeroDuringArming == ATTITUDESETTINGS_ZERODURINGARMING_TRUE && armed == FLIGHTSTATUS_ARMED_ARMING)) {
+        // level on the accels and take the gyro bias from the mean rate
+        this->accelKp = 1.0f;
+        this->accelKi = 0.0f;
+        this->rollPitchBiasRate = 0.01f;
+        this->init    = 0;
+        PIOS_NOTIFY_StartNotification(NOTIFY_DRAW_ATTENTION, NOTIFY_PRIORITY_REGULAR);
+    } else if (this->init == 0) {
+        loadSettings(this);
+        this->init = 1;
+    }
+
+    // Compute the dT using the cpu clock
+    float dT = PIOS_DELAY_DiffuS(this->timeval) * 1e-6f;
+    this->timeval = PIOS_DELAY_GetRaw();
+    if (dT < 0.0001f) { // safe bounds
+        dT = 0.0001f;
+    }
+
+    const float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+
+    // Gravity in body frame crossed with the accels, both normalized
+    const float gx = -2.0f * (q1 * q3 - q0 * q2);
+    const float gy = -2.0f * (q2 * q3 + q0 * q1);
+    const float gz = -(q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3);
+
+    const float accel_mag_sq = accel[0] * accel[0] + accel[1] * accel[1] + accel[2] * accel[2];
+    if (accel_mag_sq < 1.0e-6f) {
+        return FILTERRESULT_CRITICAL; // safety feature copied from CC
+    }
+    const float invAccel = 1.0f / sqrtf(accel_mag_sq);
+    const float ex = (accel[1] * gz - accel[2] * gy) * invAccel;
+    const float ey = (accel[2] * gx - accel[0] * gz) * invAccel;
+    const float ez = (accel[0] * gy - accel[1] * gx) * invAccel;
+
+    // Correct rates based on integral coefficient
+    gyro[0] -= this->gyroBias[0];
+    gyro[1] -= this->gyroBias[1];
+    gyro[2] -= this->gyroBias[2];
+
+    // Accumulate integral of error, the yaw bias only from the mean rate
+    this->gyroBias[0] -= ex * this->accelKi - gyro[0] * this->rollPitchBiasRate;
+    this->gyroBias[1] -= ey * this->accelKi - gyro[1] * this->rollPitchBiasRate;
+    this->gyroBias[2] += gyro[2] * this->rollPitchBiasRate;
+
+    // Proportional correction, then half the rotation of this step in rad
+    const float kp = this->accelKp / dT;
+    const float hdT = DEG2RAD(0.5f) * dT;
+    const float hx = (gyro[0] + ex * kp) * hdT;
+    const float hy = (gyro[1] + ey * kp) * hdT;
+    const float hz = (gyro[2] + ez * kp) * hdT;
+
+    // q = q + qdot*dT, qdot from the INSAlgo writeup
+    float n0 = q0 - q1 * hx - q2 * hy - q3 * hz;
+    float n1 = q1 + q0 * hx - q3 * hy + q2 * hz;
+    float n2 = q2 + q3 * hx + q0 * hy - q1 * hz;
+    float n3 = q3 - q2 * hx + q1 * hy + q0 * hz;
+
+    const float qmag_sq = n0 * n0 + n1 * n1 + n2 * n2 + n3 * n3;
+
+    // If quaternion has become inappropriately short or is nan reinit.
+    // THIS SHOULD NEVER ACTUALLY HAPPEN
+    if (!(qmag_sq > 1.0e-6f)) {
+        this->first_run = 1;
+        return FILTERRESULT_WARNING;
+    }
+
+    // Renormalize, keeping q0 positive
+    const float invq = copysignf(1.0f / sqrtf(qmag_sq), n0);
+    q[0] = n0 * invq;
+    q[1] = n1 * invq;
+    q[2] = n2 * invq;
+    q[3] = n3 * invq;
+
+    if (this->init) {
+        return FILTERRESULT_OK;
+    } else {
+        return FILTERRESULT_CRITICAL; // "critical" while zeroing, as filtercf.c
+    }
+}
+
+static void flightStatusUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    FlightStatusArmedGet(&armed);
+}
+
+/**
+ * @}
+ * @}
+ */
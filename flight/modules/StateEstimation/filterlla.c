@@ -44,10 +44,12 @@
 struct data {
     GPSSettingsData  settings;
     HomeLocationData home;
-    double HomeECEF[3];
-    float HomeRne[3][3];
+    BaseFrame HomeFrame;
 };
 
+// filter state
+static struct data filterData __ccm_data;
+
 // Private variables
 
 // Private functions
@@ -60,7 +62,7 @@ int32_t filterLLAInitialize(stateFilter *handle)
 {
     handle->init      = &init;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
+    handle->localdata = &filterData;
     GPSSettingsInitialize();
     GPSPositionSensorInitialize();
     HomeLocationInitialize();
@@ -80,8 +82,7 @@ static int32_t init(__attribute__((unused)) stateFilter *self)
             this->home.Longitude,
             (int32_t)(this->home.Altitude * 1e4f),
         };
-        LLA2ECEF(LLAi, this->HomeECEF);
-        RneFromLLA(LLAi, this->HomeRne);
+        BaseFrameFromLLA(LLAi, &this->HomeFrame);
     }
     return 0;
 }
@@ -111,7 +112,7 @@ static filterResult filter(__attribute__((unused)) stateFilter *self, stateEstim
                 gpsdata.Longitude,
                 (int32_t)((gpsdata.Altitude + gpsdata.GeoidSeparation) * 1e4f),
             };
-            LLA2Base(LLAi, this->HomeECEF, this->HomeRne, state->pos);
+            LLA2BaseFrame(LLAi, &this->HomeFrame, state->pos);
             state->updated |= SENSORUPDATES_pos;
         }
     }
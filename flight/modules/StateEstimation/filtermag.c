@@ -57,6 +57,9 @@ struct data {
     float   magBias[3];
 };
 
+// filter state
+static struct data filterData __ccm_data;
+
 // Private variables
 
 // Private functions
@@ -71,7 +74,7 @@ int32_t filterMagInitialize(stateFilter *handle)
 {
     handle->init      = &init;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
+    handle->localdata = &filterData;
     HomeLocationInitialize();
     return STACK_REQUIRED;
 }
@@ -52,6 +52,9 @@ struct data {
     PiOSDeltatimeConfig dtconfig;
 };
 
+// filter state
+static struct data filterData __ccm_data;
+
 // Private variables
 
 // Private functions
@@ -64,7 +67,7 @@ int32_t filterVelocityInitialize(stateFilter *handle)
 {
     handle->init      = &init;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
+    handle->localdata = &filterData;
     return STACK_REQUIRED;
 }
 
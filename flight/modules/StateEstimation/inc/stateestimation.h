@@ -92,6 +92,7 @@ int32_t filterStationaryInitialize(stateFilter *handle);
 int32_t filterLLAInitialize(stateFilter *handle);
 int32_t filterCFInitialize(stateFilter *handle);
 int32_t filterCFMInitialize(stateFilter *handle);
+int32_t filterFastInitialize(stateFilter *handle);
 int32_t filterEKF13iInitialize(stateFilter *handle);
 int32_t filterEKF13Initialize(stateFilter *handle);
 int32_t filterEKF16iInitialize(stateFilter *handle);
@@ -55,12 +55,16 @@
 #include "flightstatus.h"
 
 #include "CoordinateConversions.h"
+#ifdef PIOS_STABILIZATION_GYRO_DIRECT
+#include <gyrodirect.h>
+#endif
 
 // Private constants
 #define STACK_SIZE_BYTES        256
 #define CALLBACK_PRIORITY       CALLBACK_PRIORITY_REGULAR
 #define TASK_PRIORITY           CALLBACK_TASK_FLIGHTCONTROL
 #define TIMEOUT_MS              10
+#define DEADLINE_MS             2
 
 // Private filter init const
 #define FILTER_INIT_FORCE       -1
@@ -128,12 +132,9 @@
 
 
 // Private types
-struct filterPipelineStruct;
 
-typedef const struct filterPipelineStruct {
-    const stateFilter *filter;
-    const struct filterPipelineStruct *next;
-} filterPipeline;
+// a filter chain is a NULL terminated array of filters, run in order
+typedef const stateFilter *const filterPipeline;
 
 // Private variables
 static DelayedCallbackInfo *stateEstimationCallback;
@@ -154,100 +155,80 @@ static stateFilter stationaryFilter;
 static stateFilter llaFilter;
 static stateFilter cfFilter;
 static stateFilter cfmFilter;
+static stateFilter fastFilter;
 static stateFilter ekf13iFilter;
 static stateFilter ekf13Filter;
+static stateFilter ekf16iFilter;
+static stateFilter ekf16Filter;
 
 // this is a hack to provide a computational shortcut for faster gyro state progression
 static float gyroRaw[3];
 static float gyroDelta[3];
 
 // preconfigured filter chains selectable via revoSettings.FusionAlgorithm
-static const filterPipeline *cfQueue = &(filterPipeline) {
-    .filter = &airFilter,
-    .next   = &(filterPipeline) {
-        .filter = &baroiFilter,
-        .next   = &(filterPipeline) {
-            .filter = &altitudeFilter,
-            .next   = &(filterPipeline) {
-                .filter = &cfFilter,
-                .next   = NULL,
-            }
-        }
-    }
+static filterPipeline cfQueue[] = {
+    &airFilter,
+    &baroiFilter,
+    &altitudeFilter,
+    &cfFilter,
+    NULL,
 };
-static const filterPipeline *cfmiQueue = &(filterPipeline) {
-    .filter = &magFilter,
-    .next   = &(filterPipeline) {
-        .filter = &airFilter,
-        .next   = &(filterPipeline) {
-            .filter = &baroiFilter,
-            .next   = &(filterPipeline) {
-                .filter = &altitudeFilter,
-                .next   = &(filterPipeline) {
-                    .filter = &cfmFilter,
-                    .next   = NULL,
-                }
-            }
-        }
-    }
+static filterPipeline fastQueue[] = {
+    &fastFilter,
+    NULL,
 };
-static const filterPipeline *cfmQueue = &(filterPipeline) {
-    .filter = &magFilter,
-    .next   = &(filterPipeline) {
-        .filter = &airFilter,
-        .next   = &(filterPipeline) {
-            .filter = &llaFilter,
-            .next   = &(filterPipeline) {
-                .filter = &baroFilter,
-                .next   = &(filterPipeline) {
-                    .filter = &altitudeFilter,
-                    .next   = &(filterPipeline) {
-                        .filter = &cfmFilter,
-                        .next   = NULL,
-                    }
-                }
-            }
-        }
-    }
+static filterPipeline cfmiQueue[] = {
+    &magFilter,
+    &airFilter,
+    &baroiFilter,
+    &altitudeFilter,
+    &cfmFilter,
+    NULL,
 };
-static const filterPipeline *ekf13iQueue = &(filterPipeline) {
-    .filter = &magFilter,
-    .next   = &(filterPipeline) {
-        .filter = &airFilter,
-        .next   = &(filterPipeline) {
-            .filter = &baroiFilter,
-            .next   = &(filterPipeline) {
-                .filter = &stationaryFilter,
-                .next   = &(filterPipeline) {
-                    .filter = &ekf13iFilter,
-                    .next   = &(filterPipeline) {
-                        .filter = &velocityFilter,
-                        .next   = NULL,
-                    }
-                }
-            }
-        }
-    }
+static filterPipeline cfmQueue[] = {
+    &magFilter,
+    &airFilter,
+    &llaFilter,
+    &baroFilter,
+    &altitudeFilter,
+    &cfmFilter,
+    NULL,
 };
-
-static const filterPipeline *ekf13Queue = &(filterPipeline) {
-    .filter = &magFilter,
-    .next   = &(filterPipeline) {
-        .filter = &airFilter,
-        .next   = &(filterPipeline) {
-            .filter = &llaFilter,
-            .next   = &(filterPipeline) {
-                .filter = &baroFilter,
-                .next   = &(filterPipeline) {
-                    .filter = &ekf13Filter,
-                    .next   = &(filterPipeline) {
-                        .filter = &velocityFilter,
-                        .next   = NULL,
-                    }
-                }
-            }
-        }
-    }
+static filterPipeline ekf13iQueue[] = {
+    &magFilter,
+    &airFilter,
+    &baroiFilter,
+    &stationaryFilter,
+    &ekf13iFilter,
+    &velocityFilter,
+    NULL,
+};
+static filterPipeline ekf13Queue[] = {
+    &magFilter,
+    &airFilter,
+    &llaFilter,
+    &baroFilter,
+    &ekf13Filter,
+    &velocityFilter,
+    NULL,
+};
+static filterPipeline ekf16iQueue[] = {
+    &magFilter,
+    &airFilter,
+    &baroiFilter,
+    &stationaryFilter,
+    &ekf16iFilter,
+    &velocityFilter,
+    NULL,
+};
+static filterPipeline ekf16Queue[] = {
+    &magFilter,
+    &airFilter,
+    &llaFilter,
+    &baroFilter,
+    &ekf16Filter,
+    &velocityFilter,
+    NULL,
 };
 
 // Private functions
@@ -315,10 +296,16 @@ int32_t StateEstimationInitialize(void)
     stack_required = maxint32_t(stack_required, filterLLAInitialize(&llaFilter));
     stack_required = maxint32_t(stack_required, filterCFInitialize(&cfFilter));
     stack_required = maxint32_t(stack_required, filterCFMInitialize(&cfmFilter));
+    stack_required = maxint32_t(stack_required, filterFastInitialize(&fastFilter));
     stack_required = maxint32_t(stack_required, filterEKF13iInitialize(&ekf13iFilter));
     stack_required = maxint32_t(stack_required, filterEKF13Initialize(&ekf13Filter));
+    stack_required = maxint32_t(stack_required, filterEKF16iInitialize(&ekf16iFilter));
+    stack_required = maxint32_t(stack_required, filterEKF16Initialize(&ekf16Filter));
 
     stateEstimationCallback = PIOS_CALLBACKSCHEDULER_Create(&StateEstimationCb, CALLBACK_PRIORITY, TASK_PRIORITY, CALLBACKINFO_RUNNING_STATEESTIMATION, stack_required);
+    // estimation runs ahead of the other regular priority callbacks of the flight control task, the critical inner loop still goes first
+    PIOS_CALLBACKSCHEDULER_SetDeadline(stateEstimationCallback, 0, DEADLINE_MS);
+    PIOS_CALLBACKSCHEDULER_SetDeadlineMode(TASK_PRIORITY, true);
 
     return 0;
 }
@@ -385,6 +372,9 @@ static void StateEstimationCb(void)
                 case REVOSETTINGS_FUSIONALGORITHM_BASICCOMPLEMENTARY:
                     newFilterChain = cfQueue;
                     break;
+                case REVOSETTINGS_FUSIONALGORITHM_ATTITUDEONLYFAST:
+                    newFilterChain = fastQueue;
+                    break;
                 case REVOSETTINGS_FUSIONALGORITHM_COMPLEMENTARYMAG:
                     newFilterChain = cfmiQueue;
                     break;
@@ -397,19 +387,25 @@ static void StateEstimationCb(void)
                 case REVOSETTINGS_FUSIONALGORITHM_GPSNAVIGATIONINS13:
                     newFilterChain = ekf13Queue;
                     break;
+                case REVOSETTINGS_FUSIONALGORITHM_INS16INDOOR:
+                    newFilterChain = ekf16iQueue;
+                    break;
+                case REVOSETTINGS_FUSIONALGORITHM_GPSNAVIGATIONINS16:
+                    newFilterChain = ekf16Queue;
+                    break;
                 default:
                     newFilterChain = NULL;
                 }
                 // initialize filters in chain
                 current = newFilterChain;
                 bool error = 0;
-                while (current != NULL) {
-                    int32_t result = current->filter->init((stateFilter *)current->filter);
+                while (current != NULL && *current != NULL) {
+                    int32_t result = (*current)->init((stateFilter *)*current);
                     if (result != 0) {
                         error = 1;
                         break;
                     }
-                    current = current->next;
+                    current++;
                 }
                 if (error) {
                     AlarmsSet(SYSTEMALARMS_ALARM_ATTITUDE, SYSTEMALARMS_ALARM_ERROR);
@@ -454,16 +450,16 @@ static void StateEstimationCb(void)
 
     case RUNSTATE_FILTER:
 
-        if (current != NULL) {
-            filterResult result = current->filter->filter((stateFilter *)current->filter, &states);
+        if (current != NULL && *current != NULL) {
+            filterResult result = (*current)->filter((stateFilter *)*current, &states);
             if (result > alarm) {
                 alarm = result;
             }
-            current = current->next;
+            current++;
         }
 
         // we are not done, re-dispatch self execution
-        if (!current) {
+        if (current == NULL || *current == NULL) {
             runState = RUNSTATE_SAVE;
         }
         PIOS_CALLBACKSCHEDULER_Dispatch(stateEstimationCallback);
@@ -477,6 +473,9 @@ static void StateEstimationCb(void)
             gyroDelta[0] = states.gyro[0] - gyroRaw[0];
             gyroDelta[1] = states.gyro[1] - gyroRaw[1];
             gyroDelta[2] = states.gyro[2] - gyroRaw[2];
+#ifdef PIOS_STABILIZATION_GYRO_DIRECT
+            gyrodirect_set_correction(gyroDelta);
+#endif
         }
         EXPORT_STATE_TO_UAVOBJECT_IF_UPDATED_3_DIMENSIONS(AccelState, accel, x, y, z);
         if (IS_SET(states.updated, SENSORUPDATES_mag)) {
@@ -510,7 +509,7 @@ static void StateEstimationCb(void)
             s.q2 = states.attitude[1];
             s.q3 = states.attitude[2];
             s.q4 = states.attitude[3];
-            Quaternion2RPY(&s.q1, &s.Roll);
+            Quaternion2RPYFast(&s.q1, &s.Roll);
             AttitudeStateSet(&s);
         }
 
@@ -56,6 +56,7 @@
 #include <taskinfo.h>
 #include <watchdogstatus.h>
 #include <callbackinfo.h>
+#include <callbackhistogram.h>
 #include <hwsettings.h>
 #include <pios_flashfs.h>
 #include <pios_notify.h>
@@ -92,16 +93,25 @@
 
 #define TASK_PRIORITY           (tskIDLE_PRIORITY + 1)
 
+#if defined(PIOS_FLASHFS_BACKGROUND_MAINTENANCE)
+#define FLASH_MAINTENANCE_PERIOD_MS      1000
+#define FLASH_MAINTENANCE_BUSY_PERIOD_MS 10
+#define FLASH_MAINTENANCE_STACK_SIZE     384
+#endif
+
 // Private types
 
 // Private variables
 static xTaskHandle systemTaskHandle;
-static xQueueHandle objectPersistenceQueue;
+static UAVObjEventSubscriber objectPersistenceSubscriber;
 static enum { STACKOVERFLOW_NONE = 0, STACKOVERFLOW_WARNING = 1, STACKOVERFLOW_CRITICAL = 3 } stackOverflow;
 static bool mallocFailed;
 static HwSettingsData bootHwSettings;
 static FrameType_t bootFrameType;
 static struct PIOS_FLASHFS_Stats fsStats;
+#if defined(PIOS_FLASHFS_BACKGROUND_MAINTENANCE)
+static DelayedCallbackInfo *flashMaintenanceCallback;
+#endif
 
 // Private functions
 static void objectUpdatedCb(UAVObjEvent *ev);
@@ -113,6 +123,9 @@ static void callbackSchedulerForEachCallback(int16_t callback_id, const struct p
 static void updateStats();
 static void updateSystemAlarms();
 static void systemTask(void *parameters);
+#if defined(PIOS_FLASHFS_BACKGROUND_MAINTENANCE)
+static void flashMaintenanceCb(void);
+#endif
 #ifdef DIAG_I2C_WDG_STATS
 static void updateI2Cstats();
 static void updateWDGstats();
@@ -152,6 +165,7 @@ int32_t SystemModInitialize(void)
 #ifdef DIAG_TASKS
     TaskInfoInitialize();
     CallbackInfoInitialize();
+    CallbackHistogramInitialize();
 #endif
 #ifdef DIAG_I2C_WDG_STATS
     I2CStatsInitialize();
@@ -162,11 +176,16 @@ int32_t SystemModInitialize(void)
     InstrumentationInit();
 #endif
 
-    objectPersistenceQueue = xQueueCreate(1, sizeof(UAVObjEvent));
-    if (objectPersistenceQueue == NULL) {
+    if (UAVObjSubscriberInit(&objectPersistenceSubscriber, 1, true) != 0) {
         return -1;
     }
 
+#if defined(PIOS_FLASHFS_BACKGROUND_MAINTENANCE)
+    // Erase and garbage collect the settings filesystems ahead of time, so saves never have to
+    flashMaintenanceCallback = PIOS_CALLBACKSCHEDULER_Create(&flashMaintenanceCb, CALLBACK_PRIORITY_LOW, CALLBACK_TASK_AUXILIARY, CALLBACKINFO_RUNNING_FLASHMAINTENANCE, FLASH_MAINTENANCE_STACK_SIZE);
+    PIOS_CALLBACKSCHEDULER_Schedule(flashMaintenanceCallback, FLASH_MAINTENANCE_PERIOD_MS, CALLBACK_UPDATEMODE_SOONER);
+#endif
+
     SystemModStart();
 
     return 0;
@@ -196,7 +215,7 @@ static void systemTask(__attribute__((unused)) void *parameters)
     PIOS_IAP_WriteBootCount(0);
 #endif
     // Listen for SettingPersistance object updates, connect a callback function
-    ObjectPersistenceConnectQueue(objectPersistenceQueue);
+    ObjectPersistenceConnectSubscriber(&objectPersistenceSubscriber);
 
     // Load a copy of HwSetting active at boot time
     HwSettingsGet(&bootHwSettings);
@@ -206,7 +225,8 @@ static void systemTask(__attribute__((unused)) void *parameters)
     SystemSettingsConnectCallback(checkSettingsUpdatedCb);
 
 #ifdef DIAG_TASKS
-    TaskInfoData taskInfoData;
+    // a few hundred bytes with the per task timings, kept off the stack
+    static TaskInfoData taskInfoData;
     CallbackInfoData callbackInfoData;
 #endif
     // Main system loop
@@ -238,7 +258,7 @@ static void systemTask(__attribute__((unused)) void *parameters)
 // }
 
 
-        UAVObjEvent ev;
+        UAVObjEventNode *ev;
         int delayTime = SYSTEM_UPDATE_PERIOD_MS;
 
 #if defined(PIOS_INCLUDE_RFM22B)
@@ -272,6 +292,10 @@ static void systemTask(__attribute__((unused)) void *parameters)
             oplinkStatus.Timeouts    = radio_stats.timeouts;
             oplinkStatus.RSSI        = radio_stats.rssi;
             oplinkStatus.LinkQuality = radio_stats.link_quality;
+            oplinkStatus.AirDataRate = radio_stats.datarate;
+            oplinkStatus.PPMInterval    = radio_stats.ppm_interval;
+            oplinkStatus.PPMIntervalMax = radio_stats.ppm_interval_max;
+            oplinkStatus.PPMLatency     = radio_stats.ppm_latency;
             if (first_time) {
                 first_time = false;
             } else {
@@ -295,9 +319,11 @@ static void systemTask(__attribute__((unused)) void *parameters)
 
 #endif /* if defined(PIOS_INCLUDE_RFM22B) */
 
-        if (xQueueReceive(objectPersistenceQueue, &ev, delayTime) == pdTRUE) {
+        ev = UAVObjSubscriberReceive(&objectPersistenceSubscriber, delayTime);
+        if (ev) {
             // If object persistence is updated call the callback
-            objectUpdatedCb(&ev);
+            objectUpdatedCb(&ev->ev);
+            UAVObjSubscriberRelease(ev);
         }
     }
 }
@@ -426,6 +452,9 @@ static void taskMonitorForEachCallback(uint16_t task_id, const struct pios_task_
     TaskInfoRunningToArray(taskData->Running)[task_id] = task_info->is_running ? TASKINFO_RUNNING_TRUE : TASKINFO_RUNNING_FALSE;
     ((uint16_t *)&taskData->StackRemaining)[task_id]   = task_info->stack_remaining;
     ((uint8_t *)&taskData->RunningTime)[task_id] = task_info->running_time_percentage;
+    ((float *)&taskData->Load)[task_id] = task_info->cpu_load;
+    ((uint16_t *)&taskData->MaxRunTime)[task_id]      = MIN(task_info->max_run_time_us, UINT16_MAX);
+    ((uint16_t *)&taskData->ContextSwitches)[task_id] = MIN(task_info->context_switch_rate, UINT16_MAX);
 }
 
 static void callbackSchedulerForEachCallback(int16_t callback_id, const struct pios_callback_info *callback_info, void *context)
@@ -445,6 +474,19 @@ static void callbackSchedulerForEachCallback(int16_t callback_id, const struct p
     ((uint8_t *)&callbackData->Running)[callback_id] = callback_info->is_running;
     ((uint32_t *)&callbackData->RunningTime)[callback_id]   = callback_info->running_time_count;
     ((int16_t *)&callbackData->StackRemaining)[callback_id] = callback_info->stack_remaining;
+    ((uint32_t *)&callbackData->WorstCaseRunTime)[callback_id] = callback_info->worst_case_runtime_us;
+    ((uint16_t *)&callbackData->DeadlineMisses)[callback_id]   = callback_info->deadline_misses > UINT16_MAX ? UINT16_MAX : callback_info->deadline_misses;
+
+    // one histogram instance per callback_id, created as callbacks show up
+    while (UAVObjGetNumInstances(CallbackHistogramHandle()) <= callback_id) {
+        if (!CallbackHistogramCreateInstance()) {
+            return;
+        }
+    }
+    CallbackHistogramData histogram;
+    memcpy(&histogram.RunTime, callback_info->run_time_histogram, sizeof(histogram.RunTime));
+    memcpy(&histogram.Latency, callback_info->latency_histogram, sizeof(histogram.Latency));
+    CallbackHistogramInstSet(callback_id, &histogram);
 }
 #endif /* ifdef DIAG_TASKS */
 
@@ -534,6 +576,16 @@ static void updateStats()
 #else
     stats.HeapRemaining = xPortGetFreeHeapSize();
     stats.SystemModStackRemaining = uxTaskGetStackHighWaterMark(NULL) * 4;
+
+    struct pios_mem_stats heapStats;
+    pios_mem_get_stats(&heapStats, false);
+    stats.HeapFree.SRAM = heapStats.free;
+    stats.HeapLowWater.SRAM    = heapStats.min_free;
+    stats.HeapLargestFree.SRAM = heapStats.largest_free;
+    pios_mem_get_stats(&heapStats, true);
+    stats.HeapFree.Fast = heapStats.free;
+    stats.HeapLowWater.Fast    = heapStats.min_free;
+    stats.HeapLargestFree.Fast = heapStats.largest_free;
 #endif
 
     // Get Irq stack status
@@ -544,15 +596,47 @@ static void updateStats()
         PIOS_FLASHFS_GetStats(pios_uavo_settings_fs_id, &fsStats);
         stats.SysSlotsFree   = fsStats.num_free_slots;
         stats.SysSlotsActive = fsStats.num_active_slots;
+        stats.SysSlotsObsolete        = fsStats.num_obsolete_slots;
+        stats.FlashArenaErases.SysMin = fsStats.min_arena_erases;
+        stats.FlashArenaErases.SysMax = fsStats.max_arena_erases;
+        stats.FlashGCCount.Sys        = fsStats.gc_count;
+        stats.FlashGCForeground.Sys   = fsStats.gc_foreground_count;
+        stats.FlashGCBytesCopied.Sys  = fsStats.gc_bytes_copied;
+        stats.FlashGCTime.SysLast     = fsStats.gc_last_us;
+        stats.FlashGCTime.SysMax      = fsStats.gc_max_us;
     }
     if (pios_user_fs_id) {
         PIOS_FLASHFS_GetStats(pios_user_fs_id, &fsStats);
         stats.UsrSlotsFree   = fsStats.num_free_slots;
         stats.UsrSlotsActive = fsStats.num_active_slots;
+        stats.UsrSlotsObsolete        = fsStats.num_obsolete_slots;
+        stats.FlashArenaErases.UsrMin = fsStats.min_arena_erases;
+        stats.FlashArenaErases.UsrMax = fsStats.max_arena_erases;
+        stats.FlashGCCount.Usr        = fsStats.gc_count;
+        stats.FlashGCForeground.Usr   = fsStats.gc_foreground_count;
+        stats.FlashGCBytesCopied.Usr  = fsStats.gc_bytes_copied;
+        stats.FlashGCTime.UsrLast     = fsStats.gc_last_us;
+        stats.FlashGCTime.UsrMax      = fsStats.gc_max_us;
     }
 #endif
     stats.CPULoad = 100 - PIOS_TASK_MONITOR_GetIdlePercentage();
 
+    // ready once sensors and attitude report OK, the receiver and GPS depend on more than the boot
+    if (AlarmsGet(SYSTEMALARMS_ALARM_SENSORS) == SYSTEMALARMS_ALARM_OK &&
+        AlarmsGet(SYSTEMALARMS_ALARM_ATTITUDE) == SYSTEMALARMS_ALARM_OK) {
+        PIOS_INITCALL_MarkPhase(PIOS_INITCALL_PHASE_READY);
+    }
+    struct pios_initcall_stats bootStats;
+    PIOS_INITCALL_GetStats(&bootStats);
+    stats.BootTime.BoardInit   = MIN(bootStats.phase_ms[PIOS_INITCALL_PHASE_BOARDINIT], UINT16_MAX);
+    stats.BootTime.ModuleInit  = MIN(bootStats.phase_ms[PIOS_INITCALL_PHASE_MODULEINIT], UINT16_MAX);
+    stats.BootTime.ModuleStart = MIN(bootStats.phase_ms[PIOS_INITCALL_PHASE_MODULESTART], UINT16_MAX);
+    stats.BootTime.Ready = MIN(bootStats.phase_ms[PIOS_INITCALL_PHASE_READY], UINT16_MAX);
+    stats.BootSlowestModule.Init      = (uint32_t)(uintptr_t)bootStats.slowest_init;
+    stats.BootSlowestModule.Start     = (uint32_t)(uintptr_t)bootStats.slowest_start;
+    stats.BootSlowestModuleTime.Init  = bootStats.slowest_init_us;
+    stats.BootSlowestModuleTime.Start = bootStats.slowest_start_us;
+
 #if defined(PIOS_INCLUDE_ADC) && defined(PIOS_ADC_USE_TEMP_SENSOR)
     float temp_voltage = PIOS_ADC_PinGetVolt(PIOS_ADC_TEMPERATURE_PIN);
     stats.CPUTemp = PIOS_CONVERT_VOLT_TO_CPU_TEMP(temp_voltage);;
@@ -560,6 +644,27 @@ static void updateStats()
     SystemStatsSet(&stats);
 }
 
+#if defined(PIOS_FLASHFS_BACKGROUND_MAINTENANCE)
+/**
+ * Runs one step of filesystem maintenance, comes back soon while there is work left
+ */
+static void flashMaintenanceCb(void)
+{
+    int32_t pending = 0;
+
+    if (pios_uavo_settings_fs_id && PIOS_FLASHFS_Maintain(pios_uavo_settings_fs_id) > 0) {
+        pending = 1;
+    }
+    if (pios_user_fs_id && PIOS_FLASHFS_Maintain(pios_user_fs_id) > 0) {
+        pending = 1;
+    }
+
+    PIOS_CALLBACKSCHEDULER_Schedule(flashMaintenanceCallback,
+                                    pending ? FLASH_MAINTENANCE_BUSY_PERIOD_MS : FLASH_MAINTENANCE_PERIOD_MS,
+                                    CALLBACK_UPDATEMODE_OVERRIDE);
+}
+#endif /* if defined(PIOS_FLASHFS_BACKGROUND_MAINTENANCE) */
+
 /**
  * Update system alarms
  */
@@ -568,6 +673,7 @@ static void updateSystemAlarms()
     SystemStatsData stats;
     UAVObjStats objStats;
     EventStats evStats;
+    AlarmsBatch alarms = { 0 };
 
     SystemStatsGet(&stats);
 
@@ -577,36 +683,36 @@ static void updateSystemAlarms()
         || (stats.IRQStackRemaining < IRQSTACK_LIMIT_CRITICAL)
 #endif
         ) {
-        AlarmsSet(SYSTEMALARMS_ALARM_OUTOFMEMORY, SYSTEMALARMS_ALARM_CRITICAL);
+        AlarmsBatchSet(&alarms, SYSTEMALARMS_ALARM_OUTOFMEMORY, SYSTEMALARMS_ALARM_CRITICAL);
     } else if ((stats.HeapRemaining < HEAP_LIMIT_WARNING)
 #if !defined(ARCH_POSIX) && !defined(ARCH_WIN32) && defined(CHECK_IRQ_STACK)
                || (stats.IRQStackRemaining < IRQSTACK_LIMIT_WARNING)
 #endif
                ) {
-        AlarmsSet(SYSTEMALARMS_ALARM_OUTOFMEMORY, SYSTEMALARMS_ALARM_WARNING);
+        AlarmsBatchSet(&alarms, SYSTEMALARMS_ALARM_OUTOFMEMORY, SYSTEMALARMS_ALARM_WARNING);
     } else {
-        AlarmsClear(SYSTEMALARMS_ALARM_OUTOFMEMORY);
+        AlarmsBatchClear(&alarms, SYSTEMALARMS_ALARM_OUTOFMEMORY);
     }
 
     // Check CPU load
     if (stats.CPULoad > CPULOAD_LIMIT_CRITICAL) {
-        AlarmsSet(SYSTEMALARMS_ALARM_CPUOVERLOAD, SYSTEMALARMS_ALARM_CRITICAL);
+        AlarmsBatchSet(&alarms, SYSTEMALARMS_ALARM_CPUOVERLOAD, SYSTEMALARMS_ALARM_CRITICAL);
     } else if (stats.CPULoad > CPULOAD_LIMIT_WARNING) {
-        AlarmsSet(SYSTEMALARMS_ALARM_CPUOVERLOAD, SYSTEMALARMS_ALARM_WARNING);
+        AlarmsBatchSet(&alarms, SYSTEMALARMS_ALARM_CPUOVERLOAD, SYSTEMALARMS_ALARM_WARNING);
     } else {
-        AlarmsClear(SYSTEMALARMS_ALARM_CPUOVERLOAD);
+        AlarmsBatchClear(&alarms, SYSTEMALARMS_ALARM_CPUOVERLOAD);
     }
 
     // Check for stack overflow
     switch (stackOverflow) {
     case STACKOVERFLOW_NONE:
-        AlarmsClear(SYSTEMALARMS_ALARM_STACKOVERFLOW);
+        AlarmsBatchClear(&alarms, SYSTEMALARMS_ALARM_STACKOVERFLOW);
         break;
     case STACKOVERFLOW_WARNING:
-        AlarmsSet(SYSTEMALARMS_ALARM_STACKOVERFLOW, SYSTEMALARMS_ALARM_WARNING);
+        AlarmsBatchSet(&alarms, SYSTEMALARMS_ALARM_STACKOVERFLOW, SYSTEMALARMS_ALARM_WARNING);
         break;
     default:
-        AlarmsSet(SYSTEMALARMS_ALARM_STACKOVERFLOW, SYSTEMALARMS_ALARM_CRITICAL);
+        AlarmsBatchSet(&alarms, SYSTEMALARMS_ALARM_STACKOVERFLOW, SYSTEMALARMS_ALARM_CRITICAL);
     }
 
     // Check for event errors
@@ -615,10 +721,11 @@ static void updateSystemAlarms()
     UAVObjClearStats();
     EventClearStats();
     if (objStats.eventCallbackErrors > 0 || objStats.eventQueueErrors > 0 || evStats.eventErrors > 0) {
-        AlarmsSet(SYSTEMALARMS_ALARM_EVENTSYSTEM, SYSTEMALARMS_ALARM_WARNING);
+        AlarmsBatchSet(&alarms, SYSTEMALARMS_ALARM_EVENTSYSTEM, SYSTEMALARMS_ALARM_WARNING);
     } else {
-        AlarmsClear(SYSTEMALARMS_ALARM_EVENTSYSTEM);
+        AlarmsBatchClear(&alarms, SYSTEMALARMS_ALARM_EVENTSYSTEM);
     }
+    AlarmsSetMany(&alarms);
 
     if (objStats.lastCallbackErrorID || objStats.lastQueueErrorID || evStats.lastErrorID) {
         SystemStatsData sysStats;
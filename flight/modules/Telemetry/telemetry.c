@@ -38,6 +38,9 @@
 #include "gcstelemetrystats.h"
 #include "hwsettings.h"
 #include "taskinfo.h"
+#ifdef PIOS_TELEM_SETTINGS_MANIFEST
+#include "settingsmanifest.h"
+#endif
 
 // Private constants
 #define MAX_QUEUE_SIZE            TELEM_QUEUE_SIZE
@@ -63,6 +66,16 @@
 #define MAX_RETRIES               2
 #define STATS_UPDATE_PERIOD_MS    4000
 #define CONNECTION_TIMEOUT_MS     8000
+// unacked objects from this size on are sent as deltas against the previous update
+#define DELTA_MIN_LENGTH          48
+// receive buffers are static so they do not count against the task stacks
+#define RX_BUFFER_LENGTH          64
+// the periodic updates are slowed down by up to this many steps when the link cannot keep up
+#define RATE_LEVEL_MAX            3
+// stats periods without congestion before a step is given back
+#define RATE_RECOVERY_PERIODS     2
+// longest update period a slowed down object gets
+#define RATE_MAX_PERIOD_MS        30000
 
 // Private types
 
@@ -87,10 +100,22 @@ static xTaskHandle radioRxTaskHandle;
 static uint32_t txErrors;
 static uint32_t txRetries;
 static uint32_t timeOfLastObjectUpdate;
+static uint8_t rateLevel;
+static uint8_t rateCalmPeriods;
+static uint32_t rateCongestedTxBytes;
+static bool loggingSampled;
 static UAVTalkConnection uavTalkCon;
 #ifdef PIOS_INCLUDE_RFM22B
 static UAVTalkConnection radioUavTalkCon;
 #endif
+#ifdef PIOS_INCLUDE_RFM22B
+static uint8_t radioTxFailures;
+static uint8_t radioTimeouts;
+#endif
+#ifdef PIOS_TELEM_SETTINGS_MANIFEST
+static volatile bool manifestReady;
+static uint16_t manifestEntries;
+#endif
 
 // Private functions
 static void telemetryTxTask(void *parameters);
@@ -103,12 +128,20 @@ static int32_t transmitData(uint8_t *data, int32_t length);
 static void registerObject(UAVObjHandle obj);
 static void updateObject(UAVObjHandle obj, int32_t eventType);
 static int32_t setUpdatePeriod(UAVObjHandle obj, int32_t updatePeriodMs);
+static int32_t scaledUpdatePeriod(UAVObjHandle obj, UAVObjMetadata *metadata);
+static void updateObjectRate(UAVObjHandle obj);
+static void updateRateLevel(uint32_t txBytes, bool connected);
 static int32_t setLoggingPeriod(UAVObjHandle obj, int32_t updatePeriodMs);
 static void processObjEvent(UAVObjEvent *ev);
+static void processQueueEvent(xQueueHandle eventQueue, UAVObjEvent *ev);
 static void updateTelemetryStats();
 static void gcsTelemetryStatsUpdated();
 static void updateSettings();
 static uint32_t getComPort(bool input);
+#ifdef PIOS_TELEM_SETTINGS_MANIFEST
+static void addManifestObject(UAVObjHandle obj);
+static void setManifestEntry(UAVObjHandle obj, uint16_t instId);
+#endif
 
 /**
  * Initialise the telemetry module
@@ -117,6 +150,12 @@ static uint32_t getComPort(bool input);
  */
 int32_t TelemetryStart(void)
 {
+#ifdef PIOS_TELEM_SETTINGS_MANIFEST
+    // List all settings objects in the manifest, it is kept up to date by UAVObjSettingsUpdated from then on
+    manifestReady = true;
+    UAVObjIterate(&addManifestObject);
+#endif
+
     // Process all registered objects and connect queue for updates
     UAVObjIterate(&registerObject);
 
@@ -146,9 +185,17 @@ int32_t TelemetryInitialize(void)
 {
     FlightTelemetryStatsInitialize();
     GCSTelemetryStatsInitialize();
+#ifdef PIOS_TELEM_SETTINGS_MANIFEST
+    SettingsManifestInitialize();
+    manifestReady   = false;
+    manifestEntries = 0;
+#endif
 
     // Initialize vars
     timeOfLastObjectUpdate = 0;
+    rateLevel = 0;
+    rateCalmPeriods = 0;
+    rateCongestedTxBytes = 0;
 
     // Create object queues
     queue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
@@ -166,6 +213,10 @@ int32_t TelemetryInitialize(void)
 
     // Initialise UAVTalk
     uavTalkCon = UAVTalkInitialize(&transmitData);
+#ifdef PIOS_TELEM_TIMESTAMPS
+    // lets the GCS time the updates independently of the link and replay speed
+    UAVTalkSetTimestamped(uavTalkCon, true);
+#endif
 #ifdef PIOS_INCLUDE_RFM22B
     radioUavTalkCon = UAVTalkInitialize(&transmitRadioData);
 #endif
@@ -192,7 +243,7 @@ static void registerObject(UAVObjHandle obj)
 {
     if (UAVObjIsMetaobject(obj)) {
         // Only connect change notifications for meta objects.  No periodic updates
-        UAVObjConnectQueue(obj, priorityQueue, EV_MASK_ALL_UPDATES);
+        UAVObjConnectQueueCoalesced(obj, priorityQueue, EV_MASK_ALL_UPDATES);
     } else {
         // Setup object for periodic updates
         updateObject(obj, EV_NONE);
@@ -225,8 +276,8 @@ static void updateObject(UAVObjHandle obj, int32_t eventType)
     eventMask   = 0;
     switch (updateMode) {
     case UPDATEMODE_PERIODIC:
-        // Set update period
-        setUpdatePeriod(obj, metadata.telemetryUpdatePeriod);
+        // Set update period, slowed down if the link is congested
+        setUpdatePeriod(obj, scaledUpdatePeriod(obj, &metadata));
         // Connect queue
         eventMask |= EV_UPDATED_PERIODIC | EV_UPDATED_MANUAL | EV_UPDATE_REQ;
         break;
@@ -242,7 +293,7 @@ static void updateObject(UAVObjHandle obj, int32_t eventType)
             eventMask |= EV_UPDATED | EV_UPDATED_MANUAL | EV_UPDATE_REQ;
             // Set update period on initialization and metadata change
             if (eventType == EV_NONE) {
-                setUpdatePeriod(obj, metadata.telemetryUpdatePeriod);
+                setUpdatePeriod(obj, scaledUpdatePeriod(obj, &metadata));
             }
         } else {
             // Otherwise, we just received an object update, so switch to periodic for the timeout period to prevent more updates
@@ -258,8 +309,8 @@ static void updateObject(UAVObjHandle obj, int32_t eventType)
     }
     switch (loggingMode) {
     case UPDATEMODE_PERIODIC:
-        // Set update period
-        setLoggingPeriod(obj, metadata.loggingUpdatePeriod);
+        // Set update period, none while the logging sampler records the object
+        setLoggingPeriod(obj, UAVObjIsLoggingSampled() ? 0 : metadata.loggingUpdatePeriod);
         // Connect queue
         eventMask |= EV_LOGGING_PERIODIC | EV_LOGGING_MANUAL;
         break;
@@ -290,10 +341,11 @@ static void updateObject(UAVObjHandle obj, int32_t eventType)
         break;
     }
     // note that all setting objects have implicitly IsPriority=true
+    // an object updated faster than it is sent has a single event in the queue, its latest data are sent
     if (UAVObjIsPriority(obj)) {
-        UAVObjConnectQueue(obj, priorityQueue, eventMask);
+        UAVObjConnectQueueCoalesced(obj, priorityQueue, eventMask);
     } else {
-        UAVObjConnectQueue(obj, queue, eventMask);
+        UAVObjConnectQueueCoalesced(obj, queue, eventMask);
     }
 }
 
@@ -322,7 +374,19 @@ static void processObjEvent(UAVObjEvent *ev)
         if ((ev->event == EV_UPDATED && (updateMode == UPDATEMODE_ONCHANGE || updateMode == UPDATEMODE_THROTTLED))
             || ev->event == EV_UPDATED_MANUAL
             || (ev->event == EV_UPDATED_PERIODIC && updateMode != UPDATEMODE_THROTTLED)) {
-            // Send update to GCS (with retries)
+            if (!UAVObjGetTelemetryAcked(&metadata)) {
+                if (UAVObjGetNumBytes(ev->obj) >= DELTA_MIN_LENGTH) {
+                    // Large objects usually change in a few fields only
+                    success = UAVTalkSendObjectDelta(uavTalkCon, ev->obj, ev->instId);
+                } else {
+                    // Unacked updates share frames, they go out once the queues are drained
+                    success = UAVTalkSendObjectBatched(uavTalkCon, ev->obj, ev->instId);
+                }
+            } else {
+                // The ack is waited for by telemetryTxTask, the objects queued behind go on meanwhile
+                success = UAVTalkSendObjectAsync(uavTalkCon, ev->obj, ev->instId);
+            }
+            // Send update to GCS (with retries) if the above failed, or too many acks are pending
             while (retries < MAX_RETRIES && success == -1) {
                 // call blocks until ack is received or timeout
                 success = UAVTalkSendObject(uavTalkCon, ev->obj, ev->instId, UAVObjGetTelemetryAcked(&metadata), REQ_TIMEOUT_MS);
@@ -336,7 +400,8 @@ static void processObjEvent(UAVObjEvent *ev)
                 ++txErrors;
             }
         } else if (ev->event == EV_UPDATE_REQ) {
-            // Request object update from GCS (with retries)
+            success = UAVTalkSendObjectRequestAsync(uavTalkCon, ev->obj, ev->instId);
+            // Request object update from GCS (with retries) if too many requests are pending
             while (retries < MAX_RETRIES && success == -1) {
                 // call blocks until update is received or timeout
                 success = UAVTalkSendObjectRequest(uavTalkCon, ev->obj, ev->instId, REQ_TIMEOUT_MS);
@@ -366,7 +431,8 @@ static void processObjEvent(UAVObjEvent *ev)
         updateMode = UAVObjGetLoggingUpdateMode(&metadata);
         if ((ev->event == EV_UPDATED && (updateMode == UPDATEMODE_ONCHANGE || updateMode == UPDATEMODE_THROTTLED))
             || ev->event == EV_LOGGING_MANUAL
-            || (ev->event == EV_LOGGING_PERIODIC && updateMode != UPDATEMODE_THROTTLED)) {
+            || (ev->event == EV_LOGGING_PERIODIC && updateMode != UPDATEMODE_THROTTLED
+                && !(updateMode == UPDATEMODE_PERIODIC && UAVObjIsLoggingSampled()))) {
             if (ev->instId == UAVOBJ_ALL_INSTANCES) {
                 success = UAVObjGetNumInstances(ev->obj);
                 for (retries = 0; retries < success; retries++) {
@@ -383,6 +449,16 @@ static void processObjEvent(UAVObjEvent *ev)
     }
 }
 
+/**
+ * Processes an event taken out of one of the queues
+ */
+static void processQueueEvent(xQueueHandle eventQueue, UAVObjEvent *ev)
+{
+    // The object updates from now on are queued again
+    UAVObjEventReceived(eventQueue, ev);
+    processObjEvent(ev);
+}
+
 /**
  * Telemetry transmit task, regular priority
  */
@@ -392,6 +468,9 @@ static void telemetryTxTask(__attribute__((unused)) void *parameters)
 
     // Loop forever
     while (1) {
+        // Send again the acked objects and requests which got no answer in time
+        UAVTalkProcessPendingTransactions(uavTalkCon, REQ_TIMEOUT_MS, MAX_RETRIES, &txRetries, &txErrors);
+
         /**
          * Tries to empty the high priority queue before handling any standard priority item
          */
@@ -399,22 +478,34 @@ static void telemetryTxTask(__attribute__((unused)) void *parameters)
         // empty priority queue, non-blocking
         while (xQueueReceive(priorityQueue, &ev, 0) == pdTRUE) {
             // Process event
-            processObjEvent(&ev);
+            processQueueEvent(priorityQueue, &ev);
         }
         // check regular queue and process update - non-blocking
         if (xQueueReceive(queue, &ev, 0) == pdTRUE) {
             // Process event
-            processObjEvent(&ev);
-            // if both queues are empty, wait on priority queue for updates (1 tick) then repeat cycle
-        } else if (xQueueReceive(priorityQueue, &ev, 1) == pdTRUE) {
-            // Process event
-            processObjEvent(&ev);
+            processQueueEvent(queue, &ev);
+        } else {
+            // both queues are empty, send batched updates before waiting
+            UAVTalkFlushBatch(uavTalkCon);
+            // wait on priority queue for updates (1 tick) then repeat cycle
+            if (xQueueReceive(priorityQueue, &ev, 1) == pdTRUE) {
+                // Process event
+                processQueueEvent(priorityQueue, &ev);
+            }
         }
 #else
-        // wait on queue for updates (1 tick) then repeat cycle
-        if (xQueueReceive(queue, &ev, 1) == pdTRUE) {
+        // check queue and process update - non-blocking
+        if (xQueueReceive(queue, &ev, 0) == pdTRUE) {
             // Process event
-            processObjEvent(&ev);
+            processQueueEvent(queue, &ev);
+        } else {
+            // queue is empty, send batched updates before waiting
+            UAVTalkFlushBatch(uavTalkCon);
+            // wait on queue for updates (1 tick) then repeat cycle
+            if (xQueueReceive(queue, &ev, 1) == pdTRUE) {
+                // Process event
+                processQueueEvent(queue, &ev);
+            }
         }
 #endif /* if defined(PIOS_TELEM_PRIORITY_QUEUE) */
     }
@@ -432,14 +523,12 @@ static void telemetryRxTask(__attribute__((unused)) void *parameters)
 
         if (inputPort) {
             // Block until data are available
-            uint8_t serial_data[1];
+            static uint8_t serial_data[RX_BUFFER_LENGTH];
             uint16_t bytes_to_process;
 
             bytes_to_process = PIOS_COM_ReceiveBuffer(inputPort, serial_data, sizeof(serial_data), 500);
             if (bytes_to_process > 0) {
-                for (uint8_t i = 0; i < bytes_to_process; i++) {
-                    UAVTalkProcessInputStream(uavTalkCon, serial_data[i]);
-                }
+                UAVTalkProcessInputStreamBuffer(uavTalkCon, serial_data, bytes_to_process);
             }
         } else {
             vTaskDelay(5);
@@ -457,14 +546,12 @@ static void radioRxTask(__attribute__((unused)) void *parameters)
     while (1) {
         if (radioPort) {
             // Block until data are available
-            uint8_t serial_data[1];
+            static uint8_t serial_data[RX_BUFFER_LENGTH];
             uint16_t bytes_to_process;
 
             bytes_to_process = PIOS_COM_ReceiveBuffer(radioPort, serial_data, sizeof(serial_data), 500);
             if (bytes_to_process > 0) {
-                for (uint8_t i = 0; i < bytes_to_process; i++) {
-                    UAVTalkProcessInputStream(radioUavTalkCon, serial_data[i]);
-                }
+                UAVTalkProcessInputStreamBuffer(radioUavTalkCon, serial_data, bytes_to_process);
             }
         } else {
             vTaskDelay(5);
@@ -533,6 +620,107 @@ static int32_t setUpdatePeriod(UAVObjHandle obj, int32_t updatePeriodMs)
     return ret;
 }
 
+/**
+ * Telemetry update period of an object at the current rate level. The flight
+ * state and control, the priority and acked objects and the metaobjects keep
+ * the period of their metadata, the navigation and sensor objects are halved
+ * at each level, the diagnostics and the settings quartered.
+ * \param[in] obj The object
+ * \param[in] metadata Its metadata
+ * \return The update period in ms
+ */
+static int32_t scaledUpdatePeriod(UAVObjHandle obj, UAVObjMetadata *metadata)
+{
+    int32_t period = metadata->telemetryUpdatePeriod;
+    uint8_t shift;
+
+    if (rateLevel == 0 || period <= 0 || UAVObjIsMetaobject(obj) || UAVObjGetTelemetryAcked(metadata)) {
+        return period;
+    }
+    if (UAVObjIsSettings(obj)) {
+        shift = 2;
+    } else if (UAVObjIsPriority(obj)) {
+        return period;
+    } else {
+        switch (UAVObjGetCategory(obj)) {
+        case UAVOBJ_CATEGORY_NAVIGATION:
+        case UAVOBJ_CATEGORY_SENSORS:
+            shift = 1;
+            break;
+        case UAVOBJ_CATEGORY_SYSTEM:
+            shift = 2;
+            break;
+        default:
+            return period;
+        }
+    }
+    period <<= rateLevel * shift;
+    return period > RATE_MAX_PERIOD_MS ? RATE_MAX_PERIOD_MS : period;
+}
+
+/**
+ * Apply the current rate level to an object, called for all of them on a level change
+ * \param[in] obj The object
+ */
+static void updateObjectRate(UAVObjHandle obj)
+{
+    if (!UAVObjIsMetaobject(obj)) {
+        updateObject(obj, EV_NONE);
+    }
+}
+
+/**
+ * Raise the rate level when the link did not keep up during the last stats
+ * period, i.e. the event queue was half full, acked updates failed or the
+ * radio failed to transmit, and lower it again once it has been calm for a
+ * while with the throughput under the one it was congested at.
+ * \param[in] txBytes Bytes sent during the last stats period
+ * \param[in] connected Whether the GCS is connected
+ */
+static void updateRateLevel(uint32_t txBytes, bool connected)
+{
+    uint8_t level  = rateLevel;
+    bool congested = txErrors > 0 || uxQueueMessagesWaiting(queue) >= MAX_QUEUE_SIZE / 2;
+
+#ifdef PIOS_INCLUDE_RFM22B
+    if (pios_rfm22b_id) {
+        struct rfm22b_stats radioStats;
+        PIOS_RFM22B_GetStats(pios_rfm22b_id, &radioStats);
+        // the counters are 8 bits and wrap
+        if ((uint8_t)(radioStats.tx_failure - radioTxFailures) > 0 || (uint8_t)(radioStats.timeouts - radioTimeouts) > 0) {
+            congested = true;
+        }
+        radioTxFailures = radioStats.tx_failure;
+        radioTimeouts   = radioStats.timeouts;
+    }
+#endif
+
+    if (!connected) {
+        // nothing is lost without a GCS, start over at full rate
+        level = 0;
+        rateCalmPeriods = 0;
+    } else if (congested) {
+        if (level < RATE_LEVEL_MAX) {
+            ++level;
+        }
+        rateCalmPeriods = 0;
+        rateCongestedTxBytes = txBytes;
+    } else if (level > 0 && ++rateCalmPeriods >= RATE_RECOVERY_PERIODS) {
+        rateCalmPeriods = 0;
+        // the next step up should fit in what the link carried when it choked
+        if (txBytes < rateCongestedTxBytes - rateCongestedTxBytes / 4) {
+            --level;
+        }
+    }
+
+    // the logging periods go too while the Logging module samples the objects
+    if (level != rateLevel || loggingSampled != UAVObjIsLoggingSampled()) {
+        rateLevel = level;
+        loggingSampled = UAVObjIsLoggingSampled();
+        UAVObjIterate(&updateObjectRate);
+    }
+}
+
 /**
  * Set logging update period of object (it must be already setup for periodic updates)
  * \param[in] obj The object to update
@@ -623,6 +811,7 @@ static void updateTelemetryStats()
         flightStats.RxSyncErrors = 0;
         flightStats.RxCrcErrors  = 0;
     }
+    updateRateLevel(utalkStats.txBytes, flightStats.Status == FLIGHTTELEMETRYSTATS_STATUS_CONNECTED);
     txErrors  = 0;
     txRetries = 0;
 
@@ -746,6 +935,83 @@ static uint32_t getComPort(__attribute__((unused)) bool input)
     }
 }
 
+#ifdef PIOS_TELEM_SETTINGS_MANIFEST
+/**
+ * Add all instances of a settings object to the manifest
+ * \param[in] obj Object to add
+ */
+static void addManifestObject(UAVObjHandle obj)
+{
+    if (!UAVObjIsSettings(obj)) {
+        return;
+    }
+    for (uint16_t instId = 0; instId < UAVObjGetNumInstances(obj); ++instId) {
+        setManifestEntry(obj, instId);
+    }
+}
+
+/**
+ * Update the CRC of a settings object instance in the manifest, adding the instance if needed.
+ * The manifest holds SETTINGSMANIFEST_CRC_NUMELEM entries per instance, in the order
+ * the objects were added. Called with the object manager lock held.
+ * \param[in] obj Object to update
+ * \param[in] instId Instance to update
+ */
+static void setManifestEntry(UAVObjHandle obj, uint16_t instId)
+{
+    UAVObjHandle manifest = SettingsManifestHandle();
+    uint32_t objId = UAVObjGetID(obj);
+    uint16_t entry;
+
+    for (entry = 0; entry < manifestEntries; ++entry) {
+        uint32_t entryObjId;
+        uint16_t entryInstId;
+        uint16_t n = entry % SETTINGSMANIFEST_OBJECTID_NUMELEM;
+        UAVObjGetInstanceDataField(manifest, entry / SETTINGSMANIFEST_OBJECTID_NUMELEM, &entryObjId,
+                                   offsetof(SettingsManifestData, ObjectID) + n * sizeof(entryObjId), sizeof(entryObjId));
+        if (entryObjId == objId) {
+            UAVObjGetInstanceDataField(manifest, entry / SETTINGSMANIFEST_OBJECTID_NUMELEM, &entryInstId,
+                                       offsetof(SettingsManifestData, InstanceID) + n * sizeof(entryInstId), sizeof(entryInstId));
+            if (entryInstId == instId) {
+                break;
+            }
+        }
+    }
+
+    uint16_t inst = entry / SETTINGSMANIFEST_OBJECTID_NUMELEM;
+    uint16_t n    = entry % SETTINGSMANIFEST_OBJECTID_NUMELEM;
+
+    if (entry == manifestEntries) {
+        // New object or instance, append it
+        if (inst >= UAVObjGetNumInstances(manifest)) {
+            SettingsManifestCreateInstance();
+            if (inst >= UAVObjGetNumInstances(manifest)) {
+                // out of memory, the GCS will retrieve what is missing from the manifest
+                return;
+            }
+        }
+        uint8_t count = n + 1;
+        UAVObjSetInstanceDataField(manifest, inst, &objId, offsetof(SettingsManifestData, ObjectID) + n * sizeof(objId), sizeof(objId));
+        UAVObjSetInstanceDataField(manifest, inst, &instId, offsetof(SettingsManifestData, InstanceID) + n * sizeof(instId), sizeof(instId));
+        UAVObjSetInstanceDataField(manifest, inst, &count, offsetof(SettingsManifestData, Entries), sizeof(count));
+        ++manifestEntries;
+    }
+
+    uint32_t crc = UAVObjUpdateCRC32(obj, instId, 0);
+    UAVObjSetInstanceDataField(manifest, inst, &crc, offsetof(SettingsManifestData, DataCRC) + n * sizeof(crc), sizeof(crc));
+}
+
+/**
+ * Called by the object manager on every write to a settings object
+ */
+void UAVObjSettingsUpdated(UAVObjHandle obj_handle, uint16_t instId)
+{
+    if (manifestReady) {
+        setManifestEntry(obj_handle, instId);
+    }
+}
+#endif /* PIOS_TELEM_SETTINGS_MANIFEST */
+
 /**
  * @}
  * @}
@@ -10,15 +10,26 @@ ifeq ($(USE_DSP_LIB), YES)
     DSPLIB_NAME		:= dsp
     CMSIS_DSPLIB	:= $(CMSIS_DIR)DSP_Lib/Source
 
-    # Compile all files into output directory
+    # Compile all files into output directory, or only the functions a board
+    # lists in DSPLIB_FUNCTIONS (source names without extension)
     DSPLIB_SRC		:= $(sort $(wildcard $(CMSIS_DSPLIB)/*/*.c))
-    DSPLIB_SRCBASE	:= $(notdir $(basename $(DSPLIB_SRC)))
+    DSPLIB_ASRC		:= $(sort $(wildcard $(CMSIS_DSPLIB)/*/*.S))
+    ifneq ($(DSPLIB_FUNCTIONS),)
+        DSPLIB_SRC	:= $(filter $(addprefix %/, $(addsuffix .c, $(DSPLIB_FUNCTIONS))), $(DSPLIB_SRC))
+        DSPLIB_ASRC	:= $(filter $(addprefix %/, $(addsuffix .S, $(DSPLIB_FUNCTIONS))), $(DSPLIB_ASRC))
+    endif
+    DSPLIB_SRCBASE	:= $(notdir $(basename $(DSPLIB_SRC) $(DSPLIB_ASRC)))
     $(foreach src, $(DSPLIB_SRC), $(eval $(call COMPILE_C_TEMPLATE, $(src))))
+    $(foreach src, $(DSPLIB_ASRC), $(eval $(call ASSEMBLE_TEMPLATE, $(src))))
 
     # Define the object files directory and a list of object files for the library
     DSPLIB_OBJDIR	= $(OUTDIR)
     DSPLIB_OBJ		= $(addprefix $(DSPLIB_OBJDIR)/, $(addsuffix .o, $(DSPLIB_SRCBASE)))
 
+    # The vendor sources are not held to the firmware warning flags
+    $(DSPLIB_OBJ) : CFLAGS += -Wno-error -Wno-float-equal -Wno-double-promotion -Wno-shadow
+    $(DSPLIB_OBJ) : CONLYFLAGS += -Wno-unsuffixed-float-constants
+
     # Create a library file
     $(eval $(call ARCHIVE_TEMPLATE, $(OUTDIR)/lib$(DSPLIB_NAME).a, $(DSPLIB_OBJ), $(DSPLIB_OBJDIR)))
 
@@ -1553,6 +1553,13 @@ void vTaskStepTick( const TickType_t xTicksToJump ) PRIVILEGED_FUNCTION;
 eSleepModeStatus eTaskConfirmSleepModeStatus( void ) PRIVILEGED_FUNCTION;
 
 UBaseType_t uxTaskGetRunTime( TaskHandle_t xTask );
+
+/*
+ * Returns the run time, the longest single run and the number of times the
+ * task was switched in since the last call, in run time counter units, and
+ * clears them. Only available with configGENERATE_RUN_TIME_STATS set.
+ */
+void vTaskGetRunTimeCounters( TaskHandle_t xTask, uint32_t *pulRunTime, uint32_t *pulMaxRunTime, uint32_t *pulSwitchCount );
 #ifdef __cplusplus
 }
 #endif
@@ -92,6 +92,9 @@ This approach is tested and works both on Linux and BSD style Unix (MAC OS X)
 
 */
 
+#ifdef __linux__
+#define _GNU_SOURCE /* for CPU pinning */
+#endif
 #include <pthread.h>
 #include <sched.h>
 #include <signal.h>
@@ -116,6 +119,9 @@ This approach is tested and works both on Linux and BSD style Unix (MAC OS X)
 #define PORT_ASSERT(assertion)    if ( !(assertion) ) { PORT_PRINT("Assertion failed in %s:%i  " #assertion "\n",__FILE__,__LINE__); int volatile assfail=0; assfail=assfail/assfail; }
 
 
+/* let the thread we wait for run, see prvYieldCPU() */
+#define PORT_YIELD_CPU() prvYieldCPU()
+
 #define PORT_LOCK(mutex) PORT_ASSERT( 0 == pthread_mutex_lock(&(mutex)) )
 #define PORT_TRYLOCK(mutex) pthread_mutex_trylock(&(mutex))
 #define PORT_UNLOCK(mutex) PORT_ASSERT( 0 == pthread_mutex_unlock(&(mutex)) )
@@ -160,6 +166,20 @@ static volatile portBASE_TYPE xPendYield = pdFALSE;
 static volatile portLONG lIndexOfLastAddedTask = 0;
 /*-----------------------------------------------------------*/
 
+/* Stepped ticks, given by a simulation running in lock-step with the firmware */
+static pthread_mutex_t xStepMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t xStepCond = PTHREAD_COND_INITIALIZER;
+static volatile portBASE_TYPE xSteppedTicks = pdFALSE;
+static portTickType xPendingTicks = 0;
+static portLONG lStepSliceUS = portTICK_RATE_MICROSECONDS;
+static unsigned long long ullSteppedTimeUS = 0;
+/* Virtual time, the ticks follow each other as soon as the tasks are idle */
+static volatile portBASE_TYPE xVirtualTicks = pdFALSE;
+
+/* Real time scheduling, the threads get SCHED_FIFO priorities that follow the task priorities */
+static volatile portBASE_TYPE xRealtime = pdFALSE;
+/*-----------------------------------------------------------*/
+
 /*
  * Setup the timer to generate the tick interrupts.
  */
@@ -172,6 +192,10 @@ static xThreadState* prvGetThreadHandleByThread( pthread_t hThread );
 static portLONG prvGetFreeThreadState( void );
 static void prvDeleteThread( void *xThreadId );
 static void prvPortYield();
+static void prvSteppedTick( void );
+static void prvRunSlice( void );
+static inline void prvYieldCPU( void );
+static void prvSetRealtimePriority( pthread_t hThread, unsigned portBASE_TYPE uxPriority );
 /*-----------------------------------------------------------*/
 
 /*
@@ -191,7 +215,7 @@ void vPortStartFirstTask( void );
  * (easierto debug than macros)
  */
 static inline void PORT_ENTER() {
-	while( prvGetThreadHandleByThread(pthread_self())->threadStatus!=THREAD_RUNNING) sched_yield();
+	while( prvGetThreadHandleByThread(pthread_self())->threadStatus!=THREAD_RUNNING) PORT_YIELD_CPU();
 	PORT_LOCK( xGuardMutex );
 	PORT_ASSERT( xSchedulerStarted?( prvGetThreadHandleByThread(pthread_self())==prvGetThreadHandle(xTaskGetCurrentTaskHandle()) ):pdTRUE )
 }
@@ -240,7 +264,7 @@ portSTACK_TYPE *pxPortInitialiseStack( portSTACK_TYPE *pxTopOfStack, pdTASK_CODE
 	PORT_ASSERT( 0 == pthread_create( &( pxThreads[ lIndexOfLastAddedTask ].hThread ), &xThreadAttributes, prvWaitForStart, (void *)pxThisThreadParams ) );
 
 	/* Let the task run a bit and wait until it suspends. */
-	while ( pxThreads[ lIndexOfLastAddedTask ].threadStatus == THREAD_STARTING ) sched_yield();
+	while ( pxThreads[ lIndexOfLastAddedTask ].threadStatus == THREAD_STARTING ) PORT_YIELD_CPU();
 
 	/* this ensures the sleeping thread reached deep sleep (and not more) */
 	PORT_UNLOCK( xYieldingThreadMutex );
@@ -295,6 +319,39 @@ portBASE_TYPE xPortStartScheduler( void )
 	 * Main scheduling loop. Call the tick handler every
 	 * portTICK_RATE_MICROSECONDS
 	 */
+#if defined( TIMER_ABSTIME )
+	/**
+	 * sleep until absolute deadlines, so neither the time the tick handler takes
+	 * nor the wake up latency add up into a drift of the tick period
+	 */
+	struct timespec xNextTick, xNow;
+	clock_gettime( CLOCK_MONOTONIC, &xNextTick );
+
+	while ( pdTRUE != xSchedulerEnd )
+	{
+		if ( xSteppedTicks ) {
+			prvSteppedTick();
+			/* resume free running ticks from now on */
+			clock_gettime( CLOCK_MONOTONIC, &xNextTick );
+			continue;
+		}
+
+		xNextTick.tv_nsec += 1000 * portTICK_RATE_MICROSECONDS;
+		if ( xNextTick.tv_nsec >= 1000000000 ) {
+			xNextTick.tv_nsec -= 1000000000;
+			xNextTick.tv_sec++;
+		}
+		while ( EINTR == clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &xNextTick, NULL ) );
+
+		vPortSystemTickHandler();
+
+		/* after a stall of the host drop the missed ticks rather than run them back to back */
+		clock_gettime( CLOCK_MONOTONIC, &xNow );
+		if ( 1000000 * ( xNow.tv_sec - xNextTick.tv_sec ) + ( xNow.tv_nsec - xNextTick.tv_nsec ) / 1000 > 3 * portTICK_RATE_MICROSECONDS ) {
+			xNextTick = xNow;
+		}
+	}
+#else /* if defined( TIMER_ABSTIME ) */
 	portLONG sleepTimeUS = portTICK_RATE_MICROSECONDS;
 	portLONG actualSleepTime;
 	struct timeval lastTime,currentTime;
@@ -303,6 +360,14 @@ portBASE_TYPE xPortStartScheduler( void )
 	
 	while ( pdTRUE != xSchedulerEnd )
 	{
+		if ( xSteppedTicks ) {
+			prvSteppedTick();
+			/* resume free running ticks from now on */
+			gettimeofday( &lastTime, NULL );
+			sleepTimeUS = portTICK_RATE_MICROSECONDS;
+			continue;
+		}
+
 		/* wait for the specified wait time */
 		wait.tv_sec = sleepTimeUS / 1000000;
 		wait.tv_nsec = 1000 * ( sleepTimeUS % 1000000 );
@@ -333,6 +398,7 @@ portBASE_TYPE xPortStartScheduler( void )
 		if (sleepTimeUS <=0 || sleepTimeUS >= 3 * portTICK_RATE_MICROSECONDS) sleepTimeUS = portTICK_RATE_MICROSECONDS;
 
 	}
+#endif /* if defined( TIMER_ABSTIME ) */
 
 	PORT_PRINT( "Cleaning Up, Exiting.\n" );
 	/* Cleanup the mutexes */
@@ -467,7 +533,7 @@ void prvPortYield()
 		 */
 		while ( xTaskToSuspend->threadStatus == THREAD_YIELDING ) {
 			pthread_kill( xTaskToSuspend->hThread, SIG_SUSPEND );
-			sched_yield();
+			PORT_YIELD_CPU();
 		}
 
 		/**
@@ -581,6 +647,232 @@ void vPortClearInterruptMask( portBASE_TYPE xMask )
 
 /*-----------------------------------------------------------*/
 
+/**
+ * In stepped mode the supervisor thread waits for ticks granted by vPortStepTicks(), runs
+ * the tick handler and then lets the tasks run for the step slice only, so the firmware
+ * runs faster than real time when the slice is shorter than the tick period.
+ * In virtual time every tick is granted, see prvRunSlice().
+ */
+static void prvSteppedTick( void )
+{
+	PORT_LOCK( xStepMutex );
+	while ( xSteppedTicks && !xVirtualTicks && xPendingTicks == 0 && pdTRUE != xSchedulerEnd ) {
+		pthread_cond_wait( &xStepCond, &xStepMutex );
+	}
+	if ( !xSteppedTicks || ( !xVirtualTicks && xPendingTicks == 0 ) ) {
+		PORT_UNLOCK( xStepMutex );
+		return;
+	}
+	ullSteppedTimeUS += portTICK_RATE_MICROSECONDS;
+	PORT_UNLOCK( xStepMutex );
+
+	vPortSystemTickHandler();
+	prvRunSlice();
+
+	PORT_LOCK( xStepMutex );
+	if ( xPendingTicks > 0 && --xPendingTicks == 0 ) {
+		pthread_cond_broadcast( &xStepCond );
+	}
+	PORT_UNLOCK( xStepMutex );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Let the tasks run after a stepped tick, for the step slice. In virtual time the
+ * slice ends as soon as the idle task runs, as nothing happens until the next tick.
+ */
+static void prvRunSlice( void )
+{
+	struct timespec wait;
+
+	if ( !xVirtualTicks ) {
+		wait.tv_sec = lStepSliceUS / 1000000;
+		wait.tv_nsec = 1000 * ( lStepSliceUS % 1000000 );
+		nanosleep( &wait, NULL );
+		return;
+	}
+
+	struct timespec now, end;
+	clock_gettime( CLOCK_MONOTONIC, &end );
+	end.tv_sec += lStepSliceUS / 1000000;
+	end.tv_nsec += 1000 * ( lStepSliceUS % 1000000 );
+	if ( end.tv_nsec >= 1000000000 ) {
+		end.tv_nsec -= 1000000000;
+		end.tv_sec++;
+	}
+	wait.tv_sec = 0;
+	wait.tv_nsec = 10000;
+	do {
+		nanosleep( &wait, NULL );
+#if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+		if ( xTaskGetCurrentTaskHandle() == xTaskGetIdleTaskHandle() ) {
+			return;
+		}
+#endif
+		clock_gettime( CLOCK_MONOTONIC, &now );
+	} while ( now.tv_sec < end.tv_sec || ( now.tv_sec == end.tv_sec && now.tv_nsec < end.tv_nsec ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Switch between free running ticks and ticks granted by vPortStepTicks()
+ * This ends virtual time, the simulation stepping the ticks takes over.
+ * \param[in] xEnable pdTRUE to step the ticks
+ * \param[in] lSliceUS Wall time the tasks get after each stepped tick
+ */
+void vPortSetSteppedTicks( portBASE_TYPE xEnable, portLONG lSliceUS )
+{
+	PORT_LOCK( xStepMutex );
+	xVirtualTicks = pdFALSE;
+	if ( xEnable && !xSteppedTicks ) {
+		/* the stepped time carries on from the wall time */
+		struct timespec now;
+		clock_gettime( CLOCK_REALTIME, &now );
+		ullSteppedTimeUS = (unsigned long long)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+	}
+	xSteppedTicks = xEnable;
+	if ( lSliceUS > 0 ) {
+		lStepSliceUS = lSliceUS;
+	}
+	if ( !xEnable ) {
+		xPendingTicks = 0;
+	}
+	pthread_cond_broadcast( &xStepCond );
+	PORT_UNLOCK( xStepMutex );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Grant xTicks ticks in stepped mode and wait for them to be run.
+ * Must not be called from a task, the ticks would never come.
+ */
+void vPortStepTicks( portTickType xTicks )
+{
+	PORT_LOCK( xStepMutex );
+	xPendingTicks += xTicks;
+	pthread_cond_broadcast( &xStepCond );
+	while ( xSteppedTicks && xPendingTicks > 0 && pdTRUE != xSchedulerEnd ) {
+		pthread_cond_wait( &xStepCond, &xStepMutex );
+	}
+	PORT_UNLOCK( xStepMutex );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Run in virtual time: each tick comes as soon as the tasks are idle, or after lSliceUS
+ * of wall time at most, and the time seen by the firmware is the tick count.
+ * The firmware then runs as fast as the host allows and its timing does not depend on
+ * the load of the host, which makes runs comparable.
+ * \param[in] lSliceUS Longest wall time the tasks get after each tick
+ */
+void vPortSetVirtualTicks( portLONG lSliceUS )
+{
+	vPortSetSteppedTicks( pdTRUE, lSliceUS );
+	PORT_LOCK( xStepMutex );
+	xVirtualTicks = pdTRUE;
+	pthread_cond_broadcast( &xStepCond );
+	PORT_UNLOCK( xStepMutex );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Schedule the firmware threads as real time threads, with SCHED_FIFO priorities above
+ * the ones of the host processes, and optionally keep them on one CPU.
+ * Must be called before the first task is created. Needs the privilege to use
+ * SCHED_FIFO (root, CAP_SYS_NICE or an rtprio limit), else the threads keep the
+ * default scheduling.
+ * \param[in] lCPU CPU to run on, or -1 to run on any
+ * \return pdTRUE if the real time priorities are in use
+ */
+portBASE_TYPE xPortSetRealtime( portLONG lCPU )
+{
+	struct sched_param xParam;
+
+	if ( lCPU >= 0 ) {
+#ifdef __linux__
+		/* the threads created from now on inherit the affinity of this one */
+		cpu_set_t xCPUs;
+		CPU_ZERO( &xCPUs );
+		CPU_SET( lCPU, &xCPUs );
+		if ( 0 != sched_setaffinity( 0, sizeof( xCPUs ), &xCPUs ) ) {
+			PORT_PRINT( "Can't run on CPU %ld\n", (long)lCPU );
+		}
+#else
+		PORT_PRINT( "CPU pinning is not supported on this host\n" );
+#endif
+	}
+
+	/* the supervisor thread gives the ticks, so it must preempt every task */
+	xParam.sched_priority = sched_get_priority_min( SCHED_FIFO ) + 1 + configMAX_PRIORITIES;
+	if ( 0 != pthread_setschedparam( pthread_self(), SCHED_FIFO, &xParam ) ) {
+		PORT_PRINT( "No real time scheduling, not allowed to use SCHED_FIFO\n" );
+		return pdFALSE;
+	}
+	xRealtime = pdTRUE;
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Give the thread of a task the SCHED_FIFO priority matching its task priority
+ */
+static void prvSetRealtimePriority( pthread_t hThread, unsigned portBASE_TYPE uxPriority )
+{
+	struct sched_param xParam;
+
+	if ( !xRealtime ) {
+		return;
+	}
+	xParam.sched_priority = sched_get_priority_min( SCHED_FIFO ) + 1 + uxPriority;
+	(void)pthread_setschedparam( hThread, SCHED_FIFO, &xParam );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Called by vTaskPrioritySet(), see traceTASK_PRIORITY_SET in portmacro.h
+ */
+void vPortSetTaskPriority( void *pxTaskHandle, unsigned portBASE_TYPE uxNewPriority )
+{
+	xThreadState *pxThread = prvGetThreadHandle( ( xTaskHandle )pxTaskHandle );
+
+	if ( pxThread ) {
+		prvSetRealtimePriority( pxThread->hThread, uxNewPriority );
+	}
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Wait for another thread to get on. With real time priorities sched_yield() would
+ * never give the CPU to a lower priority thread, so the thread sleeps instead, long
+ * enough for the other one to be switched in and handle its signal on a single CPU.
+ */
+static inline void prvYieldCPU( void )
+{
+	if ( xRealtime ) {
+		struct timespec wait = { 0, 20000 };
+		nanosleep( &wait, NULL );
+	} else {
+		sched_yield();
+	}
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * \param[out] pullTimeUS Time of the stepped ticks, in us
+ * \return pdTRUE in stepped mode, pdFALSE if the ticks follow the wall time
+ */
+portBASE_TYPE xPortGetSteppedTime( unsigned long long *pullTimeUS )
+{
+	if ( !xSteppedTicks ) {
+		return pdFALSE;
+	}
+	PORT_LOCK( xStepMutex );
+	*pullTimeUS = ullSteppedTimeUS;
+	PORT_UNLOCK( xStepMutex );
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
 /**
  * the tick handler is just an ordinary function, called by the supervisor thread periodically
  */
@@ -627,7 +919,7 @@ void vPortSystemTickHandler()
 	xTaskToSuspend->threadStatus = THREAD_PREEMPTING;
 	while ( xTaskToSuspend->threadStatus != THREAD_SLEEPING ) {
 		pthread_kill( xTaskToSuspend->hThread, SIG_SUSPEND );
-		sched_yield();
+		PORT_YIELD_CPU();
 	}
 
 	/**
@@ -749,7 +1041,7 @@ void *prvWaitForStart( void * pvParams )
 	 */
 	while ( myself->threadStatus == THREAD_STARTING ) {
 		pthread_kill( myself->hThread, SIG_SUSPEND );
-		sched_yield();
+		PORT_YIELD_CPU();
 	}
 
 	/**
@@ -887,7 +1179,7 @@ void prvResumeThread( xThreadState* xThreadId )
 	 */
 	while ( xThreadId->threadStatus != THREAD_WAKING ) {
 		pthread_cond_signal(& xThreadId->threadSleepCond);
-		sched_yield();
+		PORT_YIELD_CPU();
 	}
 	
 	PORT_UNLOCK( xResumingThreadMutex );
@@ -1043,6 +1335,7 @@ void vPortAddTaskHandle( void *pxTaskHandle )
 portLONG lIndex;
 
 	pxThreads[ lIndexOfLastAddedTask ].hTask = ( xTaskHandle )pxTaskHandle;
+	prvSetRealtimePriority( pxThreads[ lIndexOfLastAddedTask ].hThread, uxTaskPriorityGet( ( xTaskHandle )pxTaskHandle ) );
 	for ( lIndex = 0; lIndex < MAX_NUMBER_OF_TASKS; lIndex++ )
 	{
 		if ( pxThreads[ lIndex ].hThread == pxThreads[ lIndexOfLastAddedTask ].hThread )
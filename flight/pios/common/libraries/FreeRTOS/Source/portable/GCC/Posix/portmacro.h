@@ -118,6 +118,13 @@ extern void vPortYield( void );
 
 #define portYIELD()					vPortYield()
 
+/* Lock-step simulation support */
+extern void vPortSetSteppedTicks( portBASE_TYPE xEnable, portLONG lSliceUS );
+extern void vPortStepTicks( TickType_t xTicks );
+extern portBASE_TYPE xPortGetSteppedTime( unsigned long long *pullTimeUS );
+extern void vPortSetVirtualTicks( portLONG lSliceUS );
+extern portBASE_TYPE xPortSetRealtime( portLONG lCPU );
+
 #define portEND_SWITCHING_ISR( xSwitchRequired ) if( xSwitchRequired ) vPortYieldFromISR()
 /*-----------------------------------------------------------*/
 
@@ -158,6 +165,9 @@ extern void vPortForciblyEndThread( void *pxTaskToDelete );
 extern void vPortAddTaskHandle( void *pxTaskHandle );
 #define traceTASK_CREATE( pxNewTCB )			vPortAddTaskHandle( pxNewTCB )
 
+extern void vPortSetTaskPriority( void *pxTaskHandle, unsigned portBASE_TYPE uxNewPriority );
+#define traceTASK_PRIORITY_SET( pxTask, uxNewPriority )	vPortSetTaskPriority( pxTask, uxNewPriority )
+
 /* Posix Signal definitions that can be changed or read as appropriate. */
 #define SIG_SUSPEND					SIGUSR1
 
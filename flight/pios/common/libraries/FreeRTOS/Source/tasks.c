@@ -154,6 +154,8 @@ typedef struct tskTaskControlBlock
 
 	#if ( configGENERATE_RUN_TIME_STATS == 1 )
 		uint32_t		ulRunTimeCounter;	/*< Stores the amount of time the task has spent in the Running state. */
+		uint32_t		ulMaxRunTime;		/*< Stores the longest time the task stayed in the Running state before another task was switched in. */
+		uint32_t		ulSwitchCount;		/*< Stores the number of times the task was switched in. */
 	#endif
 
 	#if ( configUSE_NEWLIB_REENTRANT == 1 )
@@ -238,6 +240,7 @@ PRIVILEGED_DATA static volatile UBaseType_t uxSchedulerSuspended	= ( UBaseType_t
 
 	PRIVILEGED_DATA static uint32_t ulTaskSwitchedInTime = 0UL;	/*< Holds the value of a timer/counter the last time a task was switched in. */
 	PRIVILEGED_DATA static uint32_t ulTotalRunTime = 0UL;		/*< Holds the total amount of execution time as defined by the run time counter clock. */
+	PRIVILEGED_DATA static uint32_t ulTaskRunStartTime = 0UL;	/*< Holds the value of a timer/counter the last time a different task was switched in. */
 
 #endif
 
@@ -1827,6 +1830,23 @@ UBaseType_t uxTaskGetNumberOfTasks( void )
         return runTime;
     }
 
+    void vTaskGetRunTimeCounters( TaskHandle_t xTask, uint32_t *pulRunTime, uint32_t *pulMaxRunTime, uint32_t *pulSwitchCount )
+    {
+        tskTCB *pxTCB;
+        pxTCB = prvGetTCBFromHandle( xTask );
+
+        taskENTER_CRITICAL();
+        {
+            *pulRunTime     = pxTCB->ulRunTimeCounter;
+            *pulMaxRunTime  = pxTCB->ulMaxRunTime;
+            *pulSwitchCount = pxTCB->ulSwitchCount;
+            pxTCB->ulRunTimeCounter = 0;
+            pxTCB->ulMaxRunTime     = 0;
+            pxTCB->ulSwitchCount    = 0;
+        }
+        taskEXIT_CRITICAL();
+    }
+
 #endif
 
 #if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
@@ -2148,19 +2168,10 @@ void vTaskSwitchContext( void )
 
 				/* Add the amount of time the task has been running to the
 				accumulated	time so far.  The time the task started running was
-				stored in ulTaskSwitchedInTime.  Note that there is no overflow
-				protection here	so count values are only valid until the timer
-				overflows.  The guard against negative values is to protect
-				against suspect run time stat counter implementations - which
-				are provided by the application, not the kernel. */
-				if( ulTotalRunTime > ulTaskSwitchedInTime )
-				{
-					pxCurrentTCB->ulRunTimeCounter += ( ulTotalRunTime - ulTaskSwitchedInTime );
-				}
-				else
-				{
-					mtCOVERAGE_TEST_MARKER();
-				}
+				stored in ulTaskSwitchedInTime.  The run time counter is a free
+				running 32bit counter (DWT_CYCCNT) here, the unsigned difference
+				stays right across its overflow. */
+				pxCurrentTCB->ulRunTimeCounter += ( ulTotalRunTime - ulTaskSwitchedInTime );
 				ulTaskSwitchedInTime = ulTotalRunTime;
 		}
 		#endif /* configGENERATE_RUN_TIME_STATS */
@@ -2168,7 +2179,31 @@ void vTaskSwitchContext( void )
 		taskFIRST_CHECK_FOR_STACK_OVERFLOW();
 		taskSECOND_CHECK_FOR_STACK_OVERFLOW();
 
-		taskSELECT_HIGHEST_PRIORITY_TASK();
+		#if ( configGENERATE_RUN_TIME_STATS == 1 )
+		{
+			TCB_t * const pxPreviousTCB = pxCurrentTCB;
+
+			taskSELECT_HIGHEST_PRIORITY_TASK();
+
+			/* A task selected again keeps running, its run only ends when
+			another task is switched in. */
+			if( pxCurrentTCB != pxPreviousTCB )
+			{
+				const uint32_t ulRunTime = ulTotalRunTime - ulTaskRunStartTime;
+
+				if( ulRunTime > pxPreviousTCB->ulMaxRunTime )
+				{
+					pxPreviousTCB->ulMaxRunTime = ulRunTime;
+				}
+				ulTaskRunStartTime = ulTotalRunTime;
+				( pxCurrentTCB->ulSwitchCount )++;
+			}
+		}
+		#else
+		{
+			taskSELECT_HIGHEST_PRIORITY_TASK();
+		}
+		#endif /* configGENERATE_RUN_TIME_STATS */
 
 		traceTASK_SWITCHED_IN();
 
@@ -2781,6 +2816,8 @@ UBaseType_t x;
 	#if ( configGENERATE_RUN_TIME_STATS == 1 )
 	{
 		pxTCB->ulRunTimeCounter = 0UL;
+		pxTCB->ulMaxRunTime = 0UL;
+		pxTCB->ulSwitchCount = 0UL;
 	}
 	#endif /* configGENERATE_RUN_TIME_STATS */
 
@@ -142,6 +142,34 @@ xPortIncreaseHeapSize(size_t bytes)
 	msheap_extend(&sram_heap, bytes);
 }
 
+static uint32_t largest_free;
+
+static void
+largest_free_cb(__attribute__((unused)) void *ptr, uint32_t size, int free)
+{
+	if (free && size > largest_free) {
+		largest_free = size;
+	}
+}
+
+/*
+ * msheap does not keep the low water mark, the free space stands for it.
+ */
+void
+pios_mem_get_stats(struct pios_mem_stats *stats, uint8_t fastheap)
+{
+	heap_handle_t *heap = fastheap ? &fast_heap : &sram_heap;
+
+	memset(stats, 0, sizeof(*stats));
+	vPortEnterCritical();
+	largest_free = 0;
+	msheap_walk(heap, largest_free_cb);
+	stats->free = msheap_free_space(heap);
+	vPortExitCritical();
+	stats->min_free = stats->free;
+	stats->largest_free = largest_free;
+}
+
 #else /* !PIOS_INCLUDE_FREERTOS */
 int heap_init_done;
 void *
@@ -0,0 +1,7 @@
+#
+# Rules to add the TLSF allocator to a PiOS target
+#
+
+TLSF_DIR	:= $(dir $(lastword $(MAKEFILE_LIST)))
+SRC		+= $(sort $(wildcard $(TLSF_DIR)*.c))
+EXTRAINCDIRS	+= $(TLSF_DIR)
@@ -0,0 +1,170 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios_tlsf.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup PiOS
+ * @{
+ * @addtogroup PiOS
+ * @{
+ * @brief FreeRTOS and PiOS heaps in SRAM and in the fast (CCM) memory, on TLSF
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "tlsf.h"
+#include "pios_config.h"
+#include "pios.h"
+
+/*
+ * Symbols exported by the linker script telling us where the heaps are.
+ */
+extern char _sheap;
+extern char _eheap;
+
+#ifdef PIOS_TARGET_PROVIDES_FAST_HEAP
+extern char _sfastheap;
+extern char _efastheap;
+#endif
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+/*
+ * Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers.  That should only be done when
+ * task.h is included from an application file.
+ * */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+# include "FreeRTOS.h"
+# include "task.h"
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+static tlsf_heap_t sram_heap;
+#ifdef PIOS_TARGET_PROVIDES_FAST_HEAP
+static tlsf_heap_t fast_heap;
+#endif
+
+/*
+ * Optional callback for allocation failures.
+ */
+extern void vApplicationMallocFailedHook(void) __attribute__((weak));
+
+/*
+ * DMA does not reach the fast memory, so what may be a DMA buffer only comes
+ * from SRAM. The rest prefers the fast memory and spills over into SRAM once
+ * the fast memory is full.
+ */
+void *pios_general_malloc(size_t s, bool use_fast_heap)
+{
+    void *p = NULL;
+
+    vPortEnterCritical();
+#ifdef PIOS_TARGET_PROVIDES_FAST_HEAP
+    if (use_fast_heap) {
+        p = tlsf_alloc(&fast_heap, s);
+    }
+#else
+    (void)use_fast_heap;
+#endif
+    if (p == NULL) {
+        p = tlsf_alloc(&sram_heap, s);
+    }
+    vPortExitCritical();
+
+    if (p == NULL && &vApplicationMallocFailedHook != NULL) {
+        vApplicationMallocFailedHook();
+    }
+    return p;
+}
+
+void *pvPortMalloc(size_t s)
+{
+    return pios_general_malloc(s, true);
+}
+
+void *pvPortMallocStack(size_t s)
+{
+    return pios_general_malloc(s, false);
+}
+
+void vPortFree(void *p)
+{
+    vPortEnterCritical();
+#ifdef PIOS_TARGET_PROVIDES_FAST_HEAP
+    if (tlsf_contains(&fast_heap, p)) {
+        tlsf_free(&fast_heap, p);
+    } else
+#endif
+    {
+        tlsf_free(&sram_heap, p);
+    }
+    vPortExitCritical();
+}
+
+size_t xPortGetFreeHeapSize(void)
+{
+    struct pios_mem_stats stats;
+    size_t free;
+
+    pios_mem_get_stats(&stats, false);
+    free = stats.free;
+#ifdef PIOS_TARGET_PROVIDES_FAST_HEAP
+    pios_mem_get_stats(&stats, true);
+    free += stats.free;
+#endif
+    return free;
+}
+
+void vPortInitialiseBlocks(void)
+{
+    tlsf_init(&sram_heap, &_sheap, &_eheap);
+#ifdef PIOS_TARGET_PROVIDES_FAST_HEAP
+    tlsf_init(&fast_heap, &_sfastheap, &_efastheap);
+#endif
+}
+
+void pios_mem_get_stats(struct pios_mem_stats *stats, uint8_t fastheap)
+{
+    tlsf_heap_t *heap = &sram_heap;
+    struct tlsf_stats heap_stats;
+
+#ifdef PIOS_TARGET_PROVIDES_FAST_HEAP
+    if (fastheap) {
+        heap = &fast_heap;
+    }
+#else
+    if (fastheap) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+#endif
+
+    vPortEnterCritical();
+    tlsf_get_stats(heap, &heap_stats);
+    vPortExitCritical();
+
+    stats->free = heap_stats.free;
+    stats->min_free     = heap_stats.min_free;
+    stats->largest_free = heap_stats.largest_free;
+    stats->allocated    = heap_stats.allocated;
+    stats->failed = heap_stats.failed;
+}
+
+#endif /* PIOS_INCLUDE_FREERTOS */
+
+/**
+ * @}
+ * @}
+ */
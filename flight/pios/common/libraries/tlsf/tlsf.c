@@ -0,0 +1,382 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tlsf.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup PiOS
+ * @{
+ * @addtogroup PiOS
+ * @{
+ * @brief Two Level Segregated Fit allocator, constant time allocation and free
+ *
+ * After M. Masmano, I. Ripoll, A. Crespo and J. Real, "TLSF: a new dynamic
+ * memory allocator for real-time systems", ECRTS 2004.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <stddef.h>
+#include "tlsf.h"
+
+/*
+ * The block header. prev_phys lies in the last word of the previous block
+ * and is only valid while that block is free, size is the first word of the
+ * block, and the free list links are the first words of the payload.
+ */
+struct tlsf_block {
+    struct tlsf_block *prev_phys;
+    uint32_t size;
+    struct tlsf_block *next_free;
+    struct tlsf_block *prev_free;
+};
+
+#define BLOCK_FREE      0x1
+#define BLOCK_PREV_FREE 0x2
+#define BLOCK_FLAGS     (BLOCK_FREE | BLOCK_PREV_FREE)
+
+#define ALIGN_SIZE      (1 << TLSF_ALIGN_LOG2)
+#define SMALL_BLOCK     (1 << TLSF_FL_SHIFT)
+
+/* the size word is all a block in use costs, prev_phys is in the block before */
+#define BLOCK_PREV_SIZE offsetof(struct tlsf_block, size)
+#define BLOCK_START     offsetof(struct tlsf_block, next_free)
+#define BLOCK_OVERHEAD  (BLOCK_START - BLOCK_PREV_SIZE)
+
+/* the payload has to hold the free list links and the next prev_phys */
+#define BLOCK_SIZE_MIN  (sizeof(struct tlsf_block) - sizeof(struct tlsf_block *))
+#define BLOCK_SIZE_MAX  ((1u << TLSF_FL_MAX) - ALIGN_SIZE)
+
+static inline int fls32(uint32_t word)
+{
+    return 31 - __builtin_clz(word);
+}
+
+static inline int ffs32(uint32_t word)
+{
+    return __builtin_ctz(word);
+}
+
+static inline uint32_t block_size(const struct tlsf_block *block)
+{
+    return block->size & ~BLOCK_FLAGS;
+}
+
+static inline void block_set_size(struct tlsf_block *block, uint32_t size)
+{
+    block->size = size | (block->size & BLOCK_FLAGS);
+}
+
+static inline bool block_is_free(const struct tlsf_block *block)
+{
+    return block->size & BLOCK_FREE;
+}
+
+static inline bool block_is_prev_free(const struct tlsf_block *block)
+{
+    return block->size & BLOCK_PREV_FREE;
+}
+
+static inline void *block_to_ptr(const struct tlsf_block *block)
+{
+    return (uint8_t *)block + BLOCK_START;
+}
+
+static inline struct tlsf_block *ptr_to_block(const void *ptr)
+{
+    return (struct tlsf_block *)((uint8_t *)ptr - BLOCK_START);
+}
+
+/* the next block starts over the last word of this one */
+static inline struct tlsf_block *block_next(const struct tlsf_block *block)
+{
+    return (struct tlsf_block *)((uint8_t *)block_to_ptr(block) + block_size(block) - BLOCK_PREV_SIZE);
+}
+
+static inline struct tlsf_block *block_link_next(struct tlsf_block *block)
+{
+    struct tlsf_block *next = block_next(block);
+
+    next->prev_phys = block;
+    return next;
+}
+
+static inline void block_mark_free(struct tlsf_block *block)
+{
+    struct tlsf_block *next = block_link_next(block);
+
+    next->size  |= BLOCK_PREV_FREE;
+    block->size |= BLOCK_FREE;
+}
+
+static inline void block_mark_used(struct tlsf_block *block)
+{
+    struct tlsf_block *next = block_next(block);
+
+    next->size  &= ~BLOCK_PREV_FREE;
+    block->size &= ~BLOCK_FREE;
+}
+
+/* size class of a block of that size */
+static void mapping_insert(uint32_t size, int *fl, int *sl)
+{
+    if (size < SMALL_BLOCK) {
+        *fl = 0;
+        *sl = size / (SMALL_BLOCK / TLSF_SL_COUNT);
+    } else {
+        int f = fls32(size);
+        *sl = (size >> (f - TLSF_SL_COUNT_LOG2)) ^ TLSF_SL_COUNT;
+        *fl = f - (TLSF_FL_SHIFT - 1);
+    }
+}
+
+/* smallest size class whose blocks are all large enough */
+static void mapping_search(uint32_t size, int *fl, int *sl)
+{
+    if (size >= SMALL_BLOCK) {
+        size += (1u << (fls32(size) - TLSF_SL_COUNT_LOG2)) - 1;
+    }
+    mapping_insert(size, fl, sl);
+}
+
+static struct tlsf_block *search_suitable_block(tlsf_heap_t *heap, int *fl, int *sl)
+{
+    uint32_t sl_map = heap->sl_bitmap[*fl] & (~0u << *sl);
+
+    if (!sl_map) {
+        /* nothing in this power of two, go for the next one holding blocks */
+        uint32_t fl_map = (*fl + 1 < 32) ? heap->fl_bitmap & (~0u << (*fl + 1)) : 0;
+        if (!fl_map) {
+            return NULL;
+        }
+        *fl    = ffs32(fl_map);
+        sl_map = heap->sl_bitmap[*fl];
+    }
+    *sl = ffs32(sl_map);
+
+    return heap->blocks[*fl][*sl];
+}
+
+static void remove_free_block(tlsf_heap_t *heap, struct tlsf_block *block, int fl, int sl)
+{
+    struct tlsf_block *prev = block->prev_free;
+    struct tlsf_block *next = block->next_free;
+
+    if (next) {
+        next->prev_free = prev;
+    }
+    if (prev) {
+        prev->next_free = next;
+    } else {
+        /* head of its list */
+        heap->blocks[fl][sl] = next;
+        if (!next) {
+            heap->sl_bitmap[fl] &= ~(1u << sl);
+            if (!heap->sl_bitmap[fl]) {
+                heap->fl_bitmap &= ~(1u << fl);
+            }
+        }
+    }
+    heap->free -= block_size(block);
+}
+
+static void insert_free_block(tlsf_heap_t *heap, struct tlsf_block *block, int fl, int sl)
+{
+    struct tlsf_block *current = heap->blocks[fl][sl];
+
+    block->next_free = current;
+    block->prev_free = NULL;
+    if (current) {
+        current->prev_free = block;
+    }
+    heap->blocks[fl][sl] = block;
+    heap->fl_bitmap     |= (1u << fl);
+    heap->sl_bitmap[fl] |= (1u << sl);
+    heap->free += block_size(block);
+}
+
+static void block_remove(tlsf_heap_t *heap, struct tlsf_block *block)
+{
+    int fl, sl;
+
+    mapping_insert(block_size(block), &fl, &sl);
+    remove_free_block(heap, block, fl, sl);
+}
+
+static void block_insert(tlsf_heap_t *heap, struct tlsf_block *block)
+{
+    int fl, sl;
+
+    mapping_insert(block_size(block), &fl, &sl);
+    insert_free_block(heap, block, fl, sl);
+}
+
+/* give back the end of a block larger than needed */
+static void block_trim(tlsf_heap_t *heap, struct tlsf_block *block, uint32_t size)
+{
+    if (block_size(block) < size + sizeof(struct tlsf_block)) {
+        return;
+    }
+
+    struct tlsf_block *remaining = (struct tlsf_block *)((uint8_t *)block_to_ptr(block) + size - BLOCK_PREV_SIZE);
+
+    remaining->size = block_size(block) - (size + BLOCK_OVERHEAD);
+    block_set_size(block, size);
+    block_link_next(block);
+    block_mark_free(remaining);
+    block_insert(heap, remaining);
+}
+
+void tlsf_init(tlsf_heap_t *heap, void *base, void *limit)
+{
+    for (int fl = 0; fl < TLSF_FL_COUNT; fl++) {
+        for (int sl = 0; sl < TLSF_SL_COUNT; sl++) {
+            heap->blocks[fl][sl] = NULL;
+        }
+        heap->sl_bitmap[fl] = 0;
+    }
+    heap->fl_bitmap = 0;
+    heap->free      = 0;
+    heap->allocated = 0;
+    heap->failed    = 0;
+
+    uintptr_t start = ((uintptr_t)base + ALIGN_SIZE - 1) & ~(uintptr_t)(ALIGN_SIZE - 1);
+    uintptr_t end   = (uintptr_t)limit & ~(uintptr_t)(ALIGN_SIZE - 1);
+    uint32_t size   = (end > start + 2 * BLOCK_OVERHEAD + BLOCK_SIZE_MIN) ? end - start - 2 * BLOCK_OVERHEAD : 0;
+
+    if (size > BLOCK_SIZE_MAX) {
+        size = BLOCK_SIZE_MAX;
+    }
+
+    heap->base  = (void *)start;
+    heap->limit = (void *)(start + size + 2 * BLOCK_OVERHEAD);
+    heap->size  = size;
+
+    if (size) {
+        /* one free block over the whole heap, its prev_phys word lies before the heap */
+        struct tlsf_block *block = (struct tlsf_block *)(start + BLOCK_OVERHEAD - BLOCK_START);
+        block->size = size;
+        block_mark_free(block);
+        block_insert(heap, block);
+
+        /* followed by an empty block in use, so that it never merges past the end */
+        struct tlsf_block *sentinel = block_link_next(block);
+        sentinel->size = BLOCK_PREV_FREE;
+    }
+    heap->min_free = heap->free;
+}
+
+void *tlsf_alloc(tlsf_heap_t *heap, uint32_t size)
+{
+    if (size == 0 || size > BLOCK_SIZE_MAX) {
+        heap->failed++;
+        return NULL;
+    }
+
+    uint32_t adjusted = (size + ALIGN_SIZE - 1) & ~(ALIGN_SIZE - 1);
+    if (adjusted < BLOCK_SIZE_MIN) {
+        adjusted = BLOCK_SIZE_MIN;
+    }
+
+    int fl, sl;
+    mapping_search(adjusted, &fl, &sl);
+
+    struct tlsf_block *block = NULL;
+    if (fl < TLSF_FL_COUNT) {
+        block = search_suitable_block(heap, &fl, &sl);
+    }
+    if (!block) {
+        /* the last resort is a block of the same class that happens to be large enough */
+        mapping_insert(adjusted, &fl, &sl);
+        for (block = heap->blocks[fl][sl]; block && block_size(block) < adjusted; block = block->next_free) {
+            ;
+        }
+    }
+    if (!block) {
+        heap->failed++;
+        return NULL;
+    }
+
+    remove_free_block(heap, block, fl, sl);
+    block_trim(heap, block, adjusted);
+    block_mark_used(block);
+
+    heap->allocated++;
+    if (heap->free < heap->min_free) {
+        heap->min_free = heap->free;
+    }
+    return block_to_ptr(block);
+}
+
+void tlsf_free(tlsf_heap_t *heap, void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+
+    struct tlsf_block *block = ptr_to_block(ptr);
+
+    block_mark_free(block);
+
+    /* merge with the free blocks around it */
+    if (block_is_prev_free(block)) {
+        struct tlsf_block *prev = block->prev_phys;
+        block_remove(heap, prev);
+        block_set_size(prev, block_size(prev) + block_size(block) + BLOCK_OVERHEAD);
+        block_link_next(prev);
+        block = prev;
+    }
+
+    struct tlsf_block *next = block_next(block);
+    if (block_is_free(next)) {
+        block_remove(heap, next);
+        block_set_size(block, block_size(block) + block_size(next) + BLOCK_OVERHEAD);
+        block_link_next(block);
+    }
+
+    block_insert(heap, block);
+    heap->allocated--;
+}
+
+bool tlsf_contains(tlsf_heap_t *heap, void *ptr)
+{
+    return ptr >= heap->base && ptr < heap->limit;
+}
+
+void tlsf_get_stats(tlsf_heap_t *heap, struct tlsf_stats *stats)
+{
+    stats->size      = heap->size;
+    stats->free      = heap->free;
+    stats->min_free  = heap->min_free;
+    stats->allocated = heap->allocated;
+    stats->failed    = heap->failed;
+    stats->largest_free = 0;
+
+    /* the largest block is in the highest size class holding any */
+    if (heap->fl_bitmap) {
+        int fl = fls32(heap->fl_bitmap);
+        int sl = fls32(heap->sl_bitmap[fl]);
+        for (struct tlsf_block *block = heap->blocks[fl][sl]; block; block = block->next_free) {
+            if (block_size(block) > stats->largest_free) {
+                stats->largest_free = block_size(block);
+            }
+        }
+    }
+}
+
+/**
+ * @}
+ * @}
+ */
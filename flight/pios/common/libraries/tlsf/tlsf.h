@@ -0,0 +1,119 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tlsf.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup PiOS
+ * @{
+ * @addtogroup PiOS
+ * @{
+ * @brief Two Level Segregated Fit allocator, constant time allocation and free
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TLSF_H
+#define TLSF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * The free blocks are kept in lists by size class: a first level by power
+ * of two, a second level splitting each power of two in TLSF_SL_COUNT.
+ * Two bitmaps tell which lists hold blocks, so that finding a block large
+ * enough takes two bit scans whatever the state of the heap.
+ *
+ * A block carries its size and two flags in a word before the payload, and
+ * a free block also links to its neighbours in its list. The address of the
+ * block before it in memory is kept in the last word of that block while it
+ * is free, for the coalescing on free.
+ *
+ * Allocations are 4 byte aligned and cost 4 bytes of overhead. Heaps up to
+ * 2^TLSF_FL_MAX bytes are supported.
+ */
+#define TLSF_SL_COUNT_LOG2 3
+#define TLSF_SL_COUNT      (1 << TLSF_SL_COUNT_LOG2)
+#define TLSF_ALIGN_LOG2    2
+#define TLSF_FL_SHIFT      (TLSF_SL_COUNT_LOG2 + TLSF_ALIGN_LOG2)
+#define TLSF_FL_MAX        18
+#define TLSF_FL_COUNT      (TLSF_FL_MAX - TLSF_FL_SHIFT + 1)
+
+struct tlsf_block;
+
+/* heap handle, the free lists by size class */
+typedef struct {
+    struct tlsf_block *blocks[TLSF_FL_COUNT][TLSF_SL_COUNT];
+    uint32_t fl_bitmap;
+    uint8_t  sl_bitmap[TLSF_FL_COUNT];
+    void     *base;
+    void     *limit;
+    uint32_t size;
+    uint32_t free;
+    uint32_t min_free;
+    uint16_t allocated;
+    uint16_t failed;
+} tlsf_heap_t;
+
+/* state of a heap */
+struct tlsf_stats {
+    uint32_t size; /* bytes managed */
+    uint32_t free; /* bytes available */
+    uint32_t min_free; /* least bytes ever available */
+    uint32_t largest_free; /* largest allocation that can succeed */
+    uint16_t allocated; /* blocks in use */
+    uint16_t failed; /* allocations refused */
+};
+
+/**
+ * Initialise the heap.
+ *
+ * @param   heap        The heap handle.
+ * @param   base        The lower boundary of the heap.
+ * @param   limit       The upper boundary of the heap.
+ */
+extern void tlsf_init(tlsf_heap_t *heap, void *base, void *limit);
+
+/**
+ * Allocate memory from the heap.
+ *
+ * @param   size        The number of bytes required (more may be allocated).
+ * @return              The memory, NULL if no free block is large enough.
+ */
+extern void *tlsf_alloc(tlsf_heap_t *heap, uint32_t size);
+
+/**
+ * Free memory back to the heap, merging it with the free blocks around it.
+ *
+ * @param   ptr         Pointer being freed to the heap.
+ */
+extern void tlsf_free(tlsf_heap_t *heap, void *ptr);
+
+/**
+ * Tell whether the memory was allocated from this heap.
+ */
+extern bool tlsf_contains(tlsf_heap_t *heap, void *ptr);
+
+/**
+ * Get the statistics of the heap.
+ */
+extern void tlsf_get_stats(tlsf_heap_t *heap, struct tlsf_stats *stats);
+
+#endif /* TLSF_H */
+
+/**
+ * @}
+ * @}
+ */
@@ -30,6 +30,11 @@
 #include <utlist.h>
 #include <uavobjectmanager.h>
 #include <taskinfo.h>
+#ifdef PIOS_INCLUDE_INSTRUMENTATION
+#include <pios_instrumentation.h>
+#else
+#define PIOS_Instrumentation_TraceEvent(type, id)
+#endif
 
 // Private constants
 #define STACK_SAFETYCOUNT 16
@@ -49,6 +54,7 @@ struct DelayedCallbackTaskStruct {
     uint32_t    stackSize;
     DelayedCallbackPriorityTask priorityTask;
     xSemaphoreHandle signal;
+    bool deadlineMode;
     struct DelayedCallbackTaskStruct *next;
 };
 
@@ -66,6 +72,14 @@ struct DelayedCallbackInfoStruct {
     uint16_t stackSafetyCount;
     uint16_t currentSafetyCount;
     uint32_t runCount;
+    uint32_t deadlineTicks;
+    uint32_t volatile deadline;
+    uint32_t runTimeMax;
+    uint32_t deadlineMisses;
+    uint32_t volatile readyTime;
+    uint16_t runTimeHistogram[PIOS_CALLBACKSCHEDULER_HISTOGRAM_BUCKETS];
+    uint16_t latencyHistogram[PIOS_CALLBACKSCHEDULER_HISTOGRAM_BUCKETS];
+    DelayedCallbackPriority priority;
     struct DelayedCallbackTaskStruct *task;
     struct DelayedCallbackInfoStruct *next;
 };
@@ -79,6 +93,13 @@ static bool schedulerStarted;
 // Private functions
 static void CallbackSchedulerTask(void *task);
 static int32_t runNextCallback(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority);
+static int32_t runEarliestDeadline(struct DelayedCallbackTaskStruct *task);
+static void runCallback(DelayedCallbackInfo *current);
+static void markReady(DelayedCallbackInfo *info, uint32_t ticks);
+static void histogramAdd(uint16_t *histogram, uint32_t us);
+
+// upper limits of the timing histogram buckets in us, the last bucket takes the rest
+static const uint32_t histogramLimits[PIOS_CALLBACKSCHEDULER_HISTOGRAM_BUCKETS - 1] = { 10, 30, 100, 300, 1000, 3000, 10000 };
 
 /**
  * Initialize the scheduler
@@ -208,6 +229,9 @@ int32_t PIOS_CALLBACKSCHEDULER_Dispatch(DelayedCallbackInfo *cbinfo)
     PIOS_Assert(cbinfo);
 
     // no semaphore needed for the callback
+    if (!cbinfo->waiting) {
+        markReady(cbinfo, xTaskGetTickCount());
+    }
     cbinfo->waiting = true;
     // but the scheduler as a whole needs to be notified
     return xSemaphoreGive(cbinfo->task->signal);
@@ -232,11 +256,67 @@ int32_t PIOS_CALLBACKSCHEDULER_DispatchFromISR(DelayedCallbackInfo *cbinfo, long
     PIOS_Assert(cbinfo);
 
     // no semaphore needed for the callback
+    if (!cbinfo->waiting) {
+        markReady(cbinfo, xTaskGetTickCountFromISR());
+    }
     cbinfo->waiting = true;
     // but the scheduler as a whole needs to be notified
     return xSemaphoreGiveFromISR(cbinfo->task->signal, pxHigherPriorityTaskWoken);
 }
 
+/**
+ * Give a callback a period and a deadline.
+ * \param[in] *cbinfo the callback handle
+ * \param[in] periodMs The period the callback is dispatched at, 0 if not periodic
+ * \param[in] deadlineMs The relative deadline, 0 to use the period, 0 for both to remove the deadline
+ * \return Success (0), failure (-1)
+ */
+int32_t PIOS_CALLBACKSCHEDULER_SetDeadline(DelayedCallbackInfo *cbinfo, uint16_t periodMs, uint16_t deadlineMs)
+{
+    PIOS_Assert(cbinfo);
+
+    if (!deadlineMs) {
+        deadlineMs = periodMs;
+    }
+
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    cbinfo->deadlineTicks = deadlineMs / portTICK_RATE_MS;
+    if (deadlineMs && !cbinfo->deadlineTicks) {
+        cbinfo->deadlineTicks = 1; // zero means no deadline, use the shortest one instead
+    }
+
+    xSemaphoreGiveRecursive(mutex);
+
+    return 0;
+}
+
+/**
+ * Enable or disable earliest deadline first scheduling on a scheduler task.
+ * \param[in] priorityTask Task priority of the scheduler task, it must have been created already
+ * \param[in] enable Selects deadline mode
+ * \return Success (0), failure (-1)
+ */
+int32_t PIOS_CALLBACKSCHEDULER_SetDeadlineMode(DelayedCallbackPriorityTask priorityTask, bool enable)
+{
+    int32_t result = -1;
+
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    struct DelayedCallbackTaskStruct *task = NULL;
+    LL_FOREACH(schedulerTasks, task) {
+        if (task->priorityTask == priorityTask) {
+            task->deadlineMode = enable;
+            result = 0;
+            break;
+        }
+    }
+
+    xSemaphoreGiveRecursive(mutex);
+
+    return result;
+}
+
 /**
  * Register a new callback to be called by a delayed callback scheduler task.
  * If a scheduler task with the specified task priority does not exist yet, it
@@ -289,6 +369,7 @@ DelayedCallbackInfo *PIOS_CALLBACKSCHEDULER_Create(
         task->name[2]      = 0;
         task->stackSize    = stacksize;
         task->priorityTask = priorityTask;
+        task->deadlineMode = false;
         task->next = NULL;
 
         // create the signaling semaphore
@@ -341,6 +422,14 @@ DelayedCallbackInfo *PIOS_CALLBACKSCHEDULER_Create(
     info->cb = cb;
     info->callbackID         = callbackID;
     info->runCount           = 0;
+    info->deadlineTicks      = 0;
+    info->deadline           = 0;
+    info->runTimeMax         = 0;
+    info->deadlineMisses     = 0;
+    info->readyTime          = 0;
+    memset(info->runTimeHistogram, 0, sizeof(info->runTimeHistogram));
+    memset(info->latencyHistogram, 0, sizeof(info->latencyHistogram));
+    info->priority           = priority;
     info->stackSize          = stacksize - STACK_SIZE;
     info->stackNotFree       = info->stackSize;
     info->stackFree          = 0;
@@ -380,6 +469,10 @@ void PIOS_CALLBACKSCHEDULER_ForEachCallback(CallbackSchedulerCallbackInfoCallbac
                 info.is_running = true;
                 info.stack_remaining    = cbinfo->stackNotFree;
                 info.running_time_count = cbinfo->runCount;
+                info.worst_case_runtime_us = cbinfo->runTimeMax;
+                info.deadline_misses    = cbinfo->deadlineMisses;
+                memcpy(info.run_time_histogram, cbinfo->runTimeHistogram, sizeof(info.run_time_histogram));
+                memcpy(info.latency_histogram, cbinfo->latencyHistogram, sizeof(info.latency_histogram));
                 xSemaphoreGiveRecursive(mutex);
                 callback(cbinfo->callbackID, &info, context);
             }
@@ -499,6 +592,9 @@ static int32_t runNextCallback(struct DelayedCallbackTaskStruct *task, DelayedCa
             if (current->scheduletime) {
                 diff = current->scheduletime - xTaskGetTickCount();
                 if (diff <= 0) {
+                    if (!current->waiting) {
+                        markReady(current, current->scheduletime);
+                    }
                     current->waiting = true;
                 } else if (diff < result) {
                     result = diff; // adjust sleep time
@@ -510,14 +606,7 @@ static int32_t runNextCallback(struct DelayedCallbackTaskStruct *task, DelayedCa
                 current->waiting = false; // the flag is reset just before execution.
                 xSemaphoreGiveRecursive(mutex);
 
-                /* callback gets invoked here - check stack sizes */
-                markStack(current);
-
-                current->cb(); // call the callback
-
-                checkStack(current);
-
-                current->runCount++;
+                runCallback(current);
 
                 return 0;
             }
@@ -529,6 +618,118 @@ static int32_t runNextCallback(struct DelayedCallbackTaskStruct *task, DelayedCa
     return result;
 }
 
+/**
+ * Deadline mode scheduler subtask. The callback priorities are kept, within the
+ * highest priority that has a waiting callback the one with the earliest
+ * deadline runs, callbacks of that priority without a deadline after it.
+ * \param[in] task The scheduler task in question
+ * \return wait time until next scheduled callback is due - 0 if a callback has just been executed
+ */
+static int32_t runEarliestDeadline(struct DelayedCallbackTaskStruct *task)
+{
+    DelayedCallbackInfo *current;
+    uint32_t now = xTaskGetTickCount();
+
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    for (DelayedCallbackPriority p = 0; p <= CALLBACK_PRIORITY_LOW; p++) {
+        DelayedCallbackInfo *earliest = NULL;
+        bool waiting = false;
+        LL_FOREACH(task->callbackQueue[p], current) {
+            if (current->scheduletime && (int32_t)(current->scheduletime - now) <= 0) {
+                if (!current->waiting) {
+                    markReady(current, current->scheduletime);
+                }
+                current->waiting = true;
+            }
+            if (!current->waiting) {
+                continue;
+            }
+            waiting = true;
+            if (current->deadlineTicks && (!earliest || (int32_t)(current->deadline - earliest->deadline) < 0)) {
+                earliest = current;
+            }
+        }
+
+        if (earliest) {
+            earliest->scheduletime = 0; // any schedules are reset
+            earliest->waiting = false; // the flag is reset just before execution.
+            xSemaphoreGiveRecursive(mutex);
+
+            runCallback(earliest);
+
+            return 0;
+        }
+        if (waiting) {
+            xSemaphoreGiveRecursive(mutex);
+            return runNextCallback(task, p); // left to the round robin
+        }
+    }
+
+    xSemaphoreGiveRecursive(mutex);
+    return runNextCallback(task, CALLBACK_PRIORITY_CRITICAL);
+}
+
+/**
+ * Invoke a callback and collect its statistics
+ * \param[in] current The callback to run
+ */
+static void runCallback(DelayedCallbackInfo *current)
+{
+    /* callback gets invoked here - check stack sizes */
+    markStack(current);
+
+    histogramAdd(current->latencyHistogram, PIOS_DELAY_DiffuS(current->readyTime));
+
+    PIOS_Instrumentation_TraceEvent(PIOS_TRACE_EVENT_CALLBACK_BEGIN, current->callbackID);
+    uint32_t start = PIOS_DELAY_GetRaw();
+
+    current->cb(); // call the callback
+
+    uint32_t runTime = PIOS_DELAY_DiffuS(start);
+    PIOS_Instrumentation_TraceEvent(PIOS_TRACE_EVENT_CALLBACK_END, current->callbackID);
+
+    histogramAdd(current->runTimeHistogram, runTime);
+
+    checkStack(current);
+
+    current->runCount++;
+    if (runTime > current->runTimeMax) {
+        current->runTimeMax = runTime;
+    }
+    if (current->deadlineTicks && (int32_t)(xTaskGetTickCount() - current->deadline) > 0) {
+        current->deadlineMisses++;
+    }
+}
+
+/**
+ * Record the moment a callback became ready to run
+ * \param[in] *info the callback
+ * \param[in] ticks the tick count the deadline is relative to
+ */
+static void markReady(DelayedCallbackInfo *info, uint32_t ticks)
+{
+    info->deadline  = ticks + info->deadlineTicks;
+    info->readyTime = PIOS_DELAY_GetRaw();
+}
+
+/**
+ * Count a sample in a timing histogram
+ * \param[in] *histogram the histogram buckets
+ * \param[in] us the sample in microseconds
+ */
+static void histogramAdd(uint16_t *histogram, uint32_t us)
+{
+    uint8_t bucket = 0;
+
+    while (bucket < PIOS_CALLBACKSCHEDULER_HISTOGRAM_BUCKETS - 1 && us >= histogramLimits[bucket]) {
+        bucket++;
+    }
+    if (histogram[bucket] < UINT16_MAX) {
+        histogram[bucket]++;
+    }
+}
+
 /**
  * Scheduler task, responsible of invoking callbacks.
  * \param[in] task The scheduling task being run
@@ -538,7 +739,11 @@ static void CallbackSchedulerTask(void *task)
     uint32_t delay = 0;
 
     while (1) {
-        delay = runNextCallback((struct DelayedCallbackTaskStruct *)task, CALLBACK_PRIORITY_CRITICAL);
+        if (((struct DelayedCallbackTaskStruct *)task)->deadlineMode) {
+            delay = runEarliestDeadline((struct DelayedCallbackTaskStruct *)task);
+        } else {
+            delay = runNextCallback((struct DelayedCallbackTaskStruct *)task, CALLBACK_PRIORITY_CRITICAL);
+        }
         if (delay) {
             // nothing to do but sleep
             xSemaphoreTake(((struct DelayedCallbackTaskStruct *)task)->signal, delay);
@@ -32,7 +32,7 @@
 
 #ifdef PIOS_INCLUDE_COM
 
-#include "fifo_buffer.h"
+#include "spsc_ring.h"
 #include <pios_com_priv.h>
 
 #ifndef PIOS_INCLUDE_FREERTOS
@@ -57,8 +57,10 @@ struct pios_com_dev {
     bool has_rx;
     bool has_tx;
 
-    t_fifo_buffer rx;
-    t_fifo_buffer tx;
+    uint32_t rx_time; // PIOS_DELAY_GetuS() when bytes were last put in the rx fifo
+
+    t_spsc_ring rx;
+    t_spsc_ring tx;
 };
 
 static bool PIOS_COM_validate(struct pios_com_dev *com_dev)
@@ -105,6 +107,20 @@ static uint16_t PIOS_COM_RxInCallback(uint32_t context, uint8_t *buf, uint16_t b
 static void PIOS_COM_UnblockRx(struct pios_com_dev *com_dev, bool *need_yield);
 static void PIOS_COM_UnblockTx(struct pios_com_dev *com_dev, bool *need_yield);
 
+/**
+ * The rx and tx fifos are lock free rings, they need power of two sizes.
+ * Board buffers of other lengths are used up to the largest power of two that fits.
+ */
+static uint16_t PIOS_COM_RingSize(uint16_t buffer_len)
+{
+    uint16_t size = 0x8000;
+
+    while (size > buffer_len) {
+        size >>= 1;
+    }
+    return size;
+}
+
 /**
  * Initialises COM layer
  * \param[out] handle
@@ -137,7 +153,7 @@ int32_t PIOS_COM_Init(uint32_t *com_id, const struct pios_com_driver *driver, ui
     com_dev->has_tx   = has_tx;
 
     if (has_rx) {
-        fifoBuf_init(&com_dev->rx, rx_buffer, rx_buffer_len);
+        spscRing_init(&com_dev->rx, rx_buffer, PIOS_COM_RingSize(rx_buffer_len));
 #if defined(PIOS_INCLUDE_FREERTOS)
         vSemaphoreCreateBinary(com_dev->rx_sem);
 #endif /* PIOS_INCLUDE_FREERTOS */
@@ -145,12 +161,12 @@ int32_t PIOS_COM_Init(uint32_t *com_id, const struct pios_com_driver *driver, ui
         if (com_dev->driver->rx_start) {
             /* Start the receiver */
             (com_dev->driver->rx_start)(com_dev->lower_id,
-                                        fifoBuf_getFree(&com_dev->rx));
+                                        spscRing_getFree(&com_dev->rx));
         }
     }
 
     if (has_tx) {
-        fifoBuf_init(&com_dev->tx, tx_buffer, tx_buffer_len);
+        spscRing_init(&com_dev->tx, tx_buffer, PIOS_COM_RingSize(tx_buffer_len));
 #if defined(PIOS_INCLUDE_FREERTOS)
         vSemaphoreCreateBinary(com_dev->tx_sem);
 #endif /* PIOS_INCLUDE_FREERTOS */
@@ -216,19 +232,17 @@ static uint16_t PIOS_COM_RxInCallback(uint32_t context, uint8_t *buf, uint16_t b
 
     PIOS_Assert(valid);
     PIOS_Assert(com_dev->has_rx);
-    uint16_t bytes_into_fifo;
-    if (buf_len == 1) {
-        bytes_into_fifo = fifoBuf_putByte(&com_dev->rx, buf[0]);
-    } else {
-        bytes_into_fifo = fifoBuf_putData(&com_dev->rx, buf, buf_len);
-    }
+    uint16_t bytes_into_fifo = spscRing_putData(&com_dev->rx, buf, buf_len);
     if (bytes_into_fifo > 0) {
         /* Data has been added to the buffer */
+#if defined(PIOS_INCLUDE_DELAY)
+        com_dev->rx_time = PIOS_DELAY_GetuS();
+#endif
         PIOS_COM_UnblockRx(com_dev, need_yield);
     }
 
     if (headroom) {
-        *headroom = fifoBuf_getFree(&com_dev->rx);
+        *headroom = spscRing_getFree(&com_dev->rx);
     }
 
     return bytes_into_fifo;
@@ -245,7 +259,7 @@ static uint16_t PIOS_COM_TxOutCallback(uint32_t context, uint8_t *buf, uint16_t
     PIOS_Assert(buf_len);
     PIOS_Assert(com_dev->has_tx);
 
-    uint16_t bytes_from_fifo = fifoBuf_getData(&com_dev->tx, buf, buf_len);
+    uint16_t bytes_from_fifo = spscRing_getData(&com_dev->tx, buf, buf_len);
 
     if (bytes_from_fifo > 0) {
         /* More space has been made in the buffer */
@@ -253,7 +267,7 @@ static uint16_t PIOS_COM_TxOutCallback(uint32_t context, uint8_t *buf, uint16_t
     }
 
     if (headroom) {
-        *headroom = fifoBuf_getUsed(&com_dev->tx);
+        *headroom = spscRing_getUsed(&com_dev->tx);
     }
 
     return bytes_from_fifo;
@@ -291,27 +305,27 @@ static int32_t PIOS_COM_SendBufferNonBlockingInternal(struct pios_com_dev *com_d
     if (com_dev->driver->available && !com_dev->driver->available(com_dev->lower_id)) {
         /*
          * Underlying device is down/unconnected.
-         * Dump our fifo contents and act like an infinite data sink.
-         * Failure to do this results in stale data in the fifo as well as
-         * possibly having the caller block trying to send to a device that's
+         * Act like an infinite data sink, failure to do this results in
+         * the caller possibly blocking trying to send to a device that's
          * no longer accepting data.
+         * The fifo is left alone: only the driver side may remove data from
+         * it, whatever is left in it goes out once the device is back.
          */
-        fifoBuf_clearData(&com_dev->tx);
         return len;
     }
 
-    if (len > fifoBuf_getFree(&com_dev->tx)) {
+    if (len > spscRing_getFree(&com_dev->tx)) {
         /* Buffer cannot accept all requested bytes (retry) */
         return -2;
     }
 
-    uint16_t bytes_into_fifo = fifoBuf_putData(&com_dev->tx, buffer, len);
+    uint16_t bytes_into_fifo = spscRing_putData(&com_dev->tx, buffer, len);
 
     if (bytes_into_fifo > 0) {
         /* More data has been put in the tx buffer, make sure the tx is started */
         if (com_dev->driver->tx_start) {
             com_dev->driver->tx_start(com_dev->lower_id,
-                                      fifoBuf_getUsed(&com_dev->tx));
+                                      spscRing_getUsed(&com_dev->tx));
         }
     }
     return bytes_into_fifo;
@@ -375,7 +389,7 @@ int32_t PIOS_COM_SendBuffer(uint32_t com_id, const uint8_t *buffer, uint16_t len
         return -2;
     }
 #endif /* PIOS_INCLUDE_FREERTOS */
-    uint32_t max_frag_len  = fifoBuf_getSize(&com_dev->tx);
+    uint32_t max_frag_len  = spscRing_getSize(&com_dev->tx);
     uint32_t bytes_to_send = len;
     while (bytes_to_send) {
         uint32_t frag_size;
@@ -403,7 +417,7 @@ int32_t PIOS_COM_SendBuffer(uint32_t com_id, const uint8_t *buffer, uint16_t len
                 /* Make sure the transmitter is running while we wait */
                 if (com_dev->driver->tx_start) {
                     (com_dev->driver->tx_start)(com_dev->lower_id,
-                                                fifoBuf_getUsed(&com_dev->tx));
+                                                spscRing_getUsed(&com_dev->tx));
                 }
 #if defined(PIOS_INCLUDE_FREERTOS)
                 if (xSemaphoreTake(com_dev->tx_sem, 5000) != pdTRUE) {
@@ -541,7 +555,7 @@ uint16_t PIOS_COM_ReceiveBuffer(uint32_t com_id, uint8_t *buf, uint16_t buf_len,
     PIOS_Assert(com_dev->has_rx);
 
 check_again:
-    bytes_from_fifo = fifoBuf_getData(&com_dev->rx, buf, buf_len);
+    bytes_from_fifo = spscRing_getData(&com_dev->rx, buf, buf_len);
 
     if (bytes_from_fifo == 0) {
         /* No more bytes in receive buffer */
@@ -549,7 +563,7 @@ check_again:
         if (com_dev->driver->rx_start) {
             /* Notify the lower layer that there is now room in the rx buffer */
             (com_dev->driver->rx_start)(com_dev->lower_id,
-                                        fifoBuf_getFree(&com_dev->rx));
+                                        spscRing_getFree(&com_dev->rx));
         }
         if (timeout_ms > 0) {
 #if defined(PIOS_INCLUDE_FREERTOS)
@@ -570,6 +584,129 @@ check_again:
     return bytes_from_fifo;
 }
 
+/**
+ * Move the received bytes of a port straight into the tx fifo of another,
+ * span by span from one ring into the other with no buffer of the caller
+ * in between. Waits for received bytes as PIOS_COM_ReceiveBuffer, then for
+ * room in the tx fifo as PIOS_COM_SendBuffer. The caller must be the only
+ * reader of from_id.
+ * \param[in] from_id COM port to read from
+ * \param[in] to_id COM port to send to
+ * \param[in] timeout_ms how long to wait for received bytes
+ * \return -1 if a port is not available
+ * \return -2 if the tx mutex can't be taken
+ * \return -3 if the tx fifo did not drain in the max allotted time of 5000msec
+ * \return number of bytes forwarded on success
+ */
+int32_t PIOS_COM_ForwardBuffer(uint32_t from_id, uint32_t to_id, uint32_t timeout_ms)
+{
+    struct pios_com_dev *from_dev = (struct pios_com_dev *)from_id;
+    struct pios_com_dev *to_dev   = (struct pios_com_dev *)to_id;
+
+    if (!PIOS_COM_validate(from_dev) || !PIOS_COM_validate(to_dev)) {
+        /* Undefined COM port for this board (see pios_board.c) */
+        return -1;
+    }
+    PIOS_Assert(from_dev->has_rx);
+    PIOS_Assert(to_dev->has_tx);
+
+    while (spscRing_getUsed(&from_dev->rx) == 0) {
+        /* Make sure the receiver is running while we wait */
+        if (from_dev->driver->rx_start) {
+            (from_dev->driver->rx_start)(from_dev->lower_id,
+                                         spscRing_getFree(&from_dev->rx));
+        }
+        if (timeout_ms == 0) {
+            return 0;
+        }
+#if defined(PIOS_INCLUDE_FREERTOS)
+        if (xSemaphoreTake(from_dev->rx_sem, timeout_ms / portTICK_RATE_MS) != pdTRUE) {
+            return 0;
+        }
+        timeout_ms = 0;
+#else
+        PIOS_DELAY_WaitmS(1);
+        timeout_ms--;
+#endif
+    }
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+    if (xSemaphoreTake(to_dev->sendbuffer_sem, 5) != pdTRUE) {
+        return -2;
+    }
+#endif /* PIOS_INCLUDE_FREERTOS */
+
+    int32_t forwarded = 0;
+    const uint8_t *rx_span;
+    uint16_t rx_len;
+
+    while ((rx_len = spscRing_peek(&from_dev->rx, &rx_span)) > 0) {
+        if (to_dev->driver->available && !to_dev->driver->available(to_dev->lower_id)) {
+            /* Nobody listens on the other side, act as a sink as PIOS_COM_SendBuffer does */
+            spscRing_release(&from_dev->rx, rx_len);
+            forwarded += rx_len;
+            continue;
+        }
+
+        uint8_t *tx_span;
+        uint16_t len = spscRing_reserve(&to_dev->tx, &tx_span);
+        if (len == 0) {
+            /* Tx fifo is full, keep the transmitter running and wait for room */
+            if (to_dev->driver->tx_start) {
+                (to_dev->driver->tx_start)(to_dev->lower_id,
+                                           spscRing_getUsed(&to_dev->tx));
+            }
+#if defined(PIOS_INCLUDE_FREERTOS)
+            if (xSemaphoreTake(to_dev->tx_sem, 5000) != pdTRUE) {
+                xSemaphoreGive(to_dev->sendbuffer_sem);
+                return -3;
+            }
+#endif
+            continue;
+        }
+        if (len > rx_len) {
+            len = rx_len;
+        }
+        memcpy(tx_span, rx_span, len);
+        spscRing_commit(&to_dev->tx, len);
+        spscRing_release(&from_dev->rx, len);
+        forwarded += len;
+    }
+
+    if (to_dev->driver->tx_start && spscRing_getUsed(&to_dev->tx)) {
+        (to_dev->driver->tx_start)(to_dev->lower_id,
+                                   spscRing_getUsed(&to_dev->tx));
+    }
+#if defined(PIOS_INCLUDE_FREERTOS)
+    xSemaphoreGive(to_dev->sendbuffer_sem);
+#endif /* PIOS_INCLUDE_FREERTOS */
+
+    /* Notify the lower layer that there is now room in the rx buffer */
+    if (from_dev->driver->rx_start) {
+        (from_dev->driver->rx_start)(from_dev->lower_id,
+                                     spscRing_getFree(&from_dev->rx));
+    }
+
+    return forwarded;
+}
+
+/**
+ * Time the driver last delivered received bytes. With a driver that delivers
+ * on line idle, as the DMA driven USARTs, this is the end of the last message.
+ * \param[in] com_id COM port
+ * \return PIOS_DELAY_GetuS() at the last delivery, 0 if nothing was received yet
+ */
+uint32_t PIOS_COM_GetRxTime(uint32_t com_id)
+{
+    struct pios_com_dev *com_dev = (struct pios_com_dev *)com_id;
+
+    if (!PIOS_COM_validate(com_dev)) {
+        return 0;
+    }
+
+    return com_dev->rx_time;
+}
+
 /**
  * Query if a com port is available for use.  That can be
  * used to check a link is established even if the device
@@ -32,17 +32,27 @@
 #include "pios.h"
 #include "uavobjectmanager.h"
 #include "debuglogentry.h"
+#if defined(PIOS_INCLUDE_FREERTOS)
+#include "callbackinfo.h"
+#endif
 
 // global definitions
-
+#if defined(PIOS_INCLUDE_FREERTOS)
+#define WRITER_CALLBACK_PRIORITY CALLBACK_PRIORITY_LOW
+#define WRITER_CBTASK_PRIORITY   CALLBACK_TASK_AUXILIARY
+#define WRITER_STACK_SIZE_BYTES  512
+#endif
 
 // Global variables
+#if !defined(PIOS_USE_DEBUGLOG_ON_SDCARD)
 extern uintptr_t pios_user_fs_id; // flash filesystem for logging
+#endif
 
 #if defined(PIOS_INCLUDE_FREERTOS)
 static xSemaphoreHandle mutex = 0;
 #define mutexlock()   xSemaphoreTakeRecursive(mutex, portMAX_DELAY)
 #define mutexunlock() xSemaphoreGiveRecursive(mutex)
+static DelayedCallbackInfo *writerCallback;
 #else
 #define mutexlock()
 #define mutexunlock()
@@ -54,10 +64,20 @@ static bool log_is_full     = false;
 static uint8_t fails_count  = 0;
 static uint16_t flightnum   = 0;
 static uint16_t lognum = 0;
-static DebugLogEntryData *buffer = 0;
+/*
+ * Double buffering: producers fill buffer while the writer saves pending to
+ * flash. A full buffer becomes pending as soon as the writer is done with the
+ * previous one, entries that arrive before that are dropped instead of
+ * blocking the producer on the flash.
+ */
+static DebugLogEntryData *buffers  = 0;
+static DebugLogEntryData *buffer   = 0;
+static DebugLogEntryData *volatile pending = 0;
 #if !defined(PIOS_INCLUDE_FREERTOS)
-static DebugLogEntryData staticbuffer;
+static DebugLogEntryData staticbuffers[2];
 #endif
+static uint32_t bytes_written   = 0;
+static uint32_t dropped_entries = 0;
 
 #define LOG_ENTRY_MAX_DATA_SIZE (sizeof(((DebugLogEntryData *)0)->Data))
 #define LOG_ENTRY_HEADER_SIZE   (sizeof(DebugLogEntryData) - LOG_ENTRY_MAX_DATA_SIZE)
@@ -66,9 +86,57 @@ static DebugLogEntryData staticbuffer;
 
 static uint32_t used_buffer_space = 0;
 
+/*
+ * Compact encoding: a CompactUAVObjects entry holds a sequence of records,
+ * FlightTime is the time of the first one and Size the number of bytes used.
+ * Each record is a varint with the us elapsed since the previous record of
+ * the block followed by a tag byte, kind in the two upper bits and dictionary
+ * index in the lower ones, then
+ *  FULL:   the object data
+ *  DELTA:  a bitmap of the 32 bit words changed since the previous record of
+ *          the object, followed by the changed words
+ *  DEFINE: objid(4) instid(2) size(2) then the object data, assigns the index
+ *  RAW:    as DEFINE, for objects that did not fit in the dictionary
+ * The dictionary is defined once per flight and a DELTA is only used when the
+ * object already has a record in the same block, so each block decodes on its
+ * own given the definitions of its flight.
+ */
+#define LOG_COMPACT_KIND_FULL     0x00
+#define LOG_COMPACT_KIND_DELTA    0x40
+#define LOG_COMPACT_KIND_DEFINE   0x80
+#define LOG_COMPACT_KIND_RAW      0xC0
+#define LOG_COMPACT_DICT_SIZE     64
+#define LOG_COMPACT_DEFINE_SIZE   8
+#define LOG_COMPACT_MAX_VARINT    5
+#define LOG_COMPACT_MAX_DATA_SIZE (LOG_ENTRY_MAX_DATA_SIZE - LOG_COMPACT_MAX_VARINT - 1 - LOG_COMPACT_DEFINE_SIZE)
+
+struct log_dict_entry {
+    uint32_t objid;
+    uint16_t instid;
+    uint16_t size;
+    uint32_t block; // last block holding a record of this object
+    bool     defined; // definition written in the current flight
+    uint8_t  *prev; // data of the last record
+};
+
+static enum pios_debuglog_encoding encoding = PIOS_DEBUGLOG_ENCODING_FULL;
+static struct log_dict_entry *dictionary    = 0;
+static uint8_t dictionary_count = 0;
+static uint32_t block_count     = 1;
+static uint32_t last_record_time;
+
+// the records of a sample share its time, 0 outside a sample
+static uint32_t sample_time;
+#define LOG_RECORD_TIME() (sample_time ? sample_time : PIOS_DELAY_GetuS())
+
 /* Private Function Prototypes */
 static void enqueue_data(uint32_t objid, uint16_t instid, size_t size, uint8_t *data);
-static bool write_current_buffer();
+static void enqueue_compact(uint32_t objid, uint16_t instid, size_t size, uint8_t *data);
+static void reset_dictionary();
+static bool queue_current_buffer();
+#if !defined(PIOS_USE_DEBUGLOG_ON_SDCARD)
+static void write_pending_buffer();
+#endif
 /**
  * @brief Initialize the log facility
  */
@@ -76,24 +144,36 @@ void PIOS_DEBUGLOG_Initialize()
 {
 #if defined(PIOS_INCLUDE_FREERTOS)
     if (!mutex) {
-        mutex  = xSemaphoreCreateRecursiveMutex();
-        buffer = pios_malloc(sizeof(DebugLogEntryData));
+        mutex   = xSemaphoreCreateRecursiveMutex();
+        buffers = pios_malloc(2 * sizeof(DebugLogEntryData));
+#if !defined(PIOS_USE_DEBUGLOG_ON_SDCARD)
+        writerCallback = PIOS_CALLBACKSCHEDULER_Create(&write_pending_buffer, WRITER_CALLBACK_PRIORITY, WRITER_CBTASK_PRIORITY, CALLBACKINFO_RUNNING_DEBUGLOG, WRITER_STACK_SIZE_BYTES);
+#endif
     }
 #else
-    buffer = &staticbuffer;
+    buffers = staticbuffers;
 #endif
-    if (!buffer) {
+    if (!buffers) {
         return;
     }
     mutexlock();
+    buffer      = &buffers[0];
+    pending     = 0;
     lognum      = 0;
     flightnum   = 0;
     fails_count = 0;
     used_buffer_space = 0;
     log_is_full = false;
-    while (PIOS_FLASHFS_ObjLoad(pios_user_fs_id, LOG_GET_FLIGHT_OBJID(flightnum), lognum, (uint8_t *)buffer, sizeof(DebugLogEntryData)) == 0) {
+    reset_dictionary();
+#if defined(PIOS_USE_DEBUGLOG_ON_SDCARD)
+    PIOS_SDLOG_Init();
+#endif
+    while (PIOS_DEBUGLOG_Read(buffer, flightnum, lognum) == 0) {
         flightnum++;
     }
+#if defined(PIOS_USE_DEBUGLOG_ON_SDCARD)
+    PIOS_SDLOG_Prepare(flightnum);
+#endif
     mutexunlock();
 }
 
@@ -106,12 +186,39 @@ void PIOS_DEBUGLOG_Enable(uint8_t enabled)
 {
     // increase the flight num as soon as logging is disabled
     if (logging_enabled && !enabled) {
+        mutexlock();
+        // hand the rest of this flight over to the writer
+        if (used_buffer_space) {
+            queue_current_buffer();
+        }
         flightnum++;
         lognum = 0;
+        reset_dictionary();
+#if defined(PIOS_USE_DEBUGLOG_ON_SDCARD)
+        // finish this flight's file and allocate the next one while disarmed
+        PIOS_SDLOG_Prepare(flightnum);
+#endif
+        mutexunlock();
     }
     logging_enabled = enabled;
 }
 
+/**
+ * @brief Select how uavobject updates are encoded in the log
+ * @param[in] encoding to use for the following entries
+ */
+void PIOS_DEBUGLOG_SetEncoding(enum pios_debuglog_encoding new_encoding)
+{
+    mutexlock();
+    if (new_encoding != PIOS_DEBUGLOG_ENCODING_FULL && !dictionary) {
+        dictionary = pios_malloc(LOG_COMPACT_DICT_SIZE * sizeof(struct log_dict_entry));
+    }
+    // without a dictionary every record would be raw, full records are smaller then
+    encoding = dictionary ? new_encoding : PIOS_DEBUGLOG_ENCODING_FULL;
+    reset_dictionary();
+    mutexunlock();
+}
+
 /**
  * @brief Write a debug log entry with a uavobject
  * @param[in] objectid
@@ -127,10 +234,47 @@ void PIOS_DEBUGLOG_UAVObject(uint32_t objid, uint16_t instid, size_t size, uint8
     }
     mutexlock();
 
-    enqueue_data(objid, instid, size, data);
+    if (encoding == PIOS_DEBUGLOG_ENCODING_FULL) {
+        enqueue_data(objid, instid, size, data);
+    } else {
+        enqueue_compact(objid, instid, size, data);
+    }
 
     mutexunlock();
 }
+/**
+ * @brief Start a sample, the uavobjects logged until PIOS_DEBUGLOG_EndSample
+ * get the same timestamp and are kept in one block if they fit
+ * @param[in] size of the data of all the objects of the sample
+ * @param[in] count of objects in the sample
+ */
+void PIOS_DEBUGLOG_BeginSample(size_t size, uint16_t count)
+{
+    // held until the end of the sample
+    mutexlock();
+
+    // worst case per record: a full entry header, or a compact definition
+    size_t needed = size + count * MAX(LOG_ENTRY_HEADER_SIZE, LOG_COMPACT_MAX_VARINT + 1 + LOG_COMPACT_DEFINE_SIZE);
+    if (logging_enabled && buffer && used_buffer_space && needed <= LOG_ENTRY_MAX_DATA_SIZE &&
+        used_buffer_space + needed > LOG_ENTRY_MAX_DATA_SIZE) {
+        // if the writer is busy the records go where they fit, still with one timestamp
+        queue_current_buffer();
+    }
+    sample_time = PIOS_DELAY_GetuS();
+    if (!sample_time) {
+        sample_time = 1;
+    }
+}
+
+/**
+ * @brief End the sample started by PIOS_DEBUGLOG_BeginSample
+ */
+void PIOS_DEBUGLOG_EndSample(void)
+{
+    sample_time = 0;
+    mutexunlock();
+}
+
 /**
  * @brief Write a debug log entry with text
  * @param[in] format - as in printf
@@ -147,11 +291,15 @@ void PIOS_DEBUGLOG_Printf(char *format, ...)
     va_start(args, format);
     mutexlock();
     // flush any pending buffer before writing debug text
-    if (used_buffer_space) {
-        write_current_buffer();
+    if (used_buffer_space && !queue_current_buffer()) {
+        dropped_entries++;
+        mutexunlock();
+        va_end(args);
+        return;
     }
     memset(buffer->Data, 0xff, sizeof(buffer->Data));
     vsnprintf((char *)buffer->Data, sizeof(buffer->Data), (char *)format, args);
+    va_end(args);
     buffer->Flight     = flightnum;
 
     buffer->FlightTime = PIOS_DELAY_GetuS();
@@ -162,9 +310,9 @@ void PIOS_DEBUGLOG_Printf(char *format, ...)
     buffer->InstanceID = 0;
     buffer->Size       = strlen((const char *)buffer->Data);
 
-    if (PIOS_FLASHFS_ObjSave(pios_user_fs_id, LOG_GET_FLIGHT_OBJID(flightnum), lognum, (uint8_t *)buffer, sizeof(DebugLogEntryData)) == 0) {
-        lognum++;
-    }
+    // text entries don't share their block, if the writer is busy it is queued with the next entry
+    used_buffer_space  = LOG_ENTRY_MAX_DATA_SIZE;
+    queue_current_buffer();
     mutexunlock();
 }
 
@@ -184,7 +332,11 @@ void PIOS_DEBUGLOG_Printf(char *format, ...)
 int32_t PIOS_DEBUGLOG_Read(void *mybuffer, uint16_t flight, uint16_t inst)
 {
     PIOS_Assert(mybuffer);
+#if defined(PIOS_USE_DEBUGLOG_ON_SDCARD)
+    return PIOS_SDLOG_Read(flight, (uint32_t)inst * sizeof(DebugLogEntryData), (uint8_t *)mybuffer, sizeof(DebugLogEntryData));
+#else
     return PIOS_FLASHFS_ObjLoad(pios_user_fs_id, LOG_GET_FLIGHT_OBJID(flight), inst, (uint8_t *)mybuffer, sizeof(DebugLogEntryData));
+#endif
 }
 
 /**
@@ -202,8 +354,16 @@ void PIOS_DEBUGLOG_Info(uint16_t *flight, uint16_t *entry, uint16_t *free, uint1
     if (entry) {
         *entry = lognum;
     }
-    struct PIOS_FLASHFS_Stats stats = { 0, 0 };
+    struct PIOS_FLASHFS_Stats stats = { .num_free_slots = 0 };
+#if defined(PIOS_USE_DEBUGLOG_ON_SDCARD)
+    // report the current file in entries
+    uint32_t used_bytes, free_bytes;
+    PIOS_SDLOG_GetStats(&used_bytes, &free_bytes);
+    stats.num_active_slots = MIN(used_bytes / sizeof(DebugLogEntryData), UINT16_MAX);
+    stats.num_free_slots   = MIN(free_bytes / sizeof(DebugLogEntryData), UINT16_MAX);
+#else
     PIOS_FLASHFS_GetStats(pios_user_fs_id, &stats);
+#endif
     if (free) {
         *free = stats.num_free_slots;
     }
@@ -212,18 +372,39 @@ void PIOS_DEBUGLOG_Info(uint16_t *flight, uint16_t *entry, uint16_t *free, uint1
     }
 }
 
+/**
+ * @brief Retrieve the throughput counters of the logging system
+ * @param[out] bytes written to flash since startup
+ * @param[out] entries dropped since startup because the writer could not keep up
+ */
+void PIOS_DEBUGLOG_Counters(uint32_t *written, uint32_t *dropped)
+{
+    if (written) {
+        *written = bytes_written;
+    }
+    if (dropped) {
+        *dropped = dropped_entries;
+    }
+}
+
 /**
  * @brief Format entire flash memory!!!
  */
 void PIOS_DEBUGLOG_Format(void)
 {
     mutexlock();
+#if defined(PIOS_USE_DEBUGLOG_ON_SDCARD)
+    PIOS_SDLOG_Format();
+    PIOS_SDLOG_Prepare(0);
+#else
     PIOS_FLASHFS_Format(pios_user_fs_id);
+#endif
     lognum      = 0;
     flightnum   = 0;
     log_is_full = false;
     fails_count = 0;
     used_buffer_space = 0;
+    reset_dictionary();
     mutexunlock();
 }
 
@@ -231,56 +412,280 @@ void enqueue_data(uint32_t objid, uint16_t instid, size_t size, uint8_t *data)
 {
     DebugLogEntryData *entry;
 
+    if (size > sizeof(buffer->Data)) {
+        size = sizeof(buffer->Data);
+    }
+
+    // if the current block has no room left, hand it over to the writer and start a new one
+    if (used_buffer_space && (buffer->Type == DEBUGLOGENTRY_TYPE_COMPACTUAVOBJECTS ||
+                              used_buffer_space + size + LOG_ENTRY_HEADER_SIZE > LOG_ENTRY_MAX_DATA_SIZE)) {
+        if (!queue_current_buffer()) {
+            dropped_entries++;
+            return;
+        }
+    }
+
     // start a new block
     if (!used_buffer_space) {
         entry = buffer;
         memset(buffer->Data, 0xff, sizeof(buffer->Data));
         used_buffer_space += size;
     } else {
-        // if an instance is being filled and there is enough space, does enqueues new data.
-        if (used_buffer_space + size + LOG_ENTRY_HEADER_SIZE > LOG_ENTRY_MAX_DATA_SIZE) {
-            buffer->Type = DEBUGLOGENTRY_TYPE_MULTIPLEUAVOBJECTS;
-            if (!write_current_buffer()) {
-                return;
-            }
-            entry = buffer;
-            memset(buffer->Data, 0xff, sizeof(buffer->Data));
-            used_buffer_space += size;
-        } else {
-            entry = (DebugLogEntryData *)&buffer->Data[used_buffer_space];
-            used_buffer_space += size + LOG_ENTRY_HEADER_SIZE;
-        }
+        // there is enough space in the instance being filled, enqueue new data.
+        entry = (DebugLogEntryData *)&buffer->Data[used_buffer_space];
+        used_buffer_space += size + LOG_ENTRY_HEADER_SIZE;
     }
 
     entry->Flight     = flightnum;
-    entry->FlightTime = PIOS_DELAY_GetuS();
+    entry->FlightTime = LOG_RECORD_TIME();
     entry->Entry = lognum;
     entry->Type = DEBUGLOGENTRY_TYPE_UAVOBJECT;
     entry->ObjectID   = objid;
     entry->InstanceID = instid;
-    if (size > sizeof(buffer->Data)) {
-        size = sizeof(buffer->Data);
-    }
     entry->Size = size;
 
     memcpy(entry->Data, data, size);
+
+    if (entry != buffer) {
+        buffer->Type = DEBUGLOGENTRY_TYPE_MULTIPLEUAVOBJECTS;
+    }
+}
+
+/**
+ * Forget which objects were defined, the next record of each one carries its
+ * definition again. Called with the lock held.
+ */
+void reset_dictionary()
+{
+    for (uint8_t i = 0; i < dictionary_count; i++) {
+        dictionary[i].defined = false;
+    }
+}
+
+/**
+ * Find the dictionary entry of an object instance, adding it if there is room.
+ * Returns NULL if the object has to be stored raw.
+ */
+static struct log_dict_entry *lookup_dictionary(uint32_t objid, uint16_t instid, uint16_t size)
+{
+    for (uint8_t i = 0; i < dictionary_count; i++) {
+        if (dictionary[i].objid == objid && dictionary[i].instid == instid) {
+            return (dictionary[i].size == size) ? &dictionary[i] : NULL;
+        }
+    }
+    if (dictionary_count >= LOG_COMPACT_DICT_SIZE) {
+        return NULL;
+    }
+    uint8_t *prev = pios_malloc(size);
+    if (!prev) {
+        return NULL;
+    }
+    struct log_dict_entry *dict = &dictionary[dictionary_count++];
+    dict->objid   = objid;
+    dict->instid  = instid;
+    dict->size    = size;
+    dict->block   = 0;
+    dict->defined = false;
+    dict->prev    = prev;
+    return dict;
+}
+
+static uint8_t varint_size(uint32_t value)
+{
+    uint8_t len = 1;
+
+    while (value >= 0x80) {
+        value >>= 7;
+        len++;
+    }
+    return len;
+}
+
+/**
+ * Pick the smallest record kind usable for this update in the current block
+ * and return the record size without the timestamp.
+ */
+static uint16_t compact_record_size(const struct log_dict_entry *dict, uint16_t size, const uint8_t *data, uint8_t *kind)
+{
+    if (!dict || !dict->defined) {
+        *kind = dict ? LOG_COMPACT_KIND_DEFINE : LOG_COMPACT_KIND_RAW;
+        return 1 + LOG_COMPACT_DEFINE_SIZE + size;
+    }
+    *kind = LOG_COMPACT_KIND_FULL;
+    if (encoding != PIOS_DEBUGLOG_ENCODING_COMPACTDELTA || dict->block != block_count) {
+        return 1 + size;
+    }
+    uint16_t delta = ((size + 3) / 4 + 7) / 8;
+    for (uint16_t i = 0; i < size; i += 4) {
+        uint16_t len = MIN(4, size - i);
+        if (memcmp(&dict->prev[i], &data[i], len)) {
+            delta += len;
+        }
+    }
+    if (delta < size) {
+        *kind = LOG_COMPACT_KIND_DELTA;
+        return 1 + delta;
+    }
+    return 1 + size;
 }
 
-bool write_current_buffer()
+void enqueue_compact(uint32_t objid, uint16_t instid, size_t size, uint8_t *data)
 {
-    // not enough space, write the block and start a new one
-    if (PIOS_FLASHFS_ObjSave(pios_user_fs_id, LOG_GET_FLIGHT_OBJID(flightnum), lognum, (uint8_t *)buffer, sizeof(DebugLogEntryData)) == 0) {
-        lognum++;
-        fails_count = 0;
-        used_buffer_space = 0;
+    struct log_dict_entry *dict;
+    uint32_t now = LOG_RECORD_TIME();
+    uint16_t len;
+    uint8_t kind;
+
+    if (size > LOG_COMPACT_MAX_DATA_SIZE) {
+        size = LOG_COMPACT_MAX_DATA_SIZE;
+    }
+    dict = lookup_dictionary(objid, instid, size);
+
+    len  = compact_record_size(dict, size, data, &kind);
+    // full entries can't share a block with compact records, switch block when there is no room left too
+    if (used_buffer_space && (buffer->Type != DEBUGLOGENTRY_TYPE_COMPACTUAVOBJECTS ||
+                              used_buffer_space + varint_size(now - last_record_time) + len > LOG_ENTRY_MAX_DATA_SIZE)) {
+        if (!queue_current_buffer()) {
+            dropped_entries++;
+            return;
+        }
+        // a delta can't cross blocks
+        len = compact_record_size(dict, size, data, &kind);
+    }
+
+    if (!used_buffer_space) {
+        memset(buffer->Data, 0xff, sizeof(buffer->Data));
+        buffer->Flight     = flightnum;
+        buffer->FlightTime = now;
+        buffer->Entry      = lognum;
+        buffer->Type       = DEBUGLOGENTRY_TYPE_COMPACTUAVOBJECTS;
+        buffer->ObjectID   = 0;
+        buffer->InstanceID = 0;
+        last_record_time   = now;
+    }
+
+    uint8_t *out   = &buffer->Data[used_buffer_space];
+    uint32_t delta = now - last_record_time;
+    while (delta >= 0x80) {
+        *out++  = (delta & 0x7F) | 0x80;
+        delta >>= 7;
+    }
+    *out++ = delta;
+    *out++ = kind | (dict ? (uint8_t)(dict - dictionary) : 0);
+
+    switch (kind) {
+    case LOG_COMPACT_KIND_DEFINE:
+    case LOG_COMPACT_KIND_RAW:
+    {
+        uint16_t size16 = size;
+        memcpy(&out[0], &objid, sizeof(objid));
+        memcpy(&out[4], &instid, sizeof(instid));
+        memcpy(&out[6], &size16, sizeof(size16));
+        out += LOG_COMPACT_DEFINE_SIZE;
+    }
+    // fall through
+    case LOG_COMPACT_KIND_FULL:
+        memcpy(out, data, size);
+        out += size;
+        break;
+    case LOG_COMPACT_KIND_DELTA:
+    {
+        uint8_t *bitmap = out;
+        uint16_t words  = (size + 3) / 4;
+        memset(bitmap, 0, (words + 7) / 8);
+        out += (words + 7) / 8;
+        for (uint16_t i = 0; i < words; i++) {
+            uint16_t wlen = MIN(4, size - i * 4);
+            if (memcmp(&dict->prev[i * 4], &data[i * 4], wlen)) {
+                bitmap[i / 8] |= 1 << (i % 8);
+                memcpy(out, &data[i * 4], wlen);
+                out += wlen;
+            }
+        }
+        break;
+    }
+    }
+
+    if (dict) {
+        memcpy(dict->prev, data, size);
+        dict->defined = true;
+        dict->block   = block_count;
+    }
+    last_record_time  = now;
+    used_buffer_space = out - buffer->Data;
+    buffer->Size = used_buffer_space;
+}
+
+/**
+ * Hand the current block over to the writer, returns false if the writer
+ * is still busy with the previous one. Called with the lock held.
+ */
+bool queue_current_buffer()
+{
+#if defined(PIOS_USE_DEBUGLOG_ON_SDCARD)
+    // the sd card log does its own buffering, blocks are only copied here
+    if (PIOS_SDLOG_Write(buffer->Flight, (uint8_t *)buffer, sizeof(DebugLogEntryData)) != 0) {
+        return false;
+    }
+    bytes_written += sizeof(DebugLogEntryData);
+    lognum++;
+    block_count++;
+    used_buffer_space = 0;
+    return true;
+#else
+    if (pending) {
+        return false;
+    }
+
+    pending = buffer;
+    buffer  = (buffer == &buffers[0]) ? &buffers[1] : &buffers[0];
+    lognum++;
+    block_count++;
+    used_buffer_space = 0;
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+    PIOS_CALLBACKSCHEDULER_Dispatch(writerCallback);
+#else
+    write_pending_buffer();
+#endif
+    return true;
+#endif /* PIOS_USE_DEBUGLOG_ON_SDCARD */
+}
+
+#if !defined(PIOS_USE_DEBUGLOG_ON_SDCARD)
+
+/**
+ * Write the pending block to flash, without holding the lock so producers can
+ * keep filling the other buffer meanwhile.
+ */
+void write_pending_buffer()
+{
+    DebugLogEntryData *block = pending;
+    bool lost_definitions    = false;
+
+    if (!block) {
+        return;
+    }
+
+    if (PIOS_FLASHFS_ObjSave(pios_user_fs_id, LOG_GET_FLIGHT_OBJID(block->Flight), block->Entry, (uint8_t *)block, sizeof(DebugLogEntryData)) == 0) {
+        bytes_written += sizeof(DebugLogEntryData);
+        fails_count    = 0;
     } else {
         if (fails_count++ > MAX_CONSECUTIVE_FAILS_COUNT) {
             log_is_full = true;
         }
-        return false;
+        // the lost block may have carried definitions
+        lost_definitions = (block->Type == DEBUGLOGENTRY_TYPE_COMPACTUAVOBJECTS);
     }
-    return true;
+
+    mutexlock();
+    if (lost_definitions) {
+        reset_dictionary();
+    }
+    pending = 0;
+    mutexunlock();
 }
+#endif /* PIOS_USE_DEBUGLOG_ON_SDCARD */
 /**
  * @}
  * @}
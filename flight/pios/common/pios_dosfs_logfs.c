@@ -148,6 +148,30 @@ int32_t PIOS_FLASHFS_ObjSave(__attribute__((unused)) uintptr_t fs_id, uint32_t o
     return 0;
 }
 
+/**
+ * @brief Saves a batch of object instances to the filesystem
+ * @param[in] fs_id The filesystem to use for this action
+ * @param[in] next Called for every object instance to save until it returns false
+ * @param[in] context Passed on to next
+ * @return 0 if success or the error code of the first object that failed to save
+ */
+int32_t PIOS_FLASHFS_ObjSaveBatch(uintptr_t fs_id, PIOS_FLASHFS_ObjIterator next, void *context)
+{
+    uint32_t obj_id;
+    uint16_t obj_inst_id;
+    uint8_t *obj_data;
+    uint16_t obj_size;
+
+    while (next(context, &obj_id, &obj_inst_id, &obj_data, &obj_size)) {
+        int32_t rc = PIOS_FLASHFS_ObjSave(fs_id, obj_id, obj_inst_id, obj_data, obj_size);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    return 0;
+}
+
 /**
  * @brief Load one object instance from the filesystem
  * @param[in] fs_id The filesystem to use for this action
@@ -258,9 +282,21 @@ int32_t PIOS_FLASHFS_Format(__attribute__((unused)) uintptr_t fs_id)
  * @return 0 if success or error code
  * @retval -1 if fs_id is not a valid filesystem instance
  */
-int32_t PIOS_FLASHFS_GetStats(__attribute__((unused)) uintptr_t fs_id, __attribute__((unused)) struct PIOS_FLASHFS_Stats *stats)
+int32_t PIOS_FLASHFS_GetStats(__attribute__((unused)) uintptr_t fs_id, struct PIOS_FLASHFS_Stats *stats)
 {
     /* stub - not implemented */
+    memset(stats, 0, sizeof(*stats));
+    return 0;
+}
+
+/**
+ * @brief Performs one step of background maintenance on the filesystem
+ * @param[in] fs_id The filesystem to use for this action
+ * @return 0 if idle
+ */
+int32_t PIOS_FLASHFS_Maintain(__attribute__((unused)) uintptr_t fs_id)
+{
+    /* stub - nothing to maintain */
     return 0;
 }
 
@@ -71,6 +71,10 @@ struct jedec_flash_dev {
     const struct pios_flash_jedec_cfg *cfg;
 #if defined(FLASH_FREERTOS)
     xSemaphoreHandle transaction_lock;
+#endif
+#if defined(PIOS_SPI_TRANSACTIONS)
+    xSemaphoreHandle transfer_done;
+    int32_t transfer_result;
 #endif
     enum pios_jedec_dev_magic magic;
 };
@@ -87,6 +91,7 @@ static int32_t PIOS_Flash_Jedec_ReadStatus(struct jedec_flash_dev *flash_dev);
 static int32_t PIOS_Flash_Jedec_ClaimBus(struct jedec_flash_dev *flash_dev, bool fast);
 static int32_t PIOS_Flash_Jedec_ReleaseBus(struct jedec_flash_dev *flash_dev);
 static int32_t PIOS_Flash_Jedec_WriteEnable(struct jedec_flash_dev *flash_dev);
+static int32_t PIOS_Flash_Jedec_Transfer(struct jedec_flash_dev *flash_dev, const struct pios_spi_segment *segments, uint8_t count, bool fast);
 static int32_t PIOS_Flash_Jedec_Busy(struct jedec_flash_dev *flash_dev);
 
 /**
@@ -105,6 +110,10 @@ static struct jedec_flash_dev *PIOS_Flash_Jedec_alloc(void)
     flash_dev->magic   = PIOS_JEDEC_DEV_MAGIC;
 #if defined(FLASH_FREERTOS)
     flash_dev->transaction_lock = xSemaphoreCreateMutex();
+#endif
+#if defined(PIOS_SPI_TRANSACTIONS)
+    vSemaphoreCreateBinary(flash_dev->transfer_done);
+    xSemaphoreTake(flash_dev->transfer_done, 0);
 #endif
     return flash_dev;
 }
@@ -192,6 +201,59 @@ static int32_t PIOS_Flash_Jedec_ReleaseBus(struct jedec_flash_dev *flash_dev)
     return 0;
 }
 
+#if defined(PIOS_SPI_TRANSACTIONS)
+static void PIOS_Flash_Jedec_TransferDone(struct pios_spi_transaction *transaction, int32_t result, bool *woken)
+{
+    struct jedec_flash_dev *flash_dev = (struct jedec_flash_dev *)transaction->context;
+    signed portBASE_TYPE higherPriorityTaskWoken = pdFALSE;
+
+    flash_dev->transfer_result = result;
+    xSemaphoreGiveFromISR(flash_dev->transfer_done, &higherPriorityTaskWoken);
+    *woken = *woken || (higherPriorityTaskWoken == pdTRUE);
+}
+#endif
+
+/**
+ * @brief Transfer the segments with the chip selected throughout
+ * Once the scheduler runs this is one queued SPI transaction, the calling task
+ * waits for it without holding the bus. Before that, or for buffers in memory
+ * the DMA cannot reach, the bus is claimed and the segments are sent in turn.
+ * @return 0 for sucess, -1 for failure to claim the bus, -2 for a failed transfer
+ */
+static int32_t PIOS_Flash_Jedec_Transfer(struct jedec_flash_dev *flash_dev, const struct pios_spi_segment *segments, uint8_t count, bool fast)
+{
+#if defined(PIOS_SPI_TRANSACTIONS)
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        struct pios_spi_transaction transaction = {
+            .slave_id      = flash_dev->slave_num,
+            .prescaler     = fast ? FLASH_FAST_PRESCALER : FLASH_PRESCALER,
+            .segments      = segments,
+            .segment_count = count,
+            .callback      = PIOS_Flash_Jedec_TransferDone,
+            .context       = flash_dev,
+        };
+        /* Buffers the DMA cannot reach are refused, they take the blocking path below */
+        if (PIOS_SPI_SubmitTransaction(flash_dev->spi_id, &transaction) == 0) {
+            xSemaphoreTake(flash_dev->transfer_done, portMAX_DELAY);
+            return flash_dev->transfer_result ? -2 : 0;
+        }
+    }
+#endif
+
+    if (PIOS_Flash_Jedec_ClaimBus(flash_dev, fast) != 0) {
+        return -1;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (PIOS_SPI_TransferBlock(flash_dev->spi_id, segments[i].send_buffer, segments[i].receive_buffer, segments[i].len, NULL) < 0) {
+            PIOS_Flash_Jedec_ReleaseBus(flash_dev);
+            return -2;
+        }
+    }
+    PIOS_Flash_Jedec_ReleaseBus(flash_dev);
+
+    return 0;
+}
+
 /**
  * @brief Returns if the flash chip is busy
  * @returns -1 for failure, 0 for not busy, 1 for busy
@@ -212,14 +274,13 @@ static int32_t PIOS_Flash_Jedec_Busy(struct jedec_flash_dev *flash_dev)
  */
 static int32_t PIOS_Flash_Jedec_WriteEnable(struct jedec_flash_dev *flash_dev)
 {
-    if (PIOS_Flash_Jedec_ClaimBus(flash_dev, true) != 0) {
+    uint8_t out[] = { JEDEC_WRITE_ENABLE };
+    const struct pios_spi_segment segment = { out, NULL, sizeof(out) };
+
+    if (PIOS_Flash_Jedec_Transfer(flash_dev, &segment, 1, true) == -1) {
         return -1;
     }
 
-    uint8_t out[] = { JEDEC_WRITE_ENABLE };
-    PIOS_SPI_TransferBlock(flash_dev->spi_id, out, NULL, sizeof(out), NULL);
-    PIOS_Flash_Jedec_ReleaseBus(flash_dev);
-
     return 0;
 }
 
@@ -229,18 +290,14 @@ static int32_t PIOS_Flash_Jedec_WriteEnable(struct jedec_flash_dev *flash_dev)
  */
 static int32_t PIOS_Flash_Jedec_ReadStatus(struct jedec_flash_dev *flash_dev)
 {
-    if (PIOS_Flash_Jedec_ClaimBus(flash_dev, true) < 0) {
-        return -1;
-    }
-
     uint8_t out[2] = { JEDEC_READ_STATUS, 0 };
     uint8_t in[2]  = { 0, 0 };
-    if (PIOS_SPI_TransferBlock(flash_dev->spi_id, out, in, sizeof(out), NULL) < 0) {
-        PIOS_Flash_Jedec_ReleaseBus(flash_dev);
-        return -2;
-    }
+    const struct pios_spi_segment segment = { out, in, sizeof(out) };
+    int32_t ret    = PIOS_Flash_Jedec_Transfer(flash_dev, &segment, 1, true);
 
-    PIOS_Flash_Jedec_ReleaseBus(flash_dev);
+    if (ret < 0) {
+        return ret;
+    }
 
     return in[1];
 }
@@ -250,19 +307,18 @@ static int32_t PIOS_Flash_Jedec_ReadStatus(struct jedec_flash_dev *flash_dev)
  */
 static int32_t PIOS_Flash_Jedec_ReadID(struct jedec_flash_dev *flash_dev)
 {
-    if (PIOS_Flash_Jedec_ClaimBus(flash_dev, true) < 0) {
-        return -2;
-    }
-
     uint8_t out[] = { JEDEC_DEVICE_ID, 0, 0, 0 };
     uint8_t in[4];
-    if (PIOS_SPI_TransferBlock(flash_dev->spi_id, out, in, sizeof(out), NULL) < 0) {
-        PIOS_Flash_Jedec_ReleaseBus(flash_dev);
+    const struct pios_spi_segment segment = { out, in, sizeof(out) };
+
+    int32_t ret = PIOS_Flash_Jedec_Transfer(flash_dev, &segment, 1, true);
+
+    if (ret == -1) {
+        return -2;
+    } else if (ret < 0) {
         return -3;
     }
 
-    PIOS_Flash_Jedec_ReleaseBus(flash_dev);
-
     flash_dev->manufacturer = in[1];
     flash_dev->memorytype   = in[2];
     flash_dev->capacity     = in[3];
@@ -357,17 +413,12 @@ static int32_t PIOS_Flash_Jedec_EraseSector(uintptr_t flash_id, uint32_t addr)
         return ret;
     }
 
-    if (PIOS_Flash_Jedec_ClaimBus(flash_dev, true) != 0) {
-        return -1;
+    const struct pios_spi_segment segment = { out, NULL, sizeof(out) };
+    int32_t transfer_ret = PIOS_Flash_Jedec_Transfer(flash_dev, &segment, 1, true);
+    if (transfer_ret != 0) {
+        return transfer_ret;
     }
 
-    if (PIOS_SPI_TransferBlock(flash_dev->spi_id, out, NULL, sizeof(out), NULL) < 0) {
-        PIOS_Flash_Jedec_ReleaseBus(flash_dev);
-        return -2;
-    }
-
-    PIOS_Flash_Jedec_ReleaseBus(flash_dev);
-
     // Keep polling when bus is busy too
     while (PIOS_Flash_Jedec_Busy(flash_dev) != 0) {
 #if defined(FLASH_FREERTOS)
@@ -397,17 +448,12 @@ static int32_t PIOS_Flash_Jedec_EraseChip(uintptr_t flash_id)
         return ret;
     }
 
-    if (PIOS_Flash_Jedec_ClaimBus(flash_dev, true) != 0) {
-        return -1;
-    }
-
-    if (PIOS_SPI_TransferBlock(flash_dev->spi_id, out, NULL, sizeof(out), NULL) < 0) {
-        PIOS_Flash_Jedec_ReleaseBus(flash_dev);
-        return -2;
+    const struct pios_spi_segment segment = { out, NULL, sizeof(out) };
+    int32_t transfer_ret = PIOS_Flash_Jedec_Transfer(flash_dev, &segment, 1, true);
+    if (transfer_ret != 0) {
+        return transfer_ret;
     }
 
-    PIOS_Flash_Jedec_ReleaseBus(flash_dev);
-
     // Keep polling when bus is busy too
     int i = 0;
     while (PIOS_Flash_Jedec_Busy(flash_dev) != 0) {
@@ -462,23 +508,15 @@ static int32_t PIOS_Flash_Jedec_WriteData(uintptr_t flash_id, uint32_t addr, uin
         return ret;
     }
 
-    /* Execute write page command and clock in address.  Keep CS asserted */
-    if (PIOS_Flash_Jedec_ClaimBus(flash_dev, true) != 0) {
-        return -1;
-    }
-    if (PIOS_SPI_TransferBlock(flash_dev->spi_id, out, NULL, sizeof(out), NULL) < 0) {
-        PIOS_Flash_Jedec_ReleaseBus(flash_dev);
+    /* Execute write page command, clock in address and clock out data to flash.  Keep CS asserted */
+    const struct pios_spi_segment segments[] = {
+        { out,  NULL, sizeof(out) },
+        { data, NULL, len         },
+    };
+    if (PIOS_Flash_Jedec_Transfer(flash_dev, segments, len ? 2 : 1, true) != 0) {
         return -1;
     }
 
-    /* Clock out data to flash */
-    if (PIOS_SPI_TransferBlock(flash_dev->spi_id, data, NULL, len, NULL) < 0) {
-        PIOS_Flash_Jedec_ReleaseBus(flash_dev);
-        return -1;
-    }
-
-    PIOS_Flash_Jedec_ReleaseBus(flash_dev);
-
     // Keep polling when bus is busy too
 #if defined(FLASH_FREERTOS)
     while (PIOS_Flash_Jedec_Busy(flash_dev) != 0) {
@@ -541,28 +579,36 @@ static int32_t PIOS_Flash_Jedec_WriteChunks(uintptr_t flash_id, uint32_t addr, s
         return ret;
     }
 
-    /* Execute write page command and clock in address.  Keep CS asserted */
-    if (PIOS_Flash_Jedec_ClaimBus(flash_dev, true) != 0) {
+    /* Execute write page command, clock in address and clock out the chunks to flash.  Keep CS asserted */
+    struct pios_spi_segment segments[1 + num];
+    uint8_t count = 0;
+    segments[count++] = (struct pios_spi_segment) { out, NULL, sizeof(out) };
+    for (uint32_t i = 0; i < num; i++) {
+        if (chunks[i].len) {
+            segments[count++] = (struct pios_spi_segment) { chunks[i].addr, NULL, chunks[i].len };
+        }
+    }
+    if (PIOS_Flash_Jedec_Transfer(flash_dev, segments, count, true) != 0) {
         return -1;
     }
 
-    if (PIOS_SPI_TransferBlock(flash_dev->spi_id, out, NULL, sizeof(out), NULL) < 0) {
-        PIOS_Flash_Jedec_ReleaseBus(flash_dev);
+    // The chip ignores further commands until the page is programmed
+#if defined(FLASH_FREERTOS)
+    while (PIOS_Flash_Jedec_Busy(flash_dev) != 0) {
+        vTaskDelay(1);
+    }
+#else
+    if (PIOS_Flash_Jedec_ClaimBus(flash_dev, true) < 0) {
         return -1;
     }
 
-    for (uint32_t i = 0; i < num; i++) {
-        struct pios_flash_chunk *chunk = &chunks[i];
-
-        /* Clock out data to flash */
-        if (PIOS_SPI_TransferBlock(flash_dev->spi_id, chunk->addr, NULL, chunk->len, NULL) < 0) {
-            PIOS_Flash_Jedec_ReleaseBus(flash_dev);
-            return -1;
-        }
+    PIOS_SPI_TransferByte(flash_dev->spi_id, JEDEC_READ_STATUS);
+    while (PIOS_SPI_TransferByte(flash_dev->spi_id, JEDEC_READ_STATUS) & JEDEC_STATUS_BUSY) {
+        ;
     }
-    PIOS_Flash_Jedec_ReleaseBus(flash_dev);
 
-    // Skip checking for busy with this to get OS running again fast
+    PIOS_Flash_Jedec_ReleaseBus(flash_dev);
+#endif
 
     return 0;
 }
@@ -583,39 +629,21 @@ static int32_t PIOS_Flash_Jedec_ReadData(uintptr_t flash_id, uint32_t addr, uint
         return -1;
     }
     bool fast_read = flash_dev->cfg->fast_read != 0;
-    if (PIOS_Flash_Jedec_ClaimBus(flash_dev, fast_read) == -1) {
-        return -1;
-    }
-    /* Execute read command and clock in address.  Keep CS asserted */
-    if (!fast_read) {
-        uint8_t out[] = { JEDEC_READ_DATA, (addr >> 16) & 0xff, (addr >> 8) & 0xff, addr & 0xff };
-        if (PIOS_SPI_TransferBlock(flash_dev->spi_id, out, NULL, sizeof(out), NULL) < 0) {
-            PIOS_Flash_Jedec_ReleaseBus(flash_dev);
-            return -2;
-        }
-    } else {
-        uint8_t cmdlen = flash_dev->cfg->fast_read_dummy_bytes + 4;
-        uint8_t out[cmdlen];
-        memset(out, 0x0, cmdlen);
-        out[0] = flash_dev->cfg->fast_read;
-        out[1] = (addr >> 16) & 0xff;
-        out[2] = (addr >> 8) & 0xff;
-        out[3] = addr & 0xff;
-        if (PIOS_SPI_TransferBlock(flash_dev->spi_id, out, NULL, cmdlen, NULL) < 0) {
-            PIOS_Flash_Jedec_ReleaseBus(flash_dev);
-            return -2;
-        }
-    }
 
-    /* Copy the transfer data to the buffer */
-    if (PIOS_SPI_TransferBlock(flash_dev->spi_id, NULL, data, len, NULL) < 0) {
-        PIOS_Flash_Jedec_ReleaseBus(flash_dev);
-        return -3;
-    }
-
-    PIOS_Flash_Jedec_ReleaseBus(flash_dev);
-
-    return 0;
+    /* Execute read command, clock in address and copy the transfer data to the buffer.  Keep CS asserted */
+    uint8_t cmdlen = fast_read ? flash_dev->cfg->fast_read_dummy_bytes + 4 : 4;
+    uint8_t out[cmdlen];
+    memset(out, 0x0, cmdlen);
+    out[0] = fast_read ? flash_dev->cfg->fast_read : JEDEC_READ_DATA;
+    out[1] = (addr >> 16) & 0xff;
+    out[2] = (addr >> 8) & 0xff;
+    out[3] = addr & 0xff;
+
+    const struct pios_spi_segment segments[] = {
+        { out,  NULL, cmdlen },
+        { NULL, data, len    },
+    };
+    return PIOS_Flash_Jedec_Transfer(flash_dev, segments, len ? 2 : 1, fast_read);
 }
 
 /* Provide a flash driver to external drivers */
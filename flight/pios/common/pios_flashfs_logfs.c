@@ -30,6 +30,7 @@
 #ifdef PIOS_INCLUDE_FLASH
 
 #include <stdbool.h>
+#include <string.h>
 #include <openpilot.h>
 #include <pios_math.h>
 #include <pios_wdg.h>
@@ -43,6 +44,19 @@ enum pios_flashfs_logfs_dev_magic {
     PIOS_FLASHFS_LOGFS_DEV_MAGIC = 0x94938201,
 };
 
+/*
+ * State of the reserve arena, the one following the active arena, which
+ * garbage collection copies the active slots into.
+ */
+enum logfs_gc_state {
+    LOGFS_GC_DIRTY,   /* must be erased before use, starting at gc_sector */
+    LOGFS_GC_ERASED,  /* erased and ready to be reserved */
+    LOGFS_GC_COPYING, /* reserved, background collection is copying slots into it */
+};
+
+/* Active slots copied per PIOS_FLASHFS_Maintain call */
+#define LOGFS_GC_SLOTS_PER_STEP 4
+
 struct logfs_state {
     enum pios_flashfs_logfs_dev_magic magic;
     const struct flashfs_logfs_cfg    *cfg;
@@ -56,6 +70,30 @@ struct logfs_state {
     uint16_t num_free_slots; /* slots in free state */
     uint16_t num_active_slots; /* slots in active state */
 
+    /* RAM index of the active arena, one tag per slot (see logfs_slot_tag).
+     * NULL if there is none, lookups then scan the slot headers in flash.
+     */
+    uint16_t *slot_tags;
+
+    /* Background garbage collection, see PIOS_FLASHFS_Maintain */
+    enum logfs_gc_state gc_state;
+    uint8_t  gc_sector;   /* next reserve arena sector to erase */
+    uint16_t gc_src_slot; /* next active arena slot to copy */
+    uint16_t gc_dst_slot; /* next free reserve arena slot */
+    uint16_t *gc_src_slots; /* active arena slot each reserve arena slot was copied from */
+    uint16_t gc_writes;   /* slots written since the running collection started */
+    uint16_t gc_writes_last; /* slots written while the last collection ran */
+    bool     written;     /* the log changed since the last maintenance step */
+
+    /* Wear and garbage collection statistics, see PIOS_FLASHFS_GetStats */
+    uint32_t *arena_erases; /* erase count of every arena, kept in flash after the arena header */
+    uint16_t gc_count;
+    uint16_t gc_foreground_count;
+    uint32_t gc_bytes_copied;
+    uint32_t gc_busy_us;  /* time spent in the running collection */
+    uint32_t gc_last_us;
+    uint32_t gc_max_us;
+
     /* Underlying flash driver glue */
     const struct pios_flash_driver *driver;
     uintptr_t flash_id;
@@ -65,6 +103,25 @@ struct logfs_state {
  * Internal Utility functions
  */
 
+/* Time taken by garbage collection, only measured with the delay functions */
+static uint32_t logfs_time_start(void)
+{
+#if defined(PIOS_INCLUDE_DELAY)
+    return PIOS_DELAY_GetRaw();
+#else
+    return 0;
+#endif
+}
+
+static uint32_t logfs_time_us(__attribute__((unused)) uint32_t start)
+{
+#if defined(PIOS_INCLUDE_DELAY)
+    return PIOS_DELAY_DiffuS(start);
+#else
+    return 0;
+#endif
+}
+
 /**
  * @brief Return the offset in flash of a particular slot within an arena
  * @return address of the requested slot
@@ -105,30 +162,52 @@ struct arena_header {
     enum arena_state state;
 } __attribute__((packed));
 
+/*
+ * Follows the arena header, written along with the erased state. Older
+ * arenas don't have it, it reads as erased then.
+ */
+struct arena_wear {
+    uint32_t erase_count;
+} __attribute__((packed));
+
+#define LOGFS_ERASE_COUNT_NONE 0xFFFFFFFF
+
 
 /****************************************
 * Arena life-cycle transition functions
 ****************************************/
 
 /**
- * @brief Erases all sectors within the given arena and sets arena to erased state.
+ * @brief Erases one sector of the given arena
  * @return 0 if success, < 0 on failure
  * @note Must be called while holding the flash transaction lock
  */
-static int32_t logfs_erase_arena(const struct logfs_state *logfs, uint8_t arena_id)
+static int32_t logfs_erase_arena_sector(const struct logfs_state *logfs, uint8_t arena_id, uint8_t sector_id)
 {
     uintptr_t arena_addr = logfs_get_addr(logfs, arena_id, 0);
 
-    /* Erase all of the sectors in the arena */
-    for (uint8_t sector_id = 0;
-         sector_id < (logfs->cfg->arena_size / logfs->cfg->sector_size);
-         sector_id++) {
-        if (logfs->driver->erase_sector(logfs->flash_id,
-                                        arena_addr + (sector_id * logfs->cfg->sector_size))) {
-            return -1;
-        }
+    if (logfs->driver->erase_sector(logfs->flash_id,
+                                    arena_addr + (sector_id * logfs->cfg->sector_size))) {
+        return -1;
     }
 
+    /* Every erase of an arena starts at its first sector */
+    if (sector_id == 0 && logfs->arena_erases) {
+        logfs->arena_erases[arena_id]++;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Sets an arena whose sectors have all been erased to erased state.
+ * @return 0 if success, < 0 on failure
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_mark_arena_erased(const struct logfs_state *logfs, uint8_t arena_id)
+{
+    uintptr_t arena_addr = logfs_get_addr(logfs, arena_id, 0);
+
     /* Mark this arena as fully erased */
     struct arena_header arena_hdr = {
         .magic = logfs->cfg->fs_magic,
@@ -139,6 +218,68 @@ static int32_t logfs_erase_arena(const struct logfs_state *logfs, uint8_t arena_
                                   arena_addr,
                                   (uint8_t *)&arena_hdr,
                                   sizeof(arena_hdr)) != 0) {
+        return -1;
+    }
+
+    /* Keep the erase count across reboots */
+    if (logfs->arena_erases) {
+        struct arena_wear arena_wear = {
+            .erase_count = logfs->arena_erases[arena_id],
+        };
+        if (logfs->driver->write_data(logfs->flash_id,
+                                      arena_addr + sizeof(arena_hdr),
+                                      (uint8_t *)&arena_wear,
+                                      sizeof(arena_wear)) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Reads the erase counts of all arenas into RAM
+ * @note Must be called while holding the flash transaction lock
+ */
+static void logfs_read_arena_erases(const struct logfs_state *logfs)
+{
+    if (!logfs->arena_erases) {
+        return;
+    }
+
+    for (uint8_t arena_id = 0;
+         arena_id < (logfs->cfg->total_fs_size / logfs->cfg->arena_size);
+         arena_id++) {
+        struct arena_wear arena_wear;
+        if (logfs->driver->read_data(logfs->flash_id,
+                                     logfs_get_addr(logfs, arena_id, 0) + sizeof(struct arena_header),
+                                     (uint8_t *)&arena_wear,
+                                     sizeof(arena_wear)) != 0 ||
+            arena_wear.erase_count == LOGFS_ERASE_COUNT_NONE) {
+            /* Unknown, erased before the count was kept */
+            arena_wear.erase_count = 0;
+        }
+        logfs->arena_erases[arena_id] = arena_wear.erase_count;
+    }
+}
+
+/**
+ * @brief Erases all sectors within the given arena and sets arena to erased state.
+ * @return 0 if success, < 0 on failure
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_erase_arena(const struct logfs_state *logfs, uint8_t arena_id)
+{
+    /* Erase all of the sectors in the arena */
+    for (uint8_t sector_id = 0;
+         sector_id < (logfs->cfg->arena_size / logfs->cfg->sector_size);
+         sector_id++) {
+        if (logfs_erase_arena_sector(logfs, arena_id, sector_id) != 0) {
+            return -1;
+        }
+    }
+
+    if (logfs_mark_arena_erased(logfs, arena_id) != 0) {
         return -2;
     }
 
@@ -353,6 +494,26 @@ struct slot_header {
     uint16_t obj_size;
 } __attribute__((packed));
 
+/*
+ * Tag of an object instance in the slot index. A tag only narrows down the
+ * slots to look at, matching slot headers are still checked in flash.
+ * 0 is never used for an object, it marks slots that are not active.
+ */
+#define LOGFS_SLOT_TAG_NONE 0
+static uint16_t logfs_slot_tag(uint32_t obj_id, uint16_t obj_inst_id)
+{
+    uint16_t tag = (uint16_t)(obj_id ^ (obj_id >> 16) ^ (obj_inst_id * 0x9E37u));
+
+    return (tag == LOGFS_SLOT_TAG_NONE) ? 1 : tag;
+}
+
+static void logfs_set_slot_tag(const struct logfs_state *logfs, uint16_t slot_id, uint16_t tag)
+{
+    if (logfs->slot_tags) {
+        logfs->slot_tags[slot_id] = tag;
+    }
+}
+
 /* NOTE: Must be called while holding the flash transaction lock */
 static int32_t logfs_raw_copy_bytes(const struct logfs_state *logfs, uintptr_t src_addr, uint16_t src_size, uintptr_t dst_addr)
 {
@@ -427,6 +588,36 @@ static int32_t logfs_unmount_log(struct logfs_state *logfs)
     return 0;
 }
 
+static uint8_t logfs_reserve_arena_id(const struct logfs_state *logfs)
+{
+    return (logfs->active_arena_id + 1) % (logfs->cfg->total_fs_size / logfs->cfg->arena_size);
+}
+
+/*
+ * Find out whether the reserve arena can be used for garbage collection
+ * as it is. The erased header is written only once all sectors of the
+ * arena have been erased, anything else needs a full erase first.
+ */
+static void logfs_gc_probe_reserve(struct logfs_state *logfs)
+{
+    struct arena_header arena_hdr;
+
+    logfs->gc_state  = LOGFS_GC_DIRTY;
+    logfs->gc_sector = 0;
+
+    if (logfs->driver->read_data(logfs->flash_id,
+                                 logfs_get_addr(logfs, logfs_reserve_arena_id(logfs), 0),
+                                 (uint8_t *)&arena_hdr,
+                                 sizeof(arena_hdr)) != 0) {
+        return;
+    }
+
+    if (arena_hdr.magic == logfs->cfg->fs_magic &&
+        arena_hdr.state == ARENA_STATE_ERASED) {
+        logfs->gc_state = LOGFS_GC_ERASED;
+    }
+}
+
 static int32_t logfs_mount_log(struct logfs_state *logfs, uint8_t arena_id)
 {
     PIOS_Assert(!logfs->mounted);
@@ -458,12 +649,15 @@ static int32_t logfs_mount_log(struct logfs_state *logfs, uint8_t arena_id)
         switch (slot_hdr.state) {
         case SLOT_STATE_EMPTY:
             logfs->num_free_slots++;
+            logfs_set_slot_tag(logfs, slot_id, LOGFS_SLOT_TAG_NONE);
             break;
         case SLOT_STATE_ACTIVE:
             logfs->num_active_slots++;
+            logfs_set_slot_tag(logfs, slot_id, logfs_slot_tag(slot_hdr.obj_id, slot_hdr.obj_inst_id));
             break;
         case SLOT_STATE_RESERVED:
         case SLOT_STATE_OBSOLETE:
+            logfs_set_slot_tag(logfs, slot_id, LOGFS_SLOT_TAG_NONE);
             break;
         }
     }
@@ -472,6 +666,8 @@ static int32_t logfs_mount_log(struct logfs_state *logfs, uint8_t arena_id)
     logfs->active_arena_id = arena_id;
     logfs->mounted = true;
 
+    logfs_gc_probe_reserve(logfs);
+
     return 0;
 }
 
@@ -497,6 +693,13 @@ static void PIOS_FLASHFS_Logfs_free(struct logfs_state *logfs)
 {
     /* Invalidate the magic */
     logfs->magic = ~PIOS_FLASHFS_LOGFS_DEV_MAGIC;
+    if (logfs->slot_tags) {
+        /* gc_src_slots shares the allocation */
+        vPortFree(logfs->slot_tags);
+    }
+    if (logfs->arena_erases) {
+        vPortFree(logfs->arena_erases);
+    }
     vPortFree(logfs);
 }
 #else
@@ -560,11 +763,38 @@ int32_t PIOS_FLASHFS_Logfs_Init(uintptr_t *fs_id, const struct flashfs_logfs_cfg
     logfs->flash_id = flash_id; /* lower-level flash device id */
     logfs->mounted  = false;
 
+#if defined(PIOS_INCLUDE_FREERTOS)
+    /*
+     * Without the index everything still works, only lookups are slower
+     * and garbage collection can't run in the background.
+     */
+    uint16_t num_slots = cfg->arena_size / cfg->slot_size;
+    logfs->slot_tags = (uint16_t *)pios_malloc(2 * sizeof(uint16_t) * num_slots);
+    logfs->gc_src_slots = logfs->slot_tags ? logfs->slot_tags + num_slots : NULL;
+    /* Without the erase counts the statistics lack the wear */
+    logfs->arena_erases = (uint32_t *)pios_malloc(sizeof(uint32_t) * (cfg->total_fs_size / cfg->arena_size));
+#else
+    logfs->slot_tags    = NULL;
+    logfs->gc_src_slots = NULL;
+    logfs->arena_erases = NULL;
+#endif
+    logfs->gc_writes    = 0;
+    logfs->gc_writes_last  = 0;
+    logfs->written      = false;
+    logfs->gc_count     = 0;
+    logfs->gc_foreground_count = 0;
+    logfs->gc_bytes_copied     = 0;
+    logfs->gc_busy_us   = 0;
+    logfs->gc_last_us   = 0;
+    logfs->gc_max_us    = 0;
+
     if (logfs->driver->start_transaction(logfs->flash_id) != 0) {
         rc = -1;
         goto out_exit;
     }
 
+    logfs_read_arena_erases(logfs);
+
     bool found = false;
     int32_t arena_id;
     for (uint8_t try = 0; !found && try < 2; try++) {
@@ -628,6 +858,155 @@ out_exit:
     return rc;
 }
 
+/*
+ * Reserve the (erased) reserve arena and start collecting into it.
+ * NOTE: Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_gc_start(struct logfs_state *logfs)
+{
+    PIOS_Assert(logfs->gc_state == LOGFS_GC_ERASED);
+
+    /* The reserve arena is no longer erased, whatever happens next */
+    logfs->gc_state  = LOGFS_GC_DIRTY;
+    logfs->gc_sector = 0;
+
+    if (logfs_reserve_arena(logfs, logfs_reserve_arena_id(logfs)) != 0) {
+        return -1;
+    }
+
+    logfs->gc_state    = LOGFS_GC_COPYING;
+    logfs->gc_src_slot = 1;
+    logfs->gc_dst_slot = 1;
+    logfs->gc_writes   = 0;
+    logfs->gc_busy_us  = 0;
+
+    return 0;
+}
+
+/*
+ * Account for a finished collection. The slots written while it ran tell
+ * how early the next one has to start, see logfs_gc_wanted.
+ */
+static void logfs_gc_done(struct logfs_state *logfs, bool foreground)
+{
+    logfs->gc_count++;
+    if (foreground) {
+        logfs->gc_foreground_count++;
+    }
+    logfs->gc_last_us     = logfs->gc_busy_us;
+    logfs->gc_max_us      = MAX(logfs->gc_max_us, logfs->gc_busy_us);
+    logfs->gc_busy_us     = 0;
+    logfs->gc_writes_last = logfs->gc_writes;
+    logfs->gc_writes      = 0;
+}
+
+/*
+ * Copy up to max_slots active slots from the active arena into the reserve
+ * arena. The active arena keeps taking writes in between calls, so slots are
+ * copied up to the current end of the log and any copy whose source has been
+ * obsoleted since is obsoleted before the reserve arena is activated.
+ * Returns 1 if there are slots left to copy, 0 once the reserve arena has
+ * been mounted as the new active arena, < 0 on failure.
+ * NOTE: Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_gc_copy(struct logfs_state *logfs, uint16_t max_slots)
+{
+    PIOS_Assert(logfs->mounted);
+    PIOS_Assert(logfs->gc_state == LOGFS_GC_COPYING);
+
+    uint16_t num_slots    = logfs->cfg->arena_size / logfs->cfg->slot_size;
+    uint16_t log_end      = num_slots - logfs->num_free_slots;
+    uint8_t src_arena_id  = logfs->active_arena_id;
+    uint8_t dst_arena_id  = logfs_reserve_arena_id(logfs);
+
+    /* Copy active slots from active arena to destination arena */
+    while (logfs->gc_src_slot < log_end) {
+        uint16_t src_slot_id = logfs->gc_src_slot;
+
+        if (logfs->slot_tags[src_slot_id] != LOGFS_SLOT_TAG_NONE) {
+            if (max_slots == 0) {
+                return 1;
+            }
+            if (logfs->gc_dst_slot >= num_slots) {
+                /* Too much has been written since the collection started */
+                return -1;
+            }
+
+            struct slot_header slot_hdr;
+            uintptr_t src_addr = logfs_get_addr(logfs, src_arena_id, src_slot_id);
+            if (logfs->driver->read_data(logfs->flash_id,
+                                         src_addr,
+                                         (uint8_t *)&slot_hdr,
+                                         sizeof(slot_hdr)) != 0) {
+                return -2;
+            }
+
+            if (slot_hdr.state == SLOT_STATE_ACTIVE) {
+                uintptr_t dst_addr = logfs_get_addr(logfs, dst_arena_id, logfs->gc_dst_slot);
+                if (logfs_raw_copy_bytes(logfs,
+                                         src_addr,
+                                         sizeof(slot_hdr) + slot_hdr.obj_size,
+                                         dst_addr) != 0) {
+                    /* Failed to copy all bytes */
+                    return -3;
+                }
+                logfs->gc_bytes_copied += sizeof(slot_hdr) + slot_hdr.obj_size;
+                logfs->gc_src_slots[logfs->gc_dst_slot++] = src_slot_id;
+                max_slots--;
+            }
+        }
+        logfs->gc_src_slot++;
+#ifdef PIOS_INCLUDE_WDG
+        PIOS_WDG_Clear();
+#endif
+    }
+
+    /* Drop the copies of everything that was obsoleted while copying */
+    for (uint16_t dst_slot_id = 1; dst_slot_id < logfs->gc_dst_slot; dst_slot_id++) {
+        if (logfs->slot_tags[logfs->gc_src_slots[dst_slot_id]] != LOGFS_SLOT_TAG_NONE) {
+            continue;
+        }
+
+        struct slot_header slot_hdr;
+        uintptr_t dst_addr = logfs_get_addr(logfs, dst_arena_id, dst_slot_id);
+        if (logfs->driver->read_data(logfs->flash_id,
+                                     dst_addr,
+                                     (uint8_t *)&slot_hdr,
+                                     sizeof(slot_hdr)) != 0) {
+            return -4;
+        }
+        slot_hdr.state = SLOT_STATE_OBSOLETE;
+        if (logfs->driver->write_data(logfs->flash_id,
+                                      dst_addr,
+                                      (uint8_t *)&slot_hdr,
+                                      sizeof(slot_hdr)) != 0) {
+            return -5;
+        }
+    }
+
+    /* Activate the destination arena */
+    if (logfs_activate_arena(logfs, dst_arena_id) != 0) {
+        return -6;
+    }
+
+    /* Unmount the source arena */
+    if (logfs_unmount_log(logfs) != 0) {
+        return -7;
+    }
+
+    /* Obsolete the source arena */
+    if (logfs_obsolete_arena(logfs, src_arena_id) != 0) {
+        return -8;
+    }
+
+    /* Mount the new arena, this also finds out the state of the next reserve arena */
+    if (logfs_mount_log(logfs, dst_arena_id) != 0) {
+        return -9;
+    }
+
+    return 0;
+}
+
 /* NOTE: Must be called while holding the flash transaction lock */
 static int32_t logfs_garbage_collect(struct logfs_state *logfs)
 {
@@ -637,14 +1016,31 @@ static int32_t logfs_garbage_collect(struct logfs_state *logfs)
     uint8_t src_arena_id = logfs->active_arena_id;
 
     /* Compute destination arena */
-    uint8_t dst_arena_id = (logfs->active_arena_id + 1) % (logfs->cfg->total_fs_size / logfs->cfg->arena_size);
+    uint8_t dst_arena_id = logfs_reserve_arena_id(logfs);
 
-    /* Erase destination arena */
-    if (logfs_erase_arena(logfs, dst_arena_id) != 0) {
-        return -1;
+    /* Finish a background collection if there is one running */
+    if (logfs->gc_state == LOGFS_GC_COPYING) {
+        if (logfs_gc_copy(logfs, UINT16_MAX) == 0) {
+            return 0;
+        }
+        if (!logfs->mounted) {
+            /* Failed while switching arenas, nothing left to fall back to */
+            return -1;
+        }
+        /* Start over from scratch */
+        logfs->gc_state  = LOGFS_GC_DIRTY;
+        logfs->gc_sector = 0;
+    }
+
+    /* Erase destination arena unless it has been erased in the background */
+    if (logfs->gc_state != LOGFS_GC_ERASED) {
+        if (logfs_erase_arena(logfs, dst_arena_id) != 0) {
+            return -1;
+        }
     }
 
     /* Reserve the destination arena so we can start filling it */
+    logfs->gc_state = LOGFS_GC_DIRTY;
     if (logfs_reserve_arena(logfs, dst_arena_id) != 0) {
         /* Unable to reserve the arena */
         return -2;
@@ -673,6 +1069,7 @@ static int32_t logfs_garbage_collect(struct logfs_state *logfs)
                 /* Failed to copy all bytes */
                 return -4;
             }
+            logfs->gc_bytes_copied += sizeof(slot_hdr) + slot_hdr.obj_size;
             dst_slot_id++;
         }
 #ifdef PIOS_INCLUDE_WDG
@@ -714,9 +1111,15 @@ static int16_t logfs_object_find_next(const struct logfs_state *logfs, struct sl
         *curr_slot = 1;
     }
 
+    const uint16_t tag = logfs_slot_tag(obj_id, obj_inst_id);
+
     for (uint16_t slot_id = *curr_slot;
          slot_id < (logfs->cfg->arena_size / logfs->cfg->slot_size);
          slot_id++) {
+        if (logfs->slot_tags && logfs->slot_tags[slot_id] != tag) {
+            /* Not active or some other object, no need to look at the flash */
+            continue;
+        }
         uintptr_t slot_addr = logfs_get_addr(logfs, logfs->active_arena_id, slot_id);
 
         if (logfs->driver->read_data(logfs->flash_id,
@@ -746,7 +1149,6 @@ static int16_t logfs_object_find_next(const struct logfs_state *logfs, struct sl
 }
 
 /* NOTE: Must be called while holding the flash transaction lock */
-/* OPTIMIZE: could trust that there is at most one active version of every object and terminate the search when we find one */
 static int8_t logfs_delete_object(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id)
 {
     int8_t rc;
@@ -771,6 +1173,8 @@ static int8_t logfs_delete_object(struct logfs_state *logfs, uint32_t obj_id, ui
             }
             /* Object has been successfully obsoleted and is no longer active */
             logfs->num_active_slots--;
+            logfs->written = true;
+            logfs_set_slot_tag(logfs, curr_slot_id, LOGFS_SLOT_TAG_NONE);
             break;
         case -1:
             /* Search completed, object not found */
@@ -789,10 +1193,11 @@ out_exit:
 }
 
 /* NOTE: Must be called while holding the flash transaction lock */
-static int8_t logfs_reserve_free_slot(struct logfs_state *logfs, uint16_t *slot_id, struct slot_header *slot_hdr, uint32_t obj_id, uint16_t obj_inst_id, uint16_t obj_size)
+static int8_t logfs_reserve_free_slot(struct logfs_state *logfs, uint16_t *slot_id, struct slot_header *slot_hdr, uint32_t obj_id, uint16_t obj_inst_id, uint8_t *obj_data, uint16_t obj_size, uint16_t *obj_written)
 {
     PIOS_Assert(slot_id);
     PIOS_Assert(slot_hdr);
+    PIOS_Assert(obj_written);
 
     if (logfs->num_free_slots < 1) {
         /* No free slots to allocate */
@@ -829,12 +1234,30 @@ static int8_t logfs_reserve_free_slot(struct logfs_state *logfs, uint16_t *slot_
     slot_hdr->obj_inst_id = obj_inst_id;
     slot_hdr->obj_size    = obj_size;
 
-    if (logfs->driver->write_data(logfs->flash_id,
-                                  slot_addr,
-                                  (uint8_t *)slot_hdr,
-                                  sizeof(*slot_hdr)) != 0) {
-        /* Failed to write the slot header */
-        return -5;
+    if (logfs->driver->write_chunks) {
+        /* Program the header along with as much of the data as fits in its page */
+        uint16_t page_remaining = logfs->cfg->page_size - (sizeof(*slot_hdr) % logfs->cfg->page_size);
+        struct pios_flash_chunk chunks[] = {
+            { .addr = (uint8_t *)slot_hdr, .len = sizeof(*slot_hdr)          },
+            { .addr = obj_data,            .len = MIN(obj_size, page_remaining) },
+        };
+        if (logfs->driver->write_chunks(logfs->flash_id,
+                                        slot_addr,
+                                        chunks,
+                                        (chunks[1].len > 0) ? 2 : 1) != 0) {
+            /* Failed to write the slot header */
+            return -5;
+        }
+        *obj_written = chunks[1].len;
+    } else {
+        if (logfs->driver->write_data(logfs->flash_id,
+                                      slot_addr,
+                                      (uint8_t *)slot_hdr,
+                                      sizeof(*slot_hdr)) != 0) {
+            /* Failed to write the slot header */
+            return -5;
+        }
+        *obj_written = 0;
     }
 
     /* FIXME: If the header write (above) failed, may have partially written data, thus corrupting that slot but we would have missed decrementing this counter */
@@ -850,8 +1273,9 @@ static int8_t logfs_append_to_log(struct logfs_state *logfs, uint32_t obj_id, ui
     /* Reserve a free slot for our new object */
     uint16_t free_slot_id;
     struct slot_header slot_hdr;
+    uint16_t obj_written;
 
-    if (logfs_reserve_free_slot(logfs, &free_slot_id, &slot_hdr, obj_id, obj_inst_id, obj_size) != 0) {
+    if (logfs_reserve_free_slot(logfs, &free_slot_id, &slot_hdr, obj_id, obj_inst_id, obj_data, obj_size, &obj_written) != 0) {
         /* Failed to reserve a free slot */
         return -1;
     }
@@ -859,8 +1283,10 @@ static int8_t logfs_append_to_log(struct logfs_state *logfs, uint32_t obj_id, ui
     /* Compute slot address */
     uintptr_t slot_addr   = logfs_get_addr(logfs, logfs->active_arena_id, free_slot_id);
 
-    /* Write the data into the reserved slot, starting after the slot header */
-    uintptr_t slot_offset = sizeof(slot_hdr);
+    /* Write the rest of the data into the reserved slot, starting after the slot header */
+    uintptr_t slot_offset = sizeof(slot_hdr) + obj_written;
+    obj_data += obj_written;
+    obj_size -= obj_written;
     while (obj_size > 0) {
         /* Individual writes must fit entirely within a single page buffer. */
         uint16_t page_remaining = logfs->cfg->page_size - (slot_offset % logfs->cfg->page_size);
@@ -891,6 +1317,105 @@ static int8_t logfs_append_to_log(struct logfs_state *logfs, uint32_t obj_id, ui
 
     /* Object has been successfully written to the slot */
     logfs->num_active_slots++;
+    logfs->written = true;
+    if (logfs->gc_state == LOGFS_GC_COPYING) {
+        logfs->gc_writes++;
+    }
+    logfs_set_slot_tag(logfs, free_slot_id, logfs_slot_tag(obj_id, obj_inst_id));
+    return 0;
+}
+
+/*
+ * Is the active copy of this object identical to obj_data?
+ * NOTE: Must be called while holding the flash transaction lock
+ */
+static bool logfs_object_unchanged(const struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id, uint8_t *obj_data, uint16_t obj_size)
+{
+    uint16_t slot_id = 0;
+    struct slot_header slot_hdr;
+
+    if (logfs_object_find_next(logfs, &slot_hdr, &slot_id, obj_id, obj_inst_id) != 0) {
+        /* Not stored yet */
+        return false;
+    }
+
+    if (slot_hdr.obj_size != obj_size) {
+        return false;
+    }
+
+    uintptr_t slot_addr = logfs_get_addr(logfs, logfs->active_arena_id, slot_id) + sizeof(slot_hdr);
+#define COMPARE_BLOCK_SIZE 16
+    uint8_t data_block[COMPARE_BLOCK_SIZE];
+
+    while (obj_size) {
+        uint16_t blk_size = MIN(obj_size, COMPARE_BLOCK_SIZE);
+
+        if (logfs->driver->read_data(logfs->flash_id,
+                                     slot_addr,
+                                     data_block,
+                                     blk_size) != 0) {
+            /* Can't tell, write it again */
+            return false;
+        }
+        if (memcmp(data_block, obj_data, blk_size) != 0) {
+            return false;
+        }
+
+        obj_size  -= blk_size;
+        obj_data  += blk_size;
+        slot_addr += blk_size;
+    }
+
+    return true;
+}
+
+/* NOTE: Must be called while holding the flash transaction lock */
+static int8_t logfs_save_object(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id, uint8_t *obj_data, uint16_t obj_size)
+{
+    if (logfs_delete_object(logfs, obj_id, obj_inst_id) != 0) {
+        return -3;
+    }
+
+    /*
+     * All old versions of this object + instance have been invalidated.
+     * Write the new object.
+     */
+
+    /* Check if the arena is entirely full. */
+    if (logfs_fs_is_full(logfs)) {
+        /* Note: Filesystem Full means we're full of *active* records so gc won't help at all. */
+        return -4;
+    }
+
+    /* Is garbage collection required? */
+    if (logfs_log_is_full(logfs)) {
+        /* Note: Log Full means the log is full but may contain obsolete slots so gc may free some space */
+        uint32_t gc_start = logfs_time_start();
+        int32_t gc_rc     = logfs_garbage_collect(logfs);
+        logfs->gc_busy_us += logfs_time_us(gc_start);
+        if (gc_rc != 0) {
+            return -5;
+        }
+        logfs_gc_done(logfs, true);
+        /* Check one more time just to be sure we actually free'd some space */
+        if (logfs_log_is_full(logfs)) {
+            /*
+             * Log is still full even after gc!
+             * NOTE: This should not happen since the filesystem wasn't full
+             *       when we checked above so gc should have helped.
+             */
+            PIOS_DEBUG_Assert(0);
+            return -6;
+        }
+    }
+
+    /* We have room for our new object.  Append it to the log. */
+    if (logfs_append_to_log(logfs, obj_id, obj_inst_id, obj_data, obj_size) != 0) {
+        /* Error during append */
+        return -7;
+    }
+
+    /* Object successfully written to the log */
     return 0;
 }
 
@@ -936,51 +1461,62 @@ int32_t PIOS_FLASHFS_ObjSave(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst
         goto out_exit;
     }
 
-    if (logfs_delete_object(logfs, obj_id, obj_inst_id) != 0) {
-        rc = -3;
-        goto out_end_trans;
-    }
+    rc = logfs_save_object(logfs, obj_id, obj_inst_id, obj_data, obj_size);
 
-    /*
-     * All old versions of this object + instance have been invalidated.
-     * Write the new object.
-     */
+    logfs->driver->end_transaction(logfs->flash_id);
 
-    /* Check if the arena is entirely full. */
-    if (logfs_fs_is_full(logfs)) {
-        /* Note: Filesystem Full means we're full of *active* records so gc won't help at all. */
-        rc = -4;
-        goto out_end_trans;
+out_exit:
+    return rc;
+}
+
+/**
+ * @brief Saves a batch of object instances to the filesystem in one transaction
+ *
+ * Instances whose stored copy is identical are left alone, which makes saving
+ * all settings cheap when only a few of them have been changed.
+ *
+ * @param[in] fs_id The filesystem to use for this action
+ * @param[in] next Called for every object instance to save until it returns false
+ * @param[in] context Passed on to next
+ * @return 0 if success or error code
+ * @retval -1 if fs_id is not a valid filesystem instance
+ * @retval -2 if failed to start transaction
+ * @retval -3 to -7 as for PIOS_FLASHFS_ObjSave, for the first object that failed to save
+ */
+int32_t PIOS_FLASHFS_ObjSaveBatch(uintptr_t fs_id, PIOS_FLASHFS_ObjIterator next, void *context)
+{
+    int8_t rc;
+
+    struct logfs_state *logfs = (struct logfs_state *)fs_id;
+
+    if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
+        rc = -1;
+        goto out_exit;
     }
 
-    /* Is garbage collection required? */
-    if (logfs_log_is_full(logfs)) {
-        /* Note: Log Full means the log is full but may contain obsolete slots so gc may free some space */
-        if (logfs_garbage_collect(logfs) != 0) {
-            rc = -5;
-            goto out_end_trans;
+    if (logfs->driver->start_transaction(logfs->flash_id) != 0) {
+        rc = -2;
+        goto out_exit;
+    }
+
+    uint32_t obj_id;
+    uint16_t obj_inst_id;
+    uint8_t *obj_data;
+    uint16_t obj_size;
+    while (next(context, &obj_id, &obj_inst_id, &obj_data, &obj_size)) {
+        PIOS_Assert(obj_size <= (logfs->cfg->slot_size - sizeof(struct slot_header)));
+
+        if (logfs_object_unchanged(logfs, obj_id, obj_inst_id, obj_data, obj_size)) {
+            continue;
         }
-        /* Check one more time just to be sure we actually free'd some space */
-        if (logfs_log_is_full(logfs)) {
-            /*
-             * Log is still full even after gc!
-             * NOTE: This should not happen since the filesystem wasn't full
-             *       when we checked above so gc should have helped.
-             */
-            PIOS_DEBUG_Assert(0);
-            rc = -6;
+
+        rc = logfs_save_object(logfs, obj_id, obj_inst_id, obj_data, obj_size);
+        if (rc != 0) {
             goto out_end_trans;
         }
     }
 
-    /* We have room for our new object.  Append it to the log. */
-    if (logfs_append_to_log(logfs, obj_id, obj_inst_id, obj_data, obj_size) != 0) {
-        /* Error during append */
-        rc = -7;
-        goto out_end_trans;
-    }
-
-    /* Object successfully written to the log */
+    /* All objects successfully written to the log */
     rc = 0;
 
 out_end_trans:
@@ -1158,6 +1694,131 @@ out_end_trans:
 out_exit:
     return rc;
 }
+
+/*
+ * Is it worth collecting garbage ahead of time?
+ * true = the log is running out of free slots and collecting would free a good part of it
+ * false = either there is plenty of room left or collecting would hardly gain anything
+ * The collection starts earlier when many slots were written while the last
+ * one ran, so it finishes before the log is full and a save has to wait for it.
+ */
+static bool logfs_gc_wanted(const struct logfs_state *logfs)
+{
+    uint16_t num_slots   = (logfs->cfg->arena_size / logfs->cfg->slot_size) - 1;
+    uint16_t num_garbage = num_slots - logfs->num_free_slots - logfs->num_active_slots;
+    uint16_t margin = MAX(num_slots / 4, MIN(2 * logfs->gc_writes_last, num_slots / 2));
+
+    return logfs->num_free_slots < margin && num_garbage >= num_slots / 4;
+}
+
+/**
+ * @brief Performs one step of background maintenance on the filesystem
+ *
+ * Erases the reserve arena one sector at a time and, once the log fills up,
+ * copies a few active slots per call into it. This spreads the cost of
+ * garbage collection over many calls instead of stalling the next save, call
+ * it periodically from a low priority context. A step is skipped when the
+ * log changed since the previous one, so a batch of saves isn't slowed down.
+ *
+ * @param[in] fs_id The filesystem to use for this action
+ * @return 1 if there is more work pending, 0 if idle or error code
+ * @retval -1 if fs_id is not a valid filesystem instance
+ * @retval -2 if failed to start transaction
+ * @retval -3 if erasing the reserve arena failed
+ * @retval -4 if collecting into the reserve arena failed
+ */
+int32_t PIOS_FLASHFS_Maintain(uintptr_t fs_id)
+{
+    int32_t rc;
+
+    struct logfs_state *logfs = (struct logfs_state *)fs_id;
+
+    if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
+        rc = -1;
+        goto out_exit;
+    }
+
+    if (logfs->driver->start_transaction(logfs->flash_id) != 0) {
+        rc = -2;
+        goto out_exit;
+    }
+
+    if (!logfs->mounted) {
+        rc = 0;
+        goto out_end_trans;
+    }
+
+    /* Saves are still going on, wait until the flash is idle */
+    if (logfs->written) {
+        logfs->written = false;
+        rc = 1;
+        goto out_end_trans;
+    }
+
+    uint8_t reserve_arena_id = logfs_reserve_arena_id(logfs);
+
+    switch (logfs->gc_state) {
+    case LOGFS_GC_DIRTY:
+        if (logfs_erase_arena_sector(logfs, reserve_arena_id, logfs->gc_sector) != 0) {
+            rc = -3;
+            goto out_end_trans;
+        }
+        if (++logfs->gc_sector < (logfs->cfg->arena_size / logfs->cfg->sector_size)) {
+            rc = 1;
+            goto out_end_trans;
+        }
+        /* All sectors erased, note it in flash so it survives a reboot */
+        logfs->gc_sector = 0;
+        if (logfs_mark_arena_erased(logfs, reserve_arena_id) != 0) {
+            rc = -3;
+            goto out_end_trans;
+        }
+        logfs->gc_state = LOGFS_GC_ERASED;
+        /* Next step decides whether to start collecting */
+        rc = 1;
+        break;
+    case LOGFS_GC_ERASED:
+        if (!logfs->slot_tags || !logfs_gc_wanted(logfs)) {
+            rc = 0;
+            break;
+        }
+        if (logfs_gc_start(logfs) != 0) {
+            rc = -4;
+            goto out_end_trans;
+        }
+        rc = 1;
+        break;
+    case LOGFS_GC_COPYING:
+    {
+        uint32_t gc_start = logfs_time_start();
+        rc = logfs_gc_copy(logfs, LOGFS_GC_SLOTS_PER_STEP);
+        logfs->gc_busy_us += logfs_time_us(gc_start);
+        if (rc == 0) {
+            logfs_gc_done(logfs, false);
+        }
+        if (rc < 0) {
+            /* Leave it to the next save to collect the garbage in one go */
+            logfs->gc_state  = LOGFS_GC_DIRTY;
+            logfs->gc_sector = 0;
+            rc = -4;
+        } else {
+            /* A finished collection leaves a reserve arena to erase behind */
+            rc = 1;
+        }
+        break;
+    }
+    default:
+        rc = 0;
+        break;
+    }
+
+out_end_trans:
+    logfs->driver->end_transaction(logfs->flash_id);
+
+out_exit:
+    return rc;
+}
+
 /**
  * @brief Returs stats for the filesystems
  * @param[in] fs_id The filesystem to use for this action
@@ -1172,8 +1833,28 @@ int32_t PIOS_FLASHFS_GetStats(uintptr_t fs_id, struct PIOS_FLASHFS_Stats *stats)
     if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
         return -1;
     }
-    stats->num_active_slots = logfs->num_active_slots;
-    stats->num_free_slots   = logfs->num_free_slots;
+    uint16_t num_slots = (logfs->cfg->arena_size / logfs->cfg->slot_size) - 1;
+    stats->num_active_slots    = logfs->num_active_slots;
+    stats->num_free_slots      = logfs->num_free_slots;
+    stats->num_obsolete_slots  = logfs->mounted ? num_slots - logfs->num_free_slots - logfs->num_active_slots : 0;
+
+    stats->min_arena_erases    = 0;
+    stats->max_arena_erases    = 0;
+    if (logfs->arena_erases) {
+        stats->min_arena_erases = UINT32_MAX;
+        for (uint8_t arena_id = 0;
+             arena_id < (logfs->cfg->total_fs_size / logfs->cfg->arena_size);
+             arena_id++) {
+            stats->min_arena_erases = MIN(stats->min_arena_erases, logfs->arena_erases[arena_id]);
+            stats->max_arena_erases = MAX(stats->max_arena_erases, logfs->arena_erases[arena_id]);
+        }
+    }
+
+    stats->gc_count            = logfs->gc_count;
+    stats->gc_foreground_count = logfs->gc_foreground_count;
+    stats->gc_bytes_copied     = logfs->gc_bytes_copied;
+    stats->gc_last_us = logfs->gc_last_us;
+    stats->gc_max_us  = logfs->gc_max_us;
     return 0;
 }
 #endif /* PIOS_INCLUDE_FLASH */
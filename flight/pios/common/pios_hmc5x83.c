@@ -35,6 +35,11 @@
 #ifdef PIOS_INCLUDE_HMC5X83
 
 #define PIOS_HMC5X83_MAGIC 0x4d783833
+
+#if defined(PIOS_HMC5X83_HAS_GPIOS) && defined(PIOS_INCLUDE_I2C) && defined(PIOS_I2C_TRANSACTIONS)
+/* On I2C the data ready interrupt queues the read, the sensor loop does not wait on the bus */
+#define PIOS_HMC5X83_QUEUED_READ
+#endif
 /* Global Variables */
 
 /* Local Types */
@@ -46,9 +51,27 @@ typedef struct {
     uint8_t  slave_num;
     uint8_t  CTRLB;
     volatile bool data_ready;
+    volatile uint32_t sample_time; // PIOS_DELAY_GetuS() at the last data ready interrupt
+#ifdef PIOS_HMC5X83_QUEUED_READ
+    bool queued;
+    volatile bool read_pending;
+    uint8_t read_cmd;
+    uint8_t read_buffer[6]; // filled by the transfer
+    uint8_t mode_cmd[2];
+    uint8_t sample[6]; // the last complete read
+    uint32_t sample_read_time; // sample_time of the last complete read
+    struct pios_i2c_txn read_txns[2];
+    struct pios_i2c_txn mode_txn;
+    struct pios_i2c_transaction read_transaction;
+    struct pios_i2c_transaction mode_transaction;
+#endif
 } pios_hmc5x83_dev_data_t;
 
 static int32_t PIOS_HMC5x83_Config(pios_hmc5x83_dev_data_t *dev);
+static void PIOS_HMC5x83_Convert(pios_hmc5x83_dev_data_t *dev, const uint8_t buffer[6], int16_t out[3]);
+#ifdef PIOS_HMC5X83_QUEUED_READ
+static void PIOS_HMC5x83_QueueInit(pios_hmc5x83_dev_data_t *dev);
+#endif
 
 // sensor driver interface
 bool PIOS_HMC5x83_driver_Test(uintptr_t context);
@@ -65,6 +88,7 @@ const PIOS_SENSORS_Driver PIOS_HMC5x83_Driver = {
     .get_queue = NULL,
     .get_scale = PIOS_HMC5x83_driver_get_scale,
     .is_polled = true,
+    .is_batched = true,
 };
 /**
  * Allocate the device setting structure
@@ -112,6 +136,9 @@ pios_hmc5x83_dev_t PIOS_HMC5x83_Init(const struct pios_hmc5x83_cfg *cfg, uint32_
     PIOS_Assert(val == 0);
 
     dev->data_ready = false;
+#ifdef PIOS_HMC5X83_QUEUED_READ
+    PIOS_HMC5x83_QueueInit(dev);
+#endif
     return (pios_hmc5x83_dev_t)dev;
 }
 
@@ -224,13 +251,27 @@ int32_t PIOS_HMC5x83_ReadMag(pios_hmc5x83_dev_t handler, int16_t out[3])
 
     dev->data_ready = false;
     uint8_t buffer[6];
-    int16_t temp[3];
-    int32_t sensitivity;
 
     if (dev->cfg->Driver->Read(handler, PIOS_HMC5x83_DATAOUT_XMSB_REG, buffer, 6) != 0) {
         return -1;
     }
 
+    PIOS_HMC5x83_Convert(dev, buffer, out);
+
+    // This should not be necessary but for some reason it is coming out of continuous conversion mode
+    dev->cfg->Driver->Write(handler, PIOS_HMC5x83_MODE_REG, PIOS_HMC5x83_MODE_CONTINUOUS);
+
+    return 0;
+}
+
+/**
+ * @brief Scale and rotate the raw X, Z, Y values read from the data output registers
+ */
+static void PIOS_HMC5x83_Convert(pios_hmc5x83_dev_data_t *dev, const uint8_t buffer[6], int16_t out[3])
+{
+    int16_t temp[3];
+    int32_t sensitivity;
+
     switch (dev->CTRLB & 0xE0) {
     case 0x00:
         sensitivity = PIOS_HMC5x83_Sensitivity_0_88Ga;
@@ -307,11 +348,6 @@ int32_t PIOS_HMC5x83_ReadMag(pios_hmc5x83_dev_t handler, int16_t out[3])
         out[2] = temp[1];
         break;
     }
-
-    // This should not be necessary but for some reason it is coming out of continuous conversion mode
-    dev->cfg->Driver->Write(handler, PIOS_HMC5x83_MODE_REG, PIOS_HMC5x83_MODE_CONTINUOUS);
-
-    return 0;
 }
 
 
@@ -442,10 +478,96 @@ bool PIOS_HMC5x83_IRQHandler(pios_hmc5x83_dev_t handler)
 {
     pios_hmc5x83_dev_data_t *dev = dev_validate(handler);
 
+    dev->sample_time = PIOS_DELAY_GetuS();
+#ifdef PIOS_HMC5X83_QUEUED_READ
+    if (dev->queued) {
+        bool woken = false;
+        // data_ready is set once the read completed, a read still on the queue picks the new sample up
+        if (!dev->read_pending) {
+            dev->read_pending = true;
+            if (PIOS_I2C_SubmitTransactionISR(dev->port_id, &dev->read_transaction, &woken) != 0) {
+                dev->read_pending = false;
+            }
+        }
+        return woken;
+    }
+#endif
     dev->data_ready = true;
     return false;
 }
 
+#ifdef PIOS_HMC5X83_QUEUED_READ
+static void PIOS_HMC5x83_ModeDone(struct pios_i2c_transaction *transaction, __attribute__((unused)) int32_t result, __attribute__((unused)) bool *woken)
+{
+    pios_hmc5x83_dev_data_t *dev = (pios_hmc5x83_dev_data_t *)transaction->context;
+
+    dev->read_pending = false;
+}
+
+static void PIOS_HMC5x83_ReadDone(struct pios_i2c_transaction *transaction, int32_t result, bool *woken)
+{
+    pios_hmc5x83_dev_data_t *dev = (pios_hmc5x83_dev_data_t *)transaction->context;
+
+    // only chain the mode write after a good read, the next data ready interrupt retries a failed one
+    if (result != 0) {
+        dev->read_pending = false;
+        return;
+    }
+    memcpy(dev->sample, dev->read_buffer, sizeof(dev->sample));
+    dev->sample_read_time = dev->sample_time;
+    dev->data_ready = true;
+
+    // as PIOS_HMC5x83_ReadMag(), keep the sensor in continuous conversion mode
+    if (PIOS_I2C_SubmitTransactionISR(dev->port_id, &dev->mode_transaction, woken) != 0) {
+        dev->read_pending = false;
+    }
+}
+
+static void PIOS_HMC5x83_QueueInit(pios_hmc5x83_dev_data_t *dev)
+{
+    dev->queued = dev->cfg->Driver == &PIOS_HMC5x83_I2C_DRIVER;
+
+    dev->read_cmd    = PIOS_HMC5x83_DATAOUT_XMSB_REG;
+    dev->mode_cmd[0] = PIOS_HMC5x83_MODE_REG;
+    dev->mode_cmd[1] = PIOS_HMC5x83_MODE_CONTINUOUS;
+
+    dev->read_txns[0] = (struct pios_i2c_txn) {
+        .info = __func__,
+        .addr = PIOS_HMC5x83_I2C_ADDR,
+        .rw   = PIOS_I2C_TXN_WRITE,
+        .len  = sizeof(dev->read_cmd),
+        .buf  = &dev->read_cmd,
+    };
+    dev->read_txns[1] = (struct pios_i2c_txn) {
+        .info = __func__,
+        .addr = PIOS_HMC5x83_I2C_ADDR,
+        .rw   = PIOS_I2C_TXN_READ,
+        .len  = sizeof(dev->read_buffer),
+        .buf  = dev->read_buffer,
+    };
+    dev->mode_txn = (struct pios_i2c_txn) {
+        .info = __func__,
+        .addr = PIOS_HMC5x83_I2C_ADDR,
+        .rw   = PIOS_I2C_TXN_WRITE,
+        .len  = sizeof(dev->mode_cmd),
+        .buf  = dev->mode_cmd,
+    };
+
+    dev->read_transaction = (struct pios_i2c_transaction) {
+        .txn_list = dev->read_txns,
+        .num_txns = NELEMENTS(dev->read_txns),
+        .callback = PIOS_HMC5x83_ReadDone,
+        .context  = dev,
+    };
+    dev->mode_transaction = (struct pios_i2c_transaction) {
+        .txn_list = &dev->mode_txn,
+        .num_txns = 1,
+        .callback = PIOS_HMC5x83_ModeDone,
+        .context  = dev,
+    };
+}
+#endif /* PIOS_HMC5X83_QUEUED_READ */
+
 #ifdef PIOS_INCLUDE_SPI
 int32_t PIOS_HMC5x83_SPI_Read(pios_hmc5x83_dev_t handler, uint8_t address, uint8_t *buffer, uint8_t len);
 int32_t PIOS_HMC5x83_SPI_Write(pios_hmc5x83_dev_t handler, uint8_t address, uint8_t buffer);
@@ -622,13 +744,48 @@ void PIOS_HMC5x83_driver_get_scale(float *scales, uint8_t size, __attribute__((u
     scales[0] = 1;
 }
 
+static void PIOS_HMC5x83_FillBatch(void *data, uint32_t sample_time, const int16_t mag[3]);
+
+/**
+ * Fetch the sample as a batch of one, stamped with the time of the data ready
+ * interrupt rather than the time the sensor task got around to reading it.
+ */
 void PIOS_HMC5x83_driver_fetch(void *data, uint8_t size, uintptr_t context)
 {
     PIOS_Assert(size > 0);
+    pios_hmc5x83_dev_data_t *dev = dev_validate((pios_hmc5x83_dev_t)context);
     int16_t mag[3];
-    PIOS_HMC5x83_ReadMag((pios_hmc5x83_dev_t)context, mag);
-    PIOS_SENSORS_3Axis_SensorsWithTemp *tmp = data;
-    tmp->count = 1;
+#ifdef PIOS_HMC5X83_QUEUED_READ
+    if (dev->queued) {
+        // the data ready interrupt has read the sample already
+        uint8_t buffer[6];
+        PIOS_IRQ_Disable();
+        memcpy(buffer, dev->sample, sizeof(buffer));
+        const uint32_t sample_time = dev->sample_read_time;
+        dev->data_ready = false;
+        PIOS_IRQ_Enable();
+        PIOS_HMC5x83_Convert(dev, buffer, mag);
+        PIOS_HMC5x83_FillBatch(data, sample_time, mag);
+        return;
+    }
+#endif
+#ifdef PIOS_HMC5X83_HAS_GPIOS
+    // read before the data, a new interrupt during the read stamps the next sample
+    const uint32_t sample_time = dev->sample_time;
+#else
+    const uint32_t sample_time = PIOS_DELAY_GetuS();
+#endif
+    PIOS_HMC5x83_ReadMag((pios_hmc5x83_dev_t)dev, mag);
+    PIOS_HMC5x83_FillBatch(data, sample_time, mag);
+}
+
+static void PIOS_HMC5x83_FillBatch(void *data, uint32_t sample_time, const int16_t mag[3])
+{
+    PIOS_SENSORS_3Axis_SensorsBatch *tmp = data;
+    tmp->count   = 1;
+    tmp->samples = 1;
+    tmp->timestamp   = sample_time;
+    tmp->period      = 0;
     tmp->sample[0].x = mag[0];
     tmp->sample[0].y = mag[1];
     tmp->sample[0].z = mag[2];
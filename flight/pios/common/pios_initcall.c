@@ -0,0 +1,165 @@
+/**
+ ******************************************************************************
+ * @addtogroup PIOS PIOS Initcall infrastructure
+ * @{
+ * @addtogroup   PIOS_INITCALL Generic Initcall Macros
+ * @brief Module Initialize and Start calls, and the boot timeline
+ * @{
+ *
+ * @file       pios_initcall.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Runs the module initcalls, timing them
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <pios.h>
+
+#ifdef PIOS_INCLUDE_INITCALL
+
+#if defined(PIOS_INCLUDE_INITCALL_PARALLEL) && !defined(PIOS_INCLUDE_FREERTOS)
+#error PiOS parallel module initialisation requires PIOS_INCLUDE_FREERTOS to be defined
+#endif
+
+#ifndef PIOS_INITCALL_PARALLEL_STACK_SIZE
+#define PIOS_INITCALL_PARALLEL_STACK_SIZE 1024
+#endif
+
+static struct pios_initcall_stats initcallStats;
+
+void PIOS_INITCALL_MarkPhase(enum pios_initcall_phase phase)
+{
+    if (phase < PIOS_INITCALL_PHASE_COUNT && initcallStats.phase_ms[phase] == 0) {
+        initcallStats.phase_ms[phase] = xTaskGetTickCount() * portTICK_RATE_MS;
+    }
+}
+
+void PIOS_INITCALL_GetStats(struct pios_initcall_stats *stats)
+{
+    PIOS_Assert(stats);
+    *stats = initcallStats;
+}
+
+#ifndef USE_SIM_POSIX
+
+/**
+ * Run an initcall, keeping the slowest one and its duration
+ */
+static void timedCall(initcall_t fn, uint32_t *slowest_us, initcall_t *slowest)
+{
+    uint32_t start = PIOS_DELAY_GetRaw();
+
+    fn();
+    uint32_t elapsed = PIOS_DELAY_DiffuS(start);
+
+    // the parallel initcalls race the others here, the worst is a wrong slowest module
+    if (elapsed > *slowest_us) {
+        *slowest_us = elapsed;
+        *slowest    = fn;
+    }
+}
+
+static void initModules(uint32_t mask, uint32_t flags)
+{
+    for (initmodule_t *fn = __module_initcall_start; fn < __module_initcall_end; fn++) {
+        if (fn->fn_minit && (fn->flags & mask) == flags) {
+            timedCall(fn->fn_minit, &initcallStats.slowest_init_us, &initcallStats.slowest_init);
+        }
+    }
+}
+
+#ifdef PIOS_INCLUDE_INITCALL_PARALLEL
+static xSemaphoreHandle parallelDone;
+static volatile bool modulesInitialised;
+
+/**
+ * Runs the Initialize of the independent modules alongside the others
+ */
+static void parallelInitTask(__attribute__((unused)) void *parameters)
+{
+    initModules(PIOS_INITCALL_PARALLEL, PIOS_INITCALL_PARALLEL);
+    xSemaphoreGive(parallelDone);
+    vTaskDelete(NULL);
+}
+#endif /* PIOS_INCLUDE_INITCALL_PARALLEL */
+
+/**
+ * Initialize all modules, in link order. With PIOS_INCLUDE_INITCALL_PARALLEL
+ * the modules declared with MODULE_INITCALL_PARALLEL are initialised by a second
+ * task meanwhile, which needs the scheduler to be running. Returns once all
+ * modules are initialised.
+ */
+void PIOS_INITCALL_InitModules(void)
+{
+    PIOS_INITCALL_MarkPhase(PIOS_INITCALL_PHASE_BOARDINIT);
+
+#ifdef PIOS_INCLUDE_INITCALL_PARALLEL
+    xTaskHandle parallelTask = NULL;
+    vSemaphoreCreateBinary(parallelDone);
+    if (parallelDone) {
+        xSemaphoreTake(parallelDone, 0);
+        // same priority as this task, the two share the CPU while neither waits
+        xTaskCreate(parallelInitTask, "InitPar", PIOS_INITCALL_PARALLEL_STACK_SIZE / 4,
+                    NULL, uxTaskPriorityGet(NULL), &parallelTask);
+    }
+    initModules(PIOS_INITCALL_PARALLEL, 0);
+    if (parallelTask) {
+        xSemaphoreTake(parallelDone, portMAX_DELAY);
+    } else {
+        initModules(PIOS_INITCALL_PARALLEL, PIOS_INITCALL_PARALLEL);
+    }
+    if (parallelDone) {
+        vSemaphoreDelete(parallelDone);
+        parallelDone = NULL;
+    }
+    modulesInitialised = true;
+#else
+    initModules(0, 0);
+#endif /* PIOS_INCLUDE_INITCALL_PARALLEL */
+
+    PIOS_INITCALL_MarkPhase(PIOS_INITCALL_PHASE_MODULEINIT);
+}
+
+/**
+ * Start all modules, in link order
+ */
+void PIOS_INITCALL_StartModules(void)
+{
+#ifdef PIOS_INCLUDE_INITCALL_PARALLEL
+    // the System task may get here while the init task waits for the parallel initcalls
+    while (!modulesInitialised) {
+        vTaskDelay(1);
+    }
+#endif
+    for (initmodule_t *fn = __module_initcall_start; fn < __module_initcall_end; fn++) {
+        if (fn->fn_tinit) {
+            timedCall(fn->fn_tinit, &initcallStats.slowest_start_us, &initcallStats.slowest_start);
+        }
+    }
+
+    PIOS_INITCALL_MarkPhase(PIOS_INITCALL_PHASE_MODULESTART);
+}
+
+#endif /* USE_SIM_POSIX */
+
+#endif /* PIOS_INCLUDE_INITCALL */
+
+/**
+ * @}
+ * @}
+ */
@@ -30,8 +30,36 @@ pios_perf_counter_t *pios_instrumentation_perf_counters = NULL;
 int8_t pios_instrumentation_max_counters = -1;
 int8_t pios_instrumentation_last_used_counter = -1;
 
+pios_perf_profile_t *pios_instrumentation_perf_profiles = NULL;
+static int8_t max_profiles = 0;
+static int8_t num_profiles = 0;
+
+#ifdef PIOS_INSTRUMENTATION_TRACE_EVENTS
+/* a power of two, so that the ring index wraps with a mask */
+#if (PIOS_INSTRUMENTATION_TRACE_EVENTS & (PIOS_INSTRUMENTATION_TRACE_EVENTS - 1)) != 0
+#error PIOS_INSTRUMENTATION_TRACE_EVENTS must be a power of two
+#endif
+static struct pios_trace_event *trace_events = NULL;
+/* total number of events recorded, the newest is at (trace_next - 1) in the ring */
+static uint32_t trace_next;
+static bool trace_frozen;
+#endif
+
 void PIOS_Instrumentation_Init(int8_t maxCounters)
 {
+#ifdef PIOS_INSTRUMENTATION_MAX_PROFILES
+    pios_instrumentation_perf_profiles = (pios_perf_profile_t *)pvPortMalloc(sizeof(pios_perf_profile_t) * PIOS_INSTRUMENTATION_MAX_PROFILES);
+    PIOS_Assert(pios_instrumentation_perf_profiles);
+    memset(pios_instrumentation_perf_profiles, 0, sizeof(pios_perf_profile_t) * PIOS_INSTRUMENTATION_MAX_PROFILES);
+    max_profiles = PIOS_INSTRUMENTATION_MAX_PROFILES;
+#endif
+#ifdef PIOS_INSTRUMENTATION_TRACE_EVENTS
+    trace_events = (struct pios_trace_event *)pvPortMalloc(sizeof(struct pios_trace_event) * PIOS_INSTRUMENTATION_TRACE_EVENTS);
+    PIOS_Assert(trace_events);
+    trace_next   = 0;
+    trace_frozen = false;
+#endif
+
     PIOS_Assert(maxCounters >= 0);
     if (maxCounters > 0) {
         pios_instrumentation_perf_counters = (pios_perf_counter_t *)pvPortMalloc(sizeof(pios_perf_counter_t) * maxCounters);
@@ -80,3 +108,187 @@ void PIOS_Instrumentation_ForEachCounter(InstrumentationCounterCallback callback
         callback(counter, index, context);
     }
 }
+
+pios_profile_t PIOS_Instrumentation_CreateProfile(uint32_t id)
+{
+    PIOS_Assert(pios_instrumentation_perf_profiles);
+
+    for (int8_t index = 0; index < num_profiles; index++) {
+        if (pios_instrumentation_perf_profiles[index].id == id) {
+            return (pios_profile_t)&pios_instrumentation_perf_profiles[index];
+        }
+    }
+
+    PIOS_Assert(num_profiles < max_profiles);
+    pios_perf_profile_t *profile = &pios_instrumentation_perf_profiles[num_profiles++];
+    profile->id  = id;
+    profile->min = UINT32_MAX;
+    return (pios_profile_t)profile;
+}
+
+int8_t PIOS_Instrumentation_GetNumProfiles()
+{
+    return num_profiles;
+}
+
+/* two buckets per octave from 256 cycles on, the first bucket takes the shorter sections */
+static uint8_t profileBucket(uint32_t cycles)
+{
+    if (cycles < 256) {
+        return 0;
+    }
+    uint8_t msb    = 31 - __builtin_clz(cycles);
+    uint8_t bucket = (msb - 8) * 2 + ((cycles >> (msb - 1)) & 1);
+    return (bucket < PIOS_INSTRUMENTATION_PROFILE_BUCKETS) ? bucket : PIOS_INSTRUMENTATION_PROFILE_BUCKETS - 1;
+}
+
+/* upper limit of a bucket */
+static uint32_t profileBucketLimit(uint8_t bucket)
+{
+    uint8_t msb = 8 + bucket / 2;
+
+    return (bucket & 1) ? (2u << msb) : (3u << (msb - 1));
+}
+
+void PIOS_Instrumentation_ProfileAdd(pios_profile_t profile_handle, uint32_t cycles)
+{
+    PIOS_Assert(pios_instrumentation_perf_profiles && profile_handle);
+    pios_perf_profile_t *profile = (pios_perf_profile_t *)profile_handle;
+    uint8_t bucket = profileBucket(cycles);
+
+    vPortEnterCritical();
+    profile->count++;
+    profile->sum += cycles;
+    if (cycles < profile->min) {
+        profile->min = cycles;
+    }
+    if (cycles > profile->max) {
+        profile->max = cycles;
+    }
+    if (profile->histogram[bucket] < UINT16_MAX) {
+        profile->histogram[bucket]++;
+    }
+    vPortExitCritical();
+}
+
+/* the duration that percent of the sections did not exceed, to the resolution of the histogram */
+static uint32_t profilePercentile(const pios_perf_profile_t *profile, uint32_t total, uint8_t percent)
+{
+    uint32_t threshold = (total * percent + 99) / 100;
+    uint32_t seen = 0;
+
+    for (uint8_t bucket = 0; bucket < PIOS_INSTRUMENTATION_PROFILE_BUCKETS; bucket++) {
+        seen += profile->histogram[bucket];
+        if (seen >= threshold) {
+            uint32_t limit = profileBucketLimit(bucket);
+            return (limit < profile->max) ? limit : profile->max;
+        }
+    }
+    return profile->max;
+}
+
+int32_t PIOS_Instrumentation_GetProfileStats(int8_t index, struct pios_perf_profile_stats *stats, bool reset)
+{
+    if (index < 0 || index >= num_profiles) {
+        return -1;
+    }
+
+    /* work on a copy, the histogram is too long to walk in a critical section */
+    pios_perf_profile_t profile;
+    pios_perf_profile_t *live = &pios_instrumentation_perf_profiles[index];
+    vPortEnterCritical();
+    profile = *live;
+    if (reset) {
+        live->count = 0;
+        live->sum   = 0;
+        live->min   = UINT32_MAX;
+        live->max   = 0;
+        memset(live->histogram, 0, sizeof(live->histogram));
+    }
+    vPortExitCritical();
+
+    uint32_t total = 0;
+    for (uint8_t bucket = 0; bucket < PIOS_INSTRUMENTATION_PROFILE_BUCKETS; bucket++) {
+        total += profile.histogram[bucket];
+    }
+
+    stats->id    = profile.id;
+    stats->count = profile.count;
+    if (profile.count == 0) {
+        stats->min = stats->max = stats->average = 0;
+        stats->p50 = stats->p90 = stats->p99 = 0;
+        return 0;
+    }
+    stats->min     = profile.min;
+    stats->max     = profile.max;
+    stats->average = (uint32_t)(profile.sum / profile.count);
+    stats->p50     = profilePercentile(&profile, total, 50);
+    stats->p90     = profilePercentile(&profile, total, 90);
+    stats->p99     = profilePercentile(&profile, total, 99);
+    return 0;
+}
+
+#ifdef PIOS_INSTRUMENTATION_TRACE_EVENTS
+void PIOS_Instrumentation_TraceEvent(uint8_t type, uint16_t id)
+{
+    if (!trace_events || trace_frozen) {
+        return;
+    }
+
+    uint32_t timestamp = PIOS_DELAY_GetRaw();
+#ifdef PIOS_INCLUDE_TASK_MONITOR
+    int16_t task = PIOS_TASK_MONITOR_GetCurrentTaskId();
+#else
+    int16_t task = -1;
+#endif
+
+    vPortEnterCritical();
+    struct pios_trace_event *event = &trace_events[trace_next++ & (PIOS_INSTRUMENTATION_TRACE_EVENTS - 1)];
+    event->timestamp = timestamp;
+    event->id   = id;
+    event->type = type;
+    event->task = (task >= 0 && task < PIOS_TRACE_TASK_UNKNOWN) ? task : PIOS_TRACE_TASK_UNKNOWN;
+    vPortExitCritical();
+}
+#endif /* PIOS_INSTRUMENTATION_TRACE_EVENTS */
+
+void PIOS_Instrumentation_TraceFreeze(__attribute__((unused)) bool frozen)
+{
+#ifdef PIOS_INSTRUMENTATION_TRACE_EVENTS
+    trace_frozen = frozen;
+#endif
+}
+
+uint16_t PIOS_Instrumentation_TraceCount()
+{
+#ifdef PIOS_INSTRUMENTATION_TRACE_EVENTS
+    return (trace_next < PIOS_INSTRUMENTATION_TRACE_EVENTS) ? trace_next : PIOS_INSTRUMENTATION_TRACE_EVENTS;
+
+#else
+    return 0;
+
+#endif
+}
+
+uint16_t PIOS_Instrumentation_TraceRead(__attribute__((unused)) uint16_t first, __attribute__((unused)) struct pios_trace_event *events, __attribute__((unused)) uint16_t count)
+{
+#ifdef PIOS_INSTRUMENTATION_TRACE_EVENTS
+    uint16_t available = PIOS_Instrumentation_TraceCount();
+
+    if (!trace_events || !trace_frozen || first >= available) {
+        return 0;
+    }
+    if (count > available - first) {
+        count = available - first;
+    }
+    uint32_t oldest = trace_next - available;
+    for (uint16_t i = 0; i < count; i++) {
+        events[i] = trace_events[(oldest + first + i) & (PIOS_INSTRUMENTATION_TRACE_EVENTS - 1)];
+    }
+    return count;
+
+#else
+    return 0;
+
+#endif
+}
@@ -157,6 +157,30 @@ int32_t PIOS_FLASHFS_ObjSave(
     return 0;
 }
 
+/**
+ * @brief Saves a batch of object instances to the filesystem
+ * @param[in] fs_id The filesystem to use for this action
+ * @param[in] next Called for every object instance to save until it returns false
+ * @param[in] context Passed on to next
+ * @return 0 if success or the error code of the first object that failed to save
+ */
+int32_t PIOS_FLASHFS_ObjSaveBatch(uintptr_t fs_id, PIOS_FLASHFS_ObjIterator next, void *context)
+{
+    uint32_t obj_id;
+    uint16_t obj_inst_id;
+    uint8_t *obj_data;
+    uint16_t obj_size;
+
+    while (next(context, &obj_id, &obj_inst_id, &obj_data, &obj_size)) {
+        int32_t rc = PIOS_FLASHFS_ObjSave(fs_id, obj_id, obj_inst_id, obj_data, obj_size);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    return 0;
+}
+
 /**
  * @brief Load one object instance from the filesystem
  * @param[in] fs_id The filesystem to use for this action
@@ -286,7 +310,8 @@ int32_t PIOS_FLASHFS_GetStats(
 
     getDeviceName(fs_id, devicename);
 
-    // Get yaffs statistics for that device
+    // Get yaffs statistics for that device, yaffs does its own wear levelling and garbage collection
+    memset(stats, 0, sizeof(*stats));
     stats->num_free_slots   = yaffs_freespace(devicename);
     stats->num_active_slots = yaffs_totalspace(devicename) - stats->num_free_slots;
 
@@ -294,6 +319,16 @@ int32_t PIOS_FLASHFS_GetStats(
     return 0;
 }
 
+/**
+ * @brief Performs one step of background maintenance on the filesystem
+ * @param[in] fs_id The filesystem to use for this action
+ * @return 0, yaffs does its own housekeeping
+ */
+int32_t PIOS_FLASHFS_Maintain(__attribute__((unused)) uintptr_t fs_id)
+{
+    return 0;
+}
+
 
 /**
  * @}
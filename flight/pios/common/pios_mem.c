@@ -28,7 +28,8 @@
 #include <pios_mem.h>
 
 #ifdef PIOS_TARGET_PROVIDES_FAST_HEAP
-// relies on pios_general_malloc to perform the allocation (i.e. pios_msheap.c)
+// relies on pios_general_malloc to perform the allocation (i.e. pios_tlsf.c or pios_msheap.c),
+// which also provides pios_mem_get_stats
 extern void *pios_general_malloc(size_t size, bool fastheap);
 
 void *pios_fastheapmalloc(size_t size)
@@ -65,4 +66,20 @@ void pios_free(void *p)
     vPortFree(p);
 }
 
+// the FreeRTOS heap only knows how much is left, which nothing gives back (heap_1)
+void pios_mem_get_stats(struct pios_mem_stats *stats, uint8_t fastheap)
+{
+    memset(stats, 0, sizeof(*stats));
+#if defined(ARCH_POSIX) || defined(ARCH_WIN32)
+    // the posix port allocates from the C library (heap_3), which has no free space to report
+    (void)fastheap;
+#else
+    if (!fastheap) {
+        stats->free     = xPortGetFreeHeapSize();
+        stats->min_free = stats->free;
+        stats->largest_free = stats->free;
+    }
+#endif
+}
+
 #endif /* ifdef PIOS_TARGET_PROVIDES_FAST_HEAP */
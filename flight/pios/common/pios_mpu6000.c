@@ -57,6 +57,17 @@ const PIOS_SENSORS_Driver PIOS_MPU6000_Driver = {
     .get_scale = PIOS_MPU6000_driver_get_scale,
     .is_polled = false,
 };
+
+const PIOS_SENSORS_Driver PIOS_MPU6000_BatchDriver = {
+    .test       = PIOS_MPU6000_driver_Test,
+    .poll       = NULL,
+    .fetch      = NULL,
+    .reset      = PIOS_MPU6000_driver_Reset,
+    .get_queue  = PIOS_MPU6000_driver_get_queue,
+    .get_scale  = PIOS_MPU6000_driver_get_scale,
+    .is_polled  = false,
+    .is_batched = true,
+};
 //
 
 
@@ -68,6 +79,9 @@ struct mpu6000_dev {
     enum pios_mpu6000_range gyro_range;
     enum pios_mpu6000_accel_range accel_range;
     enum pios_mpu6000_filter filter;
+    uint8_t  burst_interval; // data ready interrupts between fifo reads
+    uint8_t  burst_countdown;
+    uint32_t sample_period_us;
     enum pios_mpu6000_dev_magic   magic;
 };
 
@@ -97,6 +111,13 @@ typedef union {
 
 #define GET_SENSOR_DATA(mpudataptr, sensor) (mpudataptr.data.sensor##_h << 8 | mpudataptr.data.sensor##_l)
 
+#define PIOS_MPU6000_FIFO_BURST_MAX   PIOS_SENSORS_MAX_BATCH_SAMPLES
+#define PIOS_MPU6000_FIFO_MAX_BYTES   1024
+// without the SPI transaction queue fifo bursts must stay on the PIO path of PIOS_SPI_TransferBlock to be safe in the interrupt
+#if !defined(PIOS_SPI_TRANSACTIONS) && (1 + PIOS_MPU6000_FIFO_BURST_MAX * PIOS_MPU6000_SAMPLES_BYTES) > 128
+#error MPU6000 fifo bursts must fit in one PIO block
+#endif
+
 // ! Global structure for this device device
 static struct mpu6000_dev *dev;
 volatile bool mpu6000_configured = false;
@@ -104,6 +125,24 @@ static mpu6000_data_t mpu6000_data;
 static PIOS_SENSORS_3Axis_SensorsWithTemp *queue_data = 0;
 #define SENSOR_COUNT     2
 #define SENSOR_DATA_SIZE (sizeof(PIOS_SENSORS_3Axis_SensorsWithTemp) + sizeof(Vector3i16) * SENSOR_COUNT)
+#define BATCH_DATA_SIZE  (sizeof(PIOS_SENSORS_3Axis_SensorsBatch) + sizeof(Vector3i16) * SENSOR_COUNT * PIOS_MPU6000_FIFO_BURST_MAX)
+static uint8_t mpu6000_fifo_buffer[1 + PIOS_MPU6000_FIFO_BURST_MAX * PIOS_MPU6000_SAMPLES_BYTES];
+static PIOS_SENSORS_3Axis_SensorsBatch *batch_data = 0;
+#if defined(PIOS_SPI_TRANSACTIONS)
+// the reads are queued from the data ready interrupt and completed from the SPI DMA interrupt,
+// a data ready interrupt arriving while the previous read is still queued is skipped
+static volatile bool mpu6000_read_pending;
+static uint32_t mpu6000_read_time;
+static uint8_t mpu6000_sensor_cmd[1 + PIOS_MPU6000_SAMPLES_BYTES] = { PIOS_MPU6000_SENSOR_FIRST_REG | 0x80 };
+static uint8_t mpu6000_count_cmd[3] = { PIOS_MPU6000_FIFO_CNT_MSB | 0x80 };
+static uint8_t mpu6000_count_buf[3];
+static uint8_t mpu6000_reset_cmd[2];
+static struct pios_spi_segment mpu6000_sensor_segment = { mpu6000_sensor_cmd, mpu6000_data.buffer, sizeof(mpu6000_data_t) };
+static struct pios_spi_segment mpu6000_count_segment  = { mpu6000_count_cmd, mpu6000_count_buf, sizeof(mpu6000_count_buf) };
+static struct pios_spi_segment mpu6000_reset_segment  = { mpu6000_reset_cmd, NULL, sizeof(mpu6000_reset_cmd) };
+static struct pios_spi_segment mpu6000_fifo_segment   = { mpu6000_fifo_buffer, mpu6000_fifo_buffer, 0 };
+static struct pios_spi_transaction mpu6000_transaction;
+#endif
 // ! Private functions
 static struct mpu6000_dev *PIOS_MPU6000_alloc(const struct pios_mpu6000_cfg *cfg);
 static int32_t PIOS_MPU6000_Validate(struct mpu6000_dev *dev);
@@ -113,12 +152,15 @@ static int32_t PIOS_MPU6000_GetReg(uint8_t address);
 static void PIOS_MPU6000_SetSpeed(const bool fast);
 static bool PIOS_MPU6000_HandleData();
 static bool PIOS_MPU6000_ReadSensor(bool *woken);
+static int16_t PIOS_MPU6000_ConvertSample(const uint8_t *raw, Vector3i16 *accel, Vector3i16 *gyro);
+static bool PIOS_MPU6000_QueueBatch(uint16_t samples, uint16_t left, uint32_t now, bool *woken);
+static bool PIOS_MPU6000_ReadFifo(bool *woken);
 
 static int32_t PIOS_MPU6000_Test(void);
 
 void PIOS_MPU6000_Register()
 {
-    PIOS_SENSORS_Register(&PIOS_MPU6000_Driver, PIOS_SENSORS_TYPE_3AXIS_GYRO_ACCEL, 0);
+    PIOS_SENSORS_Register(dev->cfg->fifo_burst ? &PIOS_MPU6000_BatchDriver : &PIOS_MPU6000_Driver, PIOS_SENSORS_TYPE_3AXIS_GYRO_ACCEL, 0);
 }
 /**
  * @brief Allocate a new device
@@ -132,12 +174,25 @@ static struct mpu6000_dev *PIOS_MPU6000_alloc(const struct pios_mpu6000_cfg *cfg
 
     mpu6000_dev->magic = PIOS_MPU6000_DEV_MAGIC;
 
-    mpu6000_dev->queue = xQueueCreate(cfg->max_downsample + 1, SENSOR_DATA_SIZE);
-    PIOS_Assert(mpu6000_dev->queue);
+    if (cfg->fifo_burst) {
+        // one item per burst, so far fewer items cover the same time span
+        mpu6000_dev->queue = xQueueCreate(cfg->max_downsample / 2 + 1, BATCH_DATA_SIZE);
+        PIOS_Assert(mpu6000_dev->queue);
+
+        batch_data = (PIOS_SENSORS_3Axis_SensorsBatch *)pios_malloc(BATCH_DATA_SIZE);
+        PIOS_Assert(batch_data);
+        batch_data->count = SENSOR_COUNT;
+    } else {
+        mpu6000_dev->queue = xQueueCreate(cfg->max_downsample + 1, SENSOR_DATA_SIZE);
+        PIOS_Assert(mpu6000_dev->queue);
 
-    queue_data = (PIOS_SENSORS_3Axis_SensorsWithTemp *)pios_malloc(SENSOR_DATA_SIZE);
-    PIOS_Assert(queue_data);
-    queue_data->count = SENSOR_COUNT;
+        queue_data = (PIOS_SENSORS_3Axis_SensorsWithTemp *)pios_malloc(SENSOR_DATA_SIZE);
+        PIOS_Assert(queue_data);
+        queue_data->count = SENSOR_COUNT;
+    }
+    mpu6000_dev->burst_interval   = 1;
+    mpu6000_dev->burst_countdown  = 1;
+    mpu6000_dev->sample_period_us = 1000;
     return mpu6000_dev;
 }
 
@@ -229,13 +284,16 @@ static void PIOS_MPU6000_Config(struct pios_mpu6000_cfg const *cfg)
         ;
     }
 
-    // FIFO storage
-    while (PIOS_MPU6000_SetReg(PIOS_MPU6000_FIFO_EN_REG, cfg->Fifo_store) != 0) {
+    // FIFO storage, burst mode stores whole samples in sensor register order
+    while (PIOS_MPU6000_SetReg(PIOS_MPU6000_FIFO_EN_REG, cfg->fifo_burst ?
+                               (PIOS_MPU6000_ACCEL_OUT | PIOS_MPU6000_FIFO_TEMP_OUT | PIOS_MPU6000_FIFO_GYRO_X_OUT |
+                                PIOS_MPU6000_FIFO_GYRO_Y_OUT | PIOS_MPU6000_FIFO_GYRO_Z_OUT) : cfg->Fifo_store) != 0) {
         ;
     }
     PIOS_MPU6000_ConfigureRanges(cfg->gyro_range, cfg->accel_range, cfg->filter);
     // Interrupt configuration
-    while (PIOS_MPU6000_SetReg(PIOS_MPU6000_USER_CTRL_REG, cfg->User_ctl) != 0) {
+    while (PIOS_MPU6000_SetReg(PIOS_MPU6000_USER_CTRL_REG, cfg->User_ctl |
+                               (cfg->fifo_burst ? (PIOS_MPU6000_USERCTL_FIFO_EN | PIOS_MPU6000_USERCTL_FIFO_RST) : 0)) != 0) {
         ;
     }
 
@@ -286,6 +344,17 @@ int32_t PIOS_MPU6000_ConfigureRanges(
 
     dev->filter = filterSetting;
 
+    // fifo bursts are read at about 1kHz whatever the output data rate
+    uint32_t sample_rate = (filterSetting == PIOS_MPU6000_LOWPASS_256_HZ ? 8000 : 1000) /
+                           (1 + (filterSetting == PIOS_MPU6000_LOWPASS_256_HZ ? dev->cfg->Smpl_rate_div_no_dlp : dev->cfg->Smpl_rate_div_dlp));
+    uint8_t burst_max    = dev->cfg->fifo_burst < PIOS_MPU6000_FIFO_BURST_MAX ? dev->cfg->fifo_burst : PIOS_MPU6000_FIFO_BURST_MAX;
+    dev->sample_period_us = 1000000 / sample_rate;
+    dev->burst_interval   = (sample_rate / 1000 < burst_max) ? sample_rate / 1000 : burst_max;
+    if (!dev->burst_interval) {
+        dev->burst_interval = 1;
+    }
+    dev->burst_countdown  = dev->burst_interval;
+
     // Gyro range
     while (PIOS_MPU6000_SetReg(PIOS_MPU6000_GYRO_CFG_REG, gyroRange) != 0) {
         ;
@@ -328,6 +397,7 @@ static void PIOS_MPU6000_SetSpeed(const bool fast)
     }
 }
 
+#if !defined(PIOS_SPI_TRANSACTIONS)
 /**
  * @brief Claim the SPI bus for the accel communications and select this chip
  * @return 0 if successful, -1 for invalid device, -2 if unable to claim bus
@@ -346,6 +416,7 @@ static int32_t PIOS_MPU6000_ClaimBusISR(bool *woken, bool fast_spi)
     PIOS_SPI_RC_PinSet(dev->spi_id, dev->slave_num, 0);
     return 0;
 }
+#endif /* !defined(PIOS_SPI_TRANSACTIONS) */
 
 /**
  * @brief Release the SPI bus for the accel communications and end the transaction
@@ -360,6 +431,7 @@ static int32_t PIOS_MPU6000_ReleaseBus()
     return PIOS_SPI_ReleaseBus(dev->spi_id);
 }
 
+#if !defined(PIOS_SPI_TRANSACTIONS)
 /**
  * @brief Release the SPI bus for the accel communications and end the transaction
  * @return 0 if successful
@@ -374,6 +446,7 @@ static int32_t PIOS_MPU6000_ReleaseBusISR(bool *woken)
     PIOS_SPI_RC_PinSet(dev->spi_id, dev->slave_num, 1);
     return PIOS_SPI_ReleaseBusISR(dev->spi_id, woken);
 }
+#endif /* !defined(PIOS_SPI_TRANSACTIONS) */
 
 /**
  * @brief Read a register from MPU6000
@@ -538,7 +611,7 @@ static int32_t PIOS_MPU6000_Test(void)
  *         higher priority task is now eligible to run
  */
 
-bool PIOS_MPU6000_IRQHandler(void)
+__fast_code bool PIOS_MPU6000_IRQHandler(void)
 {
     bool woken = false;
 
@@ -546,9 +619,19 @@ bool PIOS_MPU6000_IRQHandler(void)
         return false;
     }
 
+    if (dev->cfg->fifo_burst) {
+        if (--dev->burst_countdown) {
+            return false;
+        }
+        dev->burst_countdown = dev->burst_interval;
+        PIOS_MPU6000_ReadFifo(&woken);
+        return woken;
+    }
+
     bool read_ok = false;
     read_ok = PIOS_MPU6000_ReadSensor(&woken);
 
+    // with the transaction queue the data is handled once the read completed
     if (read_ok) {
         bool woken2 = PIOS_MPU6000_HandleData();
         woken |= woken2;
@@ -605,6 +688,246 @@ static bool PIOS_MPU6000_HandleData()
     return higherPriorityTaskWoken == pdTRUE;
 }
 
+/**
+ * @brief Rotate one raw sample in sensor register order to OP convention
+ * @return the temperature in degrees Celsius * 100
+ */
+static int16_t PIOS_MPU6000_ConvertSample(const uint8_t *raw, Vector3i16 *accel, Vector3i16 *gyro)
+{
+    const int16_t accel_x = raw[0] << 8 | raw[1];
+    const int16_t accel_y = raw[2] << 8 | raw[3];
+    const int16_t accel_z = raw[4] << 8 | raw[5];
+    const int16_t temp    = raw[6] << 8 | raw[7];
+    const int16_t gyro_x  = raw[8] << 8 | raw[9];
+    const int16_t gyro_y  = raw[10] << 8 | raw[11];
+    const int16_t gyro_z  = raw[12] << 8 | raw[13];
+
+    // same rotations as PIOS_MPU6000_HandleData()
+    switch (dev->cfg->orientation) {
+    case PIOS_MPU6000_TOP_0DEG:
+        accel->y = accel_x;
+        accel->x = accel_y;
+        gyro->y  = gyro_x;
+        gyro->x  = gyro_y;
+        break;
+    case PIOS_MPU6000_TOP_90DEG:
+        accel->y = -1 - accel_y;
+        accel->x = accel_x;
+        gyro->y  = -1 - gyro_y;
+        gyro->x  = gyro_x;
+        break;
+    case PIOS_MPU6000_TOP_180DEG:
+        accel->y = -1 - accel_x;
+        accel->x = -1 - accel_y;
+        gyro->y  = -1 - gyro_x;
+        gyro->x  = -1 - gyro_y;
+        break;
+    case PIOS_MPU6000_TOP_270DEG:
+        accel->y = accel_y;
+        accel->x = -1 - accel_x;
+        gyro->y  = gyro_y;
+        gyro->x  = -1 - gyro_x;
+        break;
+    }
+    accel->z = -1 - accel_z;
+    gyro->z  = -1 - gyro_z;
+
+    return 3500 + ((float)(temp + 512)) * (1.0f / 3.4f);
+}
+
+/**
+ * @brief Rotate the samples read from the fifo and queue them as one batch
+ * @param[in] samples number of samples at the start of mpu6000_fifo_buffer
+ * @param[in] left samples that were left in the fifo behind them
+ * @param[in] now time of the data ready interrupt of the newest sample in the fifo
+ * @return true if a batch was queued
+ */
+static bool PIOS_MPU6000_QueueBatch(uint16_t samples, uint16_t left, uint32_t now, bool *woken)
+{
+    for (uint16_t i = 0; i < samples; i++) {
+        const uint8_t *raw = &mpu6000_fifo_buffer[1 + i * PIOS_MPU6000_SAMPLES_BYTES];
+        batch_data->temperature = PIOS_MPU6000_ConvertSample(raw, &batch_data->sample[i * SENSOR_COUNT], &batch_data->sample[i * SENSOR_COUNT + 1]);
+    }
+    batch_data->samples   = samples;
+    batch_data->timestamp = now - (uint32_t)left * dev->sample_period_us;
+    batch_data->period    = dev->sample_period_us;
+
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    xQueueSendToBackFromISR(dev->queue, (void *)batch_data, &higherPriorityTaskWoken);
+    *woken = *woken || (higherPriorityTaskWoken == pdTRUE);
+    return true;
+}
+
+#if defined(PIOS_SPI_TRANSACTIONS)
+
+/**
+ * @brief Queue the next read of the chain started by the data ready interrupt
+ */
+static void PIOS_MPU6000_Submit(struct pios_spi_segment *segment, bool fast_spi,
+                                void (*callback)(struct pios_spi_transaction *transaction, int32_t result, bool *woken), bool *woken)
+{
+    mpu6000_transaction.slave_id      = dev->slave_num;
+    mpu6000_transaction.prescaler     = fast_spi ? dev->cfg->fast_prescaler : dev->cfg->std_prescaler;
+    mpu6000_transaction.segments      = segment;
+    mpu6000_transaction.segment_count = 1;
+    mpu6000_transaction.callback      = callback;
+
+    if (PIOS_SPI_SubmitTransactionISR(dev->spi_id, &mpu6000_transaction, woken) != 0) {
+        mpu6000_read_pending = false;
+    }
+}
+
+static void PIOS_MPU6000_ReadDone(__attribute__((unused)) struct pios_spi_transaction *transaction, __attribute__((unused)) int32_t result,
+                                  __attribute__((unused)) bool *woken)
+{
+    mpu6000_read_pending = false;
+}
+
+static void PIOS_MPU6000_SensorDone(__attribute__((unused)) struct pios_spi_transaction *transaction, int32_t result, bool *woken)
+{
+    if (result == 0) {
+        *woken = PIOS_MPU6000_HandleData() || *woken;
+    }
+    mpu6000_read_pending = false;
+}
+
+static void PIOS_MPU6000_FifoDone(__attribute__((unused)) struct pios_spi_transaction *transaction, int32_t result, bool *woken)
+{
+    if (result == 0) {
+        const uint16_t samples = (mpu6000_fifo_segment.len - 1) / PIOS_MPU6000_SAMPLES_BYTES;
+        const uint16_t fifo_samples = (mpu6000_count_buf[1] << 8 | mpu6000_count_buf[2]) / PIOS_MPU6000_SAMPLES_BYTES;
+        PIOS_MPU6000_QueueBatch(samples, fifo_samples - samples, mpu6000_read_time, woken);
+    }
+    mpu6000_read_pending = false;
+}
+
+static void PIOS_MPU6000_FifoCountDone(__attribute__((unused)) struct pios_spi_transaction *transaction, int32_t result, bool *woken)
+{
+    if (result != 0) {
+        mpu6000_read_pending = false;
+        return;
+    }
+
+    uint16_t fifo_bytes = mpu6000_count_buf[1] << 8 | mpu6000_count_buf[2];
+    if ((fifo_bytes % PIOS_MPU6000_SAMPLES_BYTES) || fifo_bytes > PIOS_MPU6000_FIFO_MAX_BYTES - PIOS_MPU6000_SAMPLES_BYTES) {
+        // overflowed or lost alignment, start over
+        mpu6000_reset_cmd[0] = PIOS_MPU6000_USER_CTRL_REG;
+        mpu6000_reset_cmd[1] = dev->cfg->User_ctl | PIOS_MPU6000_USERCTL_FIFO_EN | PIOS_MPU6000_USERCTL_FIFO_RST;
+        PIOS_MPU6000_Submit(&mpu6000_reset_segment, false, PIOS_MPU6000_ReadDone, woken);
+        return;
+    }
+
+    uint16_t samples = fifo_bytes / PIOS_MPU6000_SAMPLES_BYTES;
+    if (samples > PIOS_MPU6000_FIFO_BURST_MAX) {
+        samples = PIOS_MPU6000_FIFO_BURST_MAX; // the rest goes with the next burst
+    }
+    if (!samples) {
+        mpu6000_read_pending = false;
+        return;
+    }
+
+    mpu6000_fifo_buffer[0]   = PIOS_MPU6000_FIFO_REG | 0x80;
+    mpu6000_fifo_segment.len = 1 + samples * PIOS_MPU6000_SAMPLES_BYTES;
+    PIOS_MPU6000_Submit(&mpu6000_fifo_segment, true, PIOS_MPU6000_FifoDone, woken);
+}
+
+/**
+ * @brief Queue the read of the fifo count, the samples are read and queued once it completed
+ * @return false, the batch is queued later from the SPI interrupt
+ */
+static bool PIOS_MPU6000_ReadFifo(bool *woken)
+{
+    if (!batch_data || mpu6000_read_pending) {
+        return false;
+    }
+    mpu6000_read_pending = true;
+    mpu6000_read_time    = PIOS_DELAY_GetuS();
+    PIOS_MPU6000_Submit(&mpu6000_count_segment, true, PIOS_MPU6000_FifoCountDone, woken);
+    return false;
+}
+
+/**
+ * @brief Queue the read of the sensor registers, the data is handled once it completed
+ * @return false, the data is not read yet
+ */
+static bool PIOS_MPU6000_ReadSensor(bool *woken)
+{
+    if (mpu6000_read_pending) {
+        return false;
+    }
+    mpu6000_read_pending = true;
+    PIOS_MPU6000_Submit(&mpu6000_sensor_segment, true, PIOS_MPU6000_SensorDone, woken);
+    return false;
+}
+
+#else /* PIOS_SPI_TRANSACTIONS */
+
+/**
+ * @brief Reset the fifo after an overflow or a misaligned read, from the interrupt
+ */
+static void PIOS_MPU6000_ResetFifoISR(bool *woken)
+{
+    const uint8_t reset_cmd[2] = { PIOS_MPU6000_USER_CTRL_REG, dev->cfg->User_ctl | PIOS_MPU6000_USERCTL_FIFO_EN | PIOS_MPU6000_USERCTL_FIFO_RST };
+
+    if (PIOS_MPU6000_ClaimBusISR(woken, false) != 0) {
+        return;
+    }
+    PIOS_SPI_TransferBlock(dev->spi_id, reset_cmd, NULL, sizeof(reset_cmd), NULL);
+    PIOS_MPU6000_ReleaseBusISR(woken);
+}
+
+/**
+ * @brief Burst read the samples waiting in the fifo and queue them as one batch
+ * @return true if a batch was queued
+ */
+static bool PIOS_MPU6000_ReadFifo(bool *woken)
+{
+    const uint8_t count_cmd[3] = { PIOS_MPU6000_FIFO_CNT_MSB | 0x80 };
+    uint8_t count_buf[3];
+    const uint32_t now = PIOS_DELAY_GetuS();
+
+    if (!batch_data) {
+        return false;
+    }
+
+    if (PIOS_MPU6000_ClaimBusISR(woken, true) != 0) {
+        return false;
+    }
+    if (PIOS_SPI_TransferBlock(dev->spi_id, count_cmd, count_buf, sizeof(count_buf), NULL) < 0) {
+        PIOS_MPU6000_ReleaseBusISR(woken);
+        return false;
+    }
+    PIOS_MPU6000_ReleaseBusISR(woken);
+
+    uint16_t fifo_bytes = count_buf[1] << 8 | count_buf[2];
+    if ((fifo_bytes % PIOS_MPU6000_SAMPLES_BYTES) || fifo_bytes > PIOS_MPU6000_FIFO_MAX_BYTES - PIOS_MPU6000_SAMPLES_BYTES) {
+        // overflowed or lost alignment, start over
+        PIOS_MPU6000_ResetFifoISR(woken);
+        return false;
+    }
+
+    uint16_t samples = fifo_bytes / PIOS_MPU6000_SAMPLES_BYTES;
+    if (samples > PIOS_MPU6000_FIFO_BURST_MAX) {
+        samples = PIOS_MPU6000_FIFO_BURST_MAX; // the rest goes with the next burst
+    }
+    if (!samples) {
+        return false;
+    }
+
+    mpu6000_fifo_buffer[0] = PIOS_MPU6000_FIFO_REG | 0x80;
+    if (PIOS_MPU6000_ClaimBusISR(woken, true) != 0) {
+        return false;
+    }
+    if (PIOS_SPI_TransferBlock(dev->spi_id, mpu6000_fifo_buffer, mpu6000_fifo_buffer, 1 + samples * PIOS_MPU6000_SAMPLES_BYTES, NULL) < 0) {
+        PIOS_MPU6000_ReleaseBusISR(woken);
+        return false;
+    }
+    PIOS_MPU6000_ReleaseBusISR(woken);
+
+    // the newest sample in the fifo is the one that raised this interrupt
+    return PIOS_MPU6000_QueueBatch(samples, fifo_bytes / PIOS_MPU6000_SAMPLES_BYTES - samples, now, woken);
+}
+
 static bool PIOS_MPU6000_ReadSensor(bool *woken)
 {
     const uint8_t mpu6000_send_buf[1 + PIOS_MPU6000_SAMPLES_BYTES] = { PIOS_MPU6000_SENSOR_FIRST_REG | 0x80 };
@@ -620,6 +943,8 @@ static bool PIOS_MPU6000_ReadSensor(bool *woken)
     return true;
 }
 
+#endif /* PIOS_SPI_TRANSACTIONS */
+
 // Sensor driver implementation
 bool PIOS_MPU6000_driver_Test(__attribute__((unused)) uintptr_t context)
 {
@@ -73,6 +73,8 @@ static uint32_t RawPressure;
 static int64_t Pressure;
 static int64_t Temperature;
 static int32_t lastConversionStart;
+// PIOS_DELAY_GetuS() at the start of the last pressure conversion
+static uint32_t pressureConversionStart;
 
 static uint32_t conversionDelayMs;
 static uint32_t conversionDelayUs;
@@ -81,9 +83,12 @@ static int32_t PIOS_MS5611_Read(uint8_t address, uint8_t *buffer, uint8_t len);
 static int32_t PIOS_MS5611_WriteCommand(uint8_t command);
 static uint32_t PIOS_MS5611_GetDelay();
 static uint32_t PIOS_MS5611_GetDelayUs();
+static void PIOS_MS5611_Compensate(const uint8_t Data[3]);
 
 // Second order temperature compensation. Temperature offset
 static int64_t compensation_t2;
+// Difference between actual and reference temperature
+static int64_t deltaTemp;
 
 // Move into proper driver structure with cfg stored
 static uint32_t oversampling;
@@ -91,6 +96,63 @@ static const struct pios_ms5611_cfg *dev_cfg;
 static int32_t i2c_id;
 static PIOS_SENSORS_1Axis_SensorsWithTemp results;
 
+#if defined(PIOS_I2C_TRANSACTIONS)
+/*
+ * The sensor loop does not wait on the bus: the conversion command and the ADC
+ * read are queued and the poll after their completion picks the result up.
+ * The magnetometer shares the bus, its reads go in between.
+ */
+static void PIOS_MS5611_ADCDone(struct pios_i2c_transaction *transaction, int32_t result, bool *woken);
+static void PIOS_MS5611_ConversionStarted(struct pios_i2c_transaction *transaction, int32_t result, bool *woken);
+
+static uint8_t ms5611_adc_cmd = MS5611_ADC_READ;
+static uint8_t ms5611_adc[3];
+static uint8_t ms5611_conversion_cmd;
+
+static const struct pios_i2c_txn ms5611_adc_txns[] = {
+    {
+        .info = "PIOS_MS5611_ADC",
+        .addr = MS5611_I2C_ADDR,
+        .rw   = PIOS_I2C_TXN_WRITE,
+        .len  = 1,
+        .buf  = &ms5611_adc_cmd,
+    }
+    ,
+    {
+        .info = "PIOS_MS5611_ADC",
+        .addr = MS5611_I2C_ADDR,
+        .rw   = PIOS_I2C_TXN_READ,
+        .len  = sizeof(ms5611_adc),
+        .buf  = ms5611_adc,
+    }
+};
+static const struct pios_i2c_txn ms5611_conversion_txns[] = {
+    {
+        .info = "PIOS_MS5611_Conversion",
+        .addr = MS5611_I2C_ADDR,
+        .rw   = PIOS_I2C_TXN_WRITE,
+        .len  = 1,
+        .buf  = &ms5611_conversion_cmd,
+    }
+};
+static struct pios_i2c_transaction ms5611_adc_transaction = {
+    .txn_list = ms5611_adc_txns,
+    .num_txns = NELEMENTS(ms5611_adc_txns),
+    .callback = PIOS_MS5611_ADCDone,
+};
+static struct pios_i2c_transaction ms5611_conversion_transaction = {
+    .txn_list = ms5611_conversion_txns,
+    .num_txns = NELEMENTS(ms5611_conversion_txns),
+    .callback = PIOS_MS5611_ConversionStarted,
+};
+
+// a transaction is queued, there is never more than one
+static volatile bool ms5611_busy;
+// the ADC has been read, ms5611_adc_result tells how that went
+static volatile bool ms5611_adc_read;
+static volatile int32_t ms5611_adc_result;
+#endif /* PIOS_I2C_TRANSACTIONS */
+
 // sensor driver interface
 bool PIOS_MS5611_driver_Test(uintptr_t context);
 void PIOS_MS5611_driver_Reset(uintptr_t context);
@@ -139,21 +201,21 @@ void PIOS_MS5611_Init(const struct pios_ms5611_cfg *cfg, int32_t i2c_device)
 /**
  * Start the ADC conversion
  * \param[in] PresOrTemp BMP085_PRES_ADDR or BMP085_TEMP_ADDR
- * \return 0 for success, -1 for failure (conversion completed and not read)
+ * \return 0 for success, -1 for failure (the command was not sent, no conversion is running)
  */
 int32_t PIOS_MS5611_StartADC(ConversionTypeTypeDef Type)
 {
-    /* Start the conversion */
-    if (Type == MS5611_CONVERSION_TYPE_TemperatureConv) {
-        while (PIOS_MS5611_WriteCommand(MS5611_TEMP_ADDR + oversampling) != 0) {
-            continue;
-        }
-    } else if (Type == MS5611_CONVERSION_TYPE_PressureConv) {
-        while (PIOS_MS5611_WriteCommand(MS5611_PRES_ADDR + oversampling) != 0) {
-            continue;
-        }
+    uint8_t command = (Type == MS5611_CONVERSION_TYPE_TemperatureConv) ? MS5611_TEMP_ADDR : MS5611_PRES_ADDR;
+
+    /* Start the conversion, a failed command is retried by the state machine rather than here */
+    if (PIOS_MS5611_WriteCommand(command + oversampling) != 0) {
+        CurrentRead = MS5611_CONVERSION_TYPE_None;
+        return -1;
     }
     lastConversionStart = PIOS_DELAY_GetRaw();
+    if (Type == MS5611_CONVERSION_TYPE_PressureConv) {
+        pressureConversionStart = PIOS_DELAY_GetuS();
+    }
     CurrentRead = Type;
 
     return 0;
@@ -231,15 +293,22 @@ int32_t PIOS_MS5611_ReadADC(void)
     if (conversionDelayUs > PIOS_DELAY_DiffuS(lastConversionStart)) {
         return -1;
     }
-    static int64_t deltaTemp;
 
-    /* Read and store the 16bit result */
-    if (CurrentRead == MS5611_CONVERSION_TYPE_TemperatureConv) {
-        /* Read the temperature conversion */
-        if (PIOS_MS5611_Read(MS5611_ADC_READ, Data, 3) != 0) {
-            return -2;
-        }
+    /* Read and store the 24bit result */
+    if (PIOS_MS5611_Read(MS5611_ADC_READ, Data, 3) != 0) {
+        return -2;
+    }
+    PIOS_MS5611_Compensate(Data);
 
+    return 0;
+}
+
+/**
+ * Compensate the ADC value of the conversion that just finished
+ */
+static void PIOS_MS5611_Compensate(const uint8_t Data[3])
+{
+    if (CurrentRead == MS5611_CONVERSION_TYPE_TemperatureConv) {
         RawTemperature = (Data[0] << 16) | (Data[1] << 8) | Data[2];
         // Difference between actual and reference temperature
         // dT = D2 - TREF = D2 - C5 * 2^8
@@ -254,10 +323,6 @@ int32_t PIOS_MS5611_ReadADC(void)
         int64_t Offset2 = 0;
         int64_t Sens2   = 0;
 
-        /* Read the pressure conversion */
-        if (PIOS_MS5611_Read(MS5611_ADC_READ, Data, 3) != 0) {
-            return -2;
-        }
         // check if temperature is less than 20°C
         if (Temperature < 2000) {
             // Apply compensation
@@ -293,9 +358,78 @@ int32_t PIOS_MS5611_ReadADC(void)
         // P = D1 * SENS - OFF = (D1 * SENS / 2^21 - OFF) / 2^15
         Pressure = (((((int64_t)RawPressure) * Sens) / POW2(21)) - Offset) / POW2(15);
     }
+}
+
+#if defined(PIOS_I2C_TRANSACTIONS)
+static void PIOS_MS5611_ConversionStarted(__attribute__((unused)) struct pios_i2c_transaction *transaction, int32_t result, __attribute__((unused)) bool *woken)
+{
+    if (result != 0) {
+        CurrentRead = MS5611_CONVERSION_TYPE_None;
+    }
+    lastConversionStart = PIOS_DELAY_GetRaw();
+    if (CurrentRead == MS5611_CONVERSION_TYPE_PressureConv) {
+        pressureConversionStart = PIOS_DELAY_GetuS();
+    }
+    ms5611_busy = false;
+}
+
+static void PIOS_MS5611_ADCDone(__attribute__((unused)) struct pios_i2c_transaction *transaction, int32_t result, __attribute__((unused)) bool *woken)
+{
+    ms5611_adc_result = result;
+    ms5611_adc_read   = true;
+    ms5611_busy = false;
+}
+
+/**
+ * Queue the conversion command, see PIOS_MS5611_StartADC()
+ */
+static int32_t PIOS_MS5611_QueueStartADC(ConversionTypeTypeDef Type)
+{
+    uint8_t command = (Type == MS5611_CONVERSION_TYPE_TemperatureConv) ? MS5611_TEMP_ADDR : MS5611_PRES_ADDR;
+
+    ms5611_conversion_cmd = command + oversampling;
+    CurrentRead = Type;
+    ms5611_busy = true;
+    if (PIOS_I2C_SubmitTransaction(i2c_id, &ms5611_conversion_transaction) != 0) {
+        ms5611_busy = false;
+        CurrentRead = MS5611_CONVERSION_TYPE_None;
+        return -1;
+    }
+
     return 0;
 }
 
+/**
+ * Queue the ADC read once the conversion time has elapsed, and compensate its
+ * value on a later call, see PIOS_MS5611_ReadADC()
+ */
+static int32_t PIOS_MS5611_QueueReadADC(void)
+{
+    if (CurrentRead == MS5611_CONVERSION_TYPE_None) {
+        return -2;
+    }
+    if (ms5611_adc_read) {
+        ms5611_adc_read = false;
+        if (ms5611_adc_result != 0) {
+            return -2;
+        }
+        PIOS_MS5611_Compensate(ms5611_adc);
+        return 0;
+    }
+    if (conversionDelayUs > PIOS_DELAY_DiffuS(lastConversionStart)) {
+        return -1;
+    }
+
+    ms5611_busy = true;
+    if (PIOS_I2C_SubmitTransaction(i2c_id, &ms5611_adc_transaction) != 0) {
+        ms5611_busy = false;
+        return -2;
+    }
+
+    return -1;
+}
+#endif /* PIOS_I2C_TRANSACTIONS */
+
 /**
  * Return the most recently computed temperature in kPa
  */
@@ -377,7 +511,9 @@ int32_t PIOS_MS5611_Test()
     int32_t cur_value = 0;
 
     cur_value = Temperature;
-    PIOS_MS5611_StartADC(MS5611_CONVERSION_TYPE_TemperatureConv);
+    if (PIOS_MS5611_StartADC(MS5611_CONVERSION_TYPE_TemperatureConv) != 0) {
+        return -1;
+    }
     PIOS_DELAY_WaitmS(10);
     PIOS_MS5611_ReadADC();
     if (cur_value == Temperature) {
@@ -385,7 +521,9 @@ int32_t PIOS_MS5611_Test()
     }
 
     cur_value = Pressure;
-    PIOS_MS5611_StartADC(MS5611_CONVERSION_TYPE_PressureConv);
+    if (PIOS_MS5611_StartADC(MS5611_CONVERSION_TYPE_PressureConv) != 0) {
+        return -1;
+    }
     PIOS_DELAY_WaitmS(10);
     PIOS_MS5611_ReadADC();
     if (cur_value == Pressure) {
@@ -421,12 +559,36 @@ void PIOS_MS5611_driver_fetch(void *data, __attribute__((unused)) uint8_t size,
     memcpy(data, (void *)&results, sizeof(PIOS_SENSORS_1Axis_SensorsWithTemp));
 }
 
+static int32_t PIOS_MS5611_StartConversion(ConversionTypeTypeDef Type)
+{
+#if defined(PIOS_I2C_TRANSACTIONS)
+    return PIOS_MS5611_QueueStartADC(Type);
+#else
+    return PIOS_MS5611_StartADC(Type);
+#endif
+}
+
+/**
+ * Conversion state machine, run from the sensor loop. Each call either returns
+ * at once while a conversion is running, or reads the finished conversion and
+ * starts the next one. A failed transfer drops the conversion in progress and
+ * the next call starts over with a temperature conversion, nothing is retried
+ * in a loop. With the I2C transaction queue the transfers are only queued here
+ * and a call returns at once while one is on the bus.
+ */
 bool PIOS_MS5611_driver_poll(__attribute__((unused)) uintptr_t context)
 {
     static uint8_t temp_press_interleave_count = 1;
     static MS5611_FSM_State next_state = MS5611_FSM_INIT;
 
+#if defined(PIOS_I2C_TRANSACTIONS)
+    if (ms5611_busy) {
+        return false; // wait for the bus
+    }
+    int32_t conversionResult = PIOS_MS5611_QueueReadADC();
+#else
     int32_t conversionResult = PIOS_MS5611_ReadADC();
+#endif
 
     if (__builtin_expect(conversionResult == -1, 1)) {
         return false; // wait for conversion to complete
@@ -437,28 +599,31 @@ bool PIOS_MS5611_driver_poll(__attribute__((unused)) uintptr_t context)
     switch (next_state) {
     case MS5611_FSM_INIT:
     case MS5611_FSM_TEMPERATURE:
-        PIOS_MS5611_StartADC(MS5611_CONVERSION_TYPE_TemperatureConv);
+        PIOS_MS5611_StartConversion(MS5611_CONVERSION_TYPE_TemperatureConv);
         next_state = MS5611_FSM_PRESSURE;
         return false;
 
     case MS5611_FSM_PRESSURE:
-        PIOS_MS5611_StartADC(MS5611_CONVERSION_TYPE_PressureConv);
+        PIOS_MS5611_StartConversion(MS5611_CONVERSION_TYPE_PressureConv);
         next_state = MS5611_FSM_CALCULATE;
         return false;
 
     case MS5611_FSM_CALCULATE:
+        results.temperature = PIOS_MS5611_GetTemperature();
+        results.sample    = PIOS_MS5611_GetPressure();
+        // the pressure is integrated over the conversion, date it at its middle
+        results.timestamp = pressureConversionStart + conversionDelayUs / 2;
+
         temp_press_interleave_count--;
         if (!temp_press_interleave_count) {
             temp_press_interleave_count = PIOS_MS5611_SLOW_TEMP_RATE;
-            PIOS_MS5611_StartADC(MS5611_CONVERSION_TYPE_TemperatureConv);
+            PIOS_MS5611_StartConversion(MS5611_CONVERSION_TYPE_TemperatureConv);
             next_state = MS5611_FSM_PRESSURE;
         } else {
-            PIOS_MS5611_StartADC(MS5611_CONVERSION_TYPE_PressureConv);
+            PIOS_MS5611_StartConversion(MS5611_CONVERSION_TYPE_PressureConv);
             next_state = MS5611_FSM_CALCULATE;
         }
 
-        results.temperature = PIOS_MS5611_GetTemperature();
-        results.sample = PIOS_MS5611_GetPressure();
         return true;
 
     default:
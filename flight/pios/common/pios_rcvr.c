@@ -113,6 +113,42 @@ int32_t PIOS_RCVR_Read(uint32_t rcvr_id, uint8_t channel)
     return rcvr_dev->driver->read(rcvr_dev->lower_id, channel);
 }
 
+/**
+ * @brief Reads the first input channels of a driver in one go, from the same frame
+ * if the driver supports it
+ * @param[in] rcvr_id driver to read from
+ * @param[out] channels values of the channels 1 to num_channels, or the error codes of PIOS_RCVR_Read
+ * @param[in] num_channels number of channels to read
+ * @returns Number of channels provided by the driver, 0 if it was not initialized
+ */
+uint8_t PIOS_RCVR_ReadAll(uint32_t rcvr_id, int32_t *channels, uint8_t num_channels)
+{
+    if (rcvr_id == 0) {
+        for (uint8_t i = 0; i < num_channels; i++) {
+            channels[i] = PIOS_RCVR_NODRIVER;
+        }
+        return 0;
+    }
+
+    struct pios_rcvr_dev *rcvr_dev = (struct pios_rcvr_dev *)rcvr_id;
+
+    if (!PIOS_RCVR_validate(rcvr_dev)) {
+        /* Undefined RCVR port for this board (see pios_board.c) */
+        PIOS_Assert(0);
+    }
+
+    if (rcvr_dev->driver->read_all) {
+        return rcvr_dev->driver->read_all(rcvr_dev->lower_id, channels, num_channels);
+    }
+
+    PIOS_DEBUG_Assert(rcvr_dev->driver->read);
+
+    for (uint8_t i = 0; i < num_channels; i++) {
+        channels[i] = rcvr_dev->driver->read(rcvr_dev->lower_id, i);
+    }
+    return num_channels;
+}
+
 /**
  * @brief Get a semaphore that signals when a new sample is available.
  * @param[in] rcvr_id driver to read from
@@ -145,6 +181,34 @@ xSemaphoreHandle PIOS_RCVR_GetSemaphore(uint32_t rcvr_id, uint8_t channel)
     return NULL;
 }
 
+/**
+ * @brief Get the time the last frame of a driver was completely received.
+ * The frame drivers give their semaphore at that time, for all channels at once.
+ * @param[in] rcvr_id driver to read from
+ * @param[out] raw time of the frame, in PIOS_DELAY_GetRaw() units
+ * @returns true if the driver timestamps its frames and received one
+ */
+bool PIOS_RCVR_GetFrameTime(uint32_t rcvr_id, uint32_t *raw)
+{
+    if (rcvr_id == 0) {
+        return false;
+    }
+
+    struct pios_rcvr_dev *rcvr_dev = (struct pios_rcvr_dev *)rcvr_id;
+
+    if (!PIOS_RCVR_validate(rcvr_dev)) {
+        /* Undefined RCVR port for this board (see pios_board.c) */
+        PIOS_Assert(0);
+    }
+
+    if (!rcvr_dev->driver->get_frame_time) {
+        return false;
+    }
+
+    *raw = rcvr_dev->driver->get_frame_time(rcvr_dev->lower_id);
+    return *raw != 0;
+}
+
 #endif /* PIOS_INCLUDE_RCVR */
 
 /**
@@ -61,7 +61,7 @@
 #include <pios_rfm22b_priv.h>
 #include <pios_ppm_out.h>
 #include <ecc.h>
-#include <sha1.h>
+#include <hmac_sha1.h>
 
 /* Local Defines */
 #define STACK_SIZE_BYTES                 200
@@ -75,6 +75,24 @@
 #define RFM22B_DEFAULT_MIN_CHANNEL       0
 #define RFM22B_DEFAULT_MAX_CHANNEL       250
 #define RFM22B_PPM_ONLY_DATARATE         RFM22_datarate_9600
+#define RFM22B_PPM_STATS_FRAMES          32
+#define RFM22B_FEC_DEFAULT_PARITY        4
+#define RFM22B_FEC_MAX_INTERLEAVE        4
+#define RFM22B_AUTH_MAC_LEN              4
+
+// Adaptive datarate, the qualities are out of 128 and the periods in frequency hop cycles
+#define RFM22B_RATE_MIN_DATARATE         RFM22_datarate_9600
+#define RFM22B_RATE_UP_QUALITY           124
+#define RFM22B_RATE_DOWN_QUALITY         100
+#define RFM22B_RATE_UP_CYCLES            8
+#define RFM22B_RATE_DOWN_CYCLES          2
+#define RFM22B_RATE_PROPOSE_CYCLES       4
+#define RFM22B_RATE_HOLDOFF_CYCLES       4
+#define RFM22B_RATE_RSSI_HYSTERESIS      6 // dBm
+#define RFM22B_RATE_LOST_TIMEOUT         (1000 / portTICK_RATE_MS) /* ms */
+#define RFM22B_RATE_CTRL_RATE            0x0f
+#define RFM22B_RATE_CTRL_COMMIT          0x80
+#define RFM22B_RATE_CTRL_QUALITY_SHIFT   4
 
 // PPM encoding limits
 #define RFM22B_PPM_MIN                   1
@@ -155,22 +173,21 @@ static const uint8_t HEADER[(TX_PREAMBLE_NIBBLES + 1) / 2 + 2] = {
     PREAMBLE_BYTE, PREAMBLE_BYTE, PREAMBLE_BYTE, PREAMBLE_BYTE, PREAMBLE_BYTE, PREAMBLE_BYTE, SYNC_BYTE_1, SYNC_BYTE_2
 };
 
-static const uint8_t OUT_FF[64] = {
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
-};
-
 /* Local function forwared declarations */
 static void pios_rfm22_task(void *parameters);
 static bool pios_rfm22_readStatus(struct pios_rfm22b_dev *rfm22b_dev);
 static void pios_rfm22_setDatarate(struct pios_rfm22b_dev *rfm22b_dev);
 static void rfm22_rxFailure(struct pios_rfm22b_dev *rfm22b_dev);
+static void rfm22_setRateConfig(struct pios_rfm22b_dev *rfm22b_dev, enum rfm22b_datarate datarate);
+static void rfm22_switchRate(struct pios_rfm22b_dev *rfm22b_dev, enum rfm22b_datarate datarate);
+static bool rfm22_updateRate(struct pios_rfm22b_dev *rfm22b_dev);
+static uint8_t rfm22_rateControl(struct pios_rfm22b_dev *rfm22b_dev);
+static void rfm22_rateControlReceived(struct pios_rfm22b_dev *rfm22b_dev, uint8_t ctrl);
+static uint8_t rfm22_fecLength(struct pios_rfm22b_dev *rfm22b_dev);
+static void rfm22_fecEncode(struct pios_rfm22b_dev *rfm22b_dev, uint8_t *p, uint8_t len);
+static bool rfm22_fecDecode(struct pios_rfm22b_dev *rfm22b_dev, uint8_t *p, uint8_t len, bool *corrected);
+static void rfm22_authSign(struct pios_rfm22b_dev *rfm22b_dev, uint32_t destination_id, const uint8_t *p, uint8_t len, uint8_t *mac);
+static bool rfm22_authCheck(struct pios_rfm22b_dev *rfm22b_dev, const uint8_t *p, uint8_t len);
 static void pios_rfm22_inject_event(struct pios_rfm22b_dev *rfm22b_dev, enum pios_radio_event event, bool inISR);
 static enum pios_radio_event rfm22_init(struct pios_rfm22b_dev *rfm22b_dev);
 static enum pios_radio_event radio_setRxMode(struct pios_rfm22b_dev *rfm22b_dev);
@@ -185,6 +202,8 @@ static enum pios_radio_event rfm22_timeout(struct pios_rfm22b_dev *rfm22b_dev);
 static enum pios_radio_event rfm22_error(struct pios_rfm22b_dev *rfm22b_dev);
 static enum pios_radio_event rfm22_fatal_error(struct pios_rfm22b_dev *rfm22b_dev);
 static void rfm22b_add_rx_status(struct pios_rfm22b_dev *rfm22b_dev, enum pios_rfm22b_rx_packet_status status);
+static void rfm22_updatePPMStats(struct pios_rfm22b_dev *rfm22b_dev);
+static void rfm22_resetPPMStats(struct pios_rfm22b_dev *rfm22b_dev);
 static void rfm22_setNominalCarrierFrequency(struct pios_rfm22b_dev *rfm22b_dev, uint8_t init_chan);
 static bool rfm22_setFreqHopChannel(struct pios_rfm22b_dev *rfm22b_dev, uint8_t channel);
 static void rfm22_updatePairStatus(struct pios_rfm22b_dev *radio_dev);
@@ -203,8 +222,6 @@ static void rfm22_clearLEDs();
 // Utility functions.
 static uint32_t pios_rfm22_time_difference_ms(portTickType start_time, portTickType end_time);
 static struct pios_rfm22b_dev *pios_rfm22_alloc(void);
-static void rfm22_hmac_sha1(const uint8_t *data, size_t len, uint8_t key[SHA1_DIGEST_LENGTH],
-                            uint8_t digest[SHA1_DIGEST_LENGTH]);
 static bool rfm22_gen_channels(uint32_t coordid, enum rfm22b_datarate datarate, uint8_t min,
                                uint8_t max, uint8_t channels[MAX_CHANNELS], uint8_t *clen);
 
@@ -216,6 +233,8 @@ static void rfm22_releaseBus(struct pios_rfm22b_dev *rfm22b_dev);
 static void rfm22_write_claim(struct pios_rfm22b_dev *rfm22b_dev, uint8_t addr, uint8_t data);
 static void rfm22_write(struct pios_rfm22b_dev *rfm22b_dev, uint8_t addr, uint8_t data);
 static uint8_t rfm22_read(struct pios_rfm22b_dev *rfm22b_dev, uint8_t addr);
+static void rfm22_burstWrite(struct pios_rfm22b_dev *rfm22b_dev, uint8_t addr, const uint8_t *data, uint16_t len);
+static bool rfm22_burstRead(struct pios_rfm22b_dev *rfm22b_dev, uint8_t addr, uint8_t *data, uint16_t len);
 
 
 /* The state transition table */
@@ -372,6 +391,9 @@ static const uint8_t packet_time[] = { 80, 40, 25, 15, 13, 10, 8, 6, 5 };
 static const uint8_t packet_time_ppm[] = { 26, 25, 25, 15, 13, 10, 8, 6, 5 };
 static const uint8_t num_channels[] = { 32, 32, 32, 32, 32, 32, 32, 32, 32 };
 
+// The weakest signal each datarate is used at, about 10 dB above the receiver sensitivity, in dBm
+static const int8_t rate_min_rssi[] = { -108, -105, -102, -100, -99, -97, -95, -93, -91 };
+
 static struct pios_rfm22b_dev *g_rfm22b_dev = NULL;
 
 
@@ -431,6 +453,7 @@ int32_t PIOS_RFM22B_Init(uint32_t *rfm22b_id, uint32_t spi_id, uint32_t slave_nu
     rfm22b_dev->stats.tx_seq       = 0;
     rfm22b_dev->stats.rx_seq       = 0;
     rfm22b_dev->stats.tx_failure   = 0;
+    rfm22_resetPPMStats(rfm22b_dev);
 
     // Initialize the channels.
     PIOS_RFM22B_SetChannelConfig(*rfm22b_id, RFM22B_DEFAULT_RX_DATARATE, RFM22B_DEFAULT_MIN_CHANNEL,
@@ -468,6 +491,10 @@ int32_t PIOS_RFM22B_Init(uint32_t *rfm22b_id, uint32_t spi_id, uint32_t slave_nu
 
     // Initialize the ECC library.
     initialize_ecc();
+    rfm22b_dev->fec_parity     = RFM22B_FEC_DEFAULT_PARITY;
+    rfm22b_dev->fec_interleave = 1;
+    set_ecc_nparity(rfm22b_dev->fec_parity);
+    rfm22b_dev->auth_len = 0;
 
     // Set the state to initializing.
     rfm22b_dev->state = RADIO_STATE_UNINITIALIZED;
@@ -600,26 +627,39 @@ void PIOS_RFM22B_SetChannelConfig(uint32_t rfm22b_id, enum rfm22b_datarate datar
     if (ppm_only) {
         rfm22b_dev->one_way_link = true;
         datarate = RFM22B_PPM_ONLY_DATARATE;
-        rfm22b_dev->datarate     = RFM22B_PPM_ONLY_DATARATE;
     } else {
         rfm22b_dev->one_way_link = oneway;
-        rfm22b_dev->datarate     = datarate;
     }
-    rfm22b_dev->packet_time = (ppm_mode ? packet_time_ppm[datarate] : packet_time[datarate]);
-
-    uint8_t num_found = 0;
-    rfm22_gen_channels(rfm22_destinationID(rfm22b_dev), datarate, min_chan, max_chan,
-                       rfm22b_dev->channels, &num_found);
-
-    rfm22b_dev->num_channels = num_found;
+    rfm22b_dev->min_chan      = min_chan;
+    rfm22b_dev->max_chan      = max_chan;
+    rfm22b_dev->adaptive_rate = false;
+    rfm22b_dev->max_datarate  = datarate;
+    rfm22_setRateConfig(rfm22b_dev, datarate);
+}
 
-    // Calculate the maximum packet length from the datarate.
-    float bytes_per_period = (float)data_rate[datarate] * (float)(rfm22b_dev->packet_time - 2) / 9000;
+/**
+ * Lets the coordinator change the datarate with the link conditions, from
+ * the lowest datarate up to the one of PIOS_RFM22B_SetChannelConfig(). The
+ * coordinator proposes a datarate, and both modems switch to it at the start
+ * of a frequency hop cycle once the remote modem has acknowledged it. A lost
+ * link is looked for again at the lowest datarate.
+ *
+ * Both modems need it, and the link must be a two way one without PPM.
+ *
+ * @param[in] rfm22b_id The RFM22B device index.
+ * @param[in] adaptive Should the datarate follow the link conditions?
+ */
+void PIOS_RFM22B_SetAdaptiveRate(uint32_t rfm22b_id, bool adaptive)
+{
+    struct pios_rfm22b_dev *rfm22b_dev = (struct pios_rfm22b_dev *)rfm22b_id;
 
-    rfm22b_dev->max_packet_len = bytes_per_period - TX_PREAMBLE_NIBBLES / 2 - SYNC_BYTES - HEADER_BYTES - LENGTH_BYTES;
-    if (rfm22b_dev->max_packet_len > RFM22B_MAX_PACKET_LEN) {
-        rfm22b_dev->max_packet_len = RFM22B_MAX_PACKET_LEN;
+    if (!PIOS_RFM22B_Validate(rfm22b_dev)) {
+        return;
     }
+    adaptive = adaptive && !rfm22b_dev->one_way_link && !rfm22b_dev->ppm_send_mode && !rfm22b_dev->ppm_recv_mode;
+    rfm22b_dev->adaptive_rate     = adaptive;
+    rfm22b_dev->peer_link_quality = 0;
+    rfm22_setRateConfig(rfm22b_dev, adaptive ? RFM22B_RATE_MIN_DATARATE : rfm22b_dev->max_datarate);
 }
 
 /**
@@ -652,6 +692,59 @@ void PIOS_RFM22B_SetCoordinatorID(uint32_t rfm22b_id, uint32_t coord_id)
     }
 }
 
+/**
+ * Sets the forward error correction of the data packets, which must be the
+ * same on both modems. Each packet is split over interleave Reed-Solomon
+ * codewords, byte i going to codeword i % interleave, so that a burst of
+ * errors is spread over all of them. Each codeword corrects up to half its
+ * parity bytes.
+ *
+ * @param[in] rfm22b_id The RFM22B device index.
+ * @param[in] parity The parity bytes per codeword, at most RS_ECC_NPARITY.
+ * @param[in] interleave The number of codewords per packet.
+ */
+void PIOS_RFM22B_SetFEC(uint32_t rfm22b_id, uint8_t parity, uint8_t interleave)
+{
+    struct pios_rfm22b_dev *rfm22b_dev = (struct pios_rfm22b_dev *)rfm22b_id;
+
+    if (!PIOS_RFM22B_Validate(rfm22b_dev)) {
+        return;
+    }
+    if (parity == 0 || parity > RS_ECC_NPARITY) {
+        parity = RFM22B_FEC_DEFAULT_PARITY;
+    }
+    if (interleave == 0 || interleave > RFM22B_FEC_MAX_INTERLEAVE) {
+        interleave = 1;
+    }
+    rfm22b_dev->fec_parity     = parity;
+    rfm22b_dev->fec_interleave = interleave;
+    set_ecc_nparity(parity);
+}
+
+/**
+ * Sets the key the packets are authenticated with, which must be the same
+ * on both modems. A truncated HMAC-SHA1 of the pair ID and the packet data
+ * is appended to every packet, and received packets without the right one
+ * are dropped as errors. The key pad states are computed here once.
+ *
+ * @param[in] rfm22b_id The RFM22B device index.
+ * @param[in] key The key, or NULL to send unauthenticated packets.
+ * @param[in] keylen The key length in bytes.
+ */
+void PIOS_RFM22B_SetAuthKey(uint32_t rfm22b_id, const uint8_t *key, uint8_t keylen)
+{
+    struct pios_rfm22b_dev *rfm22b_dev = (struct pios_rfm22b_dev *)rfm22b_id;
+
+    if (!PIOS_RFM22B_Validate(rfm22b_dev)) {
+        return;
+    }
+    rfm22b_dev->auth_len = 0;
+    if (key && keylen) {
+        HMACSHA1Init(&rfm22b_dev->auth_ctx, key, keylen);
+        rfm22b_dev->auth_len = RFM22B_AUTH_MAC_LEN;
+    }
+}
+
 /**
  * Returns the device statistics RFM22B device.
  *
@@ -813,12 +906,10 @@ bool PIOS_RFM22B_TransmitPacket(uint32_t rfm22b_id, uint8_t *p, uint8_t len)
 
     RX_LED_OFF;
 
-    // Set the destination address in the transmit header.
+    // Set the destination address in the transmit header, from header 3 (MSB) to header 0.
     uint32_t id = rfm22_destinationID(rfm22b_dev);
-    rfm22_write(rfm22b_dev, RFM22_transmit_header0, id & 0xff);
-    rfm22_write(rfm22b_dev, RFM22_transmit_header1, (id >> 8) & 0xff);
-    rfm22_write(rfm22b_dev, RFM22_transmit_header2, (id >> 16) & 0xff);
-    rfm22_write(rfm22b_dev, RFM22_transmit_header3, (id >> 24) & 0xff);
+    uint8_t header[4] = { (id >> 24) & 0xff, (id >> 16) & 0xff, (id >> 8) & 0xff, id & 0xff };
+    rfm22_burstWrite(rfm22b_dev, RFM22_transmit_header3, header, sizeof(header));
 
     // FIFO mode, GFSK modulation
     uint8_t fd_bit = rfm22_read(rfm22b_dev, RFM22_modulation_mode_control2) & RFM22_mmc2_fd;
@@ -833,13 +924,10 @@ bool PIOS_RFM22B_TransmitPacket(uint32_t rfm22b_id, uint8_t *p, uint8_t len)
 
     // Add some data to the chips TX FIFO before enabling the transmitter
     uint8_t *tx_buffer = rfm22b_dev->tx_packet_handle;
-    rfm22_assertCs(rfm22b_dev);
-    PIOS_SPI_TransferByte(rfm22b_dev->spi_id, RFM22_fifo_access | 0x80);
     int bytes_to_write = (rfm22b_dev->tx_data_wr - rfm22b_dev->tx_data_rd);
     bytes_to_write = (bytes_to_write > FIFO_SIZE) ? FIFO_SIZE : bytes_to_write;
-    PIOS_SPI_TransferBlock(rfm22b_dev->spi_id, &tx_buffer[rfm22b_dev->tx_data_rd], NULL, bytes_to_write, NULL);
+    rfm22_burstWrite(rfm22b_dev, RFM22_fifo_access, &tx_buffer[rfm22b_dev->tx_data_rd], bytes_to_write);
     rfm22b_dev->tx_data_rd += bytes_to_write;
-    rfm22_deassertCs(rfm22b_dev);
 
     // Enable TX interrupts.
     rfm22_write(rfm22b_dev, RFM22_interrupt_enable1, RFM22_ie1_enpksent | RFM22_ie1_entxffaem);
@@ -886,15 +974,12 @@ pios_rfm22b_int_result PIOS_RFM22B_ProcessTx(uint32_t rfm22b_id)
         // Add data to the TX FIFO buffer
         uint8_t *tx_buffer = rfm22b_dev->tx_packet_handle;
         uint16_t max_bytes = FIFO_SIZE - TX_FIFO_LO_WATERMARK - 1;
-        rfm22_claimBus(rfm22b_dev);
-        rfm22_assertCs(rfm22b_dev);
-        PIOS_SPI_TransferByte(rfm22b_dev->spi_id, RFM22_fifo_access | 0x80);
         int bytes_to_write = (rfm22b_dev->tx_data_wr - rfm22b_dev->tx_data_rd);
         bytes_to_write = (bytes_to_write > max_bytes) ? max_bytes : bytes_to_write;
-        PIOS_SPI_TransferBlock(rfm22b_dev->spi_id, &tx_buffer[rfm22b_dev->tx_data_rd], NULL, bytes_to_write, NULL);
-        rfm22b_dev->tx_data_rd += bytes_to_write;
-        rfm22_deassertCs(rfm22b_dev);
+        rfm22_claimBus(rfm22b_dev);
+        rfm22_burstWrite(rfm22b_dev, RFM22_fifo_access, &tx_buffer[rfm22b_dev->tx_data_rd], bytes_to_write);
         rfm22_releaseBus(rfm22b_dev);
+        rfm22b_dev->tx_data_rd += bytes_to_write;
 
         return PIOS_RFM22B_INT_SUCCESS;
     } else if (rfm22b_dev->status_regs.int_status_1.packet_sent_interrupt) {
@@ -940,8 +1025,10 @@ pios_rfm22b_int_result PIOS_RFM22B_ProcessRx(uint32_t rfm22b_id)
         // Claim the SPI bus.
         rfm22_claimBus(rfm22b_dev);
 
-        // read the total length of the packet data
-        uint32_t len = rfm22_read(rfm22b_dev, RFM22_received_packet_length);
+        // The packet header (destination ID) is followed by the total length of the packet data.
+        uint8_t header[5];
+        rfm22_burstRead(rfm22b_dev, RFM22_received_header3, header, sizeof(header));
+        uint32_t len = header[4];
 
         // The received packet is going to be larger than the receive buffer
         if (len > rfm22b_dev->max_packet_len) {
@@ -954,22 +1041,17 @@ pios_rfm22b_int_result PIOS_RFM22B_ProcessRx(uint32_t rfm22b_id)
         if (rfm22b_dev->rx_buffer_wr < len) {
             int32_t bytes_to_read = len - rfm22b_dev->rx_buffer_wr;
             // Fetch the data from the RX FIFO
-            rfm22_assertCs(rfm22b_dev);
-            PIOS_SPI_TransferByte(rfm22b_dev->spi_id, RFM22_fifo_access & 0x7F);
-            rfm22b_dev->rx_buffer_wr += (PIOS_SPI_TransferBlock(rfm22b_dev->spi_id, OUT_FF, (uint8_t *)&rx_buffer[rfm22b_dev->rx_buffer_wr],
-                                                                bytes_to_read, NULL) == 0) ? bytes_to_read : 0;
-            rfm22_deassertCs(rfm22b_dev);
+            if (rfm22_burstRead(rfm22b_dev, RFM22_fifo_access, &rx_buffer[rfm22b_dev->rx_buffer_wr], bytes_to_read)) {
+                rfm22b_dev->rx_buffer_wr += bytes_to_read;
+            }
         }
 
-        // Read the packet header (destination ID)
-        rfm22b_dev->rx_destination_id  = rfm22_read(rfm22b_dev, RFM22_received_header0);
-        rfm22b_dev->rx_destination_id |= (rfm22_read(rfm22b_dev, RFM22_received_header1) << 8);
-        rfm22b_dev->rx_destination_id |= (rfm22_read(rfm22b_dev, RFM22_received_header2) << 16);
-        rfm22b_dev->rx_destination_id |= (rfm22_read(rfm22b_dev, RFM22_received_header3) << 24);
-
         // Release the SPI bus.
         rfm22_releaseBus(rfm22b_dev);
 
+        rfm22b_dev->rx_destination_id = ((uint32_t)header[0] << 24) | ((uint32_t)header[1] << 16) |
+                                        ((uint32_t)header[2] << 8) | header[3];
+
         // Is there a length error?
         if (rfm22b_dev->rx_buffer_wr != len) {
             rfm22_rxFailure(rfm22b_dev);
@@ -1011,11 +1093,9 @@ pios_rfm22b_int_result PIOS_RFM22B_ProcessRx(uint32_t rfm22b_id)
         }
 
         // Fetch the data from the RX FIFO
-        rfm22_assertCs(rfm22b_dev);
-        PIOS_SPI_TransferByte(rfm22b_dev->spi_id, RFM22_fifo_access & 0x7F);
-        rfm22b_dev->rx_buffer_wr += (PIOS_SPI_TransferBlock(rfm22b_dev->spi_id, OUT_FF, (uint8_t *)&rx_buffer[rfm22b_dev->rx_buffer_wr],
-                                                            RX_FIFO_HI_WATERMARK, NULL) == 0) ? RX_FIFO_HI_WATERMARK : 0;
-        rfm22_deassertCs(rfm22b_dev);
+        if (rfm22_burstRead(rfm22b_dev, RFM22_fifo_access, &rx_buffer[rfm22b_dev->rx_buffer_wr], RX_FIFO_HI_WATERMARK)) {
+            rfm22b_dev->rx_buffer_wr += RX_FIFO_HI_WATERMARK;
+        }
 
         // Release the SPI bus.
         rfm22_releaseBus(rfm22b_dev);
@@ -1042,10 +1122,10 @@ pios_rfm22b_int_result PIOS_RFM22B_ProcessRx(uint32_t rfm22b_id)
         rfm22_claimBus(rfm22b_dev);
 
         // read the 10-bit signed afc correction value
-        // bits 9 to 2
-        uint16_t afc_correction = (uint16_t)rfm22_read(rfm22b_dev, RFM22_afc_correction_read) << 8;
-        // bits 1 & 0
-        afc_correction  |= (uint16_t)rfm22_read(rfm22b_dev, RFM22_ook_counter_value1) & 0x00c0;
+        // bits 9 to 2, then bits 1 & 0 in the next register
+        uint8_t afc[2];
+        rfm22_burstRead(rfm22b_dev, RFM22_afc_correction_read, afc, sizeof(afc));
+        uint16_t afc_correction = ((uint16_t)afc[0] << 8) | (afc[1] & 0xc0);
         afc_correction >>= 6;
         // convert the afc value to Hz
         int32_t afc_corr = (int32_t)(rfm22b_dev->frequency_step_size * afc_correction + 0.5f);
@@ -1537,6 +1617,44 @@ static enum pios_radio_event rfm22_init(struct pios_rfm22b_dev *rfm22b_dev)
     return RADIO_EVENT_INITIALIZED;
 }
 
+/**
+ * Set the datarate and the parameters that depend on it, the packet time,
+ * the channel list and the maximum packet length. The radio registers are
+ * set by pios_rfm22_setDatarate().
+ *
+ * @param[in] rfm22b_dev  The device structure pointer.
+ * @param[in] datarate  The air datarate.
+ */
+static void rfm22_setRateConfig(struct pios_rfm22b_dev *rfm22b_dev, enum rfm22b_datarate datarate)
+{
+    bool ppm_mode = rfm22b_dev->ppm_send_mode || rfm22b_dev->ppm_recv_mode;
+
+    rfm22b_dev->datarate       = datarate;
+    rfm22b_dev->stats.datarate = datarate;
+    rfm22b_dev->packet_time    = (ppm_mode ? packet_time_ppm[datarate] : packet_time[datarate]);
+
+    uint8_t num_found = 0;
+    rfm22_gen_channels(rfm22_destinationID(rfm22b_dev), datarate, rfm22b_dev->min_chan, rfm22b_dev->max_chan,
+                       rfm22b_dev->channels, &num_found);
+
+    rfm22b_dev->num_channels = num_found;
+
+    // Calculate the maximum packet length from the datarate.
+    float bytes_per_period = (float)data_rate[datarate] * (float)(rfm22b_dev->packet_time - 2) / 9000;
+
+    rfm22b_dev->max_packet_len = bytes_per_period - TX_PREAMBLE_NIBBLES / 2 - SYNC_BYTES - HEADER_BYTES - LENGTH_BYTES;
+    if (rfm22b_dev->max_packet_len > RFM22B_MAX_PACKET_LEN) {
+        rfm22b_dev->max_packet_len = RFM22B_MAX_PACKET_LEN;
+    }
+
+    // Nothing is proposed at the new datarate yet.
+    rfm22b_dev->rate_proposed  = datarate;
+    rfm22b_dev->rate_commit    = false;
+    rfm22b_dev->rate_announced = false;
+    rfm22b_dev->rate_votes     = 0;
+    rfm22b_dev->rate_cycles    = RFM22B_RATE_HOLDOFF_CYCLES;
+}
+
 /**
  * Set the air datarate for the RFM22B device.
  *
@@ -1697,25 +1815,18 @@ static bool rfm22_setFreqHopChannel(struct pios_rfm22b_dev *rfm22b_dev, uint8_t
  */
 static bool pios_rfm22_readStatus(struct pios_rfm22b_dev *rfm22b_dev)
 {
-    // 1. Read the interrupt statuses with burst read
-    rfm22_claimBus(rfm22b_dev); // Set RC and the semaphore
-    uint8_t write_buf[3] = { RFM22_interrupt_status1 &0x7f, 0xFF, 0xFF };
-    uint8_t read_buf[3];
-    rfm22_assertCs(rfm22b_dev);
-    PIOS_SPI_TransferBlock(rfm22b_dev->spi_id, write_buf, read_buf, sizeof(write_buf), NULL);
-    rfm22_deassertCs(rfm22b_dev);
-    rfm22b_dev->status_regs.int_status_1.raw  = read_buf[1];
-    rfm22b_dev->status_regs.int_status_2.raw  = read_buf[2];
-
-    // Device status
-    rfm22b_dev->status_regs.device_status.raw = rfm22_read(rfm22b_dev, RFM22_device_status);
-
-    // EzMAC status
-    rfm22b_dev->status_regs.ezmac_status.raw  = rfm22_read(rfm22b_dev, RFM22_ezmac_status);
+    // The device status and the interrupt statuses follow each other, read them in one burst.
+    // Reading the interrupt statuses clears them. The EzMAC status is not used.
+    uint8_t status[3];
 
-    // Release the bus
+    rfm22_claimBus(rfm22b_dev);
+    rfm22_burstRead(rfm22b_dev, RFM22_device_status, status, sizeof(status));
     rfm22_releaseBus(rfm22b_dev);
 
+    rfm22b_dev->status_regs.device_status.raw = status[0];
+    rfm22b_dev->status_regs.int_status_1.raw  = status[1];
+    rfm22b_dev->status_regs.int_status_2.raw  = status[2];
+
     // the RF module has gone and done a reset - we need to re-initialize the rf module
     if (rfm22b_dev->status_regs.int_status_2.poweron_reset) {
         return false;
@@ -1739,6 +1850,140 @@ static void rfm22_rxFailure(struct pios_rfm22b_dev *rfm22b_dev)
 }
 
 
+/*****************************************************************************
+* Forward error correction.
+*****************************************************************************/
+
+/**
+ * The number of parity bytes added to a data packet.
+ *
+ * @param[in] rfm22b_dev The device structure
+ * @return The parity bytes of all codewords.
+ */
+static uint8_t rfm22_fecLength(struct pios_rfm22b_dev *rfm22b_dev)
+{
+    return rfm22b_dev->fec_parity * rfm22b_dev->fec_interleave;
+}
+
+/**
+ * Append the parity bytes of the codewords to a packet, interleaved as the
+ * data: parity byte j of codeword k goes to len + j * interleave + k.
+ *
+ * @param[in] rfm22b_dev The device structure
+ * @param[in,out] p The packet, with room for the parity bytes after the data
+ * @param[in] len The data length
+ */
+static void rfm22_fecEncode(struct pios_rfm22b_dev *rfm22b_dev, uint8_t *p, uint8_t len)
+{
+    uint8_t interleave = rfm22b_dev->fec_interleave;
+    uint8_t parity     = rfm22b_dev->fec_parity;
+    uint8_t *codeword  = rfm22b_dev->fec_codeword;
+
+    for (uint8_t k = 0; k < interleave; ++k) {
+        uint8_t n = 0;
+        for (uint8_t i = k; i < len; i += interleave) {
+            codeword[n++] = p[i];
+        }
+        encode_data((unsigned char *)codeword, n, (unsigned char *)codeword);
+        for (uint8_t j = 0; j < parity; ++j) {
+            p[len + j * interleave + k] = codeword[n + j];
+        }
+    }
+}
+
+/**
+ * Check the codewords of a packet, and correct the data if possible.
+ *
+ * @param[in] rfm22b_dev The device structure
+ * @param[in,out] p The packet
+ * @param[in] len The data length, the parity bytes follow
+ * @param[out] corrected Set if errors were corrected
+ * @return True if the data are good or were corrected
+ */
+static bool rfm22_fecDecode(struct pios_rfm22b_dev *rfm22b_dev, uint8_t *p, uint8_t len, bool *corrected)
+{
+    uint8_t interleave = rfm22b_dev->fec_interleave;
+    uint8_t parity     = rfm22b_dev->fec_parity;
+    uint8_t *codeword  = rfm22b_dev->fec_codeword;
+
+    *corrected = false;
+    for (uint8_t k = 0; k < interleave; ++k) {
+        uint8_t n = 0;
+        for (uint8_t i = k; i < len; i += interleave) {
+            codeword[n++] = p[i];
+        }
+        for (uint8_t j = 0; j < parity; ++j) {
+            codeword[n + j] = p[len + j * interleave + k];
+        }
+
+        decode_data((unsigned char *)codeword, n + parity);
+        if (check_syndrome() == 0) {
+            continue;
+        }
+
+        // Try to correct it, a wrong correction is caught by checking again.
+        if (correct_errors_erasures((unsigned char *)codeword, n + parity, 0, 0) == 0) {
+            return false;
+        }
+        decode_data((unsigned char *)codeword, n + parity);
+        if (check_syndrome() != 0) {
+            return false;
+        }
+        n = 0;
+        for (uint8_t i = k; i < len; i += interleave) {
+            p[i] = codeword[n++];
+        }
+        *corrected = true;
+    }
+
+    return true;
+}
+
+/*****************************************************************************
+* Packet authentication.
+*****************************************************************************/
+
+/**
+ * Compute the MAC of a packet.
+ *
+ * @param[in] rfm22b_dev The device structure
+ * @param[in] destination_id The pair the packet is sent in, from the packet header
+ * @param[in] p The packet data
+ * @param[in] len The data length
+ * @param[out] mac The auth_len bytes of the MAC
+ */
+static void rfm22_authSign(struct pios_rfm22b_dev *rfm22b_dev, uint32_t destination_id, const uint8_t *p, uint8_t len, uint8_t *mac)
+{
+    SHA1_CTX sha;
+
+    HMACSHA1Start(&rfm22b_dev->auth_ctx, &sha);
+    SHA1Update(&sha, (const uint8_t *)&destination_id, sizeof(destination_id));
+    SHA1Update(&sha, p, len);
+    HMACSHA1Finish(&rfm22b_dev->auth_ctx, &sha, mac, rfm22b_dev->auth_len);
+}
+
+/**
+ * Check the MAC of a received packet.
+ *
+ * @param[in] rfm22b_dev The device structure
+ * @param[in] p The packet data
+ * @param[in] len The data length, the MAC follows
+ * @return True if the MAC is right
+ */
+static bool rfm22_authCheck(struct pios_rfm22b_dev *rfm22b_dev, const uint8_t *p, uint8_t len)
+{
+    uint8_t mac[RFM22B_AUTH_MAC_LEN];
+    uint8_t diff = 0;
+
+    rfm22_authSign(rfm22b_dev, rfm22b_dev->rx_destination_id, p, len, mac);
+    // Compare all the bytes, not to tell how many were right
+    for (uint8_t i = 0; i < rfm22b_dev->auth_len; ++i) {
+        diff |= mac[i] ^ p[len + i];
+    }
+    return diff == 0;
+}
+
+
 /*****************************************************************************
 * Radio Transmit and Receive functions.
 *****************************************************************************/
@@ -1753,7 +1998,7 @@ static enum pios_radio_event radio_txStart(struct pios_rfm22b_dev *radio_dev)
 {
     uint8_t *p  = radio_dev->tx_packet;
     uint8_t len = 0;
-    uint8_t max_data_len = radio_dev->max_packet_len - (radio_dev->ppm_only_mode ? 0 : RS_ECC_NPARITY);
+    uint8_t max_data_len = radio_dev->max_packet_len - (radio_dev->ppm_only_mode ? 0 : rfm22_fecLength(radio_dev)) - radio_dev->auth_len;
 
     // Don't send if it's not our turn, or if we're receiving a packet.
     if (!rfm22_timeToSend(radio_dev) || !PIOS_RFM22B_InRxWait((uint32_t)radio_dev)) {
@@ -1811,6 +2056,13 @@ static enum pios_radio_event radio_txStart(struct pios_rfm22b_dev *radio_dev)
         }
     }
 
+    // The datarate negotiation goes first, there is no PPM data with it.
+    uint8_t header_len = len;
+    if (radio_dev->adaptive_rate) {
+        p[len++]   = rfm22_rateControl(radio_dev);
+        header_len = len;
+    }
+
     // Append data from the com interface if applicable.
     if (!radio_dev->ppm_only_mode && radio_dev->tx_out_cb) {
         // Try to get some data to send
@@ -1818,20 +2070,32 @@ static enum pios_radio_event radio_txStart(struct pios_rfm22b_dev *radio_dev)
         len += (radio_dev->tx_out_cb)(radio_dev->tx_out_context, p + len, max_data_len - len, NULL, &need_yield);
     }
 
-    // Always send a packet if this modem is a coordinator.
-    if ((len == 0) && !rfm22_isCoordinator(radio_dev)) {
-        return RADIO_EVENT_RX_MODE;
+    // Always send a packet if this modem is a coordinator. The remote modem
+    // acknowledges the datarate proposals, and tells its link quality once
+    // per frequency hop cycle.
+    if ((len == header_len) && !rfm22_isCoordinator(radio_dev)) {
+        bool rate_report = radio_dev->adaptive_rate &&
+                           ((radio_dev->rate_proposed != radio_dev->datarate) || (radio_dev->channel_index == 0));
+        if ((len == 0) || !rate_report) {
+            return RADIO_EVENT_RX_MODE;
+        }
     }
 
     // Increment the packet sequence number.
     radio_dev->stats.tx_seq++;
 
+    // Authenticate the data, and the pair they are sent in.
+    if (radio_dev->auth_len) {
+        rfm22_authSign(radio_dev, rfm22_destinationID(radio_dev), p, len, p + len);
+        len += radio_dev->auth_len;
+    }
+
     // Add the error correcting code.
     if (!radio_dev->ppm_only_mode) {
         if (len != 0) {
-            encode_data((unsigned char *)p, len, (unsigned char *)p);
+            rfm22_fecEncode(radio_dev, p, len);
         }
-        len += RS_ECC_NPARITY;
+        len += rfm22_fecLength(radio_dev);
     }
 
     // Transmit the packet.
@@ -1903,21 +2167,43 @@ static enum pios_radio_event radio_receivePacket(struct pios_rfm22b_dev *radio_d
 
     // We don't rsencode ppm only packets.
     if (!radio_dev->ppm_only_mode) {
-        data_len -= RS_ECC_NPARITY;
+        if (rx_len < rfm22_fecLength(radio_dev)) {
+            good_packet = false;
+            data_len    = 0;
+        } else {
+            data_len -= rfm22_fecLength(radio_dev);
+        }
 
         // Attempt to correct any errors in the packet.
         if (data_len > 0) {
-            decode_data((unsigned char *)p, rx_len);
-            good_packet = check_syndrome() == 0;
-
-            // We have an error.  Try to correct it.
-            if (!good_packet && (correct_errors_erasures((unsigned char *)p, rx_len, 0, 0) != 0)) {
-                // We corrected it
-                corrected_packet = true;
+            good_packet = rfm22_fecDecode(radio_dev, p, data_len, &corrected_packet);
+            if (corrected_packet) {
+                // counted as corrected, not as good
+                good_packet = false;
             }
         }
     }
 
+    // Check and strip the MAC, a forged packet is dropped like a damaged one.
+    if ((good_packet || corrected_packet) && radio_dev->auth_len) {
+        if ((data_len < radio_dev->auth_len) || !rfm22_authCheck(radio_dev, p, data_len - radio_dev->auth_len)) {
+            good_packet = false;
+            corrected_packet = false;
+            data_len    = 0;
+        } else {
+            data_len -= radio_dev->auth_len;
+        }
+    }
+
+    // The datarate negotiation of our pair.
+    if ((good_packet || corrected_packet) && radio_dev->adaptive_rate && (data_len > 0)) {
+        if (radio_dev->rx_destination_id == rfm22_destinationID(radio_dev)) {
+            rfm22_rateControlReceived(radio_dev, p[0]);
+        }
+        ++p;
+        --data_len;
+    }
+
     // Should we pull PPM data off of the head of the packet?
     if ((good_packet || corrected_packet) && radio_dev->ppm_recv_mode) {
         uint8_t ppm_len = RFM22B_PPM_NUM_CHANNELS + (radio_dev->ppm_only_mode ? 2 : 1);
@@ -1958,6 +2244,7 @@ static enum pios_radio_event radio_receivePacket(struct pios_rfm22b_dev *radio_d
             if (radio_dev->ppm_callback) {
                 radio_dev->ppm_callback(radio_dev->ppm);
             }
+            rfm22_updatePPMStats(radio_dev);
         }
     }
 
@@ -2122,6 +2409,57 @@ static void rfm22_calculateLinkQuality(struct pios_rfm22b_dev *rfm22b_dev)
     rfm22b_dev->stats.link_quality = 64 + rfm22b_dev->stats.rx_good - rfm22b_dev->stats.rx_error - rfm22b_dev->stats.rx_failure;
 }
 
+/**
+ * Account for a PPM frame that was just output. The interval between the
+ * frames bounds the latency of the RC channels, the latency is counted from
+ * the sync word of the frame, so it includes the air time of the packet.
+ * The averages and the maximum are published every RFM22B_PPM_STATS_FRAMES.
+ *
+ * @param[in] rfm22b_dev  The device structure
+ */
+static void rfm22_updatePPMStats(struct pios_rfm22b_dev *rfm22b_dev)
+{
+    portTickType now = xTaskGetTickCount();
+
+    if (rfm22b_dev->ppm_last_ticks) {
+        uint32_t interval = pios_rfm22_time_difference_ms(rfm22b_dev->ppm_last_ticks, now);
+        rfm22b_dev->ppm_interval_sum += interval;
+        if (interval > rfm22b_dev->ppm_interval_max) {
+            rfm22b_dev->ppm_interval_max = interval;
+        }
+        if (rfm22b_dev->packet_start_ticks) {
+            rfm22b_dev->ppm_latency_sum += pios_rfm22_time_difference_ms(rfm22b_dev->packet_start_ticks, now);
+        }
+        if (++rfm22b_dev->ppm_frames == RFM22B_PPM_STATS_FRAMES) {
+            rfm22b_dev->stats.ppm_interval     = rfm22b_dev->ppm_interval_sum / RFM22B_PPM_STATS_FRAMES;
+            rfm22b_dev->stats.ppm_interval_max = (rfm22b_dev->ppm_interval_max > 0xffff) ? 0xffff : rfm22b_dev->ppm_interval_max;
+            rfm22b_dev->stats.ppm_latency      = rfm22b_dev->ppm_latency_sum / RFM22B_PPM_STATS_FRAMES;
+            rfm22b_dev->ppm_frames       = 0;
+            rfm22b_dev->ppm_interval_sum = 0;
+            rfm22b_dev->ppm_interval_max = 0;
+            rfm22b_dev->ppm_latency_sum  = 0;
+        }
+    }
+    rfm22b_dev->ppm_last_ticks = now ? now : 1;
+}
+
+/**
+ * Forget the PPM frame statistics when the link is lost.
+ *
+ * @param[in] rfm22b_dev  The device structure
+ */
+static void rfm22_resetPPMStats(struct pios_rfm22b_dev *rfm22b_dev)
+{
+    rfm22b_dev->ppm_last_ticks   = 0;
+    rfm22b_dev->ppm_frames       = 0;
+    rfm22b_dev->ppm_interval_sum = 0;
+    rfm22b_dev->ppm_interval_max = 0;
+    rfm22b_dev->ppm_latency_sum  = 0;
+    rfm22b_dev->stats.ppm_interval     = 0;
+    rfm22b_dev->stats.ppm_interval_max = 0;
+    rfm22b_dev->stats.ppm_latency      = 0;
+}
+
 /**
  * Add a status value to the RX packet status array.
  *
@@ -2261,6 +2599,7 @@ static uint8_t rfm22_calcChannel(struct pios_rfm22b_dev *rfm22b_dev, uint8_t ind
                 for (uint8_t i = 0; i < RFM22B_PPM_NUM_CHANNELS; ++i) {
                     rfm22b_dev->ppm[i] = PIOS_RCVR_INVALID;
                 }
+                rfm22_resetPPMStats(rfm22b_dev);
             }
 
             // Stay on first channel.
@@ -2297,9 +2636,167 @@ static bool rfm22_changeChannel(struct pios_rfm22b_dev *rfm22b_dev)
 {
     // A disconnected non-coordinator modem should sit on the sync channel until connected.
     if (!rfm22_isCoordinator(rfm22b_dev) && !rfm22_isConnected(rfm22b_dev)) {
-        return rfm22_setFreqHopChannel(rfm22b_dev, rfm22_calcChannel(rfm22b_dev, 0));
+        // The coordinator goes back to the lowest datarate too.
+        bool rate_changed = false;
+        if (rfm22b_dev->adaptive_rate && (rfm22b_dev->datarate != RFM22B_RATE_MIN_DATARATE)) {
+            rfm22_switchRate(rfm22b_dev, RFM22B_RATE_MIN_DATARATE);
+            rate_changed = true;
+        }
+        return rfm22_setFreqHopChannel(rfm22b_dev, rfm22_calcChannel(rfm22b_dev, 0)) || rate_changed;
+    }
+
+    uint8_t prev_index = rfm22b_dev->channel_index;
+    uint8_t channel    = rfm22_calcChannelFromClock(rfm22b_dev);
+
+    // The datarate only changes at the start of a frequency hop cycle.
+    if ((rfm22b_dev->channel_index == 0) && (prev_index != 0) && rfm22_updateRate(rfm22b_dev)) {
+        rfm22_setFreqHopChannel(rfm22b_dev, rfm22_calcChannelFromClock(rfm22b_dev));
+        return true;
+    }
+    return rfm22_setFreqHopChannel(rfm22b_dev, channel);
+}
+
+
+/*****************************************************************************
+* Adaptive Datarate Functions
+*****************************************************************************/
+
+/**
+ * Switch both the datarate parameters and the radio to a new datarate.
+ *
+ * @param[in] rfm22b_dev  The device structure
+ * @param[in] datarate  The new datarate
+ */
+static void rfm22_switchRate(struct pios_rfm22b_dev *rfm22b_dev, enum rfm22b_datarate datarate)
+{
+    rfm22_setRateConfig(rfm22b_dev, datarate);
+    pios_rfm22_setDatarate(rfm22b_dev);
+}
+
+/**
+ * Run the datarate negotiation at the start of a frequency hop cycle.
+ * The coordinator votes for a faster or slower datarate and proposes it,
+ * then switches the cycle after the remote modem acknowledged it.
+ *
+ * @param[in] rfm22b_dev  The device structure
+ * @return True if the datarate was changed
+ */
+static bool rfm22_updateRate(struct pios_rfm22b_dev *rfm22b_dev)
+{
+    if (!rfm22b_dev->adaptive_rate) {
+        return false;
+    }
+
+    // The remote modem only follows the commits of the coordinator.
+    if (!rfm22_isCoordinator(rfm22b_dev)) {
+        // Reported in our next packets.
+        rfm22_calculateLinkQuality(rfm22b_dev);
+        if (rfm22b_dev->rate_commit && (rfm22b_dev->rate_proposed != rfm22b_dev->datarate)) {
+            rfm22_switchRate(rfm22b_dev, rfm22b_dev->rate_proposed);
+            return true;
+        }
+        return false;
+    }
+
+    // The remote modem went back to the lowest datarate to find us again.
+    if ((rfm22b_dev->datarate != RFM22B_RATE_MIN_DATARATE) &&
+        (pios_rfm22_time_difference_ms(rfm22b_dev->last_contact, xTaskGetTickCount()) >= RFM22B_RATE_LOST_TIMEOUT)) {
+        rfm22_switchRate(rfm22b_dev, RFM22B_RATE_MIN_DATARATE);
+        return true;
+    }
+
+    // Switch once the remote modem has seen the commit at least once.
+    if (rfm22b_dev->rate_commit) {
+        if (rfm22b_dev->rate_announced) {
+            rfm22_switchRate(rfm22b_dev, rfm22b_dev->rate_proposed);
+            return true;
+        }
+        return false;
+    }
+
+    // Wait for the statistics of the new datarate, or for the acknowledge.
+    if (rfm22b_dev->rate_cycles > 0) {
+        if ((--rfm22b_dev->rate_cycles == 0) && (rfm22b_dev->rate_proposed != rfm22b_dev->datarate)) {
+            // Not acknowledged, try again later.
+            rfm22b_dev->rate_proposed = rfm22b_dev->datarate;
+        }
+        return false;
+    }
+
+    // The worst of both directions.
+    rfm22_calculateLinkQuality(rfm22b_dev);
+    uint8_t quality = rfm22b_dev->stats.link_quality;
+    if (rfm22b_dev->peer_link_quality < quality) {
+        quality = rfm22b_dev->peer_link_quality;
+    }
+    enum rfm22b_datarate datarate = rfm22b_dev->datarate;
+    int8_t rssi = rfm22b_dev->rssi_dBm;
+
+    if (((quality < RFM22B_RATE_DOWN_QUALITY) || (rssi < rate_min_rssi[datarate])) &&
+        (datarate > RFM22B_RATE_MIN_DATARATE)) {
+        rfm22b_dev->rate_votes = (rfm22b_dev->rate_votes > 0) ? -1 : rfm22b_dev->rate_votes - 1;
+    } else if ((quality >= RFM22B_RATE_UP_QUALITY) && (datarate < rfm22b_dev->max_datarate) &&
+               (rssi >= rate_min_rssi[datarate + 1] + RFM22B_RATE_RSSI_HYSTERESIS)) {
+        rfm22b_dev->rate_votes = (rfm22b_dev->rate_votes < 0) ? 1 : rfm22b_dev->rate_votes + 1;
     } else {
-        return rfm22_setFreqHopChannel(rfm22b_dev, rfm22_calcChannelFromClock(rfm22b_dev));
+        rfm22b_dev->rate_votes = 0;
+    }
+
+    if (rfm22b_dev->rate_votes <= -RFM22B_RATE_DOWN_CYCLES) {
+        rfm22b_dev->rate_proposed = datarate - 1;
+    } else if (rfm22b_dev->rate_votes >= RFM22B_RATE_UP_CYCLES) {
+        rfm22b_dev->rate_proposed = datarate + 1;
+    } else {
+        return false;
+    }
+    rfm22b_dev->rate_votes  = 0;
+    rfm22b_dev->rate_cycles = RFM22B_RATE_PROPOSE_CYCLES;
+    return false;
+}
+
+/**
+ * The datarate negotiation byte of a packet. The coordinator sends the
+ * datarate it proposes and whether it switches to it at the next cycle, the
+ * remote modem the last proposed datarate and its link quality.
+ *
+ * @param[in] rfm22b_dev  The device structure
+ * @return The negotiation byte
+ */
+static uint8_t rfm22_rateControl(struct pios_rfm22b_dev *rfm22b_dev)
+{
+    uint8_t ctrl = rfm22b_dev->rate_proposed & RFM22B_RATE_CTRL_RATE;
+
+    if (rfm22_isCoordinator(rfm22b_dev)) {
+        if (rfm22b_dev->rate_commit) {
+            ctrl |= RFM22B_RATE_CTRL_COMMIT;
+            rfm22b_dev->rate_announced = true;
+        }
+    } else {
+        uint8_t quality = rfm22b_dev->stats.link_quality >> 3;
+        ctrl |= ((quality > 0x0f) ? 0x0f : quality) << RFM22B_RATE_CTRL_QUALITY_SHIFT;
+    }
+    return ctrl;
+}
+
+/**
+ * Process the datarate negotiation byte of a packet from our pair.
+ *
+ * @param[in] rfm22b_dev  The device structure
+ * @param[in] ctrl  The negotiation byte
+ */
+static void rfm22_rateControlReceived(struct pios_rfm22b_dev *rfm22b_dev, uint8_t ctrl)
+{
+    uint8_t datarate = ctrl & RFM22B_RATE_CTRL_RATE;
+
+    if (rfm22_isCoordinator(rfm22b_dev)) {
+        rfm22b_dev->peer_link_quality = (ctrl >> RFM22B_RATE_CTRL_QUALITY_SHIFT) << 3;
+        // Acknowledged, switch at the next cycle.
+        if ((rfm22b_dev->rate_proposed != rfm22b_dev->datarate) && (datarate == rfm22b_dev->rate_proposed)) {
+            rfm22b_dev->rate_commit = true;
+        }
+    } else if (datarate <= rfm22b_dev->max_datarate) {
+        rfm22b_dev->rate_proposed = datarate;
+        rfm22b_dev->rate_commit   = (ctrl & RFM22B_RATE_CTRL_COMMIT) != 0;
     }
 }
 
@@ -2572,38 +3069,41 @@ static uint8_t rfm22_read(struct pios_rfm22b_dev *rfm22b_dev, uint8_t addr)
     return in[1];
 }
 
-
-static void rfm22_hmac_sha1(const uint8_t *data, size_t len,
-                            uint8_t key[SHA1_DIGEST_LENGTH],
-                            uint8_t digest[SHA1_DIGEST_LENGTH])
+/**
+ * Write consecutive registers, or the FIFO, in one burst without claiming the bus
+ *
+ * @param[in] rfm22b_dev  The RFM22B device structure pointer.
+ * @param[in] addr The first address to write to
+ * @param[in] data The data to write
+ * @param[in] len The number of bytes to write
+ */
+static void rfm22_burstWrite(struct pios_rfm22b_dev *rfm22b_dev, uint8_t addr, const uint8_t *data, uint16_t len)
 {
-    uint8_t ipad[64] = { 0 };
-    uint8_t opad[64] = { 0 };
-    static SHA1_CTX *ctx;
-
-    ctx = pios_malloc(sizeof(SHA1_CTX));
-
-    memcpy(ipad, key, SHA1_DIGEST_LENGTH);
-    memcpy(opad, key, SHA1_DIGEST_LENGTH);
-
-    for (int i = 0; i < 64; i++) {
-        ipad[i] ^= 0x36;
-        opad[i] ^= 0x5c;
-    }
-
-    SHA1Init(ctx);
-    SHA1Update(ctx, ipad, sizeof(ipad));
-    SHA1Update(ctx, data, len);
-    SHA1Final(digest, ctx);
-
-    SHA1Init(ctx);
-    SHA1Update(ctx, opad, sizeof(opad));
-    SHA1Update(ctx, digest, SHA1_DIGEST_LENGTH);
-    SHA1Final(digest, ctx);
+    rfm22_assertCs(rfm22b_dev);
+    PIOS_SPI_TransferByte(rfm22b_dev->spi_id, addr | 0x80);
+    PIOS_SPI_TransferBlock(rfm22b_dev->spi_id, data, NULL, len, NULL);
+    rfm22_deassertCs(rfm22b_dev);
+}
 
-    pios_free(ctx);
+/**
+ * Read consecutive registers, or the FIFO, in one burst without claiming the bus
+ *
+ * @param[in] rfm22b_dev  The RFM22B device structure pointer.
+ * @param[in] addr The first address to read from
+ * @param[out] data The bytes read
+ * @param[in] len The number of bytes to read
+ * @return True if the transfer succeeded
+ */
+static bool rfm22_burstRead(struct pios_rfm22b_dev *rfm22b_dev, uint8_t addr, uint8_t *data, uint16_t len)
+{
+    rfm22_assertCs(rfm22b_dev);
+    PIOS_SPI_TransferByte(rfm22b_dev->spi_id, addr & 0x7F);
+    bool ok = PIOS_SPI_TransferBlock(rfm22b_dev->spi_id, NULL, data, len, NULL) == 0;
+    rfm22_deassertCs(rfm22b_dev);
+    return ok;
 }
 
+
 static bool rfm22_gen_channels(uint32_t coordid, enum rfm22b_datarate rate, uint8_t min,
                                uint8_t max, uint8_t channels[MAX_CHANNELS], uint8_t *clen)
 {
@@ -2613,10 +3113,14 @@ static bool rfm22_gen_channels(uint32_t coordid, enum rfm22b_datarate rate, uint
     uint8_t key[SHA1_DIGEST_LENGTH] = { 0 };
     uint8_t digest[SHA1_DIGEST_LENGTH];
     uint8_t *all_channels;
+    HMAC_SHA1_CTX *ctx;
 
     all_channels = pios_malloc(RFM22B_NUM_CHANNELS);
+    ctx = pios_malloc(sizeof(HMAC_SHA1_CTX));
 
+    // The sequence is keyed by the pair, the pads are hashed once for all of it.
     memcpy(key, &coordid, sizeof(coordid));
+    HMACSHA1Init(ctx, key, sizeof(key));
 
     for (int i = 0; i < chan_range; i++) {
         all_channels[i] = min / channel_spacing[rate] + i;
@@ -2629,7 +3133,7 @@ static bool rfm22_gen_channels(uint32_t coordid, enum rfm22b_datarate rate, uint
         uint8_t tmp;
 
         if (j == SHA1_DIGEST_LENGTH) {
-            rfm22_hmac_sha1((uint8_t *)&data, sizeof(data), key, digest);
+            HMACSHA1(ctx, (uint8_t *)&data, sizeof(data), digest, sizeof(digest));
             j = 0;
             data++;
         }
@@ -2647,6 +3151,7 @@ static bool rfm22_gen_channels(uint32_t coordid, enum rfm22b_datarate rate, uint
 
     *clen = cpos & 0xfe;
 
+    pios_free(ctx);
     pios_free(all_channels);
 
     return *clen > 0;
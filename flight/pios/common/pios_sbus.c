@@ -36,17 +36,27 @@
 
 /* Forward Declarations */
 static int32_t PIOS_SBus_Get(uint32_t rcvr_id, uint8_t channel);
+static uint8_t PIOS_SBus_Get_All(uint32_t rcvr_id, int32_t *channels, uint8_t num_channels);
 static uint16_t PIOS_SBus_RxInCallback(uint32_t context,
                                        uint8_t *buf,
                                        uint16_t buf_len,
                                        uint16_t *headroom,
                                        bool *need_yield);
 static void PIOS_SBus_Supervisor(uint32_t sbus_id);
+#if defined(PIOS_INCLUDE_FREERTOS)
+static xSemaphoreHandle PIOS_SBus_Get_Semaphore(uint32_t rcvr_id, uint8_t channel);
+#endif
+static uint32_t PIOS_SBus_Get_Frame_Time(uint32_t rcvr_id);
 
 
 /* Local Variables */
 const struct pios_rcvr_driver pios_sbus_rcvr_driver = {
-    .read = PIOS_SBus_Get,
+    .read           = PIOS_SBus_Get,
+    .read_all       = PIOS_SBus_Get_All,
+#if defined(PIOS_INCLUDE_FREERTOS)
+    .get_semaphore  = PIOS_SBus_Get_Semaphore,
+#endif
+    .get_frame_time = PIOS_SBus_Get_Frame_Time,
 };
 
 enum pios_sbus_dev_magic {
@@ -60,12 +70,16 @@ struct pios_sbus_state {
     uint8_t  failsafe_timer;
     uint8_t  frame_found;
     uint8_t  byte_count;
+    volatile uint32_t frame_time;
 };
 
 struct pios_sbus_dev {
     enum pios_sbus_dev_magic   magic;
     const struct pios_sbus_cfg *cfg;
     struct pios_sbus_state     state;
+#if defined(PIOS_INCLUDE_FREERTOS)
+    xSemaphoreHandle new_frame_semaphore;
+#endif
 };
 
 /* Allocate S.Bus device descriptor */
@@ -79,6 +93,7 @@ static struct pios_sbus_dev *PIOS_SBus_Alloc(void)
         return NULL;
     }
 
+    sbus_dev->new_frame_semaphore = 0;
     sbus_dev->magic = PIOS_SBUS_DEV_MAGIC;
     return sbus_dev;
 }
@@ -120,6 +135,7 @@ static void PIOS_SBus_ResetState(struct pios_sbus_state *state)
     state->receive_timer  = 0;
     state->failsafe_timer = 0;
     state->frame_found    = 0;
+    state->frame_time     = 0;
     PIOS_SBus_ResetChannels(state);
 }
 
@@ -188,6 +204,70 @@ static int32_t PIOS_SBus_Get(uint32_t rcvr_id, uint8_t channel)
     return sbus_dev->state.channel_data[channel];
 }
 
+/**
+ * Get the values of the first input channels of the last frame
+ * \param[out] channels values of the channels, PIOS_RCVR_INVALID past the inputs
+ * \param[in] num_channels number of channels to read (zero based)
+ * \output number of channels available
+ */
+static uint8_t PIOS_SBus_Get_All(uint32_t rcvr_id, int32_t *channels, uint8_t num_channels)
+{
+    struct pios_sbus_dev *sbus_dev = (struct pios_sbus_dev *)rcvr_id;
+
+    if (!PIOS_SBus_Validate(sbus_dev)) {
+        return 0;
+    }
+
+    uint8_t available = (num_channels < PIOS_SBUS_NUM_INPUTS) ? num_channels : PIOS_SBUS_NUM_INPUTS;
+    uint32_t frame_time;
+
+    /* copy again if a frame was decoded in the meantime, so that all channels come from the same one */
+    do {
+        frame_time = sbus_dev->state.frame_time;
+        for (uint8_t i = 0; i < available; i++) {
+            channels[i] = sbus_dev->state.channel_data[i];
+        }
+    } while (frame_time != sbus_dev->state.frame_time);
+
+    for (uint8_t i = available; i < num_channels; i++) {
+        channels[i] = PIOS_RCVR_INVALID;
+    }
+    return available;
+}
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+/**
+ * Get the semaphore given on every new frame, the same for all channels
+ */
+static xSemaphoreHandle PIOS_SBus_Get_Semaphore(uint32_t rcvr_id, __attribute__((unused)) uint8_t channel)
+{
+    struct pios_sbus_dev *sbus_dev = (struct pios_sbus_dev *)rcvr_id;
+
+    if (!PIOS_SBus_Validate(sbus_dev)) {
+        return 0;
+    }
+
+    if (sbus_dev->new_frame_semaphore == 0) {
+        vSemaphoreCreateBinary(sbus_dev->new_frame_semaphore);
+    }
+    return sbus_dev->new_frame_semaphore;
+}
+#endif /* if defined(PIOS_INCLUDE_FREERTOS) */
+
+/**
+ * Get the time the last good frame was received, 0 if none
+ */
+static uint32_t PIOS_SBus_Get_Frame_Time(uint32_t rcvr_id)
+{
+    struct pios_sbus_dev *sbus_dev = (struct pios_sbus_dev *)rcvr_id;
+
+    if (!PIOS_SBus_Validate(sbus_dev)) {
+        return 0;
+    }
+
+    return sbus_dev->state.frame_time;
+}
+
 /**
  * Compute channel_data[] from received_data[].
  * For efficiency it unrolls first 8 channels without loops and does the
@@ -225,12 +305,17 @@ static void PIOS_SBus_UnrollChannels(struct pios_sbus_state *state)
     *d++ = (s[22] & SBUS_FLAG_DC2) ? SBUS_VALUE_MAX : SBUS_VALUE_MIN;
 }
 
-/* Update decoder state processing input byte from the S.Bus stream */
-static void PIOS_SBus_UpdateState(struct pios_sbus_state *state, uint8_t b)
+/**
+ * Update decoder state processing input byte from the S.Bus stream
+ * \output true if a new frame was decoded into channel_data[]
+ */
+static bool PIOS_SBus_UpdateState(struct pios_sbus_state *state, uint8_t b)
 {
+    bool new_frame = false;
+
     /* should not process any data until new frame is found */
     if (!state->frame_found) {
-        return;
+        return false;
     }
 
     if (state->byte_count == 0) {
@@ -241,7 +326,7 @@ static void PIOS_SBus_UpdateState(struct pios_sbus_state *state, uint8_t b)
             /* do not store the SOF byte */
             state->byte_count++;
         }
-        return;
+        return false;
     }
 
     /* do not store last frame byte as well */
@@ -258,10 +343,13 @@ static void PIOS_SBus_UpdateState(struct pios_sbus_state *state, uint8_t b)
             } else if (flags & SBUS_FLAG_FS) {
                 /* failsafe flag active */
                 PIOS_SBus_ResetChannels(state);
+                new_frame = true;
             } else {
                 /* data looking good */
                 PIOS_SBus_UnrollChannels(state);
                 state->failsafe_timer = 0;
+                state->frame_time     = PIOS_DELAY_GetRaw();
+                new_frame = true;
             }
         } else {
             /* discard whole frame */
@@ -270,6 +358,8 @@ static void PIOS_SBus_UpdateState(struct pios_sbus_state *state, uint8_t b)
         /* prepare for the next frame */
         state->frame_found = 0;
     }
+
+    return new_frame;
 }
 
 /* Comm byte received callback */
@@ -286,10 +376,11 @@ static uint16_t PIOS_SBus_RxInCallback(uint32_t context,
     PIOS_Assert(valid);
 
     struct pios_sbus_state *state = &(sbus_dev->state);
+    bool new_frame = false;
 
     /* process byte(s) and clear receive timer */
     for (uint8_t i = 0; i < buf_len; i++) {
-        PIOS_SBus_UpdateState(state, buf[i]);
+        new_frame |= PIOS_SBus_UpdateState(state, buf[i]);
         state->receive_timer = 0;
     }
 
@@ -298,8 +389,15 @@ static uint16_t PIOS_SBus_RxInCallback(uint32_t context,
         *headroom = SBUS_FRAME_LENGTH;
     }
 
-    /* We never need a yield */
+    /* Wake up the receiver task as soon as the frame is complete */
     *need_yield = false;
+#if defined(PIOS_INCLUDE_FREERTOS)
+    if (new_frame && sbus_dev->new_frame_semaphore != 0) {
+        signed portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+        xSemaphoreGiveFromISR(sbus_dev->new_frame_semaphore, &xHigherPriorityTaskWoken);
+        *need_yield = (xHigherPriorityTaskWoken == pdTRUE);
+    }
+#endif
 
     /* Always indicate that all bytes were consumed */
     return buf_len;
@@ -80,6 +80,16 @@ uint8_t PIOS_SDCARD_Sector[SECTOR_SIZE];
 #define SDCMD_WRITE_SINGLE_BLOCK     (0x40 + 24)
 #define SDCMD_WRITE_SINGLE_BLOCK_CRC 0xff
 
+#define SDCMD_WRITE_MULTIPLE_BLOCK   (0x40 + 25)
+#define SDCMD_WRITE_MULTIPLE_BLOCK_CRC 0xff
+
+#define SDCMD_SET_WR_BLK_ERASE_COUNT (0xC0 + 23)
+#define SDCMD_SET_WR_BLK_ERASE_COUNT_CRC 0xff
+
+/* Data tokens of a multiple block write */
+#define SDTOKEN_START_MULTIPLE_BLOCK 0xfc
+#define SDTOKEN_STOP_TRANSMISSION    0xfd
+
 /* Card type flags (CardType) */
 #define CT_MMC                       0x01
 #define CT_SD1                       0x02
@@ -553,6 +563,111 @@ error:
     return status;
 }
 
+/**
+ * Writes consecutive sectors with a single multiple block write, which
+ * avoids the programming delay the card takes after every single block write
+ * \param[in] sector first 32bit sector
+ * \param[in] *buffer pointer to count * 512 byte buffer
+ * \param[in] count number of sectors to write
+ * \return 0 if all sectors have been successfully written
+ * \return -error if error occured during write operation, as for PIOS_SDCARD_SectorWrite
+ * \return -256 if timeout during command has been sent
+ * \return -257 if write operation not accepted
+ * \return -258 if timeout during write operation
+ */
+int32_t PIOS_SDCARD_SectorsWrite(uint32_t sector, uint8_t *buffer, uint32_t count)
+{
+    int32_t status;
+    int i;
+
+    if (count == 1) {
+        return PIOS_SDCARD_SectorWrite(sector, buffer);
+    }
+
+    SDCARD_MUTEX_TAKE;
+
+    if (!(CardType & CT_BLOCK)) {
+        sector *= 512;
+    }
+
+    /* Init SPI port for fast frequency access (ca. 18 MBit/s) */
+    /* This is required for the case that the SPI port is shared with other devices */
+    PIOS_SPI_SetClockSpeed(PIOS_SDCARD_SPI, PIOS_SPI_PRESCALER_4);
+
+    /* Let SD cards pre-erase the blocks that will follow, MMC don't know this command */
+    if (CardType & CT_SDC) {
+        PIOS_SDCARD_SendSDCCmd(SDCMD_SET_WR_BLK_ERASE_COUNT, count, SDCMD_SET_WR_BLK_ERASE_COUNT_CRC);
+        PIOS_SPI_RC_PinSet(PIOS_SDCARD_SPI, 0, 1); /* spi, pin_value */
+        PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
+    }
+
+    if ((status = PIOS_SDCARD_SendSDCCmd(SDCMD_WRITE_MULTIPLE_BLOCK, sector, SDCMD_WRITE_MULTIPLE_BLOCK_CRC))) {
+        status = (status < 0) ? -256 : status; /* Return timeout indicator or error flags */
+        goto error;
+    }
+
+    while (count--) {
+        /* Send start token */
+        PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, SDTOKEN_START_MULTIPLE_BLOCK);
+
+        /* Send 512 bytes of data via DMA */
+        PIOS_SPI_TransferBlock(PIOS_SDCARD_SPI, buffer, NULL, 512, NULL);
+        buffer += 512;
+
+        /* Send CRC */
+        PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
+        PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
+
+        /* Read response, a rejected block still needs the stop token */
+        uint8_t response = PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
+        if ((response & 0x0f) != 0x5) {
+            status = -257;
+            break;
+        }
+
+        /* Wait until the block is programmed */
+        for (i = 0; i < 32 * 65536; ++i) { /* TODO: check if sufficient */
+            uint8_t ret = PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
+            if (ret != 0x00) {
+                break;
+            }
+        }
+        if (i == 32 * 65536) {
+            status = -258;
+            goto error;
+        }
+    }
+
+    /* Send stop token, followed by one byte before the card signals busy */
+    PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, SDTOKEN_STOP_TRANSMISSION);
+    PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
+
+    /* Wait for write completion */
+    for (i = 0; i < 32 * 65536; ++i) { /* TODO: check if sufficient */
+        uint8_t ret = PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
+        if (ret != 0x00) {
+            break;
+        }
+    }
+    if (i == 32 * 65536) {
+        status = -258;
+        goto error;
+    }
+
+    /* Required for clocking (see spec) */
+    PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
+
+error:
+    /* Deactivate chip select */
+    PIOS_SPI_RC_PinSet(PIOS_SDCARD_SPI, 0, 1); /* spi, pin_value */
+    /* Send dummy byte once deactivated to drop cards DO */
+    PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
+
+    SDCARD_MUTEX_GIVE;
+
+    return status;
+}
+
 /**
  * Reads the CID informations from SD Card
  * \param[in] *cid pointer to buffer which holds the CID informations
@@ -1005,6 +1120,152 @@ int32_t PIOS_SDCARD_FileDelete(char *Filename)
     return 0;
 }
 
+/**
+ * Set a run of FAT entries in both FAT copies, either freeing the clusters or
+ * chaining them into one file, writing each FAT sector only once
+ * return 0 No errors
+ * return -1 FAT type not supported
+ * return -2 Error accessing the FAT
+ */
+static int32_t PIOS_SDCARD_FATWriteRun(uint32_t cluster, uint32_t count, bool allocate)
+{
+    uint32_t entrysize;
+    uint32_t eoc;
+
+    switch (PIOS_SDCARD_VolInfo.filesystem) {
+    case FAT16:
+        entrysize = 2;
+        eoc = 0xfff8;
+        break;
+    case FAT32:
+        entrysize = 4;
+        eoc = 0x0ffffff8;
+        break;
+    default:
+        /* FAT12 entries span sectors, SD cards are never formatted like that */
+        return -1;
+    }
+
+    uint32_t last = cluster + count - 1;
+    while (cluster <= last) {
+        uint32_t sector = PIOS_SDCARD_VolInfo.fat1 + (cluster * entrysize) / SECTOR_SIZE;
+        if (DFS_ReadSector(PIOS_SDCARD_VolInfo.unit, PIOS_SDCARD_Sector, sector, 1)) {
+            return -2;
+        }
+        /* update all entries of the run held in this sector */
+        do {
+            uint32_t value  = allocate ? ((cluster == last) ? eoc : cluster + 1) : 0;
+            uint8_t *entry  = &PIOS_SDCARD_Sector[(cluster * entrysize) % SECTOR_SIZE];
+            entry[0] = value & 0xff;
+            entry[1] = (value >> 8) & 0xff;
+            if (entrysize == 4) {
+                /* the upper 4 bits of FAT32 entries are reserved and preserved */
+                entry[2] = (value >> 16) & 0xff;
+                entry[3] = (entry[3] & 0xf0) | ((value >> 24) & 0x0f);
+            }
+            cluster++;
+        } while (cluster <= last && (cluster * entrysize) % SECTOR_SIZE);
+
+        if (DFS_WriteSector(PIOS_SDCARD_VolInfo.unit, PIOS_SDCARD_Sector, sector, 1) ||
+            DFS_WriteSector(PIOS_SDCARD_VolInfo.unit, PIOS_SDCARD_Sector, sector + PIOS_SDCARD_VolInfo.secperfat, 1)) {
+            return -2;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Create a file whose clusters are allocated in one contiguous run, so its
+ * content can be written with PIOS_SDCARD_SectorsWrite without going through
+ * the FAT. An existing file of the same name is deleted first.
+ * The file length is 0 until set with PIOS_SDCARD_FileSetLength.
+ * param[in] *Filename File to create
+ * param[in] size Number of bytes to allocate
+ * param[out] *fileinfo File handle, firstcluster holds the start of the run
+ * return 0 No errors
+ * return -1 Error creating file
+ * return -2 No contiguous free space large enough
+ * return -3 Error writing the FAT or directory
+ */
+int32_t PIOS_SDCARD_FilePreallocate(char *Filename, uint32_t size, PFILEINFO fileinfo)
+{
+    uint32_t clustersize = PIOS_SDCARD_VolInfo.secperclus * SECTOR_SIZE;
+    uint32_t clusters    = (size + clustersize - 1) / clustersize;
+    uint32_t cache = 0;
+    uint32_t start = 0;
+    uint32_t run   = 0;
+
+    /* Delete the file if it exists - ignore errors */
+    DFS_UnlinkFile(&PIOS_SDCARD_VolInfo, (uint8_t *)Filename, PIOS_SDCARD_Sector);
+
+    if (DFS_OpenFile(&PIOS_SDCARD_VolInfo, (uint8_t *)Filename, DFS_WRITE, PIOS_SDCARD_Sector, fileinfo)) {
+        return -1;
+    }
+
+    /*
+     * The file got the first free cluster on creation, all clusters before it
+     * are in use so the search for a free run starts there
+     */
+    for (uint32_t cluster = fileinfo->firstcluster; cluster < PIOS_SDCARD_VolInfo.numclusters && run < clusters; cluster++) {
+        if (cluster == fileinfo->firstcluster || !DFS_GetFAT(&PIOS_SDCARD_VolInfo, PIOS_SDCARD_Sector, &cache, cluster)) {
+            if (!run) {
+                start = cluster;
+            }
+            run++;
+        } else {
+            run = 0;
+        }
+    }
+    if (run < clusters) {
+        return -2;
+    }
+
+    if (PIOS_SDCARD_FATWriteRun(start, clusters, true)) {
+        return -3;
+    }
+    if (start != fileinfo->firstcluster) {
+        if (PIOS_SDCARD_FATWriteRun(fileinfo->firstcluster, 1, false)) {
+            return -3;
+        }
+        fileinfo->firstcluster = start;
+        fileinfo->cluster = start;
+    }
+
+    return PIOS_SDCARD_FileSetLength(fileinfo, 0) ? -3 : 0;
+}
+
+/**
+ * Update the start cluster and length of a file in its directory entry
+ * param[in] *fileinfo File handle
+ * param[in] length New file length in bytes
+ * return 0 No errors
+ * return -1 Error accessing the directory
+ */
+int32_t PIOS_SDCARD_FileSetLength(PFILEINFO fileinfo, uint32_t length)
+{
+    if (DFS_ReadSector(PIOS_SDCARD_VolInfo.unit, PIOS_SDCARD_Sector, fileinfo->dirsector, 1)) {
+        return -1;
+    }
+
+    PDIRENT de = &((PDIRENT)PIOS_SDCARD_Sector)[fileinfo->diroffset];
+    de->startclus_l_l = fileinfo->firstcluster & 0xff;
+    de->startclus_l_h = (fileinfo->firstcluster >> 8) & 0xff;
+    de->startclus_h_l = (fileinfo->firstcluster >> 16) & 0xff;
+    de->startclus_h_h = (fileinfo->firstcluster >> 24) & 0xff;
+    de->filesize_0    = length & 0xff;
+    de->filesize_1    = (length >> 8) & 0xff;
+    de->filesize_2    = (length >> 16) & 0xff;
+    de->filesize_3    = (length >> 24) & 0xff;
+
+    if (DFS_WriteSector(PIOS_SDCARD_VolInfo.unit, PIOS_SDCARD_Sector, fileinfo->dirsector, 1)) {
+        return -1;
+    }
+    fileinfo->filelen = length;
+
+    return 0;
+}
+
 #endif /* PIOS_INCLUDE_SDCARD */
 
 /**
@@ -0,0 +1,416 @@
+/**
+ ******************************************************************************
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup PIOS_SDLOG SD card flight log
+ * @brief Streams the on board log to preallocated files on the SD card
+ * @{
+ *
+ * @file       pios_sdlog.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      SD card flight log
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "pios.h"
+
+#if defined(PIOS_INCLUDE_SDCARD) && defined(PIOS_USE_DEBUGLOG_ON_SDCARD)
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+#include "callbackinfo.h"
+#endif
+
+/*
+ * Every flight is logged to its own file, allocated in one contiguous run of
+ * clusters while disarmed. Data is collected in one of two buffers while the
+ * other one is written out with a single multiple block write, bypassing the
+ * filesystem. The file length in the directory is only updated every few
+ * buffers and when the flight ends, it always covers written out data only.
+ */
+#ifndef PIOS_SDLOG_FILE_SIZE
+#define PIOS_SDLOG_FILE_SIZE       (64 * 1024 * 1024)
+#endif
+#ifndef PIOS_SDLOG_BUFFER_SECTORS
+#define PIOS_SDLOG_BUFFER_SECTORS  8
+#endif
+#define PIOS_SDLOG_BUFFER_SIZE     (PIOS_SDLOG_BUFFER_SECTORS * SECTOR_SIZE)
+// update the directory entry every this many buffers
+#define PIOS_SDLOG_LENGTH_INTERVAL 16
+#define PIOS_SDLOG_NO_FLIGHT       0xFFFFFFFF
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+#define WRITER_CALLBACK_PRIORITY   CALLBACK_PRIORITY_LOW
+#define WRITER_CBTASK_PRIORITY     CALLBACK_TASK_AUXILIARY
+#define WRITER_STACK_SIZE_BYTES    512
+
+static xSemaphoreHandle mutex   = 0; // protects the state below, only held briefly
+static xSemaphoreHandle sdmutex = 0; // serializes card access
+#define mutexlock()     xSemaphoreTakeRecursive(mutex, portMAX_DELAY)
+#define mutexunlock()   xSemaphoreGiveRecursive(mutex)
+#define sdmutexlock()   xSemaphoreTakeRecursive(sdmutex, portMAX_DELAY)
+#define sdmutexunlock() xSemaphoreGiveRecursive(sdmutex)
+static DelayedCallbackInfo *writerCallback;
+#else
+#define mutexlock()
+#define mutexunlock()
+#define sdmutexlock()
+#define sdmutexunlock()
+#endif
+
+struct sdlog_buffer {
+    uint8_t  *data;
+    uint32_t sector; // first sector of the buffer, relative to the start of the file
+    uint32_t used; // bytes
+};
+
+static FILEINFO file;
+static uint32_t file_flight    = PIOS_SDLOG_NO_FLIGHT;
+static uint32_t file_sector;   // physical sector of the start of the file
+static uint32_t file_sectors;  // allocated size
+static uint32_t file_length;   // length committed to the directory
+static uint32_t flush_count;
+
+static struct sdlog_buffer buffers[2];
+static struct sdlog_buffer *fill = 0;
+static struct sdlog_buffer *volatile flushing = 0;
+static uint32_t prepare_flight = PIOS_SDLOG_NO_FLIGHT;
+static bool close_requested    = false;
+
+static void writer();
+
+static void schedule_writer()
+{
+#if defined(PIOS_INCLUDE_FREERTOS)
+    PIOS_CALLBACKSCHEDULER_Dispatch(writerCallback);
+#else
+    writer();
+#endif
+}
+
+static void flight_filename(uint32_t flight, char *filename)
+{
+    snprintf(filename, 13, "FLT%05u.LOG", (unsigned int)(flight & 0xFFFF));
+}
+
+/**
+ * @brief Initialize the SD card log, the card must be mounted already
+ * @return 0 if success, -1 if out of memory
+ */
+int32_t PIOS_SDLOG_Init(void)
+{
+#if defined(PIOS_INCLUDE_FREERTOS)
+    if (!mutex) {
+        mutex   = xSemaphoreCreateRecursiveMutex();
+        sdmutex = xSemaphoreCreateRecursiveMutex();
+        writerCallback = PIOS_CALLBACKSCHEDULER_Create(&writer, WRITER_CALLBACK_PRIORITY, WRITER_CBTASK_PRIORITY, CALLBACKINFO_RUNNING_SDLOG, WRITER_STACK_SIZE_BYTES);
+    }
+#endif
+    if (!buffers[0].data) {
+        buffers[0].data = pios_malloc(2 * PIOS_SDLOG_BUFFER_SIZE);
+        if (!buffers[0].data) {
+            return -1;
+        }
+        buffers[1].data = buffers[0].data + PIOS_SDLOG_BUFFER_SIZE;
+    }
+    mutexlock();
+    fill     = &buffers[0];
+    flushing = 0;
+    file_flight     = PIOS_SDLOG_NO_FLIGHT;
+    prepare_flight  = PIOS_SDLOG_NO_FLIGHT;
+    close_requested = false;
+    mutexunlock();
+
+    return 0;
+}
+
+/**
+ * @brief Allocate the file of a flight in the background, finishing the current one first
+ * @param[in] flight number of the flight to log next
+ */
+void PIOS_SDLOG_Prepare(uint16_t flight)
+{
+    if (!fill) {
+        return;
+    }
+    mutexlock();
+    if (file_flight != flight) {
+        if (file_flight != PIOS_SDLOG_NO_FLIGHT) {
+            close_requested = true;
+        }
+        prepare_flight = flight;
+        schedule_writer();
+    }
+    mutexunlock();
+}
+
+/**
+ * Hand the fill buffer over to the writer. Called with the lock held and
+ * only when the writer is idle, the caller takes care of scheduling it.
+ */
+static void submit_fill_buffer()
+{
+    struct sdlog_buffer *next = (fill == &buffers[0]) ? &buffers[1] : &buffers[0];
+
+    // the card is written in whole sectors, the unused tail reads as erased flash
+    memset(&fill->data[fill->used], 0xff, PIOS_SDLOG_BUFFER_SIZE - fill->used);
+    flushing = fill;
+    if (fill->used == PIOS_SDLOG_BUFFER_SIZE) {
+        next->sector = fill->sector + PIOS_SDLOG_BUFFER_SECTORS;
+        next->used   = 0;
+    } else {
+        // keep the partial last sector, it is written again once complete
+        uint32_t full = fill->used / SECTOR_SIZE;
+        next->sector = fill->sector + full;
+        next->used   = fill->used - full * SECTOR_SIZE;
+        memcpy(next->data, &fill->data[full * SECTOR_SIZE], next->used);
+    }
+    fill = next;
+}
+
+/**
+ * @brief Append data to the log of a flight
+ * @param[in] flight number of the flight the data belongs to
+ * @param[in] data to append
+ * @param[in] size of data
+ * @return 0 if success or error code
+ * @retval -1 if the file of this flight is not ready
+ * @retval -2 if the file of this flight is full
+ * @retval -3 if the card can't keep up, both buffers are full
+ */
+int32_t PIOS_SDLOG_Write(uint16_t flight, const uint8_t *data, uint16_t size)
+{
+    int32_t rc = 0;
+
+    if (!fill) {
+        return -1;
+    }
+    mutexlock();
+    if (file_flight != flight || close_requested) {
+        rc = -1;
+        goto out;
+    }
+    if ((fill->sector * SECTOR_SIZE) + fill->used + size > file_sectors * SECTOR_SIZE) {
+        rc = -2;
+        goto out;
+    }
+    if (fill->used + size >= PIOS_SDLOG_BUFFER_SIZE && flushing) {
+        rc = -3;
+        goto out;
+    }
+
+    uint16_t len = MIN(size, PIOS_SDLOG_BUFFER_SIZE - fill->used);
+    memcpy(&fill->data[fill->used], data, len);
+    fill->used += len;
+    if (fill->used == PIOS_SDLOG_BUFFER_SIZE) {
+        submit_fill_buffer();
+        memcpy(fill->data, &data[len], size - len);
+        fill->used = size - len;
+        schedule_writer();
+    }
+
+out:
+    mutexunlock();
+    return rc;
+}
+
+/**
+ * @brief Write out buffered data and the final length of the current file in the background
+ */
+void PIOS_SDLOG_Close(void)
+{
+    if (!fill) {
+        return;
+    }
+    mutexlock();
+    if (file_flight != PIOS_SDLOG_NO_FLIGHT) {
+        close_requested = true;
+        schedule_writer();
+    }
+    mutexunlock();
+}
+
+/**
+ * Writer callback, writes out the flushing buffer and carries out close and
+ * prepare requests once all data is written.
+ */
+static void writer()
+{
+    char filename[13];
+    bool tail_written = false;
+
+    sdmutexlock();
+    for (;;) {
+        struct sdlog_buffer *block = flushing;
+
+        if (block) {
+            uint32_t count  = (block->used + SECTOR_SIZE - 1) / SECTOR_SIZE;
+            uint32_t length = block->sector * SECTOR_SIZE + block->used;
+            // a failed write is not retried, the entries are lost but the file stays consistent
+            PIOS_SDCARD_SectorsWrite(file_sector + block->sector, block->data, count);
+            // the buffer may be refilled as soon as it is released
+            mutexlock();
+            flushing = 0;
+            mutexunlock();
+            if (++flush_count % PIOS_SDLOG_LENGTH_INTERVAL == 0) {
+                file_length = length;
+                PIOS_SDCARD_FileSetLength(&file, file_length);
+            }
+            continue;
+        }
+
+        mutexlock();
+        if (close_requested) {
+            // the partial last sector stays in the fill buffer, write it out once
+            if (fill->used && !tail_written) {
+                submit_fill_buffer();
+                tail_written = true;
+                mutexunlock();
+                continue;
+            }
+            file_length = fill->sector * SECTOR_SIZE + fill->used;
+            file_flight = PIOS_SDLOG_NO_FLIGHT;
+            close_requested = false;
+            mutexunlock();
+            PIOS_SDCARD_FileSetLength(&file, file_length);
+            continue;
+        }
+        uint32_t flight = prepare_flight;
+        prepare_flight = PIOS_SDLOG_NO_FLIGHT;
+        mutexunlock();
+
+        if (flight == PIOS_SDLOG_NO_FLIGHT || !PIOS_SDCARD_IsMounted()) {
+            break;
+        }
+        flight_filename(flight, filename);
+        if (PIOS_SDCARD_FilePreallocate(filename, PIOS_SDLOG_FILE_SIZE, &file) == 0) {
+            mutexlock();
+            file_sector  = PIOS_SDCARD_VolInfo.dataarea + (file.firstcluster - 2) * PIOS_SDCARD_VolInfo.secperclus;
+            file_sectors = PIOS_SDLOG_FILE_SIZE / SECTOR_SIZE;
+            file_length  = 0;
+            flush_count  = 0;
+            fill->sector = 0;
+            fill->used   = 0;
+            file_flight  = flight;
+            mutexunlock();
+        }
+    }
+    sdmutexunlock();
+}
+
+/**
+ * @brief Read data back from the log of a flight
+ * @param[in] flight number of the flight to read from
+ * @param[in] offset in the flight log
+ * @param[out] data where to store what was read
+ * @param[in] size of data
+ * @return 0 if success or error code
+ * @retval -1 if the card is not mounted
+ * @retval -2 if there is no log for this flight
+ * @retval -3 if the data is beyond what was written out so far
+ * @retval -4 if reading from the card fails
+ */
+int32_t PIOS_SDLOG_Read(uint16_t flight, uint32_t offset, uint8_t *data, uint16_t size)
+{
+    FILEINFO readfile;
+    char filename[13];
+    uint32_t count;
+    int32_t rc = 0;
+
+    if (!PIOS_SDCARD_IsMounted()) {
+        return -1;
+    }
+    flight_filename(flight, filename);
+
+    sdmutexlock();
+    if (DFS_OpenFile(&PIOS_SDCARD_VolInfo, (uint8_t *)filename, DFS_READ, PIOS_SDCARD_Sector, &readfile)) {
+        rc = -2;
+    } else if (offset + size > readfile.filelen) {
+        rc = -3;
+    } else {
+        DFS_Seek(&readfile, offset, PIOS_SDCARD_Sector);
+        if (DFS_ReadFile(&readfile, PIOS_SDCARD_Sector, data, &count, size) || count != size) {
+            rc = -4;
+        }
+    }
+    sdmutexunlock();
+
+    return rc;
+}
+
+/**
+ * @brief Delete all flight logs
+ */
+void PIOS_SDLOG_Format(void)
+{
+    char filename[13];
+
+    if (!fill) {
+        return;
+    }
+    sdmutexlock();
+    mutexlock();
+    // forget the current file and whatever was not written yet
+    flushing    = 0;
+    fill->used  = 0;
+    file_flight = PIOS_SDLOG_NO_FLIGHT;
+    prepare_flight  = PIOS_SDLOG_NO_FLIGHT;
+    close_requested = false;
+    mutexunlock();
+
+    for (uint32_t flight = 0; flight <= 0xFFFF; flight++) {
+        flight_filename(flight, filename);
+        if (PIOS_SDCARD_FileDelete(filename)) {
+            break;
+        }
+    }
+    sdmutexunlock();
+}
+
+/**
+ * @brief Retrieve the usage of the file of the current flight
+ * @param[out] bytes written to the current file
+ * @param[out] bytes left in the current file
+ */
+void PIOS_SDLOG_GetStats(uint32_t *used, uint32_t *free)
+{
+    uint32_t written = 0;
+    uint32_t size    = 0;
+
+    if (fill) {
+        mutexlock();
+        if (file_flight != PIOS_SDLOG_NO_FLIGHT) {
+            written = fill->sector * SECTOR_SIZE + fill->used;
+            size    = file_sectors * SECTOR_SIZE;
+        }
+        mutexunlock();
+    }
+    if (used) {
+        *used = written;
+    }
+    if (free) {
+        *free = size - written;
+    }
+}
+
+#endif /* PIOS_INCLUDE_SDCARD && PIOS_USE_DEBUGLOG_ON_SDCARD */
+
+/**
+ * @}
+ * @}
+ */
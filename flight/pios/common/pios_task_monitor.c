@@ -33,6 +33,9 @@
 static xSemaphoreHandle mLock;
 static xTaskHandle *mTaskHandles;
 static uint32_t mLastMonitorTime;
+#if (configGENERATE_RUN_TIME_STATS == 1)
+static uint32_t mLastMonitorTimeUs;
+#endif
 static uint32_t mLastIdleMonitorTime;
 static uint16_t mMaxTasks;
 
@@ -55,6 +58,7 @@ int32_t PIOS_TASK_MONITOR_Initialize(uint16_t max_tasks)
     mMaxTasks = max_tasks;
 #if (configGENERATE_RUN_TIME_STATS == 1)
     mLastMonitorTime     = portGET_RUN_TIME_COUNTER_VALUE();
+    mLastMonitorTimeUs   = PIOS_DELAY_GetuS();
     mLastIdleMonitorTime = portGET_RUN_TIME_COUNTER_VALUE();
 #else
     mLastMonitorTime     = 0;
@@ -114,12 +118,16 @@ void PIOS_TASK_MONITOR_ForEachTask(TaskMonitorTaskInfoCallback callback, void *c
 
 #if (configGENERATE_RUN_TIME_STATS == 1)
     /* Calculate the amount of elapsed run time between the last time we
-     * measured and now. Scale so that we can convert task run times
-     * directly to percentages. */
-    uint32_t currentTime = portGET_RUN_TIME_COUNTER_VALUE();
+     * measured and now, in run time counter ticks and in microseconds to
+     * convert the ticks of the single runs. */
+    uint32_t currentTime   = portGET_RUN_TIME_COUNTER_VALUE();
+    uint32_t currentTimeUs = PIOS_DELAY_GetuS();
     /* avoid divide-by-zero if the interval is too small */
-    uint32_t deltaTime   = ((currentTime - mLastMonitorTime) / 100) ? : 1;
-    mLastMonitorTime = currentTime;
+    uint32_t deltaTime     = (currentTime - mLastMonitorTime) ? : 1;
+    uint32_t deltaTimeUs   = (currentTimeUs - mLastMonitorTimeUs) ? : 1;
+    mLastMonitorTime   = currentTime;
+    mLastMonitorTimeUs = currentTimeUs;
+    const float usPerTick = (float)deltaTimeUs / (float)deltaTime;
 #endif
     /* Update all task information */
     for (uint16_t n = 0; n < mMaxTasks; ++n) {
@@ -133,14 +141,25 @@ void PIOS_TASK_MONITOR_ForEachTask(TaskMonitorTaskInfoCallback callback, void *c
 #endif
 #if (configGENERATE_RUN_TIME_STATS == 1)
             /* Generate run time percentage stats */
-            info.running_time_percentage = uxTaskGetRunTime(mTaskHandles[n]) / deltaTime;
+            uint32_t runTime, maxRunTime, switchCount;
+            vTaskGetRunTimeCounters(mTaskHandles[n], &runTime, &maxRunTime, &switchCount);
+            info.cpu_load = (100.0f * runTime) / deltaTime;
+            info.running_time_percentage = (uint8_t)info.cpu_load;
+            info.max_run_time_us     = (uint32_t)(maxRunTime * usPerTick);
+            info.context_switch_rate = (uint32_t)((1.0e6f * switchCount) / deltaTimeUs);
 #else
             info.running_time_percentage = 0;
+            info.cpu_load = 0.0f;
+            info.max_run_time_us     = 0;
+            info.context_switch_rate = 0;
 #endif
         } else {
             info.is_running = false;
             info.stack_remaining = 0;
             info.running_time_percentage = 0;
+            info.cpu_load = 0.0f;
+            info.max_run_time_us     = 0;
+            info.context_switch_rate = 0;
         }
         /* Pass the information for this task back to the caller */
         callback(n, &info, context);
@@ -149,6 +168,21 @@ void PIOS_TASK_MONITOR_ForEachTask(TaskMonitorTaskInfoCallback callback, void *c
     xSemaphoreGiveRecursive(mLock);
 }
 
+int16_t PIOS_TASK_MONITOR_GetCurrentTaskId()
+{
+    if (!mTaskHandles) {
+        return -1;
+    }
+
+    xTaskHandle current = xTaskGetCurrentTaskHandle();
+    for (uint16_t n = 0; n < mMaxTasks; ++n) {
+        if (mTaskHandles[n] == current) {
+            return n;
+        }
+    }
+    return -1;
+}
+
 uint8_t PIOS_TASK_MONITOR_GetIdlePercentage()
 {
 #if defined(ARCH_POSIX) || defined(ARCH_WIN32)
@@ -77,6 +77,8 @@ volatile uint16_t line = 0;
 volatile uint16_t Vsync_update = 0;
 volatile uint16_t Hsync_update = 0;
 static int16_t m_osdLines = 0;
+// the draw buffer holds a complete frame, the blank one counts as such
+static volatile bool frame_done = true;
 
 /**
  * swap_buffers: Swaps the two buffers. Contents in the display
@@ -122,10 +124,12 @@ bool PIOS_Vsync_ISR()
     gActiveLine  = 0;
     Hsync_update = 0;
     Vsync_update++;
-    if (Vsync_update >= 2) {
-        // load second image buffer
+    if (Vsync_update >= 2 && frame_done) {
+        // load second image buffer, never a half drawn one: a late frame
+        // shows on the first vertical blank after it is done
         swap_buffers();
         Vsync_update = 0;
+        frame_done   = false;
 
         // trigger redraw every second field
         xHigherPriorityTaskWoken = xSemaphoreGiveFromISR(osdSemaphore, &xHigherPriorityTaskWoken);
@@ -141,6 +145,15 @@ uint16_t PIOS_Video_GetOSDLines(void)
     return m_osdLines;
 }
 
+/**
+ * Tell that the draw buffer holds a complete frame, to be displayed from the
+ * next vertical blank on
+ */
+void PIOS_Video_FrameDone(void)
+{
+    frame_done = true;
+}
+
 /**
  * Stops the pixel clock and ensures it ignores the rising edge.  To be used after a
  * vsync until the first line is to be displayed
@@ -36,10 +36,20 @@
 
 typedef void (*ADCCallback)(float *data);
 
+/* State of a pin as kept from the DMA interrupt */
+struct pios_adc_pin_stats {
+    float    filtered; /* low passed value, in ADC counts */
+    uint64_t positive; /* sum of the samples above the pin offset, in ADC counts, never cleared */
+    uint32_t samples; /* number of samples summed into positive, wraps */
+    uint32_t timestamp; /* PIOS_DELAY_GetRaw() time of the last block */
+};
+
 /* Public Functions */
 void PIOS_ADC_Config(uint32_t oversampling);
 int32_t PIOS_ADC_PinGet(uint32_t pin);
 float PIOS_ADC_PinGetVolt(uint32_t pin);
+bool PIOS_ADC_PinGetStats(uint32_t pin, struct pios_adc_pin_stats *stats);
+void PIOS_ADC_PinSetOffset(uint32_t pin, uint16_t offset);
 int16_t *PIOS_ADC_GetRawBuffer(void);
 uint8_t PIOS_ADC_GetOverSampling(void);
 void PIOS_ADC_SetCallback(ADCCallback new_function);
@@ -145,6 +145,31 @@ DelayedCallbackInfo *PIOS_CALLBACKSCHEDULER_Create(
     int16_t callbackID,
     uint32_t stacksize);
 
+/**
+ * Give a callback a period and a deadline.
+ * The deadline counts from the moment the callback is dispatched, or its schedule expires.
+ * Runs that complete after the deadline are counted as deadline misses.
+ * On a scheduler task in deadline mode, callbacks with a deadline run earliest
+ * deadline first, ahead of callbacks of the same priority without one.
+ * \param[in] *cbinfo the callback handle
+ * \param[in] periodMs The period the callback is dispatched at, 0 if not periodic
+ * \param[in] deadlineMs The relative deadline, 0 to use the period, 0 for both to remove the deadline
+ * \return Success (0), failure (-1)
+ */
+int32_t PIOS_CALLBACKSCHEDULER_SetDeadline(DelayedCallbackInfo *cbinfo, uint16_t periodMs, uint16_t deadlineMs);
+
+/**
+ * Enable or disable earliest deadline first scheduling on a scheduler task.
+ * A waiting callback of a higher priority still runs first, deadlines only
+ * order the callbacks of one priority. Callbacks without a deadline keep the
+ * round robin order, they run whenever no callback of their priority with a
+ * deadline is waiting.
+ * \param[in] priorityTask Task priority of the scheduler task, it must have been created already
+ * \param[in] enable Selects deadline mode
+ * \return Success (0), failure (-1)
+ */
+int32_t PIOS_CALLBACKSCHEDULER_SetDeadlineMode(DelayedCallbackPriorityTask priorityTask, bool enable);
+
 /**
  * Schedule dispatching a callback at some point in the future. The function returns immediately.
  * \param[in] *cbinfo the callback handle
@@ -186,6 +211,13 @@ int32_t PIOS_CALLBACKSCHEDULER_Dispatch(DelayedCallbackInfo *cbinfo);
  */
 int32_t PIOS_CALLBACKSCHEDULER_DispatchFromISR(DelayedCallbackInfo *cbinfo, long *pxHigherPriorityTaskWoken);
 
+/**
+ * Number of buckets in the timing histograms, the bucket limits are
+ * 10us, 30us, 100us, 300us, 1ms, 3ms and 10ms, the last bucket takes anything longer.
+ * Bucket counts saturate at UINT16_MAX.
+ */
+#define PIOS_CALLBACKSCHEDULER_HISTOGRAM_BUCKETS 8
+
 /**
  * Information about a running callback that has been registered
  * via a call to PIOS_CALLBACKSCHEDULER_Create().
@@ -197,6 +229,14 @@ struct pios_callback_info {
     bool     is_running;
     /** Count of executions of the callback since system start */
     uint32_t running_time_count;
+    /** Longest execution time of the callback in microseconds */
+    uint32_t worst_case_runtime_us;
+    /** Count of executions that completed after their deadline, or were shed */
+    uint32_t deadline_misses;
+    /** Execution time histogram, see PIOS_CALLBACKSCHEDULER_HISTOGRAM_BUCKETS */
+    uint16_t run_time_histogram[PIOS_CALLBACKSCHEDULER_HISTOGRAM_BUCKETS];
+    /** Dispatch to start of execution latency histogram */
+    uint16_t latency_histogram[PIOS_CALLBACKSCHEDULER_HISTOGRAM_BUCKETS];
 };
 
 /**
@@ -57,6 +57,8 @@ extern int32_t PIOS_COM_SendString(uint32_t com_id, const char *str);
 extern int32_t PIOS_COM_SendFormattedStringNonBlocking(uint32_t com_id, const char *format, ...);
 extern int32_t PIOS_COM_SendFormattedString(uint32_t com_id, const char *format, ...);
 extern uint16_t PIOS_COM_ReceiveBuffer(uint32_t com_id, uint8_t *buf, uint16_t buf_len, uint32_t timeout_ms);
+extern int32_t PIOS_COM_ForwardBuffer(uint32_t from_id, uint32_t to_id, uint32_t timeout_ms);
+extern uint32_t PIOS_COM_GetRxTime(uint32_t com_id);
 extern bool PIOS_COM_Available(uint32_t com_id);
 
 #endif /* PIOS_COM_H */
@@ -31,12 +31,24 @@
 #ifndef PIOS_DEBUGLOG_H
 #define PIOS_DEBUGLOG_H
 
+/* How uavobject updates are stored in flash */
+enum pios_debuglog_encoding {
+    PIOS_DEBUGLOG_ENCODING_FULL = 0, /* one complete DebugLogEntry record per update */
+    PIOS_DEBUGLOG_ENCODING_COMPACT, /* varint timestamps and per flight object dictionary */
+    PIOS_DEBUGLOG_ENCODING_COMPACTDELTA, /* compact, storing only the words changed since the previous record */
+};
 
 /**
  * @brief Initialize the log facility
  */
 void PIOS_DEBUGLOG_Initialize();
 
+/**
+ * @brief Select how uavobject updates are encoded in the log
+ * @param[in] encoding to use for the following entries
+ */
+void PIOS_DEBUGLOG_SetEncoding(enum pios_debuglog_encoding encoding);
+
 /**
  * @brief Enables or Disables logging globally
  * @param[in] enable or disable logging
@@ -53,6 +65,19 @@ void PIOS_DEBUGLOG_Enable(uint8_t enabled);
  */
 void PIOS_DEBUGLOG_UAVObject(uint32_t objid, uint16_t instid, size_t size, uint8_t *data);
 
+/**
+ * @brief Start a sample, the uavobjects logged until PIOS_DEBUGLOG_EndSample
+ * get the same timestamp and are kept in one block if they fit
+ * @param[in] size of the data of all the objects of the sample
+ * @param[in] count of objects in the sample
+ */
+void PIOS_DEBUGLOG_BeginSample(size_t size, uint16_t count);
+
+/**
+ * @brief End the sample started by PIOS_DEBUGLOG_BeginSample
+ */
+void PIOS_DEBUGLOG_EndSample(void);
+
 /**
  * @brief Write a debug log entry with text
  * @param[in] format - as in printf
@@ -84,6 +109,13 @@ int32_t PIOS_DEBUGLOG_Read(void *buffer, uint16_t flight, uint16_t inst);
  */
 void PIOS_DEBUGLOG_Info(uint16_t *flight, uint16_t *entry, uint16_t *free, uint16_t *used);
 
+/**
+ * @brief Retrieve the throughput counters of the logging system
+ * @param[out] bytes written to flash since startup
+ * @param[out] entries dropped since startup because the writer could not keep up
+ */
+void PIOS_DEBUGLOG_Counters(uint32_t *written, uint32_t *dropped);
+
 /**
  * @brief Format entire flash memory!!!
  */
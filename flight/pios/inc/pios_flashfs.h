@@ -28,18 +28,35 @@
 #define PIOS_FLASHFS_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 struct PIOS_FLASHFS_Stats {
     uint16_t num_free_slots; /* slots in free state */
     uint16_t num_active_slots; /* slots in active state */
+    uint16_t num_obsolete_slots; /* slots garbage collection would free */
+    uint32_t min_arena_erases; /* erase count of the least worn arena */
+    uint32_t max_arena_erases; /* erase count of the most worn arena */
+    uint16_t gc_count; /* garbage collections since boot */
+    uint16_t gc_foreground_count; /* of these, the ones a save had to wait for */
+    uint32_t gc_bytes_copied; /* bytes copied by garbage collection since boot */
+    uint32_t gc_last_us; /* time spent in the last garbage collection */
+    uint32_t gc_max_us; /* time spent in the longest garbage collection */
 };
 
+/*
+ * Iterator for PIOS_FLASHFS_ObjSaveBatch, fills in the next object instance
+ * to save and returns true, or returns false once there is nothing left.
+ */
+typedef bool (*PIOS_FLASHFS_ObjIterator)(void *context, uint32_t *obj_id, uint16_t *obj_inst_id, uint8_t **obj_data, uint16_t *obj_size);
+
 // define logfs subdirectory of a yaffs flash device
 #define PIOS_LOGFS_DIR "logfs"
 
 int32_t PIOS_FLASHFS_Format(uintptr_t fs_id);
 int32_t PIOS_FLASHFS_ObjSave(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id, uint8_t *obj_data, uint16_t obj_size);
+int32_t PIOS_FLASHFS_ObjSaveBatch(uintptr_t fs_id, PIOS_FLASHFS_ObjIterator next, void *context);
 int32_t PIOS_FLASHFS_ObjLoad(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id, uint8_t *obj_data, uint16_t obj_size);
 int32_t PIOS_FLASHFS_ObjDelete(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id);
 int32_t PIOS_FLASHFS_GetStats(uintptr_t fs_id, struct PIOS_FLASHFS_Stats *stats);
+int32_t PIOS_FLASHFS_Maintain(uintptr_t fs_id);
 #endif /* PIOS_FLASHFS_H */
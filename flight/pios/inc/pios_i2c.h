@@ -48,6 +48,24 @@ struct pios_i2c_txn {
     uint8_t    *buf;
 };
 
+/*
+ * Queued transaction: the transfers of txn_list are chained with restarts as
+ * with PIOS_I2C_Transfer(). The callback runs in the FreeRTOS timer task once
+ * the stop condition has been sent, result is 0 on success, -1 on a bus error,
+ * -2 on a timeout or -3 on a NACK. It must not block, it may queue the next
+ * transaction. A timeout is noticed by a periodic timer of the adapter.
+ * The descriptor, txn_list and its buffers belong to the driver until then,
+ * next is used by the queue.
+ */
+struct pios_i2c_transaction {
+    const struct pios_i2c_txn *txn_list;
+    uint32_t num_txns;
+    void     (*callback)(struct pios_i2c_transaction *transaction, int32_t result, bool *woken);
+    void     *context;
+
+    struct pios_i2c_transaction *next;
+};
+
 #define I2C_LOG_DEPTH 20
 enum pios_i2c_error_type {
     PIOS_I2C_ERROR_EVENT,
@@ -65,7 +83,12 @@ struct pios_i2c_fault_history {
 
 /* Public Functions */
 extern int32_t PIOS_I2C_Transfer(uint32_t i2c_id, const struct pios_i2c_txn txn_list[], uint32_t num_txns);
-extern int32_t PIOS_I2C_Transfer_Callback(uint32_t i2c_id, const struct pios_i2c_txn txn_list[], uint32_t num_txns, void *callback);
+#if defined(STM32F4XX) && defined(PIOS_INCLUDE_FREERTOS)
+/* The transaction queue is available, its completions run in the timer task */
+#define PIOS_I2C_TRANSACTIONS
+extern int32_t PIOS_I2C_SubmitTransaction(uint32_t i2c_id, struct pios_i2c_transaction *transaction);
+extern int32_t PIOS_I2C_SubmitTransactionISR(uint32_t i2c_id, struct pios_i2c_transaction *transaction, bool *woken);
+#endif
 extern void PIOS_I2C_EV_IRQ_Handler(uint32_t i2c_id);
 extern void PIOS_I2C_ER_IRQ_Handler(uint32_t i2c_id);
 extern void PIOS_I2C_IRQ_Handler(uint32_t i2c_id);
@@ -29,6 +29,9 @@
 #include <pios.h>
 #include <pios_stm32.h>
 #include <stdbool.h>
+#ifdef PIOS_I2C_TRANSACTIONS
+#include <timers.h>
+#endif
 
 struct pios_i2c_adapter_cfg {
     I2C_TypeDef       *regs;
@@ -68,7 +71,18 @@ struct pios_i2c_adapter {
     const struct pios_i2c_txn *active_txn;
     const struct pios_i2c_txn *last_txn;
 
-    void    (*callback)();
+#ifdef PIOS_I2C_TRANSACTIONS
+    /* transaction queue, the head is the one on the bus while queue_running */
+    struct pios_i2c_transaction *queue_head;
+    struct pios_i2c_transaction *queue_tail;
+    volatile bool queue_running;
+    volatile bool queue_stopping; /* the head is done, its completion is pended to the timer task */
+    volatile bool transfer_running; /* a blocking transfer holds the bus */
+    volatile uint8_t transfers_waiting; /* blocking transfers waiting for the bus, they go before the queue */
+    uint32_t queue_start; /* PIOS_DELAY_GetRaw() when the head was started */
+    xSemaphoreHandle sem_queue_idle; /* given when the head is retired while a transfer waits */
+    xTimerHandle queue_timer; /* runs the transfer timeout of the head */
+#endif /* PIOS_I2C_TRANSACTIONS */
 
     uint8_t *active_byte;
     uint8_t *last_byte;
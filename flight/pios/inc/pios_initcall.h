@@ -46,8 +46,39 @@ typedef int32_t (*initcall_t)(void);
 typedef struct {
     initcall_t fn_minit;
     initcall_t fn_tinit;
+    uint32_t   flags;
 } initmodule_t;
 
+/* the Initialize of the module depends on no other module, it may run alongside the others */
+#define PIOS_INITCALL_PARALLEL 0x01
+
+/* boot timeline, ms since the scheduler started, 0 while the phase did not end */
+enum pios_initcall_phase {
+    PIOS_INITCALL_PHASE_BOARDINIT,
+    PIOS_INITCALL_PHASE_MODULEINIT,
+    PIOS_INITCALL_PHASE_MODULESTART,
+    PIOS_INITCALL_PHASE_READY,
+    PIOS_INITCALL_PHASE_COUNT
+};
+
+struct pios_initcall_stats {
+    uint32_t   phase_ms[PIOS_INITCALL_PHASE_COUNT];
+    uint32_t   slowest_init_us; /* longest module Initialize */
+    initcall_t slowest_init;
+    uint32_t   slowest_start_us; /* longest module Start */
+    initcall_t slowest_start;
+};
+
+/**
+ * Record the end of a boot phase, later calls for the same phase are ignored.
+ */
+extern void PIOS_INITCALL_MarkPhase(enum pios_initcall_phase phase);
+
+/**
+ * Get the boot timeline and the slowest module calls.
+ */
+extern void PIOS_INITCALL_GetStats(struct pios_initcall_stats *stats);
+
 /* Init module section */
 extern initmodule_t __module_initcall_start[], __module_initcall_end[];
 
@@ -57,6 +88,7 @@ extern void InitModules();
 extern void StartModules();
 
 #define MODULE_INITCALL(ifn, sfn)
+#define MODULE_INITCALL_PARALLEL(ifn, sfn)
 
 #define MODULE_TASKCREATE_ALL \
     { \
@@ -85,25 +117,20 @@ extern void StartModules();
     static initcall_t __initcall_##fn##id __attribute__((__used__)) \
     __attribute__((__section__(".initcall" level ".init"))) = fn
 
-#define __define_module_initcall(level, ifn, sfn) \
+#define __define_module_initcall(level, ifn, sfn, fl) \
     static initmodule_t __initcall_##ifn __attribute__((__used__)) \
-    __attribute__((__section__(".initcall" level ".init"))) = { .fn_minit = ifn, .fn_tinit = sfn }
+    __attribute__((__section__(".initcall" level ".init"))) = { .fn_minit = ifn, .fn_tinit = sfn, .flags = fl }
 
-#define MODULE_INITCALL(ifn, sfn) __define_module_initcall("module", ifn, sfn)
+#define MODULE_INITCALL(ifn, sfn)          __define_module_initcall("module", ifn, sfn, 0)
+#define MODULE_INITCALL_PARALLEL(ifn, sfn) __define_module_initcall("module", ifn, sfn, PIOS_INITCALL_PARALLEL)
 
-#define MODULE_INITIALISE_ALL \
-    { for (initmodule_t *fn = __module_initcall_start; fn < __module_initcall_end; fn++) { \
-          if (fn->fn_minit) { \
-              (fn->fn_minit)(); } \
-      } \
-    }
+/* the module Initialize and Start calls, timed, see pios_initcall.c */
+extern void PIOS_INITCALL_InitModules(void);
+extern void PIOS_INITCALL_StartModules(void);
 
-#define MODULE_TASKCREATE_ALL \
-    { for (initmodule_t *fn = __module_initcall_start; fn < __module_initcall_end; fn++) { \
-          if (fn->fn_tinit) { \
-              (fn->fn_tinit)(); } \
-      } \
-    }
+#define MODULE_INITIALISE_ALL PIOS_INITCALL_InitModules();
+
+#define MODULE_TASKCREATE_ALL PIOS_INITCALL_StartModules();
 
 #endif /* USE_SIM_POSIX */
 
@@ -42,6 +42,77 @@ typedef void *pios_counter_t;
 extern pios_perf_counter_t *pios_instrumentation_perf_counters;
 extern int8_t pios_instrumentation_last_used_counter;
 
+/*
+ * Profiles time code sections in CPU cycles, as counted by the DWT CYCCNT behind
+ * PIOS_DELAY_GetRaw(). Besides min, max and average they keep a histogram of the
+ * durations with two buckets per octave, starting at 256 cycles, for the percentiles.
+ */
+#define PIOS_INSTRUMENTATION_PROFILE_BUCKETS 32
+
+typedef struct {
+    uint32_t id;
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint16_t histogram[PIOS_INSTRUMENTATION_PROFILE_BUCKETS];
+} pios_perf_profile_t;
+
+typedef void *pios_profile_t;
+
+extern pios_perf_profile_t *pios_instrumentation_perf_profiles;
+
+/* statistics of a profile in cycles, @see PIOS_Instrumentation_GetProfileStats */
+struct pios_perf_profile_stats {
+    uint32_t id;
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t average;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+};
+
+/* a profiled section started by PERF_PROFILE_SCOPE, ended when it goes out of scope */
+struct pios_profile_scope {
+    pios_profile_t profile;
+    uint32_t start;
+};
+
+/*
+ * Trace events are kept in a ring of PIOS_INSTRUMENTATION_TRACE_EVENTS entries, the
+ * oldest ones overwritten, until the ring is frozen to be read out.
+ */
+enum pios_trace_event_type {
+    PIOS_TRACE_EVENT_MARK = 0,
+    PIOS_TRACE_EVENT_PROFILE_BEGIN  = 1,
+    PIOS_TRACE_EVENT_PROFILE_END    = 2,
+    PIOS_TRACE_EVENT_CALLBACK_BEGIN = 3,
+    PIOS_TRACE_EVENT_CALLBACK_END   = 4,
+};
+
+/* task of the events not attributed to a registered task */
+#define PIOS_TRACE_TASK_UNKNOWN 0xFF
+
+struct pios_trace_event {
+    uint32_t timestamp; /* PIOS_DELAY_GetRaw() */
+    uint16_t id; /* profile index, callback id or mark */
+    uint8_t  type; /* enum pios_trace_event_type */
+    uint8_t  task; /* task monitor id of the running task */
+};
+
+#ifdef PIOS_INSTRUMENTATION_TRACE_EVENTS
+/**
+ * Add an event to the trace ring, unless it is frozen
+ * @param type kind of event @see pios_trace_event_type
+ * @param id what the event is about, depending on its type
+ */
+void PIOS_Instrumentation_TraceEvent(uint8_t type, uint16_t id);
+#else
+#define PIOS_Instrumentation_TraceEvent(type, id)
+#endif
+
 /**
  * Update a counter with a new value
  * @param counter_handle handle of the counter to update @see PIOS_Instrumentation_SearchCounter @see PIOS_Instrumentation_CreateCounter
@@ -127,8 +198,53 @@ inline void PIOS_Instrumentation_TrackPeriod(pios_counter_t counter_handle)
     counter->lastUpdateTS = PIOS_DELAY_GetRaw();
 }
 
+/**
+ * Account for a profiled section, @see PIOS_Instrumentation_ProfileBegin
+ * @param profile_handle handle of the profile @see PIOS_Instrumentation_CreateProfile
+ * @param cycles length of the section
+ */
+void PIOS_Instrumentation_ProfileAdd(pios_profile_t profile_handle, uint32_t cycles);
+
+/**
+ * Mark the begin of a profiled section. @see PIOS_Instrumentation_ProfileEnd
+ * @param profile_handle handle of the profile @see PIOS_Instrumentation_CreateProfile
+ * @return the start time to give to PIOS_Instrumentation_ProfileEnd
+ */
+static inline uint32_t PIOS_Instrumentation_ProfileBegin(pios_profile_t profile_handle)
+{
+    PIOS_Instrumentation_TraceEvent(PIOS_TRACE_EVENT_PROFILE_BEGIN,
+                                    (pios_perf_profile_t *)profile_handle - pios_instrumentation_perf_profiles);
+    return PIOS_DELAY_GetRaw();
+}
+
+/**
+ * Mark the end of a profiled section. Sections of the same profile may run in several tasks at once.
+ * @param profile_handle handle of the profile @see PIOS_Instrumentation_CreateProfile
+ * @param start what PIOS_Instrumentation_ProfileBegin returned
+ */
+static inline void PIOS_Instrumentation_ProfileEnd(pios_profile_t profile_handle, uint32_t start)
+{
+    PIOS_Instrumentation_ProfileAdd(profile_handle, PIOS_DELAY_GetRaw() - start);
+    PIOS_Instrumentation_TraceEvent(PIOS_TRACE_EVENT_PROFILE_END,
+                                    (pios_perf_profile_t *)profile_handle - pios_instrumentation_perf_profiles);
+}
+
+static inline struct pios_profile_scope PIOS_Instrumentation_ProfileScopeBegin(pios_profile_t profile_handle)
+{
+    struct pios_profile_scope scope = { profile_handle, PIOS_Instrumentation_ProfileBegin(profile_handle) };
+
+    return scope;
+}
+
+static inline void PIOS_Instrumentation_ProfileScopeEnd(struct pios_profile_scope *scope)
+{
+    PIOS_Instrumentation_ProfileEnd(scope->profile, scope->start);
+}
+
 /**
  * Initialize the Instrumentation infrastructure
+ * The profiles and the trace ring are sized by PIOS_INSTRUMENTATION_MAX_PROFILES and
+ * PIOS_INSTRUMENTATION_TRACE_EVENTS, when the board defines them.
  * @param maxCounters maximum number of allowed counters
  */
 void PIOS_Instrumentation_Init(int8_t maxCounters);
@@ -156,4 +272,45 @@ typedef void (*InstrumentationCounterCallback)(const pios_perf_counter_t *counte
  */
 void PIOS_Instrumentation_ForEachCounter(InstrumentationCounterCallback callback, void *context);
 
+/**
+ * Create a new profile.
+ * @param id the unique id to assign to the profile, if a profile with the same id exists it is returned
+ * @return the profile handle
+ */
+pios_profile_t PIOS_Instrumentation_CreateProfile(uint32_t id);
+
+/**
+ * Number of profiles created so far, profiles are indexed from 0 in their creation order
+ */
+int8_t PIOS_Instrumentation_GetNumProfiles();
+
+/**
+ * Compute the statistics of a profile
+ * @param index index of the profile
+ * @param stats where to store them
+ * @param reset start a new measurement period
+ * @return 0 on success, -1 if there is no such profile
+ */
+int32_t PIOS_Instrumentation_GetProfileStats(int8_t index, struct pios_perf_profile_stats *stats, bool reset);
+
+/**
+ * Stop or restart the recording of trace events. The events of a frozen ring can be read out.
+ * @param frozen true to stop the recording
+ */
+void PIOS_Instrumentation_TraceFreeze(bool frozen);
+
+/**
+ * Read events from the trace ring, oldest first. The ring must be frozen.
+ * @param first index of the first event to read, from the oldest one
+ * @param events where to store them
+ * @param count maximum number of events to read
+ * @return the number of events read
+ */
+uint16_t PIOS_Instrumentation_TraceRead(uint16_t first, struct pios_trace_event *events, uint16_t count);
+
+/**
+ * Number of events in the trace ring
+ */
+uint16_t PIOS_Instrumentation_TraceCount();
+
 #endif /* PIOS_INSTRUMENTATION_H */
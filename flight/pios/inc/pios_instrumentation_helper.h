@@ -72,6 +72,24 @@
  * <pre>PERF_TRACK_VALUE(counterAccelSamples, i);</pre>
  * the counter is then updated with the value of i.
  *
+ * Profiles measure code sections in CPU cycles, and report min, max, average and percentiles
+ * through the PerfProfile objects. They are defined and initialized as counters:
+ * <pre>PERF_DEFINE_PROFILE(profileFilter);
+ * PERF_INIT_PROFILE(profileFilter, 0xE6F00003);</pre>
+ *
+ * A scoped profile times the rest of the block it is declared in, whichever way it is left:
+ * <pre>{
+ *     PERF_PROFILE_SCOPE(profileFilter);
+ *     ...
+ * }</pre>
+ * or explicitly, within the same function:
+ * <pre>PERF_PROFILE_START(profileFilter);
+ * ...
+ * PERF_PROFILE_END(profileFilter);</pre>
+ * With PIOS_INSTRUMENTATION_TRACE_EVENTS the sections also go to the trace shown by the GCS timeline,
+ * as the callbacks do. A single point in time can be traced with:
+ * <pre>PERF_TRACE_MARK(0x0001);</pre>
+ *
  * \par
  */
 
@@ -99,6 +117,14 @@
 #define PERF_MEASURE_PERIOD(x)      PIOS_Instrumentation_TrackPeriod(x)
 #define PERF_TRACK_VALUE(x, y)      PIOS_Instrumentation_updateCounter(x, y)
 
+#define PERF_DEFINE_PROFILE(x)      pios_profile_t x
+#define PERF_INIT_PROFILE(x, id)    x = PIOS_Instrumentation_CreateProfile(id)
+#define PERF_PROFILE_SCOPE(x) \
+    struct pios_profile_scope perf_scope_##x __attribute__((cleanup(PIOS_Instrumentation_ProfileScopeEnd))) = PIOS_Instrumentation_ProfileScopeBegin(x)
+#define PERF_PROFILE_START(x)       uint32_t perf_start_##x = PIOS_Instrumentation_ProfileBegin(x)
+#define PERF_PROFILE_END(x)         PIOS_Instrumentation_ProfileEnd(x, perf_start_##x)
+#define PERF_TRACE_MARK(id)         PIOS_Instrumentation_TraceEvent(PIOS_TRACE_EVENT_MARK, id)
+
 #else
 
 #define PERF_DEFINE_COUNTER(x)
@@ -107,5 +133,11 @@
 #define PERF_TIMED_SECTION_END(x)
 #define PERF_MEASURE_PERIOD(x)
 #define PERF_TRACK_VALUE(x, y)
+#define PERF_DEFINE_PROFILE(x)
+#define PERF_INIT_PROFILE(x, id)
+#define PERF_PROFILE_SCOPE(x)
+#define PERF_PROFILE_START(x)
+#define PERF_PROFILE_END(x)
+#define PERF_TRACE_MARK(id)
 #endif /* PIOS_INCLUDE_INSTRUMENTATION */
 #endif /* PIOS_INSTRUMENTATION_HELPER_H */
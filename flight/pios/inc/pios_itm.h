@@ -0,0 +1,152 @@
+/**
+ ******************************************************************************
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup PIOS_ITM ITM trace functions
+ * @brief Stream of scheduler, queue and UAVObject events over ITM/SWO
+ * @{
+ *
+ * @file       pios_itm.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      ITM trace header
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PIOS_ITM_H
+#define PIOS_ITM_H
+
+/*
+ * Built with ENABLE_ITM_TRACE=YES, which defines PIOS_ENABLE_ITM_TRACE for
+ * every source, the FreeRTOS kernel included. The events are written to the
+ * ITM stimulus ports, one port per kind of event so that the payload is the
+ * only thing sent, and the ITM adds hardware timestamps in cycles between
+ * them. The CPU never waits on anything but the ITM FIFO, a few cycles at
+ * the usual SWO rates.
+ *
+ * Ports and payloads, decoded by make/scripts/itm-decode.py:
+ *   1  task switched in     TCB address
+ *   2  task created         TCB address, followed by its name on port 3
+ *   3  task name            one character per write, 0 terminated
+ *   4  queue send           queue address
+ *   5  queue receive        queue address
+ *   6  semaphore give       semaphore or mutex address
+ *   7  semaphore take       semaphore or mutex address
+ *   8  UAVObject updated    object id
+ *   9  UAVObject unpacked   object id, received from telemetry
+ * Port 0 is left to printf style output. Semaphores have ports of their own
+ * as the mutexes of the UAVObject manager are taken and given on every get
+ * and set, which would flood the link: PIOS_ITM_Init() leaves ports 6 and 7
+ * disabled, set their bits in ITM_TER from the debugger to trace them.
+ */
+#define PIOS_ITM_PORT_TASK_SWITCH    1
+#define PIOS_ITM_PORT_TASK_CREATE    2
+#define PIOS_ITM_PORT_TASK_NAME      3
+#define PIOS_ITM_PORT_QUEUE_SEND     4
+#define PIOS_ITM_PORT_QUEUE_RECEIVE  5
+#define PIOS_ITM_PORT_SEM_GIVE       6
+#define PIOS_ITM_PORT_SEM_TAKE       7
+#define PIOS_ITM_PORT_UAVO_UPDATED   8
+#define PIOS_ITM_PORT_UAVO_UNPACKED  9
+
+/* SWO bit rate, a divisor of the core clock */
+#ifndef PIOS_ITM_SWO_BAUD
+#define PIOS_ITM_SWO_BAUD            2000000
+#endif
+
+#include <stdint.h>
+
+/* this header is included by the kernel sources, which know nothing of CMSIS */
+#define PIOS_ITM_STIM32(port) (*(volatile uint32_t *)(0xe0000000 + 4 * (port)))
+#define PIOS_ITM_STIM8(port)  (*(volatile uint8_t *)(0xe0000000 + 4 * (port)))
+#define PIOS_ITM_TER          (*(volatile uint32_t *)0xe0000e00)
+#define PIOS_ITM_TCR          (*(volatile uint32_t *)0xe0000e80)
+#define PIOS_ITM_TCR_ITMENA   (1 << 0)
+
+extern int32_t PIOS_ITM_Init(void);
+
+/**
+ * Write a word to a stimulus port, if the port is enabled
+ * @param port stimulus port
+ * @param value payload
+ */
+static inline void PIOS_ITM_Send32(uint8_t port, uint32_t value)
+{
+    if ((PIOS_ITM_TCR & PIOS_ITM_TCR_ITMENA) && (PIOS_ITM_TER & (1UL << port))) {
+        /* reads 1 once the FIFO has room */
+        while (PIOS_ITM_STIM32(port) == 0) {
+            ;
+        }
+        PIOS_ITM_STIM32(port) = value;
+    }
+}
+
+/**
+ * Write a byte to a stimulus port, if the port is enabled
+ * @param port stimulus port
+ * @param value payload
+ */
+static inline void PIOS_ITM_Send8(uint8_t port, uint8_t value)
+{
+    if ((PIOS_ITM_TCR & PIOS_ITM_TCR_ITMENA) && (PIOS_ITM_TER & (1UL << port))) {
+        while (PIOS_ITM_STIM32(port) == 0) {
+            ;
+        }
+        PIOS_ITM_STIM8(port) = value;
+    }
+}
+
+/**
+ * Announce a task, so that the decoder can name the addresses of the switches
+ * @param handle task handle
+ * @param name task name
+ */
+static inline void PIOS_ITM_SendTask(const void *handle, const char *name)
+{
+    PIOS_ITM_Send32(PIOS_ITM_PORT_TASK_CREATE, (uint32_t)handle);
+    do {
+        PIOS_ITM_Send8(PIOS_ITM_PORT_TASK_NAME, *name);
+    } while (*name++);
+}
+
+#ifdef PIOS_ENABLE_ITM_TRACE
+
+/* FreeRTOS trace hooks, expanded inside tasks.c and queue.c */
+#define traceTASK_SWITCHED_IN()         PIOS_ITM_Send32(PIOS_ITM_PORT_TASK_SWITCH, (uint32_t)pxCurrentTCB)
+#define traceTASK_CREATE(pxNewTCB)      PIOS_ITM_SendTask((pxNewTCB), (const char *)(pxNewTCB)->pcTaskName)
+
+/* semaphores and mutexes are the queues with no item */
+#define pios_itm_queue_event(pxQueue, queue_port, sem_port) \
+    PIOS_ITM_Send32((pxQueue)->uxItemSize ? (queue_port) : (sem_port), (uint32_t)(pxQueue))
+
+#define traceQUEUE_SEND(pxQueue)                 pios_itm_queue_event(pxQueue, PIOS_ITM_PORT_QUEUE_SEND, PIOS_ITM_PORT_SEM_GIVE)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)        pios_itm_queue_event(pxQueue, PIOS_ITM_PORT_QUEUE_SEND, PIOS_ITM_PORT_SEM_GIVE)
+#define traceQUEUE_RECEIVE(pxQueue)              pios_itm_queue_event(pxQueue, PIOS_ITM_PORT_QUEUE_RECEIVE, PIOS_ITM_PORT_SEM_TAKE)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)     pios_itm_queue_event(pxQueue, PIOS_ITM_PORT_QUEUE_RECEIVE, PIOS_ITM_PORT_SEM_TAKE)
+
+#define PIOS_ITM_TRACE_UAVO_UPDATED(objId)       PIOS_ITM_Send32(PIOS_ITM_PORT_UAVO_UPDATED, (objId))
+#define PIOS_ITM_TRACE_UAVO_UNPACKED(objId)      PIOS_ITM_Send32(PIOS_ITM_PORT_UAVO_UNPACKED, (objId))
+
+#endif /* PIOS_ENABLE_ITM_TRACE */
+
+#endif /* PIOS_ITM_H */
+
+/**
+ * @}
+ * @}
+ */
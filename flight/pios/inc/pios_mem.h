@@ -26,12 +26,39 @@
  */
 #ifndef PIOS_MEM_H
 #define PIOS_MEM_H
+#include <stdint.h>
 #include <strings.h>
 
+/*
+ * Placement of hot loop state and code.
+ * __ccm_data puts a variable in the core coupled memory, which is zeroed at startup
+ * and which DMA can not reach: only for zero initialised data that no peripheral touches.
+ * __fast_code runs a function from SRAM, copied there with the initialised data.
+ */
+#ifdef PIOS_TARGET_PROVIDES_FAST_HEAP
+#define __ccm_data  __attribute__((section(".fast")))
+#define __fast_code __attribute__((section(".ramfunc"), long_call, noinline))
+#else
+#define __ccm_data
+#define __fast_code
+#endif
+
 void *pios_fastheapmalloc(size_t size);
 
 void *pios_malloc(size_t size);
 
 void pios_free(void *p);
 
+/* state of a heap */
+struct pios_mem_stats {
+    uint32_t free; /* bytes available */
+    uint32_t min_free; /* least bytes ever available */
+    uint32_t largest_free; /* largest allocation that can succeed */
+    uint16_t allocated; /* blocks in use */
+    uint16_t failed; /* allocations refused */
+};
+
+/* statistics of the SRAM heap, or of the fast heap if there is one and fastheap is set */
+void pios_mem_get_stats(struct pios_mem_stats *stats, uint8_t fastheap);
+
 #endif /* PIOS_MEM_H */
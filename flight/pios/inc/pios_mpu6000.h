@@ -151,6 +151,9 @@ struct pios_mpu6000_cfg {
     SPIPrescalerTypeDef fast_prescaler;
     SPIPrescalerTypeDef std_prescaler;
     uint8_t max_downsample;
+    /* Read accel, temperature and gyro through the FIFO, in bursts of up to this many samples (at most
+     * PIOS_SENSORS_MAX_BATCH_SAMPLES) about once per millisecond. 0 reads the sensor registers on every sample */
+    uint8_t fifo_burst;
 };
 
 /* Public Functions */
@@ -161,6 +164,7 @@ extern void PIOS_MPU6000_Register();
 extern bool PIOS_MPU6000_IRQHandler(void);
 
 extern const PIOS_SENSORS_Driver PIOS_MPU6000_Driver;
+extern const PIOS_SENSORS_Driver PIOS_MPU6000_BatchDriver;
 #endif /* PIOS_MPU6000_H */
 
 /**
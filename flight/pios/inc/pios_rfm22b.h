@@ -97,6 +97,10 @@ struct rfm22b_stats {
     int8_t   rssi;
     int8_t   afc_correction;
     uint8_t  link_state;
+    uint8_t  datarate;
+    uint16_t ppm_interval;
+    uint16_t ppm_interval_max;
+    uint8_t  ppm_latency;
 };
 
 /* Public Functions */
@@ -105,6 +109,9 @@ extern void PIOS_RFM22B_Reinit(uint32_t rfb22b_id);
 extern void PIOS_RFM22B_SetTxPower(uint32_t rfm22b_id, enum rfm22b_tx_power tx_pwr);
 extern void PIOS_RFM22B_SetChannelConfig(uint32_t rfm22b_id, enum rfm22b_datarate datarate, uint8_t min_chan, uint8_t max_chan, bool coordinator, bool oneway, bool ppm_mode, bool ppm_only);
 extern void PIOS_RFM22B_SetCoordinatorID(uint32_t rfm22b_id, uint32_t coord_id);
+extern void PIOS_RFM22B_SetAdaptiveRate(uint32_t rfm22b_id, bool adaptive);
+extern void PIOS_RFM22B_SetFEC(uint32_t rfm22b_id, uint8_t parity, uint8_t interleave);
+extern void PIOS_RFM22B_SetAuthKey(uint32_t rfm22b_id, const uint8_t *key, uint8_t keylen);
 extern uint32_t PIOS_RFM22B_DeviceID(uint32_t rfb22b_id);
 extern void PIOS_RFM22B_GetStats(uint32_t rfm22b_id, struct rfm22b_stats *stats);
 extern uint8_t PIOS_RFM2B_GetPairStats(uint32_t rfm22b_id, uint32_t *device_ids, int8_t *RSSIs, uint8_t max_pairs);
@@ -35,6 +35,7 @@
 #include <fifo_buffer.h>
 #include <uavobjectmanager.h>
 #include <oplinkstatus.h>
+#include <hmac_sha1.h>
 #include "pios_rfm22b.h"
 
 // ************************************
@@ -747,6 +748,12 @@ struct pios_rfm22b_dev {
     int16_t  ppm[RFM22B_PPM_NUM_CHANNELS];
     // The PPM packet received callback.
     PPMReceivedCallback ppm_callback;
+    // The PPM frame statistics being gathered
+    portTickType ppm_last_ticks;
+    uint8_t      ppm_frames;
+    uint32_t     ppm_interval_sum;
+    uint32_t     ppm_interval_max;
+    uint32_t     ppm_latency_sum;
 
     // The id that the packet was received from
     uint32_t     rx_destination_id;
@@ -762,6 +769,36 @@ struct pios_rfm22b_dev {
     bool         ppm_recv_mode;
     // Are we sending / receiving only PPM data?
     bool         ppm_only_mode;
+    // Reed-Solomon parity bytes per codeword
+    uint8_t      fec_parity;
+    // Codewords the packets are interleaved over
+    uint8_t      fec_interleave;
+    // One deinterleaved codeword
+    uint8_t      fec_codeword[RFM22B_MAX_PACKET_LEN];
+    // Bytes of the packet MAC, 0 if not authenticated
+    uint8_t      auth_len;
+    // The key pad states of the packet MAC
+    HMAC_SHA1_CTX auth_ctx;
+
+    // The channel range
+    uint8_t      min_chan;
+    uint8_t      max_chan;
+    // Does the datarate follow the link conditions?
+    bool         adaptive_rate;
+    // The configured datarate, the highest one when adaptive
+    uint8_t      max_datarate;
+    // The datarate proposed by the coordinator, or acknowledged by the remote modem
+    uint8_t      rate_proposed;
+    // Switch to the proposed datarate at the next frequency hop cycle
+    bool         rate_commit;
+    // Has the commit been sent?
+    bool         rate_announced;
+    // Consecutive cycles voting for a faster (> 0) or slower (< 0) datarate
+    int8_t       rate_votes;
+    // Cycles left to wait for an acknowledge or new statistics
+    uint8_t      rate_cycles;
+    // The link quality seen by the remote modem
+    uint8_t      peer_link_quality;
 
     // The channel list
     uint8_t      channels[RFM22B_NUM_CHANNELS];
@@ -97,6 +97,7 @@ extern int32_t PIOS_SDCARD_CheckAvailable(uint8_t was_available);
 extern int32_t PIOS_SDCARD_SendSDCCmd(uint8_t cmd, uint32_t addr, uint8_t crc);
 extern int32_t PIOS_SDCARD_SectorRead(uint32_t sector, uint8_t *buffer);
 extern int32_t PIOS_SDCARD_SectorWrite(uint32_t sector, uint8_t *buffer);
+extern int32_t PIOS_SDCARD_SectorsWrite(uint32_t sector, uint8_t *buffer, uint32_t count);
 extern int32_t PIOS_SDCARD_CIDRead(SDCARDCidTypeDef *cid);
 extern int32_t PIOS_SDCARD_CSDRead(SDCARDCsdTypeDef *csd);
 
@@ -107,6 +108,8 @@ extern int32_t PIOS_SDCARD_GetFree(void);
 #ifndef USE_SIM_POSIX
 extern int32_t PIOS_SDCARD_ReadBuffer(PFILEINFO fileinfo, uint8_t *buffer, uint32_t len);
 extern int32_t PIOS_SDCARD_ReadLine(PFILEINFO fileinfo, uint8_t *buffer, uint32_t max_len);
+extern int32_t PIOS_SDCARD_FilePreallocate(char *Filename, uint32_t size, PFILEINFO fileinfo);
+extern int32_t PIOS_SDCARD_FileSetLength(PFILEINFO fileinfo, uint32_t length);
 #endif
 extern int32_t PIOS_SDCARD_FileCopy(char *Source, char *Destination);
 extern int32_t PIOS_SDCARD_FileDelete(char *Filename);
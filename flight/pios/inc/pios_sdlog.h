@@ -0,0 +1,96 @@
+/**
+ ******************************************************************************
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup PIOS_SDLOG SD card flight log
+ * @brief Streams the on board log to preallocated files on the SD card
+ * @{
+ *
+ * @file       pios_sdlog.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      SD card flight log
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PIOS_SDLOG_H
+#define PIOS_SDLOG_H
+
+#include <stdint.h>
+
+/**
+ * @brief Initialize the SD card log, the card must be mounted already
+ * @return 0 if success, -1 if out of memory
+ */
+int32_t PIOS_SDLOG_Init(void);
+
+/**
+ * @brief Allocate the file of a flight in the background, finishing the current one first
+ * @param[in] flight number of the flight to log next
+ */
+void PIOS_SDLOG_Prepare(uint16_t flight);
+
+/**
+ * @brief Append data to the log of a flight
+ * @param[in] flight number of the flight the data belongs to
+ * @param[in] data to append
+ * @param[in] size of data
+ * @return 0 if success or error code
+ * @retval -1 if the file of this flight is not ready
+ * @retval -2 if the file of this flight is full
+ * @retval -3 if the card can't keep up, both buffers are full
+ */
+int32_t PIOS_SDLOG_Write(uint16_t flight, const uint8_t *data, uint16_t size);
+
+/**
+ * @brief Write out buffered data and the final length of the current file in the background
+ */
+void PIOS_SDLOG_Close(void);
+
+/**
+ * @brief Read data back from the log of a flight
+ * @param[in] flight number of the flight to read from
+ * @param[in] offset in the flight log
+ * @param[out] data where to store what was read
+ * @param[in] size of data
+ * @return 0 if success or error code
+ * @retval -1 if the card is not mounted
+ * @retval -2 if there is no log for this flight
+ * @retval -3 if the data is beyond what was written out so far
+ * @retval -4 if reading from the card fails
+ */
+int32_t PIOS_SDLOG_Read(uint16_t flight, uint32_t offset, uint8_t *data, uint16_t size);
+
+/**
+ * @brief Delete all flight logs
+ */
+void PIOS_SDLOG_Format(void);
+
+/**
+ * @brief Retrieve the usage of the file of the current flight
+ * @param[out] bytes written to the current file
+ * @param[out] bytes left in the current file
+ */
+void PIOS_SDLOG_GetStats(uint32_t *used, uint32_t *free);
+
+#endif /* PIOS_SDLOG_H */
+
+/**
+ * @}
+ * @}
+ */
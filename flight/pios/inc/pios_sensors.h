@@ -51,6 +51,7 @@ typedef struct PIOS_SENSORS_Driver {
     PIOS_SENSORS_get_queue_function get_queue; // get the queue reference
     PIOS_SENSORS_get_scale_function get_scale; // return scales for the sensors
     bool is_polled;
+    bool is_batched; // queue items are PIOS_SENSORS_3Axis_SensorsBatch
 } PIOS_SENSORS_Driver;
 
 typedef enum PIOS_SENSORS_TYPE {
@@ -80,9 +81,23 @@ typedef struct PIOS_SENSORS_3Axis_SensorsWithTemp {
     Vector3i16 sample[];
 } PIOS_SENSORS_3Axis_SensorsWithTemp;
 
+/**
+ * A batch of 3d samples read in one burst from a sensor fifo
+ */
+#define PIOS_SENSORS_MAX_BATCH_SAMPLES 8
+typedef struct PIOS_SENSORS_3Axis_SensorsBatch {
+    uint16_t   count; // number of sensor instances
+    uint16_t   samples; // number of samples in the batch, oldest first
+    int16_t    temperature; // Degrees Celsius * 100, of the newest sample
+    uint32_t   timestamp; // PIOS_DELAY_GetuS() at the newest sample
+    uint32_t   period; // us between samples, sample i was taken period * (samples - 1 - i) before timestamp
+    Vector3i16 sample[]; // samples * count entries, instance j of sample i at [i * count + j]
+} PIOS_SENSORS_3Axis_SensorsBatch;
+
 typedef struct PIOS_SENSORS_1Axis_SensorsWithTemp {
-    float temperature; // Degrees Celsius
-    float sample; // sample
+    float    temperature; // Degrees Celsius
+    float    sample; // sample
+    uint32_t timestamp; // PIOS_DELAY_GetuS() at the sample
 } PIOS_SENSORS_1Axis_SensorsWithTemp;
 
 /**
@@ -0,0 +1,60 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios_simstep.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Lock-step simulation server of the posix targets.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PIOS_SIMSTEP_H
+#define PIOS_SIMSTEP_H
+
+/*
+ * A simulation drives the firmware ticks with step requests, one UDP datagram
+ * each. The first step request stops the free running ticks, a release request
+ * gives them back. Every request is answered once done, with the same message
+ * holding the firmware time.
+ */
+#define PIOS_SIMSTEP_MAGIC 0x5353504f /* "OPSS" */
+
+enum pios_simstep_command {
+    PIOS_SIMSTEP_CMD_STEP    = 1,
+    PIOS_SIMSTEP_CMD_RELEASE = 2,
+};
+
+struct pios_simstep_msg {
+    uint32_t magic;
+    uint32_t command;
+    /* ticks to run */
+    uint32_t ticks;
+    /* wall time the tasks get after each tick, 0 keeps the current one */
+    uint32_t slice_us;
+    /* firmware time after the step, set in the answer */
+    uint64_t time_us;
+} __attribute__((packed));
+
+struct pios_simstep_cfg {
+    const char *ip;
+    uint16_t   port;
+};
+
+extern int32_t PIOS_SIMSTEP_Init(const struct pios_simstep_cfg *cfg);
+
+#endif /* PIOS_SIMSTEP_H */
@@ -42,6 +42,32 @@ typedef enum {
     PIOS_SPI_PRESCALER_256 = 7
 } SPIPrescalerTypeDef;
 
+/* One DMA transfer of a transaction */
+struct pios_spi_segment {
+    const uint8_t *send_buffer; /* NULL sends 0xff */
+    uint8_t *receive_buffer; /* NULL discards */
+    uint16_t len;
+};
+
+/*
+ * Queued transaction: the slave is selected for the whole chain of segments,
+ * which are transferred by DMA at the given clock speed. The callback runs in
+ * the DMA interrupt once the slave has been deselected, result is 0 on success
+ * or -4 on a CRC error. The descriptor and its buffers, which must be DMA
+ * reachable, belong to the queue until then, next and segment are used by it.
+ */
+struct pios_spi_transaction {
+    uint32_t slave_id;
+    SPIPrescalerTypeDef prescaler;
+    const struct pios_spi_segment *segments;
+    uint8_t  segment_count;
+    void     (*callback)(struct pios_spi_transaction *transaction, int32_t result, bool *woken);
+    void     *context;
+
+    struct pios_spi_transaction *next;
+    uint8_t  segment;
+};
+
 /* Public Functions */
 extern int32_t PIOS_SPI_SetClockSpeed(uint32_t spi_id, SPIPrescalerTypeDef spi_prescaler);
 extern int32_t PIOS_SPI_RC_PinSet(uint32_t spi_id, uint32_t slave_id, uint8_t pin_value);
@@ -55,6 +81,13 @@ extern int32_t PIOS_SPI_ReleaseBusISR(uint32_t spi_id, bool *woken);
 extern void    PIOS_SPI_IRQ_Handler(uint32_t spi_id);
 extern void    PIOS_SPI_SetPrescalar(uint32_t spi_id, uint32_t prescalar);
 
+#if defined(STM32F4XX) && defined(PIOS_INCLUDE_FREERTOS)
+/* The transaction queue is available */
+#define PIOS_SPI_TRANSACTIONS
+extern int32_t PIOS_SPI_SubmitTransaction(uint32_t spi_id, struct pios_spi_transaction *transaction);
+extern int32_t PIOS_SPI_SubmitTransactionISR(uint32_t spi_id, struct pios_spi_transaction *transaction, bool *woken);
+#endif
+
 #endif /* PIOS_SPI_H */
 
 /**
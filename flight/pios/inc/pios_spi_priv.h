@@ -54,6 +54,10 @@ struct pios_spi_dev {
     uint8_t rx_dummy_byte;
 #if defined(PIOS_INCLUDE_FREERTOS)
     xSemaphoreHandle busy;
+    /* transaction queue, the head is the one on the bus while queue_running */
+    struct pios_spi_transaction *queue_head;
+    struct pios_spi_transaction *queue_tail;
+    volatile bool queue_running;
 #else
     uint8_t busy;
 #endif
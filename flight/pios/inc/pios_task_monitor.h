@@ -83,7 +83,13 @@ struct pios_task_info {
     /** Percentage of cpu time used by the task since the last call
      *  to PIOS_TASK_MONITOR_ForEachTask(). Low-load tasks may
      *  report 0% load even though they have run during the interval. */
-    uint8_t running_time_percentage;
+    uint8_t  running_time_percentage;
+    /** Same as running_time_percentage, down to a run time counter tick. */
+    float    cpu_load;
+    /** Longest single run of the task in the interval in microseconds. */
+    uint32_t max_run_time_us;
+    /** Times the task was switched in per second during the interval. */
+    uint32_t context_switch_rate;
 };
 
 /**
@@ -104,6 +110,14 @@ typedef void (*TaskMonitorTaskInfoCallback)(uint16_t task_id, const struct pios_
  */
 extern void PIOS_TASK_MONITOR_ForEachTask(TaskMonitorTaskInfoCallback callback, void *context);
 
+/**
+ * Return the id of the running task, from a task or an interrupt it preempted.
+ * Looks the task up without locking, as the task table only changes on task creation.
+ *
+ * @return the task id, or -1 if the task is not registered.
+ */
+extern int16_t PIOS_TASK_MONITOR_GetCurrentTaskId();
+
 /**
  * Return the idle task running time percentage.
  */
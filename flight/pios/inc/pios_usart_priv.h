@@ -38,6 +38,28 @@
 
 extern const struct pios_com_driver pios_usart_com_driver;
 
+#if defined(STM32F4XX)
+#ifndef PIOS_USART_DMA_RX_BUFFER_LEN
+#define PIOS_USART_DMA_RX_BUFFER_LEN 64
+#endif
+#ifndef PIOS_USART_DMA_TX_BUFFER_LEN
+#define PIOS_USART_DMA_TX_BUFFER_LEN 64
+#endif
+
+/*
+ * Optional DMA streams of a port. RX runs circular and is drained on line idle,
+ * half and full transfer, TX sends whatever the COM tx fifo holds in one transfer.
+ * The board routes both stream IRQs to PIOS_USART_DMA_IRQ_Handler(), at the
+ * same preemption priority.
+ */
+struct pios_usart_dma_cfg {
+    struct stm32_dma_chan rx;
+    struct stm32_irq rx_irq; /* flags: HTIFx | TCIFx of the rx stream */
+    struct stm32_dma_chan tx;
+    struct stm32_irq tx_irq; /* flags: TCIFx of the tx stream */
+};
+#endif /* STM32F4XX */
+
 struct pios_usart_cfg {
     USART_TypeDef     *regs;
     uint32_t remap; /* GPIO_Remap_* */
@@ -45,10 +67,16 @@ struct pios_usart_cfg {
     struct stm32_gpio rx;
     struct stm32_gpio tx;
     struct stm32_irq  irq;
+#if defined(STM32F4XX)
+    const struct pios_usart_dma_cfg *dma; /* NULL for per byte interrupts */
+#endif
 };
 
 extern int32_t PIOS_USART_Init(uint32_t *usart_id, const struct pios_usart_cfg *cfg);
 extern const struct pios_usart_cfg *PIOS_USART_GetConfig(uint32_t usart_id);
+#if defined(STM32F4XX)
+extern void PIOS_USART_DMA_IRQ_Handler(USART_TypeDef *regs);
+#endif
 
 #endif /* PIOS_USART_PRIV_H */
 
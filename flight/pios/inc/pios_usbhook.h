@@ -64,6 +64,8 @@ typedef bool (*pios_usbhook_epcb)(uint32_t context, uint8_t epnum, uint16_t len)
 
 extern void PIOS_USBHOOK_RegisterEpInCallback(uint8_t epnum, uint16_t max_len, pios_usbhook_epcb cb, uint32_t context);
 extern void PIOS_USBHOOK_RegisterEpOutCallback(uint8_t epnum, uint16_t max_len, pios_usbhook_epcb cb, uint32_t context);
+extern void PIOS_USBHOOK_RegisterEpInBulkCallback(uint8_t epnum, uint16_t max_packet, uint16_t max_len, pios_usbhook_epcb cb, uint32_t context);
+extern void PIOS_USBHOOK_RegisterEpOutBulkCallback(uint8_t epnum, uint16_t max_packet, uint16_t max_len, pios_usbhook_epcb cb, uint32_t context);
 extern void PIOS_USBHOOK_DeRegisterEpInCallback(uint8_t epnum);
 extern void PIOS_USBHOOK_DeRegisterEpOutCallback(uint8_t epnum);
 
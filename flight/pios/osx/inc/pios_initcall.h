@@ -52,6 +52,7 @@ extern void InitModules();
 extern void StartModules();
 
 #define MODULE_INITCALL(ifn, sfn)
+#define MODULE_INITCALL_PARALLEL(ifn, sfn)
 
 #define MODULE_TASKCREATE_ALL \
     { \
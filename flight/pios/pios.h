@@ -257,8 +257,10 @@ extern "C" {
 
 #ifdef PIOS_INCLUDE_SDCARD
 /* #define LOG_FILENAME "startup.log" */
+/* #define PIOS_USE_DEBUGLOG_ON_SDCARD */
 #include <dosfs.h>
 #include <pios_sdcard.h>
+#include <pios_sdlog.h>
 #endif
 
 #ifdef PIOS_INCLUDE_FLASH
@@ -60,6 +60,8 @@ struct pios_com_dev {
 
     t_fifo_buffer rx;
     t_fifo_buffer tx;
+
+    uint32_t rx_time; // PIOS_DELAY_GetuS() when bytes were last put in the rx fifo
 };
 
 static bool PIOS_COM_validate(struct pios_com_dev *com_dev)
@@ -219,6 +221,7 @@ static uint16_t PIOS_COM_RxInCallback(uint32_t context, uint8_t *buf, uint16_t b
 
     if (bytes_into_fifo > 0) {
         /* Data has been added to the buffer */
+        com_dev->rx_time = PIOS_DELAY_GetuS();
         PIOS_COM_UnblockRx(com_dev, need_yield);
     }
 
@@ -504,6 +507,22 @@ check_again:
     return bytes_from_fifo;
 }
 
+/**
+ * Time the driver last delivered received bytes.
+ * \param[in] com_id COM port
+ * \return PIOS_DELAY_GetuS() at the last delivery, 0 if nothing was received yet
+ */
+uint32_t PIOS_COM_GetRxTime(uint32_t com_id)
+{
+    struct pios_com_dev *com_dev = PIOS_COM_find_dev(com_id);
+
+    if (!PIOS_COM_validate(com_dev)) {
+        return 0;
+    }
+
+    return com_dev->rx_time;
+}
+
 /**
  * Query if a com port is available for use.  That can be
  * used to check a link is established even if the device
@@ -103,12 +103,20 @@ int32_t PIOS_DELAY_WaitmS(uint32_t mS)
 
 /**
  * @brief Query the Delay timer for the current uS
+ * In lock-step with a simulation the time follows the stepped ticks, not the wall time
  * @return A microsecond value
  */
 uint32_t PIOS_DELAY_GetuS()
 {
     static struct timespec current;
 
+#if defined(PIOS_INCLUDE_FREERTOS)
+    unsigned long long stepped;
+    if (xPortGetSteppedTime(&stepped)) {
+        return (uint32_t)stepped;
+    }
+#endif /* PIOS_INCLUDE_FREERTOS */
+
     clock_gettime(CLOCK_REALTIME, &current);
     return (current.tv_sec * 1000000) + (current.tv_nsec / 1000);
 }
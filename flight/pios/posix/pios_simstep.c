@@ -0,0 +1,110 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios_simstep.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Lock-step simulation server, steps the FreeRTOS ticks on request.
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   PIOS_SIMSTEP Lock-step simulation Functions
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/* Project Includes */
+#include "pios.h"
+
+#if defined(PIOS_INCLUDE_SIMSTEP)
+
+#include <pthread.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+static int simstep_socket = -1;
+static pthread_t simstep_thread;
+
+/**
+ * Serve the step requests. This is a plain thread, not a task: it waits for
+ * the ticks it grants, which a task could not do.
+ */
+static void *PIOS_SIMSTEP_Thread(__attribute__((unused)) void *param)
+{
+    struct pios_simstep_msg msg;
+    struct sockaddr_in client;
+    socklen_t client_length;
+
+    while (1) {
+        client_length = sizeof(client);
+        ssize_t received = recvfrom(simstep_socket, &msg, sizeof(msg), 0,
+                                    (struct sockaddr *)&client, &client_length);
+        if (received != sizeof(msg) || msg.magic != PIOS_SIMSTEP_MAGIC) {
+            continue;
+        }
+
+        switch (msg.command) {
+        case PIOS_SIMSTEP_CMD_STEP:
+            vPortSetSteppedTicks(pdTRUE, msg.slice_us);
+            vPortStepTicks(msg.ticks);
+            break;
+        case PIOS_SIMSTEP_CMD_RELEASE:
+            vPortSetSteppedTicks(pdFALSE, 0);
+            break;
+        default:
+            continue;
+        }
+
+        unsigned long long time_us;
+        if (!xPortGetSteppedTime(&time_us)) {
+            time_us = PIOS_DELAY_GetuS();
+        }
+        msg.time_us = time_us;
+        sendto(simstep_socket, &msg, sizeof(msg), 0, (struct sockaddr *)&client, client_length);
+    }
+
+    return NULL;
+}
+
+/**
+ * Open the step request socket
+ * \return 0 on success, -1 if the socket can't be bound
+ */
+int32_t PIOS_SIMSTEP_Init(const struct pios_simstep_cfg *cfg)
+{
+    struct sockaddr_in server;
+
+    simstep_socket = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    memset(&server, 0, sizeof(server));
+    server.sin_family = AF_INET;
+    server.sin_addr.s_addr = inet_addr(cfg->ip);
+    server.sin_port = htons(cfg->port);
+    if (simstep_socket < 0 || bind(simstep_socket, (struct sockaddr *)&server, sizeof(server)) < 0) {
+        printf("simstep - can't bind port %u\n", cfg->port);
+        return -1;
+    }
+
+    pthread_create(&simstep_thread, NULL, PIOS_SIMSTEP_Thread, NULL);
+    printf("simstep - lock-step requests on port %u\n", cfg->port);
+
+    return 0;
+}
+
+#endif /* PIOS_INCLUDE_SIMSTEP */
+
+/**
+ * @}
+ */
@@ -59,5 +59,7 @@ ifneq ($(FREERTOS_DIR),)
     FREERTOS_PORTDIR	:= $(FREERTOS_DIR)
     SRC				+= $(sort $(wildcard $(FREERTOS_PORTDIR)/portable/GCC/ARM_CM4F/*.c))
     EXTRAINCDIRS	+= $(FREERTOS_PORTDIR)/portable/GCC/ARM_CM4F
-    include $(PIOSCOMMON)/libraries/msheap/library.mk
+    # heap allocator, tlsf (constant time) or msheap
+    PIOS_HEAP		?= tlsf
+    include $(PIOSCOMMON)/libraries/$(PIOS_HEAP)/library.mk
 endif
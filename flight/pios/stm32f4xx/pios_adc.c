@@ -30,16 +30,17 @@
 
 /*
  * @note This is a stripped-down ADC driver intended primarily for sampling
- * voltage and current values.  Samples are averaged over the period between
- * fetches so that relatively accurate measurements can be obtained without
- * forcing higher-level logic to poll aggressively.
+ * voltage and current values.  The configured pins are scanned continuously
+ * by DMA into a double buffer, and every completed half is folded into per pin
+ * totals from the DMA interrupt, so no reader ever waits for a conversion:
  *
- * @todo This module needs more work to be more generally useful.  It should
- * almost certainly grow callback support so that e.g. voltage and current readings
- * can be shipped out for coulomb counting purposes.  The F1xx interface presumes
- * use with analog sensors, but that implementation largely dominates the ADC
- * resources.  Rather than commit to a new API without a defined use case, we
- * should stick to our lightweight subset until we have a better idea of what's needed.
+ * - PIOS_ADC_PinGet() averages the samples taken since the previous call,
+ *   so relatively accurate measurements can be obtained without forcing
+ *   higher-level logic to poll aggressively.
+ * - PIOS_ADC_PinGetStats() returns a low passed value with the time of the
+ *   block it was taken from, and a never cleared sum of the samples above a
+ *   pin offset.  The sum is built at the ADC rate, so consumers can integrate
+ *   e.g. a current sensor into consumed mAh without aliasing their own period.
  */
 
 #include "pios.h"
@@ -65,6 +66,14 @@
 #define PIOS_ADC_NUM_CHANNELS     0
 #endif
 
+/* Low pass of the per block averages as a shift: 1/64 gives ~13ms at the Revolution block rate */
+#if !defined(PIOS_ADC_FILTER_SHIFT)
+#define PIOS_ADC_FILTER_SHIFT     6
+#endif
+
+/* Fractional bits kept by the low pass */
+#define PIOS_ADC_FILTER_FRAC_BITS 8
+
 // Private types
 enum pios_adc_dev_magic {
     PIOS_ADC_DEV_MAGIC = 0x58375124,
@@ -108,6 +117,12 @@ struct dma_config {
 struct adc_accumulator {
     uint32_t accumulator;
     uint32_t count;
+    int32_t  filtered; /* low passed block average, PIOS_ADC_FILTER_FRAC_BITS fraction */
+    uint32_t offset; /* samples are integrated above this */
+    uint64_t positive; /* sum of (sample - offset), clamped to 0 per block */
+    uint32_t samples; /* number of samples that went into positive */
+    uint32_t timestamp; /* PIOS_DELAY raw time of the last block */
+    bool     sampled; /* a block has been taken */
 };
 
 #if defined(PIOS_INCLUDE_ADC)
@@ -294,36 +309,88 @@ void PIOS_ADC_Config(__attribute__((unused)) uint32_t oversampling)
 /**
  * Returns value of an ADC Pin
  * @param[in] pin number
- * @return ADC pin value averaged over the set of samples since the last reading.
+ * @return ADC pin value averaged over the set of samples since the last reading,
+ * or the filtered value if no block completed since then.
  * @return -1 if pin doesn't exist
- * @return -2 if no data acquired since last read
+ * @return -2 if the pin has not been sampled yet
  */
 int32_t last_conv_value;
 int32_t PIOS_ADC_PinGet(uint32_t pin)
 {
 #if defined(PIOS_INCLUDE_ADC)
-    int32_t result;
+    uint32_t sum;
+    uint32_t count;
 
     /* Check if pin exists */
     if (pin >= PIOS_ADC_NUM_PINS) {
         return -1;
     }
 
-    if (accumulator[pin].accumulator <= 0) {
-        return -2;
+    /* take the samples accumulated since the last read, the DMA interrupt adds to them */
+    PIOS_IRQ_Disable();
+    sum   = accumulator[pin].accumulator;
+    count = accumulator[pin].count;
+    accumulator[pin].accumulator = 0;
+    accumulator[pin].count = 0;
+    PIOS_IRQ_Enable();
+
+    if (count == 0) {
+        /* nothing new, fall back to the filtered value rather than failing */
+        if (!accumulator[pin].sampled) {
+            return -2;
+        }
+        return accumulator[pin].filtered >> PIOS_ADC_FILTER_FRAC_BITS;
     }
 
-    /* return accumulated result and clear accumulator */
-    result = accumulator[pin].accumulator / (accumulator[pin].count ? : 1);
-    accumulator[pin].accumulator = result;
-    accumulator[pin].count = 1;
-
-    return result;
+    return sum / count;
 
 #endif
     return -1;
 }
 
+/**
+ * Returns the filtered value and running integral of an ADC Pin
+ * @param[in] pin number
+ * @param[out] stats filled in with the pin state as of the last DMA block
+ * @return true on success, false if the pin doesn't exist or has not been sampled yet
+ */
+bool PIOS_ADC_PinGetStats(uint32_t pin, struct pios_adc_pin_stats *stats)
+{
+#if defined(PIOS_INCLUDE_ADC)
+    if (pin >= PIOS_ADC_NUM_PINS) {
+        return false;
+    }
+
+    /* the 64 bit sum is not updated atomically */
+    PIOS_IRQ_Disable();
+    stats->filtered  = (float)accumulator[pin].filtered * (1.0f / (1 << PIOS_ADC_FILTER_FRAC_BITS));
+    stats->positive  = accumulator[pin].positive;
+    stats->samples   = accumulator[pin].samples;
+    stats->timestamp = accumulator[pin].timestamp;
+    PIOS_IRQ_Enable();
+
+    return accumulator[pin].sampled;
+
+#else
+    return false;
+
+#endif
+}
+
+/**
+ * Sets the offset above which the samples of a pin are integrated
+ * @param[in] pin number
+ * @param[in] offset in ADC counts, e.g. the zero current point of a current sensor
+ */
+void PIOS_ADC_PinSetOffset(uint32_t pin, uint16_t offset)
+{
+#if defined(PIOS_INCLUDE_ADC)
+    if (pin < PIOS_ADC_NUM_PINS) {
+        accumulator[pin].offset = offset;
+    }
+#endif
+}
+
 float PIOS_ADC_PinGetVolt(uint32_t pin)
 {
     return ((float)PIOS_ADC_PinGet(pin)) * PIOS_ADC_VOLTAGE_SCALE;
@@ -396,24 +463,48 @@ void PIOS_ADC_SetFIRCoefficients(__attribute__((unused)) float *new_filter)
 void accumulate(uint16_t *buffer, uint32_t count)
 {
 #if defined(PIOS_INCLUDE_ADC)
+    uint32_t block[PIOS_ADC_NUM_PINS] = { 0 };
+    uint32_t now = PIOS_DELAY_GetRaw();
     uint16_t *sp = buffer;
 
     /*
-     * Accumulate sampled values.
+     * Sum the block per pin first, it is small enough not to overflow, so
+     * the bookkeeping below only runs once per pin and block.
      */
-    while (count--) {
+    for (uint32_t n = 0; n < count; ++n) {
         for (uint32_t i = 0; i < PIOS_ADC_NUM_PINS; ++i) {
-            accumulator[i].accumulator += *sp++;
-            accumulator[i].count++;
-            /*
-             * If the accumulator reaches half-full, rescale in order to
-             * make more space.
-             */
-            if (accumulator[i].accumulator >= (((uint32_t)1) << 31)) {
-                accumulator[i].accumulator /= 2;
-                accumulator[i].count /= 2;
-            }
+            block[i] += *sp++;
+        }
+    }
+
+    for (uint32_t i = 0; i < PIOS_ADC_NUM_PINS; ++i) {
+        struct adc_accumulator *acc = &accumulator[i];
+
+        acc->accumulator += block[i];
+        acc->count += count;
+        /*
+         * If the accumulator reaches half-full, rescale in order to
+         * make more space.
+         */
+        if (acc->accumulator >= (((uint32_t)1) << 31)) {
+            acc->accumulator /= 2;
+            acc->count /= 2;
+        }
+
+        int32_t average = (int32_t)((block[i] << PIOS_ADC_FILTER_FRAC_BITS) / count);
+        if (!acc->sampled) {
+            acc->filtered = average;
+            acc->sampled  = true;
+        } else {
+            acc->filtered += (average - acc->filtered) >> PIOS_ADC_FILTER_SHIFT;
+        }
+
+        uint32_t zero = acc->offset * count;
+        if (block[i] > zero) {
+            acc->positive += block[i] - zero;
         }
+        acc->samples  += count;
+        acc->timestamp = now;
     }
 
 #if defined(PIOS_INCLUDE_FREERTOS)
@@ -40,16 +40,26 @@
 
 /* Forward Declarations */
 static int32_t PIOS_DSM_Get(uint32_t rcvr_id, uint8_t channel);
+static uint8_t PIOS_DSM_Get_All(uint32_t rcvr_id, int32_t *channels, uint8_t num_channels);
 static uint16_t PIOS_DSM_RxInCallback(uint32_t context,
                                       uint8_t *buf,
                                       uint16_t buf_len,
                                       uint16_t *headroom,
                                       bool *need_yield);
 static void PIOS_DSM_Supervisor(uint32_t dsm_id);
+#if defined(PIOS_INCLUDE_FREERTOS)
+static xSemaphoreHandle PIOS_DSM_Get_Semaphore(uint32_t rcvr_id, uint8_t channel);
+#endif
+static uint32_t PIOS_DSM_Get_Frame_Time(uint32_t rcvr_id);
 
 /* Local Variables */
 const struct pios_rcvr_driver pios_dsm_rcvr_driver = {
-    .read = PIOS_DSM_Get,
+    .read           = PIOS_DSM_Get,
+    .read_all       = PIOS_DSM_Get_All,
+#if defined(PIOS_INCLUDE_FREERTOS)
+    .get_semaphore  = PIOS_DSM_Get_Semaphore,
+#endif
+    .get_frame_time = PIOS_DSM_Get_Frame_Time,
 };
 
 enum pios_dsm_dev_magic {
@@ -63,6 +73,7 @@ struct pios_dsm_state {
     uint8_t  failsafe_timer;
     uint8_t  frame_found;
     uint8_t  byte_count;
+    volatile uint32_t frame_time;
 #ifdef DSM_LOST_FRAME_COUNTER
     uint8_t  frames_lost_last;
     uint16_t frames_lost;
@@ -73,6 +84,9 @@ struct pios_dsm_dev {
     enum pios_dsm_dev_magic   magic;
     const struct pios_dsm_cfg *cfg;
     struct pios_dsm_state     state;
+#if defined(PIOS_INCLUDE_FREERTOS)
+    xSemaphoreHandle new_frame_semaphore;
+#endif
 };
 
 /* Allocate DSM device descriptor */
@@ -86,6 +100,7 @@ static struct pios_dsm_dev *PIOS_DSM_Alloc(void)
         return NULL;
     }
 
+    dsm_dev->new_frame_semaphore = 0;
     dsm_dev->magic = PIOS_DSM_DEV_MAGIC;
     return dsm_dev;
 }
@@ -167,6 +182,7 @@ static void PIOS_DSM_ResetState(struct pios_dsm_dev *dsm_dev)
     state->receive_timer    = 0;
     state->failsafe_timer   = 0;
     state->frame_found      = 0;
+    state->frame_time       = 0;
 #ifdef DSM_LOST_FRAME_COUNTER
     state->frames_lost_last = 0;
     state->frames_lost      = 0;
@@ -253,10 +269,14 @@ stream_error:
     return -1;
 }
 
-/* Update decoder state processing input byte from the DSMx stream */
-static void PIOS_DSM_UpdateState(struct pios_dsm_dev *dsm_dev, uint8_t byte)
+/**
+ * Update decoder state processing input byte from the DSMx stream
+ * \output true if a new frame was accepted into channel_data[]
+ */
+static bool PIOS_DSM_UpdateState(struct pios_dsm_dev *dsm_dev, uint8_t byte)
 {
     struct pios_dsm_state *state = &(dsm_dev->state);
+    bool new_frame = false;
 
     if (state->frame_found) {
         /* receiving the data frame */
@@ -268,6 +288,8 @@ static void PIOS_DSM_UpdateState(struct pios_dsm_dev *dsm_dev, uint8_t byte)
                 if (!PIOS_DSM_UnrollChannels(dsm_dev)) {
                     /* data looking good */
                     state->failsafe_timer = 0;
+                    state->frame_time     = PIOS_DELAY_GetRaw();
+                    new_frame = true;
                 }
 
                 /* prepare for the next frame */
@@ -275,6 +297,8 @@ static void PIOS_DSM_UpdateState(struct pios_dsm_dev *dsm_dev, uint8_t byte)
             }
         }
     }
+
+    return new_frame;
 }
 
 /* Initialise DSM receiver interface */
@@ -330,9 +354,11 @@ static uint16_t PIOS_DSM_RxInCallback(uint32_t context,
 
     PIOS_Assert(valid);
 
+    bool new_frame = false;
+
     /* process byte(s) and clear receive timer */
     for (uint8_t i = 0; i < buf_len; i++) {
-        PIOS_DSM_UpdateState(dsm_dev, buf[i]);
+        new_frame |= PIOS_DSM_UpdateState(dsm_dev, buf[i]);
         dsm_dev->state.receive_timer = 0;
     }
 
@@ -341,8 +367,15 @@ static uint16_t PIOS_DSM_RxInCallback(uint32_t context,
         *headroom = DSM_FRAME_LENGTH;
     }
 
-    /* We never need a yield */
+    /* Wake up the receiver task as soon as the frame is complete */
     *need_yield = false;
+#if defined(PIOS_INCLUDE_FREERTOS)
+    if (new_frame && dsm_dev->new_frame_semaphore != 0) {
+        signed portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+        xSemaphoreGiveFromISR(dsm_dev->new_frame_semaphore, &xHigherPriorityTaskWoken);
+        *need_yield = (xHigherPriorityTaskWoken == pdTRUE);
+    }
+#endif
 
     /* Always indicate that all bytes were consumed */
     return buf_len;
@@ -372,6 +405,70 @@ static int32_t PIOS_DSM_Get(uint32_t rcvr_id, uint8_t channel)
     return dsm_dev->state.channel_data[channel];
 }
 
+/**
+ * Get the values of the first input channels of the last frame
+ * \param[out] channels values of the channels, PIOS_RCVR_INVALID past the inputs
+ * \param[in] num_channels number of channels to read (zero based)
+ * \output number of channels available
+ */
+static uint8_t PIOS_DSM_Get_All(uint32_t rcvr_id, int32_t *channels, uint8_t num_channels)
+{
+    struct pios_dsm_dev *dsm_dev = (struct pios_dsm_dev *)rcvr_id;
+
+    if (!PIOS_DSM_Validate(dsm_dev)) {
+        return 0;
+    }
+
+    uint8_t available = (num_channels < PIOS_DSM_NUM_INPUTS) ? num_channels : PIOS_DSM_NUM_INPUTS;
+    uint32_t frame_time;
+
+    /* copy again if a frame was decoded in the meantime, so that all channels come from the same one */
+    do {
+        frame_time = dsm_dev->state.frame_time;
+        for (uint8_t i = 0; i < available; i++) {
+            channels[i] = dsm_dev->state.channel_data[i];
+        }
+    } while (frame_time != dsm_dev->state.frame_time);
+
+    for (uint8_t i = available; i < num_channels; i++) {
+        channels[i] = PIOS_RCVR_INVALID;
+    }
+    return available;
+}
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+/**
+ * Get the semaphore given on every new frame, the same for all channels
+ */
+static xSemaphoreHandle PIOS_DSM_Get_Semaphore(uint32_t rcvr_id, __attribute__((unused)) uint8_t channel)
+{
+    struct pios_dsm_dev *dsm_dev = (struct pios_dsm_dev *)rcvr_id;
+
+    if (!PIOS_DSM_Validate(dsm_dev)) {
+        return 0;
+    }
+
+    if (dsm_dev->new_frame_semaphore == 0) {
+        vSemaphoreCreateBinary(dsm_dev->new_frame_semaphore);
+    }
+    return dsm_dev->new_frame_semaphore;
+}
+#endif /* if defined(PIOS_INCLUDE_FREERTOS) */
+
+/**
+ * Get the time the last good frame was received, 0 if none
+ */
+static uint32_t PIOS_DSM_Get_Frame_Time(uint32_t rcvr_id)
+{
+    struct pios_dsm_dev *dsm_dev = (struct pios_dsm_dev *)rcvr_id;
+
+    if (!PIOS_DSM_Validate(dsm_dev)) {
+        return 0;
+    }
+
+    return dsm_dev->state.frame_time;
+}
+
 /**
  * Input data supervisor is called periodically and provides
  * two functions: frame syncing and failsafe triggering.
@@ -159,7 +159,11 @@ static bool i2c_adapter_wait_for_stopped(struct pios_i2c_adapter *i2c_adapter);
 static void i2c_adapter_reset_bus(struct pios_i2c_adapter *i2c_adapter);
 
 static void i2c_adapter_log_fault(enum pios_i2c_error_type type);
-static bool i2c_adapter_callback_handler(struct pios_i2c_adapter *i2c_adapter);
+#ifdef PIOS_I2C_TRANSACTIONS
+static bool i2c_adapter_queue_run(struct pios_i2c_adapter *i2c_adapter);
+static void i2c_adapter_queue_service(void *context, uint32_t unused);
+static void i2c_adapter_queue_timer(xTimerHandle timer);
+#endif
 
 static const struct i2c_adapter_transition i2c_adapter_transitions[I2C_STATE_NUM_STATES] = {
     [I2C_STATE_FSM_FAULT] =             {
@@ -417,6 +421,20 @@ static void go_stopping(struct pios_i2c_adapter *i2c_adapter)
 
     I2C_ITConfig(i2c_adapter->cfg->regs, I2C_IT_EVT | I2C_IT_BUF | I2C_IT_ERR, DISABLE);
 
+#ifdef PIOS_I2C_TRANSACTIONS
+    if (i2c_adapter->queue_running) {
+        /*
+         * Queued transaction, nobody is waiting on sem_ready. The timer task
+         * waits for the stop condition and calls back, the periodic timer
+         * picks it up should the timer queue be full.
+         */
+        i2c_adapter->queue_stopping = true;
+        xTimerPendFunctionCallFromISR(i2c_adapter_queue_service, i2c_adapter, 0, &pxHigherPriorityTaskWoken);
+        portEND_SWITCHING_ISR(pxHigherPriorityTaskWoken);
+        return;
+    }
+#endif /* PIOS_I2C_TRANSACTIONS */
+
 #ifdef USE_FREERTOS
     if (xSemaphoreGiveFromISR(i2c_adapter->sem_ready, &pxHigherPriorityTaskWoken) != pdTRUE) {
 #if defined(I2C_HALT_ON_ERRORS)
@@ -425,10 +443,6 @@ static void go_stopping(struct pios_i2c_adapter *i2c_adapter)
     }
     portEND_SWITCHING_ISR(pxHigherPriorityTaskWoken); /* FIXME: is this the right place for this? */
 #endif /* USE_FREERTOS */
-
-    if (i2c_adapter->callback) {
-        i2c_adapter_callback_handler(i2c_adapter);
-    }
 }
 
 static void go_stopped(struct pios_i2c_adapter *i2c_adapter)
@@ -816,60 +830,6 @@ static bool i2c_adapter_fsm_terminated(struct pios_i2c_adapter *i2c_adapter)
     }
 }
 
-uint32_t i2c_cb_count = 0;
-static bool i2c_adapter_callback_handler(struct pios_i2c_adapter *i2c_adapter)
-{
-    bool semaphore_success = true;
-
-    /* Wait for the transfer to complete */
-#ifdef USE_FREERTOS
-    portTickType timeout;
-    timeout = i2c_adapter->cfg->transfer_timeout_ms / portTICK_RATE_MS;
-    semaphore_success &= (xSemaphoreTake(i2c_adapter->sem_ready, timeout) == pdTRUE);
-    xSemaphoreGive(i2c_adapter->sem_ready);
-#endif /* USE_FREERTOS */
-
-    /* transfer_timeout_ticks is set by PIOS_I2C_Transfer_Callback */
-    /* Spin waiting for the transfer to finish */
-    while (!i2c_adapter_fsm_terminated(i2c_adapter)) {
-        // sleep 1 byte, as FSM can't be faster
-        // FIXME: clock stretching could make problems, but citing NPX: alsmost no slave device implements clock stretching
-        // three times the expected time should cover clock delay
-        PIOS_DELAY_WaituS(i2c_adapter->transfer_delay_uS);
-
-        i2c_adapter->transfer_timeout_ticks--;
-        if (i2c_adapter->transfer_timeout_ticks == 0) {
-            break;
-        }
-    }
-
-    if (i2c_adapter_wait_for_stopped(i2c_adapter)) {
-        i2c_adapter_inject_event(i2c_adapter, I2C_EVENT_STOPPED);
-    } else {
-        i2c_adapter_fsm_init(i2c_adapter);
-    }
-
-    // Execute user supplied function
-    i2c_adapter->callback();
-
-    i2c_cb_count++;
-
-#ifdef USE_FREERTOS
-    /* Unlock the bus */
-    xSemaphoreGive(i2c_adapter->sem_busy);
-    if (!semaphore_success) {
-        i2c_timeout_counter++;
-    }
-#else
-    PIOS_IRQ_Disable();
-    i2c_adapter->busy = 0;
-    PIOS_IRQ_Enable();
-#endif /* USE_FREERTOS */
-
-
-    return (!i2c_adapter->bus_error) && semaphore_success;
-}
-
 /**
  * Logs the last N state transitions and N IRQ events due to
  * an error condition
@@ -1000,6 +960,18 @@ int32_t PIOS_I2C_Init(uint32_t *i2c_id, const struct pios_i2c_adapter_cfg *cfg)
     /* Initialize the state machine */
     i2c_adapter_fsm_init(i2c_adapter);
 
+#ifdef PIOS_I2C_TRANSACTIONS
+    /* A transaction waiting in the queue hands the bus over on this */
+    vSemaphoreCreateBinary(i2c_adapter->sem_queue_idle);
+    /* Fails a queued transaction whose interrupts got lost */
+    i2c_adapter->queue_timer = xTimerCreate("I2C",
+                                            i2c_adapter->cfg->transfer_timeout_ms / portTICK_RATE_MS,
+                                            pdTRUE, i2c_adapter, i2c_adapter_queue_timer);
+    if (!i2c_adapter->queue_timer || xTimerStart(i2c_adapter->queue_timer, 0) != pdPASS) {
+        goto out_fail;
+    }
+#endif /* PIOS_I2C_TRANSACTIONS */
+
     *i2c_id = (uint32_t)i2c_adapter;
 
     /* Configure and enable I2C interrupts */
@@ -1031,7 +1003,36 @@ int32_t PIOS_I2C_Transfer(uint32_t i2c_id, const struct pios_i2c_txn txn_list[],
     /* Lock the bus */
     portTickType timeout;
     timeout = i2c_adapter->cfg->transfer_timeout_ms / portTICK_RATE_MS;
-    if (xSemaphoreTake(i2c_adapter->sem_busy, timeout) == pdFALSE) {
+#ifdef PIOS_I2C_TRANSACTIONS
+    /* Blocking transfers go before the queue */
+    PIOS_IRQ_Disable();
+    i2c_adapter->transfers_waiting++;
+    PIOS_IRQ_Enable();
+#endif
+    bool locked = (xSemaphoreTake(i2c_adapter->sem_busy, timeout) == pdTRUE);
+#ifdef PIOS_I2C_TRANSACTIONS
+    /* Wait for the queued transaction on the bus, if any */
+    while (locked) {
+        PIOS_IRQ_Disable();
+        if (!i2c_adapter->queue_running) {
+            i2c_adapter->transfer_running = true;
+            PIOS_IRQ_Enable();
+            break;
+        }
+        PIOS_IRQ_Enable();
+        if (xSemaphoreTake(i2c_adapter->sem_queue_idle, timeout) != pdTRUE) {
+            xSemaphoreGive(i2c_adapter->sem_busy);
+            locked = false;
+        }
+    }
+    PIOS_IRQ_Disable();
+    i2c_adapter->transfers_waiting--;
+    PIOS_IRQ_Enable();
+#endif /* PIOS_I2C_TRANSACTIONS */
+    if (!locked) {
+#ifdef PIOS_I2C_TRANSACTIONS
+        i2c_adapter_queue_run(i2c_adapter);
+#endif
         return -2;
     }
 #else
@@ -1063,7 +1064,6 @@ int32_t PIOS_I2C_Transfer(uint32_t i2c_id, const struct pios_i2c_txn txn_list[],
     // timeout if it takes eight times the expected time
     i2c_adapter->transfer_timeout_ticks <<= 3;
 
-    i2c_adapter->callback  = NULL;
     i2c_adapter->bus_error = false;
     i2c_adapter->nack = false;
     i2c_adapter_inject_event(i2c_adapter, I2C_EVENT_START);
@@ -1093,8 +1093,18 @@ int32_t PIOS_I2C_Transfer(uint32_t i2c_id, const struct pios_i2c_txn txn_list[],
         i2c_adapter_fsm_init(i2c_adapter);
     }
 
+    int32_t result = !semaphore_success ? -2 :
+                     i2c_adapter->bus_error ? -1 :
+                     i2c_adapter->nack ? -3 :
+                     0;
+
 #ifdef USE_FREERTOS
     /* Unlock the bus */
+#ifdef PIOS_I2C_TRANSACTIONS
+    PIOS_IRQ_Disable();
+    i2c_adapter->transfer_running = false;
+    PIOS_IRQ_Enable();
+#endif
     xSemaphoreGive(i2c_adapter->sem_busy);
     if (!semaphore_success) {
         i2c_timeout_counter++;
@@ -1105,13 +1115,42 @@ int32_t PIOS_I2C_Transfer(uint32_t i2c_id, const struct pios_i2c_txn txn_list[],
     PIOS_IRQ_Enable();
 #endif /* USE_FREERTOS */
 
-    return !semaphore_success ? -2 :
-           i2c_adapter->bus_error ? -1 :
-           i2c_adapter->nack ? -3 :
-           0;
+#ifdef PIOS_I2C_TRANSACTIONS
+    /* Queued transactions held back by this transfer */
+    i2c_adapter_queue_run(i2c_adapter);
+#endif
+
+    return result;
+}
+
+#ifdef PIOS_I2C_TRANSACTIONS
+/**
+ * Append a transaction to the queue
+ */
+static void i2c_adapter_queue_append(struct pios_i2c_adapter *i2c_adapter, struct pios_i2c_transaction *transaction)
+{
+    transaction->next = NULL;
+
+    PIOS_IRQ_Disable();
+    if (i2c_adapter->queue_tail) {
+        i2c_adapter->queue_tail->next = transaction;
+    } else {
+        i2c_adapter->queue_head = transaction;
+    }
+    i2c_adapter->queue_tail = transaction;
+    PIOS_IRQ_Enable();
 }
 
-int32_t PIOS_I2C_Transfer_Callback(uint32_t i2c_id, const struct pios_i2c_txn txn_list[], uint32_t num_txns, void *callback)
+/**
+ * Queue a transaction on the bus from a task. It runs once the transactions
+ * before it and any blocking transfer are done, and its callback is called
+ * from the timer task when it completes.
+ * \param[in] i2c_id I2C device handle
+ * \param[in] transaction descriptor, owned by the queue until its callback runs
+ * \return 0 if queued
+ * \return -1 if the adapter or the transaction is invalid
+ */
+int32_t PIOS_I2C_SubmitTransaction(uint32_t i2c_id, struct pios_i2c_transaction *transaction)
 {
     struct pios_i2c_adapter *i2c_adapter = (struct pios_i2c_adapter *)i2c_id;
 
@@ -1119,53 +1158,150 @@ int32_t PIOS_I2C_Transfer_Callback(uint32_t i2c_id, const struct pios_i2c_txn tx
         return -1;
     }
 
-    PIOS_Assert(callback);
+    if (!transaction || !transaction->txn_list || !transaction->num_txns) {
+        return -1;
+    }
 
-    PIOS_DEBUG_Assert(txn_list);
-    PIOS_DEBUG_Assert(num_txns);
+    i2c_adapter_queue_append(i2c_adapter, transaction);
+    i2c_adapter_queue_run(i2c_adapter);
 
-    bool semaphore_success = true;
+    return 0;
+}
 
-#ifdef USE_FREERTOS
-    /* Lock the bus */
-    portTickType timeout;
-    timeout = i2c_adapter->cfg->transfer_timeout_ms / portTICK_RATE_MS;
-    if (xSemaphoreTake(i2c_adapter->sem_busy, timeout) == pdFALSE) {
-        return -2;
+/**
+ * Queue a transaction from an interrupt or a transaction callback, see
+ * PIOS_I2C_SubmitTransaction()
+ * \param woken[in,out] If non-NULL, will be set to true if woken was false and a higher priority
+ *                      task has is now eligible to run, else unchanged
+ */
+int32_t PIOS_I2C_SubmitTransactionISR(uint32_t i2c_id, struct pios_i2c_transaction *transaction, __attribute__((unused)) bool *woken)
+{
+    struct pios_i2c_adapter *i2c_adapter = (struct pios_i2c_adapter *)i2c_id;
+
+    if (!PIOS_I2C_validate(i2c_adapter)) {
+        return -1;
     }
-#else
-    if (i2c_adapter->busy) {
+
+    if (!transaction || !transaction->txn_list || !transaction->num_txns) {
+        return -1;
+    }
+
+    i2c_adapter_queue_append(i2c_adapter, transaction);
+    i2c_adapter_queue_run(i2c_adapter);
+
+    return 0;
+}
+
+/**
+ * Put the head of the queue on the bus if nothing else holds it. A transfer
+ * or transaction that holds the bus runs the queue again once it is done, so
+ * nothing is left behind.
+ * \return false if there was nothing to start
+ */
+static bool i2c_adapter_queue_run(struct pios_i2c_adapter *i2c_adapter)
+{
+    PIOS_IRQ_Disable();
+    if (i2c_adapter->queue_running || i2c_adapter->transfer_running ||
+        i2c_adapter->transfers_waiting || !i2c_adapter->queue_head) {
         PIOS_IRQ_Enable();
-        return -2;
+        return false;
     }
-#endif /* USE_FREERTOS */
+
+    struct pios_i2c_transaction *transaction = i2c_adapter->queue_head;
 
     PIOS_DEBUG_Assert(i2c_adapter->curr_state == I2C_STATE_STOPPED);
 
-    i2c_adapter->first_txn  = &txn_list[0];
-    i2c_adapter->last_txn   = &txn_list[num_txns - 1];
-    i2c_adapter->active_txn = i2c_adapter->first_txn;
+    i2c_adapter->queue_running = true;
+    i2c_adapter->queue_start   = PIOS_DELAY_GetRaw();
+    i2c_adapter->first_txn     = &transaction->txn_list[0];
+    i2c_adapter->last_txn      = &transaction->txn_list[transaction->num_txns - 1];
+    i2c_adapter->active_txn    = i2c_adapter->first_txn;
+    i2c_adapter->bus_error     = false;
+    i2c_adapter->nack = false;
+    i2c_adapter_inject_event(i2c_adapter, I2C_EVENT_START);
+    PIOS_IRQ_Enable();
 
-#ifdef USE_FREERTOS
-    /* Make sure the done/ready semaphore is consumed before we start */
-    semaphore_success &= (xSemaphoreTake(i2c_adapter->sem_ready, timeout) == pdTRUE);
+    return true;
+}
+
+/**
+ * Take the transaction at the head of the queue off the bus and hand the bus
+ * to a blocking transfer waiting for it
+ */
+static struct pios_i2c_transaction *i2c_adapter_queue_retire(struct pios_i2c_adapter *i2c_adapter)
+{
+    PIOS_IRQ_Disable();
+    struct pios_i2c_transaction *transaction = i2c_adapter->queue_head;
+    i2c_adapter->queue_head = transaction->next;
+    if (!i2c_adapter->queue_head) {
+        i2c_adapter->queue_tail = NULL;
+    }
+    i2c_adapter->queue_running  = false;
+    i2c_adapter->queue_stopping = false;
+    PIOS_IRQ_Enable();
+
+    if (i2c_adapter->transfers_waiting) {
+        xSemaphoreGive(i2c_adapter->sem_queue_idle);
+    }
+
+    return transaction;
+}
+
+/**
+ * Completes the queued transaction on the bus, from the timer task. Pended by
+ * go_stopping() once the stop condition has been sent, and run by the
+ * periodic timer, which also fails a transaction that outlived the transfer
+ * timeout: it lost an interrupt, the bus is reset so the queue moves on.
+ * The callback is called from here, then the next transaction is started.
+ */
+static void i2c_adapter_queue_service(void *context, __attribute__((unused)) uint32_t unused)
+{
+    struct pios_i2c_adapter *i2c_adapter = (struct pios_i2c_adapter *)context;
+    int32_t result;
+
+    if (i2c_adapter->queue_stopping) {
+        result = i2c_adapter->bus_error ? -1 :
+                 i2c_adapter->nack ? -3 :
+                 0;
+
+        if (i2c_adapter_wait_for_stopped(i2c_adapter)) {
+            i2c_adapter_inject_event(i2c_adapter, I2C_EVENT_STOPPED);
+        } else {
+            i2c_adapter_fsm_init(i2c_adapter);
+            result = -1;
+        }
+    } else {
+        PIOS_IRQ_Disable();
+        /* A transaction completing right now is pended by go_stopping() */
+        if (!i2c_adapter->queue_running || i2c_adapter->queue_stopping ||
+            PIOS_DELAY_DiffuS(i2c_adapter->queue_start) < i2c_adapter->cfg->transfer_timeout_ms * 1000) {
+            PIOS_IRQ_Enable();
+            return;
+        }
+
+        i2c_adapter_fsm_init(i2c_adapter);
+        PIOS_IRQ_Enable();
+#if defined(PIOS_I2C_DIAGNOSTICS)
+        i2c_timeout_counter++;
 #endif
+        result = -2;
+    }
 
-    // used in the i2c_adapter_callback_handler function
-    // Estimate bytes of transmission. Per txns: 1 adress byte + length
-    i2c_adapter->transfer_timeout_ticks = num_txns;
-    for (uint32_t i = 0; i < num_txns; i++) {
-        i2c_adapter->transfer_timeout_ticks += txn_list[i].len;
+    struct pios_i2c_transaction *transaction = i2c_adapter_queue_retire(i2c_adapter);
+
+    if (transaction->callback) {
+        bool woken = false;
+        transaction->callback(transaction, result, &woken);
     }
-    // timeout if it takes eight times the expected time
-    i2c_adapter->transfer_timeout_ticks <<= 3;
 
-    i2c_adapter->callback  = callback;
-    i2c_adapter->bus_error = false;
-    i2c_adapter_inject_event(i2c_adapter, I2C_EVENT_START);
+    i2c_adapter_queue_run(i2c_adapter);
+}
 
-    return !semaphore_success ? -2 : 0;
+static void i2c_adapter_queue_timer(xTimerHandle timer)
+{
+    i2c_adapter_queue_service(pvTimerGetTimerID(timer), 0);
 }
+#endif /* PIOS_I2C_TRANSACTIONS */
 
 void PIOS_I2C_EV_IRQ_Handler(uint32_t i2c_id)
 {
@@ -0,0 +1,102 @@
+/**
+ ******************************************************************************
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup PIOS_ITM ITM trace functions
+ * @brief Stream of scheduler, queue and UAVObject events over ITM/SWO
+ * @{
+ *
+ * @file       pios_itm.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Sets up the ITM and the SWO pin for the trace hooks
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <pios.h>
+
+#ifdef PIOS_ENABLE_ITM_TRACE
+
+#include <pios_itm.h>
+
+/* the unlock key of the CoreSight components */
+#define ITM_LAR_KEY      0xc5acce55
+
+/* TPIU_SPPR value of the asynchronous NRZ (UART like) protocol */
+#define TPIU_SPPR_NRZ    2
+
+/* TPIU_FFCR with the formatter bypassed, SWO needs no framing */
+#define TPIU_FFCR_BYPASS 0x100
+
+/**
+ * Route the ITM to the SWO pin (PB3) and enable the trace ports.
+ *
+ * Must run before the first task is created, so that every task is named in
+ * the stream. A debugger that sets the ITM up itself may change all this.
+ *
+ * \return always zero (success)
+ */
+int32_t PIOS_ITM_Init(void)
+{
+    RCC_ClocksTypeDef clocks;
+    GPIO_InitTypeDef swo = {
+        .GPIO_Pin   = GPIO_Pin_3,
+        .GPIO_Mode  = GPIO_Mode_AF,
+        .GPIO_Speed = GPIO_Speed_50MHz,
+        .GPIO_OType = GPIO_OType_PP,
+        .GPIO_PuPd  = GPIO_PuPd_NOPULL,
+    };
+
+    RCC_GetClocksFreq(&clocks);
+
+    /* the reset state of PB3, unless a driver took it */
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOB, ENABLE);
+    GPIO_PinAFConfig(GPIOB, GPIO_PinSource3, GPIO_AF_SWJ);
+    GPIO_Init(GPIOB, &swo);
+
+    /* trace clock and pin, asynchronous mode */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DBGMCU->CR = (DBGMCU->CR & ~DBGMCU_CR_TRACE_MODE) | DBGMCU_CR_TRACE_IOEN;
+
+    /* the TPIU runs off the core clock */
+    TPI->CSPSR = 1;
+    TPI->SPPR  = TPIU_SPPR_NRZ;
+    TPI->ACPR  = clocks.HCLK_Frequency / PIOS_ITM_SWO_BAUD - 1;
+    TPI->FFCR  = TPIU_FFCR_BYPASS;
+
+    /* local timestamps in core cycles, the trace ports usable unprivileged */
+    ITM->LAR = ITM_LAR_KEY;
+    ITM->TCR = (1UL << ITM_TCR_TraceBusID_Pos) | ITM_TCR_SYNCENA_Msk | ITM_TCR_TSENA_Msk | ITM_TCR_ITMENA_Msk;
+    ITM->TPR = 0;
+    ITM->TER = (1UL << PIOS_ITM_PORT_TASK_SWITCH) |
+               (1UL << PIOS_ITM_PORT_TASK_CREATE) |
+               (1UL << PIOS_ITM_PORT_TASK_NAME) |
+               (1UL << PIOS_ITM_PORT_QUEUE_SEND) |
+               (1UL << PIOS_ITM_PORT_QUEUE_RECEIVE) |
+               (1UL << PIOS_ITM_PORT_UAVO_UPDATED) |
+               (1UL << PIOS_ITM_PORT_UAVO_UNPACKED);
+
+    return 0;
+}
+
+#endif /* PIOS_ENABLE_ITM_TRACE */
+
+/**
+ * @}
+ * @}
+ */
@@ -157,25 +157,33 @@ void PIOS_OVERO_DMA_irq_handler(uint32_t overo_id)
     overo_dev->writing_buffer = 1 - DMA_GetCurrentMemoryTarget(overo_dev->cfg->dma.tx.channel);
     overo_dev->writing_offset = 0;
 
-/*	bool rx_need_yield;
-        // Get data from the Rx buffer and add to the fifo
-        (void) (overo_dev->rx_in_cb)(overo_dev->rx_in_context,
-                                                                 &overo_dev->rx_buffer[overo_dev->writing_buffer][0],
-                                                                PACKET_SIZE, NULL, &rx_need_yield);
-
-        if(rx_need_yield) {
+    // Hand what the companion sent to the fifo. It pads its packets with 0xFF as we do,
+    // the padding is not passed on. The rx stream completes a byte after the tx one,
+    // the last byte of the packet may not have arrived yet, it is the padding unless
+    // the companion filled the whole packet.
+    if (overo_dev->rx_in_cb) {
+        const uint8_t *rx_packet = overo_dev->rx_buffer[1 - DMA_GetCurrentMemoryTarget(overo_dev->cfg->dma.rx.channel)];
+        uint16_t rx_bytes = PACKET_SIZE;
+        while (rx_bytes > 0 && rx_packet[rx_bytes - 1] == 0xFF) {
+            rx_bytes--;
+        }
+        if (rx_bytes > 0) {
+            bool rx_need_yield = false;
+            (void)(overo_dev->rx_in_cb)(overo_dev->rx_in_context, (uint8_t *)rx_packet, rx_bytes, NULL, &rx_need_yield);
+#if defined(OVERO_USES_BLOCKING_WRITE)
+            if (rx_need_yield) {
                 vPortYieldFromISR();
+            }
+#endif
         }
-
-        // Fill the buffer with known value to prevent rereading these bytes
-        memset(&overo_dev->rx_buffer[overo_dev->writing_buffer][0], 0xFF, PACKET_SIZE);
- */
-    // Fill the buffer with known value to prevent resending any bytes
-    memset(&overo_dev->tx_buffer[overo_dev->writing_buffer][0], 0xFF, PACKET_SIZE);
+    }
 
     // Load any pending bytes from TX fifo
     PIOS_OVERO_WriteData(overo_dev);
 
+    // Fill the rest with known value to prevent resending any bytes
+    memset(&overo_dev->tx_buffer[overo_dev->writing_buffer][overo_dev->writing_offset], 0xFF, PACKET_SIZE - overo_dev->writing_offset);
+
     overo_dev->packets++;
 }
 
@@ -36,13 +36,17 @@
 
 /* Provide a RCVR driver */
 static int32_t PIOS_PPM_Get(uint32_t rcvr_id, uint8_t channel);
+static uint8_t PIOS_PPM_Get_All(uint32_t rcvr_id, int32_t *channels, uint8_t num_channels);
 static xSemaphoreHandle PIOS_PPM_Get_Semaphore(uint32_t rcvr_id, uint8_t channel);
+static uint32_t PIOS_PPM_Get_Frame_Time(uint32_t rcvr_id);
 
 const struct pios_rcvr_driver pios_ppm_rcvr_driver = {
-    .read          = PIOS_PPM_Get,
+    .read           = PIOS_PPM_Get,
+    .read_all       = PIOS_PPM_Get_All,
 #if defined(PIOS_INCLUDE_FREERTOS)
-    .get_semaphore = PIOS_PPM_Get_Semaphore
+    .get_semaphore  = PIOS_PPM_Get_Semaphore,
 #endif
+    .get_frame_time = PIOS_PPM_Get_Frame_Time,
 };
 
 #define PIOS_PPM_IN_MIN_NUM_CHANNELS     4
@@ -72,6 +76,7 @@ struct pios_ppm_dev {
     int8_t   NumChannels;
     int8_t   NumChannelsPrevFrame;
     uint8_t  NumChannelCounter;
+    volatile uint32_t FrameTime;
 
     uint8_t  supv_timer;
     bool     Tracking;
@@ -154,6 +159,7 @@ extern int32_t PIOS_PPM_Init(uint32_t *ppm_id, const struct pios_ppm_cfg *cfg)
     ppm_dev->NumChannels  = -1;
     ppm_dev->NumChannelsPrevFrame = -1;
     ppm_dev->NumChannelCounter = 0;
+    ppm_dev->FrameTime = 0;
     ppm_dev->Tracking     = false;
     ppm_dev->Fresh = false;
 
@@ -252,6 +258,52 @@ static int32_t PIOS_PPM_Get(uint32_t rcvr_id, uint8_t channel)
     return ppm_dev->CaptureValue[channel];
 }
 
+/**
+ * Get the values of the first input channels of the last frame
+ * \param[out] channels values of the channels, PIOS_RCVR_INVALID past the inputs
+ * \param[in] num_channels number of channels to read (zero based)
+ * \output number of channels available
+ */
+static uint8_t PIOS_PPM_Get_All(uint32_t rcvr_id, int32_t *channels, uint8_t num_channels)
+{
+    struct pios_ppm_dev *ppm_dev = (struct pios_ppm_dev *)rcvr_id;
+
+    if (!PIOS_PPM_validate(ppm_dev)) {
+        return 0;
+    }
+
+    uint8_t available = (num_channels < PIOS_PPM_IN_MAX_NUM_CHANNELS) ? num_channels : PIOS_PPM_IN_MAX_NUM_CHANNELS;
+    uint32_t frame_time;
+
+    /* copy again if a frame was decoded in the meantime, so that all channels come from the same one */
+    do {
+        frame_time = ppm_dev->FrameTime;
+        for (uint8_t i = 0; i < available; i++) {
+            channels[i] = ppm_dev->CaptureValue[i];
+        }
+    } while (frame_time != ppm_dev->FrameTime);
+
+    for (uint8_t i = available; i < num_channels; i++) {
+        channels[i] = PIOS_RCVR_INVALID;
+    }
+    return available;
+}
+
+/**
+ * Get the time the last well formed frame ended, 0 if none
+ */
+static uint32_t PIOS_PPM_Get_Frame_Time(uint32_t rcvr_id)
+{
+    struct pios_ppm_dev *ppm_dev = (struct pios_ppm_dev *)rcvr_id;
+
+    if (!PIOS_PPM_validate(ppm_dev)) {
+        /* Invalid device specified */
+        return 0;
+    }
+
+    return ppm_dev->FrameTime;
+}
+
 static void PIOS_PPM_tim_overflow_cb(__attribute__((unused)) uint32_t tim_id, uint32_t context,
                                      __attribute__((unused)) uint8_t channel, uint16_t count)
 {
@@ -321,6 +373,7 @@ static void PIOS_PPM_tim_edge_cb(__attribute__((unused)) uint32_t tim_id, uint32
                  i < PIOS_PPM_IN_MAX_NUM_CHANNELS; i++) {
                 ppm_dev->CaptureValue[i] = PIOS_RCVR_TIMEOUT;
             }
+            ppm_dev->FrameTime = PIOS_DELAY_GetRaw();
 #if defined(PIOS_INCLUDE_FREERTOS)
             /* Signal that a new sample is ready on this channel. */
             if (ppm_dev->new_sample_semaphores[chan_idx] != 0) {
@@ -44,6 +44,12 @@
 
 #define SPI_MAX_BLOCK_PIO 128
 
+#if defined(PIOS_INCLUDE_FREERTOS)
+static void SPI_Queue_Start(struct pios_spi_dev *spi_dev);
+static void SPI_Queue_StartISR(struct pios_spi_dev *spi_dev, bool *woken);
+static void SPI_Queue_SegmentDone(struct pios_spi_dev *spi_dev, int32_t result, bool *woken);
+#endif
+
 static bool PIOS_SPI_validate(__attribute__((unused)) struct pios_spi_dev *com_dev)
 {
     /* Should check device magic here */
@@ -93,6 +99,9 @@ int32_t PIOS_SPI_Init(uint32_t *spi_id, const struct pios_spi_cfg *cfg)
 #if defined(PIOS_INCLUDE_FREERTOS)
     vSemaphoreCreateBinary(spi_dev->busy);
     xSemaphoreGive(spi_dev->busy);
+    spi_dev->queue_head    = NULL;
+    spi_dev->queue_tail    = NULL;
+    spi_dev->queue_running = false;
 #endif
 
     /* Disable callback function */
@@ -329,6 +338,9 @@ int32_t PIOS_SPI_ReleaseBus(uint32_t spi_id)
     PIOS_Assert(valid)
 
     xSemaphoreGive(spi_dev->busy);
+
+    /* Queued transactions waited for the bus */
+    SPI_Queue_Start(spi_dev);
 #else
     struct pios_spi_dev *spi_dev = (struct pios_spi_dev *)spi_id;
     PIOS_IRQ_Disable();
@@ -358,6 +370,9 @@ int32_t PIOS_SPI_ReleaseBusISR(uint32_t spi_id, bool *woken)
     if (woken) {
         *woken = *woken || (higherPriorityTaskWoken == pdTRUE);
     }
+
+    /* Queued transactions waited for the bus */
+    SPI_Queue_StartISR(spi_dev, woken);
     return 0;
 
 #else
@@ -486,9 +501,11 @@ static int32_t SPI_DMA_TransferBlock(uint32_t spi_id, const uint8_t *send_buffer
     }
 
     /* Disable the SPI peripheral */
-    /* Initialize the SPI block */
+    /* Initialize the SPI block, at the clock speed PIOS_SPI_SetClockSpeed() selected */
+    SPI_InitTypeDef spi_init = spi_dev->cfg->init;
+    spi_init.SPI_BaudRatePrescaler = spi_dev->cfg->regs->CR1 & SPI_CR1_BR;
     SPI_DeInit(spi_dev->cfg->regs);
-    SPI_Init(spi_dev->cfg->regs, (SPI_InitTypeDef *)&(spi_dev->cfg->init));
+    SPI_Init(spi_dev->cfg->regs, &spi_init);
     SPI_Cmd(spi_dev->cfg->regs, DISABLE);
     /* Configure CRC calculation */
     if (spi_dev->cfg->use_crc) {
@@ -555,7 +572,12 @@ static int32_t SPI_DMA_TransferBlock(uint32_t spi_id, const uint8_t *send_buffer
 
     DMA_Init(spi_dev->cfg->dma.tx.channel, &(dma_init));
 
-    /* Enable DMA interrupt if callback function active */
+    /* Enable DMA interrupt if callback function active or the transfer is queued */
+#if defined(PIOS_INCLUDE_FREERTOS)
+    if (spi_dev->queue_running) {
+        callback = spi_dev;
+    }
+#endif
     DMA_ITConfig(spi_dev->cfg->dma.rx.channel, DMA_IT_TC, (callback != NULL) ? ENABLE : DISABLE);
 
     /* Flush out the CRC registers */
@@ -751,6 +773,23 @@ void PIOS_SPI_IRQ_Handler(uint32_t spi_id)
         }
     }
 
+#if defined(PIOS_INCLUDE_FREERTOS)
+    if (spi_dev->queue_running) {
+        int32_t result = 0;
+        bool woken     = false;
+
+        if (spi_dev->cfg->use_crc && SPI_I2S_GetFlagStatus(spi_dev->cfg->regs, SPI_FLAG_CRCERR)) {
+            SPI_I2S_ClearFlag(spi_dev->cfg->regs, SPI_FLAG_CRCERR);
+            result = -4;
+        }
+        SPI_Queue_SegmentDone(spi_dev, result, &woken);
+        if (woken) {
+            vPortYield();
+        }
+        return;
+    }
+#endif
+
     if (spi_dev->callback != NULL) {
         bool crc_ok = true;
         uint8_t crc_val;
@@ -764,6 +803,228 @@ void PIOS_SPI_IRQ_Handler(uint32_t spi_id)
     }
 }
 
+#if defined(PIOS_INCLUDE_FREERTOS)
+/**
+ * Check a transaction and append it to the queue
+ * \return true if the queue was idle and should be started
+ */
+static bool SPI_Queue_Append(struct pios_spi_dev *spi_dev, struct pios_spi_transaction *transaction)
+{
+    transaction->next    = NULL;
+    transaction->segment = 0;
+
+    PIOS_IRQ_Disable();
+    if (spi_dev->queue_tail) {
+        spi_dev->queue_tail->next = transaction;
+    } else {
+        spi_dev->queue_head = transaction;
+    }
+    spi_dev->queue_tail = transaction;
+    bool idle = !spi_dev->queue_running;
+    PIOS_IRQ_Enable();
+
+    return idle;
+}
+
+static bool SPI_Queue_DMAReachable(const void *buffer)
+{
+    /* The DMA controllers have no access to the core coupled memory */
+    return (uint32_t)buffer < CCMDATARAM_BASE || (uint32_t)buffer >= CCMDATARAM_BASE + 0x10000;
+}
+
+static bool SPI_Queue_Valid(struct pios_spi_dev *spi_dev, const struct pios_spi_transaction *transaction)
+{
+    if (!transaction || !transaction->segment_count || transaction->slave_id >= spi_dev->cfg->slave_count) {
+        return false;
+    }
+    for (uint8_t i = 0; i < transaction->segment_count; i++) {
+        const struct pios_spi_segment *segment = &transaction->segments[i];
+        if (!segment->len || !SPI_Queue_DMAReachable(segment->send_buffer) || !SPI_Queue_DMAReachable(segment->receive_buffer)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Queue a transaction from a task, it is run by DMA as soon as the bus is free.
+ * Blocking users of the bus are mutually excluded through the bus semaphore,
+ * which the queue holds for as long as it has transactions to run.
+ * \param[in] spi_id SPI device handle
+ * \param[in] transaction descriptor, owned by the queue until its callback runs
+ * \return 0 if queued
+ * \return -1 if the transaction is malformed or a buffer is not DMA reachable
+ */
+int32_t PIOS_SPI_SubmitTransaction(uint32_t spi_id, struct pios_spi_transaction *transaction)
+{
+    struct pios_spi_dev *spi_dev = (struct pios_spi_dev *)spi_id;
+
+    bool valid = PIOS_SPI_validate(spi_dev);
+
+    PIOS_Assert(valid)
+
+    if (!SPI_Queue_Valid(spi_dev, transaction)) {
+        return -1;
+    }
+    if (SPI_Queue_Append(spi_dev, transaction)) {
+        SPI_Queue_Start(spi_dev);
+    }
+
+    return 0;
+}
+
+/**
+ * Queue a transaction from an interrupt or a transaction callback, see
+ * PIOS_SPI_SubmitTransaction()
+ * \param woken[in,out] If non-NULL, will be set to true if woken was false and a higher priority
+ *                      task has is now eligible to run, else unchanged
+ */
+int32_t PIOS_SPI_SubmitTransactionISR(uint32_t spi_id, struct pios_spi_transaction *transaction, bool *woken)
+{
+    struct pios_spi_dev *spi_dev = (struct pios_spi_dev *)spi_id;
+
+    bool valid = PIOS_SPI_validate(spi_dev);
+
+    PIOS_Assert(valid)
+
+    if (!SPI_Queue_Valid(spi_dev, transaction)) {
+        return -1;
+    }
+    if (SPI_Queue_Append(spi_dev, transaction)) {
+        SPI_Queue_StartISR(spi_dev, woken);
+    }
+
+    return 0;
+}
+
+/**
+ * Hand the head of the queue to the caller, which holds the bus semaphore
+ * \return the transaction to run, NULL if there is none
+ */
+static struct pios_spi_transaction *SPI_Queue_Claim(struct pios_spi_dev *spi_dev)
+{
+    struct pios_spi_transaction *transaction = NULL;
+
+    PIOS_IRQ_Disable();
+    if (!spi_dev->queue_running && spi_dev->queue_head) {
+        spi_dev->queue_running = true;
+        transaction = spi_dev->queue_head;
+    }
+    PIOS_IRQ_Enable();
+
+    return transaction;
+}
+
+/**
+ * Select the slave of a transaction and start its first segment
+ */
+static void SPI_Queue_Run(struct pios_spi_dev *spi_dev, struct pios_spi_transaction *transaction)
+{
+    const struct pios_spi_segment *segment = &transaction->segments[0];
+
+    PIOS_SPI_SetClockSpeed((uint32_t)spi_dev, transaction->prescaler);
+    PIOS_SPI_RC_PinSet((uint32_t)spi_dev, transaction->slave_id, 0);
+    SPI_DMA_TransferBlock((uint32_t)spi_dev, segment->send_buffer, segment->receive_buffer, segment->len, NULL);
+}
+
+/**
+ * Start an idle queue from a task, if the bus can be claimed.
+ * A transaction queued by an interrupt while the semaphore was held here
+ * could not start itself, so the queue is checked again after giving it back.
+ */
+static void SPI_Queue_Start(struct pios_spi_dev *spi_dev)
+{
+    while (spi_dev->queue_head && !spi_dev->queue_running) {
+        if (xSemaphoreTake(spi_dev->busy, 0) != pdTRUE) {
+            /* The bus is in use, releasing it comes back here */
+            return;
+        }
+
+        struct pios_spi_transaction *transaction = SPI_Queue_Claim(spi_dev);
+        if (transaction) {
+            SPI_Queue_Run(spi_dev, transaction);
+            return;
+        }
+        xSemaphoreGive(spi_dev->busy);
+    }
+}
+
+/**
+ * Start an idle queue from an interrupt, see SPI_Queue_Start()
+ */
+static void SPI_Queue_StartISR(struct pios_spi_dev *spi_dev, bool *woken)
+{
+    while (spi_dev->queue_head && !spi_dev->queue_running) {
+        signed portBASE_TYPE higherPriorityTaskWoken = pdFALSE;
+
+        if (xSemaphoreTakeFromISR(spi_dev->busy, &higherPriorityTaskWoken) != pdTRUE) {
+            /* The bus is in use, releasing it comes back here */
+            return;
+        }
+
+        struct pios_spi_transaction *transaction = SPI_Queue_Claim(spi_dev);
+        if (transaction) {
+            SPI_Queue_Run(spi_dev, transaction);
+            return;
+        }
+        xSemaphoreGiveFromISR(spi_dev->busy, &higherPriorityTaskWoken);
+        if (woken) {
+            *woken = *woken || (higherPriorityTaskWoken == pdTRUE);
+        }
+    }
+}
+
+/**
+ * A DMA transfer of the head transaction has completed, continue with its
+ * next segment, or complete it and go on with the next transaction.
+ * The queue keeps the bus while it has transactions to run.
+ * Runs in the DMA interrupt.
+ */
+static void SPI_Queue_SegmentDone(struct pios_spi_dev *spi_dev, int32_t result, bool *woken)
+{
+    struct pios_spi_transaction *transaction = spi_dev->queue_head;
+
+    if (result == 0 && ++transaction->segment < transaction->segment_count) {
+        const struct pios_spi_segment *segment = &transaction->segments[transaction->segment];
+        SPI_DMA_TransferBlock((uint32_t)spi_dev, segment->send_buffer, segment->receive_buffer, segment->len, NULL);
+        return;
+    }
+
+    PIOS_SPI_RC_PinSet((uint32_t)spi_dev, transaction->slave_id, 1);
+
+    PIOS_IRQ_Disable();
+    spi_dev->queue_head = transaction->next;
+    if (!spi_dev->queue_head) {
+        spi_dev->queue_tail = NULL;
+    }
+    PIOS_IRQ_Enable();
+
+    /* The descriptor belongs to the driver again, it may queue it anew */
+    if (transaction->callback) {
+        transaction->callback(transaction, result, woken);
+    }
+
+    PIOS_IRQ_Disable();
+    struct pios_spi_transaction *next = spi_dev->queue_head;
+    if (!next) {
+        spi_dev->queue_running = false;
+    }
+    PIOS_IRQ_Enable();
+
+    if (next) {
+        SPI_Queue_Run(spi_dev, next);
+        return;
+    }
+
+    signed portBASE_TYPE higherPriorityTaskWoken = pdFALSE;
+    xSemaphoreGiveFromISR(spi_dev->busy, &higherPriorityTaskWoken);
+    *woken = *woken || (higherPriorityTaskWoken == pdTRUE);
+
+    /* Queued by a higher priority interrupt while the bus was still held */
+    SPI_Queue_StartISR(spi_dev, woken);
+}
+#endif /* PIOS_INCLUDE_FREERTOS */
+
 #endif /* PIOS_INCLUDE_SPI */
 
 /**
@@ -65,6 +65,12 @@ struct pios_usart_dev {
     uint32_t rx_in_context;
     pios_com_callback tx_out_cb;
     uint32_t tx_out_context;
+
+    /* only used on ports with a DMA configuration */
+    uint16_t dma_rx_pos;
+    volatile bool dma_tx_busy;
+    uint8_t  dma_rx_buf[PIOS_USART_DMA_RX_BUFFER_LEN];
+    uint8_t  dma_tx_buf[PIOS_USART_DMA_TX_BUFFER_LEN];
 };
 
 static bool PIOS_USART_validate(struct pios_usart_dev *usart_dev)
@@ -72,6 +78,10 @@ static bool PIOS_USART_validate(struct pios_usart_dev *usart_dev)
     return usart_dev->magic == PIOS_USART_DEV_MAGIC;
 }
 
+static void PIOS_USART_DMA_Init(struct pios_usart_dev *usart_dev);
+static bool PIOS_USART_DMA_RxFlush(struct pios_usart_dev *usart_dev);
+static bool PIOS_USART_DMA_TxKick(struct pios_usart_dev *usart_dev);
+
 #if defined(PIOS_INCLUDE_FREERTOS)
 static struct pios_usart_dev *PIOS_USART_alloc(void)
 {
@@ -216,8 +226,12 @@ int32_t PIOS_USART_Init(uint32_t *usart_id, const struct pios_usart_cfg *cfg)
         break;
     }
     NVIC_Init((NVIC_InitTypeDef *)&(usart_dev->cfg->irq.init));
-    USART_ITConfig(usart_dev->cfg->regs, USART_IT_RXNE, ENABLE);
-    USART_ITConfig(usart_dev->cfg->regs, USART_IT_TXE, ENABLE);
+    if (usart_dev->cfg->dma) {
+        PIOS_USART_DMA_Init(usart_dev);
+    } else {
+        USART_ITConfig(usart_dev->cfg->regs, USART_IT_RXNE, ENABLE);
+        USART_ITConfig(usart_dev->cfg->regs, USART_IT_TXE, ENABLE);
+    }
 
     // FIXME XXX Clear / reset uart here - sends NUL char else
 
@@ -238,6 +252,11 @@ static void PIOS_USART_RxStart(uint32_t usart_id, __attribute__((unused)) uint16
 
     PIOS_Assert(valid);
 
+    if (usart_dev->cfg->dma) {
+        /* The circular rx transfer never stops */
+        return;
+    }
+
     USART_ITConfig(usart_dev->cfg->regs, USART_IT_RXNE, ENABLE);
 }
 static void PIOS_USART_TxStart(uint32_t usart_id, __attribute__((unused)) uint16_t tx_bytes_avail)
@@ -248,6 +267,16 @@ static void PIOS_USART_TxStart(uint32_t usart_id, __attribute__((unused)) uint16
 
     PIOS_Assert(valid);
 
+    if (usart_dev->cfg->dma) {
+        /*
+         * The transfer complete interrupt kicks the next transfer, an idle
+         * stream is started by pending the tx stream interrupt, so that the
+         * COM callback always runs in interrupt context
+         */
+        NVIC_SetPendingIRQ(usart_dev->cfg->dma->tx_irq.init.NVIC_IRQChannel);
+        return;
+    }
+
     USART_ITConfig(usart_dev->cfg->regs, USART_IT_TXE, ENABLE);
 }
 
@@ -316,6 +345,22 @@ static void PIOS_USART_generic_irq_handler(uint32_t usart_id)
 
     PIOS_Assert(valid);
 
+    if (usart_dev->cfg->dma) {
+        /* Only the line idle interrupt is enabled, SR then DR clears it */
+        volatile uint16_t sr = usart_dev->cfg->regs->SR;
+        volatile uint8_t dr  = usart_dev->cfg->regs->DR;
+        (void)sr;
+        (void)dr;
+
+        bool need_yield = PIOS_USART_DMA_RxFlush(usart_dev);
+#if defined(PIOS_INCLUDE_FREERTOS)
+        if (need_yield) {
+            vPortYield();
+        }
+#endif /* PIOS_INCLUDE_FREERTOS */
+        return;
+    }
+
     /* Force read of dr after sr to make sure to clear error flags */
     volatile uint16_t sr = usart_dev->cfg->regs->SR;
     volatile uint8_t dr  = usart_dev->cfg->regs->DR;
@@ -358,6 +403,171 @@ static void PIOS_USART_generic_irq_handler(uint32_t usart_id)
 #endif /* PIOS_INCLUDE_FREERTOS */
 }
 
+/**
+ * Set up the circular rx transfer and the tx stream of a DMA port
+ */
+static void PIOS_USART_DMA_Init(struct pios_usart_dev *usart_dev)
+{
+    const struct pios_usart_dma_cfg *dma = usart_dev->cfg->dma;
+    DMA_InitTypeDef init;
+
+    /* RX, circular into dma_rx_buf for as long as the port exists */
+    DMA_DeInit(dma->rx.channel);
+    init = dma->rx.init;
+    init.DMA_PeripheralBaseAddr = (uint32_t)&usart_dev->cfg->regs->DR;
+    init.DMA_Memory0BaseAddr    = (uint32_t)usart_dev->dma_rx_buf;
+    init.DMA_BufferSize         = PIOS_USART_DMA_RX_BUFFER_LEN;
+    init.DMA_DIR  = DMA_DIR_PeripheralToMemory;
+    init.DMA_Mode = DMA_Mode_Circular;
+    DMA_Init(dma->rx.channel, &init);
+    usart_dev->dma_rx_pos = 0;
+
+    /* TX, memory address and length are set for each transfer */
+    DMA_DeInit(dma->tx.channel);
+
+    NVIC_Init((NVIC_InitTypeDef *)&dma->rx_irq.init);
+    NVIC_Init((NVIC_InitTypeDef *)&dma->tx_irq.init);
+
+    DMA_ITConfig(dma->rx.channel, DMA_IT_HT | DMA_IT_TC, ENABLE);
+    DMA_Cmd(dma->rx.channel, ENABLE);
+    USART_DMACmd(usart_dev->cfg->regs, USART_DMAReq_Rx | USART_DMAReq_Tx, ENABLE);
+
+    USART_ITConfig(usart_dev->cfg->regs, USART_IT_IDLE, ENABLE);
+}
+
+/**
+ * Hand everything the rx stream wrote since the last call to the COM layer.
+ * Called from the line idle and the rx stream interrupts.
+ * \return true if a task needs to be woken
+ */
+static bool PIOS_USART_DMA_RxFlush(struct pios_usart_dev *usart_dev)
+{
+    bool need_yield = false;
+    uint16_t pos    = PIOS_USART_DMA_RX_BUFFER_LEN - DMA_GetCurrDataCounter(usart_dev->cfg->dma->rx.channel);
+
+    if (pos >= PIOS_USART_DMA_RX_BUFFER_LEN) {
+        pos = 0;
+    }
+    if (pos == usart_dev->dma_rx_pos) {
+        return false;
+    }
+
+    if (usart_dev->rx_in_cb) {
+        /* what the fifo cannot take is dropped, as in byte mode */
+        if (pos < usart_dev->dma_rx_pos) {
+            (void)(usart_dev->rx_in_cb)(usart_dev->rx_in_context, &usart_dev->dma_rx_buf[usart_dev->dma_rx_pos],
+                                        PIOS_USART_DMA_RX_BUFFER_LEN - usart_dev->dma_rx_pos, NULL, &need_yield);
+            usart_dev->dma_rx_pos = 0;
+        }
+        if (pos > usart_dev->dma_rx_pos) {
+            (void)(usart_dev->rx_in_cb)(usart_dev->rx_in_context, &usart_dev->dma_rx_buf[usart_dev->dma_rx_pos],
+                                        pos - usart_dev->dma_rx_pos, NULL, &need_yield);
+        }
+    }
+    usart_dev->dma_rx_pos = pos;
+
+    return need_yield;
+}
+
+/**
+ * Start a tx transfer with what the COM layer has queued.
+ * Only called from the stream interrupts, which cannot preempt each other.
+ * \return true if a task needs to be woken
+ */
+static bool PIOS_USART_DMA_TxKick(struct pios_usart_dev *usart_dev)
+{
+    const struct pios_usart_dma_cfg *dma = usart_dev->cfg->dma;
+    bool need_yield = false;
+    uint16_t bytes_to_send = 0;
+
+    if (usart_dev->tx_out_cb) {
+        bytes_to_send = (usart_dev->tx_out_cb)(usart_dev->tx_out_context, usart_dev->dma_tx_buf, PIOS_USART_DMA_TX_BUFFER_LEN, NULL, &need_yield);
+    }
+    if (bytes_to_send == 0) {
+        usart_dev->dma_tx_busy = false;
+        return need_yield;
+    }
+
+    DMA_InitTypeDef init = dma->tx.init;
+    init.DMA_PeripheralBaseAddr = (uint32_t)&usart_dev->cfg->regs->DR;
+    init.DMA_Memory0BaseAddr    = (uint32_t)usart_dev->dma_tx_buf;
+    init.DMA_BufferSize         = bytes_to_send;
+    init.DMA_DIR  = DMA_DIR_MemoryToPeripheral;
+    init.DMA_Mode = DMA_Mode_Normal;
+
+    usart_dev->dma_tx_busy = true;
+    DMA_Cmd(dma->tx.channel, DISABLE);
+    DMA_ClearITPendingBit(dma->tx.channel, dma->tx_irq.flags);
+    DMA_Init(dma->tx.channel, &init);
+    DMA_ITConfig(dma->tx.channel, DMA_IT_TC, ENABLE);
+    DMA_Cmd(dma->tx.channel, ENABLE);
+
+    return need_yield;
+}
+
+static struct pios_usart_dev *PIOS_USART_dev_from_regs(USART_TypeDef *regs)
+{
+    switch ((uint32_t)regs) {
+    case (uint32_t)USART1:
+        return (struct pios_usart_dev *)PIOS_USART_1_id;
+
+    case (uint32_t)USART2:
+        return (struct pios_usart_dev *)PIOS_USART_2_id;
+
+    case (uint32_t)USART3:
+        return (struct pios_usart_dev *)PIOS_USART_3_id;
+
+    case (uint32_t)UART4:
+        return (struct pios_usart_dev *)PIOS_USART_4_id;
+
+    case (uint32_t)UART5:
+        return (struct pios_usart_dev *)PIOS_USART_5_id;
+
+    case (uint32_t)USART6:
+        return (struct pios_usart_dev *)PIOS_USART_6_id;
+    }
+    return NULL;
+}
+
+/**
+ * Common handler for the rx and tx DMA stream interrupts of a port.
+ * \param[in] regs USART the streams belong to
+ */
+void PIOS_USART_DMA_IRQ_Handler(USART_TypeDef *regs)
+{
+    struct pios_usart_dev *usart_dev = PIOS_USART_dev_from_regs(regs);
+
+    if (!usart_dev || !usart_dev->cfg->dma) {
+        /* Port not initialised, or initialised without DMA */
+        return;
+    }
+
+    bool valid = PIOS_USART_validate(usart_dev);
+
+    PIOS_Assert(valid);
+
+    const struct pios_usart_dma_cfg *dma = usart_dev->cfg->dma;
+    bool rx_need_yield = false;
+    bool tx_need_yield = false;
+
+    DMA_ClearITPendingBit(dma->rx.channel, dma->rx_irq.flags);
+    rx_need_yield = PIOS_USART_DMA_RxFlush(usart_dev);
+
+    if (DMA_GetITStatus(dma->tx.channel, dma->tx_irq.flags) == SET) {
+        DMA_ClearITPendingBit(dma->tx.channel, dma->tx_irq.flags);
+        tx_need_yield = PIOS_USART_DMA_TxKick(usart_dev);
+    } else if (!usart_dev->dma_tx_busy) {
+        /* Pended by PIOS_USART_TxStart, start the idle stream */
+        tx_need_yield = PIOS_USART_DMA_TxKick(usart_dev);
+    }
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+    if (rx_need_yield || tx_need_yield) {
+        vPortYield();
+    }
+#endif /* PIOS_INCLUDE_FREERTOS */
+}
+
 #endif /* PIOS_INCLUDE_USART */
 
 /**
@@ -52,6 +52,11 @@ const struct pios_com_driver pios_usb_cdc_com_driver = {
     .available  = PIOS_USB_CDC_Available,
 };
 
+/* Largest bulk IN transfer, several packets can go out in a single USB frame */
+#ifndef PIOS_USB_CDC_TX_TRANSFER_LENGTH
+#define PIOS_USB_CDC_TX_TRANSFER_LENGTH (8 * PIOS_USB_BOARD_CDC_DATA_LENGTH)
+#endif
+
 enum pios_usb_cdc_dev_magic {
     PIOS_USB_CDC_DEV_MAGIC = 0xAABBCCDD,
 };
@@ -74,12 +79,13 @@ struct pios_usb_cdc_dev {
     volatile bool rx_active;
 
     /*
-     * NOTE: This is -1 as somewhat of a hack.  It ensures that we always send packets
-     * that are strictly < maxPacketSize for this interface which means we never have
-     * to bother with zero length packets (ZLP).
+     * Data is sent in transfers of several bulk packets, the core splits them into
+     * maxPacketSize packets.  A transfer ending on a packet boundary is followed by
+     * a zero length packet (ZLP) so that the host completes the read without waiting.
      */
-    uint8_t  tx_packet_buffer[PIOS_USB_BOARD_CDC_DATA_LENGTH - 1] __attribute__((aligned(4)));
+    uint8_t  tx_packet_buffer[PIOS_USB_CDC_TX_TRANSFER_LENGTH] __attribute__((aligned(4)));
     volatile bool tx_active;
+    volatile bool tx_zlp_pending;
 
     uint8_t  ctrl_tx_packet_buffer[PIOS_USB_BOARD_CDC_MGMT_LENGTH] __attribute__((aligned(4)));
 
@@ -181,6 +187,7 @@ int32_t PIOS_USB_CDC_Init(uint32_t *usbcdc_id, const struct pios_usb_cdc_cfg *cf
     /* Rx and Tx are not active yet */
     usb_cdc_dev->rx_active           = false;
     usb_cdc_dev->tx_active           = false;
+    usb_cdc_dev->tx_zlp_pending      = false;
 
     /* Clear stats */
     usb_cdc_dev->rx_dropped          = 0;
@@ -228,6 +235,7 @@ static bool PIOS_USB_CDC_SendData(struct pios_usb_cdc_dev *usb_cdc_dev)
      * to make sure we don't race with the Tx completion interrupt
      */
     usb_cdc_dev->tx_active = true;
+    usb_cdc_dev->tx_zlp_pending = (bytes_to_tx % PIOS_USB_BOARD_CDC_DATA_LENGTH) == 0;
 
     PIOS_USBHOOK_EndpointTx(usb_cdc_dev->cfg->data_tx_ep,
                             usb_cdc_dev->tx_packet_buffer,
@@ -552,14 +560,16 @@ static void PIOS_USB_CDC_DATA_IF_Init(uint32_t usb_cdc_id)
     }
 
     /* Register endpoint specific callbacks with the USBHOOK layer */
-    PIOS_USBHOOK_RegisterEpInCallback(usb_cdc_dev->cfg->data_tx_ep,
-                                      sizeof(usb_cdc_dev->tx_packet_buffer),
-                                      PIOS_USB_CDC_DATA_EP_IN_Callback,
-                                      (uint32_t)usb_cdc_dev);
-    PIOS_USBHOOK_RegisterEpOutCallback(usb_cdc_dev->cfg->data_rx_ep,
-                                       sizeof(usb_cdc_dev->rx_packet_buffer),
-                                       PIOS_USB_CDC_DATA_EP_OUT_Callback,
-                                       (uint32_t)usb_cdc_dev);
+    PIOS_USBHOOK_RegisterEpInBulkCallback(usb_cdc_dev->cfg->data_tx_ep,
+                                          PIOS_USB_BOARD_CDC_DATA_LENGTH,
+                                          sizeof(usb_cdc_dev->tx_packet_buffer),
+                                          PIOS_USB_CDC_DATA_EP_IN_Callback,
+                                          (uint32_t)usb_cdc_dev);
+    PIOS_USBHOOK_RegisterEpOutBulkCallback(usb_cdc_dev->cfg->data_rx_ep,
+                                           PIOS_USB_BOARD_CDC_DATA_LENGTH,
+                                           sizeof(usb_cdc_dev->rx_packet_buffer),
+                                           PIOS_USB_CDC_DATA_EP_OUT_Callback,
+                                           (uint32_t)usb_cdc_dev);
     usb_cdc_dev->usb_data_if_enabled = true;
 }
 
@@ -614,6 +624,15 @@ static bool PIOS_USB_CDC_DATA_EP_IN_Callback(
 
     PIOS_Assert(valid);
 
+    if (usb_cdc_dev->tx_zlp_pending) {
+        /* Terminate the previous transfer before starting the next one */
+        usb_cdc_dev->tx_zlp_pending = false;
+        PIOS_USBHOOK_EndpointTx(usb_cdc_dev->cfg->data_tx_ep,
+                                usb_cdc_dev->tx_packet_buffer,
+                                0);
+        return true;
+    }
+
     bool rc = PIOS_USB_CDC_SendData(usb_cdc_dev);
     if (!rc) {
         /* No additional data was transmitted, note that tx is no longer active */
@@ -127,7 +127,7 @@ struct usb_ep_entry {
     uint16_t max_len;
 };
 static struct usb_ep_entry usb_epin_table[6];
-void PIOS_USBHOOK_RegisterEpInCallback(uint8_t epnum, uint16_t max_len, pios_usbhook_epcb cb, uint32_t context)
+static void PIOS_USBHOOK_OpenEpIn(uint8_t epnum, uint16_t max_packet, uint16_t max_len, uint8_t ep_type, pios_usbhook_epcb cb, uint32_t context)
 {
     PIOS_Assert(epnum < NELEMENTS(usb_epin_table));
     PIOS_Assert(cb);
@@ -138,11 +138,22 @@ void PIOS_USBHOOK_RegisterEpInCallback(uint8_t epnum, uint16_t max_len, pios_usb
 
     DCD_EP_Open(&pios_usb_otg_core_handle,
                 epnum | 0x80,
-                max_len,
-                USB_OTG_EP_INT);
-    /*
-     * FIXME do not hardcode endpoint type
-     */
+                max_packet,
+                ep_type);
+}
+
+void PIOS_USBHOOK_RegisterEpInCallback(uint8_t epnum, uint16_t max_len, pios_usbhook_epcb cb, uint32_t context)
+{
+    PIOS_USBHOOK_OpenEpIn(epnum, max_len, max_len, USB_OTG_EP_INT, cb, context);
+}
+
+/**
+ * Register a bulk IN endpoint, transfers of up to max_len bytes are split
+ * by the core into max_packet sized packets
+ */
+void PIOS_USBHOOK_RegisterEpInBulkCallback(uint8_t epnum, uint16_t max_packet, uint16_t max_len, pios_usbhook_epcb cb, uint32_t context)
+{
+    PIOS_USBHOOK_OpenEpIn(epnum, max_packet, max_len, USB_OTG_EP_BULK, cb, context);
 }
 
 extern void PIOS_USBHOOK_DeRegisterEpInCallback(uint8_t epnum)
@@ -155,7 +166,7 @@ extern void PIOS_USBHOOK_DeRegisterEpInCallback(uint8_t epnum)
 }
 
 static struct usb_ep_entry usb_epout_table[6];
-void PIOS_USBHOOK_RegisterEpOutCallback(uint8_t epnum, uint16_t max_len, pios_usbhook_epcb cb, uint32_t context)
+static void PIOS_USBHOOK_OpenEpOut(uint8_t epnum, uint16_t max_packet, uint16_t max_len, uint8_t ep_type, pios_usbhook_epcb cb, uint32_t context)
 {
     PIOS_Assert(epnum < NELEMENTS(usb_epout_table));
     PIOS_Assert(cb);
@@ -166,11 +177,8 @@ void PIOS_USBHOOK_RegisterEpOutCallback(uint8_t epnum, uint16_t max_len, pios_us
 
     DCD_EP_Open(&pios_usb_otg_core_handle,
                 epnum,
-                max_len,
-                USB_OTG_EP_INT);
-    /*
-     * FIXME do not hardcode endpoint type
-     */
+                max_packet,
+                ep_type);
 
     /*
      * Make sure we refuse OUT transactions until we explicitly
@@ -187,6 +195,16 @@ void PIOS_USBHOOK_RegisterEpOutCallback(uint8_t epnum, uint16_t max_len, pios_us
                     USB_OTG_EP_RX_NAK);
 }
 
+void PIOS_USBHOOK_RegisterEpOutCallback(uint8_t epnum, uint16_t max_len, pios_usbhook_epcb cb, uint32_t context)
+{
+    PIOS_USBHOOK_OpenEpOut(epnum, max_len, max_len, USB_OTG_EP_INT, cb, context);
+}
+
+void PIOS_USBHOOK_RegisterEpOutBulkCallback(uint8_t epnum, uint16_t max_packet, uint16_t max_len, pios_usbhook_epcb cb, uint32_t context)
+{
+    PIOS_USBHOOK_OpenEpOut(epnum, max_packet, max_len, USB_OTG_EP_BULK, cb, context);
+}
+
 extern void PIOS_USBHOOK_DeRegisterEpOutCallback(uint8_t epnum)
 {
     PIOS_Assert(epnum < NELEMENTS(usb_epout_table));
@@ -36,16 +36,26 @@
 #include "task.h"
 
 
-// framebuffer
-static ledbuf_t *fb = 0;
+// two framebuffers, the dma sends fb[front] while the next frame is encoded in the other
+static ledbuf_t *fb[2];
+static volatile uint8_t front;
+// a frame waits in the back buffer for the transfer in progress to end
+static volatile bool pending;
+// the colors set, and the colors each framebuffer holds
+static Color_t colors[PIOS_WS2811_NUMLEDS];
+static Color_t encoded[2][PIOS_WS2811_NUMLEDS];
 // bitmask with pin to be set/reset using dma
 static ledbuf_t dmaSource[4];
+// the dma words of the 4 bits of a nibble, msb first
+static ledbuf_t nibbleLut[16][4];
 
 static const struct pios_ws2811_cfg *pios_ws2811_cfg;
 static const struct pios_ws2811_pin_cfg *pios_ws2811_pin_cfg;
 
 static void setupTimer();
 static void setupDMA();
+static void startTransfer();
+static void encodeLed(Color_t c, ledbuf_t *buf);
 
 // generic wrapper around corresponding SPL functions
 static void genericTIM_OCxInit(TIM_TypeDef *TIMx, const TIM_OCInitTypeDef *TIM_OCInitStruct, uint8_t ch);
@@ -174,12 +184,25 @@ void PIOS_WS2811_Init(const struct pios_ws2811_cfg *ws2811_cfg, const struct pio
     for (uint8_t i = 0; i < 4; i++) {
         dmaSource[i] = (ledbuf_t)pios_ws2811_pin_cfg->gpioInit.GPIO_Pin;
     }
+    // a "1" bit leaves the pin high until Ch2, a "0" bit has Ch1 reset it
+    for (uint8_t n = 0; n < 16; n++) {
+        for (uint8_t i = 0; i < 4; i++) {
+            nibbleLut[n][i] = (n & (0b1000 >> i)) ? 0x0 : dmaSource[0];
+        }
+    }
 
-    fb = (ledbuf_t *)pios_malloc(PIOS_WS2811_BUFFER_SIZE * sizeof(ledbuf_t));
-    memset(fb, 0, PIOS_WS2811_BUFFER_SIZE * sizeof(ledbuf_t));
-    const Color_t ledoff = Color_Off;
+    ledbuf_t *buffers = (ledbuf_t *)pios_malloc(2 * PIOS_WS2811_BUFFER_SIZE * sizeof(ledbuf_t));
+    PIOS_Assert(buffers);
+    fb[0] = buffers;
+    fb[1] = buffers + PIOS_WS2811_BUFFER_SIZE;
+    for (uint8_t b = 0; b < 2; b++) {
+        for (uint8_t i = 0; i < PIOS_WS2811_NUMLEDS; i++) {
+            encodeLed(Color_Off, fb[b] + (i * 24));
+            encoded[b][i] = Color_Off;
+        }
+    }
     for (uint8_t i = 0; i < PIOS_WS2811_NUMLEDS; i++) {
-        PIOS_WS2811_setColorRGB(ledoff, i, false);
+        colors[i] = Color_Off;
     }
     // Setup timers
     setupTimer();
@@ -264,7 +287,7 @@ void setupDMA()
     // Configure Ch1
     DMA_Init(pios_ws2811_cfg->streamCh1, (DMA_InitTypeDef *)&pios_ws2811_cfg->dmaInitCh1);
     pios_ws2811_cfg->streamCh1->PAR  = (uint32_t)&pios_ws2811_pin_cfg->gpio->BSRRH;
-    pios_ws2811_cfg->streamCh1->M0AR = (uint32_t)fb;
+    pios_ws2811_cfg->streamCh1->M0AR = (uint32_t)fb[front];
 
     NVIC_Init((NVIC_InitTypeDef *)&(pios_ws2811_cfg->irq.init));
     DMA_ITConfig(pios_ws2811_cfg->streamCh1, DMA_IT_TC, ENABLE);
@@ -287,13 +310,22 @@ void setupDMA()
     DMA_Cmd(pios_ws2811_cfg->streamUpdate, ENABLE);
 }
 
-void setColor(uint8_t color, ledbuf_t *buf)
+static inline void setColor(uint8_t color, ledbuf_t *buf)
 {
-    uint8_t i;
+    memcpy(buf, nibbleLut[color >> 4], sizeof(nibbleLut[0]));
+    memcpy(buf + 4, nibbleLut[color & 0xf], sizeof(nibbleLut[0]));
+}
 
-    for (i = 0; i < 8; i++) {
-        buf[i] = ((color << i) & 0b10000000 ? 0x0 : dmaSource[0]);
-    }
+static void encodeLed(Color_t c, ledbuf_t *buf)
+{
+    setColor(c.G, buf);
+    setColor(c.R, buf + 8);
+    setColor(c.B, buf + 16);
+}
+
+static inline bool sameColor(Color_t a, Color_t b)
+{
+    return a.R == b.R && a.G == b.G && a.B == b.B;
 }
 
 /**
@@ -307,9 +339,8 @@ void PIOS_WS2811_setColorRGB(Color_t c, uint8_t led, bool update)
     if (led >= PIOS_WS2811_NUMLEDS) {
         return;
     }
-    setColor(c.G, fb + (led * 24));
-    setColor(c.R, fb + 8 + (led * 24));
-    setColor(c.B, fb + 16 + (led * 24));
+    // only kept here, PIOS_WS2811_Update encodes the leds that changed
+    colors[led] = c;
 
     if (update) {
         PIOS_WS2811_Update();
@@ -317,15 +348,52 @@ void PIOS_WS2811_setColorRGB(Color_t c, uint8_t led, bool update)
 }
 
 /**
- * trigger an update cycle if not already running
+ * Send the colors set if they differ from the last frame sent. The leds that
+ * changed are encoded in the back framebuffer, which is sent right away or,
+ * while a transfer is on going, as soon as it ends.
  */
 void PIOS_WS2811_Update()
 {
-    // does not start if framebuffer is not allocated (init has not been called yet) or a transfer is still on going
-    if (!fb || (pios_ws2811_cfg->timer->CR1 & TIM_CR1_CEN)) {
+    // does not start if framebuffer is not allocated (init has not been called yet)
+    if (!fb[0]) {
         return;
     }
 
+    // the irq swaps the buffers, keep it off while the back one is written
+    NVIC_DisableIRQ(pios_ws2811_cfg->irq.init.NVIC_IRQChannel);
+
+    uint8_t back = front ^ 1;
+    bool changed = false;
+    for (uint8_t i = 0; i < PIOS_WS2811_NUMLEDS; i++) {
+        if (!sameColor(encoded[back][i], colors[i])) {
+            encodeLed(colors[i], fb[back] + (i * 24));
+            encoded[back][i] = colors[i];
+        }
+        changed |= !sameColor(encoded[front][i], colors[i]);
+    }
+
+    if (pios_ws2811_cfg->timer->CR1 & TIM_CR1_CEN) {
+        pending = changed;
+    } else if (changed) {
+        front = back;
+        startTransfer();
+    }
+
+    NVIC_EnableIRQ(pios_ws2811_cfg->irq.init.NVIC_IRQChannel);
+}
+
+/**
+ * Send fb[front], the timer is stopped
+ */
+static void startTransfer()
+{
+    // M0AR can only be written once the stream is off
+    DMA_Cmd(pios_ws2811_cfg->streamCh1, DISABLE);
+    while (pios_ws2811_cfg->streamCh1->CR & DMA_SxCR_EN) {
+        ;
+    }
+    pios_ws2811_cfg->streamCh1->M0AR = (uint32_t)fb[front];
+
     // reset counters for synchronization
     pios_ws2811_cfg->timer->CNT = PIOS_WS2811_TIM_PERIOD - 1;
 
@@ -337,7 +405,8 @@ void PIOS_WS2811_Update()
 }
 
 /**
- * Stop timer once the complete framebuffer has been sent
+ * Stop timer once the complete framebuffer has been sent, then send the
+ * frame waiting in the back buffer if there is one
  */
 
 void PIOS_WS2811_DMA_irq_handler()
@@ -348,6 +417,12 @@ void PIOS_WS2811_DMA_irq_handler()
     DMA_Cmd(pios_ws2811_cfg->streamCh2, DISABLE);
     DMA_Cmd(pios_ws2811_cfg->streamCh1, DISABLE);
     DMA_Cmd(pios_ws2811_cfg->streamUpdate, DISABLE);
+
+    if (pending) {
+        pending = false;
+        front  ^= 1;
+        startTransfer();
+    }
 }
 
 #endif // PIOS_INCLUDE_WS2811
@@ -39,6 +39,7 @@
  */
 
 #define MODULE_INITCALL(ifn, sfn)
+#define MODULE_INITCALL_PARALLEL(ifn, sfn)
 
 #define MODULE_TASKCREATE_ALL
 
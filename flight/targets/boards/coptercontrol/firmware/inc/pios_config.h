@@ -140,6 +140,7 @@
 /* #define PIOS_INCLUDE_COM_FLEXI */
 /* #define PIOS_INCLUDE_COM_AUX */
 /* #define PIOS_TELEM_PRIORITY_QUEUE */
+/* #define PIOS_CRC_SLICE_BY_4 */
 #define PIOS_INCLUDE_GPS
 #define PIOS_GPS_MINIMAL
 /* #define PIOS_INCLUDE_GPS_NMEA_PARSER */
@@ -148,6 +149,8 @@
 
 /* Stabilization options */
 /* #define PIOS_QUATERNION_STABILIZATION */
+/* Integer attitude filter, F1 has no FPU */
+#define PIOS_ATTITUDE_FIXED_POINT
 #define PIOS_EXCLUDE_ADVANCED_FEATURES
 /* Performance counters */
 #define IDLE_COUNTS_PER_SEC_AT_NO_LOAD  1995998
@@ -178,6 +181,9 @@
 /* This can't be too high to stop eventdispatcher thread overflowing */
 #define PIOS_EVENTDISAPTCHER_QUEUE      10
 
+/* Events held by the event dispatcher and the modules subscribers together */
+#define PIOS_UAVOBJ_EVENT_POOL_SIZE     12
+
 /* Revolution series */
 /* #define REVOLUTION */
 
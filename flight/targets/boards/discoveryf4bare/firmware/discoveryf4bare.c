@@ -95,6 +95,11 @@ int main()
     /* Brings up System using CMSIS functions, enables the LEDs. */
     PIOS_SYS_Init();
 
+#ifdef PIOS_ENABLE_ITM_TRACE
+    /* before the first task is created, so that all are named in the trace */
+    PIOS_ITM_Init();
+#endif
+
     /* For Revolution we use a FreeRTOS task to bring up the system so we can */
     /* always rely on FreeRTOS primitive */
     result = xTaskCreate(initTask, "init",
@@ -65,6 +65,7 @@
 #define INCLUDE_xTaskGetCurrentTaskHandle            1
 #define INCLUDE_uxTaskGetStackHighWaterMark          1
 #define INCLUDE_xTaskGetIdleTaskHandle               1
+#define INCLUDE_xTimerPendFunctionCall               1
 
 
 /* This is the raw value as per the Cortex-M3 NVIC.  Values can be 255
@@ -97,6 +98,11 @@
     while (0)
 #define portGET_RUN_TIME_COUNTER_VALUE() (*(unsigned long *)0xe0001004) /* DWT_CYCCNT */
 
+/* scheduler and queue events streamed over SWO, see pios_itm.h */
+#ifdef PIOS_ENABLE_ITM_TRACE
+#include <pios_itm.h>
+#endif
+
 
 /**
  * @}
@@ -46,9 +46,13 @@ typedef void (*pFunction)(void);
 /* Private define ------------------------------------------------------------*/
 #define MAX_PACKET_DATA_LEN 255
 #define MAX_PACKET_BUF_SIZE (1 + 1 + MAX_PACKET_DATA_LEN + 2)
-#define UART_BUFFER_SIZE    256
 #define BL_WAIT_TIME        6 * 1000 * 1000
 #define DFU_BUFFER_SIZE     63
+// DFU packets are received through a window of SSP_RX_WINDOW packets, the fifo
+// must take a full window released at once on top of a partial DFU packet
+#define SSP_RX_WINDOW       4
+#define RX_PACKET_DATA_LEN  (DFU_BUFFER_SIZE + 1)
+#define UART_BUFFER_SIZE    ((SSP_RX_WINDOW + 1) * DFU_BUFFER_SIZE)
 
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
@@ -64,7 +68,7 @@ uint32_t sweep_steps2 = 100; // * 5 mS -> 500 mS
 static uint8_t process_buffer[DFU_BUFFER_SIZE];
 static uint8_t rx_buffer[UART_BUFFER_SIZE];
 static uint8_t txBuf[MAX_PACKET_BUF_SIZE];
-static uint8_t rxBuf[MAX_PACKET_BUF_SIZE];
+static uint8_t rxBuf[SSP_RX_WINDOW * SSP_PACKET_BUF_SIZE(RX_PACKET_DATA_LEN)];
 
 /* Extern variables ----------------------------------------------------------*/
 DFUStates DeviceState = DFUidle;
@@ -88,11 +92,13 @@ static void SSP_SerialWrite(uint8_t);
 
 static const PortConfig_t ssp_portConfig = {
     .rxBuf         = rxBuf,
-    .rxBufSize     = MAX_PACKET_DATA_LEN,
+    .rxBufSize     = RX_PACKET_DATA_LEN,
     .txBuf         = txBuf,
     .txBufSize     = MAX_PACKET_DATA_LEN,
     .max_retry     = 1,
     .timeoutLen    = 5000,
+    .txWindow      = 1,
+    .rxWindow      = SSP_RX_WINDOW,
     .pfCallBack    = SSP_CallBack,
     .pfSerialRead  = SSP_SerialRead,
     .pfSerialWrite = SSP_SerialWrite,
@@ -440,6 +440,13 @@ void PIOS_Board_Init(void)
         // Set the radio configuration parameters.
         PIOS_RFM22B_SetCoordinatorID(pios_rfm22b_id, oplinkSettings.CoordID);
         PIOS_RFM22B_SetChannelConfig(pios_rfm22b_id, datarate, oplinkSettings.MinChannel, oplinkSettings.MaxChannel, is_coordinator, is_oneway, ppm_mode, ppm_only);
+        // The parity options count by two bytes, the interleave ones double.
+        PIOS_RFM22B_SetFEC(pios_rfm22b_id, (oplinkSettings.FECParity + 1) * 2, 1 << oplinkSettings.FECInterleave);
+        // An all zero key leaves the packets unauthenticated.
+        if (oplinkSettings.AuthKey[0] | oplinkSettings.AuthKey[1] | oplinkSettings.AuthKey[2] | oplinkSettings.AuthKey[3]) {
+            PIOS_RFM22B_SetAuthKey(pios_rfm22b_id, (const uint8_t *)oplinkSettings.AuthKey, sizeof(oplinkSettings.AuthKey));
+        }
+        PIOS_RFM22B_SetAdaptiveRate(pios_rfm22b_id, oplinkSettings.AdaptiveRate == OPLINKSETTINGS_ADAPTIVERATE_TRUE);
 
         /* Set the PPM callback if we should be receiving PPM. */
         if (ppm_mode || (ppm_only && !is_coordinator)) {
@@ -304,13 +304,13 @@ extern uint32_t pios_packet_handler;
 #define PIOS_PH_MAX_PACKET      255
 #define PIOS_PH_WIN_SIZE        3
 #define PIOS_PH_MAX_CONNECTIONS 1
-#define RS_ECC_NPARITY          4
+#define RS_ECC_NPARITY          8
 
 // -------------------------
 // Reed-Solomon ECC
 // -------------------------
 
-#define RS_ECC_NPARITY 4
+#define RS_ECC_NPARITY 8
 
 // -------------------------
 // Flash EEPROM Emulation
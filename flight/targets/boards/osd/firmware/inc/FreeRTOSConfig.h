@@ -80,6 +80,7 @@
 #define configGENERATE_RUN_TIME_STATS                1
 #define INCLUDE_uxTaskGetRunTime                     1
 #define INCLUDE_xTaskGetIdleTaskHandle               1
+#define INCLUDE_xTimerPendFunctionCall               1
 
 /*
  * Once we move to CMSIS2 we can at least use:
@@ -725,7 +725,67 @@ static const struct flashfs_logfs_cfg flashfs_internal_cfg = {
 
 /*
  * MAIN USART
+ * DMA2 stream 2 (rx) and 7 (tx), channel 4
  */
+static const struct pios_usart_dma_cfg pios_usart_main_dma_cfg = {
+    .rx     = {
+        .channel = DMA2_Stream2,
+        .init    = {
+            .DMA_Channel            = DMA_Channel_4,
+            .DMA_PeripheralInc      = DMA_PeripheralInc_Disable,
+            .DMA_MemoryInc          = DMA_MemoryInc_Enable,
+            .DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte,
+            .DMA_MemoryDataSize     = DMA_MemoryDataSize_Byte,
+            .DMA_Priority           = DMA_Priority_Medium,
+            .DMA_FIFOMode           = DMA_FIFOMode_Disable,
+            .DMA_FIFOThreshold      = DMA_FIFOThreshold_Full,
+            .DMA_MemoryBurst        = DMA_MemoryBurst_Single,
+            .DMA_PeripheralBurst    = DMA_PeripheralBurst_Single,
+        },
+    },
+    .rx_irq = {
+        .flags = (DMA_IT_HTIF2 | DMA_IT_TCIF2),
+        .init  = {
+            .NVIC_IRQChannel    = DMA2_Stream2_IRQn,
+            .NVIC_IRQChannelPreemptionPriority = PIOS_IRQ_PRIO_MID,
+            .NVIC_IRQChannelSubPriority        = 0,
+            .NVIC_IRQChannelCmd = ENABLE,
+        },
+    },
+    .tx     = {
+        .channel = DMA2_Stream7,
+        .init    = {
+            .DMA_Channel            = DMA_Channel_4,
+            .DMA_PeripheralInc      = DMA_PeripheralInc_Disable,
+            .DMA_MemoryInc          = DMA_MemoryInc_Enable,
+            .DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte,
+            .DMA_MemoryDataSize     = DMA_MemoryDataSize_Byte,
+            .DMA_Priority           = DMA_Priority_Medium,
+            .DMA_FIFOMode           = DMA_FIFOMode_Disable,
+            .DMA_FIFOThreshold      = DMA_FIFOThreshold_Full,
+            .DMA_MemoryBurst        = DMA_MemoryBurst_Single,
+            .DMA_PeripheralBurst    = DMA_PeripheralBurst_Single,
+        },
+    },
+    .tx_irq = {
+        .flags = DMA_IT_TCIF7,
+        .init  = {
+            .NVIC_IRQChannel    = DMA2_Stream7_IRQn,
+            .NVIC_IRQChannelPreemptionPriority = PIOS_IRQ_PRIO_MID,
+            .NVIC_IRQChannelSubPriority        = 0,
+            .NVIC_IRQChannelCmd = ENABLE,
+        },
+    },
+};
+
+void PIOS_USART_main_dma_irq_handler(void);
+void DMA2_Stream2_IRQHandler(void) __attribute__((alias("PIOS_USART_main_dma_irq_handler")));
+void DMA2_Stream7_IRQHandler(void) __attribute__((alias("PIOS_USART_main_dma_irq_handler")));
+void PIOS_USART_main_dma_irq_handler(void)
+{
+    PIOS_USART_DMA_IRQ_Handler(USART1);
+}
+
 static const struct pios_usart_cfg pios_usart_main_cfg = {
     .regs  = USART1,
     .remap = GPIO_AF_USART1,
@@ -765,6 +825,7 @@ static const struct pios_usart_cfg pios_usart_main_cfg = {
             .GPIO_PuPd  = GPIO_PuPd_UP
         },
     },
+    .dma = &pios_usart_main_dma_cfg,
 };
 #endif /* PIOS_INCLUDE_COM_TELEM */
 
@@ -903,7 +964,67 @@ static const struct pios_sbus_cfg pios_sbus_cfg = {
 #ifdef PIOS_INCLUDE_COM_FLEXI
 /*
  * FLEXI PORT
+ * DMA1 stream 1 (rx) and 3 (tx), channel 4
  */
+static const struct pios_usart_dma_cfg pios_usart_flexi_dma_cfg = {
+    .rx     = {
+        .channel = DMA1_Stream1,
+        .init    = {
+            .DMA_Channel            = DMA_Channel_4,
+            .DMA_PeripheralInc      = DMA_PeripheralInc_Disable,
+            .DMA_MemoryInc          = DMA_MemoryInc_Enable,
+            .DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte,
+            .DMA_MemoryDataSize     = DMA_MemoryDataSize_Byte,
+            .DMA_Priority           = DMA_Priority_Medium,
+            .DMA_FIFOMode           = DMA_FIFOMode_Disable,
+            .DMA_FIFOThreshold      = DMA_FIFOThreshold_Full,
+            .DMA_MemoryBurst        = DMA_MemoryBurst_Single,
+            .DMA_PeripheralBurst    = DMA_PeripheralBurst_Single,
+        },
+    },
+    .rx_irq = {
+        .flags = (DMA_IT_HTIF1 | DMA_IT_TCIF1),
+        .init  = {
+            .NVIC_IRQChannel    = DMA1_Stream1_IRQn,
+            .NVIC_IRQChannelPreemptionPriority = PIOS_IRQ_PRIO_MID,
+            .NVIC_IRQChannelSubPriority        = 0,
+            .NVIC_IRQChannelCmd = ENABLE,
+        },
+    },
+    .tx     = {
+        .channel = DMA1_Stream3,
+        .init    = {
+            .DMA_Channel            = DMA_Channel_4,
+            .DMA_PeripheralInc      = DMA_PeripheralInc_Disable,
+            .DMA_MemoryInc          = DMA_MemoryInc_Enable,
+            .DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte,
+            .DMA_MemoryDataSize     = DMA_MemoryDataSize_Byte,
+            .DMA_Priority           = DMA_Priority_Medium,
+            .DMA_FIFOMode           = DMA_FIFOMode_Disable,
+            .DMA_FIFOThreshold      = DMA_FIFOThreshold_Full,
+            .DMA_MemoryBurst        = DMA_MemoryBurst_Single,
+            .DMA_PeripheralBurst    = DMA_PeripheralBurst_Single,
+        },
+    },
+    .tx_irq = {
+        .flags = DMA_IT_TCIF3,
+        .init  = {
+            .NVIC_IRQChannel    = DMA1_Stream3_IRQn,
+            .NVIC_IRQChannelPreemptionPriority = PIOS_IRQ_PRIO_MID,
+            .NVIC_IRQChannelSubPriority        = 0,
+            .NVIC_IRQChannelCmd = ENABLE,
+        },
+    },
+};
+
+void PIOS_USART_flexi_dma_irq_handler(void);
+void DMA1_Stream1_IRQHandler(void) __attribute__((alias("PIOS_USART_flexi_dma_irq_handler")));
+void DMA1_Stream3_IRQHandler(void) __attribute__((alias("PIOS_USART_flexi_dma_irq_handler")));
+void PIOS_USART_flexi_dma_irq_handler(void)
+{
+    PIOS_USART_DMA_IRQ_Handler(USART3);
+}
+
 static const struct pios_usart_cfg pios_usart_flexi_cfg = {
     .regs  = USART3,
     .remap = GPIO_AF_USART3,
@@ -944,6 +1065,7 @@ static const struct pios_usart_cfg pios_usart_flexi_cfg = {
             .GPIO_PuPd  = GPIO_PuPd_UP
         },
     },
+    .dma = &pios_usart_flexi_dma_cfg,
 };
 
 #endif /* PIOS_INCLUDE_COM_FLEXI */
@@ -65,6 +65,7 @@
 #define INCLUDE_xTaskGetCurrentTaskHandle            1
 #define INCLUDE_uxTaskGetStackHighWaterMark          1
 #define INCLUDE_xTaskGetIdleTaskHandle               1
+#define INCLUDE_xTimerPendFunctionCall               1
 
 /* This is the raw value as per the Cortex-M3 NVIC.  Values can be 255
    (lowest) to 1 (highest maskable) to 0 (highest non-maskable). */
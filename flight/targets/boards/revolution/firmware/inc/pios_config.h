@@ -53,11 +53,14 @@
 /* PIOS system functions */
 #define PIOS_INCLUDE_DELAY
 #define PIOS_INCLUDE_INITCALL
+#define PIOS_INCLUDE_INITCALL_PARALLEL /* independent modules initialise in a second task */
 #define PIOS_INCLUDE_SYS
 #define PIOS_INCLUDE_TASK_MONITOR
 
 #define PIOS_INCLUDE_INSTRUMENTATION
 #define PIOS_INSTRUMENTATION_MAX_COUNTERS 10
+#define PIOS_INSTRUMENTATION_MAX_PROFILES 8
+#define PIOS_INSTRUMENTATION_TRACE_EVENTS 256
 
 /* PIOS hardware peripherals */
 #define PIOS_INCLUDE_IRQ
@@ -117,11 +120,13 @@
 /* #define PIOS_INCLUDE_OVERO */
 /* #define PIOS_OVERO_SPI */
 /* #define PIOS_INCLUDE_SDCARD */
+/* #define PIOS_USE_DEBUGLOG_ON_SDCARD */
 /* #define LOG_FILENAME "startup.log" */
 #define PIOS_INCLUDE_FLASH
 #define PIOS_INCLUDE_FLASH_INTERNAL
 #define PIOS_INCLUDE_FLASH_LOGFS_SETTINGS
 #define FLASH_FREERTOS
+#define PIOS_FLASHFS_BACKGROUND_MAINTENANCE
 /* #define PIOS_INCLUDE_FLASH_EEPROM */
 
 /* PIOS radio modules */
@@ -143,6 +148,9 @@
 #define PIOS_INCLUDE_COM_FLEXI
 /* #define PIOS_INCLUDE_COM_AUX */
 #define PIOS_TELEM_PRIORITY_QUEUE
+#define PIOS_TELEM_SETTINGS_MANIFEST
+#define PIOS_TELEM_TIMESTAMPS
+#define PIOS_CRC_SLICE_BY_4
 #define PIOS_INCLUDE_GPS
 /* #define PIOS_GPS_MINIMAL */
 #define PIOS_INCLUDE_GPS_NMEA_PARSER
@@ -151,6 +159,8 @@
 
 /* Stabilization options */
 #define PIOS_QUATERNION_STABILIZATION
+/* Run the inner loop from the sensor task on every gyro sample */
+/* #define PIOS_STABILIZATION_GYRO_DIRECT */
 
 /* Performance counters */
 #define IDLE_COUNTS_PER_SEC_AT_NO_LOAD 8379692
@@ -174,6 +184,9 @@
 /* This can't be too high to stop eventdispatcher thread overflowing */
 #define PIOS_EVENTDISAPTCHER_QUEUE 10
 
+/* Multi instance objects keep their instances in blocks of this many, indexed in O(1) */
+#define PIOS_UAVOBJ_INSTANCE_CHUNK 8
+
 /* Revolution series */
 #define REVOLUTION
 
@@ -208,6 +208,8 @@ static const struct pios_mpu6000_cfg pios_mpu6000_cfg = {
     .fast_prescaler = PIOS_SPI_PRESCALER_4,
     .std_prescaler  = PIOS_SPI_PRESCALER_64,
     .max_downsample = 20,
+    // at 8kHz read the fifo once every 8 samples
+    .fifo_burst     = 8,
 };
 #endif /* PIOS_INCLUDE_MPU6000 */
 
@@ -226,6 +228,10 @@ uint32_t pios_rcvr_group_map[MANUALCONTROLSETTINGS_CHANNELGROUPS_NONE];
 #define PIOS_COM_TELEM_USB_RX_BUF_LEN    65
 #define PIOS_COM_TELEM_USB_TX_BUF_LEN    65
 
+/* the VCP carries telemetry in multi packet bulk transfers */
+#define PIOS_COM_TELEM_VCP_RX_BUF_LEN    256
+#define PIOS_COM_TELEM_VCP_TX_BUF_LEN    1024
+
 #define PIOS_COM_BRIDGE_RX_BUF_LEN       65
 #define PIOS_COM_BRIDGE_TX_BUF_LEN       12
 
@@ -558,13 +564,13 @@ void PIOS_Board_Init(void)
     case HWSETTINGS_USB_VCPPORT_USBTELEMETRY:
 #if defined(PIOS_INCLUDE_COM)
         {
-            uint8_t *rx_buffer = (uint8_t *)pios_malloc(PIOS_COM_TELEM_USB_RX_BUF_LEN);
-            uint8_t *tx_buffer = (uint8_t *)pios_malloc(PIOS_COM_TELEM_USB_TX_BUF_LEN);
+            uint8_t *rx_buffer = (uint8_t *)pios_malloc(PIOS_COM_TELEM_VCP_RX_BUF_LEN);
+            uint8_t *tx_buffer = (uint8_t *)pios_malloc(PIOS_COM_TELEM_VCP_TX_BUF_LEN);
             PIOS_Assert(rx_buffer);
             PIOS_Assert(tx_buffer);
             if (PIOS_COM_Init(&pios_com_telem_usb_id, &pios_usb_cdc_com_driver, pios_usb_cdc_id,
-                              rx_buffer, PIOS_COM_TELEM_USB_RX_BUF_LEN,
-                              tx_buffer, PIOS_COM_TELEM_USB_TX_BUF_LEN)) {
+                              rx_buffer, PIOS_COM_TELEM_VCP_RX_BUF_LEN,
+                              tx_buffer, PIOS_COM_TELEM_VCP_TX_BUF_LEN)) {
                 PIOS_Assert(0);
             }
         }
@@ -619,7 +625,8 @@ void PIOS_Board_Init(void)
         break;
     case HWSETTINGS_USB_HIDPORT_USBTELEMETRY:
 #if defined(PIOS_INCLUDE_COM)
-        {
+        /* telemetry explicitly moved to the VCP takes precedence */
+        if (!pios_com_telem_usb_id) {
             uint8_t *rx_buffer = (uint8_t *)pios_malloc(PIOS_COM_TELEM_USB_RX_BUF_LEN);
             uint8_t *tx_buffer = (uint8_t *)pios_malloc(PIOS_COM_TELEM_USB_TX_BUF_LEN);
             PIOS_Assert(rx_buffer);
@@ -773,6 +780,13 @@ void PIOS_Board_Init(void)
         /* Set the radio configuration parameters. */
         PIOS_RFM22B_SetCoordinatorID(pios_rfm22b_id, oplinkSettings.CoordID);
         PIOS_RFM22B_SetChannelConfig(pios_rfm22b_id, datarate, oplinkSettings.MinChannel, oplinkSettings.MaxChannel, is_coordinator, is_oneway, ppm_mode, ppm_only);
+        // The parity options count by two bytes, the interleave ones double.
+        PIOS_RFM22B_SetFEC(pios_rfm22b_id, (oplinkSettings.FECParity + 1) * 2, 1 << oplinkSettings.FECInterleave);
+        // An all zero key leaves the packets unauthenticated.
+        if (oplinkSettings.AuthKey[0] | oplinkSettings.AuthKey[1] | oplinkSettings.AuthKey[2] | oplinkSettings.AuthKey[3]) {
+            PIOS_RFM22B_SetAuthKey(pios_rfm22b_id, (const uint8_t *)oplinkSettings.AuthKey, sizeof(oplinkSettings.AuthKey));
+        }
+        PIOS_RFM22B_SetAdaptiveRate(pios_rfm22b_id, oplinkSettings.AdaptiveRate == OPLINKSETTINGS_ADAPTIVERATE_TRUE);
 
         /* Set the PPM callback if we should be receiving PPM. */
         if (ppm_mode || (ppm_only && !is_coordinator)) {
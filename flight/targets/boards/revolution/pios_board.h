@@ -169,7 +169,7 @@ extern uint32_t pios_spi_telem_flash_id;
 // -------------------------
 // Packet Handler
 // -------------------------
-#define RS_ECC_NPARITY          4
+#define RS_ECC_NPARITY          8
 #define PIOS_PH_MAX_PACKET      255
 #define PIOS_PH_WIN_SIZE        3
 #define PIOS_PH_MAX_CONNECTIONS 1
@@ -298,6 +298,10 @@ uint32_t pios_rcvr_group_map[MANUALCONTROLSETTINGS_CHANNELGROUPS_NONE];
 #define PIOS_COM_TELEM_USB_RX_BUF_LEN 65
 #define PIOS_COM_TELEM_USB_TX_BUF_LEN 65
 
+/* the VCP carries telemetry in multi packet bulk transfers */
+#define PIOS_COM_TELEM_VCP_RX_BUF_LEN 256
+#define PIOS_COM_TELEM_VCP_TX_BUF_LEN 1024
+
 #define PIOS_COM_BRIDGE_RX_BUF_LEN    65
 #define PIOS_COM_BRIDGE_TX_BUF_LEN    12
 
@@ -541,13 +545,13 @@ void PIOS_Board_Init(void)
     case HWSETTINGS_USB_VCPPORT_USBTELEMETRY:
 #if defined(PIOS_INCLUDE_COM)
         {
-            uint8_t *rx_buffer = (uint8_t *)pios_malloc(PIOS_COM_TELEM_USB_RX_BUF_LEN);
-            uint8_t *tx_buffer = (uint8_t *)pios_malloc(PIOS_COM_TELEM_USB_TX_BUF_LEN);
+            uint8_t *rx_buffer = (uint8_t *)pios_malloc(PIOS_COM_TELEM_VCP_RX_BUF_LEN);
+            uint8_t *tx_buffer = (uint8_t *)pios_malloc(PIOS_COM_TELEM_VCP_TX_BUF_LEN);
             PIOS_Assert(rx_buffer);
             PIOS_Assert(tx_buffer);
             if (PIOS_COM_Init(&pios_com_telem_usb_id, &pios_usb_cdc_com_driver, pios_usb_cdc_id,
-                              rx_buffer, PIOS_COM_TELEM_USB_RX_BUF_LEN,
-                              tx_buffer, PIOS_COM_TELEM_USB_TX_BUF_LEN)) {
+                              rx_buffer, PIOS_COM_TELEM_VCP_RX_BUF_LEN,
+                              tx_buffer, PIOS_COM_TELEM_VCP_TX_BUF_LEN)) {
                 PIOS_Assert(0);
             }
         }
@@ -602,7 +606,8 @@ void PIOS_Board_Init(void)
         break;
     case HWSETTINGS_USB_HIDPORT_USBTELEMETRY:
 #if defined(PIOS_INCLUDE_COM)
-        {
+        /* telemetry explicitly moved to the VCP takes precedence */
+        if (!pios_com_telem_usb_id) {
             uint8_t *rx_buffer = (uint8_t *)pios_malloc(PIOS_COM_TELEM_USB_RX_BUF_LEN);
             uint8_t *tx_buffer = (uint8_t *)pios_malloc(PIOS_COM_TELEM_USB_TX_BUF_LEN);
             PIOS_Assert(rx_buffer);
@@ -31,11 +31,16 @@
 
 #include <pios_udp_priv.h>
 
+/*
+ * The ports below are not const, PIOS_Board_Init() moves them by
+ * OP_SIM_PORT_OFFSET so that several simulations can run on one host
+ */
+
 #ifdef PIOS_INCLUDE_COM_TELEM
 /*
  * Telemetry on main USART
  */
-const struct pios_udp_cfg pios_udp_telem_cfg = {
+struct pios_udp_cfg pios_udp_telem_cfg = {
     .ip   = "0.0.0.0",
     .port = 9000,
 };
@@ -45,7 +50,7 @@ const struct pios_udp_cfg pios_udp_telem_cfg = {
 /*
  * GPS USART
  */
-const struct pios_udp_cfg pios_udp_gps_cfg = {
+struct pios_udp_cfg pios_udp_gps_cfg = {
     .ip   = "0.0.0.0",
     .port = 9001,
 };
@@ -56,7 +61,7 @@ const struct pios_udp_cfg pios_udp_gps_cfg = {
 /*
  * AUX USART (UART label on rev2)
  */
-const struct pios_udp_cfg pios_udp_aux_cfg = {
+struct pios_udp_cfg pios_udp_aux_cfg = {
     .ip   = "0.0.0.0",
     .port = 9002,
 };
@@ -64,6 +69,16 @@ const struct pios_udp_cfg pios_udp_aux_cfg = {
 
 #endif /* PIOS_UDP */
 
+#ifdef PIOS_INCLUDE_SIMSTEP
+/*
+ * Lock-step simulation requests
+ */
+struct pios_simstep_cfg pios_simstep_cfg = {
+    .ip   = "0.0.0.0",
+    .port = 9003,
+};
+#endif /* PIOS_INCLUDE_SIMSTEP */
+
 #if defined(PIOS_INCLUDE_COM)
 
 #include <pios_com_priv.h>
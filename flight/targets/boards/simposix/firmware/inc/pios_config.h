@@ -60,6 +60,7 @@
 #define PIOS_INCLUDE_RTC
 #define PIOS_INCLUDE_WDG
 #define PIOS_INCLUDE_UDP
+#define PIOS_INCLUDE_SIMSTEP
 
 /* Select the sensors to include */
 // #define PIOS_INCLUDE_BMA180
@@ -105,6 +106,9 @@
 /* Flags that alter behaviors - mostly to lower resources for CC */
 #define PIOS_INCLUDE_INITCALL          /* Include init call structures */
 #define PIOS_TELEM_PRIORITY_QUEUE      /* Enable a priority queue in telemetry */
+#define PIOS_TELEM_SETTINGS_MANIFEST   /* Maintain the SettingsManifest for fast GCS connects */
+#define PIOS_TELEM_TIMESTAMPS          /* Timestamp the object updates sent to the GCS */
+#define PIOS_CRC_SLICE_BY_4            /* Four bytes per table round in PIOS_CRC_updateCRC */
 #define PIOS_QUATERNION_STABILIZATION  /* Stabilization options */
 // #define PIOS_GPS_SETS_HOMELOCATION      /* GPS options */
 
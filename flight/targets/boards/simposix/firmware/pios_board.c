@@ -110,6 +110,34 @@ static void PIOS_Board_configure_com(const struct pios_udp_cfg *usart_port_cfg,
     }
 }
 
+/*
+ * Move all the UDP ports of this instance by OP_SIM_PORT_OFFSET
+ */
+static void PIOS_Board_offset_ports(void)
+{
+    const char *env = getenv("OP_SIM_PORT_OFFSET");
+
+    if (!env) {
+        return;
+    }
+    uint16_t offset = strtoul(env, NULL, 0);
+
+#ifdef PIOS_INCLUDE_UDP
+#ifdef PIOS_INCLUDE_COM_TELEM
+    pios_udp_telem_cfg.port += offset;
+#endif
+#ifdef PIOS_INCLUDE_GPS
+    pios_udp_gps_cfg.port   += offset;
+#endif
+#ifdef PIOS_INCLUDE_COM_AUX
+    pios_udp_aux_cfg.port   += offset;
+#endif
+#endif /* PIOS_INCLUDE_UDP */
+#ifdef PIOS_INCLUDE_SIMSTEP
+    pios_simstep_cfg.port   += offset;
+#endif
+}
+
 /**
  * PIOS_Board_Init()
  * initializes all the core subsystems on this specific hardware
@@ -120,6 +148,13 @@ void PIOS_Board_Init(void)
     /* Delay system */
     PIOS_DELAY_Init();
 
+    PIOS_Board_offset_ports();
+
+#if defined(PIOS_INCLUDE_SIMSTEP)
+    /* Ticks stay free running until a simulation asks for lock-step */
+    PIOS_SIMSTEP_Init(&pios_simstep_cfg);
+#endif
+
     // Initialize logfs for settings.
     // If linking in yaffs for testing, this will be /dev0 with settings stored
     // via the logfs object api in /dev0/logfs/
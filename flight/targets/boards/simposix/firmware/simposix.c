@@ -94,6 +94,12 @@ int main()
     /* Brings up System using CMSIS functions, enables the LEDs. */
     PIOS_SYS_Init();
 
+    /* For profiling, real time priorities on one CPU (or -1 for any), before the first task exists */
+    const char *env = getenv("OP_SIM_REALTIME");
+    if (env) {
+        xPortSetRealtime(strtol(env, NULL, 0));
+    }
+
     /* For Revolution we use a FreeRTOS task to bring up the system so we can */
     /* always rely on FreeRTOS primitive */
     result = xTaskCreate(initTask, "init",
@@ -101,6 +107,12 @@ int main()
                          &initTaskHandle);
     PIOS_Assert(result == pdPASS);
 
+    /* For benchmarks, ticks as fast as the tasks allow, each given this many us at most */
+    env = getenv("OP_SIM_VIRTUAL_TIME");
+    if (env) {
+        vPortSetVirtualTicks(strtol(env, NULL, 0));
+    }
+
     /* Start the FreeRTOS scheduler */
     vTaskStartScheduler();
 
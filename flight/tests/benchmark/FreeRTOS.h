@@ -0,0 +1,77 @@
+/**
+ ******************************************************************************
+ *
+ * @file       FreeRTOS.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      FreeRTOS stubs, the benchmarks run in a single thread
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+typedef uint32_t portTickType;
+typedef void *xSemaphoreHandle;
+typedef void *xQueueHandle;
+
+#define pdFALSE            0
+#define pdTRUE             1
+#define portMAX_DELAY      ((portTickType)0xffffffff)
+#define portTICK_RATE_MS   ((portTickType)1)
+
+#define pvPortMalloc(xSize) (malloc(xSize))
+#define vPortFree(pv)       (free(pv))
+
+/* with a single thread the locks are always free, and no response ever comes */
+static inline xSemaphoreHandle xSemaphoreCreateRecursiveMutex(void)
+{
+    return (xSemaphoreHandle)1;
+}
+
+#define vSemaphoreCreateBinary(xSemaphore) ((xSemaphore) = (xSemaphoreHandle)1)
+
+static inline long xSemaphoreTake(__attribute__((unused)) xSemaphoreHandle xSemaphore, __attribute__((unused)) portTickType xBlockTime)
+{
+    return 0;
+}
+
+static inline long xSemaphoreGive(__attribute__((unused)) xSemaphoreHandle xSemaphore)
+{
+    return 1;
+}
+
+static inline long xSemaphoreTakeRecursive(__attribute__((unused)) xSemaphoreHandle xMutex, __attribute__((unused)) portTickType xBlockTime)
+{
+    return 1;
+}
+
+static inline long xSemaphoreGiveRecursive(__attribute__((unused)) xSemaphoreHandle xMutex)
+{
+    return 1;
+}
+
+static inline portTickType xTaskGetTickCount(void)
+{
+    return 0;
+}
+
+#endif /* FREERTOS_H */
@@ -0,0 +1,151 @@
+/**
+ ******************************************************************************
+ *
+ * @file       bench.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Micro-benchmark harness for the flight libraries
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef BENCH_CYCLES
+/*
+ * On target the DWT cycle counter of the Cortex-M3/M4 is the clock, the core
+ * debug registers are accessed directly so that no CMSIS header is needed
+ */
+#define BENCH_DEMCR      (*(volatile uint32_t *)0xE000EDFC)
+#define BENCH_DWT_CTRL   (*(volatile uint32_t *)0xE0001000)
+#define BENCH_DWT_CYCCNT (*(volatile uint32_t *)0xE0001004)
+
+#define BENCH_UNIT       "cycles"
+/* a sample long enough to dwarf the loop overhead, but far from a counter wrap */
+#define BENCH_MIN_SAMPLE 1000000
+
+static void bench_clock_init(void)
+{
+    BENCH_DEMCR     |= (1 << 24); /* TRCENA */
+    BENCH_DWT_CYCCNT = 0;
+    BENCH_DWT_CTRL  |= 1; /* CYCCNTENA */
+}
+
+/* the difference of two readings stays right across a wrap of the counter */
+typedef uint32_t bench_time_t;
+
+static inline bench_time_t bench_clock(void)
+{
+    return BENCH_DWT_CYCCNT;
+}
+
+#else /* BENCH_CYCLES */
+
+#include <time.h>
+
+#define BENCH_UNIT       "ns"
+/* 10ms samples, long enough for the clock resolution and short enough between interrupts */
+#define BENCH_MIN_SAMPLE 10000000
+
+static void bench_clock_init(void)
+{}
+
+typedef uint64_t bench_time_t;
+
+static inline bench_time_t bench_clock(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+#endif /* BENCH_CYCLES */
+
+static const char *filter;
+static uint32_t count;
+
+static int compare_float(const void *a, const void *b)
+{
+    float fa = *(const float *)a;
+    float fb = *(const float *)b;
+
+    return (fa > fb) - (fa < fb);
+}
+
+static bench_time_t bench_sample(bench_fn fn, void *ctx, uint32_t iterations)
+{
+    bench_time_t start = bench_clock();
+
+    fn(ctx, iterations);
+    return bench_clock() - start;
+}
+
+/**
+ * Parse the command line: an optional word selects the benchmarks whose name contains it
+ */
+void bench_init(int argc, char *argv[])
+{
+    if (argc > 1) {
+        filter = argv[1];
+    }
+    bench_clock_init();
+    printf("%-44s %12s %14s %14s %8s\n", "benchmark", "iterations", BENCH_UNIT "/op median", BENCH_UNIT "/op min", "spread");
+}
+
+/**
+ * Time fn and print the cost of one operation
+ */
+void bench_run(const char *name, bench_fn fn, void *ctx)
+{
+    if (filter && !strstr(name, filter)) {
+        return;
+    }
+
+    /* warm the caches and the branch predictors, then find a sample length */
+    uint32_t iterations = 1;
+    fn(ctx, iterations);
+    while (bench_sample(fn, ctx, iterations) < BENCH_MIN_SAMPLE && iterations < 0x40000000) {
+        iterations *= 2;
+    }
+
+    float per_op[BENCH_SAMPLES];
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        per_op[i] = (float)bench_sample(fn, ctx, iterations) / iterations;
+    }
+    qsort(per_op, BENCH_SAMPLES, sizeof(per_op[0]), compare_float);
+
+    float median = per_op[BENCH_SAMPLES / 2];
+    /* spread between the quartiles, a large one means the figures can't be trusted */
+    float spread = median > 0 ? (per_op[3 * BENCH_SAMPLES / 4] - per_op[BENCH_SAMPLES / 4]) / median : 0;
+    printf("%-44s %12u %14.1f %14.1f %7.1f%%\n", name, (unsigned)iterations, (double)median, (double)per_op[0], (double)(spread * 100));
+    fflush(stdout);
+    count++;
+}
+
+/**
+ * \return the exit code, failing when the filter matched nothing
+ */
+int bench_done(void)
+{
+    return count ? EXIT_SUCCESS : EXIT_FAILURE;
+}
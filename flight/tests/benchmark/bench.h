@@ -0,0 +1,52 @@
+/**
+ ******************************************************************************
+ *
+ * @file       bench.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Micro-benchmark harness for the flight libraries
+ *
+ * A benchmark is a function running its operation a given number of times.
+ * The harness finds how many iterations make a sample long enough to time,
+ * takes BENCH_SAMPLES samples and reports the median and minimum cost of one
+ * operation, in ns on the host or in CPU cycles with BENCH_CYCLES on target.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BENCH_SAMPLES 11
+
+/* run the operation iterations times, ctx is the one given to bench_run() */
+typedef void (*bench_fn)(void *ctx, uint32_t iterations);
+
+/* keep the compiler from optimising away a result nobody reads */
+#define BENCH_KEEP(x) __asm__ volatile ("" : : "g" (x) : "memory")
+
+/* make the compiler forget what it knows about the memory, so that inputs are read again */
+#define BENCH_CLOBBER() __asm__ volatile ("" : : : "memory")
+
+void bench_init(int argc, char *argv[]);
+void bench_run(const char *name, bench_fn fn, void *ctx);
+int bench_done(void);
+
+#endif /* BENCH_H */
@@ -0,0 +1,107 @@
+/**
+ ******************************************************************************
+ *
+ * @file       bench_buffers.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Benchmarks of the byte FIFO and the CRCs
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "bench.h"
+#include "benchmarks.h"
+
+#include <string.h>
+#include <fifo_buffer.h>
+#include <pios_crc.h>
+
+/* a typical telemetry frame */
+#define BENCH_FRAME_SIZE 64
+
+struct fifo_ctx {
+    t_fifo_buffer fifo;
+    uint8_t buffer[256];
+    uint8_t frame[BENCH_FRAME_SIZE];
+};
+
+static void bench_fifo_frame(void *ctx, uint32_t iterations)
+{
+    struct fifo_ctx *f = ctx;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        fifoBuf_putData(&f->fifo, f->frame, sizeof(f->frame));
+        BENCH_KEEP(fifoBuf_getData(&f->fifo, f->frame, sizeof(f->frame)));
+    }
+}
+
+static void bench_fifo_byte(void *ctx, uint32_t iterations)
+{
+    struct fifo_ctx *f = ctx;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        fifoBuf_putByte(&f->fifo, (uint8_t)i);
+        BENCH_KEEP(fifoBuf_getByte(&f->fifo));
+    }
+}
+
+static void bench_crc8(void *ctx, uint32_t iterations)
+{
+    const uint8_t *frame = ctx;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        BENCH_CLOBBER();
+        BENCH_KEEP(PIOS_CRC_updateCRC(0, frame, BENCH_FRAME_SIZE));
+    }
+}
+
+static void bench_crc16(void *ctx, uint32_t iterations)
+{
+    const uint8_t *frame = ctx;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        BENCH_CLOBBER();
+        BENCH_KEEP(PIOS_CRC16_updateCRC(0, frame, BENCH_FRAME_SIZE));
+    }
+}
+
+static void bench_crc32(void *ctx, uint32_t iterations)
+{
+    const uint8_t *frame = ctx;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        BENCH_CLOBBER();
+        BENCH_KEEP(PIOS_CRC32_updateCRC(0, frame, BENCH_FRAME_SIZE));
+    }
+}
+
+void bench_buffers(void)
+{
+    static struct fifo_ctx f;
+
+    fifoBuf_init(&f.fifo, f.buffer, sizeof(f.buffer));
+    for (uint32_t i = 0; i < sizeof(f.frame); i++) {
+        f.frame[i] = (uint8_t)(i * 7);
+    }
+
+    bench_run("fifo/putData+getData 64 bytes", bench_fifo_frame, &f);
+    bench_run("fifo/putByte+getByte", bench_fifo_byte, &f);
+    bench_run("crc/CRC8 64 bytes", bench_crc8, f.frame);
+    bench_run("crc/CRC16 64 bytes", bench_crc16, f.frame);
+    bench_run("crc/CRC32 64 bytes", bench_crc32, f.frame);
+}
@@ -0,0 +1,142 @@
+/**
+ ******************************************************************************
+ *
+ * @file       bench_crypto.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Benchmarks of the radio link MAC and cipher primitives
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "bench.h"
+#include "benchmarks.h"
+
+#include <string.h>
+#include <hmac_sha1.h>
+#include <aes.h>
+
+/* a typical OPLink packet */
+#define BENCH_PACKET_SIZE 64
+
+struct crypto_ctx {
+    uint8_t  packet[BENCH_PACKET_SIZE];
+    uint8_t  key[16];
+    uint8_t  mac[SHA1_DIGEST_LENGTH];
+    HMAC_SHA1_CTX hmac;
+    uint32_t round_key[AES_128_ROUND_KEYS];
+    uint8_t  counter[N_BLOCK];
+};
+
+/* HMAC-SHA1 hashing both key pads for every message, as the radio driver used to */
+static void hmac_sha1_reference(const uint8_t *data, unsigned int len, const uint8_t *key, unsigned int keylen, uint8_t *digest)
+{
+    uint8_t ipad[64] = { 0 };
+    uint8_t opad[64] = { 0 };
+    SHA1_CTX sha;
+
+    memcpy(ipad, key, keylen);
+    memcpy(opad, key, keylen);
+    for (int i = 0; i < 64; i++) {
+        ipad[i] ^= 0x36;
+        opad[i] ^= 0x5c;
+    }
+
+    SHA1Init(&sha);
+    SHA1Update(&sha, ipad, sizeof(ipad));
+    SHA1Update(&sha, data, len);
+    SHA1Final(digest, &sha);
+
+    SHA1Init(&sha);
+    SHA1Update(&sha, opad, sizeof(opad));
+    SHA1Update(&sha, digest, SHA1_DIGEST_LENGTH);
+    SHA1Final(digest, &sha);
+}
+
+static void bench_hmac_reference(void *ctx, uint32_t iterations)
+{
+    struct crypto_ctx *c = ctx;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        hmac_sha1_reference(c->packet, sizeof(c->packet), c->key, sizeof(c->key), c->mac);
+        BENCH_KEEP(c->mac[0]);
+    }
+}
+
+static void bench_hmac_precomputed(void *ctx, uint32_t iterations)
+{
+    struct crypto_ctx *c = ctx;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        HMACSHA1(&c->hmac, c->packet, sizeof(c->packet), c->mac, 4);
+        BENCH_KEEP(c->mac[0]);
+    }
+}
+
+static void bench_aes_bytes(void *ctx, uint32_t iterations)
+{
+    struct crypto_ctx *c = ctx;
+    uint8_t key[16];
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        /* the key is updated on the fly, so it has to be restored for each block */
+        memcpy(key, c->key, sizeof(key));
+        aes_encrypt_cbc_128(c->packet, key, NULL);
+        BENCH_KEEP(c->packet[0]);
+    }
+}
+
+static void bench_aes_words(void *ctx, uint32_t iterations)
+{
+    struct crypto_ctx *c = ctx;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        aes_encrypt_128(c->round_key, c->packet, c->packet);
+        BENCH_KEEP(c->packet[0]);
+    }
+}
+
+static void bench_aes_ctr(void *ctx, uint32_t iterations)
+{
+    struct crypto_ctx *c = ctx;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        aes_ctr_128(c->round_key, c->counter, c->packet, sizeof(c->packet));
+        BENCH_KEEP(c->packet[0]);
+    }
+}
+
+void bench_crypto(void)
+{
+    static struct crypto_ctx c;
+
+    for (uint32_t i = 0; i < sizeof(c.packet); i++) {
+        c.packet[i] = (uint8_t)(i * 13);
+    }
+    for (uint32_t i = 0; i < sizeof(c.key); i++) {
+        c.key[i] = (uint8_t)(i * 29 + 1);
+    }
+    HMACSHA1Init(&c.hmac, c.key, sizeof(c.key));
+    aes_key_128_expand(c.key, c.round_key);
+
+    bench_run("crypto/HMAC-SHA1 64 bytes", bench_hmac_reference, &c);
+    bench_run("crypto/HMAC-SHA1 precomputed pads 64 bytes", bench_hmac_precomputed, &c);
+    bench_run("crypto/AES-128 byte oriented block", bench_aes_bytes, &c);
+    bench_run("crypto/AES-128 table block", bench_aes_words, &c);
+    bench_run("crypto/AES-128 CTR 64 bytes", bench_aes_ctr, &c);
+}
@@ -0,0 +1,88 @@
+/**
+ ******************************************************************************
+ *
+ * @file       bench_insgps13.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Benchmarks of the 13 and 16 state INS/GPS filter
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "bench.h"
+#include "benchmarks.h"
+
+#include <insgps.h>
+
+/* sensor readings of a vehicle hovering still, at the rates of filterekf */
+static float gyro[3]  = { 0.01f, -0.02f, 0.005f };
+static float accel[3] = { 0.1f, -0.1f, -9.81f };
+static float mag[3]   = { 400.0f, 20.0f, 400.0f };
+static float pos[3]   = { 1.0f, -2.0f, -3.0f };
+static float vel[3]   = { 0.1f, 0.0f, -0.1f };
+static float baro     = 3.0f;
+
+static void bench_reset(uint16_t num_states)
+{
+    float q[4]   = { 1.0f, 0.0f, 0.0f, 0.0f };
+    float zeros[3] = { 0.0f, 0.0f, 0.0f };
+
+    INSGPSInit(num_states);
+    INSSetMagNorth((float[3]) { 400.0f, 20.0f, 400.0f });
+    INSSetMagVar((float[3]) { 0.01f, 0.01f, 0.01f });
+    INSSetPosVelVar((float[3]) { 1.0f, 1.0f, 1.0f }, (float[3]) { 1.0f, 1.0f, 1.0f });
+    INSSetState(pos, vel, q, zeros, zeros);
+}
+
+static void bench_state_prediction(__attribute__((unused)) void *ctx, uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        INSStatePrediction(gyro, accel, 0.002f);
+    }
+}
+
+static void bench_covariance_prediction(__attribute__((unused)) void *ctx, uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        INSCovariancePrediction(0.002f);
+    }
+}
+
+static void bench_correction(__attribute__((unused)) void *ctx, uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        INSCorrection(mag, pos, vel, baro, FULL_SENSORS);
+    }
+}
+
+void bench_insgps13(void)
+{
+    bench_reset(INSGPS_13STATE);
+    bench_run("insgps13/INSStatePrediction", bench_state_prediction, NULL);
+    bench_reset(INSGPS_13STATE);
+    bench_run("insgps13/INSCovariancePrediction", bench_covariance_prediction, NULL);
+    bench_reset(INSGPS_13STATE);
+    bench_run("insgps13/INSCorrection full", bench_correction, NULL);
+
+    bench_reset(INSGPS_16STATE);
+    bench_run("insgps16/INSStatePrediction", bench_state_prediction, NULL);
+    bench_reset(INSGPS_16STATE);
+    bench_run("insgps16/INSCovariancePrediction", bench_covariance_prediction, NULL);
+    bench_reset(INSGPS_16STATE);
+    bench_run("insgps16/INSCorrection full", bench_correction, NULL);
+}
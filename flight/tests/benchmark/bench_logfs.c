@@ -0,0 +1,113 @@
+/**
+ ******************************************************************************
+ *
+ * @file       bench_logfs.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Benchmarks of the settings filesystem
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "bench.h"
+#include "benchmarks.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "pios.h"
+#include "pios_flash_ut_priv.h"
+#include "pios_flashfs_logfs_priv.h"
+
+/* the flash layout of the logfs unit test, one arena fills up every 256 saves */
+static const struct pios_flash_ut_cfg flash_config = {
+    .size_of_flash  = 0x00100000,
+    .size_of_sector = 0x00010000,
+};
+
+static const struct flashfs_logfs_cfg flashfs_config = {
+    .fs_magic      = 0x89abceef,
+    .total_fs_size = 0x00100000, /* 1M bytes (16 sectors) */
+    .arena_size    = 0x00010000, /* 256 * slot size */
+    .slot_size     = 0x00000100, /* 256 bytes */
+
+    .start_offset  = 0,
+    .sector_size   = 0x00010000, /* 64K bytes */
+    .page_size     = 0x00000100, /* 256 bytes */
+};
+
+#define BENCH_OBJ_ID   0x12345678
+#define BENCH_OBJ_SIZE 120
+
+struct logfs_ctx {
+    uintptr_t fs_id;
+    uint8_t   obj[BENCH_OBJ_SIZE];
+};
+
+static void bench_save(void *ctx, uint32_t iterations)
+{
+    struct logfs_ctx *l = ctx;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        l->obj[0] = (uint8_t)i;
+        PIOS_FLASHFS_ObjSave(l->fs_id, BENCH_OBJ_ID, 0, l->obj, sizeof(l->obj));
+    }
+}
+
+static void bench_load(void *ctx, uint32_t iterations)
+{
+    struct logfs_ctx *l = ctx;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        PIOS_FLASHFS_ObjLoad(l->fs_id, BENCH_OBJ_ID, 0, l->obj, sizeof(l->obj));
+        BENCH_KEEP(l->obj[0]);
+    }
+}
+
+void bench_logfs(void)
+{
+    static struct logfs_ctx l;
+    uintptr_t flash_id;
+
+    /* an erased flash image */
+    FILE *theflash = fopen(FLASH_IMAGE_FILE, "wb");
+    uint8_t sector[0x00010000];
+
+    if (!theflash) {
+        printf("logfs: can't create %s\n", FLASH_IMAGE_FILE);
+        return;
+    }
+    memset(sector, 0xFF, sizeof(sector));
+    for (uint32_t i = 0; i < flash_config.size_of_flash / flash_config.size_of_sector; i++) {
+        fwrite(sector, sizeof(sector), 1, theflash);
+    }
+    fclose(theflash);
+
+    if (PIOS_Flash_UT_Init(&flash_id, &flash_config) != 0 ||
+        PIOS_FLASHFS_Logfs_Init(&l.fs_id, &flashfs_config, &pios_ut_flash_driver, flash_id) != 0) {
+        printf("logfs: can't mount %s\n", FLASH_IMAGE_FILE);
+        return;
+    }
+
+    memset(l.obj, 0x5A, sizeof(l.obj));
+    /* includes the arena changes and the garbage collection every arena fill */
+    bench_run("logfs/ObjSave 120 bytes", bench_save, &l);
+    bench_run("logfs/ObjLoad 120 bytes", bench_load, &l);
+
+    PIOS_FLASHFS_Logfs_Destroy(l.fs_id);
+    PIOS_Flash_UT_Destroy(flash_id);
+}
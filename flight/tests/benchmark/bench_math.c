@@ -0,0 +1,141 @@
+/**
+ ******************************************************************************
+ *
+ * @file       bench_math.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Benchmarks of the attitude math, PID and filter libraries
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "bench.h"
+#include "benchmarks.h"
+
+#include <math.h>
+#include <CoordinateConversions.h>
+#include <pid.h>
+#include <butterworth.h>
+
+static void bench_quaternion2rpy(__attribute__((unused)) void *ctx, uint32_t iterations)
+{
+    float q[4] = { 0.9f, 0.1f, -0.3f, 0.2f };
+    float rpy[3];
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        BENCH_CLOBBER();
+        Quaternion2RPY(q, rpy);
+        BENCH_KEEP(rpy[0]);
+    }
+}
+
+static void bench_rpy2quaternion(__attribute__((unused)) void *ctx, uint32_t iterations)
+{
+    float rpy[3] = { 10.0f, -20.0f, 135.0f };
+    float q[4];
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        BENCH_CLOBBER();
+        RPY2Quaternion(rpy, q);
+        BENCH_KEEP(q[0]);
+    }
+}
+
+static void bench_quaternion2r(__attribute__((unused)) void *ctx, uint32_t iterations)
+{
+    float q[4] = { 0.9f, 0.1f, -0.3f, 0.2f };
+    float R[3][3];
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        BENCH_CLOBBER();
+        Quaternion2R(q, R);
+        BENCH_KEEP(R[0][0]);
+    }
+}
+
+static void bench_lla2base(__attribute__((unused)) void *ctx, uint32_t iterations)
+{
+    int32_t home[3] = { 473977000, 85456000, 40000 }; /* deg * 1e7, cm */
+    int32_t LLAi[3] = { 473978000, 85457000, 41000 };
+    double  BaseECEF[3];
+    float   Rne[3][3];
+    float   NED[3];
+
+    LLA2ECEF(home, BaseECEF);
+    RneFromLLA(home, Rne);
+    for (uint32_t i = 0; i < iterations; i++) {
+        BENCH_CLOBBER();
+        LLA2Base(LLAi, BaseECEF, Rne, NED);
+        BENCH_KEEP(NED[0]);
+    }
+}
+
+static void bench_lla2baseframe(__attribute__((unused)) void *ctx, uint32_t iterations)
+{
+    int32_t home[3] = { 473977000, 85456000, 40000 }; /* deg * 1e7, cm */
+    int32_t LLAi[3] = { 473978000, 85457000, 41000 };
+    BaseFrame frame;
+    float NED[3];
+
+    BaseFrameFromLLA(home, &frame);
+    for (uint32_t i = 0; i < iterations; i++) {
+        BENCH_CLOBBER();
+        LLA2BaseFrame(LLAi, &frame, NED);
+        BENCH_KEEP(NED[0]);
+    }
+}
+
+static void bench_pid(__attribute__((unused)) void *ctx, uint32_t iterations)
+{
+    struct pid pid;
+    pid_scaler scaler = { 1.0f, 1.0f, 1.0f };
+    float setpoint    = 10.0f;
+    float measured    = 9.0f;
+
+    pid_configure_derivative(25.0f, 1.0f);
+    pid_configure(&pid, 0.003f, 0.006f, 0.00004f, 0.3f);
+    for (uint32_t i = 0; i < iterations; i++) {
+        BENCH_CLOBBER();
+        BENCH_KEEP(pid_apply_setpoint(&pid, &scaler, setpoint, measured, 0.002f));
+    }
+}
+
+static void bench_butterworth(__attribute__((unused)) void *ctx, uint32_t iterations)
+{
+    struct ButterWorthDF2Filter filter;
+    float wn1, wn2;
+    float x = 1.0f;
+
+    InitButterWorthDF2Filter(0.1f, &filter);
+    InitButterWorthDF2Values(0.0f, &filter, &wn1, &wn2);
+    for (uint32_t i = 0; i < iterations; i++) {
+        BENCH_CLOBBER();
+        BENCH_KEEP(FilterButterWorthDF2(x, &filter, &wn1, &wn2));
+    }
+}
+
+void bench_math(void)
+{
+    bench_run("math/Quaternion2RPY", bench_quaternion2rpy, NULL);
+    bench_run("math/RPY2Quaternion", bench_rpy2quaternion, NULL);
+    bench_run("math/Quaternion2R", bench_quaternion2r, NULL);
+    bench_run("math/LLA2Base", bench_lla2base, NULL);
+    bench_run("math/LLA2BaseFrame", bench_lla2baseframe, NULL);
+    bench_run("math/pid_apply_setpoint", bench_pid, NULL);
+    bench_run("math/FilterButterWorthDF2", bench_butterworth, NULL);
+}
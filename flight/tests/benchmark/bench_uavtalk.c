@@ -0,0 +1,195 @@
+/**
+ ******************************************************************************
+ *
+ * @file       bench_uavtalk.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Benchmarks of the UAVTalk encoder and parser
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "bench.h"
+#include "benchmarks.h"
+
+#include <string.h>
+#include "openpilot.h"
+
+/*
+ * A single single-instance object the size of AttitudeState stands for the
+ * object manager, so that only the protocol is timed
+ */
+#define BENCH_OBJ_ID   0xD7E0D964
+#define BENCH_OBJ_SIZE 28
+
+static uint8_t obj_data[BENCH_OBJ_SIZE];
+static const int obj_handle;
+
+UAVObjHandle UAVObjGetByID(uint32_t id)
+{
+    return (id == BENCH_OBJ_ID) ? (UAVObjHandle)&obj_handle : NULL;
+}
+
+uint32_t UAVObjGetID(__attribute__((unused)) UAVObjHandle obj)
+{
+    return BENCH_OBJ_ID;
+}
+
+uint32_t UAVObjGetNumBytes(__attribute__((unused)) UAVObjHandle obj)
+{
+    return BENCH_OBJ_SIZE;
+}
+
+uint16_t UAVObjGetNumInstances(__attribute__((unused)) UAVObjHandle obj)
+{
+    return 1;
+}
+
+bool UAVObjIsSingleInstance(__attribute__((unused)) UAVObjHandle obj)
+{
+    return true;
+}
+
+int32_t UAVObjUnpack(__attribute__((unused)) UAVObjHandle obj, uint16_t instId, const uint8_t *dataIn)
+{
+    if (instId != 0) {
+        return -1;
+    }
+    memcpy(obj_data, dataIn, BENCH_OBJ_SIZE);
+    return 0;
+}
+
+int32_t UAVObjPack(__attribute__((unused)) UAVObjHandle obj, uint16_t instId, uint8_t *dataOut)
+{
+    if (instId != 0) {
+        return -1;
+    }
+    memcpy(dataOut, obj_data, BENCH_OBJ_SIZE);
+    return 0;
+}
+
+/* what the encoder sent last, the frames parsed by the benchmarks */
+#define BENCH_STREAM_FRAMES 16
+/* header, object and checksum */
+#define BENCH_FRAME_SIZE    (10 + BENCH_OBJ_SIZE + 1)
+static uint8_t stream[BENCH_STREAM_FRAMES * BENCH_FRAME_SIZE];
+static uint16_t stream_length;
+
+static int32_t capture_output(uint8_t *data, int32_t length)
+{
+    if (stream_length + length <= (int32_t)sizeof(stream)) {
+        memcpy(&stream[stream_length], data, length);
+        stream_length += length;
+    }
+    return length;
+}
+
+static int32_t discard_output(__attribute__((unused)) uint8_t *data, int32_t length)
+{
+    BENCH_KEEP(data[0]);
+    return length;
+}
+
+static void bench_send(void *ctx, uint32_t iterations)
+{
+    UAVTalkConnection connection = ctx;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        UAVTalkSendObject(connection, (UAVObjHandle)&obj_handle, 0, 0, 0);
+    }
+}
+
+static void bench_parse_bytes(void *ctx, uint32_t iterations)
+{
+    UAVTalkConnection connection = ctx;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        for (uint16_t pos = 0; pos < stream_length; pos++) {
+            UAVTalkProcessInputStream(connection, stream[pos]);
+        }
+    }
+}
+
+static void bench_parse_buffer(void *ctx, uint32_t iterations)
+{
+    UAVTalkConnection connection = ctx;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        UAVTalkProcessInputStreamBuffer(connection, stream, stream_length);
+    }
+}
+
+/* the bridge connections, frames are parsed on the first and relayed on the second */
+static UAVTalkConnection relay[2];
+
+static void bench_relay_packet(__attribute__((unused)) void *ctx, uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        for (uint16_t pos = 0; pos < stream_length; pos++) {
+            if (UAVTalkProcessInputStreamQuiet(relay[0], stream[pos]) == UAVTALK_STATE_COMPLETE) {
+                UAVTalkRelayPacket(relay[0], relay[1]);
+            }
+        }
+    }
+}
+
+static void bench_relay_frame(__attribute__((unused)) void *ctx, uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        uint16_t start = 0;
+        for (uint16_t pos = 0; pos < stream_length; pos++) {
+            UAVTalkRxState state = UAVTalkProcessInputStreamQuiet(relay[0], stream[pos]);
+            if (state == UAVTALK_STATE_TYPE) {
+                start = pos;
+            } else if (state == UAVTALK_STATE_COMPLETE) {
+                UAVTalkRelayFrame(relay[0], relay[1], &stream[start], pos - start + 1);
+            }
+        }
+    }
+}
+
+void bench_uavtalk(void)
+{
+    UAVTalkConnection connection = UAVTalkInitialize(capture_output);
+
+    for (uint32_t i = 0; i < BENCH_OBJ_SIZE; i++) {
+        obj_data[i] = (uint8_t)(0x3C + i);
+    }
+    for (uint32_t i = 0; i < BENCH_STREAM_FRAMES; i++) {
+        UAVTalkSendObject(connection, (UAVObjHandle)&obj_handle, 0, 0, 0);
+    }
+    UAVTalkSetOutputStream(connection, discard_output);
+
+    bench_run("uavtalk/SendObject", bench_send, connection);
+    /* a buffer of BENCH_STREAM_FRAMES frames per operation */
+    bench_run("uavtalk/ProcessInputStream 16 frames", bench_parse_bytes, connection);
+    bench_run("uavtalk/ProcessInputStreamBuffer 16 frames", bench_parse_buffer, connection);
+
+    relay[0] = UAVTalkInitialize(discard_output);
+    relay[1] = UAVTalkInitialize(discard_output);
+    bench_run("uavtalk/RelayPacket 16 frames", bench_relay_packet, NULL);
+    bench_run("uavtalk/RelayFrame 16 frames", bench_relay_frame, NULL);
+
+    UAVTalkStats stats;
+    UAVTalkGetStats(connection, &stats, false);
+    UAVTalkAddStats(relay[0], &stats, false);
+    UAVTalkAddStats(relay[1], &stats, false);
+    if (stats.rxErrors || stats.rxSyncErrors || stats.rxCrcErrors) {
+        printf("uavtalk: %u errors parsing the stream\n", (unsigned)(stats.rxErrors + stats.rxSyncErrors + stats.rxCrcErrors));
+    }
+}
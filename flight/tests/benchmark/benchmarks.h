@@ -0,0 +1,36 @@
+/**
+ ******************************************************************************
+ *
+ * @file       benchmarks.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Benchmark groups of the flight libraries
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+void bench_math(void);
+void bench_buffers(void);
+void bench_uavtalk(void);
+void bench_logfs(void);
+void bench_insgps13(void);
+void bench_crypto(void);
+
+#endif /* BENCHMARKS_H */
@@ -0,0 +1,49 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Runs the benchmarks of the flight libraries
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * Usage: benchmark.elf [pattern]
+ * Only the benchmarks whose name contain pattern are run, e.g. "uavtalk/".
+ * Build the benchmarks with the firmware optimisation for figures that
+ * compare, and compare them on the same host only.
+ */
+
+#include "bench.h"
+#include "benchmarks.h"
+
+int main(int argc, char *argv[])
+{
+    bench_init(argc, argv);
+
+    bench_math();
+    bench_buffers();
+    bench_uavtalk();
+    bench_logfs();
+    bench_insgps13();
+    bench_crypto();
+
+    return bench_done();
+}
@@ -0,0 +1,46 @@
+/**
+ ******************************************************************************
+ *
+ * @file       openpilot.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Flight software environment of the benchmarks
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef OPENPILOT_H
+#define OPENPILOT_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pios.h"
+
+#define PIOS_Assert(x) \
+    if (!(x)) { fprintf(stderr, "assertion failed: %s at %s:%d\n", #x, __FILE__, __LINE__); abort(); }
+#define PIOS_DEBUG_Assert(x) PIOS_Assert(x)
+
+#define PIOS_DEBUGLOG_Printf(...)
+#define PIOS_STATIC_ASSERT(test) ((void)sizeof(int[1 - 2 * !(test)]))
+
+#include "uavobjectmanager.h"
+#include "uavtalk.h"
+
+#endif /* OPENPILOT_H */
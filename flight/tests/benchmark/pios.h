@@ -0,0 +1,47 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Stubbed PiOS for the benchmarks
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef PIOS_H
+#define PIOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pios_config.h"
+
+#ifdef PIOS_INCLUDE_FREERTOS
+#include "FreeRTOS.h"
+#endif
+
+#include "pios_mem.h"
+#include <pios_math.h>
+#include <pios_crc.h>
+
+#ifdef PIOS_INCLUDE_FLASH
+#include <pios_flash.h>
+#include <pios_flashfs.h>
+#endif
+
+#endif /* PIOS_H */
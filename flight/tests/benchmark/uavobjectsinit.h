@@ -0,0 +1,32 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectsinit.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Object set of the benchmarks, see bench_uavtalk.c
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVOBJECTSINIT_H
+#define UAVOBJECTSINIT_H
+
+/* bounds the UAVTalk buffers, as large as with the flight object set */
+#define UAVOBJECTS_LARGEST 512
+
+#endif /* UAVOBJECTSINIT_H */
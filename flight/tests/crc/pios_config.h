@@ -0,0 +1,7 @@
+#ifndef PIOS_CONFIG_H
+#define PIOS_CONFIG_H
+
+/* Enable/Disable PiOS modules */
+#define PIOS_CRC_SLICE_BY_4
+
+#endif /* PIOS_CONFIG_H */
@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* abort */
+#include <string.h> /* memset */
+#include <time.h> /* clock */
+
+extern "C" {
+#include "pios_crc.h"
+}
+
+#define BUFFER_LENGTH    301
+#define BENCHMARK_LENGTH (64 * 1024)
+#define BENCHMARK_ROUNDS 64
+
+// Bitwise CRC-8, polynomial 0x07, used as reference for the table driven implementation
+static uint8_t crc8_reference(uint8_t crc, const uint8_t *data, int32_t length)
+{
+    while (length--) {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Byte at a time lookup, as PIOS_CRC_updateCRC without PIOS_CRC_SLICE_BY_4
+static uint8_t crc8_bytewise(uint8_t crc, const uint8_t *data, int32_t length)
+{
+    while (length--) {
+        crc = PIOS_CRC_updateByte(crc, *data++);
+    }
+    return crc;
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class CrcTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        srand(1);
+        for (int i = 0; i < BUFFER_LENGTH; i++) {
+            buffer[i] = (uint8_t)rand();
+        }
+    }
+
+    uint8_t buffer[BUFFER_LENGTH];
+};
+
+TEST_F(CrcTest, known_value) {
+    const uint8_t check[] = "123456789";
+
+    // CRC-8 check value for polynomial 0x07, init 0x00
+    EXPECT_EQ(0xF4, PIOS_CRC_updateCRC(0, check, 9));
+}
+
+TEST_F(CrcTest, all_lengths_and_alignments) {
+    for (int offset = 0; offset < 4; offset++) {
+        for (int length = 0; length <= BUFFER_LENGTH - offset; length++) {
+            ASSERT_EQ(crc8_reference(0x5A, &buffer[offset], length), PIOS_CRC_updateCRC(0x5A, &buffer[offset], length))
+                << "offset " << offset << " length " << length;
+        }
+    }
+}
+
+TEST_F(CrcTest, incremental) {
+    uint8_t crc = 0;
+
+    // feeding the buffer in odd sized chunks gives the same result as a single call
+    for (int pos = 0; pos < BUFFER_LENGTH; pos += 7) {
+        int length = (BUFFER_LENGTH - pos < 7) ? BUFFER_LENGTH - pos : 7;
+        crc = PIOS_CRC_updateCRC(crc, &buffer[pos], length);
+    }
+    EXPECT_EQ(crc8_reference(0, buffer, BUFFER_LENGTH), crc);
+}
+
+TEST_F(CrcTest, benchmark) {
+    static uint8_t data[BENCHMARK_LENGTH];
+    uint8_t crc_bytewise = 0;
+    uint8_t crc_sliced   = 0;
+
+    for (int i = 0; i < BENCHMARK_LENGTH; i++) {
+        data[i] = (uint8_t)rand();
+    }
+
+    clock_t start = clock();
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+        crc_bytewise = crc8_bytewise(crc_bytewise, data, BENCHMARK_LENGTH);
+    }
+    clock_t bytewise = clock() - start;
+
+    start = clock();
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+        crc_sliced = PIOS_CRC_updateCRC(crc_sliced, data, BENCHMARK_LENGTH);
+    }
+    clock_t sliced = clock() - start;
+
+    EXPECT_EQ(crc_bytewise, crc_sliced);
+
+    double bytes = (double)BENCHMARK_LENGTH * BENCHMARK_ROUNDS;
+    printf("bytewise : %.3f ns/byte\n", 1e9 * bytewise / CLOCKS_PER_SEC / bytes);
+    printf("sliced   : %.3f ns/byte\n", 1e9 * sliced / CLOCKS_PER_SEC / bytes);
+}
@@ -0,0 +1,234 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* abort */
+#include <string.h> /* memset */
+#include <algorithm>
+#include <vector>
+
+extern "C" {
+#include "aes.h"
+#include "sha1.h"
+#include "hmac_sha1.h"
+}
+
+// Bytes of a hex string
+static std::vector<uint8_t> hex(const char *s)
+{
+    std::vector<uint8_t> bytes;
+
+    for (; s[0] && s[1]; s += 2) {
+        char byte[3] = { s[0], s[1], 0 };
+        bytes.push_back((uint8_t)strtoul(byte, NULL, 16));
+    }
+    return bytes;
+}
+
+static std::vector<uint8_t> bytes(const char *s)
+{
+    return std::vector<uint8_t>(s, s + strlen(s));
+}
+
+static std::vector<uint8_t> sha1(const std::vector<uint8_t> & data)
+{
+    std::vector<uint8_t> digest(SHA1_DIGEST_LENGTH);
+    SHA1_CTX sha;
+
+    SHA1Init(&sha);
+    SHA1Update(&sha, data.data(), data.size());
+    SHA1Final(digest.data(), &sha);
+    return digest;
+}
+
+static std::vector<uint8_t> hmac_sha1(const std::vector<uint8_t> & key, const std::vector<uint8_t> & data, unsigned int maclen)
+{
+    std::vector<uint8_t> mac(maclen);
+    HMAC_SHA1_CTX ctx;
+
+    HMACSHA1Init(&ctx, key.data(), key.size());
+    HMACSHA1(&ctx, data.data(), data.size(), mac.data(), maclen);
+    return mac;
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class AesTest : public testing::Test {};
+
+// FIPS-197 appendix B and C.1
+TEST_F(AesTest, fips197_aes128) {
+    const char *vectors[][3] = {
+        { "2b7e151628aed2a6abf7158809cf4f3c", "3243f6a8885a308d313198a2e0370734", "3925841d02dc09fbdc118597196a0b32" },
+        { "000102030405060708090a0b0c0d0e0f", "00112233445566778899aabbccddeeff", "69c4e0d86a7b0430d8cdb78070b4c55a" },
+    };
+
+    for (unsigned int i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+        std::vector<uint8_t> key = hex(vectors[i][0]);
+        std::vector<uint8_t> plain  = hex(vectors[i][1]);
+        std::vector<uint8_t> cipher = hex(vectors[i][2]);
+
+        // table driven cipher
+        uint32_t round_key[AES_128_ROUND_KEYS];
+        std::vector<uint8_t> out(N_BLOCK);
+        aes_key_128_expand(key.data(), round_key);
+        aes_encrypt_128(round_key, plain.data(), out.data());
+        EXPECT_EQ(cipher, out) << "vector " << i;
+
+        // in place
+        out = plain;
+        aes_encrypt_128(round_key, out.data(), out.data());
+        EXPECT_EQ(cipher, out) << "vector " << i;
+
+        // byte oriented cipher, the key is updated on the fly
+        std::vector<uint8_t> enc_key = key;
+        out = plain;
+        aes_encrypt_cbc_128(out.data(), enc_key.data(), NULL);
+        EXPECT_EQ(cipher, out) << "vector " << i;
+
+        std::vector<uint8_t> dec_key(N_BLOCK);
+        enc_key = key;
+        aes_decrypt_key_128_create(enc_key.data(), dec_key.data());
+        aes_decrypt_cbc_128(out.data(), dec_key.data(), NULL);
+        EXPECT_EQ(plain, out) << "vector " << i;
+    }
+}
+
+// FIPS-197 appendix C.3
+TEST_F(AesTest, fips197_aes256) {
+    std::vector<uint8_t> key    = hex("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f");
+    std::vector<uint8_t> plain  = hex("00112233445566778899aabbccddeeff");
+    std::vector<uint8_t> cipher = hex("8ea2b7ca516745bfeafc49904b496089");
+
+    std::vector<uint8_t> enc_key = key;
+    std::vector<uint8_t> out     = plain;
+    aes_encrypt_cbc_256(out.data(), enc_key.data(), NULL);
+    EXPECT_EQ(cipher, out);
+
+    std::vector<uint8_t> dec_key(2 * N_BLOCK);
+    enc_key = key;
+    aes_decrypt_key_256_create(enc_key.data(), dec_key.data());
+    aes_decrypt_cbc_256(out.data(), dec_key.data(), NULL);
+    EXPECT_EQ(plain, out);
+}
+
+// SP 800-38A F.5.1 and F.5.2, CTR-AES128
+TEST_F(AesTest, sp800_38a_ctr) {
+    std::vector<uint8_t> key   = hex("2b7e151628aed2a6abf7158809cf4f3c");
+    std::vector<uint8_t> plain = hex("6bc1bee22e409f96e93d7e117393172a"
+                                     "ae2d8a571e03ac9c9eb76fac45af8e51"
+                                     "30c81c46a35ce411e5fbc1191a0a52ef"
+                                     "f69f2445df4f9b17ad2b417be66c3710");
+    std::vector<uint8_t> cipher = hex("874d6191b620e3261bef6864990db6ce"
+                                      "9806f66b7970fdff8617187bb9fffdff"
+                                      "5ae4df3edbd5d35e5b4f09020db03eab"
+                                      "1e031dda2fbe03d1792170a0f3009cee");
+    uint32_t round_key[AES_128_ROUND_KEYS];
+
+    aes_key_128_expand(key.data(), round_key);
+
+    // whole message, the counter carries out of its low byte
+    std::vector<uint8_t> counter = hex("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+    std::vector<uint8_t> data    = plain;
+    aes_ctr_128(round_key, counter.data(), data.data(), data.size());
+    EXPECT_EQ(cipher, data);
+    EXPECT_EQ(hex("f0f1f2f3f4f5f6f7f8f9fafbfcfdff03"), counter);
+
+    // decryption is the same operation
+    counter = hex("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+    aes_ctr_128(round_key, counter.data(), data.data(), data.size());
+    EXPECT_EQ(plain, data);
+
+    // a partial block uses up a whole counter value
+    counter = hex("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+    data    = plain;
+    aes_ctr_128(round_key, counter.data(), data.data(), 20);
+    aes_ctr_128(round_key, counter.data(), data.data() + 32, 32);
+    EXPECT_TRUE(std::equal(cipher.begin(), cipher.begin() + 20, data.begin()));
+    EXPECT_TRUE(std::equal(plain.begin() + 20, plain.begin() + 32, data.begin() + 20));
+    EXPECT_TRUE(std::equal(cipher.begin() + 32, cipher.end(), data.begin() + 32));
+}
+
+class Sha1Test : public testing::Test {};
+
+// FIPS 180-2 appendix A
+TEST_F(Sha1Test, fips180_vectors) {
+    EXPECT_EQ(hex("a9993e364706816aba3e25717850c26c9cd0d89d"), sha1(bytes("abc")));
+    EXPECT_EQ(hex("84983e441c3bd26ebaae4aa1f95129e5e54670f1"),
+              sha1(bytes("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")));
+    EXPECT_EQ(hex("34aa973cd4c4daa4f61eeb2bdbad27316534016f"), sha1(std::vector<uint8_t>(1000000, 'a')));
+}
+
+// Messages around the block size, 55 bytes is the longest that leaves room
+// for the length in the last block, 56 needs a block of padding of its own
+TEST_F(Sha1Test, padding_boundaries) {
+    const struct {
+        unsigned int len;
+        const char   *digest;
+    } vectors[] = {
+        { 0,   "da39a3ee5e6b4b0d3255bfef95601890afd80709" },
+        { 55,  "c1c8bbdc22796e28c0e15163d20899b65621d65a" },
+        { 56,  "c2db330f6083854c99d4b5bfb6e8f29f201be699" },
+        { 63,  "03f09f5b158a7a8cdad920bddc29b81c18a551f5" },
+        { 64,  "0098ba824b5c16427bd7a1122a5a442a25ec644d" },
+        { 65,  "11655326c708d70319be2610e8a57d9a5b959d3b" },
+        { 119, "ee971065aaa017e0632a8ca6c77bb3bf8b1dfc56" },
+        { 120, "f34c1488385346a55709ba056ddd08280dd4c6d6" },
+    };
+
+    for (unsigned int i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+        std::vector<uint8_t> message(vectors[i].len, 'a');
+        EXPECT_EQ(hex(vectors[i].digest), sha1(message)) << "length " << vectors[i].len;
+
+        // fed a byte at a time
+        std::vector<uint8_t> digest(SHA1_DIGEST_LENGTH);
+        SHA1_CTX sha;
+        SHA1Init(&sha);
+        for (unsigned int j = 0; j < message.size(); j++) {
+            SHA1Update(&sha, &message[j], 1);
+        }
+        SHA1Final(digest.data(), &sha);
+        EXPECT_EQ(hex(vectors[i].digest), digest) << "length " << vectors[i].len;
+    }
+}
+
+class HmacSha1Test : public testing::Test {};
+
+// RFC 2202 section 3
+TEST_F(HmacSha1Test, rfc2202_vectors) {
+    EXPECT_EQ(hex("b617318655057264e28bc0b6fb378c8ef146be00"),
+              hmac_sha1(std::vector<uint8_t>(20, 0x0b), bytes("Hi There"), SHA1_DIGEST_LENGTH));
+    EXPECT_EQ(hex("effcdf6ae5eb2fa2d27416d5f184df9c259a7c79"),
+              hmac_sha1(bytes("Jefe"), bytes("what do ya want for nothing?"), SHA1_DIGEST_LENGTH));
+    EXPECT_EQ(hex("125d7342b9ac11cd91a39af48aa17b4f63f175d3"),
+              hmac_sha1(std::vector<uint8_t>(20, 0xaa), std::vector<uint8_t>(50, 0xdd), SHA1_DIGEST_LENGTH));
+    EXPECT_EQ(hex("4c9007f4026250c6bc8414f9bf50c86c2d7235da"),
+              hmac_sha1(hex("0102030405060708090a0b0c0d0e0f10111213141516171819"), std::vector<uint8_t>(50, 0xcd), SHA1_DIGEST_LENGTH));
+    EXPECT_EQ(hex("4c1a03424b55e07fe7f27be1d58bb9324a9a5a04"),
+              hmac_sha1(std::vector<uint8_t>(20, 0x0c), bytes("Test With Truncation"), SHA1_DIGEST_LENGTH));
+    // keys longer than a block are hashed first
+    EXPECT_EQ(hex("aa4ae5e15272d00e95705637ce8a3b55ed402112"),
+              hmac_sha1(std::vector<uint8_t>(80, 0xaa), bytes("Test Using Larger Than Block-Size Key - Hash Key First"), SHA1_DIGEST_LENGTH));
+    EXPECT_EQ(hex("e8e99d0f45237d786d6bbaa7965c7808bbff1a91"),
+              hmac_sha1(std::vector<uint8_t>(80, 0xaa), bytes("Test Using Larger Than Block-Size Key and Larger Than One Block-Size Data"), SHA1_DIGEST_LENGTH));
+}
+
+TEST_F(HmacSha1Test, truncated_mac) {
+    // RFC 2202 test case 5, HMAC-SHA-1-96
+    EXPECT_EQ(hex("4c1a03424b55e07fe7f27be1"), hmac_sha1(std::vector<uint8_t>(20, 0x0c), bytes("Test With Truncation"), 12));
+}
+
+TEST_F(HmacSha1Test, message_in_parts) {
+    std::vector<uint8_t> key  = std::vector<uint8_t>(80, 0xaa);
+    std::vector<uint8_t> data = bytes("Test Using Larger Than Block-Size Key and Larger Than One Block-Size Data");
+    std::vector<uint8_t> mac(SHA1_DIGEST_LENGTH);
+    HMAC_SHA1_CTX ctx;
+    SHA1_CTX sha;
+
+    // the key states are reused for every message
+    HMACSHA1Init(&ctx, key.data(), key.size());
+    for (unsigned int split = 0; split <= data.size(); split++) {
+        HMACSHA1Start(&ctx, &sha);
+        SHA1Update(&sha, data.data(), split);
+        SHA1Update(&sha, data.data() + split, data.size() - split);
+        HMACSHA1Finish(&ctx, &sha, mac.data(), mac.size());
+        EXPECT_EQ(hex("e8e99d0f45237d786d6bbaa7965c7808bbff1a91"), mac) << "split " << split;
+    }
+}
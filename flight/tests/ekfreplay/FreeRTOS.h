@@ -0,0 +1,85 @@
+/**
+ ******************************************************************************
+ *
+ * @file       FreeRTOS.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      FreeRTOS stubs, the replay runs in a single thread
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+typedef uint32_t portTickType;
+typedef void *xSemaphoreHandle;
+typedef void *xQueueHandle;
+
+#define pdFALSE            0
+#define pdTRUE             1
+#define portMAX_DELAY      ((portTickType)0xffffffff)
+#define portTICK_RATE_MS   ((portTickType)1)
+#define tskIDLE_PRIORITY   0
+
+#define pvPortMalloc(xSize) (malloc(xSize))
+#define vPortFree(pv)       (free(pv))
+
+/* one thread, the locks are never contended */
+static inline xSemaphoreHandle xSemaphoreCreateRecursiveMutex(void)
+{
+    return (xSemaphoreHandle)1;
+}
+static inline xSemaphoreHandle xSemaphoreCreateBinary(void)
+{
+    return (xSemaphoreHandle)1;
+}
+#define portENTER_CRITICAL()
+#define portEXIT_CRITICAL()
+
+#define vSemaphoreCreateBinary(xSemaphore) ((xSemaphore) = (xSemaphoreHandle)1)
+
+static inline long xSemaphoreTake(__attribute__((unused)) xSemaphoreHandle xSemaphore, __attribute__((unused)) portTickType xBlockTime)
+{
+    return 1;
+}
+static inline long xSemaphoreGive(__attribute__((unused)) xSemaphoreHandle xSemaphore)
+{
+    return 1;
+}
+static inline long xSemaphoreTakeRecursive(__attribute__((unused)) xSemaphoreHandle xMutex, __attribute__((unused)) portTickType xBlockTime)
+{
+    return 1;
+}
+static inline long xSemaphoreGiveRecursive(__attribute__((unused)) xSemaphoreHandle xMutex)
+{
+    return 1;
+}
+
+/* no object is connected to a queue in the replay */
+static inline long xQueueSend(__attribute__((unused)) xQueueHandle xQueue, __attribute__((unused)) const void *pvItemToQueue, __attribute__((unused)) portTickType xTicksToWait)
+{
+    return pdFALSE;
+}
+
+/* the time of the log being replayed, see replay_os.c */
+portTickType xTaskGetTickCount(void);
+
+#endif /* FREERTOS_H */
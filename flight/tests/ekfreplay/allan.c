@@ -0,0 +1,350 @@
+/**
+ ******************************************************************************
+ *
+ * @file       allan.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Allan deviation of the sensors in a static recording
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * The overlapping Allan variance of a stream y sampled every t0, at the
+ * cluster size m, from the running sums theta of the samples:
+ *
+ *   avar(m t0) = sum_k (theta[k+2m] - 2 theta[k+m] + theta[k])^2 / (2 m^2 (N + 1 - 2m))
+ *
+ * which takes one pass over the samples per cluster size. The cluster sizes
+ * are spread logarithmically and shared out to the threads.
+ *
+ * The noise terms are read off the curve as IEEE 952 does: the white noise
+ * density where the slope is closest to -1/2, the bias instability at the
+ * bottom and the bias random walk where the slope is closest to +1/2 past
+ * the bottom. insgps.c adds Q dT^2 to the covariance at every prediction,
+ * so a density n becomes the variance Q = n^2 f at the prediction rate f.
+ */
+
+#include <openpilot.h>
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <accelsensor.h>
+#include <barosensor.h>
+#include <ekfconfiguration.h>
+#include <gyrosensor.h>
+
+#include "replay.h"
+
+#define CLUSTERS_PER_DECADE 10
+#define MAX_CLUSTERS        128
+/* the noise terms are read where there are at least this many clusters, within about 25% */
+#define TRUSTED_CLUSTERS    10
+/* minimum adev over the bias instability, sqrt(2 ln 2 / pi) */
+#define BIAS_INSTABILITY    0.664
+
+enum channel { GYROX, GYROY, GYROZ, ACCELX, ACCELY, ACCELZ, BARO, CHANNELS };
+
+static const char *const channelNames[CHANNELS] = { "gyrox", "gyroy", "gyroz", "accelx", "accely", "accelz", "baro" };
+
+struct stream {
+    double   *samples;
+    uint32_t count;
+    uint32_t size;
+    uint64_t first_us;
+    uint64_t last_us;
+    /* the curve */
+    uint16_t clusters;
+    uint16_t trusted;
+    uint32_t m[MAX_CLUSTERS];
+    double   tau[MAX_CLUSTERS];
+    double   adev[MAX_CLUSTERS];
+    /* the noise terms, 0 where the curve does not show them */
+    double   white;
+    double   instability;
+    double   walk;
+};
+
+static struct stream streams[CHANNELS];
+
+/* the cluster sizes left to compute, taken by the threads */
+static uint32_t nextJob;
+static uint32_t jobCount;
+static struct {
+    uint8_t  channel;
+    uint16_t cluster;
+} jobs[CHANNELS * MAX_CLUSTERS];
+
+static void addSample(enum channel channel, double value)
+{
+    struct stream *s = &streams[channel];
+
+    if (s->count == s->size) {
+        s->size    = s->size ? s->size * 2 : 4096;
+        s->samples = realloc(s->samples, s->size * sizeof(*s->samples));
+        PIOS_Assert(s->samples);
+    }
+    if (!s->count) {
+        s->first_us = replay_time();
+    }
+    s->last_us = replay_time();
+    s->samples[s->count++] = value;
+}
+
+static void gyroSensorUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    GyroSensorData gyro;
+
+    GyroSensorGet(&gyro);
+    // the EKF works in rad/s
+    addSample(GYROX, DEG2RAD((double)gyro.x));
+    addSample(GYROY, DEG2RAD((double)gyro.y));
+    addSample(GYROZ, DEG2RAD((double)gyro.z));
+}
+
+static void accelSensorUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    AccelSensorData accel;
+
+    AccelSensorGet(&accel);
+    addSample(ACCELX, accel.x);
+    addSample(ACCELY, accel.y);
+    addSample(ACCELZ, accel.z);
+}
+
+static void baroSensorUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    float altitude;
+
+    BaroSensorAltitudeGet(&altitude);
+    addSample(BARO, altitude);
+}
+
+void allan_collect(void)
+{
+    GyroSensorInitialize();
+    AccelSensorInitialize();
+    BaroSensorInitialize();
+    EKFConfigurationInitialize();
+    GyroSensorConnectCallback(&gyroSensorUpdatedCb);
+    AccelSensorConnectCallback(&accelSensorUpdatedCb);
+    BaroSensorConnectCallback(&baroSensorUpdatedCb);
+}
+
+static double samplePeriod(const struct stream *s)
+{
+    return (s->last_us - s->first_us) * 1e-6 / (s->count - 1);
+}
+
+/**
+ * Turn the samples into their running sums, less the mean to keep the precision
+ */
+static void integrate(struct stream *s)
+{
+    double mean = 0;
+
+    for (uint32_t i = 0; i < s->count; i++) {
+        mean += s->samples[i];
+    }
+    mean /= s->count;
+
+    // theta[0] is 0 and theta[k] the sum of the first k samples, one more than the samples
+    s->samples = realloc(s->samples, (s->count + 1) * sizeof(*s->samples));
+    PIOS_Assert(s->samples);
+    double sum = 0;
+    for (uint32_t i = 0; i < s->count; i++) {
+        double y = s->samples[i] - mean;
+        s->samples[i] = sum;
+        sum += y;
+    }
+    s->samples[s->count] = sum;
+
+    // the cluster sizes, the last leaves at least two clusters
+    uint32_t largest = (s->count - 1) / 2;
+    s->trusted = 0;
+    s->clusters = 0;
+    for (uint16_t i = 0; s->clusters < MAX_CLUSTERS; i++) {
+        uint32_t m = (uint32_t)floor(pow(10.0, (double)i / CLUSTERS_PER_DECADE));
+        if (m > largest) {
+            break;
+        }
+        if (!s->clusters || m != s->m[s->clusters - 1]) {
+            if (m <= s->count / TRUSTED_CLUSTERS) {
+                s->trusted = s->clusters + 1;
+            }
+            s->m[s->clusters++] = m;
+        }
+    }
+}
+
+static void *allanThread(__attribute__((unused)) void *arg)
+{
+    for (;;) {
+        uint32_t job = __sync_fetch_and_add(&nextJob, 1);
+        if (job >= jobCount) {
+            return NULL;
+        }
+        struct stream *s = &streams[jobs[job].channel];
+        uint16_t cluster = jobs[job].cluster;
+        const uint32_t m = s->m[cluster];
+        const double *theta = s->samples;
+        const uint32_t terms = s->count + 1 - 2 * m;
+
+        double sum = 0;
+        for (uint32_t k = 0; k < terms; k++) {
+            double d = theta[k + 2 * m] - 2 * theta[k + m] + theta[k];
+            sum += d * d;
+        }
+        s->tau[cluster]  = m * samplePeriod(s);
+        s->adev[cluster] = sqrt(sum / (2.0 * m * m * terms));
+    }
+}
+
+/**
+ * The point of the curve whose slope to the next is closest to slope, from the first point given
+ */
+static int16_t findSlope(const struct stream *s, uint16_t from, double slope)
+{
+    int16_t best = -1;
+    double bestError = 0.25;
+
+    for (uint16_t i = from; i + 1 < s->trusted; i++) {
+        if (s->adev[i] <= 0 || s->adev[i + 1] <= 0) {
+            continue;
+        }
+        double error = fabs(log(s->adev[i + 1] / s->adev[i]) / log(s->tau[i + 1] / s->tau[i]) - slope);
+        if (error < bestError) {
+            best = i;
+            bestError = error;
+        }
+    }
+    return best;
+}
+
+static void noiseTerms(struct stream *s)
+{
+    uint16_t bottom = 0;
+
+    for (uint16_t i = 1; i < s->trusted; i++) {
+        if (s->adev[i] < s->adev[bottom]) {
+            bottom = i;
+        }
+    }
+    s->instability = s->adev[bottom] / BIAS_INSTABILITY;
+
+    // white noise shows at the shortest clusters, a curve without the slope starts in it
+    int16_t white = findSlope(s, 0, -0.5);
+    if (white < 0) {
+        white = 0;
+    }
+    s->white = s->adev[white] * sqrt(s->tau[white]);
+
+    int16_t walk  = findSlope(s, bottom, 0.5);
+    s->walk = walk >= 0 ? s->adev[walk] * sqrt(3.0 / s->tau[walk]) : 0;
+}
+
+static void writeValues(FILE *xml, const char *name, const float *values, uint8_t count)
+{
+    fprintf(xml, "      <field name=\"%s\" values=\"", name);
+    for (uint8_t i = 0; i < count; i++) {
+        fprintf(xml, "%s%g", i ? "," : "", (double)values[i]);
+    }
+    fprintf(xml, "\"/>\n");
+}
+
+int allan_report(uint32_t threads, float inertialRate, FILE *curves, FILE *xml)
+{
+    for (uint8_t c = 0; c < CHANNELS; c++) {
+        if (streams[c].count < 5) {
+            fprintf(stderr, "ekfreplay: the log holds too few %s samples\n", channelNames[c]);
+            return 1;
+        }
+        integrate(&streams[c]);
+        for (uint16_t i = 0; i < streams[c].clusters; i++) {
+            jobs[jobCount].channel   = c;
+            jobs[jobCount++].cluster = i;
+        }
+    }
+
+    pthread_t thread[threads];
+    for (uint32_t i = 0; i < threads; i++) {
+        if (pthread_create(&thread[i], NULL, &allanThread, NULL)) {
+            perror("ekfreplay: pthread_create");
+            return 1;
+        }
+    }
+    for (uint32_t i = 0; i < threads; i++) {
+        pthread_join(thread[i], NULL);
+    }
+
+    printf("%8s %8s %10s %14s %14s %14s\n", "sensor", "samples", "rate(Hz)", "white", "instability", "walk");
+    for (uint8_t c = 0; c < CHANNELS; c++) {
+        struct stream *s = &streams[c];
+        noiseTerms(s);
+        printf("%8s %8u %10.1f %14.4g %14.4g %14.4g\n", channelNames[c], s->count, 1.0 / samplePeriod(s),
+               s->white, s->instability, s->walk);
+    }
+
+    if (curves) {
+        // one block per sensor, as gnuplot plots them with index
+        for (uint8_t c = 0; c < CHANNELS; c++) {
+            fprintf(curves, "%s# %s\ntau,adev\n", c ? "\n\n" : "", channelNames[c]);
+            for (uint16_t i = 0; i < streams[c].clusters; i++) {
+                fprintf(curves, "%g,%g\n", streams[c].tau[i], streams[c].adev[i]);
+            }
+        }
+    }
+
+    // the variances, the terms the curves do not show keep the configured values
+    EKFConfigurationData config;
+    EKFConfigurationGet(&config);
+    float *Q = EKFConfigurationQToArray(config.Q);
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        Q[EKFCONFIGURATION_Q_GYROX + axis]  = streams[GYROX + axis].white * streams[GYROX + axis].white * inertialRate;
+        Q[EKFCONFIGURATION_Q_ACCELX + axis] = streams[ACCELX + axis].white * streams[ACCELX + axis].white * inertialRate;
+        if (streams[GYROX + axis].walk > 0) {
+            Q[EKFCONFIGURATION_Q_GYRODRIFTX + axis] = streams[GYROX + axis].walk * streams[GYROX + axis].walk * inertialRate;
+        }
+        if (streams[ACCELX + axis].walk > 0) {
+            Q[EKFCONFIGURATION_Q_ACCELDRIFTX + axis] = streams[ACCELX + axis].walk * streams[ACCELX + axis].walk * inertialRate;
+        }
+    }
+    // the baro is a measurement, its variance at the rate it comes in
+    const struct stream *baro = &streams[BARO];
+    config.R.BaroZ = baro->white * baro->white / samplePeriod(baro);
+
+    EKFConfigurationSet(&config);
+
+    if (xml) {
+        // a settings file the GCS imports, with the fields that changed
+        fprintf(xml, "<!DOCTYPE UAVObjects>\n<uavobjects>\n  <settings>\n");
+        fprintf(xml, "    <object name=\"EKFConfiguration\" id=\"0x%08X\">\n", EKFCONFIGURATION_OBJID);
+        writeValues(xml, "Q", Q, EKFCONFIGURATION_Q_NUMELEM);
+        writeValues(xml, "R", EKFConfigurationRToArray(config.R), EKFCONFIGURATION_R_NUMELEM);
+        fprintf(xml, "    </object>\n  </settings>\n</uavobjects>\n");
+    }
+    return 0;
+}
+
+/**
+ * @}
+ * @}
+ */
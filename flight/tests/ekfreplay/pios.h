@@ -0,0 +1,54 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      The part of PiOS the state estimation needs, on the replay clock
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef PIOS_H
+#define PIOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pios_config.h"
+
+#ifdef PIOS_INCLUDE_FREERTOS
+#include "FreeRTOS.h"
+#endif
+
+#define PIOS_Assert(x) \
+    if (!(x)) { fprintf(stderr, "assertion failed: %s at %s:%d\n", #x, __FILE__, __LINE__); abort(); }
+#define PIOS_DEBUG_Assert(x) PIOS_Assert(x)
+
+#include "pios_mem.h"
+#include <pios_helpers.h>
+#include <pios_math.h>
+#include <pios_crc.h>
+#include <pios_delay.h>
+#include <pios_deltatime.h>
+#include <pios_callbackscheduler.h>
+#include <pios_notify.h>
+
+#endif /* PIOS_H */
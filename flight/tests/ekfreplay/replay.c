@@ -0,0 +1,750 @@
+/**
+ ******************************************************************************
+ *
+ * @file       replay.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Replays a recorded log through the state estimation
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * Usage: ekfreplay.elf [options] log.opl
+ *   -a algorithm      fusion algorithm, overriding RevoSettings of the log:
+ *                     cf, cfm, cfmgps, fast, ins13indoor, ins13, ins16indoor, ins16
+ *   -S field=value    set an EKFConfiguration variance, e.g. R.GPSPosNorth=2
+ *   -s field=a:b:n    sweep an EKFConfiguration variance over n values from a
+ *                     to b in geometric steps, several sweeps run all combinations
+ *   -j jobs           replays run at the same time during a sweep, default the CPUs
+ *   -w seconds        seconds of the log not scored while the filter settles, default 10
+ *   -o file           write the estimate as CSV, one row every -r milliseconds
+ *   -r milliseconds   default 100
+ *
+ * Usage: ekfreplay.elf -A [-f hertz] [-j threads] [-o file] [-x file] log.opl
+ *   -A                the Allan deviation of the gyros, accels and baro of a
+ *                     static recording instead, with the EKFConfiguration
+ *                     variances it gives as -S options for the replay
+ *   -f hertz          rate of the EKF prediction, default PIOS_SENSOR_RATE
+ *   -o file           write the Allan deviation curves as CSV
+ *   -x file           write the variances as settings for the GCS to import
+ *
+ * The log is replayed as fast as the host goes, on a clock taken from the log
+ * timestamps. The flight code is the unmodified StateEstimation module with its
+ * filters, fed the sensor objects of the log through UAVTalk. The estimate is
+ * scored by its innovations, the difference between each GPS position and
+ * velocity and the estimate when the GPS solution came in, so the RMS of a
+ * sweep points at the variances which predict best.
+ *
+ * The module and the object manager keep their state in statics, every point
+ * of a sweep therefore replays in a forked process of its own.
+ */
+
+#include <openpilot.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include <CoordinateConversions.h>
+
+#include <accelsensor.h>
+#include <accelstate.h>
+#include <airspeedstate.h>
+#include <attitudesettings.h>
+#include <attitudestate.h>
+#include <auxmagsettings.h>
+#include <ekfconfiguration.h>
+#include <ekfstatevariance.h>
+#include <gpspositionsensor.h>
+#include <gpssettings.h>
+#include <gpsvelocitysensor.h>
+#include <gyrostate.h>
+#include <homelocation.h>
+#include <magstate.h>
+#include <positionstate.h>
+#include <revosettings.h>
+#include <velocitystate.h>
+
+#include "replay.h"
+
+#define MAX_OVERRIDES   16
+#define MAX_SWEEPS      4
+#define LOG_HEADER_SIZE (sizeof(uint32_t) + sizeof(int64_t))
+
+int32_t StateEstimationInitialize(void);
+int32_t StateEstimationStart(void);
+
+struct variance {
+    const char *name;
+    size_t     offset;
+};
+
+#define VARIANCE(field, element) { #field "." #element, offsetof(EKFConfigurationData, field.element) }
+
+static const struct variance variances[] = {
+    VARIANCE(P, PositionNorth),   VARIANCE(P, PositionEast),    VARIANCE(P, PositionDown),
+    VARIANCE(P, VelocityNorth),   VARIANCE(P, VelocityEast),    VARIANCE(P, VelocityDown),
+    VARIANCE(P, AttitudeQ1),      VARIANCE(P, AttitudeQ2),      VARIANCE(P, AttitudeQ3),
+    VARIANCE(P, AttitudeQ4),      VARIANCE(P, GyroDriftX),      VARIANCE(P, GyroDriftY),
+    VARIANCE(P, GyroDriftZ),      VARIANCE(P, AccelBiasX),      VARIANCE(P, AccelBiasY),
+    VARIANCE(P, AccelBiasZ),
+    VARIANCE(Q, GyroX),           VARIANCE(Q, GyroY),           VARIANCE(Q, GyroZ),
+    VARIANCE(Q, AccelX),          VARIANCE(Q, AccelY),          VARIANCE(Q, AccelZ),
+    VARIANCE(Q, GyroDriftX),      VARIANCE(Q, GyroDriftY),      VARIANCE(Q, GyroDriftZ),
+    VARIANCE(Q, AccelDriftX),     VARIANCE(Q, AccelDriftY),     VARIANCE(Q, AccelDriftZ),
+    VARIANCE(R, GPSPosNorth),     VARIANCE(R, GPSPosEast),      VARIANCE(R, GPSPosDown),
+    VARIANCE(R, GPSVelNorth),     VARIANCE(R, GPSVelEast),      VARIANCE(R, GPSVelDown),
+    VARIANCE(R, MagX),            VARIANCE(R, MagY),            VARIANCE(R, MagZ),
+    VARIANCE(R, BaroZ),
+    VARIANCE(FakeR, FakeGPSPosIndoor), VARIANCE(FakeR, FakeGPSVelIndoor), VARIANCE(FakeR, FakeGPSVelAirspeed),
+};
+
+static const struct {
+    const char *name;
+    uint8_t    algorithm;
+} algorithms[] = {
+    { "cf",          REVOSETTINGS_FUSIONALGORITHM_BASICCOMPLEMENTARY         },
+    { "cfm",         REVOSETTINGS_FUSIONALGORITHM_COMPLEMENTARYMAG           },
+    { "cfmgps",      REVOSETTINGS_FUSIONALGORITHM_COMPLEMENTARYMAGGPSOUTDOOR },
+    { "fast",        REVOSETTINGS_FUSIONALGORITHM_ATTITUDEONLYFAST           },
+    { "ins13indoor", REVOSETTINGS_FUSIONALGORITHM_INS13INDOOR                },
+    { "ins13",       REVOSETTINGS_FUSIONALGORITHM_GPSNAVIGATIONINS13         },
+    { "ins16indoor", REVOSETTINGS_FUSIONALGORITHM_INS16INDOOR                },
+    { "ins16",       REVOSETTINGS_FUSIONALGORITHM_GPSNAVIGATIONINS16         },
+};
+
+struct override {
+    const struct variance *variance;
+    float value;
+};
+
+struct sweep {
+    const struct variance *variance;
+    float    from;
+    float    to;
+    uint16_t steps;
+};
+
+/* what a replay reports, written whole to the pipe by the sweep workers */
+struct result {
+    uint32_t point;
+    uint32_t posCount;
+    uint32_t velCount;
+    double   posSquares;
+    double   velSquares;
+    double   logSeconds;
+    double   wallSeconds;
+    float    values[MAX_SWEEPS];
+};
+
+static struct {
+    const uint8_t *log;
+    size_t   logSize;
+    int16_t  algorithm;
+    struct override overrides[MAX_OVERRIDES + MAX_SWEEPS];
+    uint8_t  overrideCount;
+    struct sweep sweeps[MAX_SWEEPS];
+    uint8_t  sweepCount;
+    uint32_t warmup_ms;
+    uint32_t csvPeriod_ms;
+    FILE     *csv;
+    bool     allan;
+    float    inertialRate;
+    FILE     *xml;
+} opts = {
+    .algorithm    = -1,
+    .warmup_ms    = 10000,
+    .csvPeriod_ms = 100,
+    .inertialRate = PIOS_SENSOR_RATE,
+};
+
+/* the state of the replay in progress */
+static struct result result;
+static uint64_t scoreFrom_us;
+static bool rxTimeEcho[2];
+static BaseFrame homeFrame;
+static bool homeSet;
+
+/* the objects the replay computes itself, their logged copies are not received */
+static uint32_t outputs[9];
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: ekfreplay.elf [-a algorithm] [-S field=value]... [-s field=from:to:n]...\n"
+                    "                     [-j jobs] [-w seconds] [-o file.csv] [-r milliseconds] log.opl\n"
+                    "       ekfreplay.elf -A [-f hertz] [-j threads] [-o file.csv] [-x file.xml] log.opl\n");
+    exit(2);
+}
+
+static const struct variance *findVariance(const char *name, size_t length)
+{
+    for (uint8_t i = 0; i < NELEMENTS(variances); i++) {
+        if (strlen(variances[i].name) == length && !strncmp(variances[i].name, name, length)) {
+            return &variances[i];
+        }
+    }
+    fprintf(stderr, "ekfreplay: no EKFConfiguration variance %.*s\n", (int)length, name);
+    exit(2);
+}
+
+/* overrides are kept as the replay goes, the log may set the objects at any time */
+
+static void ekfConfigurationUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    EKFConfigurationData config;
+    bool changed = false;
+
+    EKFConfigurationGet(&config);
+    for (uint8_t i = 0; i < opts.overrideCount; i++) {
+        float *value = (float *)((uint8_t *)&config + opts.overrides[i].variance->offset);
+        if (*value != opts.overrides[i].value) {
+            *value  = opts.overrides[i].value;
+            changed = true;
+        }
+    }
+    // the set calls back here, with nothing left to change
+    if (changed) {
+        EKFConfigurationSet(&config);
+    }
+}
+
+static void revoSettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    uint8_t algorithm;
+
+    RevoSettingsFusionAlgorithmGet(&algorithm);
+    if (opts.algorithm >= 0 && algorithm != opts.algorithm) {
+        algorithm = (uint8_t)opts.algorithm;
+        RevoSettingsFusionAlgorithmSet(&algorithm);
+    }
+}
+
+static void homeLocationUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    HomeLocationData home;
+
+    HomeLocationGet(&home);
+    homeSet = home.Set == HOMELOCATION_SET_TRUE;
+    if (homeSet) {
+        int32_t LLAi[3] = { home.Latitude, home.Longitude, (int32_t)(home.Altitude * 1e4f) };
+        BaseFrameFromLLA(LLAi, &homeFrame);
+    }
+}
+
+/*
+ * The RxTime of the GPS objects is the flight clock of the logging board,
+ * meaningless on the replay clock. Cleared, the EKF compensates the delay
+ * by EKFConfiguration.GPSDelay only. Clearing it updates the object again,
+ * that echo is neither cleared nor scored.
+ */
+static bool clearRxTime(UAVObjHandle obj, bool *echo)
+{
+    uint32_t rxTime;
+
+    if (*echo) {
+        *echo = false;
+        return false;
+    }
+    if (obj == GPSPositionSensorHandle()) {
+        GPSPositionSensorRxTimeGet(&rxTime);
+    } else {
+        GPSVelocitySensorRxTimeGet(&rxTime);
+    }
+    if (rxTime) {
+        rxTime = 0;
+        *echo  = true;
+        if (obj == GPSPositionSensorHandle()) {
+            GPSPositionSensorRxTimeSet(&rxTime);
+        } else {
+            GPSVelocitySensorRxTimeSet(&rxTime);
+        }
+    }
+    return true;
+}
+
+static void gpsPositionUpdatedCb(UAVObjEvent *ev)
+{
+    GPSPositionSensorData gps;
+    GPSSettingsData settings;
+    PositionStateData position;
+
+    if (!clearRxTime(ev->obj, &rxTimeEcho[0]) || !homeSet || replay_time() < scoreFrom_us) {
+        return;
+    }
+    GPSPositionSensorGet(&gps);
+    GPSSettingsGet(&settings);
+    // the fixes filterlla.c takes
+    if (gps.PDOP >= settings.MaxPDOP || gps.Satellites < settings.MinSatellites ||
+        gps.Status != GPSPOSITIONSENSOR_STATUS_FIX3D || (gps.Latitude == 0 && gps.Longitude == 0)) {
+        return;
+    }
+    int32_t LLAi[3] = { gps.Latitude, gps.Longitude, (int32_t)((gps.Altitude + gps.GeoidSeparation) * 1e4f) };
+    float NED[3];
+    LLA2BaseFrame(LLAi, &homeFrame, NED);
+
+    PositionStateGet(&position);
+    result.posSquares += (NED[0] - position.North) * (NED[0] - position.North) +
+                         (NED[1] - position.East) * (NED[1] - position.East) +
+                         (NED[2] - position.Down) * (NED[2] - position.Down);
+    result.posCount++;
+}
+
+static void gpsVelocityUpdatedCb(UAVObjEvent *ev)
+{
+    GPSVelocitySensorData gps;
+    VelocityStateData velocity;
+
+    if (!clearRxTime(ev->obj, &rxTimeEcho[1]) || replay_time() < scoreFrom_us) {
+        return;
+    }
+    GPSVelocitySensorGet(&gps);
+    VelocityStateGet(&velocity);
+    result.velSquares += (gps.North - velocity.North) * (gps.North - velocity.North) +
+                         (gps.East - velocity.East) * (gps.East - velocity.East) +
+                         (gps.Down - velocity.Down) * (gps.Down - velocity.Down);
+    result.velCount++;
+}
+
+static void csvRow(void)
+{
+    PositionStateData position;
+    VelocityStateData velocity;
+    AttitudeStateData attitude;
+
+    PositionStateGet(&position);
+    VelocityStateGet(&velocity);
+    AttitudeStateGet(&attitude);
+    fprintf(opts.csv, "%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.2f,%.2f,%.2f\n",
+            replay_time() * 1e-6,
+            (double)position.North, (double)position.East, (double)position.Down,
+            (double)velocity.North, (double)velocity.East, (double)velocity.Down,
+            (double)attitude.Roll, (double)attitude.Pitch, (double)attitude.Yaw);
+}
+
+static int32_t discardOutput(__attribute__((unused)) uint8_t *data, int32_t length)
+{
+    return length;
+}
+
+static bool isOutput(uint32_t objId)
+{
+    for (uint8_t i = 0; i < NELEMENTS(outputs); i++) {
+        // the objects and their metadata
+        if ((objId & ~1u) == outputs[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static double wallClock(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Feed the objects of the log to the flight code, on the clock of the log
+ */
+static void feedLog(void)
+{
+    UAVTalkConnection uavTalk = UAVTalkInitialize(&discardOutput);
+
+    PIOS_Assert(uavTalk);
+
+    uint64_t first_us   = 0;
+    uint64_t nextRow_us = 0;
+    for (size_t pos = 0; opts.logSize - pos >= LOG_HEADER_SIZE;) {
+        uint32_t timestamp;
+        int64_t size;
+        memcpy(&timestamp, opts.log + pos, sizeof(timestamp));
+        memcpy(&size, opts.log + pos + sizeof(timestamp), sizeof(size));
+        pos += LOG_HEADER_SIZE;
+
+        // the checks of the GCS log replay, a corrupt log ends there
+        if (size < 1 || size > 1024 * 1024 || (uint64_t)size > opts.logSize - pos) {
+            break;
+        }
+        uint64_t time_us = (uint64_t)timestamp * 1000;
+        if (pos == LOG_HEADER_SIZE) {
+            first_us     = time_us;
+            scoreFrom_us = time_us + (uint64_t)opts.warmup_ms * 1000;
+            nextRow_us   = time_us;
+        } else if (time_us < replay_time() || time_us - replay_time() > 60ull * 60 * 1000 * 1000) {
+            break;
+        }
+
+        while (opts.csv && nextRow_us < time_us) {
+            replay_advance(nextRow_us);
+            csvRow();
+            nextRow_us += (uint64_t)opts.csvPeriod_ms * 1000;
+        }
+        replay_advance(time_us);
+
+        for (const uint8_t *byte = opts.log + pos; byte < opts.log + pos + size; byte++) {
+            if (UAVTalkProcessInputStreamQuiet(uavTalk, *byte) == UAVTALK_STATE_COMPLETE &&
+                !isOutput(UAVTalkGetPacketObjId(uavTalk))) {
+                UAVTalkReceiveObject(uavTalk);
+                // the events of each object before the next, as the flight would
+                replay_run_pending();
+            }
+        }
+        pos += size;
+    }
+
+    result.logSeconds = (replay_time() - first_us) * 1e-6;
+}
+
+/**
+ * Replay the log once with the overrides, filling in the result
+ */
+static void replay(void)
+{
+    double start = wallClock();
+
+    // as pios_board.c brings the system up, then the module
+    UAVObjInitialize();
+    AlarmsInitialize();
+
+    // registered by the other modules on the flight side
+    AccelSensorInitialize();
+    AttitudeSettingsInitialize();
+    AuxMagSettingsInitialize();
+    StateEstimationInitialize();
+    GPSSettingsInitialize();
+    EKFConfigurationInitialize();
+
+    outputs[0] = UAVObjGetID(GyroStateHandle());
+    outputs[1] = UAVObjGetID(AccelStateHandle());
+    outputs[2] = UAVObjGetID(MagStateHandle());
+    outputs[3] = UAVObjGetID(AirspeedStateHandle());
+    outputs[4] = UAVObjGetID(PositionStateHandle());
+    outputs[5] = UAVObjGetID(VelocityStateHandle());
+    outputs[6] = UAVObjGetID(AttitudeStateHandle());
+    outputs[7] = UAVObjGetID(EKFStateVarianceHandle());
+    outputs[8] = UAVObjGetID(SystemAlarmsHandle());
+
+    EKFConfigurationConnectCallback(&ekfConfigurationUpdatedCb);
+    RevoSettingsConnectCallback(&revoSettingsUpdatedCb);
+    HomeLocationConnectCallback(&homeLocationUpdatedCb);
+    GPSPositionSensorConnectCallback(&gpsPositionUpdatedCb);
+    GPSVelocitySensorConnectCallback(&gpsVelocityUpdatedCb);
+    ekfConfigurationUpdatedCb(NULL);
+    revoSettingsUpdatedCb(NULL);
+    replay_run_pending();
+
+    StateEstimationStart();
+
+    feedLog();
+    result.wallSeconds = wallClock() - start;
+}
+
+/**
+ * Characterise the sensors of the log, printing the variances which changed as options for the replay
+ */
+static int characterise(uint32_t threads, const char *curvesFile, const char *xmlFile)
+{
+    FILE *curves = NULL, *xml = NULL;
+    EKFConfigurationData before, after;
+
+    if ((curvesFile && !(curves = fopen(curvesFile, "w"))) || (xmlFile && !(xml = fopen(xmlFile, "w")))) {
+        perror(curves ? xmlFile : curvesFile);
+        return 1;
+    }
+
+    UAVObjInitialize();
+    allan_collect();
+    feedLog();
+
+    EKFConfigurationGet(&before);
+    int rc = allan_report(threads, opts.inertialRate, curves, xml);
+    EKFConfigurationGet(&after);
+    if (!rc) {
+        printf("\n");
+        for (uint8_t i = 0; i < NELEMENTS(variances); i++) {
+            const float *old = (const float *)((const uint8_t *)&before + variances[i].offset);
+            const float *new = (const float *)((const uint8_t *)&after + variances[i].offset);
+            if (*new != *old) {
+                printf("-S %s=%g ", variances[i].name, (double)*new);
+            }
+        }
+        printf("\n");
+    }
+    if (curves) {
+        fclose(curves);
+    }
+    if (xml) {
+        fclose(xml);
+    }
+    return rc;
+}
+
+static void printResult(const struct result *r)
+{
+    for (uint8_t i = 0; i < opts.sweepCount; i++) {
+        printf("%14g", (double)r->values[i]);
+    }
+    printf("%12.4f %8u %12.4f %8u %10.1f %8.2f %10.0f\n",
+           r->posCount ? sqrt(r->posSquares / r->posCount) : NAN, r->posCount,
+           r->velCount ? sqrt(r->velSquares / r->velCount) : NAN, r->velCount,
+           r->logSeconds, r->wallSeconds, r->wallSeconds > 0 ? r->logSeconds / r->wallSeconds : 0);
+}
+
+static void printHeader(void)
+{
+    for (uint8_t i = 0; i < opts.sweepCount; i++) {
+        printf("%14s", opts.sweeps[i].variance->name);
+    }
+    printf("%12s %8s %12s %8s %10s %8s %10s\n", "pos rms(m)", "fixes", "vel rms(m/s)", "fixes", "log(s)", "wall(s)", "realtime");
+}
+
+static double score(const struct result *r)
+{
+    if (!r->posCount && !r->velCount) {
+        return INFINITY;
+    }
+    return (r->posCount ? sqrt(r->posSquares / r->posCount) : 0) + (r->velCount ? sqrt(r->velSquares / r->velCount) : 0);
+}
+
+static int byScore(const void *a, const void *b)
+{
+    double sa = score(a), sb = score(b);
+
+    return (sa < sb) ? 1 : (sa > sb) ? -1 : 0;
+}
+
+/**
+ * Set the sweep values of a point, the first sweep varies slowest
+ */
+static void selectPoint(uint32_t point)
+{
+    for (int i = opts.sweepCount - 1; i >= 0; i--) {
+        const struct sweep *sweep = &opts.sweeps[i];
+        uint16_t step = point % sweep->steps;
+        point /= sweep->steps;
+
+        float value = sweep->from;
+        if (sweep->steps > 1) {
+            value = sweep->from * powf(sweep->to / sweep->from, (float)step / (sweep->steps - 1));
+        }
+        opts.overrides[opts.overrideCount + i].variance = sweep->variance;
+        opts.overrides[opts.overrideCount + i].value    = value;
+        result.values[i] = value;
+    }
+    opts.overrideCount += opts.sweepCount;
+}
+
+/**
+ * Replay every point of the sweeps in worker processes, jobs at a time
+ */
+static int runSweep(uint32_t points, uint32_t jobs)
+{
+    struct result *results = calloc(points, sizeof(*results));
+    int fds[2];
+
+    if (!results || pipe(fds)) {
+        perror("ekfreplay");
+        return 1;
+    }
+
+    uint32_t started = 0, done = 0, running = 0;
+    while (done < points) {
+        while (running < jobs && started < points) {
+            pid_t pid = fork();
+            if (pid < 0) {
+                perror("ekfreplay: fork");
+                return 1;
+            }
+            if (pid == 0) {
+                close(fds[0]);
+                result.point = started;
+                selectPoint(started);
+                replay();
+                // a result is far below PIPE_BUF, the write is atomic
+                _exit(write(fds[1], &result, sizeof(result)) == sizeof(result) ? 0 : 1);
+            }
+            started++;
+            running++;
+        }
+
+        struct result r;
+        ssize_t got = read(fds[0], &r, sizeof(r));
+        if (got == sizeof(r) && r.point < points) {
+            results[r.point] = r;
+            fprintf(stderr, "\r%u/%u", done + 1, points);
+        } else if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        // collect the worker, one that died without a result counts as done too
+        int status;
+        if (wait(&status) > 0) {
+            running--;
+            done++;
+        }
+    }
+    fprintf(stderr, "\n");
+
+    qsort(results, points, sizeof(*results), byScore);
+    printHeader();
+    for (uint32_t i = 0; i < points; i++) {
+        printResult(&results[i]);
+    }
+    free(results);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    int opt;
+
+    const char *outFile = NULL, *xmlFile = NULL;
+
+    while ((opt = getopt(argc, argv, "a:S:s:j:w:o:r:Af:x:")) != -1) {
+        const char *eq = optarg ? strchr(optarg, '=') : NULL;
+        switch (opt) {
+        case 'a':
+            for (uint8_t i = 0; i < NELEMENTS(algorithms); i++) {
+                if (!strcmp(algorithms[i].name, optarg)) {
+                    opts.algorithm = algorithms[i].algorithm;
+                }
+            }
+            if (opts.algorithm < 0) {
+                usage();
+            }
+            break;
+        case 'S':
+            if (!eq || opts.overrideCount >= MAX_OVERRIDES) {
+                usage();
+            }
+            opts.overrides[opts.overrideCount].variance = findVariance(optarg, eq - optarg);
+            opts.overrides[opts.overrideCount].value    = strtof(eq + 1, NULL);
+            opts.overrideCount++;
+            break;
+        case 's':
+        {
+            struct sweep *sweep = &opts.sweeps[opts.sweepCount];
+            unsigned steps;
+            if (!eq || opts.sweepCount >= MAX_SWEEPS ||
+                sscanf(eq + 1, "%f:%f:%u", &sweep->from, &sweep->to, &steps) != 3 ||
+                !(sweep->from > 0) || !(sweep->to > 0) || steps < 1 || steps > 1000) {
+                usage();
+            }
+            sweep->variance = findVariance(optarg, eq - optarg);
+            sweep->steps    = steps;
+            opts.sweepCount++;
+            break;
+        }
+        case 'j':
+            jobs = atol(optarg);
+            break;
+        case 'w':
+            opts.warmup_ms = (uint32_t)(atof(optarg) * 1000);
+            break;
+        case 'o':
+            outFile = optarg;
+            break;
+        case 'r':
+            opts.csvPeriod_ms = atoi(optarg);
+            if (!opts.csvPeriod_ms) {
+                usage();
+            }
+            break;
+        case 'A':
+            opts.allan = true;
+            break;
+        case 'f':
+            opts.inertialRate = strtof(optarg, NULL);
+            if (!(opts.inertialRate > 0)) {
+                usage();
+            }
+            break;
+        case 'x':
+            xmlFile = optarg;
+            break;
+        default:
+            usage();
+        }
+    }
+    if (optind != argc - 1 || jobs < 1) {
+        usage();
+    }
+
+    int fd = open(argv[optind], O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) || st.st_size < (off_t)LOG_HEADER_SIZE) {
+        fprintf(stderr, "ekfreplay: %s: %s\n", argv[optind], fd < 0 ? strerror(errno) : "holds no packets");
+        return 1;
+    }
+    opts.logSize = st.st_size;
+    opts.log     = mmap(NULL, opts.logSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (opts.log == MAP_FAILED) {
+        perror("ekfreplay: mmap");
+        return 1;
+    }
+    // the log is read once front to back
+    madvise((void *)opts.log, opts.logSize, MADV_SEQUENTIAL);
+
+    if (opts.allan) {
+        return characterise(jobs, outFile, xmlFile);
+    }
+    if (outFile) {
+        opts.csv = fopen(outFile, "w");
+        if (!opts.csv) {
+            perror(outFile);
+            return 1;
+        }
+        fprintf(opts.csv, "time,north,east,down,velnorth,veleast,veldown,roll,pitch,yaw\n");
+    }
+
+    uint32_t points = 1;
+    for (uint8_t i = 0; i < opts.sweepCount; i++) {
+        points *= opts.sweeps[i].steps;
+    }
+    if (opts.sweepCount) {
+        if (opts.csv) {
+            fprintf(stderr, "ekfreplay: no CSV of a sweep\n");
+            return 2;
+        }
+        return runSweep(points, jobs);
+    }
+
+    replay();
+    if (opts.csv) {
+        fclose(opts.csv);
+    }
+    printHeader();
+    printResult(&result);
+    return 0;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,54 @@
+/**
+ ******************************************************************************
+ *
+ * @file       replay.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      The replay clock and the scheduling of the callbacks and events
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * The replay runs the flight code in one thread on a simulated clock. The
+ * delays, the tick count and the callback schedules all read this clock,
+ * which only moves forward when the replay advances it to the time of the
+ * next logged packet.
+ */
+
+/* move the clock forward, running the delayed callbacks which fall due on the way */
+void replay_advance(uint64_t time_us);
+uint64_t replay_time(void);
+
+/* run the queued events and the dispatched callbacks until none is left */
+void replay_run_pending(void);
+
+/*
+ * The Allan deviation of the sensors, see allan.c. allan_collect() connects
+ * to the sensor objects before the log is read, allan_report() computes the
+ * curves and sets EKFConfiguration to the noise read off them.
+ */
+void allan_collect(void);
+int allan_report(uint32_t threads, float inertialRate, FILE *curves, FILE *xml);
+
+#endif /* REPLAY_H */
@@ -0,0 +1,230 @@
+/**
+ ******************************************************************************
+ *
+ * @file       replay_os.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      The PiOS delay, callback scheduler and event dispatcher for the replay
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <openpilot.h>
+
+#include "replay.h"
+
+/* the events queued by the object manager, as the event dispatcher would */
+#define EVENT_QUEUE_SIZE 256
+
+struct DelayedCallbackInfoStruct {
+    struct DelayedCallbackInfoStruct *next;
+    DelayedCallback cb;
+    bool     dispatched;
+    bool     scheduled;
+    uint64_t due;
+};
+
+struct eventEntry {
+    UAVObjEvent ev;
+    UAVObjEventCallback cb;
+};
+
+static uint64_t now;
+static struct DelayedCallbackInfoStruct *callbacks;
+static struct eventEntry eventQueue[EVENT_QUEUE_SIZE];
+static uint32_t eventHead;
+static uint32_t eventTail;
+static EventStats eventStats;
+
+uint64_t replay_time(void)
+{
+    return now;
+}
+
+/**
+ * Returns the earliest time a delayed callback falls due at, UINT64_MAX for none
+ */
+static uint64_t nextDue(void)
+{
+    struct DelayedCallbackInfoStruct *info;
+    uint64_t due = UINT64_MAX;
+
+    LL_FOREACH(callbacks, info) {
+        if (info->scheduled && info->due < due) {
+            due = info->due;
+        }
+    }
+    return due;
+}
+
+void replay_advance(uint64_t time_us)
+{
+    for (uint64_t due = nextDue(); due <= time_us; due = nextDue()) {
+        if (due > now) {
+            now = due;
+        }
+        replay_run_pending();
+    }
+    if (time_us > now) {
+        now = time_us;
+    }
+}
+
+void replay_run_pending(void)
+{
+    bool ran;
+
+    do {
+        ran = false;
+        while (eventTail != eventHead) {
+            struct eventEntry entry = eventQueue[eventTail];
+            eventTail = (eventTail + 1) % EVENT_QUEUE_SIZE;
+            entry.cb(&entry.ev);
+            ran = true;
+        }
+
+        struct DelayedCallbackInfoStruct *info;
+        LL_FOREACH(callbacks, info) {
+            if (info->dispatched || (info->scheduled && info->due <= now)) {
+                // the run answers the dispatch and the schedule alike
+                info->dispatched = false;
+                info->scheduled  = false;
+                info->cb();
+                ran = true;
+            }
+        }
+    } while (ran);
+}
+
+/* PIOS_DELAY, the raw counter counts microseconds */
+
+uint32_t PIOS_DELAY_GetuS()
+{
+    return (uint32_t)now;
+}
+
+uint32_t PIOS_DELAY_GetuSSince(uint32_t t)
+{
+    return (uint32_t)now - t;
+}
+
+uint32_t PIOS_DELAY_GetRaw()
+{
+    return (uint32_t)now;
+}
+
+uint32_t PIOS_DELAY_DiffuS(uint32_t raw)
+{
+    return (uint32_t)now - raw;
+}
+
+portTickType xTaskGetTickCount(void)
+{
+    return (portTickType)(now / 1000);
+}
+
+/* PIOS_CALLBACKSCHEDULER, callbacks run in creation order once nothing else runs */
+
+DelayedCallbackInfo *PIOS_CALLBACKSCHEDULER_Create(
+    DelayedCallback cb,
+    __attribute__((unused)) DelayedCallbackPriority priority,
+    __attribute__((unused)) DelayedCallbackPriorityTask priorityTask,
+    __attribute__((unused)) int16_t callbackID,
+    __attribute__((unused)) uint32_t stacksize)
+{
+    DelayedCallbackInfo *info = calloc(1, sizeof(*info));
+
+    if (info) {
+        info->cb = cb;
+        LL_APPEND(callbacks, info);
+    }
+    return info;
+}
+
+int32_t PIOS_CALLBACKSCHEDULER_SetDeadline(__attribute__((unused)) DelayedCallbackInfo *cbinfo,
+                                           __attribute__((unused)) uint16_t periodMs,
+                                           __attribute__((unused)) uint16_t deadlineMs)
+{
+    return 0;
+}
+
+int32_t PIOS_CALLBACKSCHEDULER_SetDeadlineMode(__attribute__((unused)) DelayedCallbackPriorityTask priorityTask,
+                                               __attribute__((unused)) bool enable)
+{
+    return 0;
+}
+
+int32_t PIOS_CALLBACKSCHEDULER_Schedule(DelayedCallbackInfo *cbinfo, int32_t milliseconds, DelayedCallbackUpdateMode updatemode)
+{
+    uint64_t due = now + (uint64_t)(milliseconds > 0 ? milliseconds : 0) * 1000;
+
+    if (cbinfo->scheduled) {
+        if (updatemode == CALLBACK_UPDATEMODE_NONE ||
+            (updatemode == CALLBACK_UPDATEMODE_SOONER && due >= cbinfo->due) ||
+            (updatemode == CALLBACK_UPDATEMODE_LATER && due <= cbinfo->due)) {
+            return 0;
+        }
+        cbinfo->due = due;
+        return 2;
+    }
+    cbinfo->scheduled = true;
+    cbinfo->due = due;
+    return 1;
+}
+
+int32_t PIOS_CALLBACKSCHEDULER_Dispatch(DelayedCallbackInfo *cbinfo)
+{
+    cbinfo->dispatched = true;
+    return 1;
+}
+
+/* the event dispatcher, the object callbacks run from the queue in order */
+
+int32_t EventCallbackDispatch(UAVObjEvent *ev, UAVObjEventCallback cb)
+{
+    uint32_t next = (eventHead + 1) % EVENT_QUEUE_SIZE;
+
+    if (next == eventTail) {
+        ++eventStats.eventErrors;
+        return pdFALSE;
+    }
+    eventQueue[eventHead].ev = *ev;
+    eventQueue[eventHead].cb = cb;
+    eventHead = next;
+    return pdTRUE;
+}
+
+void EventGetStats(EventStats *statsOut)
+{
+    *statsOut = eventStats;
+}
+
+void EventClearStats()
+{
+    memset(&eventStats, 0, sizeof(eventStats));
+}
+
+/* nobody sees the LEDs of a replay */
+void PIOS_NOTIFY_StartNotification(__attribute__((unused)) pios_notify_notification notification,
+                                   __attribute__((unused)) pios_notify_priority priority)
+{}
+
+/**
+ * @}
+ * @}
+ */
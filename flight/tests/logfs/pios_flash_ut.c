@@ -147,6 +147,38 @@ static int32_t PIOS_Flash_UT_WriteData(uintptr_t flash_id, uint32_t addr, uint8_
     return 0;
 }
 
+static int32_t PIOS_Flash_UT_WriteChunks(uintptr_t flash_id, uint32_t addr, struct pios_flash_chunk chunks[], uint32_t num)
+{
+    /* Check inputs */
+    assert(chunks);
+
+    struct flash_ut_dev *flash_dev = (struct flash_ut_dev *)flash_id;
+
+    assert(flash_dev->transaction_in_progress);
+
+    /* Like a jedec page program, all chunks must fit within one 256 byte page */
+    uint32_t len = 0;
+    for (uint32_t i = 0; i < num; i++) {
+        len += chunks[i].len;
+    }
+    assert(((addr & 0xff) + len) <= 0x100);
+
+    if (fseek(flash_dev->flash_file, addr, SEEK_SET) != 0) {
+        assert(0);
+    }
+
+    for (uint32_t i = 0; i < num; i++) {
+        assert(chunks[i].addr);
+
+        size_t s;
+        s = fwrite(chunks[i].addr, 1, chunks[i].len, flash_dev->flash_file);
+
+        assert(s == chunks[i].len);
+    }
+
+    return 0;
+}
+
 static int32_t PIOS_Flash_UT_ReadData(uintptr_t flash_id, uint32_t addr, uint8_t *data, uint16_t len)
 {
     /* Check inputs */
@@ -173,6 +205,7 @@ const struct pios_flash_driver pios_ut_flash_driver = {
     .start_transaction = PIOS_Flash_UT_StartTransaction,
     .end_transaction   = PIOS_Flash_UT_EndTransaction,
     .erase_sector = PIOS_Flash_UT_EraseSector,
+    .write_chunks = PIOS_Flash_UT_WriteChunks,
     .write_data   = PIOS_Flash_UT_WriteData,
     .read_data    = PIOS_Flash_UT_ReadData,
 };
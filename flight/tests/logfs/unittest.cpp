@@ -264,6 +264,41 @@ TEST_F(LogfsTestCooked, FillFilesystemAndGarbageCollect) {
     EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
 }
 
+TEST_F(LogfsTestCooked, GarbageCollectStats) {
+    uint16_t num_slots = (flashfs_config_partition_a.arena_size / flashfs_config_partition_a.slot_size) - 1;
+    struct PIOS_FLASHFS_Stats stats;
+
+    /* Fill the log with versions of one object */
+    for (uint32_t i = 0; i < num_slots; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1, sizeof(obj1)));
+    }
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(1, stats.num_active_slots);
+    EXPECT_EQ(0, stats.num_free_slots);
+    EXPECT_EQ(num_slots - 1, stats.num_obsolete_slots);
+    EXPECT_EQ(0, stats.gc_count);
+
+    /* The next save has to collect the garbage */
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 1, obj1, sizeof(obj1)));
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(2, stats.num_active_slots);
+    EXPECT_EQ(0, stats.num_obsolete_slots);
+    EXPECT_EQ(1, stats.gc_count);
+    EXPECT_EQ(1, stats.gc_foreground_count);
+    EXPECT_EQ(sizeof(obj1) + 12u, stats.gc_bytes_copied);
+
+    /* Arena 0 was erased on the first mount and arena 1 for the collection, the others never */
+    EXPECT_EQ(0u, stats.min_arena_erases);
+    EXPECT_EQ(1u, stats.max_arena_erases);
+
+    /* The erase counts are kept in flash */
+    PIOS_FLASHFS_Logfs_Destroy(fs_id);
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_partition_a, &pios_ut_flash_driver, flash_id));
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(1u, stats.max_arena_erases);
+    EXPECT_EQ(0, stats.gc_count);
+}
+
 TEST_F(LogfsTestCooked, WriteManyVerify) {
     for (uint32_t i = 0; i < 10000; i++) {
         /* Write a collection of objects */
@@ -297,6 +332,165 @@ TEST_F(LogfsTestCooked, WriteManyVerify) {
     EXPECT_EQ(0, memcmp(obj3, obj3_check, sizeof(obj3)));
 }
 
+TEST_F(LogfsTestCooked, WriteDeleteRemountVerify) {
+    /* Leave obsolete slots for OBJ1 in the log before the current versions */
+    for (uint32_t i = 0; i < 10; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1_alt, sizeof(obj1_alt)));
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ2_ID, 0, obj2, sizeof(obj2)));
+    }
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1, sizeof(obj1)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 123, obj1_alt, sizeof(obj1_alt)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id, OBJ2_ID, 0));
+
+    /* Mount the same flash again, the slot index is rebuilt from the log */
+    PIOS_FLASHFS_Logfs_Destroy(fs_id);
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_partition_a, &pios_ut_flash_driver, flash_id));
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1, obj1_check, sizeof(obj1)));
+
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 123, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+
+    unsigned char obj2_check[OBJ2_SIZE];
+    EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ2_ID, 0, obj2_check, sizeof(obj2_check)));
+
+    /* Only the two OBJ1 instances are left active */
+    struct PIOS_FLASHFS_Stats stats;
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(2, stats.num_active_slots);
+}
+
+TEST_F(LogfsTestCooked, BackgroundGarbageCollect) {
+    /* Fill most of the log with obsolete versions of OBJ2 */
+    for (uint32_t i = 0; i < 10; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i, obj1, sizeof(obj1)));
+    }
+    for (uint32_t i = 0; i < 200; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ2_ID, 0, obj2, sizeof(obj2)));
+    }
+
+    /* Step the maintenance until it is idle, changing objects while it is collecting */
+    struct PIOS_FLASHFS_Stats stats;
+    uint32_t steps = 0;
+    int32_t rc;
+    while ((rc = PIOS_FLASHFS_Maintain(fs_id)) > 0 && steps < 1000) {
+        if (++steps == 3) {
+            EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 3, obj1_alt, sizeof(obj1_alt)));
+            EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id, OBJ1_ID, 5));
+        }
+    }
+    EXPECT_EQ(0, rc);
+    EXPECT_GT(steps, 3u);
+
+    /*
+     * Garbage is gone, only OBJ1 instances 0-9 without 5 and OBJ2 are left active.
+     * Copies of the two changed instances may have been dropped after being copied.
+     */
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(10, stats.num_active_slots);
+    EXPECT_LE((flashfs_config_partition_a.arena_size / flashfs_config_partition_a.slot_size) - 1 - 10 - 2, stats.num_free_slots);
+
+    /* Mount the same flash again to check what actually ended up in flash */
+    PIOS_FLASHFS_Logfs_Destroy(fs_id);
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_partition_a, &pios_ut_flash_driver, flash_id));
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    for (uint32_t i = 0; i < 10; i++) {
+        memset(obj1_check, 0, sizeof(obj1_check));
+        if (i == 5) {
+            EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, i, obj1_check, sizeof(obj1_check)));
+        } else {
+            EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, i, obj1_check, sizeof(obj1_check)));
+            EXPECT_EQ(0, memcmp((i == 3) ? obj1_alt : obj1, obj1_check, sizeof(obj1)));
+        }
+    }
+
+    unsigned char obj2_check[OBJ2_SIZE];
+    memset(obj2_check, 0, sizeof(obj2_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ2_ID, 0, obj2_check, sizeof(obj2_check)));
+    EXPECT_EQ(0, memcmp(obj2, obj2_check, sizeof(obj2)));
+
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(10, stats.num_active_slots);
+}
+
+struct batch_entry {
+    uint32_t obj_id;
+    uint16_t obj_inst_id;
+    uint8_t  *obj_data;
+    uint16_t obj_size;
+};
+
+struct batch {
+    const struct batch_entry *entries;
+    uint32_t num_entries;
+    uint32_t next_entry;
+};
+
+static bool batch_next(void *context, uint32_t *obj_id, uint16_t *obj_inst_id, uint8_t **obj_data, uint16_t *obj_size)
+{
+    struct batch *b = (struct batch *)context;
+
+    if (b->next_entry >= b->num_entries) {
+        return false;
+    }
+
+    const struct batch_entry *entry = &b->entries[b->next_entry++];
+    *obj_id      = entry->obj_id;
+    *obj_inst_id = entry->obj_inst_id;
+    *obj_data    = entry->obj_data;
+    *obj_size    = entry->obj_size;
+    return true;
+}
+
+TEST_F(LogfsTestCooked, SaveBatchSkipsUnchanged) {
+    const struct batch_entry entries[] = {
+        { OBJ0_ID, 0, NULL, 0            },
+        { OBJ1_ID, 0, obj1, sizeof(obj1) },
+        { OBJ2_ID, 0, obj2, sizeof(obj2) },
+        { OBJ3_ID, 0, obj3, sizeof(obj3) },
+    };
+    struct batch b = { entries, sizeof(entries) / sizeof(entries[0]), 0 };
+    struct PIOS_FLASHFS_Stats stats;
+
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSaveBatch(fs_id, batch_next, &b));
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(4, stats.num_active_slots);
+    uint16_t free_slots = stats.num_free_slots;
+
+    /* Nothing changed, nothing is written */
+    b.next_entry = 0;
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSaveBatch(fs_id, batch_next, &b));
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(4, stats.num_active_slots);
+    EXPECT_EQ(free_slots, stats.num_free_slots);
+
+    /* Only the changed object is written */
+    const struct batch_entry changed[] = {
+        { OBJ1_ID, 0, obj1_alt, sizeof(obj1_alt) },
+        { OBJ2_ID, 0, obj2,     sizeof(obj2)     },
+    };
+    struct batch c = { changed, sizeof(changed) / sizeof(changed[0]), 0 };
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSaveBatch(fs_id, batch_next, &c));
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(4, stats.num_active_slots);
+    EXPECT_EQ(free_slots - 1, stats.num_free_slots);
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+
+    unsigned char obj3_check[OBJ3_SIZE];
+    memset(obj3_check, 0, sizeof(obj3_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ3_ID, 0, obj3_check, sizeof(obj3_check)));
+    EXPECT_EQ(0, memcmp(obj3, obj3_check, sizeof(obj3)));
+}
+
 class LogfsTestCookedMultiPart : public LogfsTestRaw {
 protected:
     virtual void SetUp()
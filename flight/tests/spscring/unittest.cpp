@@ -0,0 +1,160 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* abort */
+#include <string.h> /* memset */
+#include <pthread.h> /* pthread_create */
+#include <sched.h> /* sched_yield */
+
+extern "C" {
+#include "spsc_ring.h"
+}
+
+#define RING_SIZE     64
+#define STRESS_LENGTH (1024 * 1024)
+
+// To use a test fixture, derive a class from testing::Test.
+class SpscRingTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        memset(storage, 0, sizeof(storage));
+        ASSERT_EQ(0, spscRing_init(&ring, storage, RING_SIZE));
+    }
+
+    t_spsc_ring ring;
+    uint8_t storage[RING_SIZE];
+};
+
+TEST_F(SpscRingTest, init_requires_power_of_two) {
+    EXPECT_EQ(-1, spscRing_init(&ring, storage, 0));
+    EXPECT_EQ(-1, spscRing_init(&ring, storage, 65));
+    EXPECT_EQ(-1, spscRing_init(&ring, storage, 12));
+    EXPECT_EQ(0, spscRing_init(&ring, storage, 32));
+    EXPECT_EQ(32, spscRing_getSize(&ring));
+}
+
+TEST_F(SpscRingTest, whole_size_usable) {
+    uint8_t data[RING_SIZE + 1];
+    uint8_t out[RING_SIZE + 1];
+
+    for (int i = 0; i <= RING_SIZE; i++) {
+        data[i] = (uint8_t)i;
+    }
+
+    EXPECT_EQ(RING_SIZE, spscRing_getFree(&ring));
+    EXPECT_EQ(RING_SIZE, spscRing_putData(&ring, data, sizeof(data)));
+    EXPECT_EQ(0, spscRing_getFree(&ring));
+    EXPECT_EQ(0, spscRing_putData(&ring, data, 1));
+
+    EXPECT_EQ(RING_SIZE, spscRing_getData(&ring, out, sizeof(out)));
+    EXPECT_EQ(0, memcmp(data, out, RING_SIZE));
+    EXPECT_EQ(0, spscRing_getUsed(&ring));
+}
+
+TEST_F(SpscRingTest, wrap_around) {
+    uint8_t data[RING_SIZE / 2 + 7];
+    uint8_t out[sizeof(data)];
+
+    // walk the indices around the ring, and the free running counters past 2^16
+    for (int round = 0; round < 3000; round++) {
+        for (unsigned int i = 0; i < sizeof(data); i++) {
+            data[i] = (uint8_t)(round + i);
+        }
+        ASSERT_EQ(sizeof(data), spscRing_putData(&ring, data, sizeof(data)));
+        ASSERT_EQ(sizeof(data), spscRing_getUsed(&ring));
+        ASSERT_EQ(sizeof(data), spscRing_getData(&ring, out, sizeof(out)));
+        ASSERT_EQ(0, memcmp(data, out, sizeof(data)));
+    }
+}
+
+TEST_F(SpscRingTest, reserve_commit_in_place) {
+    uint8_t *span;
+    const uint8_t *rspan;
+    uint8_t out[RING_SIZE] = { 0 };
+
+    // move the head close to the end of the storage
+    ASSERT_EQ(RING_SIZE - 10, spscRing_putData(&ring, out, RING_SIZE - 10));
+    ASSERT_EQ(RING_SIZE - 10, spscRing_getData(&ring, out, RING_SIZE - 10));
+
+    // contiguous space ends at the end of the storage
+    EXPECT_EQ(10, spscRing_reserve(&ring, &span));
+    EXPECT_EQ(storage + RING_SIZE - 10, span);
+    memset(span, 0xa5, 10);
+    spscRing_commit(&ring, 10);
+
+    // and then continues at the start
+    EXPECT_EQ(RING_SIZE - 10, spscRing_reserve(&ring, &span));
+    EXPECT_EQ(storage, span);
+    memset(span, 0x5a, 4);
+    spscRing_commit(&ring, 4);
+
+    EXPECT_EQ(10, spscRing_peek(&ring, &rspan));
+    EXPECT_EQ(0xa5, rspan[9]);
+    spscRing_release(&ring, 10);
+    EXPECT_EQ(4, spscRing_peek(&ring, &rspan));
+    EXPECT_EQ(0x5a, rspan[0]);
+    spscRing_release(&ring, 4);
+    EXPECT_EQ(0, spscRing_peek(&ring, &rspan));
+}
+
+TEST_F(SpscRingTest, clear) {
+    uint8_t data[10] = { 0 };
+
+    spscRing_putData(&ring, data, sizeof(data));
+    spscRing_clearData(&ring);
+    EXPECT_EQ(0, spscRing_getUsed(&ring));
+    EXPECT_EQ(RING_SIZE, spscRing_getFree(&ring));
+}
+
+static void *producer(void *context)
+{
+    t_spsc_ring *ring = (t_spsc_ring *)context;
+    uint32_t sent     = 0;
+
+    while (sent < STRESS_LENGTH) {
+        uint8_t *span;
+        uint16_t len = spscRing_reserve(ring, &span);
+        if (len == 0) {
+            sched_yield();
+            continue;
+        }
+        if (len > STRESS_LENGTH - sent) {
+            len = STRESS_LENGTH - sent;
+        }
+        for (uint16_t i = 0; i < len; i++) {
+            span[i] = (uint8_t)(sent + i);
+        }
+        spscRing_commit(ring, len);
+        sent += len;
+    }
+    return NULL;
+}
+
+TEST_F(SpscRingTest, concurrent_producer_consumer) {
+    pthread_t thread;
+    uint32_t received = 0;
+    uint32_t errors   = 0;
+
+    ASSERT_EQ(0, pthread_create(&thread, NULL, producer, &ring));
+
+    while (received < STRESS_LENGTH) {
+        uint8_t out[13];
+        uint16_t len = spscRing_getData(&ring, out, sizeof(out));
+        if (len == 0) {
+            sched_yield();
+            continue;
+        }
+        for (uint16_t i = 0; i < len; i++) {
+            if (out[i] != (uint8_t)(received + i)) {
+                errors++;
+            }
+        }
+        received += len;
+    }
+
+    pthread_join(thread, NULL);
+
+    EXPECT_EQ(0u, errors);
+    EXPECT_EQ(0, spscRing_getUsed(&ring));
+}
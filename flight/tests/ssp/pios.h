@@ -0,0 +1,10 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+/* PIOS Feature Selection */
+#include "pios_config.h"
+
+#include <stdint.h>
+#include "pios_math.h"
+
+#endif /* PIOS_H */
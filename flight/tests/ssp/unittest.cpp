@@ -0,0 +1,275 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* abort */
+#include <string.h> /* memset */
+#include <deque>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include "ssp.h"
+}
+
+#define PAYLOAD_SIZE 63 // DFU packet size, as the bootloader sends
+#define BUFFER_SIZE  (PAYLOAD_SIZE + 2)
+#define TIMEOUT      60 // ticks to wait for an ack
+#define LATENCY      5 // ticks a byte takes to cross the link
+#define MAX_TICKS    (1000u * 1000u)
+
+// One direction of the simulated serial link: a byte arrives LATENCY ticks after
+// it was written, unless it is lost
+struct Link {
+    std::deque<std::pair<uint32_t, uint8_t> > bytes;
+    uint32_t lossPerMille;
+};
+
+static uint32_t now;
+static uint32_t seed;
+static Link toA;
+static Link toB;
+static Port_t portA;
+static Port_t portB;
+static std::vector<uint16_t> received; // packet numbers in the order they reached B
+static uint32_t corrupted; // packets that reached B with the payload of another packet
+
+static void makePayload(uint8_t *payload, uint16_t number)
+{
+    payload[0] = number & 0xff;
+    payload[1] = number >> 8;
+    for (int i = 2; i < PAYLOAD_SIZE; i++) {
+        payload[i] = (uint8_t)(number * 7 + i);
+    }
+}
+
+// Fixed linear congruential generator, so every run loses the same bytes
+static bool lost(const Link &link)
+{
+    seed = seed * 1103515245 + 12345;
+    return ((seed >> 16) % 1000) < link.lossPerMille;
+}
+
+static void linkWrite(Link &link, uint8_t c)
+{
+    if (!lost(link)) {
+        link.bytes.push_back(std::make_pair(now + LATENCY, c));
+    }
+}
+
+static int16_t linkRead(Link &link)
+{
+    if (link.bytes.empty() || link.bytes.front().first > now) {
+        return -1;
+    }
+    uint8_t c = link.bytes.front().second;
+    link.bytes.pop_front();
+    return c;
+}
+
+static void writeA(uint8_t c)
+{
+    linkWrite(toB, c);
+}
+
+static void writeB(uint8_t c)
+{
+    linkWrite(toA, c);
+}
+
+static int16_t readB(void)
+{
+    return linkRead(toB);
+}
+
+// The reads of A drive the simulation: whenever A finds no byte waiting, time
+// moves on a tick and B runs, so the blocking ssp_Synchronise() works too
+static int16_t readA(void)
+{
+    int16_t c = linkRead(toA);
+
+    if (c < 0) {
+        now++;
+        ssp_ReceiveProcess(&portB);
+        ssp_SendProcess(&portB);
+    }
+    return c;
+}
+
+static uint32_t getTime(void)
+{
+    return now;
+}
+
+static void callbackA(__attribute__((unused)) uint8_t *buf, __attribute__((unused)) uint16_t length) {}
+
+static void callbackB(uint8_t *buf, uint16_t length)
+{
+    uint8_t expected[PAYLOAD_SIZE];
+    uint16_t number = buf[0] | (buf[1] << 8);
+
+    makePayload(expected, number);
+    if (length != PAYLOAD_SIZE || memcmp(buf, expected, PAYLOAD_SIZE)) {
+        corrupted++;
+    }
+    received.push_back(number);
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class SspTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        now  = 0;
+        seed = 1;
+        toA.bytes.clear();
+        toB.bytes.clear();
+        received.clear();
+        corrupted = 0;
+    }
+
+    void init(uint8_t window, uint32_t lossPerMille, uint16_t maxRetry)
+    {
+        PortConfig_t configA;
+
+        memset(&configA, 0, sizeof(configA));
+        configA.rxBuf         = rxBufA;
+        configA.rxBufSize     = BUFFER_SIZE;
+        configA.txBuf         = txBufA;
+        configA.txBufSize     = BUFFER_SIZE;
+        configA.max_retry     = maxRetry;
+        configA.timeoutLen    = TIMEOUT;
+        configA.txWindow      = window;
+        configA.rxWindow      = window;
+        configA.pfCallBack    = callbackA;
+        configA.pfSerialRead  = readA;
+        configA.pfSerialWrite = writeA;
+        configA.pfGetTime     = getTime;
+
+        PortConfig_t configB = configA;
+
+        configB.rxBuf         = rxBufB;
+        configB.txBuf         = txBufB;
+        configB.pfCallBack    = callbackB;
+        configB.pfSerialRead  = readB;
+        configB.pfSerialWrite = writeB;
+
+        toA.lossPerMille = lossPerMille;
+        toB.lossPerMille = lossPerMille;
+        ssp_Init(&portA, &configA);
+        ssp_Init(&portB, &configB);
+    }
+
+    // Send packets first .. first + count - 1 from A to B, returns the number of timeouts
+    uint32_t send(uint16_t first, uint16_t count)
+    {
+        uint8_t payload[PAYLOAD_SIZE];
+        uint16_t next     = first;
+        uint32_t timeouts = 0;
+
+        while ((next < first + count || portA.txBusy) && now < MAX_TICKS) {
+            ssp_ReceiveProcess(&portA);
+            if (ssp_SendProcess(&portA) == SSP_TX_TIMEOUT) {
+                timeouts++;
+            }
+            if (next < first + count) {
+                makePayload(payload, next);
+                if (ssp_SendData(&portA, payload, PAYLOAD_SIZE) == SSP_TX_WAITING) {
+                    next++;
+                }
+            }
+        }
+        EXPECT_GT(MAX_TICKS, now);
+        return timeouts;
+    }
+
+    void expectInOrder(uint16_t first, uint16_t count, size_t from)
+    {
+        ASSERT_LE(from + count, received.size());
+        for (uint16_t i = 0; i < count; i++) {
+            EXPECT_EQ(first + i, received[from + i]);
+        }
+    }
+
+    uint8_t rxBufA[SSP_MAX_WINDOW * SSP_PACKET_BUF_SIZE(BUFFER_SIZE)];
+    uint8_t txBufA[SSP_MAX_WINDOW * SSP_PACKET_BUF_SIZE(BUFFER_SIZE)];
+    uint8_t rxBufB[SSP_MAX_WINDOW * SSP_PACKET_BUF_SIZE(BUFFER_SIZE)];
+    uint8_t txBufB[SSP_MAX_WINDOW * SSP_PACKET_BUF_SIZE(BUFFER_SIZE)];
+};
+
+TEST_F(SspTest, window_is_negotiated) {
+    init(4, 0, 4);
+    ASSERT_TRUE(ssp_Synchronise(&portA));
+    EXPECT_EQ(4, portA.txLimit);
+    EXPECT_EQ(4, portA.rxLimit);
+    EXPECT_EQ(4, portB.txLimit);
+    EXPECT_EQ(4, portB.rxLimit);
+}
+
+TEST_F(SspTest, window_of_one_stops_and_waits) {
+    init(1, 0, 4);
+    ASSERT_TRUE(ssp_Synchronise(&portA));
+    EXPECT_EQ(1, portA.txLimit);
+    EXPECT_EQ(0, portA.rxLimit);
+    EXPECT_EQ(1, portB.txLimit);
+    EXPECT_EQ(0, portB.rxLimit);
+}
+
+TEST_F(SspTest, lossless_across_sequence_wraps) {
+    init(4, 0, 4);
+    ASSERT_TRUE(ssp_Synchronise(&portA));
+    EXPECT_EQ(0u, send(0, 1000));
+    EXPECT_EQ(1000u, received.size());
+    expectInOrder(0, 1000, 0);
+    EXPECT_EQ(0u, corrupted);
+}
+
+TEST_F(SspTest, lossy_link_windowed) {
+    // about one packet or ack in ten is hit, so packets are held ahead of gaps and resent
+    init(4, 2, 10);
+    ASSERT_TRUE(ssp_Synchronise(&portA));
+    EXPECT_EQ(0u, send(0, 1000));
+    EXPECT_EQ(1000u, received.size());
+    expectInOrder(0, 1000, 0);
+    EXPECT_EQ(0u, corrupted);
+    EXPECT_LT(0u, portB.RxError);
+}
+
+TEST_F(SspTest, lossy_link_stop_and_wait) {
+    init(1, 2, 10);
+    ASSERT_TRUE(ssp_Synchronise(&portA));
+    EXPECT_EQ(0u, send(0, 300));
+    EXPECT_EQ(300u, received.size());
+    expectInOrder(0, 300, 0);
+    EXPECT_EQ(0u, corrupted);
+}
+
+TEST_F(SspTest, resynchronises_after_give_up) {
+    init(4, 0, 4);
+    ASSERT_TRUE(ssp_Synchronise(&portA));
+    EXPECT_EQ(0u, send(0, 10));
+
+    // packets 10 .. 13 never arrive, A gives up on them
+    toB.lossPerMille = 1000;
+    EXPECT_LT(0u, send(10, 4));
+    EXPECT_EQ(10u, received.size());
+
+    // B still waits for packet 10, the link only works again after a synch
+    toB.lossPerMille = 0;
+    EXPECT_EQ(0u, send(14, 300));
+    EXPECT_EQ(310u, received.size());
+    expectInOrder(0, 10, 0);
+    expectInOrder(14, 300, 10);
+    EXPECT_EQ(0u, corrupted);
+}
+
+TEST_F(SspTest, lossy_link_with_give_ups_never_duplicates) {
+    // too few retries for this loss rate, some packets are given up on
+    init(4, 8, 2);
+    ASSERT_TRUE(ssp_Synchronise(&portA));
+    EXPECT_LT(0u, send(0, 1000));
+    EXPECT_EQ(0u, corrupted);
+    ASSERT_LT(500u, received.size());
+    for (size_t i = 1; i < received.size(); i++) {
+        EXPECT_LT(received[i - 1], received[i]);
+    }
+}
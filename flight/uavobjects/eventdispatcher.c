@@ -44,6 +44,8 @@
 #define CALLBACK_PRIORITY    CALLBACK_PRIORITY_CRITICAL
 #define TASK_PRIORITY        CALLBACK_TASK_FLIGHTCONTROL
 #define MAX_UPDATE_PERIOD_MS 1000
+#define HEAP_INITIAL_SIZE    16
+#define HEAP_NONE            0xFFFF
 
 // Private types
 
@@ -65,13 +67,19 @@ struct PeriodicObjectListStruct {
     EventCallbackInfo evInfo; /** Event callback information */
     uint16_t updatePeriodMs; /** Update period in ms or 0 if no periodic updates are needed */
     int32_t  timeToNextUpdateMs; /** Time delay to the next update */
+    uint16_t heapIndex; /** Position in the update heap or HEAP_NONE if no periodic updates are needed */
     struct PeriodicObjectListStruct *next; /** Needed by linked list library (utlist.h) */
 };
 typedef struct PeriodicObjectListStruct PeriodicObjectList;
 
 // Private variables
 static PeriodicObjectList *mObjList;
-static xQueueHandle mQueue;
+// Binary min-heap of the entries with periodic updates, keyed on timeToNextUpdateMs
+static PeriodicObjectList **mHeap;
+static uint16_t mHeapCount;
+static uint16_t mHeapSize;
+// Callbacks to invoke, their events are taken from the shared pool of the object manager
+static UAVObjEventSubscriber mCallbacks;
 static DelayedCallbackInfo *eventSchedulerCallback;
 static xSemaphoreHandle mMutex;
 static EventStats mStats;
@@ -82,6 +90,12 @@ static void eventTask();
 static int32_t eventPeriodicCreate(UAVObjEvent *ev, UAVObjEventCallback cb, xQueueHandle queue, uint16_t periodMs);
 static int32_t eventPeriodicUpdate(UAVObjEvent *ev, UAVObjEventCallback cb, xQueueHandle queue, uint16_t periodMs);
 static uint16_t randomizePeriod(uint16_t periodMs);
+static void heapSet(uint16_t index, PeriodicObjectList *objEntry);
+static void heapSiftUp(uint16_t index);
+static void heapSiftDown(uint16_t index);
+static int32_t heapInsert(PeriodicObjectList *objEntry);
+static void heapRemove(PeriodicObjectList *objEntry);
+static void heapReschedule(PeriodicObjectList *objEntry);
 
 
 /**
@@ -91,7 +105,10 @@ static uint16_t randomizePeriod(uint16_t periodMs);
 int32_t EventDispatcherInitialize()
 {
     // Initialize variables
-    mObjList = NULL;
+    mObjList   = NULL;
+    mHeap      = NULL;
+    mHeapCount = 0;
+    mHeapSize  = 0;
     memset(&mStats, 0, sizeof(EventStats));
 
     // Create mMutex
@@ -100,8 +117,8 @@ int32_t EventDispatcherInitialize()
         return -1;
     }
 
-    // Create event queue
-    mQueue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(EventCallbackInfo));
+    // The event task is run by the callback scheduler, nothing to wait on
+    UAVObjSubscriberInit(&mCallbacks, MAX_QUEUE_SIZE, false);
 
     // Create callback
     eventSchedulerCallback = PIOS_CALLBACKSCHEDULER_Create(&eventTask, CALLBACK_PRIORITY, TASK_PRIORITY, CALLBACKINFO_RUNNING_EVENTDISPATCHER, STACK_SIZE * 4);
@@ -141,14 +158,9 @@ void EventClearStats()
  */
 int32_t EventCallbackDispatch(UAVObjEvent *ev, UAVObjEventCallback cb)
 {
-    EventCallbackInfo evInfo;
-
-    // Initialize event callback information
-    memcpy(&evInfo.ev, ev, sizeof(UAVObjEvent));
-    evInfo.cb    = cb;
-    evInfo.queue = 0;
-    // Push to queue
-    int32_t result = xQueueSend(mQueue, &evInfo, 0); // will not block if queue is full
+    // will not block if the pool is empty or too many callbacks are waiting
+    int32_t result = (UAVObjSubscriberPost(&mCallbacks, ev, cb) == 0) ? pdTRUE : pdFALSE;
+
     PIOS_CALLBACKSCHEDULER_Dispatch(eventSchedulerCallback);
     return result;
 }
@@ -230,6 +242,7 @@ static int32_t eventPeriodicCreate(UAVObjEvent *ev, UAVObjEventCallback cb, xQue
     // Create handle
     objEntry = (PeriodicObjectList *)pios_malloc(sizeof(PeriodicObjectList));
     if (objEntry == NULL) {
+        xSemaphoreGiveRecursive(mMutex);
         return -1;
     }
     objEntry->evInfo.ev.obj      = ev->obj;
@@ -239,6 +252,12 @@ static int32_t eventPeriodicCreate(UAVObjEvent *ev, UAVObjEventCallback cb, xQue
     objEntry->evInfo.queue       = queue;
     objEntry->updatePeriodMs     = periodMs;
     objEntry->timeToNextUpdateMs = randomizePeriod(periodMs); // avoid bunching of updates
+    objEntry->heapIndex = HEAP_NONE;
+    if (periodMs > 0 && heapInsert(objEntry) != 0) {
+        pios_free(objEntry);
+        xSemaphoreGiveRecursive(mMutex);
+        return -1;
+    }
     // Add to list
     LL_APPEND(mObjList, objEntry);
     // Release lock
@@ -270,9 +289,17 @@ static int32_t eventPeriodicUpdate(UAVObjEvent *ev, UAVObjEventCallback cb, xQue
             // Object found, update period
             objEntry->updatePeriodMs     = periodMs;
             objEntry->timeToNextUpdateMs = randomizePeriod(periodMs); // avoid bunching of updates
+            int32_t ret = 0;
+            if (periodMs == 0) {
+                heapRemove(objEntry);
+            } else if (objEntry->heapIndex == HEAP_NONE) {
+                ret = heapInsert(objEntry);
+            } else {
+                heapReschedule(objEntry);
+            }
             // Release lock
             xSemaphoreGiveRecursive(mMutex);
-            return 0;
+            return ret;
         }
     }
     // If this point is reached the object was not found
@@ -286,16 +313,17 @@ static int32_t eventPeriodicUpdate(UAVObjEvent *ev, UAVObjEventCallback cb, xQue
 static void eventTask()
 {
     static uint32_t timeToNextUpdateMs = 0;
-    EventCallbackInfo evInfo;
+    UAVObjEventNode *node;
 
-    // Wait for queue message
+    // Take the posted callbacks
     int limit = MAX_QUEUE_SIZE;
 
-    while (xQueueReceive(mQueue, &evInfo, 0) == pdTRUE) {
+    while ((node = UAVObjSubscriberReceive(&mCallbacks, 0)) != NULL) {
         // Invoke callback, if any
-        if (evInfo.cb != 0) {
-            evInfo.cb(&evInfo.ev); // the function is expected to copy the event information
+        if (node->cb != 0) {
+            node->cb(&node->ev); // the function is expected to copy the event information
         }
+        UAVObjSubscriberRelease(node);
         // limit loop to max queue size to slightly reduce the impact of recursive events
         if (!--limit) {
             break;
@@ -324,37 +352,35 @@ static int32_t processPeriodicUpdates()
     // Get lock
     xSemaphoreTakeRecursive(mMutex, portMAX_DELAY);
 
-    // Iterate through each object and update its timer, if zero then transmit object.
-    // Also calculate smallest delay to next update.
-    timeToNextUpdate = xTaskGetTickCount() * portTICK_RATE_MS + MAX_UPDATE_PERIOD_MS;
-    LL_FOREACH(mObjList, objEntry) {
-        // If object is configured for periodic updates
-        if (objEntry->updatePeriodMs > 0) {
-            // Check if time for the next update
-            timeNow = xTaskGetTickCount() * portTICK_RATE_MS;
-            if (objEntry->timeToNextUpdateMs <= timeNow) {
-                // Reset timer
-                offset = (timeNow - objEntry->timeToNextUpdateMs) % objEntry->updatePeriodMs;
-                objEntry->timeToNextUpdateMs = timeNow + objEntry->updatePeriodMs - offset;
-                // Invoke callback, if one
-                if (objEntry->evInfo.cb != 0) {
-                    objEntry->evInfo.cb(&objEntry->evInfo.ev); // the function is expected to copy the event information
-                }
-                // Push event to queue, if one
-                if (objEntry->evInfo.queue != 0) {
-                    if (xQueueSend(objEntry->evInfo.queue, &objEntry->evInfo.ev, 0) != pdTRUE && !objEntry->evInfo.ev.lowPriority) { // do not block if queue is full
-                        if (objEntry->evInfo.ev.obj != NULL) {
-                            mStats.lastErrorID = UAVObjGetID(objEntry->evInfo.ev.obj);
-                        }
-                        ++mStats.eventErrors;
-                    }
+    // Pop the due objects off the heap, update their timer and transmit them.
+    // Only due entries are visited, the heap top is the smallest delay to the next update.
+    timeNow = xTaskGetTickCount() * portTICK_RATE_MS;
+    while (mHeapCount > 0 && mHeap[0]->timeToNextUpdateMs <= timeNow) {
+        objEntry = mHeap[0];
+        // Reset timer, before the callback which may change the period
+        offset   = (timeNow - objEntry->timeToNextUpdateMs) % objEntry->updatePeriodMs;
+        objEntry->timeToNextUpdateMs = timeNow + objEntry->updatePeriodMs - offset;
+        heapSiftDown(0);
+        // Invoke callback, if one
+        if (objEntry->evInfo.cb != 0) {
+            objEntry->evInfo.cb(&objEntry->evInfo.ev); // the function is expected to copy the event information
+        }
+        // Push event to queue, if one
+        if (objEntry->evInfo.queue != 0) {
+            if (xQueueSend(objEntry->evInfo.queue, &objEntry->evInfo.ev, 0) != pdTRUE && !objEntry->evInfo.ev.lowPriority) { // do not block if queue is full
+                if (objEntry->evInfo.ev.obj != NULL) {
+                    mStats.lastErrorID = UAVObjGetID(objEntry->evInfo.ev.obj);
                 }
-            }
-            // Update minimum delay
-            if (objEntry->timeToNextUpdateMs < timeToNextUpdate) {
-                timeToNextUpdate = objEntry->timeToNextUpdateMs;
+                ++mStats.eventErrors;
             }
         }
+        timeNow = xTaskGetTickCount() * portTICK_RATE_MS;
+    }
+
+    // Calculate smallest delay to next update
+    timeToNextUpdate = timeNow + MAX_UPDATE_PERIOD_MS;
+    if (mHeapCount > 0 && mHeap[0]->timeToNextUpdateMs < timeToNextUpdate) {
+        timeToNextUpdate = mHeap[0]->timeToNextUpdateMs;
     }
 
     // Done
@@ -362,6 +388,123 @@ static int32_t processPeriodicUpdates()
     return timeToNextUpdate;
 }
 
+/**
+ * Store an entry in the update heap.
+ * \param[in] index Heap position
+ * \param[in] objEntry The entry
+ */
+static void heapSet(uint16_t index, PeriodicObjectList *objEntry)
+{
+    mHeap[index] = objEntry;
+    objEntry->heapIndex = index;
+}
+
+/**
+ * Move an entry towards the heap top while it is due before its parent.
+ * \param[in] index Heap position of the entry
+ */
+static void heapSiftUp(uint16_t index)
+{
+    PeriodicObjectList *objEntry = mHeap[index];
+
+    while (index > 0) {
+        uint16_t parent = (index - 1) / 2;
+        if (mHeap[parent]->timeToNextUpdateMs <= objEntry->timeToNextUpdateMs) {
+            break;
+        }
+        heapSet(index, mHeap[parent]);
+        index = parent;
+    }
+    heapSet(index, objEntry);
+}
+
+/**
+ * Move an entry away from the heap top while it is due after one of its children.
+ * \param[in] index Heap position of the entry
+ */
+static void heapSiftDown(uint16_t index)
+{
+    PeriodicObjectList *objEntry = mHeap[index];
+
+    while (1) {
+        uint32_t child = 2 * (uint32_t)index + 1;
+        if (child >= mHeapCount) {
+            break;
+        }
+        if (child + 1 < mHeapCount && mHeap[child + 1]->timeToNextUpdateMs < mHeap[child]->timeToNextUpdateMs) {
+            ++child;
+        }
+        if (objEntry->timeToNextUpdateMs <= mHeap[child]->timeToNextUpdateMs) {
+            break;
+        }
+        heapSet(index, mHeap[child]);
+        index = child;
+    }
+    heapSet(index, objEntry);
+}
+
+/**
+ * Add an entry to the update heap, growing it if needed.
+ * \param[in] objEntry The entry
+ * \return Success (0), failure (-1)
+ */
+static int32_t heapInsert(PeriodicObjectList *objEntry)
+{
+    if (mHeapCount == mHeapSize) {
+        if (mHeapSize >= HEAP_NONE / 2) {
+            return -1;
+        }
+        uint16_t size = mHeapSize ? mHeapSize * 2 : HEAP_INITIAL_SIZE;
+        PeriodicObjectList **heap = (PeriodicObjectList **)pios_malloc(size * sizeof(PeriodicObjectList *));
+        if (heap == NULL) {
+            return -1;
+        }
+        if (mHeap) {
+            memcpy(heap, mHeap, mHeapCount * sizeof(PeriodicObjectList *));
+            pios_free(mHeap);
+        }
+        mHeap     = heap;
+        mHeapSize = size;
+    }
+    heapSet(mHeapCount++, objEntry);
+    heapSiftUp(objEntry->heapIndex);
+    return 0;
+}
+
+/**
+ * Remove an entry from the update heap, if it is in it.
+ * \param[in] objEntry The entry
+ */
+static void heapRemove(PeriodicObjectList *objEntry)
+{
+    uint16_t index = objEntry->heapIndex;
+
+    if (index == HEAP_NONE) {
+        return;
+    }
+    objEntry->heapIndex = HEAP_NONE;
+    if (--mHeapCount == index) {
+        return;
+    }
+    // Move the last entry into the hole and restore the heap order
+    heapSet(index, mHeap[mHeapCount]);
+    heapReschedule(mHeap[index]);
+}
+
+/**
+ * Restore the heap order after the update time of an entry changed.
+ * \param[in] objEntry The entry
+ */
+static void heapReschedule(PeriodicObjectList *objEntry)
+{
+    uint16_t index = objEntry->heapIndex;
+
+    heapSiftUp(index);
+    if (objEntry->heapIndex == index) {
+        heapSiftDown(index);
+    }
+}
+
 /**
  * Return a psedorandom integer from 0 to periodMs
  * Based on the Park-Miller-Carta Pseudo-Random Number Generator
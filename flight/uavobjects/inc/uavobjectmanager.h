@@ -142,9 +142,33 @@ typedef enum {
 #define EV_MASK_ALL         0
 #define EV_MASK_ALL_UPDATES (EV_UNPACKED | EV_UPDATED | EV_UPDATED_MANUAL | EV_UPDATED_PERIODIC | EV_LOGGING_MANUAL | EV_LOGGING_PERIODIC)
 
+/**
+ * Field masks, bit n stands for the n-th 32th of the object data, rounded up,
+ * so a bit is one byte or more. Objects of up to 32 bytes get the exact fields,
+ * in larger ones a field may share a bit with its neighbours, and the listener
+ * gets some of their changes too.
+ */
+#define UAVOBJ_FIELDMASK_ALL      0
+#define UAVOBJ_FIELDMASK_ALL_BITS 0xFFFFFFFFu
+#define UAVOBJ_FIELDMASK_CHUNK(numbytes) (((numbytes) + 31) / 32)
+#define UAVOBJ_FIELDMASK(offset, size, numbytes) \
+    ((uint32_t)((2u << (((offset) + (size) - 1) / UAVOBJ_FIELDMASK_CHUNK(numbytes))) - \
+                (1u << ((offset) / UAVOBJ_FIELDMASK_CHUNK(numbytes)))))
+
 /**
  * Access types
  */
+/**
+ * Object category, from the category attribute of the object definition
+ */
+typedef enum {
+    UAVOBJ_CATEGORY_CONTROL    = 0, /** Flight control, commands and settings of the controllers */
+    UAVOBJ_CATEGORY_NAVIGATION = 1, /** Path planning and following */
+    UAVOBJ_CATEGORY_SENSORS    = 2, /** Raw and calibrated sensor data */
+    UAVOBJ_CATEGORY_STATE      = 3, /** Estimated vehicle state */
+    UAVOBJ_CATEGORY_SYSTEM     = 4 /** Telemetry, alarms and diagnostics */
+} UAVObjCategory;
+
 typedef enum {
     ACCESS_READWRITE = 0,
     ACCESS_READONLY  = 1
@@ -167,6 +191,29 @@ typedef struct {
  */
 typedef void (*UAVObjEventCallback)(UAVObjEvent *ev);
 
+/**
+ * Event taken from the shared event pool, it is linked into the list of its
+ * subscriber until received, then given back with UAVObjSubscriberRelease().
+ */
+typedef struct UAVObjEventNode {
+    struct UAVObjEventNode *next;
+    UAVObjEvent ev;
+    UAVObjEventCallback cb; /** callback to invoke, for the event dispatcher */
+} UAVObjEventNode;
+
+/**
+ * Receiver of events from the shared pool, an alternative to a queue of its
+ * own sized for the worst case: the subscriber only holds the events it was
+ * sent, up to its limit, and no copy is made of them.
+ */
+typedef struct {
+    UAVObjEventNode *head;
+    UAVObjEventNode *tail;
+    uint8_t count;
+    uint8_t limit;
+    xSemaphoreHandle sem; /** given when an event is posted, NULL if the receiver polls */
+} UAVObjEventSubscriber;
+
 /**
  * Callback used to initialize the object fields to their default values.
  */
@@ -180,12 +227,16 @@ typedef struct {
     uint32_t eventCallbackErrors;
     uint32_t lastCallbackErrorID;
     uint32_t lastQueueErrorID;
+    uint32_t eventsCoalesced;
+    uint32_t eventPoolErrors;
+    uint32_t eventsFiltered;
+    uint32_t updatesSuppressed;
 } UAVObjStats;
 
 int32_t UAVObjInitialize();
 void UAVObjGetStats(UAVObjStats *statsOut);
 void UAVObjClearStats();
-UAVObjHandle UAVObjRegister(uint32_t id, bool isSingleInstance, bool isSettings, bool isPriority, uint32_t num_bytes, UAVObjInitializeCallback initCb);
+UAVObjHandle UAVObjRegister(uint32_t id, bool isSingleInstance, bool isSettings, bool isPriority, bool isDoubleBuffered, bool isNotifyOnChange, UAVObjCategory category, uint32_t num_bytes, const UAVObjMetadata *defaultMetadata, UAVObjInitializeCallback initCb);
 UAVObjHandle UAVObjGetByID(uint32_t id);
 uint32_t UAVObjGetID(UAVObjHandle obj);
 uint32_t UAVObjGetNumBytes(UAVObjHandle obj);
@@ -196,9 +247,12 @@ bool UAVObjIsSingleInstance(UAVObjHandle obj);
 bool UAVObjIsMetaobject(UAVObjHandle obj);
 bool UAVObjIsSettings(UAVObjHandle obj);
 bool UAVObjIsPriority(UAVObjHandle obj);
+UAVObjCategory UAVObjGetCategory(UAVObjHandle obj);
 int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId, const uint8_t *dataIn);
 int32_t UAVObjPack(UAVObjHandle obj_handle, uint16_t instId, uint8_t *dataOut);
 uint8_t UAVObjUpdateCRC(UAVObjHandle obj_handle, uint16_t instId, uint8_t crc);
+uint32_t UAVObjUpdateCRC32(UAVObjHandle obj_handle, uint16_t instId, uint32_t crc);
+void UAVObjSettingsUpdated(UAVObjHandle obj_handle, uint16_t instId);
 int32_t UAVObjSave(UAVObjHandle obj_handle, uint16_t instId);
 int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId);
 int32_t UAVObjDelete(UAVObjHandle obj_handle, uint16_t instId);
@@ -235,8 +289,18 @@ UAVObjUpdateMode UAVObjGetLoggingUpdateMode(const UAVObjMetadata *dataOut);
 void UAVObjSetLoggingUpdateMode(UAVObjMetadata *dataOut, UAVObjUpdateMode val);
 int8_t UAVObjReadOnly(UAVObjHandle obj);
 int32_t UAVObjConnectQueue(UAVObjHandle obj_handle, xQueueHandle queue, uint8_t eventMask);
+int32_t UAVObjConnectQueueCoalesced(UAVObjHandle obj_handle, xQueueHandle queue, uint8_t eventMask);
+int32_t UAVObjConnectQueueFields(UAVObjHandle obj_handle, xQueueHandle queue, uint8_t eventMask, uint32_t fieldMask);
 int32_t UAVObjDisconnectQueue(UAVObjHandle obj_handle, xQueueHandle queue);
+void UAVObjEventReceived(xQueueHandle queue, const UAVObjEvent *ev);
 int32_t UAVObjConnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb, uint8_t eventMask);
+int32_t UAVObjConnectCallbackFields(UAVObjHandle obj_handle, UAVObjEventCallback cb, uint8_t eventMask, uint32_t fieldMask);
+int32_t UAVObjConnectSubscriber(UAVObjHandle obj_handle, UAVObjEventSubscriber *subscriber, uint8_t eventMask);
+int32_t UAVObjDisconnectSubscriber(UAVObjHandle obj_handle, UAVObjEventSubscriber *subscriber);
+int32_t UAVObjSubscriberInit(UAVObjEventSubscriber *subscriber, uint8_t limit, bool blocking);
+int32_t UAVObjSubscriberPost(UAVObjEventSubscriber *subscriber, const UAVObjEvent *ev, UAVObjEventCallback cb);
+UAVObjEventNode *UAVObjSubscriberReceive(UAVObjEventSubscriber *subscriber, portTickType timeout);
+void UAVObjSubscriberRelease(UAVObjEventNode *node);
 int32_t UAVObjDisconnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb);
 void UAVObjRequestUpdate(UAVObjHandle obj);
 void UAVObjRequestInstanceUpdate(UAVObjHandle obj_handle, uint16_t instId);
@@ -246,6 +310,9 @@ void UAVObjLogging(UAVObjHandle obj);
 void UAVObjInstanceLogging(UAVObjHandle obj_handle, uint16_t instId);
 void UAVObjIterate(void (*iterator)(UAVObjHandle obj));
 void UAVObjInstanceWriteToLog(UAVObjHandle obj_handle, uint16_t instId);
+void UAVObjWriteSampleToLog(const UAVObjHandle *objs, uint16_t count);
+void UAVObjSetLoggingSampled(bool sampled);
+bool UAVObjIsLoggingSampled(void);
 
 #endif // UAVOBJECTMANAGER_H
 
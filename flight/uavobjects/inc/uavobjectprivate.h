@@ -72,7 +72,14 @@ struct ObjectEventEntry {
     struct ObjectEventEntry *next;
     xQueueHandle queue;
     UAVObjEventCallback     cb;
+    UAVObjEventSubscriber   *subscriber;
     uint8_t eventMask;
+    /* coalesced queues get one event of each type per instance at a time */
+    bool     coalesce;
+    uint8_t  pendingEvents;
+    uint16_t pendingInstId;
+    /* the fields whose changes are sent, 0 for all */
+    uint32_t fieldMask;
 };
 
 /*
@@ -100,13 +107,19 @@ struct UAVOBase {
         bool isSingle      : 1;
         bool isSettings    : 1;
         bool isPriority    : 1;
+        bool isDoubleBuffered : 1;
+        bool isNotifyOnChange : 1;
+        uint8_t category   : 3;
     } flags;
 } __attribute__((packed));
 
-/* Augmented type for Meta UAVO */
+/*
+ * Augmented type for Meta UAVO. The metadata are the generated defaults in
+ * flash until they are changed, they are copied to RAM then, see MetaDataWrite.
+ */
 struct UAVOMeta {
     struct UAVOBase base;
-    UAVObjMetadata  instance0;
+    const UAVObjMetadata *metadata;
 } __attribute__((packed));
 
 /* Shared data structure for all data-carrying UAVObjects (UAVOSingle and UAVOMulti) */
@@ -125,6 +138,12 @@ struct UAVOData {
 struct UAVOSingle {
     struct UAVOData uavo;
 
+    /*
+     * Sequence counter for lock free readers, odd while a
+     * writer is updating instance0.
+     */
+    volatile uint32_t seq;
+
     uint8_t instance0[];
     /*
      * Additional space will be malloc'd here to hold the
@@ -132,7 +151,28 @@ struct UAVOSingle {
      */
 } __attribute__((packed));
 
-/* Part of a linked list of instances chained off of a multi instance UAVO. */
+/*
+ * Latest value copy of a double buffered single instance UAVO, stored after
+ * instance0. Writers fill the buffer readers are not using and then bump
+ * seq, readers copy buffer[seq & 1] and retry if seq moved meanwhile.
+ */
+struct UAVOLatest {
+    volatile uint32_t seq;
+    uint8_t buffer[];
+    /*
+     * Additional space will be malloc'd here to hold two
+     * copies of the instance data.
+     */
+} __attribute__((packed));
+
+#define UAVO_LATEST_OFFSET(num_bytes) (((num_bytes) + 3) & ~3)
+#define ObjLatestPtr(obj) ((struct UAVOLatest *)(((struct UAVOSingle *)(obj))->instance0 + UAVO_LATEST_OFFSET((obj)->instance_size)))
+
+/*
+ * Part of a linked list of instances chained off of a multi instance UAVO.
+ * With PIOS_UAVOBJ_INSTANCE_CHUNK only instance0 is one, the other instances
+ * are stored in blocks of PIOS_UAVOBJ_INSTANCE_CHUNK, found through a table.
+ */
 struct UAVOMultiInst {
     struct UAVOMultiInst *next;
     uint8_t instance[];
@@ -146,6 +186,10 @@ struct UAVOMultiInst {
 struct UAVOMulti {
     struct UAVOData uavo;
     uint16_t num_instances;
+#ifdef PIOS_UAVOBJ_INSTANCE_CHUNK
+    uint16_t num_chunks; /* entries in chunks */
+    uint8_t  **chunks; /* instance n > 0 is in chunks[(n - 1) / PIOS_UAVOBJ_INSTANCE_CHUNK] */
+#endif
     struct UAVOMultiInst instance0 __attribute__((aligned(4)));
     /*
      * Additional space will be malloc'd here to hold the
@@ -157,16 +201,23 @@ struct UAVOMulti {
 #define MetaNumBytes sizeof(UAVObjMetadata)
 #define MetaBaseObjectPtr(obj)           ((struct UAVOData *)((obj) - offsetof(struct UAVOData, metaObj)))
 #define MetaObjectPtr(obj)               ((struct UAVODataMeta *)&((obj)->metaObj))
-#define MetaDataPtr(obj)                 ((UAVObjMetadata *)&((obj)->instance0))
-#define LinkedMetaDataPtr(obj)           ((UAVObjMetadata *)&((obj)->metaObj.instance0))
+#define MetaDataPtr(obj)                 ((obj)->metadata)
+#define LinkedMetaDataPtr(obj)           ((obj)->metaObj.metadata)
 
 /** all information about instances are dependant on object type **/
 #define ObjSingleInstanceDataOffset(obj) ((void *)(&(((struct UAVOSingle *)obj)->instance0)))
 #define InstanceDataOffset(inst)         ((void *)&(((struct UAVOMultiInst *)inst)->instance))
 #define InstanceData(instance)           ((void *)instance)
+#define InstanceStride(obj)              (((obj)->instance_size + 3) & ~3)
 
 // Private functions
 int32_t sendEvent(struct UAVOBase *obj, uint16_t instId, UAVObjEventType event);
+int32_t sendEventFields(struct UAVOBase *obj, uint16_t instId, UAVObjEventType event, uint32_t changed);
 InstanceHandle getInstance(struct UAVOData *obj, uint16_t instId);
+void SingleInstanceWriteBegin(struct UAVOData *obj);
+void SingleInstanceWriteEnd(struct UAVOData *obj);
+bool MetaDataWrite(struct UAVOMeta *obj, const void *dataIn, uint32_t offset, uint32_t size);
+struct UAVOData *getNextSettingsObject(uint32_t *slot);
+int32_t saveSettingsBatch(void);
 
 #endif /* UAVOBJECTPRIVATE_H_ */
@@ -34,12 +34,21 @@
 #include "openpilot.h"
 #include "pios_struct_helper.h"
 #include "inc/uavobjectprivate.h"
+#ifdef PIOS_ENABLE_ITM_TRACE
+#include <pios_itm.h>
+#endif
 
 // Private functions
 static InstanceHandle createInstance(struct UAVOData *obj, uint16_t instId);
-static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventCallback cb, uint8_t eventMask);
-static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventCallback cb);
+static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventSubscriber *subscriber, UAVObjEventCallback cb, uint8_t eventMask, bool coalesce, uint32_t fieldMask);
+static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventSubscriber *subscriber, UAVObjEventCallback cb);
 static void instanceAutoUpdated(UAVObjHandle obj_handle, uint16_t instId);
+static void indexInsert(struct UAVOData *obj);
+static bool indexLookup(uint32_t id, UAVObjHandle *found_obj);
+static uint32_t writeInstance(struct UAVOData *obj, InstanceHandle instEntry, const void *dataIn, uint32_t offset, uint32_t size);
+static uint32_t changedFields(const struct UAVOData *obj, const uint8_t *oldData, const uint8_t *newData, uint32_t offset, uint32_t size);
+static bool readSingleInstance(struct UAVOData *obj, void *dataOut, uint32_t offset, uint32_t size);
+static bool readLatest(struct UAVOData *obj, void *dataOut, uint32_t offset, uint32_t size);
 
 
 int32_t UAVObjPers_stub(__attribute__((unused)) UAVObjHandle obj_handle, __attribute__((unused))  uint16_t instId)
@@ -49,6 +58,14 @@ int32_t UAVObjPers_stub(__attribute__((unused)) UAVObjHandle obj_handle, __attri
 int32_t UAVObjSave(UAVObjHandle obj_handle, uint16_t instId)  __attribute__((weak, alias("UAVObjPers_stub")));;
 int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId) __attribute__((weak, alias("UAVObjPers_stub")));
 int32_t UAVObjDelete(UAVObjHandle obj_handle, uint16_t instId) __attribute__((weak, alias("UAVObjPers_stub")));
+int32_t UAVObjPersSettings_stub(void)
+{
+    return 0;
+}
+int32_t saveSettingsBatch(void) __attribute__((weak, alias("UAVObjPersSettings_stub")));
+void UAVObjSettingsUpdated_stub(__attribute__((unused)) UAVObjHandle obj_handle, __attribute__((unused)) uint16_t instId)
+{}
+void UAVObjSettingsUpdated(UAVObjHandle obj_handle, uint16_t instId) __attribute__((weak, alias("UAVObjSettingsUpdated_stub")));
 
 
 // Private variables
@@ -67,6 +84,47 @@ static const UAVObjMetadata defMetadata = {
 
 static UAVObjStats stats;
 
+/*
+ * RAM copies of the metadata that were changed from their defaults in flash,
+ * only ever added to. Changed under the mutex.
+ */
+struct UAVOMetaCopy {
+    struct UAVOMetaCopy *next;
+    UAVObjMetadata metadata;
+};
+static struct UAVOMetaCopy *metaCopies;
+
+/*
+ * Events of all the subscribers, whatever the object. The nodes are handed
+ * out in order on first use, those given back are reused from the free list.
+ * Both are only changed in critical sections, the event dispatcher posts
+ * without the mutex.
+ */
+#ifndef PIOS_UAVOBJ_EVENT_POOL_SIZE
+#define PIOS_UAVOBJ_EVENT_POOL_SIZE 24
+#endif
+static UAVObjEventNode eventPool[PIOS_UAVOBJ_EVENT_POOL_SIZE];
+static uint16_t eventPoolUsed;
+static UAVObjEventNode *eventPoolFree;
+
+/*
+ * Registered objects sorted by object id. UAVObjGetByID() runs a binary
+ * search over this table without taking the mutex. Writers (registration
+ * only) hold the mutex and make indexSeq odd while the table is modified,
+ * readers retry under the mutex if they raced with a writer. Entries are
+ * word stores, so a racing reader sees stale but valid handles.
+ */
+#ifndef UAVOBJ_INDEX_SIZE
+#define UAVOBJ_INDEX_SIZE 0
+#endif
+static struct UAVOData *volatile indexTable[UAVOBJ_INDEX_SIZE];
+static volatile uint16_t indexCount;
+static volatile uint32_t indexSeq;
+static bool indexOverflow;
+
+// the objects with periodic logging are written by the logging sampler
+static volatile bool loggingSampled;
+
 /**
  * Initialize the object manager
  * \return 0 Success
@@ -88,6 +146,12 @@ int32_t UAVObjInitialize()
     memset(__start__uavo_handles, 0,
            (uintptr_t)__stop__uavo_handles - (uintptr_t)__start__uavo_handles);
 
+    // Initialize the sorted id index
+    memset((void *)indexTable, 0, sizeof(indexTable));
+    indexCount    = 0;
+    indexSeq      = 0;
+    indexOverflow = false;
+
     // Create mutex
     mutex = xSemaphoreCreateRecursiveMutex();
     if (mutex == NULL) {
@@ -127,7 +191,7 @@ void UAVObjClearStats()
  * Object Initialization
  ***********************/
 
-static void UAVObjInitMetaData(struct UAVOMeta *obj_meta)
+static void UAVObjInitMetaData(struct UAVOMeta *obj_meta, const UAVObjMetadata *defaultMetadata)
 {
     /* Fill in the common part of the UAVO */
     struct UAVOBase *uavo_base = &(obj_meta->base);
@@ -137,15 +201,63 @@ static void UAVObjInitMetaData(struct UAVOMeta *obj_meta)
     uavo_base->flags.isSingle = true;
     uavo_base->next_event     = NULL;
 
-    /* Clear the instance data carried in the UAVO */
-    memset(&(obj_meta->instance0), 0, sizeof(obj_meta->instance0));
+    /* The defaults stay in flash until they are changed */
+    obj_meta->metadata = defaultMetadata ? defaultMetadata : &defMetadata;
+}
+
+/**
+ * Change the metadata of an object, moving them to RAM on the first change
+ * \param[in] obj The meta object
+ * \param[in] dataIn The new data
+ * \param[in] offset Offset into the metadata
+ * \param[in] size The size of the new data
+ * \return false if there was no memory for the copy
+ */
+bool MetaDataWrite(struct UAVOMeta *obj, const void *dataIn, uint32_t offset, uint32_t size)
+{
+    bool ok = true;
+
+    PIOS_Assert(offset + size <= MetaNumBytes);
+
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    // Most writes restore the defaults, those don't need a copy
+    if (memcmp((const uint8_t *)obj->metadata + offset, dataIn, size) != 0) {
+        struct UAVOMetaCopy *copy;
+        LL_FOREACH(metaCopies, copy) {
+            if (obj->metadata == &copy->metadata) {
+                break;
+            }
+        }
+        if (!copy) {
+            copy = (struct UAVOMetaCopy *)pios_malloc(sizeof(struct UAVOMetaCopy));
+            if (!copy) {
+                ok = false;
+                goto unlock_exit;
+            }
+            copy->metadata = *obj->metadata;
+            LL_PREPEND(metaCopies, copy);
+            obj->metadata  = &copy->metadata;
+        }
+        memcpy((uint8_t *)&copy->metadata + offset, dataIn, size);
+    }
+
+unlock_exit:
+    xSemaphoreGiveRecursive(mutex);
+    return ok;
 }
 
-static struct UAVOData *UAVObjAllocSingle(uint32_t num_bytes)
+static struct UAVOData *UAVObjAllocSingle(uint32_t num_bytes, bool isDoubleBuffered)
 {
     /* Compute the complete size of the object, including the data for a single embedded instance */
     uint32_t object_size = sizeof(struct UAVOSingle) + num_bytes;
 
+    /* Double buffered objects carry two more copies of the instance data */
+    if (isDoubleBuffered) {
+        object_size = sizeof(struct UAVOSingle) + UAVO_LATEST_OFFSET(num_bytes) +
+                      sizeof(struct UAVOLatest) + 2 * num_bytes;
+    }
+
     /* Allocate the object from the heap */
     struct UAVOSingle *uavo_single = (struct UAVOSingle *)pios_malloc(object_size);
 
@@ -160,7 +272,8 @@ static struct UAVOData *UAVObjAllocSingle(uint32_t num_bytes)
     uavo_base->next_event     = NULL;
 
     /* Clear the instance data carried in the UAVO */
-    memset(&(uavo_single->instance0), 0, num_bytes);
+    uavo_single->seq = 0;
+    memset(&(uavo_single->instance0), 0, object_size - sizeof(struct UAVOSingle));
 
     /* Give back the generic UAVO part */
     return &(uavo_single->uavo);
@@ -186,6 +299,10 @@ static struct UAVOData *UAVObjAllocMulti(uint32_t num_bytes)
 
     /* Set up the type-specific part of the UAVO */
     uavo_multi->num_instances = 1;
+#ifdef PIOS_UAVOBJ_INSTANCE_CHUNK
+    uavo_multi->num_chunks    = 0;
+    uavo_multi->chunks        = NULL;
+#endif
 
     /* Clear the multi instance data carried in the UAVO */
     memset(&(uavo_multi->instance0), 0, sizeof(struct UAVOMultiInst) + num_bytes);
@@ -203,28 +320,43 @@ static struct UAVOData *UAVObjAllocMulti(uint32_t num_bytes)
  * \param[in] id Unique object ID
  * \param[in] isSingleInstance Is this a single instance or multi-instance object
  * \param[in] isSettings Is this a settings object
+ * \param[in] isPriority Is this a prioritized object
+ * \param[in] isDoubleBuffered Keep a double buffered copy for lock free reads
+ * \param[in] isNotifyOnChange Only send the events of the sets that change the data
+ * \param[in] category Category of the object, the telemetry rates depend on it
  * \param[in] numBytes Number of bytes of object data (for one instance)
+ * \param[in] defaultMetadata Default metadata, const so they stay in flash until changed
  * \param[in] initCb Default field and metadata initialization function
- * \return Object handle, or NULL if failure.
- * \return
+ * \return Object handle, the one registered before for a duplicate id, or NULL if failure
+ * or if the duplicate id was registered with another size or type.
  */
 UAVObjHandle UAVObjRegister(uint32_t id,
                             bool isSingleInstance, bool isSettings, bool isPriority,
-                            uint32_t num_bytes,
-                            UAVObjInitializeCallback initCb)
+                            bool isDoubleBuffered, bool isNotifyOnChange, UAVObjCategory category, uint32_t num_bytes,
+                            const UAVObjMetadata *defaultMetadata, UAVObjInitializeCallback initCb)
 {
     struct UAVOData *uavo_data = NULL;
 
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
-    /* Don't allow duplicate registrations */
-    if (UAVObjGetByID(id)) {
+    /* Don't allow duplicate registrations, two modules initialised in parallel
+     * may both register the object after checking it was not */
+    uavo_data = (struct UAVOData *)UAVObjGetByID(id);
+    if (uavo_data) {
+        /* The same id with another definition is a build error, not a shared object */
+        if (UAVObjIsMetaobject((UAVObjHandle)uavo_data) ||
+            UAVObjIsSingleInstance((UAVObjHandle)uavo_data) != isSingleInstance ||
+            uavo_data->base.flags.isSettings != isSettings ||
+            uavo_data->instance_size != num_bytes) {
+            PIOS_DEBUG_Assert(0);
+            uavo_data = NULL;
+        }
         goto unlock_exit;
     }
 
     /* Map the various flags to one of the UAVO types we understand */
     if (isSingleInstance) {
-        uavo_data = UAVObjAllocSingle(num_bytes);
+        uavo_data = UAVObjAllocSingle(num_bytes, isDoubleBuffered);
     } else {
         uavo_data = UAVObjAllocMulti(num_bytes);
     }
@@ -236,6 +368,9 @@ UAVObjHandle UAVObjRegister(uint32_t id,
     /* Fill in the details about this UAVO */
     uavo_data->id = id;
     uavo_data->instance_size = num_bytes;
+    uavo_data->base.flags.isDoubleBuffered = isSingleInstance && isDoubleBuffered;
+    uavo_data->base.flags.isNotifyOnChange = isNotifyOnChange;
+    uavo_data->base.flags.category = category;
     if (isSettings) {
         uavo_data->base.flags.isSettings = true;
         // settings defaults to being sent with priority
@@ -244,13 +379,16 @@ UAVObjHandle UAVObjRegister(uint32_t id,
         uavo_data->base.flags.isPriority = isPriority;
     }
     /* Initialize the embedded meta UAVO */
-    UAVObjInitMetaData(&uavo_data->metaObj);
+    UAVObjInitMetaData(&uavo_data->metaObj, defaultMetadata);
 
     /* Initialize object fields and metadata to default values */
     if (initCb) {
         initCb((UAVObjHandle)uavo_data, 0);
     }
 
+    /* Make the object visible to UAVObjGetByID() */
+    indexInsert(uavo_data);
+
     /* Always try to load the meta object from flash */
     UAVObjLoad((UAVObjHandle) & (uavo_data->metaObj), 0);
 
@@ -268,6 +406,108 @@ unlock_exit:
     return (UAVObjHandle)uavo_data;
 }
 
+/**
+ * Find the position of an id in the sorted index.
+ * Must be called with a consistent view of the index.
+ * \param[in] id The object ID
+ * \param[out] pos Position of the entry, or the insertion point if not found
+ * \return true if the id is in the index
+ */
+static bool indexFind(uint32_t id, uint16_t *pos)
+{
+    uint16_t low  = 0;
+    uint16_t high = indexCount;
+
+    while (low < high) {
+        uint16_t mid = low + ((high - low) >> 1);
+        uint32_t mid_id = indexTable[mid]->id;
+
+        if (mid_id == id) {
+            *pos = mid;
+            return true;
+        } else if (mid_id < id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    *pos = low;
+    return false;
+}
+
+/**
+ * Search the index for an object or its metaobject.
+ * Must be called with a consistent view of the index.
+ * \param[in] id The object ID
+ * \return The object handle or NULL if not found
+ */
+static UAVObjHandle indexSearch(uint32_t id)
+{
+    uint16_t pos;
+
+    if (indexFind(id, &pos)) {
+        return (UAVObjHandle)indexTable[pos];
+    }
+    if (indexFind(id - 1, &pos)) {
+        return (UAVObjHandle) & (indexTable[pos]->metaObj);
+    }
+    return NULL;
+}
+
+/**
+ * Add a newly registered object to the sorted index.
+ * Must be called with the mutex held.
+ * \param[in] obj The object
+ */
+static void indexInsert(struct UAVOData *obj)
+{
+    uint16_t pos;
+
+    if (indexCount >= UAVOBJ_INDEX_SIZE) {
+        // Objects that do not fit are found by walking the object list
+        indexOverflow = true;
+        return;
+    }
+    if (indexFind(obj->id, &pos)) {
+        return;
+    }
+
+    indexSeq++;
+    __sync_synchronize();
+    // Shift one pointer at a time from the top, each slot always holds a valid
+    // handle and a racing reader never dereferences a half copied entry
+    for (uint16_t i = indexCount; i > pos; i--) {
+        indexTable[i] = indexTable[i - 1];
+    }
+    // publish the new entry only once the move is done
+    __sync_synchronize();
+    indexTable[pos] = obj;
+    indexCount++;
+    __sync_synchronize();
+    indexSeq++;
+}
+
+/**
+ * Lock free lookup of an object in the sorted index.
+ * \param[in] id The object ID
+ * \param[out] found_obj The object handle or NULL if not found
+ * \return true if the lookup completed without racing a writer
+ */
+static bool indexLookup(uint32_t id, UAVObjHandle *found_obj)
+{
+    uint32_t seq = indexSeq;
+
+    // A writer is modifying the index, don't spin on it
+    if (seq & 1) {
+        return false;
+    }
+    __sync_synchronize();
+    *found_obj = indexSearch(id);
+    __sync_synchronize();
+
+    return seq == indexSeq;
+}
+
 /**
  * Retrieve an object from the list given its id
  * \param[in] The object ID
@@ -277,9 +517,19 @@ UAVObjHandle UAVObjGetByID(uint32_t id)
 {
     UAVObjHandle *found_obj = (UAVObjHandle *)NULL;
 
+    // Fast path, the index is authoritative unless it ran out of space
+    if (indexLookup(id, (UAVObjHandle *)&found_obj) && (found_obj || !indexOverflow)) {
+        return found_obj;
+    }
+
     // Get lock
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
+    found_obj = (UAVObjHandle *)indexSearch(id);
+    if (found_obj || !indexOverflow) {
+        goto unlock_exit;
+    }
+
     // Look for object
     UAVO_LIST_ITERATE(tmp_obj)
     if (tmp_obj->id == id) {
@@ -493,6 +743,25 @@ bool UAVObjIsPriority(UAVObjHandle obj_handle)
     return uavo_base->flags.isPriority;
 }
 
+/**
+ * Get the category of an object, a metaobject has the one of its object
+ * \param[in] obj The object handle
+ * \return The category
+ */
+UAVObjCategory UAVObjGetCategory(UAVObjHandle obj_handle)
+{
+    PIOS_Assert(obj_handle);
+
+    /* Recover the common object header */
+    struct UAVOBase *uavo_base = (struct UAVOBase *)obj_handle;
+
+    if (UAVObjIsMetaobject(obj_handle)) {
+        uavo_base = (struct UAVOBase *)UAVObjGetLinkedObj(obj_handle);
+    }
+
+    return (UAVObjCategory)uavo_base->flags.category;
+}
+
 
 /**
  * Unpack an object from a byte array
@@ -509,12 +778,15 @@ int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId, const uint8_t *da
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
     int32_t rc = -1;
+    uint32_t changed = UAVOBJ_FIELDMASK_ALL_BITS;
 
     if (UAVObjIsMetaobject(obj_handle)) {
         if (instId != 0) {
             goto unlock_exit;
         }
-        memcpy(MetaDataPtr((struct UAVOMeta *)obj_handle), dataIn, MetaNumBytes);
+        if (!MetaDataWrite((struct UAVOMeta *)obj_handle, dataIn, 0, MetaNumBytes)) {
+            goto unlock_exit;
+        }
     } else {
         struct UAVOData *obj;
         InstanceHandle instEntry;
@@ -533,11 +805,14 @@ int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId, const uint8_t *da
             }
         }
         // Set the data
-        memcpy(InstanceData(instEntry), dataIn, obj->instance_size);
+        changed = writeInstance(obj, instEntry, dataIn, 0, obj->instance_size);
+        if (obj->base.flags.isSettings) {
+            UAVObjSettingsUpdated(obj_handle, instId);
+        }
     }
 
     // Fire event
-    sendEvent((struct UAVOBase *)obj_handle, instId, EV_UNPACKED);
+    sendEventFields((struct UAVOBase *)obj_handle, instId, EV_UNPACKED, changed);
     rc = 0;
 
 unlock_exit:
@@ -629,6 +904,36 @@ unlock_exit:
     return crc;
 }
 
+/**
+ * Update a CRC32 with an object data, same as UAVObjUpdateCRC but less prone to collisions
+ * \param[in] obj The object handle
+ * \param[in] instId The instance ID
+ * \param[in] crc The crc to update
+ * \return the updated crc
+ */
+uint32_t UAVObjUpdateCRC32(UAVObjHandle obj_handle, uint16_t instId, uint32_t crc)
+{
+    PIOS_Assert(obj_handle);
+
+    // Lock
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    if (UAVObjIsMetaobject(obj_handle)) {
+        if (instId == 0) {
+            crc = PIOS_CRC32_updateCRC(crc, (uint8_t *)MetaDataPtr((struct UAVOMeta *)obj_handle), MetaNumBytes);
+        }
+    } else {
+        struct UAVOData *obj = (struct UAVOData *)obj_handle;
+        InstanceHandle instEntry = getInstance(obj, instId);
+        if (instEntry != NULL) {
+            crc = PIOS_CRC32_updateCRC(crc, (uint8_t *)InstanceData(instEntry), (int32_t)obj->instance_size);
+        }
+    }
+
+    xSemaphoreGiveRecursive(mutex);
+    return crc;
+}
+
 /**
  * Actually write the object's data to the logfile
  * \param[in] obj The object handle
@@ -667,33 +972,66 @@ unlock_exit:
 }
 
 /**
- * Save all settings objects to the SD card.
- * @return 0 if success or -1 if failure
+ * Write all instances of several objects to the log as one sample. No object
+ * can change while the sample is taken, and all records get the same time.
+ * \param[in] objs The object handles
+ * \param[in] count The number of objects
  */
-int32_t UAVObjSaveSettings()
+void UAVObjWriteSampleToLog(const UAVObjHandle *objs, uint16_t count)
 {
-    // Get lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    uint32_t size = 0;
+    uint16_t records = 0;
 
-    int32_t rc = -1;
+    PIOS_Assert(objs);
 
-    // Save all settings objects
-    UAVO_LIST_ITERATE(obj)
-    // Check if this is a settings object
-    if (UAVObjIsSettings(obj)) {
-        // Save object
-        if (UAVObjSave((UAVObjHandle)obj, 0) ==
-            -1) {
-            goto unlock_exit;
+    // Lock, the setters wait until the whole sample is written
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    for (uint16_t i = 0; i < count; i++) {
+        uint16_t instances = UAVObjGetNumInstances(objs[i]);
+        size    += instances * UAVObjGetNumBytes(objs[i]);
+        records += instances;
+    }
+    PIOS_DEBUGLOG_BeginSample(size, records);
+    for (uint16_t i = 0; i < count; i++) {
+        uint16_t instances = UAVObjGetNumInstances(objs[i]);
+        for (uint16_t instId = 0; instId < instances; instId++) {
+            UAVObjInstanceWriteToLog(objs[i], instId);
         }
     }
+    PIOS_DEBUGLOG_EndSample();
+
+    xSemaphoreGiveRecursive(mutex);
 }
 
-rc = 0;
+/**
+ * Tell whether the objects with a periodic logging update mode are logged by
+ * a sampler, rather than on their own periodic events.
+ */
+void UAVObjSetLoggingSampled(bool sampled)
+{
+    loggingSampled = sampled;
+}
 
-unlock_exit:
-xSemaphoreGiveRecursive(mutex);
-return rc;
+bool UAVObjIsLoggingSampled(void)
+{
+    return loggingSampled;
+}
+
+/**
+ * Save all settings objects to the SD card.
+ * @return 0 if success or -1 if failure
+ */
+int32_t UAVObjSaveSettings()
+{
+    // Get lock
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    // Save all settings objects in one go, leaving unchanged ones alone
+    int32_t rc = saveSettingsBatch();
+
+    xSemaphoreGiveRecursive(mutex);
+    return rc;
 }
 
 /**
@@ -897,12 +1235,15 @@ int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
     int32_t rc = -1;
+    uint32_t changed = UAVOBJ_FIELDMASK_ALL_BITS;
 
     if (UAVObjIsMetaobject(obj_handle)) {
         if (instId != 0) {
             goto unlock_exit;
         }
-        memcpy(MetaDataPtr((struct UAVOMeta *)obj_handle), dataIn, MetaNumBytes);
+        if (!MetaDataWrite((struct UAVOMeta *)obj_handle, dataIn, 0, MetaNumBytes)) {
+            goto unlock_exit;
+        }
     } else {
         struct UAVOData *obj;
         InstanceHandle instEntry;
@@ -920,11 +1261,20 @@ int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
             goto unlock_exit;
         }
         // Set data
-        memcpy(InstanceData(instEntry), dataIn, obj->instance_size);
+        changed = writeInstance(obj, instEntry, dataIn, 0, obj->instance_size);
+        if (changed == 0 && obj->base.flags.isNotifyOnChange) {
+            // the same data again, nobody is told
+            ++stats.updatesSuppressed;
+            rc = 0;
+            goto unlock_exit;
+        }
+        if (obj->base.flags.isSettings) {
+            UAVObjSettingsUpdated(obj_handle, instId);
+        }
     }
 
     // Fire event
-    sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATED);
+    sendEventFields((struct UAVOBase *)obj_handle, instId, EV_UPDATED, changed);
     rc = 0;
 
 unlock_exit:
@@ -947,6 +1297,7 @@ int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, con
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
     int32_t rc = -1;
+    uint32_t changed = UAVOBJ_FIELDMASK_ALL_BITS;
 
     if (UAVObjIsMetaobject(obj_handle)) {
         // Get instance information
@@ -960,7 +1311,9 @@ int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, con
         }
 
         // Set data
-        memcpy(MetaDataPtr((struct UAVOMeta *)obj_handle) + offset, dataIn, size);
+        if (!MetaDataWrite((struct UAVOMeta *)obj_handle, dataIn, offset, size)) {
+            goto unlock_exit;
+        }
     } else {
         struct UAVOData *obj;
         InstanceHandle instEntry;
@@ -985,12 +1338,21 @@ int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, con
         }
 
         // Set data
-        memcpy(InstanceData(instEntry) + offset, dataIn, size);
+        changed = writeInstance(obj, instEntry, dataIn, offset, size);
+        if (changed == 0 && obj->base.flags.isNotifyOnChange) {
+            // the same data again, nobody is told
+            ++stats.updatesSuppressed;
+            rc = 0;
+            goto unlock_exit;
+        }
+        if (obj->base.flags.isSettings) {
+            UAVObjSettingsUpdated(obj_handle, instId);
+        }
     }
 
 
     // Fire event
-    sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATED);
+    sendEventFields((struct UAVOBase *)obj_handle, instId, EV_UPDATED, changed);
     rc = 0;
 
 unlock_exit:
@@ -1010,6 +1372,22 @@ int32_t UAVObjGetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
 {
     PIOS_Assert(obj_handle);
 
+    // Single instance data objects can be read without taking the lock
+    if (!UAVObjIsMetaobject(obj_handle) && UAVObjIsSingleInstance(obj_handle)) {
+        struct UAVOData *obj = (struct UAVOData *)obj_handle;
+
+        if (instId != 0) {
+            return -1;
+        }
+        if (obj->base.flags.isDoubleBuffered) {
+            if (readLatest(obj, dataOut, 0, obj->instance_size)) {
+                return 0;
+            }
+        } else if (readSingleInstance(obj, dataOut, 0, obj->instance_size)) {
+            return 0;
+        }
+    }
+
     // Lock
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
@@ -1056,6 +1434,22 @@ int32_t UAVObjGetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, voi
 {
     PIOS_Assert(obj_handle);
 
+    // Single instance data objects can be read without taking the lock
+    if (!UAVObjIsMetaobject(obj_handle) && UAVObjIsSingleInstance(obj_handle)) {
+        struct UAVOData *obj = (struct UAVOData *)obj_handle;
+
+        if (instId != 0 || (size + offset) > obj->instance_size) {
+            return -1;
+        }
+        if (obj->base.flags.isDoubleBuffered) {
+            if (readLatest(obj, dataOut, offset, size)) {
+                return 0;
+            }
+        } else if (readSingleInstance(obj, dataOut, offset, size)) {
+            return 0;
+        }
+    }
+
     // Lock
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
@@ -1073,7 +1467,7 @@ int32_t UAVObjGetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, voi
         }
 
         // Set data
-        memcpy(dataOut, MetaDataPtr((struct UAVOMeta *)obj_handle) + offset, size);
+        memcpy(dataOut, (const uint8_t *)MetaDataPtr((struct UAVOMeta *)obj_handle) + offset, size);
     } else {
         struct UAVOData *obj;
         InstanceHandle instEntry;
@@ -1343,11 +1737,82 @@ int32_t UAVObjConnectQueue(UAVObjHandle obj_handle, xQueueHandle queue,
     PIOS_Assert(queue);
     int32_t res;
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-    res = connectObj(obj_handle, queue, 0, eventMask);
+    res = connectObj(obj_handle, queue, NULL, 0, eventMask, false, UAVOBJ_FIELDMASK_ALL);
     xSemaphoreGiveRecursive(mutex);
     return res;
 }
 
+/**
+ * Connect an event queue to the object like UAVObjConnectQueue(), but do not
+ * queue an event while the same one, for the same instance, is still waiting
+ * in the queue. The events only tell that the object changed, the receiver
+ * reads its latest data, so there is no point in having it several times in
+ * the queue: the queue is never filled by the updates of one fast object.
+ * The receiver must call UAVObjEventReceived() for each event it takes out.
+ * Only one instance of a multi instance object is coalesced at a time.
+ * \param[in] obj The object handle
+ * \param[in] queue The event queue
+ * \param[in] eventMask The event mask, if EV_MASK_ALL then all events are enabled (e.g. EV_UPDATED | EV_UPDATED_MANUAL)
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjConnectQueueCoalesced(UAVObjHandle obj_handle, xQueueHandle queue,
+                                    uint8_t eventMask)
+{
+    PIOS_Assert(obj_handle);
+    PIOS_Assert(queue);
+    int32_t res;
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    res = connectObj(obj_handle, queue, NULL, 0, eventMask, true, UAVOBJ_FIELDMASK_ALL);
+    xSemaphoreGiveRecursive(mutex);
+    return res;
+}
+
+/**
+ * Connect an event queue to the object like UAVObjConnectQueue(), but only
+ * queue the EV_UPDATED and EV_UNPACKED events that changed one of the fields
+ * in the field mask. The other events are not filtered.
+ * \param[in] obj The object handle
+ * \param[in] queue The event queue
+ * \param[in] eventMask The event mask, if EV_MASK_ALL then all events are enabled (e.g. EV_UPDATED | EV_UPDATED_MANUAL)
+ * \param[in] fieldMask The fields, from the <Object>FieldMask() macros, UAVOBJ_FIELDMASK_ALL for all
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjConnectQueueFields(UAVObjHandle obj_handle, xQueueHandle queue,
+                                 uint8_t eventMask, uint32_t fieldMask)
+{
+    PIOS_Assert(obj_handle);
+    PIOS_Assert(queue);
+    int32_t res;
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    res = connectObj(obj_handle, queue, NULL, 0, eventMask, false, fieldMask);
+    xSemaphoreGiveRecursive(mutex);
+    return res;
+}
+
+/**
+ * Tell that an event was taken out of a coalesced queue, the next change of
+ * the object is queued again. Must be called before the object data are read.
+ * \param[in] queue The event queue the event was received from
+ * \param[in] ev The event
+ */
+void UAVObjEventReceived(xQueueHandle queue, const UAVObjEvent *ev)
+{
+    struct ObjectEventEntry *event;
+
+    if (ev->obj == NULL) {
+        return;
+    }
+
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    LL_FOREACH(((struct UAVOBase *)ev->obj)->next_event, event) {
+        if (event->queue == queue && event->coalesce && event->pendingInstId == ev->instId) {
+            event->pendingEvents &= ~ev->event;
+            break;
+        }
+    }
+    xSemaphoreGiveRecursive(mutex);
+}
+
 /**
  * Disconnect an event queue from the object.
  * \param[in] obj The object handle
@@ -1360,7 +1825,7 @@ int32_t UAVObjDisconnectQueue(UAVObjHandle obj_handle, xQueueHandle queue)
     PIOS_Assert(queue);
     int32_t res;
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-    res = disconnectObj(obj_handle, queue, 0);
+    res = disconnectObj(obj_handle, queue, NULL, 0);
     xSemaphoreGiveRecursive(mutex);
     return res;
 }
@@ -1379,7 +1844,29 @@ int32_t UAVObjConnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb,
     PIOS_Assert(obj_handle);
     int32_t res;
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-    res = connectObj(obj_handle, 0, cb, eventMask);
+    res = connectObj(obj_handle, 0, NULL, cb, eventMask, false, UAVOBJ_FIELDMASK_ALL);
+    xSemaphoreGiveRecursive(mutex);
+    return res;
+}
+
+/**
+ * Connect an event callback to the object like UAVObjConnectCallback(), but
+ * only invoke it on the EV_UPDATED and EV_UNPACKED events that changed one of
+ * the fields in the field mask. A set that leaves those fields as they were
+ * does not reach the callback. The other events are not filtered.
+ * \param[in] obj The object handle
+ * \param[in] cb The event callback
+ * \param[in] eventMask The event mask, if EV_MASK_ALL then all events are enabled (e.g. EV_UPDATED | EV_UPDATED_MANUAL)
+ * \param[in] fieldMask The fields, from the <Object>FieldMask() macros, UAVOBJ_FIELDMASK_ALL for all
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjConnectCallbackFields(UAVObjHandle obj_handle, UAVObjEventCallback cb,
+                                    uint8_t eventMask, uint32_t fieldMask)
+{
+    PIOS_Assert(obj_handle);
+    int32_t res;
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    res = connectObj(obj_handle, 0, NULL, cb, eventMask, false, fieldMask);
     xSemaphoreGiveRecursive(mutex);
     return res;
 }
@@ -1395,11 +1882,152 @@ int32_t UAVObjDisconnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb
     PIOS_Assert(obj_handle);
     int32_t res;
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-    res = disconnectObj(obj_handle, 0, cb);
+    res = disconnectObj(obj_handle, 0, NULL, cb);
     xSemaphoreGiveRecursive(mutex);
     return res;
 }
 
+/**
+ * Connect an event subscriber to the object, if it is already connected then the event mask is only updated.
+ * \param[in] obj The object handle
+ * \param[in] subscriber The subscriber, set up by UAVObjSubscriberInit()
+ * \param[in] eventMask The event mask, if EV_MASK_ALL then all events are enabled (e.g. EV_UPDATED | EV_UPDATED_MANUAL)
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjConnectSubscriber(UAVObjHandle obj_handle, UAVObjEventSubscriber *subscriber,
+                                uint8_t eventMask)
+{
+    PIOS_Assert(obj_handle);
+    PIOS_Assert(subscriber);
+    int32_t res;
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    res = connectObj(obj_handle, 0, subscriber, 0, eventMask, false, UAVOBJ_FIELDMASK_ALL);
+    xSemaphoreGiveRecursive(mutex);
+    return res;
+}
+
+/**
+ * Disconnect an event subscriber from the object, the events already posted stay with the subscriber.
+ * \param[in] obj The object handle
+ * \param[in] subscriber The subscriber
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjDisconnectSubscriber(UAVObjHandle obj_handle, UAVObjEventSubscriber *subscriber)
+{
+    PIOS_Assert(obj_handle);
+    PIOS_Assert(subscriber);
+    int32_t res;
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    res = disconnectObj(obj_handle, 0, subscriber, 0);
+    xSemaphoreGiveRecursive(mutex);
+    return res;
+}
+
+/**
+ * Set up an event subscriber, usually a static variable of a module.
+ * \param[in] subscriber The subscriber
+ * \param[in] limit The most events it may hold from the shared pool
+ * \param[in] blocking Whether UAVObjSubscriberReceive() may wait for events, which costs a semaphore
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjSubscriberInit(UAVObjEventSubscriber *subscriber, uint8_t limit, bool blocking)
+{
+    PIOS_Assert(subscriber);
+    memset(subscriber, 0, sizeof(UAVObjEventSubscriber));
+    subscriber->limit = limit;
+    if (blocking) {
+        subscriber->sem = xSemaphoreCreateBinary();
+        if (subscriber->sem == NULL) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Post an event to a subscriber, it is queued behind the ones it holds already.
+ * Will not block, the event is dropped if the pool is empty or the subscriber full.
+ * \param[in] subscriber The subscriber
+ * \param[in] ev The event, copied into a node of the pool
+ * \param[in] cb The callback stored along, or zero if none
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjSubscriberPost(UAVObjEventSubscriber *subscriber, const UAVObjEvent *ev, UAVObjEventCallback cb)
+{
+    UAVObjEventNode *node = NULL;
+
+    portENTER_CRITICAL();
+    if (subscriber->count < subscriber->limit) {
+        if (eventPoolFree) {
+            node = eventPoolFree;
+            eventPoolFree = node->next;
+        } else if (eventPoolUsed < PIOS_UAVOBJ_EVENT_POOL_SIZE) {
+            node = &eventPool[eventPoolUsed++];
+        }
+    }
+    if (node) {
+        node->ev   = *ev;
+        node->cb   = cb;
+        node->next = NULL;
+        if (subscriber->tail) {
+            subscriber->tail->next = node;
+        } else {
+            subscriber->head = node;
+        }
+        subscriber->tail = node;
+        subscriber->count++;
+    }
+    portEXIT_CRITICAL();
+
+    if (!node) {
+        ++stats.eventPoolErrors;
+        return -1;
+    }
+    if (subscriber->sem) {
+        xSemaphoreGive(subscriber->sem);
+    }
+    return 0;
+}
+
+/**
+ * Take the oldest event of a subscriber, to be given back with UAVObjSubscriberRelease() once processed.
+ * \param[in] subscriber The subscriber
+ * \param[in] timeout How long to wait for an event, only for a blocking subscriber
+ * \return The event node, or NULL if there was none
+ */
+UAVObjEventNode *UAVObjSubscriberReceive(UAVObjEventSubscriber *subscriber, portTickType timeout)
+{
+    UAVObjEventNode *node;
+
+    do {
+        portENTER_CRITICAL();
+        node = subscriber->head;
+        if (node) {
+            subscriber->head = node->next;
+            if (subscriber->head == NULL) {
+                subscriber->tail = NULL;
+            }
+            subscriber->count--;
+        }
+        portEXIT_CRITICAL();
+        // the semaphore may be left given by the events taken since, then the list is checked again
+    } while (!node && subscriber->sem && timeout && xSemaphoreTake(subscriber->sem, timeout) == pdTRUE);
+
+    return node;
+}
+
+/**
+ * Give an event node back to the pool
+ * \param[in] node The node, from UAVObjSubscriberReceive()
+ */
+void UAVObjSubscriberRelease(UAVObjEventNode *node)
+{
+    portENTER_CRITICAL();
+    node->next    = eventPoolFree;
+    eventPoolFree = node;
+    portEXIT_CRITICAL();
+}
+
 /**
  * Request an update of the object's data from the GCS. The call will not wait for the response, a EV_UPDATED event
  * will be generated as soon as the object is updated.
@@ -1507,6 +2135,15 @@ xSemaphoreGiveRecursive(mutex);
  * Send a triggered event to all event queues registered on the object.
  */
 int32_t sendEvent(struct UAVOBase *obj, uint16_t instId, UAVObjEventType triggered_event)
+{
+    return sendEventFields(obj, instId, triggered_event, UAVOBJ_FIELDMASK_ALL_BITS);
+}
+
+/**
+ * Send an event for a write that changed the fields in the changed mask, the
+ * EV_UPDATED and EV_UNPACKED events only go to the listeners of these fields
+ */
+int32_t sendEventFields(struct UAVOBase *obj, uint16_t instId, UAVObjEventType triggered_event, uint32_t changed)
 {
     /* Set up the message that will be sent to all registered listeners */
     UAVObjEvent msg = {
@@ -1519,14 +2156,45 @@ int32_t sendEvent(struct UAVOBase *obj, uint16_t instId, UAVObjEventType trigger
     // Go through each object and push the event message in the queue (if event is activated for the queue)
     struct ObjectEventEntry *event;
 
+#ifdef PIOS_ENABLE_ITM_TRACE
+    if (triggered_event & (EV_UPDATED | EV_UPDATED_MANUAL)) {
+        PIOS_ITM_TRACE_UAVO_UPDATED(UAVObjGetID(obj));
+    } else if (triggered_event & EV_UNPACKED) {
+        PIOS_ITM_TRACE_UAVO_UNPACKED(UAVObjGetID(obj));
+    }
+#endif
+
     LL_FOREACH(obj->next_event, event) {
         if (event->eventMask == 0 || (event->eventMask & triggered_event) != 0) {
+            if (event->fieldMask && (triggered_event & (EV_UPDATED | EV_UNPACKED)) && !(event->fieldMask & changed)) {
+                // none of the fields of this listener changed
+                ++stats.eventsFiltered;
+                continue;
+            }
             // Send to queue if a valid queue is registered
             if (event->queue) {
+                if (event->coalesce && event->pendingEvents) {
+                    if (event->pendingInstId == instId && (event->pendingEvents & triggered_event)) {
+                        // the event in the queue already covers this one
+                        ++stats.eventsCoalesced;
+                        continue;
+                    }
+                }
                 // will not block
                 if (xQueueSend(event->queue, &msg, 0) != pdTRUE) {
                     ++stats.eventQueueErrors;
                     stats.lastQueueErrorID = UAVObjGetID(obj);
+                } else if (event->coalesce && (event->pendingEvents == 0 || event->pendingInstId == instId)) {
+                    event->pendingEvents |= triggered_event;
+                    event->pendingInstId  = instId;
+                }
+            }
+
+            // Post to the subscriber, from the shared pool
+            if (event->subscriber) {
+                if (UAVObjSubscriberPost(event->subscriber, &msg, 0) != 0) {
+                    ++stats.eventQueueErrors;
+                    stats.lastQueueErrorID = UAVObjGetID(obj);
                 }
             }
 
@@ -1549,8 +2217,6 @@ int32_t sendEvent(struct UAVOBase *obj, uint16_t instId, UAVObjEventType trigger
  */
 static InstanceHandle createInstance(struct UAVOData *obj, uint16_t instId)
 {
-    struct UAVOMultiInst *instEntry;
-
     /* Don't allow more than one instance for single instance objects */
     if (UAVObjIsSingleInstance(&(obj->base))) {
         PIOS_Assert(0);
@@ -1574,14 +2240,46 @@ static InstanceHandle createInstance(struct UAVOData *obj, uint16_t instId)
         }
     }
 
+#ifdef PIOS_UAVOBJ_INSTANCE_CHUNK
+    /* Instances are created in order, the first one of a chunk allocates it */
+    struct UAVOMulti *uavo_multi = (struct UAVOMulti *)obj;
+    uint16_t chunk = (instId - 1) / PIOS_UAVOBJ_INSTANCE_CHUNK;
+    uint16_t slot  = (instId - 1) % PIOS_UAVOBJ_INSTANCE_CHUNK;
+    if (slot == 0) {
+        if (chunk >= uavo_multi->num_chunks) {
+            /* Grow the chunk table, the chunks themselves never move */
+            uint16_t num_chunks = MAX(4, 2 * uavo_multi->num_chunks);
+            uint8_t **chunks    = (uint8_t **)pios_malloc(num_chunks * sizeof(uint8_t *));
+            if (!chunks) {
+                return NULL;
+            }
+            memset(chunks, 0, num_chunks * sizeof(uint8_t *));
+            if (uavo_multi->chunks) {
+                memcpy(chunks, uavo_multi->chunks, uavo_multi->num_chunks * sizeof(uint8_t *));
+                pios_free(uavo_multi->chunks);
+            }
+            uavo_multi->chunks     = chunks;
+            uavo_multi->num_chunks = num_chunks;
+        }
+        uint32_t size = PIOS_UAVOBJ_INSTANCE_CHUNK * InstanceStride(obj);
+        uavo_multi->chunks[chunk] = (uint8_t *)pios_malloc(size);
+        if (!uavo_multi->chunks[chunk]) {
+            return NULL;
+        }
+        memset(uavo_multi->chunks[chunk], 0, size);
+    }
+    InstanceHandle instance = uavo_multi->chunks[chunk] + slot * InstanceStride(obj);
+#else
     /* Create the actual instance */
     uint32_t size = sizeof(struct UAVOMultiInst) + obj->instance_size;
-    instEntry = (struct UAVOMultiInst *)pios_malloc(size);
+    struct UAVOMultiInst *instEntry = (struct UAVOMultiInst *)pios_malloc(size);
     if (!instEntry) {
         return NULL;
     }
     memset(instEntry, 0, size);
     LL_APPEND(((struct UAVOMulti *)obj)->instance0.next, instEntry);
+    InstanceHandle instance = InstanceDataOffset(instEntry);
+#endif /* PIOS_UAVOBJ_INSTANCE_CHUNK */
 
     ((struct UAVOMulti *)obj)->num_instances++;
 
@@ -1589,7 +2287,166 @@ static InstanceHandle createInstance(struct UAVOData *obj, uint16_t instId)
     instanceAutoUpdated((UAVObjHandle)obj, instId);
 
     // Done
-    return InstanceDataOffset(instEntry);
+    return instance;
+}
+
+/**
+ * Mark the data of a single instance object as being modified.
+ * Lock free readers retry or fall back to the mutex while the counter is odd.
+ * Must be called with the mutex held, or by the only writer of the object.
+ */
+void SingleInstanceWriteBegin(struct UAVOData *obj)
+{
+    if (UAVObjIsSingleInstance(&obj->base) && !UAVObjIsMetaobject(&obj->base)) {
+        ((struct UAVOSingle *)obj)->seq++;
+        __sync_synchronize();
+    }
+}
+
+/**
+ * Finish the modification of a single instance object and publish the new
+ * value to the latest value copy of double buffered objects.
+ */
+void SingleInstanceWriteEnd(struct UAVOData *obj)
+{
+    if (UAVObjIsSingleInstance(&obj->base) && !UAVObjIsMetaobject(&obj->base)) {
+        struct UAVOSingle *uavo_single = (struct UAVOSingle *)obj;
+
+        __sync_synchronize();
+        uavo_single->seq++;
+
+        if (obj->base.flags.isDoubleBuffered) {
+            struct UAVOLatest *latest = ObjLatestPtr(obj);
+            uint32_t next = latest->seq + 1;
+
+            // Fill the buffer no reader is allowed to use, then switch over
+            memcpy(latest->buffer + (next & 1) * obj->instance_size, uavo_single->instance0, obj->instance_size);
+            __sync_synchronize();
+            latest->seq = next;
+        }
+    }
+}
+
+/**
+ * Copy data into an object instance. Must be called with the mutex held.
+ * Single instance objects bump their sequence counter around the copy so
+ * that lock free readers can detect a concurrent update.
+ */
+static uint32_t writeInstance(struct UAVOData *obj, InstanceHandle instEntry, const void *dataIn, uint32_t offset, uint32_t size)
+{
+    uint32_t changed = UAVOBJ_FIELDMASK_ALL_BITS;
+    struct ObjectEventEntry *event;
+
+    // only compare for notify on change objects or when someone listens to some of the fields
+    if (obj->base.flags.isNotifyOnChange) {
+        changed = changedFields(obj, InstanceData(instEntry), dataIn, offset, size);
+    } else {
+        LL_FOREACH(obj->base.next_event, event) {
+            if (event->fieldMask) {
+                changed = changedFields(obj, InstanceData(instEntry), dataIn, offset, size);
+                break;
+            }
+        }
+    }
+    if (changed == 0) {
+        return 0;
+    }
+
+    SingleInstanceWriteBegin(obj);
+    memcpy(InstanceData(instEntry) + offset, dataIn, size);
+    SingleInstanceWriteEnd(obj);
+    return changed;
+}
+
+/**
+ * The field mask bits of the bytes a write changes, bit n covers the n-th
+ * UAVOBJ_FIELDMASK_CHUNK of the instance data
+ */
+static uint32_t changedFields(const struct UAVOData *obj, const uint8_t *oldData, const uint8_t *newData, uint32_t offset, uint32_t size)
+{
+    const uint32_t chunk = UAVOBJ_FIELDMASK_CHUNK(obj->instance_size);
+    const uint32_t end   = offset + size;
+    uint32_t changed     = 0;
+
+    for (uint32_t pos = offset; pos < end;) {
+        uint32_t bit  = pos / chunk;
+        uint32_t next = MIN((bit + 1) * chunk, end);
+        if (memcmp(oldData + pos, newData + (pos - offset), next - pos)) {
+            changed |= 1u << bit;
+        }
+        pos = next;
+    }
+    return changed;
+}
+
+/**
+ * Lock free read of a single instance object.
+ * Gives up instead of spinning if a writer is active, so that the caller
+ * can block on the mutex and let the writer finish.
+ * \return true if a consistent copy was made
+ */
+static bool readSingleInstance(struct UAVOData *obj, void *dataOut, uint32_t offset, uint32_t size)
+{
+    struct UAVOSingle *uavo_single = (struct UAVOSingle *)obj;
+
+    for (uint8_t retry = 0; retry < 2; retry++) {
+        uint32_t seq = uavo_single->seq;
+
+        if (seq & 1) {
+            return false;
+        }
+        __sync_synchronize();
+        memcpy(dataOut, (uint8_t *)uavo_single->instance0 + offset, size);
+        __sync_synchronize();
+        if (seq == uavo_single->seq) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Read the latest value copy of a double buffered object.
+ * A writer in progress never touches the buffer being read, so this only
+ * retries if a complete update was published during the copy.
+ * \return true if a consistent copy was made
+ */
+static bool readLatest(struct UAVOData *obj, void *dataOut, uint32_t offset, uint32_t size)
+{
+    struct UAVOLatest *latest = ObjLatestPtr(obj);
+
+    for (uint8_t retry = 0; retry < 4; retry++) {
+        uint32_t seq = latest->seq;
+
+        __sync_synchronize();
+        memcpy(dataOut, latest->buffer + (seq & 1) * obj->instance_size + offset, size);
+        __sync_synchronize();
+        if (seq == latest->seq) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Walk the settings objects of the handle table, which is only set up in
+ * this file on Mach-o.
+ * \param[in,out] slot Next slot of the table to look at, 0 to start
+ * \return the next settings object or NULL at the end of the table
+ */
+struct UAVOData *getNextSettingsObject(uint32_t *slot)
+{
+    while (__start__uavo_handles && &__start__uavo_handles[*slot] < __stop__uavo_handles) {
+        struct UAVOData *obj = __start__uavo_handles[(*slot)++];
+
+        if (obj != NULL && UAVObjIsSettings((UAVObjHandle)obj)) {
+            return obj;
+        }
+    }
+
+    return NULL;
 }
 
 /**
@@ -1605,8 +2462,9 @@ InstanceHandle getInstance(struct UAVOData *obj, uint16_t instId)
         }
 
         /* Augment our pointer to reflect the proper type */
+        /* Only to read, metadata are changed through MetaDataWrite */
         struct UAVOMeta *uavo_meta = (struct UAVOMeta *)obj;
-        return &(uavo_meta->instance0);
+        return (InstanceHandle)uavo_meta->metadata;
     } else if (UAVObjIsSingleInstance(&(obj->base))) {
         /* Single Instance */
 
@@ -1625,6 +2483,13 @@ InstanceHandle getInstance(struct UAVOData *obj, uint16_t instId)
             return NULL;
         }
 
+#ifdef PIOS_UAVOBJ_INSTANCE_CHUNK
+        if (instId == 0) {
+            return &(uavo_multi->instance0.instance);
+        }
+        return uavo_multi->chunks[(instId - 1) / PIOS_UAVOBJ_INSTANCE_CHUNK] +
+               ((instId - 1) % PIOS_UAVOBJ_INSTANCE_CHUNK) * InstanceStride(obj);
+#else
         // Look for specified instance ID
         uint16_t instance = 0;
         struct UAVOMultiInst *instEntry;
@@ -1636,6 +2501,7 @@ InstanceHandle getInstance(struct UAVOData *obj, uint16_t instId)
         }
         /* Instance was not found */
         return NULL;
+#endif /* PIOS_UAVOBJ_INSTANCE_CHUNK */
     }
 }
 
@@ -1643,12 +2509,15 @@ InstanceHandle getInstance(struct UAVOData *obj, uint16_t instId)
  * Connect an event queue to the object, if the queue is already connected then the event mask is only updated.
  * \param[in] obj The object handle
  * \param[in] queue The event queue
+ * \param[in] subscriber The event subscriber
  * \param[in] cb The event callback
  * \param[in] eventMask The event mask, if EV_MASK_ALL then all events are enabled (e.g. EV_UPDATED | EV_UPDATED_MANUAL)
+ * \param[in] coalesce Whether the events waiting in the queue are not queued again
+ * \param[in] fieldMask The fields whose changes are sent, UAVOBJ_FIELDMASK_ALL for all
  * \return 0 if success or -1 if failure
  */
-static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
-                          UAVObjEventCallback cb, uint8_t eventMask)
+static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventSubscriber *subscriber,
+                          UAVObjEventCallback cb, uint8_t eventMask, bool coalesce, uint32_t fieldMask)
 {
     struct ObjectEventEntry *event;
     struct UAVOBase *obj;
@@ -1656,9 +2525,11 @@ static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
     // Check that the queue is not already connected, if it is simply update event mask
     obj = (struct UAVOBase *)obj_handle;
     LL_FOREACH(obj->next_event, event) {
-        if (event->queue == queue && event->cb == cb) {
-            // Already connected, update event mask and return
+        if (event->queue == queue && event->subscriber == subscriber && event->cb == cb) {
+            // Already connected, update event mask and return, the pending events stay in the queue
             event->eventMask = eventMask;
+            event->coalesce  = coalesce;
+            event->fieldMask = fieldMask;
             return 0;
         }
     }
@@ -1668,9 +2539,14 @@ static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
     if (event == NULL) {
         return -1;
     }
-    event->queue     = queue;
-    event->cb        = cb;
-    event->eventMask = eventMask;
+    event->queue         = queue;
+    event->subscriber    = subscriber;
+    event->cb            = cb;
+    event->eventMask     = eventMask;
+    event->coalesce      = coalesce;
+    event->fieldMask     = fieldMask;
+    event->pendingEvents = 0;
+    event->pendingInstId = 0;
     LL_APPEND(obj->next_event, event);
 
     // Done
@@ -1681,10 +2557,11 @@ static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
  * Disconnect an event queue from the object
  * \param[in] obj The object handle
  * \param[in] queue The event queue
+ * \param[in] subscriber The event subscriber
  * \param[in] cb The event callback
  * \return 0 if success or -1 if failure
  */
-static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue,
+static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventSubscriber *subscriber,
                              UAVObjEventCallback cb)
 {
     struct ObjectEventEntry *event;
@@ -1694,6 +2571,7 @@ static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue,
     obj = (struct UAVOBase *)obj_handle;
     LL_FOREACH(obj->next_event, event) {
         if ((event->queue == queue
+             && event->subscriber == subscriber
              && event->cb == cb)) {
             LL_DELETE(obj->next_event, event);
             vPortFree(event);
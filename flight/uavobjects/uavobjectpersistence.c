@@ -69,6 +69,54 @@ int32_t UAVObjSave(UAVObjHandle obj_handle, uint16_t instId)
     return 0;
 }
 
+struct settingsBatch {
+    uint32_t slot; /* next slot for getNextSettingsObject() */
+    bool     failed; /* a settings object has no instance 0 */
+};
+
+/**
+ * Iterates instance 0 of all settings objects for PIOS_FLASHFS_ObjSaveBatch.
+ * Stops at an object without data, as UAVObjSave does.
+ * @param[in] context The struct settingsBatch of the save
+ */
+static bool nextSettingsBatchObject(void *context, uint32_t *obj_id, uint16_t *obj_inst_id, uint8_t **obj_data, uint16_t *obj_size)
+{
+    struct settingsBatch *batch = (struct settingsBatch *)context;
+    struct UAVOData *obj = getNextSettingsObject(&batch->slot);
+
+    if (obj == NULL) {
+        return false;
+    }
+
+    InstanceHandle instEntry = getInstance(obj, 0);
+    if (instEntry == NULL || InstanceData(instEntry) == NULL) {
+        batch->failed = true;
+        return false;
+    }
+
+    *obj_id      = UAVObjGetID((UAVObjHandle)obj);
+    *obj_inst_id = 0;
+    *obj_data    = InstanceData(instEntry);
+    *obj_size    = UAVObjGetNumBytes((UAVObjHandle)obj);
+    return true;
+}
+
+/**
+ * Save instance 0 of all settings objects to the file system in one transaction.
+ * Objects that are stored unchanged already are not written again.
+ * Called by UAVObjSaveSettings with the object manager lock held.
+ * @return 0 if success or -1 if failure
+ */
+int32_t saveSettingsBatch(void)
+{
+    struct settingsBatch batch = { .slot = 0, .failed = false };
+
+    if (PIOS_FLASHFS_ObjSaveBatch(pios_uavo_settings_fs_id, nextSettingsBatchObject, &batch) != 0 || batch.failed) {
+        return -1;
+    }
+    return 0;
+}
+
 
 /**
  * Load an object from the file system (SD card).
@@ -87,8 +135,10 @@ int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId)
             return -1;
         }
 
-        // Fire event on success
-        if (PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, (uint8_t *)MetaDataPtr((struct UAVOMeta *)obj_handle), UAVObjGetNumBytes(obj_handle)) == 0) {
+        // Fire event on success, the stored metadata only take RAM if they differ from the defaults
+        UAVObjMetadata metadata;
+        if (PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, (uint8_t *)&metadata, UAVObjGetNumBytes(obj_handle)) == 0 &&
+            MetaDataWrite((struct UAVOMeta *)obj_handle, &metadata, 0, sizeof(metadata))) {
             sendEvent((struct UAVOBase *)obj_handle, instId, EV_UNPACKED);
         } else {
             return -1;
@@ -101,7 +151,10 @@ int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId)
         }
 
         // Fire event on success
-        if (PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, InstanceData(instEntry), UAVObjGetNumBytes(obj_handle)) == 0) {
+        SingleInstanceWriteBegin((struct UAVOData *)obj_handle);
+        int32_t rc = PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, InstanceData(instEntry), UAVObjGetNumBytes(obj_handle));
+        SingleInstanceWriteEnd((struct UAVOData *)obj_handle);
+        if (rc == 0) {
             sendEvent((struct UAVOBase *)obj_handle, instId, EV_UNPACKED);
         } else {
             return -1;
@@ -39,12 +39,58 @@
 // max header : sync(1), type (1), size(2), object ID(4), instance ID(2), timestamp(2)
 #define UAVTALK_MAX_HEADER_LENGTH  12
 
+#define UAVTALK_TIMESTAMP_LENGTH   (UAVTALK_MAX_HEADER_LENGTH - UAVTALK_MIN_HEADER_LENGTH)
+
 #define UAVTALK_CHECKSUM_LENGTH    1
 
 #define UAVTALK_MAX_PAYLOAD_LENGTH (UAVOBJECTS_LARGEST + 1)
 
+// batch record header : object ID(4), instance ID(2)
+#define UAVTALK_BATCH_RECORD_HEADER_LENGTH 6
+
+// batched frames are bounded independently of the local object set so that
+// boards with small objects (e.g. a relaying modem) can still forward them.
+// must stay below the GCS receive limit of 256 bytes
+#define UAVTALK_MAX_BATCH_PAYLOAD_LENGTH   255
+
+#if UAVTALK_MAX_BATCH_PAYLOAD_LENGTH > UAVTALK_MAX_PAYLOAD_LENGTH
+#define UAVTALK_MAX_RX_PAYLOAD_LENGTH      UAVTALK_MAX_BATCH_PAYLOAD_LENGTH
+#else
+#define UAVTALK_MAX_RX_PAYLOAD_LENGTH      UAVTALK_MAX_PAYLOAD_LENGTH
+#endif
+
 #define UAVTALK_MIN_PACKET_LENGTH  UAVTALK_MAX_HEADER_LENGTH + UAVTALK_CHECKSUM_LENGTH
-#define UAVTALK_MAX_PACKET_LENGTH  UAVTALK_MIN_PACKET_LENGTH + UAVTALK_MAX_PAYLOAD_LENGTH
+#define UAVTALK_MAX_PACKET_LENGTH  UAVTALK_MIN_PACKET_LENGTH + UAVTALK_MAX_RX_PAYLOAD_LENGTH
+#define UAVTALK_BATCH_BUFFER_LENGTH (UAVTALK_MAX_HEADER_LENGTH + UAVTALK_MAX_BATCH_PAYLOAD_LENGTH + UAVTALK_CHECKSUM_LENGTH)
+
+// delta payload : base sequence(1), base CRC(1), bitmap of changed blocks, changed blocks
+// the base sequence counts the deltas sent since the full copy the base derives from, 0 is the full copy itself
+#define UAVTALK_DELTA_BLOCK_LENGTH 4
+#define UAVTALK_DELTA_BITMAP_LENGTH(length) ((((length) + UAVTALK_DELTA_BLOCK_LENGTH - 1) / UAVTALK_DELTA_BLOCK_LENGTH + 7) / 8)
+
+// number of object instances per connection that can be delta encoded
+#define UAVTALK_DELTA_SHADOWS      8
+
+// a full copy is sent every n updates so that receivers which missed an update resynchronise
+#define UAVTALK_DELTA_KEYFRAME_INTERVAL 10
+
+typedef struct {
+    uint32_t objId;
+    uint16_t instId;
+    uint8_t  updates; // updates sent since the last full copy, 0 forces a full copy
+    uint8_t  *data; // copy of the object data as last sent
+} UAVTalkDeltaShadow;
+
+// acked transactions that can wait for their response at the same time, see UAVTalkSendObjectAsync()
+#define UAVTALK_MAX_PENDING        4
+
+typedef struct {
+    uint32_t objId; // 0 when the slot is free
+    uint16_t instId;
+    uint8_t  type; // transaction type, sent again on timeout
+    uint8_t  retries; // transmissions that timed out
+    portTickType sentTime; // time of the last transmission
+} UAVTalkPendingTransaction;
 
 typedef struct {
     uint8_t  type;
@@ -73,6 +119,13 @@ typedef struct {
     UAVTalkInputProcessor iproc;
     uint8_t      *rxBuffer;
     uint8_t      *txBuffer;
+    uint8_t      *batchBuffer;
+    uint16_t     batchLength;
+    uint16_t     batchCount;
+    uint16_t     batchTimestamp; // time of the first batched object
+    bool         timestamped; // object frames carry the send time, see UAVTalkSetTimestamped()
+    UAVTalkDeltaShadow *deltaShadows;
+    UAVTalkPendingTransaction *pending;
 } UAVTalkConnectionData;
 
 #define UAVTALK_CANARI          0xCA
@@ -86,6 +139,8 @@ typedef struct {
 #define UAVTALK_TYPE_OBJ_ACK    (UAVTALK_TYPE_VER | 0x02)
 #define UAVTALK_TYPE_ACK        (UAVTALK_TYPE_VER | 0x03)
 #define UAVTALK_TYPE_NACK       (UAVTALK_TYPE_VER | 0x04)
+#define UAVTALK_TYPE_OBJ_MULTI  (UAVTALK_TYPE_VER | 0x05)
+#define UAVTALK_TYPE_OBJ_DELTA  (UAVTALK_TYPE_VER | 0x06)
 #define UAVTALK_TYPE_OBJ_TS     (UAVTALK_TIMESTAMPED | UAVTALK_TYPE_OBJ)
 #define UAVTALK_TYPE_OBJ_ACK_TS (UAVTALK_TIMESTAMPED | UAVTALK_TYPE_OBJ_ACK)
 
@@ -49,9 +49,15 @@
 
 // Private functions
 static int32_t objectTransaction(UAVTalkConnectionData *connection, uint8_t type, UAVObjHandle obj, uint16_t instId, int32_t timeout);
+static int32_t asyncTransaction(UAVTalkConnectionData *connection, uint8_t type, UAVObjHandle obj, uint16_t instId);
 static int32_t sendObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, UAVObjHandle obj);
 static int32_t sendSingleObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, UAVObjHandle obj);
+static int32_t batchObject(UAVTalkConnectionData *connection, uint32_t objId, uint16_t instId, UAVObjHandle obj);
+static int32_t flushBatch(UAVTalkConnectionData *connection);
+static UAVTalkDeltaShadow *findDeltaShadow(UAVTalkConnectionData *connection, uint32_t objId, uint16_t instId, uint32_t length);
+static int32_t sendDeltaObject(UAVTalkConnectionData *connection, uint32_t objId, uint16_t instId, UAVObjHandle obj);
 static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, uint8_t *data);
+static int32_t receiveBatch(UAVTalkConnectionData *connection, uint16_t count, uint8_t *data, uint32_t length);
 static void updateAck(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId);
 
 /**
@@ -84,6 +90,15 @@ UAVTalkConnection UAVTalkInitialize(UAVTalkOutputStream outputStream)
     if (!connection->txBuffer) {
         return 0;
     }
+    // the batch buffer is only allocated once batching is used on this connection
+    connection->batchBuffer = NULL;
+    connection->batchLength = 0;
+    connection->batchCount  = 0;
+    connection->timestamped = false;
+    // likewise the delta shadow table
+    connection->deltaShadows = NULL;
+    // and the pending transactions
+    connection->pending = NULL;
     vSemaphoreCreateBinary(connection->respSema);
     xSemaphoreTake(connection->respSema, 0); // reset to zero
     UAVTalkResetStats((UAVTalkConnection)connection);
@@ -115,6 +130,35 @@ int32_t UAVTalkSetOutputStream(UAVTalkConnection connectionHandle, UAVTalkOutput
     return 0;
 }
 
+/**
+ * Select if the object updates sent on the connection carry a timestamp.
+ * Plain, acked, batched and delta frames then hold the system time in ms (16 bits) at which
+ * they were sent, or for batched frames at which the first object was queued, so that the
+ * receiver can time the updates independently of the link latency.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] timestamped True to send timestamped frames
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSetTimestamped(UAVTalkConnection connectionHandle, bool timestamped)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    // Lock
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+
+    // queued objects go out with the framing they were queued for
+    flushBatch(connection);
+    connection->timestamped = timestamped;
+
+    // Release lock
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return 0;
+}
+
 /**
  * Get current output stream
  * \param[in] connection UAVTalkConnection to be used
@@ -265,6 +309,92 @@ int32_t UAVTalkSendObject(UAVTalkConnection connectionHandle, UAVObjHandle obj,
     }
 }
 
+/**
+ * Send the specified object with an ack request, without waiting for the ack.
+ * The object is sent again with its current data if the ack does not come in
+ * time, see UAVTalkProcessPendingTransactions(). Up to UAVTALK_MAX_PENDING
+ * transactions are in flight at once, a transaction on an object instance
+ * that is already pending replaces it.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object to send
+ * \param[in] instId The instance ID or UAVOBJ_ALL_INSTANCES for all instances.
+ * \return 0 Success
+ * \return -1 Failure, or no room for another pending transaction
+ */
+int32_t UAVTalkSendObjectAsync(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    return asyncTransaction(connection, UAVTALK_TYPE_OBJ_ACK, obj, instId);
+}
+
+/**
+ * Request an object update from the other end, without waiting for the update.
+ * Works as UAVTalkSendObjectAsync(), the update completes the transaction.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object to request
+ * \param[in] instId The instance ID or UAVOBJ_ALL_INSTANCES for all instances.
+ * \return 0 Success
+ * \return -1 Failure, or no room for another pending transaction
+ */
+int32_t UAVTalkSendObjectRequestAsync(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    return asyncTransaction(connection, UAVTALK_TYPE_OBJ_REQ, obj, instId);
+}
+
+/**
+ * Send again the pending transactions whose response is late, or give up on them.
+ * To be called regularly by the task making the asynchronous transactions.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] timeoutMs Time to wait for a response before sending again
+ * \param[in] maxRetries Transmissions of a transaction before giving up
+ * \param[out] retries Incremented for each transmission that timed out
+ * \param[out] failures Incremented for each transaction given up
+ * \return The number of transactions still pending
+ */
+int32_t UAVTalkProcessPendingTransactions(UAVTalkConnection connectionHandle, int32_t timeoutMs, uint8_t maxRetries, uint32_t *retries, uint32_t *failures)
+{
+    UAVTalkConnectionData *connection;
+    int32_t count = 0;
+
+    CHECKCONHANDLE(connectionHandle, connection, return 0);
+
+    if (!connection->pending) {
+        return 0;
+    }
+
+    portTickType now = xTaskGetTickCount();
+
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+    for (uint8_t n = 0; n < UAVTALK_MAX_PENDING; ++n) {
+        UAVTalkPendingTransaction *trans = &connection->pending[n];
+        if (trans->objId == 0) {
+            continue;
+        }
+        if ((portTickType)(now - trans->sentTime) >= (portTickType)(timeoutMs / portTICK_RATE_MS)) {
+            ++*retries;
+            UAVObjHandle obj = UAVObjGetByID(trans->objId);
+            if (!obj || ++trans->retries >= maxRetries ||
+                sendObject(connection, trans->type, trans->objId, trans->instId, obj) != 0) {
+                ++*failures;
+                trans->objId = 0;
+                continue;
+            }
+            trans->sentTime = now;
+        }
+        ++count;
+    }
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return count;
+}
+
 /**
  * Send the specified object through the telemetry link with a timestamp.
  * \param[in] connection UAVTalkConnection to be used
@@ -289,6 +419,128 @@ int32_t UAVTalkSendObjectTimestamped(UAVTalkConnection connectionHandle, UAVObjH
     }
 }
 
+/**
+ * Queue the specified object for transmission in a batched frame.
+ * Queued objects are sent together in a single UAVTALK_TYPE_OBJ_MULTI frame
+ * once the frame is full, when UAVTalkFlushBatch() is called, or before any
+ * other packet is sent on the connection.
+ * Batched objects are never acked.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object to send
+ * \param[in] instId The instance ID or UAVOBJ_ALL_INSTANCES for all instances.
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSendObjectBatched(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId)
+{
+    UAVTalkConnectionData *connection;
+    uint32_t numInst;
+    uint32_t n;
+    int32_t ret;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    // If all instances are requested and this is a single instance object, force instance ID to zero
+    if ((instId == UAVOBJ_ALL_INSTANCES) && UAVObjIsSingleInstance(obj)) {
+        instId = 0;
+    }
+
+    // Lock
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+
+    if (instId == UAVOBJ_ALL_INSTANCES) {
+        // Queue all instances in reverse order, see sendObject()
+        numInst = UAVObjGetNumInstances(obj);
+        ret     = 0;
+        for (n = 0; n < numInst; ++n) {
+            ret = batchObject(connection, UAVObjGetID(obj), numInst - n - 1, obj);
+            if (ret == -1) {
+                break;
+            }
+        }
+    } else {
+        ret = batchObject(connection, UAVObjGetID(obj), instId, obj);
+    }
+
+    // Release lock
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return ret;
+}
+
+/**
+ * Send any objects queued by UAVTalkSendObjectBatched()
+ * \param[in] connection UAVTalkConnection to be used
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkFlushBatch(UAVTalkConnection connectionHandle)
+{
+    UAVTalkConnectionData *connection;
+    int32_t ret;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    // Lock
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+
+    ret = flushBatch(connection);
+
+    // Release lock
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return ret;
+}
+
+/**
+ * Send the specified object as a delta against the copy last sent on this connection.
+ * The frame holds a CRC of the previous copy, so receivers that missed an update drop
+ * the delta, a full copy is sent periodically to resynchronise them.
+ * Objects that can not be tracked, or whose delta is not smaller, are sent in full.
+ * Delta encoded objects are never acked.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object to send
+ * \param[in] instId The instance ID or UAVOBJ_ALL_INSTANCES for all instances.
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSendObjectDelta(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId)
+{
+    UAVTalkConnectionData *connection;
+    uint32_t numInst;
+    uint32_t n;
+    int32_t ret;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    // If all instances are requested and this is a single instance object, force instance ID to zero
+    if ((instId == UAVOBJ_ALL_INSTANCES) && UAVObjIsSingleInstance(obj)) {
+        instId = 0;
+    }
+
+    // Lock
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+
+    if (instId == UAVOBJ_ALL_INSTANCES) {
+        // Send all instances in reverse order, see sendObject()
+        numInst = UAVObjGetNumInstances(obj);
+        ret     = 0;
+        for (n = 0; n < numInst; ++n) {
+            ret = sendDeltaObject(connection, UAVObjGetID(obj), numInst - n - 1, obj);
+            if (ret == -1) {
+                break;
+            }
+        }
+    } else {
+        ret = sendDeltaObject(connection, UAVObjGetID(obj), instId, obj);
+    }
+
+    // Release lock
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return ret;
+}
+
 /**
  * Execute the requested transaction on an object.
  * \param[in] connection UAVTalkConnection to be used
@@ -347,6 +599,60 @@ static int32_t objectTransaction(UAVTalkConnectionData *connection, uint8_t type
     return ret;
 }
 
+/**
+ * Send an object or an object request and record it as pending its response
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] type Transaction type, UAVTALK_TYPE_OBJ_ACK or UAVTALK_TYPE_OBJ_REQ
+ * \param[in] obj Object
+ * \param[in] instId The instance ID of UAVOBJ_ALL_INSTANCES for all instances.
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t asyncTransaction(UAVTalkConnectionData *connection, uint8_t type, UAVObjHandle obj, uint16_t instId)
+{
+    UAVTalkPendingTransaction *trans = NULL;
+    uint32_t objId = UAVObjGetID(obj);
+    int32_t ret    = -1;
+
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+
+    if (!connection->pending) {
+        connection->pending = pios_malloc(UAVTALK_MAX_PENDING * sizeof(UAVTalkPendingTransaction));
+        if (connection->pending) {
+            memset(connection->pending, 0, UAVTALK_MAX_PENDING * sizeof(UAVTalkPendingTransaction));
+        }
+    }
+    if (connection->pending) {
+        // the same transaction again, else a free slot
+        for (uint8_t n = 0; n < UAVTALK_MAX_PENDING; ++n) {
+            UAVTalkPendingTransaction *slot = &connection->pending[n];
+            if (slot->objId == objId && slot->instId == instId && slot->type == type) {
+                trans = slot;
+                break;
+            }
+            if (!trans && slot->objId == 0) {
+                trans = slot;
+            }
+        }
+    }
+    if (trans) {
+        ret = sendObject(connection, type, objId, instId, obj);
+        if (ret == 0) {
+            trans->objId    = objId;
+            trans->instId   = instId;
+            trans->type     = type;
+            trans->retries  = 0;
+            trans->sentTime = xTaskGetTickCount();
+        } else {
+            trans->objId = 0;
+        }
+    }
+
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return ret;
+}
+
 /**
  * Process an byte from the telemetry stream.
  * \param[in] connectionHandle UAVTalkConnection to be used
@@ -421,7 +727,7 @@ UAVTalkRxState UAVTalkProcessInputStreamQuiet(UAVTalkConnection connectionHandle
         iproc->packet_size += rxbyte << 8;
         iproc->rxCount      = 0;
 
-        if (iproc->packet_size < UAVTALK_MIN_HEADER_LENGTH || iproc->packet_size > UAVTALK_MAX_HEADER_LENGTH + UAVTALK_MAX_PAYLOAD_LENGTH) {
+        if (iproc->packet_size < UAVTALK_MIN_HEADER_LENGTH || iproc->packet_size > UAVTALK_MAX_HEADER_LENGTH + UAVTALK_MAX_RX_PAYLOAD_LENGTH) {
             // incorrect packet size
             connection->stats.rxErrors++;
             iproc->state = UAVTALK_STATE_ERROR;
@@ -465,8 +771,9 @@ UAVTalkRxState UAVTalkProcessInputStreamQuiet(UAVTalkConnection connectionHandle
             iproc->length = 0;
             iproc->timestampLength = 0;
         } else {
-            iproc->timestampLength = (iproc->type & UAVTALK_TIMESTAMPED) ? 2 : 0;
-            if (obj) {
+            uint8_t baseType = iproc->type & ~UAVTALK_TIMESTAMPED;
+            iproc->timestampLength = (iproc->type & UAVTALK_TIMESTAMPED) ? UAVTALK_TIMESTAMP_LENGTH : 0;
+            if (obj && baseType != UAVTALK_TYPE_OBJ_MULTI && baseType != UAVTALK_TYPE_OBJ_DELTA) {
                 iproc->length = UAVObjGetNumBytes(obj);
             } else {
                 iproc->length = iproc->packet_size - iproc->rxPacketLength - iproc->timestampLength;
@@ -474,7 +781,7 @@ UAVTalkRxState UAVTalkProcessInputStreamQuiet(UAVTalkConnection connectionHandle
         }
 
         // Check length
-        if (iproc->length >= UAVTALK_MAX_PAYLOAD_LENGTH) {
+        if ((iproc->type & ~UAVTALK_TIMESTAMPED) == UAVTALK_TYPE_OBJ_MULTI ? iproc->length > UAVTALK_MAX_BATCH_PAYLOAD_LENGTH : iproc->length >= UAVTALK_MAX_PAYLOAD_LENGTH) {
             // packet error - exceeded payload max length
             connection->stats.rxErrors++;
             iproc->state = UAVTALK_STATE_ERROR;
@@ -556,7 +863,8 @@ UAVTalkRxState UAVTalkProcessInputStreamQuiet(UAVTalkConnection connectionHandle
             break;
         }
 
-        connection->stats.rxObjects++;
+        // batched frames carry their record count in the instance ID
+        connection->stats.rxObjects     += ((iproc->type & ~UAVTALK_TIMESTAMPED) == UAVTALK_TYPE_OBJ_MULTI) ? iproc->instId : 1;
         connection->stats.rxObjectBytes += iproc->length;
 
         iproc->state = UAVTALK_STATE_COMPLETE;
@@ -589,6 +897,76 @@ UAVTalkRxState UAVTalkProcessInputStream(UAVTalkConnection connectionHandle, uin
     return state;
 }
 
+/**
+ * Process a buffer of bytes from the telemetry stream.
+ * Sync scanning and payload copies are done in bulk. When a payload and its checksum are
+ * entirely in the buffer the object is unpacked from the buffer itself, without going
+ * through the connection receive buffer, so UAVTalkReceiveObject() and UAVTalkRelayPacket()
+ * must not be used on the resulting state. Received objects are handled as by UAVTalkProcessInputStream().
+ * \param[in] connectionHandle UAVTalkConnection to be used
+ * \param[in] buf Received bytes
+ * \param[in] length Number of received bytes
+ * \return UAVTalkRxState after the last byte
+ */
+UAVTalkRxState UAVTalkProcessInputStreamBuffer(UAVTalkConnection connectionHandle, uint8_t *buf, uint16_t length)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    UAVTalkInputProcessor *iproc = &connection->iproc;
+    uint16_t pos = 0;
+
+    while (pos < length) {
+        uint16_t available = length - pos;
+
+        if (iproc->state == UAVTALK_STATE_SYNC) {
+            // skip everything up to the next sync byte
+            uint8_t *sync    = memchr(&buf[pos], UAVTALK_SYNC_VAL, available);
+            uint16_t skipped = sync ? (uint16_t)(sync - &buf[pos]) : available;
+            if (skipped > 0) {
+                connection->stats.rxBytes      += skipped;
+                connection->stats.rxSyncErrors += skipped;
+                pos += skipped;
+                continue;
+            }
+        } else if (iproc->state == UAVTALK_STATE_DATA) {
+            uint32_t remaining = iproc->length - iproc->rxCount;
+            uint32_t count     = (remaining < available) ? remaining : available;
+
+            // update the CRC over the whole slice
+            iproc->cs = PIOS_CRC_updateCRC(iproc->cs, &buf[pos], count);
+            connection->stats.rxBytes += count;
+            iproc->rxPacketLength     += count;
+
+            if (iproc->rxCount == 0 && remaining < available) {
+                // payload and checksum are in the buffer, check the checksum and unpack in place
+                uint8_t *data = &buf[pos];
+                pos += count;
+                iproc->state = UAVTALK_STATE_CS;
+                if (UAVTalkProcessInputStreamQuiet(connectionHandle, buf[pos++]) == UAVTALK_STATE_COMPLETE) {
+                    receiveObject(connection, iproc->type, iproc->objId, iproc->instId, data);
+                }
+                continue;
+            }
+
+            // the packet spans buffers, collect the payload in the receive buffer
+            memcpy(&connection->rxBuffer[iproc->rxCount], &buf[pos], count);
+            iproc->rxCount += count;
+            pos += count;
+            if (iproc->rxCount == iproc->length) {
+                iproc->rxCount = 0;
+                iproc->state   = UAVTALK_STATE_CS;
+            }
+            continue;
+        }
+
+        UAVTalkProcessInputStream(connectionHandle, buf[pos++]);
+    }
+
+    return iproc->state;
+}
+
 /**
  * Send a parsed packet received on one connection handle out on a different connection handle.
  * The packet must be in a complete state, meaning it is completed parsing.
@@ -639,12 +1017,11 @@ int32_t UAVTalkRelayPacket(UAVTalkConnection inConnectionHandle, UAVTalkConnecti
     outConnection->txBuffer[9] = (uint8_t)((inIproc->instId >> 8) & 0xFF);
     int32_t headerLength = 10;
 
-    // Add timestamp when the transaction type is appropriate
+    // Copy the timestamp, it is covered by the copied checksum and holds the time of the original sender
     if (inIproc->type & UAVTALK_TIMESTAMPED) {
-        portTickType time = xTaskGetTickCount();
-        outConnection->txBuffer[10] = (uint8_t)(time & 0xFF);
-        outConnection->txBuffer[11] = (uint8_t)((time >> 8) & 0xFF);
-        headerLength += 2;
+        outConnection->txBuffer[10] = (uint8_t)(inIproc->timestamp & 0xFF);
+        outConnection->txBuffer[11] = (uint8_t)((inIproc->timestamp >> 8) & 0xFF);
+        headerLength += UAVTALK_TIMESTAMP_LENGTH;
     }
 
     // Copy data (if any)
@@ -679,6 +1056,62 @@ int32_t UAVTalkRelayPacket(UAVTalkConnection inConnectionHandle, UAVTalkConnecti
     return ret;
 }
 
+/**
+ * Send a parsed packet out on a different connection handle as it was received.
+ * The packet must be complete and frame must hold all of its bytes, from the sync byte
+ * to the checksum, typically in the buffer that was just fed to the parser. The bytes
+ * are forwarded untouched, which saves the copy and the re-framing of UAVTalkRelayPacket().
+ * \param[in] inConnectionHandle UAVTalkConnection the packet was parsed on
+ * \param[in] outConnectionHandle UAVTalkConnection the packet is sent on
+ * \param[in] frame The received bytes of the packet
+ * \param[in] length Number of bytes in frame
+ * \return 0 Success
+ * \return -1 Failure, or frame is not the whole packet
+ */
+int32_t UAVTalkRelayFrame(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t *frame, uint16_t length)
+{
+    UAVTalkConnectionData *inConnection;
+
+    CHECKCONHANDLE(inConnectionHandle, inConnection, return -1);
+    UAVTalkInputProcessor *inIproc = &inConnection->iproc;
+
+    // The input packet must be completely parsed, and be the one given.
+    if (inIproc->state != UAVTALK_STATE_COMPLETE || inIproc->rxPacketLength != length || frame[0] != UAVTALK_SYNC_VAL) {
+        inConnection->stats.rxErrors++;
+
+        return -1;
+    }
+
+    UAVTalkConnectionData *outConnection;
+    CHECKCONHANDLE(outConnectionHandle, outConnection, return -1);
+
+    if (!outConnection->outStream) {
+        outConnection->stats.txErrors++;
+
+        return -1;
+    }
+
+    // Lock
+    xSemaphoreTakeRecursive(outConnection->lock, portMAX_DELAY);
+
+    int32_t rc = (*outConnection->outStream)(frame, length);
+
+    // Update stats
+    outConnection->stats.txBytes += (rc > 0) ? rc : 0;
+
+    // evaluate return value before releasing the lock
+    int32_t ret = 0;
+    if (rc != (int32_t)length) {
+        outConnection->stats.txErrors++;
+        ret = -1;
+    }
+
+    // Release lock
+    xSemaphoreGiveRecursive(outConnection->lock);
+
+    return ret;
+}
+
 /**
  * Complete receiving a UAVTalk packet.  This will cause the packet to be unpacked, acked, etc.
  * \param[in] connectionHandle UAVTalkConnection to be used
@@ -806,6 +1239,16 @@ static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, ui
         }
         break;
 
+    case UAVTALK_TYPE_OBJ_MULTI:
+        // Batched object updates, the instance ID holds the record count
+        ret = receiveBatch(connection, instId, data, connection->iproc.length);
+        break;
+
+    case UAVTALK_TYPE_OBJ_DELTA:
+        // Delta frames are only sent by the flight side
+        ret = -1;
+        break;
+
     case UAVTALK_TYPE_NACK:
         // Do nothing on flight side, let it time out.
         // TODO:
@@ -838,6 +1281,50 @@ static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, ui
     return ret;
 }
 
+/**
+ * Unpack the records of a batched frame.
+ * Each record is object ID(4), instance ID(2) followed by the object data.
+ * The record length is only known from the object itself, so unpacking stops at the first unknown object.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] count Number of records in the frame
+ * \param[in] data Data buffer
+ * \param[in] length Buffer length
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t receiveBatch(UAVTalkConnectionData *connection, uint16_t count, uint8_t *data, uint32_t length)
+{
+    UAVObjHandle obj;
+    uint32_t objId;
+    uint16_t instId;
+    uint32_t offset = 0;
+    int32_t ret     = 0;
+
+    for (uint16_t n = 0; n < count; ++n) {
+        if (offset + UAVTALK_BATCH_RECORD_HEADER_LENGTH > length) {
+            return -1;
+        }
+        objId   = data[offset] | (data[offset + 1] << 8) | (data[offset + 2] << 16) | ((uint32_t)data[offset + 3] << 24);
+        instId  = data[offset + 4] | (data[offset + 5] << 8);
+        offset += UAVTALK_BATCH_RECORD_HEADER_LENGTH;
+
+        obj     = UAVObjGetByID(objId);
+        if (!obj || instId == UAVOBJ_ALL_INSTANCES || offset + UAVObjGetNumBytes(obj) > length) {
+            return -1;
+        }
+        // Unpack object, if the instance does not exist it will be created!
+        if (UAVObjUnpack(obj, instId, &data[offset]) == 0) {
+            // a batched record acks a pending OBJ_REQ message like a plain OBJ message
+            updateAck(connection, UAVTALK_TYPE_OBJ, objId, instId);
+        } else {
+            ret = -1;
+        }
+        offset += UAVObjGetNumBytes(obj);
+    }
+
+    return ret;
+}
+
 /**
  * Check if an ack is pending on an object and give response semaphore
  * \param[in] connection UAVTalkConnection to be used
@@ -846,6 +1333,18 @@ static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, ui
  */
 static void updateAck(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId)
 {
+    if (connection->pending) {
+        // the response to an acked object is an ack, the one to a request is the object
+        uint8_t transType = ((type & ~UAVTALK_TIMESTAMPED) == UAVTALK_TYPE_ACK) ? UAVTALK_TYPE_OBJ_ACK : UAVTALK_TYPE_OBJ_REQ;
+        for (uint8_t n = 0; n < UAVTALK_MAX_PENDING; ++n) {
+            UAVTalkPendingTransaction *trans = &connection->pending[n];
+            if (trans->objId == objId && trans->type == transType &&
+                (trans->instId == instId || (trans->instId == UAVOBJ_ALL_INSTANCES && instId == 0))) {
+                trans->objId = 0;
+            }
+        }
+    }
+
     if ((connection->respObjId == objId) && (connection->respType == type)) {
         if ((connection->respInstId == UAVOBJ_ALL_INSTANCES) && (instId == 0)) {
             // last instance received, complete transaction
@@ -923,11 +1422,18 @@ static int32_t sendSingleObject(UAVTalkConnectionData *connection, uint8_t type,
 {
     // IMPORTANT : obj can be null (when type is NACK for example)
 
+    // Queued batched objects go out first to preserve the update order
+    flushBatch(connection);
+
     if (!connection->outStream) {
         connection->stats.txErrors++;
         return -1;
     }
 
+    if (connection->timestamped && (type == UAVTALK_TYPE_OBJ || type == UAVTALK_TYPE_OBJ_ACK)) {
+        type |= UAVTALK_TIMESTAMPED;
+    }
+
     // Setup sync byte
     connection->txBuffer[0] = UAVTALK_SYNC_VAL;
     // Setup type
@@ -948,7 +1454,7 @@ static int32_t sendSingleObject(UAVTalkConnectionData *connection, uint8_t type,
         portTickType time = xTaskGetTickCount();
         connection->txBuffer[10] = (uint8_t)(time & 0xFF);
         connection->txBuffer[11] = (uint8_t)((time >> 8) & 0xFF);
-        headerLength += 2;
+        headerLength += UAVTALK_TIMESTAMP_LENGTH;
     }
 
     // Determine data length
@@ -1000,6 +1506,287 @@ static int32_t sendSingleObject(UAVTalkConnectionData *connection, uint8_t type,
     return 0;
 }
 
+/**
+ * Append an object to the batched frame of the connection, sending the frame first if it is full.
+ * Objects too large to share a frame are sent on their own.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] objId The object ID
+ * \param[in] instId The instance ID (can NOT be UAVOBJ_ALL_INSTANCES)
+ * \param[in] obj Object handle to send
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t batchObject(UAVTalkConnectionData *connection, uint32_t objId, uint16_t instId, UAVObjHandle obj)
+{
+    uint32_t length = UAVObjGetNumBytes(obj);
+    uint32_t recordLength = UAVTALK_BATCH_RECORD_HEADER_LENGTH + length;
+
+    if (recordLength > UAVTALK_MAX_BATCH_PAYLOAD_LENGTH) {
+        return sendSingleObject(connection, UAVTALK_TYPE_OBJ, objId, instId, obj);
+    }
+
+    if (!connection->batchBuffer) {
+        connection->batchBuffer = pios_malloc(UAVTALK_BATCH_BUFFER_LENGTH);
+        if (!connection->batchBuffer) {
+            return sendSingleObject(connection, UAVTALK_TYPE_OBJ, objId, instId, obj);
+        }
+    }
+
+    if (connection->batchLength + recordLength > UAVTALK_MAX_BATCH_PAYLOAD_LENGTH) {
+        flushBatch(connection);
+    }
+    if (connection->batchCount == 0) {
+        connection->batchTimestamp = (uint16_t)xTaskGetTickCount();
+    }
+
+    // Setup the record header, records follow the largest frame header
+    uint8_t *record = &connection->batchBuffer[UAVTALK_MAX_HEADER_LENGTH + connection->batchLength];
+    record[0] = (uint8_t)(objId & 0xFF);
+    record[1] = (uint8_t)((objId >> 8) & 0xFF);
+    record[2] = (uint8_t)((objId >> 16) & 0xFF);
+    record[3] = (uint8_t)((objId >> 24) & 0xFF);
+    record[4] = (uint8_t)(instId & 0xFF);
+    record[5] = (uint8_t)((instId >> 8) & 0xFF);
+
+    // Copy data
+    if (UAVObjPack(obj, instId, &record[UAVTALK_BATCH_RECORD_HEADER_LENGTH]) == -1) {
+        connection->stats.txErrors++;
+        return -1;
+    }
+
+    connection->batchLength += recordLength;
+    connection->batchCount++;
+
+    return 0;
+}
+
+/**
+ * Send the batched frame of the connection, if any objects are queued.
+ * \param[in] connection UAVTalkConnection to be used
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t flushBatch(UAVTalkConnectionData *connection)
+{
+    uint16_t count  = connection->batchCount;
+    uint16_t length = connection->batchLength;
+    uint16_t headerLength = connection->timestamped ? UAVTALK_MAX_HEADER_LENGTH : UAVTALK_MIN_HEADER_LENGTH;
+
+    if (count == 0) {
+        return 0;
+    }
+    // the frame header is built right before the records
+    uint8_t *buffer = &connection->batchBuffer[UAVTALK_MAX_HEADER_LENGTH - headerLength];
+    connection->batchCount  = 0;
+    connection->batchLength = 0;
+
+    if (!connection->outStream) {
+        connection->stats.txErrors++;
+        return -1;
+    }
+
+    // Setup sync byte and type
+    buffer[0] = UAVTALK_SYNC_VAL;
+    buffer[1] = connection->timestamped ? (UAVTALK_TIMESTAMPED | UAVTALK_TYPE_OBJ_MULTI) : UAVTALK_TYPE_OBJ_MULTI;
+    // Store the packet length
+    buffer[2] = (uint8_t)((headerLength + length) & 0xFF);
+    buffer[3] = (uint8_t)(((headerLength + length) >> 8) & 0xFF);
+    // Object ID is unused, the instance ID holds the record count
+    buffer[4] = 0;
+    buffer[5] = 0;
+    buffer[6] = 0;
+    buffer[7] = 0;
+    buffer[8] = (uint8_t)(count & 0xFF);
+    buffer[9] = (uint8_t)((count >> 8) & 0xFF);
+    if (connection->timestamped) {
+        buffer[10] = (uint8_t)(connection->batchTimestamp & 0xFF);
+        buffer[11] = (uint8_t)((connection->batchTimestamp >> 8) & 0xFF);
+    }
+
+    // Calculate and store checksum
+    buffer[headerLength + length] = PIOS_CRC_updateCRC(0, buffer, headerLength + length);
+
+    // Send frame
+    uint16_t tx_msg_len = headerLength + length + UAVTALK_CHECKSUM_LENGTH;
+    int32_t rc = (*connection->outStream)(buffer, tx_msg_len);
+
+    // Update stats
+    if (rc == tx_msg_len) {
+        connection->stats.txObjects     += count;
+        connection->stats.txObjectBytes += length - count * UAVTALK_BATCH_RECORD_HEADER_LENGTH;
+        connection->stats.txBytes += tx_msg_len;
+    } else {
+        connection->stats.txErrors++;
+        connection->stats.txBytes += (rc > 0) ? rc : 0;
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Get the delta shadow of an object instance, assigning a free one on first use.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] objId The object ID
+ * \param[in] instId The instance ID
+ * \param[in] length The object data length
+ * \return The shadow or NULL if all shadows are in use
+ */
+static UAVTalkDeltaShadow *findDeltaShadow(UAVTalkConnectionData *connection, uint32_t objId, uint16_t instId, uint32_t length)
+{
+    UAVTalkDeltaShadow *shadows = connection->deltaShadows;
+
+    if (!shadows) {
+        shadows = pios_malloc(UAVTALK_DELTA_SHADOWS * sizeof(UAVTalkDeltaShadow));
+        if (!shadows) {
+            return NULL;
+        }
+        memset(shadows, 0, UAVTALK_DELTA_SHADOWS * sizeof(UAVTalkDeltaShadow));
+        connection->deltaShadows = shadows;
+    }
+
+    for (uint8_t n = 0; n < UAVTALK_DELTA_SHADOWS; ++n) {
+        if (shadows[n].data && shadows[n].objId == objId && shadows[n].instId == instId) {
+            return &shadows[n];
+        }
+    }
+
+    // Shadows are never released, the set of delta encoded objects is fixed at runtime
+    for (uint8_t n = 0; n < UAVTALK_DELTA_SHADOWS; ++n) {
+        if (!shadows[n].data) {
+            shadows[n].data = pios_malloc(length);
+            if (!shadows[n].data) {
+                return NULL;
+            }
+            shadows[n].objId   = objId;
+            shadows[n].instId  = instId;
+            shadows[n].updates = 0;
+            return &shadows[n];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Send an object instance as a delta frame, or in full when required.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] objId The object ID
+ * \param[in] instId The instance ID (can NOT be UAVOBJ_ALL_INSTANCES)
+ * \param[in] obj Object handle to send
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t sendDeltaObject(UAVTalkConnectionData *connection, uint32_t objId, uint16_t instId, UAVObjHandle obj)
+{
+    uint8_t bitmap[UAVTALK_DELTA_BITMAP_LENGTH(UAVOBJECTS_LARGEST)];
+    uint32_t length = UAVObjGetNumBytes(obj);
+    UAVTalkDeltaShadow *shadow = findDeltaShadow(connection, objId, instId, length);
+
+    if (!shadow || length > UAVOBJECTS_LARGEST) {
+        return sendSingleObject(connection, UAVTALK_TYPE_OBJ, objId, instId, obj);
+    }
+
+    // Queued batched objects go out first to preserve the update order
+    flushBatch(connection);
+
+    if (!connection->outStream) {
+        connection->stats.txErrors++;
+        return -1;
+    }
+
+    // Pack the current data, it becomes the payload when sent in full
+    uint32_t headerLength = connection->timestamped ? UAVTALK_MAX_HEADER_LENGTH : UAVTALK_MIN_HEADER_LENGTH;
+    uint8_t *payload = &connection->txBuffer[headerLength];
+    if (UAVObjPack(obj, instId, payload) == -1) {
+        connection->stats.txErrors++;
+        return -1;
+    }
+
+    // Mark the blocks that changed since the last sent copy
+    uint32_t bitmapLength = UAVTALK_DELTA_BITMAP_LENGTH(length);
+    uint32_t deltaLength  = 2 + bitmapLength;
+    uint32_t offset;
+    uint32_t block;
+    uint32_t n;
+    memset(bitmap, 0, bitmapLength);
+    for (offset = 0, block = 0; offset < length; offset += UAVTALK_DELTA_BLOCK_LENGTH, ++block) {
+        n = (length - offset < UAVTALK_DELTA_BLOCK_LENGTH) ? length - offset : UAVTALK_DELTA_BLOCK_LENGTH;
+        if (memcmp(&payload[offset], &shadow->data[offset], n) != 0) {
+            bitmap[block / 8] |= 1 << (block % 8);
+            deltaLength += n;
+        }
+    }
+
+    uint8_t baseCrc = PIOS_CRC_updateCRC(0, shadow->data, length);
+    memcpy(shadow->data, payload, length);
+
+    uint8_t type    = UAVTALK_TYPE_OBJ;
+    if (shadow->updates > 0 && shadow->updates < UAVTALK_DELTA_KEYFRAME_INTERVAL && deltaLength < length) {
+        // Replace the packed data by the delta, the changed blocks are taken from the updated shadow
+        // the base is named by its update count since the full copy as well as its CRC,
+        // the 8 bit CRC alone would let about one delta in 256 apply to a wrong base
+        type       = UAVTALK_TYPE_OBJ_DELTA;
+        payload[0] = shadow->updates - 1;
+        payload[1] = baseCrc;
+        memcpy(&payload[2], bitmap, bitmapLength);
+        uint32_t pos = 2 + bitmapLength;
+        for (offset = 0, block = 0; offset < length; offset += UAVTALK_DELTA_BLOCK_LENGTH, ++block) {
+            if (bitmap[block / 8] & (1 << (block % 8))) {
+                n = (length - offset < UAVTALK_DELTA_BLOCK_LENGTH) ? length - offset : UAVTALK_DELTA_BLOCK_LENGTH;
+                memcpy(&payload[pos], &shadow->data[offset], n);
+                pos += n;
+            }
+        }
+    }
+    uint32_t payloadLength = (type == UAVTALK_TYPE_OBJ_DELTA) ? deltaLength : length;
+
+    // Setup sync byte
+    connection->txBuffer[0] = UAVTALK_SYNC_VAL;
+    // Setup type
+    connection->txBuffer[1] = connection->timestamped ? (UAVTALK_TIMESTAMPED | type) : type;
+    // Store the packet length
+    connection->txBuffer[2] = (uint8_t)((headerLength + payloadLength) & 0xFF);
+    connection->txBuffer[3] = (uint8_t)(((headerLength + payloadLength) >> 8) & 0xFF);
+    // Setup object ID
+    connection->txBuffer[4] = (uint8_t)(objId & 0xFF);
+    connection->txBuffer[5] = (uint8_t)((objId >> 8) & 0xFF);
+    connection->txBuffer[6] = (uint8_t)((objId >> 16) & 0xFF);
+    connection->txBuffer[7] = (uint8_t)((objId >> 24) & 0xFF);
+    // Setup instance ID
+    connection->txBuffer[8] = (uint8_t)(instId & 0xFF);
+    connection->txBuffer[9] = (uint8_t)((instId >> 8) & 0xFF);
+    if (connection->timestamped) {
+        portTickType time = xTaskGetTickCount();
+        connection->txBuffer[10] = (uint8_t)(time & 0xFF);
+        connection->txBuffer[11] = (uint8_t)((time >> 8) & 0xFF);
+    }
+
+    // Calculate and store checksum
+    connection->txBuffer[headerLength + payloadLength] = PIOS_CRC_updateCRC(0, connection->txBuffer, headerLength + payloadLength);
+
+    // Send object
+    uint16_t tx_msg_len = headerLength + payloadLength + UAVTALK_CHECKSUM_LENGTH;
+    int32_t rc = (*connection->outStream)(connection->txBuffer, tx_msg_len);
+
+    // Update stats
+    if (rc == tx_msg_len) {
+        ++connection->stats.txObjects;
+        connection->stats.txObjectBytes += payloadLength;
+        connection->stats.txBytes += tx_msg_len;
+    } else {
+        connection->stats.txErrors++;
+        connection->stats.txBytes += (rc > 0) ? rc : 0;
+        // the receiver copy is unknown now, force a full copy next time
+        shadow->updates = 0;
+        return -1;
+    }
+
+    shadow->updates = (type == UAVTALK_TYPE_OBJ_DELTA) ? shadow->updates + 1 : 1;
+
+    return 0;
+}
+
 /**
  * @}
  * @}
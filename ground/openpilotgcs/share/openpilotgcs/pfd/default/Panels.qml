@@ -989,7 +989,7 @@ Item {
         } 
 
         Text {
-             text: ["None", "Basic (No Nav)", "CompMag", "Comp+Mag+GPS", "EKFIndoor", "GPS Nav (INS13)"][RevoSettings.FusionAlgorithm]
+             text: ["None", "Basic (No Nav)", "CompMag", "Comp+Mag+GPS", "EKFIndoor", "GPS Nav (INS13)", "EKF16Indoor", "GPS Nav (INS16)", "Fast (No Nav)"][RevoSettings.FusionAlgorithm]
              anchors.right: parent.right
              color: "white"
              font {
@@ -100,4 +100,15 @@ Rectangle {
             }
         }
     }
+
+    Text {
+        visible: qmlWidget.frameStatsShown
+        anchors.left: parent.left
+        anchors.bottom: parent.bottom
+        anchors.margins: 4
+        color: "white"
+        font.pixelSize: 12
+        text: qmlWidget.frameRate.toFixed(0) + " fps, render " + qmlWidget.renderTime.toFixed(2) +
+              " ms, data " + qmlWidget.dataTime.toFixed(2) + " ms"
+    }
 }
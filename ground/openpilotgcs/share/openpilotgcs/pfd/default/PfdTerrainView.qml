@@ -6,6 +6,8 @@ OsgEarth {
 
     sceneFile: qmlWidget.earthFile
     fieldOfView: 90
+    lodScale: qmlWidget.terrainLODScale
+    maximumPagedLOD: qmlWidget.terrainMaximumPagedLOD
 
     yaw: AttitudeState.Yaw
     pitch: AttitudeState.Pitch
@@ -36,6 +36,7 @@
 #include <QtCore/QMetaProperty>
 #include <QtCore/QDir>
 #include <QtCore/QTextStream>
+#include <algorithm>
 #include <QtCore/QWriteLocker>
 #include <QtDebug>
 #ifdef WITH_TESTS
@@ -382,6 +383,9 @@ void PluginManager::formatOptions(QTextStream &str, int optionIndentation, int d
     formatOption(str, QLatin1String(OptionsParser::NO_LOAD_OPTION),
                  QLatin1String("plugin"), QLatin1String("Do not load <plugin>"),
                  optionIndentation, descriptionIndentation);
+    formatOption(str, QLatin1String(OptionsParser::PROFILE_OPTION),
+                 QString(), QLatin1String("Report the time spent starting each plugin"),
+                 optionIndentation, descriptionIndentation);
 }
 
 /*!
@@ -494,7 +498,7 @@ PluginSpecPrivate *PluginManagerPrivate::privateSpec(PluginSpec *spec)
     \internal
  */
 PluginManagerPrivate::PluginManagerPrivate(PluginManager *pluginManager)
-    : extension("xml"), q(pluginManager)
+    : extension("xml"), profileElapsedMS(0), profiling(false), q(pluginManager)
 {}
 
 /*!
@@ -577,15 +581,25 @@ void PluginManagerPrivate::removeObject(QObject *obj)
 /*!
     \fn void PluginManagerPrivate::loadPlugins()
     \internal
+    Plugins are loaded, initialized and started one at a time in dependency
+    order on the GUI thread. initialize() creates widgets and registers the
+    gadget factories, so it can neither run on another thread nor wait until
+    one of the gadgets is needed: the factory is only known once the library
+    is loaded. The costly part is deferred instead by the workspaces, which
+    only create their gadgets when first shown. Run with -profile to see the
+    time each plugin takes.
  */
 void PluginManagerPrivate::loadPlugins()
 {
     QList<PluginSpec *> queue = loadQueue();
+    profilingReport(">loadPlugins");
     foreach(PluginSpec * spec, queue) {
         loadPlugin(spec, PluginSpec::Loaded);
+        profilingReport("loadLibrary", spec);
     }
     foreach(PluginSpec * spec, queue) {
         loadPlugin(spec, PluginSpec::Initialized);
+        profilingReport("initializePlugin", spec);
     }
     QListIterator<PluginSpec *> it(queue);
     it.toBack();
@@ -593,10 +607,76 @@ void PluginManagerPrivate::loadPlugins()
         PluginSpec *plugin = it.previous();
         emit q->pluginAboutToBeLoaded(plugin);
         loadPlugin(plugin, PluginSpec::Running);
+        profilingReport("extensionsInitialized", plugin);
     }
     emit q->pluginsChanged();
     q->m_allPluginsLoaded = true;
     emit q->pluginsLoadEnded();
+    profilingReport("<loadPlugins");
+    profilingSummary();
+}
+
+/*!
+    \fn void PluginManagerPrivate::initProfiling()
+    \internal
+ */
+void PluginManagerPrivate::initProfiling()
+{
+    profiling = true;
+    profileTimer.start();
+    profileElapsedMS = 0;
+    qDebug("Profiling started");
+}
+
+/*!
+    \fn void PluginManagerPrivate::profilingReport(const char *what, const PluginSpec *spec)
+    \internal
+    Print the time since the previous report and charge it to \a spec.
+ */
+void PluginManagerPrivate::profilingReport(const char *what, const PluginSpec *spec)
+{
+    if (!profiling) {
+        return;
+    }
+    const qint64 absoluteElapsedMS = profileTimer.elapsed();
+    const qint64 elapsedMS = absoluteElapsedMS - profileElapsedMS;
+    profileElapsedMS = absoluteElapsedMS;
+    if (spec) {
+        profileTotal[spec] += elapsedMS;
+        qDebug("%-22s %-22s %8lldms (%8lldms)", what, qPrintable(spec->name()), elapsedMS, absoluteElapsedMS);
+    } else {
+        qDebug("%-45s %8lldms", what, absoluteElapsedMS);
+    }
+}
+
+static bool profileTotalLessThan(const QPair<qint64, const PluginSpec *> &a, const QPair<qint64, const PluginSpec *> &b)
+{
+    return a.first > b.first;
+}
+
+/*!
+    \fn void PluginManagerPrivate::profilingSummary()
+    \internal
+    Print the plugins by the total time they took to start, slowest first.
+ */
+void PluginManagerPrivate::profilingSummary() const
+{
+    if (!profiling) {
+        return;
+    }
+    QList<QPair<qint64, const PluginSpec *> > sorted;
+    qint64 total = 0;
+    QHash<const PluginSpec *, qint64>::const_iterator it;
+    for (it = profileTotal.constBegin(); it != profileTotal.constEnd(); ++it) {
+        sorted.append(qMakePair(it.value(), it.key()));
+        total += it.value();
+    }
+    std::sort(sorted.begin(), sorted.end(), profileTotalLessThan);
+    for (int i = 0; i < sorted.size(); ++i) {
+        qDebug("%-22s %8lldms (%5.1f%%)", qPrintable(sorted.at(i).second->name()), sorted.at(i).first,
+               total ? 100.0 * sorted.at(i).first / total : 0.0);
+    }
+    qDebug("Total plugins: %lldms", total);
 }
 
 /*!
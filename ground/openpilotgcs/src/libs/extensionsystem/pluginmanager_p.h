@@ -35,6 +35,8 @@
 #include <QtCore/QSet>
 #include <QtCore/QStringList>
 #include <QtCore/QObject>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
 
 namespace ExtensionSystem {
 class PluginManager;
@@ -57,6 +59,9 @@ public:
     QList<PluginSpec *> loadQueue();
     void loadPlugin(PluginSpec *spec, PluginSpec::State destState);
     void resolveDependencies();
+    void initProfiling();
+    void profilingReport(const char *what, const PluginSpec *spec = 0);
+    void profilingSummary() const;
 
     QList<PluginSpec *> pluginSpecs;
     QList<PluginSpec *> testSpecs;
@@ -66,6 +71,12 @@ public:
 
     QStringList arguments;
 
+    // Startup profiling, enabled by the -profile option
+    QElapsedTimer profileTimer;
+    qint64 profileElapsedMS;
+    QHash<const PluginSpec *, qint64> profileTotal;
+    bool profiling;
+
     // Look in argument descriptions of the specs for the option.
     PluginSpec *pluginForOption(const QString &option, bool *requiresArgument) const;
     PluginSpec *pluginByName(const QString &name) const;
@@ -46,6 +46,37 @@ void Cache::setCacheLocation(const QString & value)
     geoCache       = cache + "GeocoderCache" + QDir::separator();
     placemarkCache = cache + "PlacemarkCache" + QDir::separator();
     ImageCache.setGtileCache(value);
+    openTilePacks();
+}
+void Cache::openTilePacks()
+{
+    QWriteLocker locker(&tilePackLock);
+
+    qDeleteAll(tilePacks);
+    tilePacks.clear();
+    QDir dir(cache);
+    foreach(QString name, dir.entryList(QStringList("*.tilepack"), QDir::Files, QDir::Name)) {
+        TilePack *pack = new TilePack;
+
+        if (pack->Open(dir.absoluteFilePath(name))) {
+            tilePacks.append(pack);
+        } else {
+            qWarning() << "Cache - invalid tile pack" << dir.absoluteFilePath(name);
+            delete pack;
+        }
+    }
+}
+QByteArray Cache::GetImageFromTilePacks(const MapType::Types &type, const Point &pos, const int &zoom)
+{
+    QReadLocker locker(&tilePackLock);
+
+    foreach(TilePack * pack, tilePacks) {
+        QByteArray ret = pack->GetImage(type, pos, zoom);
+        if (!ret.isEmpty()) {
+            return ret;
+        }
+    }
+    return QByteArray();
 }
 QString Cache::CacheLocation()
 {
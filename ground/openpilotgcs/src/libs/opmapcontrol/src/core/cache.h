@@ -28,6 +28,7 @@
 #define CACHE_H
 
 #include "pureimagecache.h"
+#include "tilepack.h"
 #include "debugheader.h"
 
 namespace core {
@@ -45,6 +46,7 @@ public:
     QString GetPlacemarkFromCache(const QString &urlEnd);
     void CacheRoute(const QString &urlEnd, const QString &content);
     QString GetRouteFromCache(const QString &urlEnd);
+    QByteArray GetImageFromTilePacks(const MapType::Types &type, const Point &pos, const int &zoom);
 
 private:
     Cache();
@@ -58,6 +60,10 @@ private:
     QString routeCache;
     QString geoCache;
     QString placemarkCache;
+    // the *.tilepack files of the cache location
+    QList<TilePack *> tilePacks;
+    QReadWriteLock tilePackLock;
+    void openTilePacks();
 };
 }
 #endif // CACHE_H
@@ -26,6 +26,21 @@
  */
 #include "opmaps.h"
 
+#include <QThreadStorage>
+
+namespace {
+// one manager per loader thread, so its connections are kept alive between tiles
+QThreadStorage<QNetworkAccessManager *> networkManagers;
+
+QNetworkAccessManager *networkManager()
+{
+    if (!networkManagers.hasLocalData()) {
+        networkManagers.setLocalData(new QNetworkAccessManager);
+    }
+    return networkManagers.localData();
+}
+}
+
 
 namespace core {
 OPMaps *OPMaps::m_pInstance = 0;
@@ -79,6 +94,19 @@ QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, co
         qDebug() << "Tile not in memory";
 #endif // DEBUG_GMAPS
         if (accessmode != (AccessMode::ServerOnly)) {
+#ifdef DEBUG_GMAPS
+            qDebug() << "Try tile from the tile packs";
+#endif // DEBUG_GMAPS
+            ret = Cache::Instance()->GetImageFromTilePacks(type, pos, zoom);
+            if (!ret.isEmpty()) {
+                errorvars.lock();
+                ++diag.tilesFromPack;
+                errorvars.unlock();
+                if (useMemoryCache) {
+                    AddTileToMemoryCache(RawTile(type, pos, zoom), ret);
+                }
+                return ret;
+            }
 #ifdef DEBUG_GMAPS
             qDebug() << "Try tile from DataBase";
 #endif // DEBUG_GMAPS
@@ -103,13 +131,11 @@ QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, co
             QEventLoop q;
             QNetworkReply *reply;
             QNetworkRequest qheader;
-            QNetworkAccessManager network;
+            QNetworkAccessManager *network = networkManager();
             QTimer tT;
             tT.setSingleShot(true);
-            connect(&network, SIGNAL(finished(QNetworkReply *)),
-                    &q, SLOT(quit()));
             connect(&tT, SIGNAL(timeout()), &q, SLOT(quit()));
-            network.setProxy(Proxy);
+            network->setProxy(Proxy);
 #ifdef DEBUG_GMAPS
             qDebug() << "Try Tile from the Internet";
 #endif // DEBUG_GMAPS
@@ -193,7 +219,8 @@ QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, co
             default:
                 break;
             }
-            reply = network.get(qheader);
+            reply = network->get(qheader);
+            connect(reply, SIGNAL(finished()), &q, SLOT(quit()));
             tT.start(Timeout);
             q.exec();
 
@@ -201,6 +228,8 @@ QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, co
                 errorvars.lock();
                 ++diag.timeouts;
                 errorvars.unlock();
+                reply->abort();
+                reply->deleteLater();
                 return ret;
             }
             tT.stop();
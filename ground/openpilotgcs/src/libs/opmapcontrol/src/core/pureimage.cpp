@@ -26,6 +26,23 @@
  */
 #include "pureimage.h"
 
+#include <QCache>
+
+namespace {
+// the cache keeps a copy of the encoded array so its data, which is the key,
+// can't be freed and reused for another tile while the entry exists
+struct DecodedTile {
+    QByteArray encoded;
+    QPixmap    pixmap;
+};
+
+const int DEFAULT_CACHE_SIZE = 64 * 1024 * 1024;
+
+// never deleted, the pixmaps must not outlive the application object
+QCache<quintptr, DecodedTile> &decodedTiles = *new QCache<quintptr, DecodedTile>(DEFAULT_CACHE_SIZE);
+int cacheHits   = 0;
+int cacheMisses = 0;
+}
 
 namespace core {
 PureImageProxy::PureImageProxy()
@@ -35,6 +52,37 @@ QPixmap PureImageProxy::FromStream(const QByteArray &array)
 {
     return QPixmap::fromImage(QImage::fromData(array));
 }
+QPixmap PureImageProxy::FromCache(const QByteArray &array)
+{
+    quintptr key = (quintptr)array.constData();
+    DecodedTile *tile = decodedTiles.object(key);
+
+    if (tile) {
+        ++cacheHits;
+        return tile->pixmap;
+    }
+    ++cacheMisses;
+    tile = new DecodedTile;
+    tile->encoded = array;
+    tile->pixmap  = FromStream(array);
+    QPixmap pixmap = tile->pixmap;
+    int cost = pixmap.width() * pixmap.height() * pixmap.depth() / 8 + array.size();
+    // insert() deletes the tile if it is larger than the whole cache
+    decodedTiles.insert(key, tile, cost);
+    return pixmap;
+}
+void PureImageProxy::SetCacheSize(int bytes)
+{
+    decodedTiles.setMaxCost(bytes);
+}
+int PureImageProxy::CacheHits()
+{
+    return cacheHits;
+}
+int PureImageProxy::CacheMisses()
+{
+    return cacheMisses;
+}
 bool PureImageProxy::Save(const QByteArray &array, QPixmap &pic)
 {
     pic = QPixmap::fromImage(QImage::fromData(array));
@@ -37,6 +37,13 @@ public:
     PureImageProxy();
     static QPixmap FromStream(const QByteArray &array);
     static bool Save(const QByteArray &array, QPixmap &pic);
+
+    // Decoded tiles, kept in a size bounded LRU cache so painting doesn't decode
+    // the same tile on every frame. GUI thread only, as QPixmap is.
+    static QPixmap FromCache(const QByteArray &array);
+    static void SetCacheSize(int bytes);
+    static int CacheHits();
+    static int CacheMisses();
 };
 }
 #endif // PUREIMAGE_H
@@ -27,10 +27,72 @@
 #include "pureimagecache.h"
 #include <QDateTime>
 #include <QSettings>
+#include <QAtomicInt>
+#include <QThreadStorage>
 // #define DEBUG_PUREIMAGECACHE
 namespace core {
 qlonglong PureImageCache::ConnCounter = 0;
 
+namespace {
+/*
+ * Connection of a thread to the tile database, with its prepared statements.
+ * A connection can only be used by the thread that opened it, so each thread
+ * keeps its own instead of opening one per tile, it is closed when the thread ends.
+ */
+class TileConnection {
+public:
+    TileConnection(const QString &file);
+    ~TileConnection();
+
+    QString file;
+    QString name;
+    QSqlDatabase db;
+    QSqlQuery *selectTile;
+    QSqlQuery *insertTile;
+    QSqlQuery *insertData;
+};
+
+QAtomicInt tileConnectionCount;
+QThreadStorage<TileConnection *> tileConnections;
+
+TileConnection::TileConnection(const QString &file) : file(file), selectTile(0), insertTile(0), insertData(0)
+{
+    name = QString("TileConnection%1").arg(tileConnectionCount.fetchAndAddRelaxed(1));
+    db   = QSqlDatabase::addDatabase("QSQLITE", name);
+    db.setDatabaseName(file);
+    if (db.open()) {
+        // the write ahead log is synced at checkpoints only, a crash can only lose the last tiles
+        QSqlQuery(db).exec("PRAGMA synchronous=NORMAL");
+        selectTile = new QSqlQuery(db);
+        selectTile->prepare("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE X=? AND Y=? AND Zoom=? AND Type=?)");
+        insertTile = new QSqlQuery(db);
+        insertTile->prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)");
+        insertData = new QSqlQuery(db);
+        insertData->prepare("INSERT INTO TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), ?)");
+    }
+}
+
+TileConnection::~TileConnection()
+{
+    delete selectTile;
+    delete insertTile;
+    delete insertData;
+    db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(name);
+}
+
+// The connection of the calling thread to file, NULL if it can't be opened
+TileConnection *tileConnection(const QString &file)
+{
+    if (!tileConnections.hasLocalData() || tileConnections.localData()->file != file) {
+        tileConnections.setLocalData(new TileConnection(file));
+    }
+    TileConnection *cn = tileConnections.localData();
+    return cn->db.isOpen() ? cn : 0;
+}
+}
+
 PureImageCache::PureImageCache()
 {}
 
@@ -53,9 +115,30 @@ void PureImageCache::setGtileCache(const QString &value)
 #endif // DEBUG_PUREIMAGECACHE
             CreateEmptyDB(db);
         }
+        PrepareDB(db);
     }
     lock.unlock();
 }
+/*
+ * Settings of the database kept in the file, also applied to databases created
+ * by previous versions.
+ */
+void PureImageCache::PrepareDB(const QString &file)
+{
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", QLatin1String("PrepareConn"));
+        db.setDatabaseName(file);
+        if (db.open()) {
+            QSqlQuery query(db);
+            // Readers don't wait for the tile writer thread with a write ahead log
+            query.exec("PRAGMA journal_mode=WAL");
+            // Tiles are looked up by position
+            query.exec("CREATE INDEX IF NOT EXISTS IndexOfTiles ON Tiles (X, Y, Zoom, Type)");
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(QLatin1String("PrepareConn"));
+}
 QString PureImageCache::GtileCache()
 {
     return gtilecache;
@@ -160,86 +243,68 @@ bool PureImageCache::CreateEmptyDB(const QString &file)
 }
 bool PureImageCache::PutImageToCache(const QByteArray &tile, const MapType::Types &type, const Point &pos, const int &zoom)
 {
+    CacheItemQueue item(type, pos, tile, zoom);
+    QList<CacheItemQueue *> tiles;
+
+    tiles << &item;
+    return PutImagesToCache(tiles);
+}
+/*
+ * Write the tiles in a single transaction, the statements prepared by the
+ * connection of the calling thread are reused.
+ */
+bool PureImageCache::PutImagesToCache(const QList<CacheItemQueue *> &tiles)
+{
+    QReadLocker locker(&lock);
+
     if (gtilecache.isEmpty() | gtilecache.isNull()) {
         return false;
     }
-    lock.lockForRead();
 #ifdef DEBUG_PUREIMAGECACHE
-    qDebug() << "PutImageToCache Start:"; // <<pos;
+    qDebug() << "PutImagesToCache Start:" << tiles.count();
 #endif // DEBUG_PUREIMAGECACHE
-    Mcounter.lock();
-    qlonglong id = ++ConnCounter;
-    Mcounter.unlock();
-    {
-        QSqlDatabase cn;
-        cn = QSqlDatabase::addDatabase("QSQLITE", QString::number(id));
-        QString db = gtilecache + "Data.qmdb";
-        cn.setDatabaseName(db);
-        cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-        if (cn.open()) {
-            {
-                QSqlQuery query(cn);
-                query.prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)");
-                query.addBindValue(pos.X());
-                query.addBindValue(pos.Y());
-                query.addBindValue(zoom);
-
-                query.addBindValue((int)type);
-                query.addBindValue(QDateTime::currentDateTime().toString());
-                query.exec();
-            }
-            {
-                QSqlQuery query(cn);
-                query.prepare("INSERT INTO TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), ?)");
-                query.addBindValue(tile);
-                query.exec();
-            }
-            cn.close();
+    TileConnection *cn = tileConnection(gtilecache + "Data.qmdb");
+    if (!cn) {
+        return false;
+    }
+    cn->db.transaction();
+    QString date = QDateTime::currentDateTime().toString();
+    foreach(CacheItemQueue * tile, tiles) {
+        cn->insertTile->addBindValue(tile->GetPosition().X());
+        cn->insertTile->addBindValue(tile->GetPosition().Y());
+        cn->insertTile->addBindValue(tile->GetZoom());
+        cn->insertTile->addBindValue((int)tile->GetMapType());
+        cn->insertTile->addBindValue(date);
+        if (cn->insertTile->exec()) {
+            cn->insertData->addBindValue(tile->GetImg());
+            cn->insertData->exec();
         }
     }
-    QSqlDatabase::removeDatabase(QString::number(id));
-    lock.unlock();
-    return true;
+    return cn->db.commit();
 }
 QByteArray PureImageCache::GetImageFromCache(MapType::Types type, Point pos, int zoom)
 {
-    lock.lockForRead();
+    QReadLocker locker(&lock);
     QByteArray ar;
+
     if (gtilecache.isEmpty() | gtilecache.isNull()) {
         return ar;
     }
-    QString dir  = gtilecache;
-    Mcounter.lock();
-    qlonglong id = ++ConnCounter;
-    Mcounter.unlock();
 #ifdef DEBUG_PUREIMAGECACHE
-    qDebug() << "Cache dir=" << dir << " Try to GET:" << pos.X() + "," + pos.Y();
+    qDebug() << "Cache dir=" << gtilecache << " Try to GET:" << pos.X() + "," + pos.Y();
 #endif // DEBUG_PUREIMAGECACHE
 
-    {
-        QString db = dir + "Data.qmdb";
-        {
-            QSqlDatabase cn;
-
-            cn = QSqlDatabase::addDatabase("QSQLITE", QString::number(id));
-
-            cn.setDatabaseName(db);
-            cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-            if (cn.open()) {
-                {
-                    QSqlQuery query(cn);
-                    query.exec(QString("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE X=%1 AND Y=%2 AND Zoom=%3 AND Type=%4)").arg(pos.X()).arg(pos.Y()).arg(zoom).arg((int)type));
-                    query.next();
-                    if (query.isValid()) {
-                        ar = query.value(0).toByteArray();
-                    }
-                }
-                cn.close();
-            }
+    TileConnection *cn = tileConnection(gtilecache + "Data.qmdb");
+    if (cn) {
+        cn->selectTile->addBindValue(pos.X());
+        cn->selectTile->addBindValue(pos.Y());
+        cn->selectTile->addBindValue(zoom);
+        cn->selectTile->addBindValue((int)type);
+        if (cn->selectTile->exec() && cn->selectTile->next()) {
+            ar = cn->selectTile->value(0).toByteArray();
         }
+        cn->selectTile->finish();
     }
-    QSqlDatabase::removeDatabase(QString::number(id));
-    lock.unlock();
     return ar;
 }
 void PureImageCache::deleteOlderTiles(int const & days)
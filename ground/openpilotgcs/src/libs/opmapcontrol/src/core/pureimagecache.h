@@ -39,6 +39,7 @@
 #include "point.h"
 #include <QVariant>
 #include "pureimage.h"
+#include "cacheitemqueue.h"
 #include <QList>
 #include <QMutex>
 #include <QReadWriteLock>
@@ -48,12 +49,14 @@ public:
     PureImageCache();
     static bool CreateEmptyDB(const QString &file);
     bool PutImageToCache(const QByteArray &tile, const MapType::Types &type, const core::Point &pos, const int &zoom);
+    bool PutImagesToCache(const QList<CacheItemQueue *> &tiles);
     QByteArray GetImageFromCache(MapType::Types type, core::Point pos, int zoom);
     QString GtileCache();
     void setGtileCache(const QString &value);
     static bool ExportMapDataToDB(QString sourceFile, QString destFile);
     void deleteOlderTiles(int const & days);
 private:
+    static void PrepareDB(const QString &file);
     QString gtilecache;
     QMutex Mcounter;
     QReadWriteLock lock;
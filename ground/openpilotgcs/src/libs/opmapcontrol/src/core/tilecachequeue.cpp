@@ -30,39 +30,38 @@
 // #define DEBUG_TILECACHEQUEUE
 
 namespace core {
-TileCacheQueue::TileCacheQueue()
+TileCacheQueue::TileCacheQueue() : stopping(false)
 {}
 TileCacheQueue::~TileCacheQueue()
 {
     // QThread::wait(10000);
 }
 
+/*
+ * Queue a tile to be written to the database by the cache thread,
+ * the caller never waits for the database.
+ */
 void TileCacheQueue::EnqueueCacheTask(CacheItemQueue *task)
 {
 #ifdef DEBUG_TILECACHEQUEUE
-    qDebug() << "DB Do I EnqueueCacheTask" << task->GetPosition().X() << "," << task->GetPosition().Y();
-#endif // DEBUG_TILECACHEQUEUE
-    if (!tileCacheQueue.contains(task)) {
-#ifdef DEBUG_TILECACHEQUEUE
-        qDebug() << "EnqueueCacheTask" << task->GetPosition().X() << "," << task->GetPosition().Y();
+    qDebug() << "EnqueueCacheTask" << task->GetPosition().X() << "," << task->GetPosition().Y();
 #endif // DEBUG_TILECACHEQUEUE
-        mutex.lock();
-        tileCacheQueue.enqueue(task);
-        mutex.unlock();
-        if (this->isRunning()) {
+    QMutexLocker locker(&mutex);
+
+    tileCacheQueue.enqueue(task);
+    if (this->isRunning() && !stopping) {
 #ifdef DEBUG_TILECACHEQUEUE
-            qDebug() << "Wake Thread";
+        qDebug() << "Wake Thread";
 #endif // DEBUG_TILECACHEQUEUE
-            // this->start(QThread::NormalPriority);
-            // waitmutex.lock();
-            waitc.wakeAll();
-            // waitmutex.unlock();
-        } else {
+        waitc.wakeAll();
+    } else {
 #ifdef DEBUG_TILECACHEQUEUE
-            qDebug() << "Start Thread";
+        qDebug() << "Start Thread";
 #endif // DEBUG_TILECACHEQUEUE
-            this->start(QThread::NormalPriority);
-        }
+        // the thread may still be leaving run()
+        this->wait();
+        stopping = false;
+        this->start(QThread::NormalPriority);
     }
 }
 void TileCacheQueue::run()
@@ -71,39 +70,28 @@ void TileCacheQueue::run()
     qDebug() << "Cache Engine Start";
 #endif // DEBUG_TILECACHEQUEUE
     while (true) {
-        CacheItemQueue *task;
-#ifdef DEBUG_TILECACHEQUEUE
-        qDebug() << "Cache";
-#endif // DEBUG_TILECACHEQUEUE
-        if (tileCacheQueue.count() > 0) {
-            mutex.lock();
-            task = tileCacheQueue.dequeue();
-            mutex.unlock();
-#ifdef DEBUG_TILECACHEQUEUE
-            qDebug() << "Cache engine Put:" << task->GetPosition().X() << "," << task->GetPosition().Y();
-#endif // DEBUG_TILECACHEQUEUE
-            Cache::Instance()->ImageCache.PutImageToCache(task->GetImg(), task->GetMapType(), task->GetPosition(), task->GetZoom());
-            usleep(44);
-            delete task;
-        } else {
-            qDebug() << "Cache engine BEGIN WAIT";
-            waitmutex.lock();
-            int tout = 4000;
-            if (!waitc.wait(&waitmutex, tout)) {
-                waitmutex.unlock();
-#ifdef DEBUG_TILECACHEQUEUE
-                qDebug() << "Cache Engine TimeOut";
-#endif // DEBUG_TILECACHEQUEUE
-                mutex.lock();
-                if (tileCacheQueue.count() == 0) {
-                    mutex.unlock();
-                    break;
-                }
+        QList<CacheItemQueue *> tasks;
+        mutex.lock();
+        while (!tileCacheQueue.isEmpty() && tasks.count() < BATCH_SIZE) {
+            tasks << tileCacheQueue.dequeue();
+        }
+        if (tasks.isEmpty()) {
+            // Stop once nothing was queued for a while
+            if (!waitc.wait(&mutex, 4000) && tileCacheQueue.isEmpty()) {
+                stopping = true;
                 mutex.unlock();
+                break;
             }
-            qDebug() << "Cache Engine DID NOT TimeOut";
-            waitmutex.unlock();
+            mutex.unlock();
+            continue;
         }
+        mutex.unlock();
+#ifdef DEBUG_TILECACHEQUEUE
+        qDebug() << "Cache engine Put:" << tasks.count();
+#endif // DEBUG_TILECACHEQUEUE
+        // Tiles queued meanwhile go in the next transaction
+        Cache::Instance()->ImageCache.PutImagesToCache(tasks);
+        qDeleteAll(tasks);
     }
 #ifdef DEBUG_TILECACHEQUEUE
     qDebug() << "Cache Engine Stopped";
@@ -49,10 +49,14 @@ public:
 protected:
     QQueue<CacheItemQueue *> tileCacheQueue;
 private:
+    // Tiles written per transaction
+    static const int BATCH_SIZE = 64;
+
     void run();
     QMutex mutex;
-    QMutex waitmutex;
     QWaitCondition waitc;
+    // Set by the thread when it leaves, under mutex
+    bool stopping;
 };
 }
 #endif // TILECACHEQUEUE_H
@@ -0,0 +1,162 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tilepack.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "tilepack.h"
+
+#include <QtEndian>
+#include <QVariant>
+#include <QVector>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+
+namespace core {
+TilePack::TilePack() : data(0), count(0)
+{}
+TilePack::~TilePack()
+{
+    Close();
+}
+bool TilePack::Open(const QString &fileName)
+{
+    Close();
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    qint64 size = file.size();
+    const uchar *map = size >= HEADER_SIZE ? file.map(0, size) : 0;
+    if (map == 0 || qFromLittleEndian<quint32>(map) != FILE_MAGIC || qFromLittleEndian<quint32>(map + 4) != FILE_VERSION) {
+        file.close();
+        return false;
+    }
+    quint64 entries = qFromLittleEndian<quint64>(map + 8);
+    if (entries > (quint64)(size - HEADER_SIZE) / ENTRY_SIZE) {
+        file.close();
+        return false;
+    }
+    data  = map;
+    count = entries;
+    return true;
+}
+void TilePack::Close()
+{
+    // closing the file unmaps it
+    file.close();
+    data  = 0;
+    count = 0;
+}
+QByteArray TilePack::GetImage(const MapType::Types &type, const Point &pos, const int &zoom) const
+{
+    const quint32 key[4] = { (quint32)type, (quint32)zoom, (quint32)pos.X(), (quint32)pos.Y() };
+    quint64 first = 0;
+    quint64 last  = count;
+
+    while (first < last) {
+        quint64 middle = first + (last - first) / 2;
+        const uchar *entry = data + HEADER_SIZE + middle * ENTRY_SIZE;
+        int cmp = 0;
+        for (int i = 0; i < 4 && cmp == 0; ++i) {
+            quint32 value = qFromLittleEndian<quint32>(entry + 4 * i);
+            cmp = value < key[i] ? -1 : (value > key[i] ? 1 : 0);
+        }
+        if (cmp < 0) {
+            first = middle + 1;
+        } else if (cmp > 0) {
+            last = middle;
+        } else {
+            quint64 offset = qFromLittleEndian<quint64>(entry + 16);
+            quint64 length = qFromLittleEndian<quint64>(entry + 24);
+            if (offset + length > (quint64)file.size()) {
+                break;
+            }
+            return QByteArray((const char *)data + offset, (int)length);
+        }
+    }
+    return QByteArray();
+}
+/**
+ * Write every tile of a tile cache database into a pack. A single pass is made over
+ * the database, in index order, so it is suitable for caches of a whole area ripped
+ * beforehand.
+ */
+bool TilePack::Create(const QString &sourceDB, const QString &packFile)
+{
+    bool ret = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "tilepack");
+        db.setDatabaseName(sourceDB);
+        // written aside, the pack may be open and mapped
+        QFile out(packFile + ".part");
+        if (db.open() && out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            QSqlQuery query(db);
+            query.setForwardOnly(true);
+            quint64 total = 0;
+            if (query.exec("SELECT COUNT(*) FROM Tiles JOIN TilesData ON Tiles.id = TilesData.id") && query.next()) {
+                total = query.value(0).toULongLong();
+            }
+            query.finish();
+
+            // images are written after the room left for the index, which is filled in last
+            QVector<uchar> index(total * ENTRY_SIZE);
+            quint64 offset = HEADER_SIZE + total * ENTRY_SIZE;
+            quint64 n = 0;
+            ret = out.seek(offset) && query.exec("SELECT Tiles.Type, Tiles.Zoom, Tiles.X, Tiles.Y, TilesData.Tile FROM Tiles "
+                                                 "JOIN TilesData ON Tiles.id = TilesData.id ORDER BY Tiles.Type, Tiles.Zoom, Tiles.X, Tiles.Y");
+            while (ret && n < total && query.next()) {
+                QByteArray image = query.value(4).toByteArray();
+                uchar *entry     = index.data() + n * ENTRY_SIZE;
+                for (int i = 0; i < 4; ++i) {
+                    qToLittleEndian<quint32>(query.value(i).toUInt(), entry + 4 * i);
+                }
+                qToLittleEndian<quint64>(offset, entry + 16);
+                qToLittleEndian<quint64>(image.size(), entry + 24);
+                ret     = out.write(image) == image.size();
+                offset += image.size();
+                ++n;
+            }
+            query.finish();
+
+            uchar header[HEADER_SIZE];
+            qToLittleEndian<quint32>(FILE_MAGIC, header);
+            qToLittleEndian<quint32>(FILE_VERSION, header + 4);
+            qToLittleEndian<quint64>(n, header + 8);
+            ret = ret && out.seek(0) && out.write((const char *)header, HEADER_SIZE) == HEADER_SIZE
+                  && out.write((const char *)index.constData(), n * ENTRY_SIZE) == (qint64)(n * ENTRY_SIZE);
+            out.close();
+            if (ret) {
+                QFile::remove(packFile);
+                ret = out.rename(packFile);
+            }
+            if (!ret) {
+                out.remove();
+            }
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase("tilepack");
+    return ret;
+}
+}
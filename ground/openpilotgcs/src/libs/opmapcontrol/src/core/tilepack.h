@@ -0,0 +1,77 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tilepack.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TILEPACK_H
+#define TILEPACK_H
+
+#include "maptype.h"
+#include "point.h"
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+namespace core {
+/**
+ * Read only pack of map tiles, a single file holding a whole area for use without network:
+ *  - a header: magic, version and number of tiles (little endian quint32, quint32, quint64)
+ *  - the index, one entry per tile sorted by type, zoom, x and y: those as quint32 then the
+ *    offset and size of the image in the file as quint64
+ *  - the tile images, contiguous
+ *
+ * The file is memory mapped and a lookup is a binary search of the index in place, so
+ * opening a pack of any size is immediate. Found images are copied out of the mapping
+ * as they end up in the memory cache, which can outlive the pack.
+ */
+class TilePack {
+public:
+    TilePack();
+    ~TilePack();
+
+    bool Open(const QString &fileName);
+    void Close();
+    bool IsOpen() const
+    {
+        return data != 0;
+    }
+    QByteArray GetImage(const MapType::Types &type, const Point &pos, const int &zoom) const;
+
+    static bool Create(const QString &sourceDB, const QString &packFile);
+
+private:
+    static const quint32 FILE_MAGIC   = 0x4b50544f; // "OTPK"
+    static const quint32 FILE_VERSION = 1;
+    static const int HEADER_SIZE = 16;
+    static const int ENTRY_SIZE  = 32;
+
+    QFile file;
+    const uchar *data;
+    quint64 count;
+
+    TilePack(TilePack const &);
+    TilePack & operator=(TilePack const &);
+};
+}
+#endif // TILEPACK_H
@@ -25,6 +25,9 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "core.h"
+#include "../core/pureimage.h"
+
+#include <QtAlgorithms>
 
 #ifdef DEBUG_CORE
 qlonglong internals::Core::debugcounter = 0;
@@ -32,9 +35,28 @@ qlonglong internals::Core::debugcounter = 0;
 
 using namespace projections;
 
+namespace {
+// orders tasks by their distance from the center tile
+struct CloserTo {
+    core::Point center;
+    CloserTo(const core::Point &point) : center(point) {}
+    int distance(const internals::LoadTask &task) const
+    {
+        int dx = task.Pos.X() - center.X();
+        int dy = task.Pos.Y() - center.Y();
+
+        return dx * dx + dy * dy;
+    }
+    bool operator()(const internals::LoadTask &lhs, const internals::LoadTask &rhs) const
+    {
+        return distance(lhs) < distance(rhs);
+    }
+};
+}
+
 namespace internals {
 Core::Core() : MouseWheelZooming(false), currentPosition(0, 0), currentPositionPixel(0, 0), LastLocationInBounds(-1, -1), sizeOfMapArea(0, 0)
-    , minOfTiles(0, 0), maxOfTiles(0, 0), zoom(0), isDragging(false), TooltipTextPadding(10, 10), loaderLimit(5), maxzoom(21), runningThreads(0), started(false)
+    , minOfTiles(0, 0), maxOfTiles(0, 0), prefetchZoom(-1), zoom(0), isDragging(false), TooltipTextPadding(10, 10), loaderLimit(5), parallelLoads(5), maxzoom(21), runningThreads(0), started(false)
 {
     mousewheelzoomtype = MouseWheelZoomType::MousePositionAndCenter;
     SetProjection(new MercatorProjection());
@@ -94,7 +116,19 @@ void Core::run()
 #ifdef DEBUG_CORE
                 qDebug() << "task as value, begining get" << " ID=" << debug;;
 #endif // DEBUG_CORE
-                {
+                if (task.Zoom != zoom) {
+                    // prefetched (or out of date) tile, only fill the caches
+                    QVector<MapType::Types> layers = OPMaps::Instance()->GetAllLayersOfType(GetMapType());
+
+                    foreach(MapType::Types tl, layers) {
+                        if (tl == MapType::PergoTurkeyMap) {
+                            Size max = Projection()->GetTileMatrixMaxXY(task.Zoom);
+                            OPMaps::Instance()->GetImageFrom(tl, Point(task.Pos.X(), max.Height() - task.Pos.Y()), task.Zoom);
+                        } else {
+                            OPMaps::Instance()->GetImageFrom(tl, task.Pos, task.Zoom);
+                        }
+                    }
+                } else {
                     Tile *m = Matrix.TileAt(task.Pos);
 
                     if (m == 0 || m->Overlays.count() == 0) {
@@ -208,6 +242,8 @@ diagnostics Core::GetDiagnostics()
     diag = OPMaps::Instance()->GetDiagnostics();
     diag.runningThreads = runningThreads;
     MrunningThreads.unlock();
+    diag.tilesFromPixmapCache = PureImageProxy::CacheHits();
+    diag.tilesDecoded = PureImageProxy::CacheMisses();
     return diag;
 }
 
@@ -447,6 +483,7 @@ void Core::ReloadMap()
         MtileLoadQueue.lock();
         {
             tileLoadQueue.clear();
+            prefetchList.clear();
         }
         MtileLoadQueue.unlock();
         MtileToload.lock();
@@ -586,8 +623,107 @@ void Core::UpdateBounds()
         }
     }
     MtileDrawingList.unlock();
+    UpdatePrefetch();
+    ScheduleTasks();
     UpdateGroundResolution();
 }
+/**
+ * Order the load queue for the current view: visible tiles closest to the center
+ * first, then the prefetched ones. Tasks for tiles which went out of view (or out
+ * of the prefetch area) are cancelled.
+ */
+void Core::ScheduleTasks()
+{
+    MtileDrawingList.lock();
+    MtileLoadQueue.lock();
+    QList<LoadTask> visible;
+    QList<LoadTask> prefetch;
+    int cancelled = 0;
+    while (!tileLoadQueue.isEmpty()) {
+        LoadTask task = tileLoadQueue.dequeue();
+        if (task.Zoom == zoom && tileDrawingList.contains(task.Pos)) {
+            visible.append(task);
+        } else if (task.Zoom == prefetchZoom && prefetchList.contains(task.Pos)) {
+            prefetch.append(task);
+        } else {
+            ++cancelled;
+        }
+    }
+    qStableSort(visible.begin(), visible.end(), CloserTo(centerTileXYLocation));
+    tileLoadQueue.append(visible);
+    tileLoadQueue.append(prefetch);
+    MtileLoadQueue.unlock();
+    MtileDrawingList.unlock();
+
+    MtileToload.lock();
+    tilesToload -= cancelled;
+    MtileToload.unlock();
+}
+void Core::SetPrefetchPosition(PointLatLng const & value)
+{
+    prefetchPosition = value;
+    if (started) {
+        UpdatePrefetch();
+        ScheduleTasks();
+    }
+}
+/**
+ * Queue the tiles of the next zoom level around the prefetch position, unless they
+ * already were for the current position and zoom.
+ */
+void Core::UpdatePrefetch()
+{
+    QList<Point> list;
+    int nextZoom = zoom + 1;
+
+    if (!prefetchPosition.IsEmpty() && nextZoom <= maxzoom) {
+        Point center = Projection()->FromPixelToTileXY(Projection()->FromLatLngToPixel(prefetchPosition, nextZoom));
+        Size min     = Projection()->GetTileMatrixMinXY(nextZoom);
+        Size max     = Projection()->GetTileMatrixMaxXY(nextZoom);
+        for (int i = -1; i <= 1; i++) {
+            for (int j = -1; j <= 1; j++) {
+                Point p(center.X() + i, center.Y() + j);
+                if (p.X() >= min.Width() && p.Y() >= min.Height() && p.X() <= max.Width() && p.Y() <= max.Height()) {
+                    list.append(p);
+                }
+            }
+        }
+    }
+
+    MtileLoadQueue.lock();
+    if (nextZoom != prefetchZoom || list != prefetchList) {
+        prefetchZoom = nextZoom;
+        prefetchList = list;
+        foreach(Point p, prefetchList) {
+            LoadTask task = LoadTask(p, prefetchZoom);
+            if (!tileLoadQueue.contains(task)) {
+                MtileToload.lock();
+                ++tilesToload;
+                MtileToload.unlock();
+                tileLoadQueue.enqueue(task);
+                ProcessLoadTaskCallback.start(this);
+            }
+        }
+    }
+    MtileLoadQueue.unlock();
+}
+/**
+ * Number of tiles fetched at the same time, each loader thread keeps its own
+ * HTTP connections alive between tiles. Lowering it waits for the loads in progress.
+ */
+void Core::SetMaxParallelLoads(int const & value)
+{
+    if (value < 1 || value == parallelLoads) {
+        return;
+    }
+    if (value > parallelLoads) {
+        loaderLimit.release(value - parallelLoads);
+    } else {
+        loaderLimit.acquire(parallelLoads - value);
+    }
+    parallelLoads = value;
+    ProcessLoadTaskCallback.setMaxThreadCount(qMax(10, 2 * value));
+}
 void Core::FindTilesAround(QList<Point> &list)
 {
     list.clear();;
@@ -252,6 +252,16 @@ public:
 
     void UpdateBounds();
 
+    // tiles of the next zoom level around value are fetched into the caches
+    // once the visible ones are loaded, an empty position disables it
+    void SetPrefetchPosition(PointLatLng const & value);
+
+    int MaxParallelLoads() const
+    {
+        return parallelLoads;
+    }
+    void SetMaxParallelLoads(int const & value);
+
     MapType::Types GetMapType()
     {
         return mapType;
@@ -319,6 +329,8 @@ signals:
 private:
 
     void keepInBounds();
+    void UpdatePrefetch();
+    void ScheduleTasks();
     PointLatLng currentPosition;
     core::Point currentPositionPixel;
     core::Point renderOffset;
@@ -345,6 +357,10 @@ private:
 
     QQueue<LoadTask> tileLoadQueue;
 
+    PointLatLng prefetchPosition;
+    QList<core::Point> prefetchList;
+    int prefetchZoom;
+
     int zoom;
 
     PureProjection *projection;
@@ -365,6 +381,7 @@ private:
     MapType::Types mapType;
 
     QSemaphore loaderLimit;
+    int parallelLoads;
 
     QThreadPool ProcessLoadTaskCallback;
     QMutex MtileToload;
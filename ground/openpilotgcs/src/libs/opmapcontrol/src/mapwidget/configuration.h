@@ -184,6 +184,19 @@ public:
     {
         core::PureImageCache::ExportMapDataToDB(sourceDB, destDB);
     }
+
+    /**
+     * @brief  Writes all the tiles of a DB into a tile pack. The *.tilepack files of the
+     *         cache location are read before the DB, when it is set.
+     *
+     * @param sourceDB the source DB
+     * @param packFile the tile pack, replaced if it exists
+     * @return true if the pack was written
+     */
+    bool ExportMapDataToPack(QString const & sourceDB, QString const & packFile) const
+    {
+        return core::TilePack::Create(sourceDB, packFile);
+    }
     /**
      * @brief Returns the location for the SQLite Database used for caching and the geocoding cache files
      *
@@ -296,7 +296,7 @@ void MapGraphicItem::wheelEvent(QGraphicsSceneWheelEvent *event)
 }
 void MapGraphicItem::DrawMap2D(QPainter *painter)
 {
-    painter->drawImage(this->boundingRect(), dragons.toImage());
+    painter->drawPixmap(this->boundingRect(), dragons, dragons.rect());
     if (!lastimage.isNull()) {
         painter->drawImage(core->GetrenderOffset().X() - lastimagepoint.X(), core->GetrenderOffset().Y() - lastimagepoint.Y(), lastimage);
     }
@@ -323,7 +323,7 @@ void MapGraphicItem::DrawMap2D(QPainter *painter)
                                         found = true;
                                     }
                                     {
-                                        painter->drawPixmap(core->tileRect.X(), core->tileRect.Y(), core->tileRect.Width(), core->tileRect.Height(), PureImageProxy::FromStream(img));
+                                        painter->drawPixmap(core->tileRect.X(), core->tileRect.Y(), core->tileRect.Width(), core->tileRect.Height(), PureImageProxy::FromCache(img));
                                     }
                                 }
                             }
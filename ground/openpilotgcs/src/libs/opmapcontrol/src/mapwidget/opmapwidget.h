@@ -292,6 +292,23 @@ public:
     {
         map->core->SetMouseWheelZoomType(value);
     }
+    int MaxParallelLoads()
+    {
+        return map->core->MaxParallelLoads();
+    }
+    void SetMaxParallelLoads(int const & value)
+    {
+        map->core->SetMaxParallelLoads(value);
+    }
+    /**
+     * @brief Tiles of the next zoom level around value are fetched into the caches
+     *
+     * @param value the position, usually the UAV's, an empty one disables it
+     */
+    void SetPrefetchPosition(internals::PointLatLng const & value)
+    {
+        map->core->SetPrefetchPosition(value);
+    }
     // void SetMouseWheelZoomTypeByStr(const QString &value){map->core->SetMouseWheelZoomType(internals::MouseWheelZoomType::TypeByStr(value));}
     // QString GetMouseWheelZoomTypeStr(){return map->GetMouseWheelZoomTypeStr();}
 
@@ -3,7 +3,7 @@
  *
  * @file       trailitem.cpp
  * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2012.
- * @brief      A graphicsItem representing a trail point
+ * @brief      A graphicsItem representing a UAV trail
  * @see        The GNU Public License (GPL) Version 3
  * @defgroup   OPMapWidget
  * @{
@@ -26,13 +26,17 @@
  */
 #include "trailitem.h"
 #include <QDateTime>
+#include <QGraphicsSceneHoverEvent>
+#include <QStack>
 namespace mapcontrol {
-TrailItem::TrailItem(internals::PointLatLng const & coord, int const & altitude, QBrush color, MapGraphicItem *map) : QGraphicsItem(map), coord(coord), m_brush(color), m_map(map)
+TrailItem::TrailItem(QColor pointColor, QColor lineColor, MapGraphicItem *map) : QGraphicsItem(map), m_map(map), m_pointBrush(pointColor),
+    m_showPoints(true), m_showLine(true), m_points(MAX_POINTS), m_unsimplified(0)
 {
-    QDateTime time    = QDateTime::currentDateTime();
-    QString coord_str = " " + QString::number(coord.Lat(), 'f', 6) + "   " + QString::number(coord.Lng(), 'f', 6);
-
-    setToolTip(QString(tr("Position:") + "%1\n" + tr("Altitude:") + "%2\n" + tr("Time:") + "%3").arg(coord_str).arg(QString::number(altitude)).arg(time.toString()));
+    m_linePen.setColor(lineColor);
+    m_linePen.setWidth(1);
+    setAcceptHoverEvents(true);
+    connect(map, SIGNAL(childRefreshPosition()), this, SLOT(RefreshPos()));
+    connect(map, SIGNAL(zoomChanged(double, double, double)), this, SLOT(zoomChangedSlot()));
 }
 
 void TrailItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
@@ -40,22 +44,187 @@ void TrailItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
     Q_UNUSED(option);
     Q_UNUSED(widget);
 
-    painter->setBrush(m_brush);
-    painter->drawEllipse(-2, -2, 4, 4);
+    if (m_showLine) {
+        painter->setPen(m_linePen);
+        painter->setBrush(Qt::NoBrush);
+        painter->drawPath(m_path);
+    }
+    if (m_showPoints) {
+        painter->setPen(Qt::black);
+        painter->setBrush(m_pointBrush);
+        for (int i = 0; i < m_path.elementCount(); ++i) {
+            QPainterPath::Element e = m_path.elementAt(i);
+            painter->drawEllipse(QRectF(e.x - 2, e.y - 2, 4, 4));
+        }
+    }
 }
 QRectF TrailItem::boundingRect() const
 {
-    return QRectF(-2, -2, 4, 4);
+    return m_path.boundingRect().adjusted(-3, -3, 3, 3);
 }
 
-
 int TrailItem::type() const
 {
     return Type;
 }
 
-void TrailItem::setPosSLOT()
+void TrailItem::AddPoint(internals::PointLatLng const & coord, int const & altitude)
+{
+    TrailPoint point;
+
+    point.coord    = coord;
+    point.altitude = altitude;
+    point.time     = QDateTime::currentMSecsSinceEpoch();
+    m_points.append(point);
+
+    if (m_points.count() == 1) {
+        m_origin = coord;
+        RefreshPos();
+    }
+    if (++m_unsimplified > SIMPLIFY_INTERVAL) {
+        simplify();
+        return;
+    }
+    prepareGeometryChange();
+    QPointF p = toItem(coord);
+    if (m_path.elementCount() == 0) {
+        m_path.moveTo(p);
+    } else {
+        m_path.lineTo(p);
+    }
+    m_vertices.append(m_points.lastIndex());
+}
+
+void TrailItem::Clear()
+{
+    prepareGeometryChange();
+    m_points.clear();
+    m_path = QPainterPath();
+    m_vertices.clear();
+    m_unsimplified = 0;
+}
+
+void TrailItem::SetShowPoints(bool const & value)
+{
+    m_showPoints = value;
+    update();
+}
+
+void TrailItem::SetShowLine(bool const & value)
+{
+    m_showLine = value;
+    update();
+}
+
+void TrailItem::hoverMoveEvent(QGraphicsSceneHoverEvent *event)
+{
+    // tool tip of the closest vertex
+    int closest = -1;
+    qreal best  = 16;
+
+    for (int i = 0; i < m_vertices.count() && i < m_path.elementCount(); ++i) {
+        QPainterPath::Element e = m_path.elementAt(i);
+        qreal dx = e.x - event->pos().x();
+        qreal dy = e.y - event->pos().y();
+        if (dx * dx + dy * dy < best && m_points.containsIndex(m_vertices.at(i))) {
+            best    = dx * dx + dy * dy;
+            closest = m_vertices.at(i);
+        }
+    }
+    if (closest < 0) {
+        setToolTip(QString());
+        return;
+    }
+    const TrailPoint &point = m_points.at(closest);
+    QString coord_str = " " + QString::number(point.coord.Lat(), 'f', 6) + "   " + QString::number(point.coord.Lng(), 'f', 6);
+    setToolTip(QString(tr("Position:") + "%1\n" + tr("Altitude:") + "%2\n" + tr("Time:") + "%3").arg(coord_str).arg(QString::number(point.altitude))
+               .arg(QDateTime::fromMSecsSinceEpoch(point.time).toString()));
+}
+
+QPointF TrailItem::toItem(internals::PointLatLng const & coord)
+{
+    core::Point p = m_map->FromLatLngToLocal(coord);
+    core::Point o = m_map->FromLatLngToLocal(m_origin);
+
+    return QPointF(p.X() - o.X(), p.Y() - o.Y());
+}
+
+/**
+ * Rebuild the path from the ring buffer, keeping only the points which are further
+ * than a pixel from the line joining their neighbours.
+ */
+void TrailItem::simplify()
+{
+    prepareGeometryChange();
+    m_path = QPainterPath();
+    m_vertices.clear();
+    m_unsimplified = 0;
+    if (m_points.isEmpty()) {
+        return;
+    }
+
+    int first = m_points.firstIndex();
+    int count = m_points.count();
+    QVector<QPointF> points(count);
+    for (int i = 0; i < count; ++i) {
+        points[i] = toItem(m_points.at(first + i).coord);
+    }
+
+    QVector<bool> keep(count, false);
+    keep[0] = true;
+    keep[count - 1] = true;
+    QStack<QPair<int, int> > ranges;
+    ranges.push(qMakePair(0, count - 1));
+    while (!ranges.isEmpty()) {
+        QPair<int, int> range = ranges.pop();
+        QPointF a  = points.at(range.first);
+        QPointF ab = points.at(range.second) - a;
+        qreal length2 = ab.x() * ab.x() + ab.y() * ab.y();
+        int farthest  = -1;
+        qreal best    = 1.0;
+        for (int i = range.first + 1; i < range.second; ++i) {
+            QPointF ap = points.at(i) - a;
+            qreal d2;
+            if (length2 > 0) {
+                qreal cross = ab.x() * ap.y() - ab.y() * ap.x();
+                d2 = cross * cross / length2;
+            } else {
+                d2 = ap.x() * ap.x() + ap.y() * ap.y();
+            }
+            if (d2 > best) {
+                best     = d2;
+                farthest = i;
+            }
+        }
+        if (farthest > 0) {
+            keep[farthest] = true;
+            ranges.push(qMakePair(range.first, farthest));
+            ranges.push(qMakePair(farthest, range.second));
+        }
+    }
+
+    for (int i = 0; i < count; ++i) {
+        if (keep.at(i)) {
+            if (m_vertices.isEmpty()) {
+                m_path.moveTo(points.at(i));
+            } else {
+                m_path.lineTo(points.at(i));
+            }
+            m_vertices.append(first + i);
+        }
+    }
+}
+
+void TrailItem::RefreshPos()
+{
+    core::Point o = m_map->FromLatLngToLocal(m_origin);
+
+    setPos(o.X(), o.Y());
+}
+
+void TrailItem::zoomChangedSlot()
 {
-    setPos(m_map->FromLatLngToLocal(this->coord).X(), m_map->FromLatLngToLocal(this->coord).Y());
+    RefreshPos();
+    simplify();
 }
 }
@@ -3,7 +3,7 @@
  *
  * @file       trailitem.h
  * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2012.
- * @brief      A graphicsItem representing a WayPoint
+ * @brief      A graphicsItem representing a UAV trail
  * @see        The GNU Public License (GPL) Version 3
  * @defgroup   OPMapWidget
  * @{
@@ -29,28 +29,67 @@
 
 #include <QGraphicsItem>
 #include <QPainter>
-#include <QLabel>
+#include <QPainterPath>
+#include <QContiguousCache>
+#include <QPointer>
+#include <QVector>
 #include "../internals/pointlatlng.h"
 #include <QObject>
 #include "mapgraphicitem.h"
 
 namespace mapcontrol {
+/**
+ * A whole trail as a single item: the last positions are kept in a ring buffer and
+ * drawn as one path, simplified (Douglas-Peucker) to a pixel at the current zoom.
+ * The points, if shown, are drawn at the vertices of that path.
+ */
 class TrailItem : public QObject, public QGraphicsItem {
     Q_OBJECT Q_INTERFACES(QGraphicsItem)
 public:
     enum { Type = UserType + 3 };
-    TrailItem(internals::PointLatLng const & coord, int const & altitude, QBrush color, MapGraphicItem *map);
+    TrailItem(QColor pointColor, QColor lineColor, MapGraphicItem *map);
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
                QWidget *widget);
     QRectF boundingRect() const;
     int type() const;
-    internals::PointLatLng coord;
+
+    void AddPoint(internals::PointLatLng const & coord, int const & altitude);
+    void Clear();
+    void SetShowPoints(bool const & value);
+    void SetShowLine(bool const & value);
+
+protected:
+    void hoverMoveEvent(QGraphicsSceneHoverEvent *event);
+
 private:
-    QBrush m_brush;
+    typedef struct {
+        internals::PointLatLng coord;
+        int    altitude;
+        qint64 time;
+    } TrailPoint;
+
+    static const int MAX_POINTS = 20000;
+    // new points appended as is before the path is simplified again
+    static const int SIMPLIFY_INTERVAL = 100;
+
     MapGraphicItem *m_map;
+    QBrush m_pointBrush;
+    QPen m_linePen;
+    bool m_showPoints;
+    bool m_showLine;
+    QContiguousCache<TrailPoint> m_points;
+    // path and vertices are relative to the origin, so moving the map only moves the item
+    internals::PointLatLng m_origin;
+    QPainterPath m_path;
+    QVector<int> m_vertices;
+    int m_unsimplified;
+
+    QPointF toItem(internals::PointLatLng const & coord);
+    void simplify();
+
 public slots:
-    void setPosSLOT();
-signals:
+    void RefreshPos();
+    void zoomChangedSlot();
 };
 }
 #endif // TRAILITEM_H
@@ -91,6 +91,8 @@ bool SDLGamepad::init()
 void SDLGamepad::run()
 {
     while (loop) {
+        // one refresh of the SDL state serves both the axes and the buttons
+        SDL_JoystickUpdate();
         updateAxes();
         updateButtons();
         msleep(tick);
@@ -142,7 +144,6 @@ void SDLGamepad::updateAxes()
 {
     if (priv->gamepad) {
         QListInt16 values;
-        SDL_JoystickUpdate();
 
         for (qint8 i = 0; i < axes; i++) {
             qint16 value = SDL_JoystickGetAxis(priv->gamepad, i);
@@ -162,8 +163,6 @@ void SDLGamepad::updateAxes()
 void SDLGamepad::updateButtons()
 {
     if (priv->gamepad) {
-        SDL_JoystickUpdate();
-
         for (qint8 i = 0; i < buttons; i++) {
             qint16 state = SDL_JoystickGetButton(priv->gamepad, i);
 
@@ -161,16 +161,73 @@ int CoordinateConversions::NED2LLA_HomeECEF(double BaseECEFm[3], double NED[3],
  */
 int CoordinateConversions::NED2LLA_HomeLLA(double homeLLA[3], double NED[3], double position[3])
 {
-    double T[3];
+    BaseFrame base;
 
-    T[0] = homeLLA[2] + 6.378137E6f * M_PI / 180.0;
-    T[1] = cosf(homeLLA[0] * M_PI / 180.0) * (homeLLA[2] + 6.378137E6f) * M_PI / 180.0;
-    T[2] = -1.0f;
+    BaseFrameFromLLA(homeLLA, base);
+    return NED2LLA_BaseFrame(base, NED, position);
+}
+
+/**
+ * Prepare the local NED frame at a base location, for the conversions
+ * through LLA2BaseFrame() and NED2LLA_BaseFrame()
+ * @param[in] LLA latitude, longitude (in deg) and altitude (in m) of the base
+ * @param[out] base the frame
+ */
+void CoordinateConversions::BaseFrameFromLLA(double LLA[3], BaseFrame &base)
+{
+    const double a  = 6378137.0; // Equatorial Radius
+    const double e  = 8.1819190842622e-2; // Eccentricity
+    const double sinLat = sin(DEG2RAD * LLA[0]);
+    const double w  = 1.0 - e * e * sinLat * sinLat;
+    const double N  = a / sqrt(w); // prime vertical radius of curvature
+    const double M  = N * (1.0 - e * e) / w; // meridian radius of curvature
+
+    for (int i = 0; i < 3; i++) {
+        base.LLA[i] = LLA[i];
+    }
+    LLA2ECEF(LLA, base.ECEF);
+    RneFromLLA(LLA, base.Rne);
+    base.NED2LLA[0] = RAD2DEG / (M + LLA[2]);
+    base.NED2LLA[1] = RAD2DEG / ((N + LLA[2]) * cos(DEG2RAD * LLA[0]));
+    base.NED2LLA[2] = -1.0;
+}
 
-    position[0] = homeLLA[0] + NED[0] / T[0];
-    position[1] = homeLLA[1] + NED[1] / T[1];
-    position[2] = homeLLA[2] + NED[2] / T[2];
+/**
+ * Express a location in the local NED frame of the base
+ * @param[in] LLA latitude, longitude (in deg) and altitude (in m)
+ * @param[in] base the frame from BaseFrameFromLLA()
+ * @param[out] NED the offset from the base (in m)
+ */
+void CoordinateConversions::LLA2BaseFrame(double LLA[3], const BaseFrame &base, float NED[3])
+{
+    double ECEF[3];
+    float diff[3];
 
+    LLA2ECEF(LLA, ECEF);
+
+    diff[0] = (float)(ECEF[0] - base.ECEF[0]);
+    diff[1] = (float)(ECEF[1] - base.ECEF[1]);
+    diff[2] = (float)(ECEF[2] - base.ECEF[2]);
+
+    NED[0]  = base.Rne[0][0] * diff[0] + base.Rne[0][1] * diff[1] + base.Rne[0][2] * diff[2];
+    NED[1]  = base.Rne[1][0] * diff[0] + base.Rne[1][1] * diff[1] + base.Rne[1][2] * diff[2];
+    NED[2]  = base.Rne[2][0] * diff[0] + base.Rne[2][1] * diff[1] + base.Rne[2][2] * diff[2];
+}
+
+/**
+ * Get the location of a NED offset from the base, on the tangent plane
+ * approximation the map and the simulators use near home
+ * @param[in] base the frame from BaseFrameFromLLA()
+ * @param[in] NED the offset from the base (in m)
+ * @param[out] position latitude, longitude (in deg) and altitude (in m)
+ * @returns
+ *  @arg 0 success
+ */
+int CoordinateConversions::NED2LLA_BaseFrame(const BaseFrame &base, double NED[3], double position[3])
+{
+    for (int i = 0; i < 3; i++) {
+        position[i] = base.LLA[i] + NED[i] * base.NED2LLA[i];
+    }
     return 0;
 }
 
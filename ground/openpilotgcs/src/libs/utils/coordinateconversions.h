@@ -36,6 +36,14 @@
 #include "math.h"
 
 namespace Utils {
+// local NED frame at a base location, prepared once for repeated conversions
+struct BaseFrame {
+    double LLA[3];
+    double ECEF[3];
+    float  Rne[3][3];
+    double NED2LLA[3]; // deg per m North and East, Down to altitude
+};
+
 class QTCREATOR_UTILS_EXPORT CoordinateConversions {
 public:
     CoordinateConversions();
@@ -45,6 +53,9 @@ public:
     void LLA2ECEF(double LLA[3], double ECEF[3]);
     int ECEF2LLA(double ECEF[3], double LLA[3]);
     void LLA2Base(double LLA[3], double BaseECEF[3], float Rne[3][3], float NED[3]);
+    void BaseFrameFromLLA(double LLA[3], BaseFrame &base);
+    void LLA2BaseFrame(double LLA[3], const BaseFrame &base, float NED[3]);
+    int NED2LLA_BaseFrame(const BaseFrame &base, double NED[3], double position[3]);
     void Quaternion2RPY(const float q[4], float rpy[3]);
     void RPY2Quaternion(const float rpy[3], float q[4]);
     void Quaternion2R(const float q[4], float Rbe[3][3]);
@@ -1,11 +1,15 @@
 #include "logfile.h"
 #include <QDebug>
 #include <QtGlobal>
+#include <algorithm>
 
 LogFile::LogFile(QObject *parent) :
     QIODevice(parent),
-    m_lastTimeStamp(0),
-    m_lastPlayed(0),
+    m_mappedData(0),
+    m_mappedSize(0),
+    m_nextPacket(0),
+    m_replayPosition(0),
+    m_pendingBytes(0),
     m_timeOffset(0),
     m_playbackSpeed(1.0),
     m_nextTimeStamp(0),
@@ -54,6 +58,17 @@ void LogFile::close()
     if (m_timer.isActive()) {
         m_timer.stop();
     }
+    m_mutex.lock();
+    m_pending.clear();
+    m_pendingBytes = 0;
+    m_mutex.unlock();
+    m_index.clear();
+    if (m_mappedData && m_fileData.isEmpty()) {
+        m_file.unmap(const_cast<uchar *>(m_mappedData));
+    }
+    m_mappedData = 0;
+    m_mappedSize = 0;
+    m_fileData.clear();
     m_file.close();
     QIODevice::close();
 }
@@ -82,83 +97,178 @@ qint64 LogFile::writeData(const char *data, qint64 dataSize)
 qint64 LogFile::readData(char *data, qint64 maxSize)
 {
     QMutexLocker locker(&m_mutex);
-    qint64 toRead = qMin(maxSize, (qint64)m_dataBuffer.size());
+    qint64 toRead = qMin(maxSize, m_pendingBytes);
+    qint64 done   = 0;
 
-    memcpy(data, m_dataBuffer.data(), toRead);
-    m_dataBuffer.remove(0, toRead);
-    return toRead;
+    // copy straight out of the mapped file, a span is only dropped once it is read completely
+    while (done < toRead) {
+        LogSpan &span = m_pending.head();
+        qint64 len    = qMin(span.size, toRead - done);
+        memcpy(data + done, span.data, len);
+        done      += len;
+        span.data += len;
+        span.size -= len;
+        if (span.size == 0) {
+            m_pending.dequeue();
+        }
+    }
+    m_pendingBytes -= done;
+    return done;
 }
 
 qint64 LogFile::bytesAvailable() const
 {
-    return m_dataBuffer.size();
+    return m_pendingBytes + QIODevice::bytesAvailable();
 }
 
-void LogFile::timerFired()
+/**
+ * Walks through the whole log once and records where each packet is.
+ * The log is a sequence of timestamp (4 bytes), size (8 bytes) and data,
+ * anything after the first implausible packet is ignored.
+ */
+bool LogFile::buildIndex()
 {
-    qint64 dataSize;
+    const qint64 header = sizeof(quint32) + sizeof(qint64);
+    qint64 pos = 0;
 
-    if (m_file.bytesAvailable() > 4) {
-        int time;
-        time = m_myTime.elapsed();
+    m_index.clear();
+    while (m_mappedSize - pos >= header) {
+        LogPacket packet;
+        memcpy(&packet.timeStamp, m_mappedData + pos, sizeof(packet.timeStamp));
+        memcpy(&packet.size, m_mappedData + pos + sizeof(packet.timeStamp), sizeof(packet.size));
+        packet.offset = pos + header;
 
-        // TODO: going back in time will be a problem
-        while ((m_lastPlayed + ((time - m_timeOffset) * m_playbackSpeed) > m_lastTimeStamp)) {
-            m_lastPlayed += ((time - m_timeOffset) * m_playbackSpeed);
-            if (m_file.bytesAvailable() < (qint64)sizeof(dataSize)) {
-                stopReplay();
-                return;
+        if (packet.size < 1 || packet.size > (1024 * 1024)) {
+            qDebug() << "Error: Logfile corrupted! Unlikely packet size: " << packet.size << "\n";
+            break;
+        }
+        if (m_mappedSize - packet.offset < packet.size) {
+            break;
+        }
+        if (!m_index.isEmpty()) {
+            quint32 save = m_index.last().timeStamp;
+            // some validity checks
+            if (packet.timeStamp < save // logfile goes back in time
+                || (packet.timeStamp - save) > (60 * 60 * 1000)) { // gap of more than 60 minutes)
+                qDebug() << "Error: Logfile corrupted! Unlikely timestamp " << packet.timeStamp << " after " << save << "\n";
+                break;
             }
+        }
+        m_index << packet;
+        pos = packet.offset + packet.size;
+    }
+    return !m_index.isEmpty();
+}
 
-            m_file.read((char *)&dataSize, sizeof(dataSize));
-
-            if (dataSize < 1 || dataSize > (1024 * 1024)) {
-                qDebug() << "Error: Logfile corrupted! Unlikely packet size: " << dataSize << "\n";
-                stopReplay();
-                return;
-            }
+static bool packetBefore(const LogFile::LogPacket &packet, quint32 timeStamp)
+{
+    return packet.timeStamp < timeStamp;
+}
 
-            if (m_file.bytesAvailable() < dataSize) {
-                stopReplay();
-                return;
-            }
+/**
+ * Index of the first packet logged at or after timeStamp.
+ */
+int LogFile::findPacket(quint32 timeStamp) const
+{
+    return std::lower_bound(m_index.constBegin(), m_index.constEnd(), timeStamp, packetBefore) - m_index.constBegin();
+}
 
-            m_mutex.lock();
-            m_dataBuffer.append(m_file.read(dataSize));
-            m_mutex.unlock();
+/**
+ * Hands the packets [from, to) to the reader in log order.
+ */
+void LogFile::queuePackets(int from, int to)
+{
+    if (from >= to) {
+        return;
+    }
+    m_mutex.lock();
+    for (int i = from; i < to; i++) {
+        LogSpan span = { (const char *)m_mappedData + m_index[i].offset, m_index[i].size };
+        m_pending.enqueue(span);
+        m_pendingBytes += span.size;
+    }
+    m_mutex.unlock();
 
-            emit readyRead();
+    emit readyRead();
+}
 
-            if (m_file.bytesAvailable() < (qint64)sizeof(m_lastTimeStamp)) {
-                stopReplay();
-                return;
-            }
+void LogFile::timerFired()
+{
+    int time = m_myTime.elapsed();
 
-            int save = m_lastTimeStamp;
-            m_file.read((char *)&m_lastTimeStamp, sizeof(m_lastTimeStamp));
-            // some validity checks
-            if (m_lastTimeStamp < save // logfile goes back in time
-                || (m_lastTimeStamp - save) > (60 * 60 * 1000)) { // gap of more than 60 minutes)
-                qDebug() << "Error: Logfile corrupted! Unlikely timestamp " << m_lastTimeStamp << " after " << save << "\n";
-                stopReplay();
-                return;
-            }
+    m_replayPosition += (time - m_timeOffset) * m_playbackSpeed;
+    m_timeOffset      = time;
 
-            m_timeOffset = time;
-            time = m_myTime.elapsed();
+    if (m_playbackSpeed >= 0) {
+        int next = m_nextPacket;
+        while (next < m_index.count() && m_index[next].timeStamp <= m_replayPosition) {
+            next++;
+        }
+        queuePackets(m_nextPacket, next);
+        m_nextPacket = next;
+        if (m_nextPacket >= m_index.count()) {
+            stopReplay();
         }
     } else {
-        stopReplay();
+        // Going back in time, the packets passed during this tick are still
+        // sent in log order so that the connection sees them in sequence
+        m_replayPosition = qMax(m_replayPosition, (double)replayStart());
+        int next = findPacket((quint32)m_replayPosition);
+        queuePackets(next, m_nextPacket);
+        m_nextPacket = qMin(next, m_nextPacket);
+    }
+}
+
+/**
+ * Jump to a point in log time, the replay continues from there with the current speed.
+ */
+void LogFile::setReplayPosition(quint32 timeStamp)
+{
+    m_mutex.lock();
+    m_pending.clear();
+    m_pendingBytes = 0;
+    m_mutex.unlock();
+
+    m_nextPacket     = findPacket(timeStamp);
+    m_replayPosition = timeStamp;
+    m_timeOffset     = m_myTime.elapsed();
+}
+
+/**
+ * Maps the open log into memory and indexes its packets.
+ */
+bool LogFile::mapLog()
+{
+    if (!m_mappedData) {
+        m_mappedSize = m_file.size();
+        m_mappedData = m_file.map(0, m_mappedSize);
+        if (!m_mappedData) {
+            // not a regular file, keep a copy in memory instead
+            m_fileData   = m_file.readAll();
+            m_mappedData = (const uchar *)m_fileData.constData();
+            m_mappedSize = m_fileData.size();
+        }
     }
+    return buildIndex();
 }
 
 bool LogFile::startReplay()
 {
-    m_dataBuffer.clear();
+    m_mutex.lock();
+    m_pending.clear();
+    m_pendingBytes = 0;
+    m_mutex.unlock();
+
+    if (!mapLog()) {
+        qDebug() << "Error: Logfile" << m_file.fileName() << "holds no packets";
+        stopReplay();
+        return false;
+    }
+
     m_myTime.restart();
-    m_timeOffset = 0;
-    m_lastPlayed = 0;
-    m_file.read((char *)&m_lastTimeStamp, sizeof(m_lastTimeStamp));
+    m_timeOffset     = 0;
+    m_nextPacket     = 0;
+    m_replayPosition = replayStart();
     m_timer.setInterval(10);
     m_timer.start();
     emit replayStarted();
@@ -8,6 +8,8 @@
 #include <QDebug>
 #include <QBuffer>
 #include <QFile>
+#include <QVector>
+#include <QQueue>
 #include "utils_global.h"
 
 class QTCREATOR_UTILS_EXPORT LogFile : public QIODevice {
@@ -40,12 +42,50 @@ public:
         m_nextTimeStamp = nextTimestamp;
     }
 
+    // replay position in log time (ms), valid once the replay is started
+    quint32 replayPosition() const
+    {
+        return (quint32)m_replayPosition;
+    }
+    quint32 replayStart() const
+    {
+        return m_index.isEmpty() ? 0 : m_index.first().timeStamp;
+    }
+    quint32 replayEnd() const
+    {
+        return m_index.isEmpty() ? 0 : m_index.last().timeStamp;
+    }
+
+    // one logged data chunk in the mapped file
+    struct LogPacket {
+        quint32 timeStamp;
+        qint64  offset;
+        qint64  size;
+    };
+
+    // direct access to the packets for offline processing, the file must be open for reading
+    bool mapLog();
+    int packetCount() const
+    {
+        return m_index.count();
+    }
+    const LogPacket &packet(int index) const
+    {
+        return m_index[index];
+    }
+    const char *packetData(int index) const
+    {
+        return (const char *)m_mappedData + m_index[index].offset;
+    }
+
 public slots:
+    // negative speeds play the log backwards
     void setReplaySpeed(double val)
     {
         m_playbackSpeed = val;
         qDebug() << "Playback speed is now" << m_playbackSpeed;
     };
+    void setReplayPosition(quint32 timeStamp);
     void pauseReplay();
     void resumeReplay();
 
@@ -58,12 +98,27 @@ signals:
     void replayFinished();
 
 protected:
-    QByteArray m_dataBuffer;
+    // part of a packet not read by the connection yet
+    struct LogSpan {
+        const char *data;
+        qint64     size;
+    };
+
+    bool buildIndex();
+    int findPacket(quint32 timeStamp) const;
+    void queuePackets(int from, int to);
+
     QTimer m_timer;
     QTime m_myTime;
     QFile m_file;
-    qint32 m_lastTimeStamp;
-    qint32 m_lastPlayed;
+    const uchar *m_mappedData;
+    qint64 m_mappedSize;
+    QByteArray m_fileData;
+    QVector<LogPacket> m_index;
+    int m_nextPacket;
+    double m_replayPosition;
+    QQueue<LogSpan> m_pending;
+    qint64 m_pendingBytes;
     QMutex m_mutex;
 
 
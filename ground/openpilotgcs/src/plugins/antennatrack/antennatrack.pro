@@ -8,6 +8,7 @@ include(../../libs/qwt/qwt.pri)
 HEADERS += antennatrackplugin.h
 HEADERS += gpsparser.h
 HEADERS += telemetryparser.h
+HEADERS += trackpredictor.h
 HEADERS += antennatrackgadget.h
 HEADERS += antennatrackwidget.h
 HEADERS += antennatrackgadgetfactory.h
@@ -16,6 +17,7 @@ HEADERS += antennatrackgadgetoptionspage.h
 SOURCES += antennatrackplugin.cpp
 SOURCES += gpsparser.cpp
 SOURCES += telemetryparser.cpp
+SOURCES += trackpredictor.cpp
 SOURCES += antennatrackgadget.cpp
 SOURCES += antennatrackgadgetfactory.cpp
 SOURCES += antennatrackwidget.cpp
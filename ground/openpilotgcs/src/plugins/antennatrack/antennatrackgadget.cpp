@@ -89,10 +89,12 @@ void AntennaTrackGadget::loadConfiguration(IUAVGadgetConfiguration *config)
         }
     }
     m_widget->dataStreamGroupBox->setHidden(false);
+    m_widget->setPrediction(AntennaTrackConfig->latency(), AntennaTrackConfig->commandRate());
     qDebug() << "Using Telemetry parser";
     parser = new TelemetryParser();
 
     connect(parser, SIGNAL(position(double, double, double)), m_widget, SLOT(setPosition(double, double, double)));
+    connect(parser, SIGNAL(timedPosition(double, double, double, qint64)), m_widget, SLOT(setTimedPosition(double, double, double, qint64)));
     connect(parser, SIGNAL(home(double, double, double)), m_widget, SLOT(setHomePosition(double, double, double)));
     connect(parser, SIGNAL(packet(QString)), m_widget, SLOT(dumpPacket(QString)));
 }
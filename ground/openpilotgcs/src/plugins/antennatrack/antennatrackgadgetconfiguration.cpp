@@ -41,7 +41,9 @@ AntennaTrackGadgetConfiguration::AntennaTrackGadgetConfiguration(QString classId
     m_defaultFlow(QSerialPort::UnknownFlowControl),
     m_defaultParity(QSerialPort::UnknownParity),
     m_defaultStopBits(QSerialPort::UnknownStopBits),
-    m_defaultTimeOut(5000)
+    m_defaultTimeOut(5000),
+    m_latency(200),
+    m_commandRate(20)
 {
     // if a saved configuration exists load it
     if (qSettings != 0) {
@@ -71,6 +73,8 @@ AntennaTrackGadgetConfiguration::AntennaTrackGadgetConfiguration(QString classId
         m_defaultParity   = parity;
         m_defaultStopBits = stopbits;
         m_connectionMode  = conMode;
+        m_latency         = qSettings->value("latency", m_latency).toInt();
+        m_commandRate     = qSettings->value("commandRate", m_commandRate).toInt();
     }
 }
 
@@ -89,6 +93,8 @@ IUAVGadgetConfiguration *AntennaTrackGadgetConfiguration::clone()
     m->m_defaultStopBits = m_defaultStopBits;
     m->m_defaultPort     = m_defaultPort;
     m->m_connectionMode  = m_connectionMode;
+    m->m_latency         = m_latency;
+    m->m_commandRate     = m_commandRate;
     return m;
 }
 
@@ -105,4 +111,6 @@ void AntennaTrackGadgetConfiguration::saveConfig(QSettings *settings) const
     settings->setValue("defaultStopBits", m_defaultStopBits);
     settings->setValue("defaultPort", m_defaultPort);
     settings->setValue("connectionMode", m_connectionMode);
+    settings->setValue("latency", m_latency);
+    settings->setValue("commandRate", m_commandRate);
 }
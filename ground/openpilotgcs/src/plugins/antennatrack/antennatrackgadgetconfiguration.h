@@ -89,6 +89,14 @@ public:
     {
         m_defaultTimeOut = timeout;
     }
+    void setLatency(int latency)
+    {
+        m_latency = latency;
+    }
+    void setCommandRate(int rate)
+    {
+        m_commandRate = rate;
+    }
 
     // get port configuration functions
     QString port()
@@ -119,6 +127,16 @@ public:
     {
         return m_defaultTimeOut;
     }
+    // ms from the fix to the antenna pointing at it, beyond the telemetry lag
+    int latency()
+    {
+        return m_latency;
+    }
+    // tracker commands per second, independent of the telemetry rate
+    int commandRate()
+    {
+        return m_commandRate;
+    }
 
     void saveConfig(QSettings *settings) const;
     IUAVGadgetConfiguration *clone();
@@ -132,6 +150,8 @@ private:
     QSerialPort::Parity m_defaultParity;
     QSerialPort::StopBits m_defaultStopBits;
     long m_defaultTimeOut;
+    int m_latency;
+    int m_commandRate;
 };
 
 #endif // ANTENNATRACKGADGETCONFIGURATION_H
@@ -132,6 +132,10 @@ QWidget *AntennaTrackGadgetOptionsPage::createPage(QWidget *parent)
     // TIMEOUT
     options_page->timeoutSpinBox->setValue(m_config->timeOut());
 
+    // PREDICTION
+    options_page->latencySpinBox->setValue(m_config->latency());
+    options_page->commandRateSpinBox->setValue(m_config->commandRate());
+
     QStringList connectionModes;
     connectionModes << "Serial";
     options_page->connectionMode->addItems(connectionModes);
@@ -163,6 +167,8 @@ void AntennaTrackGadgetOptionsPage::apply()
     m_config->setStopBits((QSerialPort::StopBits)options_page->stopBitsComboBox->itemData(options_page->stopBitsComboBox->currentIndex()).toInt());
     m_config->setParity((QSerialPort::Parity)options_page->parityComboBox->itemData(options_page->parityComboBox->currentIndex()).toInt());
     m_config->setTimeOut(options_page->timeoutSpinBox->value());
+    m_config->setLatency(options_page->latencySpinBox->value());
+    m_config->setCommandRate(options_page->commandRateSpinBox->value());
     m_config->setConnectionMode(options_page->connectionMode->currentText());
 }
 
@@ -43,6 +43,11 @@ AntennaTrackWidget::AntennaTrackWidget(QWidget *parent) : QWidget(parent)
 
     azimuth_old   = 0;
     elevation_old = 0;
+    latency = 0;
+    homeSet = false;
+
+    clock.start();
+    connect(&commandTimer, SIGNAL(timeout()), this, SLOT(updateAntenna()));
 }
 
 AntennaTrackWidget::~AntennaTrackWidget()
@@ -52,6 +57,16 @@ void AntennaTrackWidget::setPort(QPointer<QSerialPort> portx)
     port = portx;
 }
 
+/**
+ * The tracker is commanded at its own rate, pointing where the UAV is expected to be
+ * latency ms after the command
+ */
+void AntennaTrackWidget::setPrediction(int latency, int commandRate)
+{
+    this->latency = latency;
+    commandTimer.start(1000 / qMax(commandRate, 1));
+}
+
 void AntennaTrackWidget::dumpPacket(const QString &packet)
 {
     textBrowser->append(packet);
@@ -95,7 +110,11 @@ void AntennaTrackWidget::setPosition(double lat, double lon, double alt)
     TrackData.Latitude  = lat;
     TrackData.Longitude = lon;
     TrackData.Altitude  = alt;
-    calcAntennaPosition();
+}
+
+void AntennaTrackWidget::setTimedPosition(double lat, double lon, double alt, qint64 boardTime)
+{
+    predictor.update(clock.elapsed(), boardTime, lat, lon, alt);
 }
 
 void AntennaTrackWidget::setHomePosition(double lat, double lon, double alt)
@@ -129,23 +148,32 @@ void AntennaTrackWidget::setHomePosition(double lat, double lon, double alt)
     TrackData.HomeLatitude  = lat;
     TrackData.HomeLongitude = lon;
     TrackData.HomeAltitude  = alt;
-    calcAntennaPosition();
+    homeSet = true;
 }
 
-void AntennaTrackWidget::calcAntennaPosition(void)
+void AntennaTrackWidget::updateAntenna()
+{
+    double lat, lon, alt;
+
+    if (homeSet && predictor.predict(clock.elapsed() + latency, lat, lon, alt)) {
+        calcAntennaPosition(lat, lon, alt);
+    }
+}
+
+void AntennaTrackWidget::calcAntennaPosition(double lat, double lon, double alt)
 {
     /** http://www.movable-type.co.uk/scripts/latlong.html **/
     double lat1, lat2, lon1, lon2, a, c, d, x, y, brng;
     double azimuth, elevation;
     double gcsAlt = TrackData.HomeAltitude; // Home MSL altitude
-    double uavAlt = TrackData.Altitude; // UAV MSL altitude
+    double uavAlt = alt; // UAV MSL altitude
     double dAlt   = uavAlt - gcsAlt; // Altitude difference
 
     // Convert to radians
     lat1 = TrackData.HomeLatitude * (M_PI / 180); // Home lat
     lon1 = TrackData.HomeLongitude * (M_PI / 180); // Home lon
-    lat2 = TrackData.Latitude * (M_PI / 180); // UAV lat
-    lon2 = TrackData.Longitude * (M_PI / 180); // UAV lon
+    lat2 = lat * (M_PI / 180); // UAV lat
+    lon2 = lon * (M_PI / 180); // UAV lon
 
     // Bearing
     /**
@@ -198,11 +226,18 @@ void AntennaTrackWidget::calcAntennaPosition(void)
 
     // servo value 2000-4000
     int servo   = (int)(2000.0 / 180 * elevation + 2000);
-    int stepper = (int)(400.0 / 360 * (azimuth - azimuth_old));
+    // the shorter way round, the predicted track crosses north often enough
+    double turn = azimuth - azimuth_old;
+    if (turn > 180) {
+        turn -= 360;
+    } else if (turn < -180) {
+        turn += 360;
+    }
+    int stepper = (int)(400.0 / 360 * turn);
 
     // send azimuth and elevation to tracker hardware
     str3.sprintf("move %d 2000 2000 2000 %d\r", stepper, servo);
-    if (port->isOpen()) {
+    if (port && port->isOpen()) {
         if (azimuth_old != azimuth || elevation != elevation_old) {
             port->write(str3.toLatin1());
         }
@@ -36,6 +36,9 @@
 #include <QtSvg/QGraphicsSvgItem>
 #include <QtSerialPort/QSerialPort>
 #include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "trackpredictor.h"
 
 class Ui_AntennaTrackWidget;
 
@@ -56,14 +59,22 @@ public:
     ~AntennaTrackWidget();
     TrackData_t TrackData;
     void setPort(QPointer<QSerialPort> portx);
+    void setPrediction(int latency, int commandRate);
 
 private slots:
     void setPosition(double, double, double);
+    void setTimedPosition(double, double, double, qint64);
     void setHomePosition(double, double, double);
     void dumpPacket(const QString &packet);
+    void updateAntenna();
 
 private:
-    void calcAntennaPosition(void);
+    void calcAntennaPosition(double lat, double lon, double alt);
+    TrackPredictor predictor;
+    QElapsedTimer clock;
+    QTimer commandTimer;
+    int latency;
+    bool homeSet;
     QGraphicsSvgItem *marker;
     QPointer<QSerialPort> port;
     double azimuth_old;
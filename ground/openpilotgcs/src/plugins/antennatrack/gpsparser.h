@@ -43,6 +43,7 @@ protected:
 signals:
     void sv(int); // Satellites in view
     void position(double, double, double); // Lat, Lon, Alt
+    void timedPosition(double, double, double, qint64); // Lat, Lon, Alt, board time in ms or -1
     void home(double, double, double); // Lat, Lon, Alt
     void datetime(double, double); // Date then time
     void speedheading(double, double);
@@ -79,4 +79,5 @@ void TelemetryParser::updateGPS(UAVObject *object1)
     lat *= 1E-7;
     lon *= 1E-7;
     emit position(lat, lon, alt);
+    emit timedPosition(lat, lon, alt, object1->getTimestamp());
 }
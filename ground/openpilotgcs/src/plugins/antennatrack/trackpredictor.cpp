@@ -0,0 +1,121 @@
+/**
+ ******************************************************************************
+ *
+ * @file       trackpredictor.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup AntennaTrackGadgetPlugin Antenna Track Gadget Plugin
+ * @{
+ * @brief Extrapolates the tracked position to the time the antenna gets there
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "trackpredictor.h"
+
+#include <math.h>
+
+#define METRES_PER_DEGREE (6371000.0 * M_PI / 180.0)
+
+const double TrackPredictor::ALPHA = 0.5;
+// 2 (2 - alpha) - 4 sqrt(1 - alpha)
+const double TrackPredictor::BETA  = 0.1716;
+// beta^2 / (2 alpha)
+const double TrackPredictor::GAMMA = 0.0294;
+
+TrackPredictor::TrackPredictor()
+{
+    reset();
+}
+
+void TrackPredictor::reset()
+{
+    valid       = false;
+    lastTime    = 0;
+    offsetCount = 0;
+    offsetIndex = 0;
+    clockOffset = 0;
+}
+
+void TrackPredictor::update(qint64 localTime, qint64 boardTime, double latitude, double longitude, double altitude)
+{
+    // without a board time the update is taken as it arrives
+    qint64 sampleTime = localTime;
+
+    if (boardTime >= 0) {
+        offsets[offsetIndex] = localTime - boardTime;
+        offsetIndex = (offsetIndex + 1) % OFFSET_WINDOW;
+        offsetCount = qMin(offsetCount + 1, (int)OFFSET_WINDOW);
+        clockOffset = offsets[0];
+        for (int i = 1; i < offsetCount; i++) {
+            clockOffset = qMin(clockOffset, offsets[i]);
+        }
+        sampleTime = boardTime + clockOffset;
+    }
+
+    if (valid && sampleTime <= lastTime) {
+        // the same fix again
+        return;
+    }
+
+    if (!valid || sampleTime - lastTime > RESET_MS) {
+        originLatitude  = latitude;
+        originLongitude = longitude;
+        metresPerDegreeLongitude = METRES_PER_DEGREE * cos(latitude * M_PI / 180.0);
+        position[0] = position[1] = 0;
+        position[2] = altitude;
+        for (int i = 0; i < 3; i++) {
+            velocity[i]     = 0;
+            acceleration[i] = 0;
+        }
+        lastTime = sampleTime;
+        valid    = true;
+        return;
+    }
+
+    const double measured[3] = {
+        (latitude - originLatitude) * METRES_PER_DEGREE,
+        (longitude - originLongitude) * metresPerDegreeLongitude,
+        altitude
+    };
+    const double dT = (sampleTime - lastTime) * 1e-3;
+    for (int i = 0; i < 3; i++) {
+        double predicted = position[i] + (velocity[i] + 0.5 * acceleration[i] * dT) * dT;
+        double residual  = measured[i] - predicted;
+        position[i]      = predicted + ALPHA * residual;
+        velocity[i]     += acceleration[i] * dT + BETA * residual / dT;
+        acceleration[i] += 2.0 * GAMMA * residual / (dT * dT);
+    }
+    lastTime = sampleTime;
+}
+
+bool TrackPredictor::predict(qint64 localTime, double &latitude, double &longitude, double &altitude) const
+{
+    if (!valid) {
+        return false;
+    }
+
+    const double horizon = qBound((qint64)0, localTime - lastTime, (qint64)MAX_HORIZON_MS) * 1e-3;
+    double predicted[3];
+    for (int i = 0; i < 3; i++) {
+        predicted[i] = position[i] + (velocity[i] + 0.5 * acceleration[i] * horizon) * horizon;
+    }
+    latitude  = originLatitude + predicted[0] / METRES_PER_DEGREE;
+    longitude = originLongitude + predicted[1] / metresPerDegreeLongitude;
+    altitude  = predicted[2];
+    return true;
+}
@@ -0,0 +1,78 @@
+/**
+ ******************************************************************************
+ *
+ * @file       trackpredictor.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup AntennaTrackGadgetPlugin Antenna Track Gadget Plugin
+ * @{
+ * @brief Extrapolates the tracked position to the time the antenna gets there
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef TRACKPREDICTOR_H
+#define TRACKPREDICTOR_H
+
+#include <QtGlobal>
+
+/**
+ * Alpha-beta-gamma tracker of the UAV position, constant acceleration between the
+ * updates. The positions are taken in a flat north/east/up frame about the first
+ * one, good for the range of a radio link.
+ *
+ * The update times are board times when the telemetry has them: the spacing of the
+ * samples is then the spacing of the fixes, not that of their arrival. The offset
+ * of the board clock to the GCS clock is the least difference seen lately, that is
+ * the update which came through fastest.
+ */
+class TrackPredictor {
+public:
+    TrackPredictor();
+
+    void reset();
+    // boardTime in ms, -1 when the update was not timestamped
+    void update(qint64 localTime, qint64 boardTime, double latitude, double longitude, double altitude);
+    // position at localTime in ms of the GCS clock, false until there is a track
+    bool predict(qint64 localTime, double &latitude, double &longitude, double &altitude) const;
+
+private:
+    // gains of the tracker, alpha and the steady Kalman beta and gamma of it
+    static const double ALPHA;
+    static const double BETA;
+    static const double GAMMA;
+    // no prediction further than this past the last update
+    static const int MAX_HORIZON_MS = 2000;
+    // the track starts over after a gap this long
+    static const int RESET_MS = 5000;
+    static const int OFFSET_WINDOW = 32;
+
+    bool valid;
+    qint64 lastTime;
+    double originLatitude;
+    double originLongitude;
+    double metresPerDegreeLongitude;
+    double position[3];
+    double velocity[3];
+    double acceleration[3];
+    qint64 offsets[OFFSET_WINDOW];
+    int offsetCount;
+    int offsetIndex;
+    qint64 clockOffset;
+};
+
+#endif // TRACKPREDICTOR_H
@@ -46,12 +46,24 @@ bool CalibrationUtils::EllipsoidCalibration(Eigen::VectorXf *samplesX, Eigen::Ve
                                             float nominalRange,
                                             EllipsoidCalibrationResult *result,
                                             bool fitAlongXYZ)
+{
+    EllipsoidFitAccumulator fit(fitAlongXYZ);
+
+    for (int i = 0; i < samplesX->rows(); i++) {
+        fit.addSample(samplesX->coeff(i), samplesY->coeff(i), samplesZ->coeff(i));
+    }
+    return EllipsoidCalibration(fit, nominalRange, result);
+}
+
+bool CalibrationUtils::EllipsoidCalibration(const EllipsoidFitAccumulator &fit,
+                                            float nominalRange,
+                                            EllipsoidCalibrationResult *result)
 {
     Eigen::VectorXf radii;
     Eigen::Vector3f center;
     Eigen::MatrixXf evecs;
 
-    EllipsoidFit(samplesX, samplesY, samplesZ, &center, &radii, &evecs, fitAlongXYZ);
+    EllipsoidFit(fit, &center, &radii, &evecs);
 
     result->Scale.setZero();
 
@@ -283,44 +295,48 @@ void CalibrationUtils::ComputePoly(VectorXf *samplesX, Eigen::VectorXf *polynomi
 
  */
 
-void CalibrationUtils::EllipsoidFit(Eigen::VectorXf *samplesX, Eigen::VectorXf *samplesY, Eigen::VectorXf *samplesZ,
-                                    Eigen::Vector3f *center,
-                                    Eigen::VectorXf *radii,
-                                    Eigen::MatrixXf *evecs,
-                                    bool fitAlongXYZ)
+CalibrationUtils::EllipsoidFitAccumulator::EllipsoidFitAccumulator(bool fitAlongXYZ) :
+    fitAlongXYZ(fitAlongXYZ)
+{
+    reset();
+}
+
+void CalibrationUtils::EllipsoidFitAccumulator::reset()
 {
-    int numSamples = (*samplesX).rows();
-    Eigen::MatrixXf D;
+    int params = fitAlongXYZ ? 6 : 9;
+
+    dtd.setZero(params, params);
+    dt1.setZero(params);
+    samples = 0;
+}
+
+/*
+ * Adds the row of D for this sample (see the fit below) to D' * D and D' * ones
+ */
+void CalibrationUtils::EllipsoidFitAccumulator::addSample(float x, float y, float z)
+{
+    double dx = x, dy = y, dz = z;
+    Eigen::VectorXd d(dt1.rows());
 
     if (!fitAlongXYZ) {
-        D.setZero(numSamples, 9);
-        D.col(0) = (*samplesX).cwiseProduct(*samplesX);
-        D.col(1) = (*samplesY).cwiseProduct(*samplesY);
-        D.col(2) = (*samplesZ).cwiseProduct(*samplesZ);
-        D.col(3) = (*samplesX).cwiseProduct(*samplesY) * 2;
-        D.col(4) = (*samplesX).cwiseProduct(*samplesZ) * 2;
-        D.col(5) = (*samplesY).cwiseProduct(*samplesZ) * 2;
-        D.col(6) = 2 * (*samplesX);
-        D.col(7) = 2 * (*samplesY);
-        D.col(8) = 2 * (*samplesZ);
+        d << dx * dx, dy * dy, dz * dz, 2 * dx * dy, 2 * dx * dz, 2 * dy * dz, 2 * dx, 2 * dy, 2 * dz;
     } else {
-        D.setZero(numSamples, 6);
-        D.setZero();
-        D.col(0) = (*samplesX).cwiseProduct(*samplesX);
-        D.col(1) = (*samplesY).cwiseProduct(*samplesY);
-        D.col(2) = (*samplesZ).cwiseProduct(*samplesZ);
-        D.col(3) = 2 * (*samplesX);
-        D.col(4) = 2 * (*samplesY);
-        D.col(5) = 2 * (*samplesZ);
+        d << dx * dx, dy * dy, dz * dz, 2 * dx, 2 * dy, 2 * dz;
     }
-    Eigen::VectorXf ones(numSamples);
-    ones.setOnes(numSamples);
+    dtd.selfadjointView<Eigen::Lower>().rankUpdate(d);
+    dt1 += d;
+    samples++;
+}
 
-    Eigen::MatrixXf dt1 = (D.transpose() * D);
-    Eigen::MatrixXf dt2 = (D.transpose() * ones);
-    Eigen::VectorXf v   = dt1.inverse() * dt2;
+void CalibrationUtils::EllipsoidFit(const EllipsoidFitAccumulator &fit,
+                                    Eigen::Vector3f *center,
+                                    Eigen::VectorXf *radii,
+                                    Eigen::MatrixXf *evecs)
+{
+    // solve the normal system of equations, D' * D is symmetric positive definite
+    Eigen::VectorXf v = fit.dtd.selfadjointView<Eigen::Lower>().ldlt().solve(fit.dt1).cast<float>();
 
-    if (!fitAlongXYZ) {
+    if (!fit.fitAlongXYZ) {
         Eigen::Matrix4f A;
         A << v.coeff(0), v.coeff(3), v.coeff(4), v.coeff(6),
             v.coeff(3), v.coeff(1), v.coeff(5), v.coeff(7),
@@ -451,7 +467,7 @@ int CalibrationUtils::LinearEquationsSolve(int nDim, double *pfMatr, double *pfV
     return 1;
 }
 
-double CalibrationUtils::listMean(QList<double> list)
+double CalibrationUtils::listMean(const QList<double> &list)
 {
     double accum = 0;
 
@@ -461,7 +477,7 @@ double CalibrationUtils::listMean(QList<double> list)
     return accum / list.size();
 }
 
-double CalibrationUtils::listVar(QList<double> list)
+double CalibrationUtils::listVar(const QList<double> &list)
 {
     double mean_accum = 0;
     double var_accum  = 0;
@@ -41,23 +41,46 @@ public:
         Eigen::Vector3f Scale;
         Eigen::Vector3f Bias;
     };
+    // The normal equations of the ellipsoid fit, accumulated one sample at
+    // a time: the samples need not be kept and the fit can be solved at any
+    // time for the cost of a 6x6 (9x9) system whatever their number.
+    class EllipsoidFitAccumulator {
+public:
+        EllipsoidFitAccumulator(bool fitAlongXYZ = true);
+        void reset();
+        void addSample(float x, float y, float z);
+        int count() const
+        {
+            return samples;
+        }
+
+private:
+        friend class CalibrationUtils;
+        bool fitAlongXYZ;
+        int samples;
+        Eigen::MatrixXd dtd; // lower triangle of D' * D
+        Eigen::VectorXd dt1; // D' * ones
+    };
     static bool EllipsoidCalibration(Eigen::VectorXf *samplesX, Eigen::VectorXf *samplesY, Eigen::VectorXf *samplesZ,
                                      float nominalRange,
                                      EllipsoidCalibrationResult *result,
                                      bool fitAlongXYZ);
+    static bool EllipsoidCalibration(const EllipsoidFitAccumulator &fit,
+                                     float nominalRange,
+                                     EllipsoidCalibrationResult *result);
     static bool PolynomialCalibration(Eigen::VectorXf *samplesX, Eigen::VectorXf *samplesY, int degree, Eigen::Ref<Eigen::VectorXf> result, const double maxRelativeError);
 
     static void ComputePoly(Eigen::VectorXf *samplesX, Eigen::VectorXf *polynomial, Eigen::VectorXf *polyY);
     static float ComputeSigma(Eigen::VectorXf *samplesY);
 
     static int SixPointInConstFieldCal(double ConstMag, double x[6], double y[6], double z[6], double S[3], double b[3]);
-    static double listMean(QList<double> list);
-    static double listVar(QList<double> list);
+    static double listMean(const QList<double> &list);
+    static double listVar(const QList<double> &list);
 private:
-    static void EllipsoidFit(Eigen::VectorXf *samplesX, Eigen::VectorXf *samplesY, Eigen::VectorXf *samplesZ,
+    static void EllipsoidFit(const EllipsoidFitAccumulator &fit,
                              Eigen::Vector3f *center,
                              Eigen::VectorXf *radii,
-                             Eigen::MatrixXf *evecs, bool fitAlongXYZ);
+                             Eigen::MatrixXf *evecs);
 
     static int LinearEquationsSolve(int nDim, double *pfMatr, double *pfVect, double *pfSolution);
 };
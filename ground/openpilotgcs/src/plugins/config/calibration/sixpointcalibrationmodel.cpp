@@ -214,9 +214,8 @@ void SixPointCalibrationModel::start(bool calibrateAccel, bool calibrateMag)
     mag_accum_y.clear();
     mag_accum_z.clear();
 
-    mag_fit_x.clear();
-    mag_fit_y.clear();
-    mag_fit_z.clear();
+    mag_fit.reset();
+    aux_mag_fit.reset();
 
     // Need to get as many accel updates as possible
     memento.accelStateMetadata = accelState->getMetadata();
@@ -324,9 +323,7 @@ void SixPointCalibrationModel::getSample(UAVObject *obj)
             mag_accum_y.append(magData.y);
             mag_accum_z.append(magData.z);
 #ifndef FITTING_USING_CONTINOUS_ACQUISITION
-            mag_fit_x.append(magData.x);
-            mag_fit_y.append(magData.y);
-            mag_fit_z.append(magData.z);
+            mag_fit.addSample(magData.x, magData.y, magData.z);
 #endif // FITTING_USING_CONTINOUS_ACQUISITION
         } else if (obj->getObjID() == AuxMagSensor::OBJID) {
             AuxMagSensor::DataFields auxMagData = auxMagSensor->getData();
@@ -336,9 +333,7 @@ void SixPointCalibrationModel::getSample(UAVObject *obj)
                 aux_mag_accum_z.append(auxMagData.z);
                 calibratingAuxMag = true;
 #ifndef FITTING_USING_CONTINOUS_ACQUISITION
-                aux_mag_fit_x.append(auxMagData.x);
-                aux_mag_fit_y.append(auxMagData.y);
-                aux_mag_fit_z.append(auxMagData.z);
+                aux_mag_fit.addSample(auxMagData.x, auxMagData.y, auxMagData.z);
 #endif // FITTING_USING_CONTINOUS_ACQUISITION
             }
         } else {
@@ -416,15 +411,11 @@ void SixPointCalibrationModel::continouslyGetMagSamples(UAVObject *obj)
 
     if (obj->getObjID() == MagSensor::OBJID) {
         MagSensor::DataFields magSensorData = magSensor->getData();
-        mag_fit_x.append(magSensorData.x);
-        mag_fit_y.append(magSensorData.y);
-        mag_fit_z.append(magSensorData.z);
+        mag_fit.addSample(magSensorData.x, magSensorData.y, magSensorData.z);
     } else if (obj->getObjID() == AuxMagSensor::OBJID) {
         AuxMagSensor::DataFields auxMagData = auxMagSensor->getData();
         if (auxMagData.Status == AuxMagSensor::STATUS_OK) {
-            aux_mag_fit_x.append(auxMagData.x);
-            aux_mag_fit_y.append(auxMagData.y);
-            aux_mag_fit_z.append(auxMagData.z);
+            aux_mag_fit.addSample(auxMagData.x, auxMagData.y, auxMagData.z);
             calibratingAuxMag = true;
         }
     }
@@ -463,10 +454,10 @@ void SixPointCalibrationModel::compute()
 
         qDebug() << "-----------------------------------";
         qDebug() << "Onboard Mag";
-        calcCalibration(mag_fit_x, mag_fit_y, mag_fit_z, Be_length, revoCalibrationData.mag_transform, revoCalibrationData.mag_bias);
+        calcCalibration(mag_fit, Be_length, revoCalibrationData.mag_transform, revoCalibrationData.mag_bias);
         if (calibratingAuxMag) {
             qDebug() << "Aux Mag";
-            calcCalibration(aux_mag_fit_x, aux_mag_fit_y, aux_mag_fit_z, Be_length, auxCalibrationData.mag_transform, auxCalibrationData.mag_bias);
+            calcCalibration(aux_mag_fit, Be_length, auxCalibrationData.mag_transform, auxCalibrationData.mag_bias);
         }
     }
     // Restore the previous setting
@@ -537,20 +528,10 @@ void SixPointCalibrationModel::compute()
     position = -1;
 }
 
-void SixPointCalibrationModel::calcCalibration(QList<float> x, QList<float> y, QList<float> z, double Be_length, float calibrationMatrix[], float bias[])
+void SixPointCalibrationModel::calcCalibration(const CalibrationUtils::EllipsoidFitAccumulator &fit, double Be_length, float calibrationMatrix[], float bias[])
 {
-    int vectSize = x.count();
-    Eigen::VectorXf samples_x(vectSize);
-    Eigen::VectorXf samples_y(vectSize);
-    Eigen::VectorXf samples_z(vectSize);
-
-    for (int i = 0; i < vectSize; i++) {
-        samples_x(i) = x[i];
-        samples_y(i) = y[i];
-        samples_z(i) = z[i];
-    }
     OpenPilot::CalibrationUtils::EllipsoidCalibrationResult result;
-    OpenPilot::CalibrationUtils::EllipsoidCalibration(&samples_x, &samples_y, &samples_z, Be_length, &result, true);
+    OpenPilot::CalibrationUtils::EllipsoidCalibration(fit, Be_length, &result);
 
     qDebug() << "Mag fitting results: ";
     qDebug() << "scale(" << result.Scale.coeff(0) << ", " << result.Scale.coeff(1) << ", " << result.Scale.coeff(2) << ")";
@@ -125,6 +125,56 @@ bool ThermalCalibration::GyroscopeCalibration(Eigen::VectorXf samplesX, Eigen::V
     return (inputSigma[0] > calibratedSigma[0]) && (inputSigma[1] > calibratedSigma[1]) && (inputSigma[2] > calibratedSigma[2]);
 }
 
+bool ThermalCalibration::TableCalibration(Eigen::VectorXf samples, Eigen::VectorXf temperature, const float *poly, int degree, float tempMin, float tempMax, float *result, int points)
+{
+    if (points < 2 || !(tempMax > tempMin)) {
+        return false;
+    }
+    const float step = (tempMax - tempMin) / (points - 1);
+    Eigen::VectorXf sum   = Eigen::VectorXf::Zero(points);
+    Eigen::VectorXi count = Eigen::VectorXi::Zero(points);
+
+    for (int i = 0; i < samples.size(); i++) {
+        int point = qRound((temperature[i] - tempMin) / step);
+        if (point >= 0 && point < points) {
+            sum[point] += samples[i];
+            count[point]++;
+        }
+    }
+
+    float offset = 0.0f;
+    int used     = 0;
+    for (int i = 0; i < points; i++) {
+        if (count[i]) {
+            offset += sum[i] / count[i] - evaluatePoly(poly, degree, tempMin + i * step);
+            used++;
+        }
+    }
+    if (!used) {
+        return false;
+    }
+    offset /= used;
+
+    for (int i = 0; i < points; i++) {
+        if (count[i]) {
+            result[i] = sum[i] / count[i] - offset;
+        } else {
+            result[i] = evaluatePoly(poly, degree, tempMin + i * step);
+        }
+    }
+    return true;
+}
+
+float ThermalCalibration::evaluatePoly(const float *poly, int degree, float x)
+{
+    float y = poly[degree];
+
+    for (int i = degree - 1; i >= 0; i--) {
+        y = y * x + poly[i];
+    }
+    return y;
+}
+
 void ThermalCalibration::copyToArray(float *result, Eigen::VectorXf solution, int elements)
 {
     for (int i = 0; i < elements; i++) {
@@ -96,9 +96,26 @@ public:
      */
     static bool GyroscopeCalibration(Eigen::VectorXf samplesX, Eigen::VectorXf samplesY, Eigen::VectorXf samplesZ, Eigen::VectorXf temperature, float *result, float *inputSigma, float *calibratedSigma);
 
+    /**
+     * @brief TableCalibration produce a temperature bias table from sensor axis and temperature samples
+     * Each point is the mean of the samples nearest to it, offset to follow the same zero bias as the polynomial.
+     * Points without samples are taken from the polynomial.
+     * @param samples
+     * @param temperature
+     * @param poly polynomial coefficients (x0, x1, ...)
+     * @param degree Degree of the polynomial
+     * @param tempMin temperature of the first point
+     * @param tempMax temperature of the last point
+     * @param result a float[points] array populated with the table
+     * @param points number of table points
+     * @return false if there are no samples in the table range
+     */
+    static bool TableCalibration(Eigen::VectorXf samples, Eigen::VectorXf temperature, const float *poly, int degree, float tempMin, float tempMax, float *result, int points);
+
 
 private:
     static void copyToArray(float *result, Eigen::VectorXf solution, int elements);
+    static float evaluatePoly(const float *poly, int degree, float x);
     ThermalCalibration();
     static int searchReferenceValue(float value, Eigen::VectorXf values);
 };
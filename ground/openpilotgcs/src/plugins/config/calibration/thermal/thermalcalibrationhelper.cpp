@@ -59,6 +59,7 @@ ThermalCalibrationHelper::ThermalCalibrationHelper(QObject *parent) :
     magSensor         = MagSensor::GetInstance(getObjectManager());
     accelGyroSettings = AccelGyroSettings::GetInstance(getObjectManager());
     revoSettings      = RevoSettings::GetInstance(getObjectManager());
+    tempCompensationTable = TempCompensationTable::GetInstance(getObjectManager());
 
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     TelemetryManager *telMngr = pm->getObject<TelemetryManager>();
@@ -100,6 +101,11 @@ bool ThermalCalibrationHelper::setupBoardForCalibration()
 
     revoSettings->setData(revoSettingsData);
 
+    // the tables take precedence over the polynomials, clear them too
+    TempCompensationTable::DataFields tableData = tempCompensationTable->getData();
+    memset(&tableData, 0, sizeof(tableData));
+    tempCompensationTable->setData(tableData);
+
     return true;
 }
 
@@ -115,6 +121,7 @@ bool ThermalCalibrationHelper::saveBoardInitialSettings()
     m_memento.baroensorMeta     = baroSensor->getMetadata();
     m_memento.accelGyroSettings = accelGyroSettings->getData();
     m_memento.revoSettings = revoSettings->getData();
+    m_memento.tempCompensationTable = tempCompensationTable->getData();
 
     /*
      * TODO: for revolution it is not needed but in case of CC we would prevent having
@@ -140,6 +147,7 @@ bool ThermalCalibrationHelper::restoreInitialSettings()
     baroSensor->setMetadata(m_memento.baroensorMeta);
     accelGyroSettings->setData(m_memento.accelGyroSettings);
     revoSettings->setData(m_memento.revoSettings);
+    tempCompensationTable->setData(m_memento.tempCompensationTable);
 
     return true;
 }
@@ -188,6 +196,8 @@ void ThermalCalibrationHelper::initAcquisition()
     m_results.accelCalibrated = false;
     m_results.gyroCalibrated  = false;
     m_results.baroCalibrated  = false;
+    m_results.baroTableCalibrated = false;
+    m_results.gyroTableCalibrated = false;
 
     // retrieve current temperature/time as initial checkpoint.
     m_startTime            = m_lastCheckpointTime = QTime::currentTime();
@@ -323,6 +333,10 @@ void ThermalCalibrationHelper::calculate()
 
     m_results.baroTempMin = datat.array().minCoeff();
     m_results.baroTempMax = datat.array().maxCoeff();
+    if (m_results.baroCalibrated) {
+        m_results.baroTableCalibrated = ThermalCalibration::TableCalibration(datax, datat, m_results.baro, 3, m_results.baroTempMin, m_results.baroTempMax,
+                                                                             m_results.baroTable, TempCompensationTable::BARO_NUMELEM);
+    }
 
     // gyro
     count = m_gyroSamples.count();
@@ -350,6 +364,19 @@ void ThermalCalibrationHelper::calculate()
     // accel
     m_results.accelGyroTempMin = datat.array().minCoeff();
     m_results.accelGyroTempMax = datat.array().maxCoeff();
+
+    // lookup tables, these follow the sensor where it deviates from the polynomials
+    const float tmin = m_results.accelGyroTempMin;
+    const float tmax = m_results.accelGyroTempMax;
+    if (m_results.gyroCalibrated) {
+        const int points = TempCompensationTable::GYROX_NUMELEM;
+        const float polyX[3] = { 0.0f, m_results.gyro[0], m_results.gyro[1] };
+        const float polyY[3] = { 0.0f, m_results.gyro[2], m_results.gyro[3] };
+        const float polyZ[3] = { 0.0f, m_results.gyro[4], m_results.gyro[5] };
+        m_results.gyroTableCalibrated = ThermalCalibration::TableCalibration(datax, datat, polyX, 2, tmin, tmax, m_results.gyroTable[0], points) &&
+                                        ThermalCalibration::TableCalibration(datay, datat, polyY, 2, tmin, tmax, m_results.gyroTable[1], points) &&
+                                        ThermalCalibration::TableCalibration(dataz, datat, polyZ, 2, tmin, tmax, m_results.gyroTable[2], points);
+    }
     // TODO: sanity checks needs to be enforced before accel calibration can be enabled and usable.
     /*
        count = m_accelSamples.count();
@@ -549,6 +576,22 @@ void ThermalCalibrationHelper::copyResultToSettings()
         data.temp_calibrated_extent[1] = m_results.accelGyroTempMax;
 
         accelGyroSettings->setData(data);
+
+        TempCompensationTable::DataFields tableData = tempCompensationTable->getData();
+        memset(&tableData, 0, sizeof(tableData));
+        if (m_results.gyroTableCalibrated) {
+            tableData.AccelGyroTempRange[0] = m_results.accelGyroTempMin;
+            tableData.AccelGyroTempRange[1] = m_results.accelGyroTempMax;
+            memcpy(tableData.GyroX, m_results.gyroTable[0], sizeof(tableData.GyroX));
+            memcpy(tableData.GyroY, m_results.gyroTable[1], sizeof(tableData.GyroY));
+            memcpy(tableData.GyroZ, m_results.gyroTable[2], sizeof(tableData.GyroZ));
+        }
+        if (m_results.baroTableCalibrated) {
+            tableData.BaroTempRange[0] = m_results.baroTempMin;
+            tableData.BaroTempRange[1] = m_results.baroTempMax;
+            memcpy(tableData.Baro, m_results.baroTable, sizeof(tableData.Baro));
+        }
+        tempCompensationTable->setData(tableData);
     }
 }
 
@@ -51,6 +51,7 @@
 #include <accelgyrosettings.h>
 #include <revocalibration.h>
 #include <revosettings.h>
+#include <tempcompensationtable.h>
 
 #include "../wizardmodel.h"
 
@@ -60,6 +61,7 @@ typedef struct {
     // AccelGyroSettings::DataFields accelGyroSettings;
     RevoSettings::DataFields revoSettings;
     AccelGyroSettings::DataFields accelGyroSettings;
+    TempCompensationTable::DataFields tempCompensationTable;
     UAVObject::Metadata gyroSensorMeta;
     UAVObject::Metadata accelSensorMeta;
     UAVObject::Metadata baroensorMeta;
@@ -86,6 +88,12 @@ typedef struct {
     float baroTempMax;
     float accelGyroTempMin;
     float accelGyroTempMax;
+
+    // bias tables over the baro and accel/gyro temperature ranges
+    bool  baroTableCalibrated;
+    float baroTable[TempCompensationTable::BARO_NUMELEM];
+    bool  gyroTableCalibrated;
+    float gyroTable[3][TempCompensationTable::GYROX_NUMELEM];
 } Results;
 
 class ThermalCalibrationHelper : public QObject {
@@ -258,6 +266,7 @@ private:
     MagSensor *magSensor;
     AccelGyroSettings *accelGyroSettings;
     RevoSettings *revoSettings;
+    TempCompensationTable *tempCompensationTable;
 
     /* board settings save/restore */
     bool setupBoardForCalibration();
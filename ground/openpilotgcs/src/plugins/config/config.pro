@@ -31,6 +31,7 @@ HEADERS += \
     inputchannelform.h \
     configcamerastabilizationwidget.h \
     configtxpidwidget.h \
+    configautotunewidget.h \
     outputchannelform.h \    
     cfg_vehicletypes/vehicleconfig.h \
     cfg_vehicletypes/configccpmwidget.h \
@@ -78,6 +79,7 @@ SOURCES += \
     configcamerastabilizationwidget.cpp \
     configrevowidget.cpp \
     configtxpidwidget.cpp \
+    configautotunewidget.cpp \
     cfg_vehicletypes/vehicleconfig.cpp \
     cfg_vehicletypes/configccpmwidget.cpp \
     cfg_vehicletypes/configmultirotorwidget.cpp \
@@ -119,6 +121,7 @@ FORMS += \
     outputchannelform.ui \
     revosensors.ui \
     txpid.ui \
+    autotune.ui \
     mixercurve.ui \
     configrevohwwidget.ui \
     oplink.ui
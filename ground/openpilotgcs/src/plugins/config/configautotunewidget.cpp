@@ -9,13 +9,19 @@
 #include <QDesktopServices>
 #include <QUrl>
 #include <QList>
-#include "relaytuningsettings.h"
-#include "relaytuning.h"
-#include "stabilizationsettings.h"
+#include <QtWidgets/QTableWidgetItem>
+#include <QtWidgets/QFileDialog>
+#include <QFile>
+#include <QTextStream>
+#include "systemident.h"
+#include "samplestream.h"
+#include "stabilizationsettingsbank1.h"
+#include "stabilizationsettingsbank2.h"
+#include "stabilizationsettingsbank3.h"
 #include "hwsettings.h"
 
 ConfigAutotuneWidget::ConfigAutotuneWidget(QWidget *parent) :
-    ConfigTaskWidget(parent)
+    ConfigTaskWidget(parent), m_samples(STREAM_CAPACITY), m_segment(0)
 {
     m_autotune = new Ui_AutotuneWidget();
     m_autotune->setupUi(this);
@@ -24,127 +30,205 @@ ConfigAutotuneWidget::ConfigAutotuneWidget(QWidget *parent) :
     autoLoadWidgets();
     disableMouseWheelEvents();
 
-    // Whenever any value changes compute new potential stabilization settings
-    connect(m_autotune->rateTuning, SIGNAL(valueChanged(int)), this, SLOT(recomputeStabilization()));
-    connect(m_autotune->attitudeTuning, SIGNAL(valueChanged(int)), this, SLOT(recomputeStabilization()));
-
     addUAVObject("HwSettings");
     addWidget(m_autotune->enableAutoTune);
 
-    RelayTuning *relayTuning = RelayTuning::GetInstance(getObjectManager());
-    Q_ASSERT(relayTuning);
-    if (relayTuning) {
-        connect(relayTuning, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(recomputeStabilization()));
+    QStringList columns;
+    columns << tr("Gain (deg/s^2)") << tr("Tau (ms)") << tr("Delay (ms)") << tr("Uncertainty")
+            << tr("RateKp") << tr("RateKi") << tr("RateKd") << tr("AttitudeKp");
+    m_autotune->identTable->setColumnCount(columns.size());
+    m_autotune->identTable->setHorizontalHeaderLabels(columns);
+    m_autotune->identTable->setRowCount(3);
+    m_autotune->identTable->setVerticalHeaderLabels(QStringList() << tr("Roll") << tr("Pitch") << tr("Yaw"));
+    for (int row = 0; row < 3; row++) {
+        for (int column = 0; column < columns.size(); column++) {
+            m_autotune->identTable->setItem(row, column, new QTableWidgetItem());
+        }
+    }
+    m_autotune->identTable->resizeColumnsToContents();
+
+    SystemIdent *systemIdent = SystemIdent::GetInstance(getObjectManager());
+    Q_ASSERT(systemIdent);
+    if (systemIdent) {
+        connect(systemIdent, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(refreshIdent()));
+    }
+
+    SampleStream *sampleStream = SampleStream::GetInstance(getObjectManager());
+    Q_ASSERT(sampleStream);
+    if (sampleStream) {
+        connect(sampleStream, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(streamUpdated(UAVObject *)));
     }
+    connect(m_autotune->exportSamples, SIGNAL(clicked()), this, SLOT(exportSamples()));
 
     // Connect the apply button for the stabilization settings
     connect(m_autotune->useComputedValues, SIGNAL(pressed()), this, SLOT(saveStabilization()));
+    refreshIdent();
 }
 
 /**
- * Apply the stabilization settings computed
+ * Unpack an update of the sample stream onto the series kept so far
  */
-void ConfigAutotuneWidget::saveStabilization()
+void ConfigAutotuneWidget::streamUpdated(UAVObject *obj)
 {
-    StabilizationSettings *stabilizationSettings = StabilizationSettings::GetInstance(getObjectManager());
+    SampleStream *sampleStream = qobject_cast<SampleStream *>(obj);
 
-    Q_ASSERT(stabilizationSettings);
-    if (!stabilizationSettings) {
+    if (!sampleStream || !m_stream.decode(obj)) {
         return;
     }
 
-    // Make sure to recompute in case the other stab settings changed since
-    // the last time
-    recomputeStabilization();
+    SampleStream::DataFields data = sampleStream->getData();
+    if (m_stream.isDiscontinuous() && !m_samples.isEmpty()) {
+        m_segment++;
+    }
+
+    for (int i = 0; i < m_stream.count(); i++) {
+        StreamSample sample;
+        sample.time      = m_stream.time(i);
+        sample.segment   = m_segment;
+        sample.values[0] = data.GyroRoll[i] * 0.1f;
+        sample.values[1] = data.GyroPitch[i] * 0.1f;
+        sample.values[2] = data.GyroYaw[i] * 0.1f;
+        sample.values[3] = data.ActuatorRoll[i] * 0.0001f;
+        sample.values[4] = data.ActuatorPitch[i] * 0.0001f;
+        sample.values[5] = data.ActuatorYaw[i] * 0.0001f;
+        m_samples.append(sample);
+    }
 
-    // Apply this data to the board
-    stabilizationSettings->setData(stabSettings);
-    stabilizationSettings->updated();
+    m_autotune->streamStatus->setText(tr("%1 samples in %2 segments, %3 updates lost")
+                                      .arg(m_samples.count()).arg(m_segment + 1).arg(m_stream.lostUpdates()));
 }
 
 /**
- * Called whenever the gain ratios or measured values
- * are changed
+ * Write the samples received so far as CSV, the segment counts the breaks in the stream
  */
-void ConfigAutotuneWidget::recomputeStabilization()
+void ConfigAutotuneWidget::exportSamples()
 {
-    RelayTuningSettings *relayTuningSettings = RelayTuningSettings::GetInstance(getObjectManager());
+    if (m_samples.isEmpty()) {
+        return;
+    }
 
-    Q_ASSERT(relayTuningSettings);
-    if (!relayTuningSettings) {
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Export Samples"), "samples.csv", tr("CSV files (*.csv)"));
+    if (fileName.isEmpty()) {
         return;
     }
 
-    RelayTuning *relayTuning = RelayTuning::GetInstance(getObjectManager());
-    Q_ASSERT(relayTuning);
-    if (!relayTuning) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
         return;
     }
 
-    StabilizationSettings *stabilizationSettings = StabilizationSettings::GetInstance(getObjectManager());
-    Q_ASSERT(stabilizationSettings);
-    if (!stabilizationSettings) {
+    QTextStream out(&file);
+    out << "time,segment,gyro_roll,gyro_pitch,gyro_yaw,actuator_roll,actuator_pitch,actuator_yaw\n";
+    for (int i = m_samples.firstIndex(); i <= m_samples.lastIndex(); i++) {
+        const StreamSample &sample = m_samples.at(i);
+        out << QString::number(sample.time, 'f', 6) << ',' << sample.segment;
+        for (int channel = 0; channel < 6; channel++) {
+            out << ',' << sample.values[channel];
+        }
+        out << '\n';
+    }
+}
+
+/**
+ * Copy the gains of the converged axes into a bank
+ */
+template <class StabilizationSettingsBankX>
+static void applyIdentifiedGains(StabilizationSettingsBankX *bank, const SystemIdent::DataFields &ident)
+{
+    typename StabilizationSettingsBankX::DataFields data = bank->getData();
+
+    if (ident.Converged[SystemIdent::CONVERGED_ROLL] == SystemIdent::CONVERGED_TRUE) {
+        data.RollRatePID[StabilizationSettingsBankX::ROLLRATEPID_KP] = ident.RateKp[SystemIdent::RATEKP_ROLL];
+        data.RollRatePID[StabilizationSettingsBankX::ROLLRATEPID_KI] = ident.RateKi[SystemIdent::RATEKI_ROLL];
+        data.RollRatePID[StabilizationSettingsBankX::ROLLRATEPID_KD] = ident.RateKd[SystemIdent::RATEKD_ROLL];
+        data.RollPI[StabilizationSettingsBankX::ROLLPI_KP] = ident.AttitudeKp[SystemIdent::ATTITUDEKP_ROLL];
+    }
+    if (ident.Converged[SystemIdent::CONVERGED_PITCH] == SystemIdent::CONVERGED_TRUE) {
+        data.PitchRatePID[StabilizationSettingsBankX::PITCHRATEPID_KP] = ident.RateKp[SystemIdent::RATEKP_PITCH];
+        data.PitchRatePID[StabilizationSettingsBankX::PITCHRATEPID_KI] = ident.RateKi[SystemIdent::RATEKI_PITCH];
+        data.PitchRatePID[StabilizationSettingsBankX::PITCHRATEPID_KD] = ident.RateKd[SystemIdent::RATEKD_PITCH];
+        data.PitchPI[StabilizationSettingsBankX::PITCHPI_KP] = ident.AttitudeKp[SystemIdent::ATTITUDEKP_PITCH];
+    }
+    if (ident.Converged[SystemIdent::CONVERGED_YAW] == SystemIdent::CONVERGED_TRUE) {
+        data.YawRatePID[StabilizationSettingsBankX::YAWRATEPID_KP] = ident.RateKp[SystemIdent::RATEKP_YAW];
+        data.YawRatePID[StabilizationSettingsBankX::YAWRATEPID_KI] = ident.RateKi[SystemIdent::RATEKI_YAW];
+        data.YawRatePID[StabilizationSettingsBankX::YAWRATEPID_KD] = ident.RateKd[SystemIdent::RATEKD_YAW];
+        data.YawPI[StabilizationSettingsBankX::YAWPI_KP] = ident.AttitudeKp[SystemIdent::ATTITUDEKP_YAW];
+    }
+
+    bank->setData(data);
+    bank->updated();
+}
+
+/**
+ * Apply the stabilization settings computed on the board to the selected bank
+ */
+void ConfigAutotuneWidget::saveStabilization()
+{
+    SystemIdent *systemIdent = SystemIdent::GetInstance(getObjectManager());
+
+    Q_ASSERT(systemIdent);
+    if (!systemIdent) {
         return;
     }
 
-    RelayTuning::DataFields relayTuningData = relayTuning->getData();
-    RelayTuningSettings::DataFields tuningSettingsData = relayTuningSettings->getData();
-    stabSettings = stabilizationSettings->getData();
+    SystemIdent::DataFields ident = systemIdent->getData();
+
+    switch (m_autotune->bankSelect->currentIndex()) {
+    case 0:
+        applyIdentifiedGains(StabilizationSettingsBank1::GetInstance(getObjectManager()), ident);
+        break;
+    case 1:
+        applyIdentifiedGains(StabilizationSettingsBank2::GetInstance(getObjectManager()), ident);
+        break;
+    case 2:
+        applyIdentifiedGains(StabilizationSettingsBank3::GetInstance(getObjectManager()), ident);
+        break;
+    }
+}
 
-    // Need to divide these by 100 because that is what the .ui file does
-    // to get the UAVO
-    const double gain_ratio_r = m_autotune->rateTuning->value() / 100.0;
-    const double zero_ratio_r = m_autotune->rateTuning->value() / 100.0;
-    const double gain_ratio_p = m_autotune->attitudeTuning->value() / 100.0;
-    const double zero_ratio_p = m_autotune->attitudeTuning->value() / 100.0;
+/**
+ * Called whenever the board publishes a new model, the gains are only
+ * shown for the axes that converged
+ */
+void ConfigAutotuneWidget::refreshIdent()
+{
+    SystemIdent *systemIdent = SystemIdent::GetInstance(getObjectManager());
 
-    // For now just run over roll and pitch
-    for (int i = 0; i < 2; i++) {
-        if (relayTuningData.Period[i] == 0 || relayTuningData.Gain[i] == 0) {
-            continue;
-        }
+    Q_ASSERT(systemIdent);
+    if (!systemIdent) {
+        return;
+    }
 
-        double wu  = 1000.0 * 2 * M_PI / relayTuningData.Period[i]; // ultimate freq = output osc freq (rad/s)
-
-        double wc  = wu * gain_ratio_r;      // target openloop crossover frequency (rad/s)
-        double zc  = wc * zero_ratio_r;      // controller zero location (rad/s)
-        double kpu = 4.0f / M_PI / relayTuningData.Gain[i]; // ultimate gain, i.e. the proportional gain for instablity
-        double kp  = kpu * gain_ratio_r;     // proportional gain
-        double ki  = zc * kp;                // integral gain
-
-        // Now calculate gains for the next loop out knowing it is the integral of
-        // the inner loop -- the plant is position/velocity = scale*1/s
-        double wc2 = wc * gain_ratio_p; // crossover of the attitude loop
-        double kp2 = wc2; // kp of attitude
-        double ki2 = wc2 * zero_ratio_p * kp2; // ki of attitude
-
-        switch (i) {
-        case 0: // Roll
-
-            stabSettings.RollRatePID[StabilizationSettings::ROLLRATEPID_KP] = kp;
-            stabSettings.RollRatePID[StabilizationSettings::ROLLRATEPID_KI] = ki;
-            stabSettings.RollPI[StabilizationSettings::ROLLPI_KP] = kp2;
-            stabSettings.RollPI[StabilizationSettings::ROLLPI_KI] = ki2;
-            break;
-        case 1: // Pitch
-            stabSettings.PitchRatePID[StabilizationSettings::PITCHRATEPID_KP] = kp;
-            stabSettings.PitchRatePID[StabilizationSettings::PITCHRATEPID_KI] = ki;
-            stabSettings.PitchPI[StabilizationSettings::PITCHPI_KP] = kp2;
-            stabSettings.PitchPI[StabilizationSettings::PITCHPI_KI] = ki2;
-            break;
+    SystemIdent::DataFields ident = systemIdent->getData();
+    int converged = 0;
+
+    for (int axis = 0; axis < 3; axis++) {
+        const bool valid = (ident.Converged[axis] == SystemIdent::CONVERGED_TRUE);
+        const float values[] = {
+            ident.Gain[axis],   ident.Tau[axis],    ident.Delay[axis], ident.Uncertainty[axis],
+            ident.RateKp[axis], ident.RateKi[axis], ident.RateKd[axis], ident.AttitudeKp[axis]
+        };
+
+        converged += valid ? 1 : 0;
+        for (int column = 0; column < 8; column++) {
+            QTableWidgetItem *item = m_autotune->identTable->item(axis, column);
+            if (column == 3) {
+                item->setText(QString("%1 %").arg(values[column], 0, 'f', 1));
+            } else if (column < 3 || valid) {
+                item->setText(QString::number(values[column], 'g', 4));
+            } else {
+                item->setText("-");
+            }
+            item->setForeground(valid ? palette().text() : palette().mid());
         }
     }
 
-    // Display these computed settings
-    m_autotune->rollRateKp->setText(QString().number(stabSettings.RollRatePID[StabilizationSettings::ROLLRATEPID_KP]));
-    m_autotune->rollRateKi->setText(QString().number(stabSettings.RollRatePID[StabilizationSettings::ROLLRATEPID_KI]));
-    m_autotune->rollAttitudeKp->setText(QString().number(stabSettings.RollPI[StabilizationSettings::ROLLPI_KP]));
-    m_autotune->rollAttitudeKi->setText(QString().number(stabSettings.RollPI[StabilizationSettings::ROLLPI_KI]));
-    m_autotune->pitchRateKp->setText(QString().number(stabSettings.PitchRatePID[StabilizationSettings::PITCHRATEPID_KP]));
-    m_autotune->pitchRateKi->setText(QString().number(stabSettings.PitchRatePID[StabilizationSettings::PITCHRATEPID_KI]));
-    m_autotune->pitchAttitudeKp->setText(QString().number(stabSettings.PitchPI[StabilizationSettings::PITCHPI_KP]));
-    m_autotune->pitchAttitudeKi->setText(QString().number(stabSettings.PitchPI[StabilizationSettings::PITCHPI_KI]));
+    m_autotune->identStatus->setText(tr("%1 samples at %2 ms, %3 of 3 axes converged")
+                                     .arg(ident.Samples).arg(ident.Period, 0, 'f', 2).arg(converged));
+    m_autotune->useComputedValues->setEnabled(converged > 0);
 }
+
 void ConfigAutotuneWidget::refreshWidgetsValues(UAVObject *obj)
 {
     HwSettings *hwSettings = HwSettings::GetInstance(getObjectManager());
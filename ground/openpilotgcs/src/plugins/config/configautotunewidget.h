@@ -32,11 +32,11 @@
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
 #include "uavobject.h"
-#include "stabilizationsettings.h"
-#include "relaytuningsettings.h"
-#include "relaytuning.h"
+#include "systemident.h"
+#include "uavobjectsamplestream.h"
 #include <QtWidgets/QWidget>
 #include <QTimer>
+#include <QContiguousCache>
 
 class ConfigAutotuneWidget : public ConfigTaskWidget {
     Q_OBJECT
@@ -45,7 +45,20 @@ public:
 
 private:
     Ui_AutotuneWidget *m_autotune;
-    StabilizationSettings::DataFields stabSettings;
+
+    // A sample of the stream, the segment changes where the stream does not follow on
+    typedef struct {
+        double time;
+        int    segment;
+        float  values[6];
+    } StreamSample;
+
+    // Ten minutes at 500Hz
+    static const int STREAM_CAPACITY = 300000;
+
+    UAVObjectSampleStream m_stream;
+    QContiguousCache<StreamSample> m_samples;
+    int m_segment;
 
 signals:
 
@@ -53,8 +66,10 @@ public slots:
     void refreshWidgetsValues(UAVObject *obj);
     void updateObjectsFromWidgets();
 private slots:
-    void recomputeStabilization();
+    void refreshIdent();
     void saveStabilization();
+    void streamUpdated(UAVObject *obj);
+    void exportSamples();
 };
 
 #endif // CONFIGAUTOTUNE_H
@@ -34,6 +34,7 @@
 #include "configstabilizationwidget.h"
 #include "configcamerastabilizationwidget.h"
 #include "configtxpidwidget.h"
+#include "configautotunewidget.h"
 #include "configrevohwwidget.h"
 #include "config_cc_hw_widget.h"
 #include "configoplinkwidget.h"
@@ -113,6 +114,12 @@ ConfigGadgetWidget::ConfigGadgetWidget(QWidget *parent) : QWidget(parent)
     qwd  = new ConfigTxPIDWidget(this);
     stackWidget->insertTab(ConfigGadgetWidget::txpid, qwd, *icon, QString("TxPID"));
 
+    icon = new QIcon();
+    icon->addFile(":/configgadget/images/autotune_normal.png", QSize(), QIcon::Normal, QIcon::Off);
+    icon->addFile(":/configgadget/images/autotune_selected.png", QSize(), QIcon::Selected, QIcon::Off);
+    qwd  = new ConfigAutotuneWidget(this);
+    stackWidget->insertTab(ConfigGadgetWidget::autotune, qwd, *icon, QString("Autotune"));
+
     stackWidget->setCurrentIndex(ConfigGadgetWidget::hardware);
 
     // Listen to autopilot connection events
@@ -67,12 +67,15 @@ ConfigOPLinkWidget::ConfigOPLinkWidget(QWidget *parent) : ConfigTaskWidget(paren
     addWidgetBinding("OPLinkSettings", "MaxRFPower", m_oplink->MaxRFTxPower);
     addWidgetBinding("OPLinkSettings", "MinChannel", m_oplink->MinimumChannel);
     addWidgetBinding("OPLinkSettings", "MaxChannel", m_oplink->MaximumChannel);
+    addWidgetBinding("OPLinkSettings", "FECParity", m_oplink->FECParity);
+    addWidgetBinding("OPLinkSettings", "FECInterleave", m_oplink->FECInterleave);
     addWidgetBinding("OPLinkSettings", "CoordID", m_oplink->CoordID);
     addWidgetBinding("OPLinkSettings", "Coordinator", m_oplink->Coordinator);
     addWidgetBinding("OPLinkSettings", "OneWay", m_oplink->OneWayLink);
     addWidgetBinding("OPLinkSettings", "PPMOnly", m_oplink->PPMOnly);
     addWidgetBinding("OPLinkSettings", "PPM", m_oplink->PPM);
     addWidgetBinding("OPLinkSettings", "ComSpeed", m_oplink->ComSpeed);
+    addWidgetBinding("OPLinkSettings", "AdaptiveRate", m_oplink->AdaptiveRate);
 
     addWidgetBinding("OPLinkStatus", "DeviceID", m_oplink->DeviceID);
     addWidgetBinding("OPLinkStatus", "RxGood", m_oplink->Good);
@@ -328,6 +331,10 @@ void ConfigOPLinkWidget::ppmOnlyChanged()
     m_oplink->PPM->setEnabled(!is_ppm_only);
     m_oplink->OneWayLink->setEnabled(!is_ppm_only);
     m_oplink->ComSpeed->setEnabled(!is_ppm_only);
+    m_oplink->AdaptiveRate->setEnabled(!is_ppm_only);
+    // PPM only packets have a CRC instead of the error correction
+    m_oplink->FECParity->setEnabled(!is_ppm_only);
+    m_oplink->FECInterleave->setEnabled(!is_ppm_only);
 }
 
 void ConfigOPLinkWidget::minChannelChanged()
@@ -38,6 +38,7 @@
 #include <QHBoxLayout>
 #include <QComboBox>
 #include <QEventLoop>
+#include <QMenu>
 
 namespace Core {
 ConnectionManager::ConnectionManager(Internal::MainWindow *mainWindow) :
@@ -69,6 +70,7 @@ ConnectionManager::ConnectionManager(Internal::MainWindow *mainWindow) :
 
     QObject::connect(m_connectBtn, SIGNAL(clicked()), this, SLOT(onConnectClicked()));
     QObject::connect(m_availableDevList, SIGNAL(currentIndexChanged(int)), this, SLOT(onDeviceSelectionChanged(int)));
+    QObject::connect(m_availableDevList, SIGNAL(customContextMenuRequested(QPoint)), this, SLOT(onDeviceListContextMenu(QPoint)));
 
     // setup our reconnect timers
     reconnect = new QTimer(this);
@@ -79,6 +81,7 @@ ConnectionManager::ConnectionManager(Internal::MainWindow *mainWindow) :
 
 ConnectionManager::~ConnectionManager()
 {
+    disconnectVehicles();
     disconnectDevice();
     suspendPolling();
 }
@@ -187,6 +190,50 @@ bool ConnectionManager::disconnectDevice()
     return true;
 }
 
+/**
+ *   Connect to device as an additional vehicle, the main connection is left as is.
+ *   Mind that most connection plugins can only open one device at a time.
+ */
+bool ConnectionManager::connectVehicle(DevListItem device)
+{
+    if (!device.connection || m_vehicleDevices.contains(device) ||
+        (m_ioDev && m_connectionDevice == device)) {
+        return false;
+    }
+
+    QIODevice *io_dev = device.connection->openDevice(device.device.name);
+    if (!io_dev) {
+        return false;
+    }
+
+    io_dev->open(QIODevice::ReadWrite);
+    if (!io_dev->isOpen()) {
+        return false;
+    }
+
+    m_vehicleDevices.append(device);
+    m_vehicleIoDevs.append(io_dev);
+
+    emit vehicleConnected(device.getConName(), io_dev);
+    return true;
+}
+
+/**
+ *   Disconnect all the additional vehicles
+ */
+void ConnectionManager::disconnectVehicles()
+{
+    while (!m_vehicleDevices.isEmpty()) {
+        DevListItem device = m_vehicleDevices.takeLast();
+        QIODevice *io_dev  = m_vehicleIoDevs.takeLast();
+
+        emit vehicleAboutToDisconnect(io_dev);
+        if (device.connection) {
+            device.connection->closeDevice(device.device.name);
+        }
+    }
+}
+
 /**
  *   Slot called when a plugin added an object to the core pool
  */
@@ -224,6 +271,15 @@ void ConnectionManager::aboutToRemoveObject(QObject *obj)
         m_ioDev = NULL;
     }
 
+    for (int i = m_vehicleDevices.size() - 1; i >= 0; --i) {
+        if (m_vehicleDevices.at(i).connection == connection) {
+            emit vehicleAboutToDisconnect(m_vehicleIoDevs.at(i));
+            connection->closeDevice(m_vehicleDevices.at(i).device.name);
+            m_vehicleDevices.removeAt(i);
+            m_vehicleIoDevs.removeAt(i);
+        }
+    }
+
     if (m_connectionsList.contains(connection)) {
         m_connectionsList.removeAt(m_connectionsList.indexOf(connection));
     }
@@ -247,6 +303,29 @@ void ConnectionManager::onDeviceSelectionChanged(int index)
     }
 }
 
+/**
+ *   Slot called when the user right clicks the device list, to manage additional vehicles
+ */
+void ConnectionManager::onDeviceListContextMenu(const QPoint &pos)
+{
+    QString deviceName = m_availableDevList->itemData(m_availableDevList->currentIndex(), Qt::ToolTipRole).toString();
+    DevListItem device = findDevice(deviceName);
+
+    QMenu menu;
+    QAction *connectAction    = menu.addAction(tr("Connect as additional vehicle"));
+    connectAction->setEnabled(device.connection && !m_vehicleDevices.contains(device) &&
+                              !(m_ioDev && m_connectionDevice == device));
+    QAction *disconnectAction = menu.addAction(tr("Disconnect additional vehicles (%1)").arg(m_vehicleDevices.size()));
+    disconnectAction->setEnabled(!m_vehicleDevices.isEmpty());
+
+    QAction *action = menu.exec(m_availableDevList->mapToGlobal(pos));
+    if (action == connectAction) {
+        connectVehicle(device);
+    } else if (action == disconnectAction) {
+        disconnectVehicles();
+    }
+}
+
 /**
  *   Slot called when the user clicks the connect/disconnect button
  */
@@ -103,6 +103,8 @@ public:
 
     bool connectDevice(DevListItem device);
     bool disconnectDevice();
+    bool connectVehicle(DevListItem device);
+    void disconnectVehicles();
     void suspendPolling();
     void resumePolling();
 
@@ -115,6 +117,9 @@ signals:
     void deviceConnected(QIODevice *device);
     void deviceAboutToDisconnect();
     void deviceDisconnected();
+    // additional vehicles, their telemetry runs next to the main connection
+    void vehicleConnected(const QString &name, QIODevice *device);
+    void vehicleAboutToDisconnect(QIODevice *device);
     void availableDevicesChanged(const QLinkedList<Core::DevListItem> devices);
 
 public slots:
@@ -127,6 +132,7 @@ private slots:
 
     void onConnectClicked();
     void onDeviceSelectionChanged(int index);
+    void onDeviceListContextMenu(const QPoint &pos);
     void devChanged(IConnection *connection);
 
     void onConnectionDestroyed(QObject *obj);
@@ -146,6 +152,10 @@ protected:
     // currently connected QIODevice
     QIODevice *m_ioDev;
 
+    // connected additional vehicles
+    QList<DevListItem> m_vehicleDevices;
+    QList<QIODevice *> m_vehicleIoDevs;
+
 private:
     bool connectDevice();
     bool polling;
@@ -81,6 +81,10 @@ public:
     virtual void saveState(QSettings * /*qSettings*/) {}
     virtual void restoreState(QByteArray) {}
     virtual void restoreState(QSettings * /*qSettings*/) {}
+    // Called when the workspace of the gadget is hidden and shown again.
+    // A suspended gadget should stop its timers and object subscriptions.
+    virtual void suspend() {}
+    virtual void resume() {}
 public slots:
     virtual void configurationChanged(IUAVGadgetConfiguration *) {}
     virtual void configurationAdded(IUAVGadgetConfiguration *) {}
@@ -32,6 +32,7 @@
 #include <QtCore/QMap>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
+#include <QtCore/QTimer>
 #include <QtCore/QVariant>
 
 #include <QtSql/QSqlDatabase>
@@ -48,6 +49,10 @@
     is asked for. It also does incremental updates of the database rather than
     rewriting the whole file each time one of the settings change.
 
+    Changes are applied to the in-memory cache at once and written out later,
+    all the changes of a write delay in a single transaction, so a burst of
+    small changes costs one commit on disk. sync() writes them out immediately.
+
     The SettingsDatabase API mimics that of QSettings.
  */
 
@@ -56,6 +61,9 @@ using namespace Core::Internal;
 
 enum { debug_settings = 0 };
 
+// Changes made within this delay (ms) are written out in the same transaction
+static const int WRITE_DELAY = 1000;
+
 namespace Core {
 namespace Internal {
 typedef QMap<QString, QVariant> SettingsMap;
@@ -81,9 +89,12 @@ public:
     SettingsMap m_settings;
 
     QStringList m_groups;
+    // Keys set and key prefixes removed since the last write, removals are written first
     QStringList m_dirtyKeys;
+    QStringList m_removedKeys;
 
     QSqlDatabase m_db;
+    QTimer m_writeTimer;
 };
 } // namespace Internal
 } // namespace Core
@@ -110,6 +121,10 @@ SettingsDatabase::SettingsDatabase(const QString &path,
     fileName += application;
     fileName += QLatin1String(".db");
 
+    d->m_writeTimer.setSingleShot(true);
+    d->m_writeTimer.setInterval(WRITE_DELAY);
+    connect(&d->m_writeTimer, &QTimer::timeout, this, &SettingsDatabase::sync);
+
     d->m_db   = QSqlDatabase::addDatabase("QSQLITE", QLatin1String("settings"));
     d->m_db.setDatabaseName(fileName);
     if (!d->m_db.open()) {
@@ -154,15 +169,12 @@ void SettingsDatabase::setValue(const QString &key, const QVariant &value)
         return;
     }
 
-    // Instant apply (TODO: Delay writing out settings)
-    QSqlQuery query(d->m_db);
-    query.prepare(QLatin1String("INSERT INTO settings VALUES (?, ?)"));
-    query.addBindValue(effectiveKey);
-    query.addBindValue(value);
-    query.exec();
-
-    if (debug_settings) {
-        qDebug() << "Stored:" << effectiveKey << "=" << value;
+    // Delay writing out settings
+    if (!d->m_dirtyKeys.contains(effectiveKey)) {
+        d->m_dirtyKeys.append(effectiveKey);
+    }
+    if (!d->m_writeTimer.isActive()) {
+        d->m_writeTimer.start();
     }
 }
 
@@ -173,7 +185,10 @@ QVariant SettingsDatabase::value(const QString &key, const QVariant &defaultValu
 
     SettingsMap::const_iterator i = d->m_settings.constFind(effectiveKey);
 
-    if (i != d->m_settings.constEnd() && i.value().isValid()) {
+    if (i == d->m_settings.constEnd()) {
+        // All the keys of the database are known, a removal might not be written out yet
+        return value;
+    } else if (i.value().isValid()) {
         value = i.value();
     } else if (d->m_db.isOpen()) {
         // Try to read the value from the database
@@ -219,12 +234,19 @@ void SettingsDatabase::remove(const QString &key)
         return;
     }
 
-    // Delete keys from the database
-    QSqlQuery query(d->m_db);
-    query.prepare(QLatin1String("DELETE FROM settings WHERE key = ? OR key LIKE ?"));
-    query.addBindValue(effectiveKey);
-    query.addBindValue(QString(effectiveKey + QLatin1String("/%")));
-    query.exec();
+    // Pending writes of the removed keys are dropped, the keys are deleted from the database later
+    QStringList::iterator k = d->m_dirtyKeys.begin();
+    while (k != d->m_dirtyKeys.end()) {
+        if (!d->m_settings.contains(*k)) {
+            k = d->m_dirtyKeys.erase(k);
+        } else {
+            ++k;
+        }
+    }
+    d->m_removedKeys.append(effectiveKey);
+    if (!d->m_writeTimer.isActive()) {
+        d->m_writeTimer.start();
+    }
 }
 
 void SettingsDatabase::beginGroup(const QString &prefix)
@@ -261,5 +283,45 @@ QStringList SettingsDatabase::childKeys() const
 
 void SettingsDatabase::sync()
 {
-    // TODO: Delay writing of dirty keys and save them here
+    d->m_writeTimer.stop();
+
+    if (!d->m_db.isOpen() || (d->m_dirtyKeys.isEmpty() && d->m_removedKeys.isEmpty())) {
+        return;
+    }
+
+    d->m_db.transaction();
+
+    QSqlQuery query(d->m_db);
+    if (!d->m_removedKeys.isEmpty()) {
+        query.prepare(QLatin1String("DELETE FROM settings WHERE key = ? OR key LIKE ?"));
+        foreach(const QString &key, d->m_removedKeys) {
+            query.bindValue(0, key);
+            query.bindValue(1, QString(key + QLatin1String("/%")));
+            query.exec();
+        }
+    }
+
+    if (!d->m_dirtyKeys.isEmpty()) {
+        query.prepare(QLatin1String("INSERT INTO settings VALUES (?, ?)"));
+        foreach(const QString &key, d->m_dirtyKeys) {
+            const QVariant value = d->m_settings.value(key);
+            query.bindValue(0, key);
+            query.bindValue(1, value);
+            query.exec();
+
+            if (debug_settings) {
+                qDebug() << "Stored:" << key << "=" << value;
+            }
+        }
+    }
+
+    if (!d->m_db.commit()) {
+        qWarning().nospace() << "Warning: Failed to write settings database! ("
+                             << d->m_db.lastError().driverText() << ")";
+        d->m_db.rollback();
+        return;
+    }
+
+    d->m_dirtyKeys.clear();
+    d->m_removedKeys.clear();
 }
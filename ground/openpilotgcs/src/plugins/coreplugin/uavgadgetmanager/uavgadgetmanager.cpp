@@ -86,7 +86,9 @@ UAVGadgetManager::UAVGadgetManager(ICore *core, QString name, QIcon icon, int pr
     m_name(name),
     m_icon(icon),
     m_priority(priority),
-    m_widget(new QWidget(parent))
+    m_widget(new QWidget(parent)),
+    m_restorePending(false),
+    m_suspended(false)
 {
     // checking that the mode name is unique gives harmless
     // warnings on the console output
@@ -122,6 +124,9 @@ UAVGadgetManager::UAVGadgetManager(ICore *core, QString name, QIcon icon, int pr
     layout->addWidget(m_splitterOrView);
 
     showToolbars(m_showToolbars);
+
+    // The gadgets are created when the workspace is first shown, and suspended while it is hidden
+    m_widget->installEventFilter(this);
 }
 
 UAVGadgetManager::~UAVGadgetManager()
@@ -345,8 +350,16 @@ void UAVGadgetManager::saveSettings(QSettings *qs)
     // Make sure the old tree is wiped.
     qs->remove("");
 
-    // Do actual saving
-    saveState(qs);
+    // Do actual saving, a workspace never shown still has the state it was read with
+    if (m_restorePending) {
+        QMapIterator<QString, QVariant> i(m_pendingState);
+        while (i.hasNext()) {
+            i.next();
+            qs->setValue(i.key(), i.value());
+        }
+    } else {
+        saveState(qs);
+    }
 
     qs->endGroup();
     qs->endGroup();
@@ -367,7 +380,19 @@ void UAVGadgetManager::readSettings(QSettings *qs)
     }
     qs->beginGroup(uniqueModeName());
 
-    restoreState(qs);
+    if (m_widget->isVisible()) {
+        restoreState(qs);
+        m_restorePending = false;
+        m_pendingState.clear();
+    } else {
+        // Creating the gadgets of a hidden workspace is deferred until it is shown
+        m_pendingState.clear();
+        foreach(const QString &key, qs->allKeys()) {
+            m_pendingState.insert(key, qs->value(key));
+        }
+        m_showToolbars   = qs->value("showToolbars", m_showToolbars).toBool();
+        m_restorePending = true;
+    }
 
     showToolbars(m_showToolbars);
 
@@ -375,6 +400,64 @@ void UAVGadgetManager::readSettings(QSettings *qs)
     qs->endGroup();
 }
 
+/**
+ * Creates the gadgets of the workspace from the state read while it was hidden.
+ * The state is staged in the application settings, where it is saved from anyway.
+ */
+void UAVGadgetManager::restorePendingState()
+{
+    if (!m_restorePending) {
+        return;
+    }
+    m_restorePending = false;
+
+    QSettings *qs = m_core->settings();
+    qs->beginGroup("UAVGadgetManager");
+    qs->beginGroup(uniqueModeName());
+    qs->remove("");
+    QMapIterator<QString, QVariant> i(m_pendingState);
+    while (i.hasNext()) {
+        i.next();
+        qs->setValue(i.key(), i.value());
+    }
+    m_pendingState.clear();
+
+    restoreState(qs);
+    showToolbars(m_showToolbars);
+
+    qs->endGroup();
+    qs->endGroup();
+}
+
+void UAVGadgetManager::setSuspended(bool suspended)
+{
+    if (m_suspended == suspended) {
+        return;
+    }
+    m_suspended = suspended;
+
+    foreach(IUAVGadget * gadget, m_splitterOrView->gadgets()) {
+        if (suspended) {
+            gadget->suspend();
+        } else {
+            gadget->resume();
+        }
+    }
+}
+
+bool UAVGadgetManager::eventFilter(QObject *obj, QEvent *event)
+{
+    if (obj == m_widget) {
+        if (event->type() == QEvent::Show) {
+            restorePendingState();
+            setSuspended(false);
+        } else if (event->type() == QEvent::Hide) {
+            setSuspended(true);
+        }
+    }
+    return IMode::eventFilter(obj, event);
+}
+
 void UAVGadgetManager::split(Qt::Orientation orientation)
 {
     if (m_core->modeManager()->currentMode() != this) {
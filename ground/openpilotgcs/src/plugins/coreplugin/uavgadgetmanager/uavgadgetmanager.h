@@ -36,6 +36,7 @@
 
 #include <QWidget>
 #include <QtCore/QList>
+#include <QtCore/QMap>
 #include <QtCore/QPointer>
 #include <QtCore/QSettings>
 #include <QIcon>
@@ -105,6 +106,8 @@ public:
         return m_showToolbars;
     }
 
+    bool eventFilter(QObject *obj, QEvent *event);
+
 signals:
     void currentGadgetChanged(IUAVGadget *gadget);
     void showUavGadgetMenus(bool show, bool hasSplitter);
@@ -132,6 +135,8 @@ private:
     void closeView(Core::Internal::UAVGadgetView *view);
     void emptyView(Core::Internal::UAVGadgetView *view);
     Core::Internal::SplitterOrView *currentSplitterOrView() const;
+    void restorePendingState();
+    void setSuspended(bool suspended);
 
     bool m_showToolbars;
     Core::Internal::SplitterOrView *m_splitterOrView;
@@ -146,6 +151,11 @@ private:
     const char *m_uniqueModeName;
     QWidget *m_widget;
 
+    // The saved workspace, restored when the workspace is first shown
+    QMap<QString, QVariant> m_pendingState;
+    bool m_restorePending;
+    bool m_suspended;
+
     friend class Core::Internal::SplitterOrView;
     friend class Core::Internal::UAVGadgetView;
 };
@@ -1,8 +1,14 @@
 #include "debugengine.h"
 
-debugengine::debugengine()
+#include <stdio.h>
+#include <stdlib.h>
+
+debugengine::debugengine() : m_writePos(0), m_readPos(0), m_dropped(0), m_previousHandler(0)
 {
-    mut_lock = new QMutex(QMutex::Recursive);
+    for (int i = 0; i < RING_SIZE; i++) {
+        m_ring[i].sequence.store(i);
+    }
+    connect(&m_drainTimer, SIGNAL(timeout()), this, SLOT(drain()));
 }
 
 debugengine *debugengine::getInstance()
@@ -14,31 +20,100 @@ debugengine *debugengine::getInstance()
 
 debugengine::~debugengine()
 {
-    delete mut_lock;
-    mut_lock = NULL;
+    removeMessageHandler();
 }
 
-void debugengine::setTextEdit(QTextBrowser *textEdit)
+// Must be called from the GUI thread, the ring is drained there
+void debugengine::installMessageHandler()
 {
-    QMutexLocker lock(mut_lock);
+    if (!m_drainTimer.isActive()) {
+        m_previousHandler = qInstallMessageHandler(messageHandler);
+        m_drainTimer.start(DRAIN_INTERVAL);
+    }
+}
 
-    _textEdit = textEdit;
+void debugengine::removeMessageHandler()
+{
+    if (m_drainTimer.isActive()) {
+        m_drainTimer.stop();
+        qInstallMessageHandler(m_previousHandler);
+        m_previousHandler = 0;
+    }
 }
 
-void debugengine::writeMessage(const QString &message)
+void debugengine::messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
 {
-    QMutexLocker lock(mut_lock);
+    debugengine *engine = getInstance();
+
+    // The messages still go where they went before
+    if (engine->m_previousHandler) {
+        engine->m_previousHandler(type, context, msg);
+    } else {
+        fprintf(stderr, "%s\n", msg.toLocal8Bit().constData());
+    }
 
-    if (_textEdit) {
-        _textEdit->append(message);
+    if (type == QtFatalMsg) {
+        abort();
     }
+    engine->postMessage(type, msg);
 }
 
-void debugengine::setColor(const QColor &c)
+/**
+ * Posts a message from any thread.
+ * Returns false when the ring is full and the message was dropped.
+ */
+bool debugengine::postMessage(QtMsgType type, const QString &text)
 {
-    QMutexLocker lock(mut_lock);
+    quint32 pos = m_writePos.load();
+
+    forever {
+        Slot &slot = m_ring[pos & (RING_SIZE - 1)];
+        // The positions wrap around, their distance is signed
+        qint32 diff = (qint32)(slot.sequence.loadAcquire() - pos);
+        if (diff == 0) {
+            // The slot is free for this position, claim it
+            if (m_writePos.testAndSetRelaxed(pos, pos + 1)) {
+                slot.message.type = type;
+                slot.message.text = text;
+                slot.sequence.storeRelease(pos + 1);
+                return true;
+            }
+            pos = m_writePos.load();
+        } else if (diff < 0) {
+            // The slot still holds the message of the previous lap
+            m_dropped.ref();
+            return false;
+        } else {
+            // Another thread claimed the position
+            pos = m_writePos.load();
+        }
+    }
+}
+
+void debugengine::drain()
+{
+    QList<DebugMessage> messages;
+
+    forever {
+        Slot &slot = m_ring[m_readPos & (RING_SIZE - 1)];
+        if ((qint32)(slot.sequence.loadAcquire() - (m_readPos + 1)) < 0) {
+            break;
+        }
+        messages.append(slot.message);
+        slot.message.text = QString();
+        slot.sequence.storeRelease(m_readPos + RING_SIZE);
+        m_readPos++;
+    }
+
+    int dropped = m_dropped.fetchAndStoreRelaxed(0);
+    if (dropped > 0) {
+        DebugMessage message;
+        message.type = QtWarningMsg;
+        message.text = QString("%1 debug messages dropped").arg(dropped);
+        messages.append(message);
+    }
 
-    if (_textEdit) {
-        _textEdit->setTextColor(c);
+    if (!messages.isEmpty()) {
+        emit messagesReceived(messages);
     }
 }
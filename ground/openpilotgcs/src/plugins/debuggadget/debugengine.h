@@ -1,21 +1,57 @@
 #ifndef DEBUGENGINE_H
 #define DEBUGENGINE_H
-#include <QTextBrowser>
-#include <QPointer>
-#include <QMutex>
+#include <QObject>
+#include <QAtomicInteger>
+#include <QList>
+#include <QString>
+#include <QTimer>
 
-class debugengine {
+struct DebugMessage {
+    QtMsgType type;
+    QString   text;
+};
+
+/*
+ * Collects the Qt debug messages of all threads in a bounded ring.
+ * Posting a message takes no lock; when the ring is full the message is dropped and counted.
+ * The GUI thread drains the ring once per frame and hands the batch to the debug gadgets.
+ */
+class debugengine : public QObject {
+    Q_OBJECT
 // Add all missing constructor etc... to have singleton
     debugengine();
     ~debugengine();
 public:
     static debugengine *getInstance();
-    void setTextEdit(QTextBrowser *textEdit);
-    void writeMessage(const QString &message);
-    void setColor(const QColor &c);
-    QMutex *mut_lock;
+    static void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg);
+
+    void installMessageHandler();
+    void removeMessageHandler();
+    bool postMessage(QtMsgType type, const QString &text);
+
+signals:
+    void messagesReceived(const QList<DebugMessage> &messages);
+
+private slots:
+    void drain();
+
 private:
-    QPointer<QTextBrowser> _textEdit;
+    // Must be a power of 2
+    static const int RING_SIZE = 4096;
+    static const int DRAIN_INTERVAL = 40;
+
+    // The sequence number tells whether a slot is free for the position, or holds its message
+    struct Slot {
+        QAtomicInteger<quint32> sequence;
+        DebugMessage message;
+    };
+
+    Slot m_ring[RING_SIZE];
+    QAtomicInteger<quint32> m_writePos;
+    quint32 m_readPos;
+    QAtomicInt m_dropped;
+    QTimer m_drainTimer;
+    QtMessageHandler m_previousHandler;
 };
 
 #endif // DEBUGENGINE_H
@@ -37,50 +37,18 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QScrollBar>
+#include <QTextCursor>
 #include <QTime>
 
-QPointer<QTextBrowser> m_textedit;
-
-void DebugGadgetWidget::customMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
-{
-    Q_UNUSED(context);
-    QString txt;
-    QColor color = Qt::black;
-
-    switch (type) {
-    case QtDebugMsg:
-        txt   = QString("Debug: %1").arg(msg);
-        color = Qt::black;
-        break;
-    case QtWarningMsg:
-        txt   = QString("Warning: %1").arg(msg);
-        color = Qt::red;
-        break;
-    case QtCriticalMsg:
-        txt   = QString("Critical: %1").arg(msg);
-        color = Qt::red;
-        break;
-    case QtFatalMsg:
-        txt   = QString("Fatal: %1").arg(msg);
-        abort();
-    }
-
-    debugengine::getInstance()->setTextEdit(m_textedit);
-    debugengine::getInstance()->setColor(color);
-    debugengine::getInstance()->writeMessage(txt);
-}
-
 DebugGadgetWidget::DebugGadgetWidget(QWidget *parent) : QLabel(parent)
 {
     m_config = new Ui_Form();
     m_config->setupUi(this);
 
-    // m_textedit = m_config->plainTextEdit;
-    // MyplainTextEdit=m_config->plainTextEdit;
-    // debugengine *de = new debugengine();
-    // qInstallMessageHandler(customMessageHandler);
-    // connect(de, SIGNAL(dbgMsg(QString, QList<QVariant>)), this, SLOT(dbgMsg(QString, QList<QVariant>)));
-    // connect(de, SIGNAL(dbgMsgError(QString, QList<QVariant>)), this, SLOT(dbgMsgError(QString, QList<QVariant>)));
+    m_config->plainTextEdit->document()->setMaximumBlockCount(MAX_LINES);
+
+    debugengine *de = debugengine::getInstance();
+    connect(de, &debugengine::messagesReceived, this, &DebugGadgetWidget::appendMessages);
     connect(m_config->pushButton, SIGNAL(clicked()), this, SLOT(saveLog()));
 }
 
@@ -89,26 +57,58 @@ DebugGadgetWidget::~DebugGadgetWidget()
     // Do nothing
 }
 
-void DebugGadgetWidget::dbgMsg(const QString &level, const QList<QVariant> &msgs)
+/**
+ * Appends the messages of a frame in a single document update.
+ * Only the messages containing the filter text are shown.
+ */
+void DebugGadgetWidget::appendMessages(const QList<DebugMessage> &messages)
 {
-    m_config->plainTextEdit->setTextColor(Qt::red);
-
-    m_config->plainTextEdit->append(QString("%2[%0]%1").arg(level).arg(msgs[0].toString()).arg(QTime::currentTime().toString()));
+    QString filter  = m_config->filterEdit->text();
+    QScrollBar *sb  = m_config->plainTextEdit->verticalScrollBar();
+    bool atBottom   = sb->value() == sb->maximum();
+    QString time    = QTime::currentTime().toString();
+
+    QTextCharFormat debugFormat;
+    debugFormat.setForeground(Qt::black);
+    QTextCharFormat errorFormat;
+    errorFormat.setForeground(Qt::red);
+
+    QTextCursor cursor(m_config->plainTextEdit->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.beginEditBlock();
+    foreach(const DebugMessage &message, messages) {
+        if (!filter.isEmpty() && !message.text.contains(filter, Qt::CaseInsensitive)) {
+            continue;
+        }
+        QString level;
+        switch (message.type) {
+        case QtDebugMsg:
+            level = "Debug";
+            break;
+        case QtWarningMsg:
+            level = "Warning";
+            break;
+        case QtCriticalMsg:
+            level = "Critical";
+            break;
+        case QtFatalMsg:
+            level = "Fatal";
+            break;
+        }
+        if (!cursor.atStart()) {
+            cursor.insertBlock();
+        }
+        cursor.insertText(QString("%1[%2] %3").arg(time).arg(level).arg(message.text),
+                          message.type == QtDebugMsg ? debugFormat : errorFormat);
+    }
+    cursor.endEditBlock();
 
-    QScrollBar *sb = m_config->plainTextEdit->verticalScrollBar();
-    sb->setValue(sb->maximum());
+    // Follow the new messages, unless scrolled back
+    if (atBottom) {
+        sb->setValue(sb->maximum());
+    }
 }
 
-void DebugGadgetWidget::dbgMsgError(const QString &level, const QList<QVariant> &msgs)
-{
-    m_config->plainTextEdit->setTextColor(Qt::black);
-
-
-    m_config->plainTextEdit->append(QString("%2[%0]%1").arg(level).arg(msgs[0].toString()).arg(QTime::currentTime().toString()));
-
-    QScrollBar *sb = m_config->plainTextEdit->verticalScrollBar();
-    sb->setValue(sb->maximum());
-}
 void DebugGadgetWidget::saveLog()
 {
     QString fileName = QFileDialog::getSaveFileName(0, tr("Save log File As"), "");
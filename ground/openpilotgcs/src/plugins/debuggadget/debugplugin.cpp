@@ -26,6 +26,7 @@
  */
 #include "debugplugin.h"
 #include "debuggadgetfactory.h"
+#include "debugengine.h"
 #include <QDebug>
 #include <QtPlugin>
 #include <QStringList>
@@ -49,6 +50,9 @@ bool DebugPlugin::initialize(const QStringList & args, QString *errMsg)
     mf = new DebugGadgetFactory(this);
     addAutoReleasedObject(mf);
 
+    // Collect the debug messages of the GCS for the debug gadgets
+    debugengine::getInstance()->installMessageHandler();
+
     return true;
 }
 
@@ -59,5 +63,5 @@ void DebugPlugin::extensionsInitialized()
 
 void DebugPlugin::shutdown()
 {
-    // Do nothing
+    debugengine::getInstance()->removeMessageHandler();
 }
@@ -30,6 +30,8 @@
 #include <utils/stylehelper.h>
 #include <iostream>
 #include <QtOpenGL/QGLWidget>
+#include <QGuiApplication>
+#include <QScreen>
 #include <QDebug>
 
 DialGadgetWidget::DialGadgetWidget(QWidget *parent) : QGraphicsView(parent)
@@ -40,7 +42,7 @@ DialGadgetWidget::DialGadgetWidget(QWidget *parent) : QGraphicsView(parent)
     setMinimumSize(64, 64);
     setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::MinimumExpanding);
     setScene(new QGraphicsScene(this));
-    setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing);
+    setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing | QPainter::SmoothPixmapTransform);
 
     m_renderer = new QSvgRenderer();
 
@@ -51,6 +53,10 @@ DialGadgetWidget::DialGadgetWidget(QWidget *parent) : QGraphicsView(parent)
     m_text2 = NULL;
     m_text3 = NULL; // Should be initialized to NULL otherwise the setFont method
                     // might segfault upon initialization if called before SetDialFile
+    m_needle1 = NULL;
+    m_needle2 = NULL;
+    m_needle3 = NULL;
+    dialError = true;
 
     needle1Target = 0;
     needle2Target = 0;
@@ -59,7 +65,10 @@ DialGadgetWidget::DialGadgetWidget(QWidget *parent) : QGraphicsView(parent)
 // beSmooth = true;
     beSmooth = false;
 
-    // This timer mechanism makes needles rotate smoothly
+    // This timer mechanism makes needles rotate smoothly, it moves them
+    // once per display refresh: faster would only draw frames nobody sees.
+    int refreshRate = qRound(QGuiApplication::primaryScreen()->refreshRate());
+    dialTimer.setInterval(1000 / qMax(refreshRate, 1));
     connect(&dialTimer, SIGNAL(timeout()), this, SLOT(rotateNeedles()));
 }
 
@@ -88,24 +97,26 @@ void DialGadgetWidget::connectNeedles(QString object1, QString nfield1,
                                       QString object3, QString nfield3)
 {
     if (obj1 != NULL) {
-        disconnect(obj1, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle1(UAVObject *)));
+        disconnect(obj1, SIGNAL(objectUpdatedCoalesced(UAVObject *)), this, SLOT(updateNeedle1(UAVObject *)));
     }
     if (obj2 != NULL) {
-        disconnect(obj2, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle2(UAVObject *)));
+        disconnect(obj2, SIGNAL(objectUpdatedCoalesced(UAVObject *)), this, SLOT(updateNeedle2(UAVObject *)));
     }
     if (obj3 != NULL) {
-        disconnect(obj3, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle3(UAVObject *)));
+        disconnect(obj3, SIGNAL(objectUpdatedCoalesced(UAVObject *)), this, SLOT(updateNeedle3(UAVObject *)));
     }
 
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
 
     // Check validity of arguments first, reject empty args and unknown fields.
+    // The needles are only redrawn once per display refresh, however
+    // often the objects get updated.
     if (!(object1.isEmpty() || nfield1.isEmpty())) {
         obj1 = dynamic_cast<UAVDataObject *>(objManager->getObject(object1));
         if (obj1 != NULL) {
             // qDebug() << "Connected Object 1 (" << object1 << ").";
-            connect(obj1, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle1(UAVObject *)));
+            objManager->connectCoalesced(obj1, this, SLOT(updateNeedle1(UAVObject *)));
             if (nfield1.contains("-")) {
                 QStringList fieldSubfield = nfield1.split("-", QString::SkipEmptyParts);
                 field1        = fieldSubfield.at(0);
@@ -125,7 +136,7 @@ void DialGadgetWidget::connectNeedles(QString object1, QString nfield1,
         obj2 = dynamic_cast<UAVDataObject *>(objManager->getObject(object2));
         if (obj2 != NULL) {
             // qDebug() << "Connected Object 2 (" << object2 << ").";
-            connect(obj2, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle2(UAVObject *)));
+            objManager->connectCoalesced(obj2, this, SLOT(updateNeedle2(UAVObject *)));
             if (nfield2.contains("-")) {
                 QStringList fieldSubfield = nfield2.split("-", QString::SkipEmptyParts);
                 field2        = fieldSubfield.at(0);
@@ -145,7 +156,7 @@ void DialGadgetWidget::connectNeedles(QString object1, QString nfield1,
         obj3 = dynamic_cast<UAVDataObject *>(objManager->getObject(object3));
         if (obj3 != NULL) {
             // qDebug() << "Connected Object 3 (" << object3 << ").";
-            connect(obj3, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle3(UAVObject *)));
+            objManager->connectCoalesced(obj3, this, SLOT(updateNeedle3(UAVObject *)));
             if (nfield3.contains("-")) {
                 QStringList fieldSubfield = nfield3.split("-", QString::SkipEmptyParts);
                 field3        = fieldSubfield.at(0);
@@ -255,7 +266,11 @@ void DialGadgetWidget::setDialFile(QString dfn, QString bg, QString fg, QString
         // All other items will be clipped to the shape of the background
         m_background->setFlags(QGraphicsItem::ItemClipsChildrenToShape |
                                QGraphicsItem::ItemClipsToShape);
+        // The background and foreground never change: keep them rendered at
+        // the resolution of the screen instead of drawing the SVG each frame.
+        m_background->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
         m_foreground = new QGraphicsSvgItem();
+        m_foreground->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
         m_needle1    = new QGraphicsSvgItem();
         m_needle2    = new QGraphicsSvgItem();
         m_needle3    = new QGraphicsSvgItem();
@@ -424,6 +439,7 @@ void DialGadgetWidget::setDialFile(QString dfn, QString bg, QString fg, QString
             dialTimer.start();
         }
         dialError = false;
+        updateNeedleCache();
     } else {
         qDebug() << "no file: display default background.";
         m_renderer->load(QString(":/dial/images/empty.svg"));
@@ -463,6 +479,33 @@ void DialGadgetWidget::resizeEvent(QResizeEvent *event)
 {
     Q_UNUSED(event);
     fitInView(m_background, Qt::KeepAspectRatio);
+    updateNeedleCache();
+}
+
+/*
+   The needles are cached as pixmaps in their own coordinates, which are only
+   transformed as the needles move. The pixmaps are sized for the current
+   scale of the view and the pixel ratio of the screen to stay sharp.
+ */
+void DialGadgetWidget::updateNeedleCache()
+{
+    if (dialError) {
+        return;
+    }
+    qreal scale = transform().m11() * devicePixelRatio();
+
+    QList<QGraphicsSvgItem *> needles;
+    needles << m_needle1;
+    if (n2enabled && m_needle2 != m_needle1) {
+        needles << m_needle2;
+    }
+    if (n3enabled) {
+        needles << m_needle3;
+    }
+    foreach(QGraphicsSvgItem * needle, needles) {
+        QSize size = (needle->boundingRect().size() * scale).toSize();
+        needle->setCacheMode(QGraphicsItem::ItemCoordinateCache, size);
+    }
 }
 
 void DialGadgetWidget::setDialFont(QString fontProps)
@@ -115,6 +115,8 @@ private slots:
     void rotateNeedles();
 
 private:
+    void updateNeedleCache();
+
     QSvgRenderer *m_renderer;
     QGraphicsSvgItem *m_background;
     QGraphicsSvgItem *m_foreground;
@@ -1,7 +1,7 @@
 TEMPLATE = lib 
 TARGET = FlightLog
 
-QT += qml quick
+QT += qml quick concurrent
 
 include(../../openpilotgcsplugin.pri)
 include(../../plugins/coreplugin/coreplugin.pri)
@@ -10,9 +10,20 @@ include(../../plugins/uavobjectutil/uavobjectutil.pri)
 include(../../plugins/uavtalk/uavtalk.pri)
 
 HEADERS += flightlogplugin.h \
-    flightlogmanager.h
+    flightlogmanager.h \
+    kmzexport.h
 SOURCES += flightlogplugin.cpp \
-    flightlogmanager.cpp
+    flightlogmanager.cpp \
+    kmzexport.cpp
+
+# the deflate half of the zlib glc_lib carries, for the kmz export
+ZLIBDIR = ../../libs/glc_lib/3rdparty/zlib
+INCLUDEPATH += $$ZLIBDIR
+SOURCES += $$ZLIBDIR/adler32.c \
+    $$ZLIBDIR/crc32.c \
+    $$ZLIBDIR/deflate.c \
+    $$ZLIBDIR/trees.c \
+    $$ZLIBDIR/zutil.c
 
 OTHER_FILES += Flightlog.pluginspec \
     FlightLogDialog.qml \
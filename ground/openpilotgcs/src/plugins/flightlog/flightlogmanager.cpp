@@ -33,18 +33,26 @@
 #include <QXmlStreamReader>
 #include <QMessageBox>
 #include <QDebug>
+#include <QTimer>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
 
 #include "debuglogcontrol.h"
 #include "uavobjecthelper.h"
 #include "uavtalk/uavtalk.h"
+#include "uavtalk/uavtalklogdecoder.h"
 #include "utils/logfile.h"
 #include "uavdataobject.h"
+#include "gpspositionsensor.h"
+#include "kmzexport.h"
 #include <uavobjectutil/uavobjectutilmanager.h>
 
 FlightLogManager::FlightLogManager(QObject *parent) :
     QObject(parent), m_disableControls(false),
     m_disableExport(true), m_cancelDownload(false),
-    m_adjustExportedTimestamps(true)
+    m_adjustExportedTimestamps(true), m_burstLoop(0),
+    m_burstFlight(-1), m_burstSlot(-1)
 {
     ExtensionSystem::PluginManager *pluginManager = ExtensionSystem::PluginManager::instance();
 
@@ -69,6 +77,18 @@ FlightLogManager::FlightLogManager(QObject *parent) :
     m_flightLogEntry    = DebugLogEntry::GetInstance(m_objectManager);
     Q_ASSERT(m_flightLogEntry);
 
+    // a burst is answered with one DebugLogEntry instance per entry
+    m_burstEntries.resize(BURST_SIZE);
+    m_burstReceived.fill(false, BURST_SIZE);
+    for (int i = 0; i < BURST_SIZE; i++) {
+        DebugLogEntry *instance = DebugLogEntry::GetInstance(m_objectManager, i);
+        if (!instance) {
+            instance = static_cast<DebugLogEntry *>(m_flightLogEntry->clone(i));
+            m_objectManager->registerObject(instance);
+        }
+        connect(instance, SIGNAL(objectUnpacked(UAVObject *)), this, SLOT(burstEntryReceived(UAVObject *)));
+    }
+
     m_flightLogSettings = DebugLogSettings::GetInstance(m_objectManager);
     Q_ASSERT(m_flightLogSettings);
 
@@ -191,8 +211,6 @@ void FlightLogManager::retrieveLogs(int flightToRetrieve)
     setDisableControls(true);
     QApplication::setOverrideCursor(Qt::WaitCursor);
     m_cancelDownload = false;
-    UAVObjectUpdaterHelper updateHelper;
-    UAVObjectRequestHelper requestHelper;
 
     clearLogList();
 
@@ -200,59 +218,32 @@ void FlightLogManager::retrieveLogs(int flightToRetrieve)
     int startFlight = (flightToRetrieve == -1) ? 0 : flightToRetrieve;
     int endFlight   = (flightToRetrieve == -1) ? m_flightLogStatus->getFlight() : flightToRetrieve;
 
-    // Prepare to send request for event retrieval
-    m_flightLogControl->setOperation(DebugLogControl::OPERATION_RETRIEVE);
+    // Raw entries of each flight are unpacked on a worker thread while the next flight is downloaded
+    QList<QFuture<QVector<DebugLogEntry::DataFields> > > flights;
     for (int flight = startFlight; flight <= endFlight; flight++) {
-        m_flightLogControl->setFlight(flight);
+        QList<DebugLogEntry::DataFields> blocks;
         bool gotLast = false;
         int slot     = 0;
         while (!gotLast) {
-            // Send request for loading flight entry on flight side and wait for ack/nack
-            m_flightLogControl->setEntry(slot);
-
-            if (updateHelper.doObjectAndWait(m_flightLogControl, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS &&
-                requestHelper.doObjectAndWait(m_flightLogEntry, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS) {
-                if (m_flightLogEntry->getType() != DebugLogEntry::TYPE_EMPTY) {
-                    // Ok, we retrieved the entry, and it was the correct one. clone it and add it to the list
-                    ExtendedDebugLogEntry *logEntry = new ExtendedDebugLogEntry();
-
-                    logEntry->setData(m_flightLogEntry->getData(), m_objectManager);
-                    m_logEntries << logEntry;
-                    if (logEntry->getData().Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
-                        const quint32 total_len  = sizeof(DebugLogEntry::DataFields);
-                        const quint32 data_len   = sizeof(((DebugLogEntry::DataFields *)0)->Data);
-                        const quint32 header_len = total_len - data_len;
-
-                        DebugLogEntry::DataFields fields;
-                        quint32 start = logEntry->getData().Size;
-
-                        // cycle until there is space for another object
-                        while (start + header_len + 1 < data_len) {
-                            memset(&fields, 0xFF, total_len);
-                            memcpy(&fields, &logEntry->getData().Data[start], header_len);
-                            // check wether a packed object is found
-                            // note that empty data blocks are set as 0xFF in flight side to minimize flash wearing
-                            // thus as soon as this read outside of used area, the test will fail as lenght would be 0xFFFF
-                            quint32 toread = header_len + fields.Size;
-                            if (!(toread + start > data_len)) {
-                                memcpy(&fields, &logEntry->getData().Data[start], toread);
-                                ExtendedDebugLogEntry *subEntry = new ExtendedDebugLogEntry();
-                                subEntry->setData(fields, m_objectManager);
-                                m_logEntries << subEntry;
-                            }
-                            start += toread;
-                        }
-                    }
-
-                    // Increment to get next entry from flight side
-                    slot++;
-                } else {
+            QList<DebugLogEntry::DataFields> entries;
+            if (!retrieveBurst(flight, slot, entries)) {
+                // Nothing came back from the burst, try the slow way once for this entry
+                DebugLogEntry::DataFields entry;
+                if (!retrieveEntry(flight, slot, entry)) {
+                    // We failed for some reason
+                    break;
+                }
+                entries << entry;
+            }
+            foreach(const DebugLogEntry::DataFields &entry, entries) {
+                if (entry.Type == DebugLogEntry::TYPE_EMPTY) {
                     // We are done, not more entries on this flight
                     gotLast = true;
+                    break;
                 }
-            } else {
-                // We failed for some reason
-                break;
+                blocks << entry;
+                // Increment to get next entry from flight side
+                slot++;
             }
             if (m_cancelDownload) {
                 break;
@@ -261,6 +252,24 @@ void FlightLogManager::retrieveLogs(int flightToRetrieve)
         if (m_cancelDownload) {
             break;
         }
+        flights << QtConcurrent::run(&FlightLogManager::unpackEntries, blocks);
+    }
+
+    foreach(const QFuture<QVector<DebugLogEntry::DataFields> > &future, flights) {
+        const QVector<DebugLogEntry::DataFields> entries = future.result();
+        if (m_cancelDownload) {
+            continue;
+        }
+        foreach(const DebugLogEntry::DataFields &entry, entries) {
+            if ((entry.Type == DebugLogEntry::TYPE_UAVOBJECT || entry.Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) &&
+                !m_objectManager->getObject(entry.ObjectID, entry.InstanceID)) {
+                // logged by a different firmware version
+                continue;
+            }
+            ExtendedDebugLogEntry *logEntry = new ExtendedDebugLogEntry();
+            logEntry->setData(entry, m_objectManager);
+            m_logEntries << logEntry;
+        }
     }
 
     if (m_cancelDownload) {
@@ -275,6 +284,227 @@ void FlightLogManager::retrieveLogs(int flightToRetrieve)
     setDisableControls(false);
 }
 
+bool FlightLogManager::retrieveBurst(int flight, int slot, QList<DebugLogEntry::DataFields> &entries)
+{
+    UAVObjectUpdaterHelper updateHelper;
+    QEventLoop loop;
+    QTimer timer;
+
+    timer.setSingleShot(true);
+    connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+
+    // Entries may already arrive while waiting for the ack of the request
+    m_burstFlight = flight;
+    m_burstSlot   = slot;
+    m_burstReceived.fill(false);
+
+    m_flightLogControl->setOperation(DebugLogControl::OPERATION_RETRIEVEBURST);
+    m_flightLogControl->setFlight(flight);
+    m_flightLogControl->setEntry(slot);
+    m_flightLogControl->setBurstSize(BURST_SIZE);
+    if (updateHelper.doObjectAndWait(m_flightLogControl, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS && !burstComplete()) {
+        m_burstLoop = &loop;
+        timer.start(UAVTALK_TIMEOUT);
+        loop.exec();
+        m_burstLoop = 0;
+    }
+    m_burstFlight = -1;
+
+    // Entries are not acked, keep what arrived in sequence and request the rest again with the next burst
+    for (int i = 0; i < BURST_SIZE && m_burstReceived[i]; i++) {
+        entries << m_burstEntries[i];
+        if (m_burstEntries[i].Type == DebugLogEntry::TYPE_EMPTY) {
+            break;
+        }
+    }
+    return !entries.isEmpty();
+}
+
+bool FlightLogManager::retrieveEntry(int flight, int slot, DebugLogEntry::DataFields &entry)
+{
+    UAVObjectUpdaterHelper updateHelper;
+    UAVObjectRequestHelper requestHelper;
+
+    // Send request for loading flight entry on flight side and wait for ack/nack
+    m_flightLogControl->setOperation(DebugLogControl::OPERATION_RETRIEVE);
+    m_flightLogControl->setFlight(flight);
+    m_flightLogControl->setEntry(slot);
+    if (updateHelper.doObjectAndWait(m_flightLogControl, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS &&
+        requestHelper.doObjectAndWait(m_flightLogEntry, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS) {
+        entry = m_flightLogEntry->getData();
+        return true;
+    }
+    return false;
+}
+
+bool FlightLogManager::burstComplete() const
+{
+    for (int i = 0; i < BURST_SIZE; i++) {
+        if (!m_burstReceived[i]) {
+            return false;
+        }
+        if (m_burstEntries[i].Type == DebugLogEntry::TYPE_EMPTY) {
+            // the flight side stops a burst at the end of the flight
+            return true;
+        }
+    }
+    return true;
+}
+
+void FlightLogManager::burstEntryReceived(UAVObject *object)
+{
+    int instance = object->getInstID();
+
+    if (m_burstFlight < 0 || instance >= BURST_SIZE) {
+        return;
+    }
+    DebugLogEntry::DataFields entry = static_cast<DebugLogEntry *>(object)->getData();
+    // ignore late entries of an earlier burst
+    if (entry.Flight != m_burstFlight || entry.Entry != m_burstSlot + instance) {
+        return;
+    }
+    m_burstEntries[instance]  = entry;
+    m_burstReceived[instance] = true;
+    if (m_burstLoop && burstComplete()) {
+        m_burstLoop->quit();
+    }
+}
+
+QVector<DebugLogEntry::DataFields> FlightLogManager::unpackEntries(const QList<DebugLogEntry::DataFields> &blocks)
+{
+    QVector<DebugLogEntry::DataFields> entries;
+    QHash<int, CompactLogObject> dictionary;
+
+    foreach(const DebugLogEntry::DataFields &block, blocks) {
+        if (block.Type == DebugLogEntry::TYPE_COMPACTUAVOBJECTS) {
+            // compact blocks only carry records, they are listed as the objects they contain
+            unpackCompactEntry(block, dictionary, entries);
+        } else {
+            entries << block;
+            if (block.Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+                unpackMultipleEntry(block, entries);
+            }
+        }
+    }
+    return entries;
+}
+
+void FlightLogManager::unpackMultipleEntry(const DebugLogEntry::DataFields &block, QVector<DebugLogEntry::DataFields> &entries)
+{
+    const quint32 total_len  = sizeof(DebugLogEntry::DataFields);
+    const quint32 data_len   = sizeof(((DebugLogEntry::DataFields *)0)->Data);
+    const quint32 header_len = total_len - data_len;
+
+    DebugLogEntry::DataFields fields;
+    quint32 start = block.Size;
+
+    // cycle until there is space for another object
+    while (start + header_len + 1 < data_len) {
+        memset(&fields, 0xFF, total_len);
+        memcpy(&fields, &block.Data[start], header_len);
+        // check wether a packed object is found
+        // note that empty data blocks are set as 0xFF in flight side to minimize flash wearing
+        // thus as soon as this read outside of used area, the test will fail as lenght would be 0xFFFF
+        quint32 toread = header_len + fields.Size;
+        if (!(toread + start > data_len)) {
+            memcpy(&fields, &block.Data[start], toread);
+            entries << fields;
+        }
+        start += toread;
+    }
+}
+
+void FlightLogManager::unpackCompactEntry(const DebugLogEntry::DataFields &block, QHash<int, CompactLogObject> &dictionary,
+                                          QVector<DebugLogEntry::DataFields> &entries)
+{
+    const int size     = qMin((int)block.Size, (int)sizeof(block.Data));
+    quint32 flightTime = block.FlightTime;
+    int pos = 0;
+
+    while (pos < size) {
+        // time since the previous record as a varint
+        quint32 delta = 0;
+        int shift     = 0;
+        quint8 c;
+        do {
+            c      = block.Data[pos++];
+            delta |= (quint32)(c & 0x7F) << shift;
+            shift += 7;
+        } while ((c & 0x80) && pos < size && shift < 32);
+        if (pos >= size) {
+            return;
+        }
+        flightTime += delta;
+
+        quint8 tag  = block.Data[pos++];
+        quint8 kind = tag & 0xC0;
+        int index   = tag & 0x3F;
+        CompactLogObject raw;
+        CompactLogObject *object;
+
+        if (kind == COMPACT_KIND_DEFINE || kind == COMPACT_KIND_RAW) {
+            if (pos + 8 > size) {
+                return;
+            }
+            memcpy(&raw.objectId, &block.Data[pos], sizeof(raw.objectId));
+            memcpy(&raw.instanceId, &block.Data[pos + 4], sizeof(raw.instanceId));
+            memcpy(&raw.size, &block.Data[pos + 6], sizeof(raw.size));
+            pos += 8;
+            if (kind == COMPACT_KIND_DEFINE) {
+                dictionary[index] = raw;
+                object = &dictionary[index];
+            } else {
+                object = &raw;
+            }
+            kind = COMPACT_KIND_FULL;
+        } else if (dictionary.contains(index)) {
+            object = &dictionary[index];
+        } else {
+            // the definition was lost with an earlier entry, the rest of the block can't be decoded
+            qWarning() << "Compact log entry" << block.Entry << "of flight" << block.Flight << "uses undefined object" << index;
+            return;
+        }
+
+        if (kind == COMPACT_KIND_FULL) {
+            if (pos + object->size > size) {
+                return;
+            }
+            object->data = QByteArray((const char *)&block.Data[pos], object->size);
+            pos += object->size;
+        } else {
+            // only the 32 bit words flagged in the bitmap changed since the previous record
+            const int words = (object->size + 3) / 4;
+            const quint8 *bitmap = &block.Data[pos];
+            pos += (words + 7) / 8;
+            if (pos > size || object->data.size() != object->size) {
+                return;
+            }
+            for (int i = 0; i < words; i++) {
+                if (bitmap[i / 8] & (1 << (i % 8))) {
+                    int len = qMin(4, object->size - i * 4);
+                    if (pos + len > size) {
+                        return;
+                    }
+                    memcpy(object->data.data() + i * 4, &block.Data[pos], len);
+                    pos += len;
+                }
+            }
+        }
+
+        DebugLogEntry::DataFields fields;
+        memset(&fields, 0xFF, sizeof(fields));
+        fields.Flight     = block.Flight;
+        fields.FlightTime = flightTime;
+        fields.Entry      = block.Entry;
+        fields.Type       = DebugLogEntry::TYPE_UAVOBJECT;
+        fields.ObjectID   = object->objectId;
+        fields.InstanceID = object->instanceId;
+        fields.Size       = object->size;
+        memcpy(fields.Data, object->data.constData(), qMin((int)object->size, (int)sizeof(fields.Data)));
+        entries << fields;
+    }
+}
+
 void FlightLogManager::exportToOPL(QString fileName)
 {
     // Fix the file name
@@ -372,6 +602,98 @@ void FlightLogManager::exportToXML(QString fileName)
     }
 }
 
+/**
+ * One binary array per object field with a shared timestamp column (us), see UAVTalkLogDecoder
+ */
+void FlightLogManager::exportToColumns(QString dirName)
+{
+    UAVTalkLogDecoder columns(m_objectManager);
+    QHash<quint64, int> records;
+
+    columns.setTimeUnits("us");
+
+    // count the records of each instance first so that every column is allocated once
+    foreach(ExtendedDebugLogEntry * entry, m_logEntries) {
+        if (entry->getType() == DebugLogEntry::TYPE_UAVOBJECT || entry->getType() == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+            records[((quint64)entry->getObjectID() << 16) | entry->getInstanceID()]++;
+        }
+    }
+    for (QHash<quint64, int>::const_iterator i = records.constBegin(); i != records.constEnd(); ++i) {
+        columns.reserve(i.key() >> 16, i.key() & 0xFFFF, i.value());
+    }
+
+    quint32 baseTime = 0;
+    quint32 currentFlight = 0;
+    foreach(ExtendedDebugLogEntry * entry, m_logEntries) {
+        if (m_adjustExportedTimestamps && entry->getFlight() != currentFlight) {
+            currentFlight = entry->getFlight();
+            baseTime = entry->getFlightTime();
+        }
+        if (entry->getType() == DebugLogEntry::TYPE_UAVOBJECT || entry->getType() == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+            columns.addRecord(entry->getObjectID(), entry->getInstanceID(), entry->getData().Data,
+                              entry->getSize(), entry->getFlightTime() - baseTime);
+        }
+    }
+
+    if (!columns.writeColumns(dirName)) {
+        QMessageBox::critical(NULL, tr("Export failed"), tr("Could not write the columns to %1").arg(dirName));
+    }
+}
+
+/**
+ * The GPS track of every flight as a kmz for Google Earth, simplified to within KMZ_TOLERANCE
+ */
+void FlightLogManager::exportToKMZ(QString fileName)
+{
+    QList<KmzExport::Track> tracks;
+    int currentFlight = -1;
+
+    foreach(ExtendedDebugLogEntry * entry, m_logEntries) {
+        if ((entry->getType() != DebugLogEntry::TYPE_UAVOBJECT && entry->getType() != DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) ||
+            entry->getObjectID() != GPSPositionSensor::OBJID) {
+            continue;
+        }
+        GPSPositionSensor *gps = qobject_cast<GPSPositionSensor *>(entry->uavObject());
+        if (!gps) {
+            continue;
+        }
+        GPSPositionSensor::DataFields data = gps->getData();
+        if (data.Status < GPSPositionSensor::STATUS_FIX2D || (data.Latitude == 0 && data.Longitude == 0)) {
+            continue;
+        }
+        if (tracks.isEmpty() || (int)entry->getFlight() != currentFlight) {
+            currentFlight = entry->getFlight();
+            KmzExport::Track track;
+            track.name = tr("Flight %1").arg(currentFlight + 1);
+            tracks << track;
+        }
+        KmzExport::Point point;
+        point.time      = entry->getFlightTime();
+        point.latitude  = data.Latitude;
+        point.longitude = data.Longitude;
+        point.altitude  = data.Altitude;
+        tracks.last().points << point;
+    }
+
+    if (tracks.isEmpty()) {
+        QMessageBox::warning(NULL, tr("Nothing to export"), tr("The log entries hold no GPS position with a fix."));
+        return;
+    }
+
+    // simplifying and deflating a long flight takes a while, keep the UI alive meanwhile
+    QFutureWatcher<bool> watcher;
+    QEventLoop loop;
+    connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+    watcher.setFuture(QtConcurrent::run(&KmzExport::write, fileName, tracks, (double)KMZ_TOLERANCE));
+    if (!watcher.isFinished()) {
+        loop.exec();
+    }
+
+    if (!watcher.result()) {
+        QMessageBox::critical(NULL, tr("Export failed"), tr("Could not write the tracks to %1").arg(fileName));
+    }
+}
+
 void FlightLogManager::exportLogs()
 {
     if (m_logEntries.isEmpty()) {
@@ -384,11 +706,13 @@ void FlightLogManager::exportLogs()
     QString oplFilter = tr("OpenPilot Log file %1").arg("(*.opl)");
     QString csvFilter = tr("Text file %1").arg("(*.csv)");
     QString xmlFilter = tr("XML file %1").arg("(*.xml)");
+    QString columnsFilter = tr("Binary columns directory %1").arg("(*.columns)");
+    QString kmzFilter     = tr("Google Earth file %1").arg("(*.kmz)");
 
     QString selectedFilter = csvFilter;
 
     QString fileName = QFileDialog::getSaveFileName(NULL, tr("Save Log Entries"), QDir::homePath(),
-                                                    QString("%1;;%2;;%3").arg(oplFilter, csvFilter, xmlFilter), &selectedFilter);
+                                                    QString("%1;;%2;;%3;;%4;;%5").arg(oplFilter, csvFilter, xmlFilter, columnsFilter, kmzFilter), &selectedFilter);
     if (!fileName.isEmpty()) {
         if (selectedFilter == oplFilter) {
             if (!fileName.endsWith(".opl")) {
@@ -405,6 +729,16 @@ void FlightLogManager::exportLogs()
                 fileName.append(".xml");
             }
             exportToXML(fileName);
+        } else if (selectedFilter == columnsFilter) {
+            if (!fileName.endsWith(".columns")) {
+                fileName.append(".columns");
+            }
+            exportToColumns(fileName);
+        } else if (selectedFilter == kmzFilter) {
+            if (!fileName.endsWith(".kmz")) {
+                fileName.append(".kmz");
+            }
+            exportToKMZ(fileName);
         }
     }
 
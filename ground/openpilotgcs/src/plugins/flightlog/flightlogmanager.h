@@ -31,10 +31,12 @@
 #include <QObject>
 #include <QList>
 #include <QHash>
+#include <QVector>
 #include <QQmlListProperty>
 #include <QSemaphore>
 #include <QXmlStreamWriter>
 #include <QTextStream>
+#include <QEventLoop>
 
 #include "uavobjectmanager.h"
 #include "uavobjectutilmanager.h"
@@ -319,6 +321,7 @@ private slots:
     void setupLogStatuses();
     void connectionStatusChanged();
     bool updateLogWrapper(QString name, int level, int period);
+    void burstEntryReceived(UAVObject *object);
 
 private:
     UAVObjectManager *m_objectManager;
@@ -341,9 +344,44 @@ private:
     void exportToOPL(QString fileName);
     void exportToCSV(QString fileName);
     void exportToXML(QString fileName);
-
+    void exportToColumns(QString dirName);
+    void exportToKMZ(QString fileName);
+
+    bool retrieveBurst(int flight, int slot, QList<DebugLogEntry::DataFields> &entries);
+    bool retrieveEntry(int flight, int slot, DebugLogEntry::DataFields &entry);
+    bool burstComplete() const;
+
+    // entries of the burst in flight, indexed by DebugLogEntry instance
+    QVector<DebugLogEntry::DataFields> m_burstEntries;
+    QVector<bool> m_burstReceived;
+    QEventLoop *m_burstLoop;
+    int m_burstFlight;
+    int m_burstSlot;
+
+    // object dictionary entry of a flight logged with the compact encoding
+    struct CompactLogObject {
+        quint32    objectId;
+        quint16    instanceId;
+        quint16    size;
+        QByteArray data;
+    };
+    // these run on a worker thread while the next flight is downloaded, they must not touch any QObject
+    static QVector<DebugLogEntry::DataFields> unpackEntries(const QList<DebugLogEntry::DataFields> &blocks);
+    static void unpackMultipleEntry(const DebugLogEntry::DataFields &block, QVector<DebugLogEntry::DataFields> &entries);
+    static void unpackCompactEntry(const DebugLogEntry::DataFields &block, QHash<int, CompactLogObject> &dictionary,
+                                   QVector<DebugLogEntry::DataFields> &entries);
+
+    // record kinds of a CompactUAVObjects entry, the format is described in pios_debuglog.c
+    static const quint8 COMPACT_KIND_FULL   = 0x00;
+    static const quint8 COMPACT_KIND_DELTA  = 0x40;
+    static const quint8 COMPACT_KIND_DEFINE = 0x80;
+    static const quint8 COMPACT_KIND_RAW    = 0xC0;
     static const int UAVTALK_TIMEOUT = 4000;
+    // entries requested at once, the flight side limits this to 16
+    static const int BURST_SIZE = 16;
     static const int LOG_SETTINGS_FILE_VERSION = 1;
+    // m off the GPS track the kmz export may go
+    static const int KMZ_TOLERANCE = 2;
     bool m_disableControls;
     bool m_disableExport;
     bool m_cancelDownload;
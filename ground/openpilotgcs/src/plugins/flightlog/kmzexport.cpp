@@ -0,0 +1,335 @@
+/**
+ ******************************************************************************
+ *
+ * @file       kmzexport.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup FlightLog
+ * @{
+ * @brief Writes the flown trajectories as a Google Earth file
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "kmzexport.h"
+
+#include <QDateTime>
+#include <QtEndian>
+#include <math.h>
+#include <string.h>
+
+#include <zlib.h>
+
+// the kml is deflated whenever this much of it is pending
+#define CHUNK_SIZE     (64 * 1024)
+#define EARTH_RADIUS   6378137.0
+#define ENTRY_NAME     "doc.kml"
+
+// zip records, all little endian
+#define ZIP_LOCAL_HEADER      0x04034b50
+#define ZIP_DATA_DESCRIPTOR   0x08074b50
+#define ZIP_CENTRAL_HEADER    0x02014b50
+#define ZIP_END_OF_DIRECTORY  0x06054b50
+#define ZIP_VERSION           20
+// the sizes and crc follow the data, they are not known before it is written
+#define ZIP_FLAG_DESCRIPTOR   0x0008
+#define ZIP_METHOD_DEFLATE    8
+
+struct KmzExport::Stream {
+    z_stream z;
+};
+
+namespace {
+void put16(QByteArray &buffer, quint16 value)
+{
+    quint8 bytes[2];
+
+    qToLittleEndian(value, bytes);
+    buffer.append((const char *)bytes, sizeof(bytes));
+}
+
+void put32(QByteArray &buffer, quint32 value)
+{
+    quint8 bytes[4];
+
+    qToLittleEndian(value, bytes);
+    buffer.append((const char *)bytes, sizeof(bytes));
+}
+
+// MS-DOS time and date of the zip entries
+quint16 dosTime(const QTime &time)
+{
+    return (time.hour() << 11) | (time.minute() << 5) | (time.second() / 2);
+}
+
+quint16 dosDate(const QDate &date)
+{
+    return ((date.year() - 1980) << 9) | (date.month() << 5) | date.day();
+}
+
+// local east, north and up of a point, in m from the origin
+void toLocal(const KmzExport::Point &point, const KmzExport::Point &origin, double cosLatitude, double local[3])
+{
+    const double scale = EARTH_RADIUS * M_PI / 180.0 * 1e-7;
+
+    local[0] = (double)(point.longitude - origin.longitude) * scale * cosLatitude;
+    local[1] = (double)(point.latitude - origin.latitude) * scale;
+    local[2] = point.altitude;
+}
+
+// square of the distance of p to the segment from a to b
+double segmentDistanceSq(const double p[3], const double a[3], const double b[3])
+{
+    double ab[3], ap[3], lengthSq = 0, dot = 0;
+
+    for (int i = 0; i < 3; i++) {
+        ab[i] = b[i] - a[i];
+        ap[i] = p[i] - a[i];
+        lengthSq += ab[i] * ab[i];
+        dot += ab[i] * ap[i];
+    }
+    double t = lengthSq > 0 ? qBound(0.0, dot / lengthSq, 1.0) : 0;
+    double distanceSq = 0;
+    for (int i = 0; i < 3; i++) {
+        double d = ap[i] - t * ab[i];
+        distanceSq += d * d;
+    }
+    return distanceSq;
+}
+}
+
+KmzExport::KmzExport(QFile *file) : file(file), stream(new Stream), crc(0), size(0), compressedSize(0)
+{
+    memset(&stream->z, 0, sizeof(stream->z));
+}
+
+KmzExport::~KmzExport()
+{
+    deflateEnd(&stream->z);
+    delete stream;
+}
+
+/**
+ * Douglas-Peucker, without recursion so that the depth does not grow with the flight.
+ * The distances are taken in a local flat frame, good to well below the tolerance
+ * over the few km of a flight.
+ */
+QVector<int> KmzExport::simplify(const QVector<Point> &points, double tolerance)
+{
+    QVector<int> kept;
+
+    if (points.size() <= 2) {
+        for (int i = 0; i < points.size(); i++) {
+            kept << i;
+        }
+        return kept;
+    }
+
+    const double cosLatitude = cos(points[0].latitude * 1e-7 * M_PI / 180.0);
+    QVector<double> local(points.size() * 3);
+    for (int i = 0; i < points.size(); i++) {
+        toLocal(points[i], points[0], cosLatitude, &local[i * 3]);
+    }
+
+    const double toleranceSq = tolerance * tolerance;
+    QVector<bool> keep(points.size(), false);
+    QVector<QPair<int, int> > ranges;
+    keep[0] = keep[points.size() - 1] = true;
+    ranges << qMakePair(0, points.size() - 1);
+    while (!ranges.isEmpty()) {
+        const QPair<int, int> range = ranges.takeLast();
+        const double *a = &local[range.first * 3];
+        const double *b = &local[range.second * 3];
+
+        int farthest = -1;
+        double farthestSq = toleranceSq;
+        for (int i = range.first + 1; i < range.second; i++) {
+            double distanceSq = segmentDistanceSq(&local[i * 3], a, b);
+            if (distanceSq > farthestSq) {
+                farthest   = i;
+                farthestSq = distanceSq;
+            }
+        }
+        if (farthest >= 0) {
+            keep[farthest] = true;
+            ranges << qMakePair(range.first, farthest) << qMakePair(farthest, range.second);
+        }
+    }
+
+    for (int i = 0; i < points.size(); i++) {
+        if (keep[i]) {
+            kept << i;
+        }
+    }
+    return kept;
+}
+
+bool KmzExport::write(const QString &fileName, const QList<Track> &tracks, double tolerance)
+{
+    QFile file(fileName);
+
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        return false;
+    }
+
+    KmzExport kmz(&file);
+    if (!kmz.open()) {
+        return false;
+    }
+
+    bool ok = kmz.append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                         "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\n<Document>\n"
+                         "<name>OpenPilot flights</name>\n"
+                         "<Style id=\"track\"><LineStyle><color>ff00ffff</color><width>3</width></LineStyle></Style>\n");
+    foreach(const Track &track, tracks) {
+        const QVector<int> kept = simplify(track.points, tolerance);
+
+        ok = ok && kmz.append(QString("<Placemark>\n<name>%1</name>\n<description>%2 of %3 GPS positions within %4 m</description>\n")
+                              .arg(track.name.toHtmlEscaped()).arg(kept.size()).arg(track.points.size()).arg(tolerance).toUtf8());
+        ok = ok && kmz.append("<styleUrl>#track</styleUrl>\n<LineString>\n<altitudeMode>absolute</altitudeMode>\n<coordinates>\n");
+        foreach(int i, kept) {
+            const Point &point = track.points[i];
+            QByteArray line;
+            line.reserve(48);
+            line.append(QByteArray::number(point.longitude * 1e-7, 'f', 7)).append(',');
+            line.append(QByteArray::number(point.latitude * 1e-7, 'f', 7)).append(',');
+            line.append(QByteArray::number(point.altitude, 'f', 1)).append('\n');
+            ok = ok && kmz.append(line);
+        }
+        ok = ok && kmz.append("</coordinates>\n</LineString>\n</Placemark>\n");
+    }
+    ok = ok && kmz.append("</Document>\n</kml>\n");
+
+    return kmz.close() && ok;
+}
+
+bool KmzExport::open()
+{
+    // raw deflate, the zip has its own header and crc
+    if (deflateInit2(&stream->z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+
+    const QDateTime now = QDateTime::currentDateTime();
+    QByteArray header;
+    put32(header, ZIP_LOCAL_HEADER);
+    put16(header, ZIP_VERSION);
+    put16(header, ZIP_FLAG_DESCRIPTOR);
+    put16(header, ZIP_METHOD_DEFLATE);
+    put16(header, dosTime(now.time()));
+    put16(header, dosDate(now.date()));
+    put32(header, 0); // crc, sizes
+    put32(header, 0);
+    put32(header, 0);
+    put16(header, sizeof(ENTRY_NAME) - 1);
+    put16(header, 0); // extra field
+    header.append(ENTRY_NAME);
+    return file->write(header) == header.size();
+}
+
+bool KmzExport::append(const QByteArray &text)
+{
+    crc = crc32(crc, (const Bytef *)text.constData(), text.size());
+    size += text.size();
+    pending.append(text);
+    if (pending.size() < CHUNK_SIZE) {
+        return true;
+    }
+    return deflate(false);
+}
+
+bool KmzExport::deflate(bool finish)
+{
+    stream->z.next_in  = (Bytef *)pending.data();
+    stream->z.avail_in = pending.size();
+    out.resize(CHUNK_SIZE);
+    int result;
+    do {
+        stream->z.next_out  = (Bytef *)out.data();
+        stream->z.avail_out = out.size();
+        result = ::deflate(&stream->z, finish ? Z_FINISH : Z_NO_FLUSH);
+        if (result == Z_STREAM_ERROR) {
+            return false;
+        }
+        qint64 length = out.size() - stream->z.avail_out;
+        if (file->write(out.constData(), length) != length) {
+            return false;
+        }
+        compressedSize += length;
+    } while (stream->z.avail_out == 0 || (finish && result != Z_STREAM_END));
+    pending.clear();
+    return true;
+}
+
+bool KmzExport::close()
+{
+    if (!deflate(true)) {
+        return false;
+    }
+
+    QByteArray descriptor;
+    put32(descriptor, ZIP_DATA_DESCRIPTOR);
+    put32(descriptor, crc);
+    put32(descriptor, compressedSize);
+    put32(descriptor, size);
+    if (file->write(descriptor) != descriptor.size()) {
+        return false;
+    }
+    return writeCentralDirectory() && file->flush();
+}
+
+bool KmzExport::writeCentralDirectory()
+{
+    const quint32 offset = file->pos();
+    const QDateTime now  = QDateTime::currentDateTime();
+    QByteArray directory;
+
+    put32(directory, ZIP_CENTRAL_HEADER);
+    put16(directory, ZIP_VERSION); // made by
+    put16(directory, ZIP_VERSION); // needed
+    put16(directory, ZIP_FLAG_DESCRIPTOR);
+    put16(directory, ZIP_METHOD_DEFLATE);
+    put16(directory, dosTime(now.time()));
+    put16(directory, dosDate(now.date()));
+    put32(directory, crc);
+    put32(directory, compressedSize);
+    put32(directory, size);
+    put16(directory, sizeof(ENTRY_NAME) - 1);
+    put16(directory, 0); // extra field
+    put16(directory, 0); // comment
+    put16(directory, 0); // disk
+    put16(directory, 0); // internal attributes
+    put32(directory, 0); // external attributes
+    put32(directory, 0); // offset of the local header
+    directory.append(ENTRY_NAME);
+    const quint32 directorySize = directory.size();
+
+    put32(directory, ZIP_END_OF_DIRECTORY);
+    put16(directory, 0); // this disk
+    put16(directory, 0); // disk of the directory
+    put16(directory, 1); // entries on this disk
+    put16(directory, 1); // entries
+    put32(directory, directorySize);
+    put32(directory, offset);
+    put16(directory, 0); // comment
+    return file->write(directory) == directory.size();
+}
+
+/**
+ * @}
+ * @}
+ */
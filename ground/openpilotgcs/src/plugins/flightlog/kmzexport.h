@@ -0,0 +1,89 @@
+/**
+ ******************************************************************************
+ *
+ * @file       kmzexport.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup FlightLog
+ * @{
+ * @brief Writes the flown trajectories as a Google Earth file
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef KMZEXPORT_H
+#define KMZEXPORT_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+/**
+ * Writes the GPS tracks of flights as a kmz, a zip holding one doc.kml.
+ *
+ * The tracks are simplified first: Douglas-Peucker drops every point which the
+ * line through its neighbours passes within the tolerance of, so that a long
+ * flight comes down to the points where it turns or climbs. The kml is
+ * deflated into the file as it is generated, nothing of the size of the
+ * output is held in memory.
+ *
+ * write() touches no QObject, it can run on a worker thread.
+ */
+class KmzExport {
+public:
+    typedef struct {
+        quint32 time;
+        qint32  latitude; // degrees x 10^-7, as the GPS objects
+        qint32  longitude;
+        float   altitude; // m above the geoid
+    } Point;
+
+    typedef struct {
+        QString name;
+        QVector<Point> points;
+    } Track;
+
+    static bool write(const QString &fileName, const QList<Track> &tracks, double tolerance);
+
+    // indices of the points kept, in order, the first and the last always are
+    static QVector<int> simplify(const QVector<Point> &points, double tolerance);
+
+private:
+    explicit KmzExport(QFile *file);
+    ~KmzExport();
+
+    bool open();
+    bool append(const QByteArray &text);
+    bool close();
+
+    bool deflate(bool finish);
+    bool writeCentralDirectory();
+
+    QFile *file;
+    // zlib stream state, kept out of the header
+    struct Stream;
+    Stream *stream;
+    QByteArray pending;
+    QByteArray out;
+    quint32 crc;
+    quint32 size;
+    quint32 compressedSize;
+};
+
+#endif // KMZEXPORT_H
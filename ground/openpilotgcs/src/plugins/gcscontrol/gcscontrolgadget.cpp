@@ -49,6 +49,8 @@ GCSControlGadget::GCSControlGadget(QString classId, GCSControlGadgetWidget *widg
     connect(control_sock, SIGNAL(readyRead()), this, SLOT(readUDPCommand()));
 
     joystickTime.start();
+    joystickTimer.setSingleShot(true);
+    connect(&joystickTimer, SIGNAL(timeout()), this, SLOT(sendAxesValues()));
     GCSControlPlugin *pl = dynamic_cast<GCSControlPlugin *>(plugin);
     connect(pl->sdlGamepad, SIGNAL(gamepads(quint8)), this, SLOT(gamepads(quint8)));
     connect(pl->sdlGamepad, SIGNAL(buttonState(ButtonNumber, bool)), this, SLOT(buttonState(ButtonNumber, bool)));
@@ -420,8 +422,26 @@ void GCSControlGadget::buttonState(ButtonNumber number, bool pressed)
     // buttonSettings[number].Amount
 }
 
+/**
+   The sticks are sent at most every JOYSTICK_UPDATE_RATE ms. A move arriving
+   sooner is held and sent as soon as the period is over, instead of being
+   dropped until a later sample of the gamepad happens to fall after it.
+ */
 void GCSControlGadget::axesValues(QListInt16 values)
 {
+    joystickValues = values;
+    int wait = JOYSTICK_UPDATE_RATE - joystickTime.elapsed();
+    if (wait <= 0) {
+        joystickTimer.stop();
+        sendAxesValues();
+    } else if (!joystickTimer.isActive()) {
+        joystickTimer.start(wait);
+    }
+}
+
+void GCSControlGadget::sendAxesValues()
+{
+    const QListInt16 &values = joystickValues;
     int chMax = values.length();
 
     if (rollChannel >= chMax || pitchChannel >= chMax ||
@@ -458,27 +478,25 @@ void GCSControlGadget::axesValues(QListInt16 values)
     }
 
 
-    if (joystickTime.elapsed() > JOYSTICK_UPDATE_RATE) {
-        joystickTime.restart();
-        // Remap RPYT to left X/Y and right X/Y depending on mode
-        // Mode 1: LeftX = Yaw, LeftY = Pitch, RightX = Roll, RightY = Throttle
-        // Mode 2: LeftX = Yaw, LeftY = THrottle, RightX = Roll, RightY = Pitch
-        // Mode 3: LeftX = Roll, LeftY = Pitch, RightX = Yaw, RightY = Throttle
-        // Mode 4: LeftX = Roll, LeftY = Throttle, RightX = Yaw, RightY = Pitch;
-        switch (controlsMode) {
-        case 1:
-            sticksChangedLocally(yValue / max, -pValue / max, rValue / max, -tValue / max);
-            break;
-        case 2:
-            sticksChangedLocally(yValue / max, -tValue / max, rValue / max, -pValue / max);
-            break;
-        case 3:
-            sticksChangedLocally(rValue / max, -pValue / max, yValue / max, -tValue / max);
-            break;
-        case 4:
-            sticksChangedLocally(rValue / max, -tValue / max, yValue / max, -pValue / max);
-            break;
-        }
+    joystickTime.restart();
+    // Remap RPYT to left X/Y and right X/Y depending on mode
+    // Mode 1: LeftX = Yaw, LeftY = Pitch, RightX = Roll, RightY = Throttle
+    // Mode 2: LeftX = Yaw, LeftY = THrottle, RightX = Roll, RightY = Pitch
+    // Mode 3: LeftX = Roll, LeftY = Pitch, RightX = Yaw, RightY = Throttle
+    // Mode 4: LeftX = Roll, LeftY = Throttle, RightX = Yaw, RightY = Pitch;
+    switch (controlsMode) {
+    case 1:
+        sticksChangedLocally(yValue / max, -pValue / max, rValue / max, -tValue / max);
+        break;
+    case 2:
+        sticksChangedLocally(yValue / max, -tValue / max, rValue / max, -pValue / max);
+        break;
+    case 3:
+        sticksChangedLocally(rValue / max, -pValue / max, yValue / max, -tValue / max);
+        break;
+    case 4:
+        sticksChangedLocally(rValue / max, -tValue / max, yValue / max, -pValue / max);
+        break;
     }
 }
 
@@ -33,6 +33,7 @@
 #include "gcscontrolgadgetconfiguration.h"
 #include "sdlgamepad/sdlgamepad.h"
 #include <QTime>
+#include <QTimer>
 #include "gcscontrolplugin.h"
 #include <QUdpSocket>
 #include <QHostAddress>
@@ -72,6 +73,8 @@ private:
     ManualControlCommand *getManualControlCommand();
     double constrain(double value);
     QTime joystickTime;
+    QTimer joystickTimer;
+    QListInt16 joystickValues;
     QWidget *m_widget;
     QList<int> m_context;
     UAVObject::Metadata mccInitialData;
@@ -99,6 +102,7 @@ protected slots:
     void gamepads(quint8 count);
     void buttonState(ButtonNumber number, bool pressed);
     void axesValues(QListInt16 values);
+    void sendAxesValues();
 };
 
 
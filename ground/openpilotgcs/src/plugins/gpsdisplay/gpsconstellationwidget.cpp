@@ -33,7 +33,7 @@
 /*
  * Initialize the widget
  */
-GpsConstellationWidget::GpsConstellationWidget(QWidget *parent) : QGraphicsView(parent)
+GpsConstellationWidget::GpsConstellationWidget(QWidget *parent) : QGraphicsView(parent), dirtySats(0)
 {
     // Create a layout, add a QGraphicsView and put the SVG inside.
     // The constellation widget looks like this:
@@ -56,6 +56,8 @@ GpsConstellationWidget::GpsConstellationWidget(QWidget *parent) : QGraphicsView(
     world = new QGraphicsSvgItem();
     world->setSharedRenderer(renderer);
     world->setElementId("map");
+    // the map is static, render the svg once rather than on every repaint
+    world->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 
     scene = new QGraphicsScene(this);
     scene->addItem(world);
@@ -74,12 +76,17 @@ GpsConstellationWidget::GpsConstellationWidget(QWidget *parent) : QGraphicsView(
         satIcons[i] = new QGraphicsSvgItem(world);
         satIcons[i]->setSharedRenderer(renderer);
         satIcons[i]->setElementId("sat-notSeen");
+        satIcons[i]->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
         satIcons[i]->hide();
 
         satTexts[i] = new QGraphicsSimpleTextItem("##", satIcons[i]);
         satTexts[i]->setBrush(QColor("Black"));
         satTexts[i]->setFont(QFont("Digital-7"));
     }
+
+    frameTimer.setSingleShot(true);
+    frameTimer.setInterval(FRAME_MS);
+    connect(&frameTimer, SIGNAL(timeout()), this, SLOT(drawSats()));
 }
 
 GpsConstellationWidget::~GpsConstellationWidget()
@@ -112,17 +119,46 @@ void GpsConstellationWidget::resizeEvent(QResizeEvent *event)
 
 void GpsConstellationWidget::updateSat(int index, int prn, int elevation, int azimuth, int snr)
 {
-    if (index >= MAX_SATTELITES) {
+    if (index < 0 || index >= MAX_SATTELITES) {
         // A bit of error checking never hurts.
         return;
     }
 
+    // the GSV sentences repeat the whole constellation, most of it unchanged
+    if (satellites[index][0] == prn && satellites[index][1] == elevation &&
+        satellites[index][2] == azimuth && satellites[index][3] == snr) {
+        return;
+    }
+
     // TODO: add range checking
     satellites[index][0] = prn;
     satellites[index][1] = elevation;
     satellites[index][2] = azimuth;
     satellites[index][3] = snr;
 
+    dirtySats |= 1 << index;
+    if (!frameTimer.isActive()) {
+        frameTimer.start();
+    }
+}
+
+void GpsConstellationWidget::drawSats()
+{
+    for (int index = 0; index < MAX_SATTELITES; index++) {
+        if (dirtySats & (1 << index)) {
+            drawSat(index);
+        }
+    }
+    dirtySats = 0;
+}
+
+void GpsConstellationWidget::drawSat(int index)
+{
+    const int prn       = satellites[index][0];
+    const int elevation = satellites[index][1];
+    const int azimuth   = satellites[index][2];
+    const int snr       = satellites[index][3];
+
     if (prn && elevation >= 0) {
         QPointF opd = polarToCoord(elevation, azimuth);
         opd += QPointF(-satIcons[index]->boundingRect().center().x(),
@@ -132,15 +168,15 @@ void GpsConstellationWidget::updateSat(int index, int prn, int elevation, int az
         // Show normal GPS or SBAS (120 - 158 range)
         if (prn > 119 && prn < 159) {
             if (snr) {
-                satIcons[index]->setElementId("satellite-sbas");
+                setSatElement(index, "satellite-sbas");
             } else {
-                satIcons[index]->setElementId("sat-sbas-notSeen");
+                setSatElement(index, "sat-sbas-notSeen");
             }
         } else {
             if (snr) {
-                satIcons[index]->setElementId("satellite");
+                setSatElement(index, "satellite");
             } else {
-                satIcons[index]->setElementId("sat-notSeen");
+                setSatElement(index, "sat-notSeen");
             }
         }
         satIcons[index]->show();
@@ -166,6 +202,16 @@ void GpsConstellationWidget::updateSat(int index, int prn, int elevation, int az
     }
 }
 
+/**
+   Changing the element has the svg renderer lay the item out again, and drops its cache
+ */
+void GpsConstellationWidget::setSatElement(int index, const QString &element)
+{
+    if (satIcons[index]->elementId() != element) {
+        satIcons[index]->setElementId(element);
+    }
+}
+
 /**
    Converts the elevation/azimuth to X/Y coordinates on the map
 
@@ -29,6 +29,7 @@
 #define GPSCONSTELLATIONWIDGET_H_
 
 #include <QGraphicsView>
+#include <QTimer>
 #include <QtSvg/QSvgRenderer>
 #include <QtSvg/QGraphicsSvgItem>
 
@@ -45,10 +46,15 @@ public slots:
 
 
 private slots:
+    void drawSats();
 
 private:
     static const int MAX_SATTELITES = 16;
+    // the satellite updates are drawn at most this often, a GSV burst redraws once
+    static const int FRAME_MS = 40;
     int satellites[MAX_SATTELITES][4];
+    quint32 dirtySats;
+    QTimer frameTimer;
     QGraphicsScene *scene;
     QSvgRenderer *renderer;
     QGraphicsSvgItem *world;
@@ -56,6 +62,8 @@ private:
     QGraphicsSimpleTextItem *satTexts[MAX_SATTELITES];
 
     QPointF polarToCoord(int elevation, int azimuth);
+    void drawSat(int index);
+    void setSatElement(int index, const QString &element);
 
 protected:
     void showEvent(QShowEvent *event);
@@ -40,9 +40,26 @@ GpsDisplayGadget::GpsDisplayGadget(QString classId, GpsDisplayWidget *widget, QW
 
 GpsDisplayGadget::~GpsDisplayGadget()
 {
+    parserThread.quit();
+    parserThread.wait();
+    delete parser;
     delete m_widget;
 }
 
+void GpsDisplayGadget::deleteParser()
+{
+    if (!parser) {
+        return;
+    }
+    if (parser->thread() == &parserThread) {
+        // it may be parsing, let its own thread delete it after the data already queued
+        parser->deleteLater();
+        parser = 0;
+    } else {
+        delete parser;
+    }
+}
+
 /*
    This is called when a configuration is loaded, and updates the plugin's settings.
    Careful: the plugin is already drawn before the loadConfiguration method is called the
@@ -57,9 +74,7 @@ void GpsDisplayGadget::loadConfiguration(IUAVGadgetConfiguration *config)
     }
 
     // Delete the (old)parser, this also disconnects all signals.
-    if (parser) {
-        delete parser;
-    }
+    deleteParser();
 
     GpsDisplayGadgetConfiguration *gpsDisplayConfig = qobject_cast< GpsDisplayGadgetConfiguration *>(config);
 
@@ -80,6 +95,12 @@ void GpsDisplayGadget::loadConfiguration(IUAVGadgetConfiguration *config)
             if (nport.portName() == gpsDisplayConfig->port()) {
                 qDebug() << "Using Serial parser";
                 parser = new NMEAParser();
+                parser->moveToThread(&parserThread);
+                if (!parserThread.isRunning()) {
+                    parserThread.start();
+                }
+                // queued, the widgets are updated from the GUI thread in turn
+                connect(this, SIGNAL(newSerialData(QByteArray)), parser, SLOT(processInputData(QByteArray)));
                 port   = new QSerialPort(nport);
                 m_widget->connectButton->setEnabled(true);
                 m_widget->disconnectButton->setEnabled(false);
@@ -159,17 +180,8 @@ void GpsDisplayGadget::onDataAvailable()
         serialData.resize(avail);
         int bytesRead = port->read(serialData.data(), serialData.size());
         if (bytesRead > 0) {
-            processNewSerialData(serialData);
+            serialData.resize(bytesRead);
+            emit newSerialData(serialData);
         }
     }
 }
-
-void GpsDisplayGadget::processNewSerialData(QByteArray serialData)
-{
-    int dataLength   = serialData.size();
-    const char *data = serialData.constData();
-
-    for (int pos = 0; pos < dataLength; pos++) {
-        parser->processInputStream(data[pos]);
-    }
-}
@@ -30,6 +30,7 @@
 
 #include <QtSerialPort/QSerialPort>
 #include <QtSerialPort/QSerialPortInfo>
+#include <QThread>
 #include <coreplugin/iuavgadget.h>
 #include "gpsdisplaywidget.h"
 #include "nmeaparser.h"
@@ -60,6 +61,9 @@ public slots:
     void onConnect();
     void onDisconnect();
 
+signals:
+    void newSerialData(const QByteArray &data);
+
 private slots:
     void onDataAvailable();
 
@@ -67,9 +71,11 @@ private:
     QPointer<GpsDisplayWidget> m_widget;
     QPointer<QSerialPort> port;
     QPointer<GPSParser> parser;
+    // the serial parser runs here, off the GUI thread
+    QThread parserThread;
     bool connected;
-    void processNewSerialData(QByteArray serialData);
     PortSettings m_portsettings;
+    void deleteParser();
 };
 
 
@@ -58,6 +58,12 @@ GpsDisplayWidget::GpsDisplayWidget(QWidget *parent) : QWidget(parent)
     fescene->addItem(marker);
     double scale = earthpix.width() / (marker->boundingRect().width() * 20);
     marker->setScale(scale);
+
+    // the document drops its oldest lines itself
+    textBrowser->document()->setMaximumBlockCount(MAX_PACKET_LINES);
+    packetTimer.setSingleShot(true);
+    packetTimer.setInterval(FRAME_MS);
+    connect(&packetTimer, SIGNAL(timeout()), this, SLOT(flushPackets()));
 }
 
 GpsDisplayWidget::~GpsDisplayWidget()
@@ -101,13 +107,20 @@ void GpsDisplayWidget::setFixType(const QString &fixtype)
 
 void GpsDisplayWidget::dumpPacket(const QString &packet)
 {
-    textBrowser->append(packet);
-    if (textBrowser->document()->lineCount() > 200) {
-        QTextCursor tc = textBrowser->textCursor();
-        tc.movePosition(QTextCursor::Start);
-        tc.movePosition(QTextCursor::Down, QTextCursor::KeepAnchor);
-        tc.movePosition(QTextCursor::StartOfLine, QTextCursor::KeepAnchor);
-        tc.removeSelectedText();
+    pendingPackets << packet;
+    if (pendingPackets.size() > MAX_PACKET_LINES) {
+        pendingPackets.removeFirst();
+    }
+    if (!packetTimer.isActive()) {
+        packetTimer.start();
+    }
+}
+
+void GpsDisplayWidget::flushPackets()
+{
+    if (!pendingPackets.isEmpty()) {
+        textBrowser->append(pendingPackets.join("\n"));
+        pendingPackets.clear();
     }
 }
 
@@ -33,6 +33,7 @@
 #include "gpsconstellationwidget.h"
 #include "uavobject.h"
 #include <QGraphicsView>
+#include <QTimer>
 #include <QtSvg/QSvgRenderer>
 #include <QtSvg/QGraphicsSvgItem>
 
@@ -53,9 +54,15 @@ private slots:
     void dumpPacket(const QString &packet);
     void setFixType(const QString &fixtype);
     void setDOP(double hdop, double vdop, double pdop);
+    void flushPackets();
 
 private:
+    // the packets of a frame are appended to the text browser at once
+    static const int FRAME_MS = 40;
+    static const int MAX_PACKET_LINES = 200;
     GpsConstellationWidget *gpsConstellation;
     QGraphicsSvgItem *marker;
+    QStringList pendingPackets;
+    QTimer packetTimer;
 };
 #endif /* GPSDISPLAYWIDGET_H_ */
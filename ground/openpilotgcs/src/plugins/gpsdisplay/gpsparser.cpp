@@ -41,3 +41,12 @@ void GPSParser::processInputStream(char c)
         Q_UNUSED(c)
     }
 }
+
+void GPSParser::processInputData(const QByteArray &data)
+{
+    const char *bytes = data.constData();
+
+    for (int pos = 0; pos < data.size(); pos++) {
+        processInputStream(bytes[pos]);
+    }
+}
@@ -37,6 +37,10 @@ class GPSParser : public QObject {
 public: ~GPSParser();
     virtual void processInputStream(char c);
 
+public slots:
+    // a chunk of the stream, queued here when the parser runs on a thread of its own
+    void processInputData(const QByteArray &data);
+
 protected:
     GPSParser(QObject *parent = 0);
 
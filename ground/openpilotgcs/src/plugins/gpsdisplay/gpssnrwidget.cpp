@@ -1,7 +1,7 @@
 #include "gpssnrwidget.h"
 
 GpsSnrWidget::GpsSnrWidget(QWidget *parent) :
-    QGraphicsView(parent)
+    QGraphicsView(parent), dirtySats(0)
 {
     scene = new QGraphicsScene(this);
     setScene(scene);
@@ -26,6 +26,10 @@ GpsSnrWidget::GpsSnrWidget(QWidget *parent) :
         satSNRs[i]->setBrush(QColor("Black"));
         satSNRs[i]->setFont(QFont("Courier"));
     }
+
+    frameTimer.setSingleShot(true);
+    frameTimer.setInterval(FRAME_MS);
+    connect(&frameTimer, SIGNAL(timeout()), this, SLOT(drawSats()));
 }
 
 GpsSnrWidget::~GpsSnrWidget()
@@ -54,18 +58,38 @@ void GpsSnrWidget::resizeEvent(QResizeEvent *event)
 
 void GpsSnrWidget::updateSat(int index, int prn, int elevation, int azimuth, int snr)
 {
-    if (index >= MAX_SATTELITES) {
+    if (index < 0 || index >= MAX_SATTELITES) {
         // A bit of error checking never hurts.
         return;
     }
 
+    if (satellites[index][0] == prn && satellites[index][3] == snr) {
+        // the elevation and azimuth are not drawn here
+        satellites[index][1] = elevation;
+        satellites[index][2] = azimuth;
+        return;
+    }
+
     // TODO: add range checking
     satellites[index][0] = prn;
     satellites[index][1] = elevation;
     satellites[index][2] = azimuth;
     satellites[index][3] = snr;
 
-    drawSat(index);
+    dirtySats |= 1 << index;
+    if (!frameTimer.isActive()) {
+        frameTimer.start();
+    }
+}
+
+void GpsSnrWidget::drawSats()
+{
+    for (int index = 0; index < MAX_SATTELITES; index++) {
+        if (dirtySats & (1 << index)) {
+            drawSat(index);
+        }
+    }
+    dirtySats = 0;
 }
 
 void GpsSnrWidget::drawSat(int index)
@@ -3,6 +3,7 @@
 
 #include <QGraphicsView>
 #include <QGraphicsRectItem>
+#include <QTimer>
 
 class GpsSnrWidget : public QGraphicsView {
     Q_OBJECT
@@ -15,9 +16,16 @@ signals:
 public slots:
     void updateSat(int index, int prn, int elevation, int azimuth, int snr);
 
+private slots:
+    void drawSats();
+
 private:
     static const int MAX_SATTELITES = 16;
+    // as GpsConstellationWidget, the updates are drawn once per frame
+    static const int FRAME_MS = 40;
     int satellites[MAX_SATTELITES][4];
+    quint32 dirtySats;
+    QTimer frameTimer;
     QGraphicsScene *scene;
     QGraphicsRectItem *boxes[MAX_SATTELITES];
     QGraphicsSimpleTextItem *satTexts[MAX_SATTELITES];
@@ -85,7 +85,11 @@ void NMEAParser::processInputStream(char c)
         gpsRxOverflow++;
         return;
     }
-    nmeaProcess(&gpsRxBuffer);
+    // a sentence can only have completed with its <LF>, scanning the buffer
+    // for one on every byte made the parsing quadratic in the sentence length
+    if (c == '\n' || !bufferIsNotFull(&gpsRxBuffer)) {
+        while (nmeaProcess(&gpsRxBuffer) != NMEA_NODATA) {}
+    }
 }
 
 
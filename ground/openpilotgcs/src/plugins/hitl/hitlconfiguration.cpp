@@ -41,6 +41,9 @@ HITLConfiguration::HITLConfiguration(QString classId, QSettings *qSettings, QObj
     settings.remoteAddress        = "127.0.0.1";
     settings.outPort              = 0;
     settings.inPort = 0;
+    settings.lockStep             = false;
+    settings.lockStepAddress      = "127.0.0.1";
+    settings.lockStepPort         = 9003;
     settings.latitude             = "";
     settings.longitude            = "";
 
@@ -77,6 +80,9 @@ HITLConfiguration::HITLConfiguration(QString classId, QSettings *qSettings, QObj
         settings.remoteAddress = qSettings->value("remoteAddress").toString();
         settings.outPort       = qSettings->value("outPort").toInt();
         settings.inPort = qSettings->value("inPort").toInt();
+        settings.lockStep        = qSettings->value("lockStep", settings.lockStep).toBool();
+        settings.lockStepAddress = qSettings->value("lockStepAddress", settings.lockStepAddress).toString();
+        settings.lockStepPort    = qSettings->value("lockStepPort", settings.lockStepPort).toInt();
 
         settings.latitude      = qSettings->value("latitude").toString();
         settings.longitude     = qSettings->value("longitude").toString();
@@ -133,6 +139,9 @@ void HITLConfiguration::saveConfig(QSettings *qSettings) const
     qSettings->setValue("remoteAddress", settings.remoteAddress);
     qSettings->setValue("outPort", settings.outPort);
     qSettings->setValue("inPort", settings.inPort);
+    qSettings->setValue("lockStep", settings.lockStep);
+    qSettings->setValue("lockStepAddress", settings.lockStepAddress);
+    qSettings->setValue("lockStepPort", settings.lockStepPort);
 
     qSettings->setValue("latitude", settings.latitude);
     qSettings->setValue("longitude", settings.longitude);
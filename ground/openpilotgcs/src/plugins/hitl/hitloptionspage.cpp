@@ -82,6 +82,9 @@ QWidget *HITLOptionsPage::createPage(QWidget *parent)
 
     m_optionsPage->startSim->setChecked(config->Settings().startSim);
     m_optionsPage->noiseCheckBox->setChecked(config->Settings().addNoise);
+    m_optionsPage->lockStep->setChecked(config->Settings().lockStep);
+    m_optionsPage->lockStepAddress->setText(config->Settings().lockStepAddress);
+    m_optionsPage->lockStepPort->setValue(config->Settings().lockStepPort);
 
     m_optionsPage->hostAddress->setText(config->Settings().hostAddress);
     m_optionsPage->remoteAddress->setText(config->Settings().remoteAddress);
@@ -128,6 +131,9 @@ void HITLOptionsPage::apply()
     settings.addNoise             = m_optionsPage->noiseCheckBox->isChecked();
     settings.hostAddress          = m_optionsPage->hostAddress->text();
     settings.remoteAddress        = m_optionsPage->remoteAddress->text();
+    settings.lockStep             = m_optionsPage->lockStep->isChecked();
+    settings.lockStepAddress      = m_optionsPage->lockStepAddress->text();
+    settings.lockStepPort         = m_optionsPage->lockStepPort->value();
 
     settings.inPort = m_optionsPage->inputPort->text().toInt();
     settings.outPort              = m_optionsPage->outputPort->text().toInt();
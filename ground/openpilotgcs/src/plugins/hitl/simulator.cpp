@@ -34,6 +34,16 @@
 #include <coreplugin/threadmanager.h>
 #include <uavtalk/telemetrymanager.h>
 
+#include <QtEndian>
+
+// lock-step requests of the simposix firmware, see flight/pios/inc/pios_simstep.h
+#define SIMSTEP_MAGIC        0x5353504f
+#define SIMSTEP_CMD_STEP     1
+#define SIMSTEP_CMD_RELEASE  2
+#define SIMSTEP_MSG_LENGTH   24
+// wall time the firmware tasks get per tick, the firmware runs 4 times faster than real time at most
+#define SIMSTEP_SLICE_US     250
+
 volatile bool Simulator::isStarted = false;
 
 const float Simulator::GEE      = 9.81;
@@ -50,6 +60,7 @@ Simulator::Simulator(const SimulatorSettings & params) :
     time(NULL),
     inSocket(NULL),
     outSocket(NULL),
+    stepSocket(NULL),
     settings(params),
     updatePeriod(50),
     simTimeout(8000),
@@ -57,6 +68,8 @@ Simulator::Simulator(const SimulatorSettings & params) :
     simConnectionStatus(false),
     txTimer(NULL),
     simTimer(NULL),
+    stepTimer(NULL),
+    stepPending(false),
     name("")
 {
     // move to thread
@@ -96,6 +109,18 @@ Simulator::~Simulator()
         outSocket = NULL;
     }
 
+    if (stepSocket) {
+        // give the firmware its own clock back
+        requestStep(SIMSTEP_CMD_RELEASE, 0);
+        delete stepSocket;
+        stepSocket = NULL;
+    }
+
+    if (stepTimer) {
+        delete stepTimer;
+        stepTimer = NULL;
+    }
+
     if (txTimer) {
         delete txTimer;
         txTimer = NULL;
@@ -201,7 +226,17 @@ void Simulator::onStart()
     txTimer = new QTimer();
     connect(txTimer, SIGNAL(timeout()), this, SLOT(transmitUpdate()), Qt::DirectConnection);
     txTimer->setInterval(updatePeriod);
-    txTimer->start();
+    if (settings.lockStep) {
+        // the actuators are sent once the firmware ran the step of each simulator frame
+        stepSocket = new QUdpSocket();
+        connect(stepSocket, SIGNAL(readyRead()), this, SLOT(receiveStep()), Qt::DirectConnection);
+        stepTimer  = new QTimer();
+        stepTimer->setSingleShot(true);
+        connect(stepTimer, SIGNAL(timeout()), this, SLOT(onStepTimeout()), Qt::DirectConnection);
+        emit processOutput("Lock-step with firmware at " + settings.lockStepAddress + ":" + QString::number(settings.lockStepPort) + "\n");
+    } else {
+        txTimer->start();
+    }
     // Setup simulator connection timer
     simTimer = new QTimer();
     connect(simTimer, SIGNAL(timeout()), this, SLOT(onSimulatorConnectionTimeout()), Qt::DirectConnection);
@@ -239,6 +274,56 @@ void Simulator::receiveUpdate()
         // Process incomming data
         processUpdate(datagram);
     }
+
+    // Advance the firmware by one step per batch of frames, simposix ticks every ms
+    if (stepSocket && !stepPending) {
+        requestStep(SIMSTEP_CMD_STEP, updatePeriod);
+    }
+}
+
+/**
+ * Send a lock-step request to the firmware, answered by receiveStep()
+ */
+void Simulator::requestStep(quint32 command, quint32 ticks)
+{
+    uchar msg[SIMSTEP_MSG_LENGTH];
+
+    qToLittleEndian<quint32>(SIMSTEP_MAGIC, &msg[0]);
+    qToLittleEndian<quint32>(command, &msg[4]);
+    qToLittleEndian<quint32>(ticks, &msg[8]);
+    qToLittleEndian<quint32>(SIMSTEP_SLICE_US, &msg[12]);
+    qToLittleEndian<quint64>(0, &msg[16]);
+
+    if (stepSocket->writeDatagram((const char *)msg, sizeof(msg), QHostAddress(settings.lockStepAddress), settings.lockStepPort) == -1) {
+        emit processOutput("Error sending lock-step request: " + stepSocket->errorString() + "\n");
+        return;
+    }
+    if (command == SIMSTEP_CMD_STEP) {
+        stepPending = true;
+        stepTimer->start(simTimeout);
+    }
+}
+
+void Simulator::receiveStep()
+{
+    while (stepSocket->hasPendingDatagrams()) {
+        uchar msg[SIMSTEP_MSG_LENGTH];
+        if (stepSocket->readDatagram((char *)msg, sizeof(msg)) != sizeof(msg) ||
+            qFromLittleEndian<quint32>(&msg[0]) != SIMSTEP_MAGIC ||
+            qFromLittleEndian<quint32>(&msg[4]) != SIMSTEP_CMD_STEP) {
+            continue;
+        }
+        stepTimer->stop();
+        stepPending = false;
+        // the firmware outputs for this step are in, pass them to the simulator
+        transmitUpdate();
+    }
+}
+
+void Simulator::onStepTimeout()
+{
+    stepPending = false;
+    emit processOutput("No answer from the firmware to the lock-step request\n");
 }
 
 void Simulator::setupObjects()
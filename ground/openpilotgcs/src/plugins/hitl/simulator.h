@@ -122,6 +122,10 @@ typedef struct _CONNECTION {
     int     inPort;
     bool    startSim;
     bool    addNoise;
+    // step the simposix firmware once per simulator frame
+    bool    lockStep;
+    QString lockStepAddress;
+    int     lockStepPort;
     QString latitude;
     QString longitude;
 
@@ -296,6 +300,8 @@ private slots:
     void onAutopilotConnect();
     void onAutopilotDisconnect();
     void onSimulatorConnectionTimeout();
+    void receiveStep();
+    void onStepTimeout();
     void telStatsUpdated(UAVObject *obj);
     Q_INVOKABLE void onDeleteSimulator(void);
 
@@ -315,6 +321,7 @@ protected:
     QTime *time;
     QUdpSocket *inSocket; // (new QUdpSocket());
     QUdpSocket *outSocket;
+    QUdpSocket *stepSocket;
 
     ActuatorCommand *actCommand;
     ActuatorDesired *actDesired;
@@ -354,6 +361,8 @@ private:
     volatile bool simConnectionStatus;
     QTimer *txTimer;
     QTimer *simTimer;
+    QTimer *stepTimer;
+    bool stepPending;
 
     QTime attRawTime;
     QTime gpsPosTime;
@@ -372,6 +381,7 @@ private:
     void setupInputObject(UAVObject *obj, quint32 updatePeriod);
     void setupWatchedObject(UAVObject *obj, quint32 updatePeriod);
     void setupObjects();
+    void requestStep(quint32 command, quint32 ticks);
 
     AirParameters airParameters;
 };
@@ -6,10 +6,12 @@ HEADERS += ipconnectionplugin.h \
     ipconnection_global.h \
     ipconnectionconfiguration.h \
     ipconnectionoptionspage.h \
-    ipconnection_internal.h
+    ipconnection_internal.h \
+    ipdatagramdevice.h
 SOURCES += ipconnectionplugin.cpp \
     ipconnectionconfiguration.cpp \
-    ipconnectionoptionspage.cpp
+    ipconnectionoptionspage.cpp \
+    ipdatagramdevice.cpp
 FORMS += ipconnectionoptionspage.ui
 RESOURCES += 
 DEFINES += IPconnection_LIBRARY
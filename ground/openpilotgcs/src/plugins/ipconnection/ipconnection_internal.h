@@ -16,7 +16,7 @@ public:
 public slots:
 
     void onOpenDevice(QString HostName, int Port, bool UseTCP);
-    void onCloseDevice(QAbstractSocket *ipSocket);
+    void onCloseDevice(QIODevice *ipSocket);
 };
 
 #endif // IPCONNECTION_INTERNAL_H
@@ -33,6 +33,7 @@
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/icore.h>
 #include "ipconnection_internal.h"
+#include "ipdatagramdevice.h"
 
 #include <QtCore/QtPlugin>
 #include <QMainWindow>
@@ -52,7 +53,7 @@ QWaitCondition openDeviceWait;
 QWaitCondition closeDeviceWait;
 // QReadWriteLock dummyLock;
 QMutex ipConMutex;
-QAbstractSocket *ret;
+QIODevice *ret;
 
 IPConnection::IPConnection(IPconnectionConnection *connection) : QObject()
 {
@@ -60,8 +61,8 @@ IPConnection::IPConnection(IPconnectionConnection *connection) : QObject()
 
     QObject::connect(connection, SIGNAL(CreateSocket(QString, int, bool)),
                      this, SLOT(onOpenDevice(QString, int, bool)));
-    QObject::connect(connection, SIGNAL(CloseSocket(QAbstractSocket *)),
-                     this, SLOT(onCloseDevice(QAbstractSocket *)));
+    QObject::connect(connection, SIGNAL(CloseSocket(QIODevice *)),
+                     this, SLOT(onCloseDevice(QIODevice *)));
 }
 
 /*IPConnection::~IPConnection()
@@ -71,25 +72,21 @@ IPConnection::IPConnection(IPconnectionConnection *connection) : QObject()
 
 void IPConnection::onOpenDevice(QString HostName, int Port, bool UseTCP)
 {
-    QAbstractSocket *ipSocket;
     const int Timeout = 5 * 1000;
 
     ipConMutex.lock();
-    if (UseTCP) {
-        ipSocket = new QTcpSocket(this);
-    } else {
-        ipSocket = new QUdpSocket(this);
-    }
-
     // do sanity check on hostname and port...
     if ((HostName.length() == 0) || (Port < 1)) {
         errorMsg = "Please configure Host and Port options before opening the connection";
-    } else {
+    } else if (UseTCP) {
+        QTcpSocket *ipSocket = new QTcpSocket();
         // try to connect...
         ipSocket->connectToHost(HostName, Port);
 
         // in blocking mode so we wait for the connection to succeed
         if (ipSocket->waitForConnected(Timeout)) {
+            // the frames written in one go are already sent together, don't hold them back any longer
+            ipSocket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
             ret = ipSocket;
             openDeviceWait.wakeAll();
             ipConMutex.unlock();
@@ -97,6 +94,18 @@ void IPConnection::onOpenDevice(QString HostName, int Port, bool UseTCP)
         }
         // tell user something went wrong
         errorMsg = ipSocket->errorString();
+        delete ipSocket;
+    } else {
+        // batches the frames in datagrams, and shares the link if HostName is a multicast group
+        IPDatagramDevice *ipDevice = new IPDatagramDevice();
+        if (ipDevice->connectToHost(HostName, Port, Timeout)) {
+            ret = ipDevice;
+            openDeviceWait.wakeAll();
+            ipConMutex.unlock();
+            return;
+        }
+        errorMsg = ipDevice->errorString();
+        delete ipDevice;
     }
     /* BUGBUG TODO - returning null here leads to segfault because some caller still calls disconnect without checking our return value properly
      * someone needs to debug this, I got lost in the calling chain.*/
@@ -105,7 +114,7 @@ void IPConnection::onOpenDevice(QString HostName, int Port, bool UseTCP)
     ipConMutex.unlock();
 }
 
-void IPConnection::onCloseDevice(QAbstractSocket *ipSocket)
+void IPConnection::onCloseDevice(QIODevice *ipSocket)
 {
     ipConMutex.lock();
     ipSocket->close();
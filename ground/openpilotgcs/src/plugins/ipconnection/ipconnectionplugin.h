@@ -35,9 +35,7 @@
 #include <extensionsystem/iplugin.h>
 // #include <QtCore/QSettings>
 
-class QAbstractSocket;
-class QTcpSocket;
-class QUdpSocket;
+class QIODevice;
 
 class IConnection;
 
@@ -74,10 +72,10 @@ protected slots:
 
 signals: // For the benefit of IPConnection
     void CreateSocket(QString HostName, int Port, bool UseTCP);
-    void CloseSocket(QAbstractSocket *socket);
+    void CloseSocket(QIODevice *socket);
 
 private:
-    QAbstractSocket *ipSocket;
+    QIODevice *ipSocket;
     IPconnectionConfiguration *m_config;
     IPconnectionOptionsPage *m_optionspage;
     // QSettings* settings;
@@ -0,0 +1,208 @@
+/**
+ ******************************************************************************
+ *
+ * @file       ipdatagramdevice.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup IPConnPlugin IP Telemetry Plugin
+ * @{
+ * @brief IP Connection Plugin impliment telemetry over TCP/IP and UDP/IP
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "ipdatagramdevice.h"
+
+#include <QtNetwork/QHostInfo>
+#include <QtNetwork/QNetworkInterface>
+#include <QtNetwork/QUdpSocket>
+
+#include <QDebug>
+
+IPDatagramDevice::IPDatagramDevice() : QIODevice(),
+    rxSocket(new QUdpSocket(this)),
+    txSocket(NULL),
+    peerPort(0),
+    multicast(false),
+    flushTimer(this)
+{
+    txBuffer.reserve(MAX_DATAGRAM_SIZE);
+
+    // the frames of one burst of updates all go out after it, in as few datagrams as possible
+    flushTimer.setSingleShot(true);
+    flushTimer.setInterval(0);
+    connect(&flushTimer, SIGNAL(timeout()), this, SLOT(flush()));
+    connect(rxSocket, SIGNAL(readyRead()), this, SIGNAL(readyRead()));
+}
+
+IPDatagramDevice::~IPDatagramDevice()
+{
+    close();
+}
+
+/**
+ * Resolve hostName and connect to it, or join it if it is a multicast group
+ * \return false on failure, errorString() tells why
+ */
+bool IPDatagramDevice::connectToHost(const QString &hostName, quint16 port, int timeout)
+{
+    QHostAddress address;
+
+    if (!address.setAddress(hostName)) {
+        QHostInfo info = QHostInfo::fromName(hostName);
+        if (info.addresses().isEmpty()) {
+            setErrorString(info.errorString());
+            return false;
+        }
+        address = info.addresses().first();
+    }
+
+    peer     = address;
+    peerPort = port;
+    bool ipv6 = (address.protocol() == QAbstractSocket::IPv6Protocol);
+    multicast = address.isInSubnet(QHostAddress("224.0.0.0"), 4) || address.isInSubnet(QHostAddress("ff00::"), 8);
+
+    if (multicast) {
+        // several GCSs on this host may listen to the same group
+        QHostAddress any = ipv6 ? QHostAddress(QHostAddress::AnyIPv6) : QHostAddress(QHostAddress::AnyIPv4);
+        if (!rxSocket->bind(any, port, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint) ||
+            !rxSocket->joinMulticastGroup(address)) {
+            setErrorString(rxSocket->errorString());
+            return false;
+        }
+        txSocket = new QUdpSocket(this);
+        if (!txSocket->bind(any, 0)) {
+            setErrorString(txSocket->errorString());
+            return false;
+        }
+        // needed by the GCSs running on the same host as the vehicle (SITL) or as each other
+        txSocket->setSocketOption(QAbstractSocket::MulticastLoopbackOption, 1);
+        localAddresses = QNetworkInterface::allAddresses();
+    } else {
+        rxSocket->connectToHost(address, port);
+        if (!rxSocket->waitForConnected(timeout)) {
+            setErrorString(rxSocket->errorString());
+            return false;
+        }
+    }
+
+    return open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+}
+
+void IPDatagramDevice::close()
+{
+    if (isOpen()) {
+        flush();
+    }
+    flushTimer.stop();
+    if (multicast && rxSocket->state() == QAbstractSocket::BoundState) {
+        rxSocket->leaveMulticastGroup(peer);
+    }
+    rxSocket->close();
+    if (txSocket) {
+        txSocket->close();
+    }
+    QIODevice::close();
+}
+
+qint64 IPDatagramDevice::bytesAvailable() const
+{
+    if (!rxSocket->hasPendingDatagrams()) {
+        return QIODevice::bytesAvailable();
+    }
+    // an empty datagram must still be read to get past it
+    return qMax<qint64>(rxSocket->pendingDatagramSize(), 1) + QIODevice::bytesAvailable();
+}
+
+qint64 IPDatagramDevice::bytesToWrite() const
+{
+    return txBuffer.size() + QIODevice::bytesToWrite();
+}
+
+/**
+ * Read the pending datagrams straight into data, as long as they fit whole
+ */
+qint64 IPDatagramDevice::readData(char *data, qint64 maxSize)
+{
+    qint64 count = 0;
+
+    while (rxSocket->hasPendingDatagrams()) {
+        qint64 size = rxSocket->pendingDatagramSize();
+        if (count + size > maxSize) {
+            if (count > 0) {
+                break;
+            }
+            // no UAVTalk frame is that large, the rest of this datagram is lost
+            qWarning() << "IPDatagramDevice - datagram of" << size << "bytes truncated to" << maxSize;
+            size = maxSize;
+        }
+        QHostAddress sender;
+        quint16 senderPort;
+        qint64 length = rxSocket->readDatagram(data + count, size, &sender, &senderPort);
+        if (length < 0) {
+            break;
+        }
+        if (multicast && isOwnDatagram(sender, senderPort)) {
+            continue;
+        }
+        count += length;
+    }
+    return count;
+}
+
+/**
+ * Append data to the datagram being built, sending the latter first if data does not fit
+ */
+qint64 IPDatagramDevice::writeData(const char *data, qint64 maxSize)
+{
+    if (!txBuffer.isEmpty() && txBuffer.size() + maxSize > MAX_DATAGRAM_SIZE) {
+        flush();
+    }
+    txBuffer.append(data, maxSize);
+    if (txBuffer.size() >= MAX_DATAGRAM_SIZE) {
+        flush();
+    } else if (!flushTimer.isActive()) {
+        flushTimer.start();
+    }
+    return maxSize;
+}
+
+void IPDatagramDevice::flush()
+{
+    if (txBuffer.isEmpty()) {
+        return;
+    }
+
+    qint64 sent;
+    if (multicast) {
+        sent = txSocket->writeDatagram(txBuffer, peer, peerPort);
+    } else {
+        // a connected socket sends each write as one datagram
+        sent = rxSocket->write(txBuffer);
+    }
+    if (sent != txBuffer.size()) {
+        qWarning() << "IPDatagramDevice - error sending datagram :" << (multicast ? txSocket : rxSocket)->errorString();
+    }
+    emit bytesWritten(txBuffer.size());
+    // keeps the reserved capacity
+    txBuffer.resize(0);
+}
+
+bool IPDatagramDevice::isOwnDatagram(const QHostAddress &sender, quint16 senderPort) const
+{
+    return senderPort == txSocket->localPort() && localAddresses.contains(sender);
+}
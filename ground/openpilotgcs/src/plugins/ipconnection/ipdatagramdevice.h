@@ -0,0 +1,97 @@
+/**
+ ******************************************************************************
+ *
+ * @file       ipdatagramdevice.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup IPConnPlugin IP Telemetry Plugin
+ * @{
+ * @brief IP Connection Plugin impliment telemetry over TCP/IP and UDP/IP
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef IPDATAGRAMDEVICE_H
+#define IPDATAGRAMDEVICE_H
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QHostAddress>
+#include <QList>
+#include <QTimer>
+
+class QUdpSocket;
+
+/**
+ * UDP telemetry link seen as a stream by UAVTalk.
+ *
+ * Frames written in the same event loop iteration are sent together in datagrams of
+ * at most MAX_DATAGRAM_SIZE bytes. Reads hand whole datagrams to the caller, as many
+ * as fit in its buffer, with no intermediate copy.
+ *
+ * If the host is a multicast group the link is shared: every GCS that joined the group
+ * receives the vehicle stream and the frames sent by the other GCSs, but not its own.
+ */
+class IPDatagramDevice : public QIODevice {
+    Q_OBJECT
+
+public:
+    // largest UDP payload that fits an ethernet frame without fragmentation
+    static const int MAX_DATAGRAM_SIZE = 1472;
+
+    IPDatagramDevice();
+    virtual ~IPDatagramDevice();
+
+    bool connectToHost(const QString &hostName, quint16 port, int timeout);
+    virtual void close();
+
+    virtual bool isSequential() const
+    {
+        return true;
+    }
+    virtual qint64 bytesAvailable() const;
+    virtual qint64 bytesToWrite() const;
+
+    bool isMulticast() const
+    {
+        return multicast;
+    }
+
+protected:
+    virtual qint64 readData(char *data, qint64 maxSize);
+    virtual qint64 writeData(const char *data, qint64 maxSize);
+
+private slots:
+    void flush();
+
+private:
+    // receives the stream, and sends it too unless multicast
+    QUdpSocket *rxSocket;
+    // sends to the multicast group from a port of its own, so our echo can be told apart
+    QUdpSocket *txSocket;
+    QHostAddress peer;
+    quint16 peerPort;
+    bool multicast;
+    QList<QHostAddress> localAddresses;
+
+    QByteArray txBuffer;
+    QTimer flushTimer;
+
+    bool isOwnDatagram(const QHostAddress &sender, quint16 senderPort) const;
+};
+
+#endif // IPDATAGRAMDEVICE_H
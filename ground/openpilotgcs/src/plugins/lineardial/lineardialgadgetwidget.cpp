@@ -36,9 +36,10 @@ LineardialGadgetWidget::LineardialGadgetWidget(QWidget *parent) : QGraphicsView(
     setMinimumSize(32, 32);
     setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::MinimumExpanding);
     setScene(new QGraphicsScene(this));
-    setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing);
+    setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing | QPainter::SmoothPixmapTransform);
     m_renderer   = new QSvgRenderer();
     verticalDial = false;
+    index = NULL;
 
     paint();
 
@@ -78,7 +79,7 @@ void LineardialGadgetWidget::enableOpenGL(bool flag)
 void LineardialGadgetWidget::connectInput(QString object1, QString nfield1)
 {
     if (obj1 != NULL) {
-        disconnect(obj1, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateIndex(UAVObject *)));
+        disconnect(obj1, SIGNAL(objectUpdatedCoalesced(UAVObject *)), this, SLOT(updateIndex(UAVObject *)));
     }
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
@@ -89,7 +90,8 @@ void LineardialGadgetWidget::connectInput(QString object1, QString nfield1)
     if (!(object1.isEmpty() || nfield1.isEmpty())) {
         obj1 = dynamic_cast<UAVDataObject *>(objManager->getObject(object1));
         if (obj1 != NULL) {
-            connect(obj1, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateIndex(UAVObject *)));
+            // The index is only redrawn once per display refresh anyway
+            objManager->connectCoalesced(obj1, this, SLOT(updateIndex(UAVObject *)));
             if (nfield1.contains("-")) {
                 QStringList fieldSubfield = nfield1.split("-", QString::SkipEmptyParts);
                 field1        = fieldSubfield.at(0);
@@ -176,6 +178,9 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
         background->setElementId("background");
         background->setFlags(QGraphicsItem::ItemClipsChildrenToShape |
                              QGraphicsItem::ItemClipsToShape);
+        // The static layers are kept rendered at the resolution of the screen
+        // instead of drawing the SVG each frame.
+        background->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
         l_scene->addItem(background);
 
         // The red/yellow/green zones are optional, we just
@@ -187,14 +192,17 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
             red->setSharedRenderer(m_renderer);
             red->setElementId("red");
             red->setParentItem(background);
+            red->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
             yellow = new QGraphicsSvgItem();
             yellow->setSharedRenderer(m_renderer);
             yellow->setElementId("yellow");
             yellow->setParentItem(background);
+            yellow->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
             green = new QGraphicsSvgItem();
             green->setSharedRenderer(m_renderer);
             green->setElementId("green");
             green->setParentItem(background);
+            green->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
             // In order to properly render the Green/Yellow/Red graphs, we need to find out
             // the starting location of the bargraph rendering area:
             QMatrix textMatrix = m_renderer->matrixForElement("bargraph");
@@ -326,6 +334,7 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
             fieldSymbol->setSharedRenderer(m_renderer);
             fieldSymbol->setTransform(matrix, false);
             fieldSymbol->setParentItem(background);
+            fieldSymbol->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
         } else {
             fieldSymbol = NULL;
         }
@@ -335,6 +344,7 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
             foreground->setSharedRenderer(m_renderer);
             foreground->setElementId("foreground");
             foreground->setParentItem(background);
+            foreground->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
             fgenabled = true;
         } else {
             fgenabled = false;
@@ -347,6 +357,7 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
         if (!dialTimer.isActive() && index) {
             dialTimer.start();
         }
+        updateIndexCache();
     } else {
         qDebug() << "no file ";
         m_renderer->load(QString(":/lineardial/images/empty.svg"));
@@ -404,6 +415,22 @@ void LineardialGadgetWidget::resizeEvent(QResizeEvent *event)
 {
     Q_UNUSED(event);
     fitInView(background, Qt::KeepAspectRatio);
+    updateIndexCache();
+}
+
+/*
+   The index is cached as a pixmap in its own coordinates, which is only
+   translated as the index moves. The pixmap is sized for the current
+   scale of the view and the pixel ratio of the screen to stay sharp.
+ */
+void LineardialGadgetWidget::updateIndexCache()
+{
+    if (!index) {
+        return;
+    }
+    qreal scale = transform().m11() * devicePixelRatio();
+    QSize size  = (index->boundingRect().size() * scale).toSize();
+    index->setCacheMode(QGraphicsItem::ItemCoordinateCache, size);
 }
 
 // Converts the value into an percentage:
@@ -440,7 +467,6 @@ void LineardialGadgetWidget::moveIndex()
     } else {
         matrix.translate(trans + startX, startY);
     }
+    // Moving the index schedules the repaint of the area it covers
     index->setTransform(matrix, false);
-
-    update();
 }
@@ -85,6 +85,7 @@ protected:
     void resizeEvent(QResizeEvent *event);
 
 private:
+    void updateIndexCache();
 
 private slots:
     void moveIndex();
@@ -1,5 +1,6 @@
 TEMPLATE = lib
 TARGET = ModelViewGadget
+QT += concurrent
 include(../../openpilotgcsplugin.pri)
 include(../../plugins/coreplugin/coreplugin.pri)
 include(../../libs/glc_lib/glc_lib.pri)
@@ -10,6 +11,7 @@ HEADERS += modelviewplugin.h \
     modelviewgadgetconfiguration.h \
     modelviewgadget.h \
     modelviewgadgetwidget.h \
+    modelviewmeshcache.h \
     modelviewgadgetfactory.h \
     modelviewgadgetoptionspage.h
 SOURCES += modelviewplugin.cpp \
@@ -17,6 +19,7 @@ SOURCES += modelviewplugin.cpp \
     modelviewgadget.cpp \
     modelviewgadgetfactory.cpp \
     modelviewgadgetwidget.cpp \
+    modelviewmeshcache.cpp \
     modelviewgadgetoptionspage.cpp
 OTHER_FILES += ModelViewGadget.pluginspec
 FORMS += modelviewoptionspage.ui
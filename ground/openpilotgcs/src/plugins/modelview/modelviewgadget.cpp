@@ -47,3 +47,13 @@ void ModelViewGadget::loadConfiguration(IUAVGadgetConfiguration *config)
     m_widget->setVboEnable(m->vboEnabled());
     m_widget->reloadScene();
 }
+
+void ModelViewGadget::suspend()
+{
+    m_widget->setSuspended(true);
+}
+
+void ModelViewGadget::resume()
+{
+    m_widget->setSuspended(false);
+}
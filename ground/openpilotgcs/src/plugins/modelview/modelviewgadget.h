@@ -49,6 +49,8 @@ public:
         return m_widget;
     }
     void loadConfiguration(IUAVGadgetConfiguration *config);
+    void suspend();
+    void resume();
 
 private:
     ModelViewGadgetWidget *m_widget;
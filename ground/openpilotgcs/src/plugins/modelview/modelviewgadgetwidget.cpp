@@ -34,17 +34,34 @@
 #include "glc_exception.h"
 #include "glc_openglexception.h"
 #include "viewport/glc_userinput.h"
+#include "modelviewmeshcache.h"
+
+#include <QtConcurrent/QtConcurrentRun>
 
 #include <iostream>
 
+// About a frame per display refresh, frames are only drawn when the attitude changed
+static const int FRAME_INTERVAL = 16;
+
+static QGLFormat glFormat()
+{
+    QGLFormat format(QGL::SampleBuffers);
+
+    // Swap on vertical sync
+    format.setSwapInterval(1);
+    return format;
+}
+
 ModelViewGadgetWidget::ModelViewGadgetWidget(QWidget *parent)
-    : QGLWidget(new GLC_Context(QGLFormat(QGL::SampleBuffers)), parent)
+    : QGLWidget(new GLC_Context(glFormat()), parent)
     , m_Light()
     , m_World()
     , m_GlView()
     , m_MoverController()
     , m_ModelBoundingBox()
     , m_MotionTimer()
+    , m_attitudeChanged(true)
+    , m_suspended(false)
     , acFilename()
     , bgFilename()
     , vboEnable(false)
@@ -63,17 +80,25 @@ ModelViewGadgetWidget::ModelViewGadgetWidget(QWidget *parent)
     repColor.setRgbF(1.0, 0.11372, 0.11372, 0.0);
     m_MoverController = GLC_Factory::instance()->createDefaultMoverController(repColor, &m_GlView);
 
+    // Parts smaller than a few pixels are skipped and meshes drawn at the detail of their size on screen
+    GLC_State::setPixelCullingUsage(true);
+
+    connect(&m_loadWatcher, SIGNAL(finished()), this, SLOT(sceneLoaded()));
     CreateScene();
     // Get required UAVObjects
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
     attState = AttitudeState::GetInstance(objManager);
+    connect(attState, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(attitudeChanged()));
 
+    m_MotionTimer.setInterval(FRAME_INTERVAL);
     connect(&m_MotionTimer, SIGNAL(timeout()), this, SLOT(updateAttitude()));
 }
 
 ModelViewGadgetWidget::~ModelViewGadgetWidget()
-{}
+{
+    m_loadWatcher.waitForFinished();
+}
 
 
 void ModelViewGadgetWidget::setAcFilename(QString acf)
@@ -102,6 +127,18 @@ void ModelViewGadgetWidget::setVboEnable(bool eVbo)
     m_World.collection()->setVboUsage(vboEnable);
 }
 
+// Stops drawing while the gadget is hidden
+void ModelViewGadgetWidget::setSuspended(bool suspended)
+{
+    m_suspended = suspended;
+    if (suspended) {
+        m_MotionTimer.stop();
+    } else if (isValid() && !m_MoverController.hasActiveMover()) {
+        m_attitudeChanged = true;
+        m_MotionTimer.start();
+    }
+}
+
 //// Public funcitons ////
 void ModelViewGadgetWidget::reloadScene()
 {
@@ -126,7 +163,9 @@ void ModelViewGadgetWidget::initializeGL()
     // Enable antialiasing
     glEnable(GL_MULTISAMPLE);
 
-    m_MotionTimer.start(100);
+    if (!m_suspended) {
+        m_MotionTimer.start();
+    }
     setFocusPolicy(Qt::StrongFocus); // keyboard capture for camera switching
 }
 
@@ -197,20 +236,31 @@ void ModelViewGadgetWidget::CreateScene()
         qDebug("ModelView: background image file loading failed.");
     }
 
-    try {
-        if (QFile::exists(acFilename)) {
-            QFile aircraft(acFilename);
-            m_World = GLC_Factory::instance()->createWorldFromFile(aircraft);
-            m_ModelBoundingBox = m_World.boundingBox();
-            m_GlView.reframe(m_ModelBoundingBox); // center 3D model in the scene
-        } else {
-            qDebug("ModelView: aircraft file not found.");
-        }
-    } catch(GLC_Exception e) {
-        qDebug("ModelView: aircraft file loading failed.");
+    // The model is parsed, or read from the mesh cache, without blocking the GCS
+    if (QFile::exists(acFilename)) {
+        m_loadWatcher.setFuture(QtConcurrent::run(&ModelViewMeshCache::load, acFilename));
+    } else {
+        qDebug("ModelView: aircraft file not found.");
     }
 }
 
+void ModelViewGadgetWidget::sceneLoaded()
+{
+    // A newer load replaced this one
+    if (m_loadWatcher.isRunning()) {
+        return;
+    }
+
+    m_World = m_loadWatcher.result();
+    m_World.collection()->setVboUsage(vboEnable);
+    m_World.collection()->setLodUsage(true, &m_GlView);
+    m_ModelBoundingBox = m_World.boundingBox();
+    m_GlView.reframe(m_ModelBoundingBox); // center 3D model in the scene
+
+    m_attitudeChanged = true;
+    updateAttitude();
+}
+
 void ModelViewGadgetWidget::wheelEvent(QWheelEvent *e)
 {
     double delta = m_GlView.cameraHandle()->distEyeTarget() - (e->delta() / 4);
@@ -264,7 +314,9 @@ void ModelViewGadgetWidget::mouseReleaseEvent(QMouseEvent *)
         return;
     }
     m_MoverController.setNoMover();
-    m_MotionTimer.start();
+    if (!m_suspended) {
+        m_MotionTimer.start();
+    }
     updateGL();
 }
 
@@ -320,8 +372,19 @@ void ModelViewGadgetWidget::keyPressEvent(QKeyEvent *e) // switch between camera
 //////////////////////////////////////////////////////////////////////
 // Private slots Functions
 //////////////////////////////////////////////////////////////////////
+void ModelViewGadgetWidget::attitudeChanged()
+{
+    m_attitudeChanged = true;
+}
+
+// Draws a frame with the latest attitude, when it changed since the last frame
 void ModelViewGadgetWidget::updateAttitude()
 {
+    if (!m_attitudeChanged) {
+        return;
+    }
+    m_attitudeChanged = false;
+
     AttitudeState::DataFields data  = attState->getData(); // get attitude data
     GLC_StructOccurence *rootObject = m_World.rootOccurence(); // get the full 3D model
     double x = data.q3;
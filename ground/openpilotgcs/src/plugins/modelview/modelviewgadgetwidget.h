@@ -30,6 +30,7 @@
 
 #include <QGLWidget>
 #include <QTimer>
+#include <QFutureWatcher>
 
 #include "glc_factory.h"
 #include "viewport/glc_viewport.h"
@@ -54,6 +55,7 @@ public:
     void setVboEnable(bool eVbo);
     void reloadScene();
     void updateAttitude(int value);
+    void setSuspended(bool suspended);
 
 private:
     void initializeGL();
@@ -74,6 +76,8 @@ private:
 //////////////////////////////////////////////////////////////////////
 private slots:
     void updateAttitude();
+    void attitudeChanged();
+    void sceneLoaded();
 
 private:
     GLC_Factory *m_pFactory;
@@ -82,8 +86,12 @@ private:
     GLC_Viewport m_GlView;
     GLC_MoverController m_MoverController;
     GLC_BoundingBox m_ModelBoundingBox;
-    // ! The timer used for motion
+    // ! The timer used for motion, a frame is drawn per tick when the attitude changed
     QTimer m_MotionTimer;
+    bool m_attitudeChanged;
+    bool m_suspended;
+    // ! The model is parsed on a worker thread
+    QFutureWatcher<GLC_World> m_loadWatcher;
 
     QString acFilename;
     QString bgFilename;
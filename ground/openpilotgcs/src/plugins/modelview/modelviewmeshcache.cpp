@@ -0,0 +1,165 @@
+/**
+ ******************************************************************************
+ *
+ * @file       modelviewmeshcache.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ModelViewPlugin ModelView Plugin
+ * @{
+ * @brief A gadget that displays a 3D representation of the UAV
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "modelviewmeshcache.h"
+#include "glc_factory.h"
+#include "glc_exception.h"
+#include "geometry/glc_3drep.h"
+#include "sceneGraph/glc_structoccurence.h"
+#include "utils/pathutils.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+// Increment the version when the layout of the cache file changes
+static const quint32 CACHE_MAGIC   = 0x4d564d43;
+static const quint32 CACHE_VERSION = 1;
+
+/**
+ * Returns the model of a file, from the cache when it is up to date.
+ * The world is empty if the model could not be loaded.
+ */
+GLC_World ModelViewMeshCache::load(const QString &fileName)
+{
+    GLC_World world;
+
+    // Resource models are small and always there
+    bool cached = !fileName.startsWith(QLatin1Char(':'));
+    QDateTime sourceTime = QFileInfo(fileName).lastModified();
+    QString cacheName    = cached ? cacheFileName(fileName) : QString();
+
+    if (cached && readCache(cacheName, sourceTime, world)) {
+        return world;
+    }
+
+    try {
+        QFile file(fileName);
+        world = GLC_Factory::instance()->createWorldFromFile(file);
+    } catch(GLC_Exception &e) {
+        qDebug() << "ModelView: aircraft file loading failed:" << e.what();
+        return GLC_World();
+    }
+
+    if (cached && !writeCache(cacheName, sourceTime, world)) {
+        qDebug() << "ModelView: could not write the mesh cache" << cacheName;
+    }
+    return world;
+}
+
+QString ModelViewMeshCache::cacheFileName(const QString &fileName)
+{
+    QByteArray key = QCryptographicHash::hash(QFileInfo(fileName).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1);
+
+    return Utils::PathUtils().GetStoragePath() + QLatin1String("modelview/") + QString::fromLatin1(key.toHex()) + QLatin1String(".mvc");
+}
+
+/**
+ * The cache holds the representations of the model flattened under the root,
+ * each with its matrix relative to the root.
+ */
+bool ModelViewMeshCache::readCache(const QString &cacheFileName, const QDateTime &sourceTime, GLC_World &world)
+{
+    QFile file(cacheFileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic, version;
+    QDateTime time;
+    stream >> magic >> version >> time;
+    if (magic != CACHE_MAGIC || version != CACHE_VERSION || time != sourceTime) {
+        return false;
+    }
+
+    quint32 count;
+    stream >> count;
+    GLC_World cachedWorld;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++) {
+        double matrix[16];
+        for (int j = 0; j < 16; j++) {
+            stream >> matrix[j];
+        }
+        GLC_3DRep *rep = new GLC_3DRep();
+        stream >> *rep;
+
+        GLC_StructInstance *instance = new GLC_StructInstance(rep);
+        instance->setMatrix(GLC_Matrix4x4(matrix));
+        cachedWorld.rootOccurence()->addChild(instance);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qDebug() << "ModelView: mesh cache" << cacheFileName << "is corrupted";
+        return false;
+    }
+
+    world = cachedWorld;
+    return true;
+}
+
+bool ModelViewMeshCache::writeCache(const QString &cacheFileName, const QDateTime &sourceTime, const GLC_World &world)
+{
+    QList<GLC_3DRep *> reps;
+    QList<GLC_Matrix4x4> matrices;
+
+    foreach(GLC_StructOccurence * occurence, world.rootOccurence()->subOccurenceList()) {
+        if (!occurence->hasRepresentation()) {
+            continue;
+        }
+        GLC_3DRep *rep = dynamic_cast<GLC_3DRep *>(occurence->structReference()->representationHandle());
+        if (rep && !rep->isEmpty()) {
+            reps.append(rep);
+            matrices.append(occurence->absoluteMatrix());
+        }
+    }
+
+    QDir().mkpath(QFileInfo(cacheFileName).absolutePath());
+    QSaveFile file(cacheFileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << CACHE_MAGIC << CACHE_VERSION << sourceTime << (quint32)reps.size();
+    for (int i = 0; i < reps.size(); i++) {
+        const double *matrix = matrices.at(i).getData();
+        for (int j = 0; j < 16; j++) {
+            stream << matrix[j];
+        }
+        stream << *reps.at(i);
+    }
+
+    return stream.status() == QDataStream::Ok && file.commit();
+}
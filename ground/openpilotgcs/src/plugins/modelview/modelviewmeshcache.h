@@ -0,0 +1,51 @@
+/**
+ ******************************************************************************
+ *
+ * @file       modelviewmeshcache.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ModelViewPlugin ModelView Plugin
+ * @{
+ * @brief A gadget that displays a 3D representation of the UAV
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef MODELVIEWMESHCACHE_H_
+#define MODELVIEWMESHCACHE_H_
+
+#include "sceneGraph/glc_world.h"
+
+#include <QDateTime>
+#include <QString>
+
+/*!
+   \brief Loads 3D models, keeping a binary copy of the parsed meshes in the GCS storage path.
+   The copy is used while it is newer than the model file, it skips parsing the model format.
+   Loading does not need an OpenGL context and can run on a worker thread.
+ */
+class ModelViewMeshCache {
+public:
+    static GLC_World load(const QString &fileName);
+
+private:
+    static QString cacheFileName(const QString &fileName);
+    static bool readCache(const QString &cacheFileName, const QDateTime &sourceTime, GLC_World &world);
+    static bool writeCache(const QString &cacheFileName, const QDateTime &sourceTime, const GLC_World &world);
+};
+
+#endif /* MODELVIEWMESHCACHE_H_ */
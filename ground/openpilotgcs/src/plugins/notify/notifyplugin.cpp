@@ -194,6 +194,7 @@ void SoundNotifyPlugin::connectNotifications()
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
 
     lstNotifiedUAVObjects.clear();
+    _notificationsByObject.clear();
     _pendingNotifications.clear();
     _notificationList.append(_toRemoveNotifications);
     _toRemoveNotifications.clear();
@@ -214,6 +215,7 @@ void SoundNotifyPlugin::connectNotifications()
 
         UAVDataObject *obj = dynamic_cast<UAVDataObject *>(objManager->getObject(notify->getDataObject()));
         if (obj != NULL) {
+            _notificationsByObject[obj->getName()].append(notify);
             if (!lstNotifiedUAVObjects.contains(obj)) {
                 lstNotifiedUAVObjects.append(obj);
 
@@ -238,12 +240,8 @@ void SoundNotifyPlugin::connectNotifications()
 
 void SoundNotifyPlugin::on_arrived_Notification(UAVObject *object)
 {
-    foreach(NotificationItem * ntf, _notificationList) {
-        if (object->getName() != ntf->getDataObject()) {
-            continue;
-        }
-
-
+    // only the notifications on this object are checked
+    foreach(NotificationItem * ntf, _notificationsByObject.value(object->getName())) {
         // skip duplicate notifications
         if (_nowPlayingNotification == ntf) {
             continue;
@@ -270,8 +268,6 @@ void SoundNotifyPlugin::on_arrived_Notification(UAVObject *object)
 
         checkNotificationRule(ntf, object);
     }
-    connect(object, SIGNAL(objectUpdated(UAVObject *)),
-            this, SLOT(on_arrived_Notification(UAVObject *)), Qt::UniqueConnection);
 }
 
 
@@ -400,7 +396,7 @@ bool checkRange(double fieldValue, double min, double max, int direction)
 
 void SoundNotifyPlugin::checkNotificationRule(NotificationItem *notification, UAVObject *object)
 {
-    if (notification->getDataObject() != object->getName() || object->getField(notification->getObjectField()) == NULL) {
+    if (notification->getDataObject() != object->getName()) {
         return;
     }
     bool condition = false;
@@ -410,10 +406,9 @@ void SoundNotifyPlugin::checkNotificationRule(NotificationItem *notification, UA
     }
 
     int direction         = notification->getCondition();
-    QString fieldName     = notification->getObjectField();
-    UAVObjectField *field = object->getField(fieldName);
+    UAVObjectField *field = object->getField(notification->getObjectField());
 
-    if (field->getName().isEmpty()) {
+    if (field == NULL || field->getName().isEmpty()) {
         return;
     }
 
@@ -491,6 +486,7 @@ bool SoundNotifyPlugin::playNotification(NotificationItem *notification)
 
         if (notification->retryValue() == NotificationItem::repeatOnce) {
             _toRemoveNotifications.append(_notificationList.takeAt(_notificationList.indexOf(notification)));
+            _notificationsByObject[notification->getDataObject()].removeOne(notification);
         } else if (notification->retryValue() == NotificationItem::repeatOncePerUpdate) {
             notification->setCurrentUpdatePlayed(true);
         } else {
@@ -102,6 +102,8 @@ private:
 
     QList<UAVDataObject *> lstNotifiedUAVObjects;
     QList<NotificationItem *> _notificationList;
+    // _notificationList by the name of the object they watch
+    QHash<QString, QList<NotificationItem *> > _notificationsByObject;
     QList<NotificationItem *> _pendingNotifications;
     QList<NotificationItem *> _toRemoveNotifications;
 
@@ -51,6 +51,21 @@ class OPHID_EXPORT RawHID : public QIODevice {
     friend class RawHIDWriteThread;
 
 public:
+    /** Throughput and latency of the HID link since it was opened */
+    typedef struct {
+        quint32 bytesRead;
+        quint32 bytesWritten;
+        quint32 reportsRead;
+        quint32 reportsWritten;
+        // reports (partly) dropped because the reader didn't keep up
+        quint32 readOverruns;
+        // readyRead signals drained by the reader
+        quint32 readDrains;
+        // from readyRead to the reader draining the data, in us
+        quint32 averageReadLatency;
+        quint32 maxReadLatency;
+    } Stats;
+
     RawHID();
     RawHID(const QString &deviceName);
     virtual ~RawHID();
@@ -59,6 +74,8 @@ public:
     virtual void close();
     virtual bool isSequential() const;
 
+    Stats getStats() const;
+
 signals:
     void closed();
 
@@ -33,6 +33,8 @@
 #include <QList>
 #include <QMutexLocker>
 #include <QWaitCondition>
+#include <QAtomicInt>
+#include <QElapsedTimer>
 
 class IConnection;
 
@@ -43,6 +45,87 @@ static const int READ_SIZE     = 64;
 static const int WRITE_TIMEOUT = 1000;
 static const int WRITE_SIZE    = 64;
 
+// ring sizes, must be powers of two
+static const int READ_BUFFER_SIZE  = 256 * 1024;
+static const int WRITE_BUFFER_SIZE = 64 * 1024;
+
+
+// *********************************************************************************
+
+/**
+ *   Lock free byte ring shared by exactly one producer and one consumer thread.
+ *   Head and tail count the bytes pushed and consumed so far, each is only
+ *   modified by its own side and published with release semantics.
+ */
+class RawHIDRingBuffer {
+    Q_DISABLE_COPY(RawHIDRingBuffer)
+public:
+    explicit RawHIDRingBuffer(int capacity)
+        : m_buffer(new char[capacity]),
+        m_capacity(capacity),
+        m_head(0),
+        m_tail(0)
+    {
+        Q_ASSERT((capacity & (capacity - 1)) == 0);
+    }
+    ~RawHIDRingBuffer()
+    {
+        delete[] m_buffer;
+    }
+
+    /** Number of bytes buffered, exact on the consumer side */
+    int size() const
+    {
+        return (uint)m_head.loadAcquire() - (uint)m_tail.loadAcquire();
+    }
+
+    /** Producer: append up to size bytes, return the number appended */
+    int push(const char *data, int size)
+    {
+        uint head = m_head.load();
+
+        size = qMin(size, m_capacity - (int)(head - (uint)m_tail.loadAcquire()));
+        int offset = head & (m_capacity - 1);
+        int first  = qMin(size, m_capacity - offset);
+        memcpy(m_buffer + offset, data, first);
+        memcpy(m_buffer, data + first, size - first);
+        m_head.storeRelease(head + size);
+        return size;
+    }
+
+    /** Consumer: copy up to size bytes without consuming them */
+    int peek(char *data, int size) const
+    {
+        uint tail = m_tail.load();
+
+        size = qMin(size, (int)((uint)m_head.loadAcquire() - tail));
+        int offset = tail & (m_capacity - 1);
+        int first  = qMin(size, m_capacity - offset);
+        memcpy(data, m_buffer + offset, first);
+        memcpy(data + first, m_buffer, size - first);
+        return size;
+    }
+
+    /** Consumer: drop size bytes, previously peeked */
+    void skip(int size)
+    {
+        m_tail.storeRelease((uint)m_tail.load() + size);
+    }
+
+    int read(char *data, int size)
+    {
+        size = peek(data, size);
+        skip(size);
+        return size;
+    }
+
+private:
+    char *m_buffer;
+    int m_capacity;
+    QAtomicInt m_head;
+    QAtomicInt m_tail;
+};
+
 
 // *********************************************************************************
 
@@ -60,6 +143,8 @@ public:
     /** return the bytes buffered */
     qint64 getBytesAvailable();
 
+    void getStats(RawHID::Stats &stats);
+
 public slots:
     void terminate()
     {
@@ -69,12 +154,25 @@ public slots:
 protected:
     void run();
 
-    /** QByteArray might not be the most efficient way to implement
-       a circular buffer but it's good enough and very simple */
-    QByteArray m_readBuffer;
+    /** Filled by this thread, drained by the reader of the device */
+    RawHIDRingBuffer m_readBuffer;
+
+    /** Set when readyRead has been emitted and not drained yet,
+       so a burst of reports only signals the reader once */
+    QAtomicInt m_readyReadPending;
+    /** When the pending readyRead was emitted, in us */
+    QAtomicInt m_readyReadTime;
+    QElapsedTimer m_clock;
+
+    /** Updated by this thread */
+    QAtomicInt m_bytesRead;
+    QAtomicInt m_reportsRead;
+    QAtomicInt m_overruns;
 
-    /** A mutex to protect read buffer */
-    QMutex m_readBufMtx;
+    /** Updated by the reader of the device */
+    quint32 m_drains;
+    quint64 m_totalLatency;
+    quint32 m_maxLatency;
 
     RawHID *m_hid;
 
@@ -101,6 +199,8 @@ public:
     /** Return the number of bytes buffered */
     qint64 getBytesToWrite();
 
+    void getStats(RawHID::Stats &stats);
+
 public slots:
     void terminate()
     {
@@ -110,16 +210,18 @@ public slots:
 protected:
     void run();
 
-    /** QByteArray might not be the most efficient way to implement
-       a circular buffer but it's good enough and very simple */
-    QByteArray m_writeBuffer;
+    /** Filled by the writer of the device, drained by this thread */
+    RawHIDRingBuffer m_writeBuffer;
 
-    /** A mutex to protect read buffer */
+    /** Only used to sleep on m_newDataToWrite, the buffer itself is lock free */
     QMutex m_writeBufMtx;
 
     /** Synchronize task with data arival */
     QWaitCondition m_newDataToWrite;
 
+    QAtomicInt m_bytesWritten;
+    QAtomicInt m_reportsWritten;
+
     RawHID *m_hid;
 
     opHID_hidapi *hiddev;
@@ -131,12 +233,22 @@ protected:
 // *********************************************************************************
 
 RawHIDReadThread::RawHIDReadThread(RawHID *hid)
-    : m_hid(hid),
+    : m_readBuffer(READ_BUFFER_SIZE),
+    m_readyReadPending(0),
+    m_readyReadTime(0),
+    m_bytesRead(0),
+    m_reportsRead(0),
+    m_overruns(0),
+    m_drains(0),
+    m_totalLatency(0),
+    m_maxLatency(0),
+    m_hid(hid),
     hiddev(&hid->dev),
     hidno(hid->m_deviceNo),
     m_running(true)
 {
     OPHID_TRACE("IN");
+    m_clock.start();
     hid->m_startedMutex->lock();
     OPHID_TRACE("OUT");
 }
@@ -169,12 +281,24 @@ void RawHIDReadThread::run()
         int ret = hiddev->receive(hidno, buffer, READ_SIZE, READ_TIMEOUT);
 
         if (ret > 0) { // read some data
-            QMutexLocker lock(&m_readBufMtx);
             // Note: Preprocess the USB packets in this OS independent code
             // First byte is report ID, second byte is the number of valid bytes
-            m_readBuffer.append(&buffer[2], buffer[1]);
+            int size = qMin((int)(quint8)buffer[1], READ_SIZE - 2);
+            int pushed = m_readBuffer.push(&buffer[2], size);
+
+            m_bytesRead.fetchAndAddRelaxed(pushed);
+            m_reportsRead.fetchAndAddRelaxed(1);
+            if (pushed < size) {
+                // the reader is not keeping up, drop what doesn't fit
+                m_overruns.fetchAndAddRelaxed(1);
+            }
 
-            emit m_hid->readyRead();
+            // only signal again once the reader drained the previous data
+            if (m_readyReadPending.loadAcquire() == 0) {
+                m_readyReadTime.store(m_clock.nsecsElapsed() / 1000);
+                m_readyReadPending.storeRelease(1);
+                emit m_hid->readyRead();
+            }
         } else if (ret == 0) { // nothing read
         } else { // < 0 => error
                  // TODO! make proper error handling, this only quick hack for unplug freeze
@@ -188,27 +312,39 @@ void RawHIDReadThread::run()
 
 int RawHIDReadThread::getReadData(char *data, int size)
 {
-    QMutexLocker lock(&m_readBufMtx);
-
-    size = qMin(size, m_readBuffer.size());
-
-    memcpy(data, m_readBuffer.constData(), size);
-    m_readBuffer.remove(0, size);
+    // cleared before reading so data pushed from now on signals again
+    if (m_readyReadPending.fetchAndStoreAcquire(0)) {
+        quint32 latency = (quint32)(m_clock.nsecsElapsed() / 1000) - (quint32)m_readyReadTime.load();
+        m_drains++;
+        m_totalLatency += latency;
+        m_maxLatency    = qMax(m_maxLatency, latency);
+    }
 
-    return size;
+    return m_readBuffer.read(data, size);
 }
 
 qint64 RawHIDReadThread::getBytesAvailable()
 {
-    QMutexLocker lock(&m_readBufMtx);
-
     return m_readBuffer.size();
 }
 
+void RawHIDReadThread::getStats(RawHID::Stats &stats)
+{
+    stats.bytesRead      = m_bytesRead.load();
+    stats.reportsRead    = m_reportsRead.load();
+    stats.readOverruns   = m_overruns.load();
+    stats.readDrains     = m_drains;
+    stats.averageReadLatency = m_drains ? m_totalLatency / m_drains : 0;
+    stats.maxReadLatency = m_maxLatency;
+}
+
 // *********************************************************************************
 
 RawHIDWriteThread::RawHIDWriteThread(RawHID *hid)
-    : m_hid(hid),
+    : m_writeBuffer(WRITE_BUFFER_SIZE),
+    m_bytesWritten(0),
+    m_reportsWritten(0),
+    m_hid(hid),
     hiddev(&hid->dev),
     hidno(hid->m_deviceNo),
     m_running(true)
@@ -229,36 +365,32 @@ void RawHIDWriteThread::run()
         char buffer[WRITE_SIZE] = { 0 };
         int size;
 
-        {
+        if (m_writeBuffer.size() <= 0) {
             QMutexLocker lock(&m_writeBufMtx);
-            size = qMin(WRITE_SIZE - 2, m_writeBuffer.size());
-            while (size <= 0) {
+            while (m_writeBuffer.size() <= 0) {
                 // wait on new data to write condition, the timeout
                 // enable the thread to shutdown properly
                 m_newDataToWrite.wait(&m_writeBufMtx, 200);
                 if (!m_running) {
                     return;
                 }
-
-                size = m_writeBuffer.size();
             }
-
-            // NOTE: data size is limited to 2 bytes less than the
-            // usb packet size (64 bytes for interrupt) to make room
-            // for the reportID and valid data length
-            size = qMin(WRITE_SIZE - 2, m_writeBuffer.size());
-            memcpy(&buffer[2], m_writeBuffer.constData(), size);
-            buffer[1] = size; // valid data length
-            buffer[0] = 2; // reportID
         }
 
-        // must hold lock through the send to know how much was sent
+        // NOTE: data size is limited to 2 bytes less than the
+        // usb packet size (64 bytes for interrupt) to make room
+        // for the reportID and valid data length
+        size = m_writeBuffer.peek(&buffer[2], WRITE_SIZE - 2);
+        buffer[1] = size; // valid data length
+        buffer[0] = 2; // reportID
+
         int ret = hiddev->send(hidno, buffer, WRITE_SIZE, WRITE_TIMEOUT);
 
         if (ret > 0) {
             // only remove the size actually written to the device
-            QMutexLocker lock(&m_writeBufMtx);
-            m_writeBuffer.remove(0, size);
+            m_writeBuffer.skip(size);
+            m_bytesWritten.fetchAndAddRelaxed(size);
+            m_reportsWritten.fetchAndAddRelaxed(1);
 
             emit m_hid->bytesWritten(ret - 2);
         } else if (ret < 0) { // < 0 => error
@@ -273,9 +405,9 @@ void RawHIDWriteThread::run()
 
 int RawHIDWriteThread::pushDataToWrite(const char *data, int size)
 {
-    QMutexLocker lock(&m_writeBufMtx);
+    size = m_writeBuffer.push(data, size);
 
-    m_writeBuffer.append(data, size);
+    QMutexLocker lock(&m_writeBufMtx);
     m_newDataToWrite.wakeOne(); // signal that new data arrived
 
     return size;
@@ -283,10 +415,15 @@ int RawHIDWriteThread::pushDataToWrite(const char *data, int size)
 
 qint64 RawHIDWriteThread::getBytesToWrite()
 {
-    // QMutexLocker lock(&m_writeBufMtx);
     return m_writeBuffer.size();
 }
 
+void RawHIDWriteThread::getStats(RawHID::Stats &stats)
+{
+    stats.bytesWritten   = m_bytesWritten.load();
+    stats.reportsWritten = m_reportsWritten.load();
+}
+
 // *********************************************************************************
 
 RawHID::RawHID(const QString &deviceName)
@@ -422,6 +559,11 @@ void RawHID::close()
 
     emit aboutToClose();
 
+    Stats stats = getStats();
+    OPHID_DEBUG("read %u bytes in %u reports (%u overruns), wrote %u bytes in %u reports",
+                stats.bytesRead, stats.reportsRead, stats.readOverruns, stats.bytesWritten, stats.reportsWritten);
+    OPHID_DEBUG("read latency %u us average, %u us max", stats.averageReadLatency, stats.maxReadLatency);
+
     if (m_writeThread) {
         OPHID_DEBUG("Terminating write thread");
         m_writeThread->terminate();
@@ -451,6 +593,21 @@ bool RawHID::isSequential() const
     return true;
 }
 
+RawHID::Stats RawHID::getStats() const
+{
+    QMutexLocker locker(m_mutex);
+    Stats stats;
+
+    memset(&stats, 0, sizeof(stats));
+    if (m_readThread) {
+        m_readThread->getStats(stats);
+    }
+    if (m_writeThread) {
+        m_writeThread->getStats(stats);
+    }
+    return stats;
+}
+
 qint64 RawHID::bytesAvailable() const
 {
     QMutexLocker locker(m_mutex);
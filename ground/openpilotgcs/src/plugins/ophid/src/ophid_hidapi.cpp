@@ -30,6 +30,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <string>
 #include "ophid_const.h"
 #include "ophid_hidapi.h"
 
@@ -124,10 +125,12 @@ int opHID_hidapi::enumerate(struct hid_device_info * *current_device_pptr, int *
  *
  * \param[in] vid USB vendor id of the device to open (-1 for any).
  * \param[in] pid USB product id of the device to open (-1 for any).
+ * \param[in] serial USB serial number of the device to open (empty for any),
+ *            only used along with vid and pid.
  * \return Number of opened device.
  * \retval 0 or 1.
  */
-int opHID_hidapi::open(int max, int vid, int pid, int usage_page, int usage)
+int opHID_hidapi::open(int max, int vid, int pid, int usage_page, int usage, const QString &serial)
 {
     int devices_found = false;
     struct hid_device_info *current_device_ptr    = NULL;
@@ -152,7 +155,8 @@ int opHID_hidapi::open(int max, int vid, int pid, int usage_page, int usage)
 
     // If caller knows which one to look for open it right away
     if (vid != 0 && pid != 0) {
-        handle = hid_open(vid, pid, NULL);
+        std::wstring serial_number = serial.toStdWString();
+        handle = hid_open(vid, pid, serial.isEmpty() ? NULL : serial_number.c_str());
 
         if (!handle) {
             OPHID_ERROR("Unable to open device.");
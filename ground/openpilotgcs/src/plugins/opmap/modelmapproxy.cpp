@@ -29,6 +29,8 @@
 
 modelMapProxy::modelMapProxy(QObject *parent, OPMapWidget *map, flightDataModel *model, QItemSelectionModel *selectionModel) : QObject(parent), myMap(map), model(model), selection(selectionModel)
 {
+    compiler = new PathCompiler(model, this);
+    connect(compiler, SIGNAL(segmentsUpdated(int, int)), this, SLOT(segmentsUpdated(int, int)));
     connect(model, SIGNAL(rowsInserted(const QModelIndex &, int, int)), this, SLOT(rowsInserted(const QModelIndex &, int, int)));
     connect(model, SIGNAL(rowsRemoved(const QModelIndex &, int, int)), this, SLOT(rowsRemoved(const QModelIndex &, int, int)));
     connect(selection, SIGNAL(currentRowChanged(QModelIndex, QModelIndex)), this, SLOT(currentRowChanged(QModelIndex, QModelIndex)));
@@ -60,6 +62,43 @@ void modelMapProxy::WPValuesChanged(WayPointItem *wp)
     model->setData(index, wp->getRelativeCoord().altitudeRelative, Qt::EditRole);
 }
 
+// show the leg and turn of the waypoints in their tooltips, and the plan in that of the first one
+void modelMapProxy::segmentsUpdated(int first, int last)
+{
+    // one pass over the scene, findWayPointNumber() walks it for each waypoint
+    QHash<int, WayPointItem *> items;
+    foreach(QGraphicsItem * i, myMap->scene()->items()) {
+        WayPointItem *w = qgraphicsitem_cast<WayPointItem *>(i);
+
+        if (w && w->Number() >= first && w->Number() <= last) {
+            items.insert(w->Number(), w);
+        }
+    }
+
+    for (int x = first; x <= last; ++x) {
+        WayPointItem *wp = items.value(x);
+        if (!wp || x >= compiler->segmentCount()) {
+            continue;
+        }
+        const PathCompiler::Segment &segment = compiler->segment(x);
+        QString info = tr("Leg: %1 m, %2 s, %3 Wh").arg(segment.length, 0, 'f', 0).arg(segment.time, 0, 'f', 0).arg(segment.energy, 0, 'f', 1);
+        if (segment.turnRadius > 0) {
+            info += tr("\nTurn: %1 deg, radius %2 m").arg(segment.turnAngle, 0, 'f', 0).arg(segment.turnRadius, 0, 'f', 0);
+        }
+        if (!segment.feasible) {
+            info += tr("\nNot flyable at this velocity");
+        }
+        if (x == 0) {
+            info = tr("Plan: %1 m, %2 s, %3 Wh").arg(compiler->totalLength(), 0, 'f', 0).arg(compiler->totalTime(), 0, 'f', 0).arg(compiler->totalEnergy(), 0, 'f', 1);
+        }
+        wp->setCustomString(info);
+        wp->RefreshToolTip();
+    }
+    if (first > 0 && compiler->segmentCount() > 0) {
+        segmentsUpdated(0, 0);
+    }
+}
+
 void modelMapProxy::currentRowChanged(QModelIndex current, QModelIndex previous)
 {
     Q_UNUSED(previous);
@@ -33,6 +33,7 @@
 #include "QMutexLocker"
 #include "QPointer"
 #include "flightdatamodel.h"
+#include "pathcompiler.h"
 #include <QItemSelectionModel>
 #include <widgetdelegates.h>
 
@@ -54,6 +55,7 @@ private slots:
     void WPValuesChanged(WayPointItem *wp);
     void currentRowChanged(QModelIndex, QModelIndex);
     void selectedWPChanged(QList<WayPointItem *>);
+    void segmentsUpdated(int first, int last);
 private:
     overlayType overlayTranslate(int type);
     void createOverlay(WayPointItem *from, WayPointItem *to, overlayType type, QColor color, bool dashed = false, int width = -1);
@@ -62,6 +64,7 @@ private:
     flightDataModel *model;
     void refreshOverlays();
     QItemSelectionModel *selection;
+    PathCompiler *compiler;
 };
 
 #endif // MODELMAPPROXY_H
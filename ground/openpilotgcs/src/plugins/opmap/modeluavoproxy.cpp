@@ -29,9 +29,17 @@
 #include "uavobjecthelper.h"
 
 #include <QProgressDialog>
+#include <QTimer>
 #include <math.h>
 
-ModelUavoProxy::ModelUavoProxy(QObject *parent, flightDataModel *model) : QObject(parent), myModel(model)
+// instances sent ahead of their acknowledgements, well within the telemetry queue
+#define SEND_WINDOW     8
+// time without any acknowledgement after which the upload is given up,
+// the telemetry retries and times out the transactions by itself before that
+#define SEND_TIMEOUT_MS 5000
+
+ModelUavoProxy::ModelUavoProxy(QObject *parent, flightDataModel *model) : QObject(parent), myModel(model),
+    sendPending(0), sendCompleted(0), sendFailed(false)
 {
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
 
@@ -62,29 +70,16 @@ void ModelUavoProxy::sendPathPlan()
     progress.setValue(1);
 
     if (success) {
-        // send Waypoint instances
-        qDebug() << "sending" << waypointCount << "waypoints";
+        // send Waypoint and PathAction instances
+        qDebug() << "sending" << waypointCount << "waypoints and" << actionCount << "path actions";
+        QList<UAVObject *> instances;
         for (int i = 0; i < waypointCount; ++i) {
-            Waypoint *waypoint = Waypoint::GetInstance(objMngr, i);
-            success = (updateHelper.doObjectAndWait(waypoint) == UAVObjectUpdaterHelper::SUCCESS);
-            if (!success) {
-                break;
-            }
-            progress.setValue(progress.value() + 1);
+            instances << Waypoint::GetInstance(objMngr, i);
         }
-    }
-
-    if (success) {
-        // send PathAction instances
-        qDebug() << "sending" << actionCount << "path actions";
         for (int i = 0; i < actionCount; ++i) {
-            PathAction *action = PathAction::GetInstance(objMngr, i);
-            success = (updateHelper.doObjectAndWait(action) == UAVObjectUpdaterHelper::SUCCESS);
-            if (!success) {
-                break;
-            }
-            progress.setValue(progress.value() + 1);
+            instances << PathAction::GetInstance(objMngr, i);
         }
+        success = sendInstances(instances, progress);
     }
 
     qDebug() << "ModelUavoProxy::pathPlanSent - completed" << success;
@@ -95,6 +90,62 @@ void ModelUavoProxy::sendPathPlan()
     progress.close();
 }
 
+// send instances with up to SEND_WINDOW of them waiting for their acknowledgements,
+// rather than one round trip per instance
+bool ModelUavoProxy::sendInstances(const QList<UAVObject *> &instances, QProgressDialog &progress)
+{
+    QTimer timeoutTimer;
+
+    timeoutTimer.setSingleShot(true);
+    connect(&timeoutTimer, SIGNAL(timeout()), &sendLoop, SLOT(quit()));
+    foreach(UAVObject * instance, instances) {
+        connect(instance, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(instanceSent(UAVObject *, bool)));
+    }
+
+    sendPending   = 0;
+    sendCompleted = 0;
+    sendFailed    = false;
+
+    int next = 0;
+    while (!sendFailed && (next < instances.size() || sendPending > 0)) {
+        while (next < instances.size() && sendPending < SEND_WINDOW) {
+            ++sendPending;
+            instances.at(next++)->updated();
+        }
+        // the acknowledgements that came while sending are not waited for
+        if (sendCompleted == 0) {
+            timeoutTimer.start(SEND_TIMEOUT_MS);
+            sendLoop.exec();
+            if (sendCompleted == 0) {
+                qDebug() << "ModelUavoProxy::sendInstances - timed out";
+                sendFailed = true;
+            }
+        }
+        progress.setValue(progress.value() + sendCompleted);
+        sendCompleted = 0;
+    }
+    timeoutTimer.stop();
+
+    foreach(UAVObject * instance, instances) {
+        disconnect(instance, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(instanceSent(UAVObject *, bool)));
+    }
+    disconnect(&timeoutTimer, SIGNAL(timeout()), &sendLoop, SLOT(quit()));
+
+    return !sendFailed;
+}
+
+void ModelUavoProxy::instanceSent(UAVObject *object, bool success)
+{
+    Q_UNUSED(object)
+
+    --sendPending;
+    ++sendCompleted;
+    if (!success) {
+        sendFailed = true;
+    }
+    sendLoop.quit();
+}
+
 void ModelUavoProxy::receivePathPlan()
 {
     QProgressDialog progress(tr("Receiving the path plan from the board... "), "", 0, 0);
@@ -34,6 +34,9 @@
 #include "waypoint.h"
 
 #include <QObject>
+#include <QEventLoop>
+
+class QProgressDialog;
 
 class ModelUavoProxy : public QObject {
     Q_OBJECT
@@ -45,10 +48,21 @@ public slots:
     void sendPathPlan();
     void receivePathPlan();
 
+private slots:
+    void instanceSent(UAVObject *object, bool success);
+
 private:
     UAVObjectManager *objMngr;
     flightDataModel *myModel;
 
+    // state of sendInstances()
+    QEventLoop sendLoop;
+    int sendPending;
+    int sendCompleted;
+    bool sendFailed;
+
+    bool sendInstances(const QList<UAVObject *> &instances, QProgressDialog &progress);
+
     bool modelToObjects();
     bool objectsToModel();
 
@@ -27,6 +27,7 @@ HEADERS += opmapplugin.h \
     widgetdelegates.h \
     pathplanner.h \
     modeluavoproxy.h \
+    pathcompiler.h \
     homeeditor.h
 
 SOURCES += opmapplugin.cpp \
@@ -43,6 +44,7 @@ SOURCES += opmapplugin.cpp \
     widgetdelegates.cpp \
     pathplanner.cpp \
     modeluavoproxy.cpp \
+    pathcompiler.cpp \
     homeeditor.cpp
 
 OTHER_FILES += OPMapGadget.pluginspec
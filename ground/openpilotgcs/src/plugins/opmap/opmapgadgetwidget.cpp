@@ -33,6 +33,8 @@
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QInputDialog>
+#include <QFileDialog>
+#include <QMessageBox>
 #include <QClipboard>
 #include <QMenu>
 #include <QStringList>
@@ -100,6 +102,8 @@ OPMapGadgetWidget::OPMapGadgetWidget(QWidget *parent) : QWidget(parent)
     obm  = NULL;
     obum = NULL;
 
+    m_home_frame.LLA[0] = NAN; // no home frame yet
+
     m_prev_tile_number = 0;
 
     m_min_zoom = m_max_zoom = 0;
@@ -374,6 +378,7 @@ void OPMapGadgetWidget::contextMenuEvent(QContextMenuEvent *event)
     contextMenu.addAction(reloadAct);
     contextMenu.addSeparator();
     contextMenu.addAction(ripAct);
+    contextMenu.addAction(exportTilePackAct);
     contextMenu.addSeparator();
 
     QMenu maxUpdateRateSubMenu(tr("&Max Update Rate ") + "(" + QString::number(m_maxUpdateRate) + " ms)", this);
@@ -1318,6 +1323,10 @@ void OPMapGadgetWidget::createActions()
     ripAct->setStatusTip(tr("Rip the map tiles"));
     connect(ripAct, SIGNAL(triggered()), this, SLOT(onRipAct_triggered()));
 
+    exportTilePackAct = new QAction(tr("&Export tile pack..."), this);
+    exportTilePackAct->setStatusTip(tr("Write the cached map tiles into a tile pack for use without network"));
+    connect(exportTilePackAct, SIGNAL(triggered()), this, SLOT(onExportTilePackAct_triggered()));
+
     copyMouseLatLonToClipAct = new QAction(tr("Mouse latitude and longitude"), this);
     copyMouseLatLonToClipAct->setStatusTip(tr("Copy the mouse latitude and longitude to the clipboard"));
     connect(copyMouseLatLonToClipAct, SIGNAL(triggered()), this, SLOT(onCopyMouseLatLonToClipAct_triggered()));
@@ -1605,6 +1614,29 @@ void OPMapGadgetWidget::onRipAct_triggered()
     m_map->RipMap();
 }
 
+void OPMapGadgetWidget::onExportTilePackAct_triggered()
+{
+    if (!m_widget || !m_map) {
+        return;
+    }
+
+    QString cacheLocation = m_map->configuration->CacheLocation();
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Export tile pack"), cacheLocation + "tiles.tilepack", tr("Tile packs (*.tilepack)"));
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    bool ok = m_map->configuration->ExportMapDataToPack(cacheLocation + "Data.qmdb", fileName);
+    QApplication::restoreOverrideCursor();
+    if (!ok) {
+        QMessageBox::warning(this, tr("Export tile pack"), tr("Could not write the tile pack %1").arg(fileName));
+        return;
+    }
+    // packs are read from the cache location, pick up the new one
+    m_map->configuration->SetCacheLocation(cacheLocation);
+}
+
 void OPMapGadgetWidget::onCopyMouseLatLonToClipAct_triggered()
 {
     QClipboard *clipboard = QApplication::clipboard();
@@ -2202,11 +2234,16 @@ bool OPMapGadgetWidget::getUAVPosition(double &latitude, double &longitude, doub
     homeLLA[1] = homeLocationData.Longitude / 1.0e7;
     homeLLA[2] = homeLocationData.Altitude;
 
+    // the home frame only changes with the home location
+    if (homeLLA[0] != m_home_frame.LLA[0] || homeLLA[1] != m_home_frame.LLA[1] || homeLLA[2] != m_home_frame.LLA[2]) {
+        Utils::CoordinateConversions().BaseFrameFromLLA(homeLLA, m_home_frame);
+    }
+
     NED[0]     = positionStateData.North;
     NED[1]     = positionStateData.East;
     NED[2]     = positionStateData.Down;
 
-    Utils::CoordinateConversions().NED2LLA_HomeLLA(homeLLA, NED, LLA);
+    Utils::CoordinateConversions().NED2LLA_BaseFrame(m_home_frame, NED, LLA);
 
     latitude  = LLA[0];
     longitude = LLA[1];
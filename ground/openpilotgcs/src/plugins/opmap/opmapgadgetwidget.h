@@ -167,6 +167,7 @@ private slots:
      */
     void onReloadAct_triggered();
     void onRipAct_triggered();
+    void onExportTilePackAct_triggered();
     void onCopyMouseLatLonToClipAct_triggered();
     void onCopyMouseLatToClipAct_triggered();
     void onCopyMouseLonToClipAct_triggered();
@@ -221,6 +222,7 @@ private:
     opMapModeType m_map_mode;
     int m_maxUpdateRate;
     t_home m_home_position;
+    Utils::BaseFrame m_home_frame;
     QStringList findPlaceWordList;
     QCompleter *findPlaceCompleter;
     QTimer *m_updateTimer;
@@ -238,6 +240,7 @@ private:
     bool m_telemetry_connected;
     QAction *reloadAct;
     QAction *ripAct;
+    QAction *exportTilePackAct;
     QAction *copyMouseLatLonToClipAct;
     QAction *copyMouseLatToClipAct;
     QAction *copyMouseLonToClipAct;
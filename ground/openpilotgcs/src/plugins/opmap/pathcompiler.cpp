@@ -1,7 +1,7 @@
 /**
  ******************************************************************************
  *
- * @file       pathcompiler.h
+ * @file       pathcompiler.cpp
  * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2012.
  * @addtogroup GCSPlugins GCS Plugins
  * @{
@@ -24,381 +24,320 @@
  * with this program; if not, write to the Free Software Foundation, Inc.,
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
-#include <pathcompiler.h>
-#include <extensionsystem/pluginmanager.h>
-#include <utils/coordinateconversions.h>
-#include <uavobjectmanager.h>
-#include <waypoint.h>
-#include <homelocation.h>
-
-#include <QDebug>
-
-PathCompiler::PathCompiler(QObject *parent) :
-    QObject(parent)
+#include "pathcompiler.h"
+#include "flightdatamodel.h"
+#include "extensionsystem/pluginmanager.h"
+#include "uavobjectmanager.h"
+#include "vtolpathfollowersettings.h"
+
+#include <math.h>
+#include <string.h>
+
+// edits within that time are compiled together, a drag edits the model on every mouse move
+#define COALESCE_MS      50
+// waypoints compiled per job, so that results of a large plan show up as they come
+#define JOB_SIZE         500
+// below which a leg is not flown, the PathFollower would crawl
+#define MIN_VELOCITY     0.1
+#define EARTH_RADIUS     6378137.0
+#define GRAVITY          9.81
+
+PathCompiler::PathCompiler(flightDataModel *model, QObject *parent) : QObject(parent), model(model),
+    jobRunning(false), jobOutdated(false), jobFirst(0), jobLast(-1)
 {
-    HomeLocation *homeLocation = NULL;
-
-    /* To catch new waypoint UAVOs */
-    connect(getObjectManager(), SIGNAL(newInstance(UAVObject *)), this, SLOT(doNewInstance(UAVObject *)));
-
-    /* Connect the object updates */
-    int numWaypoints = getObjectManager()->getNumInstances(Waypoint::OBJID);
-    for (int i = 0; i < numWaypoints; i++) {
-        Waypoint *waypoint = Waypoint::GetInstance(getObjectManager(), i);
-        Q_ASSERT(waypoint);
-        if (waypoint) {
-            connect(waypoint, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(doUpdateFromUAV(UAVObject *)));
-        }
+    qRegisterMetaType<PathCompiler::Point>("PathCompiler::Point");
+    qRegisterMetaType<PathCompiler::Segment>("PathCompiler::Segment");
+    qRegisterMetaType<PathCompiler::Vehicle>("PathCompiler::Vehicle");
+    qRegisterMetaType<QVector<PathCompiler::Point> >("QVector<PathCompiler::Point>");
+    qRegisterMetaType<QVector<PathCompiler::Segment> >("QVector<PathCompiler::Segment>");
+
+    memset(&total, 0, sizeof(total));
+
+    // a multirotor of the usual size, banking as far as the PathFollower lets it
+    myVehicle.maxBankAngle = 25.0;
+    myVehicle.mass  = 1.5;
+    myVehicle.power = 200.0;
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objMngr = pm ? pm->getObject<UAVObjectManager>() : NULL;
+    VtolPathFollowerSettings *settings = objMngr ? VtolPathFollowerSettings::GetInstance(objMngr) : NULL;
+    if (settings) {
+        myVehicle.maxBankAngle = settings->getMaxRollPitch();
     }
 
-    homeLocation = HomeLocation::GetInstance(getObjectManager());
-    Q_ASSERT(homeLocation);
-    if (homeLocation) {
-        connect(homeLocation, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(doUpdateFromUAV(UAVObject *)));
-    }
+    PathCompilerWorker *worker = new PathCompilerWorker;
+    worker->moveToThread(&workerThread);
+    connect(&workerThread, SIGNAL(finished()), worker, SLOT(deleteLater()));
+    connect(this, SIGNAL(compile(int, int, int, QVector<PathCompiler::Point>, PathCompiler::Vehicle)),
+            worker, SLOT(compile(int, int, int, QVector<PathCompiler::Point>, PathCompiler::Vehicle)));
+    connect(worker, SIGNAL(compiled(int, QVector<PathCompiler::Segment>)),
+            this, SLOT(compiled(int, QVector<PathCompiler::Segment>)));
+    workerThread.start(QThread::LowPriority);
+
+    coalesceTimer.setSingleShot(true);
+    coalesceTimer.setInterval(COALESCE_MS);
+    connect(&coalesceTimer, SIGNAL(timeout()), this, SLOT(startJob()));
+
+    connect(model, SIGNAL(dataChanged(QModelIndex, QModelIndex)), this, SLOT(dataChanged(QModelIndex, QModelIndex)));
+    connect(model, SIGNAL(rowsInserted(const QModelIndex &, int, int)), this, SLOT(rowsInserted(const QModelIndex &, int, int)));
+    connect(model, SIGNAL(rowsRemoved(const QModelIndex &, int, int)), this, SLOT(rowsRemoved(const QModelIndex &, int, int)));
+    connect(model, SIGNAL(modelReset()), this, SLOT(modelReset()));
+
+    modelReset();
 }
 
-/**
- * Helper method to get the uavobjectamanger
- */
-UAVObjectManager *PathCompiler::getObjectManager()
+PathCompiler::~PathCompiler()
 {
-    ExtensionSystem::PluginManager *pm = NULL;
-    UAVObjectManager *objMngr = NULL;
-
-    pm = ExtensionSystem::PluginManager::instance();
-    Q_ASSERT(pm);
-    if (pm) {
-        objMngr = pm->getObject<UAVObjectManager>();
-    }
-    Q_ASSERT(objMngr);
-
-    return objMngr;
+    workerThread.quit();
+    workerThread.wait();
 }
 
-/**
- * This method opens a dialog (if filename is null) and saves the path
- * @param filename The file to save the path to
- * @returns -1 for failure, 0 for success
- */
-int PathCompiler::savePath(QString filename)
+void PathCompiler::setVehicle(const Vehicle &vehicle)
 {
-    Q_UNUSED(filename);
-    return -1;
+    myVehicle = vehicle;
+    markStale(0, segments.size() - 1);
 }
 
-/**
- * This method opens a dialog (if filename is null) and loads the path
- * @param filename The file to load from
- * @returns -1 for failure, 0 for success
- */
-int PathCompiler::loadPath(QString filename)
-{
-    Q_UNUSED(filename);
-    return -1;
-}
-
-/**
- * Called whenever a new object instance is created so we can check
- * if it's a waypoint and if so connect to it
- * @param [in] obj The point to the object being created
- */
-void PathCompiler::doNewInstance(UAVObject *obj)
+void PathCompiler::dataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
 {
-    Q_ASSERT(obj);
-    if (!obj) {
+    if (topLeft.column() > flightDataModel::VELOCITY || bottomRight.column() < flightDataModel::LATPOSITION) {
+        // the description, or the actions
         return;
     }
-
-    if (obj->getObjID() == Waypoint::OBJID) {
-        connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(doUpdateFromUAV(UAVObject *)));
-    }
+    // the leg to a waypoint, its turn and those of the waypoints either side
+    markStale(topLeft.row() - 1, bottomRight.row() + 1);
 }
 
-/**
- * add a waypoint
- * @param waypoint the new waypoint to add
- * @param position which position to insert it to, defaults to end
- */
-void PathCompiler::doAddWaypoint(waypoint newWaypointInternal, int /*position*/)
+void PathCompiler::rowsInserted(const QModelIndex &parent, int first, int last)
 {
-    /* TODO: If a waypoint is inserted not at the end shift them all by one and */
-    /* add the data there */
-
-    UAVObjectManager *objManager     = getObjectManager();
-
-    // Format the data from the map into a UAVO
-    Waypoint::DataFields newWaypoint = InternalToUavo(newWaypointInternal);
+    Q_UNUSED(parent);
 
-    // Search for any waypoints set to stop, because if they exist we
-    // should add the waypoint immediately after that one
-    int numWaypoints = objManager->getNumInstances(Waypoint::OBJID);
-    int i;
+    int count = last - first + 1;
 
-    for (i = 0; i < numWaypoints; i++) {
-        Waypoint *waypoint = Waypoint::GetInstance(objManager, i);
-        Q_ASSERT(waypoint);
-        if (waypoint == NULL) {
-            return;
-        }
-
-        Waypoint::DataFields waypointData = waypoint->getData();
-        if (waypointData.Action == Waypoint::ACTION_STOP) {
-            waypointData.Action = Waypoint::ACTION_PATHTONEXT;
-            waypoint->setData(waypointData);
-            waypoint->updated();
-            break;
-        }
+    segments.insert(first, count, Segment());
+    stale.resize(segments.size());
+    // QBitArray has no insertion, shift the flags after the new rows
+    for (int row = segments.size() - 1; row > last; --row) {
+        stale.setBit(row, stale.testBit(row - count));
+    }
+    for (int row = first; row <= last; ++row) {
+        stale.clearBit(row);
     }
 
-    if (i >= numWaypoints - 1) {
-        // We reached end of list so new waypoint needs to be registered
-
-        Waypoint *waypoint = new Waypoint();
-        Q_ASSERT(waypoint);
-        if (waypoint) {
-            // Register a new waypoint instance
-            quint32 newInstId = objManager->getNumInstances(waypoint->getObjID());
-            waypoint->initialize(newInstId, waypoint->getMetaObject());
-            objManager->registerObject(waypoint);
-
-            // Set the data in the new object
-            waypoint->setData(newWaypoint);
-            waypoint->updated();
+    if (jobRunning) {
+        if (first <= jobFirst) {
+            jobFirst += count;
         }
-    } else {
-        Waypoint *waypoint = Waypoint::GetInstance(objManager, i + 1);
-        Q_ASSERT(waypoint);
-        if (waypoint) {
-            waypoint->setData(newWaypoint);
-            waypoint->updated();
+        if (first <= jobLast) {
+            jobLast += count;
         }
+        jobOutdated = true;
     }
+
+    markStale(first - 1, last + 1);
 }
 
-/**
- * Update waypoint
- */
-void PathCompiler::doUpdateWaypoints(PathCompiler::waypoint changedWaypoint, int position)
+void PathCompiler::rowsRemoved(const QModelIndex &parent, int first, int last)
 {
-    int numWaypoints = getObjectManager()->getNumInstances(Waypoint::OBJID);
+    Q_UNUSED(parent);
 
-    Q_ASSERT(position < numWaypoints);
-    if (position >= numWaypoints) {
-        return;
-    }
+    int count = last - first + 1;
 
-    Waypoint *waypointInst = Waypoint::GetInstance(getObjectManager(), position);
-    Q_ASSERT(waypointInst);
+    for (int row = first; row <= last; ++row) {
+        addToTotal(segments.at(row), -1.0);
+    }
+    segments.remove(first, count);
+    for (int row = first; row < segments.size(); ++row) {
+        stale.setBit(row, stale.testBit(row + count));
+    }
+    stale.resize(segments.size());
 
-    // Mirror over the updated position.  We don't just use the changedWaypoint
-    // because things like action might need to be preserved
-    Waypoint::DataFields changedWaypointUAVO = InternalToUavo(changedWaypoint);
-    Waypoint::DataFields oldWaypointUAVO     = waypointInst->getData();
-    oldWaypointUAVO.Position[0] = changedWaypointUAVO.Position[0];
-    oldWaypointUAVO.Position[1] = changedWaypointUAVO.Position[1];
-    // Don't take the altitude from the map for now
+    if (jobRunning) {
+        jobFirst    = (jobFirst > last) ? jobFirst - count : qMin(jobFirst, first);
+        jobLast     = (jobLast > last) ? jobLast - count : qMin(jobLast, first - 1);
+        jobOutdated = true;
+    }
 
-    waypointInst->setData(oldWaypointUAVO);
-    waypointInst->updated();
+    // the waypoints either side are neighbours now
+    markStale(first - 1, first);
 }
 
-/**
- * Delete a waypoint
- * @param index which waypoint to delete
- */
-void PathCompiler::doDelWaypoint(int index)
+void PathCompiler::modelReset()
 {
-    // This method is awkward because there is no support
-    // on the FC for actually deleting a waypoint.  We need
-    // to shift them all by one and set the new "last" waypoint
-    // to a stop action
+    segments.fill(Segment(), model->rowCount());
+    stale.fill(false, segments.size());
+    memset(&total, 0, sizeof(total));
+    jobOutdated = jobRunning;
+    jobLast     = jobFirst - 1;
 
-    UAVObjectManager *objManager = getObjectManager();
-    Waypoint *waypoint = Waypoint::GetInstance(objManager);
+    markStale(0, segments.size() - 1);
+}
 
-    Q_ASSERT(waypoint);
-    if (!waypoint) {
+void PathCompiler::markStale(int first, int last)
+{
+    first = qMax(first, 0);
+    last  = qMin(last, segments.size() - 1);
+    if (first > last) {
         return;
     }
-
-    int numWaypoints = objManager->getNumInstances(waypoint->getObjID());
-    for (int i = index; i < numWaypoints - 1; i++) {
-        Waypoint *waypointDest = Waypoint::GetInstance(objManager, i);
-        Q_ASSERT(waypointDest);
-
-        Waypoint *waypointSrc  = Waypoint::GetInstance(objManager, i + 1);
-        Q_ASSERT(waypointSrc);
-
-        if (!waypointDest || !waypointSrc) {
-            return;
-        }
-
-        // Copy the data down an index
-        Waypoint::DataFields waypoint = waypointSrc->getData();
-        waypointDest->setData(waypoint);
-        waypointDest->updated();
-    }
-
-    // Set the second to last waypoint to stop (and last for safety)
-    // the functional equivalent to deleting
-    for (int i = numWaypoints - 2; i < numWaypoints; i++) {
-        waypoint = Waypoint::GetInstance(objManager, i);
-        Q_ASSERT(waypoint);
-        if (waypoint) {
-            Waypoint::DataFields waypointData = waypoint->getData();
-            waypointData.Action = Waypoint::ACTION_STOP;
-            waypoint->setData(waypointData);
-            waypoint->updated();
-        }
+    stale.fill(true, first, last + 1);
+    if (!coalesceTimer.isActive()) {
+        coalesceTimer.start();
     }
 }
 
-/**
- * Delete all the waypoints
- */
-void PathCompiler::doDelAllWaypoints()
+void PathCompiler::addToTotal(const Segment &segment, double sign)
 {
-    Waypoint *waypointObj = Waypoint::GetInstance(getObjectManager(), 0);
-
-    Q_ASSERT(waypointObj);
-    if (waypointObj == NULL) {
-        return;
-    }
+    total.length += sign * segment.length;
+    total.time   += sign * segment.time;
+    total.energy += sign * segment.energy;
+}
 
-    int numWaypoints = getObjectManager()->getNumInstances(waypointObj->getObjID());
-    for (int i = 0; i < numWaypoints; i++) {
-        Waypoint *waypoint = Waypoint::GetInstance(getObjectManager(), i);
-        Q_ASSERT(waypoint);
-        if (waypoint) {
-            Waypoint::DataFields waypointData = waypoint->getData();
-            waypointData.Action = Waypoint::ACTION_STOP;
-            waypoint->setData(waypointData);
-        }
-    }
+PathCompiler::Point PathCompiler::point(int row) const
+{
+    Point point;
 
-    waypointObj->updated();
+    point.latitude  = model->data(model->index(row, flightDataModel::LATPOSITION)).toDouble();
+    point.longitude = model->data(model->index(row, flightDataModel::LNGPOSITION)).toDouble();
+    point.altitude  = model->data(model->index(row, flightDataModel::ALTITUDE)).toDouble();
+    point.velocity  = model->data(model->index(row, flightDataModel::VELOCITY)).toDouble();
+    return point;
 }
 
 /**
- * When the UAV waypoints change trigger the pathcompiler to
- * get the latest version and then update the visualization
+ * Send the first run of stale waypoints to the worker, up to JOB_SIZE of them
  */
-void PathCompiler::doUpdateFromUAV(UAVObject *obj)
+void PathCompiler::startJob()
 {
-    UAVObjectManager *objManager = getObjectManager();
-
-    if (!objManager) {
+    if (jobRunning) {
+        // compiled() starts the next one
         return;
     }
 
-    Waypoint *waypointObj = Waypoint::GetInstance(getObjectManager());
-    Q_ASSERT(waypointObj);
-    if (waypointObj == NULL) {
+    int first = 0;
+    while (first < stale.size() && !stale.testBit(first)) {
+        ++first;
+    }
+    if (first >= stale.size()) {
         return;
     }
-
-    /* Get all the waypoints from the UAVO and create a representation for the visualization */
-    QList <waypoint> waypoints;
-    waypoints.clear();
-    int numWaypoints = objManager->getNumInstances(waypointObj->getObjID());
-    bool stopped     = false;
-    for (int i = 0; i < numWaypoints && !stopped; i++) {
-        Waypoint *waypoint = Waypoint::GetInstance(objManager, i);
-        Q_ASSERT(waypoint);
-        if (waypoint == NULL) {
-            return;
-        }
-
-        Waypoint::DataFields waypointData = waypoint->getData();
-        waypoints.append(UavoToInternal(waypointData));
-        stopped = waypointData.Action == Waypoint::ACTION_STOP;
+    int last = first;
+    while (last + 1 < stale.size() && stale.testBit(last + 1) && last + 1 - first < JOB_SIZE) {
+        ++last;
     }
 
-    if (previousWaypoints != waypoints) {
-        /* Because the waypoints have to update periodically (or we miss new ones on the FC */
-        /* side - needs telem fix) we want to filter updates to map that are simply periodic */
-        previousWaypoints = waypoints;
-
-        /* Inform visualization */
-        emit visualizationChanged(waypoints);
+    // the points can't change under the worker, it gets a copy
+    int pointsFirst = qMax(first - 1, 0);
+    int pointsLast  = qMin(last + 1, segments.size() - 1);
+    QVector<Point> points;
+    points.reserve(pointsLast - pointsFirst + 1);
+    for (int row = pointsFirst; row <= pointsLast; ++row) {
+        points.append(point(row));
     }
+
+    stale.fill(false, first, last + 1);
+    jobRunning  = true;
+    jobOutdated = false;
+    jobFirst    = first;
+    jobLast     = last;
+    emit compile(first, last, pointsFirst, points, myVehicle);
 }
 
-/**
- * Convert a UAVO waypoint to the local structure
- * @param uavo The UAVO data representation
- * @return The waypoint structure for visualization
- */
-struct PathCompiler::waypoint PathCompiler::UavoToInternal(Waypoint::DataFields uavo)
+void PathCompiler::compiled(int first, QVector<PathCompiler::Segment> results)
 {
-    double homeLLA[3];
-    double LLA[3];
-    double NED[3];
-    waypoint internalWaypoint;
+    Q_UNUSED(first);
 
-    HomeLocation *homeLocation = HomeLocation::GetInstance(getObjectManager());
+    jobRunning = false;
 
-    Q_ASSERT(homeLocation);
-    if (homeLocation == NULL) {
-        return internalWaypoint;
+    if (jobOutdated) {
+        // rows moved under the job, compile whatever is left of them again
+        markStale(jobFirst, jobLast);
+    } else {
+        for (int n = 0; n < results.size(); ++n) {
+            addToTotal(segments.at(jobFirst + n), -1.0);
+            segments[jobFirst + n] = results.at(n);
+            addToTotal(results.at(n), 1.0);
+        }
+        emit segmentsUpdated(jobFirst, jobLast);
     }
-    HomeLocation::DataFields homeLocationData = homeLocation->getData();
-    homeLLA[0] = homeLocationData.Latitude / 10e6;
-    homeLLA[1] = homeLocationData.Longitude / 10e6;
-    homeLLA[2] = homeLocationData.Altitude;
-
-    NED[0]     = uavo.Position[Waypoint::POSITION_NORTH];
-    NED[1]     = uavo.Position[Waypoint::POSITION_EAST];
-    NED[2]     = uavo.Position[Waypoint::POSITION_DOWN];
-    Utils::CoordinateConversions().GetLLA(homeLLA, NED, LLA);
-
-    internalWaypoint.latitude  = LLA[0];
-    internalWaypoint.longitude = LLA[1];
-    internalWaypoint.altitude  = LLA[2];
-    return internalWaypoint;
+
+    startJob();
 }
 
-/**
- * Convert a UAVO waypoint to the local structure
- * @param internal The internal structure type
- * @returns The waypoint UAVO data structure
- */
-Waypoint::DataFields PathCompiler::InternalToUavo(waypoint internal)
+void PathCompilerWorker::compile(int first, int last, int pointsFirst, QVector<PathCompiler::Point> points, PathCompiler::Vehicle vehicle)
 {
-    Waypoint::DataFields uavo;
+    emit compiled(first, compileSegments(first, last, pointsFirst, points, vehicle));
+}
 
-    double homeLLA[3];
-    double LLA[3];
-    double NED[3];
+QVector<PathCompiler::Segment> PathCompilerWorker::compileSegments(int first, int last, int pointsFirst, const QVector<PathCompiler::Point> &points,
+                                                                   const PathCompiler::Vehicle &vehicle)
+{
+    QVector<PathCompiler::Segment> results(last - first + 1);
+    double tanBank = tan(vehicle.maxBankAngle * M_PI / 180.0);
+
+    // horizontal leg from point n - 1 to point n, north and east in m
+    struct Leg {
+        double north;
+        double east;
+        double length;
+    };
+    Leg in;
+    Leg out;
+    Leg *legs[2] = { &in, &out };
+
+    for (int row = first; row <= last; ++row) {
+        PathCompiler::Segment &segment = results[row - first];
+        int n = row - pointsFirst;
+        const PathCompiler::Point &to  = points.at(n);
+
+        memset(&segment, 0, sizeof(segment));
+        segment.feasible = true;
+
+        for (int k = 0; k < 2; ++k) {
+            int from = n - 1 + k;
+            legs[k]->length = -1.0;
+            if (from >= 0 && from + 1 < points.size()) {
+                const PathCompiler::Point &a = points.at(from);
+                const PathCompiler::Point &b = points.at(from + 1);
+                // flat earth over a leg, the legs of a plan are short
+                legs[k]->north  = (b.latitude - a.latitude) * M_PI / 180.0 * EARTH_RADIUS;
+                legs[k]->east   = (b.longitude - a.longitude) * M_PI / 180.0 * EARTH_RADIUS * cos((a.latitude + b.latitude) * M_PI / 360.0);
+                legs[k]->length = sqrt(legs[k]->north * legs[k]->north + legs[k]->east * legs[k]->east);
+            }
+        }
 
-    HomeLocation *homeLocation = HomeLocation::GetInstance(getObjectManager());
+        // the first waypoint is flown to from wherever the vehicle is
+        if (row > 0 && in.length >= 0.0) {
+            const PathCompiler::Point &from = points.at(n - 1);
+            segment.climb  = to.altitude - from.altitude;
+            segment.length = sqrt(in.length * in.length + segment.climb * segment.climb);
+
+            // the PathFollower goes from the velocity of one waypoint to that of the next along the leg,
+            // linearly with the distance, which takes the length over their logarithmic mean
+            double v0 = qMax(from.velocity, MIN_VELOCITY);
+            double v1 = qMax(to.velocity, MIN_VELOCITY);
+            if (from.velocity < MIN_VELOCITY || to.velocity < MIN_VELOCITY) {
+                segment.feasible = false;
+            }
+            if (fabs(v1 - v0) < 1e-3) {
+                segment.time = segment.length / v0;
+            } else {
+                segment.time = segment.length * log(v1 / v0) / (v1 - v0);
+            }
+            segment.energy = (vehicle.power * segment.time + vehicle.mass * GRAVITY * qMax(segment.climb, 0.0)) / 3600.0;
+        }
 
-    Q_ASSERT(homeLocation);
-    if (homeLocation == NULL) {
-        return uavo;
+        // the turn towards the next waypoint, it starts that far before the waypoint
+        // and ends that far after it, half of each leg is left to the turns at their other ends
+        if (row > 0 && in.length > 0.0 && out.length > 0.0) {
+            double cosAngle = (in.north * out.north + in.east * out.east) / (in.length * out.length);
+            segment.turnAngle  = acos(qBound(-1.0, cosAngle, 1.0)) * 180.0 / M_PI;
+            segment.turnRadius = to.velocity * to.velocity / (GRAVITY * tanBank);
+            double lead = segment.turnRadius * tan(segment.turnAngle * M_PI / 360.0);
+            if (lead > qMin(in.length, out.length) / 2.0) {
+                segment.feasible = false;
+            }
+        }
     }
-    HomeLocation::DataFields homeLocationData = homeLocation->getData();
-    homeLLA[0] = homeLocationData.Latitude / 10e6;
-    homeLLA[1] = homeLocationData.Longitude / 10e6;
-    homeLLA[2] = homeLocationData.Altitude;
-
-    // TODO: Give the point a concept of altitude
-    LLA[0]     = internal.latitude;
-    LLA[1]     = internal.longitude;
-    LLA[2]     = internal.altitude;
-
-    Utils::CoordinateConversions().GetNED(homeLLA, LLA, NED);
-
-    uavo.Position[Waypoint::POSITION_NORTH] = NED[0];
-    uavo.Position[Waypoint::POSITION_EAST]  = NED[1];
-    uavo.Position[Waypoint::POSITION_DOWN]  = NED[2];
-
-    uavo.Action = Waypoint::ACTION_PATHTONEXT;
-
-    uavo.Velocity[Waypoint::VELOCITY_NORTH] = 5;
-    uavo.Velocity[Waypoint::VELOCITY_EAST]  = 0;
-    uavo.Velocity[Waypoint::VELOCITY_DOWN]  = 0;
 
-    return uavo;
+    return results;
 }
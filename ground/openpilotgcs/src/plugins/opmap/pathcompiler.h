@@ -28,121 +28,146 @@
 #define PATHCOMPILER_H
 
 #include <QObject>
-#include <uavobject.h>
-#include <uavobjectmanager.h>
-#include <waypoint.h>
+#include <QVector>
+#include <QBitArray>
+#include <QThread>
+#include <QTimer>
+#include <QModelIndex>
 
-// TODO: Make this a singleton class and separate from map library.  Not sure of the proper design pattern in Qt.
-// factory? static variables?
+class flightDataModel;
 
 /**
- * This class is a two way adapter between a visualization of a path and the
- * UAVObject representation on the flight controller.  It also can support multiple
- * ways of converting a path from what the user clicked to the underlying representation
- * to achieve the desired end flight trajectory
+ * Analysis of a flight plan, kept up to date as it is edited.
  *
- * So the chain of data for the map lib is:
- *    FC <-> PathCompiler <-> OPMapGadget <-> OPMapLib
+ * Each waypoint gets the leg the PathPlanner flies to it from the previous
+ * one, and the turn it makes there towards the next one: length, time and
+ * energy of the leg, the smallest turn radius at the waypoint velocity and
+ * whether the turn fits in the legs on either side. The first waypoint is
+ * flown to from wherever the vehicle is, so it has no leg.
  *
- * The goal is that PathCompiler be as state free as is possible.  Eventually for more
- * complicated path compilation this will probably not be achievable.  That means it
- * should not cache a copy of waypoints locally if that can be avoided (i.e. it should
- * refer directly to what is stored on the FC).
- *
- * For the visualization to have the ability to manipulate the path though it needs to
- * be able to map unambiguously from the graphical items to the internal waypoints. It
- * must cache a lookup from the graphical item to the index from this tool.
+ * An edit only makes its waypoint and the two around it stale. The stale
+ * waypoints are compiled in a worker thread, the edits of a few tens of ms
+ * together so that a drag is not compiled on every mouse move, and the
+ * results come back as segmentsUpdated().
  */
 class PathCompiler : public QObject {
     Q_OBJECT
 public:
-    explicit PathCompiler(QObject *parent = 0);
-
-    // ! This method opens a dialog (if filename is null) and saves the path
-    int savePath(QString filename = NULL);
-
-    // ! This method opens a dialog (if filename is null) and loads the path
-    int loadPath(QString filename = NULL);
-
-    // ! Waypoint representation that is exchanged between visualization
-    class waypoint {
-public:
-        waypoint() {}
+    // vehicle the plan is analysed for
+    struct Vehicle {
+        double maxBankAngle; // deg
+        double mass; // kg
+        double power; // W, drawn at cruise
+    };
 
-        const bool operator==(const waypoint other)
-        {
-            return (other.latitude == latitude) && (other.longitude == longitude);
-        }
+    struct Segment {
+        double length; // m, of the leg from the previous waypoint
+        double climb; // m, over the leg
+        double time; // s, at the mean velocity of the waypoints at either end
+        double energy; // Wh, cruise power over the time and the climb
+        double turnAngle; // deg, from this leg to the next
+        double turnRadius; // m, smallest at the waypoint velocity
+        bool   feasible; // the velocities allow the leg, the turn fits
+    };
 
+    // the waypoint data the analysis needs, as sent to the worker
+    struct Point {
         double latitude;
         double longitude;
         double altitude;
+        double velocity;
     };
 
-private:
-    // ! Helper method to get uavobject manager
-    UAVObjectManager *getObjectManager();
+    explicit PathCompiler(flightDataModel *model, QObject *parent = 0);
+    ~PathCompiler();
+
+    void setVehicle(const Vehicle &vehicle);
+    Vehicle vehicle() const
+    {
+        return myVehicle;
+    }
+
+    int segmentCount() const
+    {
+        return segments.size();
+    }
+    const Segment &segment(int row) const
+    {
+        return segments.at(row);
+    }
+
+    // totals of the plan as far as compiled, see isCompiled()
+    double totalLength() const
+    {
+        return total.length;
+    }
+    double totalTime() const
+    {
+        return total.time;
+    }
+    double totalEnergy() const
+    {
+        return total.energy;
+    }
+    bool isCompiled() const
+    {
+        return stale.count(true) == 0 && !jobRunning;
+    }
 
-    // ! Convert a UAVO waypoint to the local structure
-    struct PathCompiler::waypoint UavoToInternal(Waypoint::DataFields);
+signals:
+    // rows first to last have new results
+    void segmentsUpdated(int first, int last);
+    // to the worker, queued
+    void compile(int first, int last, int pointsFirst, QVector<PathCompiler::Point> points, PathCompiler::Vehicle vehicle);
+
+private slots:
+    void dataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void rowsInserted(const QModelIndex &parent, int first, int last);
+    void rowsRemoved(const QModelIndex &parent, int first, int last);
+    void modelReset();
+    void startJob();
+    void compiled(int first, QVector<PathCompiler::Segment> results);
 
-    // ! Convert a UAVO waypoint to the local structure
-    Waypoint::DataFields InternalToUavo(waypoint);
+private:
+    flightDataModel *model;
+    Vehicle myVehicle;
+    QThread workerThread;
+    QTimer coalesceTimer;
+
+    QVector<Segment> segments;
+    QBitArray stale;
+    Segment total;
+
+    // the rows of the job on the worker, moved along with row insertions and removals
+    bool jobRunning;
+    bool jobOutdated;
+    int  jobFirst;
+    int  jobLast;
+
+    void markStale(int first, int last);
+    void addToTotal(const Segment &segment, double sign);
+    Point point(int row) const;
+};
 
-    QList <waypoint> previousWaypoints;
-signals:
-    /**
-     * Indicates something changed the waypoints and the map should
-     * update the display
-     */
-    void visualizationChanged(QList<PathCompiler::waypoint>);
+/**
+ * The compilation itself, on the worker thread
+ */
+class PathCompilerWorker : public QObject {
+    Q_OBJECT
+public:
+    // results of rows first..last, points holds rows pointsFirst.. and at least one row either side if there is one
+    static QVector<PathCompiler::Segment> compileSegments(int first, int last, int pointsFirst, const QVector<PathCompiler::Point> &points,
+                                                          const PathCompiler::Vehicle &vehicle);
 
 public slots:
-    /**
-     * These are slots that the visualization can call to manipulate the path.
-     * It is an important design detail that the visualiation _not_ attempt to maintain
-     * the list of waypoints itself.  This starts the slippery of moving the path logic
-     * into the view.
-     */
-
-    /**
-     * Called when new instances are registered
-     */
-    void doNewInstance(UAVObject *);
-
-    /**
-     * add a waypoint
-     * @param waypoint the new waypoint to add
-     * @param position which position to insert it to, defaults to end
-     */
-    void doAddWaypoint(waypoint, int position = -1);
-
-    /**
-     * Update waypoint
-     */
-    void doUpdateWaypoints(PathCompiler::waypoint, int position);
-
-    /**
-     * Delete a waypoint
-     * @param index which waypoint to delete
-     */
-    void doDelWaypoint(int index);
-
-    /**
-     * Delete all the waypoints
-     */
-    void doDelAllWaypoints();
+    void compile(int first, int last, int pointsFirst, QVector<PathCompiler::Point> points, PathCompiler::Vehicle vehicle);
 
-public slots:
-    /**
-     * These are slots that the UAV can call to update the path.
-     */
-
-    /**
-     * When the UAV waypoints change trigger the pathcompiler to
-     * get the latest version and then update the visualization
-     */
-    void doUpdateFromUAV(UAVObject *);
+signals:
+    void compiled(int first, QVector<PathCompiler::Segment> results);
 };
 
+Q_DECLARE_METATYPE(PathCompiler::Point)
+Q_DECLARE_METATYPE(PathCompiler::Segment)
+Q_DECLARE_METATYPE(PathCompiler::Vehicle)
+
 #endif // PATHCOMPILER_H
@@ -1,7 +1,7 @@
 TEMPLATE = lib
 TARGET = OsgEarthviewGadget
 
-QT += opengl
+QT += opengl concurrent
 include(../../openpilotgcsplugin.pri)
 include(../../plugins/coreplugin/coreplugin.pri)
 include(osgearthview_dependencies.pri)
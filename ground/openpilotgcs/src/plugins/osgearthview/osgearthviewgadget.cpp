@@ -46,4 +46,8 @@ OsgEarthviewGadget::~OsgEarthviewGadget()
 void OsgEarthviewGadget::loadConfiguration(IUAVGadgetConfiguration *config)
 {
     OsgEarthviewGadgetConfiguration *m = qobject_cast<OsgEarthviewGadgetConfiguration *>(config);
+
+    m_widget->setLODScale(m->lodScale());
+    m_widget->setMaximumPagedLOD(m->maximumPagedLOD());
+    m_widget->setEarthFile(m->earthFile());
 }
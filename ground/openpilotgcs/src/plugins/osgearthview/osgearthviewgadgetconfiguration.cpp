@@ -31,11 +31,18 @@
  *
  */
 OsgEarthviewGadgetConfiguration::OsgEarthviewGadgetConfiguration(QString classId, QSettings *qSettings, QObject *parent) :
-    IUAVGadgetConfiguration(classId, parent)
+    IUAVGadgetConfiguration(classId, parent),
+    m_earthFile(Utils::PathUtils().InsertDataPath("%%DATAPATH%%pfd/default/readymap.earth")),
+    m_lodScale(1.0),
+    m_maximumPagedLOD(300)
 {
-    Q_UNUSED(qSettings);
     // if a saved configuration exists load it
-    if (qSettings != 0) {}
+    if (qSettings != 0) {
+        m_earthFile       = qSettings->value("earthFile", m_earthFile).toString();
+        m_earthFile       = Utils::PathUtils().InsertDataPath(m_earthFile);
+        m_lodScale        = qSettings->value("lodScale", m_lodScale).toDouble();
+        m_maximumPagedLOD = qSettings->value("maximumPagedLOD", m_maximumPagedLOD).toInt();
+    }
 }
 
 /**
@@ -46,6 +53,10 @@ IUAVGadgetConfiguration *OsgEarthviewGadgetConfiguration::clone()
 {
     OsgEarthviewGadgetConfiguration *m = new OsgEarthviewGadgetConfiguration(this->classId());
 
+    m->m_earthFile       = m_earthFile;
+    m->m_lodScale        = m_lodScale;
+    m->m_maximumPagedLOD = m_maximumPagedLOD;
+
     return m;
 }
 
@@ -53,4 +64,9 @@ IUAVGadgetConfiguration *OsgEarthviewGadgetConfiguration::clone()
  * Saves a configuration.
  *
  */
-void OsgEarthviewGadgetConfiguration::saveConfig(QSettings *qSettings) const {}
+void OsgEarthviewGadgetConfiguration::saveConfig(QSettings *qSettings) const
+{
+    qSettings->setValue("earthFile", Utils::PathUtils().RemoveDataPath(m_earthFile));
+    qSettings->setValue("lodScale", m_lodScale);
+    qSettings->setValue("maximumPagedLOD", m_maximumPagedLOD);
+}
@@ -39,7 +39,38 @@ public:
     void saveConfig(QSettings *settings) const;
     IUAVGadgetConfiguration *clone();
 
+    void setEarthFile(const QString &fileName)
+    {
+        m_earthFile = fileName;
+    }
+    void setLODScale(double scale)
+    {
+        m_lodScale = scale;
+    }
+    void setMaximumPagedLOD(int count)
+    {
+        m_maximumPagedLOD = count;
+    }
+
+    QString earthFile() const
+    {
+        return m_earthFile;
+    }
+    // terrain detail, above 1.0 tiles switch to a lower resolution closer to the camera
+    double lodScale() const
+    {
+        return m_lodScale;
+    }
+    // number of terrain tiles the pager keeps loaded before expiring the unused ones
+    int maximumPagedLOD() const
+    {
+        return m_maximumPagedLOD;
+    }
+
 private:
+    QString m_earthFile;
+    double m_lodScale;
+    int m_maximumPagedLOD;
 };
 
 #endif // OSGEARTHVIEWGADGETCONFIGURATION_H
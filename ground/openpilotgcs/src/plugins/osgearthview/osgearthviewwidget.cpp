@@ -114,6 +114,21 @@ OsgEarthviewWidget::OsgEarthviewWidget(QWidget *parent) : QWidget(parent)
 OsgEarthviewWidget::~OsgEarthviewWidget()
 {}
 
+void OsgEarthviewWidget::setEarthFile(const QString &fileName)
+{
+    m_widget->widget->setEarthFile(fileName);
+}
+
+void OsgEarthviewWidget::setLODScale(double scale)
+{
+    m_widget->widget->setLODScale(scale);
+}
+
+void OsgEarthviewWidget::setMaximumPagedLOD(int count)
+{
+    m_widget->widget->setMaximumPagedLOD(count);
+}
+
 void OsgEarthviewWidget::paintEvent(QPaintEvent *event)
 {}
 
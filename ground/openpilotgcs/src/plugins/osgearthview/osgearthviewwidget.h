@@ -90,6 +90,10 @@ public:
     OsgEarthviewWidget(QWidget *parent = 0);
     ~OsgEarthviewWidget();
 
+    void setEarthFile(const QString &fileName);
+    void setLODScale(double scale);
+    void setMaximumPagedLOD(int count);
+
 public slots:
 
 protected: /* Protected methods */
@@ -36,6 +36,9 @@
 #include <QDebug>
 
 #include <QtCore/QTimer>
+#include <QtCore/QThread>
+#include <QtCore/QFileInfo>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtWidgets/QApplication>
 #include <QGridLayout>
 
@@ -103,19 +106,89 @@ using namespace osgEarth::Annotation;
 
 using namespace Utils;
 
-OsgViewerWidget::OsgViewerWidget(QWidget *parent) : QWidget(parent)
+OsgViewerWidget::OsgViewerWidget(QWidget *parent) : QWidget(parent),
+    lodScale(1.0),
+    maximumPagedLOD(300),
+    view(0),
+    manip(0),
+    uavPos(0),
+    uavAttitudeAndScale(0),
+    mapNode(0)
 {
     setThreadingModel(osgViewer::ViewerBase::CullThreadPerCameraDrawThreadPerContext);
     setAttribute(Qt::WA_PaintOnScreen, true);
+    setLayout(new QVBoxLayout(this));
 
-    osg::Group *root = new osg::Group;
-    osg::Node *earth = osgDB::readNodeFile("/Users/Cotton/Programming/osg/osgearth/tests/boston.earth");
-    mapNode = osgEarth::MapNode::findMapNode(earth);
+    // the scene is built once the earth file set by the configuration is loaded
+    connect(&sceneWatcher, SIGNAL(finished()), this, SLOT(sceneLoaded()));
+    connect(&_timer, SIGNAL(timeout()), this, SLOT(update()));
+}
+
+OsgViewerWidget::~OsgViewerWidget()
+{}
+
+/**
+ * Read an earth file through the osgDB object cache.
+ *
+ * The PFD terrain view reads its earth file the same way, so all the views of
+ * the same file share one osgEarth map (and its tile caches) instead of loading it again.
+ */
+osg::ref_ptr<osg::Node> OsgViewerWidget::readEarthFile(const QString &fileName)
+{
+    osg::ref_ptr<osgDB::Options> options = new osgDB::Options();
+    options->setObjectCacheHint(osgDB::Options::CACHE_NODES);
+
+    return osgDB::readNodeFile(QFileInfo(fileName).canonicalFilePath().toStdString(), options.get());
+}
+
+/**
+ * Load the earth file in the background, reading it takes seconds
+ * with remote tile sources and would stall the whole GCS
+ */
+void OsgViewerWidget::setEarthFile(const QString &fileName)
+{
+    if (fileName == earthFile) {
+        return;
+    }
+    earthFile = fileName;
+
+    // a previous load still running is superseded by this one, its result is dropped
+    sceneWatcher.setFuture(QtConcurrent::run(&OsgViewerWidget::readEarthFile, earthFile));
+}
+
+void OsgViewerWidget::setLODScale(double scale)
+{
+    lodScale = scale;
+    updateLOD();
+}
+
+void OsgViewerWidget::setMaximumPagedLOD(int count)
+{
+    maximumPagedLOD = count;
+    updateLOD();
+}
+
+void OsgViewerWidget::updateLOD()
+{
+    if (!view) {
+        return;
+    }
+    view->getCamera()->setLODScale(lodScale);
+    view->getDatabasePager()->setTargetMaximumNumberOfPageLOD(maximumPagedLOD);
+}
+
+void OsgViewerWidget::sceneLoaded()
+{
+    osg::ref_ptr<osg::Node> earth = sceneWatcher.result();
+
+    mapNode = osgEarth::MapNode::findMapNode(earth.get());
     if (!mapNode) {
-        qDebug() << "Uhoh";
+        qWarning() << "OsgViewerWidget -" << earthFile << "doesn't look like an osgEarth file";
+        return;
     }
 
-    root->addChild(earth);
+    osg::Group *root = new osg::Group;
+    root->addChild(earth.get());
 
     osg::Node *airplane = createAirplane();
     uavPos = new osgEarth::Util::ObjectLocatorNode(mapNode->getMap());
@@ -124,27 +197,28 @@ OsgViewerWidget::OsgViewerWidget(QWidget *parent) : QWidget(parent)
 
     root->addChild(uavPos);
 
+    // only optimize our own nodes, the earth is shared with the other views
     osgUtil::Optimizer optimizer;
-    optimizer.optimize(root);
+    optimizer.optimize(uavPos);
+
+    if (view) {
+        view->setSceneData(root);
+        manip->setTetherNode(uavPos);
+        return;
+    }
 
     QWidget *viewWidget = createViewWidget(createCamera(0, 0, 200, 200, "Earth", false), root);
     viewWidget->show();
-    setLayout(new QVBoxLayout(this));
 
     viewWidget->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     layout()->addWidget(viewWidget);
 
-
-    connect(&_timer, SIGNAL(timeout()), this, SLOT(update()));
     _timer.start(10);
 }
 
-OsgViewerWidget::~OsgViewerWidget()
-{}
-
 QWidget *OsgViewerWidget::createViewWidget(osg::Camera *camera, osg::Node *scene)
 {
-    osgViewer::View *view = new osgViewer::View;
+    view = new osgViewer::View;
 
     view->setCamera(camera);
 
@@ -152,7 +226,13 @@ QWidget *OsgViewerWidget::createViewWidget(osg::Camera *camera, osg::Node *scene
 
     view->setSceneData(scene);
     view->addEventHandler(new osgViewer::StatsHandler);
-    view->getDatabasePager()->setDoPreCompile(true);
+
+    // size the pager threads explicitly, one of them for http so that
+    // slow remote tiles don't hold back the ones read from the cache
+    osgDB::DatabasePager *pager = view->getDatabasePager();
+    pager->setDoPreCompile(true);
+    pager->setUpThreads(qBound(2, QThread::idealThreadCount(), 4), 1);
+    updateLOD();
 
     manip = new EarthManipulator();
     view->setCameraManipulator(manip);
@@ -253,6 +333,9 @@ osg::Node *OsgViewerWidget::createAirplane()
 void OsgViewerWidget::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event);
+    if (!uavPos) {
+        return;
+    }
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objMngr = pm->getObject<UAVObjectManager>();
 
@@ -287,7 +370,9 @@ void OsgViewerWidget::paintEvent(QPaintEvent *event)
     quat.makeRotate(angle, osg::Vec3d(axis[1], axis[0], -axis[2]));
     osg::Matrixd rot = osg::Matrixd::rotate(quat);
 
-    uavAttitudeAndScale->setMatrix(rot);
+    if (uavAttitudeAndScale) {
+        uavAttitudeAndScale->setMatrix(rot);
+    }
 
     frame();
 }
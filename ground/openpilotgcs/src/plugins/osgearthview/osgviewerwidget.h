@@ -34,6 +34,7 @@
 #include "uavobject.h"
 
 #include <QTimer>
+#include <QFutureWatcher>
 
 #include <osg/Notify>
 #include <osg/PositionAttitudeTransform>
@@ -87,10 +88,20 @@ class OsgViewerWidget : public QWidget, public osgViewer::CompositeViewer {
 public:
     explicit OsgViewerWidget(QWidget *parent = 0);
     ~OsgViewerWidget();
+
+    void setEarthFile(const QString &fileName);
+    void setLODScale(double scale);
+    void setMaximumPagedLOD(int count);
+
+    static osg::ref_ptr<osg::Node> readEarthFile(const QString &fileName);
+
 signals:
 
 public slots:
 
+private slots:
+    void sceneLoaded();
+
 protected:
     void paintEvent(QPaintEvent *event);
 
@@ -103,8 +114,16 @@ protected:
     /* Get the model to render */
     osg::Node *createAirplane();
 
+    /* Apply the terrain level of detail settings to the view */
+    void updateLOD();
+
 private: /* Private variables */
     QTimer _timer;
+    QFutureWatcher<osg::ref_ptr<osg::Node> > sceneWatcher;
+    QString earthFile;
+    double lodScale;
+    int maximumPagedLOD;
+    osgViewer::View *view;
     EarthManipulator *manip;
     osgEarth::Util::ObjectLocatorNode *uavPos;
     osg::MatrixTransform *uavAttitudeAndScale;
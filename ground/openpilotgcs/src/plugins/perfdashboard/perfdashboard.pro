@@ -0,0 +1,20 @@
+TEMPLATE = lib
+TARGET = PerfDashboardGadget
+
+include(../../openpilotgcsplugin.pri)
+include(../../plugins/coreplugin/coreplugin.pri)
+include(../../plugins/uavobjects/uavobjects.pri)
+include(../../plugins/uavtalk/uavtalk.pri)
+
+HEADERS += perfdashboardplugin.h
+HEADERS += perfdashboardgadget.h
+HEADERS += perfdashboardgadgetfactory.h
+HEADERS += perfdashboardgadgetwidget.h
+HEADERS += perfrun.h
+SOURCES += perfdashboardplugin.cpp
+SOURCES += perfdashboardgadget.cpp
+SOURCES += perfdashboardgadgetfactory.cpp
+SOURCES += perfdashboardgadgetwidget.cpp
+SOURCES += perfrun.cpp
+
+OTHER_FILES += PerfDashboardGadget.pluginspec
@@ -0,0 +1,38 @@
+/**
+ ******************************************************************************
+ *
+ * @file       perfdashboardgadget.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup PerfDashboardPlugin Performance Dashboard Plugin
+ * @{
+ * @brief Live and recorded performance figures of the board, compared to a baseline
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "perfdashboardgadget.h"
+#include "perfdashboardgadgetwidget.h"
+
+PerfDashboardGadget::PerfDashboardGadget(QString classId, PerfDashboardGadgetWidget *widget, QWidget *parent) :
+    IUAVGadget(classId, parent),
+    m_widget(widget)
+{}
+
+PerfDashboardGadget::~PerfDashboardGadget()
+{
+    delete m_widget;
+}
@@ -0,0 +1,514 @@
+/**
+ ******************************************************************************
+ *
+ * @file       perfdashboardgadgetwidget.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup PerfDashboardPlugin Performance Dashboard Plugin
+ * @{
+ * @brief Live and recorded performance figures of the board, compared to a baseline
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "perfdashboardgadgetwidget.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+
+#include <extensionsystem/pluginmanager.h>
+#include <utils/pathutils.h>
+#include <uavtalk/telemetrymanager.h>
+#include "uavobjectmanager.h"
+#include "perfcounter.h"
+#include "perfprofile.h"
+#include "systemstats.h"
+#include "flightstatus.h"
+
+#define POLL_PERIOD          1000
+#define REFRESH_DELAY        250
+// change of a mean, in percent, shown as a regression or an improvement
+#define REGRESSION_THRESHOLD 5.0
+
+namespace {
+enum CounterKind { COUNTER_PERIOD, COUNTER_TIME, COUNTER_VALUE };
+
+// The counters and profiles defined in the flight code, see PERF_INIT_COUNTER and
+// PERF_INIT_PROFILE, the kind of a profile is not used
+struct KnownCounter {
+    quint32     id;
+    const char *name;
+    CounterKind kind;
+};
+
+const KnownCounter knownCounters[] = {
+    { 0x53000001, "Sensors accel samples", COUNTER_VALUE  },
+    { 0x53000002, "Sensors accel",         COUNTER_PERIOD },
+    { 0x53000003, "Sensors mag",           COUNTER_PERIOD },
+    { 0x53000004, "Sensors baro",          COUNTER_PERIOD },
+    { 0x53000005, "Sensors loop",          COUNTER_PERIOD },
+    { 0x53000006, "Sensors resets",        COUNTER_VALUE  },
+    { 0x53000007, "Sensors mag latency",   COUNTER_TIME   },
+    { 0x53000008, "Sensors baro latency",  COUNTER_TIME   },
+    { 0x53000009, "Sensors gyro latency",  COUNTER_TIME   },
+    { 0xA7710001, "Attitude update",       COUNTER_TIME   },
+    { 0xA7710002, "Attitude attitude",     COUNTER_TIME   },
+    { 0xA7710003, "Attitude loop",         COUNTER_PERIOD },
+    { 0xA7710004, "Attitude accel samples", COUNTER_VALUE },
+    { 0x97510001, "GPS bytes in",          COUNTER_VALUE  },
+    { 0x97510002, "GPS",                   COUNTER_PERIOD },
+    { 0x97510003, "GPS parse",             COUNTER_TIME   },
+    { 0xE6F00001, "EKF covariance",        COUNTER_TIME   },
+    { 0xE6F00002, "EKF correction",        COUNTER_TIME   },
+    { 0xE6F00003, "EKF filter",            COUNTER_TIME   },
+};
+
+const KnownCounter *findCounter(quint32 id)
+{
+    for (unsigned int i = 0; i < sizeof(knownCounters) / sizeof(knownCounters[0]); i++) {
+        if (knownCounters[i].id == id) {
+            return &knownCounters[i];
+        }
+    }
+    return NULL;
+}
+
+QString counterName(quint32 id)
+{
+    const KnownCounter *counter = findCounter(id);
+
+    return counter ? QString(counter->name) : QString("0x%1").arg(id, 8, 16, QChar('0'));
+}
+
+QString format(double value)
+{
+    return QString::number(value, 'f', qAbs(value) < 100.0 ? 2 : 0);
+}
+}
+
+PerfDashboardGadgetWidget::PerfDashboardGadgetWidget(QWidget *parent) : QWidget(parent),
+    recording(false),
+    armed(false)
+{
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+
+    objManager = pm->getObject<UAVObjectManager>();
+    telMngr    = pm->getObject<TelemetryManager>();
+
+    recordButton = new QPushButton(tr("Record"), this);
+    recordButton->setCheckable(true);
+    recordButton->setToolTip(tr("Records a run on the bench, flights are recorded from arming to disarming"));
+    saveBaselineButton = new QPushButton(tr("Save as baseline"), this);
+    loadBaselineButton = new QPushButton(tr("Load baseline..."), this);
+    statusLabel = new QLabel(this);
+
+    table = new QTableWidget(0, 8, this);
+    table->setHorizontalHeaderLabels(QStringList() << tr("Figure") << tr("Unit") << tr("Now") << tr("Worst now")
+                                                   << tr("Mean") << tr("Worst") << tr("Baseline") << tr("Change %"));
+    table->verticalHeader()->hide();
+    table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionMode(QAbstractItemView::NoSelection);
+    table->setToolTip(tr("Mean and Worst are taken over the run, the mean is compared to the one of the baseline. "
+                         "Worst now is the worst value the board saw since its previous report."));
+
+    QHBoxLayout *controls = new QHBoxLayout();
+    controls->addWidget(recordButton);
+    controls->addWidget(saveBaselineButton);
+    controls->addWidget(loadBaselineButton);
+    controls->addWidget(statusLabel, 1);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(controls);
+    layout->addWidget(table, 1);
+
+    QString baselineFile = runDirectory() + "baseline.json";
+    if (QFile::exists(baselineFile) && baseline.load(baselineFile)) {
+        statusLabel->setText(tr("Baseline of %1").arg(baseline.started().toString()));
+    }
+
+    pollTimer.setInterval(POLL_PERIOD);
+    refreshTimer.setSingleShot(true);
+    refreshTimer.setInterval(REFRESH_DELAY);
+    connect(&pollTimer, SIGNAL(timeout()), this, SLOT(poll()));
+    connect(&refreshTimer, SIGNAL(timeout()), this, SLOT(refresh()));
+    connect(recordButton, SIGNAL(clicked()), this, SLOT(toggleRecording()));
+    connect(saveBaselineButton, SIGNAL(clicked()), this, SLOT(saveBaseline()));
+    connect(loadBaselineButton, SIGNAL(clicked()), this, SLOT(loadBaseline()));
+
+    // Every update is a sample of the run, so the updates are not coalesced
+    connectInstances("PerfCounter", SLOT(counterUpdated(UAVObject *)));
+    connectInstances("PerfProfile", SLOT(profileUpdated(UAVObject *)));
+    connectInstances("TaskInfo", SLOT(taskInfoUpdated(UAVObject *)));
+    connectInstances("CallbackInfo", SLOT(callbackInfoUpdated(UAVObject *)));
+    connectInstances("SystemStats", SLOT(systemStatsUpdated(UAVObject *)));
+    connectInstances("FlightStatus", SLOT(flightStatusUpdated(UAVObject *)));
+    connect(objManager, SIGNAL(newInstance(UAVObject *)), this, SLOT(newInstance(UAVObject *)));
+
+    connect(telMngr, SIGNAL(connected()), this, SLOT(onAutopilotConnect()));
+    connect(telMngr, SIGNAL(disconnected()), this, SLOT(onAutopilotDisconnect()));
+    if (telMngr->isConnected()) {
+        onAutopilotConnect();
+    }
+
+    refresh();
+}
+
+PerfDashboardGadgetWidget::~PerfDashboardGadgetWidget()
+{
+    if (recording) {
+        stopRecording();
+    }
+}
+
+/**
+ * The board only sends the counters and profiles when asked to, and the task
+ * diagnostics every ten seconds
+ */
+void PerfDashboardGadgetWidget::poll()
+{
+    PerfCounter::GetInstance(objManager)->requestUpdateAll();
+    PerfProfile::GetInstance(objManager)->requestUpdateAll();
+
+    UAVObject *obj = objManager->getObject(QString("TaskInfo"));
+    if (obj) {
+        obj->requestUpdate();
+    }
+    obj = objManager->getObject(QString("CallbackInfo"));
+    if (obj) {
+        obj->requestUpdate();
+    }
+}
+
+void PerfDashboardGadgetWidget::onAutopilotConnect()
+{
+    if (!recording) {
+        run.clear();
+    }
+    pollTimer.start();
+    poll();
+}
+
+void PerfDashboardGadgetWidget::onAutopilotDisconnect()
+{
+    pollTimer.stop();
+    armed = false;
+    if (recording) {
+        stopRecording();
+    }
+}
+
+void PerfDashboardGadgetWidget::newInstance(UAVObject *obj)
+{
+    if (obj->getName() == "PerfCounter") {
+        connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(counterUpdated(UAVObject *)), Qt::UniqueConnection);
+    } else if (obj->getName() == "PerfProfile") {
+        connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(profileUpdated(UAVObject *)), Qt::UniqueConnection);
+    }
+}
+
+void PerfDashboardGadgetWidget::counterUpdated(UAVObject *obj)
+{
+    PerfCounter *counter = qobject_cast<PerfCounter *>(obj);
+
+    if (!counter) {
+        return;
+    }
+
+    PerfCounter::DataFields data = counter->getData();
+    const KnownCounter *known    = findCounter(data.Id);
+    QString name = counterName(data.Id);
+    double value = data.Counter[PerfCounter::COUNTER_VALUE];
+    double max   = data.Counter[PerfCounter::COUNTER_MAX];
+
+    switch (known ? known->kind : COUNTER_VALUE) {
+    case COUNTER_PERIOD:
+        // a period counter holds the filtered period and the longest one, in us
+        if (value <= 0 || max <= 0) {
+            return;
+        }
+        run.addSample(name + " rate", "Hz", PerfRun::LOWER_IS_WORSE, 1e6 / value, 1e6 / max);
+        break;
+    case COUNTER_TIME:
+        run.addSample(name, "us", PerfRun::HIGHER_IS_WORSE, value, max);
+        break;
+    case COUNTER_VALUE:
+        run.addSample(name, "", PerfRun::NEUTRAL, value, max);
+        break;
+    }
+    if (!refreshTimer.isActive()) {
+        refreshTimer.start();
+    }
+}
+
+void PerfDashboardGadgetWidget::profileUpdated(UAVObject *obj)
+{
+    PerfProfile *profile = qobject_cast<PerfProfile *>(obj);
+
+    if (!profile) {
+        return;
+    }
+
+    PerfProfile::DataFields data = profile->getData();
+    if (data.Count == 0) {
+        // the section did not run over the last period
+        return;
+    }
+    run.addSample(counterName(data.Id) + " profile", "cycles", PerfRun::HIGHER_IS_WORSE,
+                  data.Cycles[PerfProfile::CYCLES_AVERAGE], data.Cycles[PerfProfile::CYCLES_P99]);
+    if (!refreshTimer.isActive()) {
+        refreshTimer.start();
+    }
+}
+
+void PerfDashboardGadgetWidget::taskInfoUpdated(UAVObject *obj)
+{
+    UAVObjectField *running    = obj->getField("Running");
+    UAVObjectField *load       = obj->getField("Load");
+    UAVObjectField *maxRunTime = obj->getField("MaxRunTime");
+
+    if (!running || !load || !maxRunTime) {
+        return;
+    }
+
+    QStringList tasks = running->getElementNames();
+    for (int i = 0; i < tasks.size(); ++i) {
+        if (running->getValue(i).toString() != "True") {
+            continue;
+        }
+        run.addSample(QString("Task %1 load").arg(tasks[i]), "%", PerfRun::HIGHER_IS_WORSE,
+                      load->getDouble(i), load->getDouble(i));
+        run.addSample(QString("Task %1 max run").arg(tasks[i]), "us", PerfRun::HIGHER_IS_WORSE,
+                      maxRunTime->getDouble(i), maxRunTime->getDouble(i));
+    }
+    if (!refreshTimer.isActive()) {
+        refreshTimer.start();
+    }
+}
+
+void PerfDashboardGadgetWidget::callbackInfoUpdated(UAVObject *obj)
+{
+    UAVObjectField *running   = obj->getField("Running");
+    UAVObjectField *worstRun  = obj->getField("WorstCaseRunTime");
+    UAVObjectField *deadlines = obj->getField("DeadlineMisses");
+
+    if (!running || !worstRun || !deadlines) {
+        return;
+    }
+
+    QStringList callbacks = running->getElementNames();
+    for (int i = 0; i < callbacks.size(); ++i) {
+        if (running->getValue(i).toString() != "True") {
+            continue;
+        }
+        run.addSample(QString("Callback %1 worst run").arg(callbacks[i]), "us", PerfRun::HIGHER_IS_WORSE,
+                      worstRun->getDouble(i), worstRun->getDouble(i));
+        run.addSample(QString("Callback %1 deadline misses").arg(callbacks[i]), "", PerfRun::HIGHER_IS_WORSE,
+                      deadlines->getDouble(i), deadlines->getDouble(i));
+    }
+    if (!refreshTimer.isActive()) {
+        refreshTimer.start();
+    }
+}
+
+void PerfDashboardGadgetWidget::systemStatsUpdated(UAVObject *obj)
+{
+    SystemStats *systemStats = qobject_cast<SystemStats *>(obj);
+
+    if (!systemStats || !telMngr->isConnected()) {
+        return;
+    }
+
+    double cpuLoad = systemStats->getData().CPULoad;
+    run.addSample("CPU load", "%", PerfRun::HIGHER_IS_WORSE, cpuLoad, cpuLoad);
+    if (!refreshTimer.isActive()) {
+        refreshTimer.start();
+    }
+}
+
+/**
+ * A flight is recorded from arming to disarming
+ */
+void PerfDashboardGadgetWidget::flightStatusUpdated(UAVObject *obj)
+{
+    FlightStatus *flightStatus = qobject_cast<FlightStatus *>(obj);
+
+    if (!flightStatus) {
+        return;
+    }
+
+    bool nowArmed = flightStatus->getData().Armed == FlightStatus::ARMED_ARMED;
+    if (nowArmed == armed) {
+        return;
+    }
+    armed = nowArmed;
+    if (armed && !recording) {
+        startRecording();
+    } else if (!armed && recording) {
+        stopRecording();
+    }
+}
+
+void PerfDashboardGadgetWidget::toggleRecording()
+{
+    if (recording) {
+        stopRecording();
+    } else {
+        startRecording();
+    }
+}
+
+void PerfDashboardGadgetWidget::startRecording()
+{
+    run.clear();
+    recording = true;
+    recordButton->setChecked(true);
+    recordButton->setText(tr("Stop"));
+    statusLabel->setText(tr("Recording since %1").arg(run.started().toString()));
+    refresh();
+}
+
+void PerfDashboardGadgetWidget::stopRecording()
+{
+    recording = false;
+    recordButton->setChecked(false);
+    recordButton->setText(tr("Record"));
+
+    QString fileName = runDirectory() + run.started().toString("yyyyMMdd-hhmmss") + ".json";
+    if (run.save(fileName)) {
+        statusLabel->setText(tr("Run of %1 s saved to %2").arg(run.duration()).arg(QDir::toNativeSeparators(fileName)));
+    } else {
+        statusLabel->setText(tr("Could not save the run to %1").arg(QDir::toNativeSeparators(fileName)));
+    }
+}
+
+void PerfDashboardGadgetWidget::saveBaseline()
+{
+    QString fileName = runDirectory() + "baseline.json";
+
+    if (!run.save(fileName)) {
+        statusLabel->setText(tr("Could not save the baseline to %1").arg(QDir::toNativeSeparators(fileName)));
+        return;
+    }
+    baseline = run;
+    statusLabel->setText(tr("Baseline of %1").arg(baseline.started().toString()));
+    refresh();
+}
+
+void PerfDashboardGadgetWidget::loadBaseline()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Load baseline"), runDirectory(),
+                                                    tr("Performance runs (*.json)"));
+
+    if (fileName.isEmpty()) {
+        return;
+    }
+    if (!baseline.load(fileName)) {
+        statusLabel->setText(tr("%1 is not a performance run").arg(QDir::toNativeSeparators(fileName)));
+        return;
+    }
+    statusLabel->setText(tr("Baseline of %1").arg(baseline.started().toString()));
+    refresh();
+}
+
+void PerfDashboardGadgetWidget::refresh()
+{
+    const QMap<QString, PerfRun::Metric> &metrics = run.metrics();
+    const QMap<QString, PerfRun::Metric> &reference = baseline.metrics();
+
+    // The figures of the baseline the board does not report any more are listed too
+    QStringList names = metrics.keys();
+    foreach(const QString &name, reference.keys()) {
+        if (!metrics.contains(name)) {
+            names.append(name);
+        }
+    }
+    names.sort();
+
+    // The rows are rewritten in place, so that the table does not flicker
+    table->setRowCount(names.size());
+    for (int row = 0; row < names.size(); ++row) {
+        const QString &name = names[row];
+        QMap<QString, PerfRun::Metric>::const_iterator current = metrics.constFind(name);
+        QMap<QString, PerfRun::Metric>::const_iterator base    = reference.constFind(name);
+        bool hasCurrent = current != metrics.constEnd();
+        bool hasBase    = base != reference.constEnd();
+
+        setCell(row, 0, name);
+        setCell(row, 1, hasCurrent ? current->unit : base->unit);
+        setCell(row, 2, hasCurrent ? format(current->current) : QString());
+        setCell(row, 3, hasCurrent ? format(current->currentWorst) : QString());
+        setCell(row, 4, hasCurrent ? format(current->mean()) : QString());
+        setCell(row, 5, hasCurrent ? format(current->worst) : QString());
+        setCell(row, 6, hasBase ? format(base->mean()) : QString());
+
+        if (!hasCurrent || !hasBase || base->mean() == 0.0) {
+            setCell(row, 7, QString());
+            continue;
+        }
+
+        double change = 100.0 * (current->mean() - base->mean()) / qAbs(base->mean());
+        QColor color;
+        if (change * current->direction > REGRESSION_THRESHOLD) {
+            color = Qt::red;
+        } else if (change * current->direction < -REGRESSION_THRESHOLD) {
+            color = Qt::darkGreen;
+        }
+        setCell(row, 7, QString::number(change, 'f', 1), color);
+    }
+}
+
+void PerfDashboardGadgetWidget::connectInstances(const QString &objName, const char *slot)
+{
+    // Boards without the diagnostics do not know the objects, their figures stay out
+    foreach(UAVObject * obj, objManager->getObjectInstances(objName)) {
+        connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, slot, Qt::UniqueConnection);
+    }
+}
+
+void PerfDashboardGadgetWidget::setCell(int row, int column, const QString &text, const QColor &color)
+{
+    QTableWidgetItem *cell = table->item(row, column);
+
+    if (!cell) {
+        cell = new QTableWidgetItem();
+        if (column > 1) {
+            cell->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        }
+        table->setItem(row, column, cell);
+    }
+    cell->setText(text);
+    if (color.isValid()) {
+        cell->setForeground(color);
+    } else {
+        cell->setData(Qt::ForegroundRole, QVariant());
+    }
+}
+
+QString PerfDashboardGadgetWidget::runDirectory()
+{
+    QString directory = Utils::PathUtils().GetStoragePath() + "perfdashboard/";
+
+    QDir().mkpath(directory);
+    return directory;
+}
@@ -0,0 +1,103 @@
+/**
+ ******************************************************************************
+ *
+ * @file       perfdashboardgadgetwidget.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup PerfDashboardPlugin Performance Dashboard Plugin
+ * @{
+ * @brief Live and recorded performance figures of the board, compared to a baseline
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PERFDASHBOARDGADGETWIDGET_H
+#define PERFDASHBOARDGADGETWIDGET_H
+
+#include <QWidget>
+#include <QColor>
+#include <QTimer>
+
+#include "perfrun.h"
+
+class QLabel;
+class QPushButton;
+class QTableWidget;
+class UAVObject;
+class UAVObjectManager;
+class TelemetryManager;
+
+/**
+ * Table of the loop rates, latencies and CPU use reported by the board.
+ *
+ * The PerfCounter and PerfProfile instances are only sent on request, they
+ * are polled together with TaskInfo and CallbackInfo while the board is
+ * connected; the answers also reach the GCS log when logging is on.
+ *
+ * A run is recorded from arming to disarming, or between two presses of
+ * Record on the bench, and written as JSON to the storage directory. Any
+ * saved run can be loaded as the baseline, the mean of every figure is then
+ * compared to it and the changes in the worse direction are highlighted.
+ */
+class PerfDashboardGadgetWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    PerfDashboardGadgetWidget(QWidget *parent = 0);
+    ~PerfDashboardGadgetWidget();
+
+private slots:
+    void poll();
+    void onAutopilotConnect();
+    void onAutopilotDisconnect();
+    void newInstance(UAVObject *obj);
+    void counterUpdated(UAVObject *obj);
+    void profileUpdated(UAVObject *obj);
+    void taskInfoUpdated(UAVObject *obj);
+    void callbackInfoUpdated(UAVObject *obj);
+    void systemStatsUpdated(UAVObject *obj);
+    void flightStatusUpdated(UAVObject *obj);
+    void toggleRecording();
+    void saveBaseline();
+    void loadBaseline();
+    void refresh();
+
+private:
+    UAVObjectManager *objManager;
+    TelemetryManager *telMngr;
+
+    QPushButton *recordButton;
+    QPushButton *saveBaselineButton;
+    QPushButton *loadBaselineButton;
+    QLabel *statusLabel;
+    QTableWidget *table;
+
+    QTimer pollTimer;
+    QTimer refreshTimer;
+    PerfRun run;
+    PerfRun baseline;
+    bool recording;
+    bool armed;
+
+    void connectInstances(const QString &objName, const char *slot);
+    void startRecording();
+    void stopRecording();
+    void setCell(int row, int column, const QString &text, const QColor &color = QColor());
+    QString runDirectory();
+};
+
+#endif // PERFDASHBOARDGADGETWIDGET_H
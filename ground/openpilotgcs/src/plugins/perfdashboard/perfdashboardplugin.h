@@ -0,0 +1,51 @@
+/**
+ ******************************************************************************
+ *
+ * @file       perfdashboardplugin.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup PerfDashboardPlugin Performance Dashboard Plugin
+ * @{
+ * @brief Live and recorded performance figures of the board, compared to a baseline
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PERFDASHBOARDPLUGIN_H
+#define PERFDASHBOARDPLUGIN_H
+
+#include <extensionsystem/iplugin.h>
+
+class PerfDashboardGadgetFactory;
+
+class PerfDashboardPlugin : public ExtensionSystem::IPlugin {
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID "OpenPilot.PerfDashboard")
+
+public:
+    PerfDashboardPlugin();
+    ~PerfDashboardPlugin();
+
+    void extensionsInitialized();
+    bool initialize(const QStringList & arguments, QString *errorString);
+    void shutdown();
+
+private:
+    PerfDashboardGadgetFactory *mf;
+};
+
+#endif // PERFDASHBOARDPLUGIN_H
@@ -0,0 +1,138 @@
+/**
+ ******************************************************************************
+ *
+ * @file       perfrun.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup PerfDashboardPlugin Performance Dashboard Plugin
+ * @{
+ * @brief Live and recorded performance figures of the board, compared to a baseline
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "perfrun.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+PerfRun::PerfRun()
+{
+    clear();
+}
+
+void PerfRun::clear()
+{
+    m_metrics.clear();
+    m_started    = QDateTime::currentDateTime();
+    m_lastSample = m_started;
+}
+
+void PerfRun::addSample(const QString &name, const QString &unit, Direction direction, double value, double worst)
+{
+    QMap<QString, Metric>::iterator it = m_metrics.find(name);
+
+    if (it == m_metrics.end()) {
+        Metric metric;
+        metric.unit      = unit;
+        metric.direction = direction;
+        metric.samples   = 0;
+        metric.sum   = 0.0;
+        metric.worst = worst;
+        it = m_metrics.insert(name, metric);
+    }
+
+    Metric &metric = it.value();
+    metric.current      = value;
+    metric.currentWorst = worst;
+    metric.samples++;
+    metric.sum += value;
+    if (direction == LOWER_IS_WORSE ? worst < metric.worst : worst > metric.worst) {
+        metric.worst = worst;
+    }
+    m_lastSample = QDateTime::currentDateTime();
+}
+
+/**
+ * Seconds between the start of the run and its last sample
+ */
+int PerfRun::duration() const
+{
+    return m_started.secsTo(m_lastSample);
+}
+
+bool PerfRun::save(const QString &fileName) const
+{
+    QJsonArray metrics;
+
+    for (QMap<QString, Metric>::const_iterator it = m_metrics.constBegin(); it != m_metrics.constEnd(); ++it) {
+        QJsonObject metric;
+        metric["name"]      = it.key();
+        metric["unit"]      = it.value().unit;
+        metric["direction"] = (int)it.value().direction;
+        metric["samples"]   = it.value().samples;
+        metric["mean"]  = it.value().mean();
+        metric["worst"] = it.value().worst;
+        metrics.append(metric);
+    }
+
+    QJsonObject run;
+    run["started"]  = m_started.toString(Qt::ISODate);
+    run["duration"] = duration();
+    run["metrics"]  = metrics;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    return file.write(QJsonDocument(run).toJson()) >= 0;
+}
+
+bool PerfRun::load(const QString &fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll());
+    if (!document.isObject()) {
+        return false;
+    }
+
+    QJsonObject run = document.object();
+    m_metrics.clear();
+    m_started    = QDateTime::fromString(run["started"].toString(), Qt::ISODate);
+    m_lastSample = m_started.addSecs(run["duration"].toInt());
+
+    foreach(const QJsonValue &value, run["metrics"].toArray()) {
+        QJsonObject metric = value.toObject();
+        Metric m;
+
+        m.unit      = metric["unit"].toString();
+        m.direction = (Direction)metric["direction"].toInt();
+        m.samples   = metric["samples"].toInt();
+        m.current   = metric["mean"].toDouble();
+        m.currentWorst = metric["worst"].toDouble();
+        m.sum   = m.current * m.samples;
+        m.worst = m.currentWorst;
+        m_metrics.insert(metric["name"].toString(), m);
+    }
+    return true;
+}
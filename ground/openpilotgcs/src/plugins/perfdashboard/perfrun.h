@@ -0,0 +1,86 @@
+/**
+ ******************************************************************************
+ *
+ * @file       perfrun.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup PerfDashboardPlugin Performance Dashboard Plugin
+ * @{
+ * @brief Live and recorded performance figures of the board, compared to a baseline
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PERFRUN_H
+#define PERFRUN_H
+
+#include <QDateTime>
+#include <QMap>
+#include <QString>
+
+/**
+ * The performance figures of one run, a flight or a bench session.
+ *
+ * Every figure keeps its latest sample and its mean and worst value since the
+ * run started. The worse direction of a figure tells which end of its range
+ * is the regression: a longer latency or a lower loop rate. Runs are saved as
+ * JSON so that a later run can be compared to them.
+ */
+class PerfRun {
+public:
+    enum Direction { NEUTRAL = 0, HIGHER_IS_WORSE = 1, LOWER_IS_WORSE = -1 };
+
+    struct Metric {
+        QString unit;
+        Direction direction;
+        double current;
+        double currentWorst;
+        int samples;
+        double sum;
+        double worst;
+
+        double mean() const
+        {
+            return samples ? sum / samples : 0.0;
+        }
+    };
+
+    PerfRun();
+
+    void clear();
+    void addSample(const QString &name, const QString &unit, Direction direction, double value, double worst);
+
+    const QMap<QString, Metric> &metrics() const
+    {
+        return m_metrics;
+    }
+    QDateTime started() const
+    {
+        return m_started;
+    }
+    int duration() const;
+
+    bool save(const QString &fileName) const;
+    bool load(const QString &fileName);
+
+private:
+    QMap<QString, Metric> m_metrics;
+    QDateTime m_started;
+    QDateTime m_lastSample;
+};
+
+#endif // PERFRUN_H
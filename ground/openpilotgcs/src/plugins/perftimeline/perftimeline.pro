@@ -0,0 +1,19 @@
+TEMPLATE = lib
+TARGET = PerfTimelineGadget
+
+include(../../openpilotgcsplugin.pri)
+include(../../plugins/coreplugin/coreplugin.pri)
+include(../../plugins/uavobjects/uavobjects.pri)
+
+HEADERS += perftimelineplugin.h
+HEADERS += perftimelinegadget.h
+HEADERS += perftimelinegadgetfactory.h
+HEADERS += perftimelinegadgetwidget.h
+HEADERS += timelineview.h
+SOURCES += perftimelineplugin.cpp
+SOURCES += perftimelinegadget.cpp
+SOURCES += perftimelinegadgetfactory.cpp
+SOURCES += perftimelinegadgetwidget.cpp
+SOURCES += timelineview.cpp
+
+OTHER_FILES += PerfTimelineGadget.pluginspec
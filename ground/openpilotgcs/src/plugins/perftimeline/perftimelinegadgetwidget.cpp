@@ -0,0 +1,184 @@
+/**
+ ******************************************************************************
+ *
+ * @file       perftimelinegadgetwidget.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup PerfTimelinePlugin Performance Timeline Plugin
+ * @{
+ * @brief Timeline of the profiled sections and callbacks traced on board
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "perftimelinegadgetwidget.h"
+
+#include <QLabel>
+#include <QPushButton>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+
+#include <extensionsystem/pluginmanager.h>
+#include "uavobjectmanager.h"
+#include "perftrace.h"
+#include "perftracecontrol.h"
+
+#define CHUNK_TIMEOUT 1000
+#define MAX_RETRIES   5
+
+PerfTimelineGadgetWidget::PerfTimelineGadgetWidget(QWidget *parent) : QWidget(parent),
+    retries(0),
+    capturing(false),
+    nextChunk(0)
+{
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+
+    objManager = pm->getObject<UAVObjectManager>();
+    perfTrace  = PerfTrace::GetInstance(objManager);
+    perfTraceControl = PerfTraceControl::GetInstance(objManager);
+
+    captureButton = new QPushButton(tr("Capture"), this);
+    statusLabel   = new QLabel(tr("Press Capture to read the trace out of the board"), this);
+    view = new TimelineView(this);
+
+    QHBoxLayout *controls = new QHBoxLayout();
+    controls->addWidget(captureButton);
+    controls->addWidget(statusLabel, 1);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(controls);
+    layout->addWidget(view, 1);
+
+    retryTimer.setSingleShot(true);
+    retryTimer.setInterval(CHUNK_TIMEOUT);
+    connect(&retryTimer, SIGNAL(timeout()), this, SLOT(retry()));
+    connect(captureButton, SIGNAL(clicked()), this, SLOT(capture()));
+    connect(perfTrace, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(traceUpdated(UAVObject *)));
+}
+
+PerfTimelineGadgetWidget::~PerfTimelineGadgetWidget()
+{}
+
+void PerfTimelineGadgetWidget::capture()
+{
+    events.clear();
+    nextChunk = 0;
+    retries   = 0;
+    capturing = true;
+    captureButton->setEnabled(false);
+    statusLabel->setText(tr("Capturing..."));
+
+    perfTraceControl->setOperation(PerfTraceControl::OPERATION_CAPTURE);
+    perfTraceControl->updated();
+    retryTimer.start();
+}
+
+void PerfTimelineGadgetWidget::traceUpdated(UAVObject *obj)
+{
+    Q_UNUSED(obj);
+
+    if (!capturing) {
+        return;
+    }
+
+    PerfTrace::DataFields trace = perfTrace->getData();
+    if (trace.Chunk != nextChunk) {
+        // an answer to a request made again, already handled
+        return;
+    }
+
+    for (int i = 0; i < (int)PerfTrace::TIMESTAMP_NUMELEM && events.size() < trace.Events; i++) {
+        TimelineView::Event event;
+        event.timestamp = trace.Timestamp[i];
+        event.id   = trace.Id[i];
+        event.type = trace.Type[i];
+        event.task = trace.Task[i];
+        events.append(event);
+    }
+
+    retries = 0;
+    if (events.size() < trace.Events) {
+        statusLabel->setText(tr("Retrieving %1 of %2 events...").arg(events.size()).arg(trace.Events));
+        requestChunk(nextChunk + 1);
+        return;
+    }
+
+    view->setTrace(events, trace.ClockRate, elementNames("TaskInfo"), elementNames("CallbackInfo"), profileNames());
+    finish(tr("%1 events").arg(events.size()));
+}
+
+void PerfTimelineGadgetWidget::retry()
+{
+    if (!capturing) {
+        return;
+    }
+    if (++retries > MAX_RETRIES) {
+        finish(tr("The board did not answer, %1 events retrieved").arg(events.size()));
+        return;
+    }
+    if (nextChunk == 0 && events.isEmpty()) {
+        // the capture request itself was lost
+        perfTraceControl->setOperation(PerfTraceControl::OPERATION_CAPTURE);
+        perfTraceControl->updated();
+        retryTimer.start();
+    } else {
+        requestChunk(nextChunk);
+    }
+}
+
+void PerfTimelineGadgetWidget::requestChunk(quint16 chunk)
+{
+    nextChunk = chunk;
+    perfTraceControl->setOperation(PerfTraceControl::OPERATION_RETRIEVE);
+    perfTraceControl->setChunk(chunk);
+    perfTraceControl->updated();
+    retryTimer.start();
+}
+
+void PerfTimelineGadgetWidget::finish(const QString &status)
+{
+    retryTimer.stop();
+    capturing = false;
+    captureButton->setEnabled(true);
+    statusLabel->setText(status);
+
+    // the board records again
+    perfTraceControl->setOperation(PerfTraceControl::OPERATION_RESUME);
+    perfTraceControl->updated();
+}
+
+QStringList PerfTimelineGadgetWidget::elementNames(const QString &objName)
+{
+    UAVObject *obj = objManager->getObject(objName);
+
+    if (!obj || !obj->getField("Running")) {
+        return QStringList();
+    }
+    return obj->getField("Running")->getElementNames();
+}
+
+QStringList PerfTimelineGadgetWidget::profileNames()
+{
+    QStringList names;
+
+    // the trace gives the profile index, the PerfProfile instance of the same index has its id
+    foreach(UAVObject * obj, objManager->getObjectInstances("PerfProfile")) {
+        UAVObjectField *id = obj->getField("Id");
+
+        names.append(id ? QString("0x%1").arg(id->getValue().toUInt(), 8, 16, QChar('0')) : QString());
+    }
+    return names;
+}
@@ -0,0 +1,85 @@
+/**
+ ******************************************************************************
+ *
+ * @file       perftimelinegadgetwidget.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup PerfTimelinePlugin Performance Timeline Plugin
+ * @{
+ * @brief Timeline of the profiled sections and callbacks traced on board
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PERFTIMELINEGADGETWIDGET_H
+#define PERFTIMELINEGADGETWIDGET_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QVector>
+
+#include "timelineview.h"
+
+class QLabel;
+class QPushButton;
+class UAVObject;
+class UAVObjectManager;
+class PerfTrace;
+class PerfTraceControl;
+
+/**
+ * Reads the on board trace out chunk by chunk and shows it in a TimelineView.
+ *
+ * Capture freezes the trace ring on board, which answers with the first chunk;
+ * each chunk received asks for the next one until all the events are in, and
+ * the recording is then resumed. A chunk that does not come in time is asked
+ * for again.
+ */
+class PerfTimelineGadgetWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    PerfTimelineGadgetWidget(QWidget *parent = 0);
+    ~PerfTimelineGadgetWidget();
+
+private slots:
+    void capture();
+    void traceUpdated(UAVObject *obj);
+    void retry();
+
+private:
+    UAVObjectManager *objManager;
+    PerfTrace *perfTrace;
+    PerfTraceControl *perfTraceControl;
+
+    QPushButton *captureButton;
+    QLabel *statusLabel;
+    TimelineView *view;
+
+    QTimer retryTimer;
+    int retries;
+    bool capturing;
+    quint16 nextChunk;
+    QVector<TimelineView::Event> events;
+
+    void requestChunk(quint16 chunk);
+    void finish(const QString &status);
+    QStringList elementNames(const QString &objName);
+    QStringList profileNames();
+};
+
+#endif // PERFTIMELINEGADGETWIDGET_H
@@ -0,0 +1,265 @@
+/**
+ ******************************************************************************
+ *
+ * @file       timelineview.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup PerfTimelinePlugin Performance Timeline Plugin
+ * @{
+ * @brief Timeline of the profiled sections and callbacks traced on board
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "timelineview.h"
+
+#include <QHash>
+#include <QPainter>
+#include <QToolTip>
+#include <QWheelEvent>
+#include <QMouseEvent>
+#include <QHelpEvent>
+#include <qmath.h>
+
+#define LABEL_WIDTH  180
+#define AXIS_HEIGHT  20
+#define ROW_HEIGHT   18
+#define MARK_WIDTH   3
+
+TimelineView::TimelineView(QWidget *parent) : QWidget(parent),
+    duration(0),
+    viewBegin(0),
+    viewLength(1),
+    dragX(0)
+{
+    setMouseTracking(true);
+    setAutoFillBackground(true);
+    setBackgroundRole(QPalette::Base);
+}
+
+/**
+ * Pair the begin and end events into spans
+ * \param events the trace, oldest first
+ * \param clockRate frequency of the timestamps
+ * \param tasks names of the tasks, by task monitor index
+ * \param callbacks names of the callbacks, by callback index
+ * \param profiles names of the profiles, by profile index
+ */
+void TimelineView::setTrace(const QVector<Event> &events, quint32 clockRate, const QStringList &tasks,
+                            const QStringList &callbacks, const QStringList &profiles)
+{
+    // begin time of what is running, by row
+    QHash<int, double> running;
+    double time = 0;
+
+    rows.clear();
+    spans.clear();
+
+    for (int i = 0; i < events.size(); i++) {
+        const Event &e = events.at(i);
+        if (i > 0 && clockRate) {
+            // the counter wraps, the difference does not as long as the events are close enough
+            time += (double)(quint32)(e.timestamp - events.at(i - 1).timestamp) / clockRate;
+        }
+
+        QString taskName = name(tasks, e.task, tr("task"));
+        int row;
+        switch (e.type) {
+        case EVENT_MARK:
+            row = rowFor(tr("%1 marks").arg(taskName));
+            spans.append(Span(time, time, row));
+            break;
+        case EVENT_PROFILE_BEGIN:
+            running.insert(rowFor(tr("%1 / %2").arg(name(profiles, e.id, tr("profile")), taskName)), time);
+            break;
+        case EVENT_CALLBACK_BEGIN:
+            running.insert(rowFor(name(callbacks, e.id, tr("callback"))), time);
+            break;
+        case EVENT_PROFILE_END:
+        case EVENT_CALLBACK_END:
+            row = (e.type == EVENT_PROFILE_END) ?
+                  rowFor(tr("%1 / %2").arg(name(profiles, e.id, tr("profile")), taskName)) :
+                  rowFor(name(callbacks, e.id, tr("callback")));
+            // the begin of the oldest ones may have been overwritten
+            if (running.contains(row)) {
+                spans.append(Span(running.take(row), time, row));
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    duration   = time;
+    viewBegin  = 0;
+    viewLength = (duration > 0) ? duration : 1;
+    setMinimumHeight(AXIS_HEIGHT + rows.size() * ROW_HEIGHT);
+    update();
+}
+
+int TimelineView::rowFor(const QString &name)
+{
+    int row = rows.indexOf(name);
+
+    if (row < 0) {
+        row = rows.size();
+        rows.append(name);
+    }
+    return row;
+}
+
+QString TimelineView::name(const QStringList &names, int index, const QString &kind) const
+{
+    if (index >= 0 && index < names.size()) {
+        return names.at(index);
+    }
+    return QString("%1 %2").arg(kind).arg(index);
+}
+
+double TimelineView::timeAt(int x) const
+{
+    return viewBegin + (x - LABEL_WIDTH) * viewLength / qMax(1, width() - LABEL_WIDTH);
+}
+
+int TimelineView::xAt(double time) const
+{
+    return LABEL_WIDTH + qRound((time - viewBegin) * (width() - LABEL_WIDTH) / viewLength);
+}
+
+int TimelineView::spanAt(const QPoint &pos) const
+{
+    int row = (pos.y() - AXIS_HEIGHT) / ROW_HEIGHT;
+
+    if (pos.x() < LABEL_WIDTH || pos.y() < AXIS_HEIGHT) {
+        return -1;
+    }
+    for (int i = 0; i < spans.size(); i++) {
+        const Span &s = spans.at(i);
+        if (s.row == row && xAt(s.begin) - MARK_WIDTH <= pos.x() && pos.x() <= qMax(xAt(s.end), xAt(s.begin) + MARK_WIDTH)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void TimelineView::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    int plotWidth = width() - LABEL_WIDTH;
+
+    // time axis, with ticks on a 1, 2, 5 scale
+    double step = qPow(10, qFloor(log10(viewLength / 8)));
+    if (viewLength / step > 40) {
+        step *= 5;
+    } else if (viewLength / step > 16) {
+        step *= 2;
+    }
+    painter.setPen(palette().color(QPalette::Mid));
+    for (double t = qCeil(viewBegin / step) * step; t <= viewBegin + viewLength; t += step) {
+        int x = xAt(t);
+        painter.drawLine(x, AXIS_HEIGHT - 4, x, height());
+        painter.drawText(x + 2, AXIS_HEIGHT - 6, QString("%1 ms").arg(t * 1000, 0, 'f', step < 1e-4 ? 2 : 1));
+    }
+
+    // the spans, clipped to the plot
+    painter.save();
+    painter.setClipRect(LABEL_WIDTH, AXIS_HEIGHT, plotWidth, height() - AXIS_HEIGHT);
+    for (int i = 0; i < spans.size(); i++) {
+        const Span &s = spans.at(i);
+        if (s.end < viewBegin || s.begin > viewBegin + viewLength) {
+            continue;
+        }
+        QColor color = QColor::fromHsv((s.row * 67) % 360, 160, 220);
+        int x = xAt(s.begin);
+        int w = qMax(xAt(s.end) - x, 1);
+        int y = AXIS_HEIGHT + s.row * ROW_HEIGHT + 2;
+        if (s.begin == s.end) {
+            painter.fillRect(x - MARK_WIDTH / 2, y, MARK_WIDTH, ROW_HEIGHT - 4, color.darker());
+        } else {
+            painter.fillRect(x, y, w, ROW_HEIGHT - 4, color);
+        }
+    }
+    painter.restore();
+
+    // row names
+    painter.setPen(palette().color(QPalette::Text));
+    for (int row = 0; row < rows.size(); row++) {
+        QRect rect(4, AXIS_HEIGHT + row * ROW_HEIGHT, LABEL_WIDTH - 8, ROW_HEIGHT);
+        painter.drawText(rect, Qt::AlignVCenter | Qt::AlignLeft,
+                         painter.fontMetrics().elidedText(rows.at(row), Qt::ElideRight, rect.width()));
+    }
+    painter.setPen(palette().color(QPalette::Mid));
+    painter.drawLine(LABEL_WIDTH, 0, LABEL_WIDTH, height());
+}
+
+bool TimelineView::event(QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip) {
+        QHelpEvent *helpEvent = static_cast<QHelpEvent *>(event);
+        int i = spanAt(helpEvent->pos());
+        if (i < 0) {
+            QToolTip::hideText();
+            event->ignore();
+        } else {
+            const Span &s = spans.at(i);
+            QString text = (s.begin == s.end) ?
+                           tr("%1\nat %2 ms").arg(rows.at(s.row)).arg(s.begin * 1000, 0, 'f', 3) :
+                           tr("%1\nat %2 ms for %3 us").arg(rows.at(s.row)).arg(s.begin * 1000, 0, 'f', 3)
+                           .arg((s.end - s.begin) * 1e6, 0, 'f', 1);
+            QToolTip::showText(helpEvent->globalPos(), text);
+        }
+        return true;
+    }
+    return QWidget::event(event);
+}
+
+void TimelineView::wheelEvent(QWheelEvent *event)
+{
+    double anchor = timeAt(event->pos().x());
+    double factor = qPow(0.8, event->angleDelta().y() / 120.0);
+
+    // no closer than a microsecond over the whole plot
+    viewLength = qBound(1e-6, viewLength * factor, qMax(duration, 1e-6));
+    viewBegin  = anchor - (event->pos().x() - LABEL_WIDTH) * viewLength / qMax(1, width() - LABEL_WIDTH);
+    update();
+    event->accept();
+}
+
+void TimelineView::mousePressEvent(QMouseEvent *event)
+{
+    dragX = event->pos().x();
+}
+
+void TimelineView::mouseMoveEvent(QMouseEvent *event)
+{
+    if (event->buttons() & Qt::LeftButton) {
+        viewBegin -= (event->pos().x() - dragX) * viewLength / qMax(1, width() - LABEL_WIDTH);
+        dragX = event->pos().x();
+        update();
+    }
+}
+
+void TimelineView::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    Q_UNUSED(event);
+
+    // back to the whole trace
+    viewBegin  = 0;
+    viewLength = (duration > 0) ? duration : 1;
+    update();
+}
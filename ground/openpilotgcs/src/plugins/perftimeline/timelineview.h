@@ -0,0 +1,107 @@
+/**
+ ******************************************************************************
+ *
+ * @file       timelineview.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup PerfTimelinePlugin Performance Timeline Plugin
+ * @{
+ * @brief Timeline of the profiled sections and callbacks traced on board
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef TIMELINEVIEW_H
+#define TIMELINEVIEW_H
+
+#include <QWidget>
+#include <QVector>
+#include <QStringList>
+
+/**
+ * Timeline of the traced events, one row per callback, one per profile and
+ * task it ran in, and one per task for the marks.
+ *
+ * The wheel zooms around the pointer, dragging pans and the tooltip tells
+ * what is under the pointer and how long it lasted.
+ */
+class TimelineView : public QWidget {
+    Q_OBJECT
+
+public:
+    // the event types of the flight side, see pios_trace_event_type
+    enum EventType {
+        EVENT_MARK = 0,
+        EVENT_PROFILE_BEGIN  = 1,
+        EVENT_PROFILE_END    = 2,
+        EVENT_CALLBACK_BEGIN = 3,
+        EVENT_CALLBACK_END   = 4
+    };
+
+    struct Event {
+        quint32 timestamp;
+        quint16 id;
+        quint8  type;
+        quint8  task;
+    };
+
+    TimelineView(QWidget *parent = 0);
+
+    void setTrace(const QVector<Event> &events, quint32 clockRate, const QStringList &tasks,
+                  const QStringList &callbacks, const QStringList &profiles);
+
+    QSize sizeHint() const
+    {
+        return QSize(800, 400);
+    }
+
+protected:
+    bool event(QEvent *event);
+    void paintEvent(QPaintEvent *event);
+    void wheelEvent(QWheelEvent *event);
+    void mousePressEvent(QMouseEvent *event);
+    void mouseMoveEvent(QMouseEvent *event);
+    void mouseDoubleClickEvent(QMouseEvent *event);
+
+private:
+    // something that ran from begin to end, in seconds from the first event, or a mark if both are equal
+    struct Span {
+        double begin;
+        double end;
+        int    row;
+
+        Span() : begin(0), end(0), row(0) {}
+        Span(double b, double e, int r) : begin(b), end(e), row(r) {}
+    };
+
+    QStringList rows;
+    QVector<Span> spans;
+    double duration;
+
+    // shown time window
+    double viewBegin;
+    double viewLength;
+    int dragX;
+
+    int rowFor(const QString &name);
+    QString name(const QStringList &names, int index, const QString &kind) const;
+    double timeAt(int x) const;
+    int xAt(double time) const;
+    int spanAt(const QPoint &pos) const;
+};
+
+#endif // TIMELINEVIEW_H
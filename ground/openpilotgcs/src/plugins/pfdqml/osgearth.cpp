@@ -53,6 +53,8 @@ OsgEarthItem::OsgEarthItem(QDeclarativeItem *parent) :
     m_longitude(153.0),
     m_altitude(400.0),
     m_fieldOfView(90.0),
+    m_lodScale(1.0),
+    m_maximumPagedLOD(300),
     m_sceneFile(QLatin1String("/usr/share/osgearth/maps/srtm.earth"))
 {
     setSize(m_currentSize);
@@ -225,6 +227,24 @@ void OsgEarthItem::setFieldOfView(qreal arg)
     }
 }
 
+// ! Terrain detail, above 1.0 tiles switch to a lower resolution closer to the camera
+void OsgEarthItem::setLodScale(qreal arg)
+{
+    if (!qFuzzyCompare(m_lodScale, arg)) {
+        m_lodScale = arg;
+        emit lodScaleChanged(arg);
+    }
+}
+
+// ! Number of terrain tiles the pager keeps loaded before expiring the unused ones
+void OsgEarthItem::setMaximumPagedLOD(int arg)
+{
+    if (m_maximumPagedLOD != arg) {
+        m_maximumPagedLOD = arg;
+        emit maximumPagedLODChanged(arg);
+    }
+}
+
 void OsgEarthItem::setSceneFile(QString arg)
 {
     if (m_sceneFile != arg) {
@@ -277,8 +297,13 @@ void OsgEarthItemRenderer::initScene()
     int w = m_currentSize.width();
     int h = m_currentSize.height();
 
-    QString sceneFile = m_item->resolvedSceneFile();
-    m_model = osgDB::readNodeFile(sceneFile.toStdString());
+    // this runs on the renderer thread, so the (slow) earth file loading doesn't block the UI.
+    // It is read through the osgDB object cache, as the Earth view gadget does,
+    // so all the views of the same file share one osgEarth map instead of loading it again.
+    QString sceneFile = QFileInfo(m_item->resolvedSceneFile()).canonicalFilePath();
+    osg::ref_ptr<osgDB::Options> options = new osgDB::Options();
+    options->setObjectCacheHint(osgDB::Options::CACHE_NODES);
+    m_model = osgDB::readNodeFile(sceneFile.toStdString(), options.get());
 
     // setup caching
     osgEarth::MapNode *mapNode = osgEarth::MapNode::findMapNode(m_model.get());
@@ -291,7 +316,13 @@ void OsgEarthItemRenderer::initScene()
     m_viewer = new osgViewer::Viewer();
     m_viewer->setThreadingModel(osgViewer::Viewer::SingleThreaded);
     m_viewer->setSceneData(m_model);
-    m_viewer->getDatabasePager()->setDoPreCompile(true);
+
+    // size the pager threads explicitly, one of them for http so that
+    // slow remote tiles don't hold back the ones read from the cache
+    osgDB::DatabasePager *pager = m_viewer->getDatabasePager();
+    pager->setDoPreCompile(true);
+    pager->setUpThreads(qBound(2, QThread::idealThreadCount(), 4), 1);
+    pager->setTargetMaximumNumberOfPageLOD(m_item->maximumPagedLOD());
 
     osg::Camera *camera = m_viewer->getCamera();
     camera->setViewport(new osg::Viewport(0, 0, w, h));
@@ -300,6 +331,7 @@ void OsgEarthItemRenderer::initScene()
 
     // configure the near/far so we don't clip things that are up close
     camera->setNearFarRatio(0.00002);
+    camera->setLODScale(m_item->lodScale());
     camera->setProjectionMatrixAsPerspective(m_item->fieldOfView(), qreal(w) / h, 1.0f, 10000.0f);
 
     updateFrame();
@@ -31,6 +31,8 @@ class OsgEarthItem : public QDeclarativeItem {
 
     Q_PROPERTY(QString sceneFile READ sceneFile WRITE setSceneFile NOTIFY sceneFileChanged)
     Q_PROPERTY(qreal fieldOfView READ fieldOfView WRITE setFieldOfView NOTIFY fieldOfViewChanged)
+    Q_PROPERTY(qreal lodScale READ lodScale WRITE setLodScale NOTIFY lodScaleChanged)
+    Q_PROPERTY(int maximumPagedLOD READ maximumPagedLOD WRITE setMaximumPagedLOD NOTIFY maximumPagedLODChanged)
 
     Q_PROPERTY(qreal roll READ roll WRITE setRoll NOTIFY rollChanged)
     Q_PROPERTY(qreal pitch READ pitch WRITE setPitch NOTIFY pitchChanged)
@@ -53,6 +55,14 @@ public:
     {
         return m_fieldOfView;
     }
+    qreal lodScale() const
+    {
+        return m_lodScale;
+    }
+    int maximumPagedLOD() const
+    {
+        return m_maximumPagedLOD;
+    }
 
     qreal roll() const
     {
@@ -88,6 +98,8 @@ public slots:
     void updateView();
     void setSceneFile(QString arg);
     void setFieldOfView(qreal arg);
+    void setLodScale(qreal arg);
+    void setMaximumPagedLOD(int arg);
 
     void setRoll(qreal arg);
     void setPitch(qreal arg);
@@ -108,6 +120,8 @@ signals:
 
     void sceneFileChanged(QString arg);
     void fieldOfViewChanged(qreal arg);
+    void lodScaleChanged(qreal arg);
+    void maximumPagedLODChanged(int arg);
 
 private slots:
     void updateFrame();
@@ -127,6 +141,8 @@ private:
     double m_altitude;
 
     qreal m_fieldOfView;
+    qreal m_lodScale;
+    int m_maximumPagedLOD;
     QString m_sceneFile;
 };
 
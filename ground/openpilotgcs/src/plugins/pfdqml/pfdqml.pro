@@ -15,6 +15,7 @@ HEADERS += \
     pfdqmlplugin.h \
     pfdqmlgadget.h \
     pfdqmlgadgetwidget.h \
+    pfdqmlobjectbridge.h \
     pfdqmlgadgetfactory.h \
     pfdqmlgadgetconfiguration.h \
     pfdqmlgadgetoptionspage.h
@@ -24,6 +25,7 @@ SOURCES += \
     pfdqmlgadget.cpp \
     pfdqmlgadgetfactory.cpp \
     pfdqmlgadgetwidget.cpp \
+    pfdqmlobjectbridge.cpp \
     pfdqmlgadgetconfiguration.cpp \
     pfdqmlgadgetoptionspage.cpp
 
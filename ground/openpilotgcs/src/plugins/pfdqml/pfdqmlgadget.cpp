@@ -45,6 +45,8 @@ void PfdQmlGadget::loadConfiguration(IUAVGadgetConfiguration *config)
     m_widget->setQmlFile(m->qmlFile());
     m_widget->setEarthFile(m->earthFile());
     m_widget->setTerrainEnabled(m->terrainEnabled());
+    m_widget->setTerrainLODScale(m->terrainLODScale());
+    m_widget->setTerrainMaximumPagedLOD(m->terrainMaximumPagedLOD());
     m_widget->setActualPositionUsed(m->actualPositionUsed());
     m_widget->setLatitude(m->latitude());
     m_widget->setLongitude(m->longitude());
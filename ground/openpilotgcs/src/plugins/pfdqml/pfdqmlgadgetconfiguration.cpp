@@ -27,6 +27,8 @@ PfdQmlGadgetConfiguration::PfdQmlGadgetConfiguration(QString classId, QSettings
     m_earthFile("Unknown"),
     m_openGLEnabled(true),
     m_terrainEnabled(false),
+    m_terrainLODScale(1.0),
+    m_terrainMaximumPagedLOD(300),
     m_actualPositionUsed(false),
     m_latitude(0),
     m_longitude(0),
@@ -53,6 +55,8 @@ PfdQmlGadgetConfiguration::PfdQmlGadgetConfiguration(QString classId, QSettings
 
         m_openGLEnabled      = qSettings->value("openGLEnabled", true).toBool();
         m_terrainEnabled     = qSettings->value("terrainEnabled").toBool();
+        m_terrainLODScale    = qSettings->value("terrainLODScale", m_terrainLODScale).toDouble();
+        m_terrainMaximumPagedLOD = qSettings->value("terrainMaximumPagedLOD", m_terrainMaximumPagedLOD).toInt();
         m_actualPositionUsed = qSettings->value("actualPositionUsed").toBool();
         m_latitude           = qSettings->value("latitude").toDouble();
         m_longitude          = qSettings->value("longitude").toDouble();
@@ -75,6 +79,8 @@ IUAVGadgetConfiguration *PfdQmlGadgetConfiguration::clone()
     m->m_openGLEnabled      = m_openGLEnabled;
     m->m_earthFile          = m_earthFile;
     m->m_terrainEnabled     = m_terrainEnabled;
+    m->m_terrainLODScale    = m_terrainLODScale;
+    m->m_terrainMaximumPagedLOD = m_terrainMaximumPagedLOD;
     m->m_actualPositionUsed = m_actualPositionUsed;
     m->m_latitude           = m_latitude;
     m->m_longitude          = m_longitude;
@@ -100,6 +106,8 @@ void PfdQmlGadgetConfiguration::saveConfig(QSettings *qSettings) const
 
     qSettings->setValue("openGLEnabled", m_openGLEnabled);
     qSettings->setValue("terrainEnabled", m_terrainEnabled);
+    qSettings->setValue("terrainLODScale", m_terrainLODScale);
+    qSettings->setValue("terrainMaximumPagedLOD", m_terrainMaximumPagedLOD);
     qSettings->setValue("actualPositionUsed", m_actualPositionUsed);
     qSettings->setValue("latitude", m_latitude);
     qSettings->setValue("longitude", m_longitude);
@@ -43,6 +43,14 @@ public:
     {
         m_terrainEnabled = flag;
     }
+    void setTerrainLODScale(double scale)
+    {
+        m_terrainLODScale = scale;
+    }
+    void setTerrainMaximumPagedLOD(int count)
+    {
+        m_terrainMaximumPagedLOD = count;
+    }
     void setActualPositionUsed(bool flag)
     {
         m_actualPositionUsed = flag;
@@ -88,6 +96,14 @@ public:
     {
         return m_terrainEnabled;
     }
+    double terrainLODScale() const
+    {
+        return m_terrainLODScale;
+    }
+    int terrainMaximumPagedLOD() const
+    {
+        return m_terrainMaximumPagedLOD;
+    }
     bool actualPositionUsed() const
     {
         return m_actualPositionUsed;
@@ -145,6 +161,8 @@ private:
     QString m_earthFile; // The name of osgearth terrain file
     bool m_openGLEnabled;
     bool m_terrainEnabled;
+    double m_terrainLODScale;
+    int m_terrainMaximumPagedLOD;
     bool m_actualPositionUsed;
     double m_latitude;
     double m_longitude;
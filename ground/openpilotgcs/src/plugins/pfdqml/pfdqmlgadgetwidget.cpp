@@ -15,6 +15,7 @@
  */
 
 #include "pfdqmlgadgetwidget.h"
+#include "pfdqmlobjectbridge.h"
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
 #include "uavobject.h"
@@ -31,11 +32,14 @@
 
 #include <QQmlEngine>
 #include <QQmlContext>
+#include <QQmlPropertyMap>
 
 PfdQmlGadgetWidget::PfdQmlGadgetWidget(QWindow *parent) :
     QQuickView(parent),
     m_openGLEnabled(false),
     m_terrainEnabled(false),
+    m_terrainLODScale(1.0),
+    m_terrainMaximumPagedLOD(300),
     m_actualPositionUsed(false),
     m_latitude(46.671478),
     m_longitude(10.158932),
@@ -43,10 +47,23 @@ PfdQmlGadgetWidget::PfdQmlGadgetWidget(QWindow *parent) :
     m_speedUnit("m/s"),
     m_speedFactor(1.0),
     m_altitudeUnit("m"),
-    m_altitudeFactor(1.0)
+    m_altitudeFactor(1.0),
+    m_frameStatsShown(false),
+    m_frameRate(0),
+    m_renderTime(0),
+    m_dataTime(0)
 {
     setResizeMode(SizeRootObjectToView);
 
+    // the objects are sampled once per frame instead of notifying on every update
+    m_objectBridge = new PfdQmlObjectBridge(this);
+
+    connect(this, SIGNAL(beforeRendering()), this, SLOT(renderingStarted()), Qt::DirectConnection);
+    connect(this, SIGNAL(afterRendering()), this, SLOT(renderingDone()), Qt::DirectConnection);
+    connect(&m_frameStatsTimer, SIGNAL(timeout()), this, SLOT(updateFrameStats()));
+    m_frameStatsTimer.start(1000);
+    m_frameStatsInterval.start();
+
     // setViewport(new QGLWidget(QGLFormat(QGL::SampleBuffers)));
 
     QStringList objectsToExport;
@@ -86,7 +103,7 @@ PfdQmlGadgetWidget::PfdQmlGadgetWidget(QWindow *parent) :
         UAVObject *object = objManager->getObject(objectName);
 
         if (object) {
-            engine()->rootContext()->setContextProperty(objectName, object);
+            engine()->rootContext()->setContextProperty(objectName, m_objectBridge->addObject(object));
         } else {
             qWarning() << "Failed to load object" << objectName;
         }
@@ -143,6 +160,22 @@ void PfdQmlGadgetWidget::setTerrainEnabled(bool arg)
     }
 }
 
+void PfdQmlGadgetWidget::setTerrainLODScale(double arg)
+{
+    if (m_terrainLODScale != arg) {
+        m_terrainLODScale = arg;
+        emit terrainLODScaleChanged(arg);
+    }
+}
+
+void PfdQmlGadgetWidget::setTerrainMaximumPagedLOD(int arg)
+{
+    if (m_terrainMaximumPagedLOD != arg) {
+        m_terrainMaximumPagedLOD = arg;
+        emit terrainMaximumPagedLODChanged(arg);
+    }
+}
+
 void PfdQmlGadgetWidget::setSpeedUnit(QString unit)
 {
     if (m_speedUnit != unit) {
@@ -193,14 +226,51 @@ void PfdQmlGadgetWidget::setActualPositionUsed(bool arg)
 
 void PfdQmlGadgetWidget::mouseReleaseEvent(QMouseEvent *event)
 {
-    // Reload the schene on the middle mouse button click.
+    // Reload the schene on the middle mouse button click,
+    // show the frame statistics on shift + middle click.
     if (event->button() == Qt::MiddleButton) {
-        setQmlFile(m_qmlFileName);
+        if (event->modifiers() & Qt::ShiftModifier) {
+            setFrameStatsShown(!m_frameStatsShown);
+        } else {
+            setQmlFile(m_qmlFileName);
+        }
     }
 
     QQuickView::mouseReleaseEvent(event);
 }
 
+void PfdQmlGadgetWidget::setFrameStatsShown(bool arg)
+{
+    if (m_frameStatsShown != arg) {
+        m_frameStatsShown = arg;
+        emit frameStatsShownChanged(arg);
+    }
+}
+
+void PfdQmlGadgetWidget::renderingStarted()
+{
+    m_renderTimer.start();
+}
+
+void PfdQmlGadgetWidget::renderingDone()
+{
+    m_renderingTime.fetchAndAddRelaxed(m_renderTimer.nsecsElapsed() / 1000);
+    m_renderedFrames.fetchAndAddRelaxed(1);
+}
+
+void PfdQmlGadgetWidget::updateFrameStats()
+{
+    qint64 interval = m_frameStatsInterval.restart();
+    int frames = m_renderedFrames.fetchAndStoreRelaxed(0);
+    int renderingTime = m_renderingTime.fetchAndStoreRelaxed(0);
+    qint64 dataTime   = m_objectBridge->takeSyncTime();
+
+    m_frameRate  = interval > 0 ? frames * 1000.0 / interval : 0;
+    m_renderTime = frames > 0 ? renderingTime / 1000.0 / frames : 0;
+    m_dataTime   = frames > 0 ? dataTime / 1000000.0 / frames : 0;
+    emit frameStatsChanged();
+}
+
 void PfdQmlGadgetWidget::setLatitude(double arg)
 {
     // not sure qFuzzyCompare is accurate enough for geo coordinates
@@ -18,11 +18,18 @@
 #define PFDQMLGADGETWIDGET_H_
 
 #include "pfdqmlgadgetconfiguration.h"
+#include <QAtomicInt>
+#include <QElapsedTimer>
 #include <QQuickView>
+#include <QTimer>
+
+class PfdQmlObjectBridge;
 
 class PfdQmlGadgetWidget : public QQuickView {
     Q_OBJECT Q_PROPERTY(QString earthFile READ earthFile WRITE setEarthFile NOTIFY earthFileChanged)
     Q_PROPERTY(bool terrainEnabled READ terrainEnabled WRITE setTerrainEnabled NOTIFY terrainEnabledChanged)
+    Q_PROPERTY(double terrainLODScale READ terrainLODScale WRITE setTerrainLODScale NOTIFY terrainLODScaleChanged)
+    Q_PROPERTY(int terrainMaximumPagedLOD READ terrainMaximumPagedLOD WRITE setTerrainMaximumPagedLOD NOTIFY terrainMaximumPagedLODChanged)
 
     Q_PROPERTY(bool actualPositionUsed READ actualPositionUsed WRITE setActualPositionUsed NOTIFY actualPositionUsedChanged)
 
@@ -36,6 +43,12 @@ class PfdQmlGadgetWidget : public QQuickView {
     Q_PROPERTY(double longitude READ longitude WRITE setLongitude NOTIFY longitudeChanged)
     Q_PROPERTY(double altitude READ altitude WRITE setAltitude NOTIFY altitudeChanged)
 
+    // frame statistics, updated every second
+    Q_PROPERTY(bool frameStatsShown READ frameStatsShown WRITE setFrameStatsShown NOTIFY frameStatsShownChanged)
+    Q_PROPERTY(double frameRate READ frameRate NOTIFY frameStatsChanged)
+    Q_PROPERTY(double renderTime READ renderTime NOTIFY frameStatsChanged)
+    Q_PROPERTY(double dataTime READ dataTime NOTIFY frameStatsChanged)
+
 public:
     PfdQmlGadgetWidget(QWindow *parent = 0);
     ~PfdQmlGadgetWidget();
@@ -49,6 +62,14 @@ public:
     {
         return m_terrainEnabled && m_openGLEnabled;
     }
+    double terrainLODScale() const
+    {
+        return m_terrainLODScale;
+    }
+    int terrainMaximumPagedLOD() const
+    {
+        return m_terrainMaximumPagedLOD;
+    }
 
     QString speedUnit() const
     {
@@ -84,9 +105,31 @@ public:
         return m_altitude;
     }
 
+    bool frameStatsShown() const
+    {
+        return m_frameStatsShown;
+    }
+    // frames rendered per second
+    double frameRate() const
+    {
+        return m_frameRate;
+    }
+    // average time spent rendering a frame, in ms
+    double renderTime() const
+    {
+        return m_renderTime;
+    }
+    // average time spent updating the objects for a frame, in ms
+    double dataTime() const
+    {
+        return m_dataTime;
+    }
+
 public slots:
     void setEarthFile(QString arg);
     void setTerrainEnabled(bool arg);
+    void setTerrainLODScale(double arg);
+    void setTerrainMaximumPagedLOD(int arg);
 
     void setSpeedUnit(QString unit);
     void setSpeedFactor(double factor);
@@ -101,9 +144,13 @@ public slots:
 
     void setActualPositionUsed(bool arg);
 
+    void setFrameStatsShown(bool arg);
+
 signals:
     void earthFileChanged(QString arg);
     void terrainEnabledChanged(bool arg);
+    void terrainLODScaleChanged(double arg);
+    void terrainMaximumPagedLODChanged(int arg);
 
     void actualPositionUsedChanged(bool arg);
     void latitudeChanged(double arg);
@@ -115,14 +162,26 @@ signals:
     void altitudeUnitChanged(QString arg);
     void altitudeFactorChanged(double arg);
 
+    void frameStatsShownChanged(bool arg);
+    void frameStatsChanged();
+
 protected:
     void mouseReleaseEvent(QMouseEvent *event);
 
+private slots:
+    // called on the render thread
+    void renderingStarted();
+    void renderingDone();
+
+    void updateFrameStats();
+
 private:
     QString m_qmlFileName;
     QString m_earthFile;
     bool m_openGLEnabled;
     bool m_terrainEnabled;
+    double m_terrainLODScale;
+    int m_terrainMaximumPagedLOD;
 
     bool m_actualPositionUsed;
     double m_latitude;
@@ -133,6 +192,19 @@ private:
     double m_speedFactor;
     QString m_altitudeUnit;
     double m_altitudeFactor;
+
+    PfdQmlObjectBridge *m_objectBridge;
+
+    bool m_frameStatsShown;
+    double m_frameRate;
+    double m_renderTime;
+    double m_dataTime;
+    QTimer m_frameStatsTimer;
+    QElapsedTimer m_frameStatsInterval;
+    QElapsedTimer m_renderTimer;
+    QAtomicInt m_renderedFrames;
+    // in us
+    QAtomicInt m_renderingTime;
 };
 
 #endif /* PFDQMLGADGETWIDGET_H_ */
@@ -0,0 +1,90 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+
+#include "pfdqmlobjectbridge.h"
+#include "uavobject.h"
+
+#include <QElapsedTimer>
+#include <QMetaProperty>
+#include <QQmlPropertyMap>
+#include <QQuickWindow>
+
+PfdQmlObjectBridge::PfdQmlObjectBridge(QQuickWindow *window) :
+    QObject(window),
+    m_window(window),
+    m_syncTime(0)
+{
+    // emitted on the gui thread, before the scene is synchronized with the renderer
+    connect(window, SIGNAL(afterAnimating()), this, SLOT(synchronize()));
+}
+
+QQmlPropertyMap *PfdQmlObjectBridge::addObject(UAVObject *object)
+{
+    QQmlPropertyMap *map = m_maps.value(object);
+
+    if (!map) {
+        map = new QQmlPropertyMap(this);
+        copyProperties(object, map);
+        m_maps.insert(object, map);
+        connect(object, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(objectUpdated(UAVObject *)));
+    }
+    return map;
+}
+
+qint64 PfdQmlObjectBridge::takeSyncTime()
+{
+    qint64 time = m_syncTime;
+
+    m_syncTime = 0;
+    return time;
+}
+
+void PfdQmlObjectBridge::objectUpdated(UAVObject *object)
+{
+    m_updatedObjects.insert(object);
+    // the values are picked up with the next frame
+    m_window->update();
+}
+
+void PfdQmlObjectBridge::synchronize()
+{
+    if (m_updatedObjects.isEmpty()) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    foreach(UAVObject * object, m_updatedObjects) {
+        copyProperties(object, m_maps.value(object));
+    }
+    m_updatedObjects.clear();
+    m_syncTime += timer.nsecsElapsed();
+}
+
+void PfdQmlObjectBridge::copyProperties(UAVObject *object, QQmlPropertyMap *map)
+{
+    const QMetaObject *metaObject = object->metaObject();
+
+    // the generated properties, one per field or field element
+    for (int i = metaObject->propertyOffset(); i < metaObject->propertyCount(); ++i) {
+        QMetaProperty property = metaObject->property(i);
+        QVariant value = property.read(object);
+        if (map->value(property.name()) != value) {
+            map->insert(property.name(), value);
+        }
+    }
+}
@@ -0,0 +1,61 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+
+#ifndef PFDQMLOBJECTBRIDGE_H_
+#define PFDQMLOBJECTBRIDGE_H_
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+
+class QQmlPropertyMap;
+class QQuickWindow;
+class UAVObject;
+
+/**
+ * Exposes UAVObjects to QML through property maps updated once per frame.
+ *
+ * Objects like AttitudeState update faster than the display, each update
+ * notifying every field. The maps only get the latest values, when the window
+ * is about to render, and only the fields that changed, so bindings are
+ * evaluated at most once per frame.
+ */
+class PfdQmlObjectBridge : public QObject {
+    Q_OBJECT
+
+public:
+    explicit PfdQmlObjectBridge(QQuickWindow *window);
+
+    QQmlPropertyMap *addObject(UAVObject *object);
+
+    // time spent updating the maps since the last call, in ns
+    qint64 takeSyncTime();
+
+private slots:
+    void objectUpdated(UAVObject *object);
+    void synchronize();
+
+private:
+    QQuickWindow *m_window;
+    QHash<UAVObject *, QQmlPropertyMap *> m_maps;
+    QSet<UAVObject *> m_updatedObjects;
+    qint64 m_syncTime;
+
+    static void copyProperties(UAVObject *object, QQmlPropertyMap *map);
+};
+
+#endif /* PFDQMLOBJECTBRIDGE_H_ */
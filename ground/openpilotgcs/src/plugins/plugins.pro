@@ -252,3 +252,16 @@ plugin_flightlog.depends += plugin_uavobjects
 plugin_flightlog.depends += plugin_uavtalk
 SUBDIRS += plugin_flightlog
 
+# Performance Timeline plugin
+plugin_perftimeline.subdir = perftimeline
+plugin_perftimeline.depends = plugin_coreplugin
+plugin_perftimeline.depends += plugin_uavobjects
+SUBDIRS += plugin_perftimeline
+
+# Performance Dashboard plugin
+plugin_perfdashboard.subdir = perfdashboard
+plugin_perfdashboard.depends = plugin_coreplugin
+plugin_perfdashboard.depends += plugin_uavobjects
+plugin_perfdashboard.depends += plugin_uavtalk
+SUBDIRS += plugin_perfdashboard
+
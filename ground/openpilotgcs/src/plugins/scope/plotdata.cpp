@@ -28,7 +28,162 @@
 
 #include "plotdata.h"
 #include <math.h>
+#include <complex>
+#include <vector>
 #include <QDebug>
+#include <QtConcurrent/QtConcurrentRun>
+#include <unsupported/Eigen/FFT>
+
+void PlotBuffer::setCapacity(int capacity)
+{
+    QVector<double> data(capacity);
+
+    m_size = qMin(m_size, capacity);
+    for (int i = 0; i < m_size; i++) {
+        data[i] = at(i);
+    }
+    m_data  = data;
+    m_first = 0;
+}
+
+void PlotBuffer::append(double value)
+{
+    if (isFull()) {
+        setCapacity(qMax(2 * m_data.size(), 16));
+    }
+    int index = m_first + m_size;
+    if (index >= m_data.size()) {
+        index -= m_data.size();
+    }
+    m_data[index] = value;
+    m_size++;
+}
+
+void PlotBuffer::removeFirst()
+{
+    if (m_size > 0) {
+        if (++m_first == m_data.size()) {
+            m_first = 0;
+        }
+        m_size--;
+    }
+}
+
+void PlotBuffer::clear()
+{
+    m_first = 0;
+    m_size  = 0;
+}
+
+void PlotDecimator::setColumns(double columnWidth, int columns)
+{
+    m_columnWidth = columnWidth;
+    m_columns.clear();
+    // Room for the partly visible columns at both ends of the window
+    m_columns.setCapacity(columns + 2);
+}
+
+void PlotDecimator::append(double x, double y)
+{
+    QPointF sample(x, y);
+    qint64 index = (qint64)floor(x / m_columnWidth);
+
+    if (!m_columns.isEmpty() && m_columns.last().index == index) {
+        Column &column = m_columns.last();
+        if (y < column.min.y()) {
+            column.min = sample;
+        }
+        if (y > column.max.y()) {
+            column.max = sample;
+        }
+        column.last = sample;
+    } else {
+        // the cache drops the oldest column once full
+        Column column;
+        column.index = index;
+        column.first = column.min = column.max = column.last = sample;
+        m_columns.append(column);
+    }
+}
+
+/**
+ * Drop the columns whose samples are all older than x
+ */
+void PlotDecimator::removeBefore(double x)
+{
+    while (!m_columns.isEmpty() && m_columns.first().last.x() < x) {
+        m_columns.removeFirst();
+    }
+}
+
+/**
+ * Plot time of a board timestamp, in seconds on the wall clock scale
+ */
+double PlotTimeBase::time(qint64 timestamp)
+{
+    if (m_anchorTimestamp < 0 || timestamp < m_lastTimestamp - RESTART_THRESHOLD) {
+        m_anchorTimestamp = timestamp;
+        m_anchorTime = currentTime();
+        m_lastTimestamp   = -1;
+    }
+    double time = m_anchorTime + (timestamp - m_anchorTimestamp) / 1000.0;
+    if (timestamp > m_lastTimestamp) {
+        m_lastTimestamp = timestamp;
+        m_lastTime = time;
+    }
+    return time;
+}
+
+double PlotTimeBase::currentTime()
+{
+    QDateTime NOW = QDateTime::currentDateTime();
+
+    return NOW.toTime_t() + NOW.time().msec() / 1000.0;
+}
+
+QPointF PlotDecimator::point(int i) const
+{
+    const Column &column = m_columns.at(m_columns.firstIndex() + i / POINTS_PER_COLUMN);
+    bool minFirst = column.min.x() <= column.max.x();
+
+    switch (i % POINTS_PER_COLUMN) {
+    case 0:
+        return column.first;
+
+    case 1:
+        return minFirst ? column.min : column.max;
+
+    case 2:
+        return minFirst ? column.max : column.min;
+
+    default:
+        return column.last;
+    }
+}
+
+size_t PlotSeriesData::size() const
+{
+    if (isDecimated()) {
+        return m_decimator->pointCount();
+    }
+    return m_yData->size();
+}
+
+QPointF PlotSeriesData::sample(size_t i) const
+{
+    if (isDecimated()) {
+        return m_decimator->point((int)i);
+    }
+    return QPointF(m_xData ? m_xData->at((int)i) : (double)i, m_yData->at((int)i));
+}
+
+QRectF PlotSeriesData::boundingRect() const
+{
+    if (d_boundingRect.width() < 0.0) {
+        d_boundingRect = qwtBoundingRect(*this);
+    }
+    return d_boundingRect;
+}
 
 PlotData::PlotData(UAVObject *object, UAVObjectField *field, int element,
                    int scaleOrderFactor, int meanSamples, QString mathFunction,
@@ -36,9 +191,12 @@ PlotData::PlotData(UAVObject *object, UAVObjectField *field, int element,
     m_scalePower(scaleOrderFactor), m_meanSamples(meanSamples),
     m_meanSum(0.0f), m_mathFunction(mathFunction), m_correctionSum(0.0f),
     m_correctionCount(0), m_plotDataSize(plotDataSize),
-    m_object(object), m_field(field), m_element(element),
+    m_plotSeries(NULL), m_object(object), m_field(field), m_element(element),
     m_plotCurve(NULL), m_isVisible(true), m_pen(pen), m_isEnumPlot(false)
 {
+    // Keep the current sample as well as the meanSamples before it
+    m_yDataHistory.setCapacity(qMax(1, m_meanSamples) + 1);
+
     if (m_field->getNumElements() > 1) {
         m_elementName = m_field->getElementNames().at(m_element);
     }
@@ -62,7 +220,6 @@ PlotData::PlotData(UAVObject *object, UAVObjectField *field, int element,
     }
 
     m_plotCurve->setPen(m_pen);
-    m_plotCurve->setSamples(m_xDataEntries, m_yDataEntries);
     m_isEnumPlot = m_field->getType() == UAVObjectField::ENUM;
 }
 
@@ -77,6 +234,15 @@ PlotData::~PlotData()
     delete m_plotCurve;
 }
 
+/**
+ * Give the curve access to the sample buffers, the curve takes ownership of the series
+ */
+void PlotData::setSeries(bool hasXData)
+{
+    m_plotSeries = new PlotSeriesData(hasXData ? &m_xDataEntries : NULL, &m_yDataEntries, &m_decimator);
+    m_plotCurve->setSamples(m_plotSeries);
+}
+
 bool PlotData::isVisible() const
 {
     return m_plotCurve->isVisible();
@@ -90,7 +256,8 @@ void PlotData::setVisible(bool visible)
 
 void PlotData::updatePlotData()
 {
-    m_plotCurve->setSamples(m_xDataEntries, m_yDataEntries);
+    m_plotSeries->invalidate();
+    m_plotCurve->itemChanged();
 }
 
 void PlotData::clear()
@@ -100,6 +267,7 @@ void PlotData::clear()
     m_correctionCount = 0;
     m_xDataEntries.clear();
     m_yDataEntries.clear();
+    m_decimator.clear();
     while (!m_enumMarkerList.isEmpty()) {
         QwtPlotMarker *marker = m_enumMarkerList.takeFirst();
         marker->detach();
@@ -113,7 +281,7 @@ void PlotData::clear()
 bool PlotData::hasData() const
 {
     if (!m_isEnumPlot) {
-        return !m_xDataEntries.isEmpty();
+        return !m_yDataEntries.isEmpty();
     } else {
         return !m_enumMarkerList.isEmpty();
     }
@@ -151,7 +319,7 @@ void PlotData::calcMathFunction(double currentValue)
     m_meanSum += currentValue;
     if (m_yDataHistory.size() > m_meanSamples) {
         m_meanSum -= m_yDataHistory.first();
-        m_yDataHistory.pop_front();
+        m_yDataHistory.removeFirst();
     }
     // make sure to correct the sum every meanSamples steps to prevent it
     // from running away due to floating point rounding errors
@@ -207,7 +375,12 @@ bool SequentialPlotData::append(UAVObject *obj)
 
     if (m_object == obj && m_field) {
         if (!m_isEnumPlot) {
-            double currentValue = m_field->getValue(m_element).toDouble() * pow(10, m_scalePower);
+            double currentValue = m_field->getDouble(m_element) * pow(10, m_scalePower);
+
+            // If new data overflows the window, remove old data, the x value of a point is its index
+            if (m_yDataEntries.isFull()) {
+                m_yDataEntries.removeFirst();
+            }
 
             // Perform scope math, if necessary
             if (m_mathFunction == "Boxcar average" || m_mathFunction == "Standard deviation") {
@@ -215,14 +388,6 @@ bool SequentialPlotData::append(UAVObject *obj)
             } else {
                 m_yDataEntries.append(currentValue);
             }
-
-            if (m_yDataEntries.size() > m_plotDataSize) {
-                // If new data overflows the window, remove old data...
-                m_yDataEntries.pop_front();
-            } else {
-                // ...otherwise, add a new y point at position xData
-                m_xDataEntries.insert(m_xDataEntries.size(), m_xDataEntries.size());
-            }
             return true;
         } else {
             // Enum markers
@@ -250,22 +415,17 @@ bool ChronoPlotData::append(UAVObject *obj)
     }
 
     if (m_object == obj && m_field) {
-        // Get the field of interest
-        // THINK ABOUT REIMPLEMENTING THIS TO SHOW UAVO TIME, NOT SYSTEM TIME
-        QDateTime NOW = QDateTime::currentDateTime();
+        if (!m_isEnumPlot && UAVObjectSampleStream::isSampleStream(obj)) {
+            appendStream(obj);
+            removeStaleData();
+            return true;
+        }
 
-        double xValue = NOW.toTime_t() + NOW.time().msec() / 1000.0;
+        // Updates timestamped by the board are plotted at their board time
+        qint64 timestamp = obj->getTimestamp();
+        double xValue    = (timestamp >= 0 && m_timeBase) ? m_timeBase->time(timestamp) : PlotTimeBase::currentTime();
         if (!m_isEnumPlot) {
-            double currentValue = m_field->getValue(m_element).toDouble() * pow(10, m_scalePower);
-
-            // Perform scope math, if necessary
-            if (m_mathFunction == "Boxcar average" || m_mathFunction == "Standard deviation") {
-                calcMathFunction(currentValue);
-            } else {
-                m_yDataEntries.append(currentValue);
-            }
-
-            m_xDataEntries.append(xValue);
+            appendValue(xValue, m_field->getDouble(m_element) * pow(10, m_scalePower));
         } else {
             // Enum markers
             QString value = m_field->getValue(m_element).toString();
@@ -287,12 +447,58 @@ bool ChronoPlotData::append(UAVObject *obj)
     return false;
 }
 
+void ChronoPlotData::appendValue(double xValue, double currentValue)
+{
+    // Perform scope math, if necessary
+    if (m_mathFunction == "Boxcar average" || m_mathFunction == "Standard deviation") {
+        calcMathFunction(currentValue);
+    } else {
+        m_yDataEntries.append(currentValue);
+    }
+
+    m_xDataEntries.append(xValue);
+    if (m_decimator.isEnabled()) {
+        m_decimator.append(xValue, m_yDataEntries.last());
+    }
+}
+
+/**
+ * Append every sample of a packed update of the field, whatever the element
+ * configured, at the time it was sampled
+ */
+void ChronoPlotData::appendStream(UAVObject *obj)
+{
+    m_stream.decode(obj);
+
+    const int samples = qMin(m_stream.count(), (int)m_field->getNumElements());
+    if (samples == 0) {
+        return;
+    }
+
+    // the first sample goes through the time base like any timestamped update
+    const double first = m_stream.time(0);
+    const double xFirst = m_timeBase ? m_timeBase->time((qint64)(first * 1000.0)) :
+                          PlotTimeBase::currentTime() - (m_stream.time(samples - 1) - first);
+    const double scale  = pow(10, m_scalePower);
+
+    for (int i = 0; i < samples; i++) {
+        appendValue(xFirst + (m_stream.time(i) - first), m_field->getDouble(i) * scale);
+    }
+}
+
 void ChronoPlotData::removeStaleData()
 {
     while (!m_xDataEntries.isEmpty() &&
            (m_xDataEntries.last() - m_xDataEntries.first()) > m_plotDataSize) {
-        m_yDataEntries.pop_front();
-        m_xDataEntries.pop_front();
+        m_yDataEntries.removeFirst();
+        m_xDataEntries.removeFirst();
+    }
+    if (m_decimator.isEnabled()) {
+        if (m_xDataEntries.isEmpty()) {
+            m_decimator.clear();
+        } else {
+            m_decimator.removeBefore(m_xDataEntries.first());
+        }
     }
     while (!m_enumMarkerList.isEmpty() &&
            (m_enumMarkerList.last()->xValue() - m_enumMarkerList.first()->xValue()) > m_plotDataSize) {
@@ -301,3 +507,181 @@ void ChronoPlotData::removeStaleData()
         delete marker;
     }
 }
+
+/**
+ * Set the column width of the decimator from the plot width in pixels,
+ * the columns are rebuilt from the samples when it changes.
+ */
+void ChronoPlotData::setDecimation(int plotWidth)
+{
+    if (plotWidth <= 0) {
+        return;
+    }
+    double columnWidth = m_plotDataSize / plotWidth;
+    if (columnWidth == m_decimator.columnWidth()) {
+        return;
+    }
+
+    m_decimator.setColumns(columnWidth, plotWidth);
+    for (int i = 0; i < m_xDataEntries.size(); i++) {
+        m_decimator.append(m_xDataEntries.at(i), m_yDataEntries.at(i));
+    }
+}
+
+SpectrumPlotData::SpectrumPlotData(UAVObject *object, UAVObjectField *field, int element,
+                                   int scaleFactor, int meanSamples, QString mathFunction,
+                                   double plotDataSize, QPen pen, bool antialiased,
+                                   int windowSize, int overlap)
+    : PlotData(object, field, element, scaleFactor, meanSamples,
+               mathFunction, plotDataSize, pen, antialiased),
+    m_windowSize(qMax(8, windowSize)), m_newSamples(0),
+    m_spectrumPending(false), m_discardSpectrum(false)
+{
+    m_hopSize = qMax(1, m_windowSize * (100 - qBound(0, overlap, 95)) / 100);
+    m_samples.setCapacity(m_windowSize);
+    m_sampleTimes.setCapacity(m_windowSize);
+    m_xDataEntries.setCapacity(m_windowSize / 2 + 1);
+    m_yDataEntries.setCapacity(m_windowSize / 2 + 1);
+    setSeries(true);
+
+    connect(&m_spectrumWatcher, SIGNAL(finished()), this, SLOT(spectrumFinished()));
+}
+
+SpectrumPlotData::~SpectrumPlotData()
+{
+    // The worker runs code of this plugin
+    m_spectrumWatcher.waitForFinished();
+}
+
+void SpectrumPlotData::appendSample(double time, double value)
+{
+    if (m_samples.isFull()) {
+        m_samples.removeFirst();
+        m_sampleTimes.removeFirst();
+    }
+    m_samples.append(value);
+    m_sampleTimes.append(time);
+    m_newSamples++;
+}
+
+bool SpectrumPlotData::append(UAVObject *obj)
+{
+    if (obj == NULL) {
+        obj = m_object;
+    }
+
+    if (m_object != obj || !m_field || m_isEnumPlot) {
+        return false;
+    }
+
+    if (m_stream.decode(obj)) {
+        // a sample per element, the sample rate is that of the board loop
+        const int samples = qMin(m_stream.count(), (int)m_field->getNumElements());
+        for (int i = 0; i < samples; i++) {
+            appendSample(m_stream.time(i), m_field->getDouble(i) * pow(10, m_scalePower));
+        }
+    } else {
+        qint64 timestamp = obj->getTimestamp();
+        double time = (timestamp >= 0) ? timestamp / 1000.0 : PlotTimeBase::currentTime();
+        appendSample(time, m_field->getDouble(m_element) * pow(10, m_scalePower));
+    }
+
+    if (!m_spectrumPending && m_newSamples >= m_hopSize && m_samples.isFull()) {
+        startSpectrum();
+    }
+    return true;
+}
+
+void SpectrumPlotData::clear()
+{
+    m_samples.clear();
+    m_sampleTimes.clear();
+    m_newSamples = 0;
+    m_discardSpectrum = m_spectrumPending;
+    PlotData::clear();
+}
+
+QString SpectrumPlotData::lastDataAsString()
+{
+    // The samples are logged, not the spectrum
+    return m_samples.isEmpty() ? QString() : QString().sprintf("%3.10g", m_samples.last());
+}
+
+void SpectrumPlotData::startSpectrum()
+{
+    double period = m_sampleTimes.last() - m_sampleTimes.first();
+
+    m_newSamples = 0;
+    // the board time went back, wait for a window of the new time
+    if (period <= 0.0) {
+        return;
+    }
+
+    QVector<double> samples(m_samples.size());
+    for (int i = 0; i < m_samples.size(); i++) {
+        samples[i] = m_samples.at(i);
+    }
+    m_spectrumPending = true;
+    m_spectrumWatcher.setFuture(QtConcurrent::run(&SpectrumPlotData::computeSpectrum, samples, (samples.size() - 1) / period));
+}
+
+void SpectrumPlotData::spectrumFinished()
+{
+    m_spectrumPending = false;
+    if (m_discardSpectrum) {
+        m_discardSpectrum = false;
+    } else {
+        Spectrum spectrum = m_spectrumWatcher.result();
+        m_xDataEntries.clear();
+        m_yDataEntries.clear();
+        for (int i = 0; i < spectrum.amplitudes.size(); i++) {
+            m_xDataEntries.append(i * spectrum.binWidth);
+            m_yDataEntries.append(spectrum.amplitudes.at(i));
+        }
+    }
+
+    // Catch up with the samples received meanwhile
+    if (m_newSamples >= m_hopSize && m_samples.isFull()) {
+        startSpectrum();
+    }
+}
+
+/**
+ * Single sided amplitude spectrum of samples, in the units of the samples.
+ * The mean is removed so the DC bin doesn't dwarf the vibrations, and a Hann
+ * window limits the leakage, its gain is corrected for.
+ * Runs on a worker thread.
+ */
+SpectrumPlotData::Spectrum SpectrumPlotData::computeSpectrum(QVector<double> samples, double sampleRate)
+{
+    int size    = samples.size();
+    double mean = 0.0;
+
+    for (int i = 0; i < size; i++) {
+        mean += samples.at(i);
+    }
+    mean /= size;
+
+    std::vector<double> windowed(size);
+    double windowSum = 0.0;
+    for (int i = 0; i < size; i++) {
+        double window = 0.5 - 0.5 * cos(2.0 * M_PI * i / (size - 1));
+        windowed[i] = (samples.at(i) - mean) * window;
+        windowSum  += window;
+    }
+
+    Eigen::FFT<double> fft;
+    fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+    std::vector<std::complex<double> > bins;
+    fft.fwd(bins, windowed);
+
+    Spectrum spectrum;
+    spectrum.binWidth = sampleRate / size;
+    spectrum.amplitudes.resize(bins.size());
+    for (int i = 0; i < (int)bins.size(); i++) {
+        // the DC and Nyquist bins are not folded
+        double scale = (i == 0 || 2 * i == size) ? 1.0 : 2.0;
+        spectrum.amplitudes[i] = scale * std::abs(bins[i]) / windowSum;
+    }
+    return spectrum;
+}
@@ -36,16 +36,192 @@
 #include "qwt/src/qwt_scale_draw.h"
 #include "qwt/src/qwt_scale_widget.h"
 #include <qwt/src/qwt_plot_marker.h>
+#include <qwt/src/qwt_series_data.h>
 
+#include <QContiguousCache>
+#include <QFutureWatcher>
 #include <QTimer>
 #include <QTime>
 #include <QVector>
 #include <uavdataobject.h>
+#include <uavobjectsamplestream.h>
 
 /*!
    \brief Defines the different type of plots.
  */
-enum PlotType { SequentialPlot, ChronoPlot };
+enum PlotType { SequentialPlot, ChronoPlot, SpectrumPlot };
+
+/*!
+   \brief Circular buffer of samples, appending and removing the oldest sample are O(1).
+   The buffer keeps its capacity, it only grows when appending to a full buffer.
+ */
+class PlotBuffer {
+public:
+    PlotBuffer() : m_first(0), m_size(0) {}
+
+    void setCapacity(int capacity);
+    int capacity() const
+    {
+        return m_data.size();
+    }
+    int size() const
+    {
+        return m_size;
+    }
+    bool isEmpty() const
+    {
+        return m_size == 0;
+    }
+    bool isFull() const
+    {
+        return m_size == m_data.size();
+    }
+
+    double at(int i) const
+    {
+        int index = m_first + i;
+
+        if (index >= m_data.size()) {
+            index -= m_data.size();
+        }
+        return m_data.at(index);
+    }
+    double first() const
+    {
+        return m_data.at(m_first);
+    }
+    double last() const
+    {
+        return at(m_size - 1);
+    }
+
+    void append(double value);
+    void removeFirst();
+    void clear();
+
+private:
+    QVector<double> m_data;
+    int m_first;
+    int m_size;
+};
+
+/*!
+   \brief Level of detail of a curve, one column per pixel of the plot width.
+   A column keeps the first, smallest, largest and last of the samples falling in it,
+   drawn in time order they light the same pixels as all the samples of the column.
+   Columns are updated as samples are appended, the oldest ones drop out of the window.
+ */
+class PlotDecimator {
+public:
+    PlotDecimator() : m_columnWidth(0.0) {}
+
+    void setColumns(double columnWidth, int columns);
+    bool isEnabled() const
+    {
+        return m_columnWidth > 0.0;
+    }
+    double columnWidth() const
+    {
+        return m_columnWidth;
+    }
+
+    void append(double x, double y);
+    void removeBefore(double x);
+    void clear()
+    {
+        m_columns.clear();
+    }
+
+    int pointCount() const
+    {
+        return m_columns.count() * POINTS_PER_COLUMN;
+    }
+    QPointF point(int i) const;
+
+private:
+    static const int POINTS_PER_COLUMN = 4;
+
+    typedef struct {
+        qint64  index;
+        QPointF first;
+        QPointF min;
+        QPointF max;
+        QPointF last;
+    } Column;
+
+    double m_columnWidth;
+    QContiguousCache<Column> m_columns;
+};
+
+/*!
+   \brief Maps the board time of timestamped object updates to the time axis of chrono plots.
+   The board time is anchored to the wall clock at the first timestamped update, and followed
+   from there so the curves keep the board timing when the link is late or a log is replayed.
+ */
+class PlotTimeBase {
+public:
+    PlotTimeBase() : m_anchorTimestamp(-1), m_anchorTime(0.0), m_lastTimestamp(-1), m_lastTime(0.0) {}
+
+    double time(qint64 timestamp);
+    bool isValid() const
+    {
+        return m_anchorTimestamp >= 0;
+    }
+    double lastTime() const
+    {
+        return m_lastTime;
+    }
+    void reset()
+    {
+        m_anchorTimestamp = -1;
+        m_lastTimestamp   = -1;
+    }
+
+    static double currentTime();
+
+private:
+    // board time going back by more than this (ms) is a board reset or another log
+    static const qint64 RESTART_THRESHOLD = 1000;
+
+    qint64 m_anchorTimestamp;
+    double m_anchorTime;
+    qint64 m_lastTimestamp;
+    double m_lastTime;
+};
+
+/*!
+   \brief Gives Qwt access to the samples of a curve without copying them.
+   Without x buffer, the x value of a sample is its index.
+   With an enabled decimator, its columns are drawn instead of the samples when they are fewer.
+ */
+class PlotSeriesData : public QwtSeriesData<QPointF> {
+public:
+    PlotSeriesData(const PlotBuffer *xData, const PlotBuffer *yData, const PlotDecimator *decimator = NULL)
+        : m_xData(xData), m_yData(yData), m_decimator(decimator)
+    {
+        invalidate();
+    }
+
+    size_t size() const;
+    QPointF sample(size_t i) const;
+    QRectF boundingRect() const;
+
+    // Must be called when the buffers were modified
+    void invalidate()
+    {
+        d_boundingRect = QRectF(0.0, 0.0, -1.0, -1.0);
+    }
+
+private:
+    const PlotBuffer *m_xData;
+    const PlotBuffer *m_yData;
+    const PlotDecimator *m_decimator;
+
+    bool isDecimated() const
+    {
+        return m_decimator && m_decimator->isEnabled() && m_decimator->pointCount() < m_yData->size();
+    }
+};
 
 /*!
    \brief Base class that keeps the data for each curve in the plot.
@@ -91,12 +267,17 @@ public:
     virtual bool append(UAVObject *obj) = 0;
     virtual PlotType plotType() const   = 0;
     virtual void removeStaleData() = 0;
+    // Draw at most one min/max column per pixel of the plot width, if supported by the plot type
+    virtual void setDecimation(int plotWidth)
+    {
+        Q_UNUSED(plotWidth);
+    }
 
     void updatePlotData();
-    void clear();
+    virtual void clear();
 
     bool hasData() const;
-    QString lastDataAsString();
+    virtual QString lastDataAsString();
 
     void attach(QwtPlot *plot);
 
@@ -113,9 +294,11 @@ protected:
     int m_correctionCount;
     double m_plotDataSize;
 
-    QVector<double> m_xDataEntries;
-    QVector<double> m_yDataEntries;
-    QVector<double> m_yDataHistory;
+    PlotBuffer m_xDataEntries;
+    PlotBuffer m_yDataEntries;
+    PlotBuffer m_yDataHistory;
+    PlotDecimator m_decimator;
+    PlotSeriesData *m_plotSeries;
 
     UAVObject *m_object;
     UAVObjectField *m_field;
@@ -127,6 +310,7 @@ protected:
     bool m_isVisible;
     QPen m_pen;
     bool m_isEnumPlot;
+    void setSeries(bool hasXData);
     virtual void calcMathFunction(double currentValue);
     QwtPlotMarker *createMarker(QString value);
 };
@@ -142,7 +326,11 @@ public:
                        int scaleFactor, int meanSamples, QString mathFunction,
                        double plotDataSize, QPen pen, bool antialiased)
         : PlotData(object, field, element, scaleFactor, meanSamples,
-                   mathFunction, plotDataSize, pen, antialiased) {}
+                   mathFunction, plotDataSize, pen, antialiased)
+    {
+        m_yDataEntries.setCapacity(qMax(1, (int)plotDataSize));
+        setSeries(false);
+    }
     ~SequentialPlotData() {}
 
     bool append(UAVObject *obj);
@@ -161,10 +349,14 @@ class ChronoPlotData : public PlotData {
 public:
     ChronoPlotData(UAVObject *object, UAVObjectField *field, int element,
                    int scaleFactor, int meanSamples, QString mathFunction,
-                   double plotDataSize, QPen pen, bool antialiased)
+                   double plotDataSize, QPen pen, bool antialiased, PlotTimeBase *timeBase)
         : PlotData(object, field, element, scaleFactor, meanSamples,
-                   mathFunction, plotDataSize, pen, antialiased)
-    {}
+                   mathFunction, plotDataSize, pen, antialiased), m_timeBase(timeBase)
+    {
+        m_xDataEntries.setCapacity(INITIAL_CAPACITY);
+        m_yDataEntries.setCapacity(INITIAL_CAPACITY);
+        setSeries(true);
+    }
     ~ChronoPlotData() {}
 
     bool append(UAVObject *obj);
@@ -173,6 +365,70 @@ public:
         return ChronoPlot;
     }
     void removeStaleData();
+    void setDecimation(int plotWidth);
+
+private:
+    // The buffers grow to the number of samples received during the plot period
+    static const int INITIAL_CAPACITY = 1024;
+
+    // Shared by the curves of a plot, so they are drawn on the same board time
+    PlotTimeBase *m_timeBase;
+    // Objects packing several samples into an update are plotted a sample per element
+    UAVObjectSampleStream m_stream;
+
+    void appendValue(double xValue, double currentValue);
+    void appendStream(UAVObject *obj);
+};
+
+/*!
+   \brief The spectrum plot shows the amplitude spectrum of the last window of samples.
+   The spectrum is computed on a worker thread each time the window moved by its
+   non overlapping part, windows completed while the previous one is computed are skipped.
+   The x values are frequencies in Hz, from the sample rate measured over the window.
+ */
+class SpectrumPlotData : public PlotData {
+    Q_OBJECT
+public:
+    SpectrumPlotData(UAVObject *object, UAVObjectField *field, int element,
+                     int scaleFactor, int meanSamples, QString mathFunction,
+                     double plotDataSize, QPen pen, bool antialiased,
+                     int windowSize, int overlap);
+    ~SpectrumPlotData();
+
+    bool append(UAVObject *obj);
+    PlotType plotType() const
+    {
+        return SpectrumPlot;
+    }
+    void removeStaleData() {}
+    void clear();
+    QString lastDataAsString();
+
+private slots:
+    void spectrumFinished();
+
+private:
+    typedef struct {
+        double binWidth;
+        QVector<double> amplitudes;
+    } Spectrum;
+
+    int m_windowSize;
+    // Samples added since the last computed window
+    int m_newSamples;
+    int m_hopSize;
+    PlotBuffer m_samples;
+    // In seconds, board time for timestamped updates
+    PlotBuffer m_sampleTimes;
+    QFutureWatcher<Spectrum> m_spectrumWatcher;
+    bool m_spectrumPending;
+    UAVObjectSampleStream m_stream;
+    // Set when the data was cleared while a spectrum was computed
+    bool m_discardSpectrum;
+
+    void startSpectrum();
+    void appendSample(double time, double value);
+    static Spectrum computeSpectrum(QVector<double> samples, double sampleRate);
 };
 
 #endif // PLOTDATA_H
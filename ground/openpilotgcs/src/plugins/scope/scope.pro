@@ -3,9 +3,13 @@ TARGET = ScopeGadget
 
 DEFINES += SCOPE_LIBRARY
 
+QT += concurrent opengl
+
 include(../../openpilotgcsplugin.pri)
 include (scope_dependencies.pri)
 
+INCLUDEPATH += ../../libs/eigen
+
 HEADERS += \
     scopeplugin.h \
     plotdata.h \
@@ -48,13 +48,19 @@ void ScopeGadget::loadConfiguration(IUAVGadgetConfiguration *config)
     ScopeGadgetWidget *widget = qobject_cast<ScopeGadgetWidget *>(m_widget);
 
     widget->setObjectName(config->name());
+    widget->setOpenGL(sgConfig->openGL());
     widget->setPlotDataSize(sgConfig->dataSize());
     widget->setRefreshInterval(sgConfig->refreshInterval());
+    widget->setDecimation(sgConfig->decimation());
+    widget->setSpectrumWindow(sgConfig->spectrumWindow());
+    widget->setSpectrumOverlap(sgConfig->spectrumOverlap());
 
     if (sgConfig->plotType() == SequentialPlot) {
         widget->setupSequentialPlot();
     } else if (sgConfig->plotType() == ChronoPlot) {
         widget->setupChronoPlot();
+    } else if (sgConfig->plotType() == SpectrumPlot) {
+        widget->setupSpectrumPlot();
     }
 
     foreach(PlotCurveConfiguration * plotCurveConfig, sgConfig->plotCurveConfigs()) {
@@ -107,3 +113,13 @@ void ScopeGadget::restoreState(QSettings *qSettings)
 {
     m_widget->restoreState(qSettings);
 }
+
+void ScopeGadget::suspend()
+{
+    m_widget->setSuspended(true);
+}
+
+void ScopeGadget::resume()
+{
+    m_widget->setSuspended(false);
+}
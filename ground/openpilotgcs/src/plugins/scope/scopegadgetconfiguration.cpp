@@ -32,6 +32,10 @@ ScopeGadgetConfiguration::ScopeGadgetConfiguration(QString classId, QSettings *q
     m_plotType((int)ChronoPlot),
     m_dataSize(60),
     m_refreshInterval(1000),
+    m_decimation(true),
+    m_spectrumWindow(512),
+    m_spectrumOverlap(50),
+    m_openGL(false),
     m_mathFunctionType(0)
 {
     uint currentStreamVersion = 0;
@@ -49,6 +53,10 @@ ScopeGadgetConfiguration::ScopeGadgetConfiguration(QString classId, QSettings *q
         m_plotType        = qSettings->value("plotType").toInt();
         m_dataSize        = qSettings->value("dataSize").toInt();
         m_refreshInterval = qSettings->value("refreshInterval").toInt();
+        m_decimation      = qSettings->value("decimation", true).toBool();
+        m_spectrumWindow  = qSettings->value("spectrumWindow", 512).toInt();
+        m_spectrumOverlap = qSettings->value("spectrumOverlap", 50).toInt();
+        m_openGL          = qSettings->value("openGL", false).toBool();
         plotCurveCount    = qSettings->value("plotCurveCount").toInt();
 
         for (int plotDatasLoadIndex = 0; plotDatasLoadIndex < plotCurveCount; plotDatasLoadIndex++) {
@@ -102,6 +110,10 @@ IUAVGadgetConfiguration *ScopeGadgetConfiguration::clone()
     m->setDataSize(m_dataSize);
     m->setMathFunctionType(m_mathFunctionType);
     m->setRefreashInterval(m_refreshInterval);
+    m->setDecimation(m_decimation);
+    m->setSpectrumWindow(m_spectrumWindow);
+    m->setSpectrumOverlap(m_spectrumOverlap);
+    m->setOpenGL(m_openGL);
 
     plotCurveCount = m_plotCurveConfigs.size();
 
@@ -143,6 +155,10 @@ void ScopeGadgetConfiguration::saveConfig(QSettings *qSettings) const
     qSettings->setValue("plotType", m_plotType);
     qSettings->setValue("dataSize", m_dataSize);
     qSettings->setValue("refreshInterval", m_refreshInterval);
+    qSettings->setValue("decimation", m_decimation);
+    qSettings->setValue("spectrumWindow", m_spectrumWindow);
+    qSettings->setValue("spectrumOverlap", m_spectrumOverlap);
+    qSettings->setValue("openGL", m_openGL);
     qSettings->setValue("plotCurveCount", plotCurveCount);
 
     for (plotDatasLoadIndex = 0; plotDatasLoadIndex < plotCurveCount; plotDatasLoadIndex++) {
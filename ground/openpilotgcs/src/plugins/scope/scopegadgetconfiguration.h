@@ -71,6 +71,22 @@ public:
     {
         m_refreshInterval = value;
     }
+    void setDecimation(bool value)
+    {
+        m_decimation = value;
+    }
+    void setSpectrumWindow(int value)
+    {
+        m_spectrumWindow = value;
+    }
+    void setSpectrumOverlap(int value)
+    {
+        m_spectrumOverlap = value;
+    }
+    void setOpenGL(bool value)
+    {
+        m_openGL = value;
+    }
     void addPlotCurveConfig(PlotCurveConfiguration *value)
     {
         m_plotCurveConfigs.append(value);
@@ -94,6 +110,22 @@ public:
     {
         return m_refreshInterval;
     }
+    bool decimation()
+    {
+        return m_decimation;
+    }
+    int spectrumWindow()
+    {
+        return m_spectrumWindow;
+    }
+    int spectrumOverlap()
+    {
+        return m_spectrumOverlap;
+    }
+    bool openGL()
+    {
+        return m_openGL;
+    }
     QList<PlotCurveConfiguration *> plotCurveConfigs()
     {
         return m_plotCurveConfigs;
@@ -137,6 +169,13 @@ private:
     int m_dataSize;
     // The interval to replot the curve widget. The data buffer is refresh as the data comes in.
     int m_refreshInterval;
+    // Draw long chrono plots from per pixel min/max columns instead of all the samples
+    bool m_decimation;
+    // The number of samples and the overlap in percent of the spectrum plot windows
+    int m_spectrumWindow;
+    int m_spectrumOverlap;
+    // Draw the plot on an OpenGL canvas instead of the raster one
+    bool m_openGL;
     // The type of math function to be used in the scope analysis
     int m_mathFunctionType;
     QList<PlotCurveConfiguration *> m_plotCurveConfigs;
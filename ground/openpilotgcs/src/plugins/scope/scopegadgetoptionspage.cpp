@@ -55,6 +55,11 @@ QWidget *ScopeGadgetOptionsPage::createPage(QWidget *parent)
 
     options_page->cmbPlotType->addItem("Sequential Plot", "");
     options_page->cmbPlotType->addItem("Chronological Plot", "");
+    options_page->cmbPlotType->addItem("Spectrum Plot", "");
+
+    for (int windowSize = 64; windowSize <= 4096; windowSize *= 2) {
+        options_page->cmbSpectrumWindow->addItem(QString("%1 samples").arg(windowSize), windowSize);
+    }
 
     // Fills the combo boxes for the UAVObjects
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
@@ -100,6 +105,11 @@ QWidget *ScopeGadgetOptionsPage::createPage(QWidget *parent)
     options_page->mathFunctionComboBox->setCurrentIndex(m_config->mathFunctionType());
     options_page->spnDataSize->setValue(m_config->dataSize());
     options_page->spnRefreshInterval->setValue(m_config->refreshInterval());
+    options_page->decimationCheckBox->setChecked(m_config->decimation());
+    int spectrumWindowIndex = options_page->cmbSpectrumWindow->findData(m_config->spectrumWindow());
+    options_page->cmbSpectrumWindow->setCurrentIndex(spectrumWindowIndex >= 0 ? spectrumWindowIndex : 3);
+    options_page->spnSpectrumOverlap->setValue(m_config->spectrumOverlap());
+    options_page->openGLCheckBox->setChecked(m_config->openGL());
 
     // add the configured curves
     foreach(PlotCurveConfiguration * plotData, m_config->plotCurveConfigs()) {
@@ -124,6 +134,8 @@ QWidget *ScopeGadgetOptionsPage::createPage(QWidget *parent)
     connect(options_page->btnColor, SIGNAL(clicked()), this, SLOT(on_btnColor_clicked()));
     connect(options_page->mathFunctionComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(on_mathFunctionComboBox_currentIndexChanged(int)));
     connect(options_page->spnRefreshInterval, SIGNAL(valueChanged(int)), this, SLOT(on_spnRefreshInterval_valueChanged(int)));
+    connect(options_page->cmbPlotType, SIGNAL(currentIndexChanged(int)), this, SLOT(on_cmbPlotType_currentIndexChanged(int)));
+    on_cmbPlotType_currentIndexChanged(options_page->cmbPlotType->currentIndex());
 
     setYAxisWidgetFromPlotCurve();
 
@@ -175,6 +187,16 @@ void ScopeGadgetOptionsPage::on_mathFunctionComboBox_currentIndexChanged(int cur
     }
 }
 
+void ScopeGadgetOptionsPage::on_cmbPlotType_currentIndexChanged(int currentIndex)
+{
+    bool spectrum = currentIndex == SpectrumPlot;
+
+    options_page->cmbSpectrumWindow->setEnabled(spectrum);
+    options_page->spnSpectrumOverlap->setEnabled(spectrum);
+    options_page->spnDataSize->setEnabled(!spectrum);
+    options_page->decimationCheckBox->setEnabled(currentIndex == ChronoPlot);
+}
+
 void ScopeGadgetOptionsPage::on_btnColor_clicked()
 {
     QColor color = QColorDialog::getColor(QColor(options_page->btnColor->text()));
@@ -275,6 +297,10 @@ void ScopeGadgetOptionsPage::apply()
     m_config->setMathFunctionType(options_page->mathFunctionComboBox->currentIndex());
     m_config->setDataSize(options_page->spnDataSize->value());
     m_config->setRefreashInterval(options_page->spnRefreshInterval->value());
+    m_config->setDecimation(options_page->decimationCheckBox->isChecked());
+    m_config->setSpectrumWindow(options_page->cmbSpectrumWindow->itemData(options_page->cmbSpectrumWindow->currentIndex()).toInt());
+    m_config->setSpectrumOverlap(options_page->spnSpectrumOverlap->value());
+    m_config->setOpenGL(options_page->openGLCheckBox->isChecked());
 
     QList<PlotCurveConfiguration *> plotCurveConfigs;
     for (int iIndex = 0; iIndex < options_page->lstCurves->count(); iIndex++) {
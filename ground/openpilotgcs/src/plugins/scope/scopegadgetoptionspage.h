@@ -73,6 +73,7 @@ private:
 
 private slots:
     void on_spnRefreshInterval_valueChanged(int);
+    void on_cmbPlotType_currentIndexChanged(int currentIndex);
     void on_lstCurves_currentRowChanged(int currentRow);
     void on_btnRemoveCurve_clicked();
     void on_btnAddCurve_clicked();
@@ -56,14 +56,17 @@
 
 #include <qwt/src/qwt_legend_label.h>
 #include <qwt/src/qwt_plot_canvas.h>
+#include <qwt/src/qwt_plot_glcanvas.h>
 #include <qwt/src/qwt_plot_layout.h>
 
 ScopeGadgetWidget::ScopeGadgetWidget(QWidget *parent) : QwtPlot(parent),
+    m_decimation(false), m_spectrumWindow(512), m_spectrumOverlap(50),
     m_csvLoggingStarted(false), m_csvLoggingEnabled(false),
     m_csvLoggingHeaderSaved(false), m_csvLoggingDataSaved(false),
     m_csvLoggingNameSet(false), m_csvLoggingDataValid(false),
     m_csvLoggingDataUpdated(false), m_csvLoggingConnected(false),
     m_csvLoggingNewFileOnConnect(false),
+    m_suspended(false), m_plotting(false),
     m_csvLoggingStartTime(QDateTime::currentDateTime()),
     m_csvLoggingPath("./csvlogging/"),
     m_plotLegend(NULL)
@@ -98,6 +101,27 @@ ScopeGadgetWidget::ScopeGadgetWidget(QWidget *parent) : QwtPlot(parent),
     connect(this, SIGNAL(customContextMenuRequested(const QPoint &)), this, SLOT(popUpMenu(const QPoint &)));
 }
 
+/*!
+   \brief Draws the plot on an OpenGL canvas, or on the default raster canvas.
+   The curves are drawn by the GL paint engine from the same zero copy series data,
+   so several scopes refreshing quickly no longer load the CPU with rasterizing.
+ */
+void ScopeGadgetWidget::setOpenGL(bool openGL)
+{
+    if (openGL) {
+        if (!qobject_cast<QwtPlotGLCanvas *>(canvas())) {
+            QwtPlotGLCanvas *glCanvas = new QwtPlotGLCanvas();
+            glCanvas->setFrameStyle(QFrame::StyledPanel | QFrame::Sunken);
+            setCanvas(glCanvas);
+        }
+    } else if (!qobject_cast<QwtPlotCanvas *>(canvas())) {
+        QwtPlotCanvas *plotCanvas = new QwtPlotCanvas();
+        plotCanvas->setFrameStyle(QFrame::StyledPanel | QFrame::Sunken);
+        plotCanvas->setBorderRadius(8);
+        setCanvas(plotCanvas);
+    }
+}
+
 ScopeGadgetWidget::~ScopeGadgetWidget()
 {
     if (replotTimer) {
@@ -194,7 +218,10 @@ void ScopeGadgetWidget::showEvent(QShowEvent *e)
  */
 void ScopeGadgetWidget::startPlotting()
 {
-    if (replotTimer && !replotTimer->isActive()) {
+    m_plotting = true;
+    if (replotTimer && !replotTimer->isActive() && !m_suspended) {
+        // the board time starts afresh on each connection
+        m_timeBase.reset();
         foreach(PlotData * plot, m_curvesData.values()) {
             if (plot->wantsInitialData()) {
                 plot->append(NULL);
@@ -206,11 +233,50 @@ void ScopeGadgetWidget::startPlotting()
 
 void ScopeGadgetWidget::stopPlotting()
 {
+    m_plotting = false;
     if (replotTimer) {
         replotTimer->stop();
     }
 }
 
+/**
+ * Suspends the plot while its workspace is hidden.
+ * The object updates are unsubscribed unless they are logged, and the replot timer is stopped.
+ * Plotting resumes fresh, without the data of the hidden period.
+ */
+void ScopeGadgetWidget::setSuspended(bool suspended)
+{
+    if (m_suspended == suspended) {
+        return;
+    }
+    m_suspended = suspended;
+
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    foreach(QString uavObjName, m_connectedUAVObjects) {
+        UAVDataObject *obj = dynamic_cast<UAVDataObject *>(objManager->getObject(uavObjName));
+        if (!obj) {
+            continue;
+        }
+        if (!suspended) {
+            connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(uavObjectReceived(UAVObject *)), Qt::UniqueConnection);
+        } else if (!m_csvLoggingStarted) {
+            disconnect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(uavObjectReceived(UAVObject *)));
+        }
+    }
+
+    if (suspended) {
+        if (replotTimer) {
+            replotTimer->stop();
+        }
+    } else {
+        clearPlot();
+        if (m_plotting) {
+            startPlotting();
+        }
+    }
+}
+
 void ScopeGadgetWidget::deleteLegend()
 {
     if (m_plotLegend) {
@@ -272,7 +338,9 @@ void ScopeGadgetWidget::preparePlot(PlotType plotType)
     // Only start the timer if we are already connected
     Core::ConnectionManager *cm = Core::ICore::instance()->connectionManager();
     if (cm->isConnected() && replotTimer) {
-        if (!replotTimer->isActive()) {
+        // a suspended plot starts on resume
+        m_plotting = true;
+        if (!replotTimer->isActive() && !m_suspended) {
             replotTimer->start(m_refreshInterval);
         } else {
             replotTimer->setInterval(m_refreshInterval);
@@ -331,6 +399,23 @@ void ScopeGadgetWidget::setupChronoPlot()
     setAxisFont(QwtPlot::yLeft, fnt); // y-axis
 }
 
+void ScopeGadgetWidget::setupSpectrumPlot()
+{
+    preparePlot(SpectrumPlot);
+
+    // The frequency range depends on the sample rate of the curves
+    setAxisScaleDraw(QwtPlot::xBottom, new QwtScaleDraw());
+    setAxisAutoScale(QwtPlot::xBottom, true);
+    setAxisLabelRotation(QwtPlot::xBottom, 0.0);
+    setAxisLabelAlignment(QwtPlot::xBottom, Qt::AlignLeft | Qt::AlignBottom);
+
+    // reduce the axis font size
+    QFont fnt(axisFont(QwtPlot::xBottom));
+    fnt.setPointSize(7);
+    setAxisFont(QwtPlot::xBottom, fnt); // x-axis
+    setAxisFont(QwtPlot::yLeft, fnt); // y-axis
+}
+
 void ScopeGadgetWidget::addCurvePlot(QString objectName, QString fieldPlusSubField, int scaleFactor,
                                      int meanSamples, QString mathFunction, QPen pen, bool antialiased)
 {
@@ -378,7 +463,11 @@ void ScopeGadgetWidget::addCurvePlot(QString objectName, QString fieldPlusSubFie
     } else if (m_plotType == ChronoPlot) {
         plotData = new ChronoPlotData(object, field, element, scaleFactor,
                                       meanSamples, mathFunction, m_plotDataSize,
-                                      pen, antialiased);
+                                      pen, antialiased, &m_timeBase);
+    } else if (m_plotType == SpectrumPlot) {
+        plotData = new SpectrumPlotData(object, field, element, scaleFactor,
+                                        meanSamples, mathFunction, m_plotDataSize,
+                                        pen, antialiased, m_spectrumWindow, m_spectrumOverlap);
     }
     connect(this, SIGNAL(visibilityChanged(QwtPlotItem *)), plotData, SLOT(visibilityChanged(QwtPlotItem *)));
     plotData->attach(this);
@@ -416,12 +505,14 @@ void ScopeGadgetWidget::replotNewData()
     QMutexLocker locker(&m_mutex);
     foreach(PlotData * plotData, m_curvesData.values()) {
         plotData->removeStaleData();
+        if (m_decimation) {
+            plotData->setDecimation(canvas()->contentsRect().width());
+        }
         plotData->updatePlotData();
     }
 
-    QDateTime NOW = QDateTime::currentDateTime();
-    double toTime = NOW.toTime_t();
-    toTime += NOW.time().msec() / 1000.0;
+    // The time axis follows the board time once timestamped updates come in
+    double toTime = m_timeBase.isValid() ? m_timeBase.lastTime() : PlotTimeBase::currentTime();
     if (m_plotType == ChronoPlot) {
         setAxisScale(QwtPlot::xBottom, toTime - m_plotDataSize, toTime);
     }
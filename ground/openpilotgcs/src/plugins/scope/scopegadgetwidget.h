@@ -71,6 +71,7 @@ public:
 
     void setupSequentialPlot();
     void setupChronoPlot();
+    void setupSpectrumPlot();
     void setupUAVObjectPlot();
     PlotType plotType()
     {
@@ -93,6 +94,20 @@ public:
     {
         return m_refreshInterval;
     }
+    void setDecimation(bool decimation)
+    {
+        m_decimation = decimation;
+    }
+    void setSpectrumWindow(int spectrumWindow)
+    {
+        m_spectrumWindow = spectrumWindow;
+    }
+    void setSpectrumOverlap(int spectrumOverlap)
+    {
+        m_spectrumOverlap = spectrumOverlap;
+    }
+    void setOpenGL(bool openGL);
+    void setSuspended(bool suspended);
 
 
     void addCurvePlot(QString uavObject, QString uavFieldSubField, int scaleOrderFactor = 0, int meanSamples = 1,
@@ -151,6 +166,10 @@ private:
 
     double m_plotDataSize;
     int m_refreshInterval;
+    bool m_decimation;
+    int m_spectrumWindow;
+    int m_spectrumOverlap;
+    PlotTimeBase m_timeBase;
     QList<QString> m_connectedUAVObjects;
     QMap<QString, PlotData *> m_curvesData;
 
@@ -165,6 +184,9 @@ private:
     bool m_csvLoggingDataUpdated;
     bool m_csvLoggingConnected;
     bool m_csvLoggingNewFileOnConnect;
+    // While the workspace is hidden the plot neither receives nor replots data
+    bool m_suspended;
+    bool m_plotting;
 
     QDateTime m_csvLoggingStartTime;
 
@@ -4,9 +4,11 @@ include(../../openpilotgcsplugin.pri)
 include(serial_dependencies.pri)
 QT += serialport
 HEADERS += serialplugin.h \
+            vcpconnection.h \
             serialpluginconfiguration.h \
             serialpluginoptionspage.h
 SOURCES += serialplugin.cpp \
+            vcpconnection.cpp \
             serialpluginconfiguration.cpp \
             serialpluginoptionspage.cpp
 FORMS += \ 
@@ -26,6 +26,7 @@
  */
 
 #include "serialplugin.h"
+#include "vcpconnection.h"
 
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/icore.h>
@@ -40,13 +41,24 @@ SerialEnumerationThread::SerialEnumerationThread(SerialConnection *serial)
     : m_serial(serial), m_running(false)
 {}
 
+// all the ports, including the board ports listed by the VCP connection
+static QStringList portNames()
+{
+    QStringList names;
+
+    foreach(QSerialPortInfo port, SerialConnection::availablePorts()) {
+        names << port.portName();
+    }
+    return names;
+}
+
 void SerialEnumerationThread::run()
 {
     m_running = true;
-    QList <Core::IConnection::device> devices = m_serial->availableDevices();
+    QStringList devices = portNames();
     while (m_running) {
         if (!m_serial->deviceOpened()) {
-            QList <Core::IConnection::device> newDev = m_serial->availableDevices();
+            QStringList newDev = portNames();
             if (devices != newDev) {
                 devices = newDev;
                 emit enumerationChanged();
@@ -144,6 +156,9 @@ QList <Core::IConnection::device> SerialConnection::availableDevices()
         // sort the list by port number (nice idea from PT_Dreamer :))
         qSort(ports.begin(), ports.end(), sortPorts);
         foreach(QSerialPortInfo port, ports) {
+            if (VcpConnection::isBoardPort(port)) {
+                continue;
+            }
             device d;
 
             d.displayName = port.portName();
@@ -220,7 +235,7 @@ void SerialConnection::resumePolling()
     enablePolling = true;
 }
 
-SerialPlugin::SerialPlugin() : m_connection(0)
+SerialPlugin::SerialPlugin() : m_connection(0), m_vcpConnection(0)
 {}
 
 SerialPlugin::~SerialPlugin()
@@ -231,13 +246,15 @@ SerialPlugin::~SerialPlugin()
 void SerialPlugin::extensionsInitialized()
 {
     addAutoReleasedObject(m_connection);
+    addAutoReleasedObject(m_vcpConnection);
 }
 
 bool SerialPlugin::initialize(const QStringList &arguments, QString *errorString)
 {
     Q_UNUSED(arguments);
     Q_UNUSED(errorString);
-    m_connection = new SerialConnection();
+    m_connection    = new SerialConnection();
+    m_vcpConnection = new VcpConnection(m_connection);
     // must manage this registration of child object ourselves
     // if we use an autorelease here it causes the GCS to crash
     // as it is deleting objects as the app closes...
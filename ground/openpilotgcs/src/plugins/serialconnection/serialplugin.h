@@ -40,6 +40,7 @@
 class IConnection;
 class QSerialPortInfo;
 class SerialConnection;
+class VcpConnection;
 
 /**
  *   Helper thread to check on new serial port connection/disconnection
@@ -100,6 +101,7 @@ public:
         return m_optionspage;
     }
 
+    static QList<QSerialPortInfo> availablePorts();
 
 private:
     QSerialPort *serialHandle;
@@ -107,8 +109,6 @@ private:
     SerialPluginConfiguration *m_config;
     SerialPluginOptionsPage *m_optionspage;
 
-    QList<QSerialPortInfo> availablePorts();
-
 protected slots:
     void onEnumerationChanged();
 
@@ -131,6 +131,7 @@ public:
     virtual void extensionsInitialized();
 private:
     SerialConnection *m_connection;
+    VcpConnection *m_vcpConnection;
 };
 
 #endif // SERIALPLUGIN_H
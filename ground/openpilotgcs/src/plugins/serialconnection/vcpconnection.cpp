@@ -0,0 +1,127 @@
+/**
+ ******************************************************************************
+ *
+ * @file       vcpconnection.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup SerialPlugin Serial Connection Plugin
+ * @{
+ * @brief USB virtual com port telemetry connection to the flight hardware
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "vcpconnection.h"
+#include "serialplugin.h"
+
+#include <QDebug>
+
+// OpenPilot USB vendor id, shared by all the boards
+static const quint16 BOARD_USB_VID = 0x20a0;
+
+VcpConnection::VcpConnection(SerialConnection *serial) :
+    m_port(NULL),
+    m_enablePolling(true)
+{
+    // the serial connection polls all the ports for both of us
+    connect(serial, SIGNAL(availableDevChanged(IConnection *)), this, SLOT(onEnumerationChanged()));
+}
+
+VcpConnection::~VcpConnection()
+{}
+
+bool VcpConnection::isBoardPort(const QSerialPortInfo &port)
+{
+    return port.hasVendorIdentifier() && port.vendorIdentifier() == BOARD_USB_VID;
+}
+
+void VcpConnection::onEnumerationChanged()
+{
+    if (m_enablePolling) {
+        emit availableDevChanged(this);
+    }
+}
+
+QList <Core::IConnection::device> VcpConnection::availableDevices()
+{
+    QList <Core::IConnection::device> list;
+
+    if (m_enablePolling) {
+        foreach(QSerialPortInfo port, SerialConnection::availablePorts()) {
+            if (isBoardPort(port)) {
+                device d;
+
+                d.displayName = port.description().isEmpty() ? port.portName() :
+                                QString("%1 (%2)").arg(port.description()).arg(port.portName());
+                d.name = port.portName();
+                list.append(d);
+            }
+        }
+    }
+
+    return list;
+}
+
+QIODevice *VcpConnection::openDevice(const QString &deviceName)
+{
+    if (m_port) {
+        closeDevice(deviceName);
+    }
+    foreach(QSerialPortInfo port, SerialConnection::availablePorts()) {
+        if (port.portName() == deviceName) {
+            // don't specify a parent, the port is moved to the telemetry thread (see telemetrymanager.cpp)
+            m_port = new QSerialPort(port);
+            if (m_port->open(QIODevice::ReadWrite)) {
+                // no limit on what is buffered, reads are drained in large chunks
+                m_port->setReadBufferSize(0);
+                m_port->setDataTerminalReady(true);
+                qDebug() << "VCP telemetry running on" << deviceName;
+            }
+            return m_port;
+        }
+    }
+    return NULL;
+}
+
+void VcpConnection::closeDevice(const QString &deviceName)
+{
+    Q_UNUSED(deviceName);
+    if (m_port) {
+        m_port->deleteLater();
+        m_port = NULL;
+    }
+}
+
+QString VcpConnection::connectionName()
+{
+    return QString("USB VCP");
+}
+
+QString VcpConnection::shortName()
+{
+    return QString("VCP");
+}
+
+void VcpConnection::suspendPolling()
+{
+    m_enablePolling = false;
+}
+
+void VcpConnection::resumePolling()
+{
+    m_enablePolling = true;
+}
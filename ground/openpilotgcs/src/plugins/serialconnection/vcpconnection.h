@@ -0,0 +1,72 @@
+/**
+ ******************************************************************************
+ *
+ * @file       vcpconnection.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup SerialPlugin Serial Connection Plugin
+ * @{
+ * @brief USB virtual com port telemetry connection to the flight hardware
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef VCPCONNECTION_H
+#define VCPCONNECTION_H
+
+#include "coreplugin/iconnection.h"
+#include <QtSerialPort/QSerialPort>
+#include <QtSerialPort/QSerialPortInfo>
+
+class SerialConnection;
+
+/**
+ *   Telemetry over the USB virtual com port of OpenPilot boards, with HwSettings
+ *   USB_VCPPort set to USBTelemetry.
+ *
+ *   The board sends it in multi packet bulk transfers instead of one 64 byte HID report per
+ *   frame, so this is the link to use for high rate streaming and log downloads.
+ *   These ports are listed here rather than with the plain serial ports and are opened
+ *   without line settings, which the board ignores. Raising DTR is what tells the board
+ *   a GCS is present and moves its telemetry to the port.
+ */
+class VcpConnection : public Core::IConnection {
+    Q_OBJECT
+public:
+    VcpConnection(SerialConnection *serial);
+    virtual ~VcpConnection();
+
+    virtual QList <Core::IConnection::device> availableDevices();
+    virtual QIODevice *openDevice(const QString &deviceName);
+    virtual void closeDevice(const QString &deviceName);
+
+    virtual QString connectionName();
+    virtual QString shortName();
+    virtual void suspendPolling();
+    virtual void resumePolling();
+
+    static bool isBoardPort(const QSerialPortInfo &port);
+
+private slots:
+    void onEnumerationChanged();
+
+private:
+    QSerialPort *m_port;
+    bool m_enablePolling;
+};
+
+#endif // VCPCONNECTION_H
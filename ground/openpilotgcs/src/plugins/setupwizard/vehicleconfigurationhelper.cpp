@@ -43,6 +43,7 @@
 #include "airspeedsettings.h"
 #include <QtCore/qmath.h>
 #include <QJsonObject>
+#include <QSet>
 #include "auxmagsettings.h"
 
 VehicleConfigurationHelper::VehicleConfigurationHelper(VehicleConfigurationSource *configSource)
@@ -885,8 +886,7 @@ void VehicleConfigurationHelper::applyTemplateSettings()
 bool VehicleConfigurationHelper::saveChangesToController(bool save)
 {
     qDebug() << "Saving modified objects to controller. " << m_modifiedObjects.count() << " objects in found.";
-    const int OUTER_TIMEOUT = 3000 * 20; // 10 seconds timeout for saving all objects
-    const int INNER_TIMEOUT = 2000; // 1 second timeout on every save attempt
+    const int OUTER_TIMEOUT = 3000 * 20; // 60 seconds timeout for uploading and saving all objects
 
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     Q_ASSERT(pm);
@@ -896,75 +896,63 @@ bool VehicleConfigurationHelper::saveChangesToController(bool save)
     QTimer outerTimeoutTimer;
     outerTimeoutTimer.setSingleShot(true);
 
-    QTimer innerTimeoutTimer;
-    innerTimeoutTimer.setSingleShot(true);
-
     connect(utilMngr, SIGNAL(saveCompleted(int, bool)), this, SLOT(uAVOTransactionCompleted(int, bool)));
-    connect(&innerTimeoutTimer, SIGNAL(timeout()), &m_eventLoop, SLOT(quit()));
     connect(&outerTimeoutTimer, SIGNAL(timeout()), this, SLOT(saveChangesTimeout()));
 
+    m_transactionTimeout = false;
     outerTimeoutTimer.start(OUTER_TIMEOUT);
+
+    // Upload the objects with up to UPLOAD_WINDOW acked updates in flight instead
+    // of waiting for the round trip of every single object, this is what makes
+    // the apply slow over a radio link.
+    m_pendingUploads.clear();
+    m_inFlightUploads.clear();
+    QSet<UAVObject *> queued;
     for (int i = 0; i < m_modifiedObjects.count(); i++) {
         QPair<UAVDataObject *, QString> *objPair = m_modifiedObjects.at(i);
-        m_transactionOK = false;
-        UAVDataObject *obj     = objPair->first;
-        QString objDescription = objPair->second;
-        if (UAVObject::GetGcsAccess(obj->getMetadata()) != UAVObject::ACCESS_READONLY && obj->isSettingsObject()) {
-            emit saveProgress(m_modifiedObjects.count() + 1, ++m_progress, objDescription);
-
-            m_currentTransactionObjectID = obj->getObjID();
-
-            connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(uAVOTransactionCompleted(UAVObject *, bool)));
-            while (!m_transactionOK && !m_transactionTimeout) {
-                // Allow the transaction to take some time
-                innerTimeoutTimer.start(INNER_TIMEOUT);
-
-                // Set object updated
-                obj->updated();
-                if (!m_transactionOK) {
-                    m_eventLoop.exec();
-                }
-                innerTimeoutTimer.stop();
-            }
-            disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(uAVOTransactionCompleted(UAVObject *, bool)));
-            if (m_transactionOK) {
-                qDebug() << "Object " << obj->getName() << " was successfully updated.";
-                if (save) {
-                    m_transactionOK = false;
-                    m_currentTransactionObjectID = obj->getObjID();
-                    // Try to save until success or timeout
-                    while (!m_transactionOK && !m_transactionTimeout) {
-                        // Allow the transaction to take some time
-                        innerTimeoutTimer.start(INNER_TIMEOUT);
-
-                        // Persist object in controller
-                        utilMngr->saveObjectToSD(obj);
-                        if (!m_transactionOK) {
-                            m_eventLoop.exec();
-                        }
-                        innerTimeoutTimer.stop();
-                    }
-                    m_currentTransactionObjectID = -1;
-                }
-            }
-
-            if (!m_transactionOK) {
-                qDebug() << "Transaction timed out when trying to save: " << obj->getName();
-            } else {
-                qDebug() << "Object " << obj->getName() << " was successfully saved.";
-            }
-        } else {
+        UAVDataObject *obj = objPair->first;
+        if (UAVObject::GetGcsAccess(obj->getMetadata()) == UAVObject::ACCESS_READONLY || !obj->isSettingsObject()) {
             qDebug() << "Trying to save a UAVDataObject that is read only or is not a settings object.";
+        } else if (queued.contains(obj)) {
+            // One update sends the latest data, no need to send it twice
+            emit saveProgress(m_modifiedObjects.count() + 1, ++m_progress, objPair->second);
+        } else {
+            queued.insert(obj);
+            m_pendingUploads << objPair;
         }
-        if (m_transactionTimeout) {
-            qDebug() << "Transaction timed out when trying to save " << m_modifiedObjects.count() << " objects.";
-            break;
+    }
+
+    sendPendingUploads();
+    while ((!m_pendingUploads.isEmpty() || !m_inFlightUploads.isEmpty()) && !m_transactionTimeout) {
+        m_eventLoop.exec();
+    }
+    foreach(UAVObject * obj, m_inFlightUploads.keys()) {
+        disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(uAVOTransactionCompleted(UAVObject *, bool)));
+    }
+    m_inFlightUploads.clear();
+    m_pendingUploads.clear();
+
+    m_transactionOK = !m_transactionTimeout;
+    if (!m_transactionOK) {
+        qDebug() << "Transaction timed out when trying to upload " << m_modifiedObjects.count() << " objects.";
+    } else if (save) {
+        // Commit all the settings to flash with a single request, the board
+        // only writes the objects which differ from their stored copy.
+        emit saveProgress(m_modifiedObjects.count() + 1, m_progress, tr("Writing settings to flash"));
+        m_transactionOK = false;
+        m_currentTransactionObjectID = 0;
+        while (!m_transactionOK && !m_transactionTimeout) {
+            utilMngr->saveAllSettingsToSD();
+            m_eventLoop.exec();
+        }
+        m_currentTransactionObjectID = -1;
+        if (!m_transactionOK) {
+            qDebug() << "Transaction timed out when trying to save all settings.";
         }
     }
 
     outerTimeoutTimer.stop();
     disconnect(&outerTimeoutTimer, SIGNAL(timeout()), this, SLOT(saveChangesTimeout()));
-    disconnect(&innerTimeoutTimer, SIGNAL(timeout()), &m_eventLoop, SLOT(quit()));
     disconnect(utilMngr, SIGNAL(saveCompleted(int, bool)), this, SLOT(uAVOTransactionCompleted(int, bool)));
 
     qDebug() << "Finished saving modified objects to controller. Success = " << m_transactionOK;
@@ -972,6 +960,17 @@ bool VehicleConfigurationHelper::saveChangesToController(bool save)
     return m_transactionOK;
 }
 
+void VehicleConfigurationHelper::sendPendingUploads()
+{
+    while (!m_pendingUploads.isEmpty() && m_inFlightUploads.count() < UPLOAD_WINDOW) {
+        QPair<UAVDataObject *, QString> *objPair = m_pendingUploads.takeFirst();
+        UAVDataObject *obj = objPair->first;
+        m_inFlightUploads.insert(obj, objPair);
+        connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(uAVOTransactionCompleted(UAVObject *, bool)));
+        obj->updated();
+    }
+}
+
 void VehicleConfigurationHelper::uAVOTransactionCompleted(int oid, bool success)
 {
     if (oid == m_currentTransactionObjectID) {
@@ -982,8 +981,24 @@ void VehicleConfigurationHelper::uAVOTransactionCompleted(int oid, bool success)
 
 void VehicleConfigurationHelper::uAVOTransactionCompleted(UAVObject *object, bool success)
 {
-    if (object) {
-        uAVOTransactionCompleted(object->getObjID(), success);
+    QPair<UAVDataObject *, QString> *objPair = m_inFlightUploads.take(object);
+    if (!objPair) {
+        return;
+    }
+    disconnect(object, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(uAVOTransactionCompleted(UAVObject *, bool)));
+    if (success) {
+        qDebug() << "Object " << object->getName() << " was successfully updated.";
+        emit saveProgress(m_modifiedObjects.count() + 1, ++m_progress, objPair->second);
+    } else {
+        // Retry at the back of the window until the outer timeout
+        qDebug() << "Transaction failed when trying to update: " << object->getName() << ", retrying.";
+        m_pendingUploads << objPair;
+    }
+    if (!m_transactionTimeout) {
+        sendPendingUploads();
+    }
+    if (m_pendingUploads.isEmpty() && m_inFlightUploads.isEmpty()) {
+        m_eventLoop.quit();
     }
 }
 
@@ -30,6 +30,7 @@
 
 #include <QList>
 #include <QPair>
+#include <QHash>
 #include "vehicleconfigurationsource.h"
 #include "uavobjectmanager.h"
 #include "systemsettings.h"
@@ -98,8 +99,13 @@ private:
     GUIConfigDataUnion getGUIConfigData();
     void applyMultiGUISettings(SystemSettings::AirframeTypeOptions airframe, GUIConfigDataUnion guiConfig);
 
+    static const int UPLOAD_WINDOW = 8;
+
     bool saveChangesToController(bool save);
+    void sendPendingUploads();
     QEventLoop m_eventLoop;
+    QList<QPair<UAVDataObject *, QString> *> m_pendingUploads;
+    QHash<UAVObject *, QPair<UAVDataObject *, QString> *> m_inFlightUploads;
     bool m_transactionOK;
     bool m_transactionTimeout;
     int m_currentTransactionObjectID;
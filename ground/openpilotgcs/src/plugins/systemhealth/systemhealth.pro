@@ -7,6 +7,7 @@ include(systemhealth_dependencies.pri)
 HEADERS += systemhealthplugin.h
 HEADERS += systemhealthgadget.h
 HEADERS += systemhealthgadgetwidget.h
+HEADERS += taskinfotable.h
 HEADERS += systemhealthgadgetfactory.h
 HEADERS += systemhealthgadgetconfiguration.h
 HEADERS += systemhealthgadgetoptionspage.h
@@ -14,6 +15,7 @@ SOURCES += systemhealthplugin.cpp
 SOURCES += systemhealthgadget.cpp
 SOURCES += systemhealthgadgetfactory.cpp
 SOURCES += systemhealthgadgetwidget.cpp
+SOURCES += taskinfotable.cpp
 SOURCES += systemhealthgadgetconfiguration.cpp
 SOURCES += systemhealthgadgetoptionspage.cpp
 OTHER_FILES += SystemHealthGadget.pluginspec
@@ -28,15 +28,25 @@
 #include "systemhealthgadget.h"
 #include "systemhealthgadgetwidget.h"
 #include "systemhealthgadgetconfiguration.h"
+#include "taskinfotable.h"
+
+#include <QSplitter>
 
 SystemHealthGadget::SystemHealthGadget(QString classId, SystemHealthGadgetWidget *widget, QWidget *parent) :
     IUAVGadget(classId, parent),
+    m_splitter(new QSplitter(Qt::Vertical)),
     m_widget(widget)
-{}
+{
+    m_splitter->addWidget(m_widget);
+    m_splitter->addWidget(new TaskInfoTable());
+    m_splitter->setStretchFactor(0, 3);
+    m_splitter->setStretchFactor(1, 1);
+}
 
 SystemHealthGadget::~SystemHealthGadget()
 {
-    delete m_widget;
+    // the splitter owns the alarms view and the table
+    delete m_splitter;
 }
 
 /*
@@ -34,6 +34,7 @@
 class IUAVGadget;
 class QWidget;
 class QString;
+class QSplitter;
 class SystemHealthGadgetWidget;
 
 using namespace Core;
@@ -46,11 +47,13 @@ public:
 
     QWidget *widget()
     {
-        return m_widget;
+        return m_splitter;
     }
     void loadConfiguration(IUAVGadgetConfiguration *config);
 
 private:
+    // the alarms above the table of the tasks
+    QSplitter *m_splitter;
     SystemHealthGadgetWidget *m_widget;
 };
 
@@ -57,8 +57,9 @@ SystemHealthGadgetWidget::SystemHealthGadgetWidget(QWidget *parent) : QGraphicsV
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
 
+    // The alarms are redrawn at most once per frame, however often they arrive
     SystemAlarms *obj = dynamic_cast<SystemAlarms *>(objManager->getObject(QString("SystemAlarms")));
-    connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateAlarms(UAVObject *)));
+    objManager->connectCoalesced(obj, this, SLOT(updateAlarms(UAVObject *)));
 
     // Listen to autopilot connection events
     TelemetryManager *telMngr = pm->getObject<TelemetryManager>();
@@ -86,20 +87,11 @@ void SystemHealthGadgetWidget::onAutopilotDisconnect()
 
 void SystemHealthGadgetWidget::updateAlarms(UAVObject *systemAlarm)
 {
-    // This code does not know anything about alarms beforehand, and
-    // I found no efficient way to locate items inside the scene by
-    // name, so it's just as simple to reset the scene:
-    // And add the one with the right name.
-    QGraphicsScene *m_scene = scene();
-
-    foreach(QGraphicsItem * item, background->childItems()) {
-        m_scene->removeItem(item);
-        delete item; // removeItem does _not_ delete the item.
-    }
-
+    // This code does not know anything about alarms beforehand: each alarm
+    // element gets the indicator named after its value. Only the indicators
+    // of the alarms which changed are replaced, the others stay in the scene.
     QMatrix backgroundMatrix = (m_renderer->matrixForElement(background->elementId())).inverted();
 
-    QString alarm = systemAlarm->getName();
     foreach(UAVObjectField * field, systemAlarm->getFields()) {
         for (uint i = 0; i < field->getNumElements(); ++i) {
             QString element = field->getElementNames()[i];
@@ -107,6 +99,13 @@ void SystemHealthGadgetWidget::updateAlarms(UAVObject *systemAlarm)
             if (!missingElements->contains(element)) {
                 if (m_renderer->elementExists(element)) {
                     QString element2 = element + "-" + value;
+                    QGraphicsSvgItem *current = indicators.value(element);
+                    if (current && current->elementId() == element2) {
+                        continue;
+                    }
+                    // deleting the item also removes it from the scene
+                    delete current;
+                    indicators.remove(element);
                     if (!missingElements->contains(element2)) {
                         if (m_renderer->elementExists(element2)) {
                             // element2 is in global coordinates
@@ -122,6 +121,7 @@ void SystemHealthGadgetWidget::updateAlarms(UAVObject *systemAlarm)
                             QTransform matrix;
                             matrix.translate(rectProjected.x(), rectProjected.y());
                             ind->setTransform(matrix, false);
+                            indicators.insert(element, ind);
                         } else {
                             if (value.compare("Uninitialised") != 0) {
                                 missingElements->append(element2);
@@ -148,6 +148,9 @@ void SystemHealthGadgetWidget::setSystemFile(QString dfn)
 {
     // Clear the list of elements not found on svg
     missingElements->clear();
+    // and the indicators, their elements may not be the same in the new file
+    qDeleteAll(indicators);
+    indicators.clear();
     setBackgroundBrush(QBrush(Utils::StyleHelper::baseColor()));
     if (QFile::exists(dfn)) {
         m_renderer->load(dfn);
@@ -37,6 +37,7 @@
 #include <QMouseEvent>
 
 #include <QFile>
+#include <QHash>
 #include <QTimer>
 
 class SystemHealthGadgetWidget : public QGraphicsView {
@@ -65,6 +66,8 @@ private:
     QGraphicsSvgItem *foreground;
     QGraphicsSvgItem *nolink;
     QStringList *missingElements;
+    // The indicator shown for each alarm element
+    QHash<QString, QGraphicsSvgItem *> indicators;
     // Simple flag to skip rendering if the
     bool fgenabled; // layer does not exist.
 
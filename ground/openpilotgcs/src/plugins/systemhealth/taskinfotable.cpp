@@ -0,0 +1,111 @@
+/**
+ ******************************************************************************
+ *
+ * @file       taskinfotable.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup SystemHealthPlugin System Health Plugin
+ * @{
+ * @brief Live table of the CPU use of the flight tasks
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "taskinfotable.h"
+
+#include "extensionsystem/pluginmanager.h"
+#include "uavobjectmanager.h"
+#include <uavtalk/telemetrymanager.h>
+
+#include <QHeaderView>
+
+TaskInfoTable::TaskInfoTable(QWidget *parent) : QTableWidget(0, 5, parent)
+{
+    setHorizontalHeaderLabels(QStringList() << tr("Task") << tr("CPU %") << tr("Max run (us)")
+                                            << tr("Switches/s") << tr("Free stack (bytes)"));
+    verticalHeader()->hide();
+    horizontalHeader()->setStretchLastSection(true);
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+    setSelectionMode(QAbstractItemView::NoSelection);
+
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+
+    // Boards without task diagnostics do not know the object, the table stays empty
+    UAVObject *obj = objManager->getObject(QString("TaskInfo"));
+    if (obj) {
+        objManager->connectCoalesced(obj, this, SLOT(updateTasks(UAVObject *)));
+    }
+
+    TelemetryManager *telMngr = pm->getObject<TelemetryManager>();
+    connect(telMngr, SIGNAL(disconnected()), this, SLOT(onAutopilotDisconnect()));
+
+    setToolTip(tr("CPU time of the flight tasks since the previous TaskInfo update. "
+                  "Max run is the longest time a task ran before another one was switched in."));
+}
+
+void TaskInfoTable::updateTasks(UAVObject *taskInfo)
+{
+    UAVObjectField *running    = taskInfo->getField("Running");
+    UAVObjectField *load       = taskInfo->getField("Load");
+    UAVObjectField *maxRunTime = taskInfo->getField("MaxRunTime");
+    UAVObjectField *switches   = taskInfo->getField("ContextSwitches");
+    UAVObjectField *stack      = taskInfo->getField("StackRemaining");
+
+    if (!running || !load || !maxRunTime || !switches || !stack) {
+        return;
+    }
+
+    // The rows are rewritten in place, so that the table does not flicker
+    QStringList tasks = running->getElementNames();
+    int row = 0;
+    for (int i = 0; i < tasks.size(); ++i) {
+        if (running->getValue(i).toString() != "True") {
+            continue;
+        }
+        if (row >= rowCount()) {
+            insertRow(row);
+        }
+        setCell(row, 0, tasks[i]);
+        setCell(row, 1, QString::number(load->getDouble(i), 'f', 2));
+        setCell(row, 2, QString::number(maxRunTime->getValue(i).toUInt()));
+        setCell(row, 3, QString::number(switches->getValue(i).toUInt()));
+        setCell(row, 4, QString::number(stack->getValue(i).toUInt()));
+        ++row;
+    }
+    setRowCount(row);
+}
+
+void TaskInfoTable::onAutopilotDisconnect()
+{
+    setRowCount(0);
+}
+
+void TaskInfoTable::setCell(int row, int column, const QString &text)
+{
+    QTableWidgetItem *cell = item(row, column);
+
+    if (cell) {
+        cell->setText(text);
+    } else {
+        cell = new QTableWidgetItem(text);
+        if (column > 0) {
+            cell->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        }
+        setItem(row, column, cell);
+    }
+}
@@ -0,0 +1,53 @@
+/**
+ ******************************************************************************
+ *
+ * @file       taskinfotable.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup SystemHealthPlugin System Health Plugin
+ * @{
+ * @brief Live table of the CPU use of the flight tasks
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef TASKINFOTABLE_H_
+#define TASKINFOTABLE_H_
+
+#include "uavobject.h"
+
+#include <QTableWidget>
+
+/*
+ * One row per running task, filled from TaskInfo: the CPU load, the longest
+ * single run and the context switches over the last update of the object,
+ * and the stack left.
+ */
+class TaskInfoTable : public QTableWidget {
+    Q_OBJECT
+
+public:
+    TaskInfoTable(QWidget *parent = 0);
+
+private slots:
+    void updateTasks(UAVObject *taskInfo);
+    void onAutopilotDisconnect();
+
+private:
+    void setCell(int row, int column, const QString &text);
+};
+#endif /* TASKINFOTABLE_H_ */
@@ -28,10 +28,9 @@
 #include "treeitem.h"
 
 /* Constructor */
-HighLightManager::HighLightManager(long checkingInterval)
+HighLightManager::HighLightManager(long checkingInterval) : m_checkingInterval(checkingInterval)
 {
-    // Start the timer and connect it to the callback
-    m_expirationTimer.start(checkingInterval);
+    // Connect the timer to the callback, it is started by the first highlight
     connect(&m_expirationTimer, SIGNAL(timeout()), this, SLOT(checkItemsExpired()));
 }
 
@@ -47,6 +46,9 @@ bool HighLightManager::add(TreeItem *itemToAdd)
     // Check so that the item isn't already in the list
     if (!m_items.contains(itemToAdd)) {
         m_items.insert(itemToAdd);
+        if (!m_expirationTimer.isActive()) {
+            m_expirationTimer.start(m_checkingInterval);
+        }
         return true;
     }
     return false;
@@ -93,6 +95,11 @@ void HighLightManager::checkItemsExpired()
             iter.remove();
         }
     }
+
+    // Nothing left to restore, sleep until the next highlight
+    if (m_items.isEmpty()) {
+        m_expirationTimer.stop();
+    }
 }
 
 int TreeItem::m_highlightTimeMs = 500;
@@ -102,14 +109,16 @@ TreeItem::TreeItem(const QList<QVariant> &data, TreeItem *parent) :
     m_data(data),
     m_parent(parent),
     m_highlight(false),
-    m_changed(false)
+    m_changed(false),
+    m_expanded(false)
 {}
 
 TreeItem::TreeItem(const QVariant &data, TreeItem *parent) :
     QObject(0),
     m_parent(parent),
     m_highlight(false),
-    m_changed(false)
+    m_changed(false),
+    m_expanded(false)
 {
     m_data << data << "" << "";
 }
@@ -190,11 +199,10 @@ void TreeItem::setHighlight(bool highlight)
         // Update the expires timestamp
         m_highlightExpires = QTime::currentTime().addMSecs(m_highlightTimeMs);
 
-        // Add to highlightmanager
-        if (m_highlightManager->add(this)) {
-            // Only emit signal if it was added
-            emit updateHighlight(this);
-        }
+        // Add to highlightmanager, the value may have changed even if it already was,
+        // the model batches the repaints
+        m_highlightManager->add(this);
+        emit updateHighlight(this);
     } else if (m_highlightManager->remove(this)) {
         // Only emit signal if it was removed
         emit updateHighlight(this);
@@ -65,6 +65,7 @@ public:
 
     // This is called when an item has been set to
     // highlighted = true.
+    // The timer only runs while there are items to restore.
     bool add(TreeItem *itemToAdd);
 
     // This is called when an item is set to highlighted = false;
@@ -77,6 +78,7 @@ private slots:
 private:
     // The timer checking highlight expiration.
     QTimer m_expirationTimer;
+    long m_checkingInterval;
 
     // The collection holding all items due to be updated.
     QSet<TreeItem *> m_items;
@@ -156,6 +158,16 @@ public:
         m_changed = changed;
     }
 
+    // Whether the children of the item are shown by the view
+    inline bool isExpanded()
+    {
+        return m_expanded;
+    }
+    inline void setExpanded(bool expanded)
+    {
+        m_expanded = expanded;
+    }
+
     virtual void setHighlightManager(HighLightManager *mgr);
 
     QTime getHiglightExpires();
@@ -239,6 +251,7 @@ private:
     TreeItem *m_parent;
     bool m_highlight;
     bool m_changed;
+    bool m_expanded;
     QTime m_highlightExpires;
     HighLightManager *m_highlightManager;
 };
@@ -283,12 +296,12 @@ class ObjectTreeItem : public TreeItem {
     Q_OBJECT
 public:
     ObjectTreeItem(const QList<QVariant> &data, UAVObject *object, TreeItem *parent = 0) :
-        TreeItem(data, parent), m_obj(object)
+        TreeItem(data, parent), m_obj(object), m_stale(false)
     {
         setDescription(m_obj->getDescription());
     }
     ObjectTreeItem(const QVariant &data, UAVObject *object, TreeItem *parent = 0) :
-        TreeItem(data, parent), m_obj(object)
+        TreeItem(data, parent), m_obj(object), m_stale(false)
     {
         setDescription(m_obj->getDescription());
     }
@@ -301,8 +314,31 @@ public:
         return !m_obj->isSettingsObject() || m_obj->isKnown();
     }
 
+    // Set when the field items missed updates of the object while they were not shown
+    inline bool isStale()
+    {
+        return m_stale;
+    }
+    inline void setStale(bool stale)
+    {
+        m_stale = stale;
+    }
+
+    // Whether the object data changed since the last call, without reading the fields
+    bool objectDataChanged()
+    {
+        QByteArray data(m_obj->getNumBytes(), 0);
+
+        m_obj->pack((quint8 *)data.data());
+        bool changed = data != m_objectData;
+        m_objectData = data;
+        return changed;
+    }
+
 private:
     UAVObject *m_obj;
+    bool m_stale;
+    QByteArray m_objectData;
 };
 
 class MetaObjectTreeItem : public ObjectTreeItem {
@@ -50,6 +50,7 @@ UAVObjectBrowserWidget::UAVObjectBrowserWidget(QWidget *parent) : QWidget(parent
     m_browser->setupUi(this);
     m_model = new UAVObjectTreeModel();
     m_browser->treeView->setModel(m_model);
+    connectModel();
     m_browser->treeView->setColumnWidth(0, 300);
 
     BrowserItemDelegate *m_delegate = new BrowserItemDelegate();
@@ -121,6 +122,7 @@ void UAVObjectBrowserWidget::categorize(bool categorize)
     m_model->setOnlyHilightChangedValues(m_onlyHilightChangedValues);
     m_model->setUnknowObjectColor(m_unknownObjectColor);
     m_browser->treeView->setModel(m_model);
+    connectModel();
     showMetaData(m_viewoptions->cbMetaData->isChecked());
     connect(m_browser->treeView->selectionModel(), SIGNAL(currentChanged(QModelIndex, QModelIndex)), this, SLOT(currentChanged(QModelIndex, QModelIndex)), Qt::UniqueConnection);
 
@@ -137,6 +139,7 @@ void UAVObjectBrowserWidget::useScientificNotation(bool scientific)
     m_model->setRecentlyUpdatedTimeout(m_recentlyUpdatedTimeout);
     m_model->setUnknowObjectColor(m_unknownObjectColor);
     m_browser->treeView->setModel(m_model);
+    connectModel();
     showMetaData(m_viewoptions->cbMetaData->isChecked());
     connect(m_browser->treeView->selectionModel(), SIGNAL(currentChanged(QModelIndex, QModelIndex)), this, SLOT(currentChanged(QModelIndex, QModelIndex)), Qt::UniqueConnection);
 
@@ -148,6 +151,8 @@ void UAVObjectBrowserWidget::sendUpdate()
     this->setFocus();
     ObjectTreeItem *objItem = findCurrentObjectTreeItem();
     Q_ASSERT(objItem);
+    // Fields of collapsed objects are not updated as the object changes
+    m_model->updateStaleItems(objItem);
     objItem->apply();
     UAVObject *obj = objItem->object();
     Q_ASSERT(obj);
@@ -375,6 +380,15 @@ void UAVObjectBrowserWidget::enableSendRequest(bool enable)
     m_browser->eraseSDButton->setEnabled(enable);
 }
 
+/**
+ * The model only keeps the fields of expanded objects up to date
+ */
+void UAVObjectBrowserWidget::connectModel()
+{
+    connect(m_browser->treeView, SIGNAL(expanded(QModelIndex)), m_model, SLOT(itemExpanded(QModelIndex)));
+    connect(m_browser->treeView, SIGNAL(collapsed(QModelIndex)), m_model, SLOT(itemCollapsed(QModelIndex)));
+}
+
 void UAVObjectBrowserWidget::updateDescription()
 {
     ObjectTreeItem *objItem = findCurrentObjectTreeItem();
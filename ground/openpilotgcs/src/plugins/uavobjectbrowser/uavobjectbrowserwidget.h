@@ -110,6 +110,7 @@ private:
     void updateObjectPersistance(ObjectPersistence::OperationOptions op, UAVObject *obj);
     void enableSendRequest(bool enable);
     void updateDescription();
+    void connectModel();
     ObjectTreeItem *findCurrentObjectTreeItem();
     QString loadFileIntoString(QString fileName);
 };
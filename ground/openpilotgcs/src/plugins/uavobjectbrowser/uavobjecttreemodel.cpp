@@ -50,9 +50,16 @@ UAVObjectTreeModel::UAVObjectTreeModel(QObject *parent, bool categorize, bool us
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
 
     Q_ASSERT(objManager);
+    m_objManager = objManager;
 
     // Create highlight manager, let it run every 300 ms.
     m_highlightManager = new HighLightManager(300);
+
+    // Repaint the changed items at most every 50 ms
+    m_refreshTimer     = new QTimer(this);
+    m_refreshTimer->setSingleShot(true);
+    m_refreshTimer->setInterval(50);
+    connect(m_refreshTimer, SIGNAL(timeout()), this, SLOT(refreshChangedItems()));
     connect(objManager, SIGNAL(newObject(UAVObject *)), this, SLOT(newObject(UAVObject *)));
     connect(objManager, SIGNAL(newInstance(UAVObject *)), this, SLOT(newObject(UAVObject *)));
 
@@ -150,9 +157,11 @@ TreeItem *UAVObjectTreeModel::createCategoryItems(QStringList categoryPath, Tree
 
 MetaObjectTreeItem *UAVObjectTreeModel::addMetaObject(UAVMetaObject *obj, TreeItem *parent)
 {
-    connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(highlightUpdatedObject(UAVObject *)));
+    // the browser only shows the latest values, one refresh per display frame is enough
+    m_objManager->connectCoalesced(obj, this, SLOT(highlightUpdatedObject(UAVObject *)));
     MetaObjectTreeItem *meta = new MetaObjectTreeItem(obj, tr("Meta Data"));
 
+    m_objectTreeItems.insert(obj, meta);
     meta->setHighlightManager(m_highlightManager);
     connect(meta, SIGNAL(updateHighlight(TreeItem *)), this, SLOT(updateHighlight(TreeItem *)));
     foreach(UAVObjectField * field, obj->getFields()) {
@@ -168,7 +177,8 @@ MetaObjectTreeItem *UAVObjectTreeModel::addMetaObject(UAVMetaObject *obj, TreeIt
 
 void UAVObjectTreeModel::addInstance(UAVObject *obj, TreeItem *parent)
 {
-    connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(highlightUpdatedObject(UAVObject *)));
+    // the browser only shows the latest values, one refresh per display frame is enough
+    m_objManager->connectCoalesced(obj, this, SLOT(highlightUpdatedObject(UAVObject *)));
     connect(obj, SIGNAL(isKnownChanged(UAVObject *, bool)), this, SLOT(isKnownChanged(UAVObject *, bool)));
     TreeItem *item;
     if (obj->isSingleInstance()) {
@@ -183,6 +193,7 @@ void UAVObjectTreeModel::addInstance(UAVObject *obj, TreeItem *parent)
         connect(item, SIGNAL(updateIsKnown(TreeItem *)), this, SLOT(updateIsKnown(TreeItem *)));
         parent->appendChild(item);
     }
+    m_objectTreeItems.insert(obj, static_cast<ObjectTreeItem *>(item));
     foreach(UAVObjectField * field, obj->getFields()) {
         if (field->getNumElements() > 1) {
             addArrayField(field, item);
@@ -287,17 +298,7 @@ QModelIndex UAVObjectTreeModel::index(TreeItem *item)
         return QModelIndex();
     }
 
-    QModelIndex root = index(item->parent());
-
-    for (int i = 0; i < rowCount(root); ++i) {
-        QModelIndex childIndex = index(i, 0, root);
-        TreeItem *child = static_cast<TreeItem *>(childIndex.internalPointer());
-        if (child == item) {
-            return childIndex;
-        }
-    }
-    Q_ASSERT(false);
-    return QModelIndex();
+    return createIndex(item->row(), 0, item);
 }
 
 QModelIndex UAVObjectTreeModel::parent(const QModelIndex &index) const
@@ -447,55 +448,115 @@ QVariant UAVObjectTreeModel::headerData(int section, Qt::Orientation orientation
 void UAVObjectTreeModel::highlightUpdatedObject(UAVObject *obj)
 {
     Q_ASSERT(obj);
-    ObjectTreeItem *item = findObjectTreeItem(obj);
+    ObjectTreeItem *item = m_objectTreeItems.value(obj);
     Q_ASSERT(item);
     if (!m_onlyHilightChangedValues) {
         item->setHighlight(true);
     }
-    item->update();
-    if (!m_onlyHilightChangedValues) {
-        QModelIndex itemIndex = index(item);
-        Q_ASSERT(itemIndex != QModelIndex());
-        emit dataChanged(itemIndex, itemIndex);
+    if (item->isExpanded() && isShown(item)) {
+        item->update();
+        item->setStale(false);
+    } else {
+        // The fields are read when the object is expanded, only the object row can be seen
+        item->setStale(true);
+        if (m_onlyHilightChangedValues && item->objectDataChanged()) {
+            item->setHighlight(true);
+        }
     }
 }
 
-ObjectTreeItem *UAVObjectTreeModel::findObjectTreeItem(UAVObject *object)
+/**
+ * Bring the field items of item and of the objects below it up to date with their objects
+ */
+void UAVObjectTreeModel::updateStaleItems(TreeItem *item)
 {
-    UAVDataObject *dataObject = qobject_cast<UAVDataObject *>(object);
-    UAVMetaObject *metaObject = qobject_cast<UAVMetaObject *>(object);
+    ObjectTreeItem *objectItem = dynamic_cast<ObjectTreeItem *>(item);
 
-    Q_ASSERT(dataObject || metaObject);
-    if (dataObject) {
-        return findDataObjectTreeItem(dataObject);
-    } else {
-        return findMetaObjectTreeItem(metaObject);
+    if (objectItem && objectItem->isStale()) {
+        objectItem->update();
+        objectItem->setStale(false);
+    }
+    foreach(TreeItem * child, item->treeChildren()) {
+        if (child->childCount() > 0) {
+            updateStaleItems(child);
+        }
     }
-    return 0;
 }
 
-DataObjectTreeItem *UAVObjectTreeModel::findDataObjectTreeItem(UAVDataObject *obj)
+void UAVObjectTreeModel::itemExpanded(const QModelIndex &index)
 {
-    TopTreeItem *root = obj->isSettingsObject() ? m_settingsTree : m_nonSettingsTree;
+    TreeItem *item = static_cast<TreeItem *>(index.internalPointer());
 
-    return root->findDataObjectTreeItemByObjectId(obj->getObjID());
+    item->setExpanded(true);
+    // Only the objects shown now, collapsed ones further down update when expanded
+    QList<TreeItem *> items;
+    items << item;
+    while (!items.isEmpty()) {
+        TreeItem *shown = items.takeFirst();
+        ObjectTreeItem *objectItem = dynamic_cast<ObjectTreeItem *>(shown);
+        if (objectItem && objectItem->isStale()) {
+            objectItem->update();
+            objectItem->setStale(false);
+        }
+        foreach(TreeItem * child, shown->treeChildren()) {
+            if (child->isExpanded()) {
+                items << child;
+            }
+        }
+    }
 }
 
-MetaObjectTreeItem *UAVObjectTreeModel::findMetaObjectTreeItem(UAVMetaObject *obj)
+void UAVObjectTreeModel::itemCollapsed(const QModelIndex &index)
 {
-    UAVDataObject *dataObject = qobject_cast<UAVDataObject *>(obj->getParentObject());
+    static_cast<TreeItem *>(index.internalPointer())->setExpanded(false);
+}
 
-    Q_ASSERT(dataObject);
-    TopTreeItem *root = dataObject->isSettingsObject() ? m_settingsTree : m_nonSettingsTree;
-    return root->findMetaObjectTreeItemByObjectId(obj->getObjID());
+/**
+ * Whether the row of item is shown, all its parents being expanded
+ */
+bool UAVObjectTreeModel::isShown(TreeItem *item)
+{
+    for (TreeItem *parent = item->parent(); parent && parent != m_rootItem; parent = parent->parent()) {
+        if (!parent->isExpanded()) {
+            return false;
+        }
+    }
+    return true;
 }
 
 void UAVObjectTreeModel::updateHighlight(TreeItem *item)
 {
-    QModelIndex itemIndex = index(item);
+    m_changedItems.insert(item);
+    if (!m_refreshTimer->isActive()) {
+        m_refreshTimer->start();
+    }
+}
 
-    Q_ASSERT(itemIndex != QModelIndex());
-    emit dataChanged(itemIndex, itemIndex.sibling(itemIndex.row(), TreeItem::DATA_COLUMN));
+void UAVObjectTreeModel::refreshChangedItems()
+{
+    // One range per parent, over the shown rows that changed
+    QHash<TreeItem *, QPair<int, int> > rows;
+    foreach(TreeItem * item, m_changedItems) {
+        if (!isShown(item)) {
+            continue;
+        }
+        int row = item->row();
+        QHash<TreeItem *, QPair<int, int> >::iterator range = rows.find(item->parent());
+        if (range == rows.end()) {
+            rows.insert(item->parent(), qMakePair(row, row));
+        } else {
+            range.value().first  = qMin(range.value().first, row);
+            range.value().second = qMax(range.value().second, row);
+        }
+    }
+    m_changedItems.clear();
+
+    QHash<TreeItem *, QPair<int, int> >::const_iterator range;
+    for (range = rows.constBegin(); range != rows.constEnd(); ++range) {
+        QModelIndex parentIndex = index(range.key());
+        emit dataChanged(index(range.value().first, TreeItem::TITLE_COLUMN, parentIndex),
+                         index(range.value().second, TreeItem::DATA_COLUMN, parentIndex));
+    }
 }
 
 void UAVObjectTreeModel::updateIsKnown(TreeItem *item)
@@ -509,7 +570,7 @@ void UAVObjectTreeModel::updateIsKnown(TreeItem *item)
 void UAVObjectTreeModel::isKnownChanged(UAVObject *object, bool isKnown)
 {
     Q_UNUSED(isKnown);
-    ObjectTreeItem *item = findObjectTreeItem(object);
+    ObjectTreeItem *item = m_objectTreeItems.value(object);
     if (item) {
         item->updateIsKnown(isKnown);
     }
@@ -32,6 +32,8 @@
 #include <QAbstractItemModel>
 #include <QtCore/QMap>
 #include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
 #include <QColor>
 
 class TopTreeItem;
@@ -86,16 +88,22 @@ public:
 
     QList<QModelIndex> getMetaDataIndexes();
 
+    void updateStaleItems(TreeItem *item);
+
 signals:
 
 public slots:
     void newObject(UAVObject *obj);
+    // Connected to the view, the fields of collapsed objects are not kept up to date
+    void itemExpanded(const QModelIndex &index);
+    void itemCollapsed(const QModelIndex &index);
 
 private slots:
     void updateHighlight(TreeItem *item);
     void updateIsKnown(TreeItem *item);
     void highlightUpdatedObject(UAVObject *obj);
     void isKnownChanged(UAVObject *object, bool isKnown);
+    void refreshChangedItems();
 
 private:
     void setupModelData(UAVObjectManager *objManager);
@@ -109,10 +117,9 @@ private:
     TreeItem *createCategoryItems(QStringList categoryPath, TreeItem *root);
 
     QString updateMode(quint8 updateMode);
-    ObjectTreeItem *findObjectTreeItem(UAVObject *obj);
-    DataObjectTreeItem *findDataObjectTreeItem(UAVDataObject *obj);
-    MetaObjectTreeItem *findMetaObjectTreeItem(UAVMetaObject *obj);
+    bool isShown(TreeItem *item);
 
+    UAVObjectManager *m_objManager;
     TreeItem *m_rootItem;
     TopTreeItem *m_settingsTree;
     TopTreeItem *m_nonSettingsTree;
@@ -126,6 +133,13 @@ private:
 
     // Highlight manager to handle highlighting of tree items.
     HighLightManager *m_highlightManager;
+
+    // The item showing each object instance and metaobject
+    QHash<UAVObject *, ObjectTreeItem *> m_objectTreeItems;
+
+    // Items to repaint at the next refresh, in one dataChanged per parent
+    QSet<TreeItem *> m_changedItems;
+    QTimer *m_refreshTimer;
 };
 
 #endif // UAVOBJECTTREEMODEL_H
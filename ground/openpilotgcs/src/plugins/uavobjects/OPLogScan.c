@@ -0,0 +1,137 @@
+/**
+ ******************************************************************************
+ *
+ * @file       OPLogScan.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      MEX helper of OPLogConvert.m, indexes the UAVTalk object packets
+ *             of an .opl log in a single pass.
+ *
+ *             Compile it once with "mex OPLogScan.c" in the directory holding
+ *             OPLogConvert.m, which falls back to its scripted parser when the
+ *             helper is missing.
+ *
+ *             [objID, dataIdx, wrongSyncByte] = OPLogScan(buffer)
+ *
+ *             buffer is the whole log file read as a uint8 vector, objID and
+ *             dataIdx are row vectors holding the object ID of every packet and
+ *             the (one based) index of its first data byte in buffer.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "mex.h"
+#include "stdint.h"
+#include "string.h"
+
+#define SYNC_VAL          0x3C
+#define TYPE_OBJ          0x20
+#define TYPE_OBJ_TS       0xA0
+#define OPL_HEADER_LENGTH 12 // timestamp (4) and data block size (8) written by the GCS logger
+#define HEADER_LENGTH     10 // sync, type, length, object and instance ID
+#define TIMESTAMP_LENGTH  4
+#define CRC_LENGTH        1
+
+static uint16_t getUInt16(const uint8_t *p)
+{
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t getUInt32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+	const uint8_t *buffer;
+	size_t length;
+	size_t capacity;
+	size_t count = 0;
+	size_t idx;
+	double wrongSyncByte = 0;
+	double *objID;
+	double *dataIdx;
+
+	if (nrhs != 1 || !mxIsUint8(prhs[0])) {
+		mexErrMsgTxt("Input must be the log file contents as a uint8 vector\n");
+		return;
+	}
+
+	buffer = (const uint8_t *)mxGetData(prhs[0]);
+	length = mxGetNumberOfElements(prhs[0]);
+
+	// Every accepted packet consumes at least its header, crc and the next
+	// opl header, which bounds the number of packets in the log
+	capacity = length / (HEADER_LENGTH + CRC_LENGTH + OPL_HEADER_LENGTH) + 1;
+	objID    = (double *)mxMalloc(capacity * sizeof(double));
+	dataIdx  = (double *)mxMalloc(capacity * sizeof(double));
+
+	idx = OPL_HEADER_LENGTH;
+	while (idx + HEADER_LENGTH + TIMESTAMP_LENGTH <= length) {
+		uint8_t type;
+		uint16_t size;
+		uint32_t id;
+		size_t headerSize = HEADER_LENGTH;
+		size_t dataSize;
+
+		// Same resynchronisation as the scripted parser: skip a byte at a time
+		if (buffer[idx++] != SYNC_VAL) {
+			wrongSyncByte++;
+			continue;
+		}
+		type = buffer[idx++];
+		if (type != TYPE_OBJ && type != TYPE_OBJ_TS) {
+			continue;
+		}
+		size = getUInt16(&buffer[idx]);
+		idx += 2;
+		id   = getUInt32(&buffer[idx]);
+		idx += 4 + 2; // the instance ID is read back from the data index
+
+		if (type == TYPE_OBJ_TS) {
+			idx += TIMESTAMP_LENGTH;
+			headerSize += TIMESTAMP_LENGTH;
+		}
+		dataSize = size > headerSize ? size - headerSize : 0;
+
+		// A packet cut short by the end of the log is dropped
+		if (idx + dataSize + CRC_LENGTH > length) {
+			break;
+		}
+
+		objID[count]   = id;
+		dataIdx[count] = (double)(idx + 1); // MATLAB indices are one based
+		count++;
+
+		idx += dataSize + CRC_LENGTH + OPL_HEADER_LENGTH;
+	}
+
+	plhs[0] = mxCreateDoubleMatrix(1, count, mxREAL);
+	memcpy(mxGetPr(plhs[0]), objID, count * sizeof(double));
+	if (nlhs > 1) {
+		plhs[1] = mxCreateDoubleMatrix(1, count, mxREAL);
+		memcpy(mxGetPr(plhs[1]), dataIdx, count * sizeof(double));
+	}
+	if (nlhs > 2) {
+		plhs[2] = mxCreateDoubleScalar(wrongSyncByte);
+	}
+
+	mxFree(objID);
+	mxFree(dataIdx);
+}
@@ -63,7 +63,8 @@ UAVObject::UAVObject(quint32 objID, bool isSingleInst, const QString & name)
     this->data         = 0;
     this->numBytes     = 0;
     this->mutex        = new QMutex(QMutex::Recursive);
-    m_isKnown = false;
+    m_isKnown   = false;
+    m_timestamp = -1;
 }
 
 /**
@@ -91,7 +92,9 @@ void UAVObject::initializeFields(QList<UAVObjectField *> & fields, quint8 *data,
     this->fields   = fields;
     // Initialize fields
     quint32 offset = 0;
+    fieldsByName.clear();
     for (int n = 0; n < fields.length(); ++n) {
+        fieldsByName.insert(fields[n]->getName(), fields[n]);
         fields[n]->initialize(data, offset, this);
         offset += fields[n]->getNumBytes();
         connect(fields[n], SIGNAL(fieldUpdated(UAVObjectField *)), this, SLOT(fieldUpdated(UAVObjectField *)));
@@ -282,10 +285,9 @@ UAVObjectField *UAVObject::getField(const QString & name)
     QMutexLocker locker(mutex);
 
     // Look for field
-    for (int n = 0; n < fields.length(); ++n) {
-        if (name.compare(fields[n]->getName()) == 0) {
-            return fields[n];
-        }
+    UAVObjectField *field = fieldsByName.value(name, NULL);
+    if (field) {
+        return field;
     }
     // If this point is reached then the field was not found
     qWarning() << "UAVObject::getField Non existant field" << name << "requested."
@@ -295,17 +297,25 @@ UAVObjectField *UAVObject::getField(const QString & name)
 
 /**
  * Pack the object data into a byte array
+ * The data fields are packed structures laid out as on the wire, so on a
+ * little endian host the object is copied at once. Field by field packing
+ * is only needed to swap the bytes on big endian hosts.
  * @returns The number of bytes copied
  */
 qint32 UAVObject::pack(quint8 *dataOut)
 {
     QMutexLocker locker(mutex);
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    memcpy(dataOut, data, numBytes);
+#else
     qint32 offset = 0;
 
     for (int n = 0; n < fields.length(); ++n) {
         fields[n]->pack(&dataOut[offset]);
         offset += fields[n]->getNumBytes();
     }
+#endif
     return numBytes;
 }
 
@@ -316,12 +326,17 @@ qint32 UAVObject::pack(quint8 *dataOut)
 qint32 UAVObject::unpack(const quint8 *dataIn)
 {
     QMutexLocker locker(mutex);
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    memcpy(data, dataIn, numBytes);
+#else
     qint32 offset = 0;
 
     for (int n = 0; n < fields.length(); ++n) {
         fields[n]->unpack(&dataIn[offset]);
         offset += fields[n]->getNumBytes();
     }
+#endif
     emit objectUnpacked(this); // trigger object updated event
     emit objectUpdated(this);
 
@@ -604,6 +619,11 @@ void UAVObject::emitNewInstance(UAVObject *obj)
     emit newInstance(obj);
 }
 
+void UAVObject::emitUpdatedCoalesced()
+{
+    emit objectUpdatedCoalesced(this);
+}
+
 bool UAVObject::isKnown() const
 {
     QMutexLocker locker(mutex);
@@ -623,6 +643,27 @@ void UAVObject::setIsKnown(bool isKnown)
     }
 }
 
+/**
+ * Board time in ms of the data, as sent by the board with the last update.
+ * \return The timestamp or -1 if the last update was not timestamped
+ */
+qint64 UAVObject::getTimestamp() const
+{
+    QMutexLocker locker(mutex);
+
+    return m_timestamp;
+}
+
+/**
+ * Set by the telemetry before unpacking an update, -1 when the update is not timestamped
+ */
+void UAVObject::setTimestamp(qint64 timestamp)
+{
+    QMutexLocker locker(mutex);
+
+    m_timestamp = timestamp;
+}
+
 bool UAVObject::isSettingsObject()
 {
     return false;
@@ -35,6 +35,7 @@
 #include <QMutexLocker>
 #include <QString>
 #include <QList>
+#include <QHash>
 #include <QFile>
 #include <stdint.h>
 #include <QXmlStreamWriter>
@@ -141,10 +142,14 @@ public:
 
     void emitTransactionCompleted(bool success);
     void emitNewInstance(UAVObject *);
+    void emitUpdatedCoalesced();
 
     bool isKnown() const;
     void setIsKnown(bool isKnown);
 
+    qint64 getTimestamp() const;
+    void setTimestamp(qint64 timestamp);
+
     virtual bool isSettingsObject();
     virtual bool isDataObject();
     virtual bool isMetaDataObject();
@@ -178,6 +183,8 @@ signals:
     void objectUpdatedManual(UAVObject *obj, bool all = false);
     void objectUpdatedPeriodic(UAVObject *obj);
     void objectUnpacked(UAVObject *obj);
+    // at most once per display refresh, see UAVObjectManager::connectCoalesced()
+    void objectUpdatedCoalesced(UAVObject *obj);
     void updateRequested(UAVObject *obj, bool all = false);
     void transactionCompleted(UAVObject *obj, bool success);
     void newInstance(UAVObject *obj);
@@ -194,6 +201,7 @@ protected:
     QMutex *mutex;
     quint8 *data;
     QList<UAVObjectField *> fields;
+    QHash<QString, UAVObjectField *> fieldsByName;
 
     void initializeFields(QList<UAVObjectField *> & fields, quint8 *data, quint32 numBytes);
     void setDescription(const QString & description);
@@ -201,6 +209,7 @@ protected:
 
 private:
     bool m_isKnown;
+    qint64 m_timestamp;
 
 private slots:
     void fieldUpdated(UAVObjectField *field);
@@ -68,6 +68,17 @@ class UAVObject(object):
     def get_size(self):
         return self.get_struct().size
 
+    def get_dtype(self):
+        # numpy structured type matching get_struct(), packed little endian
+        import numpy
+        return numpy.dtype([f.get_dtype() for f in self.fields])
+
+    def unpack_all(self, data):
+        # Decode the concatenated payloads of all the logged updates of this
+        # object in a single call, one record per update
+        import numpy
+        return numpy.frombuffer(data, dtype=self.get_dtype())
+
 class UAVObjectField(object):
     def __init__(self, fieldname, type, nelements, elemnames, values):
         self.name      = fieldname
@@ -83,6 +94,11 @@ class UAVObjectField(object):
         fmt += "%s" % (self.type)
         return fmt
 
+    def get_dtype(self):
+        if self.nelements > 1:
+            return (self.name, "<%s" % (self.type), (self.nelements,))
+        return (self.name, "<%s" % (self.type))
+
 # List of registered uavobject instances
 uavobjects = {}
 
@@ -60,6 +60,7 @@ void UAVObjectField::constructorInitialize(const QString & name, const QString &
     this->data         = NULL;
     this->obj = NULL;
     this->elementNames = elementNames;
+    this->limits = limits;
     // Set field size
     switch (type) {
     case INT8:
@@ -96,10 +97,13 @@ void UAVObjectField::constructorInitialize(const QString & name, const QString &
     default:
         numBytesPerElement = 0;
     }
-    limitsInitialize(limits);
 }
 
-void UAVObjectField::limitsInitialize(const QString &limits)
+/**
+ * Parse the limits string on first use, most fields never have their
+ * limits checked and parsing them all slows down the object creation.
+ */
+void UAVObjectField::limitsInitialize()
 {
     // Limit string format:
     // %        - start char
@@ -120,6 +124,7 @@ void UAVObjectField::limitsInitialize(const QString &limits)
         return;
     }
     QStringList stringPerElement = limits.split(";");
+    limits.clear();
     quint32 index = 0;
     foreach(QString str, stringPerElement) {
         QStringList ruleList = str.split(",");
@@ -212,7 +217,8 @@ void UAVObjectField::limitsInitialize(const QString &limits)
 }
 bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
 {
-    if (!elementLimits.keys().contains(index)) {
+    limitsInitialize();
+    if (!elementLimits.contains(index)) {
         return true;
     }
 
@@ -470,7 +476,8 @@ QString UAVObjectField::getLimitsAsString(quint32 index, int board)
 {
     QString limitString;
 
-    if (elementLimits.keys().contains(index)) {
+    limitsInitialize();
+    if (elementLimits.contains(index)) {
         foreach(LimitStruct struc, elementLimits.value(index)) {
             if ((struc.board != board) && board != 0 && struc.board != 0) {
                 continue;
@@ -520,7 +527,8 @@ QString UAVObjectField::getLimitsAsString(quint32 index, int board)
 
 QVariant UAVObjectField::getMaxLimit(quint32 index, int board)
 {
-    if (!elementLimits.keys().contains(index)) {
+    limitsInitialize();
+    if (!elementLimits.contains(index)) {
         return QVariant();
     }
     foreach(LimitStruct struc, elementLimits.value(index)) {
@@ -547,7 +555,8 @@ QVariant UAVObjectField::getMaxLimit(quint32 index, int board)
 }
 QVariant UAVObjectField::getMinLimit(quint32 index, int board)
 {
-    if (!elementLimits.keys().contains(index)) {
+    limitsInitialize();
+    if (!elementLimits.contains(index)) {
         return QVariant();
     }
     foreach(LimitStruct struc, elementLimits.value(index)) {
@@ -1178,9 +1187,121 @@ void UAVObjectField::setValue(const QVariant & value, quint32 index)
     }
 }
 
+/**
+ * Read one element straight from the packed data, enums read as their index.
+ * Must be called with the object mutex held and a valid index.
+ */
+double UAVObjectField::readElement(quint32 index)
+{
+    const quint8 *element = &data[offset + numBytesPerElement * index];
+
+    switch (type) {
+    case INT8:
+    {
+        qint8 tmpint8;
+        memcpy(&tmpint8, element, sizeof(tmpint8));
+        return tmpint8;
+    }
+    case INT16:
+    {
+        qint16 tmpint16;
+        memcpy(&tmpint16, element, sizeof(tmpint16));
+        return tmpint16;
+    }
+    case INT32:
+    {
+        qint32 tmpint32;
+        memcpy(&tmpint32, element, sizeof(tmpint32));
+        return tmpint32;
+    }
+    case UINT8:
+    case ENUM:
+        return *element;
+
+    case UINT16:
+    {
+        quint16 tmpuint16;
+        memcpy(&tmpuint16, element, sizeof(tmpuint16));
+        return tmpuint16;
+    }
+    case UINT32:
+    {
+        quint32 tmpuint32;
+        memcpy(&tmpuint32, element, sizeof(tmpuint32));
+        return tmpuint32;
+    }
+    case FLOAT32:
+    {
+        float tmpfloat;
+        memcpy(&tmpfloat, element, sizeof(tmpfloat));
+        return tmpfloat;
+    }
+    case BITFIELD:
+        return (data[offset + numBytesPerElement * (index / 8)] >> (index % 8)) & 1;
+
+    case STRING:
+        break;
+    }
+    return 0;
+}
+
+/**
+ * Numeric value of an element without going through QVariant, enums give their option index.
+ */
 double UAVObjectField::getDouble(quint32 index)
 {
-    return getValue(index).toDouble();
+    if (type == STRING) {
+        return getValue(index).toDouble();
+    }
+
+    QMutexLocker locker(obj->getMutex());
+
+    if (index >= numElements) {
+        return 0;
+    }
+    return readElement(index);
+}
+
+qint64 UAVObjectField::getInt(quint32 index)
+{
+    return (qint64)getDouble(index);
+}
+
+/**
+ * Option index of an enum element, 0 if the value is out of range like getValue()
+ * @returns The index or -1 if this is not an enum field
+ */
+int UAVObjectField::getEnumIndex(quint32 index)
+{
+    if (type != ENUM) {
+        return -1;
+    }
+
+    QMutexLocker locker(obj->getMutex());
+
+    if (index >= numElements || data[offset + index] >= options.length()) {
+        return 0;
+    }
+    return data[offset + index];
+}
+
+/**
+ * Copy all elements as doubles, taking the object lock once.
+ * @returns The number of elements copied
+ */
+quint32 UAVObjectField::copyElementsTo(double *values, quint32 maxElements)
+{
+    if (type == STRING) {
+        return 0;
+    }
+
+    QMutexLocker locker(obj->getMutex());
+
+    quint32 count = qMin(numElements, maxElements);
+    for (quint32 index = 0; index < count; ++index) {
+        values[index] = readElement(index);
+    }
+    return count;
 }
 
 void UAVObjectField::setDouble(double value, quint32 index)
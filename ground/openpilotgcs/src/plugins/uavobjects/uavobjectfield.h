@@ -71,6 +71,9 @@ public:
     void setValue(const QVariant & data, quint32 index = 0);
     double getDouble(quint32 index = 0);
     void setDouble(double value, quint32 index = 0);
+    qint64 getInt(quint32 index = 0);
+    int getEnumIndex(quint32 index = 0);
+    quint32 copyElementsTo(double *values, quint32 maxElements);
     quint32 getDataOffset();
     quint32 getNumBytes();
     bool isNumeric();
@@ -103,10 +106,12 @@ protected:
     quint32 offset;
     quint8 *data;
     UAVObject *obj;
+    QString limits;
     QMap<quint32, QList<LimitStruct> > elementLimits;
     void clear();
+    double readElement(quint32 index);
     void constructorInitialize(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits);
-    void limitsInitialize(const QString &limits);
+    void limitsInitialize();
 };
 
 #endif // UAVOBJECTFIELD_H
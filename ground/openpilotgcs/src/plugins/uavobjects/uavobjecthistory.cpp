@@ -0,0 +1,388 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjecthistory.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      The UAVUObjects GCS plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "uavobjecthistory.h"
+#include "uavobjectfield.h"
+#include <string.h>
+
+/**
+ * Up to CHUNK_SAMPLES samples of one element, packed into a bit stream.
+ *
+ * The first sample is stored in full. Each following time is stored as the
+ * change of the interval to the previous sample, which is 0 for updates at a
+ * steady rate, and each value as the XOR with the previous value, leaving out
+ * its leading and trailing zero bits.
+ */
+class UAVObjectHistoryChunk {
+public:
+    UAVObjectHistoryChunk() : m_bits(0), m_count(0), m_firstTime(0), m_lastTime(0),
+        m_lastDelta(0), m_lastValue(0), m_leading(-1), m_trailing(0)
+    {}
+
+    bool isFull() const
+    {
+        return m_count >= UAVObjectHistory::CHUNK_SAMPLES;
+    }
+    qint64 firstTime() const
+    {
+        return m_firstTime;
+    }
+    qint64 lastTime() const
+    {
+        return m_lastTime;
+    }
+    qint64 bytes() const
+    {
+        return sizeof(*this) + m_words.capacity() * sizeof(quint64);
+    }
+    void squeeze()
+    {
+        m_words.squeeze();
+    }
+
+    void append(qint64 time, double value);
+    void decode(qint64 from, qint64 to, QVector<UAVObjectHistory::Sample> & samples) const;
+
+private:
+    QVector<quint64> m_words;
+    int m_bits;
+    int m_count;
+    qint64 m_firstTime;
+    qint64 m_lastTime;
+    qint64 m_lastDelta;
+    quint64 m_lastValue;
+    int m_leading;
+    int m_trailing;
+
+    void write(quint64 bits, int length);
+    quint64 read(int & pos, int length) const;
+};
+
+static inline quint64 doubleBits(double value)
+{
+    quint64 bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static inline double bitsDouble(quint64 bits)
+{
+    double value;
+
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void UAVObjectHistoryChunk::write(quint64 bits, int length)
+{
+    if (length < 64) {
+        bits &= ((quint64)1 << length) - 1;
+    }
+    int used = m_bits & 63;
+    if (used == 0) {
+        m_words.append(bits);
+    } else {
+        m_words.last() |= bits << used;
+        if (used + length > 64) {
+            m_words.append(bits >> (64 - used));
+        }
+    }
+    m_bits += length;
+}
+
+quint64 UAVObjectHistoryChunk::read(int & pos, int length) const
+{
+    int used     = pos & 63;
+    quint64 bits = m_words.at(pos >> 6) >> used;
+
+    if (used + length > 64) {
+        bits |= m_words.at((pos >> 6) + 1) << (64 - used);
+    }
+    if (length < 64) {
+        bits &= ((quint64)1 << length) - 1;
+    }
+    pos += length;
+    return bits;
+}
+
+void UAVObjectHistoryChunk::append(qint64 time, double value)
+{
+    quint64 bits = doubleBits(value);
+
+    if (m_count == 0) {
+        write(time, 64);
+        write(bits, 64);
+        m_firstTime = time;
+    } else {
+        // time, change of the interval in 1, 9, 12, 16 or 68 bits
+        qint64 delta = time - m_lastTime;
+        qint64 dod   = delta - m_lastDelta;
+        if (dod == 0) {
+            write(0x0, 1);
+        } else if (dod >= -63 && dod <= 64) {
+            write(0x1, 2);
+            write(dod + 63, 7);
+        } else if (dod >= -2047 && dod <= 2048) {
+            write(0x3, 3);
+            write(dod + 2047, 12);
+        } else if (dod >= -32767 && dod <= 32768) {
+            write(0x7, 4);
+            write(dod + 32767, 16);
+        } else {
+            write(0xf, 4);
+            write(dod, 64);
+        }
+        m_lastDelta = delta;
+
+        // value, XOR with the previous value
+        quint64 x = bits ^ m_lastValue;
+        if (x == 0) {
+            write(0x0, 1);
+        } else {
+            int leading  = qMin(__builtin_clzll(x), 31);
+            int trailing = __builtin_ctzll(x);
+            if (m_leading >= 0 && leading >= m_leading && trailing >= m_trailing) {
+                // the meaningful bits fit in the window of the previous value
+                write(0x1, 2);
+                write(x >> m_trailing, 64 - m_leading - m_trailing);
+            } else {
+                int length = 64 - leading - trailing;
+                write(0x3, 2);
+                write(leading, 5);
+                write(length - 1, 6);
+                write(x >> trailing, length);
+                m_leading  = leading;
+                m_trailing = trailing;
+            }
+        }
+    }
+    m_lastTime  = time;
+    m_lastValue = bits;
+    ++m_count;
+}
+
+void UAVObjectHistoryChunk::decode(qint64 from, qint64 to, QVector<UAVObjectHistory::Sample> & samples) const
+{
+    int pos        = 0;
+    qint64 time    = 0;
+    qint64 delta   = 0;
+    quint64 bits   = 0;
+    int leading    = 0;
+    int trailing   = 0;
+
+    for (int i = 0; i < m_count; ++i) {
+        if (i == 0) {
+            time = read(pos, 64);
+            bits = read(pos, 64);
+        } else {
+            if (read(pos, 1)) {
+                qint64 dod;
+                if (!read(pos, 1)) {
+                    dod = (qint64)read(pos, 7) - 63;
+                } else if (!read(pos, 1)) {
+                    dod = (qint64)read(pos, 12) - 2047;
+                } else if (!read(pos, 1)) {
+                    dod = (qint64)read(pos, 16) - 32767;
+                } else {
+                    dod = read(pos, 64);
+                }
+                delta += dod;
+            }
+            time += delta;
+
+            if (read(pos, 1)) {
+                if (read(pos, 1)) {
+                    leading  = read(pos, 5);
+                    trailing = 64 - leading - ((int)read(pos, 6) + 1);
+                }
+                bits ^= read(pos, 64 - leading - trailing) << trailing;
+            }
+        }
+        if (time > to) {
+            break;
+        }
+        if (time >= from) {
+            UAVObjectHistory::Sample sample = { time, bitsDouble(bits) };
+            samples.append(sample);
+        }
+    }
+}
+
+UAVObjectHistory::UAVObjectHistory(QObject *parent) : QObject(parent),
+    m_maxBytes(DEFAULT_MAX_BYTES), m_usedBytes(0)
+{}
+
+UAVObjectHistory::~UAVObjectHistory()
+{
+    clear();
+}
+
+/**
+ * Add the current value of every numeric element of an object
+ */
+void UAVObjectHistory::record(UAVObject *obj, qint64 time)
+{
+    QMutexLocker locker(&m_mutex);
+
+    ObjectHistory *history = objectHistory(obj);
+    Series *series = history->series.data();
+
+    foreach(UAVObjectField * field, obj->getFields()) {
+        quint32 count = field->copyElementsTo(m_values.data(), m_values.size());
+
+        for (quint32 n = 0; n < count; ++n) {
+            append(*series++, time, m_values.at(n));
+        }
+    }
+    trim();
+}
+
+/**
+ * Samples of one element between from and to (inclusive), oldest first
+ */
+QVector<UAVObjectHistory::Sample> UAVObjectHistory::query(quint32 objId, quint32 instId, const QString & fieldName, quint32 element,
+                                                          qint64 from, qint64 to) const
+{
+    QMutexLocker locker(&m_mutex);
+    QVector<Sample> samples;
+
+    ObjectHistory *history = m_objects.value(key(objId, instId));
+    if (history == NULL || !history->fields.contains(fieldName)) {
+        return samples;
+    }
+    QPair<int, int> field = history->fields.value(fieldName);
+    if (element >= (quint32)field.second) {
+        return samples;
+    }
+    foreach(const UAVObjectHistoryChunk * chunk, history->series.at(field.first + element)) {
+        if (chunk->lastTime() >= from && chunk->firstTime() <= to) {
+            chunk->decode(from, to, samples);
+        }
+    }
+    return samples;
+}
+
+QVector<UAVObjectHistory::Sample> UAVObjectHistory::query(UAVObjectField *field, quint32 element, qint64 from, qint64 to) const
+{
+    return query(field->getObject()->getObjID(), field->getObject()->getInstID(), field->getName(), element, from, to);
+}
+
+void UAVObjectHistory::setMaxBytes(qint64 maxBytes)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_maxBytes = maxBytes;
+    trim();
+}
+
+qint64 UAVObjectHistory::maxBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_maxBytes;
+}
+
+qint64 UAVObjectHistory::usedBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_usedBytes;
+}
+
+void UAVObjectHistory::clear()
+{
+    QMutexLocker locker(&m_mutex);
+
+    foreach(ObjectHistory * history, m_objects) {
+        for (int i = 0; i < history->series.size(); ++i) {
+            qDeleteAll(history->series.at(i));
+        }
+        delete history;
+    }
+    m_objects.clear();
+    m_fullChunks.clear();
+    m_usedBytes = 0;
+}
+
+/**
+ * History of an object instance, set up on its first update
+ */
+UAVObjectHistory::ObjectHistory *UAVObjectHistory::objectHistory(UAVObject *obj)
+{
+    ObjectHistory *history = m_objects.value(key(obj->getObjID(), obj->getInstID()));
+
+    if (history == NULL) {
+        history = new ObjectHistory;
+        int count = 0;
+        foreach(UAVObjectField * field, obj->getFields()) {
+            if (field->getType() != UAVObjectField::STRING) {
+                history->fields.insert(field->getName(), qMakePair(count, (int)field->getNumElements()));
+                count += field->getNumElements();
+                if (m_values.size() < (int)field->getNumElements()) {
+                    m_values.resize(field->getNumElements());
+                }
+            }
+        }
+        history->series.resize(count);
+        m_objects.insert(key(obj->getObjID(), obj->getInstID()), history);
+    }
+    return history;
+}
+
+void UAVObjectHistory::append(Series & series, qint64 time, double value)
+{
+    if (series.isEmpty() || series.last()->isFull()) {
+        if (!series.isEmpty()) {
+            m_usedBytes -= series.last()->bytes();
+            series.last()->squeeze();
+            m_usedBytes += series.last()->bytes();
+            m_fullChunks.enqueue(&series);
+        }
+        series.append(new UAVObjectHistoryChunk);
+        m_usedBytes += series.last()->bytes();
+    }
+    UAVObjectHistoryChunk *chunk = series.last();
+    m_usedBytes -= chunk->bytes();
+    chunk->append(time, value);
+    m_usedBytes += chunk->bytes();
+}
+
+/**
+ * Drop the oldest full chunks until the store is within its budget.
+ * Chunks fill up in time order, so the oldest full chunk is always the
+ * first chunk of its series.
+ */
+void UAVObjectHistory::trim()
+{
+    while (m_usedBytes > m_maxBytes && !m_fullChunks.isEmpty()) {
+        Series *series = m_fullChunks.dequeue();
+        UAVObjectHistoryChunk *chunk = series->takeFirst();
+        m_usedBytes -= chunk->bytes();
+        delete chunk;
+    }
+}
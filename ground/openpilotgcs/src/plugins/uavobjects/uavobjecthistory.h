@@ -0,0 +1,108 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjecthistory.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      The UAVUObjects GCS plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVOBJECTHISTORY_H
+#define UAVOBJECTHISTORY_H
+
+#include "uavobjects_global.h"
+#include "uavobject.h"
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QQueue>
+#include <QMutex>
+
+class UAVObjectHistoryChunk;
+
+/**
+ * History of every numeric field element of the received objects, so any
+ * gadget can ask what an element did over the last minutes.
+ *
+ * Each element is a series of chunks holding up to CHUNK_SAMPLES samples,
+ * compressed as they are recorded: the times as delta of deltas and the
+ * values XORed with the previous one (as in Facebook's Gorilla). Once the
+ * store is above its byte budget the oldest chunks are dropped.
+ *
+ * Times are GCS times in ms since the epoch, taken when the update was
+ * received. record() is called from the telemetry thread, query() may be
+ * called from any thread.
+ */
+class UAVOBJECTS_EXPORT UAVObjectHistory : public QObject {
+    Q_OBJECT
+
+public:
+    static const int CHUNK_SAMPLES = 256;
+    static const qint64 DEFAULT_MAX_BYTES = 32 * 1024 * 1024;
+
+    typedef struct {
+        qint64 time;
+        double value;
+    } Sample;
+
+    UAVObjectHistory(QObject *parent = 0);
+    ~UAVObjectHistory();
+
+    void record(UAVObject *obj, qint64 time);
+
+    QVector<Sample> query(quint32 objId, quint32 instId, const QString & fieldName, quint32 element,
+                          qint64 from, qint64 to) const;
+    QVector<Sample> query(UAVObjectField *field, quint32 element, qint64 from, qint64 to) const;
+
+    void setMaxBytes(qint64 maxBytes);
+    qint64 maxBytes() const;
+    qint64 usedBytes() const;
+    void clear();
+
+private:
+    typedef QList<UAVObjectHistoryChunk *> Series;
+
+    // history of one object instance, a series per element of its numeric fields,
+    // fields maps each numeric field to its first series and element count
+    typedef struct {
+        QHash<QString, QPair<int, int> > fields;
+        QVector<Series> series;
+    } ObjectHistory;
+
+    mutable QMutex m_mutex;
+    QHash<quint64, ObjectHistory *> m_objects;
+    // series owning each full chunk, oldest first
+    QQueue<Series *> m_fullChunks;
+    QVector<double> m_values;
+    qint64 m_maxBytes;
+    qint64 m_usedBytes;
+
+    ObjectHistory *objectHistory(UAVObject *obj);
+    void append(Series & series, qint64 time, double value);
+    void trim();
+
+    static quint64 key(quint32 objId, quint32 instId)
+    {
+        return ((quint64)objId << 32) | instId;
+    }
+};
+
+#endif // UAVOBJECTHISTORY_H
@@ -28,6 +28,7 @@
 #include "uavobjectmanager.h"
 
 #include <QtWidgetsDepends>
+#include <QJsonDocument>
 
 /**
  * Constructor
@@ -35,6 +36,10 @@
 UAVObjectManager::UAVObjectManager()
 {
     mutex = new QMutex(QMutex::Recursive);
+
+    coalescedTimer.setSingleShot(true);
+    coalescedTimer.setInterval(COALESCED_UPDATE_PERIOD);
+    connect(&coalescedTimer, SIGNAL(timeout()), this, SLOT(sendCoalescedUpdates()));
 }
 
 UAVObjectManager::~UAVObjectManager()
@@ -53,54 +58,53 @@ bool UAVObjectManager::registerObject(UAVDataObject *obj)
     QMutexLocker locker(mutex);
 
     // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0 && objects[objidx][0]->getObjID() == obj->getObjID()) {
-            // Check if this is a single instance object, if yes we can not add a new instance
-            if (obj->isSingleInstance()) {
-                return false;
-            }
-            // The object type has alredy been added, so now we need to initialize the new instance with the appropriate id
-            // There is a single metaobject for all object instances of this type, so no need to create a new one
-            // Get object type metaobject from existing instance
-            UAVDataObject *refObj = dynamic_cast<UAVDataObject *>(objects[objidx][0]);
-            if (refObj == NULL) {
-                return false;
-            }
-            UAVMetaObject *mobj = refObj->getMetaObject();
-            // If the instance ID is specified and not at the default value (0) then we need to make sure
-            // that there are no gaps in the instance list. If gaps are found then then additional instances
-            // will be created.
-            if ((obj->getInstID() > 0) && (obj->getInstID() < MAX_INSTANCES)) {
-                for (int instidx = 0; instidx < objects[objidx].length(); ++instidx) {
-                    if (objects[objidx][instidx]->getInstID() == obj->getInstID()) {
-                        // Instance conflict, do not add
-                        return false;
-                    }
-                }
-                // Check if there are any gaps between the requested instance ID and the ones in the list,
-                // if any then create the missing instances.
-                for (quint32 instidx = objects[objidx].length(); instidx < obj->getInstID(); ++instidx) {
-                    UAVDataObject *cobj = obj->clone(instidx);
-                    cobj->initialize(mobj);
-                    objects[objidx].append(cobj);
-                    getObject(cobj->getObjID())->emitNewInstance(cobj);
-                    emit newInstance(cobj);
+    int objidx = findObject(NULL, obj->getObjID());
+
+    if (objidx >= 0) {
+        // Check if this is a single instance object, if yes we can not add a new instance
+        if (obj->isSingleInstance()) {
+            return false;
+        }
+        // The object type has alredy been added, so now we need to initialize the new instance with the appropriate id
+        // There is a single metaobject for all object instances of this type, so no need to create a new one
+        // Get object type metaobject from existing instance
+        UAVDataObject *refObj = dynamic_cast<UAVDataObject *>(objects[objidx][0]);
+        if (refObj == NULL) {
+            return false;
+        }
+        UAVMetaObject *mobj = refObj->getMetaObject();
+        // If the instance ID is specified and not at the default value (0) then we need to make sure
+        // that there are no gaps in the instance list. If gaps are found then then additional instances
+        // will be created.
+        if ((obj->getInstID() > 0) && (obj->getInstID() < MAX_INSTANCES)) {
+            for (int instidx = 0; instidx < objects[objidx].length(); ++instidx) {
+                if (objects[objidx][instidx]->getInstID() == obj->getInstID()) {
+                    // Instance conflict, do not add
+                    return false;
                 }
-                // Finally, initialize the actual object instance
-                obj->initialize(mobj);
-            } else if (obj->getInstID() == 0) {
-                // Assign the next available ID and initialize the object instance
-                obj->initialize(objects[objidx].length(), mobj);
-            } else {
-                return false;
             }
-            // Add the actual object instance in the list
-            objects[objidx].append(obj);
-            getObject(obj->getObjID())->emitNewInstance(obj);
-            emit newInstance(obj);
-            return true;
+            // Check if there are any gaps between the requested instance ID and the ones in the list,
+            // if any then create the missing instances.
+            for (quint32 instidx = objects[objidx].length(); instidx < obj->getInstID(); ++instidx) {
+                UAVDataObject *cobj = obj->clone(instidx);
+                cobj->initialize(mobj);
+                objects[objidx].append(cobj);
+                getObject(cobj->getObjID())->emitNewInstance(cobj);
+                emit newInstance(cobj);
+            }
+            // Finally, initialize the actual object instance
+            obj->initialize(mobj);
+        } else if (obj->getInstID() == 0) {
+            // Assign the next available ID and initialize the object instance
+            obj->initialize(objects[objidx].length(), mobj);
+        } else {
+            return false;
         }
+        // Add the actual object instance in the list
+        objects[objidx].append(obj);
+        getObject(obj->getObjID())->emitNewInstance(obj);
+        emit newInstance(obj);
+        return true;
     }
     // If this point is reached then this is the first time this object type (ID) is added in the list
     // create a new list of the instances, add in the object collection and create the object's metaobject
@@ -122,9 +126,24 @@ void UAVObjectManager::addObject(UAVObject *obj)
     QList<UAVObject *> list;
     list.append(obj);
     objects.append(list);
+    objectIndex.insert(obj->getObjID(), objects.length() - 1);
+    nameIndex.insert(obj->getName(), objects.length() - 1);
     emit newObject(obj);
 }
 
+/**
+ * Position of an object type in the object list, looked up by name if given or else by ID.
+ * Must be called with the mutex held.
+ * @returns The position or -1 if not found
+ */
+int UAVObjectManager::findObject(const QString *name, quint32 objId) const
+{
+    if (name != NULL) {
+        return nameIndex.value(*name, -1);
+    }
+    return objectIndex.value(objId, -1);
+}
+
 /**
  * Get all objects. A two dimentional QList is returned. Objects are grouped by
  * instances of the same object type.
@@ -227,17 +246,18 @@ UAVObject *UAVObjectManager::getObject(const QString *name, quint32 objId, quint
 {
     QMutexLocker locker(mutex);
 
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
-                // Look for the requested instance ID
-                for (int instidx = 0; instidx < objects[objidx].length(); ++instidx) {
-                    if (objects[objidx][instidx]->getInstID() == instId) {
-                        return objects[objidx][instidx];
-                    }
-                }
+    int objidx = findObject(name, objId);
+
+    if (objidx >= 0) {
+        const QList<UAVObject *> &instances = objects[objidx];
+        // Instances are registered without gaps, so the instance ID is the position in the list
+        if (instId < (quint32)instances.length() && instances[instId]->getInstID() == instId) {
+            return instances[instId];
+        }
+        // Look for the requested instance ID
+        for (int instidx = 0; instidx < instances.length(); ++instidx) {
+            if (instances[instidx]->getInstID() == instId) {
+                return instances[instidx];
             }
         }
     }
@@ -269,14 +289,10 @@ QList<UAVObject *> UAVObjectManager::getObjectInstances(const QString *name, qui
 {
     QMutexLocker locker(mutex);
 
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
-                return objects[objidx];
-            }
-        }
+    int objidx = findObject(name, objId);
+
+    if (objidx >= 0) {
+        return objects[objidx];
     }
     // If this point is reached then the requested object could not be found
     return QList<UAVObject *>();
@@ -298,7 +314,59 @@ qint32 UAVObjectManager::getNumInstances(quint32 objId)
     return getNumInstances(NULL, objId);
 }
 
-void UAVObjectManager::toJson(QJsonObject &jsonObject, UAVObjectManager::JSON_EXPORT_OPTION what)
+/**
+ * Connect to the updates of an object, delivered at most once per display refresh.
+ * Meant for views that only show the latest value, receivers that need every
+ * update (e.g. to plot or log them) must connect to objectUpdated() instead.
+ */
+void UAVObjectManager::connectCoalesced(UAVObject *obj, const QObject *receiver, const char *method)
+{
+    // Direct, so that updates unpacked by the telemetry thread are only queued here
+    // instead of posting one event per update to this thread
+    connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(queueCoalescedUpdate(UAVObject *)),
+            (Qt::ConnectionType)(Qt::DirectConnection | Qt::UniqueConnection));
+    connect(obj, SIGNAL(objectUpdatedCoalesced(UAVObject *)), receiver, method);
+}
+
+/**
+ * Called in the thread that updated the object.
+ */
+void UAVObjectManager::queueCoalescedUpdate(UAVObject *obj)
+{
+    QMutexLocker locker(&coalescedMutex);
+
+    if (coalescedPending.contains(obj)) {
+        return;
+    }
+    if (coalescedUpdates.isEmpty()) {
+        // first update of this refresh, a single event starts the timer in the manager's thread
+        QMetaObject::invokeMethod(this, "startCoalescedTimer", Qt::QueuedConnection);
+    }
+    coalescedPending.insert(obj);
+    coalescedUpdates.append(obj);
+}
+
+void UAVObjectManager::startCoalescedTimer()
+{
+    if (!coalescedTimer.isActive()) {
+        coalescedTimer.start();
+    }
+}
+
+void UAVObjectManager::sendCoalescedUpdates()
+{
+    coalescedMutex.lock();
+    QList<UAVObject *> updates = coalescedUpdates;
+    coalescedUpdates.clear();
+    coalescedPending.clear();
+    coalescedMutex.unlock();
+
+    foreach(UAVObject * obj, updates) {
+        obj->emitUpdatedCoalesced();
+    }
+}
+
+QList<UAVObject *> UAVObjectManager::getObjectsToExport(UAVObjectManager::JSON_EXPORT_OPTION what)
 {
     QList<UAVObject *> objects;
     QList< QList<UAVObject *> > allObjects = getObjects();
@@ -312,7 +380,12 @@ void UAVObjectManager::toJson(QJsonObject &jsonObject, UAVObjectManager::JSON_EX
             }
         }
     }
-    toJson(jsonObject, objects);
+    return objects;
+}
+
+void UAVObjectManager::toJson(QJsonObject &jsonObject, UAVObjectManager::JSON_EXPORT_OPTION what)
+{
+    toJson(jsonObject, getObjectsToExport(what));
 }
 
 void UAVObjectManager::toJson(QJsonObject &jsonObject, const QList<QString> &objectsToExport)
@@ -345,15 +418,115 @@ void UAVObjectManager::fromJson(const QJsonObject &jsonObject, QList<UAVObject *
     QJsonArray jObjects = jsonObject["objects"].toArray();
 
     for (int i = 0; i < jObjects.size(); i++) {
-        QJsonObject jObject = jObjects.at(i).toObject();
-        UAVObject *object   = getObject(jObject["name"].toString(), jObject["instance"].toInt());
-        if (object != NULL) {
-            object->fromJson(jObject);
-            if (updatedObjects != NULL) {
-                updatedObjects->append(object);
+        readJsonObject(jObjects.at(i).toObject(), updatedObjects);
+    }
+}
+
+void UAVObjectManager::readJsonObject(const QJsonObject &jObject, QList<UAVObject *> *updatedObjects)
+{
+    UAVObject *object = getObject(jObject["name"].toString(), jObject["instance"].toInt());
+
+    if (object != NULL) {
+        object->fromJson(jObject);
+        if (updatedObjects != NULL) {
+            updatedObjects->append(object);
+        }
+    }
+}
+
+bool UAVObjectManager::toJson(QIODevice *device, UAVObjectManager::JSON_EXPORT_OPTION what)
+{
+    return toJson(device, getObjectsToExport(what));
+}
+
+/**
+ * Write the same document as toJson(QJsonObject &) straight to the device,
+ * one object at a time, instead of building the whole tree first.
+ * Returns false if the device refused the data.
+ */
+bool UAVObjectManager::toJson(QIODevice *device, const QList<UAVObject *> &objectsToExport)
+{
+    bool ok = device->write("{\n\"objects\": [\n") >= 0;
+
+    for (int i = 0; ok && i < objectsToExport.size(); i++) {
+        QJsonObject jObject;
+
+        objectsToExport.at(i)->toJson(jObject);
+        if (i > 0) {
+            ok = device->write(",\n") >= 0;
+        }
+        ok = ok && device->write(QJsonDocument(jObject).toJson(QJsonDocument::Compact)) >= 0;
+    }
+    return ok && device->write("\n]\n}\n") >= 0;
+}
+
+/**
+ * Read a document written by toJson() from the device, applying each entry
+ * of its "objects" array as soon as it is complete. Only the entry being
+ * read is held in memory, the rest of the document is skipped over.
+ * Returns false if the document is truncated or an entry is not valid JSON.
+ */
+bool UAVObjectManager::fromJson(QIODevice *device, QList<UAVObject *> *updatedObjects)
+{
+    static const QByteArray objectsKey("objects");
+    char buffer[JSON_READ_CHUNK];
+    QByteArray entry;
+    QByteArray key;
+    bool inString  = false;
+    bool escaped   = false;
+    bool inObjects = false;
+    int depth = 0;
+    qint64 length;
+
+    // depth 1 is the document, 2 the "objects" array and 3 and more an entry
+    while ((length = device->read(buffer, sizeof(buffer))) > 0) {
+        for (qint64 i = 0; i < length; i++) {
+            char c = buffer[i];
+            int previousDepth = depth;
+
+            if (inString) {
+                if (escaped) {
+                    escaped = false;
+                } else if (c == '\\') {
+                    escaped = true;
+                } else if (c == '"') {
+                    inString = false;
+                } else if (depth == 1 && key.size() <= objectsKey.size()) {
+                    // only the keys of the document are needed, and only as long as "objects"
+                    key.append(c);
+                }
+            } else if (c == '"') {
+                inString = true;
+                if (depth == 1) {
+                    key.clear();
+                }
+            } else if (c == '{' || c == '[') {
+                if (depth == 1 && c == '[' && key == objectsKey) {
+                    inObjects = true;
+                }
+                depth++;
+            } else if (c == '}' || c == ']') {
+                depth--;
+                if (depth <= 1) {
+                    inObjects = false;
+                }
+            }
+
+            if (inObjects && (depth >= 3 || previousDepth >= 3)) {
+                entry.append(c);
+                if (previousDepth == 3 && depth == 2) {
+                    QJsonParseError error;
+                    QJsonDocument document = QJsonDocument::fromJson(entry, &error);
+                    if (error.error != QJsonParseError::NoError || !document.isObject()) {
+                        return false;
+                    }
+                    readJsonObject(document.object(), updatedObjects);
+                    entry.clear();
+                }
             }
         }
     }
+    return length == 0 && depth == 0 && !inString;
 }
 
 /**
@@ -363,14 +536,10 @@ qint32 UAVObjectManager::getNumInstances(const QString *name, quint32 objId)
 {
     QMutexLocker locker(mutex);
 
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
-                return objects[objidx].length();
-            }
-        }
+    int objidx = findObject(name, objId);
+
+    if (objidx >= 0) {
+        return objects[objidx].length();
     }
     // If this point is reached then the requested object could not be found
     return -1;
@@ -33,9 +33,13 @@
 #include "uavdataobject.h"
 #include "uavmetaobject.h"
 #include <QList>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QJsonObject>
+#include <QIODevice>
 
 class UAVOBJECTS_EXPORT UAVObjectManager : public QObject {
     Q_OBJECT
@@ -56,25 +60,53 @@ public:
     qint32 getNumInstances(const QString & name);
     qint32 getNumInstances(quint32 objId);
 
+    void connectCoalesced(UAVObject *obj, const QObject *receiver, const char *method);
+
     void toJson(QJsonObject &jsonObject, JSON_EXPORT_OPTION what = JSON_EXPORT_ALL);
     void toJson(QJsonObject &jsonObject, const QList<QString> &objectsToExport);
     void toJson(QJsonObject &jsonObject, const QList<UAVObject *> &objectsToExport);
     void fromJson(const QJsonObject &jsonObject, QList<UAVObject *> *updatedObjects = NULL);
+    // streamed variants, only one object is serialized in memory at a time
+    bool toJson(QIODevice *device, JSON_EXPORT_OPTION what = JSON_EXPORT_ALL);
+    bool toJson(QIODevice *device, const QList<UAVObject *> &objectsToExport);
+    bool fromJson(QIODevice *device, QList<UAVObject *> *updatedObjects = NULL);
 
 signals:
     void newObject(UAVObject *obj);
     void newInstance(UAVObject *obj);
 
+private slots:
+    void queueCoalescedUpdate(UAVObject *obj);
+    void startCoalescedTimer();
+    void sendCoalescedUpdates();
+
 private:
     static const quint32 MAX_INSTANCES = 1000;
+    // display refresh period for coalesced updates
+    static const int COALESCED_UPDATE_PERIOD = 40;
+    // bytes read at once by the streamed JSON import
+    static const int JSON_READ_CHUNK = 4096;
 
     QList< QList<UAVObject *> > objects;
+    // position of each object type in objects, by ID and by name
+    QHash<quint32, int> objectIndex;
+    QHash<QString, int> nameIndex;
     QMutex *mutex;
 
+    // objects updated since the last display refresh, in update order
+    // filled from the telemetry thread, drained by the manager's (GUI) thread
+    QList<UAVObject *> coalescedUpdates;
+    QSet<UAVObject *> coalescedPending;
+    QMutex coalescedMutex;
+    QTimer coalescedTimer;
+
     void addObject(UAVObject *obj);
+    int findObject(const QString *name, quint32 objId) const;
     UAVObject *getObject(const QString *name, quint32 objId, quint32 instId);
     QList<UAVObject *> getObjectInstances(const QString *name, quint32 objId);
     qint32 getNumInstances(const QString *name, quint32 objId);
+    QList<UAVObject *> getObjectsToExport(JSON_EXPORT_OPTION what);
+    void readJsonObject(const QJsonObject &jObject, QList<UAVObject *> *updatedObjects);
 };
 
 
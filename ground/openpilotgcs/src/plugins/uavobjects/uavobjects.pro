@@ -14,14 +14,18 @@ HEADERS += \
     uavdataobject.h \
     uavobjectfield.h \
     uavobjectsinit.h \
-    uavobjectsplugin.h
+    uavobjectsplugin.h \
+    uavobjectsamplestream.h \
+    uavobjecthistory.h
 SOURCES += \
     uavobject.cpp \
     uavmetaobject.cpp \
     uavobjectmanager.cpp \
     uavdataobject.cpp \
     uavobjectfield.cpp \
-    uavobjectsplugin.cpp
+    uavobjectsplugin.cpp \
+    uavobjectsamplestream.cpp \
+    uavobjecthistory.cpp
 
 OTHER_FILES += UAVObjects.pluginspec
 
@@ -47,9 +51,11 @@ HEADERS += \
     $$UAVOBJECT_SYNTHETICS/ekfstatevariance.h \
     $$UAVOBJECT_SYNTHETICS/revocalibration.h \
     $$UAVOBJECT_SYNTHETICS/revosettings.h \
+    $$UAVOBJECT_SYNTHETICS/tempcompensationtable.h \
     $$UAVOBJECT_SYNTHETICS/gcstelemetrystats.h \
     $$UAVOBJECT_SYNTHETICS/gyrostate.h \
     $$UAVOBJECT_SYNTHETICS/gyrosensor.h \
+    $$UAVOBJECT_SYNTHETICS/gyrospectrum.h \
     $$UAVOBJECT_SYNTHETICS/accelsensor.h \
     $$UAVOBJECT_SYNTHETICS/accelstate.h \
     $$UAVOBJECT_SYNTHETICS/magsensor.h \
@@ -64,6 +70,9 @@ HEADERS += \
     $$UAVOBJECT_SYNTHETICS/systemsettings.h \
     $$UAVOBJECT_SYNTHETICS/stabilizationstatus.h \
     $$UAVOBJECT_SYNTHETICS/stabilizationsettings.h \
+    $$UAVOBJECT_SYNTHETICS/systemident.h \
+    $$UAVOBJECT_SYNTHETICS/systemidentsettings.h \
+    $$UAVOBJECT_SYNTHETICS/samplestream.h \
     $$UAVOBJECT_SYNTHETICS/stabilizationsettingsbank1.h \
     $$UAVOBJECT_SYNTHETICS/stabilizationsettingsbank2.h \
     $$UAVOBJECT_SYNTHETICS/stabilizationsettingsbank3.h \
@@ -98,10 +107,12 @@ HEADERS += \
     $$UAVOBJECT_SYNTHETICS/vtolpathfollowersettings.h \
     $$UAVOBJECT_SYNTHETICS/ratedesired.h \
     $$UAVOBJECT_SYNTHETICS/firmwareiapobj.h \
+    $$UAVOBJECT_SYNTHETICS/settingsmanifest.h \
     $$UAVOBJECT_SYNTHETICS/i2cstats.h \
     $$UAVOBJECT_SYNTHETICS/flightbatterysettings.h \
     $$UAVOBJECT_SYNTHETICS/taskinfo.h \
     $$UAVOBJECT_SYNTHETICS/callbackinfo.h \
+    $$UAVOBJECT_SYNTHETICS/callbackhistogram.h \
     $$UAVOBJECT_SYNTHETICS/flightplanstatus.h \
     $$UAVOBJECT_SYNTHETICS/flightplansettings.h \
     $$UAVOBJECT_SYNTHETICS/flightplancontrol.h \
@@ -112,6 +123,7 @@ HEADERS += \
     $$UAVOBJECT_SYNTHETICS/hwsettings.h \
     $$UAVOBJECT_SYNTHETICS/gcsreceiver.h \
     $$UAVOBJECT_SYNTHETICS/receiveractivity.h \
+    $$UAVOBJECT_SYNTHETICS/receiverstatus.h \
     $$UAVOBJECT_SYNTHETICS/attitudesettings.h \
     $$UAVOBJECT_SYNTHETICS/txpidsettings.h \
     $$UAVOBJECT_SYNTHETICS/cameradesired.h \
@@ -130,7 +142,10 @@ HEADERS += \
     $$UAVOBJECT_SYNTHETICS/auxmagsensor.h \
     $$UAVOBJECT_SYNTHETICS/auxmagsettings.h \
     $$UAVOBJECT_SYNTHETICS/gpsextendedstatus.h \
-    $$UAVOBJECT_SYNTHETICS/perfcounter.h
+    $$UAVOBJECT_SYNTHETICS/perfcounter.h \
+    $$UAVOBJECT_SYNTHETICS/perfprofile.h \
+    $$UAVOBJECT_SYNTHETICS/perftrace.h \
+    $$UAVOBJECT_SYNTHETICS/perftracecontrol.h
 
 SOURCES += \
     $$UAVOBJECT_SYNTHETICS/vtolselftuningstats.cpp \
@@ -153,11 +168,13 @@ SOURCES += \
     $$UAVOBJECT_SYNTHETICS/ekfstatevariance.cpp \
     $$UAVOBJECT_SYNTHETICS/revocalibration.cpp \
     $$UAVOBJECT_SYNTHETICS/revosettings.cpp \
+    $$UAVOBJECT_SYNTHETICS/tempcompensationtable.cpp \
     $$UAVOBJECT_SYNTHETICS/gcstelemetrystats.cpp \
     $$UAVOBJECT_SYNTHETICS/accelsensor.cpp \
     $$UAVOBJECT_SYNTHETICS/accelstate.cpp \
     $$UAVOBJECT_SYNTHETICS/gyrostate.cpp \
     $$UAVOBJECT_SYNTHETICS/gyrosensor.cpp \
+    $$UAVOBJECT_SYNTHETICS/gyrospectrum.cpp \
     $$UAVOBJECT_SYNTHETICS/magsensor.cpp \
     $$UAVOBJECT_SYNTHETICS/magstate.cpp \
     $$UAVOBJECT_SYNTHETICS/camerastabsettings.cpp \
@@ -170,6 +187,9 @@ SOURCES += \
     $$UAVOBJECT_SYNTHETICS/systemsettings.cpp \
     $$UAVOBJECT_SYNTHETICS/stabilizationstatus.cpp \
     $$UAVOBJECT_SYNTHETICS/stabilizationsettings.cpp \
+    $$UAVOBJECT_SYNTHETICS/systemident.cpp \
+    $$UAVOBJECT_SYNTHETICS/systemidentsettings.cpp \
+    $$UAVOBJECT_SYNTHETICS/samplestream.cpp \
     $$UAVOBJECT_SYNTHETICS/stabilizationsettingsbank1.cpp \
     $$UAVOBJECT_SYNTHETICS/stabilizationsettingsbank2.cpp \
     $$UAVOBJECT_SYNTHETICS/stabilizationsettingsbank3.cpp \
@@ -204,10 +224,12 @@ SOURCES += \
     $$UAVOBJECT_SYNTHETICS/vtolpathfollowersettings.cpp \
     $$UAVOBJECT_SYNTHETICS/ratedesired.cpp \
     $$UAVOBJECT_SYNTHETICS/firmwareiapobj.cpp \
+    $$UAVOBJECT_SYNTHETICS/settingsmanifest.cpp \
     $$UAVOBJECT_SYNTHETICS/i2cstats.cpp \
     $$UAVOBJECT_SYNTHETICS/flightbatterysettings.cpp \
     $$UAVOBJECT_SYNTHETICS/taskinfo.cpp \
     $$UAVOBJECT_SYNTHETICS/callbackinfo.cpp \
+    $$UAVOBJECT_SYNTHETICS/callbackhistogram.cpp \
     $$UAVOBJECT_SYNTHETICS/flightplanstatus.cpp \
     $$UAVOBJECT_SYNTHETICS/flightplansettings.cpp \
     $$UAVOBJECT_SYNTHETICS/flightplancontrol.cpp \
@@ -219,6 +241,7 @@ SOURCES += \
     $$UAVOBJECT_SYNTHETICS/hwsettings.cpp \
     $$UAVOBJECT_SYNTHETICS/gcsreceiver.cpp \
     $$UAVOBJECT_SYNTHETICS/receiveractivity.cpp \
+    $$UAVOBJECT_SYNTHETICS/receiverstatus.cpp \
     $$UAVOBJECT_SYNTHETICS/attitudesettings.cpp \
     $$UAVOBJECT_SYNTHETICS/txpidsettings.cpp \
     $$UAVOBJECT_SYNTHETICS/cameradesired.cpp \
@@ -237,5 +260,8 @@ SOURCES += \
     $$UAVOBJECT_SYNTHETICS/auxmagsensor.cpp \
     $$UAVOBJECT_SYNTHETICS/auxmagsettings.cpp \
     $$UAVOBJECT_SYNTHETICS/gpsextendedstatus.cpp \
-    $$UAVOBJECT_SYNTHETICS/perfcounter.cpp
+    $$UAVOBJECT_SYNTHETICS/perfcounter.cpp \
+    $$UAVOBJECT_SYNTHETICS/perfprofile.cpp \
+    $$UAVOBJECT_SYNTHETICS/perftrace.cpp \
+    $$UAVOBJECT_SYNTHETICS/perftracecontrol.cpp
 
@@ -0,0 +1,113 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectsamplestream.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      The UAVUObjects GCS plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "uavobjectsamplestream.h"
+#include "uavobjectfield.h"
+
+UAVObjectSampleStream::UAVObjectSampleStream()
+{
+    reset();
+}
+
+/**
+ * Whether the object packs several samples into an update
+ */
+bool UAVObjectSampleStream::isSampleStream(UAVObject *obj)
+{
+    return obj && obj->getField("Sequence") && obj->getField("Timestamp") && obj->getField("Interval");
+}
+
+/**
+ * Forget the stream followed so far
+ */
+void UAVObjectSampleStream::reset()
+{
+    m_wraps         = 0;
+    m_lastTimestamp = -1;
+    m_lastSequence  = -1;
+    m_nextTimestamp = -1;
+    m_discontinuous = true;
+    m_lostUpdates   = 0;
+    m_times.clear();
+}
+
+/**
+ * Work out the sample times of the current data of the object, to be called
+ * once for every update of the stream
+ * \return false if the object is no sample stream
+ */
+bool UAVObjectSampleStream::decode(UAVObject *obj)
+{
+    if (!isSampleStream(obj)) {
+        return false;
+    }
+
+    const int sequence    = (int)obj->getField("Sequence")->getDouble();
+    const qint64 raw      = (qint64)obj->getField("Timestamp")->getDouble();
+    const double interval = obj->getField("Interval")->getDouble();
+
+    // the channels all have a sample per element
+    int samples = 0;
+    foreach(UAVObjectField * field, obj->getFields()) {
+        const QString name = field->getName();
+
+        if (name != "Sequence" && name != "Timestamp" && name != "Interval") {
+            samples = field->getNumElements();
+            break;
+        }
+    }
+
+    // the board clock wraps every 71 minutes, a reboot starts it over
+    if (m_lastTimestamp >= 0 && raw < m_lastTimestamp) {
+        if (m_lastTimestamp - raw > 0x80000000LL) {
+            m_wraps += 0x100000000LL;
+        } else {
+            m_wraps = 0;
+            m_nextTimestamp = -1;
+        }
+    }
+    m_lastTimestamp = raw;
+    const qint64 timestamp = raw + m_wraps;
+
+    if (m_lastSequence >= 0) {
+        const int step = (sequence - m_lastSequence) & 0xffff;
+        if (step > 1) {
+            m_lostUpdates += step - 1;
+        }
+    }
+    m_lastSequence  = sequence;
+
+    // more than half an interval off the end of the previous update is a gap, or samples the board dropped
+    m_discontinuous = m_nextTimestamp < 0 || qAbs(timestamp - m_nextTimestamp) > interval / 2;
+    m_nextTimestamp = timestamp + (qint64)(samples * interval + 0.5);
+
+    m_times.resize(samples);
+    for (int i = 0; i < samples; i++) {
+        m_times[i] = (timestamp + i * interval) / 1000000.0;
+    }
+    return true;
+}
@@ -0,0 +1,83 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectsamplestream.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      The UAVUObjects GCS plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVOBJECTSAMPLESTREAM_H
+#define UAVOBJECTSAMPLESTREAM_H
+
+#include "uavobjects_global.h"
+#include "uavobject.h"
+#include <QVector>
+
+/**
+ * Sample times of the objects packing several samples into an update, such
+ * as SampleStream. Such an object has a Sequence counter, the Timestamp of
+ * its first sample in us and the Interval between the samples in us, every
+ * other field holds one channel with a sample per element.
+ *
+ * A decoder follows one stream: it keeps the timestamps going across the
+ * 32 bit wrap of the board clock, and counts the updates the link lost.
+ */
+class UAVOBJECTS_EXPORT UAVObjectSampleStream {
+public:
+    UAVObjectSampleStream();
+
+    static bool isSampleStream(UAVObject *obj);
+
+    bool decode(UAVObject *obj);
+    void reset();
+
+    // Samples of the last decoded update, and the time of each in seconds of board time
+    int count() const
+    {
+        return m_times.size();
+    }
+    double time(int i) const
+    {
+        return m_times.at(i);
+    }
+
+    // Set when the last update does not follow on the previous one
+    bool isDiscontinuous() const
+    {
+        return m_discontinuous;
+    }
+    quint32 lostUpdates() const
+    {
+        return m_lostUpdates;
+    }
+
+private:
+    qint64 m_wraps;
+    qint64 m_lastTimestamp;
+    int m_lastSequence;
+    qint64 m_nextTimestamp;
+    bool m_discontinuous;
+    quint32 m_lostUpdates;
+    QVector<double> m_times;
+};
+
+#endif // UAVOBJECTSAMPLESTREAM_H
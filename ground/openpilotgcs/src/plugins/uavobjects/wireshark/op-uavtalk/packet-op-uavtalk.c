@@ -177,6 +177,9 @@ void proto_register_op_uavtalk(void)
                                                "UAVTALK",
                                                "uavtalk");
 
+    /* Named, so that the pcapng captures of the GCS (DLT_USER0) can be mapped to it in the DLT_USER preferences */
+    new_register_dissector("op-uavtalk", dissect_op_uavtalk, proto_op_uavtalk);
+
     /* Allow subdissectors for each objid to bind for decoding */
     uavtalk_subdissector_table = register_dissector_table("uavtalk.objid", "UAVObject ID", FT_UINT32, BASE_HEX);
 
@@ -56,11 +56,21 @@ UAVObjectUtilManager::UAVObjectUtilManager()
     obm  = NULL;
     obum = NULL;
 
+    firmwareIapValid = false;
+    boardDescriptionValid = false;
+
     pm   = ExtensionSystem::PluginManager::instance();
     if (pm) {
         obm  = pm->getObject<UAVObjectManager>();
         obum = pm->getObject<UAVObjectUtilManager>();
     }
+
+    // A new connection or firmware sends FirmwareIAPObj again, the update is direct
+    // so the board information is never stale when read right after
+    FirmwareIAPObj *firmwareIapObj = obm ? FirmwareIAPObj::GetInstance(obm) : NULL;
+    if (firmwareIapObj) {
+        connect(firmwareIapObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(invalidateBoardInfo()), Qt::DirectConnection);
+    }
 }
 
 UAVObjectUtilManager::~UAVObjectUtilManager()
@@ -105,6 +115,21 @@ void UAVObjectUtilManager::saveObjectToSD(UAVObject *obj)
     }
 }
 
+/*
+   Save all the settings objects in a single request, the board writes only
+   those that differ from their stored copy. Queued like single objects, as
+   a NULL entry, and completed with an object ID of 0.
+ */
+void UAVObjectUtilManager::saveAllSettingsToSD()
+{
+    queue.enqueue(NULL);
+    qDebug() << "Enqueue all settings";
+
+    if (queue.length() == 1) {
+        saveNextObject();
+    }
+}
+
 void UAVObjectUtilManager::saveNextObject()
 {
     if (queue.isEmpty()) {
@@ -115,21 +140,25 @@ void UAVObjectUtilManager::saveNextObject()
 
     // Get next object from the queue
     UAVObject *obj = queue.head();
-    qDebug() << "Send save object request to board " << obj->getName();
+    qDebug() << "Send save object request to board " << (obj ? obj->getName() : QString("(all settings)"));
 
     ObjectPersistence *objper = dynamic_cast<ObjectPersistence *>(getObjectManager()->getObject(ObjectPersistence::NAME));
     connect(objper, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(objectPersistenceTransactionCompleted(UAVObject *, bool)));
     connect(objper, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(objectPersistenceUpdated(UAVObject *)));
     saveState = AWAITING_ACK;
+    ObjectPersistence::DataFields data;
+    data.Operation = ObjectPersistence::OPERATION_SAVE;
     if (obj != NULL) {
-        ObjectPersistence::DataFields data;
-        data.Operation  = ObjectPersistence::OPERATION_SAVE;
         data.Selection  = ObjectPersistence::SELECTION_SINGLEOBJECT;
         data.ObjectID   = obj->getObjID();
         data.InstanceID = obj->getInstID();
-        objper->setData(data);
-        objper->updated();
+    } else {
+        data.Selection  = ObjectPersistence::SELECTION_ALLSETTINGS;
+        data.ObjectID   = 0;
+        data.InstanceID = 0;
     }
+    objper->setData(data);
+    objper->updated();
     // Now: we are going to get two "objectUpdated" messages (one coming from GCS, one coming from Flight, which
     // will confirm the object was properly received by both sides) and then one "transactionCompleted" indicating
     // that the Flight side did not only receive the object but it did receive it without error. Last we will get
@@ -158,7 +187,8 @@ void UAVObjectUtilManager::objectPersistenceTransactionCompleted(UAVObject *obj,
         // the queue:
         saveState = AWAITING_COMPLETED;
         disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(objectPersistenceTransactionCompleted(UAVObject *, bool)));
-        failureTimer.start(2000); // Create a timeout
+        // Saving all the settings may have to write many objects
+        failureTimer.start(queue.head() ? 2000 : 10000); // Create a timeout
     } else {
         // Can be caused by timeout errors on sending.  Forget it and send next.
         qDebug() << "objectPersistenceTranscationCompleted (error)";
@@ -186,12 +216,11 @@ void UAVObjectUtilManager::objectPersistenceOperationFailed()
         Q_ASSERT(objectPersistence);
 
         UAVObject *obj = queue.dequeue(); // We can now remove the object, it failed anyway.
-        Q_ASSERT(obj);
 
         objectPersistence->disconnect(this);
 
         saveState = IDLE;
-        emit saveCompleted(obj->getObjID(), false);
+        emit saveCompleted(obj ? obj->getObjID() : 0, false);
 
         saveNextObject();
     }
@@ -217,7 +246,7 @@ void UAVObjectUtilManager::objectPersistenceUpdated(UAVObject *obj)
         failureTimer.stop();
         // Check right object saved
         UAVObject *savingObj = queue.head();
-        if (objectPersistence.ObjectID != savingObj->getObjID()) {
+        if (objectPersistence.ObjectID != (savingObj ? savingObj->getObjID() : 0)) {
             objectPersistenceOperationFailed();
             return;
         }
@@ -231,21 +260,38 @@ void UAVObjectUtilManager::objectPersistenceUpdated(UAVObject *obj)
     }
 }
 
+void UAVObjectUtilManager::invalidateBoardInfo()
+{
+    QMutexLocker locker(mutex);
+
+    firmwareIapValid = false;
+    boardDescriptionValid = false;
+}
+
 /**
  * Helper function that makes sure FirmwareIAP is updated and then returns the data
+ * The data is kept until the object is updated again.
  */
 FirmwareIAPObj::DataFields UAVObjectUtilManager::getFirmwareIap()
 {
+    QMutexLocker locker(mutex);
+
+    if (firmwareIapValid) {
+        return firmwareIap;
+    }
+
     FirmwareIAPObj::DataFields dummy;
 
-    FirmwareIAPObj *firmwareIap = FirmwareIAPObj::GetInstance(obm);
+    FirmwareIAPObj *firmwareIapObj = FirmwareIAPObj::GetInstance(obm);
 
-    Q_ASSERT(firmwareIap);
-    if (!firmwareIap) {
+    Q_ASSERT(firmwareIapObj);
+    if (!firmwareIapObj) {
         return dummy;
     }
 
-    return firmwareIap->getData();
+    firmwareIap = firmwareIapObj->getData();
+    firmwareIapValid = true;
+    return firmwareIap;
 }
 
 /**
@@ -428,10 +474,15 @@ int UAVObjectUtilManager::getGPSPositionSensor(double LLA[3])
 
 deviceDescriptorStruct UAVObjectUtilManager::getBoardDescriptionStruct()
 {
-    deviceDescriptorStruct ret;
+    QMutexLocker locker(mutex);
 
-    descriptionToStructure(getBoardDescription(), ret);
-    return ret;
+    // Parsed once per FirmwareIAPObj update
+    if (!boardDescriptionValid) {
+        boardDescription = deviceDescriptorStruct();
+        descriptionToStructure(getBoardDescription(), boardDescription);
+        boardDescriptionValid = true;
+    }
+    return boardDescription;
 }
 
 bool UAVObjectUtilManager::descriptionToStructure(QByteArray desc, deviceDescriptorStruct & struc)
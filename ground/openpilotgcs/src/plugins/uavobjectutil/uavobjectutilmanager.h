@@ -67,6 +67,7 @@ public:
     static bool descriptionToStructure(QByteArray desc, deviceDescriptorStruct & struc);
     UAVObjectManager *getObjectManager();
     void saveObjectToSD(UAVObject *obj);
+    void saveAllSettingsToSD();
 protected:
     FirmwareIAPObj::DataFields getFirmwareIap();
 
@@ -84,11 +85,18 @@ private:
     UAVObjectManager *obm;
     UAVObjectUtilManager *obum;
 
+    // The board information of the connected board, until FirmwareIAPObj changes
+    bool firmwareIapValid;
+    FirmwareIAPObj::DataFields firmwareIap;
+    bool boardDescriptionValid;
+    deviceDescriptorStruct boardDescription;
+
 private slots:
     // void transactionCompleted(UAVObject *obj, bool success);
     void objectPersistenceTransactionCompleted(UAVObject *obj, bool success);
     void objectPersistenceUpdated(UAVObject *obj);
     void objectPersistenceOperationFailed();
+    void invalidateBoardInfo();
 };
 
 
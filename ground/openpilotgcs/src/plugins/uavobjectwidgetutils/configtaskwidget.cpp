@@ -134,7 +134,7 @@ void ConfigTaskWidget::doAddWidgetBinding(QString objectName, QString fieldName,
         Q_ASSERT(object);
         m_updatedObjects.insert(object, true);
         connect(object, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(objectUpdated(UAVObject *)));
-        connect(object, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(refreshWidgetsValues(UAVObject *)), Qt::UniqueConnection);
+        connect(object, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(refreshWidgetsValuesWhenShown(UAVObject *)), Qt::UniqueConnection);
     }
 
     if (!fieldName.isEmpty() && object) {
@@ -269,7 +269,7 @@ void ConfigTaskWidget::onAutopilotConnect()
     m_isConnected = true;
     setDirty(false);
     enableControls(true);
-    refreshWidgetsValues();
+    refreshWidgetsValuesWhenShown(NULL);
 }
 
 void ConfigTaskWidget::populateWidgets()
@@ -294,8 +294,22 @@ void ConfigTaskWidget::refreshWidgetsValues(UAVObject *obj)
     bool dirtyBack = isDirty();
     emit refreshWidgetsValuesRequested();
     QList<WidgetBinding *> bindings = obj == NULL ? m_widgetBindingsPerObject.values() : m_widgetBindingsPerObject.values(obj);
+
+    // Unless they were edited, the widgets still show the fields which did not
+    // change since the object was last refreshed: only the others are set.
+    QByteArray shownData;
+    QByteArray objectData;
+    if (obj != NULL) {
+        if (!dirtyBack) {
+            shownData = m_shownObjectData.value(obj);
+        }
+        objectData = packedObjectData(obj);
+    }
     foreach(WidgetBinding * binding, bindings) {
         if (binding->field() != NULL && binding->widget() != NULL) {
+            if (!shownData.isEmpty() && !hasBindingChanged(binding, shownData, objectData)) {
+                continue;
+            }
             if (binding->isEnabled()) {
                 setWidgetFromField(binding->widget(), binding->field(), binding);
             } else {
@@ -303,11 +317,86 @@ void ConfigTaskWidget::refreshWidgetsValues(UAVObject *obj)
             }
         }
     }
+    if (obj != NULL) {
+        m_shownObjectData.insert(obj, objectData);
+    } else {
+        foreach(UAVObject * object, m_widgetBindingsPerObject.uniqueKeys()) {
+            if (object) {
+                m_shownObjectData.insert(object, packedObjectData(object));
+            }
+        }
+    }
     setDirty(dirtyBack);
 }
 
+/**
+ * Object updates refresh the widgets right away while the page is shown. A hidden
+ * page only remembers the objects to refresh, until it is shown (see event()).
+ * NULL stands for all the objects.
+ */
+void ConfigTaskWidget::refreshWidgetsValuesWhenShown(UAVObject *obj)
+{
+    if (isVisible()) {
+        refreshWidgetsValues(obj);
+    } else {
+        m_pendingRefreshObjects.insert(obj);
+    }
+}
+
+void ConfigTaskWidget::refreshPendingWidgetsValues()
+{
+    if (m_pendingRefreshObjects.isEmpty()) {
+        return;
+    }
+    QSet<UAVObject *> objects = m_pendingRefreshObjects;
+    m_pendingRefreshObjects.clear();
+    if (objects.contains(NULL)) {
+        refreshWidgetsValues();
+    } else {
+        foreach(UAVObject * object, objects) {
+            refreshWidgetsValues(object);
+        }
+    }
+}
+
+QByteArray ConfigTaskWidget::packedObjectData(UAVObject *obj)
+{
+    QByteArray data(obj->getNumBytes(), 0);
+
+    obj->pack((quint8 *)data.data());
+    return data;
+}
+
+bool ConfigTaskWidget::hasBindingChanged(WidgetBinding *binding, const QByteArray &shownData, const QByteArray &objectData)
+{
+    UAVObjectField *field = binding->field();
+    quint32 offset = field->getDataOffset();
+    quint32 size   = field->getNumBytes();
+
+    // the elements of a bitfield share their bytes
+    if (field->getType() != UAVObjectField::BITFIELD) {
+        size   /= field->getNumElements();
+        offset += binding->index() * size;
+    }
+    if (offset + size > (quint32)shownData.size() || offset + size > (quint32)objectData.size()) {
+        return true;
+    }
+    return memcmp(shownData.constData() + offset, objectData.constData() + offset, size) != 0;
+}
+
+bool ConfigTaskWidget::event(QEvent *event)
+{
+    // Caught here rather than in showEvent(), which the pages override
+    if (event->type() == QEvent::Show) {
+        refreshPendingWidgetsValues();
+    }
+    return QWidget::event(event);
+}
+
 void ConfigTaskWidget::updateObjectsFromWidgets()
 {
+    // The bindings of a hidden page must not write back values older than the objects
+    refreshPendingWidgetsValues();
     emit updateObjectsFromWidgetsRequested();
 
     foreach(WidgetBinding * binding, m_widgetBindingsPerObject) {
@@ -476,7 +565,7 @@ void ConfigTaskWidget::disableObjectUpdates()
     m_isWidgetUpdatesAllowed = false;
     foreach(WidgetBinding * binding, m_widgetBindingsPerWidget) {
         if (binding->object()) {
-            disconnect(binding->object(), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(refreshWidgetsValues(UAVObject *)));
+            disconnect(binding->object(), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(refreshWidgetsValuesWhenShown(UAVObject *)));
         }
     }
 }
@@ -486,7 +575,7 @@ void ConfigTaskWidget::enableObjectUpdates()
     m_isWidgetUpdatesAllowed = true;
     foreach(WidgetBinding * binding, m_widgetBindingsPerWidget) {
         if (binding->object()) {
-            connect(binding->object(), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(refreshWidgetsValues(UAVObject *)), Qt::UniqueConnection);
+            connect(binding->object(), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(refreshWidgetsValuesWhenShown(UAVObject *)), Qt::UniqueConnection);
         }
     }
 }
@@ -517,6 +606,8 @@ void ConfigTaskWidget::invalidateObjects()
     foreach(UAVObject * obj, m_updatedObjects.keys()) {
         m_updatedObjects[obj] = false;
     }
+    // and refresh all the widgets on the next update
+    m_shownObjectData.clear();
 }
 
 void ConfigTaskWidget::apply()
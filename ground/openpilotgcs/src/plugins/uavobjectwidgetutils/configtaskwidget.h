@@ -34,6 +34,7 @@
 #include <QQueue>
 #include <QWidget>
 #include <QList>
+#include <QSet>
 #include <QLabel>
 #include "smartsavebutton.h"
 #include "mixercurvewidget.h"
@@ -106,6 +107,7 @@ public:
 
     void disableMouseWheelEvents();
     bool eventFilter(QObject *obj, QEvent *evt);
+    bool event(QEvent *event);
 
     void saveObjectToSD(UAVObject *obj);
     UAVObjectManager *getObjectManager();
@@ -178,6 +180,7 @@ signals:
 
 private slots:
     void objectUpdated(UAVObject *object);
+    void refreshWidgetsValuesWhenShown(UAVObject *obj);
     void defaultButtonClicked();
     void reloadButtonClicked();
 
@@ -217,6 +220,9 @@ private:
     UAVObjectUtilManager *m_objectUtilManager;
     SmartSaveButton *m_saveButton;
     QHash<UAVObject *, bool> m_updatedObjects;
+    // the object data the widgets were last refreshed from
+    QHash<UAVObject *, QByteArray> m_shownObjectData;
+    QSet<UAVObject *> m_pendingRefreshObjects;
     QHash<QPushButton *, QString> m_helpButtons;
     QList<QPushButton *> m_reloadButtons;
     bool m_isDirty;
@@ -224,6 +230,9 @@ private:
     QTimer *m_realtimeUpdateTimer;
 
     bool setWidgetFromField(QWidget *widget, UAVObjectField *field, WidgetBinding *binding);
+    void refreshPendingWidgetsValues();
+    static QByteArray packedObjectData(UAVObject *obj);
+    static bool hasBindingChanged(WidgetBinding *binding, const QByteArray &shownData, const QByteArray &objectData);
 
     QVariant getVariantFromWidget(QWidget *widget, WidgetBinding *binding);
     bool setWidgetFromVariant(QWidget *widget, QVariant value, WidgetBinding *binding);
@@ -112,6 +112,16 @@ void ImportSummaryDialog::doTheSaving()
     if (itemCount == 0) {
         return;
     }
+    if (itemCount == ui->importSummaryList->rowCount() && itemCount > 1) {
+        // Everything imported is to be saved, one request saves all the
+        // settings and the board only writes the objects that changed.
+        ui->progressBar->setMaximum(2);
+        ui->progressBar->setValue(1);
+        utilManager->saveAllSettingsToSD();
+        ui->saveToFlash->setEnabled(false);
+        ui->closeButton->setEnabled(false);
+        return;
+    }
     ui->progressBar->setMaximum(itemCount + 1);
     ui->progressBar->setValue(1);
     for (int i = 0; i < ui->importSummaryList->rowCount(); i++) {
@@ -157,9 +157,11 @@ void UAVSettingsImportExportFactory::importUAVSettings()
                 swui.addLine(uavObjectName, "Error (Object unknown)", false);
             } else {
                 // - Update each field
-                // - Issue and "updated" command
+                // - Issue and "updated" command if anything changed
                 bool error     = false;
                 bool setError  = false;
+                QByteArray oldData(obj->getNumBytes(), 0);
+                obj->pack((quint8 *)oldData.data());
                 QDomNode field = node.firstChild();
                 while (!field.isNull()) {
                     QDomElement f = field.toElement();
@@ -194,7 +196,11 @@ void UAVSettingsImportExportFactory::importUAVSettings()
                     }
                     field = field.nextSibling();
                 }
-                obj->updated();
+                QByteArray newData(obj->getNumBytes(), 0);
+                obj->pack((quint8 *)newData.data());
+                if (newData != oldData) {
+                    obj->updated();
+                }
 
                 if (error) {
                     swui.addLine(uavObjectName, "Warning (Object field unknown)", true);
@@ -0,0 +1,169 @@
+/**
+ ******************************************************************************
+ *
+ * @file       objectcache.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "objectcache.h"
+#include <utils/crc.h>
+#include <utils/pathutils.h>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+
+ObjectCache::ObjectCache() : modified(false)
+{}
+
+/**
+ * Load the cache of the board described by firmwareIAPObj
+ * \return false if the board is not identified
+ */
+bool ObjectCache::open(FirmwareIAPObj *firmwareIAPObj)
+{
+    close();
+
+    FirmwareIAPObj::DataFields firmwareIapData = firmwareIAPObj->getData();
+    QByteArray serial((const char *)firmwareIapData.CPUSerial, FirmwareIAPObj::CPUSERIAL_NUMELEM);
+    QByteArray description((const char *)firmwareIapData.Description, FirmwareIAPObj::DESCRIPTION_NUMELEM);
+    if (serial.count('\0') == serial.length()) {
+        return false;
+    }
+
+    QDir dir(Utils::PathUtils().GetStoragePath() + "objectcache");
+    if (!dir.exists() && !dir.mkpath(dir.absolutePath())) {
+        qWarning() << "ObjectCache - can't create" << dir.absolutePath();
+        return false;
+    }
+    QByteArray firmware = QCryptographicHash::hash(description, QCryptographicHash::Sha1).left(8);
+    fileName = dir.absoluteFilePath(QString("%1-%2.cache").arg(QString(serial.toHex())).arg(QString(firmware.toHex())));
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        // first connection to this board and firmware
+        return true;
+    }
+    QDataStream in(&file);
+    quint32 magic;
+    quint32 version;
+    quint32 count;
+    in >> magic >> version >> count;
+    if (magic != FILE_MAGIC || version != FILE_VERSION) {
+        return true;
+    }
+    for (quint32 n = 0; n < count && in.status() == QDataStream::Ok; ++n) {
+        quint64 id;
+        Entry entry;
+        in >> id >> entry.crc >> entry.data;
+        // skip entries damaged on disk rather than restoring them
+        if (in.status() == QDataStream::Ok && dataCRC(entry.data) == entry.crc) {
+            entries.insert(id, entry);
+        }
+    }
+    return true;
+}
+
+void ObjectCache::close()
+{
+    fileName.clear();
+    entries.clear();
+    modified = false;
+}
+
+/**
+ * Write the cache back to disk if anything was stored since it was opened
+ */
+bool ObjectCache::save()
+{
+    if (!isOpen() || !modified) {
+        return true;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "ObjectCache - can't write" << fileName;
+        return false;
+    }
+    QDataStream out(&file);
+    out << FILE_MAGIC << FILE_VERSION << (quint32)entries.count();
+    QHash<quint64, Entry>::const_iterator i;
+    for (i = entries.constBegin(); i != entries.constEnd(); ++i) {
+        out << i.key() << i.value().crc << i.value().data;
+    }
+    modified = false;
+    return out.status() == QDataStream::Ok;
+}
+
+/**
+ * Unpack the cached data into obj if the board holds the same data
+ * \param[in] crc The CRC of the object data reported by the board
+ * \return true if obj was restored from the cache
+ */
+bool ObjectCache::restore(UAVObject *obj, quint32 crc)
+{
+    QHash<quint64, Entry>::const_iterator i = entries.constFind(key(obj));
+
+    if (i == entries.constEnd() || i.value().crc != crc || (quint32)i.value().data.size() != obj->getNumBytes()) {
+        return false;
+    }
+    obj->unpack((const quint8 *)i.value().data.constData());
+    return true;
+}
+
+/**
+ * Record the current data of obj, as just retrieved from the board
+ */
+void ObjectCache::store(UAVObject *obj)
+{
+    if (!isOpen()) {
+        return;
+    }
+
+    Entry entry;
+    entry.data.resize(obj->getNumBytes());
+    obj->pack((quint8 *)entry.data.data());
+    entry.crc = dataCRC(entry.data);
+
+    quint64 id = key(obj);
+    QHash<quint64, Entry>::const_iterator i = entries.constFind(id);
+    if (i == entries.constEnd() || i.value().crc != entry.crc || i.value().data != entry.data) {
+        entries.insert(id, entry);
+        modified = true;
+    }
+}
+
+/**
+ * CRC of object data, as computed by the flight side for the SettingsManifest
+ */
+quint32 ObjectCache::dataCRC(const QByteArray &data)
+{
+    return Utils::Crc::updateCRC32(0, (const quint8 *)data.constData(), data.size());
+}
+
+quint64 ObjectCache::key(UAVObject *obj)
+{
+    return ((quint64)obj->getObjID() << 16) | obj->getInstID();
+}
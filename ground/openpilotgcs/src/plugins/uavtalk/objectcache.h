@@ -0,0 +1,80 @@
+/**
+ ******************************************************************************
+ *
+ * @file       objectcache.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef OBJECTCACHE_H
+#define OBJECTCACHE_H
+
+#include "uavobject.h"
+#include "firmwareiapobj.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+/**
+ * Copy of the settings objects retrieved from a board, kept on disk so the objects
+ * for which the board reports the same CRC don't have to be retrieved on reconnect.
+ *
+ * There is one file per board, named after its CPU serial and a hash of its firmware
+ * description, so a firmware update (and its possibly different layouts) starts afresh.
+ * An entry is only ever used if its CRC matches the one reported by the board.
+ */
+class ObjectCache {
+public:
+    ObjectCache();
+
+    bool open(FirmwareIAPObj *firmwareIAPObj);
+    void close();
+    bool save();
+
+    bool isOpen() const
+    {
+        return !fileName.isEmpty();
+    }
+
+    bool restore(UAVObject *obj, quint32 crc);
+    void store(UAVObject *obj);
+
+    static quint32 dataCRC(const QByteArray &data);
+
+private:
+    static const quint32 FILE_MAGIC   = 0x4f50430a;
+    static const quint32 FILE_VERSION = 1;
+
+    typedef struct {
+        quint32    crc;
+        QByteArray data;
+    } Entry;
+
+    QString fileName;
+    QHash<quint64, Entry> entries;
+    bool modified;
+
+    static quint64 key(UAVObject *obj);
+};
+
+#endif // OBJECTCACHE_H
@@ -28,11 +28,16 @@
 #include "telemetry.h"
 #include "oplinksettings.h"
 #include "objectpersistence.h"
+#include "gcsreceiver.h"
+#include "manualcontrolcommand.h"
 #include <QTime>
 #include <QtGlobal>
 #include <stdlib.h>
 #include <QDebug>
 
+// Latency budget of each transmit priority, in ms
+static const int PRIORITY_LATENCY_MS[] = { 0, 50, 250, 2000 };
+
 /**
  * Constructor
  */
@@ -40,6 +45,19 @@ Telemetry::Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr) : objMngr(objMng
 {
     mutex = new QMutex(QMutex::Recursive);
 
+    // Setup the transmit scheduler, the link rate is refined as transactions complete
+    for (int n = 0; n < PRIORITY_COUNT; ++n) {
+        queueSize[n] = 0;
+    }
+    linkRate     = DEFAULT_LINK_RATE;
+    txTokens     = linkRate * TX_BURST_MS / 1000.0;
+    txLimited    = false;
+    txLastRefill = 0;
+    txClock.start();
+    txTimer      = new QTimer(this);
+    txTimer->setSingleShot(true);
+    connect(txTimer, SIGNAL(timeout()), this, SLOT(txTimeout()));
+
     // Register all objects in the list
     foreach(QList<UAVObject *> instances, objMngr->getObjects()) {
         foreach(UAVObject * object, instances) {
@@ -243,6 +261,8 @@ void Telemetry::transactionCompleted(UAVObject *obj, bool success)
     ObjectTransactionInfo *transInfo = findTransaction(obj);
 
     if (transInfo) {
+        updateLinkRate(transInfo, success);
+
         if (success) {
             // We now know tat the flight side knows of this object.
             obj->setIsKnown(true);
@@ -280,6 +300,7 @@ void Telemetry::transactionTimeout(ObjectTransactionInfo *transInfo)
 #endif
         ++txRetries;
         --transInfo->retriesRemaining;
+        updateLinkRate(transInfo, false);
 
         // Retry the transaction
         processObjectTransaction(transInfo);
@@ -287,6 +308,7 @@ void Telemetry::transactionTimeout(ObjectTransactionInfo *transInfo)
         qWarning().nospace() << "Telemetry - !!! transaction timed out for object " << transInfo->obj->toStringBrief();
 
         ++txErrors;
+        updateLinkRate(transInfo, false);
 
         // Terminate transaction
         utalk->cancelTransaction(transInfo->obj);
@@ -326,7 +348,8 @@ void Telemetry::processObjectTransaction(ObjectTransactionInfo *transInfo)
     if (transInfo->objRequest || transInfo->acked) {
         if (sent) {
             // Start timer if a response is expected
-            transInfo->timer->start(REQ_TIMEOUT_MS);
+            transInfo->sentTime.start();
+            transInfo->timer->start(transactionTimeoutMs());
         } else {
             // message was not sent, the transaction will not complete and will timeout
             // there is no need to wait to close the transaction and notify of completion failure
@@ -341,7 +364,7 @@ void Telemetry::processObjectTransaction(ObjectTransactionInfo *transInfo)
 /**
  * Process the event received from an object
  */
-void Telemetry::processObjectUpdates(UAVObject *obj, EventMask event, bool allInstances, bool priority)
+void Telemetry::processObjectUpdates(UAVObject *obj, EventMask event, bool allInstances)
 {
     // Push event into queue
     ObjectQueueInfo objInfo;
@@ -349,22 +372,38 @@ void Telemetry::processObjectUpdates(UAVObject *obj, EventMask event, bool allIn
     objInfo.obj   = obj;
     objInfo.event = event;
     objInfo.allInstances = allInstances;
-    if (priority) {
-        if (objPriorityQueue.length() < MAX_QUEUE_SIZE) {
-            objPriorityQueue.enqueue(objInfo);
-        } else {
-            ++txErrors;
-            qWarning().nospace() << "Telemetry - !!! priority event queue is full, event lost " << obj->toStringBrief();
-            obj->emitTransactionCompleted(false);
+    objInfo.priority     = objectPriority(obj, event);
+    objInfo.deadline     = txClock.elapsed() + PRIORITY_LATENCY_MS[objInfo.priority];
+    objInfo.txSize = transmitSize(obj, event, allInstances);
+
+    // Events of an object are processed in the order they occur, so the new one can't be due before older ones
+    for (int n = 0; n < objQueue.length(); ++n) {
+        const ObjectQueueInfo &queued = objQueue.at(n);
+        if (queued.obj == obj) {
+            if (event == EV_UPDATED_PERIODIC && queued.event == EV_UPDATED_PERIODIC) {
+                // The pending periodic update will send the latest data anyway
+                return;
+            }
+            objInfo.deadline = qMax(objInfo.deadline, queued.deadline);
         }
-    } else {
-        if (objQueue.length() < MAX_QUEUE_SIZE) {
-            objQueue.enqueue(objInfo);
-        } else {
-            ++txErrors;
-            qWarning().nospace() << "Telemetry - !!! event queue is full, event lost " << obj->toStringBrief();
-            obj->emitTransactionCompleted(false);
+    }
+
+    int maxQueueSize = MAX_QUEUE_SIZE;
+    if (objInfo.priority == PRIORITY_LOW) {
+        maxQueueSize = MAX_SETTINGS_QUEUE_SIZE;
+    }
+    if (queueSize[objInfo.priority] < maxQueueSize) {
+        // Insert after all events due earlier or at the same time
+        int n = objQueue.length();
+        while (n > 0 && objQueue.at(n - 1).deadline > objInfo.deadline) {
+            --n;
         }
+        objQueue.insert(n, objInfo);
+        ++queueSize[objInfo.priority];
+    } else {
+        ++txErrors;
+        qWarning().nospace() << "Telemetry - !!! event queue is full, event lost " << obj->toStringBrief();
+        obj->emitTransactionCompleted(false);
     }
 
     // Process the transaction
@@ -372,49 +411,78 @@ void Telemetry::processObjectUpdates(UAVObject *obj, EventMask event, bool allIn
 }
 
 /**
- * Process events from the object queue
+ * Process events from the object queue, earliest deadline first and as fast as the link allows
  */
 void Telemetry::processObjectQueue()
 {
-    // Get object information from queue (first the priority and then the regular queue)
-    ObjectQueueInfo objInfo;
-
-    if (!objPriorityQueue.isEmpty()) {
-        objInfo = objPriorityQueue.dequeue();
-    } else if (!objQueue.isEmpty()) {
-        objInfo = objQueue.dequeue();
-    } else {
-        return;
-    }
+    refillTxTokens();
 
     // Check if a connection has been established, only process GCSTelemetryStats updates
     // (used to establish the connection)
     GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
-    if (gcsStats.Status != GCSTelemetryStats::STATUS_CONNECTED) {
-        objQueue.clear();
-        if ((objInfo.obj->getObjID() != GCSTelemetryStats::OBJID) &&
-            (objInfo.obj->getObjID() != OPLinkSettings::OBJID) &&
-            (objInfo.obj->getObjID() != ObjectPersistence::OBJID)) {
-            objInfo.obj->emitTransactionCompleted(false);
-            return;
+    bool connected = (gcsStats.Status == GCSTelemetryStats::STATUS_CONNECTED);
+    bool paced     = false;
+
+    int n = 0;
+    while (n < objQueue.length()) {
+        const ObjectQueueInfo &next = objQueue.at(n);
+
+        if (!connected &&
+            (next.obj->getObjID() != GCSTelemetryStats::OBJID) &&
+            (next.obj->getObjID() != OPLinkSettings::OBJID) &&
+            (next.obj->getObjID() != ObjectPersistence::OBJID)) {
+            ObjectQueueInfo objInfo = objQueue.takeAt(n);
+            --queueSize[objInfo.priority];
+            if (objInfo.event != EV_UPDATED_PERIODIC) {
+                objInfo.obj->emitTransactionCompleted(false);
+            }
+            continue;
         }
-    }
 
-    // Setup transaction (skip if unpack event)
-    UAVObject::Metadata metadata     = objInfo.obj->getMetadata();
-    UAVObject::UpdateMode updateMode = UAVObject::GetGcsTelemetryUpdateMode(metadata);
-    if ((objInfo.event != EV_UNPACKED) && ((objInfo.event != EV_UPDATED_PERIODIC) || (updateMode != UAVObject::UPDATEMODE_THROTTLED))) {
-        // Check if a transaction for that object already exists
+        // Check if a transaction for that object already exists, if so wait for it to complete
         // It is allowed to have multiple transaction on the same object ID provided that the instance IDs are different
         // If an "all instances" transaction is running, then it is not allowed to start another transaction with same object ID
         // If a single instance transaction is running, then starting an "all instance" transaction is not allowed
         // TODO make the above logic a reality...
-        if (findTransaction(objInfo.obj)) {
-            qWarning().nospace() << "Telemetry - !!! Making request for an object " << objInfo.obj->toStringBrief() << " for which a request is already in progress";
-            // objInfo.obj->emitTransactionCompleted(false);
-            return;
+        if (next.txSize > 0 && findTransaction(next.obj)) {
+            ++n;
+            continue;
         }
-        UAVObject::Metadata metadata     = objInfo.obj->getMetadata();
+
+        // Everything but control traffic is paced to the link rate,
+        // a frame larger than the bucket can go once the bucket is full
+        if (next.priority != PRIORITY_CONTROL) {
+            if (paced) {
+                ++n;
+                continue;
+            }
+            double needed = qMin((double)next.txSize, linkRate * TX_BURST_MS / 1000.0);
+            if (txTokens < needed) {
+                paced     = true;
+                txLimited = true;
+                txTimer->start(qMax(1, (int)((needed - txTokens) * 1000.0 / linkRate) + 1));
+                ++n;
+                continue;
+            }
+        }
+
+        ObjectQueueInfo objInfo = objQueue.takeAt(n);
+        --queueSize[objInfo.priority];
+        txTokens -= objInfo.txSize;
+        processObjectEvent(objInfo);
+    }
+}
+
+/**
+ * Start the transaction of an event taken from the queue
+ */
+void Telemetry::processObjectEvent(const ObjectQueueInfo & objInfo)
+{
+    // Setup transaction (skip if unpack event)
+    UAVObject::Metadata metadata     = objInfo.obj->getMetadata();
+    UAVObject::UpdateMode updateMode = UAVObject::GetGcsTelemetryUpdateMode(metadata);
+
+    if ((objInfo.event != EV_UNPACKED) && ((objInfo.event != EV_UPDATED_PERIODIC) || (updateMode != UAVObject::UPDATEMODE_THROTTLED))) {
         ObjectTransactionInfo *transInfo = new ObjectTransactionInfo(this);
         transInfo->obj   = objInfo.obj;
         transInfo->allInstances = objInfo.allInstances;
@@ -438,14 +506,103 @@ void Telemetry::processObjectQueue()
     } else if (updateMode != UAVObject::UPDATEMODE_THROTTLED) {
         updateObject(objInfo.obj, objInfo.event);
     }
+}
 
-    // The fact we received an unpacked event does not mean that
-    // we do not have additional objects still in the queue,
-    // so we have to reschedule queue processing to make sure they are not
-    // stuck:
-    if (objInfo.event == EV_UNPACKED) {
-        processObjectQueue();
+/**
+ * Priority of an object event, pilot control and link management come first, settings last
+ */
+Telemetry::Priority Telemetry::objectPriority(UAVObject *obj, EventMask event) const
+{
+    quint32 objId = obj->getObjID();
+
+    if ((event == EV_UNPACKED) ||
+        (objId == GCSTelemetryStats::OBJID) ||
+        (objId == GCSReceiver::OBJID) ||
+        (objId == ManualControlCommand::OBJID)) {
+        return PRIORITY_CONTROL;
+    }
+    if (event == EV_UPDATE_REQ) {
+        return PRIORITY_HIGH;
+    }
+    if (event == EV_UPDATED_PERIODIC) {
+        return PRIORITY_NORMAL;
+    }
+    // ObjectPersistence goes along with the settings so a save never overtakes the upload
+    if (obj->isSettingsObject() || (objId == ObjectPersistence::OBJID) || (dynamic_cast<UAVMetaObject *>(obj) != NULL)) {
+        return PRIORITY_LOW;
+    }
+    return PRIORITY_HIGH;
+}
+
+/**
+ * Estimate the number of bytes an event will send on the link
+ */
+quint32 Telemetry::transmitSize(UAVObject *obj, EventMask event, bool allInstances)
+{
+    if (event == EV_UNPACKED) {
+        return 0;
+    }
+    if (event == EV_UPDATE_REQ) {
+        return FRAME_OVERHEAD;
+    }
+    if ((event == EV_UPDATED_PERIODIC) &&
+        (UAVObject::GetGcsTelemetryUpdateMode(obj->getMetadata()) == UAVObject::UPDATEMODE_THROTTLED)) {
+        return 0;
+    }
+    quint32 instances = allInstances ? objMngr->getNumInstances(obj->getObjID()) : 1;
+    return instances * (FRAME_OVERHEAD + obj->getNumBytes());
+}
+
+/**
+ * Time to wait for an answer, the answers to the other transactions in flight may arrive first
+ */
+qint32 Telemetry::transactionTimeoutMs()
+{
+    quint32 inFlightBytes = 0;
+
+    foreach(QMap<quint32, ObjectTransactionInfo *> *objTransactions, transMap) {
+        foreach(ObjectTransactionInfo * trans, *objTransactions) {
+            if (trans->timer->isActive()) {
+                inFlightBytes += 2 * FRAME_OVERHEAD + trans->obj->getNumBytes();
+            }
+        }
+    }
+    return REQ_TIMEOUT_MS + (qint32)(inFlightBytes * 1000.0 / linkRate);
+}
+
+/**
+ * Add the tokens earned since the last refill, up to the bucket depth
+ */
+void Telemetry::refillTxTokens()
+{
+    qint64 now   = txClock.elapsed();
+    double depth = linkRate * TX_BURST_MS / 1000.0;
+
+    txTokens     = qMin(depth, txTokens + (double)(now - txLastRefill) * linkRate / 1000.0);
+    txLastRefill = now;
+}
+
+/**
+ * Refine the link rate from the outcome of a transaction
+ */
+void Telemetry::updateLinkRate(ObjectTransactionInfo *transInfo, bool success)
+{
+    if (success) {
+        // The object and the answer went through within the round trip, the link is at least that fast
+        qint64 elapsedMs = transInfo->sentTime.isValid() ? transInfo->sentTime.elapsed() : 0;
+        if (elapsedMs > 0) {
+            linkRate = qMax(linkRate, (2 * FRAME_OVERHEAD + transInfo->obj->getNumBytes()) * 1000.0 / elapsedMs);
+        }
+        // Probe for more bandwidth while the bucket is what holds transmissions back
+        if (txLimited) {
+            linkRate *= 1.05;
+            txLimited = false;
+        }
+    } else if (gcsStatsObj->getData().Status == GCSTelemetryStats::STATUS_CONNECTED) {
+        // Lost or late answers on a live link mean it is congested, back off
+        linkRate /= 2.0;
     }
+    linkRate = qBound((double)MIN_LINK_RATE, linkRate, (double)MAX_LINK_RATE);
 }
 
 /**
@@ -480,7 +637,7 @@ void Telemetry::processPeriodicUpdates()
                 // Send object
                 time.start();
                 allInstances = !objinfo->obj->isSingleInstance();
-                processObjectUpdates(objinfo->obj, EV_UPDATED_PERIODIC, allInstances, false);
+                processObjectUpdates(objinfo->obj, EV_UPDATED_PERIODIC, allInstances);
                 elapsedMs    = time.elapsed();
                 // Update timeToNextUpdateMs with the elapsed delay of sending the object;
                 timeToNextUpdateMs += elapsedMs;
@@ -544,7 +701,7 @@ void Telemetry::objectUpdatedAuto(UAVObject *obj)
 {
     QMutexLocker locker(mutex);
 
-    processObjectUpdates(obj, EV_UPDATED, false, true);
+    processObjectUpdates(obj, EV_UPDATED, false);
 }
 
 void Telemetry::objectUpdatedManual(UAVObject *obj, bool all)
@@ -553,21 +710,21 @@ void Telemetry::objectUpdatedManual(UAVObject *obj, bool all)
 
     bool allInstances = obj->isSingleInstance() ? false : all;
 
-    processObjectUpdates(obj, EV_UPDATED_MANUAL, allInstances, true);
+    processObjectUpdates(obj, EV_UPDATED_MANUAL, allInstances);
 }
 
 void Telemetry::objectUpdatedPeriodic(UAVObject *obj)
 {
     QMutexLocker locker(mutex);
 
-    processObjectUpdates(obj, EV_UPDATED_PERIODIC, false, true);
+    processObjectUpdates(obj, EV_UPDATED_PERIODIC, false);
 }
 
 void Telemetry::objectUnpacked(UAVObject *obj)
 {
     QMutexLocker locker(mutex);
 
-    processObjectUpdates(obj, EV_UNPACKED, false, true);
+    processObjectUpdates(obj, EV_UNPACKED, false);
 }
 
 void Telemetry::updateRequested(UAVObject *obj, bool all)
@@ -576,7 +733,14 @@ void Telemetry::updateRequested(UAVObject *obj, bool all)
 
     bool allInstances = obj->isSingleInstance() ? false : all;
 
-    processObjectUpdates(obj, EV_UPDATE_REQ, allInstances, true);
+    processObjectUpdates(obj, EV_UPDATE_REQ, allInstances);
+}
+
+void Telemetry::txTimeout()
+{
+    QMutexLocker locker(mutex);
+
+    processObjectQueue();
 }
 
 void Telemetry::newObject(UAVObject *obj)
@@ -34,6 +34,7 @@
 #include <QMutex>
 #include <QMutexLocker>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QQueue>
 #include <QMap>
 
@@ -48,6 +49,7 @@ public:
     bool objRequest;
     qint32 retriesRemaining;
     bool acked;
+    QElapsedTimer sentTime;
     QPointer<class Telemetry>telem;
     QTimer *timer;
 private slots:
@@ -86,6 +88,12 @@ private:
     static const int MAX_UPDATE_PERIOD_MS = 1000;
     static const int MIN_UPDATE_PERIOD_MS = 1;
     static const int MAX_QUEUE_SIZE = 20;
+    static const int MAX_SETTINGS_QUEUE_SIZE = 100;
+    static const int FRAME_OVERHEAD = 11; /** UAVTalk header and CRC bytes of a frame */
+    static const int DEFAULT_LINK_RATE = 5760; /** Bytes per second, a 57600 baud serial link */
+    static const int MIN_LINK_RATE  = 500;
+    static const int MAX_LINK_RATE  = 1000000;
+    static const int TX_BURST_MS    = 50; /** Depth of the transmit bucket, in ms at the link rate */
 
     // Types
     /**
@@ -106,10 +114,24 @@ private:
         qint32    timeToNextUpdateMs; /** Time delay to the next update */
     } ObjectTimeInfo;
 
+    /**
+     * Transmit priorities, each with a latency budget used to order the queue
+     */
+    typedef enum {
+        PRIORITY_CONTROL = 0, /** Connection and pilot control objects, sent even when the link is saturated */
+        PRIORITY_HIGH    = 1, /** Requests and object updates */
+        PRIORITY_NORMAL  = 2, /** Periodic updates */
+        PRIORITY_LOW     = 3, /** Settings uploads */
+        PRIORITY_COUNT   = 4
+    } Priority;
+
     typedef struct {
         UAVObject *obj;
         EventMask event;
         bool allInstances;
+        Priority  priority;
+        qint64    deadline; /** Time by which the event should be processed, in ms */
+        quint32   txSize; /** Estimated bytes sent on the link */
     } ObjectQueueInfo;
 
     // Variables
@@ -117,8 +139,9 @@ private:
     UAVTalk *utalk;
     GCSTelemetryStats *gcsStatsObj;
     QList<ObjectTimeInfo> objList;
-    QQueue<ObjectQueueInfo> objQueue;
-    QQueue<ObjectQueueInfo> objPriorityQueue;
+    // pending events, in deadline order
+    QList<ObjectQueueInfo> objQueue;
+    int queueSize[PRIORITY_COUNT];
     QMap<quint32, QMap<quint32, ObjectTransactionInfo *> *> transMap;
     QMutex *mutex;
     QTimer *updateTimer;
@@ -126,6 +149,13 @@ private:
     qint32 timeToNextUpdateMs;
     quint32 txErrors;
     quint32 txRetries;
+    // token bucket pacing the transmissions to the link rate
+    QElapsedTimer txClock;
+    QTimer *txTimer;
+    qint64 txLastRefill;
+    double txTokens;
+    double linkRate;
+    bool txLimited;
 
     // Methods
     void registerObject(UAVObject *obj);
@@ -134,9 +164,15 @@ private:
     void connectToObjectInstances(UAVObject *obj, quint32 eventMask);
     void connectToObject(UAVObject *obj, quint32 eventMask);
     void updateObject(UAVObject *obj, quint32 eventMask);
-    void processObjectUpdates(UAVObject *obj, EventMask event, bool allInstances, bool priority);
+    void processObjectUpdates(UAVObject *obj, EventMask event, bool allInstances);
     void processObjectTransaction(ObjectTransactionInfo *transInfo);
     void processObjectQueue();
+    void processObjectEvent(const ObjectQueueInfo & objInfo);
+    Priority objectPriority(UAVObject *obj, EventMask event) const;
+    quint32 transmitSize(UAVObject *obj, EventMask event, bool allInstances);
+    void refillTxTokens();
+    void updateLinkRate(ObjectTransactionInfo *transInfo, bool success);
+    qint32 transactionTimeoutMs();
 
     ObjectTransactionInfo *findTransaction(UAVObject *obj);
     void openTransaction(ObjectTransactionInfo *trans);
@@ -152,6 +188,7 @@ private slots:
     void newObject(UAVObject *obj);
     void newInstance(UAVObject *obj);
     void processPeriodicUpdates();
+    void txTimeout();
     void transactionCompleted(UAVObject *obj, bool success);
 };
 
@@ -0,0 +1,140 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryhub.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "telemetryhub.h"
+#include "telemetrymanager.h"
+#include "uavobjectsinit.h"
+
+#include <QtGlobal>
+
+TelemetryHub::TelemetryHub(TelemetryManager *mainTelemetry) : m_nextId(1), m_nextWorker(0)
+{
+    Vehicle vehicle;
+
+    vehicle.name     = tr("Main");
+    vehicle.device   = NULL;
+    vehicle.objMngr  = mainTelemetry->objectManager();
+    vehicle.telMngr  = mainTelemetry;
+    m_vehicles.insert(0, vehicle);
+}
+
+TelemetryHub::~TelemetryHub()
+{
+    foreach(int id, m_vehicles.keys()) {
+        removeVehicle(id);
+    }
+    foreach(QThread * worker, m_workers) {
+        // deletes the telemetry of the removed vehicles first
+        worker->quit();
+        worker->wait();
+        delete worker;
+    }
+}
+
+/**
+ * Start the telemetry of an additional vehicle on dev
+ * \return the id of the vehicle
+ */
+int TelemetryHub::addVehicle(const QString &name, QIODevice *dev)
+{
+    Vehicle vehicle;
+
+    vehicle.name    = name;
+    vehicle.device  = dev;
+    vehicle.objMngr = new UAVObjectManager();
+    UAVObjectsInitialize(vehicle.objMngr);
+    vehicle.telMngr = new TelemetryManager(vehicle.objMngr, workerThread());
+
+    int id = m_nextId++;
+    m_vehicles.insert(id, vehicle);
+
+    vehicle.telMngr->start(dev);
+    emit vehicleAdded(id);
+    return id;
+}
+
+/**
+ * Stop the telemetry of an additional vehicle, vehicle 0 belongs to the connection manager
+ */
+void TelemetryHub::removeVehicle(int id)
+{
+    if (id == 0 || !m_vehicles.contains(id)) {
+        return;
+    }
+
+    Vehicle vehicle = m_vehicles.take(id);
+    emit vehicleRemoved(id);
+
+    // the telemetry is stopped and deleted on its thread, the objects it uses go after it
+    vehicle.telMngr->stop();
+    connect(vehicle.telMngr, SIGNAL(destroyed()), vehicle.objMngr, SLOT(deleteLater()));
+    vehicle.telMngr->deleteLater();
+}
+
+/**
+ * \return the id of the vehicle connected through dev, -1 if none
+ */
+int TelemetryHub::findVehicle(QIODevice *dev) const
+{
+    QMap<int, Vehicle>::const_iterator i;
+    for (i = m_vehicles.constBegin(); i != m_vehicles.constEnd(); ++i) {
+        if (i.value().device == dev) {
+            return i.key();
+        }
+    }
+    return -1;
+}
+
+QString TelemetryHub::vehicleName(int id) const
+{
+    return m_vehicles.value(id).name;
+}
+
+UAVObjectManager *TelemetryHub::objectManager(int id) const
+{
+    return m_vehicles.contains(id) ? m_vehicles.value(id).objMngr : NULL;
+}
+
+TelemetryManager *TelemetryHub::telemetryManager(int id) const
+{
+    return m_vehicles.contains(id) ? m_vehicles.value(id).telMngr : NULL;
+}
+
+/**
+ * The additional links take turns on a few threads, decoding needs much less than a core per link
+ */
+QThread *TelemetryHub::workerThread()
+{
+    if (m_workers.size() < qBound(1, QThread::idealThreadCount() - 1, 4)) {
+        QThread *worker = new QThread();
+        worker->setObjectName(QString("TelemetryHub%1").arg(m_workers.size()));
+        worker->start();
+        m_workers.append(worker);
+        return worker;
+    }
+    return m_workers.at(m_nextWorker++ % m_workers.size());
+}
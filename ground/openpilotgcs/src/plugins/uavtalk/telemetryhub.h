@@ -0,0 +1,93 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryhub.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef TELEMETRYHUB_H
+#define TELEMETRYHUB_H
+
+#include "uavtalk_global.h"
+#include "uavobjectmanager.h"
+
+#include <QIODevice>
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include <QThread>
+
+class TelemetryManager;
+
+/**
+ * Telemetry links to several vehicles at once, each with its own objects.
+ *
+ * Vehicle 0 is the main connection: its objects are the global UAVObjectManager
+ * used by all the gadgets. Each additional vehicle gets a UAVObjectManager of its
+ * own and a TelemetryManager running on one of a few worker threads shared by all
+ * the additional links.
+ *
+ * Gadgets get the hub from the plugin manager and access the objects of a given
+ * vehicle through objectManager().
+ */
+class UAVTALK_EXPORT TelemetryHub : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TelemetryHub(TelemetryManager *mainTelemetry);
+    ~TelemetryHub();
+
+    int addVehicle(const QString &name, QIODevice *dev);
+    void removeVehicle(int id);
+    int findVehicle(QIODevice *dev) const;
+
+    QList<int> vehicles() const
+    {
+        return m_vehicles.keys();
+    }
+    QString vehicleName(int id) const;
+    UAVObjectManager *objectManager(int id) const;
+    TelemetryManager *telemetryManager(int id) const;
+
+signals:
+    void vehicleAdded(int id);
+    void vehicleRemoved(int id);
+
+private:
+    typedef struct {
+        QString name;
+        QIODevice *device;
+        UAVObjectManager *objMngr;
+        TelemetryManager *telMngr;
+    } Vehicle;
+
+    QMap<int, Vehicle> m_vehicles;
+    int m_nextId;
+    QList<QThread *> m_workers;
+    int m_nextWorker;
+
+    QThread *workerThread();
+};
+
+#endif // TELEMETRYHUB_H
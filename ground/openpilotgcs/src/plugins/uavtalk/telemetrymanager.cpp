@@ -32,12 +32,20 @@
 #include <coreplugin/icore.h>
 #include <coreplugin/threadmanager.h>
 
-TelemetryManager::TelemetryManager() : m_connectionState(TELEMETRY_DISCONNECTED)
+/**
+ * \param[in] objMngr The objects of the vehicle, the global UAVObjectManager by default
+ * \param[in] thread The thread running the link, the real time thread by default
+ */
+TelemetryManager::TelemetryManager(UAVObjectManager *objMngr, QThread *thread) : m_connectionState(TELEMETRY_DISCONNECTED)
 {
-    moveToThread(Core::ICore::instance()->threadManager()->getRealTimeThread());
-    // Get UAVObjectManager instance
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    m_uavobjectManager = pm->getObject<UAVObjectManager>();
+    moveToThread(thread ? thread : Core::ICore::instance()->threadManager()->getRealTimeThread());
+    if (objMngr) {
+        m_uavobjectManager = objMngr;
+    } else {
+        // Get UAVObjectManager instance
+        ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+        m_uavobjectManager = pm->getObject<UAVObjectManager>();
+    }
 
     // connect to start stop signals
     connect(this, SIGNAL(myStart()), this, SLOT(onStart()), Qt::QueuedConnection);
@@ -48,12 +48,16 @@ public:
         TELEMETRY_CONNECTING
     };
 
-    TelemetryManager();
+    TelemetryManager(UAVObjectManager *objMngr = NULL, QThread *thread = NULL);
     ~TelemetryManager();
 
     void start(QIODevice *dev);
     void stop();
     bool isConnected() const;
+    UAVObjectManager *objectManager() const
+    {
+        return m_uavobjectManager;
+    }
     ConnectionState connectionState() const;
 
 signals:
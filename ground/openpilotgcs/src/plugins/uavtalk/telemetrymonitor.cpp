@@ -28,6 +28,7 @@
 #include "telemetrymonitor.h"
 #include "coreplugin/connectionmanager.h"
 #include "coreplugin/icore.h"
+#include "settingsmanifest.h"
 
 /**
  * Constructor
@@ -39,8 +40,10 @@ TelemetryMonitor::TelemetryMonitor(UAVObjectManager *objMngr, Telemetry *tel) :
     flightStatsObj(FlightTelemetryStats::GetInstance(objMngr)),
     firmwareIAPObj(FirmwareIAPObj::GetInstance(objMngr)),
     statsTimer(new QTimer(this)),
-    objPending(NULL),
     mutex(new QMutex(QMutex::Recursive)),
+    fetchingManifest(false),
+    boardIdentified(false),
+    manifestValid(false),
     connectionTimer(new QTime())
 {
     // Listen for flight stats updates
@@ -68,6 +71,10 @@ void TelemetryMonitor::startRetrievingObjects()
 {
     // Clear object queue
     queue.clear();
+    foreach(UAVObject * obj, objPending) {
+        obj->disconnect(this);
+    }
+    objPending.clear();
     // Get all objects, add metaobjects, settings and data objects with OnChange update mode to the queue
     QList< QList<UAVObject *> > objs = objMngr->getObjects();
     for (int n = 0; n < objs.length(); ++n) {
@@ -90,7 +97,68 @@ void TelemetryMonitor::startRetrievingObjects()
     // Start retrieving
     qDebug() << tr("Starting to retrieve meta and settings objects from the autopilot (%1 objects)")
         .arg(queue.length());
-    retrieveNextObject();
+    retrieveManifest();
+}
+
+/**
+ * Retrieve the board identity and the settings manifest, before the queued objects
+ */
+void TelemetryMonitor::retrieveManifest()
+{
+    objCache.close();
+    fetchingManifest = true;
+    boardIdentified  = false;
+    manifestValid    = false;
+
+    // Forget the manifest of the previous connection, the board may send fewer instances
+    QList<UAVObject *> manifests = objMngr->getObjectInstances(SettingsManifest::OBJID);
+    foreach(UAVObject * manifest, manifests) {
+        QByteArray empty(manifest->getNumBytes(), 0);
+        manifest->unpack((const quint8 *)empty.constData());
+    }
+
+    UAVObject *manifest = SettingsManifest::GetInstance(objMngr);
+    connect(firmwareIAPObj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+    connect(manifest, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+    objPending.append(firmwareIAPObj);
+    objPending.append(manifest);
+    firmwareIAPObj->requestUpdate();
+    manifest->requestUpdateAll();
+}
+
+/**
+ * Restore the settings objects that the board holds as cached, they don't need to be retrieved
+ */
+void TelemetryMonitor::restoreCachedObjects()
+{
+    if (!boardIdentified || !objCache.open(firmwareIAPObj)) {
+        return;
+    }
+    queue.removeAll(firmwareIAPObj);
+    if (!manifestValid) {
+        // the board doesn't provide a manifest, retrieve everything but keep the cache up to date
+        return;
+    }
+
+    int restored = 0;
+    QList<UAVObject *> manifests = objMngr->getObjectInstances(SettingsManifest::OBJID);
+    foreach(UAVObject * obj, manifests) {
+        SettingsManifest *manifest = dynamic_cast<SettingsManifest *>(obj);
+        if (manifest == NULL) {
+            continue;
+        }
+        SettingsManifest::DataFields data = manifest->getData();
+        for (int n = 0; n < data.Entries && n < (int)SettingsManifest::OBJECTID_NUMELEM; ++n) {
+            UAVObject *settings = objMngr->getObject(data.ObjectID[n], data.InstanceID[n]);
+            if (settings != NULL && queue.contains(settings) && objCache.restore(settings, data.DataCRC[n])) {
+                settings->setIsKnown(true);
+                queue.removeAll(settings);
+                ++restored;
+            }
+        }
+    }
+    qDebug() << tr("Restored %1 settings objects from the cache, %2 objects left to retrieve")
+        .arg(restored).arg(queue.length());
 }
 
 /**
@@ -100,16 +168,35 @@ void TelemetryMonitor::stopRetrievingObjects()
 {
     qDebug("Object retrieval has been cancelled");
     queue.clear();
+    fetchingManifest = false;
+    foreach(UAVObject * obj, objPending) {
+        obj->disconnect(this);
+    }
+    objPending.clear();
 }
 
 /**
- * Retrieve the next object in the queue
+ * Retrieve the next objects in the queue, keeping a window of requests in flight
+ * so the retrieval is bound by the link bandwidth rather than by its round trip time
  */
 void TelemetryMonitor::retrieveNextObject()
 {
-    // If queue is empty return
+    // The manifest tells which of the queued objects can be restored from the cache
+    if (fetchingManifest) {
+        if (!objPending.isEmpty()) {
+            return;
+        }
+        fetchingManifest = false;
+        restoreCachedObjects();
+    }
+
+    // If queue is empty and all requests are answered return
     if (queue.isEmpty()) {
+        if (!objPending.isEmpty()) {
+            return;
+        }
         qDebug("Object retrieval completed");
+        objCache.save();
         if (firmwareIAPObj->getBoardType()) {
             emit connected();
         } else {
@@ -118,16 +205,19 @@ void TelemetryMonitor::retrieveNextObject()
         return;
     }
 
-    // Get next object from the queue
-    UAVObject *obj = queue.dequeue();
-    // qDebug( tr("Retrieving object: %1").arg(obj->getName()) );
+    // Requests may complete in any order, each completion refills the window
+    while (!queue.isEmpty() && objPending.length() < RETRIEVE_WINDOW) {
+        // Get next object from the queue
+        UAVObject *obj = queue.dequeue();
+        // qDebug( tr("Retrieving object: %1").arg(obj->getName()) );
 
-    // Connect to object
-    connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+        // Connect to object
+        connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
 
-    // Request update
-    obj->requestUpdate();
-    objPending = obj;
+        // Request update, the object is pending first as the completion can be immediate
+        objPending.append(obj);
+        obj->requestUpdate();
+    }
 }
 
 /**
@@ -135,13 +225,23 @@ void TelemetryMonitor::retrieveNextObject()
  */
 void TelemetryMonitor::transactionCompleted(UAVObject *obj, bool success)
 {
-    Q_UNUSED(success);
     QMutexLocker locker(mutex);
 
-    if (obj == objPending) {
+    if (objPending.removeOne(obj)) {
         // Disconnect from sending object
         obj->disconnect(this);
-        objPending = NULL;
+        if (fetchingManifest) {
+            if (obj == firmwareIAPObj) {
+                boardIdentified = success;
+            } else {
+                manifestValid = success;
+            }
+        } else if (success) {
+            UAVDataObject *dobj = dynamic_cast<UAVDataObject *>(obj);
+            if (dobj != NULL && dobj->isSettingsObject()) {
+                objCache.store(obj);
+            }
+        }
         // Process next object if telemetry is still available
         GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
 
@@ -40,6 +40,7 @@
 #include "firmwareiapobj.h"
 #include "systemstats.h"
 #include "telemetry.h"
+#include "objectcache.h"
 
 class TelemetryMonitor : public QObject {
     Q_OBJECT
@@ -63,6 +64,7 @@ private:
     static const int STATS_UPDATE_PERIOD_MS  = 4000;
     static const int STATS_CONNECT_PERIOD_MS = 2000;
     static const int CONNECTION_TIMEOUT_MS   = 8000;
+    static const int RETRIEVE_WINDOW = 8; /** Object requests in flight during the initial retrieval */
 
     UAVObjectManager *objMngr;
     Telemetry *tel;
@@ -71,12 +73,18 @@ private:
     FlightTelemetryStats *flightStatsObj;
     FirmwareIAPObj *firmwareIAPObj;
     QTimer *statsTimer;
-    UAVObject *objPending;
+    QList<UAVObject *> objPending;
+    ObjectCache objCache;
+    bool fetchingManifest;
+    bool boardIdentified;
+    bool manifestValid;
     QMutex *mutex;
     QTime *connectionTimer;
 
     void startRetrievingObjects();
     void retrieveNextObject();
+    void retrieveManifest();
+    void restoreCachedObjects();
     void stopRetrievingObjects();
 };
 
@@ -32,6 +32,8 @@
 #include <QtEndian>
 #include <QDebug>
 #include <QEventLoop>
+#include <QDateTime>
+#include <QDir>
 
 #ifdef VERBOSE_UAVTALK
 // uncomment and adapt the following lines to filter verbose logging to include specific object(s) only
@@ -53,11 +55,16 @@ UAVTalk::UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr) : io(iodev), objMn
 {
     rxState = STATE_SYNC;
     rxPacketLength = 0;
+    rxTimestamp    = -1;
+    rxBoardTime    = -1;
+    txLength       = 0;
+    txFlushPending = false;
 
     memset(&stats, 0, sizeof(ComStats));
 
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     Core::Internal::GeneralSettings *settings = pm->getObject<Core::Internal::GeneralSettings>();
+    history = pm->getObject<UAVObjectHistory>();
     useUDPMirror = settings->useUDPMirror();
     qDebug() << "USE UDP:::::::::::." << useUDPMirror;
     if (useUDPMirror) {
@@ -68,6 +75,21 @@ UAVTalk::UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr) : io(iodev), objMn
         connect(udpSocketTx, SIGNAL(readyRead()), this, SLOT(dummyUDPRead()));
         connect(udpSocketRx, SIGNAL(readyRead()), this, SLOT(dummyUDPRead()));
     }
+
+    capture = NULL;
+    if (settings->useUAVTalkCapture()) {
+        QString fileName = QDir::temp().filePath(QString("uavtalk-%1.pcapng")
+                                                 .arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss-zzz")));
+        capture = new UAVTalkCapture(fileName);
+        if (capture->isOpen()) {
+            qDebug() << "UAVTalk - capturing the link to" << fileName;
+            capture->start(QThread::LowPriority);
+        } else {
+            delete capture;
+            capture = NULL;
+        }
+    }
+    keepRxData = useUDPMirror || capture != NULL;
 }
 
 UAVTalk::~UAVTalk()
@@ -76,6 +98,10 @@ UAVTalk::~UAVTalk()
     // disconnect(io, SIGNAL(readyRead()), worker, SLOT(processInputStream()));
 
     closeAllTransactions();
+
+    flushOutputStream();
+
+    delete capture;
 }
 
 /**
@@ -98,6 +124,26 @@ UAVTalk::ComStats UAVTalk::getStats()
     return stats;
 }
 
+/**
+ * Write the frames packed since the last pass to the device
+ */
+void UAVTalk::flushOutputStream()
+{
+    QMutexLocker locker(&mutex);
+
+    txFlushPending = false;
+    if (txLength == 0) {
+        return;
+    }
+    if (!io.isNull() && io->isWritable()) {
+        if (io->write((const char *)txBuffer, txLength) != txLength) {
+            qWarning() << "UAVTalk - error transmitting : io device write failed";
+            ++stats.txErrors;
+        }
+    }
+    txLength = 0;
+}
+
 void UAVTalk::dummyUDPRead()
 {
     QUdpSocket *socket = qobject_cast<QUdpSocket *>(sender());
@@ -208,31 +254,80 @@ bool UAVTalk::objectTransaction(quint8 type, quint32 objId, quint16 instId, UAVO
  */
 void UAVTalk::processInputStream()
 {
-    quint8 tmp;
-
     if (io && io->isReadable()) {
         while (io->bytesAvailable() > 0) {
-            int ret = io->read((char *)&tmp, 1);
-            if (ret != -1) {
-                processInputByte(tmp);
-            } else {
-                // TODOD
+            qint64 count = io->read((char *)rxChunk, RX_CHUNK_SIZE);
+            if (count <= 0) {
+                break;
             }
-            if (rxState == STATE_COMPLETE) {
-                mutex.lock();
-                if (receiveObject(rxType, rxObjId, rxInstId, rxBuffer, rxLength)) {
-                    stats.rxObjectBytes += rxLength;
-                    stats.rxObjects++;
-                } else {
-                    // TODO...
-                }
-                mutex.unlock();
+            processInputBuffer(rxChunk, count);
+        }
+    }
+}
 
-                if (useUDPMirror) {
-                    // it is safe to do this outside of the above critical section as the rxDataArray is
-                    // accessed from this thread only
-                    udpSocketTx->writeDatagram(rxDataArray, QHostAddress::LocalHost, udpSocketRx->localPort());
+/**
+ * Process a block of bytes from the telemetry stream.
+ * Sync scanning and payload copies are done in bulk, the header bytes go through
+ * the byte state machine. The objects decoded from the block are delivered under a single lock.
+ * \param[in] data Received bytes
+ * \param[in] length Number of received bytes
+ */
+void UAVTalk::processInputBuffer(const quint8 *data, qint32 length)
+{
+    QMutexLocker locker(&mutex);
+
+    qint32 pos = 0;
+
+    while (pos < length) {
+        if (rxState == STATE_SYNC) {
+            // skip everything up to the next sync byte
+            const quint8 *sync = (const quint8 *)memchr(&data[pos], SYNC_VAL, length - pos);
+            qint32 skipped     = (sync != NULL) ? (qint32)(sync - &data[pos]) : length - pos;
+            if (skipped > 0) {
+                stats.rxBytes      += skipped;
+                stats.rxSyncErrors += skipped;
+                if (keepRxData) {
+                    rxDataArray.append((const char *)&data[pos], skipped);
                 }
+                pos += skipped;
+                continue;
+            }
+        } else if (rxState == STATE_DATA) {
+            // copy as much of the payload as is available
+            qint32 count = qMin((qint32)(rxLength - rxCount), length - pos);
+            rxCS = Crc::updateCRC(rxCS, &data[pos], count);
+            memcpy(&rxBuffer[rxCount], &data[pos], count);
+            stats.rxBytes  += count;
+            rxPacketLength += count;
+            if (keepRxData) {
+                rxDataArray.append((const char *)&data[pos], count);
+            }
+            rxCount += count;
+            pos     += count;
+            if (rxCount == rxLength) {
+                rxCount = 0;
+                rxState = STATE_CS;
+            }
+            continue;
+        }
+
+        processInputByte(data[pos++]);
+
+        if (rxState == STATE_COMPLETE) {
+            if (receiveObject(rxType & ~TYPE_TIMESTAMPED, rxObjId, rxInstId, rxBuffer, rxLength)) {
+                stats.rxObjectBytes += rxLength;
+                stats.rxObjects++;
+            } else {
+                // TODO...
+            }
+
+            if (useUDPMirror) {
+                udpSocketTx->writeDatagram(rxDataArray, QHostAddress::LocalHost, udpSocketRx->localPort());
+            }
+            if (capture) {
+                // the frame is the tail of the data, the garbage received before its sync byte is left out
+                capture->capture(UAVTalkCapture::DIRECTION_RX,
+                                 (const quint8 *)rxDataArray.constData() + rxDataArray.size() - rxPacketLength, rxPacketLength);
             }
         }
     }
@@ -248,7 +343,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
     if (rxState == STATE_COMPLETE || rxState == STATE_ERROR) {
         rxState = STATE_SYNC;
 
-        if (useUDPMirror) {
+        if (keepRxData) {
             rxDataArray.clear();
         }
     }
@@ -259,7 +354,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
     // update packet byte count
     rxPacketLength++;
 
-    if (useUDPMirror) {
+    if (keepRxData) {
         rxDataArray.append(rxbyte);
     }
 
@@ -289,14 +384,15 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
         // Update CRC
         rxCS = Crc::updateCRC(rxCS, rxbyte);
 
-        if ((rxbyte & TYPE_MASK) != TYPE_VER) {
+        if ((rxbyte & TYPE_MASK & ~TYPE_TIMESTAMPED) != TYPE_VER) {
             qWarning() << "UAVTalk - error : bad type";
             stats.rxErrors++;
             rxState = STATE_ERROR;
             break;
         }
 
-        rxType     = rxbyte;
+        rxType      = rxbyte;
+        rxTimestamp = -1;
 
         packetSize = 0;
 
@@ -317,7 +413,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
         rxCount     = 0;
 
 
-        if (packetSize < HEADER_LENGTH || packetSize > HEADER_LENGTH + MAX_PAYLOAD_LENGTH) {
+        if (packetSize < HEADER_LENGTH || packetSize > HEADER_LENGTH + TIMESTAMP_LENGTH + MAX_PAYLOAD_LENGTH) {
             // incorrect packet size
             qWarning() << "UAVTalk - error : incorrect packet size";
             stats.rxErrors++;
@@ -359,6 +455,24 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
 
         rxInstId = (qint16)qFromLittleEndian<quint16>(rxTmpBuffer);
 
+        // Batched and delta frames have a variable length, the payload is parsed on reception
+        if ((rxType & ~TYPE_TIMESTAMPED) == TYPE_OBJ_MULTI || (rxType & ~TYPE_TIMESTAMPED) == TYPE_OBJ_DELTA) {
+            rxLength = packetSize - rxPacketLength - ((rxType & TYPE_TIMESTAMPED) ? TIMESTAMP_LENGTH : 0);
+            if (rxLength >= MAX_PAYLOAD_LENGTH) {
+                // packet error - exceeded payload max length
+                qWarning() << "UAVTalk - error : exceeded payload max length" << rxObjId;
+                stats.rxErrors++;
+                rxState = STATE_ERROR;
+                break;
+            }
+            if (rxType & TYPE_TIMESTAMPED) {
+                rxState = STATE_TIMESTAMP;
+            } else {
+                rxState = (rxLength > 0) ? STATE_DATA : STATE_CS;
+            }
+            break;
+        }
+
         // Search for object, if not found reset state machine
         {
             UAVObject *rxObj = objMngr->getObject(rxObjId);
@@ -370,13 +484,14 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
             }
 
             // Determine data length
+            qint32 timestampLength = (rxType & TYPE_TIMESTAMPED) ? TIMESTAMP_LENGTH : 0;
             if (rxType == TYPE_OBJ_REQ || rxType == TYPE_ACK || rxType == TYPE_NACK) {
                 rxLength = 0;
             } else {
                 if (rxObj) {
                     rxLength = rxObj->getNumBytes();
                 } else {
-                    rxLength = packetSize - rxPacketLength;
+                    rxLength = packetSize - rxPacketLength - timestampLength;
                 }
             }
 
@@ -390,7 +505,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
             }
 
             // Check the lengths match
-            if ((rxPacketLength + rxLength) != packetSize) {
+            if ((rxPacketLength + timestampLength + rxLength) != packetSize) {
                 // packet error - mismatched packet size
                 qWarning() << "UAVTalk - error : mismatched packet size" << rxObjId;
                 stats.rxErrors++;
@@ -399,6 +514,29 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
             }
         }
 
+        // If there is a timestamp get it, then the payload if any, otherwise receive checksum
+        if (rxType & TYPE_TIMESTAMPED) {
+            rxState = STATE_TIMESTAMP;
+        } else if (rxLength > 0) {
+            rxState = STATE_DATA;
+        } else {
+            rxState = STATE_CS;
+        }
+        break;
+
+    case STATE_TIMESTAMP:
+
+        // Update CRC
+        rxCS = Crc::updateCRC(rxCS, rxbyte);
+
+        rxTmpBuffer[rxCount++] = rxbyte;
+        if (rxCount < TIMESTAMP_LENGTH) {
+            break;
+        }
+        rxCount     = 0;
+
+        rxTimestamp = extendTimestamp(qFromLittleEndian<quint16>(rxTmpBuffer));
+
         // If there is a payload get it, otherwise receive checksum
         if (rxLength > 0) {
             rxState = STATE_DATA;
@@ -474,8 +612,6 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
  */
 bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *data, qint32 length)
 {
-    Q_UNUSED(length);
-
     UAVObject *obj    = NULL;
     bool error        = false;
     bool allInstances = (instId == ALL_INSTANCES);
@@ -486,7 +622,7 @@ bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *
         // All instances, not allowed for OBJ messages
         if (!allInstances) {
             // Get object and update its data
-            obj = updateObject(objId, instId, data);
+            obj = updateObject(objId, instId, data, rxTimestamp);
 #ifdef VERBOSE_UAVTALK
             VERBOSE_FILTER(objId) qDebug() << "UAVTalk - received object" << objId << instId << (obj != NULL ? obj->toStringBrief() : "<null object>");
 #endif
@@ -503,11 +639,35 @@ bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *
         }
         break;
 
+    case TYPE_OBJ_MULTI:
+        // Batched object updates, the instance ID holds the record count
+        error = !receiveBatch(instId, data, length);
+        break;
+
+    case TYPE_OBJ_DELTA:
+        // All instances, not allowed for OBJ_DELTA messages
+        if (!allInstances) {
+            // Get object and apply the changed blocks
+            obj = applyDelta(objId, instId, data, length, rxTimestamp);
+#ifdef VERBOSE_UAVTALK
+            VERBOSE_FILTER(objId) qDebug() << "UAVTalk - received object delta" << objId << instId << (obj != NULL ? obj->toStringBrief() : "<null object>");
+#endif
+            if (obj != NULL) {
+                // a delta acks a pending OBJ_REQ message like a plain OBJ message
+                updateAck(TYPE_OBJ, objId, instId, obj);
+            } else {
+                error = true;
+            }
+        } else {
+            error = true;
+        }
+        break;
+
     case TYPE_OBJ_ACK:
         // All instances, not allowed for OBJ_ACK messages
         if (!allInstances) {
             // Get object and update its data
-            obj = updateObject(objId, instId, data);
+            obj = updateObject(objId, instId, data, rxTimestamp);
 #ifdef VERBOSE_UAVTALK
             VERBOSE_FILTER(objId) qDebug() << "UAVTalk - received object (acked)" << objId << instId << (obj != NULL ? obj->toStringBrief() : "<null object>");
 #endif
@@ -594,13 +754,125 @@ bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *
     return !error;
 }
 
+/**
+ * Unpack the records of a batched frame.
+ * Each record is object ID(4), instance ID(2) followed by the object data.
+ * The record length is only known from the object itself, so unpacking stops at the first unknown object.
+ * \param[in] count Number of records in the frame
+ * \param[in] data Data buffer
+ * \param[in] length Buffer length
+ * \return Success (true), Failure (false)
+ */
+bool UAVTalk::receiveBatch(quint16 count, quint8 *data, qint32 length)
+{
+    qint32 offset = 0;
+    bool error    = false;
+
+    for (quint16 n = 0; n < count; ++n) {
+        if (offset + BATCH_RECORD_HEADER_LENGTH > length) {
+            return false;
+        }
+        quint32 objId  = qFromLittleEndian<quint32>(&data[offset]);
+        quint16 instId = qFromLittleEndian<quint16>(&data[offset + 4]);
+        offset += BATCH_RECORD_HEADER_LENGTH;
+
+        UAVObject *typeObj = objMngr->getObject(objId);
+        if (typeObj == NULL) {
+            qWarning() << "UAVTalk - error : unknown object in batch" << objId;
+            return false;
+        }
+        if (instId == ALL_INSTANCES || offset + (qint32)typeObj->getNumBytes() > length) {
+            return false;
+        }
+        // the records of a batch share the frame timestamp
+        UAVObject *obj = updateObject(objId, instId, &data[offset], rxTimestamp);
+#ifdef VERBOSE_UAVTALK
+        VERBOSE_FILTER(objId) qDebug() << "UAVTalk - received batched object" << objId << instId << (obj != NULL ? obj->toStringBrief() : "<null object>");
+#endif
+        if (obj != NULL) {
+            // a batched record acks a pending OBJ_REQ message like a plain OBJ message
+            updateAck(TYPE_OBJ, objId, instId, obj);
+        } else {
+            error = true;
+        }
+        offset += typeObj->getNumBytes();
+    }
+
+    return !error;
+}
+
+/**
+ * Apply a delta frame to an object instance.
+ * The delta is relative to the copy last sent by the flight side, if the local copy
+ * is another one (an update was lost) it is dropped until the next full copy is received.
+ * The base is checked by the number of deltas applied since the full copy and by its CRC.
+ * \param[in] objId Object ID
+ * \param[in] instId Instance ID
+ * \param[in] data Delta payload
+ * \param[in] length Payload length
+ * \param[in] timestamp Board time of the update in ms, or -1
+ * \return The updated object or NULL
+ */
+UAVObject *UAVTalk::applyDelta(quint32 objId, quint16 instId, quint8 *data, qint32 length, qint64 timestamp)
+{
+    UAVObject *obj = objMngr->getObject(objId, instId);
+
+    if (obj == NULL) {
+        qWarning() << "UAVTalk - failed to get object for delta, object ID :" << objId << instId;
+        return NULL;
+    }
+
+    qint32 numBytes     = obj->getNumBytes();
+    qint32 numBlocks    = (numBytes + DELTA_BLOCK_LENGTH - 1) / DELTA_BLOCK_LENGTH;
+    qint32 bitmapLength = (numBlocks + 7) / 8;
+    if (length < 2 + bitmapLength || numBytes > MAX_PAYLOAD_LENGTH) {
+        return NULL;
+    }
+
+    // the base must be the copy the flight side derived the delta from, by sequence and CRC
+    QHash<quint64, quint8>::iterator sequence = deltaSequence.find(((quint64)objId << 16) | instId);
+    quint8 objData[MAX_PAYLOAD_LENGTH];
+    obj->pack(objData);
+    if (sequence == deltaSequence.end() || sequence.value() != data[0] || Crc::updateCRC(0, objData, numBytes) != data[1]) {
+        qWarning() << "UAVTalk - delta base mismatch, waiting for full update" << obj->toStringBrief();
+        if (sequence != deltaSequence.end()) {
+            deltaSequence.erase(sequence);
+        }
+        return NULL;
+    }
+
+    const quint8 *bitmap = &data[2];
+    qint32 pos = 2 + bitmapLength;
+    for (qint32 block = 0; block < numBlocks; ++block) {
+        if (bitmap[block / 8] & (1 << (block % 8))) {
+            qint32 offset = block * DELTA_BLOCK_LENGTH;
+            qint32 n = qMin(DELTA_BLOCK_LENGTH, numBytes - offset);
+            if (pos + n > length) {
+                return NULL;
+            }
+            memcpy(&objData[offset], &data[pos], n);
+            pos += n;
+        }
+    }
+
+    sequence.value() = data[0] + 1;
+    obj->setTimestamp(timestamp);
+    obj->unpack(objData);
+    recordHistory(obj);
+    return obj;
+}
+
 /**
  * Update the data of an object from a byte array (unpack).
  * If the object instance could not be found in the list, then a
  * new one is created.
+ * The timestamp is set before unpacking, so it is current when the object signals its update.
  */
-UAVObject *UAVTalk::updateObject(quint32 objId, quint16 instId, quint8 *data)
+UAVObject *UAVTalk::updateObject(quint32 objId, quint16 instId, quint8 *data, qint64 timestamp)
 {
+    // a full copy is the base of the deltas that follow
+    deltaSequence.insert(((quint64)objId << 16) | instId, 0);
+
     // Get object
     UAVObject *obj = objMngr->getObject(objId, instId);
 
@@ -623,15 +895,44 @@ UAVObject *UAVTalk::updateObject(quint32 objId, quint16 instId, quint8 *data)
             qWarning() << "UAVTalk - failed to register object " << instObj->toStringBrief();
             return NULL;
         }
+        instObj->setTimestamp(timestamp);
         instObj->unpack(data);
+        recordHistory(instObj);
         return instObj;
     } else {
         // Unpack data into object instance
+        obj->setTimestamp(timestamp);
         obj->unpack(data);
+        recordHistory(obj);
         return obj;
     }
 }
 
+/**
+ * Keep the received values in the history store, stamped with the GCS receive time.
+ */
+void UAVTalk::recordHistory(UAVObject *obj)
+{
+    if (history) {
+        history->record(obj, QDateTime::currentMSecsSinceEpoch());
+    }
+}
+
+/**
+ * Extend the 16 bit board time of a frame to a continuous board time in ms.
+ * The board time wraps every 65 s, updates are assumed to be less than half of that apart.
+ */
+qint64 UAVTalk::extendTimestamp(quint16 timestamp)
+{
+    if (rxBoardTime < 0) {
+        rxBoardTime = timestamp;
+    } else {
+        // frames can arrive slightly out of order (batches), hence the signed difference
+        rxBoardTime += (qint16)(timestamp - (quint16)rxBoardTime);
+    }
+    return rxBoardTime;
+}
+
 /**
  * Check if a transaction is pending and if yes complete it.
  */
@@ -746,15 +1047,33 @@ bool UAVTalk::transmitSingleObject(quint8 type, quint32 objId, quint16 instId, U
 
     // IMPORTANT : obj can be null (when type is NACK for example)
 
+    // Check that the transmit backlog, written or not, does not grow above limit
+    if (io.isNull() || !io->isWritable()) {
+        qWarning() << "UAVTalk - error transmitting : io device not writable";
+        ++stats.txErrors;
+        return false;
+    }
+    if (io->bytesToWrite() + txLength >= TX_BUFFER_SIZE) {
+        qWarning() << "UAVTalk - error transmitting : io device full";
+        ++stats.txErrors;
+        return false;
+    }
+
+    // Pack the frame after the ones already waiting, making room first if needed
+    if (txLength + MAX_PACKET_LENGTH > TX_BUFFER_SIZE) {
+        flushOutputStream();
+    }
+    quint8 *frame = &txBuffer[txLength];
+
     // Setup sync byte
-    txBuffer[0] = SYNC_VAL;
+    frame[0] = SYNC_VAL;
     // Setup type
-    txBuffer[1] = type;
+    frame[1] = type;
     // next 2 bytes are reserved for data length (inserted here later)
     // Setup object ID
-    qToLittleEndian<quint32>(objId, &txBuffer[4]);
+    qToLittleEndian<quint32>(objId, &frame[4]);
     // Setup instance ID
-    qToLittleEndian<quint16>(instId, &txBuffer[8]);
+    qToLittleEndian<quint16>(instId, &frame[8]);
 
     // Determine data length
     if (type == TYPE_OBJ_REQ || type == TYPE_ACK || type == TYPE_NACK) {
@@ -772,7 +1091,7 @@ bool UAVTalk::transmitSingleObject(quint8 type, quint32 objId, quint16 instId, U
 
     // Copy data (if any)
     if (length > 0) {
-        if (!obj->pack(&txBuffer[HEADER_LENGTH])) {
+        if (!obj->pack(&frame[HEADER_LENGTH])) {
             qWarning() << "UAVTalk - error transmitting : failed to pack object" << obj->toStringBrief();
             ++stats.txErrors;
             return false;
@@ -780,27 +1099,22 @@ bool UAVTalk::transmitSingleObject(quint8 type, quint32 objId, quint16 instId, U
     }
 
     // Store the packet length
-    qToLittleEndian<quint16>(HEADER_LENGTH + length, &txBuffer[2]);
+    qToLittleEndian<quint16>(HEADER_LENGTH + length, &frame[2]);
 
     // Calculate checksum
-    txBuffer[HEADER_LENGTH + length] = Crc::updateCRC(0, txBuffer, HEADER_LENGTH + length);
+    frame[HEADER_LENGTH + length] = Crc::updateCRC(0, frame, HEADER_LENGTH + length);
 
-    // Send buffer, check that the transmit backlog does not grow above limit
-    if (!io.isNull() && io->isWritable()) {
-        if (io->bytesToWrite() < TX_BUFFER_SIZE) {
-            io->write((const char *)txBuffer, HEADER_LENGTH + length + CHECKSUM_LENGTH);
-            if (useUDPMirror) {
-                udpSocketRx->writeDatagram((const char *)txBuffer, HEADER_LENGTH + length + CHECKSUM_LENGTH, QHostAddress::LocalHost, udpSocketTx->localPort());
-            }
-        } else {
-            qWarning() << "UAVTalk - error transmitting : io device full";
-            ++stats.txErrors;
-            return false;
-        }
-    } else {
-        qWarning() << "UAVTalk - error transmitting : io device not writable";
-        ++stats.txErrors;
-        return false;
+    // Queue the frame, the device write happens once all frames of this pass are packed
+    txLength += HEADER_LENGTH + length + CHECKSUM_LENGTH;
+    if (!txFlushPending) {
+        txFlushPending = true;
+        QMetaObject::invokeMethod(this, "flushOutputStream", Qt::QueuedConnection);
+    }
+    if (useUDPMirror) {
+        udpSocketRx->writeDatagram((const char *)frame, HEADER_LENGTH + length + CHECKSUM_LENGTH, QHostAddress::LocalHost, udpSocketTx->localPort());
+    }
+    if (capture) {
+        capture->capture(UAVTalkCapture::DIRECTION_TX, frame, HEADER_LENGTH + length + CHECKSUM_LENGTH);
     }
 
     // Update stats
@@ -896,6 +1210,16 @@ const char *UAVTalk::typeToString(quint8 type)
     case TYPE_NACK:
         return "nack";
 
+        break;
+
+    case TYPE_OBJ_MULTI:
+        return "batched objects";
+
+        break;
+
+    case TYPE_OBJ_DELTA:
+        return "object delta";
+
         break;
     }
     return "<error>";
@@ -28,7 +28,9 @@
 #define UAVTALK_H
 
 #include "uavobjectmanager.h"
+#include "uavobjecthistory.h"
 #include "uavtalk_global.h"
+#include "uavtalkcapture.h"
 
 #include <QtCore>
 #include <QIODevice>
@@ -42,6 +44,8 @@ class UAVTALK_EXPORT UAVTalk : public QObject {
     Q_OBJECT
 
     friend class IODeviceReader;
+    // shares the protocol constants
+    friend class UAVTalkLogDecoder;
 
 public:
     static const quint16 ALL_INSTANCES = 0xFFFF;
@@ -75,6 +79,7 @@ signals:
 
 private slots:
     void processInputStream();
+    void flushOutputStream();
     void dummyUDPRead();
 
 private:
@@ -93,27 +98,43 @@ private:
     static const int TYPE_OBJ_ACK  = (TYPE_VER | 0x02);
     static const int TYPE_ACK      = (TYPE_VER | 0x03);
     static const int TYPE_NACK     = (TYPE_VER | 0x04);
+    static const int TYPE_OBJ_MULTI = (TYPE_VER | 0x05);
+    static const int TYPE_OBJ_DELTA = (TYPE_VER | 0x06);
+    // object frames of any type can carry the sender time after the header
+    static const int TYPE_TIMESTAMPED = 0x80;
 
     // header : sync(1), type (1), size(2), object ID(4), instance ID(2)
     static const int HEADER_LENGTH = 10;
 
+    // timestamp : sender time in ms, 16 bits
+    static const int TIMESTAMP_LENGTH = 2;
+
     static const int MAX_PAYLOAD_LENGTH = 256;
 
     static const int CHECKSUM_LENGTH    = 1;
 
-    static const int MAX_PACKET_LENGTH  = (HEADER_LENGTH + MAX_PAYLOAD_LENGTH + CHECKSUM_LENGTH);
+    // batch record header : object ID(4), instance ID(2)
+    static const int BATCH_RECORD_HEADER_LENGTH = 6;
+
+    // delta payload : base sequence(1), base CRC(1), bitmap of changed blocks, changed blocks
+    static const int DELTA_BLOCK_LENGTH = 4;
+
+    static const int MAX_PACKET_LENGTH  = (HEADER_LENGTH + TIMESTAMP_LENGTH + MAX_PAYLOAD_LENGTH + CHECKSUM_LENGTH);
 
     static const int TX_BUFFER_SIZE     = 2 * 1024;
 
+    static const int RX_CHUNK_SIZE      = 2 * 1024;
+
     // Types
     typedef enum {
-        STATE_SYNC, STATE_TYPE, STATE_SIZE, STATE_OBJID, STATE_INSTID, STATE_DATA, STATE_CS, STATE_COMPLETE, STATE_ERROR
+        STATE_SYNC, STATE_TYPE, STATE_SIZE, STATE_OBJID, STATE_INSTID, STATE_TIMESTAMP, STATE_DATA, STATE_CS, STATE_COMPLETE, STATE_ERROR
     } RxStateType;
 
     // Variables
     QPointer<QIODevice> io;
 
     UAVObjectManager *objMngr;
+    UAVObjectHistory *history;
 
     ComStats stats;
 
@@ -121,9 +142,17 @@ private:
 
     QMap<quint32, QMap<quint32, Transaction *> *> transMap;
 
+    // deltas applied since the last full copy, by object ID << 16 | instance ID
+    QHash<quint64, quint8> deltaSequence;
+
     quint8 rxBuffer[MAX_PACKET_LENGTH];
 
-    quint8 txBuffer[MAX_PACKET_LENGTH];
+    // frames are packed back to back and written to the device once per event loop pass
+    quint8 txBuffer[TX_BUFFER_SIZE];
+    qint32 txLength;
+    bool txFlushPending;
+
+    quint8 rxChunk[RX_CHUNK_SIZE];
 
     // Variables used by the receive state machine
     // state machine variables
@@ -135,6 +164,10 @@ private:
     quint8 rxType;
     quint32 rxObjId;
     quint16 rxInstId;
+    // board time of the received frame in ms, -1 if not timestamped
+    qint64 rxTimestamp;
+    // last board time, to extend the 16 bit timestamps
+    qint64 rxBoardTime;
     quint16 rxLength;
     quint16 rxPacketLength;
     quint8 rxCSPacket;
@@ -144,12 +177,21 @@ private:
     QUdpSocket *udpSocketTx;
     QUdpSocket *udpSocketRx;
     QByteArray rxDataArray;
+    // pcapng capture of the link, NULL unless enabled in the general settings
+    UAVTalkCapture *capture;
+    // rxDataArray collects the frame being received, for the UDP mirror or the capture
+    bool keepRxData;
 
     // Methods
     bool objectTransaction(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
+    void processInputBuffer(const quint8 *data, qint32 length);
     bool processInputByte(quint8 rxbyte);
     bool receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *data, qint32 length);
-    UAVObject *updateObject(quint32 objId, quint16 instId, quint8 *data);
+    bool receiveBatch(quint16 count, quint8 *data, qint32 length);
+    UAVObject *applyDelta(quint32 objId, quint16 instId, quint8 *data, qint32 length, qint64 timestamp);
+    UAVObject *updateObject(quint32 objId, quint16 instId, quint8 *data, qint64 timestamp);
+    void recordHistory(UAVObject *obj);
+    qint64 extendTimestamp(quint16 timestamp);
     void updateAck(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
     void updateNack(quint32 objId, quint16 instId, UAVObject *obj);
     bool transmitObject(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
@@ -13,17 +13,25 @@ include(uavtalk_dependencies.pri)
 
 HEADERS += \
     uavtalk.h \
+    uavtalklogdecoder.h \
+    uavtalkcapture.h \
+    objectcache.h \
     uavtalkplugin.h \
     telemetrymonitor.h \
     telemetrymanager.h \
+    telemetryhub.h \
     uavtalk_global.h \
     telemetry.h
 
 SOURCES += \
     uavtalk.cpp \
+    uavtalklogdecoder.cpp \
+    uavtalkcapture.cpp \
+    objectcache.cpp \
     uavtalkplugin.cpp \
     telemetrymonitor.cpp \
     telemetrymanager.cpp \
+    telemetryhub.cpp \
     telemetry.cpp
 
 OTHER_FILES += UAVTalk.pluginspec
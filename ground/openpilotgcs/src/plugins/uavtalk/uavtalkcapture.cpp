@@ -0,0 +1,234 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavtalkcapture.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavtalkcapture.h"
+
+#include <QDateTime>
+#include <QDebug>
+
+// pcapng block types
+#define BLOCK_SECTION_HEADER      0x0A0D0D0A
+#define BLOCK_INTERFACE           0x00000001
+#define BLOCK_INTERFACE_STATS     0x00000005
+#define BLOCK_ENHANCED_PACKET     0x00000006
+#define BYTE_ORDER_MAGIC          0x1A2B3C4D
+// pcapng option codes
+#define OPTION_END                0
+#define OPTION_EPB_FLAGS          2
+#define OPTION_ISB_IFRECV         4
+#define OPTION_ISB_IFDROP         5
+
+static void append16(QByteArray &block, quint16 value)
+{
+    block.append((const char *)&value, sizeof(value));
+}
+
+static void append32(QByteArray &block, quint32 value)
+{
+    block.append((const char *)&value, sizeof(value));
+}
+
+static void append64(QByteArray &block, quint64 value)
+{
+    block.append((const char *)&value, sizeof(value));
+}
+
+static void appendTimestamp(QByteArray &block, quint64 timestamp)
+{
+    append32(block, (quint32)(timestamp >> 32));
+    append32(block, (quint32)timestamp);
+}
+
+/**
+ * Create the capture file and write its section and interface headers,
+ * the capture thread still has to be started.
+ */
+UAVTalkCapture::UAVTalkCapture(const QString &fileName) : file(fileName),
+    ring(new quint8[RING_SIZE]), head(0), tail(0), dropped(0), received(0), stopping(0)
+{
+    startTime = (quint64)QDateTime::currentMSecsSinceEpoch() * 1000;
+    clock.start();
+
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        qWarning() << "UAVTalkCapture - could not create" << fileName << ":" << file.errorString();
+        return;
+    }
+
+    QByteArray block;
+    append32(block, BYTE_ORDER_MAGIC);
+    append16(block, 1); // version 1.0
+    append16(block, 0);
+    append64(block, (quint64)-1); // section length not known
+    writeBlock(BLOCK_SECTION_HEADER, block);
+
+    block.clear();
+    append16(block, LINKTYPE_USER0);
+    append16(block, 0);
+    append32(block, 0); // no snapshot length
+    writeBlock(BLOCK_INTERFACE, block);
+}
+
+/**
+ * Stop the capture thread, write what is left in the ring and the
+ * statistics of the capture, and close the file.
+ */
+UAVTalkCapture::~UAVTalkCapture()
+{
+    stopping.storeRelease(1);
+    wait();
+
+    if (file.isOpen()) {
+        writeRecords();
+
+        QByteArray block;
+        append32(block, 0);
+        appendTimestamp(block, now());
+        append16(block, OPTION_ISB_IFRECV);
+        append16(block, sizeof(quint64));
+        append64(block, received.load());
+        append16(block, OPTION_ISB_IFDROP);
+        append16(block, sizeof(quint64));
+        append64(block, dropped.load());
+        append16(block, OPTION_END);
+        append16(block, 0);
+        writeBlock(BLOCK_INTERFACE_STATS, block);
+        file.close();
+
+        if (dropped.load() > 0) {
+            qWarning() << "UAVTalkCapture -" << dropped.load() << "frames dropped out of" << received.load() << "in" << file.fileName();
+        }
+    }
+    delete[] ring;
+}
+
+/**
+ * Queue a frame for the capture file, drop it if the ring is full.
+ * \param[in] direction Received or sent frame
+ * \param[in] data The whole frame, from the sync byte to the checksum
+ * \param[in] length Frame length
+ */
+void UAVTalkCapture::capture(Direction direction, const quint8 *data, qint32 length)
+{
+    Record record;
+
+    record.length    = length;
+    record.direction = direction;
+    record.timestamp = now();
+
+    quint32 size     = (sizeof(Record) + length + 3) & ~3;
+    quint32 position = head.load();
+    received.store(received.load() + 1);
+    if (RING_SIZE - (position - tail.loadAcquire()) < size) {
+        dropped.store(dropped.load() + 1);
+        return;
+    }
+    copyToRing(position, &record, sizeof(Record));
+    copyToRing(position + sizeof(Record), data, length);
+    head.storeRelease(position + size);
+}
+
+void UAVTalkCapture::run()
+{
+    while (!stopping.loadAcquire()) {
+        writeRecords();
+        msleep(WRITE_PERIOD);
+    }
+}
+
+quint64 UAVTalkCapture::now() const
+{
+    return startTime + (quint64)clock.nsecsElapsed() / 1000;
+}
+
+void UAVTalkCapture::copyToRing(quint32 position, const void *data, quint32 length)
+{
+    quint32 offset = position & (RING_SIZE - 1);
+    quint32 first  = qMin(length, RING_SIZE - offset);
+
+    memcpy(&ring[offset], data, first);
+    memcpy(ring, (const quint8 *)data + first, length - first);
+}
+
+void UAVTalkCapture::copyFromRing(quint32 position, void *data, quint32 length) const
+{
+    quint32 offset = position & (RING_SIZE - 1);
+    quint32 first  = qMin(length, RING_SIZE - offset);
+
+    memcpy(data, &ring[offset], first);
+    memcpy((quint8 *)data + first, ring, length - first);
+}
+
+/**
+ * Write the frames queued in the ring as enhanced packet blocks
+ */
+void UAVTalkCapture::writeRecords()
+{
+    quint32 position = tail.load();
+    quint32 end = head.loadAcquire();
+    QByteArray block;
+
+    while (position != end) {
+        Record record;
+        copyFromRing(position, &record, sizeof(Record));
+
+        block.clear();
+        append32(block, 0);
+        appendTimestamp(block, record.timestamp);
+        append32(block, record.length);
+        append32(block, record.length);
+        int data = block.size();
+        block.resize(data + ((record.length + 3) & ~3));
+        memset(block.data() + data + record.length, 0, block.size() - data - record.length);
+        copyFromRing(position + sizeof(Record), block.data() + data, record.length);
+        append16(block, OPTION_EPB_FLAGS);
+        append16(block, sizeof(quint32));
+        append32(block, record.direction);
+        append16(block, OPTION_END);
+        append16(block, 0);
+        writeBlock(BLOCK_ENHANCED_PACKET, block);
+
+        position += (sizeof(Record) + record.length + 3) & ~3;
+        tail.storeRelease(position);
+    }
+    file.flush();
+}
+
+void UAVTalkCapture::writeBlock(quint32 type, const QByteArray &body)
+{
+    // the bodies built above are always padded to 32 bits
+    quint32 length = 3 * sizeof(quint32) + body.size();
+
+    file.write((const char *)&type, sizeof(type));
+    file.write((const char *)&length, sizeof(length));
+    file.write(body);
+    file.write((const char *)&length, sizeof(length));
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,99 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavtalkcapture.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef UAVTALKCAPTURE_H
+#define UAVTALKCAPTURE_H
+
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QThread>
+
+/**
+ * Captures the UAVTalk frames sent and received on a link to a pcapng file,
+ * for use with the op-uavtalk Wireshark dissector (DLT_USER0 = op-uavtalk).
+ *
+ * capture() only copies the frame into a ring buffer and never blocks nor
+ * allocates, the file is written by the capture thread. Frames which do not
+ * fit in the ring are dropped and reported in the statistics of the capture.
+ * capture() must not be called from more than one thread at a time, UAVTalk
+ * calls it under its own lock.
+ */
+class UAVTalkCapture : public QThread {
+    Q_OBJECT
+
+public:
+    enum Direction { DIRECTION_RX = 1, DIRECTION_TX = 2 };
+
+    explicit UAVTalkCapture(const QString &fileName);
+    ~UAVTalkCapture();
+
+    bool isOpen() const
+    {
+        return file.isOpen();
+    }
+    void capture(Direction direction, const quint8 *data, qint32 length);
+
+protected:
+    void run();
+
+private:
+    // must be a power of two
+    static const quint32 RING_SIZE    = 256 * 1024;
+    static const unsigned long WRITE_PERIOD = 50; // ms
+    static const quint16 LINKTYPE_USER0 = 147;
+
+    typedef struct {
+        quint32 length;
+        quint32 direction;
+        quint64 timestamp;
+    } Record;
+
+    QFile file;
+    QElapsedTimer clock;
+    quint64 startTime; // us since the epoch
+    quint8 *ring;
+    // bytes ever written to and read from the ring, owned by capture() and the capture thread
+    QAtomicInteger<quint32> head;
+    QAtomicInteger<quint32> tail;
+    QAtomicInteger<quint32> dropped;
+    QAtomicInteger<quint32> received;
+    QAtomicInt stopping;
+
+    quint64 now() const;
+    void copyToRing(quint32 position, const void *data, quint32 length);
+    void copyFromRing(quint32 position, void *data, quint32 length) const;
+    void writeRecords();
+    void writeBlock(quint32 type, const QByteArray &body);
+};
+
+#endif // UAVTALKCAPTURE_H
+
+/**
+ * @}
+ * @}
+ */
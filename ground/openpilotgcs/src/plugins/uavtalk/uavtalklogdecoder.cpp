@@ -0,0 +1,415 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavtalklogdecoder.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavtalklogdecoder.h"
+#include "uavtalk.h"
+#include <utils/crc.h>
+#include <utils/logfile.h>
+
+#include <QtEndian>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+
+#define SYNC_VAL 0x3C
+
+using namespace Utils;
+
+static QString storageType(UAVObjectField::FieldType type)
+{
+    switch (type) {
+    case UAVObjectField::INT8:
+        return "int8";
+
+    case UAVObjectField::INT16:
+        return "int16";
+
+    case UAVObjectField::INT32:
+        return "int32";
+
+    case UAVObjectField::UINT16:
+        return "uint16";
+
+    case UAVObjectField::UINT32:
+        return "uint32";
+
+    case UAVObjectField::FLOAT32:
+        return "float32";
+
+    default:
+        // enums, bitfields and strings are stored as bytes
+        return "uint8";
+    }
+}
+
+/**
+ * Copy the layout of all known objects, this has to run on the thread owning the object manager.
+ */
+UAVTalkLogDecoder::UAVTalkLogDecoder(UAVObjectManager *objMngr) :
+    timeUnits("ms")
+{
+    memset(&stats, 0, sizeof(stats));
+
+    foreach(QList<UAVDataObject *> instances, objMngr->getDataObjects()) {
+        if (instances.isEmpty()) {
+            continue;
+        }
+        UAVDataObject *obj = instances.first();
+        ObjectLayout layout;
+        layout.name = obj->getName();
+        layout.singleInstance = obj->isSingleInstance();
+        layout.numBytes = obj->getNumBytes();
+        foreach(UAVObjectField * field, obj->getFields()) {
+            FieldLayout fieldLayout;
+            fieldLayout.name = field->getName();
+            fieldLayout.type = storageType(field->getType());
+            fieldLayout.units = field->getUnits();
+            fieldLayout.offset      = field->getDataOffset();
+            fieldLayout.numBytes    = field->getNumBytes();
+            fieldLayout.numElements = field->getNumElements();
+            layout.fields << fieldLayout;
+        }
+        objects.insert(obj->getObjID(), layout);
+    }
+}
+
+/**
+ * Decode a whole log file and write the columns to outputDir.
+ * \return Success (true), Failure (false) if the log can't be read or the output can't be written
+ */
+bool UAVTalkLogDecoder::decode(const QString &logFileName, const QString &outputDir)
+{
+    LogFile logFile;
+
+    logFile.setFileName(logFileName);
+    if (!logFile.open(QIODevice::ReadOnly) || !logFile.mapLog()) {
+        qWarning() << "UAVTalkLogDecoder - unable to read" << logFileName;
+        return false;
+    }
+
+    clear();
+
+    for (int i = 0; i < logFile.packetCount(); i++) {
+        const LogFile::LogPacket &packet = logFile.packet(i);
+        const quint8 *data = (const quint8 *)logFile.packetData(i);
+        stats.packets++;
+
+        if (tail.isEmpty()) {
+            qint64 used = processBuffer(data, packet.size, packet.timeStamp);
+            tail = QByteArray((const char *)data + used, packet.size - used);
+        } else {
+            // a frame was split over two packets, only the unparsed bytes are carried over
+            tail.append((const char *)data, packet.size);
+            qint64 used = processBuffer((const quint8 *)tail.constData(), tail.size(), packet.timeStamp);
+            tail = tail.mid(used);
+        }
+    }
+    logFile.close();
+
+    return writeColumns(outputDir);
+}
+
+/**
+ * Drop all records decoded or added so far.
+ */
+void UAVTalkLogDecoder::clear()
+{
+    streams.clear();
+    tail.clear();
+    memset(&stats, 0, sizeof(stats));
+}
+
+/**
+ * Pre-size the columns of an object instance for the given number of records.
+ */
+void UAVTalkLogDecoder::reserve(quint32 objId, quint16 instId, int records)
+{
+    QHash<quint32, ObjectLayout>::const_iterator layout = objects.constFind(objId);
+
+    if (layout == objects.constEnd()) {
+        return;
+    }
+    Stream &stream = streamFor(&layout.value(), objId, instId);
+    stream.timeStamps.reserve(records * sizeof(quint32));
+    for (int i = 0; i < layout->fields.count(); i++) {
+        stream.columns[i].reserve(records * layout->fields.at(i).numBytes);
+    }
+}
+
+/**
+ * Add a record of packed object data, as stored by UAVObject::pack().
+ * \return Success (true), Failure (false) if the object is unknown or the data has the wrong length
+ */
+bool UAVTalkLogDecoder::addRecord(quint32 objId, quint16 instId, const quint8 *data, qint32 length, quint32 timeStamp)
+{
+    QHash<quint32, ObjectLayout>::const_iterator layout = objects.constFind(objId);
+
+    if (layout == objects.constEnd() || (qint32)layout->numBytes != length) {
+        stats.unknownObjects++;
+        return false;
+    }
+    appendRecord(&layout.value(), objId, instId, data, timeStamp);
+    return true;
+}
+
+/**
+ * Parse all complete frames of a buffer.
+ * \return Number of bytes consumed, the rest is the start of an incomplete frame
+ */
+qint64 UAVTalkLogDecoder::processBuffer(const quint8 *data, qint64 length, quint32 timeStamp)
+{
+    const qint32 headerLength = UAVTalk::HEADER_LENGTH;
+    const qint32 maxLength    = UAVTalk::HEADER_LENGTH + UAVTalk::TIMESTAMP_LENGTH + UAVTalk::MAX_PAYLOAD_LENGTH;
+    qint64 pos = 0;
+
+    while (pos < length) {
+        const quint8 *sync = (const quint8 *)memchr(&data[pos], SYNC_VAL, length - pos);
+        if (sync == NULL) {
+            stats.syncErrors += length - pos;
+            return length;
+        }
+        stats.syncErrors += sync - &data[pos];
+        pos = sync - data;
+
+        if (length - pos < headerLength) {
+            return pos;
+        }
+        quint8 type   = data[pos + 1];
+        qint32 size   = qFromLittleEndian<quint16>(&data[pos + 2]);
+        if ((type & UAVTalk::TYPE_MASK & ~UAVTalk::TYPE_TIMESTAMPED) != UAVTalk::TYPE_VER || size < headerLength || size > maxLength) {
+            stats.syncErrors++;
+            pos++;
+            continue;
+        }
+        if (length - pos < size + UAVTalk::CHECKSUM_LENGTH) {
+            return pos;
+        }
+        if (Crc::updateCRC(0, &data[pos], size) != data[pos + size]) {
+            stats.crcErrors++;
+            pos++;
+            continue;
+        }
+
+        quint32 objId  = qFromLittleEndian<quint32>(&data[pos + 4]);
+        quint16 instId = qFromLittleEndian<quint16>(&data[pos + 8]);
+        // the board time of timestamped frames is skipped, records are timed by the log
+        qint32 dataOffset = headerLength + ((type & UAVTalk::TYPE_TIMESTAMPED) ? UAVTalk::TIMESTAMP_LENGTH : 0);
+        stats.frames++;
+        if (size >= dataOffset) {
+            receiveFrame(type & ~UAVTalk::TYPE_TIMESTAMPED, objId, instId, &data[pos + dataOffset], size - dataOffset, timeStamp);
+        }
+        pos += size + UAVTalk::CHECKSUM_LENGTH;
+    }
+    return pos;
+}
+
+void UAVTalkLogDecoder::receiveFrame(quint8 type, quint32 objId, quint16 instId, const quint8 *data, qint32 length, quint32 timeStamp)
+{
+    switch (type) {
+    case UAVTalk::TYPE_OBJ:
+    case UAVTalk::TYPE_OBJ_ACK:
+    {
+        QHash<quint32, ObjectLayout>::const_iterator layout = objects.constFind(objId);
+        if (layout == objects.constEnd() || (qint32)layout->numBytes != length || instId == UAVTalk::ALL_INSTANCES) {
+            stats.unknownObjects++;
+            return;
+        }
+        appendRecord(&layout.value(), objId, instId, data, timeStamp);
+        break;
+    }
+
+    case UAVTalk::TYPE_OBJ_MULTI:
+        receiveBatch(instId, data, length, timeStamp);
+        break;
+
+    case UAVTalk::TYPE_OBJ_DELTA:
+        applyDelta(objId, instId, data, length, timeStamp);
+        break;
+
+    default:
+        // requests, acks and nacks carry no data
+        break;
+    }
+}
+
+/**
+ * Same record format as UAVTalk::receiveBatch(), object ID(4), instance ID(2) and the object data.
+ */
+void UAVTalkLogDecoder::receiveBatch(quint16 count, const quint8 *data, qint32 length, quint32 timeStamp)
+{
+    const qint32 recordHeaderLength = UAVTalk::BATCH_RECORD_HEADER_LENGTH;
+    qint32 offset = 0;
+
+    for (quint16 n = 0; n < count; ++n) {
+        if (offset + recordHeaderLength > length) {
+            return;
+        }
+        quint32 objId  = qFromLittleEndian<quint32>(&data[offset]);
+        quint16 instId = qFromLittleEndian<quint16>(&data[offset + 4]);
+        offset += recordHeaderLength;
+
+        QHash<quint32, ObjectLayout>::const_iterator layout = objects.constFind(objId);
+        if (layout == objects.constEnd()) {
+            // the record length is unknown, the rest of the frame is lost
+            stats.unknownObjects++;
+            return;
+        }
+        if (instId == UAVTalk::ALL_INSTANCES || offset + (qint32)layout->numBytes > length) {
+            return;
+        }
+        appendRecord(&layout.value(), objId, instId, &data[offset], timeStamp);
+        offset += layout->numBytes;
+    }
+}
+
+/**
+ * Same delta format as UAVTalk::applyDelta(), relative to the last record of the instance.
+ */
+void UAVTalkLogDecoder::applyDelta(quint32 objId, quint16 instId, const quint8 *data, qint32 length, quint32 timeStamp)
+{
+    const qint32 blockLength = UAVTalk::DELTA_BLOCK_LENGTH;
+
+    QHash<quint64, Stream>::iterator stream = streams.find(((quint64)objId << 16) | instId);
+
+    if (stream == streams.end() || stream->last.isEmpty()) {
+        // no base to apply the delta to yet
+        return;
+    }
+
+    QByteArray record   = stream->last;
+    qint32 numBytes     = record.size();
+    qint32 numBlocks    = (numBytes + blockLength - 1) / blockLength;
+    qint32 bitmapLength = (numBlocks + 7) / 8;
+    if (length < 2 + bitmapLength) {
+        return;
+    }
+    if (stream->deltas != data[0] || Crc::updateCRC(0, (const quint8 *)record.constData(), numBytes) != data[1]) {
+        // a frame was lost, wait for the next full copy
+        stream->last.clear();
+        return;
+    }
+
+    const quint8 *bitmap = &data[2];
+    qint32 pos = 2 + bitmapLength;
+    for (qint32 block = 0; block < numBlocks; ++block) {
+        if (bitmap[block / 8] & (1 << (block % 8))) {
+            qint32 offset = block * blockLength;
+            qint32 n = qMin(blockLength, numBytes - offset);
+            if (pos + n > length) {
+                return;
+            }
+            memcpy(record.data() + offset, &data[pos], n);
+            pos += n;
+        }
+    }
+    appendRecord(stream->layout, objId, instId, (const quint8 *)record.constData(), timeStamp);
+    stream->deltas = data[0] + 1;
+}
+
+UAVTalkLogDecoder::Stream &UAVTalkLogDecoder::streamFor(const ObjectLayout *layout, quint32 objId, quint16 instId)
+{
+    quint64 key = ((quint64)objId << 16) | instId;
+    QHash<quint64, Stream>::iterator stream = streams.find(key);
+
+    if (stream == streams.end()) {
+        Stream newStream;
+        newStream.layout = layout;
+        newStream.instId = instId;
+        newStream.deltas = 0;
+        newStream.columns.resize(layout->fields.count());
+        stream = streams.insert(key, newStream);
+    }
+    return stream.value();
+}
+
+/**
+ * Split one record into the columns of its instance.
+ */
+void UAVTalkLogDecoder::appendRecord(const ObjectLayout *layout, quint32 objId, quint16 instId, const quint8 *data, quint32 timeStamp)
+{
+    Stream *stream = &streamFor(layout, objId, instId);
+
+    stream->last   = QByteArray((const char *)data, layout->numBytes);
+    stream->deltas = 0;
+    quint8 time[sizeof(timeStamp)];
+    qToLittleEndian<quint32>(timeStamp, time);
+    stream->timeStamps.append((const char *)time, sizeof(time));
+    for (int i = 0; i < layout->fields.count(); i++) {
+        const FieldLayout &field = layout->fields.at(i);
+        stream->columns[i].append((const char *)data + field.offset, field.numBytes);
+    }
+    stats.records++;
+}
+
+bool UAVTalkLogDecoder::writeColumns(const QString &outputDir)
+{
+    QDir dir(outputDir);
+
+    foreach(const Stream &stream, streams) {
+        QString name = stream.layout->name;
+        if (!stream.layout->singleInstance) {
+            name += QString("_%1").arg(stream.instId);
+        }
+        if (!dir.mkpath(name)) {
+            qWarning() << "UAVTalkLogDecoder - unable to create" << dir.filePath(name);
+            return false;
+        }
+        QDir objectDir(dir.filePath(name));
+        quint32 records = stream.timeStamps.size() / sizeof(quint32);
+
+        QFile index(objectDir.filePath("columns.txt"));
+        if (!index.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            return false;
+        }
+        QTextStream columns(&index);
+
+        QFile file(objectDir.filePath("timestamp.uint32"));
+        if (!file.open(QIODevice::WriteOnly) || file.write(stream.timeStamps) != stream.timeStamps.size()) {
+            return false;
+        }
+        file.close();
+        columns << file.fileName().section('/', -1) << " uint32 1 " << records << " " << timeUnits << "\n";
+
+        for (int i = 0; i < stream.layout->fields.count(); i++) {
+            const FieldLayout &field = stream.layout->fields.at(i);
+            file.setFileName(objectDir.filePath(field.name + "." + field.type));
+            if (!file.open(QIODevice::WriteOnly) || file.write(stream.columns.at(i)) != stream.columns.at(i).size()) {
+                return false;
+            }
+            file.close();
+            columns << file.fileName().section('/', -1) << " " << field.type << " " << field.numElements << " " << records
+                    << " " << field.units << "\n";
+        }
+    }
+    return true;
+}
+
+/**
+ * @}
+ * @}
+ */
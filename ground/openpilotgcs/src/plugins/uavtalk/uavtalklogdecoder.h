@@ -0,0 +1,126 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavtalklogdecoder.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef UAVTALKLOGDECODER_H
+#define UAVTALKLOGDECODER_H
+
+#include "uavobjectmanager.h"
+#include "uavtalk_global.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+/**
+ * Decodes a logged telemetry stream (.opl) as fast as possible into one binary
+ * array per object field, without going through UAVTalk and the object manager.
+ *
+ * The object definitions are copied when the decoder is created, decode() does not
+ * touch any QObject afterwards and can run on a worker thread.
+ *
+ * For every object instance found in the log, outputDir gets a directory named
+ * after the object (with _<instance> appended for multi instance objects) holding:
+ *  - timestamp.uint32, the log time of each record, in ms for telemetry logs
+ *  - <field>.<type>, the raw little endian values of each record, elements interleaved
+ *  - columns.txt, one "<file> <type> <elements> <records> <units>" line per column
+ *
+ * Records from other sources can be added with addRecord() and written with writeColumns().
+ */
+class UAVTALK_EXPORT UAVTalkLogDecoder {
+public:
+    typedef struct {
+        quint32 packets;
+        quint32 frames;
+        quint32 records;
+        quint32 unknownObjects;
+        quint32 crcErrors;
+        quint32 syncErrors;
+    } Stats;
+
+    explicit UAVTalkLogDecoder(UAVObjectManager *objMngr);
+
+    bool decode(const QString &logFileName, const QString &outputDir);
+
+    void setTimeUnits(const QString &units)
+    {
+        timeUnits = units;
+    }
+    void reserve(quint32 objId, quint16 instId, int records);
+    bool addRecord(quint32 objId, quint16 instId, const quint8 *data, qint32 length, quint32 timeStamp);
+    bool writeColumns(const QString &outputDir);
+    void clear();
+
+    Stats getStats() const
+    {
+        return stats;
+    }
+
+private:
+    typedef struct {
+        QString name;
+        QString type;
+        QString units;
+        quint32 offset;
+        quint32 numBytes;
+        quint32 numElements;
+    } FieldLayout;
+
+    typedef struct {
+        QString name;
+        bool    singleInstance;
+        quint32 numBytes;
+        QList<FieldLayout> fields;
+    } ObjectLayout;
+
+    typedef struct {
+        const ObjectLayout *layout;
+        quint16 instId;
+        QByteArray last;
+        // deltas applied to last since the full copy
+        quint8 deltas;
+        QByteArray timeStamps;
+        QVector<QByteArray> columns;
+    } Stream;
+
+    QHash<quint32, ObjectLayout> objects;
+    QHash<quint64, Stream> streams;
+    // start of a frame that continues in the next log packet
+    QByteArray tail;
+    QString timeUnits;
+    Stats stats;
+
+    qint64 processBuffer(const quint8 *data, qint64 length, quint32 timeStamp);
+    void receiveFrame(quint8 type, quint32 objId, quint16 instId, const quint8 *data, qint32 length, quint32 timeStamp);
+    void receiveBatch(quint16 count, const quint8 *data, qint32 length, quint32 timeStamp);
+    void applyDelta(quint32 objId, quint16 instId, const quint8 *data, qint32 length, quint32 timeStamp);
+    Stream &streamFor(const ObjectLayout *layout, quint32 objId, quint16 instId);
+    void appendRecord(const ObjectLayout *layout, quint32 objId, quint16 instId, const quint8 *data, quint32 timeStamp);
+};
+
+#endif // UAVTALKLOGDECODER_H
@@ -53,12 +53,20 @@ bool UAVTalkPlugin::initialize(const QStringList & arguments, QString *errorStri
     telMngr = new TelemetryManager();
     addAutoReleasedObject(telMngr);
 
+    // Expose the objects of all the connected vehicles
+    telHub = new TelemetryHub(telMngr);
+    addAutoReleasedObject(telHub);
+
     // Connect to connection manager so we get notified when the user connect to his device
     Core::ConnectionManager *cm = Core::ICore::instance()->connectionManager();
     QObject::connect(cm, SIGNAL(deviceConnected(QIODevice *)),
                      this, SLOT(onDeviceConnect(QIODevice *)));
     QObject::connect(cm, SIGNAL(deviceAboutToDisconnect()),
                      this, SLOT(onDeviceDisconnect()));
+    QObject::connect(cm, SIGNAL(vehicleConnected(QString, QIODevice *)),
+                     this, SLOT(onVehicleConnect(QString, QIODevice *)));
+    QObject::connect(cm, SIGNAL(vehicleAboutToDisconnect(QIODevice *)),
+                     this, SLOT(onVehicleDisconnect(QIODevice *)));
     return true;
 }
 
@@ -74,3 +82,13 @@ void UAVTalkPlugin::onDeviceDisconnect()
 {
     telMngr->stop();
 }
+
+void UAVTalkPlugin::onVehicleConnect(const QString &name, QIODevice *dev)
+{
+    telHub->addVehicle(name, dev);
+}
+
+void UAVTalkPlugin::onVehicleDisconnect(QIODevice *dev)
+{
+    telHub->removeVehicle(telHub->findVehicle(dev));
+}
@@ -32,6 +32,7 @@
 #include <QtPlugin>
 #include "uavtalk.h"
 #include "telemetrymanager.h"
+#include "telemetryhub.h"
 
 class UAVTALK_EXPORT UAVTalkPlugin : public ExtensionSystem::IPlugin {
     Q_OBJECT
@@ -48,9 +49,12 @@ public:
 protected slots:
     void onDeviceConnect(QIODevice *dev);
     void onDeviceDisconnect();
+    void onVehicleConnect(const QString &name, QIODevice *dev);
+    void onVehicleDisconnect(QIODevice *dev);
 
 private:
     TelemetryManager *telMngr;
+    TelemetryHub *telHub;
 };
 
 #endif // UAVTALKPLUGIN_H
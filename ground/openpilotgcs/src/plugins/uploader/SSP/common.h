@@ -39,5 +39,10 @@ enum ReceiveState {
     state_unescaped_e
 };
 
+// window limits, see the notes in qssp.cpp. Buffers must hold window slots of
+// SSP_PACKET_BUF_SIZE(size) bytes each.
+#define SSP_MAX_WINDOW 8
+#define SSP_PACKET_BUF_SIZE(size) ((size) + 4)
+
 
 #endif // COMMON_H
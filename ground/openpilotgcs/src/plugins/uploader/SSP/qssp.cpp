@@ -31,6 +31,20 @@
 #include <string.h>
 #include <stdio.h>
 
+/*
+ * Windowed operation: the synch packet carries our receive window as a single
+ * data byte, and a bootloader that understands windows answers with its own
+ * receive window in the ACK of the synch. After that up to
+ * min(txWindow, peer rxWindow) packets are kept in flight, each with its own
+ * timeout and retry count, and packets that arrive ahead of a lost one are held
+ * until the gap is filled. A bootloader that predates windows answers with a
+ * bare ACK, which leaves the link in stop and wait mode, as does a window of
+ * one on either side. After a packet was given up on the next ssp_SendData()
+ * synchronises the link again, and packets outside the receive window are
+ * acked as stale copies from before a synch. This mirrors
+ * flight/libraries/ssp.c.
+ */
+
 
 /** PRIVATE DEFINITIONS **/
 #define SYNC     225                     // Sync character used in Serial Protocol
@@ -65,11 +79,18 @@
 #define ISBITSET(a, b)              (((a) & (b)) == (b) ? TRUE : FALSE)
 #define ISBITCLEAR(a, b)            ((~(a) & (b)) == (b) ? TRUE : FALSE)
 
+// sequence numbers run 1..127, these step and compare them across the rollover
+#define SEQ_COUNT                   0x7F
+#define NEXTSEQNO(s)                ((((s) & 0x7F) >= SEQ_COUNT) ? 1 : (((s) & 0x7F) + 1))
+#define SEQDISTANCE(from, to)       ((uint8_t)(((to) + SEQ_COUNT - (from)) % SEQ_COUNT))
+#define CLAMPWINDOW(w)              ((w) < 1 ? 1 : ((w) > SSP_MAX_WINDOW ? SSP_MAX_WINDOW : (w)))
+
 
 /* Flag bit masks...*/
 #define SENT_SYNCH       (0x01)
 #define ACK_RECEIVED     (0x02)
 #define ACK_EXPECTED     (0x04)
+#define RESYNCH          (0x08) // a packet was given up on, synch before sending again
 
 #define SSP_AWAITING_ACK 0
 #define SSP_ACKED        1
@@ -138,11 +159,14 @@ void qssp::ssp_Init(const PortConfig_t *const info)
     thisport->rxBufSize     = info->rxBufSize;
     thisport->txBuf = info->txBuf;
     thisport->rxBuf = info->rxBuf;
-    thisport->retryCount    = 0;
+    thisport->txWindow      = CLAMPWINDOW(info->txWindow);
+    thisport->rxWindow      = CLAMPWINDOW(info->rxWindow);
+    thisport->txLimit       = 1; // stop and wait until a synch agrees on a window
+    thisport->rxLimit       = 0;
     thisport->sendSynch     = FALSE;                // TRUE;
     thisport->rxSeqNo = 255;
     thisport->txSeqNo = 255;
-    thisport->SendState     = SSP_IDLE;
+    sf_ResetWindow();
     thisport->InputState    = (ReceiveState)0;
     thisport->DecodeState   = (decodeState_)0;
     thisport->TxError = 0;
@@ -164,34 +188,37 @@ void qssp::ssp_Init(const PortConfig_t *const info)
  */
 int16_t qssp::ssp_SendProcess()
 {
-    int16_t value = SSP_TX_WAITING;
+    int16_t value = SSP_TX_IDLE;
 
-    if (thisport->SendState == SSP_AWAITING_ACK) {
-        if (sf_CheckTimeout() == TRUE) {
-            if (thisport->retryCount < thisport->maxRetryCount) {
-                // Try again
-                sf_SendPacket();
-                sf_SetSendTimeout();
-                value = SSP_TX_WAITING;
-            } else {
-                // Give up, # of trys has exceded the limit
-                value = SSP_TX_TIMEOUT;
-                CLEARBIT(thisport->flags, ACK_RECEIVED);
-                thisport->SendState = SSP_IDLE;
-                if (debug) {
-                    qDebug() << "Send TimeOut!";
-                }
-            }
+    for (uint8_t slot = 0; slot < thisport->txWindow && value != SSP_TX_TIMEOUT; slot++) {
+        if (ISBITCLEAR(thisport->txBusy, 1 << slot) || sf_CheckTimeout(slot) == FALSE) {
+            continue;
+        }
+        if (thisport->txSlotRetry[slot] < thisport->maxRetryCount) {
+            // Try again, only this packet is resent
+            sf_SendSlot(slot);
         } else {
-            value = SSP_TX_WAITING;
+            // Give up, # of trys has exceded the limit. The packets behind it can not be
+            // delivered in order either, so the whole window is dropped and the sequence
+            // numbers are synchronised again before the next packet.
+            value = SSP_TX_TIMEOUT;
+            CLEARBIT(thisport->flags, ACK_RECEIVED);
+            SETBIT(thisport->flags, RESYNCH);
+            thisport->txBusy    = 0;
+            thisport->SendState = SSP_IDLE;
+            if (debug) {
+                qDebug() << "Send TimeOut!";
+            }
         }
+    }
+    if (value == SSP_TX_TIMEOUT) {
+        // reported above
     } else if (thisport->SendState == SSP_ACKED) {
         SETBIT(thisport->flags, ACK_RECEIVED);
         value = SSP_TX_ACKED;
         thisport->SendState = SSP_IDLE;
-    } else {
-        thisport->SendState = SSP_IDLE;
-        value = SSP_TX_IDLE;
+    } else if (thisport->txBusy != 0) {
+        value = SSP_TX_WAITING;
     }
     return value;
 }
@@ -277,19 +304,28 @@ uint16_t qssp::ssp_SendDataBlock(uint8_t *data, uint16_t length)
  * \param	length = number of bytes to send
  * \return	SSP_TX_BUFOVERRUN = tried to send too much data
  * \return	SSP_TX_WAITING = data sent and waiting for an ack to arrive
- * \return	SSP_TX_BUSY = a packet has already been sent, but not yet acked
+ * \return	SSP_TX_BUSY = the window is full, wait for an ack before sending more
  *
  * \note
- *
+ * In stop and wait mode the window is a single packet, so SSP_TX_BUSY is returned
+ * until the previous packet has been acked or has timed out. After a packet timed
+ * out the first call starts a synch instead, and SSP_TX_BUSY is returned until the
+ * synch has been acked.
  */
 int16_t qssp::ssp_SendData(const uint8_t *data, const uint16_t length)
 {
     int16_t value = SSP_TX_WAITING;
+    int16_t slot  = -1;
 
     if ((length + 2) > thisport->txBufSize) {
         // TRYING to send too much data.
         value = SSP_TX_BUFOVERRUN;
-    } else if (thisport->SendState == SSP_IDLE) {
+    } else if (ISBITSET(thisport->flags, RESYNCH)) {
+        if (thisport->txBusy == 0) {
+            sf_StartSynch();
+        }
+        value = SSP_TX_BUSY;
+    } else if ((slot = sf_GetTxSlot()) >= 0) {
 #ifdef ACTIVE_SYNCH
         if (thisport->sendSynch == TRUE) {
             sf_SendSynchPacket();
@@ -305,35 +341,27 @@ int16_t qssp::ssp_SendData(const uint8_t *data, const uint16_t length)
             thisport->txSeqNo = 0; // make this zero to cause the other end to re-synch with us
             SETBIT(thisport->flags, SENT_SYNCH);
         } else {
-            // we are sending a data packet
-            CLEARBIT(thisport->txSeqNo, ACK_BIT); // make sure we are not sending a ACK packet
-            thisport->txSeqNo++; // update the sequence number.
-            if (thisport->txSeqNo > 0x7F) { // check for sequence number rollover
-                thisport->txSeqNo = 1; // if we do have rollover then reset to 1 not zero,
-                // zero is reserviced for synchronization requests
-            }
+            // we are sending a data packet, rolls over to 1 not zero,
+            // zero is reserviced for synchronization requests
+            thisport->txSeqNo = NEXTSEQNO(thisport->txSeqNo);
         }
 
 #else
-        CLEARBIT(thisport->txSeqNo, ACK_BIT); // make sure we are not sending a ACK packet
-        thisport->txSeqNo++; // update the sequence number.
-        if (thisport->txSeqNo > 0x7F) { // check for sequence number rollover
-            thisport->txSeqNo = 1; // if we do have rollover then reset to 1 not zero,
-            // zero is reserved for synchronization requests
-        }
+        // rolls over from 127 to 1 not zero, zero is reserved for synchronization requests
+        thisport->txSeqNo = NEXTSEQNO(thisport->txSeqNo);
 #endif // ifdef SYNCH_SEND
         CLEARBIT(thisport->flags, ACK_RECEIVED);
-        thisport->SendState  = SSP_AWAITING_ACK;
         value = SSP_TX_WAITING;
-        thisport->retryCount = 0; // zero out the retry counter for this transmission
-        sf_MakePacket(thisport->txBuf, data, length, thisport->txSeqNo);
-        sf_SendPacket(); // punch out the packet to the serial port
-        sf_SetSendTimeout(); // do the timeout values
+        thisport->txSlotSeq[slot]   = thisport->txSeqNo;
+        thisport->txSlotRetry[slot] = 0; // zero out the retry counter for this transmission
+        SETBIT(thisport->txBusy, 1 << slot);
+        sf_MakePacket(sf_TxSlot(slot), data, length, thisport->txSeqNo);
+        sf_SendSlot(slot); // punch out the packet and start its timeout
         if (debug) {
             qDebug() << "Sent DATA PACKET:" << thisport->txSeqNo;
         }
     } else {
-        // error we are already sending a packet. Need to wait for the current packet to be acked or timeout.
+        // error the window is full. Need to wait for a packet to be acked or timeout.
         value = SSP_TX_BUSY;
         if (debug) {
             qDebug() << "Error sending TX was busy";
@@ -355,6 +383,8 @@ int16_t qssp::ssp_SendData(const uint8_t *data, const uint16_t length)
  *              increment try counter
  *              if number of tries exceed maximum try limit then exit
  * C. goto A
+ *
+ * The synch packet carries our receive window, see the notes at the top of the file.
  */
 uint16_t qssp::ssp_Synchronise()
 {
@@ -362,13 +392,7 @@ uint16_t qssp::ssp_Synchronise()
     uint16_t retval = FALSE;
 
 #ifndef USE_SENDPACKET_DATA
-    thisport->txSeqNo = 0; // make this zero to cause the other end to re-synch with us
-    SETBIT(thisport->flags, SENT_SYNCH);
-    // TODO - should this be using ssp_SendPacketData()??
-    sf_MakePacket(thisport->txBuf, NULL, 0, thisport->txSeqNo); // construct the packet
-    sf_SendPacket();
-    sf_SetSendTimeout();
-    thisport->SendState = SSP_AWAITING_ACK;
+    sf_StartSynch();
     packet_status = SSP_TX_WAITING;
 #else
     packet_status = ssp_SendData(NULL, 0);
@@ -395,26 +419,127 @@ uint16_t qssp::ssp_Synchronise()
     return retval;
 }
 
+/*!
+ * \brief   drops the window and sends a synch packet carrying our receive window
+ * \return  none.
+ *
+ * \note
+ * The synch is retried and timed out like a data packet by ssp_SendProcess.
+ */
+void qssp::sf_StartSynch()
+{
+    sf_ResetWindow();
+    thisport->txLimit = 1;
+    thisport->txSeqNo = 0; // make this zero to cause the other end to re-synch with us
+    SETBIT(thisport->flags, SENT_SYNCH);
+    // TODO - should this be using ssp_SendPacketData()??
+    sf_MakePacket(sf_TxSlot(0), &thisport->rxWindow, 1, thisport->txSeqNo); // construct the packet
+    thisport->txSlotSeq[0]   = thisport->txSeqNo;
+    thisport->txSlotRetry[0] = 0;
+    SETBIT(thisport->txBusy, 1);
+    sf_SendSlot(0);
+}
+
+/*!
+ * \brief   sets the window limits agreed in a synch exchange
+ * \param   peerWindow = receive window sent by the other end, NULL if it does not use windows
+ * \return  none.
+ *
+ * \note
+ * The windowed receive path is only used when both ends keep more than one packet in
+ * flight, a window of one stays in stop and wait mode.
+ */
+void qssp::sf_SetLimits(const uint8_t *peerWindow)
+{
+    if (peerWindow != NULL) {
+        thisport->txLimit = qMin((uint8_t)CLAMPWINDOW(*peerWindow), thisport->txWindow);
+        thisport->rxLimit = (thisport->rxWindow > 1) ? thisport->rxWindow : 0;
+    } else {
+        thisport->txLimit = 1;
+        thisport->rxLimit = 0;
+    }
+}
+
 
 /*!
  * \brief   sends out a preformatted packet for a give port
- * \param   thisport = which port to use.
+ * \param   buf = packet to send
  * \return  none.
  *
  * \note
  * Packet should be formed through the use of sf_MakePacket before calling this function.
  */
-void qssp::sf_SendPacket()
+void qssp::sf_SendPacket(const uint8_t *buf)
 {
     // add 3 to packet data length for: 1 length + 2 CRC (packet overhead)
-    uint8_t packetLen = thisport->txBuf[LENGTH] + 3;
+    uint16_t packetLen = buf[LENGTH] + 3;
 
     // use the raw serial write function so the SYNC byte does not get 'escaped'
     thisport->pfSerialWrite(SYNC);
-    for (uint8_t x = 0; x < packetLen; x++) {
-        sf_write_byte(thisport->txBuf[x]);
+    for (uint16_t x = 0; x < packetLen; x++) {
+        sf_write_byte(buf[x]);
+    }
+}
+
+/*!
+ * \brief   sends (or resends) the packet held in a transmit slot and restarts its timeout
+ * \param   slot = transmit slot to send
+ * \return  none.
+ */
+void qssp::sf_SendSlot(uint8_t slot)
+{
+    sf_SendPacket(sf_TxSlot(slot));
+    thisport->txSlotRetry[slot]++;
+    sf_SetSendTimeout(slot);
+}
+
+/*!
+ * \brief   finds a free transmit slot for the next packet
+ * \return  slot number, or -1 if the window is full
+ *
+ * \note
+ * The window is full when txLimit packets are in flight, or when the oldest packet
+ * that has not been acked is txLimit sequence numbers behind the next one, since the
+ * receiver would drop the next packet as being outside its window.
+ */
+int16_t qssp::sf_GetTxSlot()
+{
+    uint8_t nextSeqNo = NEXTSEQNO(thisport->txSeqNo);
+    uint8_t inFlight  = 0;
+    int16_t freeSlot  = -1;
+
+    for (uint8_t slot = 0; slot < thisport->txWindow; slot++) {
+        if (ISBITSET(thisport->txBusy, 1 << slot)) {
+            inFlight++;
+            if (SEQDISTANCE(thisport->txSlotSeq[slot], nextSeqNo) >= thisport->txLimit) {
+                return -1;
+            }
+        } else if (freeSlot < 0) {
+            freeSlot = slot;
+        }
     }
-    thisport->retryCount++;
+    return (inFlight < thisport->txLimit) ? freeSlot : -1;
+}
+
+/*!
+ * \brief   drops all packets in flight and any that are held waiting for a gap to be filled
+ * \return  none.
+ */
+void qssp::sf_ResetWindow()
+{
+    thisport->txBusy    = 0;
+    thisport->SendState = SSP_IDLE;
+    memset(thisport->rxSlotSeq, 0, sizeof(thisport->rxSlotSeq));
+}
+
+uint8_t *qssp::sf_TxSlot(uint8_t slot)
+{
+    return &thisport->txBuf[slot * SSP_PACKET_BUF_SIZE(thisport->txBufSize)];
+}
+
+uint8_t *qssp::sf_RxSlot(uint8_t slot)
+{
+    return &thisport->rxBuf[slot * SSP_PACKET_BUF_SIZE(thisport->rxBufSize)];
 }
 
 
@@ -459,19 +584,21 @@ void qssp::sf_MakePacket(uint8_t *txBuf, const uint8_t *pdata, uint16_t length,
  * \brief   sends out an ack packet to given sequence number
  * \param   thisport = which port to use
  * \param	seqNumber = sequence number of the packet we would like to ack
+ * \param	pdata = optional ack data, only used to answer a synch request
+ * \param	length = number of ack data bytes, at most 1
  * \return  none.
  *
  * \note
  *
  */
 
-void qssp::sf_SendAckPacket(uint8_t seqNumber)
+void qssp::sf_SendAckPacket(uint8_t seqNumber, const uint8_t *pdata, uint16_t length)
 {
     uint8_t AckSeqNumber = SETBIT(seqNumber, ACK_BIT);
 
     // create the packet, note we pass AckSequenceNumber directly
-    sf_MakePacket(thisport->txBuf, NULL, 0, AckSeqNumber);
-    sf_SendPacket();
+    sf_MakePacket(thisport->ackBuf, pdata, length, AckSeqNumber);
+    sf_SendPacket(thisport->ackBuf);
     if (debug) {
         qDebug() << "Sent ACK PACKET:" << seqNumber;
     }
@@ -536,12 +663,12 @@ uint16_t qssp::sf_crc16(uint16_t crc, uint8_t data)
  *
  */
 
-void qssp::sf_SetSendTimeout()
+void qssp::sf_SetSendTimeout(uint8_t slot)
 {
     uint32_t timeout;
 
     timeout = thisport->pfGetTime() + thisport->timeoutLen;
-    thisport->timeout = timeout;
+    thisport->txSlotTimeout[slot] = timeout;
 }
 
 /*!
@@ -553,18 +680,18 @@ void qssp::sf_SetSendTimeout()
  * \note
  *
  */
-uint16_t qssp::sf_CheckTimeout()
+uint16_t qssp::sf_CheckTimeout(uint8_t slot)
 {
     uint16_t retval = FALSE;
     uint32_t current_time;
 
     current_time = thisport->pfGetTime();
-    if (current_time > thisport->timeout) {
+    if (current_time > thisport->txSlotTimeout[slot]) {
         retval = TRUE;
     }
     if (retval) {
         if (debug) {
-            qDebug() << "timeout " << current_time << thisport->timeout;
+            qDebug() << "timeout " << current_time << thisport->txSlotTimeout[slot];
         }
     }
     return retval;
@@ -737,14 +864,29 @@ int16_t qssp::sf_ReceivePacket()
     int16_t value = FALSE;
 
     if (ISBITSET(thisport->rxBuf[SEQNUM], ACK_BIT)) {
-        // Received an ACK packet, need to check if it matches the previous sent packet
-        if ((thisport->rxBuf[SEQNUM] & 0x7F) == (thisport->txSeqNo & 0x7f)) {
-            // It matches the last packet sent by us
-            SETBIT(thisport->txSeqNo, ACK_BIT);
-            thisport->SendState = SSP_ACKED;
-            value = FALSE;
-            if (debug) {
-                qDebug() << "Received ACK:" << (thisport->txSeqNo & 0x7F);
+        // Received an ACK packet, need to check if it matches a packet in flight
+        uint8_t seqNo = thisport->rxBuf[SEQNUM] & 0x7F;
+        for (uint8_t slot = 0; slot < thisport->txWindow; slot++) {
+            if (ISBITSET(thisport->txBusy, 1 << slot) && thisport->txSlotSeq[slot] == seqNo) {
+                CLEARBIT(thisport->txBusy, 1 << slot);
+                thisport->SendState = SSP_ACKED;
+                if (seqNo == 0) {
+                    // ack of our synch, carries the receive window of a bootloader that supports windows
+                    if (thisport->rxBufLen > 0) {
+                        sf_SetLimits(&thisport->rxBuf[DATA]);
+                        thisport->rxSeqNo = 0;
+                    } else {
+                        sf_SetLimits(NULL);
+                    }
+                    CLEARBIT(thisport->flags, RESYNCH);
+                    if (debug) {
+                        qDebug() << "SYNC window:" << thisport->txLimit;
+                    }
+                }
+                if (debug) {
+                    qDebug() << "Received ACK:" << seqNo;
+                }
+                break;
             }
         }
         // else ignore the ACK packet
@@ -758,12 +900,25 @@ int16_t qssp::sf_ReceivePacket()
 #ifdef ACTIVE_SYNCH
             thisport->sendSynch = TRUE;
 #endif
-            sf_SendAckPacket(thisport->rxBuf[SEQNUM]);
+            sf_ResetWindow();
+            if (thisport->rxBufLen > 0) {
+                // the other end supports windows, answer with our receive window and restart our sequence
+                sf_SetLimits(&thisport->rxBuf[DATA]);
+                thisport->txSeqNo = 0;
+                sf_SendAckPacket(thisport->rxBuf[SEQNUM], &thisport->rxWindow, 1);
+            } else {
+                sf_SetLimits(NULL);
+                sf_SendAckPacket(thisport->rxBuf[SEQNUM], NULL, 0);
+            }
+            // both directions start over, a synch we were about to send is not needed
+            CLEARBIT(thisport->flags, RESYNCH);
             thisport->rxSeqNo   = 0;
             value = FALSE;
+        } else if (thisport->rxLimit > 0) {
+            value = sf_ReceiveWindowed();
         } else if (thisport->rxBuf[SEQNUM] == thisport->rxSeqNo) {
             // Already seen this packet, just ack it, don't act on the packet.
-            sf_SendAckPacket(thisport->rxBuf[SEQNUM]);
+            sf_SendAckPacket(thisport->rxBuf[SEQNUM], NULL, 0);
             value = FALSE;
         } else {
             // New Packet
@@ -779,12 +934,76 @@ int16_t qssp::sf_ReceivePacket()
             // after we send the ACK, it is possible for the host to send a new packet.
             // Thus the application needs to copy the data and reset the receive buffer
             // inside of thisport->pfCallBack()
-            sf_SendAckPacket(thisport->rxBuf[SEQNUM]);
+            sf_SendAckPacket(thisport->rxBuf[SEQNUM], NULL, 0);
             value = TRUE;
         }
     }
     return value;
 }
+
+/*!
+ * \brief   receive one data packet once a window has been agreed on
+ * \return  true = new data was passed to the application
+ * \return	false = otherwise
+ *
+ * \note
+ * The next packet in sequence is passed to the callback together with any held packets
+ * that follow it. A packet ahead of the next one is copied into a free receive slot and
+ * acked, so the sender does not resend it. Any other packet is a resend of one whose ack
+ * was lost, or a stale copy from before a synch, and is only acked again.
+ */
+int16_t qssp::sf_ReceiveWindowed()
+{
+    uint8_t seqNo    = thisport->rxBuf[SEQNUM];
+    uint8_t distance = SEQDISTANCE(NEXTSEQNO(thisport->rxSeqNo), seqNo);
+    int16_t value    = FALSE;
+
+    if (distance == 0) {
+        thisport->rxSeqNo = seqNo;
+        pfCallBack(&(thisport->rxBuf[DATA]), thisport->rxBufLen);
+        for (uint8_t slot = 1; slot < thisport->rxWindow;) {
+            if (thisport->rxSlotSeq[slot] == NEXTSEQNO(thisport->rxSeqNo)) {
+                thisport->rxSeqNo = thisport->rxSlotSeq[slot];
+                thisport->rxSlotSeq[slot] = 0;
+                pfCallBack(sf_RxSlot(slot), thisport->rxSlotLen[slot]);
+                slot = 1; // the next one may sit in any slot
+            } else {
+                slot++;
+            }
+        }
+        // a held packet that is not ahead of the window any more would be taken for a
+        // new one once the sequence numbers wrap, drop it
+        for (uint8_t slot = 1; slot < thisport->rxWindow; slot++) {
+            if (thisport->rxSlotSeq[slot] != 0 &&
+                SEQDISTANCE(NEXTSEQNO(thisport->rxSeqNo), thisport->rxSlotSeq[slot]) >= thisport->rxLimit) {
+                thisport->rxSlotSeq[slot] = 0;
+            }
+        }
+        sf_SendAckPacket(seqNo, NULL, 0);
+        value = TRUE;
+    } else if (distance < thisport->rxLimit) {
+        // slot 0 is the receive buffer itself, 1..rxWindow-1 hold packets ahead of a gap
+        uint8_t freeSlot = 0;
+        for (uint8_t slot = 1; slot < thisport->rxWindow; slot++) {
+            if (thisport->rxSlotSeq[slot] == seqNo) {
+                freeSlot = slot; // already held, just ack it again
+                break;
+            } else if (thisport->rxSlotSeq[slot] == 0 && freeSlot == 0) {
+                freeSlot = slot;
+            }
+        }
+        if (freeSlot != 0) {
+            memcpy(sf_RxSlot(freeSlot), &(thisport->rxBuf[DATA]), thisport->rxBufLen);
+            thisport->rxSlotLen[freeSlot] = thisport->rxBufLen;
+            thisport->rxSlotSeq[freeSlot] = seqNo;
+            sf_SendAckPacket(seqNo, NULL, 0);
+        }
+    } else {
+        // Already seen this packet, or it is outside the window, just ack it, don't act on the packet.
+        sf_SendAckPacket(seqNo, NULL, 0);
+    }
+    return value;
+}
 qssp::qssp(port *info, bool debug) : debug(debug)
 {
     thisport = info;
@@ -794,11 +1013,14 @@ qssp::qssp(port *info, bool debug) : debug(debug)
     thisport->rxBufSize     = info->rxBufSize;
     thisport->txBuf = info->txBuf;
     thisport->rxBuf = info->rxBuf;
-    thisport->retryCount    = 0;
+    thisport->txWindow      = CLAMPWINDOW(info->txWindow);
+    thisport->rxWindow      = CLAMPWINDOW(info->rxWindow);
+    thisport->txLimit       = 1; // stop and wait until a synch agrees on a window
+    thisport->rxLimit       = 0;
     thisport->sendSynch     = FALSE;                // TRUE;
     thisport->rxSeqNo = 255;
     thisport->txSeqNo = 255;
-    thisport->SendState     = SSP_IDLE;
+    sf_ResetWindow();
     thisport->InputState    = (ReceiveState)0;
     thisport->DecodeState   = (decodeState_)0;
     thisport->TxError = 0;
@@ -70,6 +70,8 @@ typedef struct {
     uint16_t txBufSize; // CRC for data in Packet buff
     uint16_t max_retry; // Maximum number of retrys for a single transmit.
     int32_t  timeoutLen;                             // how long to wait for each retry to succeed
+    uint8_t  txWindow; // number of transmit slots in txBuf, 0 or 1 = stop and wait
+    uint8_t  rxWindow; // number of receive slots in rxBuf, 0 or 1 = in order only
     // function returns time in number of seconds that has elapsed from a given reference point
 } PortConfig_t;
 
@@ -87,15 +89,23 @@ private:
     // static void      sf_SendSynchPacket( Port_t *thisport );
     uint16_t sf_crc16(uint16_t crc, uint8_t data);
     void        sf_write_byte(uint8_t c);
-    void        sf_SetSendTimeout();
-    uint16_t sf_CheckTimeout();
+    void        sf_SetSendTimeout(uint8_t slot);
+    uint16_t sf_CheckTimeout(uint8_t slot);
     int16_t     sf_DecodeState(uint8_t c);
     int16_t     sf_ReceiveState(uint8_t c);
 
-    void        sf_SendPacket();
-    void        sf_SendAckPacket(uint8_t seqNumber);
+    void        sf_SendPacket(const uint8_t *buf);
+    void        sf_SendSlot(uint8_t slot);
+    void        sf_SendAckPacket(uint8_t seqNumber, const uint8_t *pdata, uint16_t length);
     void     sf_MakePacket(uint8_t *buf, const uint8_t *pdata, uint16_t length, uint8_t seqNo);
     int16_t     sf_ReceivePacket();
+    int16_t     sf_ReceiveWindowed();
+    int16_t     sf_GetTxSlot();
+    void        sf_ResetWindow();
+    void        sf_StartSynch();
+    void        sf_SetLimits(const uint8_t *peerWindow);
+    uint8_t     *sf_TxSlot(uint8_t slot);
+    uint8_t     *sf_RxSlot(uint8_t slot);
     uint16_t ssp_SendDataBlock(uint8_t *data, uint16_t length);
     bool debug;
 public:
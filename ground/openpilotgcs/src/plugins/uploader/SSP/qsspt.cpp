@@ -36,29 +36,32 @@ void qsspt::run()
         sendstatus    = this->ssp_SendProcess();
         msleep(1);
         sendbufmutex.lock();
-        if (datapending && receivestatus == SSP_TX_IDLE) {
-            this->ssp_SendData(mbuf, msize);
+        // the packet is copied into the window, so the caller may go on as soon as
+        // there was room for it rather than waiting for its ack
+        if (datapending && receivestatus == SSP_TX_IDLE && this->ssp_SendData(mbuf, msize) != SSP_TX_BUSY) {
             datapending = false;
-        }
-        sendbufmutex.unlock();
-        if (sendstatus == SSP_TX_ACKED) {
             sendwait.wakeAll();
         }
+        sendbufmutex.unlock();
     }
 }
 bool qsspt::sendData(uint8_t *buf, uint16_t size)
 {
+    sendbufmutex.lock();
     if (datapending) {
+        sendbufmutex.unlock();
         return false;
     }
-    sendbufmutex.lock();
     datapending = true;
     mbuf  = buf;
     msize = size;
+    while (datapending) {
+        if (!sendwait.wait(&sendbufmutex, 10000)) {
+            datapending = false;
+            break;
+        }
+    }
     sendbufmutex.unlock();
-    msendwait.lock();
-    sendwait.wait(&msendwait, 10000);
-    msendwait.unlock();
     return true;
 }
 
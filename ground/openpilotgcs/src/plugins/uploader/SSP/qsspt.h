@@ -52,7 +52,6 @@ private:
     uint16_t sendstatus;
     uint16_t receivestatus;
     QWaitCondition sendwait;
-    QMutex msendwait;
     bool debug;
 };
 
@@ -357,24 +357,10 @@ void DeviceWidget::uploadFirmware()
     QByteArray desc = loadedFW.right(100);
     if (desc.startsWith("OpFw")) {
         descriptionArray = desc;
-        // Now do sanity checking:
-        // - Check whether board type matches firmware:
-        int board = m_dfu->devices[deviceID].ID;
-        int firmwareBoard = ((desc.at(12) & 0xff) << 8) + (desc.at(13) & 0xff);
-        if ((board == 0x401 && firmwareBoard == 0x402) ||
-            (board == 0x901 && firmwareBoard == 0x902) || // L3GD20 revo supports Revolution firmware
-            (board == 0x902 && firmwareBoard == 0x903)) { // RevoMini1 supporetd by RevoMini2 firmware
-            // These firmwares are designed to be backwards compatible
-        } else if (firmwareBoard != board) {
-            status("Error: firmware does not match board", STATUSICON_FAIL);
-            updateButtons(true);
-            return;
-        }
-        // Check the firmware embedded in the file:
-        QByteArray firmwareHash = desc.mid(40, 20);
-        QByteArray fileHash     = QCryptographicHash::hash(loadedFW.left(loadedFW.length() - 100), QCryptographicHash::Sha1);
-        if (firmwareHash != fileHash) {
-            status("Error: firmware file corrupt", STATUSICON_FAIL);
+        // Now do sanity checking: the board type and the hash of the image
+        QString error = DFUObject::PackagedFirmwareError(loadedFW, m_dfu->devices[deviceID].ID);
+        if (!error.isEmpty()) {
+            status("Error: " + error, STATUSICON_FAIL);
             updateButtons(true);
             return;
         }
@@ -49,6 +49,8 @@ DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
         info->txBufSize  = MAX_PACKET_DATA_LEN;
         info->max_retry  = 10;
         info->timeoutLen = 1000;
+        info->txWindow   = SSP_TX_WINDOW;
+        info->rxWindow   = 1;
         if (info->status() != port::open) {
             cout << "Could not open serial port\n";
             mready = false;
@@ -74,10 +76,12 @@ DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
         QEventLoop m_eventloop;
         QTimer::singleShot(200, &m_eventloop, SLOT(quit()));
         m_eventloop.exec();
+        // Without a port name there must be a single bootloader on the bus,
+        // with one the bootloader of that USB serial number is opened.
         QList<USBPortInfo> devices;
-        devices = USBMonitor::instance()->availableDevices(0x20a0, -1, -1, USBMonitor::Bootloader);
+        devices = availableBootloaders(portname);
         if (devices.length() == 1) {
-            if (hidHandle.open(1, devices.first().vendorID, devices.first().productID, 0, 0) == 1) {
+            if (hidHandle.open(1, devices.first().vendorID, devices.first().productID, 0, 0, portname) == 1) {
                 mready = true;
                 QTimer::singleShot(200, &m_eventloop, SLOT(quit()));
                 m_eventloop.exec();
@@ -97,11 +101,11 @@ DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
                     QTimer::singleShot(2000, &m_eventloop, SLOT(quit()));
                 }
                 m_eventloop.exec();
-                devices = USBMonitor::instance()->availableDevices(0x20a0, -1, -1, USBMonitor::Bootloader);
+                devices = availableBootloaders(portname);
                 qDebug() << "Devices length: " << devices.length();
                 if (devices.length() == 1) {
                     qDebug() << "Opening device";
-                    if (hidHandle.open(1, devices.first().vendorID, devices.first().productID, 0, 0) == 1) {
+                    if (hidHandle.open(1, devices.first().vendorID, devices.first().productID, 0, 0, portname) == 1) {
                         QTimer::singleShot(200, &m_eventloop, SLOT(quit()));
                         m_eventloop.exec();
                         qDebug() << "OP_DFU detected after delay";
@@ -120,6 +124,25 @@ DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
     }
 }
 
+/**
+   Lists the bootloaders on the USB bus, only the one with the given serial
+   number if there is one.
+ */
+QList<USBPortInfo> DFUObject::availableBootloaders(const QString &serialNumber)
+{
+    QList<USBPortInfo> bootloaders = USBMonitor::instance()->availableDevices(0x20a0, -1, -1, USBMonitor::Bootloader);
+
+    if (!serialNumber.isEmpty()) {
+        QMutableListIterator<USBPortInfo> it(bootloaders);
+        while (it.hasNext()) {
+            if (it.next().serialNumber != serialNumber) {
+                it.remove();
+            }
+        }
+    }
+    return bootloaders;
+}
+
 DFUObject::~DFUObject()
 {
     if (use_serial) {
@@ -816,11 +839,11 @@ OP_DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &veri
     }
 
     if (verify) {
+        // Rather than reading the whole image back, ask the bootloader for
+        // the CRC it computes over the flash and compare with the file's.
         emit operationProgress(QString("Verifying firmware"));
         cout << "Starting code verification\n";
-        QByteArray arr2;
-        StartDownloadT(&arr2, arr.length(), OP_DFU::FW);
-        if (arr != arr2) {
+        if (!findDevices() || device >= devices.size() || devices[device].FW_CRC != crc) {
             cout << "Verify:FAILED\n";
             return OP_DFU::abort;
         }
@@ -998,6 +1021,34 @@ quint32 DFUObject::CRC32WideFast(quint32 Crc, quint32 Size, quint32 *Buffer)
 /**
    Utility function
  */
+/**
+   Checks that a packaged firmware is meant for the board and that the
+   image matches the hash in its description.
+ */
+QString DFUObject::PackagedFirmwareError(const QByteArray &firmware, int board)
+{
+    QByteArray desc = firmware.right(100);
+
+    if (!desc.startsWith("OpFw")) {
+        return QString("firmware is not packaged");
+    }
+    int firmwareBoard = ((desc.at(12) & 0xff) << 8) + (desc.at(13) & 0xff);
+    if ((board == 0x401 && firmwareBoard == 0x402) ||
+        (board == 0x901 && firmwareBoard == 0x902) || // L3GD20 revo supports Revolution firmware
+        (board == 0x902 && firmwareBoard == 0x903)) { // RevoMini1 supporetd by RevoMini2 firmware
+        // These firmwares are designed to be backwards compatible
+    } else if (firmwareBoard != board) {
+        return QString("firmware does not match board");
+    }
+    // Check the firmware embedded in the file:
+    QByteArray firmwareHash = desc.mid(40, 20);
+    QByteArray fileHash     = QCryptographicHash::hash(firmware.left(firmware.length() - 100), QCryptographicHash::Sha1);
+    if (firmwareHash != fileHash) {
+        return QString("firmware file corrupt");
+    }
+    return QString();
+}
+
 quint32 DFUObject::CRCFromQBArray(QByteArray array, quint32 Size)
 {
     quint32 pad = Size - array.length();
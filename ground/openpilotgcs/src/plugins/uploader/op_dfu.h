@@ -29,6 +29,7 @@ using namespace std;
 
 #define MAX_PACKET_DATA_LEN 255
 #define MAX_PACKET_BUF_SIZE (1 + 1 + MAX_PACKET_DATA_LEN + 2)
+#define SSP_TX_WINDOW       8 // upload packets kept in flight, limited by the bootloader receive window
 
 namespace OP_DFU {
 enum TransferTypes {
@@ -112,7 +113,12 @@ class DFUObject : public QThread {
 
 public:
     static quint32 CRCFromQBArray(QByteArray array, quint32 Size);
+    // Checks a firmware packaged with its OpFw description, empty when it can be
+    // flashed on a board with the given ID
+    static QString PackagedFirmwareError(const QByteArray &firmware, int board);
     // DFUObject(bool debug);
+    // port is the serial port with use_serial, else the USB serial number
+    // of the bootloader to open (empty when only one is connected)
     DFUObject(bool debug, bool use_serial, QString port);
 
     virtual ~DFUObject();
@@ -176,13 +182,14 @@ private:
     qsspt *serialhandle;
     int sendData(void *, int);
     int receiveData(void *data, int size);
-    uint8_t sspTxBuf[MAX_PACKET_BUF_SIZE];
+    uint8_t sspTxBuf[SSP_TX_WINDOW * SSP_PACKET_BUF_SIZE(MAX_PACKET_DATA_LEN)];
     uint8_t sspRxBuf[MAX_PACKET_BUF_SIZE];
     port *info;
 
 
     // USB Bootloader:
     opHID_hidapi hidHandle;
+    QList<USBPortInfo> availableBootloaders(const QString &serialNumber);
     int setStartBit(int command)
     {
         return command | 0x20;
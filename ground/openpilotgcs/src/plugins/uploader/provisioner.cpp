@@ -0,0 +1,188 @@
+/**
+ ******************************************************************************
+ *
+ * @file       provisioner.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup Uploader Uploader Plugin
+ * @{
+ * @brief Flashes a firmware on every connected board at once
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "provisioner.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+
+// time the USB monitor needs to list the boards already plugged in
+#define SETTLE_TIME 2000
+// the GCS quits when no board has shown up for this long
+#define IDLE_TIME   10000
+
+using namespace OP_DFU;
+
+Provisioner::Provisioner(const QString &firmwareFile, QObject *parent) : QObject(parent),
+    m_firmwareFile(firmwareFile),
+    m_succeeded(0),
+    m_failed(0),
+    m_filter(0x20a0, -1, -1, USBMonitor::Bootloader)
+{
+    m_idleTimer.setSingleShot(true);
+    m_idleTimer.setInterval(IDLE_TIME);
+    connect(&m_idleTimer, SIGNAL(timeout()), this, SLOT(finish()));
+}
+
+Provisioner::~Provisioner()
+{
+    foreach(DFUObject * dfu, m_busy) {
+        dfu->wait();
+        delete dfu;
+    }
+}
+
+/**
+   Loads the firmware and starts looking for boards once the event loop runs.
+ */
+void Provisioner::start()
+{
+    QFile file(m_firmwareFile);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        report(QString(), "cannot open " + m_firmwareFile);
+        m_failed++;
+        QTimer::singleShot(0, this, SLOT(finish()));
+        return;
+    }
+    m_firmware = file.readAll();
+    connect(&m_filter, SIGNAL(deviceDiscovered()), this, SLOT(scan()));
+    QTimer::singleShot(SETTLE_TIME, this, SLOT(scan()));
+}
+
+/**
+   Starts an upload on every bootloader that was not seen before.
+ */
+void Provisioner::scan()
+{
+    QList<USBPortInfo> bootloaders = USBMonitor::instance()->availableDevices(0x20a0, -1, -1, USBMonitor::Bootloader);
+
+    foreach(const USBPortInfo &info, bootloaders) {
+        // the DFUObject runs an event loop while it opens the board, which can
+        // bring us back here, so the board is marked as seen first
+        if (!info.serialNumber.isEmpty() && !m_seen.contains(info.serialNumber)) {
+            m_seen.insert(info.serialNumber);
+            provision(info.serialNumber);
+        }
+    }
+    if (m_busy.isEmpty()) {
+        m_idleTimer.start();
+    } else {
+        m_idleTimer.stop();
+    }
+}
+
+void Provisioner::provision(const QString &serialNumber)
+{
+    DFUObject *dfu = new DFUObject(false, false, serialNumber);
+
+    if (!dfu->ready()) {
+        delete dfu;
+        failed(serialNumber, "could not open the bootloader");
+        return;
+    }
+    dfu->AbortOperation();
+    if (!dfu->enterDFU(0) || !dfu->findDevices() || dfu->numberOfDevices < 1) {
+        delete dfu;
+        failed(serialNumber, "could not enter DFU mode");
+        return;
+    }
+    QString error = DFUObject::PackagedFirmwareError(m_firmware, dfu->devices[0].ID);
+    if (error.isEmpty() && !dfu->devices[0].Writable) {
+        error = "device not writable";
+    }
+    if (!error.isEmpty()) {
+        delete dfu;
+        failed(serialNumber, error);
+        return;
+    }
+    connect(dfu, SIGNAL(uploadFinished(OP_DFU::Status)), this, SLOT(uploadFinished(OP_DFU::Status)));
+    if (!dfu->UploadFirmware(m_firmwareFile, true, 0)) {
+        delete dfu;
+        failed(serialNumber, "could not start upload");
+        return;
+    }
+    m_busy.insert(serialNumber, dfu);
+    report(serialNumber, "uploading");
+}
+
+/**
+   Writes the description and boots the board once its upload was verified.
+ */
+void Provisioner::uploadFinished(OP_DFU::Status status)
+{
+    DFUObject *dfu = qobject_cast<DFUObject *>(sender());
+    QString serialNumber = m_busy.key(dfu);
+
+    if (dfu == NULL || serialNumber.isEmpty()) {
+        return;
+    }
+    m_busy.remove(serialNumber);
+    // the signal is sent just before the upload thread returns
+    dfu->wait();
+    if (status == OP_DFU::Last_operation_Success) {
+        status = dfu->UploadDescription(m_firmware.right(100));
+    }
+    if (status == OP_DFU::Last_operation_Success) {
+        dfu->JumpToApp(false, false);
+        m_succeeded++;
+        report(serialNumber, "done, CRC verified");
+    } else {
+        failed(serialNumber, "upload failed with code: " + dfu->StatusToString(status));
+    }
+    dfu->deleteLater();
+    if (m_busy.isEmpty()) {
+        m_idleTimer.start();
+    }
+}
+
+void Provisioner::finish()
+{
+    if (!m_busy.isEmpty()) {
+        return;
+    }
+    report(QString(), QString("%1 board(s) provisioned, %2 failed").arg(m_succeeded).arg(m_failed));
+    QCoreApplication::exit(m_failed ? 1 : 0);
+}
+
+void Provisioner::failed(const QString &serialNumber, const QString &reason)
+{
+    m_failed++;
+    report(serialNumber, "FAILED, " + reason);
+}
+
+void Provisioner::report(const QString &serialNumber, const QString &message)
+{
+    QTextStream out(stdout);
+
+    if (serialNumber.isEmpty()) {
+        out << "Provisioning: " << message << endl;
+    } else {
+        out << "Provisioning " << serialNumber << ": " << message << endl;
+    }
+}
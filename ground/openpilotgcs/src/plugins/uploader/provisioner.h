@@ -0,0 +1,82 @@
+/**
+ ******************************************************************************
+ *
+ * @file       provisioner.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup Uploader Uploader Plugin
+ * @{
+ * @brief Flashes a firmware on every connected board at once
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PROVISIONER_H
+#define PROVISIONER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+
+#include "op_dfu.h"
+
+/**
+ * Bench provisioning, started with the -provision <firmware> option.
+ *
+ * Every board that shows up on USB in its bootloader is opened by its serial
+ * number with a DFUObject of its own, so the uploads run in one thread per
+ * board at the same time. Each upload is verified against the CRC the
+ * bootloader computes over the flash, then the description is written and the
+ * board is booted. The GCS quits once no board is left busy and none has
+ * appeared for a while, with a non zero exit code if any board failed.
+ *
+ * Settings are not pushed: that needs a telemetry link and an object manager
+ * per board, and the GCS has a single one of each.
+ */
+class Provisioner : public QObject {
+    Q_OBJECT
+
+public:
+    Provisioner(const QString &firmwareFile, QObject *parent = 0);
+    ~Provisioner();
+
+    void start();
+
+private slots:
+    void scan();
+    void uploadFinished(OP_DFU::Status status);
+    void finish();
+
+private:
+    QString m_firmwareFile;
+    QByteArray m_firmware;
+    QMap<QString, OP_DFU::DFUObject *> m_busy; // uploads running, by USB serial number
+    QSet<QString> m_seen;
+    int m_succeeded;
+    int m_failed;
+    QTimer m_idleTimer;
+    USBSignalFilter m_filter;
+
+    void provision(const QString &serialNumber);
+    void failed(const QString &serialNumber, const QString &reason);
+    void report(const QString &serialNumber, const QString &message);
+};
+
+#endif // PROVISIONER_H
@@ -32,7 +32,8 @@ HEADERS += uploadergadget.h \
     uploader_global.h \
     enums.h \
     rebootdialog.h \
-    oplinkwatchdog.h
+    oplinkwatchdog.h \
+    provisioner.h
 
 SOURCES += uploadergadget.cpp \
     uploadergadgetconfiguration.cpp \
@@ -48,7 +49,8 @@ SOURCES += uploadergadget.cpp \
     SSP/qsspt.cpp \
     runningdevicewidget.cpp \
     rebootdialog.cpp \
-    oplinkwatchdog.cpp
+    oplinkwatchdog.cpp \
+    provisioner.cpp
 
 OTHER_FILES += Uploader.pluginspec
 
@@ -26,15 +26,14 @@
  */
 #include "uploaderplugin.h"
 #include "uploadergadgetfactory.h"
+#include "provisioner.h"
 
 #include <extensionsystem/pluginmanager.h>
 
 #include <QStringList>
 
-UploaderPlugin::UploaderPlugin()
-{
-    // Do nothing
-}
+UploaderPlugin::UploaderPlugin() : provisioner(0)
+{}
 
 UploaderPlugin::~UploaderPlugin()
 {
@@ -43,9 +42,13 @@ UploaderPlugin::~UploaderPlugin()
 
 bool UploaderPlugin::initialize(const QStringList & args, QString *errMsg)
 {
-    Q_UNUSED(args);
     Q_UNUSED(errMsg);
 
+    int index = args.indexOf("-provision");
+    if (index >= 0 && index + 1 < args.size()) {
+        provisionFile = args.at(index + 1);
+    }
+
     mf = new UploaderGadgetFactory(this);
     addAutoReleasedObject(mf);
 
@@ -54,7 +57,10 @@ bool UploaderPlugin::initialize(const QStringList & args, QString *errMsg)
 
 void UploaderPlugin::extensionsInitialized()
 {
-    // Do nothing
+    if (!provisionFile.isEmpty()) {
+        provisioner = new Provisioner(provisionFile, this);
+        provisioner->start();
+    }
 }
 
 void UploaderPlugin::shutdown()
@@ -32,6 +32,7 @@
 #include "uploader_global.h"
 
 class UploaderGadgetFactory;
+class Provisioner;
 
 class UPLOADER_EXPORT UploaderPlugin : public ExtensionSystem::IPlugin {
     Q_OBJECT
@@ -47,6 +48,8 @@ public:
 
 private:
     UploaderGadgetFactory *mf;
+    QString provisionFile;
+    Provisioner *provisioner;
 };
 
 #endif // UPLOADERPLUGIN_H
@@ -254,144 +254,55 @@ bool UAVObjectGeneratorFlight::process_object(ObjectInfo *info)
     outCode.replace(QString("$(INITFIELDS)"), initfields);
 
     // Replace the $(SETGETFIELDS) tag
+    // The field accessors are inlined so that the field offset and size are
+    // constants at the call site rather than another call away.
     QString setgetfields;
     for (int n = 0; n < info->fields.length(); ++n) {
-        // if (!info->fields[n]->defaultValues.isEmpty() )
-        {
-            // For non-array fields
-            if (info->fields[n]->numElements == 1) {
-                /* Set */
-                setgetfields.append(QString("void %2%3Set(%1 *New%3)\n")
-                                    .arg(fieldTypeStrC[info->fields[n]->type])
-                                    .arg(info->name)
-                                    .arg(info->fields[n]->name));
-                setgetfields.append(QString("{\n"));
-                setgetfields.append(QString("    UAVObjSetDataField(%1Handle(), (void *)New%2, offsetof(%1Data, %2), sizeof(%3));\n")
-                                    .arg(info->name)
-                                    .arg(info->fields[n]->name)
-                                    .arg(fieldTypeStrC[info->fields[n]->type]));
-                setgetfields.append(QString("}\n"));
-
-                /* GET */
-                setgetfields.append(QString("void %2%3Get(%1 *New%3)\n")
-                                    .arg(fieldTypeStrC[info->fields[n]->type])
-                                    .arg(info->name)
-                                    .arg(info->fields[n]->name));
-                setgetfields.append(QString("{\n"));
-                setgetfields.append(QString("    UAVObjGetDataField(%1Handle(), (void *)New%2, offsetof(%1Data, %2), sizeof(%3));\n")
-                                    .arg(info->name)
-                                    .arg(info->fields[n]->name)
-                                    .arg(fieldTypeStrC[info->fields[n]->type]));
-                setgetfields.append(QString("}\n"));
-            } else {
-                // When no struct accessor is available for a field array accessor is the default.
-                QString suffix = QString("");
-
-                if (info->fields[n]->elementNames[0].compare(QString("0")) != 0) {
-                    // struct based field accessor
-                    QString structTypeName = QString("%1%2Data").arg(info->name).arg(info->fields[n]->name);
-                    /* SET */
-                    setgetfields.append(QString("void %2%3Set( %1 *New%3 )\n")
-                                        .arg(structTypeName)
-                                        .arg(info->name)
-                                        .arg(info->fields[n]->name));
-                    setgetfields.append(QString("{\n"));
-                    setgetfields.append(QString("    UAVObjSetDataField(%1Handle(), (void *)New%2, offsetof(%1Data, %2), %3*sizeof(%4));\n")
-                                        .arg(info->name)
-                                        .arg(info->fields[n]->name)
-                                        .arg(info->fields[n]->numElements)
-                                        .arg(fieldTypeStrC[info->fields[n]->type]));
-                    setgetfields.append(QString("}\n"));
-
-                    /* GET */
-                    setgetfields.append(QString("void %2%3Get( %1 *New%3 )\n")
-                                        .arg(structTypeName)
-                                        .arg(info->name)
-                                        .arg(info->fields[n]->name));
-                    setgetfields.append(QString("{\n"));
-                    setgetfields.append(QString("    UAVObjGetDataField(%1Handle(), (void *)New%2, offsetof(%1Data, %2), %3*sizeof(%4));\n")
-                                        .arg(info->name)
-                                        .arg(info->fields[n]->name)
-                                        .arg(info->fields[n]->numElements)
-                                        .arg(fieldTypeStrC[info->fields[n]->type]));
-                    setgetfields.append(QString("}\n"));
-
-                    // Append array suffix to array accessors
-                    suffix = QString("Array");
-                }
-
-                // array based field accessor
-                /* SET */
-                setgetfields.append(QString("void %2%3%4Set( %1 *New%3 )\n")
-                                    .arg(fieldTypeStrC[info->fields[n]->type])
-                                    .arg(info->name)
-                                    .arg(info->fields[n]->name)
-                                    .arg(suffix));
-                setgetfields.append(QString("{\n"));
-                setgetfields.append(QString("    UAVObjSetDataField(%1Handle(), (void *)New%2, offsetof(%1Data, %2), %3*sizeof(%4));\n")
-                                    .arg(info->name)
-                                    .arg(info->fields[n]->name)
-                                    .arg(info->fields[n]->numElements)
-                                    .arg(fieldTypeStrC[info->fields[n]->type]));
-                setgetfields.append(QString("}\n"));
-
-                /* GET */
-                setgetfields.append(QString("void %2%3%4Get( %1 *New%3 )\n")
-                                    .arg(fieldTypeStrC[info->fields[n]->type])
-                                    .arg(info->name)
-                                    .arg(info->fields[n]->name)
-                                    .arg(suffix));
-                setgetfields.append(QString("{\n"));
-                setgetfields.append(QString("    UAVObjGetDataField(%1Handle(), (void *)New%2, offsetof(%1Data, %2), %3*sizeof(%4));\n")
-                                    .arg(info->name)
-                                    .arg(info->fields[n]->name)
-                                    .arg(info->fields[n]->numElements)
-                                    .arg(fieldTypeStrC[info->fields[n]->type]));
-                setgetfields.append(QString("}\n"));
-            }
+        QString suffix = QString("");
+        QString size;
+        if (info->fields[n]->numElements == 1) {
+            size = QString("sizeof(%1)").arg(fieldTypeStrC[info->fields[n]->type]);
+        } else {
+            size = QString("%1 * sizeof(%2)").arg(info->fields[n]->numElements).arg(fieldTypeStrC[info->fields[n]->type]);
         }
-    }
-    outCode.replace(QString("$(SETGETFIELDS)"), setgetfields);
-
-    // Replace the $(SETGETFIELDSEXTERN) tag
-    QString setgetfieldsextern;
-    for (int n = 0; n < info->fields.length(); ++n) {
-        // if (!info->fields[n]->defaultValues.isEmpty() )
-        {
-            QString suffix = QString("");
-            if (info->fields[n]->elementNames[0].compare(QString("0")) != 0) {
-                // struct based field accessor
-                QString structTypeName = QString("%1%2Data").arg(info->name).arg(info->fields[n]->name);
-
-                /* SET */
-                setgetfieldsextern.append(QString("extern void %2%3Set(%1 *New%3);\n")
-                                          .arg(structTypeName)
-                                          .arg(info->name)
-                                          .arg(info->fields[n]->name));
+        if (info->fields[n]->numElements > 1 && info->fields[n]->elementNames[0].compare(QString("0")) != 0) {
+            // struct based field accessor
+            QString structTypeName = QString("%1%2Data").arg(info->name).arg(info->fields[n]->name);
 
-                /* GET */
-                setgetfieldsextern.append(QString("extern void %2%3Get(%1 *New%3);\n")
-                                          .arg(structTypeName)
-                                          .arg(info->name)
-                                          .arg(info->fields[n]->name));
-                suffix = QString("Array");
-            }
             /* SET */
-            setgetfieldsextern.append(QString("extern void %2%3%4Set(%1 *New%3);\n")
-                                      .arg(fieldTypeStrC[info->fields[n]->type])
-                                      .arg(info->name)
-                                      .arg(info->fields[n]->name)
-                                      .arg(suffix));
+            setgetfields.append(QString("static inline void %2%3Set(%1 *New%3) { UAVObjSetDataField(%2Handle(), (void *)New%3, offsetof(%2Data, %3), %4); }\n")
+                                .arg(structTypeName)
+                                .arg(info->name)
+                                .arg(info->fields[n]->name)
+                                .arg(size));
 
             /* GET */
-            setgetfieldsextern.append(QString("extern void %2%3%4Get(%1 *New%3);\n")
-                                      .arg(fieldTypeStrC[info->fields[n]->type])
-                                      .arg(info->name)
-                                      .arg(info->fields[n]->name)
-                                      .arg(suffix));
+            setgetfields.append(QString("static inline void %2%3Get(%1 *New%3) { UAVObjGetDataField(%2Handle(), (void *)New%3, offsetof(%2Data, %3), %4); }\n")
+                                .arg(structTypeName)
+                                .arg(info->name)
+                                .arg(info->fields[n]->name)
+                                .arg(size));
+
+            // Append array suffix to array accessors
+            suffix = QString("Array");
         }
+        /* SET */
+        setgetfields.append(QString("static inline void %2%3%4Set(%1 *New%3) { UAVObjSetDataField(%2Handle(), (void *)New%3, offsetof(%2Data, %3), %5); }\n")
+                            .arg(fieldTypeStrC[info->fields[n]->type])
+                            .arg(info->name)
+                            .arg(info->fields[n]->name)
+                            .arg(suffix)
+                            .arg(size));
+
+        /* GET */
+        setgetfields.append(QString("static inline void %2%3%4Get(%1 *New%3) { UAVObjGetDataField(%2Handle(), (void *)New%3, offsetof(%2Data, %3), %5); }\n")
+                            .arg(fieldTypeStrC[info->fields[n]->type])
+                            .arg(info->name)
+                            .arg(info->fields[n]->name)
+                            .arg(suffix)
+                            .arg(size));
     }
-    outInclude.replace(QString("$(SETGETFIELDSEXTERN)"), setgetfieldsextern);
+    outInclude.replace(QString("$(SETGETFIELDS)"), setgetfields);
 
     // Write the flight code
     bool res = writeFileIfDiffrent(flightOutputPath.absolutePath() + "/" + info->namelc + ".c", outCode);
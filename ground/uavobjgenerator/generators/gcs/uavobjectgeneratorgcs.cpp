@@ -280,6 +280,19 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
     }
     outCode.replace(QString("$(FIELDSINIT)"), finit);
 
+    // Replace the $(FIELDSLAYOUT) tag
+    QString layout;
+    int offset = 0;
+    for (int n = 0; n < info->fields.length(); ++n) {
+        layout.append(QString("Q_STATIC_ASSERT(offsetof(%1::DataFields, %2) == %3);\n")
+                      .arg(info->name)
+                      .arg(info->fields[n]->name)
+                      .arg(offset));
+        offset += info->fields[n]->numBytes * info->fields[n]->numElements;
+    }
+    layout.append(QString("Q_STATIC_ASSERT(%1::NUMBYTES == %2);\n").arg(info->name).arg(offset));
+    outCode.replace(QString("$(FIELDSLAYOUT)"), layout);
+
     // Replace the $(DATAFIELDINFO) tag
     QString name;
     QString enums;
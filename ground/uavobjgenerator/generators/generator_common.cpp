@@ -58,6 +58,8 @@ void replaceCommonTags(QString & out, ObjectInfo *info)
     out.replace(QString("$(DESCRIPTION)"), info->description);
     // Replace $(CATEGORY) tag
     out.replace(QString("$(CATEGORY)"), info->category);
+    // Replace $(CATEGORYUC) tag, the objects without one are filed under System
+    out.replace(QString("$(CATEGORYUC)"), info->category.isEmpty() ? QString("SYSTEM") : info->category.toUpper());
     // Replace $(NAMEUC) tag
     out.replace(QString("$(NAMEUC)"), info->name.toUpper());
     // Replace $(OBJID) tag
@@ -75,6 +77,10 @@ void replaceCommonTags(QString & out, ObjectInfo *info)
     // Replace $(ISPRIORITY) tag
     out.replace(QString("$(ISPRIORITY)"), boolTo01String(info->isPriority));
     out.replace(QString("$(ISPRIORITYTF)"), boolToTRUEFALSEString(info->isPriority));
+    // Replace $(ISDOUBLEBUFFERED) tag
+    out.replace(QString("$(ISDOUBLEBUFFERED)"), boolTo01String(info->isDoubleBuffered));
+    // Replace $(ISNOTIFYONCHANGE) tag
+    out.replace(QString("$(ISNOTIFYONCHANGE)"), boolTo01String(info->isNotifyOnChange));
     // Replace $(GCSACCESS) tag
     value = accessModeStr[info->gcsAccess];
     out.replace(QString("$(GCSACCESS)"), value);
@@ -41,7 +41,10 @@ bool UAVObjectGeneratorMatlab::generate(UAVObjectParser *parser, QString templat
 
     QString matlabCodeTemplate = readFile(matlabTemplatePath.absoluteFilePath("uavobject.m.template"));
 
-    if (matlabCodeTemplate.isEmpty()) {
+    // MEX helper indexing the log packets, shipped next to the converter
+    QString matlabScanCode     = readFile(matlabTemplatePath.absoluteFilePath("OPLogScan.c"));
+
+    if (matlabCodeTemplate.isEmpty() || matlabScanCode.isEmpty()) {
         std::cerr << "Problem reading matlab templates" << endl;
         return false;
     }
@@ -54,12 +57,14 @@ bool UAVObjectGeneratorMatlab::generate(UAVObjectParser *parser, QString templat
 
     matlabCodeTemplate.replace(QString("$(INSTANTIATIONCODE)"), matlabInstantiationCode);
     matlabCodeTemplate.replace(QString("$(SWITCHCODE)"), matlabSwitchCode);
+    matlabCodeTemplate.replace(QString("$(INDEXCODE)"), matlabIndexCode);
     matlabCodeTemplate.replace(QString("$(CLEANUPCODE)"), matlabCleanupCode);
     matlabCodeTemplate.replace(QString("$(SAVEOBJECTSCODE)"), matlabSaveObjectsCode);
     matlabCodeTemplate.replace(QString("$(ALLOCATIONCODE)"), matlabAllocationCode);
     matlabCodeTemplate.replace(QString("$(EXPORTCSVCODE)"), matlabExportCsvCode);
 
-    bool res = writeFile(matlabOutputPath.absolutePath() + "/OPLogConvert.m", matlabCodeTemplate);
+    bool res = writeFileIfDiffrent(matlabOutputPath.absolutePath() + "/OPLogConvert.m", matlabCodeTemplate) &&
+               writeFileIfDiffrent(matlabOutputPath.absolutePath() + "/OPLogScan.c", matlabScanCode);
     if (!res) {
         cout << "Error: Could not write output files" << endl;
         return false;
@@ -118,19 +123,26 @@ bool UAVObjectGeneratorMatlab::process_object(ObjectInfo *info, int numBytes)
     // ==============================================================//
     // Generate 'Switch:' code (will replace the $(SWITCHCODE) tag) //
     // ==============================================================//
-    matlabSwitchCode.append("\t\tcase " + objectTableName.toUpper() + "_OBJID\n");
-    matlabSwitchCode.append("\t\t\t" + tableIdxName + " = " + tableIdxName + " + 1;\n");
-    matlabSwitchCode.append("\t\t\t" + objectTableName + "FidIdx(" + tableIdxName + ") = bufferIdx; %#ok<*AGROW>\n");
-    matlabSwitchCode.append("\t\t\tbufferIdx=bufferIdx + " + objectTableName.toUpper() + "_NUMBYTES+1; %+1 is for CRC\n");
-    matlabSwitchCode.append("\t\t\tif " + tableIdxName + " >= length(" + objectTableName + "FidIdx) %Check to see if pre-allocated memory is exhausted\n");
-    matlabSwitchCode.append("\t\t\t\t" + objectTableName + "FidIdx(" + tableIdxName + "*2) = 0;\n");
-    matlabSwitchCode.append("\t\t\tend\n");
+    matlabSwitchCode.append("\t\t\tcase " + objectTableName.toUpper() + "_OBJID\n");
+    matlabSwitchCode.append("\t\t\t\t" + tableIdxName + " = " + tableIdxName + " + 1;\n");
+    matlabSwitchCode.append("\t\t\t\t" + objectTableName + "FidIdx(" + tableIdxName + ") = bufferIdx; %#ok<*AGROW>\n");
+    matlabSwitchCode.append("\t\t\t\tbufferIdx=bufferIdx + " + objectTableName.toUpper() + "_NUMBYTES+1; %+1 is for CRC\n");
+    matlabSwitchCode.append("\t\t\t\tif " + tableIdxName + " >= length(" + objectTableName + "FidIdx) %Check to see if pre-allocated memory is exhausted\n");
+    matlabSwitchCode.append("\t\t\t\t\t" + objectTableName + "FidIdx(" + tableIdxName + "*2) = 0;\n");
+    matlabSwitchCode.append("\t\t\t\tend\n");
+
+
+    // ============================================================//
+    // Generate 'Index:' code (will replace the $(INDEXCODE) tag) //
+    // ============================================================//
+    matlabIndexCode.append("\t" + objectTableName + "FidIdx = packetDataIdx(packetObjID == " + objectTableName.toUpper() + "_OBJID);\n");
+    matlabIndexCode.append("\tknownObjIDs(end + 1) = " + objectTableName.toUpper() + "_OBJID;\n");
 
 
     // ============================================================//
     // Generate 'Cleanup:' code (will replace the $(CLEANUP) tag) //
     // ============================================================//
-    matlabCleanupCode.append(objectTableName + "FidIdx =" + objectTableName + "FidIdx(1:" + tableIdxName + ");\n");
+    matlabCleanupCode.append("\t" + objectTableName + "FidIdx =" + objectTableName + "FidIdx(1:" + tableIdxName + ");\n");
 
     // =================================================================//
     // Generate functions code (will replace the $(ALLOCATIONCODE) tag) //
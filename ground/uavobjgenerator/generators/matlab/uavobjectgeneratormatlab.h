@@ -39,6 +39,7 @@ private:
     bool process_object(ObjectInfo *info, int numBytes);
     QString matlabInstantiationCode;
     QString matlabSwitchCode;
+    QString matlabIndexCode;
     QString matlabCleanupCode;
     QString matlabAllocationCode;
     QString matlabSaveObjectsCode;
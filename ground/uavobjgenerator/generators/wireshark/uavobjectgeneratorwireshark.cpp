@@ -28,6 +28,19 @@
 
 using namespace std;
 
+/**
+ * Initializer of an array of field handles, wireshark wants them at -1
+ **/
+static QString unregisteredHandles(int count)
+{
+    QStringList handles;
+
+    for (int n = 0; n < count; ++n) {
+        handles << "-1";
+    }
+    return handles.join(", ");
+}
+
 bool UAVObjectGeneratorWireshark::generate(UAVObjectParser *parser, QString templatepath, QString outputpath)
 {
     fieldTypeStrHf << "FT_INT8" << "FT_INT16" << "FT_INT32" << "FT_UINT8"
@@ -83,18 +96,31 @@ bool UAVObjectGeneratorWireshark::generate(UAVObjectParser *parser, QString temp
                     uavobjectsOutputPath.absoluteFilePath(uavostaticfiles[i]));
     }
 
-    /* Generate the per-object files from the templates, and keep track of the list of generated filenames */
-    QString objFileNames;
+    /* Collect the descriptor tables of all the objects into a single dissector */
     for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
         ObjectInfo *info = parser->getObjectByIndex(objidx);
-        process_object(info, uavobjectsOutputPath);
-        objFileNames.append(" packet-op-uavobjects-" + info->namelc + ".c");
+        process_object(info, parser->getNumBytes(objidx));
+    }
+
+    wiresharkCodeTemplate.replace(QString("$(SUBTREESTATICS)"), subtreestatics);
+    wiresharkCodeTemplate.replace(QString("$(SUBTREES)"), subtrees);
+    wiresharkCodeTemplate.replace(QString("$(FIELDHANDLES)"), fieldhandles);
+    wiresharkCodeTemplate.replace(QString("$(ENUMFIELDNAMES)"), enums);
+    wiresharkCodeTemplate.replace(QString("$(FIELDTABLES)"), fieldtables);
+    wiresharkCodeTemplate.replace(QString("$(OBJECTTABLE)"), objecttable);
+    wiresharkCodeTemplate.replace(QString("$(HEADERFIELDS)"),
+                                  QString("   static hf_register_info hf[] = {\r\n") + headerfields + QString("   };\r\n"));
+
+    bool res = writeFileIfDiffrent(uavobjectsOutputPath.absolutePath() + "/packet-op-uavobjects.c", wiresharkCodeTemplate);
+    if (!res) {
+        cout << "Error: Could not write wireshark code files" << endl;
+        return false;
     }
 
     /* Write the uavobject dissector's Makefile.common */
-    wiresharkMakeTemplate.replace(QString("$(UAVOBJFILENAMES)"), objFileNames);
-    bool res = writeFileIfDiffrent(uavobjectsOutputPath.absolutePath() + "/Makefile.common",
-                                   wiresharkMakeTemplate);
+    wiresharkMakeTemplate.replace(QString("$(UAVOBJFILENAMES)"), QString(" packet-op-uavobjects.c"));
+    res = writeFileIfDiffrent(uavobjectsOutputPath.absolutePath() + "/Makefile.common",
+                              wiresharkMakeTemplate);
     if (!res) {
         cout << "Error: Could not write wireshark Makefile" << endl;
         return false;
@@ -105,69 +131,50 @@ bool UAVObjectGeneratorWireshark::generate(UAVObjectParser *parser, QString temp
 
 
 /**
- * Generate the Flight object files
+ * Append the handles, enum strings and descriptor tables of one object
  **/
-bool UAVObjectGeneratorWireshark::process_object(ObjectInfo *info, QDir outputpath)
+bool UAVObjectGeneratorWireshark::process_object(ObjectInfo *info, int numBytes)
 {
     if (info == NULL) {
         return false;
     }
 
-    // Prepare output strings
-    QString outCode = wiresharkCodeTemplate;
-
-    // Replace common tags
-    replaceCommonTags(outCode, info);
-
-    // Replace the $(SUBTREES) and $(SUBTREESTATICS) tags
-    QString subtrees;
-    QString subtreestatics;
-    subtreestatics.append(QString("static gint ett_uavo = -1;\r\n"));
-    subtrees.append(QString("&ett_uavo,\r\n"));
+    // Subtree of the object, and of each of its arrays
+    subtreestatics.append(QString("static gint ett_uavo_%1 = -1;\r\n").arg(info->namelc));
+    subtrees.append(QString("\t&ett_uavo_%1,\r\n").arg(info->namelc));
     for (int n = 0; n < info->fields.length(); ++n) {
         if (info->fields[n]->numElements > 1) {
-            /* Reserve a subtree for each array */
             subtreestatics.append(QString("static gint ett_%1_%2 = -1;\r\n")
                                   .arg(info->namelc)
                                   .arg(info->fields[n]->name));
-            subtrees.append(QString("&ett_%1_%2,\r\n")
+            subtrees.append(QString("\t&ett_%1_%2,\r\n")
                             .arg(info->namelc)
                             .arg(info->fields[n]->name));
         }
     }
-    outCode.replace(QString("$(SUBTREES)"), subtrees);
-    outCode.replace(QString("$(SUBTREESTATICS)"), subtreestatics);
 
-    // Replace the $(FIELDHANDLES) tag
-    QString type;
-    QString fields;
+    // One handle per field, and one array of element handles per array field
+    fieldhandles.append(QString("static int hf_op_uavobjects_%1[%2] = { %3 };\r\n")
+                        .arg(info->namelc)
+                        .arg(info->fields.length())
+                        .arg(unregisteredHandles(info->fields.length())));
     for (int n = 0; n < info->fields.length(); ++n) {
-        fields.append(QString("static int hf_op_uavobjects_%1_%2 = -1;\r\n")
-                      .arg(info->namelc)
-                      .arg(info->fields[n]->name));
         if (info->fields[n]->numElements > 1) {
-            QStringList elemNames = info->fields[n]->elementNames;
-            for (int m = 0; m < elemNames.length(); ++m) {
-                fields.append(QString("static int hf_op_uavobjects_%1_%2_%3 = -1;\r\n")
-                              .arg(info->namelc)
-                              .arg(info->fields[n]->name)
-                              .arg(elemNames[m]));
-            }
+            fieldhandles.append(QString("static int hf_op_uavobjects_%1_%2[%3] = { %4 };\r\n")
+                                .arg(info->namelc)
+                                .arg(info->fields[n]->name)
+                                .arg(info->fields[n]->numElements)
+                                .arg(unregisteredHandles(info->fields[n]->numElements)));
         }
     }
-    outCode.replace(QString("$(FIELDHANDLES)"), fields);
 
-    // Replace the $(ENUMFIELDNAMES) tag
-    QString enums;
+    // Enumeration options of the enum fields
     for (int n = 0; n < info->fields.length(); ++n) {
-        // Only for enum types
         if (info->fields[n]->type == FIELDTYPE_ENUM) {
-            enums.append(QString("/* Field %1 information */\r\n").arg(info->fields[n]->name));
-            enums.append(QString("/* Enumeration options for field %1 */\r\n").arg(info->fields[n]->name));
+            enums.append(QString("/* Enumeration options for field %1.%2 */\r\n").arg(info->name).arg(info->fields[n]->name));
             enums.append(QString("static const value_string uavobjects_%1_%2[]= {\r\n")
                          .arg(info->namelc)
                          .arg(info->fields[n]->name));
-            // Go through each option
             QStringList options = info->fields[n]->options;
             for (int m = 0; m < options.length(); ++m) {
                 enums.append(QString("\t{ %1, \"%2\" },\r\n")
@@ -178,112 +185,78 @@ bool UAVObjectGeneratorWireshark::process_object(ObjectInfo *info, QDir outputpa
             enums.append(QString("};\r\n"));
         }
     }
-    outCode.replace(QString("$(ENUMFIELDNAMES)"), enums);
 
-    // Replace the $(POPULATETREE) tag
-    QString treefields;
+    // Field descriptors, walked in order by the dissector
+    fieldtables.append(QString("static const uavo_field_t uavo_%1_fields[] = {\r\n").arg(info->namelc));
     for (int n = 0; n < info->fields.length(); ++n) {
         if (info->fields[n]->numElements == 1) {
-            treefields.append(QString("    ptvcursor_add(cursor, hf_op_uavobjects_%1_%2, sizeof(%3), ENC_LITTLE_ENDIAN);\r\n")
-                              .arg(info->namelc)
-                              .arg(info->fields[n]->name)
-                              .arg(fieldTypeStrGlib[info->fields[n]->type]));
+            fieldtables.append(QString("\t{ &hf_op_uavobjects_%1[%2], NULL, NULL, %3, 1 },\r\n")
+                               .arg(info->namelc)
+                               .arg(n)
+                               .arg(info->fields[n]->numBytes));
         } else {
-            treefields.append(QString("    {\r\n"));
-            treefields.append(QString("      proto_item * it = NULL;\r\n"));
-            treefields.append(QString("      it = ptvcursor_add_no_advance(cursor, hf_op_uavobjects_%1_%2, 1, ENC_NA);\r\n")
-                              .arg(info->namelc)
-                              .arg(info->fields[n]->name));
-            treefields.append(QString("      ptvcursor_push_subtree(cursor, it, ett_%1_%2);\r\n")
-                              .arg(info->namelc)
-                              .arg(info->fields[n]->name));
-            /* Populate each array element into the table */
-            QStringList elemNames = info->fields[n]->elementNames;
-            for (int m = 0; m < elemNames.length(); ++m) {
-                treefields.append(QString("    ptvcursor_add(cursor, hf_op_uavobjects_%1_%2_%3, sizeof(%4), ENC_LITTLE_ENDIAN);\r\n")
-                                  .arg(info->namelc)
-                                  .arg(info->fields[n]->name)
-                                  .arg(elemNames[m])
-                                  .arg(fieldTypeStrGlib[info->fields[n]->type]));
-            }
-            treefields.append(QString("      ptvcursor_pop_subtree(cursor);\r\n"));
-            treefields.append(QString("    }\r\n"));
+            fieldtables.append(QString("\t{ &hf_op_uavobjects_%1[%2], hf_op_uavobjects_%1_%3, &ett_%1_%3, %4, %5 },\r\n")
+                               .arg(info->namelc)
+                               .arg(n)
+                               .arg(info->fields[n]->name)
+                               .arg(info->fields[n]->numBytes)
+                               .arg(info->fields[n]->numElements));
         }
     }
-    outCode.replace(QString("$(POPULATETREE)"), treefields);
+    fieldtables.append(QString("};\r\n"));
 
-    // Replace the $(HEADERFIELDS) tag
-    QString headerfields;
-    headerfields.append(QString("   static hf_register_info hf[] = {\r\n"));
+    objecttable.append(QString("\t{ %1, \"%2\", &ett_uavo_%3, %4, array_length(uavo_%3_fields), uavo_%3_fields },\r\n")
+                       .arg(QString("0x") + QString().setNum(info->id, 16).toUpper())
+                       .arg(info->name)
+                       .arg(info->namelc)
+                       .arg(numBytes));
+
+    // Field registrations, the filter names are unchanged: <object>.<field>[.<element>]
     for (int n = 0; n < info->fields.length(); ++n) {
-        // For non-array fields
+        QString display;
+        if (info->fields[n]->type == FIELDTYPE_ENUM) {
+            display = QString("BASE_DEC, VALS(uavobjects_%1_%2), 0x0, NULL, HFILL")
+                      .arg(info->namelc)
+                      .arg(info->fields[n]->name);
+        } else if (info->fields[n]->type == FIELDTYPE_FLOAT32) {
+            display = QString("BASE_NONE, NULL, 0x0, NULL, HFILL");
+        } else {
+            display = QString("BASE_DEC_HEX, NULL, 0x0, NULL, HFILL");
+        }
+
+        headerfields.append(QString("\t { &hf_op_uavobjects_%1[%2],\r\n")
+                            .arg(info->namelc)
+                            .arg(n));
         if (info->fields[n]->numElements == 1) {
-            headerfields.append(QString("\t { &hf_op_uavobjects_%1_%2,\r\n")
-                                .arg(info->namelc)
-                                .arg(info->fields[n]->name));
-            headerfields.append(QString("\t   { \"%1\", \"%2.%3\", %4,\r\n")
+            headerfields.append(QString("\t   { \"%1\", \"%2.%1\", %3,\r\n")
                                 .arg(info->fields[n]->name)
                                 .arg(info->namelc)
-                                .arg(info->fields[n]->name)
                                 .arg(fieldTypeStrHf[info->fields[n]->type]));
-            if (info->fields[n]->type == FIELDTYPE_ENUM) {
-                headerfields.append(QString("\t     BASE_DEC, VALS(uavobjects_%1_%2), 0x0, NULL, HFILL \r\n")
-                                    .arg(info->namelc)
-                                    .arg(info->fields[n]->name));
-            } else if (info->fields[n]->type == FIELDTYPE_FLOAT32) {
-                headerfields.append(QString("\t     BASE_NONE, NULL, 0x0, NULL, HFILL \r\n"));
-            } else {
-                headerfields.append(QString("\t     BASE_DEC_HEX, NULL, 0x0, NULL, HFILL\r\n"));
-            }
-            headerfields.append(QString("\t   },\r\n"));
+            headerfields.append(QString("\t     %1 }\r\n").arg(display));
             headerfields.append(QString("\t },\r\n"));
         } else {
-            headerfields.append(QString("\t { &hf_op_uavobjects_%1_%2,\r\n")
-                                .arg(info->namelc)
-                                .arg(info->fields[n]->name));
-            headerfields.append(QString("\t   { \"%1\", \"%2.%3\", FT_NONE,\r\n")
+            headerfields.append(QString("\t   { \"%1\", \"%2.%1\", FT_NONE,\r\n")
                                 .arg(info->fields[n]->name)
-                                .arg(info->namelc)
-                                .arg(info->fields[n]->name));
-            headerfields.append(QString("\t     BASE_NONE, NULL, 0x0, NULL, HFILL\r\n"));
-            headerfields.append(QString("\t   },\r\n"));
+                                .arg(info->namelc));
+            headerfields.append(QString("\t     BASE_NONE, NULL, 0x0, NULL, HFILL }\r\n"));
             headerfields.append(QString("\t },\r\n"));
 
             QStringList elemNames = info->fields[n]->elementNames;
             for (int m = 0; m < elemNames.length(); ++m) {
-                headerfields.append(QString("\t { &hf_op_uavobjects_%1_%2_%3,\r\n")
+                headerfields.append(QString("\t { &hf_op_uavobjects_%1_%2[%3],\r\n")
                                     .arg(info->namelc)
                                     .arg(info->fields[n]->name)
-                                    .arg(elemNames[m]));
-                headerfields.append(QString("\t   { \"%1\", \"%2.%3.%4\", %5,\r\n")
+                                    .arg(m));
+                headerfields.append(QString("\t   { \"%1\", \"%2.%3.%1\", %4,\r\n")
                                     .arg(elemNames[m])
                                     .arg(info->namelc)
                                     .arg(info->fields[n]->name)
-                                    .arg(elemNames[m])
                                     .arg(fieldTypeStrHf[info->fields[n]->type]));
-                if (info->fields[n]->type == FIELDTYPE_ENUM) {
-                    headerfields.append(QString("\t     BASE_DEC, VALS(uavobjects_%1_%2), 0x0, NULL, HFILL \r\n")
-                                        .arg(info->namelc)
-                                        .arg(info->fields[n]->name));
-                } else if (info->fields[n]->type == FIELDTYPE_FLOAT32) {
-                    headerfields.append(QString("\t     BASE_NONE, NULL, 0x0, NULL, HFILL \r\n"));
-                } else {
-                    headerfields.append(QString("\t     BASE_DEC_HEX, NULL, 0x0, NULL, HFILL\r\n"));
-                }
-                headerfields.append(QString("\t   },\r\n"));
+                headerfields.append(QString("\t     %1 }\r\n").arg(display));
                 headerfields.append(QString("\t },\r\n"));
             }
         }
     }
-    headerfields.append(QString("   };\r\n"));
-    outCode.replace(QString("$(HEADERFIELDS)"), headerfields);
-
-    // Write the flight code
-    bool res = writeFileIfDiffrent(outputpath.absolutePath() + "/packet-op-uavobjects-" + info->namelc + ".c", outCode);
-    if (!res) {
-        cout << "Error: Could not write wireshark code files" << endl;
-        return false;
-    }
 
     return true;
 }
@@ -39,7 +39,14 @@ public:
     QDir wiresharkOutputPath;
 
 private:
-    bool process_object(ObjectInfo *info, QDir outputpath);
+    bool process_object(ObjectInfo *info, int numBytes);
+    QString subtreestatics;
+    QString subtrees;
+    QString fieldhandles;
+    QString enums;
+    QString fieldtables;
+    QString objecttable;
+    QString headerfields;
 };
 
 #endif
@@ -27,6 +27,7 @@
 #include <QFile>
 #include <QString>
 #include <QStringList>
+#include <QThread>
 #include <iostream>
 
 #include "generators/java/uavobjectgeneratorjava.h"
@@ -42,6 +43,29 @@
 
 using namespace std;
 
+/**
+ * Run one code generator in its own thread
+ */
+template<class Generator>
+class GeneratorThread : public QThread {
+public:
+    GeneratorThread(UAVObjectParser *parser, const QString & templatepath, const QString & outputpath)
+        : parser(parser), templatepath(templatepath), outputpath(outputpath) {}
+
+protected:
+    void run()
+    {
+        Generator generator;
+
+        generator.generate(parser, templatepath, outputpath);
+    }
+
+private:
+    UAVObjectParser *parser;
+    QString templatepath;
+    QString outputpath;
+};
+
 /**
  * print usage info
  */
@@ -209,46 +233,40 @@ int main(int argc, char *argv[])
         return RETURN_OK;
     }
 
-    // generate flight code if wanted
+    // The generators only read the parsed objects and write to their own
+    // output directories, so they run side by side.
+    QList<QThread *> generators;
     if (do_flight | do_all) {
         cout << "generating flight code" << endl;
-        UAVObjectGeneratorFlight flightgen;
-        flightgen.generate(parser, templatepath, outputpath);
+        generators << new GeneratorThread<UAVObjectGeneratorFlight>(parser, templatepath, outputpath);
     }
-
-    // generate gcs code if wanted
     if (do_gcs | do_all) {
         cout << "generating gcs code" << endl;
-        UAVObjectGeneratorGCS gcsgen;
-        gcsgen.generate(parser, templatepath, outputpath);
+        generators << new GeneratorThread<UAVObjectGeneratorGCS>(parser, templatepath, outputpath);
     }
-
-    // generate java code if wanted
     if (do_java | do_all) {
         cout << "generating java code" << endl;
-        UAVObjectGeneratorJava javagen;
-        javagen.generate(parser, templatepath, outputpath);
+        generators << new GeneratorThread<UAVObjectGeneratorJava>(parser, templatepath, outputpath);
     }
-
-    // generate python code if wanted
     if (do_python | do_all) {
         cout << "generating python code" << endl;
-        UAVObjectGeneratorPython pygen;
-        pygen.generate(parser, templatepath, outputpath);
+        generators << new GeneratorThread<UAVObjectGeneratorPython>(parser, templatepath, outputpath);
     }
-
-    // generate matlab code if wanted
     if (do_matlab | do_all) {
         cout << "generating matlab code" << endl;
-        UAVObjectGeneratorMatlab matlabgen;
-        matlabgen.generate(parser, templatepath, outputpath);
+        generators << new GeneratorThread<UAVObjectGeneratorMatlab>(parser, templatepath, outputpath);
     }
-
-    // generate wireshark plugin if wanted
     if (do_wireshark | do_all) {
         cout << "generating wireshark code" << endl;
-        UAVObjectGeneratorWireshark wiresharkgen;
-        wiresharkgen.generate(parser, templatepath, outputpath);
+        generators << new GeneratorThread<UAVObjectGeneratorWireshark>(parser, templatepath, outputpath);
+    }
+
+    foreach(QThread * generator, generators) {
+        generator->start();
+    }
+    foreach(QThread * generator, generators) {
+        generator->wait();
+        delete generator;
     }
 
     return RETURN_OK;
@@ -63,7 +63,7 @@ QList<ObjectInfo *> UAVObjectParser::getObjectInfo()
 
 ObjectInfo *UAVObjectParser::getObjectByIndex(int objIndex)
 {
-    return objInfo[objIndex];
+    return objInfo.at(objIndex);
 }
 
 /**
@@ -71,7 +71,7 @@ ObjectInfo *UAVObjectParser::getObjectByIndex(int objIndex)
  */
 QString UAVObjectParser::getObjectName(int objIndex)
 {
-    ObjectInfo *info = objInfo[objIndex];
+    ObjectInfo *info = objInfo.at(objIndex);
 
     if (info == NULL) {
         return QString();
@@ -85,7 +85,7 @@ QString UAVObjectParser::getObjectName(int objIndex)
  */
 quint32 UAVObjectParser::getObjectID(int objIndex)
 {
-    ObjectInfo *info = objInfo[objIndex];
+    ObjectInfo *info = objInfo.at(objIndex);
 
     if (info == NULL) {
         return 0;
@@ -98,7 +98,7 @@ quint32 UAVObjectParser::getObjectID(int objIndex)
  */
 int UAVObjectParser::getNumBytes(int objIndex)
 {
-    ObjectInfo *info = objInfo[objIndex];
+    ObjectInfo *info = objInfo.at(objIndex);
 
     if (info == NULL) {
         return 0;
@@ -652,11 +652,38 @@ QString UAVObjectParser::processObjectAttributes(QDomNode & node, ObjectInfo *in
         }
     }
 
+    // Get doublebuffered attribute
+    attr = attributes.namedItem("doublebuffered");
+    info->isDoubleBuffered = false;
+    if (!attr.isNull()) {
+        if (attr.nodeValue().compare(QString("true")) == 0) {
+            info->isDoubleBuffered = true;
+        } else if (attr.nodeValue().compare(QString("false")) != 0) {
+            return QString("Object:doublebuffered attribute value is invalid (true|false)");
+        }
+    }
+
+    // Get notifyonchange attribute
+    attr = attributes.namedItem("notifyonchange");
+    info->isNotifyOnChange = false;
+    if (!attr.isNull()) {
+        if (attr.nodeValue().compare(QString("true")) == 0) {
+            info->isNotifyOnChange = true;
+        } else if (attr.nodeValue().compare(QString("false")) != 0) {
+            return QString("Object:notifyonchange attribute value is invalid (true|false)");
+        }
+    }
+
     // Settings objects can only have a single instance
     if (info->isSettings && !info->isSingleInst) {
         return QString("Object: Settings objects can not have multiple instances");
     }
 
+    // Only single instance data objects can be double buffered
+    if (info->isDoubleBuffered && (info->isSettings || !info->isSingleInst)) {
+        return QString("Object: Only single instance data objects can be double buffered");
+    }
+
     // Done
     return QString();
 }
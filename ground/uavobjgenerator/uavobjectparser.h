@@ -86,6 +86,8 @@ typedef struct  {
     bool       isSingleInst;
     bool       isSettings;
     bool       isPriority;
+    bool       isDoubleBuffered; /** Flight side keeps a double buffered copy for lock free reads **/
+    bool       isNotifyOnChange; /** Flight side only sends the events of the sets that change the data **/
     AccessMode gcsAccess;
     AccessMode flightAccess;
     bool       flightTelemetryAcked;
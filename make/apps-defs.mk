@@ -81,10 +81,12 @@ SRC += $(PIOSCOMMON)/pios_rfm22b_com.c
 SRC += $(PIOSCOMMON)/pios_rcvr.c
 SRC += $(PIOSCOMMON)/pios_sbus.c
 SRC += $(PIOSCOMMON)/pios_sdcard.c
+SRC += $(PIOSCOMMON)/pios_sdlog.c
 SRC += $(PIOSCOMMON)/pios_sensors.c
 
 ## Misc library functions
 SRC += $(FLIGHTLIB)/sanitycheck.c
+SRC += $(FLIGHTLIB)/gyrodirect.c
 SRC += $(FLIGHTLIB)/CoordinateConversions.c
 SRC += $(MATHLIB)/sin_lookup.c
 SRC += $(MATHLIB)/pid.c
@@ -109,6 +111,7 @@ SRC += $(PIOSCOMMON)/pios_usb_desc_hid_only.c
 SRC += $(PIOSCOMMON)/pios_usb_util.c
 endif
 ## PIOS system code
+SRC += $(PIOSCOMMON)/pios_initcall.c
 SRC += $(PIOSCOMMON)/pios_task_monitor.c
 SRC += $(PIOSCOMMON)/pios_callbackscheduler.c
 SRC += $(PIOSCOMMON)/pios_notify.c
@@ -116,9 +119,12 @@ SRC += $(PIOSCOMMON)/pios_instrumentation.c
 SRC += $(PIOSCOMMON)/pios_mem.c
 ## Misc library functions
 SRC += $(FLIGHTLIB)/fifo_buffer.c
+SRC += $(FLIGHTLIB)/spsc_ring.c
 
 SRC += $(MATHLIB)/mathmisc.c
 SRC += $(MATHLIB)/butterworth.c
+SRC += $(MATHLIB)/biquad.c
+SRC += $(MATHLIB)/fixed_quat.c
 SRC += $(FLIGHTLIB)/printf-stdarg.c
 SRC += $(FLIGHTLIB)/optypes.c
 
@@ -190,6 +196,19 @@ EXTRA_LIBS += m
 # Compiler flags
 CFLAGS +=
 
+# Check the worst case stack use of the tasks and callbacks against the budget
+# of the board, set STACK_BUDGET_CHECK to NO to skip the check
+STACK_BUDGET_CHECK ?= YES
+ifeq ($(STACK_BUDGET_CHECK), YES)
+    STACK_BUDGET ?= $(wildcard $(TOPDIR)/stack_budget.txt)
+endif
+ifneq ($(STACK_BUDGET),)
+    CFLAGS += -fstack-usage
+endif
+
+# Size the UAVObject id lookup index to the objects linked into this target
+CDEFS += -DUAVOBJ_INDEX_SIZE=$(words $(filter $(OPUAVSYNTHDIR)/%,$(SRC)))
+
 # Set linker-script name depending on selected submodel name
 ifeq ($(MCU),cortex-m3)
     LDFLAGS += -T$(LINKER_SCRIPTS_PATH)/link_$(BOARD)_memory.ld
@@ -32,6 +32,9 @@ ENABLE_DEBUG_PINS    ?= NO
 # Set to YES to enable the AUX UART which is mapped on the S1 (Tx) and S2 (Rx) servo outputs
 ENABLE_AUX_UART      ?= NO
 
+# Set to YES to stream the scheduler, queue and UAVObject events over SWO (discoveryf4bare)
+ENABLE_ITM_TRACE     ?= NO
+
 # Include objects that are just nice information to show
 DIAG_STACK           ?= NO
 DIAG_MIXERSTATUS     ?= NO
@@ -73,6 +76,10 @@ ifeq ($(ENABLE_AUX_UART), YES)
     CDEFS += -DPIOS_ENABLE_AUX_UART
 endif
 
+ifeq ($(ENABLE_ITM_TRACE), YES)
+    CDEFS += -DPIOS_ENABLE_ITM_TRACE
+endif
+
 # The following Makefile command, ifneq (,$(filter) $(A), $(B) $(C))
 #    is equivalent to the pseudocode `if (A == B || A == C)`
 ifneq (,$(filter YES,$(DIAG_STACK) $(DIAG_ALL)))
@@ -233,6 +240,17 @@ else
     $(error "$(MSG_FORMATERROR) $(FORMAT)")
 endif
 
+# Stack and RAM budget from the .su files of -fstack-usage, see make/scripts/stack-budget.py
+ifneq ($(STACK_BUDGET),)
+build: stack
+
+$(OUTDIR)/$(TARGET).stack: $(OUTDIR)/$(TARGET).elf $(STACK_BUDGET) $(ROOT_DIR)/make/scripts/stack-budget.py
+	@$(ECHO) $(MSG_STACK) $(call toprel, $@)
+	$(V1) $(PYTHON) $(ROOT_DIR)/make/scripts/stack-budget.py --objdump=$(OBJDUMP) --nm=$(NM) \
+		--su-dir=$(OUTDIR) --map=$(OUTDIR)/$(TARGET).map --budget=$(STACK_BUDGET) \
+		--output=$@ $<
+endif
+
 # Generate code for PyMite
 # $(OUTDIR)/pmlib_img.c $(OUTDIR)/pmlib_nat.c $(OUTDIR)/pmlibusr_img.c $(OUTDIR)/pmlibusr_nat.c $(OUTDIR)/pmfeatures.h: $(wildcard $(PYMITELIB)/*.py) $(wildcard $(PYMITEPLAT)/*.py) $(wildcard $(FLIGHTPLANLIB)/*.py) $(wildcard $(FLIGHTPLANS)/*.py)
 #	@$(ECHO) $(MSG_PYMITEINIT) $(call toprel, $@)
@@ -278,7 +296,7 @@ $(eval $(call OPFW_TEMPLATE,$(OUTDIR)/$(TARGET).bin,$(BOARD_TYPE),$(BOARD_REVISI
 
 $(OUTDIR)/$(TARGET).bin.o: $(OUTDIR)/$(TARGET).bin
 
-.PHONY: elf lss sym hex bin bino opfw
+.PHONY: elf lss sym hex bin bino opfw stack
 elf: $(OUTDIR)/$(TARGET).elf
 lss: $(OUTDIR)/$(TARGET).lss
 sym: $(OUTDIR)/$(TARGET).sym
@@ -286,6 +304,7 @@ hex: $(OUTDIR)/$(TARGET).hex
 bin: $(OUTDIR)/$(TARGET).bin
 bino: $(OUTDIR)/$(TARGET).bin.o
 opfw: $(OUTDIR)/$(TARGET).opfw
+stack: $(OUTDIR)/$(TARGET).stack
 
 # Display sizes of sections.
 $(eval $(call SIZE_TEMPLATE, $(OUTDIR)/$(TARGET).elf))
@@ -301,6 +320,8 @@ clean:
 	$(V1) $(RM) -f $(OUTDIR)/$(TARGET).lss
 	$(V1) $(RM) -f $(OUTDIR)/$(TARGET).bin.o
 	$(V1) $(RM) -f $(OUTDIR)/$(TARGET).opfw
+	$(V1) $(RM) -f $(OUTDIR)/$(TARGET).stack $(OUTDIR)/$(TARGET).stack.failed
+	$(V1) $(RM) -f $(wildcard $(OUTDIR)/*.su)
 	$(V1) $(RM) -f $(wildcard $(OUTDIR)/*.c)
 	$(V1) $(RM) -f $(wildcard $(OUTDIR)/*.h)
 	$(V1) $(RM) -f $(ALLOBJ)
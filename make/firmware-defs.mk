@@ -43,6 +43,7 @@ endif
 MSG_FORMATERROR      = $(QUOTE) Can not handle output-format$(QUOTE)
 MSG_MODINIT          = $(QUOTE) MODINIT   $(MSG_EXTRA) $(QUOTE)
 MSG_SIZE             = $(QUOTE) SIZE      $(MSG_EXTRA) $(QUOTE)
+MSG_STACK            = $(QUOTE) STACK     $(MSG_EXTRA) $(QUOTE)
 MSG_LOAD_FILE        = $(QUOTE) BIN/HEX   $(MSG_EXTRA) $(QUOTE)
 MSG_BIN_OBJ          = $(QUOTE) BINO      $(MSG_EXTRA) $(QUOTE)
 MSG_STRIP_FILE       = $(QUOTE) STRIP     $(MSG_EXTRA) $(QUOTE)
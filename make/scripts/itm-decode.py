@@ -0,0 +1,289 @@
+#!/usr/bin/env python
+#
+# Decode the ITM trace of a firmware built with ENABLE_ITM_TRACE=YES into a
+# timeline of task switches, queue and UAVObject events, see pios_itm.h for
+# the stimulus ports and their payloads.
+#
+# The input is the raw SWO byte stream, as captured for instance by OpenOCD
+# with the core clock and the SWO rate of the firmware:
+#   tpiu config internal swo.bin uart off 168000000 2000000
+#
+# The timeline is printed, or written with -j as a Chrome trace to be opened
+# in chrome://tracing or Perfetto, with a row per task. Object ids are named
+# after the generated UAVObject headers, found with -u.
+#
+# -l FROM:TO measures the latency from the updates of the object FROM to the
+# next update of TO, e.g. from the gyro samples to the actuator commands:
+#   make/scripts/itm-decode.py swo.bin -l GyroSensor:ActuatorCommand -q
+#
+# (c) 2014, The OpenPilot Team, http://www.openpilot.org
+# See also: The GNU Public License (GPL) Version 3
+#
+
+import optparse
+import json
+import glob
+import sys
+import re
+import os
+
+PORT_TASK_SWITCH = 1
+PORT_TASK_CREATE = 2
+PORT_TASK_NAME = 3
+PORT_QUEUE_SEND = 4
+PORT_QUEUE_RECEIVE = 5
+PORT_SEM_GIVE = 6
+PORT_SEM_TAKE = 7
+PORT_UAVO_UPDATED = 8
+PORT_UAVO_UNPACKED = 9
+
+EVENT_NAMES = {
+    PORT_QUEUE_SEND: "queue send",
+    PORT_QUEUE_RECEIVE: "queue receive",
+    PORT_SEM_GIVE: "semaphore give",
+    PORT_SEM_TAKE: "semaphore take",
+    PORT_UAVO_UPDATED: "updated",
+    PORT_UAVO_UNPACKED: "unpacked",
+}
+
+
+def itm_packets(data):
+    """Yield ("ts", cycles) for the local timestamps and (port, value) for the software source packets"""
+    i = 0
+    n = len(data)
+    while i < n:
+        header = data[i]
+        i += 1
+        if header == 0x00:
+            # synchronisation, zeros up to a 0x80
+            while i < n and data[i] == 0x00:
+                i += 1
+            if i < n and data[i] == 0x80:
+                i += 1
+        elif header == 0x70:
+            yield ("overflow", 0)
+        elif header & 0x0f == 0x00:
+            # local timestamp, in one byte or in continued 7 bit groups
+            if header & 0x80:
+                value = 0
+                shift = 0
+                while i < n:
+                    byte = data[i]
+                    i += 1
+                    value |= (byte & 0x7f) << shift
+                    shift += 7
+                    if not byte & 0x80:
+                        break
+                yield ("ts", value)
+            else:
+                yield ("ts", (header >> 4) & 0x07)
+        elif header & 0x03 == 0x00:
+            # extension or global timestamp, skipped
+            more = header & 0x80
+            while more and i < n:
+                more = data[i] & 0x80
+                i += 1
+        else:
+            size = {1: 1, 2: 2, 3: 4}[header & 0x03]
+            payload = data[i:i + size]
+            i += size
+            if len(payload) < size:
+                break
+            value = 0
+            for byte in reversed(payload):
+                value = (value << 8) | byte
+            # hardware (DWT) packets have bit 2 set, only the software ones are ours
+            if not header & 0x04:
+                yield (header >> 3, value)
+
+
+def load_uavo_names(paths):
+    """Object id to name, from the generated flight headers or python modules"""
+    names = {}
+    for path in paths:
+        for filename in glob.glob(os.path.join(path, "*.h")) + glob.glob(os.path.join(path, "*.py")):
+            with open(filename) as f:
+                text = f.read()
+            for name, objid in re.findall(r"#define\s+(\w+)_OBJID\s+(0x[0-9A-Fa-f]+)", text):
+                names.setdefault(int(objid, 16), name)
+            py_id = re.search(r"OBJID\s*=\s*(0x[0-9A-Fa-f]+|\d+)", text)
+            py_name = re.search(r"\bNAME\s*=\s*\"(\w+)\"", text)
+            if py_id and py_name:
+                # the python names have the case of the definitions
+                names[int(py_id.group(1), 0)] = py_name.group(1)
+    return names
+
+
+class Timeline:
+    """Events with their time, and the task running when they happened"""
+
+    def __init__(self, clock, uavo_names):
+        self.clock = float(clock)
+        self.uavo_names = uavo_names
+        self.tasks = {}
+        self.creating = None
+        self.name = ""
+        self.cycles = 0
+        self.overflows = 0
+        # events wait for the timestamp that follows them
+        self.pending = []
+        self.events = []
+
+    def task_name(self, handle):
+        return self.tasks.get(handle, "0x%08x" % handle)
+
+    def uavo_name(self, objid):
+        return self.uavo_names.get(objid, "0x%08X" % objid)
+
+    def feed(self, packets):
+        for port, value in packets:
+            if port == "ts":
+                self.cycles += value
+                for event in self.pending:
+                    event["t"] = self.cycles / self.clock
+                    self.events.append(event)
+                self.pending = []
+            elif port == "overflow":
+                self.overflows += 1
+            elif port == PORT_TASK_CREATE:
+                self.creating = value
+                self.name = ""
+            elif port == PORT_TASK_NAME:
+                if value & 0xff:
+                    self.name += chr(value & 0xff)
+                elif self.creating is not None:
+                    self.tasks[self.creating] = self.name
+                    self.creating = None
+            elif port in EVENT_NAMES or port == PORT_TASK_SWITCH:
+                self.pending.append({"port": port, "value": value})
+        for event in self.pending:
+            event["t"] = self.cycles / self.clock
+            self.events.append(event)
+        self.pending = []
+
+    def describe(self, event):
+        port = event["port"]
+        if port in (PORT_UAVO_UPDATED, PORT_UAVO_UNPACKED):
+            return "%s %s" % (self.uavo_name(event["value"]), EVENT_NAMES[port])
+        return "%s 0x%08x" % (EVENT_NAMES[port], event["value"])
+
+    def walk(self):
+        """Yield (time, running task, event) with the task switches resolved"""
+        running = None
+        for event in self.events:
+            if event["port"] == PORT_TASK_SWITCH:
+                running = self.task_name(event["value"])
+            yield event["t"], running, event
+
+    def print_timeline(self, out):
+        for t, running, event in self.walk():
+            if event["port"] == PORT_TASK_SWITCH:
+                out.write("%14.3f us  %-16s switched in\n" % (t * 1e6, running))
+            else:
+                out.write("%14.3f us  %-16s %s\n" % (t * 1e6, running or "-", self.describe(event)))
+
+    def chrome_trace(self):
+        trace = []
+        tids = {}
+        running = None
+        since = 0.0
+
+        def tid(name):
+            if name not in tids:
+                tids[name] = len(tids) + 1
+                trace.append({"ph": "M", "name": "thread_name", "pid": 1, "tid": tids[name], "args": {"name": name}})
+            return tids[name]
+
+        for t, task, event in self.walk():
+            if event["port"] == PORT_TASK_SWITCH:
+                if running is not None:
+                    trace.append({"ph": "X", "name": running, "pid": 1, "tid": tid(running),
+                                  "ts": since * 1e6, "dur": (t - since) * 1e6})
+                running = task
+                since = t
+            else:
+                trace.append({"ph": "i", "s": "t", "name": self.describe(event), "pid": 1,
+                              "tid": tid(task or "-"), "ts": t * 1e6})
+        return {"traceEvents": trace, "displayTimeUnit": "ns"}
+
+    def latency(self, source, target):
+        """Delays from each last update of source to the next update of target, in seconds"""
+        source = source.lower()
+        target = target.lower()
+        start = None
+        delays = []
+        for t, running, event in self.walk():
+            if event["port"] not in (PORT_UAVO_UPDATED, PORT_UAVO_UNPACKED):
+                continue
+            name = self.uavo_name(event["value"]).lower()
+            if name == target and start is not None:
+                delays.append(t - start)
+                start = None
+            if name == source:
+                start = t
+        return delays
+
+    def run_times(self):
+        """Time each task ran, in seconds"""
+        times = {}
+        running = None
+        since = 0.0
+        for t, task, event in self.walk():
+            if event["port"] == PORT_TASK_SWITCH:
+                if running is not None:
+                    times[running] = times.get(running, 0.0) + t - since
+                running = task
+                since = t
+        return times
+
+
+def main():
+    parser = optparse.OptionParser(usage="%prog [options] swo.bin")
+    parser.add_option("-c", "--clock", type="float", default=168e6,
+                      help="core clock of the ITM timestamps in Hz [default: %default]")
+    parser.add_option("-u", "--uavobjects", action="append",
+                      help="directory of the generated UAVObject headers or python modules "
+                      "[default: build/uavobject-synthetics/flight]")
+    parser.add_option("-j", "--json", help="write the timeline to this Chrome trace file")
+    parser.add_option("-l", "--latency", action="append", default=[], metavar="FROM:TO",
+                      help="report the delays from the updates of object FROM to the next ones of TO")
+    parser.add_option("-q", "--quiet", action="store_true", default=False,
+                      help="do not print the timeline")
+    (options, args) = parser.parse_args()
+
+    if len(args) != 1:
+        parser.error("one SWO capture expected")
+
+    data = bytearray(getattr(sys.stdin, "buffer", sys.stdin).read() if args[0] == "-" else open(args[0], "rb").read())
+    timeline = Timeline(options.clock, load_uavo_names(options.uavobjects or ["build/uavobject-synthetics/flight"]))
+    timeline.feed(itm_packets(data))
+
+    if not options.quiet:
+        timeline.print_timeline(sys.stdout)
+
+    if options.json:
+        with open(options.json, "w") as out:
+            json.dump(timeline.chrome_trace(), out)
+
+    duration = timeline.events[-1]["t"] if timeline.events else 0.0
+    sys.stderr.write("%d events over %.3f ms, %d overflows\n" % (len(timeline.events), duration * 1e3, timeline.overflows))
+    if duration > 0:
+        for task, time in sorted(timeline.run_times().items(), key=lambda item: -item[1]):
+            sys.stderr.write("%-16s %6.2f %%\n" % (task, 100.0 * time / duration))
+
+    for chain in options.latency:
+        source, _, target = chain.partition(":")
+        delays = sorted(timeline.latency(source, target))
+        if not delays:
+            sys.stderr.write("%s: no update of %s after %s\n" % (chain, target, source))
+            continue
+        sys.stderr.write("%s: %d samples, min %.1f us, avg %.1f us, p99 %.1f us, max %.1f us\n" %
+                         (chain, len(delays), delays[0] * 1e6, sum(delays) / len(delays) * 1e6,
+                          delays[min(len(delays) - 1, int(len(delays) * 0.99))] * 1e6, delays[-1] * 1e6))
+
+    # a stream with overflows lost events, the numbers above are not to be trusted
+    return 1 if timeline.overflows else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,190 @@
+#!/usr/bin/env python
+#
+# Run several simposix simulations in parallel and report how they flew.
+#
+# Each instance runs in a directory of its own (the simulation keeps its
+# settings in the working directory), with its UDP ports moved by
+# OP_SIM_PORT_OFFSET, its sensor noise seeded by OP_SIM_SEED and the
+# flight plan given by OP_SIM_PLAN. The SIMSTATS lines the simulated
+# Sensors module prints every OP_SIM_STATS seconds are gathered into a
+# report with the loop timing and the state estimation errors.
+#
+# A flight plan gives the sticks from a time on, in seconds, throttle,
+# roll, pitch, yaw and flight mode switch position, e.g. to take off,
+# roll right for two seconds and hover again:
+#   0   -1  0   0 0 0
+#   2   0.6 0   0 0 0
+#   10  0.6 0.3 0 0 0
+#   12  0.6 0   0 0 0
+#
+# With --virtual the simulation runs in virtual time, that is as fast as
+# its tasks allow, and -d gives the wall time of the run. --realtime puts
+# each instance on a CPU of its own, with real time priorities.
+#
+# Example:
+#   make fw_simposix
+#   make/scripts/simposix-runner.py -n 8 -p plan.txt -d 60 -o report.json
+#
+# (c) 2014, The OpenPilot Team, http://www.openpilot.org
+# See also: The GNU Public License (GPL) Version 3
+#
+
+from subprocess import Popen, PIPE, STDOUT
+from threading import Thread
+import multiprocessing
+import optparse
+import shutil
+import json
+import math
+import time
+import sys
+import os
+
+# each instance uses the telemetry, GPS, aux and lock-step ports
+PORTS_PER_INSTANCE = 10
+
+STATS_KEYS = ["loop_avg_us", "loop_max_us", "att_rms_deg", "att_max_deg", "pos_rms_m", "vel_rms_ms"]
+
+
+class Instance:
+    """One simposix process and the SIMSTATS samples it printed"""
+
+    def __init__(self, index, options):
+        self.index = index
+        self.seed = options.seed + index
+        self.dir = os.path.join(options.workdir, "sim%02d" % index)
+        self.samples = []
+        self.log = []
+
+        if os.path.isdir(self.dir):
+            shutil.rmtree(self.dir)
+        if options.settings:
+            shutil.copytree(options.settings, self.dir)
+        else:
+            os.makedirs(self.dir)
+
+        env = dict(os.environ)
+        env["OP_SIM_SEED"] = str(self.seed)
+        env["OP_SIM_STATS"] = str(options.period)
+        env["OP_SIM_PORT_OFFSET"] = str(index * PORTS_PER_INSTANCE)
+        if options.plan:
+            env["OP_SIM_PLAN"] = os.path.abspath(options.plan)
+        if options.realtime:
+            # one CPU per instance, as long as there are enough
+            env["OP_SIM_REALTIME"] = str(index % options.cpus)
+        if options.virtual:
+            env["OP_SIM_VIRTUAL_TIME"] = str(options.virtual)
+
+        self.process = Popen([os.path.abspath(options.firmware)], cwd=self.dir, env=env,
+                             stdout=PIPE, stderr=STDOUT, universal_newlines=True)
+        self.reader = Thread(target=self.read)
+        self.reader.daemon = True
+        self.reader.start()
+
+    def read(self):
+        for line in iter(self.process.stdout.readline, ""):
+            if line.startswith("SIMSTATS "):
+                sample = {}
+                for field in line.split()[1:]:
+                    key, _, value = field.partition("=")
+                    sample[key] = float(value)
+                self.samples.append(sample)
+            else:
+                self.log.append(line)
+
+    def stop(self):
+        if self.process.poll() is None:
+            self.process.terminate()
+        self.process.wait()
+        self.reader.join(5)
+        with open(os.path.join(self.dir, "simposix.log"), "w") as log:
+            log.writelines(self.log)
+
+    def summary(self, skip):
+        """Statistics over the samples from time skip on"""
+        samples = [s for s in self.samples if s.get("t", 0) >= skip]
+        result = {"instance": self.index, "seed": self.seed, "samples": len(samples),
+                  "exit": self.process.returncode}
+        for key in STATS_KEYS:
+            values = [s[key] for s in samples if key in s]
+            if not values:
+                continue
+            if key.endswith("_max_us") or key.endswith("_max_deg"):
+                result[key] = max(values)
+            elif key.startswith("loop"):
+                result[key] = sum(values) / len(values)
+            else:
+                # mean of the per period RMS, as a RMS over the whole flight
+                result[key] = math.sqrt(sum(v * v for v in values) / len(values))
+        return result
+
+
+def print_report(results, out):
+    columns = ["instance", "seed", "samples"] + STATS_KEYS
+    out.write(" ".join("%12s" % c for c in columns) + "\n")
+    for r in results:
+        out.write(" ".join(("%12.4f" % r[c]) if isinstance(r.get(c), float) else ("%12s" % r.get(c, "-"))
+                           for c in columns) + "\n")
+
+    worst = {}
+    for key in STATS_KEYS:
+        values = [r[key] for r in results if key in r]
+        if values:
+            worst[key] = max(values)
+    out.write(" ".join("%12s" % c for c in ["worst", "", ""]) + " " +
+              " ".join("%12.4f" % worst[k] if k in worst else "%12s" % "-" for k in STATS_KEYS) + "\n")
+    return worst
+
+
+def main():
+    parser = optparse.OptionParser(usage="%prog [options]")
+    parser.add_option("-f", "--firmware", default="build/fw_simposix/fw_simposix.elf",
+                      help="simposix executable [default: %default]")
+    parser.add_option("-n", "--instances", type="int", default=4,
+                      help="number of simulations run in parallel [default: %default]")
+    parser.add_option("-p", "--plan", help="flight plan file, see simPlanLoad() in Sensors/simulated")
+    parser.add_option("-s", "--settings", help="directory of saved settings copied to every instance")
+    parser.add_option("-d", "--duration", type="float", default=30.0,
+                      help="seconds each simulation runs [default: %default]")
+    parser.add_option("--settle", type="float", default=5.0,
+                      help="seconds left out of the report while the filters converge [default: %default]")
+    parser.add_option("--period", type="float", default=1.0,
+                      help="seconds between two samples [default: %default]")
+    parser.add_option("--seed", type="int", default=1,
+                      help="noise seed of the first instance, the next ones count up [default: %default]")
+    parser.add_option("-w", "--workdir", default="build/simposix-runner",
+                      help="directory holding the instance directories [default: %default]")
+    parser.add_option("-r", "--realtime", action="store_true", default=False,
+                      help="SCHED_FIFO priorities and one CPU per instance, needs the privilege to use them")
+    parser.add_option("--cpus", type="int", default=multiprocessing.cpu_count(),
+                      help="CPUs the instances are spread over with --realtime [default: %default]")
+    parser.add_option("--virtual", type="int", metavar="US",
+                      help="run in virtual time, giving the tasks at most US of wall time per tick")
+    parser.add_option("-o", "--output", help="also write the report to this JSON file")
+    (options, args) = parser.parse_args()
+
+    if not os.path.isfile(options.firmware):
+        parser.error("no simposix executable at %s, build it with 'make fw_simposix'" % options.firmware)
+
+    instances = [Instance(i, options) for i in range(options.instances)]
+    try:
+        time.sleep(options.duration)
+    except KeyboardInterrupt:
+        pass
+    for instance in instances:
+        instance.stop()
+
+    results = [instance.summary(options.settle) for instance in instances]
+    worst = print_report(results, sys.stdout)
+
+    if options.output:
+        with open(options.output, "w") as out:
+            json.dump({"plan": options.plan, "duration": options.duration, "instances": results,
+                       "worst": worst}, out, indent=2, sort_keys=True)
+
+    # an instance that printed nothing crashed or never started
+    return 0 if all(r["samples"] > 0 for r in results) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
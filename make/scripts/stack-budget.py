@@ -0,0 +1,336 @@
+#!/usr/bin/env python
+#
+# Worst case stack use of the tasks, callbacks and interrupt handlers of a
+# firmware image, and its RAM map, checked against the budget of the board.
+#
+# The frame of every function comes from the .su files gcc writes with
+# -fstack-usage, the calls from the disassembly of the ELF file. Calls
+# through function pointers can not be followed: an entry which makes any
+# is reported as a lower bound, the budget file can name their targets.
+#
+# (c) 2014, The OpenPilot Team, http://www.openpilot.org
+# See also: The GNU Public License (GPL) Version 3
+#
+
+from __future__ import print_function
+
+from subprocess import Popen, PIPE
+import optparse
+import fnmatch
+import glob
+import sys
+import re
+import os
+
+# interrupt handlers, run on the IRQ stack
+IRQ_PATTERNS = ['*_IRQHandler', '*_Handler', 'xPortPendSVHandler', 'xPortSysTickHandler', 'vPortSVCHandler']
+
+# direct calls and tail calls, ARM thumb and x86 for the host builds
+CALL_RE = re.compile(r'^\s*[0-9a-f]+:\s+(?:[0-9a-f]{2,8} )*\s*(bl|blx|b|b\.w|b\.n|call|callq|jmp|jmpq)\s+[0-9a-f]+ <([^>+]+)>\s*$')
+INDIRECT_RE = re.compile(r'^\s*[0-9a-f]+:\s+(?:[0-9a-f]{2,8} )*\s*(?:blx\s+r\d+|bx\s+r\d+|call[q]?\s+\*|jmp[q]?\s+\*)')
+FUNC_RE = re.compile(r'^([0-9a-f]+) <([^>]+)>:$')
+SU_RE = re.compile(r'^(.*):(\d+):(\d+):(.+)\t(\d+)\t(\S+)$')
+
+
+def run(cmd):
+    """Run a tool and return its output as text"""
+    p = Popen(cmd, stdout = PIPE, stderr = PIPE)
+    out, err = p.communicate()
+    if p.returncode != 0:
+        sys.stderr.write(err.decode('utf-8', 'replace'))
+        sys.exit("stack-budget: %s failed" % cmd[0])
+    return out.decode('utf-8', 'replace')
+
+
+def base_name(name):
+    """The function a compiler clone (foo.constprop.0, foo.isra.1) comes from"""
+    name = name.split('@')[0]
+    return name.split('.')[0]
+
+
+class Frames:
+    """Frame sizes by function from the .su files"""
+
+    def __init__(self, files):
+        self.size = {}
+        self.dynamic = set()
+        for f in files:
+            for line in open(f):
+                m = SU_RE.match(line.rstrip('\n'))
+                if not m:
+                    continue
+                # C++ names come with their signature
+                name = m.group(4).split('(')[0].split()[-1]
+                size = int(m.group(5))
+                # static functions of the same name in several files, keep the largest
+                self.size[name] = max(size, self.size.get(name, 0))
+                if 'dynamic' in m.group(6) and 'bounded' not in m.group(6):
+                    self.dynamic.add(name)
+
+    def get(self, name):
+        for n in (name, base_name(name)):
+            if n in self.size:
+                return self.size[n], n in self.dynamic
+        return None, False
+
+
+class CallGraph:
+    """Direct calls by function from the disassembly"""
+
+    def __init__(self, objdump, elf):
+        self.calls = {}
+        self.indirect = set()
+        current = None
+        for line in run([objdump, '-d', elf]).splitlines():
+            m = FUNC_RE.match(line)
+            if m:
+                current = m.group(2)
+                self.calls.setdefault(current, set())
+                continue
+            if current is None:
+                continue
+            m = CALL_RE.match(line)
+            if m:
+                target = m.group(2).split('@')[0]
+                # branches inside the function are not calls, calls to itself are recursion
+                if target != current or m.group(1) in ('bl', 'blx', 'call', 'callq'):
+                    self.calls[current].add(target)
+            elif INDIRECT_RE.match(line):
+                self.indirect.add(current)
+
+    def add(self, caller, callees):
+        self.calls.setdefault(caller, set()).update(callees)
+        self.indirect.discard(caller)
+
+
+class Analysis:
+    """Deepest call chain from an entry point"""
+
+    def __init__(self, frames, graph):
+        self.frames = frames
+        self.graph = graph
+        self.memo = {}
+
+    def depth(self, name, stack = ()):
+        """Returns (bytes, chain, flags) of the deepest path below name"""
+        if name in self.memo:
+            return self.memo[name]
+        if name in stack:
+            return 0, [name], set(['recursive'])
+        frame, dynamic = self.frames.get(name)
+        flags = set()
+        if frame is None:
+            frame = 0
+            flags.add('unknown')
+        if dynamic:
+            flags.add('dynamic')
+        if name in self.graph.indirect:
+            flags.add('indirect')
+        deepest, chain = 0, []
+        for callee in sorted(self.graph.calls.get(name, ())):
+            d, c, f = self.depth(callee, stack + (name,))
+            flags |= f
+            if d > deepest:
+                deepest, chain = d, c
+        result = (frame + deepest, [name] + chain, flags)
+        if 'recursive' not in flags:
+            self.memo[name] = result
+        return result
+
+
+class Budget:
+    """The budget file of the board"""
+
+    def __init__(self, path):
+        self.tasks = []
+        self.callbacks = []
+        self.heaps = []
+        self.calls = []
+        self.irq_nesting = 0
+        self.task_overhead = 0
+        self.irq_overhead = 0
+        if not path:
+            return
+        for n, line in enumerate(open(path)):
+            words = line.split('#')[0].split()
+            if not words:
+                continue
+            try:
+                kind = words[0]
+                if kind == 'task':
+                    self.tasks.append((words[1], int(words[2], 0)))
+                elif kind == 'callback':
+                    self.callbacks.append((words[1], int(words[2], 0)))
+                elif kind == 'heap':
+                    self.heaps.append((words[1], int(words[2], 0)))
+                elif kind == 'calls':
+                    self.calls.append((words[1], words[2:]))
+                elif kind == 'irq':
+                    self.irq_nesting = int(words[1], 0)
+                elif kind == 'set' and words[1] == 'taskoverhead':
+                    self.task_overhead = int(words[2], 0)
+                elif kind == 'set' and words[1] == 'irqoverhead':
+                    self.irq_overhead = int(words[2], 0)
+                else:
+                    raise ValueError(kind)
+            except (IndexError, ValueError):
+                sys.exit("%s:%d: can not parse '%s'" % (path, n + 1, line.strip()))
+
+
+def memory_regions(mapfile):
+    """Name, origin, length and attributes of the regions from the linker map"""
+    regions = []
+    inside = False
+    for line in open(mapfile):
+        if line.startswith('Memory Configuration'):
+            inside = True
+            continue
+        if inside and line.startswith('Linker script and memory map'):
+            break
+        words = line.split()
+        if inside and len(words) >= 3 and words[1].startswith('0x'):
+            if words[0] != '*default*':
+                attributes = words[3] if len(words) > 3 else ''
+                regions.append((words[0], int(words[1], 16), int(words[2], 16), attributes))
+    return regions
+
+
+def sections(objdump, elf):
+    """Name, size, address of the sections taking memory"""
+    result = []
+    lines = run([objdump, '-h', elf]).splitlines()
+    for i, line in enumerate(lines):
+        words = line.split()
+        if len(words) >= 7 and words[0].isdigit() and i + 1 < len(lines) and 'ALLOC' in lines[i + 1]:
+            result.append((words[1], int(words[2], 16), int(words[3], 16)))
+    return result
+
+
+def symbols(nm, elf):
+    """Address of every symbol, and the data symbols with their size"""
+    address = {}
+    data = []
+    for line in run([nm, '-S', elf]).splitlines():
+        words = line.split()
+        if len(words) == 3:
+            address[words[2]] = int(words[0], 16)
+        elif len(words) == 4:
+            address[words[3]] = int(words[0], 16)
+            if words[2] in 'bBdD':
+                data.append((int(words[1], 16), words[3]))
+    return address, sorted(data, reverse = True)
+
+
+def flagstr(flags):
+    return ','.join(sorted(flags)) if flags else ''
+
+
+def main():
+    parser = optparse.OptionParser(usage = "usage: %prog [options] firmware.elf")
+    parser.add_option('--objdump', default = 'objdump', help = 'objdump of the toolchain')
+    parser.add_option('--nm', default = 'nm', help = 'nm of the toolchain')
+    parser.add_option('--su-dir', help = 'directory of the .su files')
+    parser.add_option('--map', help = 'linker map file, for the memory regions')
+    parser.add_option('--budget', help = 'budget file of the board')
+    parser.add_option('--output', help = 'report file, written with .failed appended on violations')
+    (options, args) = parser.parse_args()
+    if len(args) != 1:
+        parser.error("the firmware ELF file is required")
+    elf = args[0]
+
+    frames = Frames(glob.glob(os.path.join(options.su_dir or os.path.dirname(elf), '*.su')))
+    graph = CallGraph(options.objdump, elf)
+    budget = Budget(options.budget)
+    for caller, callees in budget.calls:
+        graph.add(caller, callees)
+    analysis = Analysis(frames, graph)
+    address, data = symbols(options.nm, elf)
+
+    report = []
+    violations = []
+
+    def check(kind, name, limit, overhead):
+        if name not in graph.calls:
+            report.append("%-9s %-32s %6s %6d  not linked" % (kind, name, '', limit))
+            return
+        used, chain, flags = analysis.depth(name)
+        used += overhead
+        line = "%-9s %-32s %6d %6d %6d  %s" % (kind, name, used, limit, limit - used, flagstr(flags))
+        report.append(line)
+        report.append("          deepest: %s" % ' > '.join(chain))
+        if used > limit:
+            violations.append("%s %s needs %d bytes of stack, has %d" % (kind, name, used, limit))
+
+    report.append("Stack use in bytes, a flag marks the figure as a lower bound:")
+    report.append("  indirect: calls through function pointers  recursive: cycle in the call graph")
+    report.append("  unknown: function without stack usage info  dynamic: alloca or variable length array")
+    report.append("")
+    report.append("%-9s %-32s %6s %6s %6s  %s" % ('kind', 'entry', 'worst', 'budget', 'slack', 'flags'))
+    for name, limit in budget.tasks:
+        check('task', name, limit, budget.task_overhead)
+    for name, limit in budget.callbacks:
+        check('callback', name, limit, 0)
+
+    # interrupts nest by priority, the deepest handlers stacked on each other
+    handlers = [f for f in graph.calls if any(fnmatch.fnmatch(f, p) for p in IRQ_PATTERNS)]
+    depths = sorted([(analysis.depth(h)[0] + budget.irq_overhead, h) for h in handlers], reverse = True)
+    if '_irq_stack_top' in address and '_irq_stack_end' in address:
+        irq_stack = address['_irq_stack_top'] - address['_irq_stack_end']
+        report.append("")
+        report.append("IRQ stack %d bytes, deepest handlers:" % irq_stack)
+        for d, h in depths[:max(budget.irq_nesting, 5)]:
+            report.append("  %-40s %6d  %s" % (h, d, flagstr(analysis.depth(h)[2])))
+        if budget.irq_nesting:
+            nested = sum([d for d, h in depths[:budget.irq_nesting]])
+            report.append("  %d nested: %d bytes, slack %d" % (budget.irq_nesting, nested, irq_stack - nested))
+            if nested > irq_stack:
+                violations.append("%d nested interrupts need %d bytes of IRQ stack, has %d" % (budget.irq_nesting, nested, irq_stack))
+
+    # RAM map
+    if options.map:
+        secs = sections(options.objdump, elf)
+        report.append("")
+        report.append("%-12s %8s %8s %8s %8s" % ('region', 'size', 'static', 'heap', 'free'))
+        for region, origin, length, attributes in memory_regions(options.map):
+            inside = [(n, s) for n, s, a in secs if origin <= a < origin + length]
+            # RAM only, the flash is executable
+            if not inside or 'x' in attributes:
+                continue
+            heap = sum([s for n, s in inside if 'heap' in n])
+            static = sum([s for n, s in inside if 'heap' not in n])
+            report.append("%-12s %8d %8d %8d %8d" % (region, length, static, heap, length - static - heap))
+            for n, s in inside:
+                report.append("  %-20s %8d" % (n, s))
+        for name, minimum in budget.heaps:
+            size = dict([(n, s) for n, s, a in secs]).get(name)
+            if size is None:
+                continue
+            if size < minimum:
+                violations.append("section %s is %d bytes, needs at least %d" % (name, size, minimum))
+
+    report.append("")
+    report.append("Largest variables:")
+    for size, name in data[:20]:
+        report.append("  %-40s %8d" % (name, size))
+
+    text = '\n'.join(report) + '\n'
+    if violations:
+        text += '\nBudget violations:\n' + ''.join(['  %s\n' % v for v in violations])
+    if options.output:
+        for path in (options.output, options.output + '.failed'):
+            if os.path.exists(path):
+                os.remove(path)
+        open(options.output + ('.failed' if violations else ''), 'w').write(text)
+    else:
+        sys.stdout.write(text)
+
+    if violations:
+        for v in violations:
+            sys.stderr.write("stack-budget: %s\n" % v)
+        if options.output:
+            sys.stderr.write("stack-budget: see %s.failed\n" % options.output)
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()